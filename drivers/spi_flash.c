@@ -2,26 +2,85 @@
 
 #include <stddef.h>
 
+#include "platform/clock.h"
+#include "platform/cpu.h"
+#include "platform/dma.h"
 #include "platform/hw.h"
 #include "platform/irq_dma.h"
 #include "platform/mmio.h"
+#include "platform/overlay.h"
+#include "platform/ram.h"
 #include "platform/time.h"
+#include "platform/watchdog.h"
+#include "src/kernel/work_queue.h"
+#include "storage/flash_health.h"
 #include "storage/layout.h"
 
 /* External SPI flash (W25Q32-class) is accessed over SPI1 with CS on PA4. */
-#define DMA1_BASE 0x40020000u
-#define DMA1_IFCR (DMA1_BASE + 0x04u)
-#define DMA1_CH2_BASE (DMA1_BASE + 0x1Cu)
-#define DMA1_CH3_BASE (DMA1_BASE + 0x30u)
+/* SPI1 RX/TX channels, from the platform DMA table. */
+#define SPI_FLASH_DMA_RX platform_dma_ch(PLATFORM_DMA_FLASH_RX)
+#define SPI_FLASH_DMA_TX platform_dma_ch(PLATFORM_DMA_FLASH_TX)
 #define DMA_CCR(ch) ((ch) + 0x00u)
 #define DMA_CNDTR(ch) ((ch) + 0x04u)
 #define DMA_CPAR(ch) ((ch) + 0x08u)
 #define DMA_CMAR(ch) ((ch) + 0x0Cu)
 
+/* W25Q32 Fast Read (0x0B) is rated far above what SPI1 can clock; cap SCK at
+ * 36 MHz (PCLK2/2 on the stock 72 MHz tree). Commands keep the OEM /4. */
+#define SPI_FLASH_READ_SCK_MAX_HZ 36000000u
+#define SPI_FLASH_CR1_BR_MASK 0x0038u
+#define SPI_FLASH_CR1_BR_OEM 0x0008u /* fPCLK/4 */
+/* Below this a polled read is cheaper than DMA setup. */
+#define SPI_FLASH_DMA_MIN_BYTES 16u
+#define SPI_FLASH_DMA_MAX_CHUNK 0xFFFFu
+/* Spin guard for a lost DMA completion; falls back to the polled read. */
+#define SPI_FLASH_DMA_SPIN_MAX 2000000u
+/* Same guard for background reads, which are polled from the main loop. */
+#define SPI_FLASH_ASYNC_TIMEOUT_MS 20u
+/* LCD blits go out in CNDTR-sized chunks; one is ~50 ms of SCK at the OEM
+ * baud, so a chunk that has not finished in 4x that lost its completion. */
+#define SPI_FLASH_LCD_CHUNK_PX 0xE000u
+#define SPI_FLASH_BLIT_TIMEOUT_MS 200u
+
+/* W25Q erase/program suspend (tSUS <= 20 us) and SR2.SUS. */
+#define SPI_FLASH_CMD_SUSPEND 0x75u
+#define SPI_FLASH_CMD_RESUME 0x7Au
+#define SPI_FLASH_SR2_SUS 0x80u
+
+/* Read-through page cache for small random reads (headers, records, meta).
+ * Larger SRAM builds can raise the line count; reads above MAX bypass it. */
+#define SPI_FLASH_CACHE_LINES 8u
+#define SPI_FLASH_CACHE_MAX_READ 64u
+#define SPI_FLASH_CACHE_EMPTY 0xFFFFFFFFu
+
+typedef struct {
+    uint32_t page; /* page base address or SPI_FLASH_CACHE_EMPTY */
+    uint32_t used; /* LRU stamp */
+} spi_flash_cache_line_t;
+
+static struct {
+    spi_flash_cache_line_t lines[SPI_FLASH_CACHE_LINES];
+    uint32_t clock;
+    spi_flash_cache_stats_t stats;
+    uint8_t ready;
+} g_spi_flash_cache;
+
+/* Line data, indexed like lines[]; read only while its line holds a page. */
+static uint8_t g_spi_flash_cache_data[SPI_FLASH_CACHE_LINES][SPI_FLASH_PAGE_SIZE]
+    __attribute__((aligned(4))) RAM_NOZERO;
+
 static int spi_flash_hw_inited;
+static uint32_t g_spi_flash_read_br;
+/* Operation started by a *_start call and not yet observed complete. */
+static volatile uint8_t g_spi_flash_op;
+/* Last erase or program issued, for storage/flash_health.h. */
+static uint32_t g_spi_flash_op_addr;
+static uint32_t g_spi_flash_op_cycles;
 static uint8_t g_spi_dma_stub_rx[4] __attribute__((aligned(4)));
 static uint8_t g_spi_dma_stub_tx[4] __attribute__((aligned(4)));
 
+static uint8_t spi_flash_blit_chain(void);
+
 static inline void spi1_disable(void)
 {
     mmio_write32(SPI1_BASE + 0x00u, mmio_read32(SPI1_BASE + 0x00u) & ~0x40u);
@@ -39,19 +98,33 @@ static void spi1_apply_cr1(uint32_t extra_bits)
     mmio_write32(SPI1_BASE + 0x00u, cr1);
 }
 
-static inline void spi_flash_stage_mark(uint32_t value)
+/* Baud-rate field only; caller must have SPE cleared. */
+static void spi1_set_br(uint32_t br_bits)
 {
-    (void)value;
+    uint32_t cr1 = mmio_read32(SPI1_BASE + 0x00u);
+    cr1 = (cr1 & ~SPI_FLASH_CR1_BR_MASK) | (br_bits & SPI_FLASH_CR1_BR_MASK);
+    mmio_write32(SPI1_BASE + 0x00u, cr1);
+}
+
+static uint32_t spi_flash_pick_read_br(void)
+{
+    uint32_t pclk = rcc_get_pclk_hz_fallback(1u);
+    uint32_t br = 0u; /* fPCLK/2 */
+    while (br < 7u && (pclk >> (br + 1u)) > SPI_FLASH_READ_SCK_MAX_HZ)
+        br++;
+    return br << 3;
+}
+
+void spi_flash_clock_changed(void)
+{
+    /* Commands keep the OEM /4; reads take the fastest BR under the cap. */
+    if (spi_flash_hw_inited)
+        g_spi_flash_read_br = spi_flash_pick_read_br();
 }
 
-static void nvic_set_priority(uint8_t irq, uint8_t priority)
+static inline void spi_flash_stage_mark(uint32_t value)
 {
-    uint32_t addr = NVIC_IPR_BASE + irq;
-    uint32_t word = addr & ~0x3u;
-    uint32_t shift = (addr & 0x3u) * 8u;
-    uint32_t v = mmio_read32(word);
-    v = (v & ~(0xFFu << shift)) | ((uint32_t)priority << shift);
-    mmio_write32(word, v);
+    (void)value;
 }
 
 static void spi_flash_gpio_configure_mask(uint32_t base, uint16_t mask, uint8_t mode_byte, uint8_t extend)
@@ -95,6 +168,7 @@ static void spi_flash_hw_init_once(void)
     if (spi_flash_hw_inited)
         return;
     spi_flash_hw_inited = 1;
+    g_spi_flash_read_br = spi_flash_pick_read_br();
 
     /* OEM-style enable: GPIOA + SPI1 on APB2. */
     uint32_t apb2 = mmio_read32(RCC_APB2ENR);
@@ -133,32 +207,31 @@ static void spi_flash_hw_init_once(void)
 
     /* OEM-style DMA channel reset/flag clear (no IRQ enable). */
     mmio_write32(RCC_AHBENR, mmio_read32(RCC_AHBENR) | (1u << 0));
-    mmio_write32(DMA_CCR(DMA1_CH2_BASE), mmio_read32(DMA_CCR(DMA1_CH2_BASE)) & ~1u);
-    mmio_write32(DMA_CCR(DMA1_CH3_BASE), mmio_read32(DMA_CCR(DMA1_CH3_BASE)) & ~1u);
-    mmio_write32(DMA_CNDTR(DMA1_CH2_BASE), 0u);
-    mmio_write32(DMA_CPAR(DMA1_CH2_BASE), 0u);
-    mmio_write32(DMA_CMAR(DMA1_CH2_BASE), 0u);
-    mmio_write32(DMA_CNDTR(DMA1_CH3_BASE), 0u);
-    mmio_write32(DMA_CPAR(DMA1_CH3_BASE), 0u);
-    mmio_write32(DMA_CMAR(DMA1_CH3_BASE), 0u);
-    mmio_write32(DMA1_IFCR, (0x0Fu << 4) | (0x0Fu << 8));
-
-    /* OEM-style: enable DMA1 CH2/CH3 NVIC lines (12/13). */
-    /* Priorities match OEM app 2.2.5 with AIRCR PRIGROUP=0x5 (SCB_AIRCR=0x500). */
-    nvic_set_priority(12u, 0x80u);
-    nvic_set_priority(13u, 0x40u);
-    mmio_write32(NVIC_ISER0, (1u << 12) | (1u << 13));
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) & ~1u);
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_TX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_TX)) & ~1u);
+    mmio_write32(DMA_CNDTR(SPI_FLASH_DMA_RX), 0u);
+    mmio_write32(DMA_CPAR(SPI_FLASH_DMA_RX), 0u);
+    mmio_write32(DMA_CMAR(SPI_FLASH_DMA_RX), 0u);
+    mmio_write32(DMA_CNDTR(SPI_FLASH_DMA_TX), 0u);
+    mmio_write32(DMA_CPAR(SPI_FLASH_DMA_TX), 0u);
+    mmio_write32(DMA_CMAR(SPI_FLASH_DMA_TX), 0u);
+
+    /* OEM-style: enable DMA1 CH2/CH3 NVIC lines (priorities in platform/dma.c). */
+    platform_spi_dma_attach();
+    platform_spi_dma_set_rx_chain(spi_flash_blit_chain);
 
     /* OEM-style DMA channel presets for SPI1 DR (channels 2/3). */
-    mmio_write32(DMA_CCR(DMA1_CH2_BASE), (mmio_read32(DMA_CCR(DMA1_CH2_BASE)) & ~0x7FF0u) | 0x3500u);
-    mmio_write32(DMA_CPAR(DMA1_CH2_BASE), SPI1_BASE + 0x0Cu);
-    mmio_write32(DMA_CMAR(DMA1_CH2_BASE), (uint32_t)g_spi_dma_stub_rx);
-    mmio_write32(DMA_CNDTR(DMA1_CH2_BASE), 0u);
-
-    mmio_write32(DMA_CCR(DMA1_CH3_BASE), (mmio_read32(DMA_CCR(DMA1_CH3_BASE)) & ~0x7FF0u) | 0x1510u);
-    mmio_write32(DMA_CPAR(DMA1_CH3_BASE), SPI1_BASE + 0x0Cu);
-    mmio_write32(DMA_CMAR(DMA1_CH3_BASE), (uint32_t)g_spi_dma_stub_tx);
-    mmio_write32(DMA_CNDTR(DMA1_CH3_BASE), 0u);
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), (mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) & ~0x7FF0u) | 0x0500u |
+                                              platform_dma_pl(PLATFORM_DMA_FLASH_RX));
+    mmio_write32(DMA_CPAR(SPI_FLASH_DMA_RX), SPI1_BASE + 0x0Cu);
+    mmio_write32(DMA_CMAR(SPI_FLASH_DMA_RX), (uint32_t)g_spi_dma_stub_rx);
+    mmio_write32(DMA_CNDTR(SPI_FLASH_DMA_RX), 0u);
+
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_TX), (mmio_read32(DMA_CCR(SPI_FLASH_DMA_TX)) & ~0x7FF0u) | 0x0510u |
+                                              platform_dma_pl(PLATFORM_DMA_FLASH_TX));
+    mmio_write32(DMA_CPAR(SPI_FLASH_DMA_TX), SPI1_BASE + 0x0Cu);
+    mmio_write32(DMA_CMAR(SPI_FLASH_DMA_TX), (uint32_t)g_spi_dma_stub_tx);
+    mmio_write32(DMA_CNDTR(SPI_FLASH_DMA_TX), 0u);
 
     /* OEM-style: enable SPI DMA requests (CR2 bits 0/1). */
     uint32_t cr2_spi = mmio_read32(SPI1_BASE + 0x04u);
@@ -215,27 +288,26 @@ static uint8_t spi1_txrx_u8_oem(uint8_t b)
     return (uint8_t)mmio_read32(SPI1_BASE + 0x0Cu);
 }
 
-static void spi_flash_dma_to_lcd(uint32_t addr, uint32_t lcd_addr, uint16_t count)
+/* One LCD chunk: READ in the 8-bit command config, then RXONLY + 16-bit
+ * into the FSMC data port. With irq set CH2's IRQ completes it (stop, CS
+ * high, g_spi_dma_rx_done); otherwise the caller polls TCIF2. */
+static void spi_flash_dma_to_lcd_arm(uint32_t addr, uint16_t count, uint8_t irq)
 {
-    if (count == 0u)
-        return;
-
-    spi_flash_hw_init_once();
     g_spi_dma_rx_done = 0u;
 
     spi1_disable();
-    mmio_write32(DMA_CCR(DMA1_CH2_BASE), mmio_read32(DMA_CCR(DMA1_CH2_BASE)) & ~1u);
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) & ~1u);
 
     /* Command phase: 8-bit, no RXONLY/DFF. */
     spi1_apply_cr1(0u);
 
     /* Program DMA RX channel (CH2) for LCD write. */
-    mmio_write32(DMA_CMAR(DMA1_CH2_BASE), lcd_addr);
-    mmio_write32(DMA_CNDTR(DMA1_CH2_BASE), count);
+    mmio_write32(DMA_CMAR(SPI_FLASH_DMA_RX), LCD_DATA_ADDR);
+    mmio_write32(DMA_CNDTR(SPI_FLASH_DMA_RX), count);
 
-    uint32_t ccr = (mmio_read32(DMA_CCR(DMA1_CH2_BASE)) & 0xFFFF800Fu);
-    ccr |= 0x3500u; /* 16-bit sizes + high priority */
-    mmio_write32(DMA_CCR(DMA1_CH2_BASE), ccr);
+    uint32_t ccr = (mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) & 0xFFFF800Fu);
+    ccr |= 0x0500u | platform_dma_pl(PLATFORM_DMA_FLASH_RX); /* 16-bit sizes */
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), ccr);
 
     spi1_enable();
     spi_flash_cs_low();
@@ -250,19 +322,26 @@ static void spi_flash_dma_to_lcd(uint32_t addr, uint32_t lcd_addr, uint16_t coun
     spi1_apply_cr1(0x0C00u); /* RXONLY + DFF (16-bit) */
 
     /* Clear DMA1 CH2 GIF (OEM uses 0x10). */
-    mmio_write32(DMA1_IFCR, 0x10u);
+    platform_dma_clear(PLATFORM_DMA_FLASH_RX);
 
-    /* Enable TCIE then enable CH2. */
-    mmio_write32(DMA_CCR(DMA1_CH2_BASE), mmio_read32(DMA_CCR(DMA1_CH2_BASE)) | 0x2u);
+    if (irq)
+        mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) | 0x2u);
     spi1_enable();
-    mmio_write32(DMA_CCR(DMA1_CH2_BASE), mmio_read32(DMA_CCR(DMA1_CH2_BASE)) | 1u);
+    platform_dma_busy_begin(PLATFORM_DMA_FLASH_RX);
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) | 1u);
+}
 
-    while (!g_spi_dma_rx_done)
+/* Polled completion of a chunk armed without irq: what CH2's IRQ does. */
+static void spi_flash_dma_to_lcd_poll(void)
+{
+    while ((platform_dma_flags(PLATFORM_DMA_FLASH_RX) & PLATFORM_DMA_F_TC) == 0u)
         ;
-
-    /* Restore SPI config (8-bit, no RXONLY). */
-    spi1_apply_cr1(0u);
-    spi1_enable();
+    platform_dma_clear(PLATFORM_DMA_FLASH_RX);
+    spi1_disable();
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) & ~3u);
+    spi_flash_cs_high();
+    platform_dma_busy_end(PLATFORM_DMA_FLASH_RX);
+    g_spi_dma_rx_done = 1u;
 }
 
 static void spi_flash_write_enable(void)
@@ -283,58 +362,667 @@ static uint8_t spi_flash_read_sr1(void)
 
 static void spi_flash_wait_ready(uint32_t timeout_ms)
 {
-    uint32_t start = g_ms;
+    /* Erase/program can take hundreds of ms: wait under a watchdog budget. */
+    uint32_t t0 = platform_cycles_now();
+    watchdog_budget_t budget;
+    watchdog_budget_begin(&budget, timeout_ms * 1000u);
     for (;;)
     {
         platform_time_poll_1ms();
         uint8_t sr = spi_flash_read_sr1();
         if ((sr & 0x01u) == 0u) /* WIP cleared */
-            return;
-        if (timeout_ms && (uint32_t)(g_ms - start) >= timeout_ms)
-            return;
+            break;
+        if (!watchdog_budget_poll(&budget))
+            break;
     }
+    flash_health_note_block(g_spi_flash_op_addr, platform_cycles_to_us(platform_cycles_now() - t0));
 }
 
-static void spi_flash_page_program(uint32_t addr, const uint8_t *data, uint32_t len)
+static void spi_flash_op_begin(uint32_t addr)
 {
-    if (!data || len == 0 || len > SPI_FLASH_PAGE_SIZE)
+    g_spi_flash_op_addr = addr;
+    g_spi_flash_op_cycles = platform_cycles_now();
+}
+
+/* Busy time runs to when the op is seen done, so it includes the polling
+ * interval of a background op. */
+static void spi_flash_op_charge(void)
+{
+    flash_health_note_busy(g_spi_flash_op_addr, platform_cycles_to_us(platform_cycles_now() - g_spi_flash_op_cycles));
+}
+
+static void spi_flash_op_done(void)
+{
+    g_spi_flash_op = SPI_FLASH_OP_NONE;
+    spi_flash_op_charge();
+}
+
+static void spi_flash_cache_drop(uint32_t addr, uint32_t len);
+
+/* Page-program data phase. Bytes go out by CH3 at the SPI clock instead of
+ * one TXE/RXNE poll per byte; RX is not drained (OVR), so the tail clears
+ * it before the next polled command. */
+#define SPI_FLASH_TX_CPU 0u
+#define SPI_FLASH_TX_DMA_POLL 1u
+#define SPI_FLASH_TX_DMA_IRQ 2u
+
+/* A CH3 data phase started with SPI_FLASH_TX_DMA_IRQ; complete once
+ * platform/irq_dma.c has waited out BSY and raised CS. */
+static volatile uint8_t g_spi_flash_tx_armed;
+
+static void spi_flash_tx_dma_arm(const uint8_t *data, uint32_t len, uint8_t irq)
+{
+    g_spi_dma_tx_done = 0u;
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_TX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_TX)) & ~1u);
+    mmio_write32(DMA_CMAR(SPI_FLASH_DMA_TX), (uint32_t)data);
+    mmio_write32(DMA_CNDTR(SPI_FLASH_DMA_TX), len);
+    uint32_t ccr = (mmio_read32(DMA_CCR(SPI_FLASH_DMA_TX)) & 0xFFFF800Fu);
+    ccr |= 0x0090u | platform_dma_pl(PLATFORM_DMA_FLASH_TX); /* 8-bit sizes, MINC, mem->periph */
+    if (irq)
+        ccr |= 0x2u;
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_TX), ccr);
+    platform_dma_clear(PLATFORM_DMA_FLASH_TX);
+    platform_dma_busy_begin(PLATFORM_DMA_FLASH_TX);
+    /* TXE is already set: the first byte goes out on EN. */
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_TX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_TX)) | 1u);
+}
+
+/* Stops CH3, lets the last byte shift out and raises CS. */
+static void spi_flash_tx_dma_stop(void)
+{
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_TX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_TX)) & ~3u);
+    for (uint32_t i = 0; i < 2000u; ++i)
+    {
+        if ((mmio_read32(SPI1_BASE + 0x08u) & 0x80u) == 0u) /* BSY */
+            break;
+    }
+    spi_flash_cs_high();
+    platform_dma_busy_end(PLATFORM_DMA_FLASH_TX);
+}
+
+/* Drops the unread RX byte; DR then SR clears OVR. */
+static void spi_flash_tx_rx_flush(void)
+{
+    (void)mmio_read32(SPI1_BASE + 0x0Cu);
+    (void)mmio_read32(SPI1_BASE + 0x08u);
+}
+
+/* Bus users wait out an IRQ-driven data phase. A completion that never ran
+ * (lost, or the caller is itself a work-queue item) is done here. */
+static void spi_flash_tx_drain(void)
+{
+    if (!g_spi_flash_tx_armed)
         return;
+    uint32_t spin = 0u;
+    while (!g_spi_dma_tx_done)
+    {
+        if (++spin > SPI_FLASH_DMA_SPIN_MAX)
+            break;
+    }
+    if (!g_spi_dma_tx_done)
+    {
+        uint32_t primask = irq_save();
+        if (!g_spi_dma_tx_done)
+            spi_flash_tx_dma_stop();
+        irq_restore(primask);
+    }
+    spi_flash_tx_rx_flush();
+    g_spi_flash_tx_armed = 0u;
+}
+
+static void spi_flash_page_program_issue(uint32_t addr, const uint8_t *data, uint32_t len, uint8_t mode)
+{
+    spi_flash_cache_drop(addr, len);
+    flash_health_note_program(addr);
     spi_flash_write_enable();
     spi_flash_cs_low();
     (void)spi1_txrx_u8(0x02u); /* PP */
     (void)spi1_txrx_u8((uint8_t)(addr >> 16));
     (void)spi1_txrx_u8((uint8_t)(addr >> 8));
     (void)spi1_txrx_u8((uint8_t)(addr));
-    for (uint32_t i = 0; i < len; ++i)
-        (void)spi1_txrx_u8(data[i]);
-    spi_flash_cs_high();
+    if (len < SPI_FLASH_DMA_MIN_BYTES)
+        mode = SPI_FLASH_TX_CPU;
+    if (mode == SPI_FLASH_TX_CPU)
+    {
+        for (uint32_t i = 0; i < len; ++i)
+            (void)spi1_txrx_u8(data[i]);
+        spi_flash_cs_high();
+        return;
+    }
+    if (mode == SPI_FLASH_TX_DMA_IRQ)
+    {
+        g_spi_flash_tx_armed = 1u;
+        spi_flash_tx_dma_arm(data, len, 1u);
+        return;
+    }
+    spi_flash_tx_dma_arm(data, len, 0u);
+    uint32_t spin = 0u;
+    while ((platform_dma_flags(PLATFORM_DMA_FLASH_TX) & PLATFORM_DMA_F_TC) == 0u)
+    {
+        if (++spin > SPI_FLASH_DMA_SPIN_MAX)
+            break;
+    }
+    platform_dma_clear(PLATFORM_DMA_FLASH_TX);
+    spi_flash_tx_dma_stop();
+    spi_flash_tx_rx_flush();
+}
+
+/* Blocking callers first drain anything a *_start call left in flight. */
+static void spi_flash_settle(void)
+{
+    spi_flash_tx_drain();
+    if (g_spi_flash_op == SPI_FLASH_OP_NONE)
+        return;
     spi_flash_wait_ready(2000u);
+    spi_flash_op_done();
 }
 
-void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+static void spi_flash_page_program(uint32_t addr, const uint8_t *data, uint32_t len)
 {
-    if (!out || len == 0)
+    if (!data || len == 0 || len > SPI_FLASH_PAGE_SIZE)
         return;
-    spi_flash_hw_init_once();
+    spi_flash_settle();
+    spi_flash_op_begin(addr);
+    spi_flash_page_program_issue(addr, data, len, SPI_FLASH_TX_DMA_POLL);
+    spi_flash_wait_ready(2000u);
+    spi_flash_op_charge();
+}
+
+static uint8_t spi_flash_read_sr2(void)
+{
+    spi_flash_cs_low();
+    (void)spi1_txrx_u8(0x35u); /* RDSR2 */
+    uint8_t v = spi1_txrx_u8(0x00u);
+    spi_flash_cs_high();
+    return v;
+}
+
+static void spi_flash_cmd(uint8_t cmd)
+{
     spi_flash_cs_low();
-    (void)spi1_txrx_u8_oem(0x03u); /* READ */
+    (void)spi1_txrx_u8(cmd);
+    spi_flash_cs_high();
+}
+
+/*
+ * Reads that land while a background op is running: suspend an erase for the
+ * read (returns 1 so the caller resumes), or wait out a page program (<= 3 ms).
+ */
+static uint8_t spi_flash_read_begin(void)
+{
+    if (g_spi_flash_op == SPI_FLASH_OP_NONE)
+        return 0u;
+    if ((spi_flash_read_sr1() & 0x01u) == 0u)
+    {
+        spi_flash_op_done();
+        return 0u;
+    }
+    if (g_spi_flash_op != SPI_FLASH_OP_ERASE)
+    {
+        spi_flash_settle();
+        return 0u;
+    }
+    spi_flash_cmd(SPI_FLASH_CMD_SUSPEND);
+    for (uint32_t i = 0; i < 2000u; ++i)
+    {
+        if ((spi_flash_read_sr1() & 0x01u) == 0u)
+            break;
+    }
+    /* Erase may have finished before the suspend took effect. */
+    if ((spi_flash_read_sr2() & SPI_FLASH_SR2_SUS) == 0u)
+    {
+        spi_flash_op_done();
+        return 0u;
+    }
+    return 1u;
+}
+
+static void spi_flash_read_end(uint8_t suspended)
+{
+    if (suspended)
+        spi_flash_cmd(SPI_FLASH_CMD_RESUME);
+}
+
+static void spi_flash_fast_read_cmd(uint32_t addr)
+{
+    (void)spi1_txrx_u8_oem(0x0Bu); /* FAST_READ */
     (void)spi1_txrx_u8_oem((uint8_t)(addr >> 16));
     (void)spi1_txrx_u8_oem((uint8_t)(addr >> 8));
     (void)spi1_txrx_u8_oem((uint8_t)(addr));
+    (void)spi1_txrx_u8_oem(0x00u); /* dummy */
+}
+
+static void spi_flash_read_polled(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    spi_flash_cs_low();
+    spi_flash_fast_read_cmd(addr);
     for (uint32_t i = 0; i < len; ++i)
         out[i] = spi1_txrx_u8_oem(0x00u);
     spi_flash_cs_high();
 }
 
-void spi_flash_read_dma_to_lcd(uint32_t addr, uint32_t lcd_addr, uint16_t count)
+/* Same RXONLY + CH2 sequence as the LCD path, into RAM with byte sizes; the
+ * CH2 IRQ stops SPI1 and raises CS on completion. */
+static void spi_flash_read_dma_arm(uint32_t addr, uint8_t *out, uint16_t count)
 {
-    spi_flash_dma_to_lcd(addr, lcd_addr, count);
+    g_spi_dma_rx_done = 0u;
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) & ~1u);
+    mmio_write32(DMA_CMAR(SPI_FLASH_DMA_RX), (uint32_t)out);
+    mmio_write32(DMA_CNDTR(SPI_FLASH_DMA_RX), count);
+    uint32_t ccr = (mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) & 0xFFFF800Fu);
+    ccr |= 0x0080u | platform_dma_pl(PLATFORM_DMA_FLASH_RX); /* 8-bit sizes, MINC */
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), ccr);
+
+    spi1_enable();
+    spi_flash_cs_low();
+    spi_flash_fast_read_cmd(addr);
+    (void)mmio_read32(SPI1_BASE + 0x0Cu); /* Clear RXNE. */
+
+    spi1_disable();
+    spi1_apply_cr1(0x0400u); /* RXONLY, 8-bit */
+    spi1_set_br(g_spi_flash_read_br);
+    platform_dma_clear(PLATFORM_DMA_FLASH_RX);
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) | 0x2u);
+    /* Arm the channel before SPE: RXONLY starts clocking immediately and a
+     * byte at PCLK/2 is only ~16 core cycles. */
+    platform_dma_busy_begin(PLATFORM_DMA_FLASH_RX);
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) | 1u);
+    spi1_enable();
 }
 
-void spi_flash_erase_4k(uint32_t addr)
+/* Tears down a transfer whose completion never arrived, then restores the
+ * command config (8-bit, full duplex, OEM baud). */
+static void spi_flash_read_dma_finish(void)
+{
+    if (!g_spi_dma_rx_done)
+    {
+        spi1_disable();
+        mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) & ~3u);
+        spi_flash_cs_high();
+        platform_dma_busy_end(PLATFORM_DMA_FLASH_RX);
+    }
+    spi1_disable();
+    spi1_apply_cr1(0u);
+    spi1_enable();
+}
+
+static int spi_flash_read_dma_chunk(uint32_t addr, uint8_t *out, uint16_t count)
+{
+    spi_flash_read_dma_arm(addr, out, count);
+    uint32_t spin = 0u;
+    while (!g_spi_dma_rx_done)
+    {
+        if (++spin > SPI_FLASH_DMA_SPIN_MAX)
+            break;
+    }
+    spi_flash_read_dma_finish();
+    return g_spi_dma_rx_done ? 1 : 0;
+}
+
+/* Background read started by spi_flash_read_async_start. */
+static struct {
+    uint8_t active;
+    uint8_t suspended;
+    uint16_t len;
+    uint32_t addr;
+    uint8_t *out;
+    uint32_t start_ms;
+} g_spi_flash_async;
+
+/* Completes the background read; a lost completion falls back to polling. */
+static void spi_flash_async_complete(void)
+{
+    uint8_t ok = g_spi_dma_rx_done;
+    spi_flash_read_dma_finish();
+    if (!ok)
+        spi_flash_read_polled(g_spi_flash_async.addr, g_spi_flash_async.out, g_spi_flash_async.len);
+    spi_flash_read_end(g_spi_flash_async.suspended);
+    g_spi_flash_async.active = 0u;
+}
+
+/* LCD blit started by spi_flash_lcd_blit_start: `runs` runs of run_px
+ * pixels, stride bytes apart; the CH2 IRQ arms each next chunk. */
+static struct {
+    volatile uint8_t active;
+    uint8_t suspended;
+    uint8_t irq;
+    uint16_t runs_left;    /* runs after the current one */
+    uint32_t run_px;
+    uint32_t stride;
+    uint32_t run_addr;
+    uint32_t addr;         /* next chunk */
+    uint32_t left;         /* pixels of the current run not yet armed */
+    volatile uint32_t chunk_ms;
+    spi_flash_blit_done_fn done;
+    void *ctx;
+} g_spi_flash_blit;
+
+/* Arms the next chunk; 0 when the whole blit is out. */
+static uint8_t spi_flash_blit_next(void)
+{
+    if (g_spi_flash_blit.left == 0u)
+    {
+        if (g_spi_flash_blit.runs_left == 0u)
+            return 0u;
+        g_spi_flash_blit.runs_left--;
+        g_spi_flash_blit.run_addr += g_spi_flash_blit.stride;
+        g_spi_flash_blit.addr = g_spi_flash_blit.run_addr;
+        g_spi_flash_blit.left = g_spi_flash_blit.run_px;
+    }
+    uint32_t n = g_spi_flash_blit.left;
+    if (n > SPI_FLASH_LCD_CHUNK_PX)
+        n = SPI_FLASH_LCD_CHUNK_PX;
+    uint32_t addr = g_spi_flash_blit.addr;
+    g_spi_flash_blit.addr += n * 2u;
+    g_spi_flash_blit.left -= n;
+    g_spi_flash_blit.chunk_ms = g_ms;
+    flash_health_note_read(addr, n * 2u);
+    spi_flash_dma_to_lcd_arm(addr, (uint16_t)n, g_spi_flash_blit.irq);
+    return 1u;
+}
+
+/* Back to the command config; the callback runs at work-queue level when
+ * this is the CH2 IRQ. */
+static void spi_flash_blit_finish(void)
+{
+    spi1_apply_cr1(0u);
+    spi1_enable();
+    spi_flash_read_end(g_spi_flash_blit.suspended);
+    spi_flash_blit_done_fn done = g_spi_flash_blit.done;
+    void *ctx = g_spi_flash_blit.ctx;
+    g_spi_flash_blit.active = 0u;
+    if (!done)
+        return;
+    if (!g_spi_flash_blit.irq || !work_queue_post(done, ctx))
+        done(ctx);
+}
+
+/* CH2 completion hook (platform/irq_dma.c). */
+static uint8_t spi_flash_blit_chain(void)
+{
+    if (!g_spi_flash_blit.active)
+        return 0u;
+    if (spi_flash_blit_next())
+        return 1u;
+    spi_flash_blit_finish();
+    return 0u;
+}
+
+static void spi_flash_blit_drain(void)
+{
+    while (g_spi_flash_blit.active)
+    {
+        if ((uint32_t)(g_ms - g_spi_flash_blit.chunk_ms) < SPI_FLASH_BLIT_TIMEOUT_MS)
+            continue;
+        /* Lost completion: cut the chunk; the window keeps what it got. */
+        uint32_t primask = irq_save();
+        if (g_spi_flash_blit.active)
+        {
+            spi1_disable();
+            mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) & ~3u);
+            spi_flash_cs_high();
+            platform_dma_busy_end(PLATFORM_DMA_FLASH_RX);
+            g_spi_flash_blit.left = 0u;
+            g_spi_flash_blit.runs_left = 0u;
+            spi_flash_blit_finish();
+        }
+        irq_restore(primask);
+    }
+}
+
+/* Every bus user waits out a background read, LCD blit or program data
+ * phase first. */
+static void spi_flash_async_drain(void)
+{
+    spi_flash_tx_drain();
+    spi_flash_blit_drain();
+    if (!g_spi_flash_async.active)
+        return;
+    uint32_t spin = 0u;
+    while (!g_spi_dma_rx_done)
+    {
+        if (++spin > SPI_FLASH_DMA_SPIN_MAX)
+            break;
+    }
+    spi_flash_async_complete();
+}
+
+static void spi_flash_enter(void)
 {
     spi_flash_hw_init_once();
+    spi_flash_async_drain();
+}
+
+static void spi_flash_read_uncached(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    spi_flash_enter();
+    flash_health_note_read(addr, len);
+    uint8_t suspended = spi_flash_read_begin();
+
+    /* DMA completion needs the CH2 IRQ: thread mode with interrupts on only
+     * (crash/fault paths and short reads stay polled). */
+    if (len < SPI_FLASH_DMA_MIN_BYTES || !cpu_irqs_available())
+    {
+        spi_flash_read_polled(addr, out, len);
+        spi_flash_read_end(suspended);
+        return;
+    }
+
+    while (len)
+    {
+        uint16_t n = (len > SPI_FLASH_DMA_MAX_CHUNK) ? (uint16_t)SPI_FLASH_DMA_MAX_CHUNK : (uint16_t)len;
+        if (!spi_flash_read_dma_chunk(addr, out, n))
+            spi_flash_read_polled(addr, out, n);
+        addr += n;
+        out += n;
+        len -= n;
+    }
+    spi_flash_read_end(suspended);
+}
+
+static void spi_flash_cache_init_once(void)
+{
+    if (g_spi_flash_cache.ready)
+        return;
+    for (uint32_t i = 0; i < SPI_FLASH_CACHE_LINES; ++i)
+        g_spi_flash_cache.lines[i].page = SPI_FLASH_CACHE_EMPTY;
+    g_spi_flash_cache.ready = 1u;
+}
+
+/* Called before any program or erase reaches the chip. */
+static void spi_flash_cache_drop(uint32_t addr, uint32_t len)
+{
+    spi_flash_cache_init_once();
+    uint32_t first = addr & ~(SPI_FLASH_PAGE_SIZE - 1u);
+    uint32_t last = (addr + len - 1u) & ~(SPI_FLASH_PAGE_SIZE - 1u);
+    for (uint32_t i = 0; i < SPI_FLASH_CACHE_LINES; ++i)
+    {
+        spi_flash_cache_line_t *l = &g_spi_flash_cache.lines[i];
+        if (l->page != SPI_FLASH_CACHE_EMPTY && l->page >= first && l->page <= last)
+        {
+            l->page = SPI_FLASH_CACHE_EMPTY;
+            g_spi_flash_cache.stats.invalidations++;
+        }
+    }
+}
+
+static const uint8_t *spi_flash_cache_page(uint32_t page)
+{
+    spi_flash_cache_line_t *victim = &g_spi_flash_cache.lines[0];
+    for (uint32_t i = 0; i < SPI_FLASH_CACHE_LINES; ++i)
+    {
+        spi_flash_cache_line_t *l = &g_spi_flash_cache.lines[i];
+        if (l->page == page)
+        {
+            l->used = ++g_spi_flash_cache.clock;
+            g_spi_flash_cache.stats.hits++;
+            return g_spi_flash_cache_data[i];
+        }
+        if (l->page == SPI_FLASH_CACHE_EMPTY)
+        {
+            if (victim->page != SPI_FLASH_CACHE_EMPTY)
+                victim = l;
+        }
+        else if (victim->page != SPI_FLASH_CACHE_EMPTY && l->used < victim->used)
+        {
+            victim = l;
+        }
+    }
+    g_spi_flash_cache.stats.misses++;
+    /* Data read while an erase is suspended or a program is pending may be
+     * about to change; serve it but do not keep it. */
+    if (g_spi_flash_op != SPI_FLASH_OP_NONE)
+        return NULL;
+    uint8_t *data = g_spi_flash_cache_data[victim - g_spi_flash_cache.lines];
+    spi_flash_read_uncached(page, data, SPI_FLASH_PAGE_SIZE);
+    victim->page = page;
+    victim->used = ++g_spi_flash_cache.clock;
+    return data;
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    if (!out || len == 0)
+        return;
+    if (len > SPI_FLASH_CACHE_MAX_READ)
+    {
+        spi_flash_read_uncached(addr, out, len);
+        return;
+    }
+    spi_flash_cache_init_once();
+    while (len)
+    {
+        uint32_t page = addr & ~(SPI_FLASH_PAGE_SIZE - 1u);
+        uint32_t off = addr - page;
+        uint32_t n = SPI_FLASH_PAGE_SIZE - off;
+        if (n > len)
+            n = len;
+        const uint8_t *line = spi_flash_cache_page(page);
+        if (line)
+        {
+            for (uint32_t i = 0; i < n; ++i)
+                out[i] = line[off + i];
+        }
+        else
+        {
+            spi_flash_read_uncached(addr, out, n);
+        }
+        addr += n;
+        out += n;
+        len -= n;
+    }
+}
+
+uint8_t spi_flash_read_async_start(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    if (!out || len == 0 || len > SPI_FLASH_DMA_MAX_CHUNK)
+        return 0u;
+    spi_flash_enter();
+    if (len < SPI_FLASH_DMA_MIN_BYTES || !cpu_irqs_available())
+    {
+        spi_flash_read_uncached(addr, out, len);
+        return 1u;
+    }
+    g_spi_flash_async.suspended = spi_flash_read_begin();
+    g_spi_flash_async.addr = addr;
+    g_spi_flash_async.out = out;
+    g_spi_flash_async.len = (uint16_t)len;
+    g_spi_flash_async.start_ms = g_ms;
+    g_spi_flash_async.active = 1u;
+    flash_health_note_read(addr, len);
+    spi_flash_read_dma_arm(addr, out, (uint16_t)len);
+    return 1u;
+}
+
+uint8_t spi_flash_read_async_poll(void)
+{
+    if (!g_spi_flash_async.active)
+        return 1u;
+    if (!g_spi_dma_rx_done && (uint32_t)(g_ms - g_spi_flash_async.start_ms) < SPI_FLASH_ASYNC_TIMEOUT_MS)
+        return 0u;
+    spi_flash_async_complete();
+    return 1u;
+}
+
+void spi_flash_cache_get_stats(spi_flash_cache_stats_t *out)
+{
+    if (out)
+        *out = g_spi_flash_cache.stats;
+}
+
+void spi_flash_cache_invalidate(void)
+{
+    spi_flash_cache_init_once();
+    spi_flash_cache_drop(0u, 0xFFFFFFFFu);
+}
+
+void spi_flash_lcd_blit_start(uint32_t addr, uint32_t run_px, uint16_t runs, uint32_t stride,
+                              spi_flash_blit_done_fn done, void *ctx)
+{
+    spi_flash_enter();
+    if (run_px == 0u || runs == 0u)
+    {
+        if (done)
+            done(ctx);
+        return;
+    }
+    g_spi_flash_blit.suspended = spi_flash_read_begin();
+    g_spi_flash_blit.irq = cpu_irqs_available() ? 1u : 0u;
+    g_spi_flash_blit.runs_left = (uint16_t)(runs - 1u);
+    g_spi_flash_blit.run_px = run_px;
+    g_spi_flash_blit.stride = stride;
+    g_spi_flash_blit.run_addr = addr;
+    g_spi_flash_blit.addr = addr;
+    g_spi_flash_blit.left = run_px;
+    g_spi_flash_blit.done = done;
+    g_spi_flash_blit.ctx = ctx;
+    g_spi_flash_blit.active = 1u;
+    if (g_spi_flash_blit.irq)
+    {
+        (void)spi_flash_blit_next();
+        return;
+    }
+    /* Early boot (boot splash) runs with interrupts off: poll each chunk. */
+    while (spi_flash_blit_next())
+        spi_flash_dma_to_lcd_poll();
+    spi_flash_blit_finish();
+}
+
+uint8_t spi_flash_lcd_blit_busy(void)
+{
+    return g_spi_flash_blit.active;
+}
+
+void spi_flash_lcd_blit_wait(void)
+{
+    spi_flash_blit_drain();
+}
+
+uint8_t spi_flash_busy(void)
+{
+    if (g_spi_flash_op == SPI_FLASH_OP_NONE)
+        return 0u;
+    /* Still clocking the page out: busy without touching the bus. */
+    if (g_spi_flash_tx_armed && !g_spi_dma_tx_done)
+        return 1u;
+    spi_flash_async_drain();
+    if (spi_flash_read_sr1() & 0x01u)
+        return 1u;
+    spi_flash_op_done();
+    return 0u;
+}
+
+void spi_flash_erase_4k_start(uint32_t addr)
+{
+    spi_flash_enter();
+    spi_flash_settle();
     uint32_t sector = addr & ~(SPI_FLASH_SECTOR_SIZE - 1u);
+    spi_flash_cache_drop(sector, SPI_FLASH_SECTOR_SIZE);
+    /* Marked before the command: the urgent path must see a busy chip as
+     * an erase it can suspend. */
+    g_spi_flash_op = SPI_FLASH_OP_ERASE;
+    spi_flash_op_begin(sector);
+    flash_health_note_erase(sector);
     spi_flash_write_enable();
     spi_flash_cs_low();
     (void)spi1_txrx_u8(0x20u); /* SE (4K) */
@@ -342,14 +1030,35 @@ void spi_flash_erase_4k(uint32_t addr)
     (void)spi1_txrx_u8((uint8_t)(sector >> 8));
     (void)spi1_txrx_u8((uint8_t)(sector));
     spi_flash_cs_high();
-    spi_flash_wait_ready(2000u);
+}
+
+void spi_flash_page_program_start(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if (!data || len == 0)
+        return;
+    /* One page per call; the chip wraps within a page otherwise. */
+    uint32_t room = SPI_FLASH_PAGE_SIZE - (addr & (SPI_FLASH_PAGE_SIZE - 1u));
+    if (len > room)
+        len = room;
+    spi_flash_enter();
+    spi_flash_settle();
+    g_spi_flash_op = SPI_FLASH_OP_PROGRAM;
+    spi_flash_op_begin(addr);
+    spi_flash_page_program_issue(addr, data, len,
+                                 cpu_irqs_available() ? SPI_FLASH_TX_DMA_IRQ : SPI_FLASH_TX_DMA_POLL);
+}
+
+void spi_flash_erase_4k(uint32_t addr)
+{
+    spi_flash_erase_4k_start(addr);
+    spi_flash_settle();
 }
 
 void spi_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
 {
     if (!data || len == 0)
         return;
-    spi_flash_hw_init_once();
+    spi_flash_enter();
 
     uint32_t cur = addr;
     uint32_t remaining = len;
@@ -367,13 +1076,117 @@ void spi_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
     }
 }
 
-static uint8_t g_spi_flash_sector_buf[SPI_FLASH_SECTOR_SIZE] __attribute__((aligned(4)));
+/* Urgent path spin bound in SR1 polls (a few us each): a page program is
+ * <= 3 ms, an erase suspend <= 20 us. */
+#define SPI_FLASH_URGENT_POLLS 4000u
+
+static uint8_t spi_flash_urgent_wait(void)
+{
+    for (uint32_t i = 0; i < SPI_FLASH_URGENT_POLLS; ++i)
+    {
+        if ((spi_flash_read_sr1() & 0x01u) == 0u)
+            return 1u;
+    }
+    return 0u;
+}
+
+/* Cuts whatever transfer was on the wire (polled, RX DMA to RAM or the
+ * LCD, TX DMA of a page) and goes back to the command config. */
+static void spi_flash_urgent_takeover(void)
+{
+    spi1_disable();
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_RX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_RX)) & ~3u);
+    mmio_write32(DMA_CCR(SPI_FLASH_DMA_TX), mmio_read32(DMA_CCR(SPI_FLASH_DMA_TX)) & ~3u);
+    spi_flash_cs_high();
+    spi1_apply_cr1(0u);
+    spi1_enable();
+    (void)mmio_read32(SPI1_BASE + 0x0Cu); /* Clear RXNE. */
+    g_spi_flash_async.active = 0u;
+    g_spi_flash_blit.active = 0u;
+    g_spi_flash_tx_armed = 0u;
+}
+
+uint8_t spi_flash_urgent_begin(void)
+{
+    if (!spi_flash_hw_inited)
+        return 0u;
+    spi_flash_urgent_takeover();
+    if ((spi_flash_read_sr1() & 0x01u) == 0u)
+        return 1u;
+    if (g_spi_flash_op != SPI_FLASH_OP_ERASE)
+        return spi_flash_urgent_wait();
+    /* Page programs are allowed outside the suspended sector, which
+     * storage/power_fail.c never writes into. */
+    spi_flash_cmd(SPI_FLASH_CMD_SUSPEND);
+    return spi_flash_urgent_wait();
+}
+
+void spi_flash_urgent_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    while (len)
+    {
+        uint32_t room = SPI_FLASH_PAGE_SIZE - (addr & (SPI_FLASH_PAGE_SIZE - 1u));
+        uint32_t n = len < room ? len : room;
+        spi_flash_page_program_issue(addr, data, n, SPI_FLASH_TX_CPU);
+        if (!spi_flash_urgent_wait())
+            return;
+        addr += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/* The suspend may also be a preempted read's; SUS survives a reset. */
+void spi_flash_urgent_end(void)
+{
+    if (!spi_flash_hw_inited)
+        return;
+    spi_flash_urgent_takeover();
+    if (spi_flash_read_sr2() & SPI_FLASH_SR2_SUS)
+        spi_flash_cmd(SPI_FLASH_CMD_RESUME);
+}
+
+_Static_assert(SPI_FLASH_SECTOR_SIZE <= OVERLAY_ARENA_BYTES, "sector copy does not fit the overlay arena");
+
+/* Programs [off, off+len) of the sector from src, skipping bytes that already
+ * match so untouched pages are never reissued. */
+static void spi_flash_program_diff(uint32_t sector, uint32_t off, uint32_t len,
+                                   const uint8_t *src, const uint8_t *cur)
+{
+    uint32_t i = 0;
+    while (i < len)
+    {
+        if (src[i] == cur[i])
+        {
+            i++;
+            continue;
+        }
+        /* Differing run, clipped to the page it starts in. */
+        uint32_t start = i;
+        uint32_t page_end = ((off + start) | (SPI_FLASH_PAGE_SIZE - 1u)) + 1u - off;
+        uint32_t end = start;
+        uint32_t last = start;
+        while (end < len && end < page_end)
+        {
+            if (src[end] != cur[end])
+                last = end;
+            end++;
+        }
+        spi_flash_page_program(sector + off + start, &src[start], last - start + 1u);
+        i = end;
+    }
+}
 
 void spi_flash_update_bytes(uint32_t addr, const uint8_t *data, uint32_t len)
 {
     if (!data || len == 0)
         return;
 
+    /* The sector copy lives in the overlay arena for the whole update. */
+    uint8_t *buf = platform_overlay_lease(OVERLAY_OWNER_FLASH_RMW, SPI_FLASH_SECTOR_SIZE);
+    if (!buf)
+        return;
+
     uint32_t cur = addr;
     uint32_t remaining = len;
     const uint8_t *p = data;
@@ -386,24 +1199,56 @@ void spi_flash_update_bytes(uint32_t addr, const uint8_t *data, uint32_t len)
         if (chunk > remaining)
             chunk = remaining;
 
-        spi_flash_read(sector, g_spi_flash_sector_buf, SPI_FLASH_SECTOR_SIZE);
+        /* Only the target span first: most updates need no erase. */
+        spi_flash_read(cur, &buf[off], chunk);
+        uint8_t same = 1u;
+        uint8_t programmable = 1u;
         for (uint32_t i = 0; i < chunk; ++i)
-            g_spi_flash_sector_buf[off + i] = p[i];
+        {
+            uint8_t old = buf[off + i];
+            if (old != p[i])
+                same = 0u;
+            /* NOR programs 1->0 only. */
+            if ((old & p[i]) != p[i])
+                programmable = 0u;
+        }
 
-        spi_flash_erase_4k(sector);
-        for (uint32_t page = 0; page < SPI_FLASH_SECTOR_SIZE; page += SPI_FLASH_PAGE_SIZE)
-            spi_flash_page_program(sector + page, &g_spi_flash_sector_buf[page], SPI_FLASH_PAGE_SIZE);
+        if (!same && programmable)
+        {
+            spi_flash_program_diff(sector, off, chunk, p, &buf[off]);
+        }
+        else if (!same)
+        {
+            if (off)
+                spi_flash_read(sector, buf, off);
+            if (off + chunk < SPI_FLASH_SECTOR_SIZE)
+                spi_flash_read(cur + chunk, &buf[off + chunk], SPI_FLASH_SECTOR_SIZE - off - chunk);
+            for (uint32_t i = 0; i < chunk; ++i)
+                buf[off + i] = p[i];
+
+            spi_flash_erase_4k(sector);
+            /* Erased pages are already 0xFF; only pages holding data are reprogrammed. */
+            for (uint32_t page = 0; page < SPI_FLASH_SECTOR_SIZE; page += SPI_FLASH_PAGE_SIZE)
+            {
+                uint8_t blank = 1u;
+                for (uint32_t i = 0; i < SPI_FLASH_PAGE_SIZE && blank; ++i)
+                    blank = (buf[page + i] == 0xFFu);
+                if (!blank)
+                    spi_flash_page_program(sector + page, &buf[page], SPI_FLASH_PAGE_SIZE);
+            }
+        }
 
         cur += chunk;
         p += chunk;
         remaining -= chunk;
     }
+    platform_overlay_release(OVERLAY_OWNER_FLASH_RMW);
 }
 
 void spi_flash_set_bootloader_mode_flag(void)
 {
     spi_flash_stage_mark(0xB200);
-    spi_flash_hw_init_once();
+    spi_flash_enter();
     /*
      * OEM bootloader checks only byte[0] at 0x3FF080 == 0xAA. Avoid erasing
      * the sector; a single-byte program is enough when the byte is 0xFF/0xAA.
@@ -6,12 +6,77 @@
 #define SPI_FLASH_SECTOR_SIZE   0x1000u
 #define SPI_FLASH_PAGE_SIZE     256u
 
+/* Reads of up to 64 bytes are served from a small LRU cache of 256-byte
+ * pages; programs and erases invalidate the pages they touch. */
 void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len);
-void spi_flash_read_dma_to_lcd(uint32_t addr, uint32_t lcd_addr, uint16_t count);
 void spi_flash_erase_4k(uint32_t addr);
 void spi_flash_write(uint32_t addr, const uint8_t *data, uint32_t len);
 void spi_flash_update_bytes(uint32_t addr, const uint8_t *data, uint32_t len);
 
+/*
+ * Non-blocking primitives for storage/flash_jobs.c: issue the command and
+ * return; poll spi_flash_busy() for completion. The blocking calls above wait
+ * for any op left in flight, and reads suspend a running sector erase.
+ */
+#define SPI_FLASH_OP_NONE    0u
+#define SPI_FLASH_OP_ERASE   1u
+#define SPI_FLASH_OP_PROGRAM 2u
+
+uint8_t spi_flash_busy(void);
+void spi_flash_erase_4k_start(uint32_t addr);
+/* Programs at most up to the end of the page containing addr. The data
+ * goes out by DMA: it must stay untouched until spi_flash_busy() is 0. */
+void spi_flash_page_program_start(uint32_t addr, const uint8_t *data, uint32_t len);
+
+/*
+ * Brown-out path (storage/power_fail.c), for an interrupt that never returns
+ * to the code it preempted. urgent_begin takes SPI1 over mid-transfer,
+ * suspends a running erase or waits out a page program, and returns 0 if the
+ * flash was never brought up or stays busy. urgent_program then writes
+ * erased pages with bounded spins (no tick, no watchdog budget).
+ * urgent_end takes the bus the same way and resumes a suspended erase, for
+ * a reset after the supply came back.
+ */
+uint8_t spi_flash_urgent_begin(void);
+void spi_flash_urgent_program(uint32_t addr, const uint8_t *data, uint32_t len);
+void spi_flash_urgent_end(void);
+
+/* Background DMA read for long sequential consumers (image verify). Returns 0
+ * if the arguments are unusable; short reads, or reads with interrupts off,
+ * complete before return. Any other flash call waits for the transfer, and
+ * `out` must stay untouched until spi_flash_read_async_poll() returns 1. */
+uint8_t spi_flash_read_async_start(uint32_t addr, uint8_t *out, uint32_t len);
+uint8_t spi_flash_read_async_poll(void);
+
+/*
+ * RGB565 image into the open LCD window by DMA: `runs` runs of run_px
+ * pixels, `stride` bytes apart in flash, streamed back to back into
+ * LCD_DATA_ADDR. Returns once the first chunk is on the wire; the CH2 IRQ
+ * chains the rest. done (optional) runs from the work queue after the last
+ * pixel. With interrupts off the blit is polled and done runs before
+ * return. Other flash calls wait for the blit, and so must anything that
+ * touches the LCD bus (spi_flash_lcd_blit_wait).
+ */
+typedef void (*spi_flash_blit_done_fn)(void *ctx);
+
+void spi_flash_lcd_blit_start(uint32_t addr, uint32_t run_px, uint16_t runs, uint32_t stride,
+                              spi_flash_blit_done_fn done, void *ctx);
+uint8_t spi_flash_lcd_blit_busy(void);
+void spi_flash_lcd_blit_wait(void);
+
+typedef struct {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t invalidations; /* cached pages dropped by a program or erase */
+} spi_flash_cache_stats_t;
+
+/* Re-pick the read SCK prescaler for the current PCLK2 (clock profile switch);
+ * applies from the next read. */
+void spi_flash_clock_changed(void);
+
+void spi_flash_cache_get_stats(spi_flash_cache_stats_t *out);
+void spi_flash_cache_invalidate(void);
+
 /* OEM bootloader mode flag: if set, bootloader stays in BLE update mode. */
 void spi_flash_set_bootloader_mode_flag(void);
 
@@ -8,6 +8,9 @@
 #define ST7789_CMD_CASET    0x2Au
 #define ST7789_CMD_RASET    0x2Bu
 #define ST7789_CMD_RAMWR    0x2Cu
+#define ST7789_CMD_TEOFF    0x34u
+#define ST7789_CMD_TEON     0x35u
+#define ST7789_CMD_GSCAN    0x45u  /* Get scanline (dummy, hi[1:0], lo). */
 #define ST7789_CMD_PORCTRL  0xB2u  /* Porch setting (back/front porch). */
 #define ST7789_CMD_GCTRL    0xB7u  /* Gate control (VGH/VGL). */
 #define ST7789_CMD_VCOMS    0xBBu  /* VCOMS setting. */
@@ -110,6 +113,26 @@ void st7789_8080_fill_rect(const st7789_8080_bus_t *bus,
         st7789_write_data16(bus, color);
 }
 
+void st7789_8080_set_tearing_effect(const st7789_8080_bus_t *bus, uint8_t enable)
+{
+    const uint8_t mode = 0x00u; /* TE on V-blank only. */
+    if (enable)
+        st7789_write_cmd_data(bus, ST7789_CMD_TEON, &mode, 1u);
+    else
+        st7789_write_cmd(bus, ST7789_CMD_TEOFF);
+}
+
+int32_t st7789_8080_read_scanline(const st7789_8080_bus_t *bus)
+{
+    if (!bus || !bus->read_data)
+        return -1;
+    st7789_write_cmd(bus, ST7789_CMD_GSCAN);
+    (void)bus->read_data(); /* dummy */
+    uint16_t hi = (uint16_t)(bus->read_data() & 0x03u);
+    uint16_t lo = (uint16_t)(bus->read_data() & 0xFFu);
+    return (int32_t)((hi << 8) | lo);
+}
+
 void st7789_8080_init_oem(const st7789_8080_bus_t *bus)
 {
     const uint8_t madctl = 0x00u; /* RGB order, no row/column swap. */
@@ -8,6 +8,7 @@ typedef struct {
     void (*write_data)(uint8_t data);
     void (*write_data16)(uint16_t data);
     void (*delay_ms)(uint32_t ms);
+    uint16_t (*read_data)(void); /* Optional; needed for scanline reads. */
 } st7789_8080_bus_t;
 
 void st7789_8080_init_oem(const st7789_8080_bus_t *bus);
@@ -21,5 +22,9 @@ void st7789_8080_fill_rect(const st7789_8080_bus_t *bus,
                            uint16_t x, uint16_t y,
                            uint16_t w, uint16_t h,
                            uint16_t color);
+/* TEON (V-blank only) / TEOFF; drives the TE output if the pin is wired. */
+void st7789_8080_set_tearing_effect(const st7789_8080_bus_t *bus, uint8_t enable);
+/* GSCAN: current panel scanline, or -1 when the bus has no read path. */
+int32_t st7789_8080_read_scanline(const st7789_8080_bus_t *bus);
 
 #endif
@@ -1,28 +1,77 @@
 #include "drivers/uart.h"
 
+#include "platform/clock.h"
+#include "platform/cpu.h"
 #include "platform/hw.h"
 #include "platform/mmio.h"
+#include "platform/time.h"
 
 #define UART_TX_READY_SPIN_MAX 200000u
 
-#define UART_RX_BUF_LEN 128u
-#define UART_RX_BUF_MASK (UART_RX_BUF_LEN - 1u)
+#define UART_SR_TC   (1u << 6)
+#define UART_SR_TXE  (1u << 7)
+#define UART_CR1_TXEIE (1u << 7)
 
+/* UART1 (BLE/comm) transmit ring; holds two full comm frames. */
+#define UART1_TX_BUF_LEN 512u
+
+/*
+ * RX FIFO sizes per port (powers of two). The BLE link bursts whole frames
+ * at up to 115200 baud while the main loop may be busy rendering; the motor
+ * and debug links are low-rate request/response.
+ */
+#define UART1_RX_BUF_LEN 512u
+#define UART2_RX_BUF_LEN 128u
+#define UART4_RX_BUF_LEN 64u
+
+_Static_assert((UART1_RX_BUF_LEN & (UART1_RX_BUF_LEN - 1u)) == 0u, "RX FIFO size must be a power of two");
+_Static_assert((UART2_RX_BUF_LEN & (UART2_RX_BUF_LEN - 1u)) == 0u, "RX FIFO size must be a power of two");
+_Static_assert((UART4_RX_BUF_LEN & (UART4_RX_BUF_LEN - 1u)) == 0u, "RX FIFO size must be a power of two");
+
+/*
+ * Receive FIFO, single producer (RX interrupt) / single consumer (thread
+ * mode). head and tail run freely and are masked on access, so head - tail
+ * is the fill level and every slot is usable. Each side publishes its index
+ * only after a barrier that orders it behind the buffer access.
+ */
 typedef struct {
-    uint8_t buf[UART_RX_BUF_LEN];
+    uint8_t *buf;
+    uint32_t mask;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+} uart_rx_fifo_t;
+
+/*
+ * Transmit ring, single producer (thread mode) / single consumer (TXE
+ * interrupt). Ports without a buffer, or before uart_tx_irq_enable(), write
+ * DR directly as before.
+ */
+typedef struct {
+    uint8_t *buf;
+    uint16_t mask;
     volatile uint16_t head;
     volatile uint16_t tail;
-} uart_rx_fifo_t;
+    volatile uint8_t irq;
+} uart_tx_ring_t;
 
 typedef struct {
     uint32_t base;
     uart_rx_fifo_t rx;
+    uart_tx_ring_t tx;
+    uart_rx_hook_t rx_hook;
+    uart_stats_t stats;
+    uint32_t baud;           /* set through uart_set_baud_rate(); 0: raw BRR */
 } uart_port_state_t;
 
+static uint8_t g_uart1_tx_buf[UART1_TX_BUF_LEN];
+static uint8_t g_uart1_rx_buf[UART1_RX_BUF_LEN];
+static uint8_t g_uart2_rx_buf[UART2_RX_BUF_LEN];
+static uint8_t g_uart4_rx_buf[UART4_RX_BUF_LEN];
+
 static uart_port_state_t g_uart_ports[] = {
-    { UART1_BASE, {{0}, 0u, 0u} },
-    { UART2_BASE, {{0}, 0u, 0u} },
-    { UART4_BASE, {{0}, 0u, 0u} },
+    { UART1_BASE, { g_uart1_rx_buf, UART1_RX_BUF_LEN - 1u, 0u, 0u }, { g_uart1_tx_buf, UART1_TX_BUF_LEN - 1u, 0u, 0u, 0u }, NULL, {0}, 0u },
+    { UART2_BASE, { g_uart2_rx_buf, UART2_RX_BUF_LEN - 1u, 0u, 0u }, { NULL, 0u, 0u, 0u, 0u }, NULL, {0}, 0u },
+    { UART4_BASE, { g_uart4_rx_buf, UART4_RX_BUF_LEN - 1u, 0u, 0u }, { NULL, 0u, 0u, 0u, 0u }, NULL, {0}, 0u },
 };
 
 static int uart_port_index(uint32_t base)
@@ -38,21 +87,55 @@ static int uart_port_index(uint32_t base)
 static int uart_rx_fifo_pop(int idx, uint8_t *out)
 {
     uart_rx_fifo_t *rx = &g_uart_ports[idx].rx;
-    if (rx->head == rx->tail)
+    uint32_t tail = rx->tail;
+    if (rx->head == tail)
         return 0;
-    *out = rx->buf[rx->tail];
-    rx->tail = (uint16_t)((rx->tail + 1u) & UART_RX_BUF_MASK);
+    mmio_dmb(); /* read the byte only after seeing head move past it */
+    *out = rx->buf[tail & rx->mask];
+    mmio_dmb(); /* ...and hand the slot back only after reading it */
+    rx->tail = tail + 1u;
     return 1;
 }
 
+/* Pops up to max bytes in at most two copies (before and after the wrap). */
+static size_t uart_rx_fifo_read(int idx, uint8_t *out, size_t max)
+{
+    uart_rx_fifo_t *rx = &g_uart_ports[idx].rx;
+    uint32_t tail = rx->tail;
+    uint32_t avail = rx->head - tail;
+    if (avail == 0u || max == 0u)
+        return 0u;
+    if (avail > max)
+        avail = (uint32_t)max;
+    mmio_dmb();
+    uint32_t n = 0u;
+    while (n < avail)
+    {
+        uint32_t off = (tail + n) & rx->mask;
+        uint32_t run = rx->mask + 1u - off;
+        if (run > avail - n)
+            run = avail - n;
+        for (uint32_t i = 0; i < run; ++i)
+            out[n + i] = rx->buf[off + i];
+        n += run;
+    }
+    mmio_dmb();
+    rx->tail = tail + n;
+    return n;
+}
+
 static void uart_rx_fifo_push(int idx, uint8_t b)
 {
     uart_rx_fifo_t *rx = &g_uart_ports[idx].rx;
-    uint16_t next = (uint16_t)((rx->head + 1u) & UART_RX_BUF_MASK);
-    if (next == rx->tail)
-        return; /* drop on overflow */
-    rx->buf[rx->head] = b;
-    rx->head = next;
+    uint32_t head = rx->head;
+    if (head - rx->tail > rx->mask)
+    {
+        g_uart_ports[idx].stats.rx_drops++; /* drop on overflow */
+        return;
+    }
+    rx->buf[head & rx->mask] = b;
+    mmio_dmb(); /* publish the byte before the index */
+    rx->head = head + 1u;
 }
 
 void uart_init_basic(uint32_t base, uint32_t brr_div)
@@ -84,18 +167,202 @@ void uart_set_9bit(uint32_t base, uint8_t enable)
 
 int uart_tx_ready(uint32_t base)
 {
-    return (mmio_read32(UART_SR(base)) & (1u << 7)) != 0; /* TXE */
+    return (mmio_read32(UART_SR(base)) & UART_SR_TXE) != 0;
 }
 
-void uart_putc(uint32_t base, uint8_t c)
+static uart_tx_ring_t *uart_tx_ring(uint32_t base)
+{
+    int idx = uart_port_index(base);
+    if (idx < 0 || !g_uart_ports[idx].tx.buf)
+        return NULL;
+    return &g_uart_ports[idx].tx;
+}
+
+static uint16_t uart_tx_ring_used(const uart_tx_ring_t *r)
+{
+    return (uint16_t)((r->head - r->tail) & r->mask);
+}
+
+static void uart_tx_stall_add(uint32_t base, uint32_t t0)
+{
+    int idx = uart_port_index(base);
+    if (idx >= 0)
+        g_uart_ports[idx].stats.tx_stall_us += platform_cycles_to_us(platform_cycles_now() - t0);
+}
+
+/* Returns 1 once c is in DR, 0 if TXE never came within the spin budget. */
+static int uart_tx_putc_direct(uint32_t base, uint8_t c)
+{
+    if (!uart_tx_ready(base))
+    {
+        uint32_t t0 = platform_cycles_now();
+        uint32_t spins = 0u;
+        while (!uart_tx_ready(base))
+        {
+            if (++spins >= UART_TX_READY_SPIN_MAX)
+                break;
+        }
+        uart_tx_stall_add(base, t0);
+        if (spins >= UART_TX_READY_SPIN_MAX)
+            return 0;
+    }
+    mmio_write32(UART_DR(base), c);
+    return 1;
+}
+
+/* Sends whatever is queued by polling, with the TXE interrupt off. Used where
+ * that interrupt cannot run (IRQs masked, fault or ISR context) and before a
+ * reset, so bytes keep their order. */
+static void uart_tx_drain_polled(uint32_t base, uart_tx_ring_t *r)
+{
+    uint32_t primask = irq_save();
+    mmio_write32(UART_CR1(base), mmio_read32(UART_CR1(base)) & ~UART_CR1_TXEIE);
+    while (r->tail != r->head)
+    {
+        (void)uart_tx_putc_direct(base, r->buf[r->tail]);
+        r->tail = (uint16_t)((r->tail + 1u) & r->mask);
+    }
+    irq_restore(primask);
+}
+
+/* Ring path is only for thread mode with IRQs on: otherwise the TXE
+ * interrupt may never get to drain it. */
+static uart_tx_ring_t *uart_tx_ring_for_write(uint32_t base)
+{
+    uart_tx_ring_t *r = uart_tx_ring(base);
+    if (!r || !r->irq)
+        return NULL;
+    if (cpu_irqs_available())
+        return r;
+    uart_tx_drain_polled(base, r);
+    return NULL;
+}
+
+/* Returns how many bytes made it into the ring; short only when the ring
+ * stayed full for UART_TX_READY_SPIN_MAX spins. */
+static size_t uart_tx_enqueue(uint32_t base, uart_tx_ring_t *r, const uint8_t *data, size_t len)
 {
+    size_t queued = 0u;
     uint32_t spins = 0u;
-    while (!uart_tx_ready(base))
+    uint32_t t0 = 0u;
+    while (len)
+    {
+        uint16_t room = (uint16_t)(r->mask - uart_tx_ring_used(r));
+        if (room == 0u)
+        {
+            /* Full: the TXE interrupt frees a byte per character time. */
+            if (spins == 0u)
+                t0 = platform_cycles_now();
+            if (++spins >= UART_TX_READY_SPIN_MAX)
+            {
+                uart_tx_stall_add(base, t0);
+                return queued;
+            }
+            continue;
+        }
+        if (spins)
+            uart_tx_stall_add(base, t0);
+        spins = 0u;
+        uint16_t head = r->head;
+        uint16_t n = (len < room) ? (uint16_t)len : room;
+        for (uint16_t i = 0; i < n; ++i)
+            r->buf[(head + i) & r->mask] = data[i];
+        mmio_dmb(); /* bytes before the index the ISR reads */
+        r->head = (uint16_t)((head + n) & r->mask);
+        data += n;
+        len -= n;
+        queued += n;
+
+        disable_irqs();
+        mmio_write32(UART_CR1(base), mmio_read32(UART_CR1(base)) | UART_CR1_TXEIE);
+        enable_irqs();
+    }
+    return queued;
+}
+
+void uart_tx_irq_enable(uint32_t base)
+{
+    uart_tx_ring_t *r = uart_tx_ring(base);
+    if (r)
+        r->irq = 1u;
+}
+
+uint16_t uart_tx_free(uint32_t base)
+{
+    uart_tx_ring_t *r = uart_tx_ring(base);
+    if (!r || !r->irq)
+        return UART_TX_FREE_POLLED;
+    return (uint16_t)(r->mask - uart_tx_ring_used(r));
+}
+
+int uart_tx_idle(uint32_t base)
+{
+    uart_tx_ring_t *r = uart_tx_ring(base);
+    if (r && r->head != r->tail)
+        return 0;
+    return (mmio_read32(UART_SR(base)) & UART_SR_TC) != 0;
+}
+
+/* Of len bytes, sent reached the ring or DR; the rest timed out. */
+static void uart_tx_count(uint32_t base, size_t len, size_t sent)
+{
+    int idx = uart_port_index(base);
+    if (idx < 0)
+        return;
+    g_uart_ports[idx].stats.tx_bytes += (uint32_t)sent;
+    g_uart_ports[idx].stats.tx_drops += (uint32_t)(len - sent);
+}
+
+void uart_tx_write(uint32_t base, const uint8_t *data, size_t len)
+{
+    if (!data || len == 0u)
+        return;
+    size_t sent = 0u;
+    uart_tx_ring_t *r = uart_tx_ring_for_write(base);
+    if (r)
+    {
+        sent = uart_tx_enqueue(base, r, data, len);
+    }
+    else
+    {
+        for (size_t i = 0; i < len; ++i)
+            sent += (size_t)uart_tx_putc_direct(base, data[i]);
+    }
+    uart_tx_count(base, len, sent);
+}
+
+void uart_tx_flush(uint32_t base)
+{
+    uart_tx_ring_t *r = uart_tx_ring(base);
+    if (r)
+        uart_tx_drain_polled(base, r);
+    uint32_t spins = 0u;
+    while (!(mmio_read32(UART_SR(base)) & UART_SR_TC))
     {
         if (++spins >= UART_TX_READY_SPIN_MAX)
             return;
     }
-    mmio_write32(UART_DR(base), c);
+}
+
+void uart_isr_tx(uint32_t base)
+{
+    uart_tx_ring_t *r = uart_tx_ring(base);
+    if (!r || !(mmio_read32(UART_CR1(base)) & UART_CR1_TXEIE))
+        return;
+    while (r->tail != r->head && uart_tx_ready(base))
+    {
+        mmio_write32(UART_DR(base), r->buf[r->tail]);
+        r->tail = (uint16_t)((r->tail + 1u) & r->mask);
+    }
+    if (r->tail == r->head)
+        mmio_write32(UART_CR1(base), mmio_read32(UART_CR1(base)) & ~UART_CR1_TXEIE);
+}
+
+void uart_putc(uint32_t base, uint8_t c)
+{
+    uart_tx_ring_t *r = uart_tx_ring_for_write(base);
+    size_t sent = r ? uart_tx_enqueue(base, r, &c, 1u) : (size_t)uart_tx_putc_direct(base, c);
+    uart_tx_count(base, 1u, sent);
 }
 
 void uart_putc_9bit(uint32_t base, uint16_t value)
@@ -129,6 +396,9 @@ int uart_rx_available(uint32_t base)
         uart_rx_fifo_t *rx = &g_uart_ports[idx].rx;
         if (rx->head != rx->tail)
             return 1;
+        /* DR belongs to the hook (uart_isr_rx_drain) once one is set. */
+        if (g_uart_ports[idx].rx_hook)
+            return 0;
     }
     return (mmio_read32(UART_SR(base)) & (1u << 5)) != 0; /* RXNE */
 }
@@ -139,9 +409,40 @@ uint8_t uart_getc(uint32_t base)
     uint8_t b = 0;
     if (idx >= 0 && uart_rx_fifo_pop(idx, &b))
         return b;
+    if (idx >= 0 && g_uart_ports[idx].rx_hook)
+        return 0;
+    if (idx >= 0)
+        g_uart_ports[idx].stats.rx_bytes++;
     return (uint8_t)mmio_read32(UART_DR(base));
 }
 
+size_t uart_read(uint32_t base, uint8_t *buf, size_t max)
+{
+    int idx = uart_port_index(base);
+    if (idx < 0 || !buf)
+        return 0u;
+    size_t n = uart_rx_fifo_read(idx, buf, max);
+    if (g_uart_ports[idx].rx_hook)
+        return n;
+    /* No IRQ drain configured: take what is waiting in DR, like uart_getc. */
+    while (n < max && (mmio_read32(UART_SR(base)) & (1u << 5)))
+    {
+        buf[n++] = (uint8_t)mmio_read32(UART_DR(base));
+        g_uart_ports[idx].stats.rx_bytes++;
+    }
+    return n;
+}
+
+void uart_rx_set_hook(uint32_t base, uart_rx_hook_t hook)
+{
+    int idx = uart_port_index(base);
+    if (idx < 0)
+        return;
+    uint32_t primask = irq_save();
+    g_uart_ports[idx].rx_hook = hook;
+    irq_restore(primask);
+}
+
 uint16_t uart_getc_9bit(uint32_t base)
 {
     int idx = uart_port_index(base);
@@ -151,6 +452,14 @@ uint16_t uart_getc_9bit(uint32_t base)
     return (uint16_t)(mmio_read32(UART_DR(base)) & 0x1FFu);
 }
 
+uint32_t uart_brr_div(uint32_t pclk_hz, uint32_t baud)
+{
+    if (!pclk_hz || !baud)
+        return 7500u;
+    uint32_t div = (pclk_hz + (baud / 2u)) / baud;
+    return div ? div : 7500u;
+}
+
 void uart_set_baud(uint32_t base, uint32_t brr_div)
 {
     /* Disable UE, change BRR, re-enable UE. */
@@ -160,14 +469,84 @@ void uart_set_baud(uint32_t base, uint32_t brr_div)
     mmio_write32(UART_CR1(base), cr1); /* restore UE */
 }
 
+/* USART1 sits on APB2, the others on APB1. */
+static uint32_t uart_pclk_hz(uint32_t base)
+{
+    return rcc_get_pclk_hz_fallback(base == UART1_BASE ? 1u : 0u);
+}
+
+void uart_init_baud(uint32_t base, uint32_t baud)
+{
+    int idx = uart_port_index(base);
+    if (idx >= 0)
+        g_uart_ports[idx].baud = baud;
+    uart_init_basic(base, uart_brr_div(uart_pclk_hz(base), baud));
+}
+
+void uart_set_baud_rate(uint32_t base, uint32_t baud)
+{
+    int idx = uart_port_index(base);
+    if (idx >= 0)
+        g_uart_ports[idx].baud = baud;
+    uart_set_baud(base, uart_brr_div(uart_pclk_hz(base), baud));
+}
+
+uint32_t uart_get_baud_rate(uint32_t base)
+{
+    int idx = uart_port_index(base);
+    return idx >= 0 ? g_uart_ports[idx].baud : 0u;
+}
+
+void uart_clock_changed(void)
+{
+    for (size_t i = 0; i < (sizeof(g_uart_ports) / sizeof(g_uart_ports[0])); ++i)
+    {
+        if (g_uart_ports[i].baud)
+            uart_set_baud(g_uart_ports[i].base,
+                          uart_brr_div(uart_pclk_hz(g_uart_ports[i].base), g_uart_ports[i].baud));
+    }
+}
+
 void uart_isr_rx_drain(uint32_t base)
 {
     int idx = uart_port_index(base);
     if (idx < 0)
         return;
+    uart_rx_hook_t hook = g_uart_ports[idx].rx_hook;
     while (mmio_read32(UART_SR(base)) & (1u << 5))
     {
         uint8_t b = (uint8_t)mmio_read32(UART_DR(base));
-        uart_rx_fifo_push(idx, b);
+        g_uart_ports[idx].stats.rx_bytes++;
+        if (!hook || !hook(b))
+            uart_rx_fifo_push(idx, b);
+    }
+}
+
+void uart_get_stats(uint32_t base, uart_stats_t *out)
+{
+    int idx = uart_port_index(base);
+    if (!out)
+        return;
+    if (idx < 0)
+    {
+        out->rx_bytes = out->rx_drops = out->tx_bytes = out->tx_drops = out->tx_stall_us = 0u;
+        return;
     }
+    uint32_t primask = irq_save();
+    *out = g_uart_ports[idx].stats;
+    irq_restore(primask);
+}
+
+void uart_reset_stats(uint32_t base)
+{
+    int idx = uart_port_index(base);
+    if (idx < 0)
+        return;
+    uint32_t primask = irq_save();
+    g_uart_ports[idx].stats.rx_bytes = 0u;
+    g_uart_ports[idx].stats.rx_drops = 0u;
+    g_uart_ports[idx].stats.tx_bytes = 0u;
+    g_uart_ports[idx].stats.tx_drops = 0u;
+    g_uart_ports[idx].stats.tx_stall_us = 0u;
+    irq_restore(primask);
 }
@@ -12,10 +12,78 @@ void uart_putc_9bit(uint32_t base, uint16_t value);
 void uart_write(uint32_t base, const uint8_t *data, size_t len);
 int uart_rx_available(uint32_t base);
 uint8_t uart_getc(uint32_t base);
+/*
+ * Bulk receive: copies up to max bytes from the RX FIFO (then from DR while
+ * RXNE, when no receive hook owns DR). Returns the count, 0 when idle.
+ */
+size_t uart_read(uint32_t base, uint8_t *buf, size_t max);
 uint16_t uart_getc_9bit(uint32_t base);
 void uart_isr_rx_drain(uint32_t base);
 
+/*
+ * Per-byte receive hook, run by uart_isr_rx_drain() on every byte read from
+ * DR; returns non-zero when it consumed the byte, otherwise the byte goes to
+ * the RX FIFO for uart_getc(). With a hook set, uart_getc() and
+ * uart_rx_available() only see the FIFO, so code that cannot rely on the
+ * IRQ (faults, IRQs masked) calls uart_isr_rx_drain() itself.
+ */
+typedef int (*uart_rx_hook_t)(uint8_t b);
+
+void uart_rx_set_hook(uint32_t base, uart_rx_hook_t hook);
+
+/*
+ * Buffered transmit. After uart_tx_irq_enable() (UART1 only has a ring),
+ * writes from thread mode are queued and drained by the TXE interrupt, so a
+ * long reply costs a memcpy instead of one character time per byte; a full
+ * ring waits for space rather than dropping, and only gives up (tx_drops)
+ * after a bounded spin. Writes from ISR/fault context or with IRQs masked
+ * flush the ring and fall back to polling, keeping byte order.
+ * uart_putc/uart_write use the same path.
+ */
+#define UART_TX_FREE_POLLED 0xFFFFu /* uart_tx_free(): port never queues */
+
+void uart_tx_irq_enable(uint32_t base);
+uint16_t uart_tx_free(uint32_t base);
+/* Non-zero once nothing is queued and the last stop bit has left (TC). */
+int uart_tx_idle(uint32_t base);
+void uart_tx_write(uint32_t base, const uint8_t *data, size_t len);
+/* Sends everything queued and waits for the last stop bit (before a reset). */
+void uart_tx_flush(uint32_t base);
+/* Called from the USART IRQ handler. */
+void uart_isr_tx(uint32_t base);
+
+/*
+ * Per-port counters. rx_bytes counts reads from DR (interrupt or polled),
+ * rx_drops bytes lost to a full RX FIFO, tx_bytes bytes queued or
+ * written to DR, tx_drops bytes given up on after UART_TX_READY_SPIN_MAX
+ * spins without TXE or ring room, tx_stall_us the time writers spent
+ * waiting for either.
+ */
+typedef struct {
+    uint32_t rx_bytes;
+    uint32_t rx_drops;
+    uint32_t tx_bytes;
+    uint32_t tx_drops;
+    uint32_t tx_stall_us;
+} uart_stats_t;
+
+void uart_get_stats(uint32_t base, uart_stats_t *out);
+void uart_reset_stats(uint32_t base);
+
+/* BRR value for baud at the port's APB clock (7500 if either is 0). */
+uint32_t uart_brr_div(uint32_t pclk_hz, uint32_t baud);
+
 /* Reconfigure baud rate on a live UART (disables/re-enables UE). */
 void uart_set_baud(uint32_t base, uint32_t brr_div);
 
+/*
+ * Init and live change from a baud rate at the port's current APB clock.
+ * The port remembers it, and uart_clock_changed() recomputes BRR for every
+ * such port after a SYSCLK profile switch (platform_clock_set_profile()).
+ */
+void uart_init_baud(uint32_t base, uint32_t baud);
+void uart_set_baud_rate(uint32_t base, uint32_t baud);
+uint32_t uart_get_baud_rate(uint32_t base);
+void uart_clock_changed(void);
+
 #endif
@@ -0,0 +1,202 @@
+#include "ui_band.h"
+
+#include <string.h>
+
+static void band_mark(ui_band_t *b, uint16_t row, uint16_t x0, uint16_t x1)
+{
+    uint32_t *m = b->cover[row];
+    while (x0 < x1)
+    {
+        uint16_t bit = (uint16_t)(x0 & 31u);
+        uint16_t n = (uint16_t)(32u - bit);
+        if (n > (uint16_t)(x1 - x0))
+            n = (uint16_t)(x1 - x0);
+        uint32_t bits = (n == 32u) ? 0xFFFFFFFFu : (((1u << n) - 1u) << bit);
+        m[x0 >> 5] |= bits;
+        x0 = (uint16_t)(x0 + n);
+    }
+}
+
+static uint8_t band_range_set(const ui_band_t *b, uint16_t row, uint16_t x0, uint16_t x1)
+{
+    for (uint16_t x = x0; x < x1; ++x)
+    {
+        if (!ui_band_covered(b, row, x))
+            return 0u;
+    }
+    return 1u;
+}
+
+static void band_unmark(ui_band_t *b, uint16_t row, uint16_t x0, uint16_t x1)
+{
+    for (uint16_t x = x0; x < x1; ++x)
+        b->cover[row][x >> 5] &= ~(1u << (x & 31u));
+}
+
+uint8_t ui_band_covers(const ui_band_t *b, uint16_t x0, uint16_t x1)
+{
+    for (uint16_t r = 0; r < b->h; ++r)
+    {
+        if (!band_range_set(b, r, x0, x1))
+            return 0u;
+    }
+    return 1u;
+}
+
+void ui_band_uncover(ui_band_t *b, uint16_t x0, uint16_t x1)
+{
+    for (uint16_t r = 0; r < b->h; ++r)
+        band_unmark(b, r, x0, x1);
+}
+
+void ui_band_begin(ui_band_t *b, uint16_t *px, uint16_t y0, uint16_t h)
+{
+    b->px = px;
+    b->y0 = y0;
+    b->h = (h > UI_BAND_H) ? (uint16_t)UI_BAND_H : h;
+    b->wx0 = b->wx1 = b->wy1 = 0u;
+    b->cx = b->cy = 0u;
+    b->bx0 = DISP_W;
+    b->bx1 = 0u;
+    b->by0 = (uint16_t)(y0 + b->h);
+    b->by1 = y0;
+    memset(b->cover, 0, sizeof(b->cover));
+}
+
+void ui_band_window(ui_band_t *b, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    if (x >= DISP_W || w == 0u || h == 0u)
+    {
+        b->cy = b->wy1 = 0u;
+        return;
+    }
+    if ((uint32_t)x + w > DISP_W)
+        w = (uint16_t)(DISP_W - x);
+    b->wx0 = x;
+    b->wx1 = (uint16_t)(x + w);
+    b->wy1 = (uint16_t)(y + h);
+    b->cx = x;
+    b->cy = y;
+}
+
+/* Next span of the window row under the cursor: n pixels at most, 0 once
+ * the window is full. *dst is NULL when the row is outside the band. */
+static uint16_t band_span(ui_band_t *b, uint32_t n, uint16_t **dst)
+{
+    if (b->cy >= b->wy1 || b->cx >= b->wx1)
+        return 0u;
+    uint16_t take = (uint16_t)(b->wx1 - b->cx);
+    if (n < take)
+        take = (uint16_t)n;
+    *dst = NULL;
+    if (b->cy >= b->y0 && b->cy < b->y0 + b->h)
+    {
+        uint16_t row = (uint16_t)(b->cy - b->y0);
+        *dst = &b->px[(uint32_t)row * DISP_W + b->cx];
+        band_mark(b, row, b->cx, (uint16_t)(b->cx + take));
+        if (b->cx < b->bx0)
+            b->bx0 = b->cx;
+        if (b->cx + take > b->bx1)
+            b->bx1 = (uint16_t)(b->cx + take);
+        if (b->cy < b->by0)
+            b->by0 = b->cy;
+        if (b->cy >= b->by1)
+            b->by1 = (uint16_t)(b->cy + 1u);
+    }
+    b->cx = (uint16_t)(b->cx + take);
+    if (b->cx >= b->wx1)
+    {
+        b->cx = b->wx0;
+        b->cy++;
+    }
+    return take;
+}
+
+void ui_band_write(ui_band_t *b, const uint16_t *src, uint32_t n)
+{
+    while (n)
+    {
+        uint16_t *dst;
+        uint16_t take = band_span(b, n, &dst);
+        if (take == 0u)
+            return;
+        if (dst)
+            memcpy(dst, src, (size_t)take * sizeof(uint16_t));
+        src += take;
+        n -= take;
+    }
+}
+
+void ui_band_fill(ui_band_t *b, uint16_t color, uint32_t n)
+{
+    while (n)
+    {
+        uint16_t *dst;
+        uint16_t take = band_span(b, n, &dst);
+        if (take == 0u)
+            return;
+        if (dst)
+        {
+            for (uint16_t i = 0; i < take; ++i)
+                dst[i] = color;
+        }
+        n -= take;
+    }
+}
+
+uint16_t ui_band_flush(ui_band_t *b, ui_band_push_fn push, void *ctx)
+{
+    if (b->bx0 >= b->bx1)
+        return 0u;
+    uint16_t w = (uint16_t)(b->bx1 - b->bx0);
+    uint16_t r0 = (uint16_t)(b->by0 - b->y0), r1 = (uint16_t)(b->by1 - b->y0);
+    uint8_t full = 1u;
+    for (uint16_t r = r0; r < r1 && full; ++r)
+        full = band_range_set(b, r, b->bx0, b->bx1);
+
+    uint16_t rects = 0u;
+    if (full)
+    {
+        /* Close the rows up into one run: each moves down to a lower address. */
+        uint16_t *dst = b->px;
+        for (uint16_t r = r0; r < r1; ++r)
+        {
+            memmove(dst, &b->px[(uint32_t)r * DISP_W + b->bx0], (size_t)w * sizeof(uint16_t));
+            dst += w;
+        }
+        push(ctx, b->bx0, b->by0, w, (uint16_t)(r1 - r0), b->px, w);
+        rects = 1u;
+    }
+    else
+    {
+        for (uint16_t r = r0; r < r1; ++r)
+        {
+            uint16_t x = b->bx0;
+            while (x < b->bx1)
+            {
+                if (!ui_band_covered(b, r, x))
+                {
+                    x++;
+                    continue;
+                }
+                uint16_t x0 = x;
+                while (x < b->bx1 && ui_band_covered(b, r, x))
+                    x++;
+                /* Rows below with exactly this run join it. */
+                uint16_t r_end = (uint16_t)(r + 1u);
+                while (r_end < r1 && band_range_set(b, r_end, x0, x) &&
+                       (x0 == 0u || !ui_band_covered(b, r_end, (uint16_t)(x0 - 1u))) &&
+                       (x >= DISP_W || !ui_band_covered(b, r_end, x)))
+                {
+                    band_unmark(b, r_end, x0, x);
+                    r_end++;
+                }
+                push(ctx, x0, (uint16_t)(b->y0 + r), (uint16_t)(x - x0), (uint16_t)(r_end - r),
+                     &b->px[(uint32_t)r * DISP_W + x0], DISP_W);
+                rects++;
+            }
+        }
+    }
+    ui_band_begin(b, b->px, b->y0, b->h);
+    return rects;
+}
@@ -0,0 +1,55 @@
+#ifndef OPEN_FIRMWARE_UI_BAND_H
+#define OPEN_FIRMWARE_UI_BAND_H
+
+#include <stdint.h>
+
+#include "ui_display.h"
+
+/*
+ * One horizontal band of the panel in RAM (DISP_W x UI_BAND_H RGB565).
+ * Primitives write it as they would the panel: a window, then pixels in
+ * RAMWR order. Each pixel written is marked covered; flush hands the
+ * covered area to `push` as few rectangles as it can, so what was never
+ * drawn is left alone on the panel.
+ */
+#define UI_BAND_H 16u
+#define UI_BAND_PIXELS ((uint32_t)DISP_W * UI_BAND_H)
+#define UI_BAND_MASK_WORDS ((DISP_W + 31u) / 32u)
+
+/* Rows of w pixels, `stride` apart; stride == w means one contiguous run. */
+typedef void (*ui_band_push_fn)(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                                const uint16_t *px, uint16_t stride);
+
+typedef struct {
+    uint16_t *px;
+    uint16_t y0;
+    uint16_t h;
+    /* Window (panel coordinates) and the RAMWR cursor in it. */
+    uint16_t wx0, wx1, wy1;
+    uint16_t cx, cy;
+    /* Bounds of everything covered; bx0 >= bx1 while nothing is. */
+    uint16_t bx0, by0, bx1, by1;
+    uint32_t cover[UI_BAND_H][UI_BAND_MASK_WORDS];
+} ui_band_t;
+
+/* Rows [y0, y0 + h) in `px` (UI_BAND_PIXELS); h at most UI_BAND_H. */
+void ui_band_begin(ui_band_t *b, uint16_t *px, uint16_t y0, uint16_t h);
+/* Pixels outside the band are dropped but still advance the cursor. */
+void ui_band_window(ui_band_t *b, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+void ui_band_write(ui_band_t *b, const uint16_t *src, uint32_t n);
+void ui_band_fill(ui_band_t *b, uint16_t color, uint32_t n);
+
+static inline uint8_t ui_band_covered(const ui_band_t *b, uint16_t row, uint16_t x)
+{
+    return (uint8_t)((b->cover[row][x >> 5] >> (x & 31u)) & 1u);
+}
+/* 1 when every row of the band covers [x0, x1). */
+uint8_t ui_band_covers(const ui_band_t *b, uint16_t x0, uint16_t x1);
+/* Leaves [x0, x1) of every row out of the next flush. */
+void ui_band_uncover(ui_band_t *b, uint16_t x0, uint16_t x1);
+/* Pushes the covered pixels: the bounds in one contiguous run when they are
+ * fully covered, else covered row runs, merged down while they repeat. The
+ * band is empty afterwards. Returns the rectangles pushed. */
+uint16_t ui_band_flush(ui_band_t *b, ui_band_push_fn push, void *ctx);
+
+#endif
@@ -1,10 +1,14 @@
 #include "ui_draw_common.h"
+#include "ui_draw_px.h"
 
 #include "ui_color.h"
 #include "ui_display.h"
 #include "src/core/trace_format.h"
 
 #include "ui_trig.h"
+#include "platform/ram.h"
+
+#include <string.h>
 
 static const uint8_t k_dither_4x4[16] = {
     0u,  8u,  2u, 10u,
@@ -13,7 +17,7 @@ static const uint8_t k_dither_4x4[16] = {
     15u, 7u, 13u, 5u
 };
 
-uint16_t ui_draw_dither_pick(uint16_t x, uint16_t y, uint16_t c0, uint16_t c1, uint8_t level)
+RAMFUNC uint16_t ui_draw_dither_pick(uint16_t x, uint16_t y, uint16_t c0, uint16_t c1, uint8_t level)
 {
     uint8_t t = k_dither_4x4[((y & 3u) << 2) | (x & 3u)];
     return (t < level) ? c1 : c0;
@@ -21,10 +25,24 @@ uint16_t ui_draw_dither_pick(uint16_t x, uint16_t y, uint16_t c0, uint16_t c1, u
 
 static uint16_t isqrt_u32(uint32_t n)
 {
-    /* Integer sqrt (floor). n is small (<= r^2) so a simple loop is fine. */
+    /* Integer sqrt (floor), digit-by-digit; also used per scanline by the ring rasterizer. */
     uint32_t r = 0;
-    while ((r + 1u) * (r + 1u) <= n)
-        r++;
+    uint32_t bit = 1u << 30;
+    while (bit > n)
+        bit >>= 2;
+    while (bit)
+    {
+        if (n >= r + bit)
+        {
+            n -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
     return (uint16_t)r;
 }
 
@@ -51,112 +69,244 @@ void ui_draw_format_value(char *out, size_t len, const char *label, long value)
     *ptr = 0;
 }
 
+uint16_t ui_draw_corner_inset(uint8_t r, uint16_t dy)
+{
+    int rr = (int)r;
+    int yy = (rr - 1) - (int)dy;
+    int xx = (int)isqrt_u32((uint32_t)(rr * rr - yy * yy));
+    int inset = (rr - 1) - xx;
+    return (inset < 0) ? 0u : (uint16_t)inset;
+}
+
+/*
+ * Corner insets by radius. Panel styles, chips and pills use a handful of
+ * radii, so each one's rows are solved once and memoised; a new radius
+ * replaces the oldest. Radii above CORNER_LUT_MAX_R are left to
+ * ui_draw_corner_inset.
+ */
+#define CORNER_LUT_SLOTS 8u
+#define CORNER_LUT_MAX_R 48u
+
+static struct {
+    uint8_t r[CORNER_LUT_SLOTS];
+    uint8_t inset[CORNER_LUT_SLOTS][CORNER_LUT_MAX_R];
+    uint8_t n;
+    uint8_t next;
+} g_corner;
+
+const uint8_t *ui_draw_corner_insets(uint8_t r)
+{
+    if (r == 0u || r > CORNER_LUT_MAX_R)
+        return NULL;
+    for (uint8_t i = 0; i < g_corner.n; ++i)
+        if (g_corner.r[i] == r)
+            return g_corner.inset[i];
+    uint8_t slot = g_corner.next;
+    g_corner.next = (uint8_t)((g_corner.next + 1u) % CORNER_LUT_SLOTS);
+    if (g_corner.n < CORNER_LUT_SLOTS)
+        g_corner.n++;
+    g_corner.r[slot] = r;
+    for (uint8_t dy = 0; dy < r; ++dy)
+        g_corner.inset[slot][dy] = (uint8_t)ui_draw_corner_inset(r, dy);
+    return g_corner.inset[slot];
+}
+
 void ui_draw_fill_round_rect(const ui_draw_rect_ops_t *ops, void *ctx, uint16_t x, uint16_t y,
                              uint16_t w, uint16_t h, uint16_t color, uint8_t radius)
 {
-    if (!ops || !ops->fill_hline || !ops->fill_rect)
-        return;
-    if (w == 0u || h == 0u)
-        return;
+    if (ops)
+        ui_draw_px_fill_round_rect(ops, ctx, x, y, w, h, color, radius);
+}
 
-    uint8_t r = radius;
-    if (r == 0u || w <= (uint16_t)(2u * r) || h <= (uint16_t)(2u * r))
+void ui_draw_fill_round_rect_dither(const ui_draw_rect_ops_t *ops, void *ctx, uint16_t x, uint16_t y,
+                                    uint16_t w, uint16_t h, uint16_t color, uint16_t alt,
+                                    uint8_t radius, uint8_t level)
+{
+    if (ops)
+        ui_draw_px_fill_round_rect_dither(ops, ctx, x, y, w, h, color, alt, radius, level);
+}
+
+/*
+ * Composite panel rasterizer.
+ *
+ * Filling shadow, border and fill as separate round rects writes most panel
+ * pixels two or three times. Instead each row's span of every layer is
+ * worked out from the same corner math, the row is cut into runs owned by
+ * the topmost layer covering them (at most five: shadow, border, fill,
+ * border, shadow) and only those runs are written. Consecutive rows with
+ * the same runs are merged into one rect per run, so the straight middle of
+ * a panel costs a handful of windows rather than one per row.
+ */
+#define PANEL_LAYERS 3u
+#define PANEL_MAX_RUNS (2u * PANEL_LAYERS - 1u)
+
+typedef struct {
+    uint16_t x0;
+    uint16_t x1; /* exclusive */
+    uint8_t layer;
+} panel_run_t;
+
+static uint8_t rrect_row_span(const ui_draw_rrect_t *rr, uint16_t y, uint16_t *x0, uint16_t *x1)
+{
+    if (rr->w == 0u || rr->h == 0u || y < rr->y || (uint32_t)y >= (uint32_t)rr->y + rr->h)
+        return 0u;
+    uint16_t row = (uint16_t)(y - rr->y);
+    uint8_t r = rr->radius;
+    uint16_t inset = 0u;
+    if (r != 0u && rr->w > (uint16_t)(2u * r) && rr->h > (uint16_t)(2u * r))
     {
-        ops->fill_rect(ctx, x, y, w, h, color);
-        return;
+        const uint8_t *insets = ui_draw_corner_insets(r);
+        if (row < r)
+            inset = ui_draw_px_inset(insets, r, row);
+        else if (row >= (uint16_t)(rr->h - r))
+            inset = ui_draw_px_inset(insets, r, (uint16_t)(row - (rr->h - r)));
     }
+    *x0 = (uint16_t)(rr->x + inset);
+    *x1 = (uint16_t)(rr->x + rr->w - inset);
+    return 1u;
+}
 
-    const int rr = (int)r;
-    const uint32_t rr2 = (uint32_t)rr * (uint32_t)rr;
+static uint8_t panel_row_runs(const ui_draw_rrect_t *const layers[PANEL_LAYERS], uint16_t y,
+                              panel_run_t runs[PANEL_MAX_RUNS])
+{
+    uint16_t lo[PANEL_LAYERS];
+    uint16_t hi[PANEL_LAYERS];
+    uint8_t has[PANEL_LAYERS];
+    uint16_t cut[2u * PANEL_LAYERS];
+    uint8_t ncut = 0u;
 
-    for (uint16_t dy = 0; dy < r; ++dy)
+    for (uint8_t i = 0; i < PANEL_LAYERS; ++i)
     {
-        int yy = (rr - 1) - (int)dy;
-        uint32_t xx2 = rr2 - (uint32_t)(yy * yy);
-        int xx = (int)isqrt_u32(xx2);
-        int inset = (rr - 1) - xx;
-        if (inset < 0)
-            inset = 0;
-        uint16_t span_w = (uint16_t)(w - 2u * (uint16_t)inset);
-        ops->fill_hline(ctx, (uint16_t)(x + (uint16_t)inset), (uint16_t)(y + dy), span_w, color);
+        has[i] = rrect_row_span(layers[i], y, &lo[i], &hi[i]);
+        if (!has[i])
+            continue;
+        /* Insertion sort; six entries at most. */
+        for (uint8_t k = 0; k < 2u; ++k)
+        {
+            uint16_t v = k ? hi[i] : lo[i];
+            uint8_t j = ncut++;
+            while (j > 0u && cut[j - 1u] > v)
+            {
+                cut[j] = cut[j - 1u];
+                j--;
+            }
+            cut[j] = v;
+        }
     }
 
-    uint16_t mid_h = (h > (uint16_t)(2u * r)) ? (uint16_t)(h - 2u * (uint16_t)r) : 0u;
-    if (mid_h)
-        ops->fill_rect(ctx, x, (uint16_t)(y + r), w, mid_h, color);
-
-    for (uint16_t dy = 0; dy < r; ++dy)
+    uint8_t n = 0u;
+    for (uint8_t c = 0; c + 1u < ncut; ++c)
     {
-        uint16_t yrow = (uint16_t)(h - r + dy);
-        int yy = (rr - 1) - (int)dy;
-        uint32_t xx2 = rr2 - (uint32_t)(yy * yy);
-        int xx = (int)isqrt_u32(xx2);
-        int inset = (rr - 1) - xx;
-        if (inset < 0)
-            inset = 0;
-        uint16_t span_w = (uint16_t)(w - 2u * (uint16_t)inset);
-        ops->fill_hline(ctx, (uint16_t)(x + (uint16_t)inset), (uint16_t)(y + yrow), span_w, color);
+        uint16_t a = cut[c];
+        uint16_t b = cut[c + 1u];
+        if (a == b)
+            continue;
+        int top = -1;
+        for (int i = (int)PANEL_LAYERS - 1; i >= 0; --i)
+        {
+            if (has[i] && a >= lo[i] && a < hi[i])
+            {
+                top = i;
+                break;
+            }
+        }
+        if (top < 0)
+            continue;
+        if (n && runs[n - 1u].layer == (uint8_t)top && runs[n - 1u].x1 == a)
+        {
+            runs[n - 1u].x1 = b;
+            continue;
+        }
+        if (n < PANEL_MAX_RUNS)
+            runs[n++] = (panel_run_t){a, b, (uint8_t)top};
     }
+    return n;
 }
 
-void ui_draw_fill_round_rect_dither(const ui_draw_rect_ops_t *ops, void *ctx, uint16_t x, uint16_t y,
-                                    uint16_t w, uint16_t h, uint16_t color, uint16_t alt,
-                                    uint8_t radius, uint8_t level)
+static uint8_t runs_equal(const panel_run_t *a, uint8_t na, const panel_run_t *b, uint8_t nb)
 {
-    if (!ops || !ops->fill_hline_dither || !ops->fill_rect_dither)
-        return;
-    if (w == 0u || h == 0u)
-        return;
-
-    if (level == 0u || color == alt)
+    if (na != nb)
+        return 0u;
+    for (uint8_t i = 0; i < na; ++i)
     {
-        ui_draw_fill_round_rect(ops, ctx, x, y, w, h, color, radius);
-        return;
+        if (a[i].x0 != b[i].x0 || a[i].x1 != b[i].x1 || a[i].layer != b[i].layer)
+            return 0u;
     }
-    if (level >= 16u)
+    return 1u;
+}
+
+static void panel_emit_band(const ui_draw_rect_ops_t *ops, void *ctx, const ui_draw_panel_t *p,
+                            const uint16_t colors[PANEL_LAYERS], uint8_t dither,
+                            const panel_run_t *runs, uint8_t n, uint16_t y, uint16_t h)
+{
+    for (uint8_t i = 0; i < n; ++i)
     {
-        ui_draw_fill_round_rect(ops, ctx, x, y, w, h, alt, radius);
-        return;
+        uint16_t x = runs[i].x0;
+        uint16_t w = (uint16_t)(runs[i].x1 - runs[i].x0);
+        if (dither && runs[i].layer == PANEL_LAYERS - 1u)
+        {
+            if (h == 1u)
+                ops->fill_hline_dither(ctx, x, y, w, p->fill_color, p->fill_alt, p->dither_level);
+            else
+                ops->fill_rect_dither(ctx, x, y, w, h, p->fill_color, p->fill_alt, p->dither_level);
+        }
+        else if (h == 1u)
+        {
+            ops->fill_hline(ctx, x, y, w, colors[runs[i].layer]);
+        }
+        else
+        {
+            ops->fill_rect(ctx, x, y, w, h, colors[runs[i].layer]);
+        }
     }
+}
 
-    uint8_t r = radius;
-    if (r == 0u || w <= (uint16_t)(2u * r) || h <= (uint16_t)(2u * r))
-    {
-        ops->fill_rect_dither(ctx, x, y, w, h, color, alt, level);
+void ui_draw_fill_panel(const ui_draw_rect_ops_t *ops, void *ctx, const ui_draw_panel_t *p)
+{
+    if (!ops || !ops->fill_hline || !ops->fill_rect || !p)
         return;
-    }
 
-    const int rr = (int)r;
-    const uint32_t rr2 = (uint32_t)rr * (uint32_t)rr;
+    const ui_draw_rrect_t *const layers[PANEL_LAYERS] = {&p->shadow, &p->body, &p->fill};
+    uint16_t colors[PANEL_LAYERS] = {p->shadow_color, p->border, p->fill_color};
+    /* Same degenerate cases as ui_draw_fill_round_rect_dither(). */
+    uint8_t dither = 0u;
+    if (p->dither_level >= 16u)
+        colors[PANEL_LAYERS - 1u] = p->fill_alt;
+    else if (p->dither_level != 0u && p->fill_color != p->fill_alt)
+        dither = 1u;
+    if (dither && (!ops->fill_hline_dither || !ops->fill_rect_dither))
+        return;
 
-    for (uint16_t dy = 0; dy < r; ++dy)
+    uint32_t y0 = 0xFFFFFFFFu;
+    uint32_t y1 = 0u;
+    for (uint8_t i = 0; i < PANEL_LAYERS; ++i)
     {
-        int yy = (rr - 1) - (int)dy;
-        uint32_t xx2 = rr2 - (uint32_t)(yy * yy);
-        int xx = (int)isqrt_u32(xx2);
-        int inset = (rr - 1) - xx;
-        if (inset < 0)
-            inset = 0;
-        uint16_t span_w = (uint16_t)(w - 2u * (uint16_t)inset);
-        ops->fill_hline_dither(ctx, (uint16_t)(x + (uint16_t)inset), (uint16_t)(y + dy), span_w, color, alt, level);
+        const ui_draw_rrect_t *l = layers[i];
+        if (l->w == 0u || l->h == 0u)
+            continue;
+        if (l->y < y0)
+            y0 = l->y;
+        if ((uint32_t)l->y + l->h > y1)
+            y1 = (uint32_t)l->y + l->h;
     }
+    if (y0 >= y1)
+        return;
 
-    uint16_t mid_h = (h > (uint16_t)(2u * r)) ? (uint16_t)(h - 2u * (uint16_t)r) : 0u;
-    if (mid_h)
-        ops->fill_rect_dither(ctx, x, (uint16_t)(y + r), w, mid_h, color, alt, level);
-
-    for (uint16_t dy = 0; dy < r; ++dy)
+    panel_run_t band[PANEL_MAX_RUNS];
+    panel_run_t row[PANEL_MAX_RUNS];
+    uint8_t band_n = 0u;
+    uint16_t band_y = (uint16_t)y0;
+    for (uint32_t y = y0; y < y1; ++y)
     {
-        uint16_t yrow = (uint16_t)(h - r + dy);
-        int yy = (rr - 1) - (int)dy;
-        uint32_t xx2 = rr2 - (uint32_t)(yy * yy);
-        int xx = (int)isqrt_u32(xx2);
-        int inset = (rr - 1) - xx;
-        if (inset < 0)
-            inset = 0;
-        uint16_t span_w = (uint16_t)(w - 2u * (uint16_t)inset);
-        ops->fill_hline_dither(ctx, (uint16_t)(x + (uint16_t)inset), (uint16_t)(y + yrow), span_w, color, alt, level);
+        uint8_t n = panel_row_runs(layers, (uint16_t)y, row);
+        if (y > y0 && runs_equal(row, n, band, band_n))
+            continue;
+        panel_emit_band(ops, ctx, p, colors, dither, band, band_n, band_y, (uint16_t)(y - band_y));
+        memcpy(band, row, n * sizeof(row[0]));
+        band_n = n;
+        band_y = (uint16_t)y;
     }
+    panel_emit_band(ops, ctx, p, colors, dither, band, band_n, band_y, (uint16_t)(y1 - band_y));
 }
 
 void ui_draw_big_digit_7seg(const ui_draw_rect_ops_t *ops, void *ctx, uint16_t x, uint16_t y,
@@ -241,7 +391,7 @@ void ui_draw_warning_icon_ops(const ui_draw_rect_ops_t *ops, void *ctx, uint16_t
     ops->fill_rect(ctx, (uint16_t)(x + 5u), (uint16_t)(y + 10u), 2u, 2u, 0x0000u);
 }
 
-static uint16_t blend_rgb565(uint16_t bg, uint16_t fg, uint8_t a4)
+RAMFUNC uint16_t ui_draw_blend_rgb565(uint16_t bg, uint16_t fg, uint8_t a4)
 {
     if (a4 == 0u)
         return bg;
@@ -262,7 +412,100 @@ static uint16_t blend_rgb565(uint16_t bg, uint16_t fg, uint8_t a4)
     return (uint16_t)((r << 11) | (g << 5) | b);
 }
 
-static uint8_t a4_from_sd_half(int32_t sd_half, int32_t aa_half)
+/*
+ * A4 blends of one fg over one bg as a 16-entry table. A theme draws only a
+ * handful of pairs (icon tints, gauge colours on the card, digit faces), so
+ * a few memoised tables turn the per-pixel blend into a lookup; a new pair
+ * replaces the oldest. A returned table stays valid for the next
+ * BLEND_LUT_SLOTS - 1 lookups.
+ */
+#define BLEND_LUT_SLOTS 8u
+
+typedef struct {
+    uint16_t bg;
+    uint16_t fg;
+    uint16_t c[16];
+} blend_lut_t;
+
+static struct {
+    blend_lut_t lut[BLEND_LUT_SLOTS];
+    uint8_t n;
+    uint8_t next;
+} g_blend;
+
+RAMFUNC const uint16_t *ui_draw_blend_lut(uint16_t bg, uint16_t fg)
+{
+    for (uint8_t i = 0; i < g_blend.n; ++i)
+        if (g_blend.lut[i].bg == bg && g_blend.lut[i].fg == fg)
+            return g_blend.lut[i].c;
+    blend_lut_t *l = &g_blend.lut[g_blend.next];
+    g_blend.next = (uint8_t)((g_blend.next + 1u) % BLEND_LUT_SLOTS);
+    if (g_blend.n < BLEND_LUT_SLOTS)
+        g_blend.n++;
+    l->bg = bg;
+    l->fg = fg;
+    for (uint8_t a = 0; a < 16u; ++a)
+        l->c[a] = ui_draw_blend_rgb565(bg, fg, a);
+    return l->c;
+}
+
+/* Token byte: kind[2] | (run - 1)[6]; kinds literal, repeat, zero run. */
+#define A4_RLE_LITERAL 0u
+#define A4_RLE_REPEAT  1u
+#define A4_RLE_ZERO    2u
+
+RAMFUNC uint32_t ui_draw_a4_rle_alpha(const uint8_t *src, uint32_t avail, uint16_t w, uint8_t *alpha)
+{
+    if (!src || !alpha || avail < 2u)
+        return 0u;
+    uint32_t len = (uint32_t)src[0] | ((uint32_t)src[1] << 8);
+    if (len > avail - 2u)
+        return 0u;
+    const uint8_t *p = &src[2];
+    const uint8_t *end = p + len;
+    uint16_t x = 0u;
+    while (p < end)
+    {
+        uint8_t kind = (uint8_t)(*p >> 6);
+        uint8_t run = (uint8_t)((*p & 0x3Fu) + 1u);
+        p++;
+        if (kind > A4_RLE_ZERO)
+            return 0u;
+        if (kind == A4_RLE_LITERAL && (uint32_t)(end - p) < run)
+            return 0u;
+        if (kind == A4_RLE_REPEAT && p >= end)
+            return 0u;
+        uint8_t rep = (kind == A4_RLE_REPEAT) ? *p++ : 0u;
+        for (uint8_t i = 0; i < run; ++i)
+        {
+            uint8_t b = (kind == A4_RLE_LITERAL) ? *p++ : rep;
+            if (x < w)
+                alpha[x++] = (uint8_t)(b >> 4);
+            if (x < w)
+                alpha[x++] = (uint8_t)(b & 0x0Fu);
+        }
+    }
+    while (x < w)
+        alpha[x++] = 0u;
+    return 2u + len;
+}
+
+RAMFUNC uint32_t ui_draw_a4_rle_row(const uint8_t *src, uint32_t avail, uint16_t w,
+                                    uint16_t fg, uint16_t bg, uint16_t *out)
+{
+    uint8_t alpha[DISP_W];
+    if (!out || w > DISP_W)
+        return 0u;
+    uint32_t used = ui_draw_a4_rle_alpha(src, avail, w, alpha);
+    if (used == 0u)
+        return 0u;
+    const uint16_t *lut = ui_draw_blend_lut(bg, fg);
+    for (uint16_t x = 0; x < w; ++x)
+        out[x] = lut[alpha[x]];
+    return used;
+}
+
+static RAMFUNC uint8_t a4_from_sd_half(int32_t sd_half, int32_t aa_half)
 {
     if (aa_half <= 0)
         return (sd_half < 0) ? 15u : 0u;
@@ -279,151 +522,314 @@ static uint8_t a4_from_sd_half(int32_t sd_half, int32_t aa_half)
     return (uint8_t)((num + den / 2) / den);
 }
 
-static int arc_contains_cw(int32_t px, int32_t py, ui_vec2_i16_t s_q15, ui_vec2_i16_t e_q15, uint16_t sweep_deg)
+/*
+ * Scanline span rasterizer for A4 ring arcs/gauges.
+ *
+ * Per row, the circle crossings (outer/inner, at both the "fully covered"
+ * and "fully clear" AA thresholds) and the angular cut points are solved
+ * once. The row then splits into at most a dozen segments; background and
+ * solid-interior segments are emitted as runs and only the AA edge
+ * segments pay for the per-pixel distance/blend evaluation. Segments also
+ * split at the angular cuts, so an edge pixel's side of the arcs is that of
+ * its segment and no pixel tests angles.
+ */
+#define RING_SPAN_ALL_LO (-0x40000000)
+#define RING_SPAN_ALL_HI 0x3FFFFFFF
+#define RING_AA_HALF 3
+
+typedef struct {
+    int32_t lo; /* inclusive; empty when lo > hi */
+    int32_t hi;
+} ring_span_t;
+
+typedef struct {
+    ring_span_t span;
+    uint8_t invert; /* membership = in(span) XOR invert */
+} ring_arc_row_t;
+
+static int32_t floor_div_i32(int32_t a, int32_t b)
 {
-    if (sweep_deg >= 360u)
-        return 1;
-    if (sweep_deg == 0u)
-        return 0;
-
-    int32_t c1 = (int32_t)s_q15.x * py - (int32_t)s_q15.y * px; /* cross(S, P) */
-    int32_t c2 = (int32_t)px * e_q15.y - (int32_t)py * e_q15.x; /* cross(P, E) */
-
-    if (sweep_deg <= 180u)
-        return (c1 >= 0 && c2 >= 0);
-
-    /* Wide arc: inside = NOT(in the excluded small arc from E->S). */
-    int32_t ce1 = (int32_t)e_q15.x * py - (int32_t)e_q15.y * px; /* cross(E, P) */
-    int32_t ce2 = (int32_t)px * s_q15.y - (int32_t)py * s_q15.x; /* cross(P, S) */
-    return !(ce1 >= 0 && ce2 >= 0);
+    int32_t q = a / b;
+    if ((a % b) != 0 && ((a < 0) != (b < 0)))
+        q--;
+    return q;
 }
 
-void ui_draw_ring_arc_a4(const ui_draw_pixel_writer_t *ops, void *ctx,
-                         uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
-                         int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
-                         int16_t start_deg_cw, uint16_t sweep_deg_cw,
-                         uint16_t fg, uint16_t bg)
+static int32_t ceil_div_i32(int32_t a, int32_t b)
 {
-    if (!ops || !ops->write_pixel)
-        return;
-    if (outer_r == 0u || thickness == 0u || sweep_deg_cw == 0u)
-        return;
-    if (clip_w == 0u || clip_h == 0u)
-        return;
+    return -floor_div_i32(-a, b);
+}
 
-    if (thickness >= outer_r)
-        thickness = outer_r;
-    uint16_t inner_r = (uint16_t)(outer_r - thickness);
+static uint8_t span_has(ring_span_t sp, int32_t v)
+{
+    return (uint8_t)(v >= sp.lo && v <= sp.hi);
+}
 
-    int x0 = (int)cx - (int)outer_r - 2;
-    int y0 = (int)cy - (int)outer_r - 2;
-    int w = 2 * (int)outer_r + 4;
-    int h = 2 * (int)outer_r + 4;
+static ring_span_t span_intersect(ring_span_t a, ring_span_t b)
+{
+    ring_span_t r;
+    r.lo = (a.lo > b.lo) ? a.lo : b.lo;
+    r.hi = (a.hi < b.hi) ? a.hi : b.hi;
+    return r;
+}
 
-    int cx0 = (int)clip_x;
-    int cy0 = (int)clip_y;
-    int cx1 = cx0 + (int)clip_w;
-    int cy1 = cy0 + (int)clip_h;
-    int x1 = x0 + w;
-    int y1 = y0 + h;
-    if (x0 < cx0)
-        x0 = cx0;
-    if (y0 < cy0)
-        y0 = cy0;
-    if (x1 > cx1)
-        x1 = cx1;
-    if (y1 > cy1)
-        y1 = cy1;
-    w = x1 - x0;
-    h = y1 - y0;
+/* px range where A - B*px >= 0. */
+static ring_span_t span_halfline_ge0(int32_t a, int32_t b)
+{
+    ring_span_t r = {RING_SPAN_ALL_LO, RING_SPAN_ALL_HI};
+    if (b == 0)
+    {
+        if (a < 0)
+            r.hi = RING_SPAN_ALL_LO - 1;
+        return r;
+    }
+    if (b > 0)
+        r.hi = floor_div_i32(a, b);
+    else
+        r.lo = ceil_div_i32(-a, -b);
+    return r;
+}
 
-    if (x0 < 0)
+/* x range where the arc from s sweeping cw to e holds (x - cx, py): the
+ * cross products with s and e are each linear in x. */
+static ring_arc_row_t arc_row(int32_t py, ui_vec2_i16_t s, ui_vec2_i16_t e, uint16_t sweep)
+{
+    ring_arc_row_t r;
+    r.span.lo = RING_SPAN_ALL_LO;
+    r.span.hi = RING_SPAN_ALL_HI;
+    r.invert = 0u;
+    if (sweep >= 360u)
+        return r;
+    if (sweep == 0u)
     {
-        w += x0;
-        x0 = 0;
+        r.span.hi = RING_SPAN_ALL_LO - 1;
+        return r;
     }
-    if (y0 < 0)
+    if (sweep <= 180u)
     {
-        h += y0;
-        y0 = 0;
+        ring_span_t c1 = span_halfline_ge0((int32_t)s.x * py, (int32_t)s.y);
+        ring_span_t c2 = span_halfline_ge0(-py * (int32_t)e.x, -(int32_t)e.y);
+        r.span = span_intersect(c1, c2);
+        return r;
     }
-    if (x0 + w > (int)DISP_W)
-        w = (int)DISP_W - x0;
-    if (y0 + h > (int)DISP_H)
-        h = (int)DISP_H - y0;
+    ring_span_t ce1 = span_halfline_ge0((int32_t)e.x * py, (int32_t)e.y);
+    ring_span_t ce2 = span_halfline_ge0(-py * (int32_t)s.x, -(int32_t)s.y);
+    r.span = span_intersect(ce1, ce2);
+    r.invert = 1u;
+    return r;
+}
 
-    if (w <= 0 || h <= 0)
-        return;
+static uint8_t arc_row_has(const ring_arc_row_t *a, int32_t px)
+{
+    return (uint8_t)(span_has(a->span, px) ^ a->invert);
+}
 
-    uint16_t sweep = sweep_deg_cw;
-    if (sweep > 360u)
-        sweep = 360u;
+/* Half-width of the disc row (2x+1-cx2)^2 + py2^2 <= limit; -1 when the
+ * row misses it. */
+static int32_t disc_row_root(int32_t py2, int32_t limit)
+{
+    int32_t m = limit - py2 * py2;
+    return (m < 0) ? -1 : (int32_t)isqrt_u32((uint32_t)m);
+}
 
-    ui_vec2_i16_t s = ui_trig_unit_deg_cw_q15(start_deg_cw);
-    ui_vec2_i16_t e = ui_trig_unit_deg_cw_q15((int16_t)(start_deg_cw + (int16_t)sweep));
+static ring_span_t disc_row_span(int32_t cx2, int32_t root)
+{
+    ring_span_t r = {0, -1};
+    if (root < 0)
+        return r;
+    r.lo = ceil_div_i32(cx2 - 1 - root, 2);
+    r.hi = floor_div_i32(cx2 - 1 + root, 2);
+    return r;
+}
 
-    const int32_t outerR = (int32_t)outer_r * 2;
-    const int32_t innerR = (int32_t)inner_r * 2;
-    const int32_t outerR2 = outerR * outerR;
-    const int32_t innerR2 = innerR * innerR;
-    const int32_t denom_outer = 2 * outerR;
-    const int32_t denom_inner = (innerR > 0) ? (2 * innerR) : 1;
-    const int32_t aa_half = 3;
+/*
+ * A row's disc roots depend only on the radii and the row's distance from
+ * the centre, so they are memoised per ring size: a gauge whose sweep moves
+ * every frame, replayed band by band by the compositor, solves each row
+ * once. Row k below the centre shares an entry with row k + 1 above it
+ * (same |py2|). A new size replaces the older slot.
+ */
+#define RING_ROOT_SLOTS 2u
+#define RING_ROOT_ROWS 128u
+
+struct ui_draw_ring_roots {
+    uint16_t outer_r;
+    uint16_t inner_r;
+    uint32_t solved[RING_ROOT_ROWS / 32u];
+    int16_t root[RING_ROOT_ROWS][4]; /* o0, o15, h0, h15 */
+};
 
-    const int32_t cx2 = (int32_t)cx * 2;
-    const int32_t cy2 = (int32_t)cy * 2;
+static struct {
+    struct ui_draw_ring_roots slot[RING_ROOT_SLOTS];
+    uint8_t n;
+    uint8_t next;
+} g_ring_roots;
 
-    if (ops->begin_window)
-        ops->begin_window(ctx, (uint16_t)x0, (uint16_t)y0, (uint16_t)w, (uint16_t)h);
+static struct ui_draw_ring_roots *ring_roots_for(uint16_t outer_r, uint16_t inner_r)
+{
+    /* Rows of the box reach outer_r + 2 from the centre. */
+    if ((uint32_t)outer_r + 3u > RING_ROOT_ROWS)
+        return NULL;
+    for (uint8_t i = 0; i < g_ring_roots.n; ++i)
+    {
+        struct ui_draw_ring_roots *c = &g_ring_roots.slot[i];
+        if (c->outer_r == outer_r && c->inner_r == inner_r)
+            return c;
+    }
+    struct ui_draw_ring_roots *c = &g_ring_roots.slot[g_ring_roots.next];
+    g_ring_roots.next = (uint8_t)((g_ring_roots.next + 1u) % RING_ROOT_SLOTS);
+    if (g_ring_roots.n < RING_ROOT_SLOTS)
+        g_ring_roots.n++;
+    c->outer_r = outer_r;
+    c->inner_r = inner_r;
+    memset(c->solved, 0, sizeof(c->solved));
+    return c;
+}
 
-    for (int yy = 0; yy < h; ++yy)
+static void ring_row_roots(const ui_draw_ring_t *r, int32_t py2, int32_t root[4])
+{
+    uint32_t k = (uint32_t)((py2 < 0) ? -py2 : py2) >> 1;
+    struct ui_draw_ring_roots *c = r->roots;
+    if (c && k < RING_ROOT_ROWS && ((c->solved[k >> 5] >> (k & 31u)) & 1u))
     {
-        int y = y0 + yy;
-        int32_t py = (int32_t)y - (int32_t)cy;
-        int32_t py2 = (int32_t)(y * 2 + 1) - cy2;
-        for (int xx = 0; xx < w; ++xx)
-        {
-            int x = x0 + xx;
-            int32_t px = (int32_t)x - (int32_t)cx;
-            int32_t px2 = (int32_t)(x * 2 + 1) - cx2;
-            int32_t dist2 = px2 * px2 + py2 * py2;
+        for (uint8_t i = 0; i < 4u; ++i)
+            root[i] = c->root[k][i];
+        return;
+    }
+    root[0] = disc_row_root(py2, r->outerR2 + RING_AA_HALF * r->denom_outer - 1);
+    root[1] = disc_row_root(py2, r->outerR2 - RING_AA_HALF * r->denom_outer);
+    root[2] = root[3] = -1;
+    if (r->innerR > 0)
+    {
+        root[2] = disc_row_root(py2, r->innerR2 - RING_AA_HALF * r->denom_inner);
+        root[3] = disc_row_root(py2, r->innerR2 + RING_AA_HALF * r->denom_inner - 1);
+    }
+    if (c && k < RING_ROOT_ROWS)
+    {
+        for (uint8_t i = 0; i < 4u; ++i)
+            c->root[k][i] = (int16_t)root[i];
+        c->solved[k >> 5] |= 1u << (k & 31u);
+    }
+}
 
-            uint8_t a4 = 0u;
-            if (sweep == 360u || arc_contains_cw(px, py, s, e, sweep))
-            {
-                int32_t sd_outer = (dist2 - outerR2) / denom_outer;
-                uint8_t a_outer = a4_from_sd_half(sd_outer, aa_half);
-                uint8_t a_inner = 15u;
-                if (innerR > 0)
-                {
-                    int32_t sd_inner = -(dist2 - innerR2) / denom_inner;
-                    a_inner = a4_from_sd_half(sd_inner, aa_half);
-                }
-                a4 = (a_outer < a_inner) ? a_outer : a_inner;
-            }
+/* Per-pixel A4 edge path (distance, coverage, blend): RAMFUNC, like the LCD
+ * writers it feeds. */
+static RAMFUNC uint16_t ring_edge_pixel(const ui_draw_ring_t *r, const uint16_t *lut, int x, int32_t py2)
+{
+    int32_t px2 = (int32_t)(x * 2 + 1) - r->cx2;
+    int32_t dist2 = px2 * px2 + py2 * py2;
 
-            ops->write_pixel(ctx, (uint16_t)x, (uint16_t)y, blend_rgb565(bg, fg, a4));
-        }
+    int32_t sd_outer = (dist2 - r->outerR2) / r->denom_outer;
+    uint8_t a_outer = a4_from_sd_half(sd_outer, RING_AA_HALF);
+    uint8_t a_inner = 15u;
+    if (r->innerR > 0)
+    {
+        int32_t sd_inner = -(dist2 - r->innerR2) / r->denom_inner;
+        a_inner = a4_from_sd_half(sd_inner, RING_AA_HALF);
     }
+    return lut[(a_outer < a_inner) ? a_outer : a_inner];
 }
 
-void ui_draw_ring_gauge_a4(const ui_draw_pixel_writer_t *ops, void *ctx,
-                           uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
-                           int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
-                           int16_t start_deg_cw, uint16_t sweep_deg_cw, uint16_t active_sweep_deg_cw,
-                           uint16_t fg_active, uint16_t fg_inactive, uint16_t bg)
+static void ring_add_break(int32_t *breaks, uint8_t *count, int32_t v, int32_t x0, int32_t x1)
 {
-    if (!ops || !ops->write_pixel)
-        return;
-    if (outer_r == 0u || thickness == 0u || sweep_deg_cw == 0u)
+    if (v <= x0 || v >= x1 || *count >= UI_DRAW_RING_MAX_BREAKS)
         return;
-    if (clip_w == 0u || clip_h == 0u)
+    uint8_t i = *count;
+    for (uint8_t j = 0; j < i; ++j)
+    {
+        if (breaks[j] == v)
+            return;
+    }
+    while (i > 0u && breaks[i - 1u] > v)
+    {
+        breaks[i] = breaks[i - 1u];
+        i--;
+    }
+    breaks[i] = v;
+    (*count)++;
+}
+
+static void ring_add_span_breaks(int32_t *breaks, uint8_t *count, ring_span_t sp, int32_t off,
+                                 int32_t x0, int32_t x1)
+{
+    if (sp.lo > sp.hi)
         return;
+    if (sp.lo > RING_SPAN_ALL_LO)
+        ring_add_break(breaks, count, sp.lo + off, x0, x1);
+    if (sp.hi < RING_SPAN_ALL_HI)
+        ring_add_break(breaks, count, sp.hi + 1 + off, x0, x1);
+}
 
-    if (thickness >= outer_r)
-        thickness = outer_r;
-    uint16_t inner_r = (uint16_t)(outer_r - thickness);
+void ui_draw_ring_row(const ui_draw_ring_t *r, int y, ui_draw_ring_row_t *out)
+{
+    const int32_t py = (int32_t)y - (int32_t)r->cy;
+    const int32_t py2 = (int32_t)(y * 2 + 1) - r->cy2;
+    const int32_t x0 = r->x0;
+    const int32_t x1 = x0 + (int32_t)r->w;
+
+    /* Radial classes (in x): outer not clear / outer fully covered / hole clear / hole not covered. */
+    int32_t root[4];
+    ring_row_roots(r, py2, root);
+    ring_span_t o0 = disc_row_span(r->cx2, root[0]);
+    ring_span_t o15 = disc_row_span(r->cx2, root[1]);
+    ring_span_t h0 = disc_row_span(r->cx2, root[2]);
+    ring_span_t h15 = disc_row_span(r->cx2, root[3]);
+
+    /* Angular classes (in px = x - cx). */
+    ring_arc_row_t a_full = arc_row(py, r->s, r->e_full, r->sweep);
+    ring_arc_row_t a_act = arc_row(py, r->s, r->e_act, r->active_sweep);
+
+    int32_t breaks[UI_DRAW_RING_MAX_BREAKS + 1u];
+    uint8_t nb = 0u;
+    ring_add_span_breaks(breaks, &nb, o0, 0, x0, x1);
+    ring_add_span_breaks(breaks, &nb, o15, 0, x0, x1);
+    ring_add_span_breaks(breaks, &nb, h0, 0, x0, x1);
+    ring_add_span_breaks(breaks, &nb, h15, 0, x0, x1);
+    ring_add_span_breaks(breaks, &nb, a_full.span, r->cx, x0, x1);
+    ring_add_span_breaks(breaks, &nb, a_act.span, r->cx, x0, x1);
+    breaks[nb] = x1;
+
+    int32_t seg = x0;
+    out->n = 0u;
+    for (uint8_t i = 0; i <= nb; ++i)
+    {
+        int32_t end = breaks[i];
+        if (end <= seg)
+            continue;
+
+        uint8_t clear = (uint8_t)(!span_has(o0, seg) || span_has(h0, seg));
+        uint8_t solid = (uint8_t)(span_has(o15, seg) && !span_has(h15, seg));
+        int32_t px = seg - (int32_t)r->cx;
+        uint8_t in_full = arc_row_has(&a_full, px);
+        uint8_t in_act = (uint8_t)(r->active_sweep && arc_row_has(&a_act, px));
+
+        uint8_t n = out->n++;
+        out->seg[n].x = (int16_t)seg;
+        out->seg[n].n = (uint16_t)(end - seg);
+        out->seg[n].edge = 0u;
+        if (clear || !in_full)
+        {
+            out->seg[n].color = r->bg;
+        }
+        else if (solid)
+        {
+            out->seg[n].color = in_act ? r->fg_active : r->fg_inactive;
+        }
+        else
+        {
+            const uint16_t *lut = in_act ? r->lut_active : r->lut_inactive;
+            out->seg[n].edge = 1u;
+            for (int32_t x = seg; x < end; ++x)
+                out->px[x - x0] = ring_edge_pixel(r, lut, (int)x, py2);
+        }
+        seg = end;
+    }
+}
 
+static int ring_clip_box(uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
+                         int16_t cx, int16_t cy, uint16_t outer_r,
+                         int *out_x0, int *out_y0, int *out_w, int *out_h)
+{
     int x0 = (int)cx - (int)outer_r - 2;
     int y0 = (int)cy - (int)outer_r - 2;
     int w = 2 * (int)outer_r + 4;
@@ -462,65 +868,164 @@ void ui_draw_ring_gauge_a4(const ui_draw_pixel_writer_t *ops, void *ctx,
         h = (int)DISP_H - y0;
 
     if (w <= 0 || h <= 0)
-        return;
+        return 0;
+    *out_x0 = x0;
+    *out_y0 = y0;
+    *out_w = w;
+    *out_h = h;
+    return 1;
+}
+
+uint8_t ui_draw_ring_setup(ui_draw_ring_t *r,
+                           uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
+                           int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
+                           int16_t start_deg_cw, uint16_t sweep_deg_cw, uint16_t active_sweep_deg_cw,
+                           uint16_t fg_active, uint16_t fg_inactive, uint16_t bg)
+{
+    if (outer_r == 0u || thickness == 0u || sweep_deg_cw == 0u)
+        return 0u;
+    if (clip_w == 0u || clip_h == 0u)
+        return 0u;
 
     uint16_t sweep = sweep_deg_cw;
     if (sweep > 360u)
         sweep = 360u;
-
     uint16_t active_sweep = active_sweep_deg_cw;
     if (active_sweep > sweep)
         active_sweep = sweep;
 
-    ui_vec2_i16_t s = ui_trig_unit_deg_cw_q15(start_deg_cw);
-    ui_vec2_i16_t e_full = ui_trig_unit_deg_cw_q15((int16_t)(start_deg_cw + (int16_t)sweep));
-    ui_vec2_i16_t e_act = ui_trig_unit_deg_cw_q15((int16_t)(start_deg_cw + (int16_t)active_sweep));
+    if (thickness >= outer_r)
+        thickness = outer_r;
+    uint16_t inner_r = (uint16_t)(outer_r - thickness);
+
+    int x0, y0, w, h;
+    if (!ring_clip_box(clip_x, clip_y, clip_w, clip_h, cx, cy, outer_r, &x0, &y0, &w, &h))
+        return 0u;
 
+    r->x0 = (int16_t)x0;
+    r->y0 = (int16_t)y0;
+    r->w = (int16_t)w;
+    r->h = (int16_t)h;
+    r->cx = cx;
+    r->cy = cy;
+    r->cx2 = (int32_t)cx * 2;
+    r->cy2 = (int32_t)cy * 2;
     const int32_t outerR = (int32_t)outer_r * 2;
-    const int32_t innerR = (int32_t)inner_r * 2;
-    const int32_t outerR2 = outerR * outerR;
-    const int32_t innerR2 = innerR * innerR;
-    const int32_t denom_outer = 2 * outerR;
-    const int32_t denom_inner = (innerR > 0) ? (2 * innerR) : 1;
-    const int32_t aa_half = 3;
+    r->innerR = (int32_t)inner_r * 2;
+    r->outerR2 = outerR * outerR;
+    r->innerR2 = r->innerR * r->innerR;
+    r->denom_outer = 2 * outerR;
+    r->denom_inner = (r->innerR > 0) ? (2 * r->innerR) : 1;
+    r->sweep = sweep;
+    r->active_sweep = active_sweep;
+    r->s = ui_trig_unit_deg_cw_q15(start_deg_cw);
+    r->e_full = ui_trig_unit_deg_cw_q15((int16_t)(start_deg_cw + (int16_t)sweep));
+    r->e_act = ui_trig_unit_deg_cw_q15((int16_t)(start_deg_cw + (int16_t)active_sweep));
+    r->fg_active = fg_active;
+    r->fg_inactive = fg_inactive;
+    r->bg = bg;
+    r->lut_active = ui_draw_blend_lut(bg, fg_active);
+    r->lut_inactive = ui_draw_blend_lut(bg, fg_inactive);
+    r->roots = ring_roots_for(outer_r, inner_r);
+    return 1u;
+}
 
-    const int32_t cx2 = (int32_t)cx * 2;
-    const int32_t cy2 = (int32_t)cy * 2;
+void ui_draw_ring_arc_a4(const ui_draw_pixel_writer_t *ops, void *ctx,
+                         uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
+                         int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
+                         int16_t start_deg_cw, uint16_t sweep_deg_cw,
+                         uint16_t fg, uint16_t bg)
+{
+    if (ops)
+        ui_draw_px_ring_arc_a4(ops, ctx, clip_x, clip_y, clip_w, clip_h, cx, cy, outer_r, thickness,
+                               start_deg_cw, sweep_deg_cw, fg, bg);
+}
 
-    if (ops->begin_window)
-        ops->begin_window(ctx, (uint16_t)x0, (uint16_t)y0, (uint16_t)w, (uint16_t)h);
+void ui_draw_ring_gauge_a4(const ui_draw_pixel_writer_t *ops, void *ctx,
+                           uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
+                           int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
+                           int16_t start_deg_cw, uint16_t sweep_deg_cw, uint16_t active_sweep_deg_cw,
+                           uint16_t fg_active, uint16_t fg_inactive, uint16_t bg)
+{
+    if (ops)
+        ui_draw_px_ring_gauge_a4(ops, ctx, clip_x, clip_y, clip_w, clip_h, cx, cy, outer_r, thickness,
+                                 start_deg_cw, sweep_deg_cw, active_sweep_deg_cw,
+                                 fg_active, fg_inactive, bg);
+}
 
-    for (int yy = 0; yy < h; ++yy)
+/* Output row `row`: face row `row`, and face row `row - shadow_ofs` shifted
+ * right by as much for the shadow. Returns 0 on a malformed stream. */
+static RAMFUNC uint8_t glyph_row_load(ui_draw_glyph_iter_t *it, uint16_t row, ui_draw_glyph_row_t *out)
+{
+    const ui_draw_glyph_t *g = it->g;
+    uint16_t ofs = g->shadow_ofs;
+    memset(out, 0, sizeof(*out));
+    if (row < g->h)
     {
-        int y = y0 + yy;
-        int32_t py = (int32_t)y - (int32_t)cy;
-        int32_t py2 = (int32_t)(y * 2 + 1) - cy2;
-        for (int xx = 0; xx < w; ++xx)
-        {
-            int x = x0 + xx;
-            int32_t px = (int32_t)x - (int32_t)cx;
-            int32_t px2 = (int32_t)(x * 2 + 1) - cx2;
-            int32_t dist2 = px2 * px2 + py2 * py2;
-
-            uint8_t a4 = 0u;
-            uint16_t fg = fg_inactive;
-            if (sweep == 360u || arc_contains_cw(px, py, s, e_full, sweep))
-            {
-                if (active_sweep && arc_contains_cw(px, py, s, e_act, active_sweep))
-                    fg = fg_active;
-
-                int32_t sd_outer = (dist2 - outerR2) / denom_outer;
-                uint8_t a_outer = a4_from_sd_half(sd_outer, aa_half);
-                uint8_t a_inner = 15u;
-                if (innerR > 0)
-                {
-                    int32_t sd_inner = -(dist2 - innerR2) / denom_inner;
-                    a_inner = a4_from_sd_half(sd_inner, aa_half);
-                }
-                a4 = (a_outer < a_inner) ? a_outer : a_inner;
-            }
+        uint32_t used = ui_draw_a4_rle_alpha(&g->rle[it->face_off], g->len - it->face_off, g->w, out->face);
+        if (used == 0u)
+            return 0u;
+        it->face_off += used;
+    }
+    if (ofs != 0u && row >= ofs)
+    {
+        uint32_t used = ui_draw_a4_rle_alpha(&g->rle[it->drop_off], g->len - it->drop_off, g->w, &out->drop[ofs]);
+        if (used == 0u)
+            return 0u;
+        it->drop_off += used;
+    }
+    return 1u;
+}
+
+RAMFUNC uint8_t ui_draw_glyph_begin(ui_draw_glyph_iter_t *it, const ui_draw_glyph_t *g)
+{
+    if (!g || !g->rle || g->w == 0u || g->w > UI_GLYPH_MAX_W || g->shadow_ofs > UI_GLYPH_MAX_SHADOW)
+        return 0u;
+    it->g = g;
+    it->face_off = 0u;
+    it->drop_off = 0u;
+    it->ow = (uint16_t)(g->w + g->shadow_ofs);
+    it->oh = (uint16_t)(g->h + g->shadow_ofs);
+    it->row = 0u;
+    it->band = 0u;
+    it->cur = 0u;
+    it->more = 0u;
+    if (it->oh == 0u || !glyph_row_load(it, 0u, &it->rows[0]))
+        return 0u;
+    it->face_bg = ui_draw_blend_lut(g->bg, g->fg);
+    it->face_shadow = ui_draw_blend_lut(g->shadow, g->fg);
+    it->shadow_bg = ui_draw_blend_lut(g->bg, g->shadow);
+    return 1u;
+}
 
-            ops->write_pixel(ctx, (uint16_t)x, (uint16_t)y, blend_rgb565(bg, fg, a4));
+RAMFUNC uint8_t ui_draw_glyph_next(ui_draw_glyph_iter_t *it)
+{
+    it->row = (uint16_t)(it->row + it->band);
+    if (it->more)
+        it->cur ^= 1u;
+    if (it->row >= it->oh)
+        return 0u;
+
+    /* Extend the band while the next row decodes identical. */
+    it->band = 1u;
+    it->more = 0u;
+    while (it->row + it->band < it->oh)
+    {
+        if (!glyph_row_load(it, (uint16_t)(it->row + it->band), &it->rows[it->cur ^ 1u]))
+            return 0u;
+        if (memcmp(&it->rows[0], &it->rows[1], sizeof(it->rows[0])) != 0)
+        {
+            it->more = 1u;
+            break;
         }
+        it->band++;
     }
+    return 1u;
+}
+
+RAMFUNC void ui_draw_glyph_a4(const ui_draw_pixel_writer_t *ops, void *ctx, uint16_t x, uint16_t y,
+                              const ui_draw_glyph_t *g)
+{
+    if (ops)
+        ui_draw_px_glyph_a4(ops, ctx, x, y, g);
 }
@@ -20,8 +20,70 @@ typedef struct {
 typedef struct {
     void (*begin_window)(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
     void (*write_pixel)(void *ctx, uint16_t x, uint16_t y, uint16_t color);
+    /* Optional: n pixels of one colour starting at (x, y) in stream order. */
+    void (*write_run)(void *ctx, uint16_t x, uint16_t y, uint16_t n, uint16_t color);
 } ui_draw_pixel_writer_t;
 
+typedef struct {
+    uint16_t x;
+    uint16_t y;
+    uint16_t w; /* 0: layer absent */
+    uint16_t h;
+    uint8_t radius;
+} ui_draw_rrect_t;
+
+/* Panel layers, bottom to top: drop shadow, border body, (dithered) fill. */
+typedef struct {
+    ui_draw_rrect_t shadow;
+    ui_draw_rrect_t body;
+    ui_draw_rrect_t fill;
+    uint16_t shadow_color;
+    uint16_t border;
+    uint16_t fill_color;
+    uint16_t fill_alt;
+    uint8_t dither_level; /* 0: solid fill */
+} ui_draw_panel_t;
+
+/*
+ * Sprite held outside the image (storage/ui_assets.c pack in SPI flash).
+ * RGB565 sprites are pre-tinted, w*h big-endian pixels the panel takes
+ * straight from SPI flash by DMA. A4 sprites are the RLE alpha rows of
+ * scripts/pack_ui_icons.py, tinted fg over bg while they are decoded.
+ */
+#define UI_SPRITE_FMT_RGB565 1u
+#define UI_SPRITE_FMT_A4_RLE 2u
+/* A4 sprites are read into a stack buffer in one go. */
+#define UI_SPRITE_A4_MAX_BYTES 512u
+
+typedef struct {
+    uint32_t addr; /* SPI flash address of the pixel data */
+    uint32_t tag;  /* changes when the stored pack does (part of the frame hash) */
+    uint16_t w;
+    uint16_t h;
+    uint16_t len;
+    uint8_t fmt;
+} ui_sprite_t;
+
+/*
+ * Anti-aliased glyph from an A4 RLE stream in RAM (a big digit from the
+ * asset pack), with an optional drop shadow of the same shape shadow_ofs px
+ * down and right. Like the 7-segment digits it leaves uncovered pixels
+ * alone; edges are blended towards bg.
+ */
+#define UI_GLYPH_MAX_W      128u
+#define UI_GLYPH_MAX_SHADOW 4u
+
+typedef struct {
+    const uint8_t *rle;
+    uint32_t len;
+    uint16_t w;
+    uint16_t h;
+    uint16_t fg;
+    uint16_t shadow;
+    uint16_t bg;
+    uint8_t shadow_ofs; /* 0: no shadow */
+} ui_draw_glyph_t;
+
 void ui_draw_format_value(char *out, size_t len, const char *label, long value);
 
 uint16_t ui_draw_dither_pick(uint16_t x, uint16_t y, uint16_t c0, uint16_t c1, uint8_t level);
@@ -31,12 +93,24 @@ void ui_draw_fill_round_rect(const ui_draw_rect_ops_t *ops, void *ctx, uint16_t
 void ui_draw_fill_round_rect_dither(const ui_draw_rect_ops_t *ops, void *ctx, uint16_t x, uint16_t y,
                                     uint16_t w, uint16_t h, uint16_t color, uint16_t alt,
                                     uint8_t radius, uint8_t level);
+/* Same pixels as filling the three layers in order, each written once. */
+void ui_draw_fill_panel(const ui_draw_rect_ops_t *ops, void *ctx, const ui_draw_panel_t *p);
+/* Decodes one A4 RLE row, [len:2 LE][tokens], into w alpha values (0..15).
+ * Returns the bytes consumed, 0 if the row does not fit in avail or a token
+ * is malformed. */
+uint32_t ui_draw_a4_rle_alpha(const uint8_t *src, uint32_t avail, uint16_t w, uint8_t *alpha);
+/* Same row as w pixels of fg blended over bg (w at most the panel width). */
+uint32_t ui_draw_a4_rle_row(const uint8_t *src, uint32_t avail, uint16_t w,
+                            uint16_t fg, uint16_t bg, uint16_t *out);
 void ui_draw_big_digit_7seg(const ui_draw_rect_ops_t *ops, void *ctx, uint16_t x, uint16_t y,
                             uint8_t digit, uint8_t scale, uint16_t color);
 void ui_draw_battery_icon_ops(const ui_draw_rect_ops_t *ops, void *ctx, uint16_t x, uint16_t y,
                           uint16_t w, uint16_t h, uint8_t soc, uint16_t color, uint16_t bg);
 void ui_draw_warning_icon_ops(const ui_draw_rect_ops_t *ops, void *ctx, uint16_t x, uint16_t y, uint16_t color);
 
+void ui_draw_glyph_a4(const ui_draw_pixel_writer_t *ops, void *ctx, uint16_t x, uint16_t y,
+                      const ui_draw_glyph_t *g);
+
 void ui_draw_ring_arc_a4(const ui_draw_pixel_writer_t *ops, void *ctx,
                          uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
                          int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
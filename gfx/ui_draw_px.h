@@ -0,0 +1,334 @@
+#ifndef UI_DRAW_PX_H
+#define UI_DRAW_PX_H
+
+#include <stdint.h>
+#include <string.h>
+
+#include "ui_display.h"
+#include "ui_draw_common.h"
+#include "ui_trig.h"
+
+/*
+ * The writer-facing loops of the hot primitives (round rects, A4 rings and
+ * glyphs) as inline templates over the ops tables. A backend that passes its
+ * own `static const` table gets a copy with the callbacks resolved and
+ * inlined (gfx/ui_lcd.c, for the panel and the compositor bands); the
+ * ui_draw_* entry points in ui_draw_common.c expand the same loops over a
+ * table only known at run time, for the host pixel sink, traces and tests.
+ * Everything that does not touch the writer (row geometry, RLE decoding,
+ * blends) stays out of line in ui_draw_common.c.
+ */
+#define UI_DRAW_PX_INLINE static inline __attribute__((always_inline))
+
+/* --- Round rects --------------------------------------------------------- */
+
+/* Corner inset of row dy (0..r-1) of a round rect's top and bottom bands. */
+uint16_t ui_draw_corner_inset(uint8_t r, uint16_t dy);
+/* All r insets of radius r, memoised; NULL for radii too big to keep. The
+ * table stays valid for the next few lookups. */
+const uint8_t *ui_draw_corner_insets(uint8_t r);
+
+UI_DRAW_PX_INLINE uint16_t ui_draw_px_inset(const uint8_t *insets, uint8_t r, uint16_t dy)
+{
+    return insets ? insets[dy] : ui_draw_corner_inset(r, dy);
+}
+
+UI_DRAW_PX_INLINE void ui_draw_px_fill_round_rect(const ui_draw_rect_ops_t *ops, void *ctx,
+                                                  uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                                                  uint16_t color, uint8_t radius)
+{
+    if (!ops->fill_hline || !ops->fill_rect)
+        return;
+    if (w == 0u || h == 0u)
+        return;
+
+    uint8_t r = radius;
+    if (r == 0u || w <= (uint16_t)(2u * r) || h <= (uint16_t)(2u * r))
+    {
+        ops->fill_rect(ctx, x, y, w, h, color);
+        return;
+    }
+
+    const uint8_t *insets = ui_draw_corner_insets(r);
+    for (uint16_t dy = 0; dy < r; ++dy)
+    {
+        uint16_t inset = ui_draw_px_inset(insets, r, dy);
+        uint16_t span_w = (uint16_t)(w - 2u * inset);
+        ops->fill_hline(ctx, (uint16_t)(x + inset), (uint16_t)(y + dy), span_w, color);
+    }
+
+    uint16_t mid_h = (uint16_t)(h - 2u * (uint16_t)r);
+    ops->fill_rect(ctx, x, (uint16_t)(y + r), w, mid_h, color);
+
+    for (uint16_t dy = 0; dy < r; ++dy)
+    {
+        uint16_t yrow = (uint16_t)(h - r + dy);
+        uint16_t inset = ui_draw_px_inset(insets, r, dy);
+        uint16_t span_w = (uint16_t)(w - 2u * inset);
+        ops->fill_hline(ctx, (uint16_t)(x + inset), (uint16_t)(y + yrow), span_w, color);
+    }
+}
+
+UI_DRAW_PX_INLINE void ui_draw_px_fill_round_rect_dither(const ui_draw_rect_ops_t *ops, void *ctx,
+                                                         uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                                                         uint16_t color, uint16_t alt,
+                                                         uint8_t radius, uint8_t level)
+{
+    if (!ops->fill_hline_dither || !ops->fill_rect_dither)
+        return;
+    if (w == 0u || h == 0u)
+        return;
+
+    if (level == 0u || color == alt)
+    {
+        ui_draw_px_fill_round_rect(ops, ctx, x, y, w, h, color, radius);
+        return;
+    }
+    if (level >= 16u)
+    {
+        ui_draw_px_fill_round_rect(ops, ctx, x, y, w, h, alt, radius);
+        return;
+    }
+
+    uint8_t r = radius;
+    if (r == 0u || w <= (uint16_t)(2u * r) || h <= (uint16_t)(2u * r))
+    {
+        ops->fill_rect_dither(ctx, x, y, w, h, color, alt, level);
+        return;
+    }
+
+    const uint8_t *insets = ui_draw_corner_insets(r);
+    for (uint16_t dy = 0; dy < r; ++dy)
+    {
+        uint16_t inset = ui_draw_px_inset(insets, r, dy);
+        uint16_t span_w = (uint16_t)(w - 2u * inset);
+        ops->fill_hline_dither(ctx, (uint16_t)(x + inset), (uint16_t)(y + dy), span_w, color, alt, level);
+    }
+
+    uint16_t mid_h = (uint16_t)(h - 2u * (uint16_t)r);
+    ops->fill_rect_dither(ctx, x, (uint16_t)(y + r), w, mid_h, color, alt, level);
+
+    for (uint16_t dy = 0; dy < r; ++dy)
+    {
+        uint16_t yrow = (uint16_t)(h - r + dy);
+        uint16_t inset = ui_draw_px_inset(insets, r, dy);
+        uint16_t span_w = (uint16_t)(w - 2u * inset);
+        ops->fill_hline_dither(ctx, (uint16_t)(x + inset), (uint16_t)(y + yrow), span_w, color, alt, level);
+    }
+}
+
+/* --- A4 rings -------------------------------------------------------------- */
+
+/* A row splits at most at this many points (radial and angular edges). */
+#define UI_DRAW_RING_MAX_BREAKS 16u
+
+typedef struct {
+    /* Window: the ring's box cut to the clip and the panel. */
+    int16_t x0, y0, w, h;
+    int16_t cx;
+    int16_t cy;
+    int32_t cx2;
+    int32_t cy2;
+    int32_t outerR2;
+    int32_t innerR2;
+    int32_t innerR;
+    int32_t denom_outer;
+    int32_t denom_inner;
+    ui_vec2_i16_t s;
+    ui_vec2_i16_t e_full;
+    ui_vec2_i16_t e_act;
+    uint16_t sweep;
+    uint16_t active_sweep;
+    uint16_t fg_active;
+    uint16_t fg_inactive;
+    uint16_t bg;
+    const uint16_t *lut_active; /* A4 blends of fg_* over bg */
+    const uint16_t *lut_inactive;
+    struct ui_draw_ring_roots *roots; /* memoised radial crossings, or NULL */
+} ui_draw_ring_t;
+
+/* One row as segments: runs of one colour, and AA edges whose pixels were
+ * evaluated into px[] (indexed from the window's x0). */
+typedef struct {
+    struct {
+        int16_t x;
+        uint16_t n;
+        uint16_t color;
+        uint8_t edge;
+    } seg[UI_DRAW_RING_MAX_BREAKS + 1u];
+    uint8_t n;
+    uint16_t px[DISP_W];
+} ui_draw_ring_row_t;
+
+/* Arc or gauge setup (an arc is a gauge whose active sweep is the whole
+ * arc); 0 when there is nothing to draw. */
+uint8_t ui_draw_ring_setup(ui_draw_ring_t *r,
+                           uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
+                           int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
+                           int16_t start_deg_cw, uint16_t sweep_deg_cw, uint16_t active_sweep_deg_cw,
+                           uint16_t fg_active, uint16_t fg_inactive, uint16_t bg);
+void ui_draw_ring_row(const ui_draw_ring_t *r, int y, ui_draw_ring_row_t *out);
+
+UI_DRAW_PX_INLINE void ui_draw_px_run(const ui_draw_pixel_writer_t *ops, void *ctx,
+                                      uint16_t x, uint16_t y, uint16_t n, uint16_t color)
+{
+    if (ops->write_run)
+    {
+        ops->write_run(ctx, x, y, n, color);
+        return;
+    }
+    for (uint16_t i = 0; i < n; ++i)
+        ops->write_pixel(ctx, (uint16_t)(x + i), y, color);
+}
+
+UI_DRAW_PX_INLINE void ui_draw_px_ring(const ui_draw_pixel_writer_t *ops, void *ctx, const ui_draw_ring_t *r)
+{
+    ui_draw_ring_row_t row;
+    if (ops->begin_window)
+        ops->begin_window(ctx, (uint16_t)r->x0, (uint16_t)r->y0, (uint16_t)r->w, (uint16_t)r->h);
+    for (int y = r->y0; y < r->y0 + r->h; ++y)
+    {
+        ui_draw_ring_row(r, y, &row);
+        for (uint8_t i = 0; i < row.n; ++i)
+        {
+            uint16_t x = (uint16_t)row.seg[i].x;
+            uint16_t n = row.seg[i].n;
+            if (!row.seg[i].edge)
+            {
+                ui_draw_px_run(ops, ctx, x, (uint16_t)y, n, row.seg[i].color);
+                continue;
+            }
+            const uint16_t *px = &row.px[x - r->x0];
+            for (uint16_t k = 0; k < n; ++k)
+                ops->write_pixel(ctx, (uint16_t)(x + k), (uint16_t)y, px[k]);
+        }
+    }
+}
+
+UI_DRAW_PX_INLINE void ui_draw_px_ring_gauge_a4(const ui_draw_pixel_writer_t *ops, void *ctx,
+                                                uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
+                                                int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
+                                                int16_t start_deg_cw, uint16_t sweep_deg_cw,
+                                                uint16_t active_sweep_deg_cw,
+                                                uint16_t fg_active, uint16_t fg_inactive, uint16_t bg)
+{
+    ui_draw_ring_t r;
+    if (!ops->write_pixel)
+        return;
+    if (ui_draw_ring_setup(&r, clip_x, clip_y, clip_w, clip_h, cx, cy, outer_r, thickness,
+                           start_deg_cw, sweep_deg_cw, active_sweep_deg_cw, fg_active, fg_inactive, bg))
+        ui_draw_px_ring(ops, ctx, &r);
+}
+
+UI_DRAW_PX_INLINE void ui_draw_px_ring_arc_a4(const ui_draw_pixel_writer_t *ops, void *ctx,
+                                              uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
+                                              int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
+                                              int16_t start_deg_cw, uint16_t sweep_deg_cw,
+                                              uint16_t fg, uint16_t bg)
+{
+    ui_draw_px_ring_gauge_a4(ops, ctx, clip_x, clip_y, clip_w, clip_h, cx, cy, outer_r, thickness,
+                             start_deg_cw, sweep_deg_cw, sweep_deg_cw, fg, fg, bg);
+}
+
+/* --- A4 glyphs ------------------------------------------------------------- */
+
+/* A4 blend of fg over bg, and the memoised 16-step table of the pair. */
+uint16_t ui_draw_blend_rgb565(uint16_t bg, uint16_t fg, uint8_t a4);
+const uint16_t *ui_draw_blend_lut(uint16_t bg, uint16_t fg);
+
+typedef struct {
+    uint8_t face[UI_GLYPH_MAX_W + UI_GLYPH_MAX_SHADOW];
+    uint8_t drop[UI_GLYPH_MAX_W + UI_GLYPH_MAX_SHADOW];
+} ui_draw_glyph_row_t;
+
+/* Walks a glyph's output rows as bands of identical ones. */
+typedef struct {
+    const ui_draw_glyph_t *g;
+    uint32_t face_off;
+    uint32_t drop_off;
+    const uint16_t *face_bg; /* face over the background */
+    const uint16_t *face_shadow;
+    const uint16_t *shadow_bg;
+    ui_draw_glyph_row_t rows[2];
+    uint16_t ow, oh;
+    uint16_t row;  /* first output row of the band */
+    uint16_t band; /* rows in it, all rows[cur] */
+    uint8_t cur;
+    uint8_t more;
+} ui_draw_glyph_iter_t;
+
+/* 0 when the glyph is malformed or empty. */
+uint8_t ui_draw_glyph_begin(ui_draw_glyph_iter_t *it, const ui_draw_glyph_t *g);
+/* Steps to the next band; 0 when done or the stream turns out malformed
+ * (bands already returned stay drawn). */
+uint8_t ui_draw_glyph_next(ui_draw_glyph_iter_t *it);
+
+/* Face over shadow over bg; only AA edges crossing the shadow edge blend twice. */
+UI_DRAW_PX_INLINE uint16_t ui_draw_glyph_px(const ui_draw_glyph_iter_t *it, uint8_t face, uint8_t drop)
+{
+    if (drop == 0u)
+        return it->face_bg[face];
+    if (face == 0u)
+        return it->shadow_bg[drop];
+    if (drop >= 15u)
+        return it->face_shadow[face];
+    return ui_draw_blend_rgb565(it->shadow_bg[drop], it->g->fg, face);
+}
+
+UI_DRAW_PX_INLINE void ui_draw_px_glyph_span(const ui_draw_pixel_writer_t *ops, void *ctx,
+                                             const ui_draw_glyph_iter_t *it, const ui_draw_glyph_row_t *r,
+                                             uint16_t c, uint16_t end, uint16_t x, uint16_t y)
+{
+    while (c < end)
+    {
+        uint16_t run = 1u;
+        while (c + run < end && r->face[c + run] == r->face[c] && r->drop[c + run] == r->drop[c])
+            run++;
+        uint16_t color = ui_draw_glyph_px(it, r->face[c], r->drop[c]);
+        if (run > 1u && ops->write_run)
+        {
+            ops->write_run(ctx, (uint16_t)(x + c), y, run, color);
+        }
+        else
+        {
+            for (uint16_t i = 0; i < run; ++i)
+                ops->write_pixel(ctx, (uint16_t)(x + c + i), y, color);
+        }
+        c = (uint16_t)(c + run);
+    }
+}
+
+/*
+ * Face and drop shadow composited in one pass; only covered columns are
+ * written. Consecutive identical rows (straight stems) share one window per
+ * span, each other row costs a window per span.
+ */
+UI_DRAW_PX_INLINE void ui_draw_px_glyph_a4(const ui_draw_pixel_writer_t *ops, void *ctx,
+                                           uint16_t x, uint16_t y, const ui_draw_glyph_t *g)
+{
+    ui_draw_glyph_iter_t it;
+    if (!ops->begin_window || !ops->write_pixel || !ui_draw_glyph_begin(&it, g))
+        return;
+    while (ui_draw_glyph_next(&it))
+    {
+        const ui_draw_glyph_row_t *r = &it.rows[it.cur];
+        uint16_t c = 0u;
+        while (c < it.ow)
+        {
+            if (r->face[c] == 0u && r->drop[c] == 0u)
+            {
+                c++;
+                continue;
+            }
+            uint16_t end = c;
+            while (end < it.ow && (r->face[end] != 0u || r->drop[end] != 0u))
+                end++;
+            ops->begin_window(ctx, (uint16_t)(x + c), (uint16_t)(y + it.row), (uint16_t)(end - c), it.band);
+            for (uint16_t k = 0; k < it.band; ++k)
+                ui_draw_px_glyph_span(ops, ctx, &it, r, c, end, x, (uint16_t)(y + it.row + k));
+            c = end;
+        }
+    }
+}
+
+#endif
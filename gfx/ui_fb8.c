@@ -0,0 +1,350 @@
+#include "ui_fb8.h"
+
+#include <string.h>
+
+static inline uint8_t bit_get(const uint32_t *m, uint32_t i)
+{
+    return (uint8_t)((m[i >> 5] >> (i & 31u)) & 1u);
+}
+
+static inline void bit_set(uint32_t *m, uint32_t i)
+{
+    m[i >> 5] |= 1u << (i & 31u);
+}
+
+static inline void bit_clear(uint32_t *m, uint32_t i)
+{
+    m[i >> 5] &= ~(1u << (i & 31u));
+}
+
+static inline uint16_t hash_slot(uint16_t color)
+{
+    return (uint16_t)((((uint32_t)color * 40503u) >> 7) & (UI_FB8_HASH - 1u));
+}
+
+static void hash_insert(ui_fb8_t *fb, uint16_t color, uint16_t idx)
+{
+    uint16_t slot = hash_slot(color);
+    while (fb->hash[slot])
+        slot = (uint16_t)((slot + 1u) & (UI_FB8_HASH - 1u));
+    fb->hash[slot] = (uint16_t)(idx + 1u);
+}
+
+static void fb8_rehash(ui_fb8_t *fb)
+{
+    memset(fb->hash, 0, sizeof(fb->hash));
+    for (uint16_t i = 0; i < UI_FB8_COLORS; ++i)
+    {
+        if (bit_get(fb->used, i))
+            hash_insert(fb, fb->lut[i], i);
+    }
+    fb->last_ok = 0u;
+}
+
+/* LUT index of `color`, adding it; -1 when the LUT is full. */
+static int16_t fb8_index(ui_fb8_t *fb, uint16_t color)
+{
+    if (fb->last_ok && fb->last_color == color)
+        return fb->last_idx;
+    int16_t idx = -1;
+    for (uint16_t slot = hash_slot(color); fb->hash[slot]; slot = (uint16_t)((slot + 1u) & (UI_FB8_HASH - 1u)))
+    {
+        uint16_t i = (uint16_t)(fb->hash[slot] - 1u);
+        if (fb->lut[i] == color)
+        {
+            idx = (int16_t)i;
+            break;
+        }
+    }
+    if (idx < 0)
+    {
+        for (uint16_t i = 0; i < UI_FB8_COLORS; ++i)
+        {
+            if ((i & 31u) == 0u && fb->used[i >> 5] == 0xFFFFFFFFu)
+            {
+                i = (uint16_t)(i + 31u);
+                continue;
+            }
+            if (!bit_get(fb->used, i))
+            {
+                idx = (int16_t)i;
+                break;
+            }
+        }
+        if (idx < 0)
+            return -1;
+        bit_set(fb->used, (uint32_t)idx);
+        fb->lut[idx] = color;
+        hash_insert(fb, color, (uint16_t)idx);
+    }
+    fb->last_color = color;
+    fb->last_idx = (uint8_t)idx;
+    fb->last_ok = 1u;
+    return idx;
+}
+
+/* Keeps only the entries known tiles use. In the band being absorbed,
+ * covered pixels count once rewritten (before row r, column x) and not
+ * before, since they are about to be. */
+static void fb8_collect(ui_fb8_t *fb, const ui_band_t *b, uint16_t r, uint16_t x)
+{
+    fb->collects++;
+    memset(fb->used, 0, sizeof(fb->used));
+    for (uint16_t y = 0; y < DISP_H; ++y)
+    {
+        uint16_t ty = (uint16_t)(y / UI_FB8_TILE);
+        uint8_t band = (uint8_t)(y >= b->y0 && y < b->y0 + b->h);
+        uint16_t br = (uint16_t)(y - b->y0);
+        for (uint16_t tx = 0; tx < UI_FB8_TILES_X; ++tx)
+        {
+            uint8_t known = bit_get(fb->known, (uint32_t)ty * UI_FB8_TILES_X + tx);
+            if (!band && !known)
+                continue;
+            for (uint16_t i = (uint16_t)(tx * UI_FB8_TILE); i < (tx + 1u) * UI_FB8_TILE; ++i)
+            {
+                if (band)
+                {
+                    uint8_t reached = (uint8_t)(br < r || (br == r && i < x));
+                    if (ui_band_covered(b, br, i) ? !reached : !known)
+                        continue;
+                }
+                bit_set(fb->used, fb->idx[y][i]);
+            }
+        }
+    }
+    fb8_rehash(fb);
+}
+
+void ui_fb8_reset(ui_fb8_t *fb)
+{
+    memset(fb->used, 0, sizeof(fb->used));
+    memset(fb->hash, 0, sizeof(fb->hash));
+    memset(fb->known, 0, sizeof(fb->known));
+    memset(fb->dirty, 0, sizeof(fb->dirty));
+    fb->last_ok = 0u;
+    ui_fb8_remote_all(fb);
+    fb->remote_scan = 0u;
+}
+
+uint8_t ui_fb8_absorb(ui_fb8_t *fb, ui_band_t *b)
+{
+    if (b->bx0 >= b->bx1)
+        return 1u;
+    uint32_t row_tile = (uint32_t)(b->y0 / UI_FB8_TILE) * UI_FB8_TILES_X;
+    for (uint16_t r = 0; r < b->h; ++r)
+    {
+        const uint16_t *src = &b->px[(uint32_t)r * DISP_W];
+        uint8_t *dst = fb->idx[b->y0 + r];
+        for (uint16_t x = b->bx0; x < b->bx1; ++x)
+        {
+            if (!ui_band_covered(b, r, x))
+                continue;
+            int16_t idx = fb8_index(fb, src[x]);
+            if (idx < 0)
+            {
+                fb8_collect(fb, b, r, x);
+                idx = fb8_index(fb, src[x]);
+                if (idx < 0)
+                {
+                    fb->resets++;
+                    ui_fb8_reset(fb);
+                    return 0u;
+                }
+            }
+            if (dst[x] != (uint8_t)idx)
+            {
+                dst[x] = (uint8_t)idx;
+                bit_set(fb->dirty, row_tile + x / UI_FB8_TILE);
+                bit_set(fb->remote, row_tile + x / UI_FB8_TILE);
+            }
+        }
+    }
+    for (uint16_t tx = (uint16_t)(b->bx0 / UI_FB8_TILE); tx * UI_FB8_TILE < b->bx1; ++tx)
+    {
+        uint32_t t = row_tile + tx;
+        uint16_t x0 = (uint16_t)(tx * UI_FB8_TILE);
+        if (!bit_get(fb->known, t))
+        {
+            if (!ui_band_covers(b, x0, (uint16_t)(x0 + UI_FB8_TILE)))
+            {
+                /* Goes out from the band; the tile stays unknown. */
+                bit_clear(fb->dirty, t);
+                continue;
+            }
+            bit_set(fb->known, t);
+            bit_set(fb->dirty, t);
+            bit_set(fb->remote, t);
+        }
+        ui_band_uncover(b, x0, (uint16_t)(x0 + UI_FB8_TILE));
+    }
+    return 1u;
+}
+
+uint16_t ui_fb8_push_row(ui_fb8_t *fb, uint16_t ty, uint16_t *scratch, ui_band_push_fn push, void *ctx)
+{
+    uint32_t row_tile = (uint32_t)ty * UI_FB8_TILES_X;
+    uint16_t y0 = (uint16_t)(ty * UI_FB8_TILE);
+    uint16_t rects = 0u;
+    uint16_t tx = 0u;
+    while (tx < UI_FB8_TILES_X)
+    {
+        if (!bit_get(fb->dirty, row_tile + tx))
+        {
+            tx++;
+            continue;
+        }
+        uint16_t tx0 = tx;
+        while (tx < UI_FB8_TILES_X && bit_get(fb->dirty, row_tile + tx))
+            bit_clear(fb->dirty, row_tile + tx++);
+        uint16_t x0 = (uint16_t)(tx0 * UI_FB8_TILE);
+        uint16_t w = (uint16_t)((tx - tx0) * UI_FB8_TILE);
+        uint16_t *p = scratch;
+        for (uint16_t r = 0; r < UI_FB8_TILE; ++r)
+        {
+            const uint8_t *src = &fb->idx[y0 + r][x0];
+            for (uint16_t i = 0; i < w; ++i)
+                *p++ = fb->lut[src[i]];
+        }
+        push(ctx, x0, y0, w, UI_FB8_TILE, scratch, w);
+        rects++;
+    }
+    return rects;
+}
+
+void ui_fb8_forget(ui_fb8_t *fb, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    if (w == 0u || h == 0u || x >= DISP_W || y >= DISP_H)
+        return;
+    uint16_t tx1 = (uint16_t)(((uint32_t)x + w - 1u) / UI_FB8_TILE);
+    uint16_t ty1 = (uint16_t)(((uint32_t)y + h - 1u) / UI_FB8_TILE);
+    if (tx1 >= UI_FB8_TILES_X)
+        tx1 = UI_FB8_TILES_X - 1u;
+    if (ty1 >= UI_FB8_TILES_Y)
+        ty1 = UI_FB8_TILES_Y - 1u;
+    for (uint16_t ty = (uint16_t)(y / UI_FB8_TILE); ty <= ty1; ++ty)
+    {
+        for (uint16_t tx = (uint16_t)(x / UI_FB8_TILE); tx <= tx1; ++tx)
+        {
+            uint32_t t = (uint32_t)ty * UI_FB8_TILES_X + tx;
+            bit_clear(fb->known, t);
+            bit_clear(fb->dirty, t);
+        }
+    }
+}
+
+void ui_fb8_remote_all(ui_fb8_t *fb)
+{
+    memset(fb->remote, 0, sizeof(fb->remote));
+    for (uint32_t t = 0; t < UI_FB8_TILES; ++t)
+        bit_set(fb->remote, t);
+    fb->remote_w = 0u;
+}
+
+uint16_t ui_fb8_remote_pending(const ui_fb8_t *fb)
+{
+    uint16_t n = 0u;
+    for (uint32_t t = 0; t < UI_FB8_TILES; ++t)
+        n = (uint16_t)(n + bit_get(fb->remote, t));
+    return n;
+}
+
+static inline uint8_t fb8_remote_ready(const ui_fb8_t *fb, uint32_t t)
+{
+    return (uint8_t)(bit_get(fb->remote, t) & bit_get(fb->known, t));
+}
+
+/* Starts the next rect: the first ready tile from the scan position on and
+ * the ready tiles right of it. */
+static uint8_t fb8_remote_open(ui_fb8_t *fb)
+{
+    for (uint32_t k = 0; k < UI_FB8_TILES; ++k)
+    {
+        uint32_t t = (fb->remote_scan + k) % UI_FB8_TILES;
+        if (!fb8_remote_ready(fb, t))
+            continue;
+        uint32_t end = t;
+        uint32_t row_end = (t / UI_FB8_TILES_X + 1u) * UI_FB8_TILES_X;
+        while (end < row_end && fb8_remote_ready(fb, end))
+            bit_clear(fb->remote, end++);
+        fb->remote_x = (uint16_t)((t % UI_FB8_TILES_X) * UI_FB8_TILE);
+        fb->remote_y = (uint16_t)((t / UI_FB8_TILES_X) * UI_FB8_TILE);
+        fb->remote_w = (uint16_t)((end - t) * UI_FB8_TILE);
+        fb->remote_pos = 0u;
+        fb->remote_scan = (uint16_t)(end % UI_FB8_TILES);
+        return 1u;
+    }
+    return 0u;
+}
+
+/* Drops the open rect, pending again, unless all its tiles are still known. */
+static void fb8_remote_check(ui_fb8_t *fb)
+{
+    uint32_t t0 = (uint32_t)(fb->remote_y / UI_FB8_TILE) * UI_FB8_TILES_X + fb->remote_x / UI_FB8_TILE;
+    uint32_t t1 = t0 + fb->remote_w / UI_FB8_TILE;
+    uint8_t known = 1u;
+    for (uint32_t t = t0; t < t1; ++t)
+        known &= bit_get(fb->known, t);
+    if (known)
+        return;
+    for (uint32_t t = t0; t < t1; ++t)
+        bit_set(fb->remote, t);
+    fb->remote_w = 0u;
+}
+
+static inline uint16_t fb8_remote_px(const ui_fb8_t *fb, uint32_t k)
+{
+    return fb->lut[fb->idx[fb->remote_y + k / fb->remote_w][fb->remote_x + k % fb->remote_w]];
+}
+
+uint16_t ui_fb8_remote_next(ui_fb8_t *fb, ui_fb8_remote_chunk_t *c, uint8_t *rle, uint16_t cap)
+{
+    if (fb->remote_w)
+        fb8_remote_check(fb);
+    if (!fb->remote_w && !fb8_remote_open(fb))
+        return 0u;
+    c->x = fb->remote_x;
+    c->y = fb->remote_y;
+    c->w = fb->remote_w;
+    c->h = UI_FB8_TILE;
+    c->pos = fb->remote_pos;
+
+    uint32_t count = (uint32_t)fb->remote_w * UI_FB8_TILE;
+    uint32_t i = fb->remote_pos;
+    uint16_t n = 0u;
+    while (i < count && n + 3u <= cap)
+    {
+        uint16_t px = fb8_remote_px(fb, i);
+        uint32_t run = 1u;
+        while (i + run < count && run < 128u && fb8_remote_px(fb, i + run) == px)
+            run++;
+        if (run >= 2u)
+        {
+            rle[n++] = (uint8_t)(0x80u | (run - 1u));
+            rle[n++] = (uint8_t)px;
+            rle[n++] = (uint8_t)(px >> 8);
+            i += run;
+            continue;
+        }
+        /* Literals up to the next pair, which codes better as a run. */
+        uint32_t max = (uint32_t)(cap - n - 1u) / 2u;
+        if (max > 128u)
+            max = 128u;
+        uint32_t lit = 1u;
+        while (i + lit < count && lit < max &&
+               !(i + lit + 1u < count && fb8_remote_px(fb, i + lit) == fb8_remote_px(fb, i + lit + 1u)))
+            lit++;
+        rle[n++] = (uint8_t)(lit - 1u);
+        for (uint32_t k = 0; k < lit; ++k)
+        {
+            uint16_t p = fb8_remote_px(fb, i + k);
+            rle[n++] = (uint8_t)p;
+            rle[n++] = (uint8_t)(p >> 8);
+        }
+        i += lit;
+    }
+    if (i >= count)
+        fb->remote_w = 0u;
+    else
+        fb->remote_pos = (uint16_t)i;
+    return n;
+}
@@ -0,0 +1,85 @@
+#ifndef OPEN_FIRMWARE_UI_FB8_H
+#define OPEN_FIRMWARE_UI_FB8_H
+
+#include <stdint.h>
+
+#include "ui_band.h"
+#include "ui_display.h"
+
+/*
+ * What the panel shows, one byte per pixel: indexes into a 256-colour LUT
+ * that fills with the colours frames actually draw (theme colours, dither
+ * pairs, A4 blend steps). Composited bands are diffed against it, so only
+ * tiles whose pixels changed go back out, expanded through the LUT.
+ *
+ * A tile is "known" while its indexes match the panel. Tiles start unknown;
+ * a band covering a whole tile makes it known, and anything drawn outside
+ * the compositor forgets the tiles it touched. Pixels of unknown tiles go
+ * out straight from the band. A full LUT is first collected (entries no
+ * known tile uses are freed); if that frees nothing, everything is forgotten.
+ *
+ * A remote viewer reads the same copy: tiles whose pixels changed stay
+ * pending for it until it has read them, and only known tiles are read, so
+ * what it gets is what the panel shows.
+ */
+#define UI_FB8_TILE 16u
+#define UI_FB8_TILES_X (DISP_W / UI_FB8_TILE)
+#define UI_FB8_TILES_Y (DISP_H / UI_FB8_TILE)
+#define UI_FB8_TILES (UI_FB8_TILES_X * UI_FB8_TILES_Y)
+#define UI_FB8_TILE_WORDS ((UI_FB8_TILES + 31u) / 32u)
+#define UI_FB8_COLORS 256u
+#define UI_FB8_HASH 512u
+
+typedef struct {
+    uint8_t idx[DISP_H][DISP_W];
+    uint16_t lut[UI_FB8_COLORS];
+    uint32_t used[UI_FB8_COLORS / 32u];
+    uint16_t hash[UI_FB8_HASH];  /* LUT index + 1; 0 is empty */
+    uint32_t known[UI_FB8_TILE_WORDS];
+    uint32_t dirty[UI_FB8_TILE_WORDS];
+    uint32_t remote[UI_FB8_TILE_WORDS]; /* changed since the remote viewer read them */
+    uint16_t remote_scan;        /* tile the pending scan resumes at */
+    uint16_t remote_x, remote_y, remote_w, remote_pos; /* rect being read; w == 0: none */
+    uint16_t last_color;         /* one-entry cache in front of the hash */
+    uint8_t last_idx;
+    uint8_t last_ok;
+    uint32_t collects;
+    uint32_t resets;
+} ui_fb8_t;
+
+/* Forgets every tile and empties the LUT. */
+void ui_fb8_reset(ui_fb8_t *fb);
+/* Moves the band's covered pixels into the framebuffer, marking the tiles
+ * they change. Pixels of known tiles are taken out of the band, which then
+ * holds only what must go out directly. The band must be one tile row
+ * (y0 a multiple of UI_FB8_TILE, h == UI_FB8_TILE). Returns 0 when the LUT
+ * overflowed: the framebuffer is reset and the band left as it was. */
+uint8_t ui_fb8_absorb(ui_fb8_t *fb, ui_band_t *b);
+/* Pushes the changed known tiles of tile row `ty`, runs of neighbours as
+ * one rectangle, expanded into `scratch` (DISP_W * UI_FB8_TILE pixels).
+ * Returns the rectangles pushed. */
+uint16_t ui_fb8_push_row(ui_fb8_t *fb, uint16_t ty, uint16_t *scratch, ui_band_push_fn push, void *ctx);
+/* The panel under the rect changed behind the framebuffer's back. */
+void ui_fb8_forget(ui_fb8_t *fb, uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+
+/* One read of the remote viewer: `pos` is the first pixel it carries,
+ * row-major in the rect. */
+typedef struct {
+    uint16_t x, y, w, h;
+    uint16_t pos;
+} ui_fb8_remote_chunk_t;
+
+/* Every tile pending again, as for a viewer that has nothing yet. Reset
+ * does this too. */
+void ui_fb8_remote_all(ui_fb8_t *fb);
+uint16_t ui_fb8_remote_pending(const ui_fb8_t *fb);
+/* Reads pending tiles as rects (a run of neighbours in one tile row), RLE
+ * encoded into `rle` as in the host BLCD stream: control byte c, bit7 set =
+ * (c & 0x7F) + 1 copies of the next pixel, clear = c + 1 literal pixels;
+ * pixels RGB565 little-endian. A rect longer than `cap` (at least 3) goes
+ * over several reads, cut between codes; one whose tiles are forgotten
+ * before it is finished is dropped and stays pending. Returns the bytes
+ * written, 0 when no known tile is pending. */
+uint16_t ui_fb8_remote_next(ui_fb8_t *fb, ui_fb8_remote_chunk_t *c, uint8_t *rle, uint16_t cap);
+
+#endif
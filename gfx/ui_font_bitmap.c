@@ -152,6 +152,204 @@ const uint8_t g_ui_font_bitmap_bits[] = {
     0x08,0x08,0x06,0x0C,0x08,0x08,0x08,0x38,0x00,0x60,0x92,0x0C,0x00,0x00,
 };
 
+const uint16_t g_ui_font_bitmap_run_index[UI_FONT_BITMAP_COUNT + 1] = {
+       0,   0,   6,  14,  30,  46,  59,  74,  78,  89, 100, 109,
+     115, 119, 120, 122, 132, 149, 158, 168, 179, 191, 201, 216,
+     225, 240, 253, 257, 263, 269, 271, 277, 285, 300, 315, 330,
+     339, 355, 364, 373, 386, 403, 412, 421, 437, 446, 467, 488,
+     504, 516, 534, 550, 561, 570, 587, 602, 623, 638, 650, 659,
+     670, 680, 691, 697, 698, 700, 710, 726, 733, 749, 758, 768,
+     784, 801, 809, 820, 835, 844, 857, 871, 883, 898, 913, 920,
+     929, 938, 952, 964, 980, 991,1006,1013,1024,1036,1047,1052,
+};
+
+const ui_font_bitmap_run_t g_ui_font_bitmap_runs[] = {
+    { 0,4,1},{ 1,4,1},{ 2,4,1},{ 3,4,1},{ 4,4,1},{ 8,4,2},
+    { 0,2,1},{ 0,5,2},{ 1,2,1},{ 1,5,2},{ 2,2,1},{ 2,5,2},
+    { 3,2,1},{ 3,5,2},{ 0,3,1},{ 0,5,1},{ 1,3,1},{ 1,5,1},
+    { 2,1,6},{ 3,2,1},{ 3,5,1},{ 4,2,1},{ 4,4,1},{ 5,2,1},
+    { 5,4,1},{ 6,0,7},{ 7,1,1},{ 7,4,1},{ 8,1,1},{ 8,3,1},
+    { 0,4,1},{ 1,3,3},{ 2,2,3},{ 2,6,1},{ 3,2,1},{ 3,4,1},
+    { 4,3,2},{ 5,4,3},{ 6,4,1},{ 6,6,1},{ 7,2,1},{ 7,4,1},
+    { 7,6,1},{ 8,3,4},{ 9,4,1},{10,4,1},{ 0,1,2},{ 1,0,1},
+    { 1,3,1},{ 2,1,2},{ 2,6,1},{ 3,3,2},{ 4,1,2},{ 4,4,2},
+    { 5,3,1},{ 5,6,1},{ 6,3,1},{ 6,6,1},{ 7,4,2},{ 0,2,3},
+    { 1,1,2},{ 2,1,2},{ 3,2,1},{ 4,1,3},{ 5,1,1},{ 5,3,1},
+    { 5,6,1},{ 6,0,1},{ 6,4,1},{ 6,6,1},{ 7,1,1},{ 7,5,1},
+    { 8,2,3},{ 8,6,1},{ 0,4,1},{ 1,4,1},{ 2,4,1},{ 3,4,1},
+    { 0,5,1},{ 1,4,1},{ 2,4,1},{ 3,4,1},{ 4,3,2},{ 5,3,1},
+    { 6,3,2},{ 7,4,1},{ 8,4,1},{ 9,4,1},{10,5,1},{ 0,3,1},
+    { 1,4,1},{ 2,4,1},{ 3,4,1},{ 4,5,1},{ 5,5,1},{ 6,5,1},
+    { 7,4,1},{ 8,4,1},{ 9,4,1},{10,3,1},{ 0,4,1},{ 1,4,1},
+    { 2,2,3},{ 2,6,1},{ 3,3,3},{ 4,2,3},{ 4,6,1},{ 5,4,1},
+    { 6,4,1},{ 0,4,1},{ 1,4,1},{ 2,4,1},{ 3,2,5},{ 4,4,1},
+    { 5,4,1},{ 0,4,1},{ 1,4,1},{ 2,3,2},{ 3,3,1},{ 0,2,5},
+    { 0,3,2},{ 1,3,2},{ 0,6,1},{ 1,6,1},{ 2,5,1},{ 3,5,1},
+    { 4,4,1},{ 5,4,1},{ 6,3,1},{ 7,3,1},{ 8,2,1},{ 9,2,1},
+    { 0,3,3},{ 1,2,2},{ 1,5,2},{ 2,2,1},{ 2,5,2},{ 3,2,1},
+    { 3,5,2},{ 4,2,1},{ 4,4,1},{ 4,6,1},{ 5,2,2},{ 5,6,1},
+    { 6,2,2},{ 6,6,1},{ 7,2,2},{ 7,6,1},{ 8,3,3},{ 0,3,3},
+    { 1,2,4},{ 2,4,2},{ 3,4,2},{ 4,4,2},{ 5,4,2},{ 6,4,2},
+    { 7,4,2},{ 8,3,4},{ 0,3,3},{ 1,2,1},{ 1,5,2},{ 2,6,1},
+    { 3,6,1},{ 4,5,1},{ 5,4,1},{ 6,3,2},{ 7,2,2},{ 8,2,5},
+    { 0,3,3},{ 1,2,1},{ 1,6,1},{ 2,6,1},{ 3,5,2},{ 4,3,3},
+    { 5,6,1},{ 6,6,1},{ 7,2,1},{ 7,6,1},{ 8,3,3},{ 0,5,1},
+    { 1,4,2},{ 2,4,2},{ 3,3,1},{ 3,5,1},{ 4,2,1},{ 4,5,1},
+    { 5,2,1},{ 5,5,1},{ 6,2,5},{ 7,5,1},{ 8,5,1},{ 0,2,5},
+    { 1,2,1},{ 2,2,1},{ 3,2,4},{ 4,5,2},{ 5,6,1},{ 6,6,1},
+    { 7,2,1},{ 7,5,2},{ 8,3,3},{ 0,3,3},{ 1,2,2},{ 1,6,1},
+    { 2,2,1},{ 3,2,1},{ 3,4,2},{ 4,2,2},{ 4,6,1},{ 5,2,1},
+    { 5,6,1},{ 6,2,1},{ 6,6,1},{ 7,2,2},{ 7,6,1},{ 8,3,3},
+    { 0,2,5},{ 1,6,1},{ 2,5,2},{ 3,5,1},{ 4,5,1},{ 5,4,1},
+    { 6,4,1},{ 7,4,1},{ 8,3,1},{ 0,3,3},{ 1,2,2},{ 1,6,1},
+    { 2,2,1},{ 2,6,1},{ 3,2,2},{ 3,6,1},{ 4,3,3},{ 5,2,1},
+    { 5,6,1},{ 6,2,1},{ 6,6,1},{ 7,2,1},{ 7,6,1},{ 8,3,3},
+    { 0,3,3},{ 1,2,1},{ 1,6,1},{ 2,2,1},{ 2,6,1},{ 3,2,1},
+    { 3,6,1},{ 4,2,1},{ 4,6,1},{ 5,3,4},{ 6,6,1},{ 7,5,2},
+    { 8,3,3},{ 0,4,1},{ 1,4,1},{ 4,4,1},{ 5,4,1},{ 0,4,1},
+    { 1,4,1},{ 4,4,1},{ 5,4,1},{ 6,3,2},{ 7,3,2},{ 0,6,1},
+    { 1,4,3},{ 2,2,2},{ 3,2,2},{ 4,4,3},{ 5,6,1},{ 0,2,5},
+    { 3,2,5},{ 0,2,1},{ 1,3,2},{ 2,5,2},{ 3,5,2},{ 4,3,2},
+    { 5,2,1},{ 0,3,3},{ 1,6,1},{ 2,6,1},{ 3,5,1},{ 4,4,1},
+    { 5,4,1},{ 7,4,1},{ 8,4,1},{ 0,3,4},{ 1,2,2},{ 2,2,1},
+    { 2,4,3},{ 3,1,1},{ 3,4,1},{ 4,1,1},{ 4,3,1},{ 5,1,1},
+    { 5,4,1},{ 6,1,1},{ 6,4,3},{ 7,2,1},{ 8,2,1},{ 9,3,4},
+    { 0,3,1},{ 1,2,3},{ 2,2,1},{ 2,4,1},{ 3,2,1},{ 3,4,1},
+    { 4,2,1},{ 4,4,2},{ 5,1,1},{ 5,5,1},{ 6,1,5},{ 7,1,1},
+    { 7,5,2},{ 8,0,2},{ 8,6,1},{ 0,2,4},{ 1,2,1},{ 1,6,1},
+    { 2,2,1},{ 2,6,1},{ 3,2,1},{ 3,6,1},{ 4,2,4},{ 5,2,1},
+    { 5,6,1},{ 6,2,1},{ 6,6,1},{ 7,2,1},{ 7,6,1},{ 8,2,5},
+    { 0,4,3},{ 1,3,1},{ 2,2,1},{ 3,2,1},{ 4,2,1},{ 5,2,1},
+    { 6,2,1},{ 7,3,1},{ 8,4,3},{ 0,2,4},{ 1,2,1},{ 1,5,2},
+    { 2,2,1},{ 2,6,1},{ 3,2,1},{ 3,6,1},{ 4,2,1},{ 4,6,1},
+    { 5,2,1},{ 5,6,1},{ 6,2,1},{ 6,6,1},{ 7,2,1},{ 7,5,2},
+    { 8,2,4},{ 0,2,5},{ 1,2,1},{ 2,2,1},{ 3,2,1},{ 4,2,5},
+    { 5,2,1},{ 6,2,1},{ 7,2,1},{ 8,2,5},{ 0,2,5},{ 1,2,2},
+    { 2,2,2},{ 3,2,2},{ 4,2,5},{ 5,2,2},{ 6,2,2},{ 7,2,2},
+    { 8,2,2},{ 0,3,4},{ 1,2,2},{ 2,2,1},{ 3,2,1},{ 4,2,1},
+    { 4,5,2},{ 5,2,1},{ 5,6,1},{ 6,2,1},{ 6,6,1},{ 7,2,2},
+    { 7,6,1},{ 8,3,4},{ 0,2,1},{ 0,6,1},{ 1,2,1},{ 1,6,1},
+    { 2,2,1},{ 2,6,1},{ 3,2,1},{ 3,6,1},{ 4,2,5},{ 5,2,1},
+    { 5,6,1},{ 6,2,1},{ 6,6,1},{ 7,2,1},{ 7,6,1},{ 8,2,1},
+    { 8,6,1},{ 0,2,5},{ 1,4,1},{ 2,4,1},{ 3,4,1},{ 4,4,1},
+    { 5,4,1},{ 6,4,1},{ 7,4,1},{ 8,2,5},{ 0,3,4},{ 1,5,2},
+    { 2,5,2},{ 3,5,2},{ 4,5,2},{ 5,5,2},{ 6,5,2},{ 7,5,1},
+    { 8,2,4},{ 0,1,1},{ 0,5,2},{ 1,1,1},{ 1,4,2},{ 2,1,1},
+    { 2,3,2},{ 3,1,3},{ 4,1,3},{ 5,1,1},{ 5,4,1},{ 6,1,1},
+    { 6,4,2},{ 7,1,1},{ 7,5,1},{ 8,1,1},{ 8,5,2},{ 0,2,1},
+    { 1,2,1},{ 2,2,1},{ 3,2,1},{ 4,2,1},{ 5,2,1},{ 6,2,1},
+    { 7,2,1},{ 8,2,5},{ 0,1,2},{ 0,6,1},{ 1,1,2},{ 1,5,2},
+    { 2,1,3},{ 2,5,2},{ 3,1,1},{ 3,3,1},{ 3,6,1},{ 4,1,1},
+    { 4,3,2},{ 4,6,1},{ 5,1,1},{ 5,4,1},{ 5,6,1},{ 6,1,1},
+    { 6,6,1},{ 7,1,1},{ 7,6,1},{ 8,1,1},{ 8,6,1},{ 0,1,2},
+    { 0,6,1},{ 1,1,2},{ 1,6,1},{ 2,1,3},{ 2,6,1},{ 3,1,1},
+    { 3,3,1},{ 3,6,1},{ 4,1,1},{ 4,4,1},{ 4,6,1},{ 5,1,1},
+    { 5,4,1},{ 5,6,1},{ 6,1,1},{ 6,5,2},{ 7,1,1},{ 7,5,2},
+    { 8,1,1},{ 8,6,1},{ 0,3,3},{ 1,2,2},{ 1,6,1},{ 2,2,1},
+    { 2,6,1},{ 3,2,1},{ 3,6,1},{ 4,2,1},{ 4,6,1},{ 5,2,1},
+    { 5,6,1},{ 6,2,1},{ 6,6,1},{ 7,2,2},{ 7,6,1},{ 8,3,3},
+    { 0,2,5},{ 1,2,1},{ 1,6,1},{ 2,2,1},{ 2,6,1},{ 3,2,1},
+    { 3,6,1},{ 4,2,5},{ 5,2,1},{ 6,2,1},{ 7,2,1},{ 8,2,1},
+    { 0,3,3},{ 1,2,2},{ 1,6,1},{ 2,2,1},{ 2,6,1},{ 3,2,1},
+    { 3,6,1},{ 4,2,1},{ 4,6,1},{ 5,2,1},{ 5,6,1},{ 6,2,1},
+    { 6,6,1},{ 7,2,2},{ 7,6,1},{ 8,3,3},{ 9,5,2},{10,6,1},
+    { 0,1,4},{ 1,1,1},{ 1,5,1},{ 2,1,1},{ 2,5,1},{ 3,1,1},
+    { 3,5,1},{ 4,1,4},{ 5,1,1},{ 5,4,2},{ 6,1,1},{ 6,5,1},
+    { 7,1,1},{ 7,5,2},{ 8,1,1},{ 8,6,1},{ 0,3,3},{ 1,2,1},
+    { 1,6,1},{ 2,2,1},{ 3,2,2},{ 4,3,3},{ 5,6,1},{ 6,6,1},
+    { 7,2,1},{ 7,6,1},{ 8,3,3},{ 0,1,6},{ 1,4,1},{ 2,4,1},
+    { 3,4,1},{ 4,4,1},{ 5,4,1},{ 6,4,1},{ 7,4,1},{ 8,4,1},
+    { 0,2,1},{ 0,6,1},{ 1,2,1},{ 1,6,1},{ 2,2,1},{ 2,6,1},
+    { 3,2,1},{ 3,6,1},{ 4,2,1},{ 4,6,1},{ 5,2,1},{ 5,6,1},
+    { 6,2,1},{ 6,6,1},{ 7,2,1},{ 7,6,1},{ 8,3,3},{ 0,1,2},
+    { 1,2,1},{ 1,6,1},{ 2,2,1},{ 2,6,1},{ 3,2,1},{ 3,6,1},
+    { 4,3,1},{ 4,6,1},{ 5,3,1},{ 5,5,1},{ 6,3,1},{ 6,5,1},
+    { 7,3,3},{ 8,4,1},{ 0,0,1},{ 0,6,1},{ 1,0,1},{ 1,6,1},
+    { 2,0,1},{ 2,3,1},{ 2,6,1},{ 3,1,1},{ 3,3,2},{ 3,6,1},
+    { 4,1,1},{ 4,4,1},{ 4,6,1},{ 5,1,2},{ 5,4,2},{ 6,1,2},
+    { 6,4,2},{ 7,1,2},{ 7,4,2},{ 8,1,2},{ 8,5,1},{ 0,1,1},
+    { 0,5,2},{ 1,1,2},{ 1,5,1},{ 2,2,1},{ 2,4,1},{ 3,3,2},
+    { 4,3,2},{ 5,2,3},{ 6,2,1},{ 6,4,2},{ 7,1,1},{ 7,5,1},
+    { 8,0,2},{ 8,6,1},{ 0,0,2},{ 0,5,2},{ 1,1,1},{ 1,5,1},
+    { 2,2,1},{ 2,4,2},{ 3,2,3},{ 4,3,1},{ 5,3,1},{ 6,3,1},
+    { 7,3,1},{ 8,3,1},{ 0,2,5},{ 1,6,1},{ 2,5,2},{ 3,5,1},
+    { 4,4,1},{ 5,4,1},{ 6,3,1},{ 7,2,1},{ 8,2,5},{ 0,4,3},
+    { 1,4,1},{ 2,4,1},{ 3,4,1},{ 4,4,1},{ 5,4,1},{ 6,4,1},
+    { 7,4,1},{ 8,4,1},{ 9,4,1},{10,4,3},{ 0,2,1},{ 1,2,1},
+    { 2,3,1},{ 3,3,1},{ 4,4,1},{ 5,4,1},{ 6,5,1},{ 7,5,1},
+    { 8,6,1},{ 9,6,1},{ 0,3,2},{ 1,4,1},{ 2,4,1},{ 3,4,1},
+    { 4,4,1},{ 5,4,1},{ 6,4,1},{ 7,4,1},{ 8,4,1},{ 9,4,1},
+    {10,3,2},{ 0,3,1},{ 1,2,3},{ 2,1,2},{ 2,4,2},{ 3,1,1},
+    { 3,5,2},{ 1,0,7},{ 0,3,1},{ 1,4,1},{ 0,2,4},{ 1,6,1},
+    { 2,6,1},{ 3,3,4},{ 4,2,1},{ 4,6,1},{ 5,2,1},{ 5,6,1},
+    { 6,3,2},{ 6,6,1},{ 0,2,1},{ 1,2,1},{ 2,2,1},{ 3,2,1},
+    { 3,4,2},{ 4,2,2},{ 4,6,1},{ 5,2,1},{ 5,6,1},{ 6,2,1},
+    { 6,6,1},{ 7,2,1},{ 7,6,1},{ 8,2,2},{ 8,6,1},{ 9,2,4},
+    { 0,4,3},{ 1,3,1},{ 2,2,1},{ 3,2,1},{ 4,2,1},{ 5,3,1},
+    { 6,4,3},{ 0,6,1},{ 1,6,1},{ 2,6,1},{ 3,3,4},{ 4,2,1},
+    { 4,5,2},{ 5,2,1},{ 5,6,1},{ 6,2,1},{ 6,6,1},{ 7,2,1},
+    { 7,6,1},{ 8,2,1},{ 8,5,2},{ 9,3,2},{ 9,6,1},{ 0,3,3},
+    { 1,2,2},{ 1,6,1},{ 2,2,1},{ 2,6,1},{ 3,2,5},{ 4,2,1},
+    { 5,2,1},{ 6,3,4},{ 0,5,2},{ 1,4,1},{ 2,4,1},{ 3,2,5},
+    { 4,4,1},{ 5,4,1},{ 6,4,1},{ 7,4,1},{ 8,4,1},{ 9,4,1},
+    { 0,3,4},{ 1,2,1},{ 1,5,2},{ 2,2,1},{ 2,6,1},{ 3,2,1},
+    { 3,6,1},{ 4,2,1},{ 4,6,1},{ 5,2,1},{ 5,5,2},{ 6,3,2},
+    { 6,6,1},{ 7,6,1},{ 8,5,2},{ 9,3,3},{ 0,2,1},{ 1,2,1},
+    { 2,2,1},{ 3,2,1},{ 3,4,2},{ 4,2,2},{ 4,6,1},{ 5,2,1},
+    { 5,6,1},{ 6,2,1},{ 6,6,1},{ 7,2,1},{ 7,6,1},{ 8,2,1},
+    { 8,6,1},{ 9,2,1},{ 9,6,1},{ 0,5,1},{ 2,3,3},{ 3,5,1},
+    { 4,5,1},{ 5,5,1},{ 6,5,1},{ 7,5,1},{ 8,2,5},{ 0,5,1},
+    { 3,3,3},{ 4,5,1},{ 5,5,1},{ 6,5,1},{ 7,5,1},{ 8,5,1},
+    { 9,5,1},{10,4,2},{11,4,1},{12,2,3},{ 0,1,2},{ 1,1,2},
+    { 2,1,2},{ 3,1,2},{ 3,5,1},{ 4,1,2},{ 4,4,1},{ 5,1,3},
+    { 6,1,4},{ 7,1,2},{ 7,4,1},{ 8,1,2},{ 8,5,1},{ 9,1,2},
+    { 9,5,2},{ 0,2,3},{ 1,4,1},{ 2,4,1},{ 3,4,1},{ 4,4,1},
+    { 5,4,1},{ 6,4,1},{ 7,4,1},{ 8,5,2},{ 0,2,5},{ 1,2,1},
+    { 1,4,1},{ 2,2,1},{ 2,4,1},{ 3,2,1},{ 3,4,1},{ 4,2,1},
+    { 4,4,1},{ 5,2,1},{ 5,4,1},{ 6,2,1},{ 6,4,1},{ 0,2,1},
+    { 0,4,2},{ 1,2,2},{ 1,6,1},{ 2,2,1},{ 2,6,1},{ 3,2,1},
+    { 3,6,1},{ 4,2,1},{ 4,6,1},{ 5,2,1},{ 5,6,1},{ 6,2,1},
+    { 6,6,1},{ 0,3,3},{ 1,2,2},{ 1,6,1},{ 2,2,1},{ 2,6,1},
+    { 3,2,1},{ 3,6,1},{ 4,2,1},{ 4,6,1},{ 5,2,2},{ 5,6,1},
+    { 6,3,3},{ 0,2,4},{ 1,2,2},{ 1,6,1},{ 2,2,1},{ 2,6,1},
+    { 3,2,1},{ 3,6,1},{ 4,2,1},{ 4,6,1},{ 5,2,2},{ 5,6,1},
+    { 6,2,4},{ 7,2,1},{ 8,2,1},{ 9,2,1},{ 0,3,4},{ 1,2,2},
+    { 1,5,2},{ 2,2,1},{ 2,6,1},{ 3,2,1},{ 3,6,1},{ 4,2,1},
+    { 4,6,1},{ 5,2,2},{ 5,5,2},{ 6,3,4},{ 7,6,1},{ 8,6,1},
+    { 9,6,1},{ 0,3,4},{ 1,3,2},{ 2,3,1},{ 3,3,1},{ 4,3,1},
+    { 5,3,1},{ 6,3,1},{ 0,3,3},{ 1,2,2},{ 1,6,1},{ 2,2,2},
+    { 3,3,3},{ 4,6,1},{ 5,2,1},{ 5,6,1},{ 6,3,3},{ 0,4,1},
+    { 1,4,1},{ 2,2,5},{ 3,4,1},{ 4,4,1},{ 5,4,1},{ 6,4,1},
+    { 7,4,1},{ 8,4,3},{ 0,2,1},{ 0,6,1},{ 1,2,1},{ 1,6,1},
+    { 2,2,1},{ 2,6,1},{ 3,2,1},{ 3,6,1},{ 4,2,1},{ 4,6,1},
+    { 5,2,2},{ 5,6,1},{ 6,3,2},{ 6,6,1},{ 0,2,1},{ 0,6,1},
+    { 1,2,1},{ 1,6,1},{ 2,2,2},{ 2,6,1},{ 3,3,1},{ 3,5,1},
+    { 4,3,1},{ 4,5,1},{ 5,3,3},{ 6,4,1},{ 0,0,1},{ 0,6,1},
+    { 1,0,1},{ 1,6,1},{ 2,1,1},{ 2,3,1},{ 2,6,1},{ 3,1,1},
+    { 3,3,1},{ 3,5,1},{ 4,1,2},{ 4,4,2},{ 5,1,2},{ 5,4,2},
+    { 6,1,2},{ 6,5,1},{ 0,2,1},{ 0,6,1},{ 1,3,1},{ 1,5,1},
+    { 2,3,3},{ 3,4,1},{ 4,3,3},{ 5,3,1},{ 5,6,1},{ 6,2,1},
+    { 6,6,1},{ 0,2,1},{ 0,6,1},{ 1,2,1},{ 1,6,1},{ 2,2,2},
+    { 2,6,1},{ 3,3,1},{ 3,5,2},{ 4,3,1},{ 4,5,1},{ 5,4,2},
+    { 6,4,1},{ 7,4,1},{ 8,4,1},{ 9,2,2},{ 0,2,5},{ 1,6,1},
+    { 2,5,1},{ 3,4,1},{ 4,3,1},{ 5,3,1},{ 6,2,5},{ 0,5,2},
+    { 1,4,2},{ 2,4,1},{ 3,4,1},{ 4,4,1},{ 5,2,2},{ 6,4,1},
+    { 7,4,1},{ 8,4,1},{ 9,4,2},{10,5,2},{ 0,4,1},{ 1,4,1},
+    { 2,4,1},{ 3,4,1},{ 4,4,1},{ 5,4,1},{ 6,4,1},{ 7,4,1},
+    { 8,4,1},{ 9,4,1},{10,4,1},{11,4,1},{ 0,2,3},{ 1,4,1},
+    { 2,4,1},{ 3,4,1},{ 4,4,1},{ 5,5,2},{ 6,4,2},{ 7,4,1},
+    { 8,4,1},{ 9,4,1},{10,2,3},{ 1,1,2},{ 2,0,1},{ 2,3,1},
+    { 2,6,1},{ 3,4,2},
+};
+
+static inline const ui_font_bitmap_run_t *glyph_runs(const ui_font_bitmap_glyph_t *g,
+                                                      const ui_font_bitmap_run_t **end)
+{
+    unsigned idx = (unsigned)(g - g_ui_font_bitmap_glyphs);
+    *end = &g_ui_font_bitmap_runs[g_ui_font_bitmap_run_index[idx + 1u]];
+    return &g_ui_font_bitmap_runs[g_ui_font_bitmap_run_index[idx]];
+}
+
 /* Draw a single glyph at (x, y) baseline position */
 static void ui_font_bitmap_draw_glyph(ui_font_bitmap_plot_fn plot,
                                       ui_font_bitmap_rect_fn rect,
@@ -168,28 +366,45 @@ static void ui_font_bitmap_draw_glyph(ui_font_bitmap_plot_fn plot,
     const int gy = y + g->yoff;
     const int w = g->w;
     const int h = g->h;
-    const int bytes_per_row = (w + 7) / 8;
-    const uint8_t *bits = &g_ui_font_bitmap_bits[g->offset];
 
     /* Draw background rect if rect callback provided */
     if (rect && bg != 0xFFFFu) {
         rect(gx, gy, w, h, bg, user);
     }
 
-    /* Draw foreground pixels */
-    if (!plot)
+    /* Draw foreground runs: one rect per run, plot only when the run starts
+     * off-surface (rect callbacks reject negative origins). */
+    const ui_font_bitmap_run_t *end;
+    for (const ui_font_bitmap_run_t *r = glyph_runs(g, &end); r < end; ++r) {
+        int rx = gx + r->x;
+        int ry = gy + r->row;
+        if (rect && rx >= 0 && ry >= 0) {
+            rect(rx, ry, r->len, 1, fg, user);
+        } else if (plot) {
+            for (int i = 0; i < r->len; ++i)
+                plot(rx + i, ry, fg, user);
+        }
+    }
+}
+
+void ui_font_bitmap_glyph_cell(const ui_font_bitmap_glyph_t *g,
+                               uint16_t *dst,
+                               uint16_t fg,
+                               uint16_t bg)
+{
+    if (!g || !dst)
         return;
 
-    for (int row = 0; row < h; ++row) {
-        int col = 0;
-        for (int b = 0; b < bytes_per_row; ++b) {
-            uint8_t byte = bits[row * bytes_per_row + b];
-            for (int bit = 7; bit >= 0 && col < w; --bit, ++col) {
-                if (byte & (1u << bit)) {
-                    plot(gx + col, gy + row, fg, user);
-                }
-            }
-        }
+    const int w = g->w;
+    const int total = w * g->h;
+    for (int i = 0; i < total; ++i)
+        dst[i] = bg;
+
+    const ui_font_bitmap_run_t *end;
+    for (const ui_font_bitmap_run_t *r = glyph_runs(g, &end); r < end; ++r) {
+        uint16_t *p = &dst[r->row * w + r->x];
+        for (int i = 0; i < r->len; ++i)
+            p[i] = fg;
     }
 }
 
@@ -22,6 +22,16 @@ typedef struct {
 extern const ui_font_bitmap_glyph_t g_ui_font_bitmap_glyphs[UI_FONT_BITMAP_COUNT];
 extern const uint8_t g_ui_font_bitmap_bits[];
 
+typedef struct {
+    uint8_t row;      /* Row within glyph bitmap */
+    uint8_t x;        /* First set column */
+    uint8_t len;      /* Run length in pixels */
+} ui_font_bitmap_run_t;
+
+/* Glyph i owns runs [run_index[i], run_index[i + 1]). */
+extern const uint16_t g_ui_font_bitmap_run_index[UI_FONT_BITMAP_COUNT + 1];
+extern const ui_font_bitmap_run_t g_ui_font_bitmap_runs[];
+
 static inline const ui_font_bitmap_glyph_t *ui_font_bitmap_glyph(char c) {
     if ((uint8_t)c < UI_FONT_BITMAP_FIRST || (uint8_t)c > UI_FONT_BITMAP_LAST)
         return &g_ui_font_bitmap_glyphs[0]; /* space */
@@ -51,4 +61,11 @@ void ui_font_bitmap_draw_text(ui_font_bitmap_plot_fn plot,
                               uint16_t fg,
                               uint16_t bg);
 
+/* Rasterize a glyph's w*h cell (row-major, stride w) into dst: bg everywhere,
+ * fg over set pixels. Lets a backend push an opaque glyph in one window write. */
+void ui_font_bitmap_glyph_cell(const ui_font_bitmap_glyph_t *g,
+                               uint16_t *dst,
+                               uint16_t fg,
+                               uint16_t bg);
+
 #endif /* UI_FONT_BITMAP_H */
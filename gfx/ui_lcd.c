@@ -1,20 +1,111 @@
 #include "ui_lcd.h"
 
+#include <string.h>
+
+#include "ui_band.h"
 #include "ui_display.h"
+#include "ui_fb8.h"
 #include "ui_draw_common.h"
+#include "ui_draw_px.h"
 #include "ui_font_bitmap.h"
 #include "platform/hw.h"
+#include "platform/ram.h"
 
+#include "drivers/st7789_8080.h"
 #if !defined(HOST_TEST)
 #include "drivers/spi_flash.h"
-#include "drivers/st7789_8080.h"
 #include "platform/lcd_dma.h"
 #endif
 
 #define LCD_DMA_BUF_PIXELS 1024u
 
-static uint16_t g_lcd_line_buf[DISP_W];
+/*
+ * Ping-pong line buffers: the CPU rasterizes row N+1 into the back buffer
+ * while DMA drains row N from the front one. Starting a transfer waits for
+ * the previous one, so the back buffer is always free to write.
+ */
+static uint16_t g_lcd_line_buf[2][DISP_W];
+static uint8_t g_lcd_line_back;
+
+/* Pixel-writer state: pixels are batched per window row into the back buffer.
+ * The window is the requested one cut to the scissor; pixels outside it are
+ * dropped. */
+static uint16_t g_lcd_px_row_w;
+static uint16_t g_lcd_px_fill;
+static uint16_t g_lcd_px_x0, g_lcd_px_y0, g_lcd_px_x1, g_lcd_px_y1;
+
+/* Scissor (ui_lcd_set_clip): no primitive writes outside it. */
+static uint16_t g_lcd_clip_x0;
+static uint16_t g_lcd_clip_y0;
+static uint16_t g_lcd_clip_x1 = DISP_W;
+static uint16_t g_lcd_clip_y1 = DISP_H;
+
+/*
+ * Compositing mode, with RAM_EXT: between ui_lcd_frame_begin and
+ * ui_lcd_frame_end the primitives below are queued instead of drawn. The
+ * frame is then rasterized one UI_BAND_H-row band at a time by replaying
+ * the queued ops that touch the band into RAM (the same code as direct
+ * drawing, with the window and pixel sinks pointed at the band), and each
+ * band goes out with one window per covered rectangle. Overdraw costs no
+ * bus time, and an op outside its scissor is dropped when queued. A full
+ * queue is composited early; without RAM_EXT everything is drawn directly.
+ *
+ * Bands are then diffed against an indexed copy of the panel (ui_fb8.h):
+ * only the tiles they change are pushed, expanded through its LUT.
+ */
+#define LCD_DL_OPS 160u
+#define LCD_DL_DATA 4096u
+
+#define LCD_OP_FILL_RECT 1u
+#define LCD_OP_ROUND_RECT 2u
+#define LCD_OP_ROUND_RECT_DITHER 3u
+#define LCD_OP_PANEL 4u
+#define LCD_OP_TEXT 5u
+#define LCD_OP_BIG_DIGIT 6u
+#define LCD_OP_GLYPH 7u
+#define LCD_OP_BATTERY 8u
+#define LCD_OP_WARNING 9u
+#define LCD_OP_RING_ARC 10u
+#define LCD_OP_RING_GAUGE 11u
+#define LCD_OP_BLIT 12u
+#define LCD_OP_SPRITE 13u
+
+typedef struct {
+    uint8_t kind;
+    uint8_t radius;
+    uint8_t level;
+    uint16_t y0, y1;   /* rows it can touch, cut to its scissor */
+    uint16_t clip[4];  /* scissor x0, y0, x1, y1 */
+    uint16_t v[14];
+    uint32_t addr;
+    void *data;        /* in the data arena */
+} lcd_dl_op_t;
+
+typedef struct {
+    lcd_dl_op_t op[LCD_DL_OPS];
+    uint64_t data[LCD_DL_DATA / 8u];
+    uint16_t px[2][UI_BAND_PIXELS];
+    ui_band_t band;
+    ui_fb8_t fb;
+} lcd_comp_t;
+
+_Static_assert(UI_BAND_H == UI_FB8_TILE, "a band is one framebuffer tile row");
+
+static lcd_comp_t g_lcd_comp RAM_EXT;
+
+static struct {
+    uint8_t recording;
+    uint8_t band_on;   /* sinks write g_lcd_comp.band */
+    uint8_t paced;
+    uint8_t back;      /* band buffer to rasterize next */
+    uint8_t fb_ready;  /* g_lcd_comp.fb was reset this boot */
+    uint16_t ops;
+    uint16_t data_used;
+    uint16_t row_y0, row_y1;
+    uint16_t pace_y0, pace_y1;
+} g_lcd_dl;
 
+#if !defined(HOST_TEST)
 static inline void lcd_write_cmd(uint8_t v)
 {
     *(volatile uint16_t *)LCD_CMD_ADDR = (uint16_t)v;
@@ -30,19 +121,133 @@ static inline void lcd_write_data16(uint16_t v)
     *(volatile uint16_t *)LCD_DATA_ADDR = v;
 }
 
-#if !defined(HOST_TEST)
+static uint16_t lcd_read_data16(void)
+{
+    return *(volatile uint16_t *)LCD_DATA_ADDR;
+}
+
 static const st7789_8080_bus_t k_lcd_bus = {
     .write_cmd = lcd_write_cmd,
     .write_data = lcd_write_data,
     .write_data16 = lcd_write_data16,
     .delay_ms = NULL,
+    .read_data = lcd_read_data16,
+};
+#else
+/*
+ * Host: a panel model stands in for the FSMC. CASET/PASET set the window,
+ * RAMWR pixels land in it row by row (ui_lcd_host_panel), every other
+ * command is dropped. GSCAN reads come from ui_lcd_set_read_data.
+ */
+static struct {
+    uint8_t cmd;
+    uint8_t args;     /* parameter bytes since cmd */
+    uint16_t col[2];  /* CASET start, end */
+    uint16_t row[2];  /* PASET start, end */
+    uint16_t x, y;    /* RAMWR cursor */
+    ui_lcd_host_bus_t bus;
+    uint16_t px[DISP_W * DISP_H];
+} g_lcd_host;
+
+static void lcd_write_cmd(uint8_t v)
+{
+    g_lcd_host.cmd = v;
+    g_lcd_host.args = 0u;
+    g_lcd_host.x = g_lcd_host.col[0];
+    g_lcd_host.y = g_lcd_host.row[0];
+    if (v == 0x2Cu)
+        g_lcd_host.bus.windows++;
+}
+
+static void lcd_write_data(uint8_t v)
+{
+    uint16_t *win;
+    if (g_lcd_host.cmd == 0x2Au)
+        win = g_lcd_host.col;
+    else if (g_lcd_host.cmd == 0x2Bu)
+        win = g_lcd_host.row;
+    else
+        return;
+    if (g_lcd_host.args >= 4u)
+        return;
+    /* Start then end, high byte first. */
+    uint16_t *dst = &win[g_lcd_host.args >> 1];
+    if (g_lcd_host.args & 1u)
+        *dst = (uint16_t)((*dst & 0xFF00u) | v);
+    else
+        *dst = (uint16_t)(((uint16_t)v << 8) | (*dst & 0x00FFu));
+    g_lcd_host.args++;
+}
+
+static void lcd_write_data16(uint16_t v)
+{
+    if (g_lcd_host.cmd != 0x2Cu)
+        return;
+    ui_lcd_host_bus_t *bus = &g_lcd_host.bus;
+    if (bus->pixels == 0u || g_lcd_host.y < bus->y0)
+        bus->y0 = g_lcd_host.y;
+    if (bus->pixels == 0u || g_lcd_host.y >= bus->y1)
+        bus->y1 = (uint16_t)(g_lcd_host.y + 1u);
+    bus->pixels++;
+    if (g_lcd_host.x < DISP_W && g_lcd_host.y < DISP_H)
+        g_lcd_host.px[(uint32_t)g_lcd_host.y * DISP_W + g_lcd_host.x] = v;
+    if (g_lcd_host.x < g_lcd_host.col[1])
+    {
+        g_lcd_host.x++;
+        return;
+    }
+    /* End of a window row; past the last row the panel wraps to the first. */
+    g_lcd_host.x = g_lcd_host.col[0];
+    g_lcd_host.y = (g_lcd_host.y < g_lcd_host.row[1]) ? (uint16_t)(g_lcd_host.y + 1u) : g_lcd_host.row[0];
+}
+
+static st7789_8080_bus_t k_lcd_bus = {
+    .write_cmd = lcd_write_cmd,
+    .write_data = lcd_write_data,
+    .write_data16 = lcd_write_data16,
+    .delay_ms = NULL,
+    .read_data = NULL,
 };
 #endif
 
-static void lcd_set_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+/*
+ * Frame pacing: a redraw band starts only while the panel scan is outside it,
+ * so the (faster) bus writer never crosses the beam mid-band. The scanline is
+ * polled with GSCAN over FSMC reads; TE is enabled too for boards wiring it.
+ */
+#define LCD_PACE_UNPROBED 0u
+#define LCD_PACE_ACTIVE 1u
+#define LCD_PACE_UNAVAILABLE 2u
+#define LCD_PACE_SPIN_MAX 40000u /* ~2 frames of GSCAN polls */
+#define LCD_SCANLINE_MAX 400u    /* larger reads mean no readable panel */
+
+static uint8_t g_lcd_pace_state;
+static uint32_t g_lcd_pace_frames;
+static uint32_t g_lcd_pace_missed;
+
+#if defined(HOST_TEST)
+void ui_lcd_set_read_data(uint16_t (*read_data)(void))
+{
+    k_lcd_bus.read_data = read_data;
+    g_lcd_pace_state = LCD_PACE_UNPROBED;
+}
+#endif
+
+/* Wait for the previous line DMA and any flash blit to drain before touching
+ * the bus or g_lcd_line_buf. */
+static inline void lcd_bus_sync(void)
+{
+#if !defined(HOST_TEST)
+    platform_lcd_dma_wait();
+    spi_flash_lcd_blit_wait();
+#endif
+}
+
+static void lcd_bus_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
 {
     if (w == 0u || h == 0u)
         return;
+    lcd_bus_sync();
 #if !defined(HOST_TEST)
     st7789_8080_set_address_window(&k_lcd_bus,
                                    x, y,
@@ -68,16 +273,187 @@ static void lcd_set_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
 #endif
 }
 
-static void lcd_dma_write_line(uint16_t w)
+static void lcd_set_window(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    if (g_lcd_dl.band_on)
+    {
+        ui_band_window(&g_lcd_comp.band, x, y, w, h);
+        return;
+    }
+    /* Drawn past the compositor: the framebuffer no longer knows these tiles. */
+    if (g_lcd_dl.fb_ready)
+        ui_fb8_forget(&g_lcd_comp.fb, x, y, w, h);
+    lcd_bus_window(x, y, w, h);
+}
+
+/* One pixel into the open window. */
+static inline void lcd_write_px(uint16_t color)
+{
+    if (g_lcd_dl.band_on)
+        ui_band_fill(&g_lcd_comp.band, color, 1u);
+    else
+        lcd_write_data16(color);
+}
+
+static void lcd_pace_wait(uint16_t y0, uint16_t y1)
+{
+    lcd_bus_sync();
+    if (g_lcd_pace_state == LCD_PACE_UNPROBED)
+    {
+        int32_t line = st7789_8080_read_scanline(&k_lcd_bus);
+        if (line < 0 || line > (int32_t)LCD_SCANLINE_MAX)
+        {
+            g_lcd_pace_state = LCD_PACE_UNAVAILABLE;
+        }
+        else
+        {
+            st7789_8080_set_tearing_effect(&k_lcd_bus, 1u);
+            g_lcd_pace_state = LCD_PACE_ACTIVE;
+        }
+    }
+    if (g_lcd_pace_state != LCD_PACE_ACTIVE)
+        return;
+
+    g_lcd_pace_frames++;
+    int32_t prev = -1;
+    for (uint32_t spin = 0; spin < LCD_PACE_SPIN_MAX; ++spin)
+    {
+        int32_t line = st7789_8080_read_scanline(&k_lcd_bus);
+        /* Outside the band, or the scan just wrapped to the top of a frame. */
+        if (line < (int32_t)y0 || line > (int32_t)y1 || line < prev)
+            return;
+        prev = line;
+    }
+    g_lcd_pace_missed++;
+}
+
+#if defined(HOST_TEST)
+/* Host stand-in for the RAM_EXT probe (ui_lcd_set_comp_force). */
+static uint8_t g_lcd_comp_host_force;
+#endif
+
+static uint8_t lcd_comp_available(void)
+{
+#if !defined(HOST_TEST)
+    return platform_ram_ext_available();
+#else
+    return g_lcd_comp_host_force;
+#endif
+}
+
+static void lcd_dl_composite(void);
+
+#if defined(HOST_TEST)
+void ui_lcd_set_comp_force(uint8_t on)
+{
+    lcd_dl_composite();
+    g_lcd_comp_host_force = on ? 1u : 0u;
+    g_lcd_dl.recording = 0u;
+    g_lcd_dl.fb_ready = 0u;
+}
+
+const uint16_t *ui_lcd_host_panel(void)
+{
+    return g_lcd_host.px;
+}
+
+void ui_lcd_host_bus(ui_lcd_host_bus_t *out, uint8_t reset)
+{
+    if (out)
+        *out = g_lcd_host.bus;
+    if (reset)
+        memset(&g_lcd_host.bus, 0, sizeof(g_lcd_host.bus));
+}
+#endif
+
+void ui_lcd_frame_begin(uint16_t y0, uint16_t y1)
 {
+    lcd_dl_composite();
+    if (!lcd_comp_available())
+    {
+        lcd_pace_wait(y0, y1);
+        return;
+    }
+    /* Paced before the first band goes out, not while the frame is queued. */
+    g_lcd_dl.recording = 1u;
+    g_lcd_dl.paced = 0u;
+    g_lcd_dl.pace_y0 = y0;
+    g_lcd_dl.pace_y1 = y1;
+}
+
+void ui_lcd_frame_resume(void)
+{
+    if (!lcd_comp_available())
+        return;
+    g_lcd_dl.recording = 1u;
+    g_lcd_dl.paced = 1u;
+}
+
+void ui_lcd_frame_end(void)
+{
+    lcd_dl_composite();
+    g_lcd_dl.recording = 0u;
+}
+
+void ui_lcd_pace_stats(uint32_t *frames, uint32_t *missed)
+{
+    if (frames)
+        *frames = g_lcd_pace_frames;
+    if (missed)
+        *missed = g_lcd_pace_missed;
+}
+
+uint8_t ui_lcd_remote_available(void)
+{
+    return lcd_comp_available();
+}
+
+void ui_lcd_remote_refresh(void)
+{
+    /* Before the first composite, the reset it starts with does this. */
+    if (g_lcd_dl.fb_ready)
+        ui_fb8_remote_all(&g_lcd_comp.fb);
+}
+
+uint16_t ui_lcd_remote_pending(void)
+{
+    return g_lcd_dl.fb_ready ? ui_fb8_remote_pending(&g_lcd_comp.fb) : 0u;
+}
+
+uint16_t ui_lcd_remote_next(ui_fb8_remote_chunk_t *c, uint8_t *rle, uint16_t cap)
+{
+    if (!g_lcd_dl.fb_ready)
+        return 0u;
+    return ui_fb8_remote_next(&g_lcd_comp.fb, c, rle, cap);
+}
+
+static inline uint16_t *lcd_line_back(void)
+{
+    return g_lcd_line_buf[g_lcd_line_back];
+}
+
+static void lcd_dma_write_buf(const uint16_t *buf, uint16_t w)
+{
+    if (g_lcd_dl.band_on)
+    {
+        ui_band_write(&g_lcd_comp.band, buf, w);
+        return;
+    }
 #if !defined(HOST_TEST)
-    platform_lcd_dma_write_u16(g_lcd_line_buf, w);
+    platform_lcd_dma_write_u16(buf, w);
 #else
     for (uint16_t i = 0; i < w; ++i)
-        lcd_write_data16(g_lcd_line_buf[i]);
+        lcd_write_data16(buf[i]);
 #endif
 }
 
+/* Queue the back buffer and flip; the other buffer becomes writable. */
+static void lcd_dma_write_line(uint16_t w)
+{
+    lcd_dma_write_buf(lcd_line_back(), w);
+    g_lcd_line_back ^= 1u;
+}
+
 static uint16_t clip_dim(uint16_t start, uint16_t dim, uint16_t max)
 {
     if (start >= max)
@@ -87,57 +463,156 @@ static uint16_t clip_dim(uint16_t start, uint16_t dim, uint16_t max)
     return dim;
 }
 
-void ui_lcd_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+void ui_lcd_set_clip(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
 {
     w = clip_dim(x, w, DISP_W);
     h = clip_dim(y, h, DISP_H);
-    if (w == 0u || h == 0u)
-        return;
+    g_lcd_clip_x0 = x;
+    g_lcd_clip_y0 = y;
+    g_lcd_clip_x1 = (uint16_t)(x + w);
+    g_lcd_clip_y1 = (uint16_t)(y + h);
+}
 
-    lcd_set_window(x, y, w, h);
+/* Cuts a rect to the scissor (and so to the panel); 0 when nothing is left. */
+static uint8_t lcd_clip(uint16_t *x, uint16_t *y, uint16_t *w, uint16_t *h)
+{
+    uint32_t x0 = *x, y0 = *y;
+    uint32_t x1 = x0 + *w, y1 = y0 + *h;
+    if (x0 < g_lcd_clip_x0)
+        x0 = g_lcd_clip_x0;
+    if (y0 < g_lcd_clip_y0)
+        y0 = g_lcd_clip_y0;
+    if (x1 > g_lcd_clip_x1)
+        x1 = g_lcd_clip_x1;
+    if (y1 > g_lcd_clip_y1)
+        y1 = g_lcd_clip_y1;
+    if (x0 >= x1 || y0 >= y1)
+        return 0u;
+    *x = (uint16_t)x0;
+    *y = (uint16_t)y0;
+    *w = (uint16_t)(x1 - x0);
+    *h = (uint16_t)(y1 - y0);
+    return 1u;
+}
 
-    for (uint16_t i = 0; i < w; ++i)
-        g_lcd_line_buf[i] = color;
+static inline uint8_t lcd_clip_has(int x, int y)
+{
+    return (uint8_t)(x >= (int)g_lcd_clip_x0 && y >= (int)g_lcd_clip_y0 &&
+                     x < (int)g_lcd_clip_x1 && y < (int)g_lcd_clip_y1);
+}
 
-    for (uint16_t row = 0; row < h; ++row)
-        lcd_dma_write_line(w);
+/*
+ * Queues an op that can touch rows [y0, y1) plus `bytes` of data for it.
+ * Returns 0 when no frame is being queued (draw now); otherwise 1 with *out
+ * to fill in, or NULL when the scissor leaves nothing of it.
+ */
+static uint8_t lcd_dl_add(uint8_t kind, int32_t y0, int32_t y1, uint32_t bytes, lcd_dl_op_t **out)
+{
+    *out = NULL;
+    if (!g_lcd_dl.recording)
+        return 0u;
+    if (y0 < (int32_t)g_lcd_clip_y0)
+        y0 = g_lcd_clip_y0;
+    if (y1 > (int32_t)g_lcd_clip_y1)
+        y1 = g_lcd_clip_y1;
+    if (y0 >= y1 || g_lcd_clip_x0 >= g_lcd_clip_x1)
+        return 1u;
+    bytes = (bytes + 7u) & ~7u;
+    if (g_lcd_dl.ops >= LCD_DL_OPS || g_lcd_dl.data_used + bytes > LCD_DL_DATA)
+        lcd_dl_composite();
+    if (g_lcd_dl.ops == 0u)
+    {
+        g_lcd_dl.row_y0 = (uint16_t)y0;
+        g_lcd_dl.row_y1 = (uint16_t)y1;
+    }
+    if (y0 < (int32_t)g_lcd_dl.row_y0)
+        g_lcd_dl.row_y0 = (uint16_t)y0;
+    if (y1 > (int32_t)g_lcd_dl.row_y1)
+        g_lcd_dl.row_y1 = (uint16_t)y1;
+    lcd_dl_op_t *o = &g_lcd_comp.op[g_lcd_dl.ops++];
+    o->kind = kind;
+    o->y0 = (uint16_t)y0;
+    o->y1 = (uint16_t)y1;
+    o->clip[0] = g_lcd_clip_x0;
+    o->clip[1] = g_lcd_clip_y0;
+    o->clip[2] = g_lcd_clip_x1;
+    o->clip[3] = g_lcd_clip_y1;
+    o->data = bytes ? (uint8_t *)g_lcd_comp.data + g_lcd_dl.data_used : NULL;
+    g_lcd_dl.data_used = (uint16_t)(g_lcd_dl.data_used + bytes);
+    *out = o;
+    return 1u;
+}
+
+void ui_lcd_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    lcd_dl_op_t *o;
+    if (lcd_dl_add(LCD_OP_FILL_RECT, y, (int32_t)y + h, 0u, &o))
+    {
+        if (o)
+        {
+            o->v[0] = x;
+            o->v[1] = y;
+            o->v[2] = w;
+            o->v[3] = h;
+            o->v[4] = color;
+        }
+        return;
+    }
+    if (!lcd_clip(&x, &y, &w, &h))
+        return;
+
+    lcd_set_window(x, y, w, h);
+    if (g_lcd_dl.band_on)
+    {
+        ui_band_fill(&g_lcd_comp.band, color, (uint32_t)w * (uint32_t)h);
+        return;
+    }
+#if !defined(HOST_TEST)
+    /* One repeated-pixel transfer covers the whole window (no per-row setup). */
+    platform_lcd_dma_fill_u16(color, (uint32_t)w * (uint32_t)h);
+#else
+    uint32_t total = (uint32_t)w * (uint32_t)h;
+    for (uint32_t i = 0; i < total; ++i)
+        lcd_write_data16(color);
+#endif
 }
 
 static void fill_hline(uint16_t x, uint16_t y, uint16_t w, uint16_t color)
 {
     if (w == 0u)
         return;
-    lcd_set_window(x, y, w, 1u);
-    for (uint16_t i = 0; i < w; ++i)
-        g_lcd_line_buf[i] = color;
-    lcd_dma_write_line(w);
+    ui_lcd_fill_rect(x, y, w, 1u, color);
 }
 
-static void fill_hline_dither(uint16_t x, uint16_t y, uint16_t w, uint16_t c0, uint16_t c1, uint8_t level)
+/* Dither patterns stay anchored to the panel when the scissor cuts them. */
+static RAMFUNC void fill_hline_dither(uint16_t x, uint16_t y, uint16_t w, uint16_t c0, uint16_t c1, uint8_t level)
 {
-    if (w == 0u)
+    uint16_t h = 1u;
+    if (!lcd_clip(&x, &y, &w, &h))
         return;
-    lcd_set_window(x, y, w, 1u);
+    uint16_t *buf = lcd_line_back();
     for (uint16_t i = 0; i < w; ++i)
     {
         uint16_t px = (uint16_t)(x + i);
-        g_lcd_line_buf[i] = ui_draw_dither_pick(px, y, c0, c1, level);
+        buf[i] = ui_draw_dither_pick(px, y, c0, c1, level);
     }
+    lcd_set_window(x, y, w, 1u);
     lcd_dma_write_line(w);
 }
 
-static void fill_rect_dither(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c0, uint16_t c1, uint8_t level)
+static RAMFUNC void fill_rect_dither(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t c0, uint16_t c1, uint8_t level)
 {
-    if (w == 0u || h == 0u)
+    if (!lcd_clip(&x, &y, &w, &h))
         return;
     lcd_set_window(x, y, w, h);
     for (uint16_t yy = 0; yy < h; ++yy)
     {
         uint16_t py = (uint16_t)(y + yy);
+        uint16_t *buf = lcd_line_back();
         for (uint16_t xx = 0; xx < w; ++xx)
         {
             uint16_t px = (uint16_t)(x + xx);
-            g_lcd_line_buf[xx] = ui_draw_dither_pick(px, py, c0, c1, level);
+            buf[xx] = ui_draw_dither_pick(px, py, c0, c1, level);
         }
         lcd_dma_write_line(w);
     }
@@ -182,7 +657,21 @@ void ui_lcd_fill_round_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint
     h = clip_dim(y, h, DISP_H);
     if (w == 0u || h == 0u)
         return;
-    ui_draw_fill_round_rect(&k_lcd_rect_ops, NULL, x, y, w, h, color, radius);
+    lcd_dl_op_t *o;
+    if (lcd_dl_add(LCD_OP_ROUND_RECT, y, (int32_t)y + h, 0u, &o))
+    {
+        if (o)
+        {
+            o->v[0] = x;
+            o->v[1] = y;
+            o->v[2] = w;
+            o->v[3] = h;
+            o->v[4] = color;
+            o->radius = radius;
+        }
+        return;
+    }
+    ui_draw_px_fill_round_rect(&k_lcd_rect_ops, NULL, x, y, w, h, color, radius);
 }
 
 void ui_lcd_fill_round_rect_dither(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
@@ -192,35 +681,200 @@ void ui_lcd_fill_round_rect_dither(uint16_t x, uint16_t y, uint16_t w, uint16_t
     h = clip_dim(y, h, DISP_H);
     if (w == 0u || h == 0u)
         return;
-    ui_draw_fill_round_rect_dither(&k_lcd_rect_ops, NULL, x, y, w, h, color, alt, radius, level);
+    lcd_dl_op_t *o;
+    if (lcd_dl_add(LCD_OP_ROUND_RECT_DITHER, y, (int32_t)y + h, 0u, &o))
+    {
+        if (o)
+        {
+            o->v[0] = x;
+            o->v[1] = y;
+            o->v[2] = w;
+            o->v[3] = h;
+            o->v[4] = color;
+            o->v[5] = alt;
+            o->radius = radius;
+            o->level = level;
+        }
+        return;
+    }
+    ui_draw_px_fill_round_rect_dither(&k_lcd_rect_ops, NULL, x, y, w, h, color, alt, radius, level);
+}
+
+static void clip_rrect(ui_draw_rrect_t *r)
+{
+    r->w = clip_dim(r->x, r->w, DISP_W);
+    r->h = clip_dim(r->y, r->h, DISP_H);
+}
+
+static void rrect_rows(const ui_draw_rrect_t *r, int32_t *y0, int32_t *y1)
+{
+    if (r->w == 0u || r->h == 0u)
+        return;
+    if (r->y < *y0)
+        *y0 = r->y;
+    if ((int32_t)r->y + r->h > *y1)
+        *y1 = (int32_t)r->y + r->h;
+}
+
+void ui_lcd_fill_panel(const ui_draw_panel_t *panel)
+{
+    if (!panel)
+        return;
+    /* Each layer clipped on its own, as when they were filled one by one. */
+    ui_draw_panel_t p = *panel;
+    clip_rrect(&p.shadow);
+    clip_rrect(&p.body);
+    clip_rrect(&p.fill);
+    int32_t y0 = DISP_H, y1 = 0;
+    rrect_rows(&p.shadow, &y0, &y1);
+    rrect_rows(&p.body, &y0, &y1);
+    rrect_rows(&p.fill, &y0, &y1);
+    lcd_dl_op_t *o;
+    if (lcd_dl_add(LCD_OP_PANEL, y0, y1, sizeof(p), &o))
+    {
+        if (o)
+            memcpy(o->data, &p, sizeof(p));
+        return;
+    }
+    ui_draw_fill_panel(&k_lcd_rect_ops, NULL, &p);
 }
 
 static void lcd_begin_window_cb(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
 {
     (void)ctx;
+    g_lcd_px_fill = 0u;
+    if (!lcd_clip(&x, &y, &w, &h))
+    {
+        g_lcd_px_x0 = g_lcd_px_x1 = 0u;
+        g_lcd_px_row_w = 0u;
+        return;
+    }
     lcd_set_window(x, y, w, h);
+    g_lcd_px_x0 = x;
+    g_lcd_px_y0 = y;
+    g_lcd_px_x1 = (uint16_t)(x + w);
+    g_lcd_px_y1 = (uint16_t)(y + h);
+    g_lcd_px_row_w = w;
+}
+
+static RAMFUNC void lcd_px_push(uint16_t n, uint16_t color)
+{
+    while (n)
+    {
+        uint16_t room = (uint16_t)(g_lcd_px_row_w - g_lcd_px_fill);
+        uint16_t take = (n < room) ? n : room;
+        uint16_t *buf = lcd_line_back() + g_lcd_px_fill;
+        for (uint16_t i = 0; i < take; ++i)
+            buf[i] = color;
+        g_lcd_px_fill = (uint16_t)(g_lcd_px_fill + take);
+        n = (uint16_t)(n - take);
+        if (g_lcd_px_fill >= g_lcd_px_row_w)
+        {
+            lcd_dma_write_line(g_lcd_px_row_w);
+            g_lcd_px_fill = 0u;
+        }
+    }
 }
 
-static void lcd_write_pixel_cb(void *ctx, uint16_t x, uint16_t y, uint16_t color)
+/* The writers inline into the ui_draw_px.h loops below; the push itself and
+ * the glyph loop run from SRAM (RAMFUNC). */
+static inline void lcd_write_pixel_cb(void *ctx, uint16_t x, uint16_t y, uint16_t color)
 {
     (void)ctx;
-    (void)x;
-    (void)y;
-    lcd_write_data16(color);
+    if (x < g_lcd_px_x0 || x >= g_lcd_px_x1 || y < g_lcd_px_y0 || y >= g_lcd_px_y1)
+        return;
+    if ((uint16_t)(g_lcd_px_fill + 1u) < g_lcd_px_row_w)
+    {
+        lcd_line_back()[g_lcd_px_fill++] = color;
+        return;
+    }
+    lcd_px_push(1u, color);
+}
+
+static inline void lcd_write_run_cb(void *ctx, uint16_t x, uint16_t y, uint16_t n, uint16_t color)
+{
+    (void)ctx;
+    if (y < g_lcd_px_y0 || y >= g_lcd_px_y1)
+        return;
+    uint32_t x0 = x, x1 = (uint32_t)x + n;
+    if (x0 < g_lcd_px_x0)
+        x0 = g_lcd_px_x0;
+    if (x1 > g_lcd_px_x1)
+        x1 = g_lcd_px_x1;
+    if (x0 < x1)
+        lcd_px_push((uint16_t)(x1 - x0), color);
 }
 
 static const ui_draw_pixel_writer_t k_lcd_pixel_writer = {
     .begin_window = lcd_begin_window_cb,
     .write_pixel = lcd_write_pixel_cb,
+    .write_run = lcd_write_run_cb,
 };
 
+static RAMFUNC void lcd_glyph_a4(uint16_t x, uint16_t y, const ui_draw_glyph_t *g)
+{
+    ui_draw_px_glyph_a4(&k_lcd_pixel_writer, NULL, x, y, g);
+}
+
+void ui_lcd_draw_glyph(uint16_t x, uint16_t y, const ui_draw_glyph_t *g)
+{
+    if (!g || (uint32_t)x + g->w + g->shadow_ofs > DISP_W || (uint32_t)y + g->h + g->shadow_ofs > DISP_H)
+        return;
+    if (g_lcd_dl.recording && sizeof(*g) + g->len > LCD_DL_DATA)
+    {
+        /* Too big to queue: what is queued goes first, then this directly. */
+        lcd_dl_composite();
+        g_lcd_dl.recording = 0u;
+        lcd_glyph_a4(x, y, g);
+        g_lcd_dl.recording = 1u;
+        return;
+    }
+    lcd_dl_op_t *o;
+    if (lcd_dl_add(LCD_OP_GLYPH, y, (int32_t)y + g->h + g->shadow_ofs, sizeof(*g) + g->len, &o))
+    {
+        if (o)
+        {
+            ui_draw_glyph_t *q = (ui_draw_glyph_t *)o->data;
+            *q = *g;
+            memcpy(q + 1, g->rle, g->len);
+            q->rle = (const uint8_t *)(q + 1);
+            o->v[0] = x;
+            o->v[1] = y;
+        }
+        return;
+    }
+    lcd_glyph_a4(x, y, g);
+}
+
 void ui_lcd_draw_ring_arc_a4(uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
                              int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
                              int16_t start_deg_cw, uint16_t sweep_deg_cw,
                              uint16_t fg, uint16_t bg)
 {
-    ui_draw_ring_arc_a4(&k_lcd_pixel_writer, NULL, clip_x, clip_y, clip_w, clip_h, cx, cy,
-                        outer_r, thickness, start_deg_cw, sweep_deg_cw, fg, bg);
+    if (!lcd_clip(&clip_x, &clip_y, &clip_w, &clip_h))
+        return;
+    lcd_dl_op_t *o;
+    if (lcd_dl_add(LCD_OP_RING_ARC, clip_y, (int32_t)clip_y + clip_h, 0u, &o))
+    {
+        if (o)
+        {
+            o->v[0] = clip_x;
+            o->v[1] = clip_y;
+            o->v[2] = clip_w;
+            o->v[3] = clip_h;
+            o->v[4] = (uint16_t)cx;
+            o->v[5] = (uint16_t)cy;
+            o->v[6] = outer_r;
+            o->v[7] = thickness;
+            o->v[8] = (uint16_t)start_deg_cw;
+            o->v[9] = sweep_deg_cw;
+            o->v[10] = fg;
+            o->v[11] = bg;
+        }
+        return;
+    }
+    ui_draw_px_ring_arc_a4(&k_lcd_pixel_writer, NULL, clip_x, clip_y, clip_w, clip_h, cx, cy,
+                           outer_r, thickness, start_deg_cw, sweep_deg_cw, fg, bg);
 }
 
 void ui_lcd_draw_ring_gauge_a4(uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
@@ -228,18 +882,42 @@ void ui_lcd_draw_ring_gauge_a4(uint16_t clip_x, uint16_t clip_y, uint16_t clip_w
                                int16_t start_deg_cw, uint16_t sweep_deg_cw, uint16_t active_sweep_deg_cw,
                                uint16_t fg_active, uint16_t fg_inactive, uint16_t bg)
 {
-    ui_draw_ring_gauge_a4(&k_lcd_pixel_writer, NULL, clip_x, clip_y, clip_w, clip_h, cx, cy,
-                          outer_r, thickness, start_deg_cw, sweep_deg_cw, active_sweep_deg_cw,
-                          fg_active, fg_inactive, bg);
+    if (!lcd_clip(&clip_x, &clip_y, &clip_w, &clip_h))
+        return;
+    lcd_dl_op_t *o;
+    if (lcd_dl_add(LCD_OP_RING_GAUGE, clip_y, (int32_t)clip_y + clip_h, 0u, &o))
+    {
+        if (o)
+        {
+            o->v[0] = clip_x;
+            o->v[1] = clip_y;
+            o->v[2] = clip_w;
+            o->v[3] = clip_h;
+            o->v[4] = (uint16_t)cx;
+            o->v[5] = (uint16_t)cy;
+            o->v[6] = outer_r;
+            o->v[7] = thickness;
+            o->v[8] = (uint16_t)start_deg_cw;
+            o->v[9] = sweep_deg_cw;
+            o->v[10] = active_sweep_deg_cw;
+            o->v[11] = fg_active;
+            o->v[12] = fg_inactive;
+            o->v[13] = bg;
+        }
+        return;
+    }
+    ui_draw_px_ring_gauge_a4(&k_lcd_pixel_writer, NULL, clip_x, clip_y, clip_w, clip_h, cx, cy,
+                             outer_r, thickness, start_deg_cw, sweep_deg_cw, active_sweep_deg_cw,
+                             fg_active, fg_inactive, bg);
 }
 
 static void stroke_plot(int x, int y, uint16_t color, void *user)
 {
     (void)user;
-    if (x < 0 || y < 0 || x >= (int)DISP_W || y >= (int)DISP_H)
+    if (!lcd_clip_has(x, y))
         return;
     lcd_set_window((uint16_t)x, (uint16_t)y, 1u, 1u);
-    lcd_write_data16(color);
+    lcd_write_px(color);
 }
 
 static void stroke_rect(int x, int y, int w, int h, uint16_t color, void *user)
@@ -250,9 +928,62 @@ static void stroke_rect(int x, int y, int w, int h, uint16_t color, void *user)
     ui_lcd_fill_rect((uint16_t)x, (uint16_t)y, (uint16_t)w, (uint16_t)h, color);
 }
 
+/* Opaque glyph: rasterize the whole cell into the line buffer and push it in
+ * one window write. Returns 0 when the scissor cuts the cell or it is too
+ * large. */
+static uint8_t lcd_draw_glyph_cell(int x, int y, const ui_font_bitmap_glyph_t *g, uint16_t fg, uint16_t bg)
+{
+    int gx = x + g->xoff;
+    int gy = y + g->yoff;
+    uint16_t n = (uint16_t)(g->w * g->h);
+    if (!lcd_clip_has(gx, gy) || !lcd_clip_has(gx + g->w - 1, gy + g->h - 1) || n > DISP_W)
+        return 0u;
+    ui_font_bitmap_glyph_cell(g, lcd_line_back(), fg, bg);
+    lcd_set_window((uint16_t)gx, (uint16_t)gy, g->w, g->h);
+    lcd_dma_write_line(n);
+    return 1u;
+}
+
 void ui_lcd_draw_text_stroke(uint16_t x, uint16_t y, const char *text, uint16_t fg, uint16_t bg)
 {
-    ui_font_bitmap_draw_text(stroke_plot, stroke_rect, NULL, (int)x, (int)y, text, fg, bg);
+    if (!text)
+        return;
+    lcd_dl_op_t *o;
+    /* Baseline y; nothing past DISP_W characters can land on the panel. */
+    size_t len = strlen(text);
+    if (len > DISP_W)
+        len = DISP_W;
+    if (lcd_dl_add(LCD_OP_TEXT, (int32_t)y - UI_FONT_BITMAP_LINE_HEIGHT,
+                   (int32_t)y + UI_FONT_BITMAP_LINE_HEIGHT, len + 1u, &o))
+    {
+        if (o)
+        {
+            memcpy(o->data, text, len);
+            ((char *)o->data)[len] = '\0';
+            o->v[0] = x;
+            o->v[1] = y;
+            o->v[2] = fg;
+            o->v[3] = bg;
+        }
+        return;
+    }
+    if (bg == 0xFFFFu)
+    {
+        ui_font_bitmap_draw_text(stroke_plot, stroke_rect, NULL, (int)x, (int)y, text, fg, bg);
+        return;
+    }
+
+    int cx = (int)x;
+    for (const char *p = text; *p; ++p)
+    {
+        const ui_font_bitmap_glyph_t *g = ui_font_bitmap_glyph(*p);
+        if (g->w && g->h && !lcd_draw_glyph_cell(cx, (int)y, g, fg, bg))
+        {
+            char one[2] = {*p, '\0'};
+            ui_font_bitmap_draw_text(stroke_plot, stroke_rect, NULL, cx, (int)y, one, fg, bg);
+        }
+        cx += g->xadv;
+    }
 }
 
 void ui_lcd_draw_value_stroke(uint16_t x, uint16_t y, const char *label, int32_t value, uint16_t fg, uint16_t bg)
@@ -264,21 +995,61 @@ void ui_lcd_draw_value_stroke(uint16_t x, uint16_t y, const char *label, int32_t
 
 void ui_lcd_draw_big_digit_7seg(uint16_t x, uint16_t y, uint8_t digit, uint8_t scale, uint16_t color)
 {
+    lcd_dl_op_t *o;
+    if (lcd_dl_add(LCD_OP_BIG_DIGIT, y, (int32_t)y + UI_BIG_DIGIT_HEIGHT(scale), 0u, &o))
+    {
+        if (o)
+        {
+            o->v[0] = x;
+            o->v[1] = y;
+            o->v[2] = color;
+            o->radius = digit;
+            o->level = scale;
+        }
+        return;
+    }
     ui_draw_big_digit_7seg(&k_lcd_rect_ops, NULL, x, y, digit, scale, color);
 }
 
 void ui_lcd_draw_battery_icon(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t soc, uint16_t color, uint16_t bg)
 {
+    lcd_dl_op_t *o;
+    if (lcd_dl_add(LCD_OP_BATTERY, y, (int32_t)y + h, 0u, &o))
+    {
+        if (o)
+        {
+            o->v[0] = x;
+            o->v[1] = y;
+            o->v[2] = w;
+            o->v[3] = h;
+            o->v[4] = color;
+            o->v[5] = bg;
+            o->level = soc;
+        }
+        return;
+    }
     ui_draw_battery_icon_ops(&k_lcd_rect_ops, NULL, x, y, w, h, soc, color, bg);
 }
 
 void ui_lcd_draw_warning_icon(uint16_t x, uint16_t y, uint16_t color)
 {
+    lcd_dl_op_t *o;
+    /* ui_draw_warning_icon_ops: 12 x 12. */
+    if (lcd_dl_add(LCD_OP_WARNING, y, (int32_t)y + 12, 0u, &o))
+    {
+        if (o)
+        {
+            o->v[0] = x;
+            o->v[1] = y;
+            o->v[2] = color;
+        }
+        return;
+    }
     ui_draw_warning_icon_ops(&k_lcd_rect_ops, NULL, x, y, color);
 }
 
 void ui_lcd_blit_rgb565_from_spi_flash(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
-                                       uint32_t flash_addr)
+                                       uint32_t flash_addr, ui_lcd_blit_done_fn done, void *ctx)
 {
 #if defined(HOST_TEST)
     (void)x;
@@ -286,22 +1057,257 @@ void ui_lcd_blit_rgb565_from_spi_flash(uint16_t x, uint16_t y, uint16_t w, uint1
     (void)w;
     (void)h;
     (void)flash_addr;
+    if (done)
+        done(ctx);
     return;
 #else
-    w = clip_dim(x, w, DISP_W);
-    h = clip_dim(y, h, DISP_H);
-    if (w == 0u || h == 0u)
+    lcd_dl_op_t *o;
+    if (!done && lcd_dl_add(LCD_OP_BLIT, y, (int32_t)y + h, 0u, &o))
+    {
+        if (o)
+        {
+            o->v[0] = x;
+            o->v[1] = y;
+            o->v[2] = w;
+            o->v[3] = h;
+            o->addr = flash_addr;
+        }
         return;
+    }
+    /* A completion is for the pixels on the panel: draw what is queued first. */
+    if (g_lcd_dl.recording)
+        lcd_dl_composite();
+    uint16_t cx = x, cy = y, cw = w, ch = h;
+    if (!lcd_clip(&cx, &cy, &cw, &ch))
+    {
+        if (done)
+            done(ctx);
+        return;
+    }
 
-    lcd_set_window(x, y, w, h);
+    uint32_t src = (uint32_t)(cy - y) * w + (uint32_t)(cx - x);
+    lcd_set_window(cx, cy, cw, ch);
+    if (g_lcd_dl.band_on)
+    {
+        /* Into the band by CPU reads, swapped from big-endian. */
+        for (uint16_t row = 0; row < ch; ++row)
+        {
+            uint16_t *buf = lcd_line_back();
+            spi_flash_read(flash_addr + (src + (uint32_t)row * w) * 2u, (uint8_t *)buf, (uint32_t)cw * 2u);
+            for (uint16_t i = 0; i < cw; ++i)
+                buf[i] = (uint16_t)((buf[i] << 8) | (buf[i] >> 8));
+            lcd_dma_write_buf(buf, cw);
+        }
+        return;
+    }
+    lcd_bus_sync();
+    if (cw != w)
+    {
+        /* Cut columns: one run per visible row, at the row's stride. */
+        spi_flash_lcd_blit_start(flash_addr + src * 2u, cw, ch, (uint32_t)w * 2u, done, ctx);
+        return;
+    }
+    spi_flash_lcd_blit_start(flash_addr + src * 2u, (uint32_t)w * ch, 1u, 0u, done, ctx);
+#endif
+}
 
-    uint32_t total = (uint32_t)w * (uint32_t)h;
-    while (total)
+/* Pack sprites: RGB565 goes flash->panel by DMA, A4 is read once and decoded
+ * row by row into the line buffers with the tint. ui.c keeps them on screen;
+ * the scissor may still cut them. */
+void ui_lcd_draw_sprite(uint16_t x, uint16_t y, const ui_sprite_t *sp, uint16_t fg, uint16_t bg)
+{
+#if defined(HOST_TEST)
+    (void)x;
+    (void)y;
+    (void)sp;
+    (void)fg;
+    (void)bg;
+#else
+    if (!sp)
+        return;
+    lcd_dl_op_t *o;
+    if (lcd_dl_add(LCD_OP_SPRITE, y, (int32_t)y + sp->h, sizeof(*sp), &o))
     {
-        uint16_t chunk = (total > 0xE000u) ? 0xE000u : (uint16_t)total;
-        spi_flash_read_dma_to_lcd(flash_addr, LCD_DATA_ADDR, chunk);
-        flash_addr += (uint32_t)chunk * 2u;
-        total -= chunk;
+        if (o)
+        {
+            memcpy(o->data, sp, sizeof(*sp));
+            o->v[0] = x;
+            o->v[1] = y;
+            o->v[2] = fg;
+            o->v[3] = bg;
+        }
+        return;
+    }
+    if (sp->fmt == UI_SPRITE_FMT_RGB565)
+    {
+        ui_lcd_blit_rgb565_from_spi_flash(x, y, sp->w, sp->h, sp->addr, NULL, NULL);
+        return;
+    }
+    if (sp->fmt != UI_SPRITE_FMT_A4_RLE || sp->len > UI_SPRITE_A4_MAX_BYTES || sp->w > DISP_W)
+        return;
+    uint16_t cx = x, cy = y, cw = sp->w, ch = sp->h;
+    if (!lcd_clip(&cx, &cy, &cw, &ch))
+        return;
+    uint8_t rle[UI_SPRITE_A4_MAX_BYTES];
+    spi_flash_read(sp->addr, rle, sp->len);
+    lcd_set_window(cx, cy, cw, ch);
+    uint32_t off = 0u;
+    uint16_t end = (uint16_t)(cy - y + ch);
+    for (uint16_t row = 0; row < end; ++row)
+    {
+        /* Rows above the scissor still decode: the stream is sequential. */
+        uint16_t *buf = lcd_line_back();
+        uint32_t used = ui_draw_a4_rle_row(&rle[off], sp->len - off, sp->w, fg, bg, buf);
+        if (used == 0u)
+        {
+            /* Truncated stream: finish the window in bg rather than leave it open. */
+            for (uint16_t i = 0; i < sp->w; ++i)
+                buf[i] = bg;
+        }
+        off += used;
+        if (row < cy - y)
+            continue;
+        lcd_dma_write_buf(buf + (cx - x), cw);
+        g_lcd_line_back ^= 1u;
+    }
+#endif
+}
+
+/* Window once per rectangle; contiguous rows go out in one transfer. */
+static void lcd_band_push(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                          const uint16_t *px, uint16_t stride)
+{
+    (void)ctx;
+    lcd_bus_window(x, y, w, h);
+#if !defined(HOST_TEST)
+    if (stride == w)
+    {
+        platform_lcd_dma_write_u16(px, (uint32_t)w * h);
+        return;
+    }
+    for (uint16_t r = 0; r < h; ++r)
+        platform_lcd_dma_write_u16(px + (uint32_t)r * stride, w);
+#else
+    for (uint16_t r = 0; r < h; ++r)
+    {
+        for (uint16_t i = 0; i < w; ++i)
+            lcd_write_data16(px[(uint32_t)r * stride + i]);
     }
 #endif
 }
+
+static void lcd_dl_run(const lcd_dl_op_t *o)
+{
+    const uint16_t *v = o->v;
+    switch (o->kind)
+    {
+    case LCD_OP_FILL_RECT:
+        ui_lcd_fill_rect(v[0], v[1], v[2], v[3], v[4]);
+        break;
+    case LCD_OP_ROUND_RECT:
+        ui_lcd_fill_round_rect(v[0], v[1], v[2], v[3], v[4], o->radius);
+        break;
+    case LCD_OP_ROUND_RECT_DITHER:
+        ui_lcd_fill_round_rect_dither(v[0], v[1], v[2], v[3], v[4], v[5], o->radius, o->level);
+        break;
+    case LCD_OP_PANEL:
+        ui_lcd_fill_panel((const ui_draw_panel_t *)o->data);
+        break;
+    case LCD_OP_TEXT:
+        ui_lcd_draw_text_stroke(v[0], v[1], (const char *)o->data, v[2], v[3]);
+        break;
+    case LCD_OP_BIG_DIGIT:
+        ui_lcd_draw_big_digit_7seg(v[0], v[1], o->radius, o->level, v[2]);
+        break;
+    case LCD_OP_GLYPH:
+        ui_lcd_draw_glyph(v[0], v[1], (const ui_draw_glyph_t *)o->data);
+        break;
+    case LCD_OP_BATTERY:
+        ui_lcd_draw_battery_icon(v[0], v[1], v[2], v[3], o->level, v[4], v[5]);
+        break;
+    case LCD_OP_WARNING:
+        ui_lcd_draw_warning_icon(v[0], v[1], v[2]);
+        break;
+    case LCD_OP_RING_ARC:
+        ui_lcd_draw_ring_arc_a4(v[0], v[1], v[2], v[3], (int16_t)v[4], (int16_t)v[5], v[6], v[7],
+                                (int16_t)v[8], v[9], v[10], v[11]);
+        break;
+    case LCD_OP_RING_GAUGE:
+        ui_lcd_draw_ring_gauge_a4(v[0], v[1], v[2], v[3], (int16_t)v[4], (int16_t)v[5], v[6], v[7],
+                                  (int16_t)v[8], v[9], v[10], v[11], v[12], v[13]);
+        break;
+    case LCD_OP_BLIT:
+        ui_lcd_blit_rgb565_from_spi_flash(v[0], v[1], v[2], v[3], o->addr, NULL, NULL);
+        break;
+    case LCD_OP_SPRITE:
+        ui_lcd_draw_sprite(v[0], v[1], (const ui_sprite_t *)o->data, v[2], v[3]);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Rasterizes the queued ops band by band and pushes each band, alternating
+ * buffers so the next band is drawn while the last one's DMA drains. */
+static void lcd_dl_composite(void)
+{
+    if (g_lcd_dl.ops == 0u)
+        return;
+    uint16_t clip[4] = {g_lcd_clip_x0, g_lcd_clip_y0, g_lcd_clip_x1, g_lcd_clip_y1};
+    if (!g_lcd_dl.fb_ready)
+    {
+        ui_fb8_reset(&g_lcd_comp.fb);
+        g_lcd_dl.fb_ready = 1u;
+    }
+    g_lcd_dl.recording = 0u;
+    g_lcd_dl.band_on = 1u;
+    ui_band_t *b = &g_lcd_comp.band;
+    /* On the tile grid: DISP_H is a whole number of bands. */
+    uint16_t y = (uint16_t)(g_lcd_dl.row_y0 - g_lcd_dl.row_y0 % UI_BAND_H);
+    const uint16_t h = UI_BAND_H;
+    for (; y < g_lcd_dl.row_y1; y = (uint16_t)(y + h))
+    {
+        ui_band_begin(b, g_lcd_comp.px[g_lcd_dl.back], y, h);
+        for (uint16_t i = 0; i < g_lcd_dl.ops; ++i)
+        {
+            const lcd_dl_op_t *o = &g_lcd_comp.op[i];
+            if (o->y1 <= y || o->y0 >= y + h)
+                continue;
+            g_lcd_clip_x0 = o->clip[0];
+            g_lcd_clip_x1 = o->clip[2];
+            g_lcd_clip_y0 = (o->clip[1] > y) ? o->clip[1] : y;
+            g_lcd_clip_y1 = (o->clip[3] < y + h) ? o->clip[3] : (uint16_t)(y + h);
+            lcd_dl_run(o);
+        }
+        if (!g_lcd_dl.paced)
+        {
+            g_lcd_dl.paced = 1u;
+            lcd_pace_wait(g_lcd_dl.pace_y0, g_lcd_dl.pace_y1);
+        }
+        g_lcd_dl.band_on = 0u;
+        if (ui_fb8_absorb(&g_lcd_comp.fb, b))
+        {
+            /* Unknown tiles go out of this buffer; changed known tiles are
+             * expanded into the other one once its last push has drained,
+             * and the next band is drawn here while they go out. */
+            (void)ui_band_flush(b, lcd_band_push, NULL);
+            lcd_bus_sync();
+            (void)ui_fb8_push_row(&g_lcd_comp.fb, (uint16_t)(y / UI_FB8_TILE),
+                                  g_lcd_comp.px[g_lcd_dl.back ^ 1u], lcd_band_push, NULL);
+        }
+        else
+        {
+            (void)ui_band_flush(b, lcd_band_push, NULL);
+            g_lcd_dl.back ^= 1u;
+        }
+        g_lcd_dl.band_on = 1u;
+    }
+    g_lcd_dl.band_on = 0u;
+    g_lcd_dl.recording = 1u;
+    g_lcd_dl.ops = 0u;
+    g_lcd_dl.data_used = 0u;
+    g_lcd_clip_x0 = clip[0];
+    g_lcd_clip_y0 = clip[1];
+    g_lcd_clip_x1 = clip[2];
+    g_lcd_clip_y1 = clip[3];
+}
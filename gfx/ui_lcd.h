@@ -3,13 +3,56 @@
 
 #include <stdint.h>
 
+#include "ui_draw_common.h"
+#include "ui_fb8.h"
+
+/* Wait (bounded) until the panel scan is outside rows [y0, y1] before a redraw;
+ * a timeout is counted as a missed vsync. */
+void ui_lcd_frame_begin(uint16_t y0, uint16_t y1);
+/* With RAM_EXT, primitives from frame_begin (or frame_resume, which skips
+ * the pacing for a frame already on its way) to frame_end are composited in
+ * RAM bands and reach the panel at frame_end. */
+void ui_lcd_frame_resume(void);
+void ui_lcd_frame_end(void);
+void ui_lcd_pace_stats(uint32_t *frames, uint32_t *missed);
+#ifdef HOST_TEST
+/* Panel reads behind GSCAN (dummy, high, low per poll) for the pacing above;
+ * NULL, the default, is a panel that cannot be read. Re-probes the panel. */
+void ui_lcd_set_read_data(uint16_t (*read_data)(void));
+/* Frames go through the compositor as on a board with RAM_EXT (on) or are
+ * drawn directly (off, the default). Either way the indexed copy of the
+ * panel starts over unknown. */
+void ui_lcd_set_comp_force(uint8_t on);
+/* What the bus writes left on the panel: DISP_W x DISP_H RGB565, row-major. */
+const uint16_t *ui_lcd_host_panel(void);
+/* Bus traffic the panel model has seen. */
+typedef struct {
+    uint32_t windows;  /* RAMWR commands */
+    uint32_t pixels;
+    uint16_t y0, y1;   /* rows the pixels landed in, y1 exclusive (with pixels) */
+} ui_lcd_host_bus_t;
+/* Copies the counters out (out may be NULL), then clears them if `reset`. */
+void ui_lcd_host_bus(ui_lcd_host_bus_t *out, uint8_t reset);
+#endif
+/* Remote viewer over the compositor's framebuffer (ui_fb8_remote_next):
+ * the panel's tiles as they change, RLE encoded. Only with RAM_EXT; without
+ * it nothing is read. */
+uint8_t ui_lcd_remote_available(void);
+void ui_lcd_remote_refresh(void);
+uint16_t ui_lcd_remote_pending(void);
+uint16_t ui_lcd_remote_next(ui_fb8_remote_chunk_t *c, uint8_t *rle, uint16_t cap);
+/* Scissor for every primitive below, cut to the panel; (0, 0, DISP_W, DISP_H)
+ * turns it off. Dither and flash sprites stay anchored where they were. */
+void ui_lcd_set_clip(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
 void ui_lcd_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
 void ui_lcd_fill_round_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color, uint8_t radius);
 void ui_lcd_fill_round_rect_dither(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
                                    uint16_t color, uint16_t alt, uint8_t radius, uint8_t level);
+void ui_lcd_fill_panel(const ui_draw_panel_t *panel);
 void ui_lcd_draw_text_stroke(uint16_t x, uint16_t y, const char *text, uint16_t fg, uint16_t bg);
 void ui_lcd_draw_value_stroke(uint16_t x, uint16_t y, const char *label, int32_t value, uint16_t fg, uint16_t bg);
 void ui_lcd_draw_big_digit_7seg(uint16_t x, uint16_t y, uint8_t digit, uint8_t scale, uint16_t color);
+void ui_lcd_draw_glyph(uint16_t x, uint16_t y, const ui_draw_glyph_t *g);
 void ui_lcd_draw_battery_icon(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t soc, uint16_t color, uint16_t bg);
 void ui_lcd_draw_warning_icon(uint16_t x, uint16_t y, uint16_t color);
 void ui_lcd_draw_ring_arc_a4(uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
@@ -20,6 +63,11 @@ void ui_lcd_draw_ring_gauge_a4(uint16_t clip_x, uint16_t clip_y, uint16_t clip_w
                                int16_t cx, int16_t cy, uint16_t outer_r, uint16_t thickness,
                                int16_t start_deg_cw, uint16_t sweep_deg_cw, uint16_t active_sweep_deg_cw,
                                uint16_t fg_active, uint16_t fg_inactive, uint16_t bg);
+/* Non-blocking: returns with the flash->panel DMA in flight and the next LCD
+ * call waits for it. done (optional) runs from the work queue once the last
+ * pixel is out, or before return when nothing was drawn. */
+typedef void (*ui_lcd_blit_done_fn)(void *ctx);
 void ui_lcd_blit_rgb565_from_spi_flash(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
-                                       uint32_t flash_addr);
+                                       uint32_t flash_addr, ui_lcd_blit_done_fn done, void *ctx);
+void ui_lcd_draw_sprite(uint16_t x, uint16_t y, const ui_sprite_t *sp, uint16_t fg, uint16_t bg);
 #endif
@@ -3,13 +3,17 @@
  * @brief ARM EABI runtime support for bare-metal builds
  *
  * Provides 64-bit division/modulo functions required by ARM EABI.
- * These are normally provided by libgcc or compiler-rt.
+ * These are normally provided by libgcc or compiler-rt. Every 64-bit '/'
+ * or '%' the compiler cannot narrow lands here; `ninja -C build` writes
+ * the call sites to div64_sites.txt (scripts/div64_report.py).
  */
 
 #include <stdint.h>
 
+#include "div64.h"
+
 /**
- * 64-bit unsigned division: binary long division algorithm
+ * 64-bit unsigned division: normalized 32-bit UDIV steps (div64.h)
  */
 void __udivmoddi4(uint64_t num, uint64_t den, uint64_t *quot_out, uint64_t *rem_out)
 {
@@ -26,26 +30,7 @@ void __udivmoddi4(uint64_t num, uint64_t den, uint64_t *quot_out, uint64_t *rem_
         return;
     }
 
-    if (den == 1) {
-        *quot_out = num;
-        *rem_out = 0;
-        return;
-    }
-
-    /* Binary long division */
-    uint64_t quot = 0;
-    uint64_t rem = 0;
-
-    for (int i = 63; i >= 0; i--) {
-        rem = (rem << 1) | ((num >> i) & 1);
-        if (rem >= den) {
-            rem -= den;
-            quot |= (1ULL << i);
-        }
-    }
-
-    *quot_out = quot;
-    *rem_out = rem;
+    *quot_out = div64_u64(num, den, rem_out);
 }
 
 /* 64-bit unsigned division - returns quotient only */
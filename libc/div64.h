@@ -0,0 +1,104 @@
+/**
+ * @file div64.h
+ * @brief 64-bit division built from 32-bit UDIV steps
+ *
+ * Header-only so __udivmoddi4 (arm_aeabi.c), divu64_32 (math_util.h) and
+ * the host tests share one implementation. The divisor is normalized with
+ * CLZ and the quotient is produced 16 bits at a time (Knuth's algorithm D
+ * in the two-digit form from Hacker's Delight): each digit is one hardware
+ * UDIV plus at most two corrections, instead of 64 shift-subtract rounds.
+ * Nothing here may use a 64-bit '/' or '%', which would call back into the
+ * runtime.
+ */
+
+#ifndef LIBC_DIV64_H
+#define LIBC_DIV64_H
+
+#include <stdint.h>
+
+/* (u1:u0) / v with u1 < v and v != 0, so the quotient fits in 32 bits. */
+static inline uint32_t div64_step(uint32_t u1, uint32_t u0, uint32_t v, uint32_t *rem)
+{
+    uint32_t s = (uint32_t)__builtin_clz(v);
+    v <<= s;
+    uint32_t vn1 = v >> 16;
+    uint32_t vn0 = v & 0xFFFFu;
+    uint32_t un32 = s ? (u1 << s) | (u0 >> (32u - s)) : u1;
+    uint32_t un10 = u0 << s;
+    uint32_t un1 = un10 >> 16;
+    uint32_t un0 = un10 & 0xFFFFu;
+
+    /* High digit: the estimate from the top divisor half is at most two
+     * too large. */
+    uint32_t q1 = un32 / vn1;
+    uint32_t rhat = un32 - q1 * vn1;
+    while (q1 > 0xFFFFu || q1 * vn0 > ((rhat << 16) | un1))
+    {
+        q1--;
+        rhat += vn1;
+        if (rhat > 0xFFFFu)
+            break;
+    }
+    uint32_t un21 = (un32 << 16) + un1 - q1 * v;
+
+    uint32_t q0 = un21 / vn1;
+    rhat = un21 - q0 * vn1;
+    while (q0 > 0xFFFFu || q0 * vn0 > ((rhat << 16) | un0))
+    {
+        q0--;
+        rhat += vn1;
+        if (rhat > 0xFFFFu)
+            break;
+    }
+    *rem = ((un21 << 16) + un0 - q0 * v) >> s;
+    return (q1 << 16) | q0;
+}
+
+/* n / d and n % d; d must be non-zero. */
+static inline uint64_t div64_u64(uint64_t n, uint64_t d, uint64_t *rem)
+{
+    uint32_t n1 = (uint32_t)(n >> 32);
+    uint32_t d1 = (uint32_t)(d >> 32);
+    uint32_t d0 = (uint32_t)d;
+    if (d1 == 0u)
+    {
+        uint32_t q1 = 0u;
+        if (n1 >= d0)
+        {
+            q1 = n1 / d0;
+            n1 -= q1 * d0;
+        }
+        uint32_t r;
+        uint32_t q0 = div64_step(n1, (uint32_t)n, d0, &r);
+        *rem = r;
+        return ((uint64_t)q1 << 32) | q0;
+    }
+
+    /* d >= 2^32, so the quotient fits in 32 bits. Divide n/2 by the top
+     * 32 bits of the normalized divisor; the estimate is then at most one
+     * too small after backing it off by one. */
+    uint32_t s = (uint32_t)__builtin_clz(d1);
+    uint32_t v1 = s ? (d1 << s) | (d0 >> (32u - s)) : d1;
+    uint32_t r;
+    uint32_t q = div64_step(n1 >> 1, (n1 << 31) | ((uint32_t)n >> 1), v1, &r);
+    q >>= 31u - s;
+    if (q != 0u)
+        q--;
+    uint64_t rest = n - (uint64_t)q * d;
+    if (rest >= d)
+    {
+        q++;
+        rest -= d;
+    }
+    *rem = rest;
+    return q;
+}
+
+/* Low 32 bits of n / d; d must be non-zero. */
+static inline uint32_t div64_u32(uint64_t n, uint32_t d)
+{
+    uint32_t r;
+    return div64_step((uint32_t)(n >> 32) % d, (uint32_t)n, d, &r);
+}
+
+#endif /* LIBC_DIV64_H */
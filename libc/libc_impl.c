@@ -2,13 +2,15 @@
  * @file libc_impl.c
  * @brief Minimal libc implementations for freestanding builds
  *
- * memset, memcpy, memmove, memcmp are provided by compiler builtins.
- * This file provides other commonly needed functions.
+ * With -fno-builtin every struct copy and buffer fill lands in the mem*
+ * functions here; the word/burst cores are in mem_words.h.
  */
 
 #include <stddef.h>
 #include <stdint.h>
 
+#include "mem_words.h"
+
 /* String length */
 size_t strlen(const char *s)
 {
@@ -90,25 +92,17 @@ char *strncat(char *dest, const char *src, size_t n)
     return dest;
 }
 
-/*
- * Memory functions - these are usually provided by compiler builtins,
- * but we provide them as fallbacks in case the compiler doesn't inline them.
- */
+/* Memory functions */
 
 void *memset(void *s, int c, size_t n)
 {
-    uint8_t *p = (uint8_t *)s;
-    while (n--)
-        *p++ = (uint8_t)c;
+    mem_fill((uint8_t *)s, (uint8_t)c, n);
     return s;
 }
 
 void *memcpy(void *dest, const void *src, size_t n)
 {
-    uint8_t *d = (uint8_t *)dest;
-    const uint8_t *s = (const uint8_t *)src;
-    while (n--)
-        *d++ = *s++;
+    mem_copy_fwd((uint8_t *)dest, (const uint8_t *)src, n);
     return dest;
 }
 
@@ -117,15 +111,10 @@ void *memmove(void *dest, const void *src, size_t n)
     uint8_t *d = (uint8_t *)dest;
     const uint8_t *s = (const uint8_t *)src;
 
-    if (d < s) {
-        while (n--)
-            *d++ = *s++;
-    } else if (d > s) {
-        d += n;
-        s += n;
-        while (n--)
-            *--d = *--s;
-    }
+    if (d < s)
+        mem_copy_fwd(d, s, n);
+    else if (d > s)
+        mem_copy_bwd(d, s, n);
     return dest;
 }
 
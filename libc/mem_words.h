@@ -0,0 +1,152 @@
+/**
+ * @file mem_words.h
+ * @brief Word and burst cores behind memcpy, memmove and memset
+ *
+ * Header-only so tests/host/bench/bench_mem.c checks the same code against
+ * the host libc. Copies align the destination first, then move words: the
+ * Cortex-M4 takes unaligned LDR in hardware, so the source may sit at any
+ * offset. A word-aligned source goes through 32-byte LDM/STM bursts on
+ * Thumb-2 (four words per C step elsewhere). Runs under 8 bytes stay
+ * byte loops.
+ */
+
+#ifndef LIBC_MEM_WORDS_H
+#define LIBC_MEM_WORDS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t __attribute__((may_alias)) mem_word_t;
+typedef uint32_t __attribute__((aligned(1), may_alias)) mem_uword_t;
+
+/* Keeps GCC from turning the loops below back into mem* calls. */
+#if defined(__GNUC__) && !defined(__clang__)
+#define MEM_NO_LIBCALL __attribute__((optimize("no-tree-loop-distribute-patterns")))
+#else
+#define MEM_NO_LIBCALL
+#endif
+
+MEM_NO_LIBCALL
+static inline void mem_copy_fwd(uint8_t *d, const uint8_t *s, size_t n)
+{
+    if (n >= 8u)
+    {
+        while ((uintptr_t)d & 3u)
+        {
+            *d++ = *s++;
+            n--;
+        }
+        if (((uintptr_t)s & 3u) == 0u)
+        {
+#if defined(__thumb2__)
+            if (n >= 32u)
+            {
+                __asm__ volatile(
+                    "1:\n\t"
+                    "ldmia %1!, {r3, r4, r5, r6}\n\t"
+                    "stmia %0!, {r3, r4, r5, r6}\n\t"
+                    "ldmia %1!, {r3, r4, r5, r6}\n\t"
+                    "stmia %0!, {r3, r4, r5, r6}\n\t"
+                    "sub %2, %2, #32\n\t"
+                    "cmp %2, #32\n\t"
+                    "bhs 1b\n\t"
+                    : "+r"(d), "+r"(s), "+r"(n)
+                    :
+                    : "r3", "r4", "r5", "r6", "cc", "memory");
+            }
+#endif
+            while (n >= 16u)
+            {
+                uint32_t a = ((const mem_word_t *)s)[0];
+                uint32_t b = ((const mem_word_t *)s)[1];
+                uint32_t c = ((const mem_word_t *)s)[2];
+                uint32_t e = ((const mem_word_t *)s)[3];
+                ((mem_word_t *)d)[0] = a;
+                ((mem_word_t *)d)[1] = b;
+                ((mem_word_t *)d)[2] = c;
+                ((mem_word_t *)d)[3] = e;
+                d += 16;
+                s += 16;
+                n -= 16u;
+            }
+        }
+        while (n >= 4u)
+        {
+            *(mem_word_t *)d = *(const mem_uword_t *)s;
+            d += 4;
+            s += 4;
+            n -= 4u;
+        }
+    }
+    while (n--)
+        *d++ = *s++;
+}
+
+/* From the top down, for memmove with d above s: each word is read before
+ * the write that could overlap it. */
+MEM_NO_LIBCALL
+static inline void mem_copy_bwd(uint8_t *d, const uint8_t *s, size_t n)
+{
+    d += n;
+    s += n;
+    if (n >= 8u)
+    {
+        while ((uintptr_t)d & 3u)
+        {
+            *--d = *--s;
+            n--;
+        }
+        while (n >= 4u)
+        {
+            d -= 4;
+            s -= 4;
+            *(mem_word_t *)d = *(const mem_uword_t *)s;
+            n -= 4u;
+        }
+    }
+    while (n--)
+        *--d = *--s;
+}
+
+MEM_NO_LIBCALL
+static inline void mem_fill(uint8_t *d, uint8_t c, size_t n)
+{
+    if (n >= 8u)
+    {
+        while ((uintptr_t)d & 3u)
+        {
+            *d++ = c;
+            n--;
+        }
+        uint32_t w = (uint32_t)c * 0x01010101u;
+#if defined(__thumb2__)
+        if (n >= 32u)
+        {
+            __asm__ volatile(
+                "mov r3, %2\n\t"
+                "mov r4, %2\n\t"
+                "mov r5, %2\n\t"
+                "mov r6, %2\n\t"
+                "1:\n\t"
+                "stmia %0!, {r3, r4, r5, r6}\n\t"
+                "stmia %0!, {r3, r4, r5, r6}\n\t"
+                "sub %1, %1, #32\n\t"
+                "cmp %1, #32\n\t"
+                "bhs 1b\n\t"
+                : "+r"(d), "+r"(n)
+                : "r"(w)
+                : "r3", "r4", "r5", "r6", "cc", "memory");
+        }
+#endif
+        while (n >= 4u)
+        {
+            *(mem_word_t *)d = w;
+            d += 4;
+            n -= 4u;
+        }
+    }
+    while (n--)
+        *d++ = c;
+}
+
+#endif /* LIBC_MEM_WORDS_H */
@@ -2,8 +2,7 @@
  * @file string.h
  * @brief Minimal string.h for freestanding bare-metal builds
  *
- * Declares common memory/string functions that the compiler provides
- * as builtins when building with -ffreestanding.
+ * Declares the memory/string functions in libc_impl.c.
  */
 
 #ifndef _LIBC_STRING_H
@@ -11,7 +10,7 @@
 
 #include <stddef.h>
 
-/* Memory functions - compiler provides builtins */
+/* Memory functions (word/burst cores in mem_words.h) */
 void *memset(void *s, int c, size_t n);
 void *memcpy(void *dest, const void *src, size_t n);
 void *memmove(void *dest, const void *src, size_t n);
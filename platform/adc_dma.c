@@ -0,0 +1,175 @@
+#include "platform/adc_dma.h"
+
+#include "platform/dma.h"
+#include "platform/hw.h"
+#include "platform/mmio.h"
+
+#define DMA_CCR(ch) ((ch) + 0x00u)
+#define DMA_CNDTR(ch) ((ch) + 0x04u)
+#define DMA_CPAR(ch) ((ch) + 0x08u)
+#define DMA_CMAR(ch) ((ch) + 0x0Cu)
+
+#define DMA_CCR_EN (1u << 0)
+#define DMA_CCR_TCIE (1u << 1)
+#define DMA_CCR_HTIE (1u << 2)
+#define DMA_CCR_TEIE (1u << 3)
+#define DMA_CCR_CIRC (1u << 5)
+#define DMA_CCR_MINC (1u << 7)
+#define DMA_CCR_PSIZE_16 (1u << 8)
+#define DMA_CCR_MSIZE_16 (1u << 10)
+
+#define RCC_APB1ENR_TIM3 (1u << 1)
+
+#define ADC1_BASE 0x40012400u
+#define ADC_CR1   (ADC1_BASE + 0x04u)
+#define ADC_CR2   (ADC1_BASE + 0x08u)
+#define ADC_SMPR1 (ADC1_BASE + 0x0Cu)
+#define ADC_SQR1  (ADC1_BASE + 0x2Cu)
+#define ADC_SQR3  (ADC1_BASE + 0x34u)
+#define ADC_DR    (ADC1_BASE + 0x4Cu)
+
+#define ADC_CR1_SCAN (1u << 8)
+#define ADC_CR2_CONT (1u << 1)
+#define ADC_CR2_DMA (1u << 8)
+#define ADC_CR2_EXTSEL_MASK (7u << 17)
+#define ADC_CR2_EXTSEL_TIM3_TRGO (4u << 17)
+#define ADC_CR2_EXTSEL_SWSTART (7u << 17)
+#define ADC_CR2_EXTTRIG (1u << 20)
+#define ADC_CR2_SWSTART (1u << 22)
+#define ADC_CR2_TSVREFE (1u << 23)
+
+/* Channel 16 needs >= 17.1 us: 239.5 cycles at 12 MHz. */
+#define ADC_SMPR1_CH16_MASK (7u << 18)
+#define ADC_SMPR1_CH16_239 (7u << 18)
+#define ADC_CH_DIE_TEMP 16u
+
+#define TIM_CR2_MMS_UPDATE (2u << 4)
+
+/* TIM3 at 72 MHz: /72 -> 1 MHz, /500 -> 2 kHz scan rate. */
+#define ADC_DMA_TIM_PSC 71u
+#define ADC_DMA_TIM_ARR 499u
+
+/* 16 scans per half: 8 ms of samples per published mean. */
+#define ADC_DMA_SCANS_PER_HALF 16u
+#define ADC_DMA_SCANS_SHIFT 4u
+#define ADC_DMA_HALF_LEN (ADC_DMA_SCANS_PER_HALF * PLATFORM_ADC_IN_COUNT)
+#define ADC_DMA_BUF_LEN (2u * ADC_DMA_HALF_LEN)
+
+/* Typical AT32F403A sensor: 1.28 V at 25 C, -4.13 mV/C; VDDA 3.3 V. */
+#define DIE_TEMP_V25_100UV 12800
+#define DIE_TEMP_SLOPE_UV_PER_C 4130
+#define ADC_VREF_100UV 33000u
+
+static uint16_t g_adc_dma_buf[ADC_DMA_BUF_LEN];
+static volatile uint16_t g_adc_dma_mean[PLATFORM_ADC_IN_COUNT];
+static volatile uint8_t g_adc_dma_ready;
+static volatile uint8_t g_adc_dma_active;
+static platform_adc_dma_stats_t g_adc_dma_stats;
+
+#if !defined(HOST_TEST)
+/* Scans are stored input-interleaved in SQR order. */
+static void adc_dma_decimate(const uint16_t *half)
+{
+    uint32_t sum[PLATFORM_ADC_IN_COUNT] = {0};
+    for (uint32_t i = 0; i < ADC_DMA_HALF_LEN; i += PLATFORM_ADC_IN_COUNT)
+    {
+        for (uint32_t in = 0; in < PLATFORM_ADC_IN_COUNT; ++in)
+            sum[in] += half[i + in];
+    }
+    for (uint32_t in = 0; in < PLATFORM_ADC_IN_COUNT; ++in)
+    {
+        uint32_t round = 1u << (ADC_DMA_SCANS_SHIFT - 1u);
+        g_adc_dma_mean[in] = (uint16_t)(((sum[in] + round) >> ADC_DMA_SCANS_SHIFT) & 0x0FFFu);
+    }
+    g_adc_dma_ready = 1u;
+    g_adc_dma_stats.halves++;
+}
+
+static void adc_dma_irq(void *ctx, uint32_t flags)
+{
+    (void)ctx;
+    if (flags & PLATFORM_DMA_F_TE)
+    {
+        /* The channel is disabled; put the regular group back to one
+         * software-started conversion on PA0 for the readers' fallback. */
+        mmio_write32(TIM_CR1(TIM3_BASE), 0u);
+        mmio_write32(ADC_CR1, mmio_read32(ADC_CR1) & ~ADC_CR1_SCAN);
+        mmio_write32(ADC_SQR1, mmio_read32(ADC_SQR1) & 0xFF0FFFFFu);
+        uint32_t cr2 = mmio_read32(ADC_CR2) & ~(ADC_CR2_DMA | ADC_CR2_EXTSEL_MASK);
+        mmio_write32(ADC_CR2, cr2 | ADC_CR2_EXTSEL_SWSTART);
+        g_adc_dma_active = 0u;
+        g_adc_dma_ready = 0u;
+        g_adc_dma_stats.errors++;
+        return;
+    }
+    if (flags & PLATFORM_DMA_F_HT)
+        adc_dma_decimate(&g_adc_dma_buf[0]);
+    if (flags & PLATFORM_DMA_F_TC)
+        adc_dma_decimate(&g_adc_dma_buf[ADC_DMA_HALF_LEN]);
+}
+#endif
+
+void platform_adc_dma_init(void)
+{
+    if (g_adc_dma_active)
+        return;
+    g_adc_dma_ready = 0u;
+#if !defined(HOST_TEST)
+    platform_dma_attach(PLATFORM_DMA_ADC, adc_dma_irq, 0);
+    uint32_t ch = platform_dma_ch(PLATFORM_DMA_ADC);
+    mmio_write32(DMA_CPAR(ch), ADC_DR);
+    mmio_write32(DMA_CMAR(ch), (uint32_t)g_adc_dma_buf);
+    mmio_write32(DMA_CNDTR(ch), ADC_DMA_BUF_LEN);
+    /* Peripheral -> memory, 16-bit both sides, circular. */
+    mmio_write32(DMA_CCR(ch),
+                 platform_dma_pl(PLATFORM_DMA_ADC) | DMA_CCR_MSIZE_16 | DMA_CCR_PSIZE_16 | DMA_CCR_MINC |
+                 DMA_CCR_CIRC | DMA_CCR_TEIE | DMA_CCR_HTIE | DMA_CCR_TCIE | DMA_CCR_EN);
+
+    /* Regular group: PA0 then the temperature sensor, one scan per trigger. */
+    mmio_write32(ADC_CR1, mmio_read32(ADC_CR1) | ADC_CR1_SCAN);
+    mmio_write32(ADC_SMPR1, (mmio_read32(ADC_SMPR1) & ~ADC_SMPR1_CH16_MASK) | ADC_SMPR1_CH16_239);
+    mmio_write32(ADC_SQR1, (mmio_read32(ADC_SQR1) & 0xFF0FFFFFu) |
+                               ((PLATFORM_ADC_IN_COUNT - 1u) << 20));
+    mmio_write32(ADC_SQR3, (mmio_read32(ADC_SQR3) & ~0x3FFu) | (ADC_CH_DIE_TEMP << 5));
+    /* ADON stays set and other bits change, so this write starts nothing. */
+    uint32_t cr2 = mmio_read32(ADC_CR2) & ~(ADC_CR2_CONT | ADC_CR2_EXTSEL_MASK | ADC_CR2_SWSTART);
+    mmio_write32(ADC_CR2, cr2 | ADC_CR2_DMA | ADC_CR2_EXTSEL_TIM3_TRGO | ADC_CR2_EXTTRIG |
+                              ADC_CR2_TSVREFE);
+
+    mmio_write32(RCC_APB1ENR, mmio_read32(RCC_APB1ENR) | RCC_APB1ENR_TIM3);
+    mmio_write32(TIM_CR1(TIM3_BASE), 0u);
+    mmio_write32(TIM_PSC(TIM3_BASE), ADC_DMA_TIM_PSC);
+    mmio_write32(TIM_ARR(TIM3_BASE), ADC_DMA_TIM_ARR);
+    mmio_write32(TIM_CR2(TIM3_BASE), TIM_CR2_MMS_UPDATE);
+    mmio_write32(TIM_EGR(TIM3_BASE), 1u); /* UG: load PSC */
+    mmio_write32(TIM_SR(TIM3_BASE), 0u);
+    g_adc_dma_active = 1u;
+    mmio_write32(TIM_CR1(TIM3_BASE), 1u); /* CEN */
+#endif
+}
+
+uint8_t platform_adc_dma_active(void)
+{
+    return g_adc_dma_active;
+}
+
+uint8_t platform_adc_dma_read(uint8_t input, uint16_t *out)
+{
+    if (!g_adc_dma_active || !g_adc_dma_ready || input >= PLATFORM_ADC_IN_COUNT || !out)
+        return 0u;
+    *out = g_adc_dma_mean[input];
+    return 1u;
+}
+
+int16_t platform_adc_die_temp_dC(uint16_t raw)
+{
+    int32_t v_100uv = (int32_t)(((uint32_t)raw * ADC_VREF_100UV) >> 12);
+    /* 0.1 C per 413 uV, i.e. per 4.13 steps of 100 uV. */
+    return (int16_t)(250 + ((DIE_TEMP_V25_100UV - v_100uv) * 1000) / DIE_TEMP_SLOPE_UV_PER_C);
+}
+
+void platform_adc_dma_stats(platform_adc_dma_stats_t *out)
+{
+    if (out)
+        *out = g_adc_dma_stats;
+}
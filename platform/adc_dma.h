@@ -0,0 +1,41 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_ADC_DMA_H
+#define OPEN_FIRMWARE_PLATFORM_ADC_DMA_H
+
+#include <stdint.h>
+
+/*
+ * Background ADC1 scan: TIM3 TRGO starts a regular-group scan at 2 kHz and
+ * DMA1 CH1 copies each conversion into a circular buffer. The half- and
+ * full-transfer IRQs average the half that just filled (16 scans, 8 ms) per
+ * input and publish the means, so readers never start or wait on a
+ * conversion.
+ *
+ * Inputs are the ones the BC280 board wires to ADC1: the battery divider on
+ * PA0 and the MCU's internal temperature sensor. Throttle and controller
+ * temperature come over the motor UART on this display.
+ */
+#define PLATFORM_ADC_IN_BATTERY 0u   /* PA0, channel 0 */
+#define PLATFORM_ADC_IN_DIE_TEMP 1u  /* internal sensor, channel 16 */
+#define PLATFORM_ADC_IN_COUNT 2u
+
+/* Called once ADC1 is powered and calibrated. */
+void platform_adc_dma_init(void);
+uint8_t platform_adc_dma_active(void);
+
+/*
+ * Latest 12-bit mean for input (rounded); 0 if the scan is not running or
+ * has not completed a half yet.
+ */
+uint8_t platform_adc_dma_read(uint8_t input, uint16_t *out);
+
+/* Die temperature in 0.1 C from the latest mean (datasheet typicals, +-5 C). */
+int16_t platform_adc_die_temp_dC(uint16_t raw);
+
+typedef struct {
+    uint32_t halves;     /* decimated buffer halves */
+    uint32_t errors;     /* DMA transfer errors (scan stopped) */
+} platform_adc_dma_stats_t;
+
+void platform_adc_dma_stats(platform_adc_dma_stats_t *out);
+
+#endif
@@ -1,9 +1,12 @@
 #include "platform/board_init.h"
 
 #include "drivers/st7789_8080.h"
+#include "platform/adc_dma.h"
 #include "platform/early_init.h"
 #include "platform/hw.h"
+#include "platform/lcd_dma.h"
 #include "platform/mmio.h"
+#include "platform/nvic.h"
 #include "platform/time.h"
 #include "storage/boot_stage.h"
 #include "boot_log.h"
@@ -26,6 +29,20 @@
 
 #define RCC_AHBENR_FSMC    (1u << 8)
 
+#define AFIO_BASE    0x40010000u
+#define AFIO_EXTICR1 (AFIO_BASE + 0x08u)
+#define AFIO_EXTICR2 (AFIO_BASE + 0x0Cu)
+
+#define EXTI_BASE 0x40010400u
+#define EXTI_IMR  (EXTI_BASE + 0x00u)
+#define EXTI_RTSR (EXTI_BASE + 0x08u)
+#define EXTI_FTSR (EXTI_BASE + 0x0Cu)
+#define EXTI_PR   (EXTI_BASE + 0x14u)
+
+/* PC0-4 buttons on EXTI lines 0-4 (IRQ 6-10), below the UARTs. */
+#define BUTTON_EXTI_LINES    0x001Fu
+#define BUTTON_EXTI_IRQ0     6u
+
 #define ADC1_BASE 0x40012400u
 #define ADC_CR1   (ADC1_BASE + 0x04u)
 #define ADC_CR2   (ADC1_BASE + 0x08u)
@@ -39,11 +56,26 @@ static inline void board_stage_mark(uint32_t value)
     boot_log_stage(value);
 }
 
+static int (*g_board_wait_hook)(void);
+
+void platform_board_set_wait_hook(int (*fn)(void))
+{
+    g_board_wait_hook = fn;
+}
+
+/*
+ * Waits are timed on the cycle counter: g_ms only moves when TIM2 is polled,
+ * and the wait hook can hold the loop past several ticks. The hook's work
+ * counts against the wait; a step longer than what is left only stretches it.
+ */
 static void platform_delay_ms(uint32_t ms)
 {
-    uint32_t start = g_ms;
-    while ((uint32_t)(g_ms - start) < ms)
+    uint32_t start = platform_cycles_now();
+    uint32_t us = ms * 1000u;
+    while (platform_cycles_to_us(platform_cycles_now() - start) < us)
     {
+        if (g_board_wait_hook)
+            (void)g_board_wait_hook();
         platform_time_poll_1ms();
         /* Keep IWDG alive if bootloader left it running. */
         mmio_write32(IWDG_KR, IWDG_KR_FEED);
@@ -110,27 +142,15 @@ void platform_key_output_set(uint8_t on)
 
 void platform_nvic_init(void)
 {
-    mmio_write32(SCB_AIRCR, SCB_AIRCR_VECTKEY | 0x500u);
-}
-
-static void nvic_set_priority(uint8_t irq, uint8_t priority)
-{
-    uint32_t addr = NVIC_IPR_BASE + irq;
-    uint32_t word = addr & ~0x3u;
-    uint32_t shift = (addr & 0x3u) * 8u;
-    uint32_t v = mmio_read32(word);
-    v = (v & ~(0xFFu << shift)) | ((uint32_t)priority << shift);
-    mmio_write32(word, v);
+    mmio_write32(SCB_AIRCR, SCB_AIRCR_VECTKEY | (PLATFORM_NVIC_PRIGROUP << 8));
 }
 
 void platform_uart_irq_init(void)
 {
 #if !defined(HOST_TEST)
-    /* Match OEM USART1/2 priority (grouping from AIRCR=0x500 -> priority=0x90). */
-    const uint8_t prio = 0x90u;
-    nvic_set_priority(37u, prio);
-    nvic_set_priority(38u, prio);
-    mmio_write32(NVIC_ISER1, (1u << (37u - 32u)) | (1u << (38u - 32u)));
+    /* The OEM gave both 0x90; the motor link now outranks BLE (platform/nvic.h). */
+    platform_nvic_enable(37u, PLATFORM_PRIO_USART1);
+    platform_nvic_enable(38u, PLATFORM_PRIO_USART2);
 #endif
 }
 
@@ -233,6 +253,61 @@ void platform_buttons_init(void)
     gpio_configure_mask(GPIOC_BASE, 0x001Fu, 0x48u, 0x00u);
 }
 
+static volatile uint8_t g_button_activity;
+static volatile uint32_t g_button_edge_cycles;
+
+void platform_buttons_exti_init(void)
+{
+    mmio_write32(RCC_APB2ENR, mmio_read32(RCC_APB2ENR) | RCC_APB2ENR_AFIO);
+    /* Lines 0-3 in EXTICR1, line 4 in EXTICR2; port C = 2. */
+    mmio_write32(AFIO_EXTICR1, 0x2222u);
+    mmio_write32(AFIO_EXTICR2, (mmio_read32(AFIO_EXTICR2) & ~0xFu) | 0x2u);
+    mmio_write32(EXTI_RTSR, mmio_read32(EXTI_RTSR) | BUTTON_EXTI_LINES);
+    mmio_write32(EXTI_FTSR, mmio_read32(EXTI_FTSR) | BUTTON_EXTI_LINES);
+    mmio_write32(EXTI_PR, BUTTON_EXTI_LINES);
+    mmio_write32(EXTI_IMR, mmio_read32(EXTI_IMR) | BUTTON_EXTI_LINES);
+    /* A button held through boot has no edge to report; sample once. */
+    g_button_edge_cycles = platform_cycles_now();
+    g_button_activity = 1u;
+#if !defined(HOST_TEST)
+    for (uint8_t i = 0; i < 5u; ++i)
+        platform_nvic_enable((uint8_t)(BUTTON_EXTI_IRQ0 + i), PLATFORM_PRIO_BUTTONS);
+#endif
+}
+
+uint8_t platform_buttons_activity_pending(void)
+{
+    return g_button_activity;
+}
+
+uint8_t platform_buttons_activity_take(uint32_t *edge_cycles)
+{
+    if (!g_button_activity)
+        return 0u;
+    if (edge_cycles)
+        *edge_cycles = g_button_edge_cycles;
+    g_button_activity = 0u;
+    return 1u;
+}
+
+#if !defined(HOST_TEST)
+/* Bounce re-pends the line a few times per press; each pass just notes it.
+ * Only the first edge of a burst is stamped: that is when the rider acted. */
+static void button_exti_irq(void)
+{
+    mmio_write32(EXTI_PR, mmio_read32(EXTI_PR) & BUTTON_EXTI_LINES);
+    if (!g_button_activity)
+        g_button_edge_cycles = platform_cycles_now();
+    g_button_activity = 1u;
+}
+
+void EXINT0_IRQHandler(void) { button_exti_irq(); }
+void EXINT1_IRQHandler(void) { button_exti_irq(); }
+void EXINT2_IRQHandler(void) { button_exti_irq(); }
+void EXINT3_IRQHandler(void) { button_exti_irq(); }
+void EXINT4_IRQHandler(void) { button_exti_irq(); }
+#endif
+
 void platform_gpioc_aux_init(void)
 {
     board_stage_mark(0xB135);
@@ -433,6 +508,9 @@ static void platform_adc_init(void)
 
     /* OEM enables bits 0x500000 after calibration. */
     mmio_write32(ADC_CR2, mmio_read32(ADC_CR2) | 0x500000u);
+
+    /* Then hand the regular group to the TIM3-triggered DMA scan. */
+    platform_adc_dma_init();
 }
 
 void platform_board_init(void)
@@ -440,14 +518,17 @@ void platform_board_init(void)
     board_stage_mark(0xB100);
     platform_power_hold_pin_init();
 
+    /* ADC first: battery monitor priming can then run in the LCD waits. */
+    platform_adc_init();
+
     platform_lcd_bus_pins_init();
     platform_fsmc_init();
+    platform_lcd_dma_init();
     platform_lcd_init_oem_8080();
     ui_lcd_fill_rect(0u, 0u, DISP_W, DISP_H, 0u);
 
     /* Turn backlight on immediately so any crash after this point is visible. */
     platform_backlight_init(5u);
-    platform_adc_init();
 
     /* OEM v2.5.1 brings up BLE module control pins + UART1 after LCD/backlight init. */
     platform_ble_control_pins_init();
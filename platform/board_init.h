@@ -5,11 +5,22 @@
 
 void platform_nvic_init(void);
 void platform_board_init(void);
+/* Called from the loop of every board init wait (LCD reset, sleep-out, DISPON,
+ * backlight) until cleared; see src/boot_steps.h. */
+void platform_board_set_wait_hook(int (*fn)(void));
 void platform_uart_irq_init(void);
 void platform_ble_uart_pins_init(void);
 void platform_motor_uart_pins_init(void);
 void platform_uart_pins_init(void);
 void platform_buttons_init(void);
+/* Edge interrupts on the button lines. Any press or release (bounce
+ * included) raises the activity flag, which also ends WFI; the main loop
+ * samples only while it is set or a press is in progress. */
+void platform_buttons_exti_init(void);
+uint8_t platform_buttons_activity_pending(void);
+/* Returns and clears the activity flag; *edge_cycles (optional) gets the
+ * DWT stamp of the first edge since the last take. */
+uint8_t platform_buttons_activity_take(uint32_t *edge_cycles);
 void platform_gpioc_aux_init(void);
 void platform_ble_control_pins_init(void);
 
@@ -2,6 +2,27 @@
 
 #include "platform/hw.h"
 #include "platform/mmio.h"
+#include "platform/time.h"
+
+#define RCC_CR_PLLON     (1u << 24)
+#define RCC_CR_PLLRDY    (1u << 25)
+#define RCC_CFGR_SW_MASK 0x3u
+#define RCC_CFGR_SW_HSE  0x1u
+#define RCC_CFGR_SW_PLL  0x2u
+#define RCC_CFGR_SWS_MASK 0xCu
+#define RCC_CFGR_SWS_HSE 0x4u
+#define RCC_CFGR_SWS_PLL 0x8u
+#define RCC_CFGR_PLLSRC_HSE 0x00010000u
+#define RCC_CFGR_PLLMUL_MASK 0x083C0000u
+#define RCC_CFGR_PLLMUL(n) ((uint32_t)((n) - 2u) << 18)
+#define RCC_PLL_LOCK_POLLS 1000000u
+
+#define CLOCK_FULL_MUL 9u
+#define CLOCK_LOW_MUL  3u
+
+static uint8_t g_clock_profile = PLATFORM_CLOCK_FULL;
+/* HSE multiplier SYSCLK currently runs at (1: HSE-direct). */
+static uint32_t g_clock_mul = CLOCK_FULL_MUL;
 
 static void clock_delay_cycles(volatile uint32_t cycles)
 {
@@ -85,6 +106,69 @@ void platform_clock_init(void)
     mmio_write32(RCC_MISC, mmio_read32(RCC_MISC) & ~0x30u);
 }
 
+static void run_from(uint32_t sw, uint32_t sws)
+{
+    mmio_write32(RCC_CFGR, (mmio_read32(RCC_CFGR) & ~RCC_CFGR_SW_MASK) | sw);
+    while ((mmio_read32(RCC_CFGR) & RCC_CFGR_SWS_MASK) != sws)
+        ;
+}
+
+/* Keep each timer's tick length across a switch. The new PSC loads at the
+ * next update, so only the period in flight runs at the wrong scale: g_ms
+ * slips by under one 5 ms tick per switch. */
+static void timer_rescale(uint32_t base, uint32_t from_mul, uint32_t to_mul)
+{
+    uint32_t psc = mmio_read32(TIM_PSC(base)) & 0xFFFFu;
+    uint32_t ticks = ((psc + 1u) * to_mul) / from_mul;
+    mmio_write32(TIM_PSC(base), ticks ? ticks - 1u : 0u);
+}
+
+uint8_t platform_clock_set_profile(uint8_t profile)
+{
+    if (profile == g_clock_profile)
+        return 0u;
+    uint32_t cfgr = mmio_read32(RCC_CFGR);
+    uint32_t sws = cfgr & RCC_CFGR_SWS_MASK;
+    /* HSE-direct only after a failed re-lock below. */
+    if (!(cfgr & RCC_CFGR_PLLSRC_HSE) ||
+        !(sws == RCC_CFGR_SWS_PLL || (sws == RCC_CFGR_SWS_HSE && g_clock_mul == 1u)))
+        return 0u;
+
+    uint32_t from_mul = g_clock_mul;
+    uint32_t to_mul = (profile == PLATFORM_CLOCK_LOW) ? CLOCK_LOW_MUL : CLOCK_FULL_MUL;
+
+    /* Park on HSE while the PLL re-locks at the new multiplier. Flash keeps
+     * its 72 MHz wait states either way. */
+    mmio_write32(RCC_MISC, mmio_read32(RCC_MISC) | 0x30u);
+    run_from(RCC_CFGR_SW_HSE, RCC_CFGR_SWS_HSE);
+    mmio_write32(RCC_CR, mmio_read32(RCC_CR) & ~RCC_CR_PLLON);
+    uint32_t polls = RCC_PLL_LOCK_POLLS;
+    while ((mmio_read32(RCC_CR) & RCC_CR_PLLRDY) && polls--)
+        ;
+    cfgr = mmio_read32(RCC_CFGR) & ~RCC_CFGR_PLLMUL_MASK;
+    mmio_write32(RCC_CFGR, cfgr | RCC_CFGR_PLLMUL(to_mul));
+    mmio_write32(RCC_CR, mmio_read32(RCC_CR) | RCC_CR_PLLON);
+    if (rcc_wait_flag(RCC_CR_PLLRDY, RCC_PLL_LOCK_POLLS))
+        run_from(RCC_CFGR_SW_PLL, RCC_CFGR_SWS_PLL);
+    else
+        to_mul = 1u; /* no lock: stay on HSE-direct rather than hang */
+    mmio_write32(RCC_MISC, mmio_read32(RCC_MISC) & ~0x30u);
+
+    timer_rescale(TIM1_BASE, from_mul, to_mul);
+    timer_rescale(TIM2_BASE, from_mul, to_mul);
+    timer_rescale(TIM3_BASE, from_mul, to_mul);
+    timer_rescale(TIM4_BASE, from_mul, to_mul);
+    platform_cycle_counter_init();
+    g_clock_mul = to_mul;
+    g_clock_profile = profile;
+    return 1u;
+}
+
+uint8_t platform_clock_profile(void)
+{
+    return g_clock_profile;
+}
+
 uint32_t rcc_get_hclk_hz_fallback(void)
 {
     /*
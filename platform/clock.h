@@ -7,4 +7,18 @@ uint32_t rcc_get_hclk_hz_fallback(void);
 uint32_t rcc_get_pclk_hz_fallback(uint8_t apb2);
 void platform_clock_init(void);
 
+/*
+ * Runtime SYSCLK profiles on the HSE PLL: FULL is the OEM HSE x9 (72 MHz),
+ * LOW re-locks the PLL at HSE x3 (24 MHz) with the same bus prescalers.
+ * A switch re-times the TIM1..TIM4 prescalers (backlight PWM, 5 ms tick,
+ * ADC scan trigger, PC sampler) and the DWT cycle scale; the caller owns UART BRR and
+ * SPI prescalers and must run it with interrupts masked. Returns 0 when the
+ * profile is already active or SYSCLK is not on the HSE PLL (HSI fallback).
+ */
+#define PLATFORM_CLOCK_FULL 0u
+#define PLATFORM_CLOCK_LOW  1u
+
+uint8_t platform_clock_set_profile(uint8_t profile);
+uint8_t platform_clock_profile(void);
+
 #endif
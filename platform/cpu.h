@@ -18,6 +18,30 @@ static inline void wfi(void)
     __asm__ volatile("wfi" ::: "memory");
 }
 
+/* Masks IRQs and returns the previous PRIMASK for irq_restore(). */
+static inline uint32_t irq_save(void)
+{
+    uint32_t primask;
+    __asm__ volatile("mrs %0, primask\n"
+                     "cpsid i" : "=r"(primask) :: "memory");
+    return primask;
+}
+
+static inline void irq_restore(uint32_t primask)
+{
+    __asm__ volatile("msr primask, %0" : : "r"(primask) : "memory");
+}
+
+/* Non-zero when running in thread mode with interrupts enabled. */
+static inline uint32_t cpu_irqs_available(void)
+{
+    uint32_t primask;
+    uint32_t ipsr;
+    __asm__ volatile("mrs %0, primask" : "=r"(primask));
+    __asm__ volatile("mrs %0, ipsr" : "=r"(ipsr));
+    return ((primask & 1u) == 0u && (ipsr & 0x1FFu) == 0u) ? 1u : 0u;
+}
+
 __attribute__((unused)) static inline void set_msp(uint32_t sp)
 {
     __asm__ volatile("msr msp, %0" : : "r"(sp) : "memory");
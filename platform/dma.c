@@ -0,0 +1,192 @@
+#include "platform/dma.h"
+
+#include "platform/hw.h"
+#include "platform/irq_load.h"
+#include "platform/mmio.h"
+#include "platform/nvic.h"
+#include "platform/time.h"
+
+#define DMA1_BASE 0x40020000u
+#define DMA2_BASE 0x40020400u
+#define DMA_ISR(dma) ((dma) + 0x00u)
+#define DMA_IFCR(dma) ((dma) + 0x04u)
+/* Channel n (1-based) register block. */
+#define DMA_CH(dma, n) ((dma) + 0x08u + 0x14u * ((n) - 1u))
+#define DMA_CCR(ch) ((ch) + 0x00u)
+
+#define DMA_CCR_EN (1u << 0)
+#define DMA_CCR_PL_LOW (0u << 12)
+#define DMA_CCR_PL_MEDIUM (1u << 12)
+#define DMA_CCR_PL_HIGH (2u << 12)
+#define DMA_CCR_PL_VERY_HIGH (3u << 12)
+
+#define RCC_AHBENR_DMA1 (1u << 0)
+#define RCC_AHBENR_DMA2 (1u << 1)
+
+typedef struct {
+    uint32_t dma;
+    uint8_t ch;        /* 1-based */
+    uint8_t irq;
+    uint8_t priority;  /* NVIC */
+    uint32_t pl;
+} dma_slot_t;
+
+static const dma_slot_t k_dma_slots[PLATFORM_DMA_COUNT] = {
+    /* Decimation can wait a few hundred us. */
+    [PLATFORM_DMA_ADC] = { DMA1_BASE, 1u, 11u, PLATFORM_PRIO_ADC_DMA, DMA_CCR_PL_LOW },
+    /* OEM app 2.2.5 had CH3 at 0x40, above the motor link; see platform/nvic.h. */
+    [PLATFORM_DMA_FLASH_RX] = { DMA1_BASE, 2u, 12u, PLATFORM_PRIO_FLASH_RX, DMA_CCR_PL_HIGH },
+    [PLATFORM_DMA_FLASH_TX] = { DMA1_BASE, 3u, 13u, PLATFORM_PRIO_FLASH_TX, DMA_CCR_PL_MEDIUM },
+    /* TIM2's group: the parsers never preempt motor_isr_tick. */
+    [PLATFORM_DMA_MOTOR_RX] = { DMA1_BASE, 6u, 16u, PLATFORM_PRIO_MOTOR_DMA, DMA_CCR_PL_VERY_HIGH },
+    [PLATFORM_DMA_MOTOR_TX] = { DMA1_BASE, 7u, 17u, PLATFORM_PRIO_MOTOR_DMA, DMA_CCR_PL_VERY_HIGH },
+    /* Below SPI flash so flash completions are never delayed. */
+    [PLATFORM_DMA_LCD] = { DMA2_BASE, 1u, 56u, PLATFORM_PRIO_LCD_DMA, DMA_CCR_PL_HIGH },
+};
+
+static struct {
+    platform_dma_done_fn done;
+    void *ctx;
+    volatile uint8_t busy;
+    volatile uint8_t pended;
+    uint32_t busy_start;
+    uint32_t pend_cycles;
+    platform_dma_stats_t st;
+} g_dma[PLATFORM_DMA_COUNT];
+
+static uint32_t dma_shift(const dma_slot_t *s)
+{
+    return 4u * ((uint32_t)s->ch - 1u);
+}
+
+uint32_t platform_dma_ch(uint8_t user)
+{
+    const dma_slot_t *s = &k_dma_slots[user];
+    return DMA_CH(s->dma, s->ch);
+}
+
+uint32_t platform_dma_pl(uint8_t user)
+{
+    return k_dma_slots[user].pl;
+}
+
+uint32_t platform_dma_flags(uint8_t user)
+{
+    const dma_slot_t *s = &k_dma_slots[user];
+    return (mmio_read32(DMA_ISR(s->dma)) >> dma_shift(s)) & 0x0Fu;
+}
+
+void platform_dma_clear(uint8_t user)
+{
+    const dma_slot_t *s = &k_dma_slots[user];
+    mmio_write32(DMA_IFCR(s->dma), 0x0Fu << dma_shift(s));
+}
+
+void platform_dma_attach(uint8_t user, platform_dma_done_fn done, void *ctx)
+{
+    const dma_slot_t *s = &k_dma_slots[user];
+    g_dma[user].done = done;
+    g_dma[user].ctx = ctx;
+    g_dma[user].busy = 0u;
+#if !defined(HOST_TEST)
+    uint32_t en = (s->dma == DMA1_BASE) ? RCC_AHBENR_DMA1 : RCC_AHBENR_DMA2;
+    mmio_write32(RCC_AHBENR, mmio_read32(RCC_AHBENR) | en);
+    uint32_t ch = DMA_CH(s->dma, s->ch);
+    mmio_write32(DMA_CCR(ch), mmio_read32(DMA_CCR(ch)) & ~DMA_CCR_EN);
+    platform_dma_clear(user);
+    if (!done)
+        return;
+    platform_nvic_enable(s->irq, s->priority);
+#else
+    (void)s;
+#endif
+}
+
+void platform_dma_pend(uint8_t user)
+{
+    uint8_t irq = k_dma_slots[user].irq;
+    g_dma[user].pend_cycles = platform_cycles_now();
+    g_dma[user].pended = 1u;
+    mmio_write32(NVIC_ISPR0 + 4u * (irq / 32u), 1u << (irq % 32u));
+}
+
+void platform_dma_busy_begin(uint8_t user)
+{
+    g_dma[user].busy_start = platform_cycles_now();
+    g_dma[user].busy = 1u;
+}
+
+void platform_dma_busy_end(uint8_t user)
+{
+    if (!g_dma[user].busy)
+        return;
+    g_dma[user].busy = 0u;
+    uint32_t us = platform_cycles_to_us(platform_cycles_now() - g_dma[user].busy_start);
+    platform_dma_stats_t *st = &g_dma[user].st;
+    st->transfers++;
+    st->busy_us += us;
+    if (us > st->max_us)
+        st->max_us = us;
+}
+
+void platform_dma_stats(uint8_t user, platform_dma_stats_t *out)
+{
+    if (out && user < PLATFORM_DMA_COUNT)
+        *out = g_dma[user].st;
+}
+
+#if !defined(HOST_TEST)
+static void dma_dispatch(uint8_t user)
+{
+    platform_irq_span_t span;
+    if (g_dma[user].pended)
+    {
+        g_dma[user].pended = 0u;
+        platform_irq_load_enter_late(&span, platform_cycles_now() - g_dma[user].pend_cycles);
+    }
+    else
+    {
+        platform_irq_load_enter(&span);
+    }
+    const dma_slot_t *s = &k_dma_slots[user];
+    uint32_t flags = (mmio_read32(DMA_ISR(s->dma)) >> dma_shift(s)) & 0x0Fu;
+    if (flags)
+        mmio_write32(DMA_IFCR(s->dma), flags << dma_shift(s));
+    g_dma[user].st.irqs++;
+    if (flags & PLATFORM_DMA_F_TE)
+        g_dma[user].st.errors++;
+    if (g_dma[user].done)
+        g_dma[user].done(g_dma[user].ctx, flags);
+    platform_irq_load_exit(PLATFORM_IRQ_SRC_DMA(user), &span);
+}
+
+void DMA1_Channel1_IRQHandler(void)
+{
+    dma_dispatch(PLATFORM_DMA_ADC);
+}
+
+void DMA1_Channel2_IRQHandler(void)
+{
+    dma_dispatch(PLATFORM_DMA_FLASH_RX);
+}
+
+void DMA1_Channel3_IRQHandler(void)
+{
+    dma_dispatch(PLATFORM_DMA_FLASH_TX);
+}
+
+void DMA1_Channel6_IRQHandler(void)
+{
+    dma_dispatch(PLATFORM_DMA_MOTOR_RX);
+}
+
+void DMA1_Channel7_IRQHandler(void)
+{
+    dma_dispatch(PLATFORM_DMA_MOTOR_TX);
+}
+
+void DMA2_Channel1_IRQHandler(void)
+{
+    dma_dispatch(PLATFORM_DMA_LCD);
+}
+#endif
@@ -0,0 +1,72 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_DMA_H
+#define OPEN_FIRMWARE_PLATFORM_DMA_H
+
+#include <stdint.h>
+
+/*
+ * DMA channel table. Every DMA consumer gets its channel, arbitration level
+ * and completion IRQ priority from here; the channel IRQ handlers live in
+ * dma.c and hand each consumer its channel's flags.
+ *
+ *   consumer   channel   CCR PL     IRQ priority (platform/nvic.h)
+ *   MOTOR_RX   DMA1 CH6  very high  0x50 (TIM2's, serialised with motor_isr_tick)
+ *   MOTOR_TX   DMA1 CH7  very high  0x50
+ *   LCD        DMA2 CH1  high       0xC0
+ *   FLASH_RX   DMA1 CH2  high       0x80 (stops the RXONLY clock)
+ *   FLASH_TX   DMA1 CH3  medium     0xA0
+ *   ADC        DMA1 CH1  low        0xC0
+ *
+ * Channels follow the fixed request wiring (ADC1 on CH1, SPI1 on CH2/3,
+ * USART2 on CH6/7); the AT32 flexible request mapping stays off. Arbitration
+ * runs motor UART > LCD > flash > ADC: a motor byte is never held behind a
+ * flash burst, and within flash the RX channel outranks TX so a full-duplex
+ * transfer cannot overrun. LCD is alone on DMA2, which the bus matrix
+ * round-robins with DMA1.
+ */
+#define PLATFORM_DMA_ADC       0u
+#define PLATFORM_DMA_FLASH_RX  1u
+#define PLATFORM_DMA_FLASH_TX  2u
+#define PLATFORM_DMA_MOTOR_RX  3u
+#define PLATFORM_DMA_MOTOR_TX  4u
+#define PLATFORM_DMA_LCD       5u
+#define PLATFORM_DMA_COUNT     6u
+
+/* Channel flags as passed to callbacks and returned by platform_dma_flags. */
+#define PLATFORM_DMA_F_GIF (1u << 0)
+#define PLATFORM_DMA_F_TC  (1u << 1)
+#define PLATFORM_DMA_F_HT  (1u << 2)
+#define PLATFORM_DMA_F_TE  (1u << 3)
+
+/* Runs from the channel IRQ with the flags it cleared (0 for a pend). */
+typedef void (*platform_dma_done_fn)(void *ctx, uint32_t flags);
+
+/* Channel register block (CCR at +0x00, CNDTR +0x04, CPAR +0x08, CMAR +0x0C). */
+uint32_t platform_dma_ch(uint8_t user);
+/* CCR PL bits for the consumer; OR them into every CCR write. */
+uint32_t platform_dma_pl(uint8_t user);
+
+/* Enables the controller clock, stops the channel and clears its flags;
+ * with a callback, also sets the IRQ priority and enables the IRQ. */
+void platform_dma_attach(uint8_t user, platform_dma_done_fn done, void *ctx);
+/* For polled transfers, which run with the channel IRQ masked (TCIE off). */
+uint32_t platform_dma_flags(uint8_t user);
+void platform_dma_clear(uint8_t user);
+/* Runs the callback at the channel IRQ's priority, flags 0. */
+void platform_dma_pend(uint8_t user);
+
+/* Busy-time accounting for one-shot transfers: begin when the channel is
+ * enabled, end when it completes (no-op when nothing was begun). */
+void platform_dma_busy_begin(uint8_t user);
+void platform_dma_busy_end(uint8_t user);
+
+typedef struct {
+    uint32_t irqs;
+    uint32_t errors;      /* TE flags seen */
+    uint32_t transfers;   /* busy_begin .. busy_end spans */
+    uint32_t busy_us;     /* summed over those spans */
+    uint32_t max_us;
+} platform_dma_stats_t;
+
+void platform_dma_stats(uint8_t user, platform_dma_stats_t *out);
+
+#endif
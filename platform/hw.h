@@ -4,6 +4,7 @@
 #include <stdint.h>
 
 /* Cortex-M system control block */
+#define SCB_ICSR 0xE000ED04u
 #define SCB_VTOR 0xE000ED08u
 #define SCB_AIRCR 0xE000ED0Cu
 #define SCB_CFSR 0xE000ED28u
@@ -12,9 +13,23 @@
 #define SCB_MMFAR 0xE000ED34u
 #define SCB_BFAR 0xE000ED38u
 #define SCB_AFSR 0xE000ED3Cu
+#define SCB_SHPR3 0xE000ED20u
+#define SCB_CCR 0xE000ED14u
+#define SCB_ACTLR 0xE000E008u
 
 #define SCB_AIRCR_VECTKEY (0x5FAu << 16)
 #define SCB_AIRCR_SYSRESETREQ (1u << 2)
+#define SCB_ICSR_PENDSVSET (1u << 28)
+#define SCB_CCR_BFHFNMIGN (1u << 8)
+#define SCB_ACTLR_DISDEFWBUF (1u << 1)
+#define SCB_CFSR_BFSR_MASK 0x0000FF00u
+
+/* Debug exception/monitor control and DWT cycle counter */
+#define DEMCR 0xE000EDFCu
+#define DEMCR_TRCENA (1u << 24)
+#define DWT_CTRL 0xE0001000u
+#define DWT_CYCCNT 0xE0001004u
+#define DWT_CTRL_CYCCNTENA (1u << 0)
 
 /* SysTick */
 #define SYST_CSR 0xE000E010u
@@ -78,6 +93,8 @@
 
 #define TIM1_BASE  0x40012C00u
 #define TIM2_BASE  0x40000000u
+#define TIM3_BASE  0x40000400u
+#define TIM4_BASE  0x40000800u
 
 #define GPIO_IDR(base) ((base) + 0x08u)
 #define GPIO_CRL(base) ((base) + 0x00u)
@@ -94,6 +111,7 @@
 #define UART_CR3(o) ((o) + 0x14u)
 
 #define TIM_CR1(base) ((base) + 0x00u)
+#define TIM_CR2(base) ((base) + 0x04u)
 #define TIM_DIER(base) ((base) + 0x0Cu)
 #define TIM_SR(base) ((base) + 0x10u)
 #define TIM_EGR(base) ((base) + 0x14u)
@@ -114,6 +132,7 @@
 /* NVIC */
 #define NVIC_ISER0 0xE000E100u
 #define NVIC_ISER1 0xE000E104u
+#define NVIC_ISPR0 0xE000E200u
 #define NVIC_IPR_BASE 0xE000E400u
 
 #endif
@@ -1,65 +1,84 @@
 #include "platform/hw.h"
 #include "platform/mmio.h"
+#include "platform/dma.h"
 #include "platform/irq_dma.h"
-
-#define DMA1_BASE 0x40020000u
-#define DMA1_ISR (DMA1_BASE + 0x00u)
-#define DMA1_IFCR (DMA1_BASE + 0x04u)
-#define DMA1_CH2_BASE (DMA1_BASE + 0x1Cu)
-#define DMA1_CH3_BASE (DMA1_BASE + 0x30u)
-
-#define DMA_ISR_TCIF2 (1u << 5)
-#define DMA_ISR_TCIF3 (1u << 9)
+#include "src/kernel/work_queue.h"
 
 #define DMA_CCR(ch) ((ch) + 0x00u)
 
 volatile uint8_t g_spi_dma_rx_done;
 volatile uint8_t g_spi_dma_tx_done;
+static platform_spi_rx_chain_fn g_spi_dma_rx_chain;
 
 #if !defined(HOST_TEST)
-void DMA1_Channel2_IRQHandler(void)
+static void spi_dma_rx_irq(void *ctx, uint32_t flags)
 {
-    if ((mmio_read32(DMA1_ISR) & DMA_ISR_TCIF2) == 0u)
+    (void)ctx;
+    if ((flags & PLATFORM_DMA_F_TC) == 0u)
         return;
 
-    /* Clear TCIF2 only (OEM writes 0x20). */
-    mmio_write32(DMA1_IFCR, DMA_ISR_TCIF2);
-
     /* Disable SPI1 and DMA1 CH2, clear TCIE. */
     uint32_t cr1 = mmio_read32(SPI1_BASE + 0x00u);
     mmio_write32(SPI1_BASE + 0x00u, cr1 & ~0x40u);
 
-    uint32_t ccr = mmio_read32(DMA_CCR(DMA1_CH2_BASE));
+    uint32_t ch = platform_dma_ch(PLATFORM_DMA_FLASH_RX);
+    uint32_t ccr = mmio_read32(DMA_CCR(ch));
     ccr &= ~1u;
     ccr &= ~2u;
-    mmio_write32(DMA_CCR(DMA1_CH2_BASE), ccr);
+    mmio_write32(DMA_CCR(ch), ccr);
 
     /* Deassert SPI flash CS (PA4 high). */
     mmio_write32(GPIO_BSRR(GPIOA_BASE), (1u << 4));
+    platform_dma_busy_end(PLATFORM_DMA_FLASH_RX);
+    if (g_spi_dma_rx_chain && g_spi_dma_rx_chain())
+        return;
     g_spi_dma_rx_done = 1u;
 }
 
-void DMA1_Channel3_IRQHandler(void)
+/* SPI1 drains its shift register for a couple of byte times after the last
+ * DMA write; that wait happens at PendSV level instead of inside CH3's
+ * handler, where it would hold off USART1 (same group, platform/nvic.h). */
+static void spi_dma_tx_finish(void *ctx)
 {
-    if ((mmio_read32(DMA1_ISR) & DMA_ISR_TCIF3) == 0u)
-        return;
-
-    /* Clear TCIF3 only (OEM writes 0x200). */
-    mmio_write32(DMA1_IFCR, DMA_ISR_TCIF3);
-
+    (void)ctx;
     /* Wait until SPI1 not busy. */
     while (mmio_read32(SPI1_BASE + 0x08u) & 0x80u)
     {
     }
 
+    /* Deassert SPI flash CS (PA4 high). */
+    mmio_write32(GPIO_BSRR(GPIOA_BASE), (1u << 4));
+    platform_dma_busy_end(PLATFORM_DMA_FLASH_TX);
+    g_spi_dma_tx_done = 1u;
+}
+
+static void spi_dma_tx_irq(void *ctx, uint32_t flags)
+{
+    (void)ctx;
+    if ((flags & PLATFORM_DMA_F_TC) == 0u)
+        return;
+
     /* Disable DMA1 CH3, clear TCIE. */
-    uint32_t ccr = mmio_read32(DMA_CCR(DMA1_CH3_BASE));
+    uint32_t ch = platform_dma_ch(PLATFORM_DMA_FLASH_TX);
+    uint32_t ccr = mmio_read32(DMA_CCR(ch));
     ccr &= ~1u;
     ccr &= ~2u;
-    mmio_write32(DMA_CCR(DMA1_CH3_BASE), ccr);
+    mmio_write32(DMA_CCR(ch), ccr);
 
-    /* Deassert SPI flash CS (PA4 high). */
-    mmio_write32(GPIO_BSRR(GPIOA_BASE), (1u << 4));
-    g_spi_dma_tx_done = 1u;
+    if (!work_queue_post(spi_dma_tx_finish, 0))
+        spi_dma_tx_finish(0);
 }
 #endif
+
+void platform_spi_dma_attach(void)
+{
+#if !defined(HOST_TEST)
+    platform_dma_attach(PLATFORM_DMA_FLASH_RX, spi_dma_rx_irq, 0);
+    platform_dma_attach(PLATFORM_DMA_FLASH_TX, spi_dma_tx_irq, 0);
+#endif
+}
+
+void platform_spi_dma_set_rx_chain(platform_spi_rx_chain_fn fn)
+{
+    g_spi_dma_rx_chain = fn;
+}
@@ -6,4 +6,12 @@
 extern volatile uint8_t g_spi_dma_rx_done;
 extern volatile uint8_t g_spi_dma_tx_done;
 
+/* Hooks the SPI1 flash completions to the DMA1 CH2/CH3 IRQs. */
+void platform_spi_dma_attach(void);
+
+/* Runs from the CH2 IRQ after each RX transfer is torn down; returning 1
+ * means it armed another, and g_spi_dma_rx_done stays clear. */
+typedef uint8_t (*platform_spi_rx_chain_fn)(void);
+void platform_spi_dma_set_rx_chain(platform_spi_rx_chain_fn fn);
+
 #endif
@@ -0,0 +1,88 @@
+#include "platform/irq_load.h"
+
+#include "platform/dma.h"
+#include "platform/time.h"
+
+#ifndef HOST_TEST
+#include "platform/cpu.h"
+#else
+static uint32_t irq_save(void) { return 0u; }
+static void irq_restore(uint32_t primask) { (void)primask; }
+#endif
+
+_Static_assert(PLATFORM_IRQ_SRC_COUNT == PLATFORM_IRQ_SRC_DMA(PLATFORM_DMA_COUNT), "one source per DMA channel");
+
+static volatile uint32_t g_irq_cycles[PLATFORM_IRQ_LOAD_COUNT];
+/* Sum of every completed handler's own time. */
+static volatile uint32_t g_irq_charged;
+static platform_irq_stats_t g_irq_stats[PLATFORM_IRQ_SRC_COUNT];
+
+static const uint8_t k_src_group[PLATFORM_IRQ_SRC_COUNT] = {
+    [PLATFORM_IRQ_SRC_TIM2] = PLATFORM_IRQ_LOAD_TIM2,
+    [PLATFORM_IRQ_SRC_USART1] = PLATFORM_IRQ_LOAD_USART,
+    [PLATFORM_IRQ_SRC_USART2] = PLATFORM_IRQ_LOAD_USART,
+    [PLATFORM_IRQ_SRC_DMA(PLATFORM_DMA_ADC)] = PLATFORM_IRQ_LOAD_DMA,
+    [PLATFORM_IRQ_SRC_DMA(PLATFORM_DMA_FLASH_RX)] = PLATFORM_IRQ_LOAD_DMA,
+    [PLATFORM_IRQ_SRC_DMA(PLATFORM_DMA_FLASH_TX)] = PLATFORM_IRQ_LOAD_DMA,
+    [PLATFORM_IRQ_SRC_DMA(PLATFORM_DMA_MOTOR_RX)] = PLATFORM_IRQ_LOAD_DMA,
+    [PLATFORM_IRQ_SRC_DMA(PLATFORM_DMA_MOTOR_TX)] = PLATFORM_IRQ_LOAD_DMA,
+    [PLATFORM_IRQ_SRC_DMA(PLATFORM_DMA_LCD)] = PLATFORM_IRQ_LOAD_DMA,
+};
+
+void platform_irq_load_enter(platform_irq_span_t *span)
+{
+    platform_irq_load_enter_late(span, PLATFORM_IRQ_LATE_UNKNOWN);
+}
+
+void platform_irq_load_enter_late(platform_irq_span_t *span, uint32_t late_cycles)
+{
+    span->start = platform_cycles_now();
+    span->nested = g_irq_charged;
+    span->late = late_cycles;
+}
+
+void platform_irq_load_exit(uint8_t src, const platform_irq_span_t *span)
+{
+    uint32_t primask = irq_save();
+    uint32_t total = platform_cycles_now() - span->start;
+    uint32_t own = total - (g_irq_charged - span->nested);
+    g_irq_cycles[k_src_group[src]] += own;
+    g_irq_charged += own;
+
+    platform_irq_stats_t *st = &g_irq_stats[src];
+    st->count++;
+    if (own > st->own_max)
+        st->own_max = own;
+    if (total > st->total_max)
+        st->total_max = total;
+    if (span->late != PLATFORM_IRQ_LATE_UNKNOWN)
+    {
+        st->late_count++;
+        if (span->late > st->late_max)
+            st->late_max = span->late;
+    }
+    irq_restore(primask);
+}
+
+void platform_irq_load_cycles(uint32_t out[PLATFORM_IRQ_LOAD_COUNT])
+{
+    for (uint8_t i = 0; i < PLATFORM_IRQ_LOAD_COUNT; ++i)
+        out[i] = g_irq_cycles[i];
+}
+
+void platform_irq_load_stats(uint8_t src, platform_irq_stats_t *out)
+{
+    if (!out || src >= PLATFORM_IRQ_SRC_COUNT)
+        return;
+    uint32_t primask = irq_save();
+    *out = g_irq_stats[src];
+    irq_restore(primask);
+}
+
+void platform_irq_load_reset_stats(void)
+{
+    uint32_t primask = irq_save();
+    for (uint8_t i = 0; i < PLATFORM_IRQ_SRC_COUNT; ++i)
+        g_irq_stats[i] = (platform_irq_stats_t){ 0 };
+    irq_restore(primask);
+}
@@ -0,0 +1,58 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_IRQ_LOAD_H
+#define OPEN_FIRMWARE_PLATFORM_IRQ_LOAD_H
+
+#include <stdint.h>
+
+/*
+ * CPU time spent in interrupt handlers, per handler group, in DWT cycles.
+ * Each handler brackets its body with enter/exit; time spent in a handler
+ * that preempted it is charged to the preempting group only, so the groups
+ * add up to the total. Counters wrap; callers take differences over windows
+ * shorter than the cycle counter's wrap.
+ *
+ * The same brackets keep worst cases per source, for checking the priority
+ * plan in platform/nvic.h: handler time on its own and from entry to exit
+ * (preemption included), and entry latency, from the request to the
+ * handler's first instruction. Latency is only known where the request is
+ * stamped: TIM2 counts us from its update event, and a DMA channel pended
+ * by software carries the pender's stamp. Other entries leave it out.
+ */
+#define PLATFORM_IRQ_LOAD_TIM2  0u /* 5 ms tick and motor_isr_tick */
+#define PLATFORM_IRQ_LOAD_USART 1u /* USART1/2 */
+#define PLATFORM_IRQ_LOAD_DMA   2u /* every DMA channel */
+#define PLATFORM_IRQ_LOAD_COUNT 3u
+
+/* Sources: TIM2, the USARTs, then one per platform/dma.h channel. */
+#define PLATFORM_IRQ_SRC_TIM2      0u
+#define PLATFORM_IRQ_SRC_USART1    1u
+#define PLATFORM_IRQ_SRC_USART2    2u
+#define PLATFORM_IRQ_SRC_DMA(user) (3u + (user))
+#define PLATFORM_IRQ_SRC_COUNT     9u
+
+typedef struct {
+    uint32_t start;
+    uint32_t nested;  /* charged-cycle total at entry */
+    uint32_t late;    /* entry latency in cycles, or PLATFORM_IRQ_LATE_UNKNOWN */
+} platform_irq_span_t;
+
+#define PLATFORM_IRQ_LATE_UNKNOWN 0xFFFFFFFFu
+
+typedef struct {
+    uint32_t count;
+    uint32_t late_count;  /* entries with a known latency */
+    uint32_t late_max;    /* cycles */
+    uint32_t own_max;     /* cycles in the handler itself */
+    uint32_t total_max;   /* cycles from entry to exit */
+} platform_irq_stats_t;
+
+void platform_irq_load_enter(platform_irq_span_t *span);
+/* As enter, for a handler that knows how long its request waited; call it
+ * before anything else in the handler. */
+void platform_irq_load_enter_late(platform_irq_span_t *span, uint32_t late_cycles);
+void platform_irq_load_exit(uint8_t src, const platform_irq_span_t *span);
+void platform_irq_load_cycles(uint32_t out[PLATFORM_IRQ_LOAD_COUNT]);
+
+void platform_irq_load_stats(uint8_t src, platform_irq_stats_t *out);
+void platform_irq_load_reset_stats(void);
+
+#endif
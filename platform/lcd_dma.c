@@ -1,15 +1,249 @@
 #include "platform/lcd_dma.h"
 
+#include "platform/dma.h"
 #include "platform/hw.h"
 #include "platform/mmio.h"
 
-void platform_lcd_dma_write_u16(const uint16_t *pixels, uint32_t count)
+#if !defined(HOST_TEST)
+#include "platform/cpu.h"
+#endif
+
+#define DMA_CCR(ch) ((ch) + 0x00u)
+#define DMA_CNDTR(ch) ((ch) + 0x04u)
+#define DMA_CPAR(ch) ((ch) + 0x08u)
+#define DMA_CMAR(ch) ((ch) + 0x0Cu)
+
+#define DMA_CCR_EN (1u << 0)
+#define DMA_CCR_TCIE (1u << 1)
+#define DMA_CCR_TEIE (1u << 3)
+#define DMA_CCR_DIR (1u << 4)
+#define DMA_CCR_MINC (1u << 7)
+#define DMA_CCR_PSIZE_16 (1u << 8)
+#define DMA_CCR_MSIZE_16 (1u << 10)
+#define DMA_CCR_MEM2MEM (1u << 14)
+
+#define LCD_DMA_MAX_CHUNK 0xFFFFu
+/* Below this size the channel setup costs more than a CPU copy. */
+#define LCD_DMA_MIN_PIXELS 16u
+
+static uint8_t g_lcd_dma_inited;
+static volatile uint8_t g_lcd_dma_busy;
+static const uint16_t *volatile g_lcd_dma_src;
+static volatile uint32_t g_lcd_dma_remaining;
+static platform_lcd_dma_done_fn g_lcd_dma_done;
+static void *g_lcd_dma_ctx;
+/* Solid fills stream one colour word with MINC cleared. */
+static volatile uint8_t g_lcd_dma_fill_mode;
+static uint16_t g_lcd_dma_fill_color;
+
+#if defined(HOST_TEST)
+platform_lcd_dma_host_t g_lcd_dma_host;
+/* Chunk the stand-in channel is moving, 0 when idle. */
+static uint32_t g_lcd_dma_host_chunk;
+
+static uint32_t lcd_dma_irqs_available(void)
+{
+    return g_lcd_dma_host.irqs_masked ? 0u : 1u;
+}
+
+static inline void lcd_dma_data_write(uint16_t v)
+{
+    g_lcd_dma_host.cpu_pixels++;
+    g_lcd_dma_host.last = v;
+}
+#else
+/* The completion IRQ only runs in thread mode with interrupts on. Boot
+ * (board init, splash, boot log) draws with them masked, as do fault paths. */
+static uint32_t lcd_dma_irqs_available(void)
+{
+    return cpu_irqs_available();
+}
+
+static inline void lcd_dma_data_write(uint16_t v)
+{
+    *(volatile uint16_t *)LCD_DATA_ADDR = v;
+}
+#endif
+
+static void lcd_dma_cpu_write(const uint16_t *pixels, uint32_t count)
+{
+    /* OEM app writes LCD over FSMC without DMA; used for short runs. */
+    for (uint32_t i = 0; i < count; ++i)
+        lcd_dma_data_write(pixels[i]);
+}
+
+static void lcd_dma_kick_chunk(void)
 {
+    uint32_t chunk = g_lcd_dma_remaining;
+    if (chunk > LCD_DMA_MAX_CHUNK)
+        chunk = LCD_DMA_MAX_CHUNK;
+
+#if defined(HOST_TEST)
+    g_lcd_dma_host.last = *g_lcd_dma_src;
+    g_lcd_dma_host_chunk = chunk;
+#else
+    uint32_t ch = platform_dma_ch(PLATFORM_DMA_LCD);
+    uint32_t ccr = mmio_read32(DMA_CCR(ch)) & ~(DMA_CCR_EN | DMA_CCR_MINC);
+    if (!g_lcd_dma_fill_mode)
+        ccr |= DMA_CCR_MINC;
+    mmio_write32(DMA_CCR(ch), ccr);
+    platform_dma_clear(PLATFORM_DMA_LCD);
+    mmio_write32(DMA_CMAR(ch), (uint32_t)g_lcd_dma_src);
+    mmio_write32(DMA_CNDTR(ch), chunk);
+#endif
+
+    if (!g_lcd_dma_fill_mode)
+        g_lcd_dma_src += chunk;
+    g_lcd_dma_remaining -= chunk;
+
+#if !defined(HOST_TEST)
+    mmio_write32(DMA_CCR(ch), ccr | DMA_CCR_EN);
+#endif
+}
+
+static void lcd_dma_irq(void *arg, uint32_t flags)
+{
+    (void)arg;
+    if ((flags & (PLATFORM_DMA_F_TC | PLATFORM_DMA_F_TE)) == 0u)
+        return;
+
+    if ((flags & PLATFORM_DMA_F_TE) == 0u && g_lcd_dma_remaining)
+    {
+        lcd_dma_kick_chunk();
+        return;
+    }
+
+#if !defined(HOST_TEST)
+    uint32_t ch = platform_dma_ch(PLATFORM_DMA_LCD);
+    mmio_write32(DMA_CCR(ch), mmio_read32(DMA_CCR(ch)) & ~DMA_CCR_EN);
+#endif
+    g_lcd_dma_remaining = 0u;
+    platform_lcd_dma_done_fn done = g_lcd_dma_done;
+    void *ctx = g_lcd_dma_ctx;
+    g_lcd_dma_done = 0;
+    g_lcd_dma_busy = 0u;
+    platform_dma_busy_end(PLATFORM_DMA_LCD);
+    if (done)
+        done(ctx);
+}
+
+#if defined(HOST_TEST)
+static uint32_t lcd_dma_take_flags(void)
+{
+    uint32_t chunk = g_lcd_dma_host_chunk;
+    if (!chunk)
+        return 0u;
+    g_lcd_dma_host_chunk = 0u;
+    g_lcd_dma_host.dma_pixels += chunk;
+    return PLATFORM_DMA_F_GIF | PLATFORM_DMA_F_TC;
+}
+
+void platform_lcd_dma_host_complete(void)
+{
+    lcd_dma_irq(0, lcd_dma_take_flags());
+}
+#else
+static uint32_t lcd_dma_take_flags(void)
+{
+    uint32_t flags = platform_dma_flags(PLATFORM_DMA_LCD);
+    if (flags & (PLATFORM_DMA_F_TC | PLATFORM_DMA_F_TE))
+        platform_dma_clear(PLATFORM_DMA_LCD);
+    return flags;
+}
+#endif
+
+void platform_lcd_dma_init(void)
+{
+    if (g_lcd_dma_inited)
+        return;
+    g_lcd_dma_inited = 1u;
+#if !defined(HOST_TEST)
+    platform_dma_attach(PLATFORM_DMA_LCD, lcd_dma_irq, 0);
+    uint32_t ch = platform_dma_ch(PLATFORM_DMA_LCD);
+
+    /* MEM2MEM with DIR=1: CMAR (RAM, incrementing) -> CPAR (LCD, fixed). */
+    mmio_write32(DMA_CPAR(ch), LCD_DATA_ADDR);
+    mmio_write32(DMA_CCR(ch),
+                 DMA_CCR_MEM2MEM | platform_dma_pl(PLATFORM_DMA_LCD) | DMA_CCR_MSIZE_16 | DMA_CCR_PSIZE_16 |
+                 DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TEIE | DMA_CCR_TCIE);
+#endif
+}
+
+uint8_t platform_lcd_dma_busy(void)
+{
+    return g_lcd_dma_busy;
+}
+
+void platform_lcd_dma_wait(void)
+{
+    while (g_lcd_dma_busy)
+    {
+        /* A transfer started before IRQs were masked: run its completion here. */
+        if (!lcd_dma_irqs_available())
+            lcd_dma_irq(0, lcd_dma_take_flags());
+    }
+}
+
+void platform_lcd_dma_write_u16_async(const uint16_t *pixels, uint32_t count,
+                                      platform_lcd_dma_done_fn done, void *ctx)
+{
+    platform_lcd_dma_wait();
     if (!pixels || count == 0u)
+    {
+        if (done)
+            done(ctx);
+        return;
+    }
+
+    if (!g_lcd_dma_inited)
+        platform_lcd_dma_init();
+    if (count >= LCD_DMA_MIN_PIXELS && lcd_dma_irqs_available())
+    {
+        g_lcd_dma_fill_mode = 0u;
+        g_lcd_dma_done = done;
+        g_lcd_dma_ctx = ctx;
+        g_lcd_dma_src = pixels;
+        g_lcd_dma_remaining = count;
+        g_lcd_dma_busy = 1u;
+        platform_dma_busy_begin(PLATFORM_DMA_LCD);
+        lcd_dma_kick_chunk();
+        return;
+    }
+
+    lcd_dma_cpu_write(pixels, count);
+    if (done)
+        done(ctx);
+}
+
+void platform_lcd_dma_write_u16(const uint16_t *pixels, uint32_t count)
+{
+    platform_lcd_dma_write_u16_async(pixels, count, 0, 0);
+}
+
+void platform_lcd_dma_fill_u16(uint16_t color, uint32_t count)
+{
+    platform_lcd_dma_wait();
+    if (count == 0u)
+        return;
+
+    if (!g_lcd_dma_inited)
+        platform_lcd_dma_init();
+    if (count >= LCD_DMA_MIN_PIXELS && lcd_dma_irqs_available())
+    {
+        /* Colour word is read by DMA until completion; wait() above guarantees the
+         * previous fill no longer references it. */
+        g_lcd_dma_fill_color = color;
+        g_lcd_dma_fill_mode = 1u;
+        g_lcd_dma_done = 0;
+        g_lcd_dma_ctx = 0;
+        g_lcd_dma_src = &g_lcd_dma_fill_color;
+        g_lcd_dma_remaining = count;
+        g_lcd_dma_busy = 1u;
+        platform_dma_busy_begin(PLATFORM_DMA_LCD);
+        lcd_dma_kick_chunk();
         return;
+    }
 
-    /* OEM app writes LCD over FSMC without DMA; keep the same behavior. */
-    volatile uint16_t *dst = (volatile uint16_t *)LCD_DATA_ADDR;
     for (uint32_t i = 0; i < count; ++i)
-        *dst = pixels[i];
+        lcd_dma_data_write(color);
 }
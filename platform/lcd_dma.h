@@ -3,6 +3,51 @@
 
 #include <stdint.h>
 
+/*
+ * LCD pixel push over FSMC using DMA2 CH1 in memory-to-memory mode
+ * (source: incrementing RAM buffer, destination: fixed LCD_DATA_ADDR).
+ *
+ * Only one transfer is in flight at a time. Callers must not touch the
+ * LCD bus (window/command writes) or the source buffer until the
+ * transfer has drained; platform_lcd_dma_wait() provides that barrier.
+ *
+ * With IRQs masked (boot, fault paths) the completion IRQ cannot run:
+ * transfers are written by the CPU instead, and waiting on one started
+ * earlier polls the channel for its completion.
+ */
+typedef void (*platform_lcd_dma_done_fn)(void *ctx);
+
+void platform_lcd_dma_init(void);
+
+/* Start a transfer and return immediately. Waits for any previous transfer
+ * first. Short transfers are written by the CPU and complete before return.
+ * The callback (optional) runs from the DMA IRQ on completion. */
+void platform_lcd_dma_write_u16_async(const uint16_t *pixels, uint32_t count,
+                                      platform_lcd_dma_done_fn done, void *ctx);
+
+/* Start a transfer without a completion callback (still non-blocking). */
 void platform_lcd_dma_write_u16(const uint16_t *pixels, uint32_t count);
 
+/* Stream one colour word `count` times (non-incrementing source); used for
+ * solid rectangle fills so a whole window goes out in one transfer. */
+void platform_lcd_dma_fill_u16(uint16_t color, uint32_t count);
+
+uint8_t platform_lcd_dma_busy(void);
+void platform_lcd_dma_wait(void);
+
+#if defined(HOST_TEST)
+/* Host tests: PRIMASK, the channel and the LCD data port are plain state.
+ * A DMA chunk stays in flight until platform_lcd_dma_host_complete() runs
+ * its completion IRQ, or a wait with IRQs masked polls it done. */
+typedef struct {
+    uint8_t irqs_masked;
+    uint32_t cpu_pixels;  /* written to the data port by the CPU */
+    uint32_t dma_pixels;  /* moved by completed chunks */
+    uint16_t last;        /* last pixel written or handed to the channel */
+} platform_lcd_dma_host_t;
+
+extern platform_lcd_dma_host_t g_lcd_dma_host;
+void platform_lcd_dma_host_complete(void);
+#endif
+
 #endif
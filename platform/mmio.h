@@ -21,22 +21,22 @@ static inline void mmio_isb(void)
 
 static inline void mmio_write32(uint32_t addr, uint32_t value)
 {
-    *(volatile uint32_t *)addr = value;
+    *(volatile uint32_t *)(uintptr_t)addr = value;
 }
 
 static inline uint32_t mmio_read32(uint32_t addr)
 {
-    return *(volatile uint32_t *)addr;
+    return *(volatile uint32_t *)(uintptr_t)addr;
 }
 
 static inline void mmio_write8(uint32_t addr, uint8_t value)
 {
-    *(volatile uint8_t *)addr = value;
+    *(volatile uint8_t *)(uintptr_t)addr = value;
 }
 
 static inline uint8_t mmio_read8(uint32_t addr)
 {
-    return *(volatile uint8_t *)addr;
+    return *(volatile uint8_t *)(uintptr_t)addr;
 }
 
 #endif
@@ -0,0 +1,20 @@
+#include "platform/nvic.h"
+
+#include "platform/hw.h"
+#include "platform/mmio.h"
+
+void platform_nvic_set_priority(uint8_t irq, uint8_t priority)
+{
+    uint32_t addr = NVIC_IPR_BASE + irq;
+    uint32_t word = addr & ~0x3u;
+    uint32_t shift = (addr & 0x3u) * 8u;
+    uint32_t v = mmio_read32(word);
+    v = (v & ~(0xFFu << shift)) | ((uint32_t)priority << shift);
+    mmio_write32(word, v);
+}
+
+void platform_nvic_enable(uint8_t irq, uint8_t priority)
+{
+    platform_nvic_set_priority(irq, priority);
+    mmio_write32(NVIC_ISER0 + 4u * (irq / 32u), 1u << (irq % 32u));
+}
@@ -0,0 +1,50 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_NVIC_H
+#define OPEN_FIRMWARE_PLATFORM_NVIC_H
+
+#include <stdint.h>
+
+/*
+ * Interrupt priority map. AIRCR PRIGROUP=5 (the OEM setting) splits the four
+ * implemented priority bits into a preemption group, bits [7:6], and a
+ * subpriority, bits [5:4]. Only a lower group number interrupts a running
+ * handler; subpriority just picks which of several pending handlers of one
+ * group goes first.
+ *
+ *   group  sources                                  why
+ *   0      PVD brownout, TIM4 PC sampler             must see everything else
+ *   1      USART2, TIM2 tick, DMA1 CH6/CH7 (motor)   motor UART timing
+ *   2      DMA1 CH2/CH3 (SPI flash), USART1 (BLE)    byte-rate deadlines
+ *   3      ADC DMA1 CH1, LCD DMA2 CH1, button EXTI   can wait milliseconds
+ *   3/3    PendSV (work queue)                       below every NVIC line
+ *
+ * The motor link has group 1 to itself, so only the brownout path and the
+ * profiler can stretch the time from a TIM2 update or a USART2 IDLE to its
+ * handler. The OEM values had the flash TX completion (0x40) preempting the
+ * motor tick and its DMA (0xA0); that completion now only posts to PendSV
+ * and waits in group 2. Handlers in one group never preempt each other,
+ * which is what keeps motor_isr_tick, the RX DMA drain and the TX
+ * completion serialised (see motor_isr.c).
+ */
+#define PLATFORM_NVIC_PRIGROUP 5u
+#define PLATFORM_NVIC_PRIO(group, sub) ((uint8_t)(((group) << 6) | ((sub) << 4)))
+
+#define PLATFORM_PRIO_PVD       PLATFORM_NVIC_PRIO(0u, 0u)
+#define PLATFORM_PRIO_PC_SAMPLE PLATFORM_NVIC_PRIO(0u, 1u)
+#define PLATFORM_PRIO_USART2    PLATFORM_NVIC_PRIO(1u, 0u)
+#define PLATFORM_PRIO_TIM2      PLATFORM_NVIC_PRIO(1u, 1u)
+#define PLATFORM_PRIO_MOTOR_DMA PLATFORM_NVIC_PRIO(1u, 1u)
+/* RX first: the RXONLY clock runs until its completion stops it. */
+#define PLATFORM_PRIO_FLASH_RX  PLATFORM_NVIC_PRIO(2u, 0u)
+#define PLATFORM_PRIO_USART1    PLATFORM_NVIC_PRIO(2u, 1u)
+#define PLATFORM_PRIO_FLASH_TX  PLATFORM_NVIC_PRIO(2u, 2u)
+#define PLATFORM_PRIO_ADC_DMA   PLATFORM_NVIC_PRIO(3u, 0u)
+#define PLATFORM_PRIO_LCD_DMA   PLATFORM_NVIC_PRIO(3u, 0u)
+#define PLATFORM_PRIO_BUTTONS   PLATFORM_NVIC_PRIO(3u, 0u)
+#define PLATFORM_PRIO_PENDSV    PLATFORM_NVIC_PRIO(3u, 3u)
+
+/* IPR byte of an NVIC line; platform_nvic_init() has set the grouping. */
+void platform_nvic_set_priority(uint8_t irq, uint8_t priority);
+/* Sets the priority, then enables the line. */
+void platform_nvic_enable(uint8_t irq, uint8_t priority);
+
+#endif
@@ -0,0 +1,93 @@
+#include "platform/overlay.h"
+
+#include <stddef.h>
+
+#include "platform/cpu.h"
+
+#define OVERLAY_GUARD 0x0E7A1A5Du
+
+static struct {
+    uint8_t buf[OVERLAY_ARENA_BYTES] __attribute__((aligned(4)));
+    uint32_t guard;
+    overlay_stats_t st;
+} g_overlay;
+
+static uint32_t overlay_lock(void)
+{
+#if defined(HOST_TEST)
+    return 0u;
+#else
+    return irq_save();
+#endif
+}
+
+static void overlay_unlock(uint32_t primask)
+{
+#if defined(HOST_TEST)
+    (void)primask;
+#else
+    irq_restore(primask);
+#endif
+}
+
+uint8_t *platform_overlay_lease(uint8_t owner, uint32_t bytes)
+{
+    if (owner == OVERLAY_OWNER_NONE)
+        return NULL;
+    uint32_t primask = overlay_lock();
+    uint8_t ok = (g_overlay.st.owner == OVERLAY_OWNER_NONE && bytes <= OVERLAY_ARENA_BYTES);
+    if (ok)
+    {
+        g_overlay.st.owner = owner;
+        g_overlay.st.leases++;
+    }
+    else
+    {
+        g_overlay.st.conflicts++;
+        g_overlay.st.last_conflict = owner;
+    }
+    overlay_unlock(primask);
+    if (!ok)
+        return NULL;
+    g_overlay.guard = OVERLAY_GUARD;
+    return g_overlay.buf;
+}
+
+void platform_overlay_release(uint8_t owner)
+{
+    uint32_t primask = overlay_lock();
+    if (owner == OVERLAY_OWNER_NONE || g_overlay.st.owner != owner)
+    {
+        g_overlay.st.conflicts++;
+        g_overlay.st.last_conflict = owner;
+    }
+    else
+    {
+        /* A write past the end of the buffer lands on the guard first. */
+        if (g_overlay.guard != OVERLAY_GUARD)
+        {
+            g_overlay.st.conflicts++;
+            g_overlay.st.last_conflict = owner;
+        }
+        g_overlay.st.owner = OVERLAY_OWNER_NONE;
+    }
+    overlay_unlock(primask);
+}
+
+uint8_t *platform_overlay_seize(uint8_t owner)
+{
+    uint32_t primask = overlay_lock();
+    if (g_overlay.st.owner != OVERLAY_OWNER_NONE)
+        g_overlay.st.last_conflict = g_overlay.st.owner;
+    g_overlay.st.owner = owner;
+    g_overlay.st.leases++;
+    overlay_unlock(primask);
+    g_overlay.guard = OVERLAY_GUARD;
+    return g_overlay.buf;
+}
+
+void platform_overlay_get_stats(overlay_stats_t *out)
+{
+    if (out)
+        *out = g_overlay.st;
+}
@@ -0,0 +1,42 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_OVERLAY_H
+#define OPEN_FIRMWARE_PLATFORM_OVERLAY_H
+
+#include <stdint.h>
+
+/*
+ * Overlay arena: one .bss region in the default bank shared by large
+ * buffers whose users never run at the same time. A user leases the whole
+ * arena for the span it needs it and releases it before returning to the
+ * main loop; nothing survives a release.
+ *
+ * Users (each _Static_asserts its buffer fits):
+ *   FLASH_RMW   spi_flash_update_bytes sector copy (4 KB)
+ *   CRASH_DUMP  crash dump build/verify image (CRASH_DUMP_SIZE)
+ *
+ * The checks are always on: a lease while another owner holds the arena
+ * returns NULL and counts a conflict, a release by anyone but the holder is
+ * counted and ignored, and a guard word past the end is checked on release.
+ * Paths that never return to the code they interrupt (the fault handler)
+ * seize the arena instead of leasing it.
+ */
+#define OVERLAY_ARENA_BYTES 4096u
+
+#define OVERLAY_OWNER_NONE       0u
+#define OVERLAY_OWNER_FLASH_RMW  1u
+#define OVERLAY_OWNER_CRASH_DUMP 2u
+
+typedef struct {
+    uint32_t leases;
+    uint32_t conflicts;      /* leases refused, bad releases, guard hits */
+    uint8_t owner;           /* OVERLAY_OWNER_* holding it now */
+    uint8_t last_conflict;   /* owner whose request was refused last */
+} overlay_stats_t;
+
+/* Main loop only. Returns the arena (4-byte aligned) or NULL. */
+uint8_t *platform_overlay_lease(uint8_t owner, uint32_t bytes);
+void platform_overlay_release(uint8_t owner);
+/* Takes the arena from any holder; the caller must not return to it. */
+uint8_t *platform_overlay_seize(uint8_t owner);
+void platform_overlay_get_stats(overlay_stats_t *out);
+
+#endif
@@ -0,0 +1,149 @@
+#include "platform/pc_sample.h"
+
+#include "platform/clock.h"
+#include "platform/hw.h"
+#include "platform/mmio.h"
+#include "platform/nvic.h"
+#include "platform/ram.h"
+
+#define RCC_APB1ENR_TIM4 (1u << 2)
+#define TIM4_IRQN 30u
+/* Period dither in counts (us): 0..15. */
+#define PC_SAMPLE_DITHER_MASK 0x0Fu
+
+static pc_sample_t g_pc_sample_ring[PC_SAMPLE_RING];
+static pc_sample_t g_pc_sample_ext[PC_SAMPLE_EXT_RING] RAM_EXT;
+
+static struct {
+    pc_sample_t *ring;
+    uint16_t cap;
+    uint16_t rate_hz;
+    uint16_t arr;                /* undithered period - 1 */
+    volatile uint8_t running;
+    volatile uint16_t head;      /* ISR */
+    volatile uint16_t tail;      /* reader */
+    volatile uint32_t total;
+    volatile uint32_t dropped;
+    uint32_t lfsr;
+} g_pc_sample;
+
+#if !defined(HOST_TEST)
+__attribute__((used)) static void pc_sample_capture(const uint32_t *frame)
+{
+    mmio_write32(TIM_SR(TIM4_BASE), ~1u);
+    /* Galois LFSR, taps 32,22,2,1. */
+    uint32_t l = g_pc_sample.lfsr;
+    l = (l >> 1) ^ (-(l & 1u) & 0x80200003u);
+    g_pc_sample.lfsr = l;
+    mmio_write32(TIM_ARR(TIM4_BASE), g_pc_sample.arr + (l & PC_SAMPLE_DITHER_MASK));
+
+    g_pc_sample.total++;
+    uint16_t head = g_pc_sample.head;
+    uint16_t next = (uint16_t)((head + 1u) % g_pc_sample.cap);
+    if (next == g_pc_sample.tail)
+    {
+        g_pc_sample.dropped++;
+        return;
+    }
+    g_pc_sample.ring[head].lr = frame[5];
+    g_pc_sample.ring[head].pc = frame[6];
+    g_pc_sample.head = next;
+}
+
+/* The stacked frame is on PSP only if the preempted code ran on it. */
+__attribute__((naked)) void TMR4_GLOBAL_IRQHandler(void)
+{
+    __asm__ volatile(
+        "tst lr, #4\n"
+        "ite eq\n"
+        "mrseq r0, msp\n"
+        "mrsne r0, psp\n"
+        "b pc_sample_capture\n");
+}
+
+static void pc_sample_nvic_setup(void)
+{
+    platform_nvic_enable(TIM4_IRQN, PLATFORM_PRIO_PC_SAMPLE);
+}
+#endif
+
+void pc_sample_stop(void)
+{
+#if !defined(HOST_TEST)
+    mmio_write32(TIM_CR1(TIM4_BASE), 0u);
+    mmio_write32(TIM_DIER(TIM4_BASE), 0u);
+    mmio_write32(TIM_SR(TIM4_BASE), 0u);
+#endif
+    g_pc_sample.running = 0u;
+}
+
+void pc_sample_start(uint16_t rate_hz)
+{
+    pc_sample_stop();
+    if (rate_hz < PC_SAMPLE_HZ_MIN)
+        rate_hz = PC_SAMPLE_HZ_MIN;
+    if (rate_hz > PC_SAMPLE_HZ_MAX)
+        rate_hz = PC_SAMPLE_HZ_MAX;
+    if (platform_ram_ext_available())
+    {
+        g_pc_sample.ring = g_pc_sample_ext;
+        g_pc_sample.cap = PC_SAMPLE_EXT_RING;
+    }
+    else
+    {
+        g_pc_sample.ring = g_pc_sample_ring;
+        g_pc_sample.cap = PC_SAMPLE_RING;
+    }
+    g_pc_sample.head = 0u;
+    g_pc_sample.tail = 0u;
+    g_pc_sample.total = 0u;
+    g_pc_sample.dropped = 0u;
+    g_pc_sample.rate_hz = rate_hz;
+    /* Centre the dither on the asked-for period. */
+    g_pc_sample.arr = (uint16_t)(1000000u / rate_hz - 1u - PC_SAMPLE_DITHER_MASK / 2u);
+    if (!g_pc_sample.lfsr)
+        g_pc_sample.lfsr = 0xACE1u;
+    g_pc_sample.running = 1u;
+#if !defined(HOST_TEST)
+    mmio_write32(RCC_APB1ENR, mmio_read32(RCC_APB1ENR) | RCC_APB1ENR_TIM4);
+    /* 1 MHz count at the current clock; profile switches rescale it. */
+    uint32_t mhz = rcc_get_hclk_hz_fallback() / 1000000u;
+    mmio_write32(TIM_PSC(TIM4_BASE), mhz ? mhz - 1u : 0u);
+    mmio_write32(TIM_ARR(TIM4_BASE), g_pc_sample.arr);
+    mmio_write32(TIM_CNT(TIM4_BASE), 0u);
+    mmio_write32(TIM_EGR(TIM4_BASE), 1u); /* UG: load PSC */
+    mmio_write32(TIM_SR(TIM4_BASE), 0u);
+    mmio_write32(TIM_DIER(TIM4_BASE), 1u);
+    pc_sample_nvic_setup();
+    mmio_write32(TIM_CR1(TIM4_BASE), 1u); /* CEN */
+#endif
+}
+
+uint16_t pc_sample_read(pc_sample_t *out, uint16_t max)
+{
+    if (!out || !g_pc_sample.cap)
+        return 0;
+    uint16_t n = 0;
+    uint16_t tail = g_pc_sample.tail;
+    while (n < max && tail != g_pc_sample.head)
+    {
+        out[n++] = g_pc_sample.ring[tail];
+        tail = (uint16_t)((tail + 1u) % g_pc_sample.cap);
+    }
+    g_pc_sample.tail = tail;
+    return n;
+}
+
+void pc_sample_get_stats(pc_sample_stats_t *out)
+{
+    if (!out)
+        return;
+    uint16_t head = g_pc_sample.head;
+    uint16_t tail = g_pc_sample.tail;
+    out->running = g_pc_sample.running;
+    out->rate_hz = g_pc_sample.rate_hz;
+    out->capacity = g_pc_sample.cap;
+    out->pending = g_pc_sample.cap ? (uint16_t)((head + g_pc_sample.cap - tail) % g_pc_sample.cap) : 0u;
+    out->total = g_pc_sample.total;
+    out->dropped = g_pc_sample.dropped;
+}
@@ -0,0 +1,44 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_PC_SAMPLE_H
+#define OPEN_FIRMWARE_PLATFORM_PC_SAMPLE_H
+
+#include <stdint.h>
+
+/*
+ * Statistical profiler. TIM4 interrupts at the chosen rate and records the
+ * PC and LR stacked by whatever it preempted: main loop, PendSV or any
+ * lower-priority ISR. It runs at the top NVIC priority so ISRs show up in
+ * the samples too, and each period is dithered by a few microseconds so the
+ * 5 ms TIM2 tick cannot alias with it.
+ *
+ * Samples go to a single-producer ring that the host drains over the comm
+ * link while sampling continues; a full ring drops new samples and counts
+ * them. With the extended SRAM bank mapped the ring is 16 times larger.
+ */
+#define PC_SAMPLE_RING 256u
+#define PC_SAMPLE_EXT_RING 4096u
+#define PC_SAMPLE_HZ_MIN 10u
+#define PC_SAMPLE_HZ_MAX 10000u
+
+typedef struct {
+    uint32_t pc;
+    uint32_t lr;
+} pc_sample_t;
+
+typedef struct {
+    uint8_t running;
+    uint16_t rate_hz;
+    uint16_t capacity;
+    uint16_t pending;    /* samples waiting to be read */
+    uint32_t total;      /* samples taken since start */
+    uint32_t dropped;    /* samples lost to a full ring */
+} pc_sample_stats_t;
+
+/* Clears the ring and starts sampling; rate is clamped to the limits. */
+void pc_sample_start(uint16_t rate_hz);
+void pc_sample_stop(void);
+
+/* Moves up to `max` of the oldest samples to `out`; returns the count. */
+uint16_t pc_sample_read(pc_sample_t *out, uint16_t max);
+void pc_sample_get_stats(pc_sample_stats_t *out);
+
+#endif
@@ -0,0 +1,51 @@
+#include "platform/pvd.h"
+
+#include "platform/hw.h"
+#include "platform/mmio.h"
+#include "platform/nvic.h"
+#include "src/power/brownout.h"
+
+#define PWR_BASE 0x40007000u
+#define PWR_CR   (PWR_BASE + 0x00u)
+#define PWR_CSR  (PWR_BASE + 0x04u)
+#define PWR_CR_PVDE (1u << 4)
+#define PWR_CR_PLS_MASK (7u << 5)
+#define PWR_CR_PLS_2V9 (7u << 5)
+#define PWR_CSR_PVDO (1u << 2)
+
+#define RCC_APB1ENR_PWR (1u << 28)
+
+#define EXTI_BASE 0x40010400u
+#define EXTI_IMR  (EXTI_BASE + 0x00u)
+#define EXTI_RTSR (EXTI_BASE + 0x08u)
+#define EXTI_PR   (EXTI_BASE + 0x14u)
+/* PVDO rises as VDD falls through the threshold. */
+#define PVD_EXTI_LINE (1u << 16)
+
+#define PVD_IRQ 1u
+
+#if !defined(HOST_TEST)
+void PVM_IRQHandler(void)
+{
+    mmio_write32(EXTI_PR, PVD_EXTI_LINE);
+    brownout_isr();
+}
+#endif
+
+void platform_pvd_init(void)
+{
+    mmio_write32(RCC_APB1ENR, mmio_read32(RCC_APB1ENR) | RCC_APB1ENR_PWR);
+    mmio_write32(PWR_CR, (mmio_read32(PWR_CR) & ~PWR_CR_PLS_MASK) | PWR_CR_PLS_2V9 | PWR_CR_PVDE);
+    mmio_write32(EXTI_RTSR, mmio_read32(EXTI_RTSR) | PVD_EXTI_LINE);
+    /* The comparator can glitch while it starts; drop that edge. */
+    mmio_write32(EXTI_PR, PVD_EXTI_LINE);
+    mmio_write32(EXTI_IMR, mmio_read32(EXTI_IMR) | PVD_EXTI_LINE);
+#if !defined(HOST_TEST)
+    platform_nvic_enable(PVD_IRQ, PLATFORM_PRIO_PVD);
+#endif
+}
+
+uint8_t platform_pvd_low(void)
+{
+    return (mmio_read32(PWR_CSR) & PWR_CSR_PVDO) ? 1u : 0u;
+}
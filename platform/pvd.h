@@ -0,0 +1,19 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_PVD_H
+#define OPEN_FIRMWARE_PLATFORM_PVD_H
+
+#include <stdint.h>
+
+/*
+ * Programmable voltage detector (PVM in AT32 terms) on VDD at its highest
+ * threshold, 2.9 V: the 3.3 V rail crossing it is the first sign that the
+ * pack is gone, ahead of the W25Q's 2.7 V minimum and the MCU's reset.
+ *
+ * The falling crossing raises EXTI line 16; the interrupt runs at the top
+ * priority, above every other handler, and calls brownout_isr().
+ */
+void platform_pvd_init(void);
+
+/* 1 while VDD is below the threshold. */
+uint8_t platform_pvd_low(void);
+
+#endif
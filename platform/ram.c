@@ -0,0 +1,252 @@
+#include "platform/ram.h"
+
+#include "platform/cpu.h"
+#include "platform/hw.h"
+#include "platform/mmio.h"
+
+#if !defined(HOST_TEST)
+extern uint32_t _stack_top;
+extern uint32_t _sdata;
+extern uint32_t _edata;
+extern uint32_t _sbss;
+extern uint32_t _ebss;
+extern uint32_t _snoinit;
+extern uint32_t _enoinit;
+extern uint32_t _sramfunc;
+extern uint32_t _eramfunc;
+extern uint32_t _sram_ext_start;
+extern uint32_t _sram_ext_end;
+#endif
+
+/* Flash controller and user system data (USD) */
+#define FLASH_UNLOCK     (FLASH_ACR + 0x04u)
+#define FLASH_USD_UNLOCK (FLASH_ACR + 0x08u)
+#define FLASH_STS        (FLASH_ACR + 0x0Cu)
+#define FLASH_CTRL       (FLASH_ACR + 0x10u)
+#define FLASH_USD        (FLASH_ACR + 0x1Cu)
+#define FLASH_KEY1 0x45670123u
+#define FLASH_KEY2 0xCDEF89ABu
+
+#define FLASH_STS_OBF     (1u << 0)
+#define FLASH_STS_PRGMERR (1u << 2)
+#define FLASH_STS_EPPERR  (1u << 4)
+#define FLASH_STS_ODF     (1u << 5)
+#define FLASH_CTRL_USDPRGM (1u << 4)
+#define FLASH_CTRL_USDERS  (1u << 5)
+#define FLASH_CTRL_ERSTR   (1u << 6)
+#define FLASH_CTRL_OPLK    (1u << 7)
+#define FLASH_CTRL_USDULKS (1u << 9)
+#define FLASH_USD_FAP      (1u << 1)
+
+/* fap, ssb, data0/1, epp0-3, eopb0, reserved, data2-7, ext_flash_key[8] */
+#define USD_BASE 0x1FFFF800u
+#define USD_HALFWORDS 24u
+#define USD_FAP_IDX 0u
+#define USD_EOPB0_IDX 8u
+#define USD_FAP_OPEN 0xA5u
+#define USD_EOPB0_SRAM_224K 0xFEu
+#define USD_EOPB0_SRAM_96K 0xFFu
+#define FLASH_WAIT_SPINS 0x00400000u
+
+static uint32_t g_stack_boot_peak;
+static uint8_t g_ram_ext_flags;
+
+uint32_t ram_paint_unused_words(const uint32_t *lo, const uint32_t *hi)
+{
+    const volatile uint32_t *p = lo;
+    while (p < hi && *p == RAM_STACK_PAINT)
+        p++;
+    return (uint32_t)(p - lo);
+}
+
+#if !defined(HOST_TEST)
+static uint32_t ram_stack_peak(void)
+{
+    uint32_t unused = ram_paint_unused_words(&_ebss, &_stack_top);
+    return (uint32_t)((uintptr_t)&_stack_top - (uintptr_t)&_ebss) - unused * 4u;
+}
+#endif
+
+void platform_ram_mark_boot(void)
+{
+#if !defined(HOST_TEST)
+    g_stack_boot_peak = ram_stack_peak();
+#endif
+}
+
+void platform_ram_get_stats(ram_stats_t *out)
+{
+    if (!out)
+        return;
+    *out = (ram_stats_t){0};
+    out->stack_boot_peak = g_stack_boot_peak;
+#if !defined(HOST_TEST)
+    uint32_t sp;
+    __asm__ volatile("mov %0, sp" : "=r"(sp));
+    uintptr_t top = (uintptr_t)&_stack_top;
+    out->sram_bytes = (uint32_t)(top - (uintptr_t)&_sdata);
+    out->data_bytes = (uint32_t)((uintptr_t)&_edata - (uintptr_t)&_sdata);
+    out->bss_bytes = (uint32_t)((uintptr_t)&_ebss - (uintptr_t)&_sbss);
+    out->stack_bytes = (uint32_t)(top - (uintptr_t)&_ebss);
+    out->stack_peak = ram_stack_peak();
+    out->stack_now = (uint32_t)(top - sp);
+    out->ext_used = (uint32_t)((uintptr_t)&_sram_ext_end - (uintptr_t)&_sram_ext_start);
+    out->ramfunc_bytes = (uint32_t)((uintptr_t)&_eramfunc - (uintptr_t)&_sramfunc);
+    out->noinit_bytes = (uint32_t)((uintptr_t)&_enoinit - (uintptr_t)&_snoinit);
+#endif
+    out->ext_flags = g_ram_ext_flags;
+}
+
+uint8_t platform_ram_ext_available(void)
+{
+    return (g_ram_ext_flags & RAM_EXT_F_ACTIVE) ? 1u : 0u;
+}
+
+#if !defined(HOST_TEST)
+static uint8_t usd_read(uint32_t idx)
+{
+    return (uint8_t)(*(volatile uint16_t *)(USD_BASE + 2u * idx) & 0xFFu);
+}
+
+static uint8_t usd_eopb0_224k(void)
+{
+    return (usd_read(USD_EOPB0_IDX) & 0x01u) ? 0u : 1u;
+}
+
+/*
+ * One store/load pair at the first extension word with data bus faults
+ * ignored (FAULTMASK + BFHFNMIGN) and the write buffer off so the store
+ * faults precisely. Only the first word is touched: it lies inside the first
+ * 128 KB, so even a decoder that wraps cannot alias it onto live SRAM.
+ */
+static uint8_t ram_ext_probe(void)
+{
+    volatile uint32_t *w = (volatile uint32_t *)RAM_EXT_BASE;
+    uint32_t actlr = mmio_read32(SCB_ACTLR);
+    uint32_t ccr = mmio_read32(SCB_CCR);
+    uint8_t ok = 1u;
+
+    __asm__ volatile("cpsid f" ::: "memory");
+    mmio_write32(SCB_ACTLR, actlr | SCB_ACTLR_DISDEFWBUF);
+    mmio_write32(SCB_CCR, ccr | SCB_CCR_BFHFNMIGN);
+    mmio_write32(SCB_CFSR, SCB_CFSR_BFSR_MASK);
+    mmio_dsb();
+    mmio_isb();
+    for (uint32_t pattern = 0x5AA5C33Cu, n = 0; n < 2u; ++n, pattern = ~pattern)
+    {
+        *w = pattern;
+        mmio_dsb();
+        if (*w != pattern)
+            ok = 0u;
+    }
+    if (mmio_read32(SCB_CFSR) & SCB_CFSR_BFSR_MASK)
+        ok = 0u;
+    mmio_write32(SCB_CFSR, SCB_CFSR_BFSR_MASK);
+    mmio_write32(SCB_CCR, ccr);
+    mmio_write32(SCB_ACTLR, actlr);
+    mmio_dsb();
+    mmio_isb();
+    __asm__ volatile("cpsie f" ::: "memory");
+    return ok;
+}
+#endif
+
+void platform_ram_ext_init(void)
+{
+    g_ram_ext_flags = 0u;
+#if !defined(HOST_TEST)
+    if (!usd_eopb0_224k())
+        return;
+    g_ram_ext_flags = RAM_EXT_F_CONFIGURED;
+    if (ram_ext_probe())
+        g_ram_ext_flags |= RAM_EXT_F_ACTIVE;
+#endif
+}
+
+#if !defined(HOST_TEST)
+static uint8_t flash_wait(void)
+{
+    for (uint32_t spin = 0; spin < FLASH_WAIT_SPINS; ++spin)
+    {
+        uint32_t sts = mmio_read32(FLASH_STS);
+        if (sts & FLASH_STS_OBF)
+            continue;
+        mmio_write32(FLASH_STS, FLASH_STS_ODF | FLASH_STS_PRGMERR | FLASH_STS_EPPERR);
+        return (sts & (FLASH_STS_PRGMERR | FLASH_STS_EPPERR)) ? 0u : 1u;
+    }
+    return 0u;
+}
+
+static uint8_t usd_rewrite(const uint8_t *val)
+{
+    mmio_write32(FLASH_UNLOCK, FLASH_KEY1);
+    mmio_write32(FLASH_UNLOCK, FLASH_KEY2);
+    mmio_write32(FLASH_USD_UNLOCK, FLASH_KEY1);
+    mmio_write32(FLASH_USD_UNLOCK, FLASH_KEY2);
+    if ((mmio_read32(FLASH_CTRL) & FLASH_CTRL_USDULKS) == 0u)
+    {
+        mmio_write32(FLASH_CTRL, mmio_read32(FLASH_CTRL) | FLASH_CTRL_OPLK);
+        return 0u;
+    }
+
+    mmio_write32(FLASH_CTRL, mmio_read32(FLASH_CTRL) | FLASH_CTRL_USDERS);
+    mmio_write32(FLASH_CTRL, mmio_read32(FLASH_CTRL) | FLASH_CTRL_ERSTR);
+    uint8_t ok = flash_wait();
+    mmio_write32(FLASH_CTRL, mmio_read32(FLASH_CTRL) & ~FLASH_CTRL_USDERS);
+
+    /* Reprogram even after an erase error: FAP must be 0xA5 again or the
+     * next reset comes up read-protected. The complement byte is generated. */
+    mmio_write32(FLASH_CTRL, mmio_read32(FLASH_CTRL) | FLASH_CTRL_USDPRGM);
+    for (uint32_t i = 0; i < USD_HALFWORDS; ++i)
+    {
+        if (val[i] == 0xFFu)
+            continue;
+        *(volatile uint16_t *)(USD_BASE + 2u * i) = val[i];
+        if (!flash_wait())
+            ok = 0u;
+    }
+    mmio_write32(FLASH_CTRL, mmio_read32(FLASH_CTRL) & ~FLASH_CTRL_USDPRGM);
+    mmio_write32(FLASH_CTRL, mmio_read32(FLASH_CTRL) | FLASH_CTRL_OPLK);
+
+    for (uint32_t i = 0; i < USD_HALFWORDS; ++i)
+    {
+        if (usd_read(i) != val[i])
+            ok = 0u;
+    }
+    return ok;
+}
+#endif
+
+uint8_t platform_ram_ext_configure(uint8_t enable)
+{
+#if defined(HOST_TEST)
+    (void)enable;
+    return RAM_EXT_ERR_FLASH;
+#else
+    /* Clearing protection would mass-erase flash, bootloader included; and an
+     * erased FAP byte reads as protected. Never touch a protected part. */
+    if ((mmio_read32(FLASH_USD) & FLASH_USD_FAP) || usd_read(USD_FAP_IDX) != USD_FAP_OPEN)
+        return RAM_EXT_ERR_PROTECTED;
+
+    uint8_t want = enable ? USD_EOPB0_SRAM_224K : USD_EOPB0_SRAM_96K;
+    if (usd_eopb0_224k() == (enable ? 1u : 0u))
+        return RAM_EXT_OK;
+
+    uint8_t val[USD_HALFWORDS];
+    for (uint32_t i = 0; i < USD_HALFWORDS; ++i)
+        val[i] = usd_read(i);
+    val[USD_EOPB0_IDX] = (uint8_t)((val[USD_EOPB0_IDX] & ~0x01u) | (want & 0x01u));
+
+    disable_irqs();
+    uint8_t ok = usd_rewrite(val);
+    enable_irqs();
+    if (!ok)
+        return RAM_EXT_ERR_FLASH;
+    /* Active state is fixed at boot; only the configured bit follows EOPB0. */
+    if (enable)
+        g_ram_ext_flags |= RAM_EXT_F_CONFIGURED;
+    else
+        g_ram_ext_flags &= (uint8_t)~RAM_EXT_F_CONFIGURED;
+    return RAM_EXT_OK;
+#endif
+}
@@ -0,0 +1,111 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_RAM_H
+#define OPEN_FIRMWARE_PLATFORM_RAM_H
+
+#include <stdint.h>
+
+/*
+ * SRAM layout and stack high-water mark.
+ *
+ * Reset_Handler paints everything between _ebss and its own frame with
+ * RAM_STACK_PAINT; the main stack grows down from _stack_top into that
+ * region, so the lowest overwritten word is the deepest the stack (MSP, which
+ * ISRs share) has reached since reset. The scan walks up from _ebss and stops
+ * at the first overwritten word, so it costs one read per unused word.
+ */
+
+#define RAM_STACK_PAINT 0xA5A5A5A5u
+
+/*
+ * Extended SRAM bank. EOPB0 bit0 = 0 in the user system data maps another
+ * 128 KB after the default 96 KB; it takes effect at the next reset. The
+ * stack stays at the top of the first 96 KB (the OEM bootloader checks
+ * SP & 0x2FFE0000 == 0x20000000), so the extension only holds NOLOAD buffers
+ * tagged RAM_EXT. Nothing is reset-zeroed there, and the same image must run
+ * without it: owners check platform_ram_ext_available() and fall back to a
+ * smaller buffer in the default bank.
+ */
+#define RAM_EXT_BASE 0x20018000u
+#define RAM_EXT_SIZE 0x00020000u
+#define RAM_EXT __attribute__((section(".ram_ext")))
+
+/*
+ * Code that runs from SRAM. The internal flash adds wait states at full HCLK,
+ * and beyond the first 256 KB it is slower still; functions tagged RAMFUNC
+ * are linked into .ramfunc (part of the .data image, so Reset_Handler's copy
+ * loop loads them) and always fetch at zero wait state. noinline keeps a
+ * tagged function from being folded back into a flash-resident caller; calls
+ * between flash and SRAM go through linker veneers. Reserve it for loops
+ * whose timing matters: every byte comes out of the default bank.
+ */
+#if defined(HOST_TEST)
+#define RAMFUNC
+#else
+#define RAMFUNC __attribute__((section(".ramfunc"), noinline))
+#endif
+
+/*
+ * State that must survive a warm reset (fault, watchdog, software reset).
+ * .noinit sits between .data and .bss in the default bank: Reset_Handler
+ * neither copies nor zeroes it, and it is below _ebss, so the stack paint
+ * leaves it alone too. After power-on it holds garbage; owners validate it
+ * (a magic word) before trusting it.
+ */
+#if defined(HOST_TEST)
+#define NOINIT
+#else
+#define NOINIT __attribute__((section(".noinit")))
+#endif
+
+/*
+ * Default-bank buffers that their owners write before they read: rings and
+ * histories bounded by their own counters, caches behind a valid tag, flash
+ * page buffers filled before they are programmed. They link into .noinit
+ * after the NOINIT state, so Reset_Handler spends no time zeroing them; unlike
+ * NOINIT, nothing expects their contents to survive. The counters and tags
+ * that make them safe stay in .bss, so tag an array, not the struct that
+ * holds its bookkeeping.
+ */
+#if defined(HOST_TEST)
+#define RAM_NOZERO
+#else
+#define RAM_NOZERO __attribute__((section(".noinit.nozero")))
+#endif
+
+#define RAM_EXT_F_CONFIGURED 0x01u  /* EOPB0 selects 224 KB (from next reset) */
+#define RAM_EXT_F_ACTIVE     0x02u  /* extension mapped and usable this boot */
+
+#define RAM_EXT_OK             0x00u
+#define RAM_EXT_ERR_PROTECTED  0xF0u  /* flash access protection is on; USD left alone */
+#define RAM_EXT_ERR_FLASH      0xF1u  /* erase/program error or verify mismatch */
+
+typedef struct {
+    uint32_t sram_bytes;       /* SRAM span used by the image: _sdata .. _stack_top */
+    uint32_t data_bytes;       /* includes ramfunc_bytes */
+    uint32_t bss_bytes;
+    uint32_t stack_bytes;      /* _ebss .. _stack_top */
+    uint32_t stack_peak;       /* deepest use since reset */
+    uint32_t stack_boot_peak;  /* deepest use when the main loop started */
+    uint32_t stack_now;        /* _stack_top - current SP */
+    uint8_t ext_flags;         /* RAM_EXT_F_* */
+    uint32_t ext_used;         /* bytes placed in .ram_ext */
+    uint32_t ramfunc_bytes;    /* RAMFUNC code copied to SRAM */
+    uint32_t noinit_bytes;     /* NOINIT + RAM_NOZERO, skipped at reset */
+} ram_stats_t;
+
+/* Words from `lo` up to `hi` (exclusive) that still hold the paint. */
+uint32_t ram_paint_unused_words(const uint32_t *lo, const uint32_t *hi);
+
+/* Records stack_boot_peak; call once when init hands over to the main loop. */
+void platform_ram_mark_boot(void);
+void platform_ram_get_stats(ram_stats_t *out);
+
+/* Reads EOPB0 and, when it selects 224 KB, probes the bank with bus faults
+ * masked. Call early in main(), before any RAM_EXT owner initializes. */
+void platform_ram_ext_init(void);
+uint8_t platform_ram_ext_available(void);
+/* Rewrites the user system data with EOPB0 for 224 KB (enable) or 96 KB,
+ * preserving every other byte; takes effect at the next reset. Returns
+ * RAM_EXT_OK or RAM_EXT_ERR_*. */
+uint8_t platform_ram_ext_configure(uint8_t enable);
+
+#endif
@@ -1,12 +1,23 @@
 #include "platform/time.h"
 
 #include "platform/clock.h"
+#include "platform/cpu.h"
 #include "platform/hw.h"
+#include "platform/irq_load.h"
 #include "platform/mmio.h"
+#include "platform/nvic.h"
 #include "src/motor/motor_isr.h"
+#include "src/telemetry/tlm_sampler.h"
+
+#define TIM2_IRQN 28u
+#define TIM2_PSC 71u    /* 1 MHz */
+#define TIM2_ARR 4999u
+#define TIM2_TICK_MS 5u
 
 volatile uint32_t g_ms;
 static volatile uint8_t g_motor_isr_ready;
+static volatile uint8_t g_tim2_irq_seen;
+static uint32_t g_cycles_per_us = 1u;
 
 void SysTick_Handler(void)
 {
@@ -16,16 +27,27 @@ void SysTick_Handler(void)
 /* AT32 naming convention: TMR2_GLOBAL_IRQHandler (was TIM2_IRQHandler on STM32) */
 void TMR2_GLOBAL_IRQHandler(void)
 {
+    uint32_t late_us = mmio_read32(TIM_CNT(TIM2_BASE));
+    platform_irq_span_t span;
+    platform_irq_load_enter_late(&span, late_us * g_cycles_per_us);
     uint32_t sr = mmio_read32(TIM_SR(TIM2_BASE));
     uint32_t dier = mmio_read32(TIM_DIER(TIM2_BASE));
     if ((sr & 1u) && (dier & 1u))
     {
         /* Clear UIF by writing inverted mask (OEM pattern). */
         mmio_write32(TIM_SR(TIM2_BASE), ~1u);
-        g_ms += 5u;
+        g_ms += TIM2_TICK_MS;
+        g_tim2_irq_seen = 1u;
         if (g_motor_isr_ready)
             motor_isr_tick(g_ms);
+        tlm_sampler_isr_tick(g_ms);
     }
+    platform_irq_load_exit(PLATFORM_IRQ_SRC_TIM2, &span);
+}
+
+uint8_t platform_time_irq_live(void)
+{
+    return g_tim2_irq_seen;
 }
 
 void platform_time_poll_1ms(void)
@@ -41,9 +63,10 @@ void platform_time_poll_1ms(void)
     if ((sr & 1u) && (mmio_read32(TIM_DIER(TIM2_BASE)) & 1u))
     {
         mmio_write32(TIM_SR(TIM2_BASE), ~1u);
-        g_ms += 5u;
+        g_ms += TIM2_TICK_MS;
         if (g_motor_isr_ready)
             motor_isr_tick(g_ms);
+        tlm_sampler_isr_tick(g_ms);
     }
 }
 
@@ -52,6 +75,44 @@ void platform_motor_isr_enable(void)
     g_motor_isr_ready = 1u;
 }
 
+void platform_cycle_counter_init(void)
+{
+    uint32_t mhz = rcc_get_hclk_hz_fallback() / 1000000u;
+    g_cycles_per_us = mhz ? mhz : 1u;
+    mmio_write32(DEMCR, mmio_read32(DEMCR) | DEMCR_TRCENA);
+    if ((mmio_read32(DWT_CTRL) & DWT_CTRL_CYCCNTENA) == 0u)
+    {
+        mmio_write32(DWT_CYCCNT, 0u);
+        mmio_write32(DWT_CTRL, mmio_read32(DWT_CTRL) | DWT_CTRL_CYCCNTENA);
+    }
+}
+
+uint32_t platform_cycles_now(void)
+{
+    return mmio_read32(DWT_CYCCNT);
+}
+
+uint32_t platform_cycles_to_us(uint32_t cycles)
+{
+    return cycles / g_cycles_per_us;
+}
+
+uint32_t platform_time_us(void)
+{
+    uint32_t primask = irq_save();
+    uint32_t ms = g_ms;
+    uint32_t cnt = mmio_read32(TIM_CNT(TIM2_BASE));
+    /* Wrapped, but not yet counted into g_ms: the count may be from either
+     * side of the wrap, so read it again. */
+    if (mmio_read32(TIM_SR(TIM2_BASE)) & 1u)
+    {
+        cnt = mmio_read32(TIM_CNT(TIM2_BASE));
+        ms += TIM2_TICK_MS;
+    }
+    irq_restore(primask);
+    return ms * 1000u + cnt;
+}
+
 void platform_timebase_init_oem(void)
 {
     /* Disable SysTick; OEM app uses TIM2 as the time base. */
@@ -64,25 +125,18 @@ void platform_timebase_init_oem(void)
     mmio_write32(RCC_APB1RSTR, rstr | (1u << 0));
     mmio_write32(RCC_APB1RSTR, rstr & ~(1u << 0));
 
-    /* OEM init: PSC=35999, ARR=9 => 200Hz tick (~5ms) at 72MHz timer clock. */
-    mmio_write32(TIM_PSC(TIM2_BASE), 35999u);
-    mmio_write32(TIM_ARR(TIM2_BASE), 9u);
+    /* 200 Hz tick (5 ms) at the 72 MHz timer clock, as the OEM's PSC=35999,
+     * ARR=9, but counting in us: CNT at handler entry is the entry latency. */
+    mmio_write32(TIM_PSC(TIM2_BASE), TIM2_PSC);
+    mmio_write32(TIM_ARR(TIM2_BASE), TIM2_ARR);
     mmio_write32(TIM_CNT(TIM2_BASE), 0u);
     mmio_write32(TIM_SR(TIM2_BASE), ~1u);
     mmio_write32(TIM_DIER(TIM2_BASE), mmio_read32(TIM_DIER(TIM2_BASE)) | 1u);
     mmio_write32(TIM_EGR(TIM2_BASE), 1u);
     mmio_write32(TIM_CR1(TIM2_BASE), mmio_read32(TIM_CR1(TIM2_BASE)) | 1u);
 
-    /* NVIC enable for IRQ28 (TIM2) with OEM-style priority (0xA0). */
-    mmio_write32(NVIC_ISER0, mmio_read32(NVIC_ISER0) | (1u << 28));
-    {
-        const uint32_t addr = NVIC_IPR_BASE + 28u;
-        const uint32_t word = addr & ~0x3u;
-        const uint32_t shift = (addr & 0x3u) * 8u;
-        uint32_t v = mmio_read32(word);
-        v = (v & ~(0xFFu << shift)) | (0xA0u << shift);
-        mmio_write32(word, v);
-    }
+    /* The OEM ran TIM2 at 0xA0, under the flash DMA; see platform/nvic.h. */
+    platform_nvic_enable(TIM2_IRQN, PLATFORM_PRIO_TIM2);
 
     /* Ensure NVIC writes complete before ISR can fire. */
     mmio_dsb();
@@ -7,7 +7,21 @@
 extern volatile uint32_t g_ms;
 
 void platform_time_poll_1ms(void);
+/* Non-zero once the TIM2 interrupt (not the poll) has advanced g_ms, i.e. a
+ * WFI is guaranteed to wake within one tick. */
+uint8_t platform_time_irq_live(void);
 void platform_timebase_init_oem(void);
 void platform_motor_isr_enable(void);
 
+/* Free-running DWT cycle counter for sub-ms timestamps. Differences are valid
+ * across wrap for spans under 2^32 cycles (~35 s at 120 MHz). */
+void platform_cycle_counter_init(void);
+uint32_t platform_cycles_now(void);
+uint32_t platform_cycles_to_us(uint32_t cycles);
+
+/* Device time in us since boot: g_ms plus the TIM2 count within its tick.
+ * Wraps at 2^32 (~71 min) without a jump, so differences stay valid. This
+ * is the timebase the comm protocol stamps frames with (0x1B time_sync). */
+uint32_t platform_time_us(void);
+
 #endif
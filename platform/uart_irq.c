@@ -1,14 +1,30 @@
 #include "drivers/uart.h"
 #include "platform/hw.h"
+#include "platform/irq_load.h"
+#include "platform/uart_rx_dma.h"
+#include "platform/uart_tx_dma.h"
 
 #if !defined(HOST_TEST)
 void USART1_IRQHandler(void)
 {
+    platform_irq_span_t span;
+    platform_irq_load_enter(&span);
     uart_isr_rx_drain(UART1_BASE);
+    uart_isr_tx(UART1_BASE);
+    platform_irq_load_exit(PLATFORM_IRQ_SRC_USART1, &span);
 }
 
 void USART2_IRQHandler(void)
 {
-    uart_isr_rx_drain(UART2_BASE);
+    platform_irq_span_t span;
+    platform_irq_load_enter(&span);
+    if (platform_uart2_tx_dma_active())
+        platform_uart2_tx_dma_usart_irq();
+    /* With RX on DMA1 CH6 only IDLE/ORE arrive here. */
+    if (platform_uart2_rx_dma_active())
+        platform_uart2_rx_dma_usart_irq();
+    else
+        uart_isr_rx_drain(UART2_BASE);
+    platform_irq_load_exit(PLATFORM_IRQ_SRC_USART2, &span);
 }
 #endif
@@ -0,0 +1,142 @@
+#include "platform/uart_rx_dma.h"
+
+#include "platform/dma.h"
+#include "platform/hw.h"
+#include "platform/mmio.h"
+#include "platform/time.h"
+#include "src/bus/bus.h"
+#include "src/motor/motor_isr.h"
+
+#define DMA_CCR(ch) ((ch) + 0x00u)
+#define DMA_CNDTR(ch) ((ch) + 0x04u)
+#define DMA_CPAR(ch) ((ch) + 0x08u)
+#define DMA_CMAR(ch) ((ch) + 0x0Cu)
+
+#define DMA_CCR_EN (1u << 0)
+#define DMA_CCR_TCIE (1u << 1)
+#define DMA_CCR_HTIE (1u << 2)
+#define DMA_CCR_TEIE (1u << 3)
+#define DMA_CCR_CIRC (1u << 5)
+#define DMA_CCR_MINC (1u << 7)
+
+#define UART_SR_ORE (1u << 3)
+#define UART_SR_IDLE (1u << 4)
+#define UART_CR1_IDLEIE (1u << 4)
+#define UART_CR1_RXNEIE (1u << 5)
+#define UART_CR3_DMAR (1u << 6)
+
+#define UART2_RX_DMA_BUF_LEN 256u
+
+static uint8_t g_uart2_rx_dma_buf[UART2_RX_DMA_BUF_LEN];
+static uint16_t g_uart2_rx_dma_tail;
+static volatile uint8_t g_uart2_rx_dma_active;
+static platform_uart_rx_dma_stats_t g_uart2_rx_dma_stats;
+
+#if !defined(HOST_TEST)
+static void uart2_rx_dma_deliver(uint16_t from, uint16_t len, uint32_t now_ms)
+{
+    if (!len)
+        return;
+    g_uart2_rx_dma_stats.bytes += len;
+    bus_session_rx(BUS_MOTOR, &g_uart2_rx_dma_buf[from], len);
+    motor_isr_rx_bytes(&g_uart2_rx_dma_buf[from], len, now_ms);
+}
+
+static void uart2_rx_dma_drain(void)
+{
+    uint32_t remaining = mmio_read32(DMA_CNDTR(platform_dma_ch(PLATFORM_DMA_MOTOR_RX))) & 0xFFFFu;
+    uint16_t head = (uint16_t)(UART2_RX_DMA_BUF_LEN - remaining);
+    if (head >= UART2_RX_DMA_BUF_LEN)
+        head = 0u; /* CNDTR reads 0 for an instant before the circular reload */
+    uint16_t tail = g_uart2_rx_dma_tail;
+    if (head == tail)
+        return;
+
+    uint32_t now_ms = g_ms;
+    if (head > tail)
+    {
+        uart2_rx_dma_deliver(tail, (uint16_t)(head - tail), now_ms);
+    }
+    else
+    {
+        uart2_rx_dma_deliver(tail, (uint16_t)(UART2_RX_DMA_BUF_LEN - tail), now_ms);
+        uart2_rx_dma_deliver(0u, head, now_ms);
+    }
+    g_uart2_rx_dma_tail = head;
+    g_uart2_rx_dma_stats.bursts++;
+}
+
+static void uart2_rx_dma_irq(void *ctx, uint32_t flags)
+{
+    (void)ctx;
+    if (flags & PLATFORM_DMA_F_TE)
+    {
+        /* A transfer error disables the channel; fall back to RXNE interrupts. */
+        g_uart2_rx_dma_active = 0u;
+        mmio_write32(UART_CR3(UART2_BASE), mmio_read32(UART_CR3(UART2_BASE)) & ~UART_CR3_DMAR);
+        uint32_t cr1 = mmio_read32(UART_CR1(UART2_BASE)) & ~UART_CR1_IDLEIE;
+        mmio_write32(UART_CR1(UART2_BASE), cr1 | UART_CR1_RXNEIE);
+    }
+    /* HT/TC or a pend from the IDLE interrupt: hand over whatever has landed. */
+    uart2_rx_dma_drain();
+}
+#endif
+
+void platform_uart2_rx_dma_init(void)
+{
+    if (g_uart2_rx_dma_active)
+        return;
+    g_uart2_rx_dma_tail = 0u;
+#if !defined(HOST_TEST)
+    platform_dma_attach(PLATFORM_DMA_MOTOR_RX, uart2_rx_dma_irq, 0);
+    uint32_t ch = platform_dma_ch(PLATFORM_DMA_MOTOR_RX);
+    mmio_write32(DMA_CCR(ch), 0u);
+    mmio_write32(DMA_CPAR(ch), UART_DR(UART2_BASE));
+    mmio_write32(DMA_CMAR(ch), (uint32_t)g_uart2_rx_dma_buf);
+    mmio_write32(DMA_CNDTR(ch), UART2_RX_DMA_BUF_LEN);
+    /* Peripheral -> memory (DIR=0), 8-bit both sides, circular. */
+    mmio_write32(DMA_CCR(ch),
+                 platform_dma_pl(PLATFORM_DMA_MOTOR_RX) | DMA_CCR_MINC | DMA_CCR_CIRC |
+                 DMA_CCR_TEIE | DMA_CCR_HTIE | DMA_CCR_TCIE);
+
+    /* Swap the per-byte RXNE interrupt for DMA requests plus IDLE. */
+    uint32_t cr1 = mmio_read32(UART_CR1(UART2_BASE)) & ~UART_CR1_RXNEIE;
+    mmio_write32(UART_CR1(UART2_BASE), cr1);
+    (void)mmio_read32(UART_SR(UART2_BASE));
+    (void)mmio_read32(UART_DR(UART2_BASE));
+    mmio_write32(DMA_CCR(ch), mmio_read32(DMA_CCR(ch)) | DMA_CCR_EN);
+    mmio_write32(UART_CR3(UART2_BASE), mmio_read32(UART_CR3(UART2_BASE)) | UART_CR3_DMAR);
+    g_uart2_rx_dma_active = 1u;
+    mmio_write32(UART_CR1(UART2_BASE), cr1 | UART_CR1_IDLEIE);
+#endif
+}
+
+uint8_t platform_uart2_rx_dma_active(void)
+{
+    return g_uart2_rx_dma_active;
+}
+
+void platform_uart2_rx_dma_usart_irq(void)
+{
+#if !defined(HOST_TEST)
+    uint32_t sr = mmio_read32(UART_SR(UART2_BASE));
+    if ((sr & (UART_SR_IDLE | UART_SR_ORE)) == 0u)
+        return;
+    /* SR then DR read clears IDLE/ORE; the DMA has already taken every data byte. */
+    (void)mmio_read32(UART_DR(UART2_BASE));
+    if (sr & UART_SR_ORE)
+        g_uart2_rx_dma_stats.overruns++;
+    if (sr & UART_SR_IDLE)
+    {
+        g_uart2_rx_dma_stats.idle_irqs++;
+        /* USART2 sits above TIM2; drain at the DMA IRQ's (TIM2) priority instead. */
+        platform_dma_pend(PLATFORM_DMA_MOTOR_RX);
+    }
+#endif
+}
+
+void platform_uart2_rx_dma_stats(platform_uart_rx_dma_stats_t *out)
+{
+    if (out)
+        *out = g_uart2_rx_dma_stats;
+}
@@ -0,0 +1,29 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_UART_RX_DMA_H
+#define OPEN_FIRMWARE_PLATFORM_UART_RX_DMA_H
+
+#include <stdint.h>
+
+/*
+ * Motor UART2 receive via DMA1 CH6 in circular mode.
+ *
+ * The DMA ring is drained on half/full-transfer and on the USART2 IDLE line
+ * (one character time after the last byte of a burst), and each burst is handed
+ * to motor_isr_rx_bytes(). Draining runs from the DMA1 CH6 IRQ at the TIM2
+ * priority, so it never interleaves with motor_isr_tick().
+ */
+void platform_uart2_rx_dma_init(void);
+uint8_t platform_uart2_rx_dma_active(void);
+
+/* Called from USART2_IRQHandler while DMA receive is active. */
+void platform_uart2_rx_dma_usart_irq(void);
+
+typedef struct {
+    uint32_t bursts;    /* drains that delivered bytes */
+    uint32_t bytes;
+    uint32_t idle_irqs;
+    uint32_t overruns;  /* USART ORE flags seen */
+} platform_uart_rx_dma_stats_t;
+
+void platform_uart2_rx_dma_stats(platform_uart_rx_dma_stats_t *out);
+
+#endif
@@ -0,0 +1,109 @@
+#include "platform/uart_tx_dma.h"
+
+#include "platform/dma.h"
+#include "platform/hw.h"
+#include "platform/mmio.h"
+#include "platform/time.h"
+#include "src/motor/motor_isr.h"
+
+#define DMA_CCR(ch) ((ch) + 0x00u)
+#define DMA_CNDTR(ch) ((ch) + 0x04u)
+#define DMA_CPAR(ch) ((ch) + 0x08u)
+#define DMA_CMAR(ch) ((ch) + 0x0Cu)
+
+#define DMA_CCR_EN (1u << 0)
+#define DMA_CCR_TEIE (1u << 3)
+#define DMA_CCR_DIR (1u << 4)
+#define DMA_CCR_MINC (1u << 7)
+
+#define UART_SR_TC (1u << 6)
+#define UART_CR1_TCIE (1u << 6)
+#define UART_CR3_DMAT (1u << 7)
+
+static uint8_t g_uart2_tx_dma_active;
+static volatile uint8_t g_uart2_tx_dma_busy;
+
+#if !defined(HOST_TEST)
+static void uart2_tx_dma_stop(void)
+{
+    mmio_write32(UART_CR1(UART2_BASE), mmio_read32(UART_CR1(UART2_BASE)) & ~UART_CR1_TCIE);
+    uint32_t ch = platform_dma_ch(PLATFORM_DMA_MOTOR_TX);
+    mmio_write32(DMA_CCR(ch), mmio_read32(DMA_CCR(ch)) & ~DMA_CCR_EN);
+}
+
+static void uart2_tx_dma_irq(void *ctx, uint32_t flags)
+{
+    (void)ctx;
+    if (flags & PLATFORM_DMA_F_TE)
+        uart2_tx_dma_stop();
+    /* TE, or a pend from the USART TC interrupt. */
+    if (!g_uart2_tx_dma_busy)
+        return;
+    g_uart2_tx_dma_busy = 0u;
+    platform_dma_busy_end(PLATFORM_DMA_MOTOR_TX);
+    motor_isr_tx_done(g_ms);
+}
+#endif
+
+void platform_uart2_tx_dma_init(void)
+{
+    if (g_uart2_tx_dma_active)
+        return;
+#if !defined(HOST_TEST)
+    platform_dma_attach(PLATFORM_DMA_MOTOR_TX, uart2_tx_dma_irq, 0);
+    uint32_t ch = platform_dma_ch(PLATFORM_DMA_MOTOR_TX);
+    mmio_write32(DMA_CPAR(ch), UART_DR(UART2_BASE));
+    /* Memory -> peripheral (DIR=1), 8-bit both sides. */
+    mmio_write32(DMA_CCR(ch), platform_dma_pl(PLATFORM_DMA_MOTOR_TX) | DMA_CCR_MINC | DMA_CCR_DIR | DMA_CCR_TEIE);
+
+    mmio_write32(UART_CR3(UART2_BASE), mmio_read32(UART_CR3(UART2_BASE)) | UART_CR3_DMAT);
+    g_uart2_tx_dma_active = 1u;
+#endif
+}
+
+uint8_t platform_uart2_tx_dma_active(void)
+{
+    return g_uart2_tx_dma_active;
+}
+
+uint8_t platform_uart2_tx_dma_busy(void)
+{
+    return g_uart2_tx_dma_busy;
+}
+
+uint8_t platform_uart2_tx_dma_start(const uint8_t *data, uint16_t len)
+{
+    if (!g_uart2_tx_dma_active || g_uart2_tx_dma_busy || !data || len == 0u)
+        return 0u;
+#if !defined(HOST_TEST)
+    uint32_t ch = platform_dma_ch(PLATFORM_DMA_MOTOR_TX);
+    g_uart2_tx_dma_busy = 1u;
+    mmio_write32(DMA_CCR(ch), mmio_read32(DMA_CCR(ch)) & ~DMA_CCR_EN);
+    platform_dma_clear(PLATFORM_DMA_MOTOR_TX);
+    mmio_write32(DMA_CMAR(ch), (uint32_t)data);
+    mmio_write32(DMA_CNDTR(ch), len);
+    /* TC is rc_w0; clear it so the interrupt marks the end of this frame. */
+    mmio_write32(UART_SR(UART2_BASE), ~UART_SR_TC);
+    platform_dma_busy_begin(PLATFORM_DMA_MOTOR_TX);
+    mmio_write32(DMA_CCR(ch), mmio_read32(DMA_CCR(ch)) | DMA_CCR_EN);
+    mmio_write32(UART_CR1(UART2_BASE), mmio_read32(UART_CR1(UART2_BASE)) | UART_CR1_TCIE);
+    return 1u;
+#else
+    return 0u;
+#endif
+}
+
+void platform_uart2_tx_dma_usart_irq(void)
+{
+#if !defined(HOST_TEST)
+    if (!g_uart2_tx_dma_busy)
+        return;
+    if ((mmio_read32(UART_SR(UART2_BASE)) & UART_SR_TC) == 0u)
+        return;
+    if (mmio_read32(DMA_CNDTR(platform_dma_ch(PLATFORM_DMA_MOTOR_TX))) & 0xFFFFu)
+        return; /* idle gap between DMA writes, not the end of the frame */
+    uart2_tx_dma_stop();
+    mmio_write32(UART_SR(UART2_BASE), ~UART_SR_TC);
+    platform_dma_pend(PLATFORM_DMA_MOTOR_TX);
+#endif
+}
@@ -0,0 +1,24 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_UART_TX_DMA_H
+#define OPEN_FIRMWARE_PLATFORM_UART_TX_DMA_H
+
+#include <stdint.h>
+
+/*
+ * Motor UART2 transmit via DMA1 CH7 (memory -> USART2 DR).
+ *
+ * One frame is in flight at a time. Completion is taken from the USART TC
+ * flag (last stop bit on the wire), not the DMA TC, and is reported to
+ * motor_isr_tx_done() from the DMA1 CH7 IRQ at the TIM2 priority.
+ * The source buffer must stay untouched until then.
+ */
+void platform_uart2_tx_dma_init(void);
+uint8_t platform_uart2_tx_dma_active(void);
+uint8_t platform_uart2_tx_dma_busy(void);
+
+/* Returns 1 if the transfer was started, 0 if busy/inactive. */
+uint8_t platform_uart2_tx_dma_start(const uint8_t *data, uint16_t len);
+
+/* Called from USART2_IRQHandler while DMA transmit is active. */
+void platform_uart2_tx_dma_usart_irq(void);
+
+#endif
@@ -0,0 +1,87 @@
+#include "platform/watchdog.h"
+
+#include "platform/hw.h"
+#include "platform/mmio.h"
+#include "platform/time.h"
+#include "src/kernel/scheduler.h"
+
+static struct
+{
+    uint8_t started;
+    uint32_t last_feed_cycles;
+    watchdog_stats_t stats;
+} g_wdt;
+
+void watchdog_start_runtime(void)
+{
+    mmio_write32(IWDG_KR, IWDG_KR_UNLOCK);
+    mmio_write32(IWDG_PR, WATCHDOG_PRESCALER_CODE);
+    mmio_write32(IWDG_RLR, WATCHDOG_RELOAD);
+    mmio_write32(IWDG_KR, IWDG_KR_START);
+    mmio_write32(IWDG_KR, IWDG_KR_FEED);
+    g_wdt.started = 1u;
+    g_wdt.last_feed_cycles = platform_cycles_now();
+    g_wdt.stats.timeout_ms = WATCHDOG_TIMEOUT_MS;
+}
+
+void watchdog_feed_runtime(void)
+{
+    mmio_write32(IWDG_KR, IWDG_KR_FEED);
+    if (!g_wdt.started)
+        return;
+    uint32_t now = platform_cycles_now();
+    uint32_t gap = platform_cycles_to_us(now - g_wdt.last_feed_cycles);
+    g_wdt.last_feed_cycles = now;
+    g_wdt.stats.feeds++;
+    if (gap > g_wdt.stats.max_gap_us)
+        g_wdt.stats.max_gap_us = gap;
+}
+
+void watchdog_budget_begin(watchdog_budget_t *b, uint32_t budget_us)
+{
+    if (!b)
+        return;
+    b->start_cycles = platform_cycles_now();
+    b->budget_us = (budget_us && budget_us < WATCHDOG_BUDGET_MAX_US) ? budget_us : WATCHDOG_BUDGET_MAX_US;
+    b->spent = 0u;
+    g_wdt.stats.budgets++;
+}
+
+uint8_t watchdog_budget_poll(watchdog_budget_t *b)
+{
+    if (!b || b->spent)
+        return 0u;
+    uint32_t used = platform_cycles_to_us(platform_cycles_now() - b->start_cycles);
+    if (used > g_wdt.stats.max_budget_us)
+        g_wdt.stats.max_budget_us = used;
+    if (used >= b->budget_us)
+    {
+        b->spent = 1u;
+        g_wdt.stats.overruns++;
+        return 0u;
+    }
+    watchdog_feed_runtime();
+    return 1u;
+}
+
+uint32_t watchdog_budget_left_us(const watchdog_budget_t *b)
+{
+    if (!b || b->spent)
+        return 0u;
+    uint32_t used = platform_cycles_to_us(platform_cycles_now() - b->start_cycles);
+    uint32_t left = (used < b->budget_us) ? b->budget_us - used : 0u;
+    uint32_t slice = scheduler_slice_left_us();
+    return (slice < left) ? slice : left;
+}
+
+void watchdog_get_stats(watchdog_stats_t *out)
+{
+    if (out)
+        *out = g_wdt.stats;
+}
+
+void watchdog_reset_stats(void)
+{
+    g_wdt.stats = (watchdog_stats_t){.timeout_ms = g_wdt.started ? WATCHDOG_TIMEOUT_MS : 0u};
+    g_wdt.last_feed_cycles = platform_cycles_now();
+}
@@ -0,0 +1,60 @@
+#ifndef OPEN_FIRMWARE_PLATFORM_WATCHDOG_H
+#define OPEN_FIRMWARE_PLATFORM_WATCHDOG_H
+
+#include <stdint.h>
+
+/*
+ * Independent watchdog (IWDG) and long-operation budgets.
+ *
+ * The main loop feeds once per pass. Code that blocks for longer than a pass
+ * (SPI flash erase/program waits, flushing the flash job queue, full-image
+ * CRCs) runs under a budget instead of feeding on its own: each
+ * watchdog_budget_poll() between steps feeds while the budget lasts and
+ * returns 0 once it is spent. Bounded waits give up at that point; waits
+ * that must finish keep spinning unfed, so a hang resets within one budget
+ * plus one watchdog period instead of never. Budgets are capped at half the
+ * period.
+ *
+ * Work that can be split checks watchdog_budget_left_us(), which inside a
+ * scheduler job is also bounded by the job's remaining interval, and yields
+ * or stops once it gets small.
+ *
+ * Every feed records the gap since the previous one; the largest gap is the
+ * closest the firmware has come to a watchdog reset.
+ */
+
+/* LSI is nominally 40 kHz (30..60 kHz across parts); /64 gives 625 Hz. */
+#define WATCHDOG_TIMEOUT_MS 4000u
+#define WATCHDOG_PRESCALER_CODE 0x4u /* /64 */
+#define WATCHDOG_RELOAD ((WATCHDOG_TIMEOUT_MS * 625u) / 1000u)
+#define WATCHDOG_BUDGET_MAX_US ((WATCHDOG_TIMEOUT_MS / 2u) * 1000u)
+
+typedef struct {
+    uint32_t start_cycles;
+    uint32_t budget_us;
+    uint8_t spent;
+} watchdog_budget_t;
+
+typedef struct {
+    uint32_t timeout_ms;
+    uint32_t feeds;
+    uint32_t max_gap_us;       /* longest time between two feeds */
+    uint32_t budgets;          /* budgeted operations started */
+    uint32_t overruns;         /* budgets that ran out */
+    uint32_t max_budget_us;    /* longest time seen inside one budget */
+} watchdog_stats_t;
+
+/* Starts the IWDG (it cannot be stopped again until reset). */
+void watchdog_start_runtime(void);
+void watchdog_feed_runtime(void);
+
+void watchdog_budget_begin(watchdog_budget_t *b, uint32_t budget_us);
+/* Feeds and returns 1 while the budget lasts; 0 (without feeding) after. */
+uint8_t watchdog_budget_poll(watchdog_budget_t *b);
+/* Time left in the budget, further bounded by the running scheduler job. */
+uint32_t watchdog_budget_left_us(const watchdog_budget_t *b);
+
+void watchdog_get_stats(watchdog_stats_t *out);
+void watchdog_reset_stats(void);
+
+#endif
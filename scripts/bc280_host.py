@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""
+ctypes wrapper for libbc280_host, the full host sim as a shared library
+(tests/host/sim/bc280_host.h). Runs, frames and metrics stay in this
+process: no host_sim launches, env files or PPM round trips per step.
+
+Build the library with `ninja -C build-host bc280_host`.
+
+Library use:
+    from bc280_host import Host
+    with Host({"BC280_SIM_RIDER_POWER": 250}) as sim:
+        sim.step(10_000)
+        print(sim.metrics()["frame_hash"])
+        sim.save_ppm("out/dash.ppm")
+
+One context per process: the firmware keeps its state in globals. Close
+one Host before opening the next; a new Host starts from a fresh init.
+
+As a script it renders pages to PPM in one process:
+  scripts/bc280_host.py --pages 0-17 --outdir out/ui_shots
+"""
+
+import argparse
+import ctypes
+import os
+import sys
+import time
+from pathlib import Path
+from typing import Dict, Optional, Union
+
+REPO_ROOT = Path(__file__).resolve().parent.parent
+DEFAULT_LIB = REPO_ROOT / "build-host/tests/host/libbc280_host.so"
+API_VERSION = 1
+
+PORT_BLE = 0
+PORT_MOTOR = 1
+
+
+class Metrics(ctypes.Structure):
+    _fields_ = [
+        ("now_ms", ctypes.c_uint32),
+        ("steps", ctypes.c_uint32),
+        ("ui_frames", ctypes.c_uint32),
+        ("frame_hash", ctypes.c_uint32),
+        ("lcd_avg_us", ctypes.c_uint32),
+        ("lcd_max_us", ctypes.c_uint32),
+        ("lcd_tick_max_us", ctypes.c_uint32),
+        ("energy_mwh", ctypes.c_int32),
+        ("dist_m", ctypes.c_uint32),
+        ("ble_cmds", ctypes.c_uint32),
+        ("speed_dmph", ctypes.c_uint16),
+        ("soc_pct", ctypes.c_uint8),
+        ("failed", ctypes.c_uint8),
+    ]
+
+
+def load_library(path: Optional[str] = None) -> ctypes.CDLL:
+    lib = ctypes.CDLL(str(path or os.environ.get("BC280_HOST_LIB") or DEFAULT_LIB))
+    lib.bc280_host_api_version.restype = ctypes.c_uint32
+    if lib.bc280_host_api_version() != API_VERSION:
+        raise RuntimeError(f"libbc280_host API {lib.bc280_host_api_version()}, wrapper {API_VERSION}")
+    lib.bc280_host_create.restype = ctypes.c_void_p
+    lib.bc280_host_create.argtypes = [ctypes.c_char_p]
+    lib.bc280_host_destroy.argtypes = [ctypes.c_void_p]
+    lib.bc280_host_step.restype = ctypes.c_uint32
+    lib.bc280_host_step.argtypes = [ctypes.c_void_p, ctypes.c_uint32]
+    lib.bc280_host_inject.restype = ctypes.c_size_t
+    lib.bc280_host_inject.argtypes = [ctypes.c_void_p, ctypes.c_uint8, ctypes.c_char_p, ctypes.c_size_t]
+    lib.bc280_host_hold_buttons.argtypes = [ctypes.c_void_p, ctypes.c_uint8]
+    lib.bc280_host_press.argtypes = [ctypes.c_void_p, ctypes.c_uint8]
+    lib.bc280_host_set_page.argtypes = [ctypes.c_void_p, ctypes.c_int]
+    lib.bc280_host_set_ride.argtypes = [ctypes.c_void_p, ctypes.c_double, ctypes.c_double]
+    lib.bc280_host_framebuffer.restype = ctypes.POINTER(ctypes.c_uint16)
+    lib.bc280_host_framebuffer.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint16),
+                                           ctypes.POINTER(ctypes.c_uint16)]
+    lib.bc280_host_metrics.argtypes = [ctypes.c_void_p, ctypes.POINTER(Metrics)]
+    return lib
+
+
+class Host:
+    """One live sim context; config takes the host_sim BC280_SIM_* knobs."""
+
+    _lib: Optional[ctypes.CDLL] = None
+
+    def __init__(self, config: Union[None, str, Dict[str, object]] = None, lib: Optional[str] = None):
+        if Host._lib is None:
+            Host._lib = load_library(lib)
+        self.lib = Host._lib
+        if isinstance(config, dict):
+            config = " ".join(f"{k}={v}" for k, v in config.items())
+        self.h = self.lib.bc280_host_create(config.encode() if config else None)
+        if not self.h:
+            raise RuntimeError("bc280_host_create failed (context already open, or bad knob/scenario)")
+
+    def close(self) -> None:
+        if self.h:
+            self.lib.bc280_host_destroy(self.h)
+            self.h = None
+
+    def __enter__(self) -> "Host":
+        return self
+
+    def __exit__(self, *exc) -> None:
+        self.close()
+
+    def step(self, ms: int) -> int:
+        return self.lib.bc280_host_step(self.h, ms)
+
+    def inject(self, data: bytes, port: int = PORT_BLE) -> int:
+        return self.lib.bc280_host_inject(self.h, port, data, len(data))
+
+    def hold_buttons(self, mask: int) -> None:
+        self.lib.bc280_host_hold_buttons(self.h, mask)
+
+    def press(self, mask: int) -> None:
+        self.lib.bc280_host_press(self.h, mask)
+
+    def set_page(self, page: int) -> None:
+        self.lib.bc280_host_set_page(self.h, page)
+
+    def set_ride(self, power_w: float, grade: float = 0.0) -> None:
+        self.lib.bc280_host_set_ride(self.h, power_w, grade)
+
+    def metrics(self) -> Dict[str, int]:
+        m = Metrics()
+        self.lib.bc280_host_metrics(self.h, ctypes.byref(m))
+        return {name: getattr(m, name) for name, _ in Metrics._fields_}
+
+    def framebuffer(self):
+        """(width, height, RGB565 pixels as a memoryview of uint16)."""
+        w, h = ctypes.c_uint16(), ctypes.c_uint16()
+        fb = self.lib.bc280_host_framebuffer(self.h, ctypes.byref(w), ctypes.byref(h))
+        buf = (ctypes.c_uint16 * (w.value * h.value)).from_address(ctypes.addressof(fb.contents))
+        return w.value, h.value, memoryview(buf).cast("B").cast("H")
+
+    def rgb888(self) -> bytes:
+        w, h, px = self.framebuffer()
+        out = bytearray(w * h * 3)
+        # Same scaling as the sink's PPM writer, so dumps compare byte for byte.
+        for i, v in enumerate(px):
+            out[3 * i] = ((v >> 11) & 0x1F) * 255 // 31
+            out[3 * i + 1] = ((v >> 5) & 0x3F) * 255 // 63
+            out[3 * i + 2] = (v & 0x1F) * 255 // 31
+        return bytes(out)
+
+    def save_ppm(self, path: Union[str, Path]) -> None:
+        w, h, _ = self.framebuffer()
+        Path(path).parent.mkdir(parents=True, exist_ok=True)
+        with open(path, "wb") as f:
+            f.write(f"P6\n{w} {h}\n255\n".encode())
+            f.write(self.rgb888())
+
+
+def parse_pages(spec: str):
+    pages = []
+    for part in spec.split(","):
+        lo, _, hi = part.partition("-")
+        pages.extend(range(int(lo), int(hi or lo) + 1))
+    return pages
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Render UI pages through libbc280_host")
+    ap.add_argument("--lib", help=f"library path (default: $BC280_HOST_LIB or {DEFAULT_LIB})")
+    ap.add_argument("--pages", default="0", help="ui_page_t ids, e.g. 0-17 or 0,4,9")
+    ap.add_argument("--ms", type=int, default=2000, help="sim time before each capture")
+    ap.add_argument("--outdir", default="out/ui_shots", help="PPM output folder")
+    ap.add_argument("--config", default="", help="extra KEY=VALUE knobs")
+    args = ap.parse_args()
+
+    t0 = time.monotonic()
+    pages = parse_pages(args.pages)
+    with Host(args.config or None, args.lib) as sim:
+        for page in pages:
+            sim.set_page(page)
+            sim.step(args.ms)
+            path = Path(args.outdir) / f"page_{page:02d}.ppm"
+            sim.save_ppm(path)
+            m = sim.metrics()
+            print(f"{path} t={m['now_ms']} ms hash={m['frame_hash']:08x} lcd_max_us={m['lcd_max_us']}")
+            if m["failed"]:
+                print("render over budget", file=sys.stderr)
+                return 1
+    print(f"{len(pages)} pages in {time.monotonic() - t0:.2f} s")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
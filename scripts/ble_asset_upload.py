@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Upload a UI asset pack (command 0x5E) holding the icon sprites.
+
+The pack is built by the icon packer:
+  ./scripts/pack_ui_icons.py --pack out/ui_assets.bin
+  ./scripts/ble_asset_upload.py <mac> out/ui_assets.bin
+
+  0x5E op=0 begin
+       op=1 offset[4], data[...]     (sequential)
+       op=2 bytes[4], crc32[4]       (commit; the index is checked too)
+       op=3 -> {ver, len, valid, uploading, count[2], bytes[4], crc32[4], write_offset[4]}
+
+Until a pack commits the display draws its built-in icons.
+
+Frame format: 0x55 | CMD | LEN | PAYLOAD | CHKSUM
+  CHKSUM = bitwise-not XOR of all prior bytes.
+"""
+
+import argparse
+import asyncio
+import binascii
+import sys
+import zlib
+from typing import List
+
+try:
+    from bleak import BleakClient
+except ImportError:
+    print("Install bleak: pip install bleak", file=sys.stderr)
+    sys.exit(1)
+
+NUS_SERVICE = "0000ffe0-0000-1000-8000-00805f9b34fb"
+NUS_RX = "0000ffe9-0000-1000-8000-00805f9b34fb"  # write
+NUS_TX = "0000ffe4-0000-1000-8000-00805f9b34fb"  # notify
+
+CMD_ASSET_UPLOAD = 0x5E
+RESP_ASSET_UPLOAD = CMD_ASSET_UPLOAD | 0x80
+CHUNK = 184
+PACK_MAX = 0x10000 - 0x1000  # storage/layout.h UI_ASSET_STORAGE_BYTES minus the header sector
+
+
+def pack_frame(cmd: int, payload: bytes) -> bytes:
+    if len(payload) > 255:
+        raise ValueError("payload too long")
+    hdr = bytes([0x55, cmd & 0xFF, len(payload) & 0xFF])
+    x = 0
+    for b in hdr + payload:
+        x ^= b
+    cks = (~x) & 0xFF
+    return hdr + payload + bytes([cks])
+
+
+class FrameParser:
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data: bytes) -> List[bytes]:
+        self.buf.extend(data)
+        out = []
+        while len(self.buf) >= 4:
+            if self.buf[0] != 0x55:
+                del self.buf[0]
+                continue
+            frame_len = 4 + self.buf[2]
+            if len(self.buf) < frame_len:
+                break
+            frame = bytes(self.buf[:frame_len])
+            del self.buf[:frame_len]
+            x = 0
+            for b in frame[:-1]:
+                x ^= b
+            if ((~x) & 0xFF) == frame[-1]:
+                out.append(frame)
+        return out
+
+
+async def main():
+    ap = argparse.ArgumentParser(description="Upload a UI asset pack (0x5E asset_upload)")
+    ap.add_argument("mac", help="BLE MAC address (or UUID on macOS/iOS)")
+    ap.add_argument("pack", help="pack file from scripts/pack_ui_icons.py --pack")
+    ap.add_argument("--service", default=NUS_SERVICE, help="UART service UUID")
+    ap.add_argument("--rx", default=NUS_RX, help="UART RX characteristic (write)")
+    ap.add_argument("--tx", default=NUS_TX, help="UART TX characteristic (notify)")
+    ap.add_argument("--timeout", type=float, default=2.0, help="seconds to wait per response")
+    ap.add_argument("-v", "--verbose", action="store_true", help="verbose I/O")
+    args = ap.parse_args()
+
+    with open(args.pack, "rb") as f:
+        body = f.read()
+    if not body or len(body) > PACK_MAX:
+        raise SystemExit(f"{args.pack}: {len(body)} bytes, pack must be 1..{PACK_MAX}")
+    crc = zlib.crc32(body) & 0xFFFFFFFF
+
+    parser = FrameParser()
+    frames: asyncio.Queue = asyncio.Queue()
+
+    def on_notify(_handle, data: bytes):
+        if args.verbose:
+            print(f"[notify] {binascii.hexlify(data).decode()}")
+        for frame in parser.feed(data):
+            frames.put_nowait(frame)
+
+    async def request(payload: bytes) -> bytes:
+        await client.write_gatt_char(args.rx, pack_frame(CMD_ASSET_UPLOAD, payload), response=True)
+        while True:
+            frame = await asyncio.wait_for(frames.get(), timeout=args.timeout)
+            if frame[1] == RESP_ASSET_UPLOAD:
+                return frame[3 : 3 + frame[2]]
+
+    async def step(payload: bytes, what: str):
+        reply = await request(payload)
+        if not reply or reply[0] != 0:
+            raise RuntimeError(f"{what} failed: status 0x{reply[0] if reply else 0xFF:02X}")
+
+    client = BleakClient(args.mac)
+    await client.connect()
+    if hasattr(client, "get_services"):
+        await client.get_services()
+    else:
+        _ = client.services
+    await client.start_notify(args.tx, on_notify)
+    try:
+        await step(bytes([0]), "begin")
+        for off in range(0, len(body), CHUNK):
+            await step(bytes([1]) + off.to_bytes(4, "big") + body[off : off + CHUNK], f"write @{off}")
+            if args.verbose:
+                print(f"{off * 100 // len(body):3d}%")
+        await step(bytes([2]) + len(body).to_bytes(4, "big") + crc.to_bytes(4, "big"), "finish")
+        info = await request(bytes([3]))
+        print(f"asset pack stored: valid={info[2]} count={int.from_bytes(info[4:6], 'big')} "
+              f"bytes={int.from_bytes(info[6:10], 'big')} crc=0x{int.from_bytes(info[10:14], 'big'):08X}")
+    finally:
+        await client.stop_notify(args.tx)
+        await client.disconnect()
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""
+Print the boot waterfall recorded by the open firmware (command 0x3E).
+
+Every boot stage mark is stamped from the DWT cycle counter; the device
+returns {ver, count, offset, n, n x {code[4], t_us[4], dt_us[4]}} pages of up
+to 16 stages, oldest first. dt_us is the time spent between the previous
+mark and this one, i.e. the stage that this mark closes.
+
+Frame format: 0x55 | CMD | LEN | PAYLOAD | CHKSUM
+  CHKSUM = bitwise-not XOR of all prior bytes.
+"""
+
+import argparse
+import asyncio
+import binascii
+import sys
+from typing import List, Tuple
+
+try:
+    from bleak import BleakClient
+except ImportError:
+    print("Install bleak: pip install bleak", file=sys.stderr)
+    sys.exit(1)
+
+NUS_SERVICE = "0000ffe0-0000-1000-8000-00805f9b34fb"
+NUS_RX = "0000ffe9-0000-1000-8000-00805f9b34fb"  # write
+NUS_TX = "0000ffe4-0000-1000-8000-00805f9b34fb"  # notify
+
+CMD_BOOT_PROFILE = 0x3E
+RESP_BOOT_PROFILE = CMD_BOOT_PROFILE | 0x80
+PAGE = 16
+
+# What ran between the previous mark and this one (see main() in src/main.c).
+# The boot steps (0xBAA1, 0xBAA7, 0xBAA8, 0xBAAC, 0xBAAD, 0xBAB0, 0xBAB1) run
+# inside the LCD waits (between 0xB160 and 0xB16F) when they fit.
+STAGE_NAMES = {
+    0xB001: "clock/NVIC/work queue/RAM_EXT probe",
+    0xB002: "TIM2 timebase",
+    0xB003: "-",
+    0xBAAE: "boot splash blit",
+    0xB004: "board init done",
+    0xB100: "board init start",
+    0xB160: "LCD bus/FSMC/DMA",
+    0xB16F: "LCD reset + ST7789 init",
+    0xB170: "LCD clear",
+    0xB180: "backlight + BLE control pins",
+    0xB1FF: "BLE UART pins + buttons",
+    0xBAB0: "RAM state defaults",
+    0xBAB1: "flash jobs + KV index",
+    0xBAA1: "battery monitor priming",
+    0xBAA2: "UART1 (BLE) init",
+    0xBAAF: "BLE MAC query",
+    0xBAA3: "GPIOC aux pins",
+    0xBAA4: "UART2 + comm IRQs",
+    0xBAAD: "ride log/trip load",
+    0xBAA5: "graphs/sampler/motor ISR/UART2 DMA",
+    0xBAA6: "motor cmd/Shengyi/link",
+    0xBAA7: "event/stream log load",
+    0xBAA8: "config load",
+    0xBAAC: "ab_update_init",
+    0xBAA9: "ui_init",
+    0xBAAA: "IRQs on + watchdog",
+    0xBAAB: "status line + Shengyi request",
+    0xB020: "main loop entry",
+    0xB021: "first frame",
+}
+
+
+def stage_name(code: int) -> str:
+    if (code & 0xF0000000) == 0xE0000000:
+        return f"reset (flags 0x{code & 0xFFFF:04X})"
+    return STAGE_NAMES.get(code, "?")
+
+
+def pack_frame(cmd: int, payload: bytes) -> bytes:
+    if len(payload) > 255:
+        raise ValueError("payload too long")
+    hdr = bytes([0x55, cmd & 0xFF, len(payload) & 0xFF])
+    x = 0
+    for b in hdr + payload:
+        x ^= b
+    cks = (~x) & 0xFF
+    return hdr + payload + bytes([cks])
+
+
+class FrameParser:
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data: bytes) -> List[bytes]:
+        self.buf.extend(data)
+        out = []
+        while len(self.buf) >= 4:
+            if self.buf[0] != 0x55:
+                del self.buf[0]
+                continue
+            frame_len = 4 + self.buf[2]
+            if len(self.buf) < frame_len:
+                break
+            frame = bytes(self.buf[:frame_len])
+            del self.buf[:frame_len]
+            x = 0
+            for b in frame[:-1]:
+                x ^= b
+            if ((~x) & 0xFF) == frame[-1]:
+                out.append(frame)
+        return out
+
+
+def parse_page(payload: bytes) -> Tuple[int, List[Tuple[int, int, int]]]:
+    if len(payload) < 4 or payload[0] != 1:
+        raise RuntimeError(f"unexpected boot_profile reply {binascii.hexlify(payload).decode()}")
+    count, n = payload[1], payload[3]
+    rows = []
+    for i in range(n):
+        rec = payload[4 + 12 * i : 16 + 12 * i]
+        rows.append((int.from_bytes(rec[0:4], "big"),
+                     int.from_bytes(rec[4:8], "big"),
+                     int.from_bytes(rec[8:12], "big")))
+    return count, rows
+
+
+def print_waterfall(rows: List[Tuple[int, int, int]], width: int):
+    if not rows:
+        print("no boot stages recorded")
+        return
+    total = rows[-1][1] or 1
+    print(f"{'code':>10}  {'start ms':>9}  {'dt ms':>8}  stage")
+    for code, t_us, dt_us in rows:
+        start = t_us - dt_us
+        col = start * width // total
+        bar = max(1, dt_us * width // total) if dt_us else 0
+        print(f"0x{code:08X}  {start / 1000:9.2f}  {dt_us / 1000:8.2f}  "
+              f"{stage_name(code):<38} |{' ' * col}{'#' * bar}")
+    print(f"total {total / 1000:.2f} ms to 0x{rows[-1][0]:X}")
+
+
+async def main():
+    ap = argparse.ArgumentParser(description="Print the boot stage waterfall (0x3E boot_profile)")
+    ap.add_argument("mac", help="BLE MAC address (or UUID on macOS/iOS)")
+    ap.add_argument("--service", default=NUS_SERVICE, help="UART service UUID")
+    ap.add_argument("--rx", default=NUS_RX, help="UART RX characteristic (write)")
+    ap.add_argument("--tx", default=NUS_TX, help="UART TX characteristic (notify)")
+    ap.add_argument("--timeout", type=float, default=2.0, help="seconds to wait per response")
+    ap.add_argument("--width", type=int, default=40, help="waterfall bar width")
+    ap.add_argument("-v", "--verbose", action="store_true", help="verbose I/O")
+    args = ap.parse_args()
+
+    parser = FrameParser()
+    frames: asyncio.Queue = asyncio.Queue()
+
+    def on_notify(_handle, data: bytes):
+        if args.verbose:
+            print(f"[notify] {binascii.hexlify(data).decode()}")
+        for frame in parser.feed(data):
+            frames.put_nowait(frame)
+
+    client = BleakClient(args.mac)
+    await client.connect()
+    if hasattr(client, "get_services"):
+        await client.get_services()
+    else:
+        _ = client.services
+    await client.start_notify(args.tx, on_notify)
+    rows: List[Tuple[int, int, int]] = []
+    try:
+        offset = 0
+        while True:
+            await client.write_gatt_char(args.rx, pack_frame(CMD_BOOT_PROFILE, bytes([offset])), response=True)
+            while True:
+                frame = await asyncio.wait_for(frames.get(), timeout=args.timeout)
+                if frame[1] == RESP_BOOT_PROFILE:
+                    break
+            count, page = parse_page(frame[3 : 3 + frame[2]])
+            rows.extend(page)
+            offset += len(page)
+            if not page or offset >= count or len(page) < PAGE:
+                break
+    finally:
+        await client.stop_notify(args.tx)
+        await client.disconnect()
+
+    print_waterfall(rows, args.width)
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
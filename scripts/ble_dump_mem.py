@@ -4,6 +4,15 @@ Dump memory over BLE using the open-firmware UART1 debug protocol.
 
 Use --flash to invoke the SPI flash read command (0x08) for external flash offsets.
 
+Use --bulk for the streaming read (0x12): one request, then numbered 0x94
+frames {seq[2], data} paced by the device; missing sequence numbers are
+re-requested with 0x13 {seq[2] x k}. Addresses follow the flash-read map.
+
+Use --pipeline N to keep N reads in flight as tagged requests (0x19 {tag,
+cmd, args} -> 0x99 {tag, cmd|0x80, reply}); replies are matched by tag, so
+the device may answer them in any order. Tagged replies carry at most 190
+bytes, so --chunk is capped there.
+
 Uses command 0x04 (read_mem):
   payload: addr[4] (big-endian), len[1]
   response: cmd|0x80 (0x84), payload len bytes
@@ -35,6 +44,13 @@ CMD_READ_FLASH = 0x08
 RESP_READ_MEM = CMD_READ_MEM | 0x80
 RESP_READ_FLASH = CMD_READ_FLASH | 0x80
 CMD_SET_DEBUG_OUTPUT = 0x0F
+CMD_BULK_READ = 0x12
+CMD_BULK_READ_NAK = 0x13
+RESP_BULK_DATA = 0x94
+BULK_NAK_MAX = 16
+CMD_TAGGED = 0x19
+RESP_TAGGED = CMD_TAGGED | 0x80
+TAGGED_MAX_REPLY = 190
 
 
 def pack_frame(cmd: int, payload: bytes) -> bytes:
@@ -89,6 +105,7 @@ class BleMemDumper:
         self.verbose = verbose
         self.parser = FrameParser()
         self.frames = asyncio.Queue()
+        self.next_tag = 0
 
     def _on_notify(self, _handle, data: bytes):
         if self.verbose:
@@ -121,6 +138,69 @@ class BleMemDumper:
             if len(frame) >= 4 and frame[1] == resp_cmd and frame[2] == size:
                 return frame[3 : 3 + size]
 
+    async def read_tagged(self, client: BleakClient, addr: int, sizes: List[int], timeout: float,
+                          cmd: int) -> bytes:
+        """Consecutive blocks as tagged reads, all in flight at once."""
+        pending = {}
+        off = addr
+        for i, n in enumerate(sizes):
+            tag = (self.next_tag + i) & 0xFF
+            inner = bytes([tag, cmd]) + off.to_bytes(4, "big") + bytes([n])
+            await self._write(client, pack_frame(CMD_TAGGED, inner))
+            pending[tag] = (i, n)
+            off += n
+        self.next_tag = (self.next_tag + len(sizes)) & 0xFF
+        resp_cmd = (cmd | 0x80) & 0xFF
+        got: List[bytes] = [b""] * len(sizes)
+        while pending:
+            frame = await asyncio.wait_for(self.frames.get(), timeout=timeout)
+            if len(frame) < 7 or frame[1] != RESP_TAGGED or frame[4] != resp_cmd or frame[3] not in pending:
+                continue
+            i, n = pending.pop(frame[3])
+            if frame[2] != n + 2:
+                raise RuntimeError(f"tagged read {frame[3]} refused: status 0x{frame[5]:02X}")
+            got[i] = frame[5 : 5 + n]
+        return b"".join(got)
+
+    async def bulk_read(self, client: BleakClient, addr: int, size: int, timeout: float,
+                        retries: int) -> bytes:
+        payload = addr.to_bytes(4, "big") + size.to_bytes(4, "big")
+        await self._write(client, pack_frame(CMD_BULK_READ, payload))
+        resp_cmd = CMD_BULK_READ | 0x80
+        while True:
+            frame = await asyncio.wait_for(self.frames.get(), timeout=timeout)
+            if frame[1] == resp_cmd and frame[2] >= 1:
+                break
+        if frame[3] != 0 or frame[2] < 4:
+            raise RuntimeError(f"bulk_read refused: status 0x{frame[3]:02X}")
+        frames = int.from_bytes(frame[4:6], "big")
+        chunk = frame[6]
+        got = {}
+        while len(got) < frames:
+            try:
+                frame = await asyncio.wait_for(self.frames.get(), timeout=timeout)
+            except asyncio.TimeoutError:
+                if retries <= 0:
+                    raise
+                retries -= 1
+                missing = [s for s in range(frames) if s not in got][:BULK_NAK_MAX]
+                nak = b"".join(s.to_bytes(2, "big") for s in missing)
+                await self._write(client, pack_frame(CMD_BULK_READ_NAK, nak))
+                if self.verbose:
+                    print(f"[nak] {missing}")
+                continue
+            if frame[1] != RESP_BULK_DATA or frame[2] < 3:
+                continue
+            seq = int.from_bytes(frame[3:5], "big")
+            if seq < frames:
+                got[seq] = frame[5 : 3 + frame[2]]
+                if self.verbose and len(got) % 16 == 0:
+                    print(f"bulk {len(got) * chunk}/{size}")
+        data = b"".join(got[s] for s in range(frames))
+        if len(data) != size:
+            raise RuntimeError(f"bulk_read returned {len(data)} of {size} bytes")
+        return data
+
 
 async def main():
     ap = argparse.ArgumentParser(description="Dump memory over BLE (UART1 debug protocol)")
@@ -134,6 +214,10 @@ async def main():
     ap.add_argument("--chunk", type=int, default=192, help="read size per request (<=192)")
     ap.add_argument("--flash", action="store_true",
                     help="use flash-read command (0x08) for external SPI flash offsets")
+    ap.add_argument("--bulk", action="store_true",
+                    help="stream the whole range with bulk read (0x12) and NAK retries")
+    ap.add_argument("--pipeline", type=int, default=1,
+                    help="reads kept in flight as tagged requests (0x19); 1 sends plain ones")
     ap.add_argument("--timeout", type=float, default=2.0, help="seconds to wait per response")
     ap.add_argument("--retries", type=int, default=20, help="reconnect attempts before giving up")
     ap.add_argument("--reconnect-delay", type=float, default=0.5, help="seconds to wait before reconnecting")
@@ -145,6 +229,11 @@ async def main():
     if args.chunk <= 0 or args.chunk > 192:
         print("chunk must be 1..192", file=sys.stderr)
         sys.exit(1)
+    if args.pipeline < 1 or args.pipeline > 16:
+        print("pipeline must be 1..16", file=sys.stderr)
+        sys.exit(1)
+    if args.pipeline > 1:
+        args.chunk = min(args.chunk, TAGGED_MAX_REPLY)
 
     dumper = BleMemDumper(args.mac, args.service, args.rx, args.tx, args.verbose)
     remaining = args.length
@@ -158,6 +247,21 @@ async def main():
         debug_mask = args.debug_mask & 0xFF
 
     os.makedirs(os.path.dirname(args.out) or ".", exist_ok=True)
+    if args.bulk:
+        client = await dumper._connect()
+        try:
+            if debug_mask is not None:
+                await dumper._write(client, pack_frame(CMD_SET_DEBUG_OUTPUT, bytes([debug_mask])))
+                await asyncio.sleep(0.05)
+            data = await dumper.bulk_read(client, args.start, args.length, args.timeout, args.retries)
+        finally:
+            if client.is_connected:
+                await client.disconnect()
+        with open(args.out, "wb") as f:
+            f.write(data)
+        print(f"OK: wrote {args.length} bytes to {args.out}")
+        return
+
     with open(args.out, "wb") as f:
         client = None
         while remaining > 0:
@@ -168,7 +272,16 @@ async def main():
                         await dumper._write(client, pack_frame(CMD_SET_DEBUG_OUTPUT, bytes([debug_mask])))
                         await asyncio.sleep(0.05)
                 n = args.chunk if remaining > args.chunk else remaining
-                data = await dumper.read_block(client, addr, n, args.timeout, cmd)
+                if args.pipeline > 1:
+                    sizes = []
+                    left = remaining
+                    while left > 0 and len(sizes) < args.pipeline:
+                        sizes.append(min(args.chunk, left))
+                        left -= sizes[-1]
+                    n = sum(sizes)
+                    data = await dumper.read_tagged(client, addr, sizes, args.timeout, cmd)
+                else:
+                    data = await dumper.read_block(client, addr, n, args.timeout, cmd)
                 f.write(data)
                 addr += n
                 remaining -= n
@@ -0,0 +1,166 @@
+#!/usr/bin/env python3
+"""
+Download the display's graph history over BLE (command 0x64) as CSV.
+
+The device keeps a min/max/mean pyramid per graph channel (speed, power,
+voltage, cadence, temperature): level 0 holds 0.5 s cells and each level
+above folds several cells of the one below. One 0x64 request sends every
+closed cell of the selected channels and levels as unsolicited 0x9B frames,
+paced by the BLE TX queue, then an end frame.
+
+Reply to the request: {status, ver=1, channels, levels, cells[2],
+period_ms[4] x levels}.
+Data frame: {seq[2], channel, level, first[4], n, cells...}; `first` is the
+absolute number of the frame's first cell (cell k of a level covers
+[k * period, (k + 1) * period) since the channel started), and each cell
+is three zigzag varints, the deltas of {min, max, mean} against the
+previous cell of the frame (the first against zeros). The end frame has
+channel = level = 0xFF and seq = the number of data frames before it.
+
+The CSV has one row per cell: channel,level,cell,period_ms,min,max,mean.
+Units are the graph's: speed dmph, power W, voltage 0.1 V, cadence rpm,
+temperature 0.1 C.
+
+Frame format: 0x55 | CMD | LEN | PAYLOAD | CHKSUM
+  CHKSUM = bitwise-not XOR of all prior bytes.
+
+Usage:
+  uv run python scripts/ble_graph_export.py AA:BB:CC:DD:EE:FF --out graphs.csv
+"""
+
+import argparse
+import asyncio
+import binascii
+import csv
+import sys
+from pathlib import Path
+from typing import Dict, List, Tuple
+
+from ble_ui_stream import FrameParser, NUS_RX, NUS_TX, pack_frame
+
+CMD_GRAPH_EXPORT = 0x64
+RESP_GRAPH_EXPORT = CMD_GRAPH_EXPORT | 0x80
+CMD_GRAPH_EXPORT_DATA = 0x9B
+OP_START = 1
+HEADER_BYTES = 9
+END = 0xFF
+
+CHANNELS = ["speed", "power", "volt", "cadence", "temp"]
+
+
+def get_varint(buf: bytes, i: int) -> Tuple[int, int]:
+    v = 0
+    shift = 0
+    while True:
+        b = buf[i]
+        i += 1
+        v |= (b & 0x7F) << shift
+        if not b & 0x80:
+            return v, i
+        shift += 7
+
+
+def unzigzag(v: int) -> int:
+    return (v >> 1) ^ -(v & 1)
+
+
+def decode_data(payload: bytes) -> Tuple[int, int, int, int, List[Tuple[int, int, int]]]:
+    """Returns (seq, channel, level, first, cells) of one data frame."""
+    if len(payload) < HEADER_BYTES:
+        raise RuntimeError(f"short graph_export frame {binascii.hexlify(payload).decode()}")
+    seq = int.from_bytes(payload[0:2], "big")
+    channel, level = payload[2], payload[3]
+    first = int.from_bytes(payload[4:8], "big")
+    n = payload[8]
+    cells = []
+    prev = [0, 0, 0]
+    i = HEADER_BYTES
+    for _ in range(n):
+        for f in range(3):
+            v, i = get_varint(payload, i)
+            prev[f] += unzigzag(v)
+        cells.append((prev[0], prev[1], prev[2]))
+    return seq, channel, level, first, cells
+
+
+async def run(args) -> int:
+    try:
+        from bleak import BleakClient
+    except ImportError:
+        print("Install bleak: pip install bleak", file=sys.stderr)
+        return 1
+
+    parser = FrameParser()
+    replies: asyncio.Queue = asyncio.Queue()
+    done = asyncio.Event()
+    cells: Dict[Tuple[int, int], Dict[int, Tuple[int, int, int]]] = {}
+    state = {"next_seq": 0, "lost": 0, "bytes": 0}
+
+    def on_notify(_handle, data: bytes):
+        for frame in parser.feed(data):
+            payload = frame[3:3 + frame[2]]
+            if frame[1] == CMD_GRAPH_EXPORT_DATA:
+                seq, channel, level, first, got = decode_data(payload)
+                if seq != state["next_seq"]:
+                    state["lost"] += (seq - state["next_seq"]) & 0xFFFF
+                state["next_seq"] = (seq + 1) & 0xFFFF
+                state["bytes"] += len(payload)
+                if channel == END:
+                    done.set()
+                    continue
+                level_cells = cells.setdefault((channel, level), {})
+                for k, c in enumerate(got):
+                    level_cells[first + k] = c
+            elif frame[1] == RESP_GRAPH_EXPORT:
+                replies.put_nowait(payload)
+
+    client = BleakClient(args.mac)
+    await client.connect()
+    if hasattr(client, "get_services"):
+        await client.get_services()
+    else:
+        _ = client.services
+    await client.start_notify(args.tx, on_notify)
+    try:
+        req = bytes([OP_START, args.channels & 0xFF, args.levels & 0xFF])
+        await client.write_gatt_char(args.rx, pack_frame(CMD_GRAPH_EXPORT, req), response=True)
+        reply = await asyncio.wait_for(replies.get(), timeout=args.timeout)
+        if len(reply) < 6 or reply[0] != 0:
+            raise RuntimeError(f"export refused: {binascii.hexlify(reply).decode()}")
+        levels = reply[3]
+        periods = [int.from_bytes(reply[6 + 4 * i:10 + 4 * i], "big") for i in range(levels)]
+        await asyncio.wait_for(done.wait(), timeout=args.seconds)
+    finally:
+        await client.stop_notify(args.tx)
+        await client.disconnect()
+
+    rows = 0
+    with args.out.open("w", newline="") as f:
+        w = csv.writer(f)
+        w.writerow(["channel", "level", "cell", "period_ms", "min", "max", "mean"])
+        for (channel, level) in sorted(cells):
+            name = CHANNELS[channel] if channel < len(CHANNELS) else str(channel)
+            period = periods[level] if level < len(periods) else 0
+            for k in sorted(cells[(channel, level)]):
+                w.writerow([name, level, k, period, *cells[(channel, level)][k]])
+                rows += 1
+    print(f"{rows} cells, {state['bytes']} bytes, {state['lost']} frames lost; wrote {args.out}")
+    return 0 if state["lost"] == 0 else 2
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("mac", help="BLE address")
+    ap.add_argument("--out", type=Path, default=Path("graphs.csv"))
+    ap.add_argument("--channels", type=lambda s: int(s, 0), default=0xFF, help="channel bit mask")
+    ap.add_argument("--levels", type=lambda s: int(s, 0), default=0xFF, help="pyramid level bit mask")
+    ap.add_argument("--seconds", type=float, default=30.0, help="how long to wait for the end frame")
+    ap.add_argument("--timeout", type=float, default=3.0, help="reply timeout in seconds")
+    ap.add_argument("--rx", default=NUS_RX, help="write characteristic UUID")
+    ap.add_argument("--tx", default=NUS_TX, help="notify characteristic UUID")
+    args = ap.parse_args()
+    return asyncio.run(run(args))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""
+Measure one-way BLE latency against the device clock (command 0x1B).
+
+Every 0x1B time_sync exchange gives four timestamps: t1 host send, t2
+device receive (stamped in the USART1 RX interrupt), t3 device reply, t4
+host receive. The device clock is microseconds since boot (wrapping at
+2^32). Offset and drift come from a line fit over the exchanges with the
+lower half of round-trip delays, taken before and after the measurement so
+the fit spans it.
+
+Reports (percentiles in ms):
+  - sync: round trip and the fit's residual
+  - --cmd HEX: that command wrapped in time_sync, N times. uplink is host
+    send to device receive, handle is device receive to its reply, ack is
+    host send to the command's own reply arriving, downlink is the time
+    sync reply's flight back
+  - --stream SECONDS: subscribes 0x11 stream v2 with the us flag and reports
+    how old each 0x91 frame is on arrival (host receive minus the frame's
+    device stamp)
+
+Frame format: 0x55 | CMD | LEN | PAYLOAD | CHKSUM
+  CHKSUM = bitwise-not XOR of all prior bytes.
+
+Usage:
+  uv run python scripts/ble_latency.py AA:BB:CC:DD:EE:FF --cmd 01 --count 200 \\
+      --stream 30
+"""
+
+import argparse
+import asyncio
+import binascii
+import sys
+import time
+from typing import Dict, List, Optional, Tuple
+
+NUS_SERVICE = "0000ffe0-0000-1000-8000-00805f9b34fb"
+NUS_RX = "0000ffe9-0000-1000-8000-00805f9b34fb"  # write
+NUS_TX = "0000ffe4-0000-1000-8000-00805f9b34fb"  # notify
+
+CMD_TIME_SYNC = 0x1B
+RESP_TIME_SYNC = CMD_TIME_SYNC | 0x80
+CMD_STREAM_V2 = 0x11
+CMD_STREAM_V2_FRAME = 0x91
+STREAM_VERSION_US = 3
+STREAM_F_US = 0x01
+STREAM_HDR_LEN = 10
+# speed, cadence, power, torque, battery current, commanded power
+STREAM_MASK = 0x003F
+
+
+def pack_frame(cmd: int, payload: bytes) -> bytes:
+    if len(payload) > 255:
+        raise ValueError("payload too long")
+    hdr = bytes([0x55, cmd & 0xFF, len(payload) & 0xFF])
+    x = 0
+    for b in hdr + payload:
+        x ^= b
+    cks = (~x) & 0xFF
+    return hdr + payload + bytes([cks])
+
+
+class FrameParser:
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data: bytes) -> List[bytes]:
+        self.buf.extend(data)
+        out = []
+        while len(self.buf) >= 4:
+            if self.buf[0] != 0x55:
+                del self.buf[0]
+                continue
+            frame_len = 4 + self.buf[2]
+            if len(self.buf) < frame_len:
+                break
+            frame = bytes(self.buf[:frame_len])
+            del self.buf[:frame_len]
+            x = 0
+            for b in frame[:-1]:
+                x ^= b
+            if ((~x) & 0xFF) == frame[-1]:
+                out.append(frame)
+        return out
+
+
+def host_us() -> int:
+    return time.monotonic_ns() // 1000
+
+
+def wrap32(v: int) -> int:
+    """Signed difference of two wrapping u32 stamps."""
+    v &= 0xFFFFFFFF
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+class Clock:
+    """Device time as a line in host time: dev = host + a + b * (host - t0)."""
+
+    def __init__(self, samples: List[Tuple[int, int, int, int]]):
+        if not samples:
+            raise RuntimeError("no time_sync replies")
+        self.t0 = samples[0][0]
+        rows = []
+        for t1, t2, t3, t4 in samples:
+            delay = (t4 - t1) - wrap32(t3 - t2)
+            # t1/t4 are full host us; offsets are taken against their low 32 bits.
+            theta = (wrap32(t2 - t1) + wrap32(t3 - t4)) / 2.0
+            rows.append((delay, 0.5 * (t1 + t4), theta))
+        rows.sort()
+        self.rtt = [r[0] for r in rows]
+        best = rows[: max(2, (len(rows) + 1) // 2)]
+        n = len(best)
+        mx = sum(r[1] for r in best) / n
+        my = sum(r[2] for r in best) / n
+        sxx = sum((r[1] - mx) ** 2 for r in best)
+        self.b = (sum((r[1] - mx) * (r[2] - my) for r in best) / sxx) if n > 1 and sxx > 0 else 0.0
+        self.a = my - self.b * (mx - self.t0)
+        self.residual = [abs(r[2] - self.offset(r[1])) for r in best]
+
+    def offset(self, host: float) -> float:
+        return self.a + self.b * (host - self.t0)
+
+    def to_host(self, dev: int, near_host: int) -> float:
+        """Host time of a device stamp; near_host resolves the 32-bit wrap."""
+        guess = near_host + self.offset(near_host)
+        return near_host + wrap32(dev - int(guess)) - (guess - int(guess))
+
+
+def pct(values: List[float], p: float) -> float:
+    s = sorted(values)
+    return s[min(len(s) - 1, int(round(p / 100.0 * (len(s) - 1))))]
+
+
+def report(name: str, values_us: List[float]) -> None:
+    if not values_us:
+        print(f"  {name:<10} no samples")
+        return
+    ms = [v / 1000.0 for v in values_us]
+    print(f"  {name:<10} n={len(ms):<5} p50={pct(ms, 50):7.2f} p90={pct(ms, 90):7.2f} "
+          f"p99={pct(ms, 99):7.2f} max={max(ms):7.2f} min={min(ms):7.2f}")
+
+
+async def run(args) -> int:
+    try:
+        from bleak import BleakClient
+    except ImportError:
+        print("Install bleak: pip install bleak", file=sys.stderr)
+        return 1
+
+    parser = FrameParser()
+    syncs: Dict[int, asyncio.Future] = {}
+    acks: asyncio.Queue = asyncio.Queue()
+    stream: List[Tuple[int, int]] = []
+    inner_resp: Optional[int] = None
+
+    def on_notify(_handle, data: bytes):
+        t4 = host_us()
+        for frame in parser.feed(data):
+            cmd, payload = frame[1], frame[3:3 + frame[2]]
+            if cmd == RESP_TIME_SYNC and len(payload) == 12:
+                fut = syncs.pop(int.from_bytes(payload[0:4], "big"), None)
+                if fut and not fut.done():
+                    fut.set_result((int.from_bytes(payload[4:8], "big"),
+                                    int.from_bytes(payload[8:12], "big"), t4))
+            elif cmd == CMD_STREAM_V2_FRAME and len(payload) >= STREAM_HDR_LEN:
+                if payload[0] == STREAM_VERSION_US:
+                    stream.append((int.from_bytes(payload[4:8], "big"), t4))
+            elif inner_resp is not None and cmd == inner_resp:
+                acks.put_nowait(t4)
+            elif args.verbose:
+                print(f"[notify] {binascii.hexlify(frame).decode()}")
+
+    async def exchange(inner: bytes = b"") -> Tuple[int, int, int, int]:
+        t1 = host_us()
+        key = t1 & 0xFFFFFFFF
+        fut = asyncio.get_running_loop().create_future()
+        syncs[key] = fut
+        await client.write_gatt_char(args.rx, pack_frame(CMD_TIME_SYNC, key.to_bytes(4, "big") + inner),
+                                     response=False)
+        try:
+            t2, t3, t4 = await asyncio.wait_for(fut, timeout=args.timeout)
+        finally:
+            syncs.pop(key, None)
+        return t1, t2, t3, t4
+
+    async def sync_burst(out: List[Tuple[int, int, int, int]]) -> None:
+        for _ in range(args.syncs):
+            try:
+                out.append(await exchange())
+            except asyncio.TimeoutError:
+                pass
+            await asyncio.sleep(args.interval)
+
+    client = BleakClient(args.mac)
+    await client.connect()
+    if hasattr(client, "get_services"):
+        await client.get_services()
+    else:
+        _ = client.services
+    await client.start_notify(args.tx, on_notify)
+    samples: List[Tuple[int, int, int, int]] = []
+    probes: List[Tuple[int, int, int, int, Optional[int]]] = []
+    try:
+        await sync_burst(samples)
+        if args.cmd:
+            inner = bytes.fromhex(args.cmd)
+            inner_resp = inner[0] | 0x80
+            for _ in range(args.count):
+                while not acks.empty():
+                    acks.get_nowait()
+                try:
+                    t1, t2, t3, t4 = await exchange(inner)
+                except asyncio.TimeoutError:
+                    continue
+                ack = acks.get_nowait() if not acks.empty() else None
+                probes.append((t1, t2, t3, t4, ack))
+                samples.append((t1, t2, t3, t4))
+                await asyncio.sleep(args.interval)
+            inner_resp = None
+        if args.stream:
+            sub = STREAM_MASK.to_bytes(2, "big") + bytes(8) + bytes([STREAM_F_US])
+            await client.write_gatt_char(args.rx, pack_frame(CMD_STREAM_V2, sub), response=False)
+            await asyncio.sleep(args.stream)
+            await client.write_gatt_char(args.rx, pack_frame(CMD_STREAM_V2, bytes(2)), response=False)
+            await asyncio.sleep(0.2)
+        await sync_burst(samples)
+    finally:
+        await client.stop_notify(args.tx)
+        await client.disconnect()
+
+    clock = Clock([s[:4] for s in samples])
+    drift_ppm = clock.b * 1e6
+    print(f"time_sync: {len(samples)} exchanges, drift {drift_ppm:+.1f} ppm")
+    report("rtt", [float(v) for v in clock.rtt])
+    report("fit err", clock.residual)
+    if probes:
+        up, handle, down, ack = [], [], [], []
+        for t1, t2, t3, t4, a in probes:
+            up.append(clock.to_host(t2, t1) - t1)
+            handle.append(float(wrap32(t3 - t2)))
+            down.append(t4 - clock.to_host(t3, t4))
+            if a is not None:
+                ack.append(float(a - t1))
+        print(f"command {args.cmd}: {len(probes)} of {args.count} answered")
+        report("uplink", up)
+        report("handle", handle)
+        report("ack", ack)
+        report("downlink", down)
+    if args.stream:
+        print(f"stream: {len(stream)} frames in {args.stream:g} s")
+        report("staleness", [t4 - clock.to_host(dev, t4) for dev, t4 in stream])
+    return 0
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("mac", help="BLE address")
+    ap.add_argument("--syncs", type=int, default=32, help="time_sync exchanges before and after")
+    ap.add_argument("--interval", type=float, default=0.05, help="seconds between requests")
+    ap.add_argument("--cmd", help="command to probe, hex: cmd byte then args (e.g. 01 for ping)")
+    ap.add_argument("--count", type=int, default=100, help="probes of --cmd")
+    ap.add_argument("--stream", type=float, default=0.0, help="seconds of stream v2 to measure")
+    ap.add_argument("--timeout", type=float, default=2.0, help="reply timeout in seconds")
+    ap.add_argument("--rx", default=NUS_RX, help="write characteristic UUID")
+    ap.add_argument("--tx", default=NUS_TX, help="notify characteristic UUID")
+    ap.add_argument("-v", "--verbose", action="store_true")
+    args = ap.parse_args()
+    return asyncio.run(run(args))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,364 @@
+#!/usr/bin/env python3
+"""
+Stream a firmware image into an A/B staging slot over BLE using the
+open-firmware OTA commands.
+
+  0x59 ota_begin:  slot[1], size[4], crc32[4], build_id[4], window[1],
+                   [format[1], stream_size[4], [base_crc32[4]]]
+                   -> status, window, chunk_max, ack_every
+  0x5A ota_chunk:  offset[4], data[<=188]
+                   -> cumulative ack {status, next_offset[4]} every ack_every
+                      chunks, or immediately on a gap/duplicate
+  0x5B ota_finish: set_pending[1] -> status
+
+Up to `window` chunks stay in flight; a gap reply rewinds to next_offset.
+With --lz the image goes out as LZ4 block-format sequences with distances of
+at most 2 KiB (util/lz_stream.h); offsets then count compressed bytes, while
+size and crc32 still describe the image the device decodes into the slot.
+With --delta-base the stream is copy/insert ops against that image, which
+must be the one in the active slot; a busy reply (the device is still
+copying from flash) pauses and resends from next_offset.
+
+Frame format: 0x55 | CMD | LEN | PAYLOAD | CHKSUM
+  CHKSUM = bitwise-not XOR of all prior bytes.
+"""
+
+import argparse
+import asyncio
+import binascii
+import sys
+import time
+import zlib
+from typing import List
+
+try:
+    from bleak import BleakClient
+except ImportError:
+    print("Install bleak: pip install bleak", file=sys.stderr)
+    sys.exit(1)
+
+NUS_SERVICE = "0000ffe0-0000-1000-8000-00805f9b34fb"
+NUS_RX = "0000ffe9-0000-1000-8000-00805f9b34fb"  # write
+NUS_TX = "0000ffe4-0000-1000-8000-00805f9b34fb"  # notify
+
+CMD_OTA_BEGIN = 0x59
+CMD_OTA_CHUNK = 0x5A
+CMD_OTA_FINISH = 0x5B
+
+OTA_STATUS_OK = 0x00
+OTA_STATUS_DUP = 0x01
+OTA_STATUS_BUSY = 0x02
+OTA_STATUS_GAP = 0xF7
+
+OTA_FORMAT_LZ = 1
+OTA_FORMAT_DELTA = 2
+LZ_WINDOW = 2048
+LZ_MIN_MATCH = 4
+LZ_CHAIN = 32
+
+DELTA_COPY = 0x01
+DELTA_INSERT = 0x02
+DELTA_KEY = 8
+DELTA_MIN_COPY = 16
+DELTA_CANDIDATES = 16
+
+
+def _lz_len(out: bytearray, n: int):
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+
+
+def _lz_sequence(out: bytearray, lit: bytes, dist: int, mlen: int):
+    m = mlen - LZ_MIN_MATCH if mlen else 0
+    out.append((min(len(lit), 15) << 4) | min(m, 15))
+    if len(lit) >= 15:
+        _lz_len(out, len(lit) - 15)
+    out += lit
+    if not mlen:
+        return
+    out += dist.to_bytes(2, "little")
+    if m >= 15:
+        _lz_len(out, m - 15)
+
+
+def lz_compress(data: bytes) -> bytes:
+    """Greedy LZ4-style sequences limited to the device's 2 KiB window."""
+    out = bytearray()
+    chains = {}
+    anchor = i = 0
+    n = len(data)
+    while i + LZ_MIN_MATCH <= n:
+        key = data[i : i + LZ_MIN_MATCH]
+        cands = chains.setdefault(key, [])
+        best_len = best_dist = 0
+        for j in reversed(cands):
+            if i - j > LZ_WINDOW:
+                break
+            k = LZ_MIN_MATCH
+            while i + k < n and data[j + k] == data[i + k]:
+                k += 1
+            if k > best_len:
+                best_len, best_dist = k, i - j
+        cands.append(i)
+        if len(cands) > LZ_CHAIN:
+            del cands[0]
+        if best_len < LZ_MIN_MATCH:
+            i += 1
+            continue
+        _lz_sequence(out, data[anchor:i], best_dist, best_len)
+        for p in range(i + 1, min(i + best_len, n - LZ_MIN_MATCH + 1)):
+            c = chains.setdefault(data[p : p + LZ_MIN_MATCH], [])
+            c.append(p)
+            if len(c) > LZ_CHAIN:
+                del c[0]
+        i += best_len
+        anchor = i
+    _lz_sequence(out, data[anchor:], 0, 0)
+    return bytes(out)
+
+
+def delta_encode(base: bytes, image: bytes) -> bytes:
+    """Greedy copy/insert ops turning `base` into `image` (storage/ota.h)."""
+    index = {}
+    for i in range(len(base) - DELTA_KEY + 1):
+        hits = index.setdefault(base[i : i + DELTA_KEY], [])
+        if len(hits) < DELTA_CANDIDATES:
+            hits.append(i)
+    out = bytearray()
+    literal = bytearray()
+
+    def flush_literal():
+        if literal:
+            out.extend(bytes([DELTA_INSERT]) + len(literal).to_bytes(4, "big") + literal)
+            literal.clear()
+
+    def extend(src: int, i: int) -> int:
+        n = 0
+        while src + n < len(base) and i + n < len(image) and base[src + n] == image[i + n]:
+            n += 1
+        return n
+
+    i = 0
+    last = 0  # base offset right after the previous copy
+    while i < len(image):
+        # Code that did not move keeps matching where the last copy stopped.
+        best_src, best_len = last, extend(last, i) if last < len(base) else 0
+        if best_len < DELTA_MIN_COPY:
+            for src in index.get(image[i : i + DELTA_KEY], ()):
+                n = extend(src, i)
+                if n > best_len:
+                    best_src, best_len = src, n
+        if best_len >= DELTA_MIN_COPY:
+            flush_literal()
+            out.extend(bytes([DELTA_COPY]) + best_src.to_bytes(4, "big") + best_len.to_bytes(4, "big"))
+            i += best_len
+            last = best_src + best_len
+        else:
+            literal.append(image[i])
+            i += 1
+            last += 1
+    flush_literal()
+    return bytes(out)
+
+
+def pack_frame(cmd: int, payload: bytes) -> bytes:
+    if len(payload) > 255:
+        raise ValueError("payload too long")
+    hdr = bytes([0x55, cmd & 0xFF, len(payload) & 0xFF])
+    x = 0
+    for b in hdr + payload:
+        x ^= b
+    cks = (~x) & 0xFF
+    return hdr + payload + bytes([cks])
+
+
+class FrameParser:
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data: bytes) -> List[bytes]:
+        self.buf.extend(data)
+        out = []
+        while True:
+            if len(self.buf) < 4:
+                break
+            if self.buf[0] != 0x55:
+                del self.buf[0]
+                continue
+            frame_len = 4 + self.buf[2]
+            if len(self.buf) < frame_len:
+                break
+            frame = bytes(self.buf[:frame_len])
+            del self.buf[:frame_len]
+            x = 0
+            for b in frame[:-1]:
+                x ^= b
+            if ((~x) & 0xFF) == frame[-1]:
+                out.append(frame)
+        return out
+
+
+class BleOtaPusher:
+    def __init__(self, mac: str, service: str, rx_uuid: str, tx_uuid: str, verbose: bool):
+        self.mac = mac
+        self.service = service
+        self.rx_uuid = rx_uuid
+        self.tx_uuid = tx_uuid
+        self.verbose = verbose
+        self.parser = FrameParser()
+        self.frames = asyncio.Queue()
+
+    def _on_notify(self, _handle, data: bytes):
+        if self.verbose:
+            print(f"[notify] {binascii.hexlify(data).decode()}")
+        for frame in self.parser.feed(data):
+            self.frames.put_nowait(frame)
+
+    async def connect(self) -> BleakClient:
+        client = BleakClient(self.mac)
+        await client.connect()
+        if hasattr(client, "get_services"):
+            await client.get_services()
+        else:
+            _ = client.services
+        await client.start_notify(self.tx_uuid, self._on_notify)
+        return client
+
+    async def write(self, client: BleakClient, cmd: int, payload: bytes, response: bool = True):
+        frame = pack_frame(cmd, payload)
+        if self.verbose:
+            print(f"[tx] {binascii.hexlify(frame).decode()}")
+        await client.write_gatt_char(self.rx_uuid, frame, response=response)
+
+    async def expect(self, cmd: int, timeout: float) -> bytes:
+        resp = (cmd | 0x80) & 0xFF
+        deadline = time.monotonic() + timeout
+        while True:
+            left = deadline - time.monotonic()
+            if left <= 0:
+                raise RuntimeError(f"timeout waiting for 0x{resp:02X}")
+            frame = await asyncio.wait_for(self.frames.get(), timeout=left)
+            if frame[1] == resp:
+                return frame[3 : 3 + frame[2]]
+
+    def poll_ack(self):
+        """Latest queued chunk reply, or None."""
+        ack = None
+        while not self.frames.empty():
+            frame = self.frames.get_nowait()
+            if frame[1] == (CMD_OTA_CHUNK | 0x80) and frame[2] >= 5:
+                ack = (frame[3], int.from_bytes(frame[4:8], "big"))
+        return ack
+
+    async def push(self, client: BleakClient, image: bytes, slot: int, build_id: int,
+                   window: int, set_pending: bool, timeout: float, lz: bool, base: bytes = None):
+        crc = zlib.crc32(image) & 0xFFFFFFFF
+        payload = bytes([slot]) + len(image).to_bytes(4, "big") + crc.to_bytes(4, "big")
+        payload += build_id.to_bytes(4, "big") + bytes([window])
+        data = image
+        if lz:
+            data = lz_compress(image)
+            payload += bytes([OTA_FORMAT_LZ]) + len(data).to_bytes(4, "big")
+            print(f"lz: {len(image)} -> {len(data)} bytes ({100.0 * len(data) / len(image):.0f}%)")
+        elif base is not None:
+            data = delta_encode(base, image)
+            base_crc = zlib.crc32(base) & 0xFFFFFFFF
+            payload += bytes([OTA_FORMAT_DELTA]) + len(data).to_bytes(4, "big") + base_crc.to_bytes(4, "big")
+            print(f"delta: {len(image)} -> {len(data)} bytes ({100.0 * len(data) / len(image):.0f}%)")
+        await self.write(client, CMD_OTA_BEGIN, payload)
+        resp = await self.expect(CMD_OTA_BEGIN, timeout)
+        if resp[0] != OTA_STATUS_OK:
+            raise RuntimeError(f"ota_begin failed: 0x{resp[0]:02X}")
+        window, chunk_max = resp[1], resp[2]
+        print(f"session: slot={slot} size={len(image)} crc=0x{crc:08X} window={window} chunk={chunk_max}")
+
+        acked = 0
+        sent = 0
+        t0 = time.monotonic()
+        while acked < len(data):
+            in_flight = (sent - acked + chunk_max - 1) // chunk_max
+            if sent < len(data) and in_flight < window:
+                n = min(chunk_max, len(data) - sent)
+                await self.write(client, CMD_OTA_CHUNK, sent.to_bytes(4, "big") + data[sent : sent + n],
+                                 response=False)
+                sent += n
+                ack = self.poll_ack()
+            else:
+                try:
+                    resp = await self.expect(CMD_OTA_CHUNK, timeout)
+                except (asyncio.TimeoutError, RuntimeError):
+                    # Lost chunk or ack: resend everything past the last ack.
+                    sent = acked
+                    continue
+                ack = (resp[0], int.from_bytes(resp[1:5], "big")) if len(resp) >= 5 else None
+            if ack is None:
+                continue
+            status, next_offset = ack
+            if status not in (OTA_STATUS_OK, OTA_STATUS_DUP, OTA_STATUS_GAP, OTA_STATUS_BUSY):
+                raise RuntimeError(f"ota_chunk failed: 0x{status:02X}")
+            acked = max(acked, next_offset)
+            if status == OTA_STATUS_BUSY:
+                # Everything after next_offset was refused; let the copy run.
+                await asyncio.sleep(0.05)
+                self.poll_ack()  # replies to the refused chunks
+            if status in (OTA_STATUS_GAP, OTA_STATUS_BUSY):
+                sent = next_offset
+            if self.verbose:
+                print(f"acked {acked}/{len(data)}")
+        dt = time.monotonic() - t0
+        print(f"streamed {len(data)} bytes in {dt:.1f}s ({len(data) / max(dt, 1e-3) / 1024:.1f} KiB/s)")
+
+        await self.write(client, CMD_OTA_FINISH, bytes([1 if set_pending else 0]))
+        resp = await self.expect(CMD_OTA_FINISH, timeout * 4)
+        if resp[0] != OTA_STATUS_OK:
+            raise RuntimeError(f"ota_finish failed: 0x{resp[0]:02X}")
+
+
+async def main():
+    ap = argparse.ArgumentParser(description="Push a firmware image into an A/B slot over BLE")
+    ap.add_argument("mac", help="BLE MAC address (or UUID on macOS/iOS)")
+    ap.add_argument("image", help="firmware image (.bin)")
+    ap.add_argument("--slot", type=int, default=1, help="A/B slot to write (must not be the active slot)")
+    ap.add_argument("--build-id", type=lambda s: int(s, 0), default=0, help="build id stored in the slot header")
+    ap.add_argument("--window", type=int, default=8, help="chunks in flight (device clamps to 1..8)")
+    ap.add_argument("--lz", action="store_true", help="stream the image LZ-compressed (device decodes it)")
+    ap.add_argument("--delta-base", help="image in the active slot; stream copy/insert ops against it")
+    ap.add_argument("--no-pending", action="store_true", help="do not mark the slot pending after upload")
+    ap.add_argument("--service", default=NUS_SERVICE, help="UART service UUID")
+    ap.add_argument("--rx", default=NUS_RX, help="UART RX characteristic (write)")
+    ap.add_argument("--tx", default=NUS_TX, help="UART TX characteristic (notify)")
+    ap.add_argument("--timeout", type=float, default=3.0, help="seconds to wait per reply")
+    ap.add_argument("-v", "--verbose", action="store_true", help="verbose I/O")
+    args = ap.parse_args()
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+    if not image:
+        print("image is empty", file=sys.stderr)
+        sys.exit(1)
+    base = None
+    if args.delta_base:
+        if args.lz:
+            print("--lz and --delta-base are exclusive", file=sys.stderr)
+            sys.exit(1)
+        with open(args.delta_base, "rb") as f:
+            base = f.read()
+
+    pusher = BleOtaPusher(args.mac, args.service, args.rx, args.tx, args.verbose)
+    client = await pusher.connect()
+    try:
+        await pusher.push(client, image, args.slot, args.build_id, args.window,
+                          not args.no_pending, args.timeout, args.lz, base)
+    finally:
+        if client.is_connected:
+            await client.disconnect()
+    print("OK: image staged" + ("" if args.no_pending else f"; slot {args.slot} pending for next boot"))
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""
+Export or import the profile bundle (command 0x5F): every assist profile,
+its speed and cadence curves, the virtual gears and the cadence bias as one
+409-byte image (src/profiles/profile_bundle.h).
+
+Provision a fleet from one tuned bike:
+  ./scripts/ble_profile_bundle.py <mac> export tuned.prfb
+  ./scripts/ble_profile_bundle.py <mac> import tuned.prfb
+  ./scripts/ble_profile_bundle.py <mac> clear          (back to built-in tables)
+
+  0x5F op=0 begin
+       op=1 offset[4], data[...]     (sequential, staged in RAM)
+       op=2                          (check, apply all tables, store)
+       op=3 -> {ver, len, stored, uploading, bytes[2], crc32[4], write_offset[4]}
+       op=4 offset[2] -> {status, offset[2], data[...]}
+       op=5                          (erase the stored image)
+
+Frame format: 0x55 | CMD | LEN | PAYLOAD | CHKSUM
+  CHKSUM = bitwise-not XOR of all prior bytes.
+"""
+
+import argparse
+import asyncio
+import binascii
+import struct
+import sys
+import zlib
+from typing import List
+
+try:
+    from bleak import BleakClient
+except ImportError:
+    print("Install bleak: pip install bleak", file=sys.stderr)
+    sys.exit(1)
+
+NUS_SERVICE = "0000ffe0-0000-1000-8000-00805f9b34fb"
+NUS_RX = "0000ffe9-0000-1000-8000-00805f9b34fb"  # write
+NUS_TX = "0000ffe4-0000-1000-8000-00805f9b34fb"  # notify
+
+CMD_PROFILE_BUNDLE = 0x5F
+RESP_PROFILE_BUNDLE = CMD_PROFILE_BUNDLE | 0x80
+CHUNK = 184
+BUNDLE_MAGIC = b"PRFB"
+BUNDLE_BYTES = 409  # header 12 + 5 profiles x 72 + gears 30 + bias 7
+HEADER_BYTES = 12
+
+
+def check_image(img: bytes, what: str):
+    """Header and CRC only; the display checks every field on commit."""
+    if len(img) != BUNDLE_BYTES or img[:4] != BUNDLE_MAGIC:
+        raise SystemExit(f"{what}: not a {BUNDLE_BYTES}-byte profile bundle")
+    (crc,) = struct.unpack(">I", img[8:12])
+    if zlib.crc32(img[HEADER_BYTES:]) & 0xFFFFFFFF != crc:
+        raise SystemExit(f"{what}: body CRC mismatch")
+
+
+def pack_frame(cmd: int, payload: bytes) -> bytes:
+    if len(payload) > 255:
+        raise ValueError("payload too long")
+    hdr = bytes([0x55, cmd & 0xFF, len(payload) & 0xFF])
+    x = 0
+    for b in hdr + payload:
+        x ^= b
+    cks = (~x) & 0xFF
+    return hdr + payload + bytes([cks])
+
+
+class FrameParser:
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data: bytes) -> List[bytes]:
+        self.buf.extend(data)
+        out = []
+        while len(self.buf) >= 4:
+            if self.buf[0] != 0x55:
+                del self.buf[0]
+                continue
+            frame_len = 4 + self.buf[2]
+            if len(self.buf) < frame_len:
+                break
+            frame = bytes(self.buf[:frame_len])
+            del self.buf[:frame_len]
+            x = 0
+            for b in frame[:-1]:
+                x ^= b
+            if ((~x) & 0xFF) == frame[-1]:
+                out.append(frame)
+        return out
+
+
+async def main():
+    ap = argparse.ArgumentParser(description="Export/import the profile bundle (0x5F profile_bundle)")
+    ap.add_argument("mac", help="BLE MAC address (or UUID on macOS/iOS)")
+    ap.add_argument("action", choices=("export", "import", "clear"))
+    ap.add_argument("file", nargs="?", help="bundle image to write (export) or send (import)")
+    ap.add_argument("--service", default=NUS_SERVICE, help="UART service UUID")
+    ap.add_argument("--rx", default=NUS_RX, help="UART RX characteristic (write)")
+    ap.add_argument("--tx", default=NUS_TX, help="UART TX characteristic (notify)")
+    ap.add_argument("--timeout", type=float, default=2.0, help="seconds to wait per response")
+    ap.add_argument("-v", "--verbose", action="store_true", help="verbose I/O")
+    args = ap.parse_args()
+
+    if args.action != "clear" and not args.file:
+        ap.error(f"{args.action} needs a file")
+    img = b""
+    if args.action == "import":
+        with open(args.file, "rb") as f:
+            img = f.read()
+        check_image(img, args.file)
+
+    parser = FrameParser()
+    frames: asyncio.Queue = asyncio.Queue()
+
+    def on_notify(_handle, data: bytes):
+        if args.verbose:
+            print(f"[notify] {binascii.hexlify(data).decode()}")
+        for frame in parser.feed(data):
+            frames.put_nowait(frame)
+
+    async def request(payload: bytes) -> bytes:
+        await client.write_gatt_char(args.rx, pack_frame(CMD_PROFILE_BUNDLE, payload), response=True)
+        while True:
+            frame = await asyncio.wait_for(frames.get(), timeout=args.timeout)
+            if frame[1] == RESP_PROFILE_BUNDLE:
+                return frame[3 : 3 + frame[2]]
+
+    async def step(payload: bytes, what: str) -> bytes:
+        reply = await request(payload)
+        if not reply or reply[0] != 0:
+            raise RuntimeError(f"{what} failed: status 0x{reply[0] if reply else 0xFF:02X}")
+        return reply
+
+    client = BleakClient(args.mac)
+    await client.connect()
+    if hasattr(client, "get_services"):
+        await client.get_services()
+    else:
+        _ = client.services
+    await client.start_notify(args.tx, on_notify)
+    try:
+        if args.action == "export":
+            out = bytearray()
+            while len(out) < BUNDLE_BYTES:
+                reply = await step(bytes([4]) + len(out).to_bytes(2, "big"), f"read @{len(out)}")
+                if len(reply) <= 3:
+                    break
+                out += reply[3:]
+            check_image(bytes(out), "export")
+            with open(args.file, "wb") as f:
+                f.write(out)
+            print(f"profile bundle exported: {len(out)} bytes crc=0x{int.from_bytes(out[8:12], 'big'):08X}")
+            return
+        if args.action == "clear":
+            await step(bytes([5]), "clear")
+        else:
+            await step(bytes([0]), "begin")
+            for off in range(0, len(img), CHUNK):
+                await step(bytes([1]) + off.to_bytes(4, "big") + img[off : off + CHUNK], f"write @{off}")
+            await step(bytes([2]), "finish")
+        info = await request(bytes([3]))
+        print(f"profile bundle: stored={info[2]} crc=0x{int.from_bytes(info[6:10], 'big'):08X}")
+    finally:
+        await client.stop_notify(args.tx)
+        await client.disconnect()
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+"""
+Upload the boot splash frame (command 0x5D) shown right after LCD init.
+
+The image is normally a host simulator dashboard shot:
+  ./scripts/ui_screenshot.py --page 0 --name dashboard
+  ./scripts/ble_splash_upload.py <mac> out/ui_shots/dashboard.png
+
+  0x5D op=0 begin
+       op=1 offset[4], data[...]     (sequential)
+       op=2 w[2], h[2], crc32[4]     (commit)
+       op=3 -> {ver, len, valid, uploading, w[2], h[2], crc32[4], write_offset[4]}
+
+Pixels are RGB565 big-endian, row-major; the frame must match the panel.
+
+Frame format: 0x55 | CMD | LEN | PAYLOAD | CHKSUM
+  CHKSUM = bitwise-not XOR of all prior bytes.
+"""
+
+import argparse
+import asyncio
+import binascii
+import sys
+import zlib
+from typing import List
+
+try:
+    from bleak import BleakClient
+except ImportError:
+    print("Install bleak: pip install bleak", file=sys.stderr)
+    sys.exit(1)
+
+from PIL import Image
+
+NUS_SERVICE = "0000ffe0-0000-1000-8000-00805f9b34fb"
+NUS_RX = "0000ffe9-0000-1000-8000-00805f9b34fb"  # write
+NUS_TX = "0000ffe4-0000-1000-8000-00805f9b34fb"  # notify
+
+CMD_SPLASH_UPLOAD = 0x5D
+RESP_SPLASH_UPLOAD = CMD_SPLASH_UPLOAD | 0x80
+CHUNK = 184
+PANEL_W = 240
+PANEL_H = 240
+
+
+def pack_frame(cmd: int, payload: bytes) -> bytes:
+    if len(payload) > 255:
+        raise ValueError("payload too long")
+    hdr = bytes([0x55, cmd & 0xFF, len(payload) & 0xFF])
+    x = 0
+    for b in hdr + payload:
+        x ^= b
+    cks = (~x) & 0xFF
+    return hdr + payload + bytes([cks])
+
+
+class FrameParser:
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data: bytes) -> List[bytes]:
+        self.buf.extend(data)
+        out = []
+        while len(self.buf) >= 4:
+            if self.buf[0] != 0x55:
+                del self.buf[0]
+                continue
+            frame_len = 4 + self.buf[2]
+            if len(self.buf) < frame_len:
+                break
+            frame = bytes(self.buf[:frame_len])
+            del self.buf[:frame_len]
+            x = 0
+            for b in frame[:-1]:
+                x ^= b
+            if ((~x) & 0xFF) == frame[-1]:
+                out.append(frame)
+        return out
+
+
+def rgb565_be(path: str):
+    img = Image.open(path).convert("RGB")
+    if img.size != (PANEL_W, PANEL_H):
+        raise SystemExit(f"{path}: {img.size[0]}x{img.size[1]}, panel is {PANEL_W}x{PANEL_H}")
+    out = bytearray()
+    for r, g, b in img.getdata():
+        v = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+        out += bytes([v >> 8, v & 0xFF])
+    return img.size, bytes(out)
+
+
+async def main():
+    ap = argparse.ArgumentParser(description="Upload the boot splash frame (0x5D splash_upload)")
+    ap.add_argument("mac", help="BLE MAC address (or UUID on macOS/iOS)")
+    ap.add_argument("image", help="PNG/PPM of the panel size (host simulator screenshot)")
+    ap.add_argument("--service", default=NUS_SERVICE, help="UART service UUID")
+    ap.add_argument("--rx", default=NUS_RX, help="UART RX characteristic (write)")
+    ap.add_argument("--tx", default=NUS_TX, help="UART TX characteristic (notify)")
+    ap.add_argument("--timeout", type=float, default=2.0, help="seconds to wait per response")
+    ap.add_argument("-v", "--verbose", action="store_true", help="verbose I/O")
+    args = ap.parse_args()
+
+    (w, h), pixels = rgb565_be(args.image)
+    crc = zlib.crc32(pixels) & 0xFFFFFFFF
+
+    parser = FrameParser()
+    frames: asyncio.Queue = asyncio.Queue()
+
+    def on_notify(_handle, data: bytes):
+        if args.verbose:
+            print(f"[notify] {binascii.hexlify(data).decode()}")
+        for frame in parser.feed(data):
+            frames.put_nowait(frame)
+
+    async def request(payload: bytes) -> bytes:
+        await client.write_gatt_char(args.rx, pack_frame(CMD_SPLASH_UPLOAD, payload), response=True)
+        while True:
+            frame = await asyncio.wait_for(frames.get(), timeout=args.timeout)
+            if frame[1] == RESP_SPLASH_UPLOAD:
+                return frame[3 : 3 + frame[2]]
+
+    async def step(payload: bytes, what: str):
+        reply = await request(payload)
+        if not reply or reply[0] != 0:
+            raise RuntimeError(f"{what} failed: status 0x{reply[0] if reply else 0xFF:02X}")
+
+    client = BleakClient(args.mac)
+    await client.connect()
+    if hasattr(client, "get_services"):
+        await client.get_services()
+    else:
+        _ = client.services
+    await client.start_notify(args.tx, on_notify)
+    try:
+        await step(bytes([0]), "begin")
+        for off in range(0, len(pixels), CHUNK):
+            await step(bytes([1]) + off.to_bytes(4, "big") + pixels[off : off + CHUNK], f"write @{off}")
+            if args.verbose or off % (CHUNK * 64) == 0:
+                print(f"{off * 100 // len(pixels):3d}%")
+        await step(bytes([2]) + w.to_bytes(2, "big") + h.to_bytes(2, "big") + crc.to_bytes(4, "big"), "finish")
+        info = await request(bytes([3]))
+        print(f"splash stored: valid={info[2]} {int.from_bytes(info[4:6], 'big')}x"
+              f"{int.from_bytes(info[6:8], 'big')} crc=0x{int.from_bytes(info[8:12], 'big'):08X}")
+    finally:
+        await client.stop_notify(args.tx)
+        await client.disconnect()
+
+
+if __name__ == "__main__":
+    try:
+        asyncio.run(main())
+    except KeyboardInterrupt:
+        pass
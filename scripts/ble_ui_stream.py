@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""
+Mirror the display over BLE (command 0x62) into an image file.
+
+The device streams the compositor's framebuffer as it changes: every tile
+row run of changed 16x16 tiles goes out as RLE in unsolicited 0x9A frames,
+paced by the BLE TX queue. This script starts the stream (the first pass
+carries the whole screen), applies the frames to a 240x320 canvas and
+rewrites --out every --every seconds until --seconds have passed.
+
+Data frame: {seq[2], x[2], y[2], w[2], h[2], pos[2], rle...} (big-endian
+header). `pos` is the first pixel of the rect the RLE carries, row-major.
+RLE as in lcd_stream.py: control byte c, bit7 set = (c & 0x7F) + 1 copies
+of the next pixel, clear = c + 1 literal pixels; RGB565 little-endian.
+
+A gap in seq means a frame was lost; the stream is restarted so the whole
+screen is sent again. Builds without the extended SRAM bank have no
+compositor and refuse to start (status 0xFE).
+
+Frame format: 0x55 | CMD | LEN | PAYLOAD | CHKSUM
+  CHKSUM = bitwise-not XOR of all prior bytes.
+
+Usage:
+  uv run python scripts/ble_ui_stream.py AA:BB:CC:DD:EE:FF --out live.png
+"""
+
+import argparse
+import asyncio
+import binascii
+import sys
+from pathlib import Path
+from typing import List
+
+from lcd_stream import to_rgb, write_image
+
+NUS_SERVICE = "0000ffe0-0000-1000-8000-00805f9b34fb"
+NUS_RX = "0000ffe9-0000-1000-8000-00805f9b34fb"  # write
+NUS_TX = "0000ffe4-0000-1000-8000-00805f9b34fb"  # notify
+
+CMD_UI_STREAM = 0x62
+RESP_UI_STREAM = CMD_UI_STREAM | 0x80
+CMD_UI_STREAM_DATA = 0x9A
+OP_STOP = 0
+OP_START = 1
+HEADER_BYTES = 12
+
+DISP_W = 240
+DISP_H = 320
+
+
+def pack_frame(cmd: int, payload: bytes) -> bytes:
+    if len(payload) > 255:
+        raise ValueError("payload too long")
+    hdr = bytes([0x55, cmd & 0xFF, len(payload) & 0xFF])
+    x = 0
+    for b in hdr + payload:
+        x ^= b
+    cks = (~x) & 0xFF
+    return hdr + payload + bytes([cks])
+
+
+class FrameParser:
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data: bytes) -> List[bytes]:
+        self.buf.extend(data)
+        out = []
+        while len(self.buf) >= 4:
+            if self.buf[0] != 0x55:
+                del self.buf[0]
+                continue
+            frame_len = 4 + self.buf[2]
+            if len(self.buf) < frame_len:
+                break
+            frame = bytes(self.buf[:frame_len])
+            del self.buf[:frame_len]
+            x = 0
+            for b in frame[:-1]:
+                x ^= b
+            if ((~x) & 0xFF) == frame[-1]:
+                out.append(frame)
+        return out
+
+
+def apply_chunk(fb: List[int], payload: bytes) -> int:
+    """Paints one data frame onto fb; returns its seq."""
+    if len(payload) < HEADER_BYTES:
+        raise RuntimeError(f"short ui_stream frame {binascii.hexlify(payload).decode()}")
+    seq, x, y, w, h, pos = (int.from_bytes(payload[i:i + 2], "big") for i in range(0, HEADER_BYTES, 2))
+    rle = payload[HEADER_BYTES:]
+    count = w * h
+    i = 0
+    while i < len(rle) and pos < count:
+        c = rle[i]
+        i += 1
+        if c & 0x80:
+            n = (c & 0x7F) + 1
+            px = [rle[i] | (rle[i + 1] << 8)] * n
+            i += 2
+        else:
+            n = c + 1
+            px = [rle[i + 2 * k] | (rle[i + 2 * k + 1] << 8) for k in range(n)]
+            i += 2 * n
+        for v in px:
+            if pos >= count:
+                break
+            fb[(y + pos // w) * DISP_W + x + pos % w] = v
+            pos += 1
+    return seq
+
+
+async def run(args) -> int:
+    try:
+        from bleak import BleakClient
+    except ImportError:
+        print("Install bleak: pip install bleak", file=sys.stderr)
+        return 1
+
+    parser = FrameParser()
+    replies: asyncio.Queue = asyncio.Queue()
+    fb = [0] * (DISP_W * DISP_H)
+    state = {"next_seq": 0, "frames": 0, "bytes": 0, "resyncs": 0, "resync": False}
+
+    def on_notify(_handle, data: bytes):
+        for frame in parser.feed(data):
+            payload = frame[3:3 + frame[2]]
+            if frame[1] == CMD_UI_STREAM_DATA:
+                seq = apply_chunk(fb, payload)
+                if seq != state["next_seq"] and not state["resync"]:
+                    if args.verbose:
+                        print(f"seq {seq}, expected {state['next_seq']}: restarting")
+                    state["resync"] = True
+                state["next_seq"] = (seq + 1) & 0xFFFF
+                state["frames"] += 1
+                state["bytes"] += len(payload)
+            elif frame[1] == RESP_UI_STREAM:
+                replies.put_nowait(payload)
+
+    async def request(payload: bytes) -> bytes:
+        await client.write_gatt_char(args.rx, pack_frame(CMD_UI_STREAM, payload), response=True)
+        return await asyncio.wait_for(replies.get(), timeout=args.timeout)
+
+    async def start() -> None:
+        state["next_seq"] = 0
+        status = await request(bytes([OP_START]))
+        if status[:1] != b"\x00":
+            raise RuntimeError(f"start refused: {binascii.hexlify(status).decode()} "
+                               "(no compositor without the extended SRAM bank)")
+
+    def save() -> None:
+        write_image(args.out, to_rgb(fb, DISP_W, DISP_H, args.scale), DISP_W * args.scale,
+                    DISP_H * args.scale)
+
+    client = BleakClient(args.mac)
+    await client.connect()
+    if hasattr(client, "get_services"):
+        await client.get_services()
+    else:
+        _ = client.services
+    await client.start_notify(args.tx, on_notify)
+    try:
+        await start()
+        loop = asyncio.get_running_loop()
+        end = loop.time() + args.seconds
+        while loop.time() < end:
+            await asyncio.sleep(args.every)
+            if state["resync"]:
+                state["resyncs"] += 1
+                await start()
+                state["resync"] = False
+            save()
+            if args.verbose:
+                print(f"{state['frames']} frames, {state['bytes']} bytes, {state['resyncs']} restarts")
+        await request(bytes([OP_STOP]))
+    finally:
+        await client.stop_notify(args.tx)
+        await client.disconnect()
+    save()
+    print(f"{state['frames']} frames, {state['bytes']} bytes in {args.seconds:g} s, "
+          f"{state['resyncs']} restarts; wrote {args.out}")
+    return 0
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("mac", help="BLE address")
+    ap.add_argument("--out", type=Path, default=Path("ui_stream.png"), help="image rewritten as frames arrive (.png or .ppm)")
+    ap.add_argument("--seconds", type=float, default=60.0, help="how long to stream")
+    ap.add_argument("--every", type=float, default=1.0, help="seconds between image writes")
+    ap.add_argument("--scale", type=int, default=1)
+    ap.add_argument("--timeout", type=float, default=3.0, help="reply timeout in seconds")
+    ap.add_argument("--rx", default=NUS_RX, help="write characteristic UUID")
+    ap.add_argument("--tx", default=NUS_TX, help="notify characteristic UUID")
+    ap.add_argument("-v", "--verbose", action="store_true")
+    args = ap.parse_args()
+    return asyncio.run(run(args))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
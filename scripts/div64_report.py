@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""
+List the functions that call the 64-bit division runtime.
+
+Disassembles the linked firmware and reports every call (BL or tail B) to
+the 64-bit divide helpers in libc/arm_aeabi.c, grouped by calling function,
+so a new 64-bit '/' or '%' on a hot path shows up in review. The build
+writes the report to build/div64_sites.txt; the libgcc names are matched
+too, for builds that link it or for an i386 object used to try the script.
+
+Usage:
+  ninja -C build            (writes build/div64_sites.txt)
+  python3 scripts/div64_report.py build/open_firmware [--objdump arm-none-eabi-objdump]
+"""
+
+from __future__ import annotations
+
+import argparse
+import re
+import shutil
+import subprocess
+import sys
+from collections import defaultdict
+
+HELPERS = (
+    "__aeabi_uldivmod",
+    "__aeabi_ldivmod",
+    "__aeabi_uldiv",
+    "__aeabi_ldiv",
+    "__udivmoddi4",
+    "__ldivmod_impl",
+    "__udivdi3",
+    "__divdi3",
+    "__umoddi3",
+    "__moddi3",
+    "__divmoddi4",
+)
+OBJDUMPS = ("arm-none-eabi-objdump", "llvm-objdump", "objdump")
+
+# "08012345 <name>:"
+RE_FUNC = re.compile(r"^[0-9a-f]+ <([^>]+)>:\s*$")
+# "8012346:  bl  8010000 <__aeabi_uldivmod>" (also b.w / call / jmp)
+RE_CALL = re.compile(r"^\s*[0-9a-f]+:\s.*?\b(?:bl|blx|b|b\.w|call|calll|jmp)\s+(?:0x)?[0-9a-f]+\s+<([^>+]+)(?:\+0x[0-9a-f]+)?>")
+
+
+def find_objdump(name: str | None) -> str:
+    for cand in (name,) if name else OBJDUMPS:
+        path = shutil.which(cand)
+        if path:
+            return path
+    raise SystemExit(f"no objdump found (tried {name or ', '.join(OBJDUMPS)})")
+
+
+def call_sites(lines):
+    """Yields (caller, helper) for every direct call to a 64-bit helper."""
+    func = None
+    for line in lines:
+        m = RE_FUNC.match(line)
+        if m:
+            func = m.group(1)
+            continue
+        m = RE_CALL.match(line)
+        if m and m.group(1) in HELPERS and func:
+            yield func, m.group(1)
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Callers of the 64-bit division runtime")
+    ap.add_argument("elf", help="linked firmware (build/open_firmware)")
+    ap.add_argument("--objdump", help="objdump to run (default: first of %s)" % ", ".join(OBJDUMPS))
+    ap.add_argument("-o", "--output", help="write the report here instead of stdout")
+    args = ap.parse_args()
+
+    tool = find_objdump(args.objdump)
+    dis = subprocess.run([tool, "-d", "--no-show-raw-insn", args.elf],
+                         check=True, capture_output=True, text=True).stdout
+
+    calls = defaultdict(lambda: defaultdict(int))
+    for func, helper in call_sites(dis.splitlines()):
+        if func in HELPERS:
+            continue  # the runtime calling itself
+        calls[func][helper] += 1
+
+    out = []
+    total = sum(sum(h.values()) for h in calls.values())
+    out.append(f"64-bit division call sites: {total} in {len(calls)} functions")
+    for func in sorted(calls, key=lambda f: (-sum(calls[f].values()), f)):
+        helpers = ", ".join(f"{h} x{n}" for h, n in sorted(calls[func].items()))
+        out.append(f"  {func:<40} {helpers}")
+    text = "\n".join(out) + "\n"
+
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as f:
+            f.write(text)
+    else:
+        sys.stdout.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
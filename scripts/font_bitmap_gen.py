@@ -94,6 +94,41 @@ def pack_glyphs(glyphs):
     return packed, offsets
 
 
+def build_runs(glyphs):
+    """Encode each glyph as horizontal runs of set pixels.
+
+    Format: (row, x, len) triples in row-major order; glyph i owns runs
+    [index[i], index[i + 1]). Lets the renderer emit one rect per run
+    instead of one plot per pixel. Columns are read the way the atlas
+    renderer reads packed rows (MSB of the first byte is column 0), so
+    both encodings draw the same pixels.
+    """
+    runs = []
+    index = []
+
+    for char, g in glyphs:
+        index.append(len(runs))
+        w = g['w']
+        top = (w + 7) // 8 * 8 - 1
+
+        def is_set(row_bits, col):
+            return row_bits & (1 << (top - col))
+
+        for row, row_bits in enumerate(g['bits']):
+            col = 0
+            while col < w:
+                if not is_set(row_bits, col):
+                    col += 1
+                    continue
+                start = col
+                while col < w and is_set(row_bits, col):
+                    col += 1
+                runs.append((row, start, col - start))
+
+    index.append(len(runs))
+    return runs, index
+
+
 def main():
     ap = argparse.ArgumentParser(description='Generate 1-bit bitmap font atlas')
     ap.add_argument('--font', help='Path to TTF/OTF font (default: system monospace)')
@@ -141,6 +176,7 @@ def main():
 
     # Pack glyph data
     packed, offsets = pack_glyphs(glyphs)
+    runs, run_index = build_runs(glyphs)
 
     # Generate preview if requested
     if args.preview:
@@ -198,6 +234,16 @@ def main():
         f.write(f'extern const {prefix.lower()}_glyph_t g_{prefix.lower()}_glyphs[{prefix}_COUNT];\n')
         f.write(f'extern const uint8_t g_{prefix.lower()}_bits[];\n\n')
 
+        f.write('typedef struct {\n')
+        f.write('    uint8_t row;      /* Row within glyph bitmap */\n')
+        f.write('    uint8_t x;        /* First set column */\n')
+        f.write('    uint8_t len;      /* Run length in pixels */\n')
+        f.write(f'}} {prefix.lower()}_run_t;\n\n')
+
+        f.write('/* Glyph i owns runs [run_index[i], run_index[i + 1]). */\n')
+        f.write(f'extern const uint16_t g_{prefix.lower()}_run_index[{prefix}_COUNT + 1];\n')
+        f.write(f'extern const {prefix.lower()}_run_t g_{prefix.lower()}_runs[];\n\n')
+
         # Inline lookup function
         f.write(f'static inline const {prefix.lower()}_glyph_t *{prefix.lower()}_glyph(char c) {{\n')
         f.write(f'    if ((uint8_t)c < {prefix}_FIRST || (uint8_t)c > {prefix}_LAST)\n')
@@ -240,11 +286,35 @@ def main():
                 f.write('\n')
         if len(packed) % 16 != 0:
             f.write('\n')
+        f.write('};\n\n')
+
+        # Horizontal run tables
+        f.write(f'const uint16_t g_{prefix.lower()}_run_index[{prefix}_COUNT + 1] = {{\n')
+        for i, v in enumerate(run_index):
+            if i % 12 == 0:
+                f.write('    ')
+            f.write(f'{v:4d},')
+            if i % 12 == 11:
+                f.write('\n')
+        if len(run_index) % 12 != 0:
+            f.write('\n')
+        f.write('};\n\n')
+
+        f.write(f'const {prefix.lower()}_run_t g_{prefix.lower()}_runs[] = {{\n')
+        for i, (row, x, n) in enumerate(runs):
+            if i % 6 == 0:
+                f.write('    ')
+            f.write(f'{{{row:2d},{x},{n}}},')
+            if i % 6 == 5:
+                f.write('\n')
+        if len(runs) % 6 != 0:
+            f.write('\n')
         f.write('};\n')
 
     print(f'Generated: {h_path} ({h_path.stat().st_size} bytes)')
     print(f'Generated: {c_path} ({c_path.stat().st_size} bytes)')
     print(f'Bitmap data: {len(packed)} bytes')
+    print(f'Run data: {len(runs)} runs')
     print(f'Glyph count: {len(glyphs)}')
     print(f'Font metrics: ascent={ascent}, descent={descent}, line_height={line_height}')
 
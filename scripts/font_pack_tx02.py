@@ -39,6 +39,33 @@ def pack_glyphs(glyphs, max_w):
     return placements, atlas_h
 
 
+def render_big_digits(font_path, scale):
+    """AA images of 0-9 filling the 7-segment digit box (12*scale x 20*scale).
+
+    The font size is the largest whose tallest digit fits the box; each digit
+    is centred horizontally on a shared baseline so the numbers line up.
+    """
+    box_w = 12 * scale
+    box_h = 20 * scale
+    digits = '0123456789'
+    size = box_h
+    while size > 4:
+        font = ImageFont.truetype(font_path, size)
+        boxes = [font.getbbox(d, anchor='ls') for d in digits]
+        top = min(b[1] for b in boxes)
+        bottom = max(b[3] for b in boxes)
+        if bottom - top <= box_h and max(b[2] - b[0] for b in boxes) <= box_w:
+            break
+        size -= 1
+    base_y = (box_h - (bottom - top)) // 2 - top
+    out = []
+    for d, (x0, _, x1, _) in zip(digits, boxes):
+        img = Image.new('L', (box_w, box_h), 0)
+        ImageDraw.Draw(img).text(((box_w - (x1 - x0)) // 2 - x0, base_y), d, fill=255, font=font, anchor='ls')
+        out.append(img)
+    return out
+
+
 def main():
     ap = argparse.ArgumentParser()
     ap.add_argument('--font', required=True, help='Path to TX-02 font file (.otf/.ttf)')
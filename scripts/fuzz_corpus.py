@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""
+Regenerate the fuzz seed corpora (tests/host/fuzz/corpus/<target>/) from
+host sim wire captures.
+
+Every scenario in tests/host/scenarios runs as `host_sim` with
+BC280_SIM_WIRE_CAPTURE set, which records what the motor and BLE models put
+on the display's UARTs as a bus replay image (BRPL). The captured streams
+are cut into seeds:
+
+  comm        mode byte + one BLE-side comm frame (app phase, each port),
+              plus a few multi-frame runs and monitor-phase copies
+  ble_hacker  the payload of every cmd 0x70 frame
+  motor       mode byte (DMA chunk size) + windows of the motor stream
+  config      fixed masks over the defaults blob (nothing on the wire
+              carries a whole blob, so these are hand-made)
+
+Seeds are named by content hash, so re-running only adds or removes files
+when the traffic changed.
+
+Usage:
+  scripts/fuzz_corpus.py [--host-sim PATH] [--out DIR]
+"""
+
+import argparse
+import hashlib
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+from typing import Dict, List, Tuple
+
+REPO_ROOT = Path(__file__).resolve().parent.parent
+BRPL_MAGIC = 0x4C505242
+BUS_MOTOR = 0
+BUS_BLE = 1
+COMM_SOF = 0x55
+COMM_MAX_PAYLOAD = 192
+CMD_BLE_HACKER = 0x70
+
+MAX_SEEDS = {"comm": 96, "ble_hacker": 32, "motor": 32, "config": 16}
+MOTOR_WINDOW = 256
+MOTOR_CHUNKS = (0, 7, 31, 63)  # mode byte: chunk size - 1
+
+
+def capture(host_sim: Path, scn: Path) -> bytes:
+    with tempfile.TemporaryDirectory(prefix="fuzz_corpus_") as tmp:
+        out = Path(tmp) / "wire.brpl"
+        env = dict(os.environ)
+        env["BC280_SIM_SCENARIO"] = str(scn.resolve())
+        env["BC280_SIM_WIRE_CAPTURE"] = str(out)
+        env["UI_LCD_OUTDIR"] = tmp
+        r = subprocess.run([str(host_sim.resolve())], env=env, cwd=tmp, capture_output=True, text=True)
+        if r.returncode != 0 or not out.exists():
+            raise RuntimeError(f"{scn.name}: host_sim failed\n{(r.stdout + r.stderr)[-2000:]}")
+        return out.read_bytes()
+
+
+def parse_brpl(img: bytes) -> Dict[int, bytes]:
+    magic, version, records, size, _crc = struct.unpack(">IHHII", img[:16])
+    if magic != BRPL_MAGIC or version != 1:
+        raise ValueError("not a BRPL image")
+    streams = {BUS_MOTOR: bytearray(), BUS_BLE: bytearray()}
+    pos = 16
+    end = 16 + size
+    for _ in range(records):
+        if pos + 4 > end:
+            break
+        bus, n = img[pos], img[pos + 1]
+        streams.setdefault(bus, bytearray()).extend(img[pos + 4:pos + 4 + n])
+        pos += 4 + n
+    return {k: bytes(v) for k, v in streams.items()}
+
+
+def comm_frames(stream: bytes) -> List[bytes]:
+    frames = []
+    i = 0
+    while i + 4 <= len(stream):
+        if stream[i] != COMM_SOF or stream[i + 2] > COMM_MAX_PAYLOAD:
+            i += 1
+            continue
+        total = stream[i + 2] + 4
+        frame = stream[i:i + total]
+        chk = 0
+        for b in frame[:-1]:
+            chk ^= b
+        if len(frame) == total and (~chk & 0xFF) == frame[-1]:
+            frames.append(frame)
+            i += total
+        else:
+            i += 1
+    return frames
+
+
+def add(seeds: Dict[str, Dict[bytes, None]], target: str, data: bytes) -> None:
+    bucket = seeds[target]
+    if len(bucket) < MAX_SEEDS[target]:
+        bucket.setdefault(data, None)
+
+
+def config_seeds() -> List[bytes]:
+    wheel_off = 12
+    return [
+        b"",
+        b"\x00",                                     # defaults, CRC as stored
+        b"\x01",                                     # defaults, CRC re-sealed
+        b"\x01" + bytes(wheel_off) + b"\x01\x00",    # wheel_mm changed
+        b"\x01" + bytes(14) + b"\x01",               # units flipped
+        b"\x01" + bytes(48) + b"\x04",               # curve_count
+        b"\x00" + b"\x01",                           # bad version
+        b"\x03\x01\x08\x34",                         # patch wheel_mm = 2100
+        b"\x03\x01\x08\x34\x03\x00\x02",             # patch wheel + second field
+    ]
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Regenerate fuzz seed corpora from sim wire captures")
+    ap.add_argument("--host-sim", default=str(REPO_ROOT / "build-host/tests/host/host_sim"),
+                    help="host_sim executable")
+    ap.add_argument("--scenarios", default=str(REPO_ROOT / "tests/host/scenarios"),
+                    help="scenario directory (*.scn)")
+    ap.add_argument("--out", default=str(REPO_ROOT / "tests/host/fuzz/corpus"),
+                    help="corpus root (one directory per target)")
+    args = ap.parse_args()
+
+    host_sim = Path(args.host_sim)
+    if not host_sim.exists():
+        print(f"host_sim not found: {host_sim}", file=sys.stderr)
+        return 1
+
+    seeds: Dict[str, Dict[bytes, None]] = {t: {} for t in MAX_SEEDS}
+    for scn in sorted(Path(args.scenarios).glob("*.scn")):
+        streams = parse_brpl(capture(host_sim, scn))
+        frames = comm_frames(streams.get(BUS_BLE, b""))
+        for f in frames:
+            if f[1] == CMD_BLE_HACKER:
+                add(seeds, "ble_hacker", f[3:-1])
+        by_cmd: Dict[int, bytes] = {}
+        for f in frames:
+            by_cmd.setdefault(f[1], f)
+        for cmd, f in sorted(by_cmd.items()):
+            for port in range(3):
+                add(seeds, "comm", bytes([port << 1]) + f)
+            add(seeds, "comm", b"\x01" + f)  # boot monitor
+        for i in range(0, len(frames), 8):
+            add(seeds, "comm", b"\x00" + b"".join(frames[i:i + 8]))
+
+        motor = streams.get(BUS_MOTOR, b"")
+        step = max(MOTOR_WINDOW, len(motor) // 4) if motor else 1
+        for k, off in enumerate(range(0, len(motor), step)):
+            window = motor[off:off + MOTOR_WINDOW]
+            add(seeds, "motor", bytes([MOTOR_CHUNKS[k % len(MOTOR_CHUNKS)]]) + window)
+        if motor:
+            add(seeds, "motor", b"\x80\x0a" + motor[:MOTOR_WINDOW])  # v2 capture armed
+    for s in config_seeds():
+        add(seeds, "config", s)
+
+    out_root = Path(args.out)
+    for target, bucket in seeds.items():
+        d = out_root / target
+        d.mkdir(parents=True, exist_ok=True)
+        want = {hashlib.sha1(s).hexdigest()[:16]: s for s in bucket}
+        for old in d.iterdir():
+            if old.name not in want:
+                old.unlink()
+        for name, data in sorted(want.items()):
+            (d / name).write_bytes(data)
+        print(f"{target}: {len(want)} seeds in {d}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -4,10 +4,11 @@
 #
 # Requirements:
 #   - meson/ninja build configured
-#   - ImageMagick (convert command) for PPM → PNG
+#   - python3 (scripts/lcd_stream.py converts PPM → PNG)
 #
 # Usage: ./scripts/gen_screenshots.sh [builddir]
 #   builddir defaults to 'build-host' if not specified
+#   JOBS=N limits parallel host_sim workers (default: all cores)
 
 set -e
 
@@ -44,17 +45,6 @@ echo "Repo root:    $REPO_ROOT"
 echo "Build dir:    $BUILD_DIR"
 echo "Output dir:   $OUT_DIR"
 
-# Check for ImageMagick (prefer magick, fall back to convert)
-if command -v magick &> /dev/null; then
-    IMG_CONVERT="magick"
-elif command -v convert &> /dev/null; then
-    IMG_CONVERT="convert"
-else
-    echo "Error: ImageMagick not found"
-    echo "Install with: brew install imagemagick (macOS) or apt install imagemagick (Linux)"
-    exit 1
-fi
-
 # Configure meson if needed
 if [ ! -f "$BUILD_DIR/build.ninja" ]; then
     echo "Configuring meson build..."
@@ -81,25 +71,30 @@ if [ ! -x "$HOST_SIM" ]; then
     exit 1
 fi
 
+# One scenario per page, each with its own PPM directory, run in parallel.
+# Only the last frame is needed: stream mode writes host_lcd_latest.ppm once
+# at exit instead of a PPM per frame.
+SCENARIOS="$LCD_DIR/screenshots.scn"
+: > "$SCENARIOS"
+for i in "${!PAGES[@]}"; do
+    rm -rf "$LCD_DIR/page_$i"
+    # 30 steps to let the UI stabilize
+    echo "BC280_SIM_FORCE_PAGE=$i BC280_SIM_STEPS=30 BC280_SIM_DT_MS=50 BC280_LCD_DUMP=stream UI_LCD_OUTDIR=$LCD_DIR/page_$i" >> "$SCENARIOS"
+done
+
 echo ""
-echo "Generating screenshots..."
+echo "Generating screenshots (${JOBS:-all} jobs)..."
+"$HOST_SIM" --jobs "${JOBS:-0}" "$SCENARIOS" > /dev/null 2>&1 || true
+
 for i in "${!PAGES[@]}"; do
     PAGE_NAME="${PAGES[$i]}"
-    PPM_FILE="$LCD_DIR/host_lcd_latest.ppm"
+    PPM_FILE="$LCD_DIR/page_$i/host_lcd_latest.ppm"
     PNG_FILE="$OUT_DIR/${PAGE_NAME}_screen.png"
 
     echo -n "  Page $i (${PAGE_NAME})... "
-
-    # Run simulator with forced page, 30 steps to let UI stabilize
-    BC280_SIM_FORCE_PAGE="$i" \
-    BC280_SIM_STEPS=30 \
-    BC280_SIM_DT_MS=50 \
-    UI_LCD_OUTDIR="$LCD_DIR" \
-    "$HOST_SIM" > /dev/null 2>&1 || true
-
     if [ -f "$PPM_FILE" ]; then
         # Convert PPM to PNG (2x scale for visibility)
-        $IMG_CONVERT "$PPM_FILE" -scale 200% "$PNG_FILE"
+        python3 "$SCRIPT_DIR/lcd_stream.py" png "$PPM_FILE" "$PNG_FILE" --scale 2
         echo "OK → ${PAGE_NAME}_screen.png"
     else
         echo "FAILED (no PPM output)"
@@ -0,0 +1,247 @@
+#!/usr/bin/env python3
+"""
+Play back host pixel sink frame dumps and convert them to PNG.
+
+With BC280_LCD_DUMP=stream the host sim writes one host_lcd.blcd container
+of RLE dirty-rect deltas instead of a PPM per frame (format in
+tests/host/pixel/ui_pixel_sink.c). This tool reads it back:
+
+  info    FILE                    frames drawn/stored, keyframes, size vs. the
+                                  PPM dumps of the same run
+  extract FILE --out DIR          decode frames to PNG (or --ppm); --frame N
+                                  for one frame (seeks via the keyframe
+                                  index), --every K for every Kth
+  png     IN.ppm OUT.png          convert a single PPM dump (no ImageMagick)
+
+--scale S enlarges PNG/PPM output by an integer factor.
+
+Usage:
+  scripts/lcd_stream.py info out/lcd_out/host_lcd.blcd
+  scripts/lcd_stream.py extract out/lcd_out/host_lcd.blcd --out out/frames --every 10
+  scripts/lcd_stream.py png out/lcd_out/host_lcd_latest.ppm shot.png --scale 2
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+from pathlib import Path
+from typing import Iterator, List, Tuple
+
+BLCD_VERSION = 1
+BLCD_FORMAT_RGB565 = 1
+BLCD_FLAG_KEY = 0x0001
+
+Index = Tuple[int, int, int, int]  # frame, t_ms, offset, flags
+
+
+class Stream:
+    def __init__(self, path: Path):
+        self.data = path.read_bytes()
+        d = self.data
+        if len(d) < 24 or d[:4] != b"BLCD":
+            raise ValueError(f"{path}: not a BLCD stream")
+        ver, self.w, self.h, fmt = struct.unpack_from("<HHHH", d, 4)
+        if ver != BLCD_VERSION or fmt != BLCD_FORMAT_RGB565:
+            raise ValueError(f"{path}: unsupported version {ver} / format {fmt}")
+        self.index: List[Index] = []
+        if d[-4:] == b"BEND":
+            (off,) = struct.unpack_from("<I", d, len(d) - 8)
+            if d[off:off + 4] == b"BIDX":
+                (count,) = struct.unpack_from("<I", d, off + 4)
+                self.index = [struct.unpack_from("<IIII", d, off + 8 + 16 * i) for i in range(count)]
+        if not self.index:
+            self.index = self.scan()  # no index: the run did not exit cleanly
+
+    def frame_at(self, off: int) -> Tuple[Tuple[int, int, int, int], List[Tuple[int, int, int, int, bytes]], int]:
+        d = self.data
+        frame, t_ms, fb_hash, rects, flags = struct.unpack_from("<IIIHH", d, off)
+        off += 16
+        out = []
+        for _ in range(rects):
+            x, y, w, h, n = struct.unpack_from("<HHHHI", d, off)
+            off += 12
+            out.append((x, y, w, h, d[off:off + n]))
+            off += n
+        return (frame, t_ms, fb_hash, flags), out, off
+
+    def scan(self) -> List[Index]:
+        idx: List[Index] = []
+        off = 16
+        while off + 16 <= len(self.data) and self.data[off:off + 4] != b"BIDX":
+            try:
+                (frame, t_ms, _, flags), _, nxt = self.frame_at(off)
+            except struct.error:
+                break
+            idx.append((frame, t_ms, off, flags))
+            off = nxt
+        return idx
+
+    def decode(self, start: int = 0) -> Iterator[Tuple[Index, List[int]]]:
+        """Framebuffers (RGB565 lists) from index entry `start` on; starts at
+        the keyframe at or before it so the deltas apply to the right base."""
+        key = start
+        while key > 0 and not self.index[key][3] & BLCD_FLAG_KEY:
+            key -= 1
+        fb = [0] * (self.w * self.h)
+        for i in range(key, len(self.index)):
+            _, rects, _ = self.frame_at(self.index[i][2])
+            for x, y, w, h, rle in rects:
+                apply_rle(fb, self.w, x, y, w, h, rle)
+            if i >= start:
+                yield self.index[i], fb
+
+
+def apply_rle(fb: List[int], stride: int, x: int, y: int, w: int, h: int, rle: bytes) -> None:
+    px: List[int] = []
+    i = 0
+    while i < len(rle):
+        c = rle[i]
+        i += 1
+        if c & 0x80:
+            v = rle[i] | (rle[i + 1] << 8)
+            i += 2
+            px.extend([v] * ((c & 0x7F) + 1))
+        else:
+            n = c + 1
+            px.extend(struct.unpack_from(f"<{n}H", rle, i))
+            i += 2 * n
+    for row in range(h):
+        base = (y + row) * stride + x
+        fb[base:base + w] = px[row * w:(row + 1) * w]
+
+
+def to_rgb(fb: List[int], w: int, h: int, scale: int) -> bytes:
+    out = bytearray()
+    for row in range(h):
+        line = bytearray()
+        for c in fb[row * w:(row + 1) * w]:
+            px = bytes((((c >> 11) & 0x1F) * 255 // 31, ((c >> 5) & 0x3F) * 255 // 63, (c & 0x1F) * 255 // 31))
+            line += px * scale
+        out += bytes(line) * scale
+    return bytes(out)
+
+
+def png_bytes(rgb: bytes, w: int, h: int) -> bytes:
+    def chunk(tag: bytes, body: bytes) -> bytes:
+        return struct.pack(">I", len(body)) + tag + body + struct.pack(">I", zlib.crc32(tag + body) & 0xFFFFFFFF)
+
+    stride = w * 3
+    raw = b"".join(b"\x00" + rgb[r * stride:(r + 1) * stride] for r in range(h))
+    return (b"\x89PNG\r\n\x1a\n" + chunk(b"IHDR", struct.pack(">IIBBBBB", w, h, 8, 2, 0, 0, 0)) +
+            chunk(b"IDAT", zlib.compress(raw, 9)) + chunk(b"IEND", b""))
+
+
+def write_image(path: Path, rgb: bytes, w: int, h: int) -> None:
+    if path.suffix.lower() == ".ppm":
+        path.write_bytes(f"P6\n{w} {h}\n255\n".encode() + rgb)
+    else:
+        path.write_bytes(png_bytes(rgb, w, h))
+
+
+def read_ppm(path: Path) -> Tuple[bytes, int, int]:
+    d = path.read_bytes()
+    parts: List[bytes] = []
+    off = 0
+    while len(parts) < 4:
+        while d[off:off + 1].isspace():
+            off += 1
+        if d[off:off + 1] == b"#":
+            off = d.index(b"\n", off) + 1
+            continue
+        end = off
+        while not d[end:end + 1].isspace():
+            end += 1
+        parts.append(d[off:end])
+        off = end
+    if parts[0] != b"P6" or parts[3] != b"255":
+        raise ValueError(f"{path}: not an 8-bit P6 PPM")
+    w, h = int(parts[1]), int(parts[2])
+    return d[off + 1:off + 1 + w * h * 3], w, h
+
+
+def scale_rgb(rgb: bytes, w: int, h: int, s: int) -> bytes:
+    if s == 1:
+        return rgb
+    out = bytearray()
+    for r in range(h):
+        line = b"".join(rgb[(r * w + x) * 3:(r * w + x) * 3 + 3] * s for x in range(w))
+        out += line * s
+    return bytes(out)
+
+
+def cmd_info(args) -> int:
+    st = Stream(Path(args.file))
+    keys = sum(1 for e in st.index if e[3] & BLCD_FLAG_KEY)
+    drawn = st.index[-1][0] + 1 if st.index else 0
+    raw = drawn * (st.w * st.h * 3 + 15)
+    size = len(st.data)
+    span = (st.index[-1][1] - st.index[0][1]) if st.index else 0
+    print(f"{args.file}: {st.w}x{st.h} drawn={drawn} stored={len(st.index)} keyframes={keys} span_ms={span}")
+    print(f"  bytes={size} avg_frame={size // max(1, len(st.index))} "
+          f"ppm_equivalent={raw} ratio={raw / max(1, size):.1f}x")
+    return 0
+
+
+def cmd_extract(args) -> int:
+    st = Stream(Path(args.file))
+    out = Path(args.out)
+    out.mkdir(parents=True, exist_ok=True)
+    ext = ".ppm" if args.ppm else ".png"
+    if args.frame is not None:
+        # Frames that changed nothing are not stored: show the one on screen.
+        pos = next((i for i in range(len(st.index) - 1, -1, -1) if st.index[i][0] <= args.frame), None)
+        if pos is None:
+            print(f"no frame {args.frame} (last {st.index[-1][0] if st.index else '-'})", file=sys.stderr)
+            return 1
+        frames = [next(st.decode(pos))]
+    else:
+        every = max(1, args.every)
+        frames = ((e, fb) for n, (e, fb) in enumerate(st.decode()) if n % every == 0)
+    count = 0
+    for (frame, t_ms, _, _), fb in frames:
+        rgb = to_rgb(fb, st.w, st.h, args.scale)
+        write_image(out / f"host_lcd_{frame:04d}{ext}", rgb, st.w * args.scale, st.h * args.scale)
+        count += 1
+    print(f"{count} frames written to {out}")
+    return 0
+
+
+def cmd_png(args) -> int:
+    rgb, w, h = read_ppm(Path(args.src))
+    write_image(Path(args.dst), scale_rgb(rgb, w, h, args.scale), w * args.scale, h * args.scale)
+    return 0
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Play back host LCD frame streams and convert dumps to PNG")
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    p = sub.add_parser("info", help="summarize a .blcd stream")
+    p.add_argument("file")
+    p.set_defaults(fn=cmd_info)
+    p = sub.add_parser("extract", help="decode frames from a .blcd stream")
+    p.add_argument("file")
+    p.add_argument("--out", required=True, help="output directory")
+    p.add_argument("--frame", type=int, help="only this frame number")
+    p.add_argument("--every", type=int, default=1, help="every Kth frame")
+    p.add_argument("--ppm", action="store_true", help="write PPM instead of PNG")
+    p.add_argument("--scale", type=int, default=1, help="integer upscale")
+    p.set_defaults(fn=cmd_extract)
+    p = sub.add_parser("png", help="convert a PPM dump to PNG")
+    p.add_argument("src")
+    p.add_argument("dst")
+    p.add_argument("--scale", type=int, default=1, help="integer upscale")
+    p.set_defaults(fn=cmd_png)
+    args = ap.parse_args()
+    if getattr(args, "scale", 1) < 1:
+        print("--scale must be >= 1", file=sys.stderr)
+        return 1
+    try:
+        return args.fn(args)
+    except (OSError, ValueError) as e:
+        print(e, file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -7,11 +7,29 @@ We intentionally keep these tiny and budgeted:
 - Row-compressed with a simple RLE token stream (literal / repeat / zero-run).
 
 This avoids shipping big bitmap assets while still enabling smooth icons.
+
+With --pack the icons are written as a UI asset pack for SPI flash instead
+(storage/ui_assets.h, uploaded with scripts/ble_asset_upload.py), so they
+take no internal flash at all. A4 entries are tinted by the UI at draw time;
+--tint NAME=RRGGBB[/RRGGBB] stores that icon as pre-tinted RGB565 (fg over
+bg) that the panel takes straight from flash by DMA.
+
+--digit-font FONT adds anti-aliased speed digits 0-9 rendered from a TX-02
+font at each --digit-scale (the ui_draw_big_digit() scale, default 5); the UI
+draws them in place of its 7-segment digits once every digit of a number is
+in the pack.
+
+Usage:
+  scripts/pack_ui_icons.py --pack out/ui_assets.bin
+  scripts/pack_ui_icons.py --pack out/ui_assets.bin --tint ble=5CAFFF/1A1A1A
+  scripts/pack_ui_icons.py --pack out/ui_assets.bin --digit-font TX-02.otf --digit-scale 5 --digit-scale 4
 """
 
 from __future__ import annotations
 
 import argparse
+import struct
+import zlib
 from dataclasses import dataclass
 from pathlib import Path
 
@@ -447,12 +465,103 @@ def emit_c_array(f, name: str, data: bytes) -> None:
     f.write("};\n\n")
 
 
+ASSET_FMT_RGB565 = 1
+ASSET_FMT_A4_RLE = 2
+ASSET_ENTRY_BYTES = 16
+ASSET_MAX = 32  # UI_ASSET_MAX
+ASSET_DATA_MAX = 0x10000 - 0x1000  # UI_ASSET_STORAGE_BYTES minus the header sector
+A4_MAX_BYTES = 512  # UI_SPRITE_A4_MAX_BYTES
+GLYPH_MAX_BYTES = 6144  # UI_GLYPH_CACHE_BYTES; digits go through the glyph cache
+GLYPH_MAX_W = 128  # UI_GLYPH_MAX_W
+
+
+def digit_asset_id(scale: int, digit: int) -> int:
+    """ui.c DIGIT_ASSET_ID: 'D' 'G' scale digit."""
+    return 0x44470000 | (scale << 8) | digit
+
+
+def parse_rgb(text: str) -> tuple[int, int, int]:
+    v = int(text, 16)
+    return (v >> 16) & 0xFF, (v >> 8) & 0xFF, v & 0xFF
+
+
+def tint_rgb565_be(img_l: Image.Image, fg: tuple[int, int, int], bg: tuple[int, int, int]) -> bytes:
+    """Alpha-blend fg over bg per pixel, RGB565 big-endian (SPI byte order)."""
+    out = bytearray()
+    for a in img_l.getdata():
+        r, g, b = (round(bc + (fc - bc) * a / 255) for fc, bc in zip(fg, bg))
+        v = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3)
+        out += bytes([v >> 8, v & 0xFF])
+    return bytes(out)
+
+
+def build_pack(entries: list[tuple[int, int, int, int, bytes]]) -> bytes:
+    """Pack body: count, big-endian index of (id, w, h, fmt, len, offset), then data."""
+    if not entries or len(entries) > ASSET_MAX:
+        raise SystemExit(f"asset pack holds 1..{ASSET_MAX} sprites, got {len(entries)}")
+    index = bytearray(struct.pack(">HH", len(entries), 0))
+    data = bytearray()
+    base = len(index) + len(entries) * ASSET_ENTRY_BYTES
+    for cid, w, h, fmt, blob in entries:
+        digit = (cid >> 16) == 0x4447
+        limit = GLYPH_MAX_BYTES if digit else A4_MAX_BYTES
+        if fmt == ASSET_FMT_A4_RLE and len(blob) > limit:
+            raise SystemExit(f"sprite 0x{cid:08X}: {len(blob)} bytes of A4, the UI decodes at most {limit}")
+        if digit and w > GLYPH_MAX_W:
+            raise SystemExit(f"sprite 0x{cid:08X}: {w} px wide, glyphs are at most {GLYPH_MAX_W}")
+        if len(blob) > 0xFFFF:
+            raise SystemExit(f"sprite 0x{cid:08X}: {len(blob)} bytes, entries are at most 64 KiB")
+        index += struct.pack(">IHHBBHI", cid, w, h, fmt, 0, len(blob), base + len(data))
+        data += blob
+    body = bytes(index + data)
+    if len(body) > ASSET_DATA_MAX:
+        raise SystemExit(f"asset pack is {len(body)} bytes, the flash region holds {ASSET_DATA_MAX}")
+    return body
+
+
+def digit_entries(font: str, scales: list[int]) -> list[tuple[int, int, int, int, bytes]]:
+    from font_pack_tx02 import render_big_digits
+
+    entries = []
+    for scale in scales:
+        for d, img in enumerate(render_big_digits(font, scale)):
+            entries.append((digit_asset_id(scale, d), img.width, img.height, ASSET_FMT_A4_RLE,
+                            encode_rows(pack_a4(img))))
+    return entries
+
+
+def write_pack(path: Path, icons: list[IconDef], size: int, tints: dict[str, str],
+               digits: list[tuple[int, int, int, int, bytes]]) -> None:
+    entries = []
+    for ic in icons:
+        img = ic.img if ic.img.size == (size, size) else ic.img.resize((size, size), resample=Image.LANCZOS)
+        if ic.name in tints:
+            fg, _, bg = tints[ic.name].partition("/")
+            blob = tint_rgb565_be(img, parse_rgb(fg), parse_rgb(bg or "000000"))
+            entries.append((ic.cid, size, size, ASSET_FMT_RGB565, blob))
+        else:
+            entries.append((ic.cid, size, size, ASSET_FMT_A4_RLE, encode_rows(pack_a4(img))))
+    entries += digits
+    body = build_pack(entries)
+    path.parent.mkdir(parents=True, exist_ok=True)
+    path.write_bytes(body)
+    crc = zlib.crc32(body) & 0xFFFFFFFF
+    print(f"Wrote: {path} ({len(entries)} sprites, {len(body)} bytes, crc32=0x{crc:08X})")
+
+
 def main() -> None:
     ap = argparse.ArgumentParser()
     ap.add_argument("--out", default="ui/ui_sprites", help="Output base path (no extension)")
     ap.add_argument("--preview-dir", default="out/ui_icon_previews", help="Write PNG previews here")
     ap.add_argument("--size", type=int, default=20, help="Icon size (px)")
     ap.add_argument("--scale", type=int, default=8, help="Oversample factor for AA")
+    ap.add_argument("--pack", help="Write an SPI flash asset pack here instead of C source")
+    ap.add_argument("--pack-size", type=int, default=16, help="Sprite size in the pack (ui.c ICON_SIZE)")
+    ap.add_argument("--tint", action="append", default=[], metavar="NAME=RRGGBB[/RRGGBB]",
+                    help="Store NAME pre-tinted as RGB565 (fg over bg) in the pack")
+    ap.add_argument("--digit-font", help="TX-02 font for anti-aliased speed digits in the pack")
+    ap.add_argument("--digit-scale", type=int, action="append", default=[],
+                    help="Big-digit scale to render (repeatable, default 5)")
     args = ap.parse_args()
 
     repo = Path(__file__).resolve().parents[1]
@@ -484,6 +593,15 @@ def main() -> None:
     for ic in icons:
         ic.img.save(preview_dir / f"icon_{ic.name}.png")
 
+    if args.pack:
+        tints = dict(t.split("=", 1) for t in args.tint)
+        unknown = sorted(set(tints) - {ic.name for ic in icons})
+        if unknown:
+            raise SystemExit(f"--tint: unknown icon(s) {', '.join(unknown)}")
+        digits = digit_entries(args.digit_font, args.digit_scale or [5]) if args.digit_font else []
+        write_pack(Path(args.pack), icons, int(args.pack_size), tints, digits)
+        return
+
     h_path = out_base.with_suffix(".h")
     c_path = out_base.with_suffix(".c")
 
@@ -2,8 +2,12 @@
 """
 Parse open-firmware crash dump blob (SPI flash).
 
+v2 dumps carry the flight recorder ring (last scheduler dispatches, event
+publishes and motor frames, DWT-stamped) and print it as a timeline ending at
+the fault. v1 dumps (152 bytes, no ring) still parse.
+
 Usage:
-  uv run python scripts/parse_crash_dump.py crash_dump.bin
+  uv run python scripts/parse_crash_dump.py crash_dump.bin [--mhz 120]
 """
 
 from __future__ import annotations
@@ -14,11 +18,16 @@ import sys
 
 
 CRASH_DUMP_MAGIC = 0x43525348  # 'CRSH'
-CRASH_DUMP_VERSION = 1
+CRASH_DUMP_VERSION = 2
 CRASH_DUMP_EVENT_MAX = 4
 CRASH_DUMP_HEADER_SIZE = 72
 EVENT_LOG_RECORD_SIZE = 20
-CRASH_DUMP_SIZE = CRASH_DUMP_HEADER_SIZE + (CRASH_DUMP_EVENT_MAX * EVENT_LOG_RECORD_SIZE)
+CRASH_DUMP_FLIGHT_MAX = 64
+FLIGHT_REC_ENTRY_SIZE = 8
+CRASH_DUMP_FLIGHT_BASE = CRASH_DUMP_HEADER_SIZE + (CRASH_DUMP_EVENT_MAX * EVENT_LOG_RECORD_SIZE)
+CRASH_DUMP_SIZE_V1 = CRASH_DUMP_FLIGHT_BASE
+CRASH_DUMP_SIZE = CRASH_DUMP_FLIGHT_BASE + 8 + (CRASH_DUMP_FLIGHT_MAX * FLIGHT_REC_ENTRY_SIZE)
+SIZE_BY_VERSION = {1: CRASH_DUMP_SIZE_V1, 2: CRASH_DUMP_SIZE}
 
 OFF_MAGIC = 0
 OFF_VERSION = 4
@@ -41,6 +50,17 @@ OFF_EVENT_COUNT = 64
 OFF_EVENT_REC_SIZE = 66
 OFF_EVENT_SEQ = 68
 OFF_EVENT_RECORDS = 72
+OFF_FLIGHT_COUNT = CRASH_DUMP_FLIGHT_BASE
+OFF_FLIGHT_REC_SIZE = CRASH_DUMP_FLIGHT_BASE + 2
+OFF_FLIGHT_HEAD = CRASH_DUMP_FLIGHT_BASE + 4
+OFF_FLIGHT_RECORDS = CRASH_DUMP_FLIGHT_BASE + 8
+
+# flight_kind_t (src/kernel/flight_rec.h)
+FLIGHT_SCHED = 1
+FLIGHT_EVENT = 2
+FLIGHT_MOTOR_RX = 3
+FLIGHT_MOTOR_TX = 4
+FLIGHT_BOOT = 5
 
 
 def be16(buf: bytes, off: int) -> int:
@@ -61,30 +81,72 @@ def crc32_compute(data: bytes) -> int:
     return (~crc) & 0xFFFFFFFF
 
 
+def flight_describe(kind: int, a: int, b: int) -> str:
+    if kind == FLIGHT_SCHED:
+        return f"sched   slot={a} now_ms=..{b:04X}"
+    if kind == FLIGHT_EVENT:
+        return f"event   type=0x{a:02X} payload=0x{b:04X}"
+    if kind == FLIGHT_MOTOR_RX:
+        return f"motor<  op=0x{a:02X} proto={b >> 8} ok={b & 1}"
+    if kind == FLIGHT_MOTOR_TX:
+        return f"motor>  op=0x{a:02X} len={b}"
+    if kind == FLIGHT_BOOT:
+        return f"boot    reset_flags=0x{b:04X}"
+    return f"kind={kind} a=0x{a:02X} b=0x{b:04X}"
+
+
+def print_flight(data: bytes, mhz: float) -> None:
+    count = be16(data, OFF_FLIGHT_COUNT)
+    rec_size = be16(data, OFF_FLIGHT_REC_SIZE)
+    head = be32(data, OFF_FLIGHT_HEAD)
+    print(f"flight: entries={count} size={rec_size} total_logged={head}")
+    if not count or rec_size < FLIGHT_REC_ENTRY_SIZE:
+        return
+    rows = []
+    for i in range(min(count, CRASH_DUMP_FLIGHT_MAX)):
+        off = OFF_FLIGHT_RECORDS + (i * rec_size)
+        rows.append((be32(data, off), data[off + 4], data[off + 5], be16(data, off + 6)))
+    # Times are relative to the last entry (closest to the fault); cycle
+    # stamps wrap every 2^32 and restart at each boot marker.
+    last = rows[-1][0]
+    print(f"{'t-fault us':>12}  {'dt us':>9}  entry")
+    prev = None
+    for cycles, kind, a, b in rows:
+        rel = -(((last - cycles) & 0xFFFFFFFF) / mhz)
+        dt = "" if prev is None else f"{((cycles - prev) & 0xFFFFFFFF) / mhz:9.1f}"
+        print(f"{rel:12.1f}  {dt:>9}  {flight_describe(kind, a, b)}")
+        prev = cycles
+
+
 def main() -> int:
     ap = argparse.ArgumentParser(description="Parse open-firmware crash dump blob")
     ap.add_argument("path", help="path to crash dump binary")
+    ap.add_argument("--mhz", type=float, default=120.0, help="core clock for cycle stamps")
     args = ap.parse_args()
 
     with open(args.path, "rb") as f:
         data = f.read()
 
-    if len(data) < CRASH_DUMP_SIZE:
-        print(f"error: file too small ({len(data)} bytes), expected {CRASH_DUMP_SIZE}", file=sys.stderr)
+    if len(data) < CRASH_DUMP_SIZE_V1:
+        print(f"error: file too small ({len(data)} bytes), expected {CRASH_DUMP_SIZE_V1}+", file=sys.stderr)
         return 2
 
     magic = be32(data, OFF_MAGIC)
     version = be16(data, OFF_VERSION)
     size = be16(data, OFF_SIZE)
     crc_expected = be32(data, OFF_CRC)
+    want_size = SIZE_BY_VERSION.get(version, CRASH_DUMP_SIZE)
+    if len(data) < want_size:
+        print(f"error: file too small ({len(data)} bytes), v{version} needs {want_size}", file=sys.stderr)
+        return 2
 
-    data_crc = bytearray(data[:CRASH_DUMP_SIZE])
+    data_crc = bytearray(data[:want_size])
     data_crc[OFF_CRC : OFF_CRC + 4] = b"\x00\x00\x00\x00"
     crc_actual = crc32_compute(data_crc)
 
     print(f"magic=0x{magic:08X} ({'OK' if magic == CRASH_DUMP_MAGIC else 'BAD'})")
-    print(f"version={version} ({'OK' if version == CRASH_DUMP_VERSION else 'BAD'})")
-    print(f"size={size} bytes ({'OK' if size == CRASH_DUMP_SIZE else 'BAD'})")
+    print(f"version={version} ({'OK' if version in SIZE_BY_VERSION else 'BAD'})")
+    print(f"size={size} bytes ({'OK' if size == want_size else 'BAD'})")
     print(f"crc=0x{crc_expected:08X} ({'OK' if crc_expected == crc_actual else 'BAD'}), computed=0x{crc_actual:08X}")
 
     print(f"seq={be32(data, OFF_SEQ)} ms={be32(data, OFF_MS)} flags=0x{be32(data, OFF_FLAGS):08X}")
@@ -105,6 +167,9 @@ def main() -> int:
             raw = data[off : off + event_size]
             print(f"event[{i}]={binascii.hexlify(raw).decode()}")
 
+    if version >= 2:
+        print_flight(data, args.mhz)
+
     return 0
 
 
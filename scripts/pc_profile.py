@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+"""
+Sample the running firmware's PC over BLE (command 0x60) and symbolize it.
+
+The device records the PC and LR stacked by a TIM4 interrupt at --rate Hz
+into a RAM ring; this script starts it, drains the ring while the bike runs,
+stops it, then maps every sample to a function with the ELF's symbol table.
+
+Output:
+  - a flat profile (self samples per function) on stdout
+  - --folded FILE: "caller;function count" lines for flamegraph.pl or
+    speedscope. The caller is the function LR points into, which is exact
+    for leaf functions and the last call site otherwise; samples in ISRs
+    and PendSV name the handler that was preempted.
+  - --save FILE keeps the raw samples (pc[4], lr[4] little-endian pairs) so
+    --load FILE can symbolize them again later against another ELF.
+
+Read reply: {ver[1]=1, running[1], rate_hz[2], pending[2], capacity[2],
+total[4], dropped[4], n[1], n x {pc[4], lr[4]}} (big-endian).
+
+Frame format: 0x55 | CMD | LEN | PAYLOAD | CHKSUM
+  CHKSUM = bitwise-not XOR of all prior bytes.
+
+Usage:
+  uv run python scripts/pc_profile.py AA:BB:CC:DD:EE:FF --seconds 30 \\
+      --elf build/open_firmware --folded ride.folded
+"""
+
+import argparse
+import asyncio
+import binascii
+import bisect
+import shutil
+import struct
+import subprocess
+import sys
+from collections import Counter
+from typing import List, Tuple
+
+NUS_SERVICE = "0000ffe0-0000-1000-8000-00805f9b34fb"
+NUS_RX = "0000ffe9-0000-1000-8000-00805f9b34fb"  # write
+NUS_TX = "0000ffe4-0000-1000-8000-00805f9b34fb"  # notify
+
+CMD_PC_PROFILE = 0x60
+RESP_PC_PROFILE = CMD_PC_PROFILE | 0x80
+OP_START = 0
+OP_STOP = 1
+OP_READ = 2
+HEADER_BYTES = 17
+
+
+def pack_frame(cmd: int, payload: bytes) -> bytes:
+    if len(payload) > 255:
+        raise ValueError("payload too long")
+    hdr = bytes([0x55, cmd & 0xFF, len(payload) & 0xFF])
+    x = 0
+    for b in hdr + payload:
+        x ^= b
+    cks = (~x) & 0xFF
+    return hdr + payload + bytes([cks])
+
+
+class FrameParser:
+    def __init__(self):
+        self.buf = bytearray()
+
+    def feed(self, data: bytes) -> List[bytes]:
+        self.buf.extend(data)
+        out = []
+        while len(self.buf) >= 4:
+            if self.buf[0] != 0x55:
+                del self.buf[0]
+                continue
+            frame_len = 4 + self.buf[2]
+            if len(self.buf) < frame_len:
+                break
+            frame = bytes(self.buf[:frame_len])
+            del self.buf[:frame_len]
+            x = 0
+            for b in frame[:-1]:
+                x ^= b
+            if ((~x) & 0xFF) == frame[-1]:
+                out.append(frame)
+        return out
+
+
+def parse_read(payload: bytes) -> Tuple[dict, List[Tuple[int, int]]]:
+    if len(payload) < HEADER_BYTES or payload[0] != 1:
+        raise RuntimeError(f"unexpected pc_profile reply {binascii.hexlify(payload).decode()}")
+    info = {
+        "running": payload[1],
+        "rate_hz": int.from_bytes(payload[2:4], "big"),
+        "pending": int.from_bytes(payload[4:6], "big"),
+        "capacity": int.from_bytes(payload[6:8], "big"),
+        "total": int.from_bytes(payload[8:12], "big"),
+        "dropped": int.from_bytes(payload[12:16], "big"),
+    }
+    n = payload[16]
+    samples = []
+    for i in range(n):
+        off = HEADER_BYTES + 8 * i
+        samples.append((int.from_bytes(payload[off : off + 4], "big"),
+                        int.from_bytes(payload[off + 4 : off + 8], "big")))
+    return info, samples
+
+
+async def collect(args) -> List[Tuple[int, int]]:
+    try:
+        from bleak import BleakClient
+    except ImportError:
+        print("Install bleak: pip install bleak", file=sys.stderr)
+        sys.exit(1)
+
+    parser = FrameParser()
+    frames: asyncio.Queue = asyncio.Queue()
+
+    def on_notify(_handle, data: bytes):
+        if args.verbose:
+            print(f"[notify] {binascii.hexlify(data).decode()}")
+        for frame in parser.feed(data):
+            frames.put_nowait(frame)
+
+    async def request(payload: bytes) -> bytes:
+        await client.write_gatt_char(args.rx, pack_frame(CMD_PC_PROFILE, payload), response=True)
+        while True:
+            frame = await asyncio.wait_for(frames.get(), timeout=args.timeout)
+            if frame[1] == RESP_PC_PROFILE:
+                return frame[3 : 3 + frame[2]]
+
+    client = BleakClient(args.mac)
+    await client.connect()
+    if hasattr(client, "get_services"):
+        await client.get_services()
+    else:
+        _ = client.services
+    await client.start_notify(args.tx, on_notify)
+    samples: List[Tuple[int, int]] = []
+    info = {}
+    try:
+        status = await request(bytes([OP_START]) + args.rate.to_bytes(2, "big"))
+        if status[:1] != b"\x00":
+            raise RuntimeError(f"start refused: {binascii.hexlify(status).decode()}")
+        loop = asyncio.get_running_loop()
+        end = loop.time() + args.seconds
+        while True:
+            stopping = loop.time() >= end
+            if stopping:
+                await request(bytes([OP_STOP]))
+            # Drain everything pending before the next poll.
+            while True:
+                info, got = parse_read(await request(bytes([OP_READ, 0])))
+                samples.extend(got)
+                if not got or info["pending"] == 0:
+                    break
+            if stopping:
+                break
+            if args.verbose:
+                print(f"{len(samples)} samples, {info['dropped']} dropped")
+            await asyncio.sleep(args.poll)
+    finally:
+        await client.stop_notify(args.tx)
+        await client.disconnect()
+    if info:
+        print(f"{len(samples)} samples at {info['rate_hz']} Hz "
+              f"({info['total']} taken, {info['dropped']} dropped by a full "
+              f"{info['capacity']}-entry ring)")
+    return samples
+
+
+class Symbols:
+    """Function ranges from `nm -n -S --defined-only`."""
+
+    def __init__(self, elf: str, nm: str):
+        out = subprocess.run([nm, "-n", "-S", "--defined-only", elf],
+                             check=True, capture_output=True, text=True).stdout
+        rows = []
+        for line in out.splitlines():
+            parts = line.split()
+            if len(parts) != 4 or parts[2] not in ("T", "t", "W", "w"):
+                continue
+            start = int(parts[0], 16) & ~1
+            rows.append((start, start + int(parts[1], 16), parts[3]))
+        rows.sort()
+        self.starts = [r[0] for r in rows]
+        self.rows = rows
+
+    def lookup(self, addr: int) -> str:
+        addr &= ~1
+        i = bisect.bisect_right(self.starts, addr) - 1
+        if i >= 0:
+            start, end, name = self.rows[i]
+            if addr < end:
+                return name
+        return f"0x{addr:08X}"
+
+
+def find_nm(wanted: str) -> str:
+    for name in ([wanted] if wanted else ["llvm-nm", "arm-none-eabi-nm", "nm"]):
+        if shutil.which(name):
+            return name
+    print("no nm found; pass --nm", file=sys.stderr)
+    sys.exit(1)
+
+
+def report(samples: List[Tuple[int, int]], syms: Symbols, top: int, folded: str):
+    if not samples:
+        print("no samples")
+        return
+    flat = Counter()
+    stacks = Counter()
+    for pc, lr in samples:
+        fn = syms.lookup(pc)
+        flat[fn] += 1
+        # EXC_RETURN in LR means the interrupt landed on a handler's first
+        # instructions: there is no caller to show.
+        caller = "exception" if (lr & 0xFFFFFF00) == 0xFFFFFF00 else syms.lookup(lr)
+        stacks[(caller, fn) if caller != fn else (fn,)] += 1
+    total = len(samples)
+    print(f"{'samples':>8} {'%':>6}  function")
+    for fn, n in flat.most_common(top):
+        print(f"{n:>8} {100.0 * n / total:>5.1f}%  {fn}")
+    if folded:
+        with open(folded, "w") as f:
+            for stack, n in sorted(stacks.items()):
+                f.write(f"{';'.join(stack)} {n}\n")
+        print(f"folded stacks -> {folded}")
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Statistical PC profile over BLE (0x60 pc_profile)")
+    ap.add_argument("mac", nargs="?", help="BLE MAC address (or UUID on macOS/iOS)")
+    ap.add_argument("--elf", default="build/open_firmware", help="firmware ELF for symbols")
+    ap.add_argument("--nm", default="", help="nm binary (default: llvm-nm, arm-none-eabi-nm, nm)")
+    ap.add_argument("--rate", type=int, default=1000, help="samples per second (10..10000)")
+    ap.add_argument("--seconds", type=float, default=10.0, help="how long to sample")
+    ap.add_argument("--poll", type=float, default=0.2, help="seconds between ring drains")
+    ap.add_argument("--top", type=int, default=30, help="functions in the flat profile")
+    ap.add_argument("--folded", default="", help="write folded stacks for a flame graph")
+    ap.add_argument("--save", default="", help="write raw samples")
+    ap.add_argument("--load", default="", help="read raw samples instead of sampling")
+    ap.add_argument("--service", default=NUS_SERVICE, help="UART service UUID")
+    ap.add_argument("--rx", default=NUS_RX, help="UART RX characteristic (write)")
+    ap.add_argument("--tx", default=NUS_TX, help="UART TX characteristic (notify)")
+    ap.add_argument("--timeout", type=float, default=2.0, help="seconds to wait per response")
+    ap.add_argument("-v", "--verbose", action="store_true", help="verbose I/O")
+    args = ap.parse_args()
+
+    if args.load:
+        with open(args.load, "rb") as f:
+            raw = f.read()
+        samples = [s for s in struct.iter_unpack("<II", raw[: len(raw) - len(raw) % 8])]
+    else:
+        if not args.mac:
+            ap.error("mac is required unless --load is given")
+        try:
+            samples = asyncio.run(collect(args))
+        except KeyboardInterrupt:
+            return
+    if args.save:
+        with open(args.save, "wb") as f:
+            for pc, lr in samples:
+                f.write(struct.pack("<II", pc, lr))
+    report(samples, Symbols(args.elf, find_nm(args.nm)), args.top, args.folded)
+
+
+if __name__ == "__main__":
+    main()
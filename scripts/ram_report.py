@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+Static RAM report from the firmware link map.
+
+Sums the .data, .bss and .noinit input sections of build/open_firmware.map
+by subsystem (source directory) and lists the largest objects, so growing a
+buffer or cache can be checked against the 96 KB of SRAM and the stack that
+is left above .bss. .noinit holds NOINIT state and RAM_NOZERO buffers, which
+take SRAM but no time at reset. Buffers placed in the 128 KB EOPB0 extension (.ram_ext)
+are listed in their own column and do not count against the default bank.
+RAMFUNC code (.ramfunc) is copied into .data at reset and counts as .data.
+In an LTO link most objects are the linker's ltrans partitions and land
+under "other"; the largest-objects list is unaffected.
+
+Usage:
+  ninja -C build ram_report
+  python3 scripts/ram_report.py build/open_firmware.map [--top 20]
+"""
+
+from __future__ import annotations
+
+import argparse
+import os
+import re
+import sys
+from collections import defaultdict
+
+SRAM_BYTES = 96 * 1024
+RAM_EXT_BYTES = 128 * 1024
+KINDS = (".data", ".bss", ".noinit", ".ram_ext")
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# " .bss.name  0xADDR  0xSIZE  file" (the name may sit alone on the line above)
+RE_INPUT = re.compile(r"^ (\.(?:data|bss|noinit|ram_ext|ramfunc)\S*|COMMON)(?:\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+))?\s*$")
+RE_CONT = re.compile(r"^\s+(0x[0-9a-f]+)\s+(0x[0-9a-f]+)\s+(\S+)\s*$")
+RE_OUTPUT = re.compile(r"^(\.\S+)\s")
+
+
+def source_subsystems() -> dict[str, str]:
+    """Meson object basename (path with '/' -> '_') -> subsystem directory."""
+    out = {}
+    for dirpath, dirnames, filenames in os.walk(ROOT):
+        rel = os.path.relpath(dirpath, ROOT)
+        if rel.startswith(("build", "tests", "out", ".")) and rel != ".":
+            dirnames[:] = []
+            continue
+        for name in filenames:
+            if not name.endswith(".c"):
+                continue
+            path = os.path.normpath(os.path.join(rel, name))
+            parts = path.split(os.sep)
+            if parts[0] == "src" and len(parts) > 2:
+                sub = "/".join(parts[:2])
+            elif len(parts) > 1:
+                sub = parts[0]
+            else:
+                sub = "."
+            out[path.replace(os.sep, "_") + ".o"] = sub
+    return out
+
+
+def subsystem_of(obj: str, table: dict[str, str]) -> str:
+    base = os.path.basename(obj)
+    if "(" in base:  # archive member: libgcc.a(_udivsi3.o)
+        lib, member = base.split("(", 1)
+        member = member.rstrip(")")
+        if member in table:  # libopen_firmware_speed.a(gfx_ui_lcd.c.o)
+            return table[member]
+        return "lib:" + lib
+    if base in table:
+        return table[base]
+    # Other build layouts prefix the mangled path; take the longest tail match.
+    best = max((k for k in table if base.endswith(k)), key=len, default=None)
+    return table[best] if best else "other"
+
+
+def parse_map(path: str):
+    """Yields (kind, section, size, object) for every SRAM input section."""
+    output = None
+    pending = None
+    in_map = False
+    with open(path, encoding="utf-8", errors="replace") as f:
+        for line in f:
+            if not in_map:
+                in_map = line.startswith("Linker script and memory map")
+                continue
+            m = RE_OUTPUT.match(line)
+            if m:
+                output = m.group(1)
+                pending = None
+                continue
+            if output not in KINDS:
+                continue
+            if pending:
+                c = RE_CONT.match(line)
+                pending_name, pending = pending, None
+                if c:
+                    yield output, pending_name, int(c.group(2), 16), c.group(3)
+                continue
+            m = RE_INPUT.match(line)
+            if not m:
+                continue
+            if m.group(2) is None:
+                pending = m.group(1)
+                continue
+            yield output, m.group(1), int(m.group(3), 16), m.group(4)
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Per-subsystem .data/.bss/.noinit from a GNU ld map")
+    ap.add_argument("map", help="linker map (build/open_firmware.map)")
+    ap.add_argument("--top", type=int, default=15, help="largest objects to list")
+    args = ap.parse_args()
+
+    table = source_subsystems()
+    by_sub = defaultdict(lambda: [0, 0, 0, 0])
+    objects = []
+    for kind, section, size, obj in parse_map(args.map):
+        if size == 0:
+            continue
+        sub = subsystem_of(obj, table)
+        by_sub[sub][KINDS.index(kind)] += size
+        name = section.split(".", 2)[2] if section.count(".") >= 2 else section
+        objects.append((size, kind, name, sub))
+
+    if not objects:
+        print(f"no .data/.bss input sections found in {args.map}", file=sys.stderr)
+        return 1
+
+    total_data = sum(v[0] for v in by_sub.values())
+    total_bss = sum(v[1] for v in by_sub.values())
+    total_noinit = sum(v[2] for v in by_sub.values())
+    total_ext = sum(v[3] for v in by_sub.values())
+    print(f"{'subsystem':<16} {'.data':>8} {'.bss':>8} {'.noinit':>8} {'total':>8} {'.ram_ext':>9}")
+    for sub, (d, b, n, x) in sorted(by_sub.items(), key=lambda kv: -sum(kv[1][:3])):
+        print(f"{sub:<16} {d:>8} {b:>8} {n:>8} {d + b + n:>8} {x:>9}")
+    static = total_data + total_bss + total_noinit
+    print(f"{'total':<16} {total_data:>8} {total_bss:>8} {total_noinit:>8} {static:>8} {total_ext:>9}")
+    print(f"\nstatic RAM {static} of {SRAM_BYTES} bytes; {SRAM_BYTES - static} left for the stack")
+    print(f"extension {total_ext} of {RAM_EXT_BYTES} bytes (224 KB mode only)")
+    print("(compare with the stack peak from comm 0x2E ram_stats)")
+
+    print("\nlargest objects:")
+    for size, kind, name, sub in sorted(objects, reverse=True)[: args.top]:
+        print(f"{size:>8}  {kind:<8}  {sub:<16} {name}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
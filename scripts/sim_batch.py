@@ -0,0 +1,155 @@
+#!/usr/bin/env python3
+"""
+Run a directory of host sim scenarios (*.scn) and diff their metrics against
+a baseline.
+
+Each scenario runs as `host_sim` with BC280_SIM_SCENARIO set; the sim prints
+one deterministic `SIM METRICS:` line (UI frame hash, frame count, estimated
+LCD bus time, energy, distance, SoC, injected BLE frames). Metrics are
+compared with the baseline JSON next to the scenarios:
+
+  - lcd_* / btn_lcd_us are performance metrics: growing by more than --tol
+    percent is a regression, shrinking is reported as an improvement;
+  - every other metric (and the hash) must match exactly - a mismatch means
+    the scenario behaves differently. Re-run with --update when that is
+    intended and commit the new baseline with the change.
+
+With --profile DIR (and --host-sim pointing at host_sim_prof) every
+scenario also writes DIR/<name>.folded, a firmware-only flame graph input;
+see tests/host/sim/sim_prof.h.
+
+Usage:
+  scripts/sim_batch.py [scenario_dir] [--host-sim PATH] [--update] [--jobs N]
+                       [--profile DIR]
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+from concurrent.futures import ThreadPoolExecutor
+from pathlib import Path
+from typing import Dict, Optional, Tuple
+
+PERF_KEYS = ("lcd_avg_us", "lcd_max_us", "lcd_tick_max_us", "btn_lcd_us", "flash_busy_us")
+REPO_ROOT = Path(__file__).resolve().parent.parent
+
+
+def parse_metrics(stdout: str) -> Optional[Dict[str, object]]:
+    for line in stdout.splitlines():
+        if not line.startswith("SIM METRICS:"):
+            continue
+        out: Dict[str, object] = {}
+        for tok in line[len("SIM METRICS:"):].split():
+            key, _, val = tok.partition("=")
+            if key in ("name", "hash"):
+                out[key] = val
+            else:
+                out[key] = int(val)
+        return out
+    return None
+
+
+def run_scenario(host_sim: Path, scn: Path, profile: Optional[Path]) -> Tuple[str, Optional[Dict[str, object]], str]:
+    with tempfile.TemporaryDirectory(prefix="sim_batch_") as tmp:
+        env = dict(os.environ)
+        env["BC280_SIM_SCENARIO"] = str(scn.resolve())
+        env["UI_LCD_OUTDIR"] = tmp
+        if profile:
+            env["BC280_SIM_PROFILE"] = str(profile)
+        r = subprocess.run([str(host_sim.resolve())], env=env, cwd=tmp, capture_output=True, text=True)
+    metrics = parse_metrics(r.stdout)
+    if r.returncode != 0 or metrics is None:
+        return scn.stem, None, (r.stdout + r.stderr)[-2000:]
+    return scn.stem, metrics, ""
+
+
+def compare(name: str, got: Dict[str, object], want: Optional[Dict[str, object]], tol: float) -> int:
+    if want is None:
+        print(f"  {name}: NEW (no baseline)")
+        return 1
+    bad = 0
+    notes = []
+    for key in sorted(set(got) | set(want)):
+        g, w = got.get(key), want.get(key)
+        if g == w:
+            continue
+        if key in PERF_KEYS and isinstance(g, int) and isinstance(w, int):
+            if g > w * (1.0 + tol / 100.0):
+                notes.append(f"{key} {w} -> {g} REGRESSION")
+                bad = 1
+            else:
+                notes.append(f"{key} {w} -> {g}")
+        else:
+            notes.append(f"{key} {w} -> {g} CHANGED")
+            bad = 1
+    status = "FAIL" if bad else "ok"
+    print(f"  {name}: {status}" + (": " + ", ".join(notes) if notes else ""))
+    return bad
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Run host sim scenarios and diff metrics against a baseline")
+    ap.add_argument("dir", nargs="?", default=str(REPO_ROOT / "tests/host/scenarios"),
+                    help="scenario directory (*.scn)")
+    ap.add_argument("--host-sim", default=str(REPO_ROOT / "build-host/tests/host/host_sim"),
+                    help="host_sim executable")
+    ap.add_argument("--baseline", help="baseline JSON (default: <dir>/baseline.json)")
+    ap.add_argument("--update", action="store_true", help="rewrite the baseline from this run")
+    ap.add_argument("--jobs", type=int, default=os.cpu_count() or 1, help="parallel scenarios")
+    ap.add_argument("--tol", type=float, default=5.0, help="allowed perf metric growth in percent")
+    ap.add_argument("--profile", help="write <name>.folded per scenario here (host_sim_prof only)")
+    args = ap.parse_args()
+
+    scn_dir = Path(args.dir)
+    host_sim = Path(args.host_sim)
+    baseline_path = Path(args.baseline) if args.baseline else scn_dir / "baseline.json"
+    scenarios = sorted(scn_dir.glob("*.scn"))
+    if not scenarios:
+        print(f"no scenarios in {scn_dir}", file=sys.stderr)
+        return 1
+    if not host_sim.exists():
+        print(f"host_sim not found: {host_sim}", file=sys.stderr)
+        return 1
+
+    profile = Path(args.profile).resolve() if args.profile else None
+    if profile:
+        profile.mkdir(parents=True, exist_ok=True)
+
+    with ThreadPoolExecutor(max_workers=max(1, args.jobs)) as pool:
+        results = list(pool.map(lambda s: run_scenario(host_sim, s, profile), scenarios))
+
+    baseline: Dict[str, Dict[str, object]] = {}
+    if baseline_path.exists():
+        baseline = json.loads(baseline_path.read_text())
+
+    failed = 0
+    current: Dict[str, Dict[str, object]] = {}
+    print(f"{len(results)} scenarios, baseline {baseline_path}")
+    for name, metrics, log in results:
+        if metrics is None:
+            print(f"  {name}: RUN FAILED\n{log}")
+            failed += 1
+            continue
+        current[name] = metrics
+        if not args.update:
+            failed += compare(name, metrics, baseline.get(name), args.tol)
+
+    if args.update:
+        if failed:
+            print("not updating baseline: some scenarios failed to run", file=sys.stderr)
+            return 1
+        baseline_path.write_text(json.dumps(current, indent=2, sort_keys=True) + "\n")
+        print(f"baseline written: {baseline_path}")
+        return 0
+    for name in sorted(set(baseline) - {r[0] for r in results}):
+        print(f"  {name}: MISSING (in baseline, not run)")
+        failed += 1
+    print("SIM BATCH " + ("FAIL" if failed else "PASS"))
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Decode binary trace records (src/core/trace_bin.h) from a UART1 capture.
+
+With debug output bit 0x04 (DEBUG_UART_BINARY) set via comm 0x0F, the
+firmware sends status and UI traces as 0x97 frames instead of text lines.
+This script scans a raw byte capture (or the simulator's sim_ui_trace.bin)
+for those frames and prints the same text lines the firmware would have
+formatted, so existing log tooling keeps working. Other frames and bytes
+are skipped.
+
+Usage:
+  python3 scripts/trace_decode.py capture.bin
+  python3 scripts/trace_decode.py out/sim/sim_ui_trace.bin --json
+  cat /tmp/uart1.raw | python3 scripts/trace_decode.py -
+"""
+
+from __future__ import annotations
+
+import argparse
+import json
+import struct
+import sys
+
+COMM_SOF = 0x55
+COMM_MAX_PAYLOAD = 192
+TRACE_FRAME_CMD = 0x97
+
+# schema -> (name, struct format, field names); little-endian, no padding.
+SCHEMAS = {
+    0x01: ("status", "<IHHHBB", ("ms", "rpm", "tq", "speed_dmph", "soc", "err")),
+    0x02: (
+        "ui",
+        "<IIHHHHhhHHHBBB3x",
+        ("ms", "hash", "dt", "spd", "cad", "pwr", "bv", "bi", "limw", "dirty", "ops", "soc", "lrsn", "page"),
+    ),
+    0x03: (
+        "eng",
+        "<HHHHhhhhHhHBBBBBBBx",
+        (
+            "spd", "rpm", "cad", "tq", "bv", "bi", "phase", "sag", "therm", "temp", "limw",
+            "page", "thr", "brk", "btn", "soc", "err", "lrsn",
+        ),
+    ),
+}
+
+ENG_ORDER = (
+    "spd", "rpm", "cad", "tq", "thr", "brk", "btn", "soc", "err",
+    "bv", "bi", "phase", "sag", "therm", "temp", "limw", "lrsn",
+)
+
+
+def checksum(buf: bytes) -> int:
+    x = 0
+    for b in buf:
+        x ^= b
+    return (~x) & 0xFF
+
+
+def frames(data: bytes):
+    """Yields (cmd, payload) for every checksummed frame in data."""
+    i = 0
+    n = len(data)
+    while i + 4 <= n:
+        if data[i] != COMM_SOF:
+            i += 1
+            continue
+        ln = data[i + 2]
+        end = i + 3 + ln
+        if ln > COMM_MAX_PAYLOAD or end >= n or checksum(data[i:end]) != data[end]:
+            i += 1
+            continue
+        yield data[i + 1], data[i + 3 : end]
+        i = end + 1
+
+
+def decode(payload: bytes):
+    if not payload or payload[0] not in SCHEMAS:
+        return None
+    name, fmt, fields = SCHEMAS[payload[0]]
+    size = struct.calcsize(fmt)
+    if len(payload) - 1 < size:
+        return None
+    rec = dict(zip(fields, struct.unpack_from(fmt, payload, 1)))
+    rec["schema"] = name
+    return rec
+
+
+def format_text(rec: dict) -> str:
+    kind = rec["schema"]
+    if kind == "status":
+        sp = rec["speed_dmph"]
+        return (
+            f"[open-fw] t={rec['ms']} ms rpm={rec['rpm']} tq={rec['tq']} "
+            f"speed={sp // 10}.{sp % 10} soc={rec['soc']} err={rec['err']}"
+        )
+    if kind == "ui":
+        keys = ("ms", "hash", "dt", "spd", "soc", "cad", "pwr", "bv", "bi", "lrsn", "limw", "page", "dirty", "ops")
+        return "[TRACE] ui " + " ".join(f"{k}={rec[k]}" for k in keys)
+    parts = [f"page={rec['page']}"]
+    for k in ENG_ORDER:
+        v = rec[k]
+        parts.append(f"{k}=0x{v:08x}" if k == "btn" else f"{k}={v}")
+    return "[TRACE] eng " + " ".join(parts)
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Decode binary trace records from a UART1 capture")
+    ap.add_argument("capture", help="raw capture file, or - for stdin")
+    ap.add_argument("--json", action="store_true", help="one JSON object per record")
+    args = ap.parse_args()
+
+    if args.capture == "-":
+        data = sys.stdin.buffer.read()
+    else:
+        with open(args.capture, "rb") as f:
+            data = f.read()
+
+    count = 0
+    for cmd, payload in frames(data):
+        if cmd != TRACE_FRAME_CMD:
+            continue
+        rec = decode(payload)
+        if rec is None:
+            continue
+        count += 1
+        print(json.dumps(rec) if args.json else format_text(rec))
+    if count == 0:
+        print("no trace records found", file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
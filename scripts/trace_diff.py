@@ -0,0 +1,273 @@
+#!/usr/bin/env python3
+"""
+Diff two host sim trace sets and localize the first divergence.
+
+Inputs are two BC280_SIM_OUTDIR directories (or two trace files of the same
+kind). Every `t=<ms> key=value ...` line is a record; lines that do not start
+with `t=` (the engineer-page `[TRACE] ui ...` lines) belong to the record
+above them. Records are aligned by timestamp, several records at the same
+timestamp by their order. For each trace present on both sides:
+
+  sim_ui_trace.txt   first tick whose frame hash differs, first draw_ops
+                     spike (B above A by --spike percent and --spike-min
+                     ops), first tick present on one side only
+  shengyi_motor.log  first record whose fields differ
+  ble_frames.log     (same)
+
+Each divergence is printed with --context aligned rows around it (`-` the A
+side, `+` the B side). A perf summary follows: draw ops and dirty rects per
+tick, full redraws and the cost model's LCD bus time per drawn frame (the
+deterministic render estimate; measured render time is not traced), overall
+and per page, so an optimization can be reviewed with numbers.
+
+Exit status: 0 when the traces match, 1 when they diverge, 2 on bad input.
+
+Usage:
+  scripts/trace_diff.py A B [--context N] [--spike PCT] [--spike-min N] [--json]
+"""
+
+import argparse
+import json
+import sys
+from pathlib import Path
+from typing import Dict, List, Optional, Tuple
+
+TRACE_FILES = ("sim_ui_trace.txt", "shengyi_motor.log", "ble_frames.log")
+UI_TRACE = "sim_ui_trace.txt"
+
+
+class Record:
+    def __init__(self, t: int, fields: Dict[str, str], raw: str):
+        self.t = t
+        self.fields = fields
+        self.raw = raw
+        self.extra: List[str] = []
+
+    def num(self, key: str) -> Optional[float]:
+        v = self.fields.get(key)
+        if v is None:
+            return None
+        try:
+            return float(int(v, 0))
+        except ValueError:
+            pass
+        try:
+            return float(v)
+        except ValueError:
+            return None
+
+    def same(self, other: "Record", keys: Optional[Tuple[str, ...]] = None) -> bool:
+        if keys is not None:
+            return all(self.fields.get(k) == other.fields.get(k) for k in keys)
+        return self.fields == other.fields and self.extra == other.extra
+
+
+def parse_trace(path: Path) -> List[Record]:
+    records: List[Record] = []
+    for line in path.read_text(errors="replace").splitlines():
+        if not line.strip():
+            continue
+        if not line.startswith("t="):
+            if records:
+                records[-1].extra.append(line)
+            continue
+        fields: Dict[str, str] = {}
+        for tok in line.split():
+            key, _, val = tok.partition("=")
+            fields[key] = val
+        try:
+            t = int(fields.pop("t"))
+        except ValueError:
+            continue
+        records.append(Record(t, fields, line))
+    return records
+
+
+Row = Tuple[Tuple[int, int], Optional[Record], Optional[Record]]
+
+
+def align(a: List[Record], b: List[Record]) -> List[Row]:
+    def keyed(recs: List[Record]) -> Dict[Tuple[int, int], Record]:
+        out: Dict[Tuple[int, int], Record] = {}
+        seen: Dict[int, int] = {}
+        for r in recs:
+            n = seen.get(r.t, 0)
+            seen[r.t] = n + 1
+            out[(r.t, n)] = r
+        return out
+
+    ka, kb = keyed(a), keyed(b)
+    return [(k, ka.get(k), kb.get(k)) for k in sorted(set(ka) | set(kb))]
+
+
+def first(rows: List[Row], pred) -> Optional[int]:
+    for i, (_, ra, rb) in enumerate(rows):
+        if pred(ra, rb):
+            return i
+    return None
+
+
+def divergences(name: str, rows: List[Row], spike_pct: float, spike_min: int) -> List[Tuple[str, int]]:
+    found: List[Tuple[str, int]] = []
+    missing = first(rows, lambda ra, rb: ra is None or rb is None)
+    if name == UI_TRACE:
+        both = lambda f: (lambda ra, rb: ra is not None and rb is not None and f(ra, rb))
+        hash_i = first(rows, both(lambda ra, rb: not ra.same(rb, ("hash",))))
+        spike_i = first(rows, both(lambda ra, rb: (rb.num("ops") or 0) - (ra.num("ops") or 0) >= spike_min and
+                                   (rb.num("ops") or 0) > (ra.num("ops") or 0) * (1.0 + spike_pct / 100.0)))
+        if hash_i is not None:
+            found.append(("frame hash", hash_i))
+        if spike_i is not None:
+            found.append(("draw_ops spike", spike_i))
+    else:
+        diff_i = first(rows, lambda ra, rb: ra is not None and rb is not None and not ra.same(rb))
+        if diff_i is not None:
+            found.append(("fields", diff_i))
+    if missing is not None:
+        found.append(("timeline", missing))
+    return sorted(found, key=lambda x: x[1])
+
+
+def show_row(marker: str, side: str, r: Optional[Record], t: int) -> List[str]:
+    if r is None:
+        return [f"{marker}{side} t={t} <no record>"]
+    return [f"{marker}{side} {r.raw}"] + [f"{marker}{side}   {x}" for x in r.extra]
+
+
+def context(rows: List[Row], at: int, n: int) -> List[str]:
+    out = []
+    for i in range(max(0, at - n), min(len(rows), at + n + 1)):
+        (t, _), ra, rb = rows[i]
+        mark = ">" if i == at else " "
+        if ra is not None and rb is not None and ra.same(rb):
+            out += show_row(mark, " ", ra, t)
+        else:
+            out += show_row(mark, "-", ra, t) + show_row(mark, "+", rb, t)
+    return out
+
+
+def ui_summary(recs: List[Record]) -> Dict[str, Dict[str, float]]:
+    """Perf figures overall ("all") and per page (when traced)."""
+    groups: Dict[str, List[Record]] = {"all": recs}
+    pages = sorted({r.fields["page"] for r in recs if "page" in r.fields}, key=int)
+    for p in pages if len(pages) > 1 else []:
+        groups[f"page {p}"] = [r for r in recs if r.fields.get("page") == p]
+    out: Dict[str, Dict[str, float]] = {}
+    for g, rs in groups.items():
+        drawn = [r for r in rs if (r.num("ops") or 0) > 0]
+        def avg(vals: List[float]) -> float:
+            return sum(vals) / len(vals) if vals else 0.0
+        ops = [r.num("ops") or 0.0 for r in rs]
+        lcd = [r.num("lcd_us") for r in drawn if r.num("lcd_us") is not None]
+        s = {
+            "ticks": float(len(rs)),
+            "drawn": float(len(drawn)),
+            "full": float(sum(1 for r in rs if r.fields.get("full") == "1")),
+            "ops/tick": avg(ops),
+            "ops max": max(ops) if ops else 0.0,
+            "dirty/tick": avg([r.num("dirty") or 0.0 for r in rs]),
+        }
+        if lcd:
+            s["lcd_us/frame"] = avg(lcd)
+            s["lcd_us max"] = max(lcd)
+            s["lcd_ms total"] = sum(lcd) / 1000.0
+        out[g] = s
+    return out
+
+
+def log_summary(recs: List[Record]) -> Dict[str, Dict[str, float]]:
+    """Counters (*_rx, *_tx, errs) as their final value, the rest averaged."""
+    s: Dict[str, float] = {"records": float(len(recs))}
+    keys = sorted({k for r in recs for k in r.fields if r.num(k) is not None})
+    for k in keys:
+        vals = [r.num(k) for r in recs if r.num(k) is not None]
+        if k.endswith(("_rx", "_tx")) or k == "errs":
+            s[k] = vals[-1]
+        else:
+            s[k + " avg"] = sum(vals) / len(vals)
+    return {"all": s}
+
+
+def print_summary(sa: Dict[str, Dict[str, float]], sb: Dict[str, Dict[str, float]]) -> None:
+    rows = []
+    for g in list(sa) + [g for g in sb if g not in sa]:
+        a, b = sa.get(g, {}), sb.get(g, {})
+        for k in list(a) + [k for k in b if k not in a]:
+            va, vb = a.get(k), b.get(k)
+            if va == vb and g != "all":
+                continue
+            pct = ""
+            if va is not None and vb is not None and va != vb and va != 0:
+                pct = f"{(vb - va) * 100.0 / va:+.1f}%"
+            fa = "-" if va is None else f"{va:.1f}"
+            fb = "-" if vb is None else f"{vb:.1f}"
+            rows.append((g, k, fa, fb, pct))
+    w = max((len(r[0]) + len(r[1]) + 1 for r in rows), default=10)
+    print(f"    {'metric':<{w}} {'A':>12} {'B':>12} {'delta':>8}")
+    for g, k, fa, fb, pct in rows:
+        print(f"    {(g + ' ' + k):<{w}} {fa:>12} {fb:>12} {pct:>8}")
+
+
+def pairs(a: Path, b: Path) -> List[Tuple[str, Path, Path]]:
+    if a.is_file():
+        # Renamed copies: a trace with frame hashes is a UI trace.
+        kind = a.name
+        if kind not in TRACE_FILES and " hash=" in a.read_text(errors="replace")[:200]:
+            kind = UI_TRACE
+        return [(kind, a, b)]
+    return [(n, a / n, b / n) for n in TRACE_FILES if (a / n).is_file() and (b / n).is_file()]
+
+
+def main() -> int:
+    ap = argparse.ArgumentParser(description="Diff two host sim trace sets and localize the first divergence")
+    ap.add_argument("a", help="baseline trace directory or file")
+    ap.add_argument("b", help="candidate trace directory or file")
+    ap.add_argument("--context", type=int, default=3, help="aligned rows shown around a divergence")
+    ap.add_argument("--spike", type=float, default=50.0, help="draw_ops growth in percent that counts as a spike")
+    ap.add_argument("--spike-min", type=int, default=8, help="minimum extra draw_ops for a spike")
+    ap.add_argument("--json", action="store_true", help="print divergences and summaries as JSON")
+    args = ap.parse_args()
+
+    a, b = Path(args.a), Path(args.b)
+    if a.is_file() != b.is_file() or not a.exists() or not b.exists():
+        print("need two directories or two files", file=sys.stderr)
+        return 2
+    todo = pairs(a, b)
+    if not todo:
+        print(f"no common traces ({', '.join(TRACE_FILES)}) in {a} and {b}", file=sys.stderr)
+        return 2
+
+    diverged = 0
+    report = {}
+    for name, pa, pb in todo:
+        ra, rb = parse_trace(pa), parse_trace(pb)
+        rows = align(ra, rb)
+        found = divergences(name, rows, args.spike, args.spike_min)
+        summarize = ui_summary if name == UI_TRACE else log_summary
+        sa, sb = summarize(ra), summarize(rb)
+        diverged |= 1 if found else 0
+        if args.json:
+            report[name] = {
+                "divergences": [{"kind": k, "t": rows[i][0][0], "a": rows[i][1].raw if rows[i][1] else None,
+                                 "b": rows[i][2].raw if rows[i][2] else None} for k, i in found],
+                "a": sa, "b": sb,
+            }
+            continue
+        print(f"{name}: {len(ra)} vs {len(rb)} records, " + ("MATCH" if not found else "DIVERGED"))
+        shown = set()
+        for kind, i in found:
+            if i in shown:
+                print(f"  first {kind} divergence at t={rows[i][0][0]} (same record as above)")
+                continue
+            shown.add(i)
+            print(f"  first {kind} divergence at t={rows[i][0][0]}:")
+            for line in context(rows, i, args.context):
+                print("    " + line)
+        print_summary(sa, sb)
+    if args.json:
+        print(json.dumps(report, indent=2, sort_keys=True))
+    return diverged
+
+
+if __name__ == "__main__":
+    sys.exit(main())
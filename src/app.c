@@ -2,38 +2,61 @@
 #include <stdint.h>
 
 #include "ui.h"
+#include "ui_glyph_cache.h"
 #include "ui_state.h"
 #include "app_state.h"
 #include "src/motor/app_data.h"
 #include "src/power/power.h"
 #include "src/control/control.h"
+#include "src/control/state_snapshot.h"
 #include "src/bus/bus.h"
 #include "src/telemetry/trip.h"
 #include "src/telemetry/telemetry.h"
+#include "src/telemetry/tlm_sampler.h"
+#include "src/telemetry/anomaly.h"
 #include "src/config/config.h"
 #include "src/profiles/profiles.h"
 #include "src/comm/comm.h"
+#include "src/core/trace_bin.h"
 #include "src/input/input.h"
+#include "src/input/input_latency.h"
 #include "src/motor/shengyi.h"
 #include "src/motor/motor_isr.h"
 #include "src/motor/motor_cmd.h"
 #include "src/motor/motor_link.h"
+#include "src/motor/motor_health.h"
 #include "src/power/battery_monitor.h"
-#include "src/kernel/event_queue.h"
+#include "src/power/battery_est.h"
+#include "src/power/clock_profile.h"
+#include "src/kernel/event_bus.h"
+#include "src/kernel/scheduler.h"
+#include "src/kernel/timer_wheel.h"
+#include "src/kernel/work_queue.h"
 #include "src/system_control.h"
 #include "storage/logs.h"
+#include "storage/flash_health.h"
+#include "storage/lifetime.h"
+#include "storage/flash_jobs.h"
+#include "storage/ota.h"
+#include "storage/ab_update.h"
+#include "storage/ride_log.h"
 #include "storage/boot_stage.h"
+#include "storage/ui_assets.h"
 #include "boot_log.h"
 #include "platform/time.h"
 #include "platform/cpu.h"
+#include "platform/dma.h"
+#include "platform/irq_load.h"
+#include "platform/ram.h"
 #include "platform/hw.h"
+#include "platform/board_init.h"
+#include "platform/watchdog.h"
 #include "drivers/uart.h"
 
 extern volatile uint32_t g_ms;
 extern uint32_t g_last_profile_switch_ms;
 extern uint8_t g_last_brake_state;
-extern event_queue_t g_motor_events;
-void recompute_outputs(void);
+extern event_bus_t g_event_bus;
 
 typedef enum
 {
@@ -46,6 +69,14 @@ typedef enum
     APP_TUNE_CURRENT_MIN_DA = 50u,
     APP_TUNE_RAMP_STEP_WPS = 50u,
     APP_TUNE_BOOST_STEP_MS = 1000u,
+    APP_SCHED_TICK_BUDGET_US = 1000u, /* past this, due slots wait a pass */
+    APP_TICK_MS = 5u,                 /* TIM2 timebase step */
+    APP_IDLE_WINDOW_MS = 1000u,
+    APP_UI_PHASE_MS = 0u,
+    APP_STATUS_PERIOD_MS = 1000u,
+    APP_STATUS_PHASE_MS = 50u,        /* between UI frames at any pacing */
+    APP_CONTROL_MAX_EVENTS = 8u,      /* motor-lane events per status step */
+    APP_PREEMPT_MAX_EVENTS = 4u,      /* input-lane events per preemption point */
 } app_constant_t;
 
 static inline uint8_t bool_to_u8(uint8_t condition)
@@ -85,10 +116,10 @@ static uint8_t app_config_change_allowed(void)
     return app_config_change_speed_dmph() <= APP_CONFIG_CHANGE_MAX_SPEED_DMPH;
 }
 
-static void apply_gear_buttons(void)
+static void apply_gear_buttons(uint8_t short_press)
 {
     uint8_t prev = g_active_vgear;
-    uint8_t rising = (uint8_t)(g_button_short_press & (BUTTON_GEAR_UP_MASK | BUTTON_GEAR_DOWN_MASK));
+    uint8_t rising = (uint8_t)(short_press & (BUTTON_GEAR_UP_MASK | BUTTON_GEAR_DOWN_MASK));
     if (rising & BUTTON_GEAR_UP_MASK)
     {
         if (g_active_vgear < g_vgears.count)
@@ -100,7 +131,10 @@ static void apply_gear_buttons(void)
             g_active_vgear--;
     }
     if (g_active_vgear != prev)
+    {
         shengyi_request_update(0u);
+        config_persist_vgear(g_active_vgear);
+    }
 }
 
 void app_process_time(void)
@@ -109,6 +143,13 @@ void app_process_time(void)
     watchdog_feed_runtime();
     system_control_key_sequencer_tick(g_ms, 0u, g_request_soft_reboot);
 
+    if (g_request_soft_reboot != REBOOT_REQUEST_NONE)
+    {
+        stream_log_flush();
+        event_log_flush();
+        config_persist_flush();
+        flash_jobs_flush(); /* queued log writes land before reset */
+    }
     if (g_request_soft_reboot == REBOOT_REQUEST_BOOTLOADER) {
         reboot_to_bootloader();
         return;
@@ -124,18 +165,158 @@ static void handle_motor_event(const event_t *evt, void *ctx)
     motor_cmd_process(evt);
 }
 
+/* Virtual gear up/down: bit4=up, bit5=down (edge-trigger). */
+static void handle_button_event(const event_t *evt, void *ctx)
+{
+    (void)ctx;
+    if (evt->type == EVT_BTN_PRESS)
+    {
+        apply_gear_buttons((uint8_t)(evt->payload16 & 0xFFu));
+        input_latency_mark(INPUT_LAT_APPLIED);
+    }
+}
+
+void app_dispatch_events(void)
+{
+    (void)event_bus_dispatch(&g_event_bus, 0u, g_ms);
+}
+
+/* Set when the render preemption point sampled a press; the flags stay
+ * latched until app_apply_inputs has seen them. */
+static uint8_t g_input_preempted;
+
 void app_process_events(void)
 {
     poll_uart_rx_ports();
-    buttons_tick();
-    event_queue_drain(&g_motor_events, handle_motor_event, NULL);
+    if (!g_input_preempted)
+        buttons_tick();
+    app_dispatch_events();
 }
 
-void app_apply_inputs(void)
+/*
+ * Anomalies raised since boot, newest first, for the alerts page. Each is
+ * also one event log record; the distance is the trip odometer when it was
+ * raised, so the page can show how far back it was.
+ */
+#define APP_ALERT_SLOTS 3u
+typedef struct {
+    uint8_t type;
+    uint8_t flags;
+    uint32_t ms;
+    uint32_t trip_mm;
+} app_alert_t;
+static app_alert_t g_alerts[APP_ALERT_SLOTS];
+static uint8_t g_alert_count;
+
+static void app_raise_anomalies(uint8_t raised, uint32_t now_ms)
 {
-    graph_on_input_all();
-    uint8_t cfg_change_allowed = app_config_change_allowed();
+    for (uint8_t a = 0; a < ANOMALY_COUNT; ++a)
+    {
+        if (!(raised & (1u << a)))
+            continue;
+        uint8_t type = anomaly_event_type(a);
+        uint8_t flags = anomaly_flags(a);
+        event_log_append(type, flags);
+        for (uint8_t i = APP_ALERT_SLOTS - 1u; i > 0u; --i)
+            g_alerts[i] = g_alerts[i - 1u];
+        g_alerts[0].type = type;
+        g_alerts[0].flags = flags;
+        g_alerts[0].ms = now_ms;
+        g_alerts[0].trip_mm = trip_get_acc()->distance_mm;
+        if (g_alert_count < APP_ALERT_SLOTS)
+            g_alert_count++;
+    }
+}
+
+/* Lifetime counters take the trip's distance and energy as it grows, and
+ * time per sample for the motor and assist counters. */
+static struct {
+    uint32_t ms;
+    uint32_t distance_mm;
+    uint32_t energy_mwh;
+} g_life_last;
 
+/* A trip resumed after a power loss has counted its distance and energy
+ * already; only what it adds from here on is new. */
+static void app_lifetime_start(void)
+{
+    const trip_acc_t *acc = trip_get_acc();
+    g_life_last.ms = 0u;
+    g_life_last.distance_mm = acc->distance_mm;
+    g_life_last.energy_mwh = acc->energy_mwh;
+}
+
+static void app_lifetime_sample(const tlm_tick_t *s, uint16_t sample_power)
+{
+    const trip_acc_t *acc = trip_get_acc();
+    /* A trip reset starts the deltas again from zero. */
+    if (acc->distance_mm < g_life_last.distance_mm || acc->energy_mwh < g_life_last.energy_mwh)
+        g_life_last.distance_mm = g_life_last.energy_mwh = 0u;
+    lifetime_add(LIFETIME_DISTANCE, acc->distance_mm - g_life_last.distance_mm);
+    lifetime_add(LIFETIME_ENERGY, acc->energy_mwh - g_life_last.energy_mwh);
+    g_life_last.distance_mm = acc->distance_mm;
+    g_life_last.energy_mwh = acc->energy_mwh;
+
+    uint32_t dt = g_life_last.ms ? s->ms - g_life_last.ms : 0u;
+    g_life_last.ms = s->ms;
+    /* A stalled loop still delivers every tick; a larger gap is not riding. */
+    if (dt > 1000u)
+        dt = 0u;
+    if (sample_power)
+        lifetime_add(LIFETIME_MOTOR_ON, dt);
+    if (s->assist_mode == 1u && s->profile_id < LIFETIME_ASSIST_PROFILES)
+        lifetime_add((uint8_t)(LIFETIME_ASSIST0 + s->profile_id), dt);
+}
+
+/* Sampler ticks reach the telemetry consumers in order, each with its own
+ * timestamp, however late this pass runs. */
+static void app_drain_samples(void)
+{
+    tlm_tick_t s;
+    battery_est_info_t batt;
+    battery_est_get_info(&batt);
+    while (tlm_sampler_pop(&s))
+    {
+        uint16_t sample_power = s.power_w ? s.power_w : s.cmd_power_w;
+        uint16_t regen_w = trip_regen_power_w(s.battery_dA, s.battery_dV);
+        graph_on_sample(&s);
+        trip_update(s.ms, s.speed_dmph, sample_power, regen_w, s.assist_mode,
+                    s.virtual_gear, s.profile_id, s.battery_dA, s.ctrl_temp_dC);
+        range_update(s.ms, s.speed_dmph, sample_power, regen_w, s.soc_pct);
+        stream_log_tick(&s);
+        app_lifetime_sample(&s, sample_power);
+        app_raise_anomalies(anomaly_on_sample(&s, batt.r_mohm), s.ms);
+    }
+}
+
+/* Link error detector input: every error kind against the frames that made
+ * it through. */
+static void app_check_link(void)
+{
+    const motor_health_t *h = motor_health_get();
+    uint32_t frames = h->untracked_frames;
+    for (uint8_t i = 0; i < h->op_count; ++i)
+        frames += h->ops[i].frames;
+    uint32_t errors = h->crc_errors + h->framing_errors + h->other_errors + h->timeouts + h->parse_errors;
+    app_raise_anomalies(anomaly_on_link(g_ms, frames, errors), g_ms);
+}
+
+/* Page the button handler last ran for; a page it has not seen yet gets one
+ * pass without presses so its state is set up (the bus monitor is enabled). */
+static uint8_t g_input_page = 0xFFu;
+static sw_timer_t g_alert_ack_timer;
+
+static void app_alert_ack_expired(void *ctx, uint32_t now_ms)
+{
+    (void)ctx;
+    (void)now_ms;
+    g_alert_ack_active = 0u;
+}
+
+/* Page-local button handling. Runs only on a pass that latched a short or
+ * long press, or the first pass on a newly shown page. */
+static void app_on_button_events(uint8_t cfg_change_allowed)
+{
     if (g_ui_page == UI_PAGE_SETTINGS)
     {
         uint8_t press = g_button_short_press;
@@ -197,6 +378,13 @@ void app_apply_inputs(void)
             g_ui_graph_window_idx = (uint8_t)((g_ui_graph_window_idx + 2u) % APP_GRAPH_WINDOW_COUNT);
     }
 
+    /* Trip page: each press steps one stored ride back, then wraps to live. */
+    if (g_ui_page == UI_PAGE_TRIP && (g_button_short_press & UI_PAGE_BUTTON_RAW))
+    {
+        uint16_t next = (uint16_t)(g_ui_trip_view + 1u);
+        g_ui_trip_view = trip_get_ride(next, NULL, NULL, NULL) ? next : 0u;
+    }
+
     if (g_ui_page == UI_PAGE_PROFILES)
     {
         uint8_t press = g_button_short_press;
@@ -267,8 +455,7 @@ void app_apply_inputs(void)
             {
                 if (dir || dir_fast)
                 {
-                    g_vgears.shape = (g_vgears.shape == VGEAR_SHAPE_EXP) ? VGEAR_SHAPE_LINEAR : VGEAR_SHAPE_EXP;
-                    vgear_generate_scales(&g_vgears);
+                    vgear_set_shape((g_vgears.shape == VGEAR_SHAPE_EXP) ? VGEAR_SHAPE_LINEAR : VGEAR_SHAPE_EXP);
                 }
             }
 
@@ -345,7 +532,7 @@ void app_apply_inputs(void)
         if (g_button_long_press & UI_PAGE_BUTTON_RAW)
         {
             g_alert_ack_active = 1u;
-            g_alert_ack_until_ms = g_ms + UI_ALERT_ACK_MS;
+            timer_wheel_start(&g_alert_ack_timer, UI_ALERT_ACK_MS, 0u, app_alert_ack_expired, NULL);
         }
     }
 
@@ -371,7 +558,7 @@ void app_apply_inputs(void)
         }
         if (g_button_short_press & BUTTON_GEAR_DOWN_MASK)
         {
-            if (g_ui_bus_offset < 0xFFu)
+            if (g_ui_bus_offset + BUS_UI_VIEW_MAX < BUS_UI_OP_SLOTS)
                 g_ui_bus_offset++;
         }
         if (g_button_short_press & WALK_BUTTON_MASK)
@@ -438,13 +625,20 @@ void app_apply_inputs(void)
             g_cruise.set_power_w = (uint16_t)v;
         }
     }
+}
 
-    if (g_alert_ack_active)
+void app_apply_inputs(void)
+{
+    if (g_button_short_press || g_button_long_press || g_ui_page != g_input_page)
     {
-        if ((int32_t)(g_ms - g_alert_ack_until_ms) >= 0)
-            g_alert_ack_active = 0u;
-        if (!g_motor.err && g_power_policy.last_reason == LIMIT_REASON_USER)
-            g_alert_ack_active = 0u;
+        g_input_page = g_ui_page;
+        app_on_button_events(app_config_change_allowed());
+    }
+
+    if (g_alert_ack_active && !g_motor.err && g_power_policy.last_reason == LIMIT_REASON_USER)
+    {
+        g_alert_ack_active = 0u;
+        timer_wheel_cancel(&g_alert_ack_timer);
     }
 
     if (g_event_meta.seq != g_ui_alert_last_seq)
@@ -463,11 +657,10 @@ void app_apply_inputs(void)
     {
         /* debounce ~100 ms to avoid chatter while remaining quick (<300 ms) */
         if (g_last_profile_switch_ms == 0u || (g_ms - g_last_profile_switch_ms) > APP_PROFILE_SWITCH_DEBOUNCE_MS)
-            set_active_profile(requested_profile, cfg_change_allowed ? 1 : 0);
+            set_active_profile(requested_profile, app_config_change_allowed() ? 1 : 0);
     }
 
-    /* Virtual gear up/down: bit4=up, bit5=down (edge-trigger). */
-    apply_gear_buttons();
+    /* Gear buttons were applied by handle_button_event() on dispatch. */
     if (g_active_vgear == 0 || g_active_vgear > g_vgears.count)
         g_active_vgear = 1;
 
@@ -478,12 +671,7 @@ void app_apply_inputs(void)
         event_log_append(EVT_BRAKE, 0);
     g_last_brake_state = bool_to_u8(g_inputs.brake);
 
-    trip_update(g_inputs.speed_dmph, g_inputs.power_w, g_outputs.assist_mode,
-                g_outputs.virtual_gear, g_outputs.profile_id);
-    {
-        uint16_t sample_power = g_inputs.power_w ? g_inputs.power_w : g_outputs.cmd_power_w;
-        range_update(g_inputs.speed_dmph, sample_power, g_motor.soc_pct);
-    }
+    app_drain_samples();
 }
 
 void app_process_periodic(void)
@@ -491,130 +679,258 @@ void app_process_periodic(void)
     /* OEM-like battery voltage monitoring (ADC1/PA0) */
     battery_monitor_tick(g_ms);
 
-    if ((g_ms - g_last_print) >= 1000u) {
-        g_last_print = g_ms;
-        print_status();
-    }
-
     if (g_stream_period_ms && ((g_ms - g_last_stream_ms) >= g_stream_period_ms)) {
         g_last_stream_ms = g_ms;
         send_state_frame_bin();
     }
+    send_telemetry_v2();
+    bulk_read_tick();
+    ui_stream_tick();
+    graph_export_tick();
+    comm_tagged_tick();
+    ble_hacker_notify_tick();
 
-    stream_log_tick();
-    graph_tick();
+    config_persist_tick(g_ms);
+    event_log_tick(g_ms);
+    flash_health_tick(g_ms);
+    lifetime_tick();
+    app_check_link();
+    flash_jobs_tick();
+    ota_tick();
+    ab_update_tick();
     bus_replay_tick();
+    bus_trigger_tick();
+    bus_session_tick();
     motor_link_periodic_send_tick();
     g_brake_edge = 0;
 }
 
-void app_update_ui(void)
+/* Stored ride for the trip page; flash is read again only when the selection
+ * or the history changes. */
+static void app_fill_trip_history(uint16_t view)
 {
-    if ((uint32_t)(g_ms - g_ui.last_tick_ms) < UI_TICK_MS) {
-        return;
+    static uint16_t s_view;
+    static uint32_t s_next_seq;
+    static trip_snapshot_t s_snap;
+    static uint16_t s_p95_dmph;
+    ride_log_info_t info;
+    ride_log_get_info(&info);
+    if (view != s_view || info.next_seq != s_next_seq)
+    {
+        trip_quantiles_t q;
+        if (!trip_get_ride(view, &s_snap, &q, NULL))
+        {
+            s_snap = (trip_snapshot_t){0};
+            q.ch[TRIP_Q_SPEED].p95 = 0u;
+        }
+        s_p95_dmph = q.ch[TRIP_Q_SPEED].p95;
+        s_view = view;
+        s_next_seq = info.next_seq;
     }
+    g_ui_model.trip_distance_mm = s_snap.distance_mm;
+    g_ui_model.trip_energy_mwh = s_snap.energy_mwh;
+    g_ui_model.trip_max_speed_dmph = s_snap.max_speed_dmph;
+    g_ui_model.trip_avg_speed_dmph = s_snap.avg_speed_dmph;
+    g_ui_model.trip_moving_ms = s_snap.moving_ms;
+    g_ui_model.trip_elapsed_ms = s_snap.elapsed_ms;
+    g_ui_model.trip_p95_speed_dmph = s_p95_dmph;
+}
+
+/* Populates the model groups in `need` (UI_CH_*) from global state. Groups
+ * left out keep their last values; ui_tick does not read them on this page. */
+static void app_ui_build_model(uint32_t need)
+{
+    state_snapshot_t st;
+    (void)state_snapshot_read(&st);
+    const motor_state_t *m = &st.motor;
+    const debug_inputs_t *in = &st.inputs;
+    const debug_outputs_t *o = &st.outputs;
+    const power_policy_state_t *pp = &st.policy;
 
-    /* Populate UI model from global state */
     g_ui_model.page = (uint8_t)g_ui_page;
-    g_ui_model.speed_dmph = g_motor.speed_dmph;
-    g_ui_model.rpm = g_motor.rpm;
-    g_ui_model.torque_raw = g_motor.torque_raw;
-    g_ui_model.assist_mode = g_outputs.assist_mode;
-    g_ui_model.virtual_gear = g_outputs.virtual_gear;
-    g_ui_model.soc_pct = g_motor.soc_pct;
-    g_ui_model.err = g_motor.err;
-    g_ui_model.batt_dV = g_inputs.battery_dV;
-    g_ui_model.batt_dA = g_inputs.battery_dA;
-    g_ui_model.phase_dA = g_power_policy.i_phase_est_dA;
-    g_ui_model.sag_margin_dV = g_power_policy.sag_margin_dV;
-    g_ui_model.thermal_state = g_power_policy.thermal_state;
-    g_ui_model.ctrl_temp_dC = g_inputs.ctrl_temp_dC;
-    g_ui_model.cadence_rpm = g_inputs.cadence_rpm;
-    g_ui_model.throttle_pct = g_inputs.throttle_pct;
-    g_ui_model.brake = g_inputs.brake;
-    g_ui_model.buttons = g_inputs.buttons;
-    g_ui_model.power_w = g_outputs.cmd_power_w ? g_outputs.cmd_power_w : g_inputs.power_w;
-    g_ui_model.limit_power_w = g_power_policy.p_final_w;
+    g_ui_model.theme = g_config_active.theme;
+    if (need & UI_CH_SPEED)
+        g_ui_model.speed_dmph = m->speed_dmph;
+    if (need & UI_CH_PEDAL)
+    {
+        g_ui_model.rpm = m->rpm;
+        g_ui_model.torque_raw = m->torque_raw;
+        g_ui_model.cadence_rpm = in->cadence_rpm;
+        g_ui_model.throttle_pct = in->throttle_pct;
+    }
+    if (need & UI_CH_ASSIST)
+    {
+        g_ui_model.assist_mode = o->assist_mode;
+        g_ui_model.virtual_gear = o->virtual_gear;
+        g_ui_model.walk_state = st.walk_state;
+    }
+    if (need & UI_CH_SOC)
+        g_ui_model.soc_pct = m->soc_pct;
+    if (need & UI_CH_ERR)
+        g_ui_model.err = m->err;
+    if (need & UI_CH_BATT)
+    {
+        g_ui_model.batt_dV = in->battery_dV;
+        g_ui_model.batt_dA = in->battery_dA;
+        g_ui_model.phase_dA = pp->i_phase_est_dA;
+        g_ui_model.sag_margin_dV = pp->sag_margin_dV;
+    }
+    if (need & UI_CH_THERMAL)
+    {
+        g_ui_model.thermal_state = pp->thermal_state;
+        g_ui_model.ctrl_temp_dC = in->ctrl_temp_dC;
+    }
+    if (need & UI_CH_BRAKE)
+        g_ui_model.brake = in->brake;
+    if (need & UI_CH_BUTTONS)
+        g_ui_model.buttons = in->buttons;
+    if (need & UI_CH_POWER)
+        g_ui_model.power_w = o->cmd_power_w ? o->cmd_power_w : in->power_w;
+    if (need & UI_CH_LIMIT)
+    {
+        g_ui_model.limit_power_w = pp->p_final_w;
+        g_ui_model.limit_reason = pp->last_reason;
+    }
     /* Trip data from telemetry API */
+    if (need & (UI_CH_TRIP | UI_CH_TRIP_STATS))
     {
         const trip_acc_t *acc = trip_get_acc();
-        trip_snapshot_t snap = {0};
-        trip_get_current(&snap);
 
         g_ui_model.trip_distance_mm = acc->distance_mm;
         g_ui_model.trip_energy_mwh = acc->energy_mwh;
         g_ui_model.trip_max_speed_dmph = acc->max_speed_dmph;
-        g_ui_model.trip_avg_speed_dmph = snap.avg_speed_dmph;
+        /* Only the trip page shows the average; skip the snapshot elsewhere. */
+        if (g_ui_page == UI_PAGE_TRIP) {
+            trip_snapshot_t snap;
+            trip_get_current(&snap);
+            g_ui_model.trip_avg_speed_dmph = snap.avg_speed_dmph;
+        }
+        g_ui_model.trip_view = (g_ui_page == UI_PAGE_TRIP) ? g_ui_trip_view : 0u;
+        if (g_ui_model.trip_view)
+            app_fill_trip_history(g_ui_model.trip_view);
         g_ui_model.trip_moving_ms = acc->moving_ms;
         g_ui_model.trip_assist_ms = acc->assist_time_ms[1] + acc->assist_time_ms[2];
 
         /* Gear time */
         uint32_t gear_ms = 0u;
-        if (g_ui_model.virtual_gear > 0u && g_ui_model.virtual_gear <= HIST_GEAR_BINS) {
-            gear_ms = acc->gear_time_ms[g_ui_model.virtual_gear - 1u];
+        if (o->virtual_gear > 0u && o->virtual_gear <= HIST_GEAR_BINS) {
+            gear_ms = acc->gear_time_ms[o->virtual_gear - 1u];
         }
         g_ui_model.trip_gear_ms = gear_ms;
     }
 
-    g_ui_model.units = g_config_active.units;
-    g_ui_model.theme = g_config_active.theme;
-    g_ui_model.mode = g_config_active.mode;
-    g_ui_model.limit_reason = g_power_policy.last_reason;
-    g_ui_model.drive_mode = (uint8_t)g_drive.mode;
-    g_ui_model.boost_seconds = (uint8_t)((g_boost.budget_ms + 500u) / 1000u);
-    g_ui_model.range_est_d10 = g_range_est_d10;
-    g_ui_model.range_confidence = g_range_confidence;
-    g_ui_model.cruise_resume_available = g_cruise.resume_available;
-    g_ui_model.cruise_resume_reason = g_cruise.resume_block_reason;
-    g_ui_model.regen_supported = bool_to_u8(regen_capable());
-    g_ui_model.regen_level = g_regen.level;
-    g_ui_model.regen_brake_level = g_regen.brake_level;
-    g_ui_model.regen_cmd_power_w = g_regen.cmd_power_w;
-    g_ui_model.regen_cmd_current_dA = g_regen.cmd_current_dA;
-    g_ui_model.walk_state = (uint8_t)g_walk_state;
-    motor_isr_stats_t link_stats;
-    motor_isr_get_stats(&link_stats);
-    g_ui_model.link_timeouts = (link_stats.timeouts > 0xFFFFu) ? 0xFFFFu : (uint16_t)link_stats.timeouts;
-    g_ui_model.link_rx_errors = (link_stats.rx_errors > 0xFFFFu) ? 0xFFFFu : (uint16_t)link_stats.rx_errors;
-    g_ui_model.settings_index = g_ui_settings_index;
-    g_ui_model.focus_metric = bool_to_u8(g_config_active.button_flags & BUTTON_FLAG_LOCK_ENABLE);
-    g_ui_model.button_map = g_config_active.button_map;
-    g_ui_model.pin_code = g_config_active.pin_code;
-    bus_ui_state_t bus_state;
-    bus_ui_get_state(&bus_state);
-
-    g_ui_model.capture_enabled = bool_to_u8(bus_capture_get_enabled());
-    g_ui_model.capture_count = bus_capture_get_count();
-    g_ui_model.alert_ack_active = g_alert_ack_active;
-    g_ui_model.alert_count = (g_event_meta.count > 0xFFFFu) ? 0xFFFFu : (uint16_t)g_event_meta.count;
-    g_ui_model.bus_count = bus_state.count;
-
-    /* Bus last entry */
-    bus_ui_entry_t last_entry;
-    if (bus_ui_get_last(&last_entry)) {
-        g_ui_model.bus_last_id = last_entry.bus_id;
-        g_ui_model.bus_last_len = last_entry.len;
-        g_ui_model.bus_last_dt_ms = last_entry.dt_ms;
-        g_ui_model.bus_last_opcode = last_entry.len ? last_entry.data[0] : 0u;
-    } else {
-        g_ui_model.bus_last_id = 0u;
-        g_ui_model.bus_last_len = 0u;
-        g_ui_model.bus_last_dt_ms = 0u;
-        g_ui_model.bus_last_opcode = 0u;
-    }
-
-    g_ui_model.profile_id = g_active_profile_id;
-    g_ui_model.profile_select = g_ui_profile_select;
-    g_ui_model.profile_focus = g_ui_profile_focus;
-    g_ui_model.gear_count = g_vgears.count;
-    g_ui_model.gear_shape = g_vgears.shape;
-    g_ui_model.gear_min_pct = vgear_q15_to_pct(g_vgears.min_scale_q15);
-    g_ui_model.gear_max_pct = vgear_q15_to_pct(g_vgears.max_scale_q15);
-    g_ui_model.tune_index = g_ui_tune_index;
-    g_ui_model.tune_cap_current_dA = g_config_active.cap_current_dA;
-    g_ui_model.tune_ramp_wps = g_config_active.soft_start_ramp_wps;
-    g_ui_model.tune_boost_s = (uint8_t)((g_config_active.boost_budget_ms + 500u) / 1000u);
-    /* Track cruise mode changes for UI flash effect */
+    if (need & UI_CH_UNITS)
+        g_ui_model.units = g_config_active.units;
+    if (need & UI_CH_MODE)
+        g_ui_model.mode = g_config_active.mode;
+    if (need & UI_CH_DRIVE)
+    {
+        g_ui_model.drive_mode = (uint8_t)g_drive.mode;
+        g_ui_model.boost_seconds = (uint8_t)((g_boost.budget_ms + 500u) / 1000u);
+    }
+    if (need & UI_CH_RANGE)
+    {
+        g_ui_model.range_est_d10 = g_range_est_d10;
+        g_ui_model.range_confidence = g_range_confidence;
+    }
+    if (need & UI_CH_REGEN)
+    {
+        g_ui_model.regen_supported = bool_to_u8(regen_capable());
+        g_ui_model.regen_level = g_regen.level;
+        g_ui_model.regen_brake_level = g_regen.brake_level;
+        g_ui_model.regen_cmd_power_w = g_regen.cmd_power_w;
+        g_ui_model.regen_cmd_current_dA = g_regen.cmd_current_dA;
+    }
+    if (need & UI_CH_LINK)
+    {
+        motor_isr_stats_t link_stats;
+        motor_isr_get_stats(&link_stats);
+        g_ui_model.link_timeouts = (link_stats.timeouts > 0xFFFFu) ? 0xFFFFu : (uint16_t)link_stats.timeouts;
+        g_ui_model.link_rx_errors = (link_stats.rx_errors > 0xFFFFu) ? 0xFFFFu : (uint16_t)link_stats.rx_errors;
+        const motor_health_t *health = motor_health_get();
+        uint32_t busiest = 0u;
+        g_ui_model.link_rate_x10 = 0u;
+        for (uint8_t i = 0; i < health->op_count; ++i)
+        {
+            if (health->ops[i].frames > busiest)
+            {
+                busiest = health->ops[i].frames;
+                g_ui_model.link_rate_x10 = motor_health_rate_x10(&health->ops[i]);
+            }
+        }
+        g_ui_model.link_crc_errors = (health->crc_errors > 0xFFFFu) ? 0xFFFFu : (uint16_t)health->crc_errors;
+        g_ui_model.link_frame_errors = (health->framing_errors > 0xFFFFu) ? 0xFFFFu : (uint16_t)health->framing_errors;
+        g_ui_model.link_outages = health->outages;
+    }
+    if (need & UI_CH_SETTINGS)
+    {
+        g_ui_model.settings_index = g_ui_settings_index;
+        g_ui_model.focus_metric = bool_to_u8(g_config_active.button_flags & BUTTON_FLAG_LOCK_ENABLE);
+        g_ui_model.button_map = g_config_active.button_map;
+        g_ui_model.pin_code = g_config_active.pin_code;
+    }
+    if (need & UI_CH_CAPTURE)
+    {
+        g_ui_model.capture_enabled = bool_to_u8(bus_capture_get_enabled());
+        g_ui_model.capture_count = bus_capture_get_count();
+    }
+    if (need & (UI_CH_BUS | UI_CH_BUS_VIEW))
+    {
+        bus_ui_state_t bus_state;
+        bus_ui_get_state(&bus_state);
+        g_ui_model.bus_count = bus_state.count;
+
+        /* Bus last entry */
+        bus_ui_entry_t last_entry;
+        if (bus_ui_get_last(&last_entry)) {
+            g_ui_model.bus_last_id = last_entry.bus_id;
+            g_ui_model.bus_last_len = last_entry.len;
+            g_ui_model.bus_last_dt_ms = last_entry.dt_ms;
+            g_ui_model.bus_last_opcode = last_entry.len ? last_entry.data[0] : 0u;
+        } else {
+            g_ui_model.bus_last_id = 0u;
+            g_ui_model.bus_last_len = 0u;
+            g_ui_model.bus_last_dt_ms = 0u;
+            g_ui_model.bus_last_opcode = 0u;
+        }
+
+        g_ui_model.bus_diff = bool_to_u8(bus_state.diff_enabled);
+        g_ui_model.bus_changed_only = bool_to_u8(bus_state.changed_only);
+        g_ui_model.bus_filter_id_active = bool_to_u8(bus_state.filter_id);
+        g_ui_model.bus_filter_opcode_active = bool_to_u8(bus_state.filter_opcode);
+        g_ui_model.bus_filter_id = bus_state.filter_bus_id;
+        g_ui_model.bus_filter_opcode = bus_state.filter_opcode_val;
+
+        /* One row per opcode slot, scrolled by g_ui_bus_offset. */
+        bus_ui_row_t rows[BUS_UI_VIEW_MAX];
+        g_ui_model.bus_entries = bus_ui_get_rows(g_ui_bus_offset, rows, BUS_UI_VIEW_MAX);
+        for (uint8_t i = 0; i < BUS_UI_VIEW_MAX; ++i) {
+            uint8_t have = (uint8_t)(i < g_ui_model.bus_entries);
+            g_ui_model.bus_list_id[i] = have ? rows[i].bus_id : 0u;
+            g_ui_model.bus_list_op[i] = have ? rows[i].opcode : 0u;
+            g_ui_model.bus_list_len[i] = have ? rows[i].len : 0u;
+            g_ui_model.bus_list_dt_ms[i] = have ? rows[i].dt_ms : 0u;
+        }
+    }
+    if (need & UI_CH_PROFILE)
+    {
+        g_ui_model.profile_id = g_active_profile_id;
+        g_ui_model.profile_select = g_ui_profile_select;
+        g_ui_model.profile_focus = g_ui_profile_focus;
+        g_ui_model.gear_count = g_vgears.count;
+        g_ui_model.gear_shape = g_vgears.shape;
+        g_ui_model.gear_min_pct = vgear_q15_to_pct(g_vgears.min_scale_q15);
+        g_ui_model.gear_max_pct = vgear_q15_to_pct(g_vgears.max_scale_q15);
+    }
+    if (need & UI_CH_TUNE)
+    {
+        g_ui_model.tune_index = g_ui_tune_index;
+        g_ui_model.tune_cap_current_dA = g_config_active.cap_current_dA;
+        g_ui_model.tune_ramp_wps = g_config_active.soft_start_ramp_wps;
+        g_ui_model.tune_boost_s = (uint8_t)((g_config_active.boost_budget_ms + 500u) / 1000u);
+    }
+    /* Track cruise mode changes for UI flash effect; on every tick so the
+     * timestamp is the change's, not the next time a page shows cruise. */
     {
         static uint8_t prev_cruise_mode = 0u;
         uint8_t new_mode = (uint8_t)g_cruise.mode;
@@ -624,51 +940,134 @@ void app_update_ui(void)
             prev_cruise_mode = new_mode;
         }
     }
-    g_ui_model.cruise_mode = (uint8_t)g_cruise.mode;
-    g_ui_model.cruise_set_dmph = g_cruise.set_speed_dmph;
-    g_ui_model.cruise_set_power_w = g_cruise.set_power_w;
-    g_ui_model.graph_channel = g_ui_graph_channel;
-    g_ui_model.graph_window_s = (uint8_t)g_graph_window_s[g_ui_graph_window_idx];
-    g_ui_model.graph_sample_hz = (uint8_t)(1000u / UI_TICK_MS);
-    g_ui_model.bus_diff = bool_to_u8(bus_state.diff_enabled);
-    g_ui_model.bus_changed_only = bool_to_u8(bus_state.changed_only);
-    g_ui_model.bus_entries = 0u;
-    g_ui_model.bus_filter_id_active = bool_to_u8(bus_state.filter_id);
-    g_ui_model.bus_filter_opcode_active = bool_to_u8(bus_state.filter_opcode);
-    g_ui_model.bus_filter_id = bus_state.filter_bus_id;
-    g_ui_model.bus_filter_opcode = bus_state.filter_opcode_val;
-
-    /* Initialize arrays */
-    for (uint8_t i = 0; i < BUS_UI_VIEW_MAX; ++i) {
-        g_ui_model.bus_list_id[i] = 0u;
-        g_ui_model.bus_list_op[i] = 0u;
-        g_ui_model.bus_list_len[i] = 0u;
-        g_ui_model.bus_list_dt_ms[i] = 0u;
+    if (need & UI_CH_CRUISE)
+    {
+        g_ui_model.cruise_resume_available = g_cruise.resume_available;
+        g_ui_model.cruise_resume_reason = g_cruise.resume_block_reason;
+        g_ui_model.cruise_mode = (uint8_t)g_cruise.mode;
+        g_ui_model.cruise_set_dmph = g_cruise.set_speed_dmph;
+        g_ui_model.cruise_set_power_w = g_cruise.set_power_w;
     }
+    if (need & UI_CH_GRAPH)
+    {
+        g_ui_model.graph_channel = g_ui_graph_channel;
+        g_ui_model.graph_window_s = g_graph_window_s[g_ui_graph_window_idx];
+        /* UI_GRAPH_CH_* match GRAPH_CH_SPEED..GRAPH_CH_CAD. */
+        g_ui_model.graph_cols = (g_ui_page == UI_PAGE_GRAPHS)
+            ? graph_get_columns(g_ui_graph_channel, (uint32_t)g_ui_model.graph_window_s * 1000u,
+                                UI_GRAPH_COLS, g_ui_model.graph_min, g_ui_model.graph_max,
+                                &g_ui_model.graph_pos)
+            : 0u;
+        g_ui_model.graph_sample_hz = (uint8_t)(1000u / UI_TICK_MS);
+    }
+
+    if (need & UI_CH_ALERTS)
+    {
+        g_ui_model.alert_ack_active = g_alert_ack_active;
+        g_ui_model.alert_count = (g_event_meta.count > 0xFFFFu) ? 0xFFFFu : (uint16_t)g_event_meta.count;
+        g_ui_model.alert_entries = g_alert_count;
+        uint32_t trip_mm = trip_get_acc()->distance_mm;
+        /* 0.1 km or 0.1 mi, as the page prints it. */
+        uint32_t d10_mm = g_config_active.units ? 100000u : 160934u;
+        for (uint8_t i = 0; i < 3u; ++i) {
+            const app_alert_t *al = &g_alerts[i];
+            uint8_t used = (uint8_t)(i < g_alert_count);
+            uint32_t age_s = used ? (g_ms - al->ms) / 1000u : 0u;
+            /* A trip reset since leaves the odometer behind the alert. */
+            uint32_t d10 = (used && trip_mm >= al->trip_mm) ? (trip_mm - al->trip_mm) / d10_mm : 0u;
+            g_ui_model.alert_type[i] = used ? al->type : 0u;
+            g_ui_model.alert_flags[i] = used ? al->flags : 0u;
+            g_ui_model.alert_age_s[i] = (age_s > 0xFFFFu) ? 0xFFFFu : (uint16_t)age_s;
+            g_ui_model.alert_dist_d10[i] = (d10 > 0xFFFFu) ? 0xFFFFu : (uint16_t)d10;
+        }
+
+        if (g_ui_model.alert_entries && g_ui_alert_index >= g_ui_model.alert_entries) {
+            g_ui_alert_index = (uint8_t)(g_ui_model.alert_entries - 1u);
+        }
 
-    g_ui_model.alert_entries = 0u;
-    for (uint8_t i = 0; i < 3u; ++i) {
-        g_ui_model.alert_type[i] = 0u;
-        g_ui_model.alert_flags[i] = 0u;
-        g_ui_model.alert_age_s[i] = 0u;
-        g_ui_model.alert_dist_d10[i] = 0u;
+        g_ui_model.alert_selected = g_ui_alert_index;
+        g_ui_model.alert_ack_mask = g_ui_alert_ack_mask;
     }
 
-    if (g_ui_model.alert_entries && g_ui_alert_index >= g_ui_model.alert_entries) {
-        g_ui_alert_index = (uint8_t)(g_ui_model.alert_entries - 1u);
+    /* Render timing from previous frames (engineer perf page) */
+    if (need & UI_CH_PERF)
+    {
+        ui_perf_screen_t all;
+        ui_perf_screen_get(&g_ui.perf, UI_PERF_PAGE_ALL, &all);
+        g_ui_model.perf_frame_us = all.last_us;
+        g_ui_model.perf_avg_us = all.frames ? (all.total_us / all.frames) : 0u;
+        g_ui_model.perf_max_us = all.max_us;
+        g_ui_model.perf_over_budget = all.hist[UI_PERF_HIST_BUCKETS - 1u];
+        g_ui_model.perf_worst_page = ui_perf_worst_page(&g_ui.perf);
+        for (uint8_t i = 0; i < UI_PERF_PRIM_COUNT; ++i)
+            g_ui_model.perf_prim_us[i] = g_ui.perf.prims[i].last_us;
+
+        if (g_ui.draw_ops) /* 0 on ticks that drew nothing */
+            g_ui_model.perf_draw_ops = g_ui.draw_ops;
+        g_ui_model.loop_permille = (uint16_t)(1000u - app_idle_permille());
+        g_ui_model.isr_tim2_permille = app_irq_permille(PLATFORM_IRQ_LOAD_TIM2);
+        g_ui_model.isr_usart_permille = app_irq_permille(PLATFORM_IRQ_LOAD_USART);
+        g_ui_model.isr_dma_permille = app_irq_permille(PLATFORM_IRQ_LOAD_DMA);
+        g_ui_model.flash_permille = app_flash_permille();
+        flash_health_region_t fh;
+        flash_health_total(&fh);
+        g_ui_model.flash_erases = fh.erases;
+        g_ui_model.flash_block_max_us = fh.block_max_us;
+
+        work_queue_stats_t wq;
+        work_queue_get_stats(&wq);
+        g_ui_model.wq_hwm = wq.hwm;
+        g_ui_model.evq_hwm = 0u;
+        for (uint8_t lane = 0; lane < EVENT_BUS_LANES; ++lane)
+        {
+            event_lane_stats_t ls;
+            if (event_bus_lane_stats(&g_event_bus, lane, &ls) && ls.queue.hwm > g_ui_model.evq_hwm)
+                g_ui_model.evq_hwm = ls.queue.hwm;
+        }
+
+        g_ui_model.sched_max_us = 0u;
+        g_ui_model.sched_ewma_us = 0u;
+        g_ui_model.sched_overruns = 0u;
+        for (uint8_t slot = 0; slot < SCHED_SLOT_MAX; ++slot)
+        {
+            scheduler_stats_t st;
+            if (!scheduler_get_stats(slot, &st))
+                continue;
+            if (st.max_us > g_ui_model.sched_max_us)
+                g_ui_model.sched_max_us = st.max_us;
+            if (st.ewma_us > g_ui_model.sched_ewma_us)
+                g_ui_model.sched_ewma_us = st.ewma_us;
+            g_ui_model.sched_overruns += st.overruns + st.late;
+        }
     }
 
-    g_ui_model.alert_selected = g_ui_alert_index;
-    g_ui_model.alert_ack_mask = g_ui_alert_ack_mask;
+}
+
+/* Model groups the next frame reads: the shown page's, or all of them while
+ * the UI trace, which reports fields of every page, is on. */
+static uint32_t app_ui_model_need(void)
+{
+    if (g_debug_uart_mask & DEBUG_UART_TRACE_UI)
+        return UI_CH_ALL;
+    return ui_page_model_deps((uint8_t)g_ui_page);
+}
 
+static void app_ui_render(uint32_t now_ms)
+{
     /* Call UI tick to render and emit trace */
     ui_trace_t trace;
     ui_trace_t *trace_ptr = (g_debug_uart_mask & DEBUG_UART_TRACE_UI) ? &trace : NULL;
     if (trace_ptr) {
         trace = (ui_trace_t){0};
     }
-    if (ui_tick(&g_ui, &g_ui_model, g_ms, trace_ptr)) {
-        if (trace_ptr) {
+    if (ui_tick(&g_ui, &g_ui_model, now_ms, trace_ptr)) {
+        if (trace_ptr && (g_debug_uart_mask & DEBUG_UART_BINARY)) {
+            uint8_t rec[TRACE_BIN_MAX_LEN];
+            size_t n = ui_pack_dashboard_trace(rec, sizeof(rec), &g_ui_model, trace_ptr, g_ms);
+            if (n > 0) {
+                send_frame_port(PORT_BLE, TRACE_FRAME_CMD, rec, (uint8_t)n);
+            }
+        } else if (trace_ptr) {
             char line[180];
             size_t n = ui_format_dashboard_trace(line, sizeof(line), &g_ui_model, trace_ptr, g_ms);
             if (n > 0) {
@@ -678,22 +1077,383 @@ void app_update_ui(void)
     }
 }
 
+void app_update_ui(void)
+{
+    if (!g_ui.frame_request && (uint32_t)(g_ms - g_ui.last_tick_ms) < ui_frame_interval_ms(&g_ui)) {
+        return;
+    }
+    app_ui_build_model(app_ui_model_need());
+    app_ui_render(g_ms);
+}
+
+/*
+ * Status-frame control step. The motor ISR posts app_control_on_status()
+ * after each decoded status frame, so on target the control law runs from
+ * PendSV as soon as the frame lands instead of on the next motor slot.
+ * PendSV can preempt the main loop anywhere, so the step only runs while
+ * busy is clear: the top-of-loop drain and idle, neither of which touches
+ * control state or flash. The step can reach flash itself (a capture that
+ * fires the bus trigger starts its flash recording), so it never runs
+ * under the UI render, which reads glyph and sprite packs from SPI flash.
+ * A frame that lands during the render is marked pending and run at the
+ * render's preemption point, between draw ops, where no flash read is in
+ * progress; the frame still reaches the command mid-render. Anywhere else
+ * the motor slot is kicked and picks it up on the next pass. Only the
+ * motor lane is dispatched here; button handlers persist settings and
+ * stay in the loop.
+ */
+static struct
+{
+    volatile uint8_t busy;
+    volatile uint8_t pending;         /* a status frame was deferred */
+    uint32_t runs;
+    uint32_t deferred;
+    motor_isr_timing_t latency;       /* status publish to command staged */
+} g_ctrl = { .busy = 1u };
+
+static void app_control_latency_add(uint32_t us)
+{
+    motor_isr_timing_t *t = &g_ctrl.latency;
+    t->last_us = us;
+    if (us > t->max_us)
+        t->max_us = us;
+    if (t->avg_us == 0u)
+        t->avg_us = us;
+    else
+        t->avg_us = (uint32_t)(((uint64_t)t->avg_us * 7u + us) >> 3);
+}
+
+static void app_control_step(void)
+{
+    g_ctrl.pending = 0u;
+    (void)event_bus_dispatch_lane(&g_event_bus, EVENT_LANE_MOTOR, APP_CONTROL_MAX_EVENTS, g_ms);
+    recompute_outputs();
+    app_control_latency_add(platform_cycles_to_us(platform_cycles_now() - motor_isr_status_cycles()));
+    g_ctrl.runs++;
+}
+
+static void app_control_on_status(void *ctx)
+{
+    (void)ctx;
+    if (g_ctrl.busy)
+    {
+        g_ctrl.deferred++;
+        g_ctrl.pending = 1u;
+        scheduler_kick(SCHED_SLOT_MOTOR_MAIN);
+        return;
+    }
+    g_ctrl.busy = 1u;
+    app_control_step();
+    g_ctrl.busy = 0u;
+}
+
+void app_control_get_stats(app_control_stats_t *out)
+{
+    if (!out)
+        return;
+    out->runs = g_ctrl.runs;
+    out->deferred = g_ctrl.deferred;
+    out->lat_last_us = g_ctrl.latency.last_us;
+    out->lat_avg_us = g_ctrl.latency.avg_us;
+    out->lat_max_us = g_ctrl.latency.max_us;
+}
+
+/* A press gets its frame on the next pass instead of the next UI period. */
+static void app_ui_wake(void)
+{
+    ui_request_frame(&g_ui);
+    (void)scheduler_kick(SCHED_SLOT_UI);
+}
+
+static void app_task_motor(void *ctx, uint32_t now_ms)
+{
+    (void)ctx;
+    /* The full dispatch below covers any deferred status frame. */
+    g_ctrl.pending = 0u;
+    app_process_events();
+    uint8_t pressed = (g_button_short_press || g_button_long_press) ? 1u : 0u;
+    app_apply_inputs();
+    g_input_preempted = 0u;
+    /* Back to full clock before the frame a press or motion asks for. */
+    uint8_t active = (pressed || app_config_change_speed_dmph() != 0u || ble_ttm_is_connected()) ? 1u : 0u;
+    clock_profile_tick(now_ms, active);
+    if (pressed)
+        app_ui_wake();
+}
+
+/* Icon sprites come from the SPI flash asset pack when one is stored. */
+_Static_assert(UI_ASSET_FMT_RGB565 == UI_SPRITE_FMT_RGB565 && UI_ASSET_FMT_A4_RLE == UI_SPRITE_FMT_A4_RLE,
+               "asset pack and sprite formats share codes");
+static int app_ui_sprite_lookup(uint32_t id, ui_sprite_t *out)
+{
+    ui_asset_t a;
+    if (!ui_asset_find(id, &a))
+        return 0;
+    ui_assets_info_t info;
+    ui_assets_get_info(&info);
+    out->addr = a.addr;
+    out->tag = info.crc32;
+    out->w = a.w;
+    out->h = a.h;
+    out->len = a.len;
+    out->fmt = a.fmt;
+    return 1;
+}
+
+/*
+ * Render preemption point (ui_tick calls it between draw ops). A full
+ * redraw can outlast several ticks, so a button edge during one is sampled
+ * here and its press dispatched on the spot: the gear change reaches the
+ * motor command without waiting for the frame. Only the input lane runs;
+ * page actions that read the press flags wait for the motor slot, which
+ * skips its own sample until it has applied them. A status frame deferred
+ * during the render runs its control step here too (see g_ctrl). busy
+ * stays raised for the whole render, so PendSV cannot run the step while
+ * these handlers are persisting settings.
+ */
+static void app_ui_preempt(void)
+{
+    static uint32_t last_ms;
+    if (g_ctrl.pending)
+        app_control_step();
+    if (g_ms == last_ms || g_input_preempted)
+        return;
+    last_ms = g_ms;
+    buttons_tick();
+    if (g_button_short_press || g_button_long_press)
+    {
+        g_input_preempted = 1u;
+        (void)event_bus_dispatch_lane(&g_event_bus, EVENT_LANE_INPUT, APP_PREEMPT_MAX_EVENTS, g_ms);
+        input_latency_note_preempt();
+        app_ui_wake();
+    }
+}
+
+static void app_task_periodic(void *ctx, uint32_t now_ms)
+{
+    (void)ctx;
+    (void)now_ms;
+    app_process_periodic();
+}
+
+static void app_task_status(void *ctx, uint32_t now_ms)
+{
+    (void)ctx;
+    g_last_print = now_ms;
+    print_status();
+}
+
+/*
+ * A frame is two chunks: the model snapshot, then the render on the next
+ * tick, so the motor task runs in between. The slot is phase-locked, and
+ * the render is stamped with its UI_TICK_FAST_MS boundary so ui_tick's own
+ * pacing never rejects a frame that started a tick late. A progressive
+ * redraw adds a render chunk per tick until the frame is done. Each frame
+ * then sets the slot's period to ui_frame_interval_ms(): fast while the
+ * ride changes, down to UI_TICK_IDLE_MS parked, which the idle loop sleeps
+ * through. A press kicks the slot for an immediate frame.
+ */
+static void app_task_ui(void *ctx, uint32_t now_ms)
+{
+    (void)ctx;
+    static uint8_t render_next;
+    static uint32_t frame_ms;
+    static uint8_t first_frame_logged;
+
+    if (!render_next)
+    {
+        frame_ms = now_ms - (now_ms - APP_UI_PHASE_MS) % UI_TICK_FAST_MS;
+        app_ui_build_model(app_ui_model_need());
+        input_latency_frame_begin();
+        render_next = 1u;
+        scheduler_yield();
+        return;
+    }
+    render_next = 0u;
+    app_ui_render(frame_ms);
+    if (ui_render_pending(&g_ui))
+    {
+        render_next = 1u;
+        scheduler_yield();
+        return;
+    }
+    input_latency_mark(INPUT_LAT_DRAWN);
+    (void)scheduler_set_interval(SCHED_SLOT_UI, ui_frame_interval_ms(&g_ui));
+
+    if (!first_frame_logged)
+    {
+        /* End of the boot waterfall (0x3E): first frame on the panel. */
+        first_frame_logged = 1u;
+        boot_log_stage(0xB021);
+    }
+}
+
+/*
+ * Idle accounting: awake time is measured with CYCCNT between wakes (the
+ * counter may stop in sleep), and idle is the rest of each g_ms window.
+ * The same window turns the handler-group cycle counters and the SPI flash
+ * DMA busy time into per-mille loads for the perf page.
+ */
+static struct
+{
+    uint32_t wake_cycles;
+    uint32_t busy_us;
+    uint32_t window_start_ms;
+    uint16_t idle_permille;
+    uint32_t sleeps;
+    uint32_t irq_cycles[PLATFORM_IRQ_LOAD_COUNT];
+    uint16_t irq_permille[PLATFORM_IRQ_LOAD_COUNT];
+    uint32_t flash_busy_us;
+    uint16_t flash_permille;
+} g_idle;
+
+uint16_t app_idle_permille(void)
+{
+    return g_idle.idle_permille;
+}
+
+uint32_t app_idle_sleeps(void)
+{
+    return g_idle.sleeps;
+}
+
+uint16_t app_irq_permille(uint8_t group)
+{
+    return (group < PLATFORM_IRQ_LOAD_COUNT) ? g_idle.irq_permille[group] : 0u;
+}
+
+uint16_t app_flash_permille(void)
+{
+    return g_idle.flash_permille;
+}
+
+/* us spent per ms of window is the load in per mille. */
+static uint16_t app_load_permille(uint32_t us, uint32_t span_ms)
+{
+    uint32_t pm = us / span_ms;
+    return (uint16_t)((pm > 1000u) ? 1000u : pm);
+}
+
+static void app_idle_account(uint32_t now_ms)
+{
+    uint32_t span_ms = now_ms - g_idle.window_start_ms;
+    if (span_ms < APP_IDLE_WINDOW_MS)
+        return;
+    uint32_t busy_ms = g_idle.busy_us / 1000u;
+    g_idle.idle_permille = (busy_ms >= span_ms) ? 0u : (uint16_t)(((span_ms - busy_ms) * 1000u) / span_ms);
+    uint32_t cycles[PLATFORM_IRQ_LOAD_COUNT];
+    platform_irq_load_cycles(cycles);
+    for (uint8_t i = 0; i < PLATFORM_IRQ_LOAD_COUNT; ++i)
+    {
+        g_idle.irq_permille[i] = app_load_permille(platform_cycles_to_us(cycles[i] - g_idle.irq_cycles[i]), span_ms);
+        g_idle.irq_cycles[i] = cycles[i];
+    }
+    platform_dma_stats_t rx;
+    platform_dma_stats_t tx;
+    platform_dma_stats(PLATFORM_DMA_FLASH_RX, &rx);
+    platform_dma_stats(PLATFORM_DMA_FLASH_TX, &tx);
+    uint32_t flash_us = rx.busy_us + tx.busy_us;
+    g_idle.flash_permille = app_load_permille(flash_us - g_idle.flash_busy_us, span_ms);
+    g_idle.flash_busy_us = flash_us;
+    g_idle.busy_us = 0u;
+    g_idle.window_start_ms = now_ms;
+}
+
+/* Work that the every-tick slots should pick up before the next TIM2 tick. */
+static uint8_t app_work_pending(void)
+{
+    uint8_t pending = work_queue_pending() ? 1u : 0u;
+    if (event_bus_pending(&g_event_bus) || comm_rx_pending() || platform_buttons_activity_pending() ||
+        uart_rx_available(UART1_BASE) || uart_rx_available(UART2_BASE))
+    {
+        scheduler_kick(SCHED_SLOT_MOTOR_MAIN);
+        pending = 1u;
+    }
+    ab_verify_status_t verify;
+    ab_update_get_verify(&verify);
+    if (flash_jobs_pending() || verify.busy)
+    {
+        scheduler_kick(SCHED_SLOT_POWER);
+        pending = 1u;
+    }
+    return pending;
+}
+
+/*
+ * Sleep until the next interrupt when no slot or timer is due and nothing is
+ * queued. TIM2 keeps running for the motor ISR, so the core wakes at least
+ * every APP_TICK_MS; UART RX, DMA and flash interrupts wake it sooner.
+ */
+static void app_idle(void)
+{
+    g_ctrl.busy = 0u;
+    uint32_t now_cycles = platform_cycles_now();
+    g_idle.busy_us += platform_cycles_to_us(now_cycles - g_idle.wake_cycles);
+    g_idle.wake_cycles = now_cycles;
+    app_idle_account(g_ms);
+
+    if (!platform_time_irq_live())
+        return;
+    if (app_work_pending() || scheduler_next_due_ms(g_ms) == 0u || timer_wheel_next_due_ms(g_ms) == 0u)
+        return;
+
+    /* With PRIMASK set a pending IRQ still ends WFI, so nothing that lands
+     * after the checks can be slept through. */
+    disable_irqs();
+    uint32_t now_ms = g_ms;
+    if (scheduler_next_due_ms(now_ms) != 0u && timer_wheel_next_due_ms(now_ms) != 0u &&
+        !event_bus_pending(&g_event_bus) && !work_queue_pending())
+    {
+        g_idle.sleeps++;
+        wfi();
+    }
+    enable_irqs();
+    g_idle.wake_cycles = platform_cycles_now();
+}
+
 void app_housekeeping(void)
 {
     /* Avoid deadlock on boards where IRQ delivery is flaky during bring-up. */
-    platform_time_poll_1ms();
+    if (!platform_time_irq_live())
+        platform_time_poll_1ms();
 }
 
 void app_main_loop(void)
 {
     boot_stage_log(0xB020);
     boot_log_stage(0xB020);
+    /* Boot is done: the staged codes go to flash in one page program. */
+    boot_stage_commit();
+    platform_ram_mark_boot();
+    event_bus_subscribe(&g_event_bus, EVT_CAT_MOTOR, handle_motor_event, NULL);
+    event_bus_subscribe(&g_event_bus, EVT_CAT_BUTTON, handle_button_event, NULL);
+    scheduler_init();
+    scheduler_register(SCHED_SLOT_MOTOR_MAIN, APP_TICK_MS, app_task_motor, NULL);
+    scheduler_register(SCHED_SLOT_POWER, APP_TICK_MS, app_task_periodic, NULL);
+    scheduler_register(SCHED_SLOT_UI, UI_TICK_MS, app_task_ui, NULL);
+    scheduler_register(SCHED_SLOT_TELEMETRY, APP_STATUS_PERIOD_MS, app_task_status, NULL);
+    /* Fixed boundaries keep the UI frame and the status print apart. */
+    scheduler_set_mode(SCHED_SLOT_UI, SCHED_MODE_LOCKED_SKIP, APP_UI_PHASE_MS);
+    scheduler_set_mode(SCHED_SLOT_TELEMETRY, SCHED_MODE_LOCKED_SKIP, APP_STATUS_PHASE_MS);
+    scheduler_set_tick_budget(APP_SCHED_TICK_BUDGET_US);
+    timer_wheel_init(g_ms);
+    g_idle.wake_cycles = platform_cycles_now();
+    g_idle.window_start_ms = g_ms;
+    app_lifetime_start();
+    motor_isr_set_status_hook(app_control_on_status);
+    ui_set_preempt_hook(app_ui_preempt);
+    ui_set_sprite_lookup(app_ui_sprite_lookup);
+    ui_glyph_cache_set_read(spi_flash_read);
     while (1) {
+        /* On target PendSV runs posted work as soon as the posting ISR
+         * returns; this pass covers the host build, which has no PendSV. */
+        g_ctrl.busy = 0u;
+        (void)work_queue_drain(0);
+        g_ctrl.busy = 1u;
         app_process_time();
-        app_process_events();
-        app_apply_inputs();
-        app_process_periodic();
-        app_update_ui();
+        scheduler_tick(g_ms);
+        timer_wheel_tick(g_ms);
         app_housekeeping();
+        app_idle();
     }
 }
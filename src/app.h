@@ -9,10 +9,29 @@
 void app_main_loop(void) __attribute__((noreturn));
 void app_process_time(void);
 void app_process_events(void);
+/* Deliver queued bus events to their subscribers (main context only). */
+void app_dispatch_events(void);
 void app_apply_inputs(void);
 void app_process_periodic(void);
 void app_update_ui(void);
 void app_housekeeping(void);
-void watchdog_feed_runtime(void);
+/* Share of the last ~1 s the main loop spent in WFI, 0..1000. */
+uint16_t app_idle_permille(void);
+uint32_t app_idle_sleeps(void);
+/* Last idle window's load of a PLATFORM_IRQ_LOAD_* handler group and of the
+ * SPI flash DMA channels, per mille. */
+uint16_t app_irq_permille(uint8_t group);
+uint16_t app_flash_permille(void);
+
+/* Control steps run straight off motor status frames (see app.c). */
+typedef struct {
+    uint32_t runs;
+    uint32_t deferred;       /* frame landed while the loop was busy */
+    uint32_t lat_last_us;    /* status publish to command staged */
+    uint32_t lat_avg_us;     /* EWMA, 1/8 weight */
+    uint32_t lat_max_us;
+} app_control_stats_t;
+
+void app_control_get_stats(app_control_stats_t *out);
 
 #endif /* APP_H */
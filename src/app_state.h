@@ -15,11 +15,11 @@ extern uint32_t g_stream_period_ms;
 extern uint32_t g_last_stream_ms;
 extern uint8_t g_brake_edge;
 extern reboot_request_t g_request_soft_reboot;
-extern uint16_t g_curve_power_w;
-extern uint16_t g_curve_cadence_q15;
 
 #define DEBUG_UART_TRACE_UI 0x01u
 #define DEBUG_UART_STATUS   0x02u
+/* With TRACE_UI/STATUS: send trace_bin records (TRACE_FRAME_CMD) instead of text. */
+#define DEBUG_UART_BINARY   0x04u
 
 extern uint8_t g_debug_uart_mask;
 
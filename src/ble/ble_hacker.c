@@ -52,7 +52,9 @@ int ble_hacker_decode(const uint8_t *buf, uint8_t len,
 uint8_t ble_hacker_encode(uint8_t opcode, const uint8_t *payload,
                           uint8_t payload_len, uint8_t *out, uint8_t out_max)
 {
-    uint8_t total = (uint8_t)(payload_len + 3u);
+    /* Sized wider than the result so a 253+ byte payload cannot wrap past
+     * the out_max check. */
+    uint16_t total = (uint16_t)(payload_len + 3u);
     if (!out || out_max < total)
         return 0;
 
@@ -61,23 +63,63 @@ uint8_t ble_hacker_encode(uint8_t opcode, const uint8_t *payload,
     out[2] = payload_len;
     if (payload_len && payload)
         copy_bytes(&out[3], payload, payload_len);
-    return total;
+    return (uint8_t)total;
 }
 
 uint8_t ble_hacker_encode_status(uint8_t opcode, uint8_t status,
                                  const uint8_t *payload, uint8_t payload_len,
                                  uint8_t *out, uint8_t out_max)
 {
-    uint8_t total_payload = (uint8_t)(payload_len + 1u);
-    uint8_t total = (uint8_t)(total_payload + 3u);
+    uint16_t total = (uint16_t)(payload_len + 4u);
     if (!out || out_max < total)
         return 0;
 
     out[0] = BLE_HACKER_VERSION;
     out[1] = opcode;
-    out[2] = total_payload;
+    out[2] = (uint8_t)(payload_len + 1u);
     out[3] = status;
     if (payload_len && payload)
         copy_bytes(&out[4], payload, payload_len);
-    return total;
+    return (uint8_t)total;
+}
+
+void ble_hacker_batch_init(ble_hacker_batch_t *b, uint8_t mtu, uint16_t deadline_ms)
+{
+    if (!b)
+        return;
+    b->mtu = (mtu && mtu <= BLE_HACKER_BATCH_MAX) ? mtu : (uint8_t)BLE_HACKER_BATCH_MAX;
+    b->deadline_ms = deadline_ms;
+    ble_hacker_batch_clear(b);
+}
+
+uint8_t ble_hacker_batch_add_status(ble_hacker_batch_t *b, uint8_t opcode, uint8_t status,
+                                    const uint8_t *payload, uint8_t payload_len,
+                                    uint32_t now_ms)
+{
+    if (!b || b->len > b->mtu)
+        return 0;
+    uint8_t n = ble_hacker_encode_status(opcode, status, payload, payload_len,
+                                         &b->buf[b->len], (uint8_t)(b->mtu - b->len));
+    if (!n)
+        return 0;
+    if (b->count == 0u)
+        b->opened_ms = now_ms;
+    b->len = (uint8_t)(b->len + n);
+    b->count++;
+    return n;
+}
+
+int ble_hacker_batch_due(const ble_hacker_batch_t *b, uint32_t now_ms)
+{
+    if (!b || b->count == 0u)
+        return 0;
+    return (uint32_t)(now_ms - b->opened_ms) >= b->deadline_ms;
+}
+
+void ble_hacker_batch_clear(ble_hacker_batch_t *b)
+{
+    if (!b)
+        return;
+    b->len = 0u;
+    b->count = 0u;
 }
@@ -15,6 +15,7 @@
 
 #define BLE_HACKER_OP_VERSION      0x01u
 #define BLE_HACKER_OP_TELEMETRY    0x02u
+#define BLE_HACKER_OP_SUBSCRIBE    0x03u
 #define BLE_HACKER_OP_CONFIG_GET   0x10u
 #define BLE_HACKER_OP_CONFIG_STAGE 0x11u
 #define BLE_HACKER_OP_CONFIG_COMMIT 0x12u
@@ -23,6 +24,7 @@
 #define BLE_HACKER_CAP_TELEMETRY 0x01u
 #define BLE_HACKER_CAP_CONFIG    0x02u
 #define BLE_HACKER_CAP_DEBUG     0x04u
+#define BLE_HACKER_CAP_NOTIFY    0x08u
 
 typedef struct {
     uint8_t version;
@@ -40,3 +42,34 @@ uint8_t ble_hacker_encode(uint8_t opcode, const uint8_t *payload,
 uint8_t ble_hacker_encode_status(uint8_t opcode, uint8_t status,
                                  const uint8_t *payload, uint8_t payload_len,
                                  uint8_t *out, uint8_t out_max);
+
+/*
+ * Notification batching: several encoded messages packed back to back into
+ * one write of up to `mtu` bytes, so the TTM UART bridge pays its per-write
+ * overhead once. The batch is flushed when the next message would not fit
+ * or `deadline_ms` after its first message was added.
+ */
+#define BLE_HACKER_BATCH_MAX 192u
+
+typedef struct {
+    uint8_t buf[BLE_HACKER_BATCH_MAX];
+    uint8_t len;
+    uint8_t count;
+    uint8_t mtu;
+    uint16_t deadline_ms;
+    uint32_t opened_ms;     /* when the first message went in */
+} ble_hacker_batch_t;
+
+void ble_hacker_batch_init(ble_hacker_batch_t *b, uint8_t mtu, uint16_t deadline_ms);
+
+/* Appends an encoded status message; returns its length, 0 if it does not
+ * fit the remaining room (flush and retry). */
+uint8_t ble_hacker_batch_add_status(ble_hacker_batch_t *b, uint8_t opcode, uint8_t status,
+                                    const uint8_t *payload, uint8_t payload_len,
+                                    uint32_t now_ms);
+
+/* Non-zero when the batch holds messages whose deadline has passed. */
+int ble_hacker_batch_due(const ble_hacker_batch_t *b, uint32_t now_ms);
+
+/* Empties the batch after its contents were sent (or dropped). */
+void ble_hacker_batch_clear(ble_hacker_batch_t *b);
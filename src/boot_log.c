@@ -13,25 +13,23 @@
 #include "ui_display.h"
 #endif
 
-#define BOOT_LOG_MAX_ENTRIES 32u
 #define BOOT_LOG_LCD_LINE_H  12u
 #define BOOT_LOG_LCD_X       4u
 #define BOOT_LOG_LCD_Y       4u
 #define BOOT_LOG_LCD_FG      0xFFFFu
 #define BOOT_LOG_LCD_BG      0x0000u
 
-typedef struct {
-    uint32_t code;
-    uint32_t ms;
-} boot_log_entry_t;
-
 static boot_log_entry_t g_boot_log[BOOT_LOG_MAX_ENTRIES];
 static uint32_t g_boot_log_count;
+static uint32_t g_boot_log_cycles;
+static uint32_t g_boot_log_us;
 static uint32_t g_uart_flushed;
-static uint32_t g_lcd_flushed;
 static uint8_t g_uart_ready;
 static uint8_t g_lcd_ready;
+#if !defined(HOST_TEST)
+static uint32_t g_lcd_flushed;
 static uint8_t g_lcd_line;
+#endif
 
 static uint32_t boot_log_start_index(void)
 {
@@ -53,7 +51,8 @@ static size_t boot_log_format(char *line, size_t size, const boot_log_entry_t *e
     append_hex_u32(&ptr, &rem, entry->code);
     append_str(&ptr, &rem, " t=");
     append_u32(&ptr, &rem, entry->ms);
-    append_str(&ptr, &rem, "ms");
+    append_str(&ptr, &rem, "ms us=");
+    append_u32(&ptr, &rem, entry->us);
     append_str(&ptr, &rem, "\n");
     if (rem)
         *ptr = '\0';
@@ -111,13 +110,35 @@ static void boot_log_flush_lcd(void)
 
 void boot_log_stage(uint32_t code)
 {
+    /* Re-reads HCLK, so the stage that switched clocks converts at the new
+     * rate; enables the counter on the first stage. */
+    platform_cycle_counter_init();
+    uint32_t now = platform_cycles_now();
+    if (g_boot_log_count)
+        g_boot_log_us += platform_cycles_to_us(now - g_boot_log_cycles);
+    g_boot_log_cycles = now;
+
     uint32_t idx = g_boot_log_count;
-    g_boot_log[idx % BOOT_LOG_MAX_ENTRIES] = (boot_log_entry_t){ code, g_ms };
+    g_boot_log[idx % BOOT_LOG_MAX_ENTRIES] = (boot_log_entry_t){ code, g_ms, g_boot_log_us };
     g_boot_log_count++;
     boot_log_flush_uart();
     boot_log_flush_lcd();
 }
 
+uint32_t boot_log_count(void)
+{
+    return g_boot_log_count;
+}
+
+int boot_log_read(uint32_t idx, boot_log_entry_t *out)
+{
+    uint32_t start = boot_log_start_index();
+    if (!out || start + idx >= g_boot_log_count)
+        return 0;
+    *out = boot_log_get(start + idx);
+    return 1;
+}
+
 void boot_log_uart_ready(void)
 {
     g_uart_ready = 1u;
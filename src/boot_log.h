@@ -3,7 +3,26 @@
 
 #include <stdint.h>
 
+/*
+ * RAM boot log. Each stage is stamped from the DWT cycle counter as well as
+ * g_ms (5 ms, and zeroed before the main loop), so per-stage durations hold
+ * for the early stages too. us is converted at the clock rate in effect when
+ * the stage ends; from the main loop on the counter can stop in WFI, which
+ * makes those stages lower bounds.
+ */
+#define BOOT_LOG_MAX_ENTRIES 32u
+
+typedef struct {
+    uint32_t code;
+    uint32_t ms;
+    uint32_t us;        /* since the first stage */
+} boot_log_entry_t;
+
 void boot_log_stage(uint32_t code);
+/* Stages logged since reset; only the newest BOOT_LOG_MAX_ENTRIES are kept. */
+uint32_t boot_log_count(void);
+/* idx counts from the oldest kept stage; returns 0 past the end. */
+int boot_log_read(uint32_t idx, boot_log_entry_t *out);
 void boot_log_uart_ready(void);
 void boot_log_lcd_ready(void);
 
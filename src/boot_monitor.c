@@ -1,14 +1,14 @@
 #include "src/boot_monitor.h"
 
-#include "drivers/spi_flash.h"
 #include "platform/hw.h"
 #include "platform/mmio.h"
 #include "platform/time.h"
 #include "platform/cpu.h"
+#include "platform/watchdog.h"
 #include "src/boot_phase.h"
 #include "src/comm/comm.h"
+#include "storage/boot_stage.h"
 #include "storage/crash_dump.h"
-#include "storage/layout.h"
 #include "util/byteorder.h"
 
 extern uint16_t g_reset_flags;
@@ -35,41 +35,6 @@ void boot_monitor_clear_continue(void)
     g_continue = 0u;
 }
 
-static int boot_stage_read_last(uint32_t *code_out, uint32_t *ms_out)
-{
-    if (code_out)
-        *code_out = 0u;
-    if (ms_out)
-        *ms_out = 0u;
-
-    uint8_t sec[SPI_FLASH_SECTOR_SIZE];
-    spi_flash_read(BOOT_STAGE_STORAGE_BASE, sec, SPI_FLASH_SECTOR_SIZE);
-
-    /* Entries are 8 bytes: code(be32), ms(be32). Scan for first erased code. */
-    uint32_t last_code = 0u;
-    uint32_t last_ms = 0u;
-    uint8_t have = 0u;
-    for (uint16_t i = 0; i < (SPI_FLASH_SECTOR_SIZE / 8u); ++i)
-    {
-        const uint8_t *e = &sec[i * 8u];
-        uint32_t code = load_be32(&e[0]);
-        uint32_t ms = load_be32(&e[4]);
-        if (code == 0xFFFFFFFFu)
-            break;
-        last_code = code;
-        last_ms = ms;
-        have = 1u;
-    }
-
-    if (!have)
-        return 0;
-    if (code_out)
-        *code_out = last_code;
-    if (ms_out)
-        *ms_out = last_ms;
-    return 1;
-}
-
 uint8_t boot_monitor_build_info(uint8_t *out, uint8_t cap)
 {
     /* Payload v1, 16 bytes:
@@ -84,8 +49,7 @@ uint8_t boot_monitor_build_info(uint8_t *out, uint8_t cap)
     store_be16(&out[2], g_reset_flags);
     store_be32(&out[4], g_reset_csr);
 
-    uint8_t crash_buf[CRASH_DUMP_SIZE];
-    uint8_t crash_valid = crash_dump_load(crash_buf) ? 1u : 0u;
+    uint8_t crash_valid = crash_dump_load() ? 1u : 0u;
     out[8] = crash_valid;
 
     uint32_t last_code = 0u;
@@ -105,7 +69,7 @@ void boot_monitor_run(void)
     while (!boot_monitor_should_continue())
     {
         platform_time_poll_1ms();
-        mmio_write32(IWDG_KR, IWDG_KR_FEED);
+        watchdog_feed_runtime();
         poll_uart_rx_ports();
 
         /* Panic monitor is best-effort: auto-exit to reset after a bounded window. */
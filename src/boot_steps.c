@@ -0,0 +1,48 @@
+#include "boot_steps.h"
+
+#include <stddef.h>
+
+static const boot_step_t *g_steps;
+static uint8_t g_step_count;
+static uint8_t g_steps_started;
+static uint8_t g_steps_done;
+static void (*g_step_mark)(uint32_t code);
+
+void boot_steps_begin(const boot_step_t *steps, uint8_t count, void (*mark)(uint32_t code))
+{
+    g_steps = steps;
+    g_step_count = (count > BOOT_STEPS_MAX) ? (uint8_t)BOOT_STEPS_MAX : count;
+    g_steps_started = 0u;
+    g_steps_done = 0u;
+    g_step_mark = mark;
+}
+
+int boot_steps_run_one(void)
+{
+    for (uint8_t i = 0; i < g_step_count; ++i)
+    {
+        uint8_t bit = (uint8_t)(1u << i);
+        if ((g_steps_started & bit) || (g_steps[i].deps & (uint8_t)~g_steps_done))
+            continue;
+        /* Started before it runs, so a step that waits in board code is not
+         * re-entered; its dependents wait until it returns. */
+        g_steps_started |= bit;
+        g_steps[i].fn();
+        g_steps_done |= bit;
+        if (g_step_mark)
+            g_step_mark(g_steps[i].code);
+        return 1;
+    }
+    return 0;
+}
+
+void boot_steps_finish(void)
+{
+    while (boot_steps_run_one())
+        ;
+}
+
+uint8_t boot_steps_done_mask(void)
+{
+    return g_steps_done;
+}
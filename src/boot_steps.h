@@ -0,0 +1,36 @@
+#ifndef OPEN_FIRMWARE_BOOT_STEPS_H
+#define OPEN_FIRMWARE_BOOT_STEPS_H
+
+#include <stdint.h>
+
+/*
+ * Dependency-ordered boot work. main() lists the init steps that do not need
+ * the panel, the UARTs or interrupts; board init runs them one at a time
+ * while it waits on the LCD (reset, sleep-out, DISPON), and
+ * boot_steps_finish() runs whatever is left once the panel is up.
+ *
+ * deps is a mask of step indices that must have run first. A step's code
+ * goes to the boot stage log when it completes.
+ *
+ * Flash loads in a step use the blocking spi_flash_read(). Interrupts stay
+ * masked until the end of boot, and the SPI flash DMA path (blocking or
+ * spi_flash_read_async_start()) needs the DMA IRQ to complete, so both fall
+ * back to polled reads here. That costs nothing: the board delays are timed
+ * on DWT cycles, so a step's time counts against the wait it runs in, and
+ * the CPU has nothing else to do during it.
+ */
+#define BOOT_STEPS_MAX 8u
+
+typedef struct {
+    void (*fn)(void);
+    uint32_t code;
+    uint8_t deps;
+} boot_step_t;
+
+void boot_steps_begin(const boot_step_t *steps, uint8_t count, void (*mark)(uint32_t code));
+/* Runs the first pending step whose deps are done; 0 when none is left. */
+int boot_steps_run_one(void);
+void boot_steps_finish(void);
+uint8_t boot_steps_done_mask(void);
+
+#endif
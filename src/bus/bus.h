@@ -8,15 +8,83 @@
 #define BUS_BLE     1
 
 /* Capture parameters */
-#define BUS_CAPTURE_VERSION   1u
+#define BUS_CAPTURE_VERSION   2u
 #define BUS_CAPTURE_MAX_DATA  32u
-#define BUS_CAPTURE_CAPACITY  64u
+/* The ring packs {len, bus_id, dt_ms be16, data[len]} records back to back,
+ * wrapping byte-wise; the oldest records are dropped to make room. Sized as
+ * 64 (1024 extended) records of the largest frame. */
+#define BUS_CAPTURE_RECORD_HEADER_BYTES 4u
+#define BUS_CAPTURE_RING_BYTES  (64u * (BUS_CAPTURE_RECORD_HEADER_BYTES + BUS_CAPTURE_MAX_DATA))
+#define BUS_CAPTURE_EXT_RING_BYTES (1024u * (BUS_CAPTURE_RECORD_HEADER_BYTES + BUS_CAPTURE_MAX_DATA)) /* in the extended SRAM bank */
 
 /* Inject safety limits */
 #define BUS_INJECT_SPEED_MAX_DMPH 10u
 #define BUS_REPLAY_RATE_MIN_MS 20u
 #define BUS_REPLAY_RATE_MAX_MS 1000u
 
+/* Replay modes (bus_capture_replay payload byte 0) */
+#define BUS_REPLAY_MODE_STOP  0u
+#define BUS_REPLAY_MODE_FIXED 1u /* RAM ring at a fixed rate */
+#define BUS_REPLAY_MODE_TIMED 2u /* RAM ring with recorded dt_ms */
+#define BUS_REPLAY_MODE_FLASH 3u /* uploaded flash capture with recorded dt_ms */
+/* Timed modes clamp idle gaps; rate_ms overrides when non-zero. */
+#define BUS_REPLAY_GAP_DEFAULT_MS 5000u
+/* Frames emitted per tick when several are due (dt_ms == 0 bursts). */
+#define BUS_REPLAY_BURST_MAX 4u
+
+/* Flash replay store: 16-byte header, then {bus_id, len, dt_ms be16, data[len]}. */
+#define BUS_REPLAY_STORE_MAGIC 0x4C505242u /* "BRPL" */
+#define BUS_REPLAY_STORE_VERSION 1u
+#define BUS_REPLAY_STORE_HEADER_BYTES 16u
+#define BUS_REPLAY_RECORD_HEADER_BYTES 4u
+
+/* Trigger recorder: the capture ring holds the pre-trigger window; once a
+ * frame matches, the window and the frames after it stream to the
+ * BUS_TRIGGER flash region as {bus_id, len, dt_ms be16, data[len]}, as in
+ * the replay store. Header (32 bytes, big-endian), written last:
+ *   [0..3] magic, [4..5] version, [6..7] records, [8..11] data bytes,
+ *   [12..15] crc32 of the data, [16..17] index of the trigger record,
+ *   [18..19] frames dropped, [20..23] trigger ms, [24] flags, [25] bus_id,
+ *   [26] opcode, [27..31] 0xFF. */
+#define BUS_TRIGGER_MAGIC 0x47525442u /* "BTRG" */
+#define BUS_TRIGGER_VERSION 1u
+#define BUS_TRIGGER_HEADER_BYTES 32u
+#define BUS_TRIGGER_F_BUS_ID 0x02u /* bits shared with BUS_UI_FLAG_FILTER_* */
+#define BUS_TRIGGER_F_OPCODE 0x04u /* data[0] */
+#define BUS_TRIGGER_F_BYTE   0x08u /* (data[byte_off] & byte_mask) == byte_val */
+
+#define BUS_TRIGGER_IDLE      0u
+#define BUS_TRIGGER_ARMED     1u
+#define BUS_TRIGGER_RECORDING 2u
+#define BUS_TRIGGER_DONE      3u
+
+/* Session recorder: what the display takes in from the bike (UART2 and
+ * UART1 RX bytes, the button pins, ADC means), streamed to the BUS_SESSION
+ * flash region as {bus_id, len, dt_ms be16, data[len]} records, as in the
+ * replay store, for host_sim to replay (BC280_SIM_SESSION). dt_ms runs from
+ * the previous record. RX bytes at most BUS_SESSION_BURST_MS apart share
+ * a record, stamped with its last byte, as the DMA IDLE path delivers them.
+ * Header (32 bytes, big-endian), written last:
+ *   [0..3] magic, [4..5] version, [6..7] flags, [8..11] data bytes,
+ *   [12..15] crc32 of the data, [16..19] records, [20..23] start ms,
+ *   [24..27] duration ms, [28..29] records dropped, [30..31] 0xFF. */
+#define BUS_SESSION_MAGIC 0x53455342u /* "BSES" */
+#define BUS_SESSION_VERSION 1u
+#define BUS_SESSION_HEADER_BYTES 32u
+#define BUS_SESSION_BUTTONS 0x10u /* {pressed}: PC0-4 mask, on change */
+#define BUS_SESSION_ADC     0x11u /* {input, raw be16}: 12-bit mean */
+#define BUS_SESSION_F_FULL  0x01u /* stopped when the region filled */
+#define BUS_SESSION_BURST_MS 2u
+/* ADC means are kept when they move this many counts, or once a period,
+ * which also keeps dt_ms in range on a quiet bus. */
+#define BUS_SESSION_ADC_INPUTS 2u
+#define BUS_SESSION_ADC_DELTA 4u
+#define BUS_SESSION_ADC_PERIOD_MS 1000u
+
+#define BUS_SESSION_IDLE      0u
+#define BUS_SESSION_RECORDING 1u
+#define BUS_SESSION_DONE      2u
+
 /* Inject override flags */
 #define BUS_INJECT_OVERRIDE_SPEED 0x01u
 #define BUS_INJECT_OVERRIDE_BRAKE 0x02u
@@ -38,10 +106,16 @@
 #define BUS_INJECT_STATUS_BRAKE            0xF4u
 #define BUS_INJECT_STATUS_CAPTURE_DISABLED 0xF5u
 #define BUS_INJECT_STATUS_BAD_RANGE        0xF6u
+#define BUS_REPLAY_STATUS_BAD_OFFSET       0xF7u
+#define BUS_REPLAY_STATUS_BAD_IMAGE        0xF8u
+#define BUS_REPLAY_STATUS_NO_IMAGE         0xF9u
 #define BUS_INJECT_STATUS_BAD_PAYLOAD      0xFEu
 
 /* Bus UI parameters */
 #define BUS_UI_VIEW_MAX 6u
+/* Last frame per (bus_id, opcode): frames diff against their own kind, and
+ * the bus page shows one row per slot. The least recently seen is reused. */
+#define BUS_UI_OP_SLOTS 8u
 #define BUS_UI_FLAG_ENABLE        0x01u
 #define BUS_UI_FLAG_FILTER_ID     0x02u
 #define BUS_UI_FLAG_FILTER_OPCODE 0x04u
@@ -66,6 +140,15 @@ typedef struct {
     uint32_t diff_mask;
 } bus_ui_entry_t;
 
+/* One opcode's row: fields change only when its frame bytes do. */
+typedef struct {
+    uint8_t bus_id;
+    uint8_t opcode;
+    uint8_t len;
+    uint16_t dt_ms;   /* between the last two frames that changed bytes */
+    uint32_t diff_mask;
+} bus_ui_row_t;
+
 /* UI state snapshot */
 typedef struct {
     uint8_t count;
@@ -81,21 +164,71 @@ typedef struct {
 typedef struct {
     uint8_t enabled;
     uint8_t paused;
-    uint16_t head;
     uint16_t count;
-    uint16_t capacity;
-    uint32_t seq;
+    uint16_t capacity; /* ring bytes */
+    uint16_t used;     /* ring bytes holding records */
+    uint32_t seq;      /* seq the next record gets; the oldest is seq - count */
     uint32_t last_ms;
 } bus_capture_state_t;
 
+/* Position in the capture ring. A cursor whose record was dropped, or that
+ * predates a reset, moves to the oldest record on its next use. */
+typedef struct {
+    uint32_t seq;   /* record the cursor is at */
+    uint16_t pos;   /* its ring offset */
+    uint16_t epoch; /* reset count it was placed in */
+} bus_capture_cursor_t;
+
 /* Replay state */
 typedef struct {
     uint8_t active;
+    uint8_t mode;
     uint16_t offset;
     uint16_t rate_ms;
     uint32_t next_ms;
 } bus_replay_state_t;
 
+/* Flash replay store summary */
+typedef struct {
+    uint8_t valid;
+    uint8_t uploading;
+    uint16_t records;
+    uint32_t bytes;
+    uint32_t crc32;
+    uint32_t write_offset;
+} bus_replay_store_info_t;
+
+/* Trigger recorder */
+typedef struct {
+    uint8_t flags;
+    uint8_t bus_id;
+    uint8_t opcode;
+    uint8_t byte_off;
+    uint8_t byte_mask;
+    uint8_t byte_val;
+    uint16_t pre;  /* frames kept from before the trigger */
+    uint16_t post; /* frames recorded after it; 0 = until the region is full */
+} bus_trigger_cfg_t;
+
+typedef struct {
+    uint8_t state;
+    uint16_t records;
+    uint16_t trigger_index;
+    uint16_t dropped; /* fell out of the ring before they were written */
+    uint32_t bytes;
+    uint32_t trigger_ms;
+} bus_trigger_info_t;
+
+typedef struct {
+    uint8_t state;
+    uint8_t flags;
+    uint16_t dropped; /* records lost to a full RAM queue */
+    uint32_t records;
+    uint32_t bytes;
+    uint32_t start_ms;
+    uint32_t duration_ms;
+} bus_session_info_t;
+
 /* Inject state */
 typedef struct {
     uint8_t armed;
@@ -109,21 +242,66 @@ void bus_capture_append(uint8_t bus_id, const uint8_t *data, uint8_t len, uint16
 uint8_t bus_capture_get_enabled(void);
 uint16_t bus_capture_get_count(void);
 void bus_capture_get_state(bus_capture_state_t *out);
-int bus_capture_get_record(uint16_t offset, bus_capture_record_t *out);
+/* Places the cursor at record `seq`, clamped to the records held (one past
+ * the newest is the end). Walks forward from the cursor when it is valid and
+ * not past `seq`, else from the oldest record. */
+void bus_capture_cursor_seek(bus_capture_cursor_t *c, uint32_t seq);
+/* Copies the record at the cursor (when `out` is set) and steps past it;
+ * 0 at the end. A stale cursor first jumps to the oldest record, so callers
+ * see skipped records as a jump in c->seq. */
+int bus_capture_cursor_next(bus_capture_cursor_t *c, bus_capture_record_t *out);
 
 void bus_inject_emit(uint8_t bus_id, const uint8_t *data, uint8_t len, uint16_t dt_ms, uint8_t flags);
 int bus_inject_allowed(uint8_t *flags_out);
 void bus_inject_log(uint8_t flags);
 void bus_inject_set_armed(uint8_t armed, uint8_t override_flags);
+uint8_t bus_inject_get_override(void);
 
-void bus_replay_start(uint8_t offset, uint16_t rate_ms);
+void bus_replay_reset(void);
+/* Returns 0 when mode is unknown or MODE_FLASH has no valid upload. */
+int bus_replay_start(uint8_t mode, uint16_t offset, uint16_t rate_ms);
 void bus_replay_cancel(uint8_t flags);
 void bus_replay_tick(void);
+void bus_replay_get_state(bus_replay_state_t *out);
+
+/* Bulk upload into the flash store: begin, sequential writes, finish. */
+void bus_replay_store_begin(void);
+int bus_replay_store_write(uint32_t offset, const uint8_t *data, uint32_t len);
+/* Verifies length, CRC32 and record framing, then commits the header. */
+int bus_replay_store_finish(uint32_t bytes, uint32_t crc32);
+void bus_replay_store_get_info(bus_replay_store_info_t *out);
+
+/* Arming enables capture. Re-arming starts over and overwrites the region. */
+void bus_trigger_arm(const bus_trigger_cfg_t *cfg);
+/* Stops a recording in progress, keeping what it has, or disarms. */
+void bus_trigger_stop(void);
+/* Capture ring hook: `seq` is the record's capture seq. */
+void bus_trigger_on_capture(uint32_t seq, uint8_t bus_id, const uint8_t *data, uint8_t len);
+/* The capture ring is about to be cleared: a recording ends with it. */
+void bus_trigger_on_reset(void);
+/* Main loop: moves recorded frames to flash while the job queue has room. */
+void bus_trigger_tick(void);
+void bus_trigger_get_info(bus_trigger_info_t *out);
+
+/* Starting erases the region as it goes; a session in progress is closed
+ * first. Stopping drains what is queued and writes the header. */
+void bus_session_start(void);
+void bus_session_stop(void);
+/* Producers, from any context (USART1/TIM2 interrupts, main loop). They
+ * only queue to RAM; bus_session_tick() moves records to flash. */
+void bus_session_rx(uint8_t bus_id, const uint8_t *data, uint16_t len);
+void bus_session_on_buttons(uint8_t pressed);
+void bus_session_on_adc(uint8_t input, uint16_t raw);
+void bus_session_tick(void);
+void bus_session_get_info(bus_session_info_t *out);
 
 void bus_ui_reset(void);
 void bus_ui_on_capture(uint8_t bus_id, const uint8_t *data, uint8_t len, uint16_t dt_ms);
 void bus_ui_set_control(uint8_t flags, uint8_t bus_id, uint8_t opcode);
 void bus_ui_get_state(bus_ui_state_t *out);
 int bus_ui_get_last(bus_ui_entry_t *out);
+/* Copies up to `max` opcode rows from slot `first` on; returns how many.
+ * A slot keeps its row position until it is reused. */
+uint8_t bus_ui_get_rows(uint8_t first, bus_ui_row_t *out, uint8_t max);
 
 #endif /* BUS_H */
@@ -2,38 +2,52 @@
 
 #include "app_data.h"
 #include "config/config.h"
+#include "platform/ram.h"
 #include "platform/time.h"
 #include "src/app_state.h"
 #include "storage/logs.h"
 
-static bus_capture_record_t g_bus_capture[BUS_CAPTURE_CAPACITY];
+/* Read only within the used bytes, like the RAM_EXT ring. */
+static uint8_t g_bus_capture_int[BUS_CAPTURE_RING_BYTES] RAM_NOZERO;
+/* Deeper ring when the 224 KB SRAM mode is active (chosen at reset). */
+static uint8_t g_bus_capture_ext[BUS_CAPTURE_EXT_RING_BYTES] RAM_EXT;
+static uint8_t *g_bus_capture = g_bus_capture_int;
+static uint16_t g_bus_capture_cap = BUS_CAPTURE_RING_BYTES;
 static uint16_t g_bus_capture_count;
-static uint16_t g_bus_capture_head;
+static uint16_t g_bus_capture_tail; /* ring offset of the oldest record */
+static uint16_t g_bus_capture_used;
+static uint16_t g_bus_capture_epoch;
 static uint32_t g_bus_capture_seq;
 static uint32_t g_bus_capture_last_ms;
 static uint8_t g_bus_capture_enabled;
 static uint8_t g_bus_inject_armed;
 static uint8_t g_bus_inject_override;
-static uint16_t g_bus_replay_rate_ms;
-static uint8_t g_bus_replay_active;
-static uint8_t g_bus_replay_offset;
-static uint32_t g_bus_replay_next_ms;
 
 static void bus_capture_append_internal(uint8_t bus_id, const uint8_t *data, uint8_t len,
                                         uint16_t dt_ms, uint8_t use_override);
 
 void bus_capture_reset(void)
 {
+    bus_trigger_on_reset();
+    if (platform_ram_ext_available())
+    {
+        g_bus_capture = g_bus_capture_ext;
+        g_bus_capture_cap = BUS_CAPTURE_EXT_RING_BYTES;
+    }
+    else
+    {
+        g_bus_capture = g_bus_capture_int;
+        g_bus_capture_cap = BUS_CAPTURE_RING_BYTES;
+    }
     g_bus_capture_count = 0;
-    g_bus_capture_head = 0;
+    g_bus_capture_tail = 0;
+    g_bus_capture_used = 0;
+    g_bus_capture_epoch++;
     g_bus_capture_seq = 1;
     g_bus_capture_last_ms = 0;
     g_bus_inject_armed = 0;
     g_bus_inject_override = 0;
-    g_bus_replay_active = 0;
-    g_bus_replay_offset = 0;
-    g_bus_replay_next_ms = 0;
-    g_bus_replay_rate_ms = BUS_REPLAY_RATE_MIN_MS;
+    bus_replay_reset();
     bus_ui_reset();
 }
 
@@ -65,22 +79,79 @@ void bus_capture_get_state(bus_capture_state_t *out)
         return;
     out->enabled = g_bus_capture_enabled ? 1u : 0u;
     out->paused = 0;
-    out->head = g_bus_capture_head;
     out->count = g_bus_capture_count;
-    out->capacity = BUS_CAPTURE_CAPACITY;
+    out->capacity = g_bus_capture_cap;
+    out->used = g_bus_capture_used;
     out->seq = g_bus_capture_seq;
     out->last_ms = g_bus_capture_last_ms;
 }
 
-int bus_capture_get_record(uint16_t offset, bus_capture_record_t *out)
+static uint16_t bus_capture_wrap(uint32_t pos)
 {
-    if (!out)
+    return (uint16_t)((pos >= g_bus_capture_cap) ? pos - g_bus_capture_cap : pos);
+}
+
+static uint16_t bus_capture_record_bytes(uint16_t pos)
+{
+    return (uint16_t)(BUS_CAPTURE_RECORD_HEADER_BYTES + g_bus_capture[pos]);
+}
+
+static uint8_t bus_capture_cursor_valid(const bus_capture_cursor_t *c)
+{
+    uint32_t oldest = g_bus_capture_seq - g_bus_capture_count;
+    return (uint8_t)(c->epoch == g_bus_capture_epoch && (int32_t)(c->seq - oldest) >= 0 &&
+                     (int32_t)(g_bus_capture_seq - c->seq) >= 0);
+}
+
+void bus_capture_cursor_seek(bus_capture_cursor_t *c, uint32_t seq)
+{
+    if (!c)
+        return;
+    uint32_t oldest = g_bus_capture_seq - g_bus_capture_count;
+    if ((int32_t)(seq - oldest) < 0)
+        seq = oldest;
+    if ((int32_t)(g_bus_capture_seq - seq) < 0)
+        seq = g_bus_capture_seq;
+    if (!bus_capture_cursor_valid(c) || (int32_t)(seq - c->seq) < 0)
+    {
+        c->seq = oldest;
+        c->pos = g_bus_capture_tail;
+        c->epoch = g_bus_capture_epoch;
+    }
+    while (c->seq != seq)
+    {
+        c->pos = bus_capture_wrap((uint32_t)c->pos + bus_capture_record_bytes(c->pos));
+        c->seq++;
+    }
+}
+
+int bus_capture_cursor_next(bus_capture_cursor_t *c, bus_capture_record_t *out)
+{
+    if (!c)
         return 0;
-    if (offset >= g_bus_capture_count)
+    if (!bus_capture_cursor_valid(c))
+        bus_capture_cursor_seek(c, (c->epoch == g_bus_capture_epoch) ? c->seq : 0u);
+    if (c->seq == g_bus_capture_seq)
         return 0;
-    uint16_t oldest = (g_bus_capture_count >= BUS_CAPTURE_CAPACITY) ? g_bus_capture_head : 0u;
-    uint16_t idx = (uint16_t)((oldest + offset) % BUS_CAPTURE_CAPACITY);
-    *out = g_bus_capture[idx];
+    uint16_t pos = c->pos;
+    uint8_t len = g_bus_capture[pos];
+    if (out)
+    {
+        uint16_t p1 = bus_capture_wrap((uint32_t)pos + 1u);
+        uint16_t p2 = bus_capture_wrap((uint32_t)p1 + 1u);
+        uint16_t p3 = bus_capture_wrap((uint32_t)p2 + 1u);
+        out->len = len;
+        out->bus_id = g_bus_capture[p1];
+        out->dt_ms = (uint16_t)(((uint16_t)g_bus_capture[p2] << 8) | g_bus_capture[p3]);
+        uint16_t d = bus_capture_wrap((uint32_t)p3 + 1u);
+        for (uint8_t i = 0; i < len; ++i)
+        {
+            out->data[i] = g_bus_capture[d];
+            d = bus_capture_wrap((uint32_t)d + 1u);
+        }
+    }
+    c->pos = bus_capture_wrap((uint32_t)pos + BUS_CAPTURE_RECORD_HEADER_BYTES + len);
+    c->seq++;
     return 1;
 }
 
@@ -131,58 +202,9 @@ void bus_inject_set_armed(uint8_t armed, uint8_t override_flags)
         g_bus_inject_override = BUS_INJECT_OVERRIDE_SPEED | BUS_INJECT_OVERRIDE_BRAKE;
 }
 
-void bus_replay_start(uint8_t offset, uint16_t rate_ms)
-{
-    if (rate_ms < BUS_REPLAY_RATE_MIN_MS)
-        rate_ms = BUS_REPLAY_RATE_MIN_MS;
-    if (rate_ms > BUS_REPLAY_RATE_MAX_MS)
-        rate_ms = BUS_REPLAY_RATE_MAX_MS;
-    g_bus_replay_rate_ms = rate_ms;
-    g_bus_replay_offset = offset;
-    g_bus_replay_active = 1;
-    g_bus_replay_next_ms = g_ms;
-}
-
-void bus_replay_cancel(uint8_t flags)
+uint8_t bus_inject_get_override(void)
 {
-    if (!g_bus_replay_active)
-        return;
-    g_bus_replay_active = 0;
-    g_bus_replay_offset = 0;
-    bus_inject_log((uint8_t)(flags | BUS_INJECT_EVENT_REPLAY));
-}
-
-void bus_replay_tick(void)
-{
-    if (!g_bus_replay_active)
-        return;
-    if (g_brake_edge && !g_bus_inject_override)
-    {
-        bus_replay_cancel(BUS_INJECT_EVENT_BLOCKED_BRAKE);
-        return;
-    }
-    if (!g_bus_inject_override && g_inputs.speed_dmph > (int16_t)BUS_INJECT_SPEED_MAX_DMPH)
-    {
-        bus_replay_cancel(BUS_INJECT_EVENT_BLOCKED_MOVING);
-        return;
-    }
-    if ((int32_t)(g_ms - g_bus_replay_next_ms) >= 0)
-    {
-        if (g_bus_replay_offset >= g_bus_capture_count)
-        {
-            bus_replay_cancel(BUS_INJECT_EVENT_OK);
-            return;
-        }
-        uint16_t oldest = (g_bus_capture_count >= BUS_CAPTURE_CAPACITY) ? g_bus_capture_head : 0u;
-        uint16_t idx = (uint16_t)((oldest + g_bus_replay_offset) % BUS_CAPTURE_CAPACITY);
-        const bus_capture_record_t *r = &g_bus_capture[idx];
-        uint8_t flags = BUS_INJECT_EVENT_OK | BUS_INJECT_EVENT_REPLAY;
-        if (g_bus_inject_override)
-            flags |= BUS_INJECT_EVENT_OVERRIDE;
-        bus_inject_emit(r->bus_id, r->data, r->len, g_bus_replay_rate_ms, flags);
-        g_bus_replay_offset++;
-        g_bus_replay_next_ms = g_ms + g_bus_replay_rate_ms;
-    }
+    return g_bus_inject_override;
 }
 
 static void bus_capture_append_internal(uint8_t bus_id, const uint8_t *data, uint8_t len,
@@ -213,17 +235,30 @@ static void bus_capture_append_internal(uint8_t bus_id, const uint8_t *data, uin
         g_bus_capture_last_ms = g_ms;
     }
 
-    bus_capture_record_t *r = &g_bus_capture[g_bus_capture_head];
-    r->dt_ms = dt_ms;
-    r->bus_id = bus_id;
-    r->len = len;
+    uint16_t need = (uint16_t)(BUS_CAPTURE_RECORD_HEADER_BYTES + len);
+    while ((uint16_t)(g_bus_capture_cap - g_bus_capture_used) < need)
+    {
+        uint16_t n = bus_capture_record_bytes(g_bus_capture_tail);
+        g_bus_capture_tail = bus_capture_wrap((uint32_t)g_bus_capture_tail + n);
+        g_bus_capture_used = (uint16_t)(g_bus_capture_used - n);
+        g_bus_capture_count--;
+    }
+    uint16_t pos = bus_capture_wrap((uint32_t)g_bus_capture_tail + g_bus_capture_used);
+    uint8_t hdr[BUS_CAPTURE_RECORD_HEADER_BYTES] = {len, bus_id, (uint8_t)(dt_ms >> 8), (uint8_t)dt_ms};
+    for (uint8_t i = 0; i < BUS_CAPTURE_RECORD_HEADER_BYTES; ++i)
+    {
+        g_bus_capture[pos] = hdr[i];
+        pos = bus_capture_wrap((uint32_t)pos + 1u);
+    }
     for (uint8_t i = 0; i < len; ++i)
-        r->data[i] = data[i];
-
-    g_bus_capture_head = (uint16_t)((g_bus_capture_head + 1u) % BUS_CAPTURE_CAPACITY);
-    if (g_bus_capture_count < BUS_CAPTURE_CAPACITY)
-        g_bus_capture_count++;
+    {
+        g_bus_capture[pos] = data[i];
+        pos = bus_capture_wrap((uint32_t)pos + 1u);
+    }
+    g_bus_capture_used = (uint16_t)(g_bus_capture_used + need);
+    g_bus_capture_count++;
     g_bus_capture_seq++;
 
     bus_ui_on_capture(bus_id, data, len, dt_ms);
+    bus_trigger_on_capture(g_bus_capture_seq - 1u, bus_id, data, len);
 }
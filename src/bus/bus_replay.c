@@ -0,0 +1,314 @@
+#include "bus.h"
+
+#include "app_data.h"
+#include "drivers/spi_flash.h"
+#include "platform/time.h"
+#include "src/app_state.h"
+#include "storage/flash_util.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+#define BUS_REPLAY_DATA_BASE (BUS_REPLAY_STORAGE_BASE + BUS_REPLAY_STORE_HEADER_BYTES)
+#define BUS_REPLAY_DATA_MAX (BUS_REPLAY_STORAGE_BYTES - BUS_REPLAY_STORE_HEADER_BYTES)
+
+static struct {
+    uint8_t active;
+    uint8_t mode;
+    uint8_t have_pending;
+    uint8_t started;
+    uint16_t offset;      /* records emitted (or skipped) so far */
+    uint16_t rate_ms;     /* fixed-mode period */
+    uint16_t max_gap_ms;  /* timed-mode gap clamp */
+    uint32_t next_ms;
+    bus_capture_cursor_t ram; /* next RAM record */
+    uint32_t ram_end_seq; /* capture seq at start; replayed frames are not replayed again */
+    uint32_t flash_pos;   /* data-relative byte offset of the next flash record */
+    bus_capture_record_t pending;
+} g_bus_replay;
+
+static struct {
+    uint8_t loaded;
+    uint8_t valid;
+    uint8_t uploading;
+    uint16_t records;
+    uint32_t bytes;
+    uint32_t crc32;
+    flash_upload_t upload;
+} g_bus_replay_store;
+
+static void bus_replay_store_load(void)
+{
+    if (g_bus_replay_store.loaded)
+        return;
+    g_bus_replay_store.loaded = 1u;
+    g_bus_replay_store.valid = 0u;
+
+    uint8_t hdr[BUS_REPLAY_STORE_HEADER_BYTES];
+    spi_flash_read(BUS_REPLAY_STORAGE_BASE, hdr, sizeof(hdr));
+    uint32_t magic = load_be32(&hdr[0]);
+    uint16_t version = load_be16(&hdr[4]);
+    uint16_t records = load_be16(&hdr[6]);
+    uint32_t bytes = load_be32(&hdr[8]);
+    if (magic != BUS_REPLAY_STORE_MAGIC || version != BUS_REPLAY_STORE_VERSION)
+        return;
+    if (bytes == 0u || bytes > BUS_REPLAY_DATA_MAX)
+        return;
+    g_bus_replay_store.valid = 1u;
+    g_bus_replay_store.records = records;
+    g_bus_replay_store.bytes = bytes;
+    g_bus_replay_store.crc32 = load_be32(&hdr[12]);
+}
+
+/* Reads the record at data offset `pos`; returns its encoded size or 0. */
+static uint32_t bus_replay_flash_read(uint32_t pos, bus_capture_record_t *out)
+{
+    uint32_t bytes = g_bus_replay_store.bytes;
+    if (pos + BUS_REPLAY_RECORD_HEADER_BYTES > bytes)
+        return 0u;
+    uint8_t buf[BUS_REPLAY_RECORD_HEADER_BYTES + BUS_CAPTURE_MAX_DATA];
+    uint32_t n = bytes - pos;
+    if (n > sizeof(buf))
+        n = sizeof(buf);
+    /* One read covers the header and the largest payload. */
+    spi_flash_read(BUS_REPLAY_DATA_BASE + pos, buf, n);
+    uint8_t len = buf[1];
+    if (len > BUS_CAPTURE_MAX_DATA || BUS_REPLAY_RECORD_HEADER_BYTES + (uint32_t)len > n)
+        return 0u;
+    if (out)
+    {
+        out->bus_id = buf[0];
+        out->len = len;
+        out->dt_ms = load_be16(&buf[2]);
+        for (uint8_t i = 0; i < len; ++i)
+            out->data[i] = buf[BUS_REPLAY_RECORD_HEADER_BYTES + i];
+    }
+    return BUS_REPLAY_RECORD_HEADER_BYTES + (uint32_t)len;
+}
+
+static int bus_replay_fetch(bus_capture_record_t *out)
+{
+    if (g_bus_replay.mode == BUS_REPLAY_MODE_FLASH)
+    {
+        uint32_t n = bus_replay_flash_read(g_bus_replay.flash_pos, out);
+        if (!n)
+            return 0;
+        g_bus_replay.flash_pos += n;
+        return 1;
+    }
+
+    uint32_t want = g_bus_replay.ram.seq;
+    if ((int32_t)(g_bus_replay.ram_end_seq - want) <= 0)
+        return 0;
+    /* A jump means the record was overwritten. */
+    return bus_capture_cursor_next(&g_bus_replay.ram, out) && g_bus_replay.ram.seq == want + 1u;
+}
+
+void bus_replay_reset(void)
+{
+    g_bus_replay.active = 0u;
+    g_bus_replay.have_pending = 0u;
+    g_bus_replay.offset = 0u;
+    g_bus_replay.next_ms = 0u;
+    g_bus_replay.mode = BUS_REPLAY_MODE_FIXED;
+    g_bus_replay.rate_ms = BUS_REPLAY_RATE_MIN_MS;
+}
+
+int bus_replay_start(uint8_t mode, uint16_t offset, uint16_t rate_ms)
+{
+    if (mode != BUS_REPLAY_MODE_FIXED && mode != BUS_REPLAY_MODE_TIMED && mode != BUS_REPLAY_MODE_FLASH)
+        return 0;
+
+    if (mode == BUS_REPLAY_MODE_FLASH)
+    {
+        bus_replay_store_load();
+        if (!g_bus_replay_store.valid || g_bus_replay_store.uploading)
+            return 0;
+        uint32_t pos = 0u;
+        for (uint16_t i = 0; i < offset; ++i)
+        {
+            uint32_t n = bus_replay_flash_read(pos, 0);
+            if (!n)
+                break;
+            pos += n;
+        }
+        g_bus_replay.flash_pos = pos;
+    }
+    else
+    {
+        bus_capture_state_t cap;
+        bus_capture_get_state(&cap);
+        g_bus_replay.ram_end_seq = cap.seq;
+        bus_capture_cursor_seek(&g_bus_replay.ram, cap.seq - cap.count + offset);
+    }
+
+    if (mode == BUS_REPLAY_MODE_FIXED)
+    {
+        if (rate_ms < BUS_REPLAY_RATE_MIN_MS)
+            rate_ms = BUS_REPLAY_RATE_MIN_MS;
+        if (rate_ms > BUS_REPLAY_RATE_MAX_MS)
+            rate_ms = BUS_REPLAY_RATE_MAX_MS;
+        g_bus_replay.rate_ms = rate_ms;
+    }
+    g_bus_replay.max_gap_ms = rate_ms ? rate_ms : BUS_REPLAY_GAP_DEFAULT_MS;
+    g_bus_replay.mode = mode;
+    g_bus_replay.offset = offset;
+    g_bus_replay.have_pending = 0u;
+    g_bus_replay.started = 0u;
+    g_bus_replay.active = 1u;
+    g_bus_replay.next_ms = g_ms;
+    return 1;
+}
+
+void bus_replay_cancel(uint8_t flags)
+{
+    if (!g_bus_replay.active)
+        return;
+    g_bus_replay.active = 0u;
+    g_bus_replay.have_pending = 0u;
+    g_bus_replay.offset = 0u;
+    bus_inject_log((uint8_t)(flags | BUS_INJECT_EVENT_REPLAY));
+}
+
+void bus_replay_tick(void)
+{
+    if (!g_bus_replay.active)
+        return;
+    uint8_t override = bus_inject_get_override();
+    if (g_brake_edge && !override)
+    {
+        bus_replay_cancel(BUS_INJECT_EVENT_BLOCKED_BRAKE);
+        return;
+    }
+    if (!override && g_inputs.speed_dmph > (int16_t)BUS_INJECT_SPEED_MAX_DMPH)
+    {
+        bus_replay_cancel(BUS_INJECT_EVENT_BLOCKED_MOVING);
+        return;
+    }
+
+    uint8_t flags = BUS_INJECT_EVENT_OK | BUS_INJECT_EVENT_REPLAY;
+    if (override)
+        flags |= BUS_INJECT_EVENT_OVERRIDE;
+
+    for (uint8_t burst = 0; burst < BUS_REPLAY_BURST_MAX; ++burst)
+    {
+        bus_capture_record_t *r = &g_bus_replay.pending;
+        uint16_t dt_ms = g_bus_replay.rate_ms;
+        if (!g_bus_replay.have_pending)
+        {
+            if (!bus_replay_fetch(r))
+            {
+                bus_replay_cancel(BUS_INJECT_EVENT_OK);
+                return;
+            }
+            g_bus_replay.have_pending = 1u;
+            if (g_bus_replay.mode != BUS_REPLAY_MODE_FIXED)
+            {
+                /* Schedule from the previous due time, not from when the tick ran,
+                 * so loop jitter does not accumulate across a long capture. */
+                dt_ms = (r->dt_ms > g_bus_replay.max_gap_ms) ? g_bus_replay.max_gap_ms : r->dt_ms;
+                if (g_bus_replay.started)
+                    g_bus_replay.next_ms += dt_ms;
+                r->dt_ms = dt_ms;
+            }
+        }
+        if ((int32_t)(g_ms - g_bus_replay.next_ms) < 0)
+            return;
+
+        if (g_bus_replay.mode != BUS_REPLAY_MODE_FIXED)
+            dt_ms = g_bus_replay.started ? r->dt_ms : 0u;
+        bus_inject_emit(r->bus_id, r->data, r->len, dt_ms, flags);
+        g_bus_replay.have_pending = 0u;
+        g_bus_replay.started = 1u;
+        g_bus_replay.offset++;
+
+        if (g_bus_replay.mode == BUS_REPLAY_MODE_FIXED)
+        {
+            g_bus_replay.next_ms = g_ms + g_bus_replay.rate_ms;
+            return;
+        }
+        /* Fell more than one gap behind (e.g. a blocking flash erase): resync. */
+        if ((uint32_t)(g_ms - g_bus_replay.next_ms) > g_bus_replay.max_gap_ms)
+            g_bus_replay.next_ms = g_ms;
+    }
+}
+
+void bus_replay_get_state(bus_replay_state_t *out)
+{
+    if (!out)
+        return;
+    out->active = g_bus_replay.active;
+    out->mode = g_bus_replay.mode;
+    out->offset = g_bus_replay.offset;
+    out->rate_ms = (g_bus_replay.mode == BUS_REPLAY_MODE_FIXED) ? g_bus_replay.rate_ms : g_bus_replay.max_gap_ms;
+    out->next_ms = g_bus_replay.next_ms;
+}
+
+void bus_replay_store_begin(void)
+{
+    if (g_bus_replay.active && g_bus_replay.mode == BUS_REPLAY_MODE_FLASH)
+        bus_replay_cancel(BUS_INJECT_EVENT_BLOCKED_CAPTURE);
+    flash_upload_begin(&g_bus_replay_store.upload, BUS_REPLAY_STORAGE_BASE, BUS_REPLAY_DATA_BASE,
+                       BUS_REPLAY_DATA_MAX);
+    g_bus_replay_store.loaded = 1u;
+    g_bus_replay_store.valid = 0u;
+    g_bus_replay_store.uploading = 1u;
+    g_bus_replay_store.records = 0u;
+    g_bus_replay_store.bytes = 0u;
+    g_bus_replay_store.crc32 = 0u;
+}
+
+int bus_replay_store_write(uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    if (!g_bus_replay_store.uploading)
+        return 0;
+    return flash_upload_write(&g_bus_replay_store.upload, offset, data, len);
+}
+
+int bus_replay_store_finish(uint32_t bytes, uint32_t crc32)
+{
+    if (!g_bus_replay_store.uploading)
+        return 0;
+    g_bus_replay_store.uploading = 0u;
+    if (!flash_upload_verify(&g_bus_replay_store.upload, bytes, crc32))
+        return 0;
+
+    /* Records must tile the upload exactly. */
+    g_bus_replay_store.bytes = bytes;
+    uint32_t pos = 0u;
+    uint32_t records = 0u;
+    while (pos < bytes)
+    {
+        uint32_t n = bus_replay_flash_read(pos, 0);
+        if (!n || records == 0xFFFFu)
+            return 0;
+        pos += n;
+        records++;
+    }
+
+    uint8_t hdr[BUS_REPLAY_STORE_HEADER_BYTES];
+    store_be32(&hdr[0], BUS_REPLAY_STORE_MAGIC);
+    store_be16(&hdr[4], BUS_REPLAY_STORE_VERSION);
+    store_be16(&hdr[6], (uint16_t)records);
+    store_be32(&hdr[8], bytes);
+    store_be32(&hdr[12], crc32);
+    spi_flash_write(BUS_REPLAY_STORAGE_BASE, hdr, sizeof(hdr));
+
+    g_bus_replay_store.valid = 1u;
+    g_bus_replay_store.records = (uint16_t)records;
+    g_bus_replay_store.crc32 = crc32;
+    return 1;
+}
+
+void bus_replay_store_get_info(bus_replay_store_info_t *out)
+{
+    if (!out)
+        return;
+    bus_replay_store_load();
+    out->valid = g_bus_replay_store.valid;
+    out->uploading = g_bus_replay_store.uploading;
+    out->records = g_bus_replay_store.valid ? g_bus_replay_store.records : 0u;
+    out->bytes = g_bus_replay_store.valid ? g_bus_replay_store.bytes : 0u;
+    out->crc32 = g_bus_replay_store.valid ? g_bus_replay_store.crc32 : 0u;
+    out->write_offset = g_bus_replay_store.upload.write_offset;
+}
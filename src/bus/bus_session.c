@@ -0,0 +1,267 @@
+#include "bus.h"
+
+#include "platform/ram.h"
+#include "platform/time.h"
+#include "storage/flash_jobs.h"
+#include "storage/layout.h"
+#include "storage/page_writer.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+#ifndef HOST_TEST
+#include "platform/cpu.h"
+#else
+static uint32_t irq_save(void) { return 0u; }
+static void irq_restore(uint32_t primask) { (void)primask; }
+#endif
+
+#define BUS_SESSION_DATA_BASE (BUS_SESSION_STORAGE_BASE + BUS_SESSION_HEADER_BYTES)
+#define BUS_SESSION_DATA_MAX (BUS_SESSION_STORAGE_BYTES - BUS_SESSION_HEADER_BYTES)
+/* RAM queue between the producers and the flash writer (power of two). */
+#define BUS_SESSION_SLOTS 32u
+/* Job queue slots left to everything else that writes flash. */
+#define BUS_SESSION_QUEUE_SPARE 4u
+/* Records moved per tick at most. */
+#define BUS_SESSION_TICK_MAX 16u
+
+typedef struct {
+    uint8_t bus_id;
+    uint8_t len;
+    uint32_t ms;
+    uint8_t data[BUS_CAPTURE_MAX_DATA];
+} bus_session_slot_t;
+
+/*
+ * Producers fill slots under a short IRQ mask; the newest slot stays open
+ * for the next RX bytes of its bus for BUS_SESSION_BURST_MS. The main loop
+ * packs closed slots into whole flash pages through a page_writer, as the
+ * trigger recorder does. The header goes in last, so an interrupted session
+ * reads as absent.
+ */
+static struct {
+    uint8_t state;
+    uint8_t flags;
+    volatile uint8_t head;    /* slots claimed */
+    volatile uint8_t tail;    /* slots written out */
+    uint8_t buttons;          /* last pressed mask recorded */
+    uint8_t buttons_valid;
+    uint16_t dropped;
+    uint16_t adc_raw[BUS_SESSION_ADC_INPUTS];
+    uint32_t adc_ms[BUS_SESSION_ADC_INPUTS];
+    uint8_t adc_valid[BUS_SESSION_ADC_INPUTS];
+    uint32_t records;
+    uint32_t start_ms;
+    uint32_t last_ms;         /* stamp of the last record written */
+    page_writer_t writer;
+    crc32_stream_t crc;
+    bus_session_slot_t slot[BUS_SESSION_SLOTS];
+} g_bus_session;
+
+/* Erased to 0xFF by page_writer before anything is written. */
+static uint8_t g_bus_session_page[2][SPI_FLASH_PAGE_SIZE] RAM_NOZERO;
+
+static void bus_session_put(const uint8_t *data, uint32_t n)
+{
+    crc32_stream_feed(&g_bus_session.crc, data, n);
+    page_writer_put(&g_bus_session.writer, data, n);
+}
+
+static void bus_session_finish(void)
+{
+    page_writer_commit(&g_bus_session.writer);
+    page_writer_erase_through(&g_bus_session.writer, BUS_SESSION_STORAGE_BASE);
+    uint8_t hdr[BUS_SESSION_HEADER_BYTES];
+    store_be32(&hdr[0], BUS_SESSION_MAGIC);
+    store_be16(&hdr[4], BUS_SESSION_VERSION);
+    store_be16(&hdr[6], g_bus_session.flags);
+    store_be32(&hdr[8], g_bus_session.writer.bytes);
+    store_be32(&hdr[12], crc32_stream_end(&g_bus_session.crc));
+    store_be32(&hdr[16], g_bus_session.records);
+    store_be32(&hdr[20], g_bus_session.start_ms);
+    store_be32(&hdr[24], g_bus_session.last_ms - g_bus_session.start_ms);
+    store_be16(&hdr[28], g_bus_session.dropped);
+    hdr[30] = 0xFFu;
+    hdr[31] = 0xFFu;
+    flash_jobs_program(BUS_SESSION_STORAGE_BASE, hdr, sizeof(hdr));
+    g_bus_session.state = BUS_SESSION_DONE;
+}
+
+/* Takes the tail slot once it is closed (or any slot when draining).
+ * Returns 0 when there is nothing to take. */
+static int bus_session_take(bus_session_slot_t *out, uint8_t drain)
+{
+    uint32_t primask = irq_save();
+    uint8_t tail = g_bus_session.tail;
+    uint8_t queued = (uint8_t)(g_bus_session.head - tail);
+    const bus_session_slot_t *s = &g_bus_session.slot[tail & (BUS_SESSION_SLOTS - 1u)];
+    if (queued == 0u ||
+        (!drain && queued == 1u && s->len < BUS_CAPTURE_MAX_DATA &&
+         (uint32_t)(g_ms - s->ms) <= BUS_SESSION_BURST_MS))
+    {
+        irq_restore(primask);
+        return 0;
+    }
+    *out = *s;
+    g_bus_session.tail = (uint8_t)(tail + 1u);
+    irq_restore(primask);
+    return 1;
+}
+
+/* Writes up to max slots; finishes the session when the region fills. */
+static void bus_session_write(uint8_t max, uint8_t drain)
+{
+    for (uint8_t n = 0; n < max && g_bus_session.state == BUS_SESSION_RECORDING; ++n)
+    {
+        if (!drain && flash_jobs_pending() + BUS_SESSION_QUEUE_SPARE >= FLASH_JOBS_DEPTH)
+            return;
+        bus_session_slot_t s;
+        if (!bus_session_take(&s, drain))
+            return;
+        if (g_bus_session.writer.bytes + BUS_REPLAY_RECORD_HEADER_BYTES + s.len > BUS_SESSION_DATA_MAX)
+        {
+            g_bus_session.flags |= BUS_SESSION_F_FULL;
+            bus_session_finish();
+            return;
+        }
+        uint32_t dt = g_bus_session.records ? s.ms - g_bus_session.last_ms : 0u;
+        uint8_t rec[BUS_REPLAY_RECORD_HEADER_BYTES];
+        rec[0] = s.bus_id;
+        rec[1] = s.len;
+        store_be16(&rec[2], (uint16_t)((dt > 0xFFFFu) ? 0xFFFFu : dt));
+        bus_session_put(rec, sizeof(rec));
+        bus_session_put(s.data, s.len);
+        g_bus_session.records++;
+        g_bus_session.last_ms = s.ms;
+    }
+}
+
+/* Queues bytes for bus_id; RX bytes join the open slot of their bus. */
+static void bus_session_queue(uint8_t bus_id, const uint8_t *data, uint16_t len, uint8_t join)
+{
+    while (len)
+    {
+        uint32_t primask = irq_save();
+        if (g_bus_session.state != BUS_SESSION_RECORDING)
+        {
+            irq_restore(primask);
+            return;
+        }
+        uint32_t now = g_ms;
+        uint8_t head = g_bus_session.head;
+        uint8_t queued = (uint8_t)(head - g_bus_session.tail);
+        bus_session_slot_t *s = &g_bus_session.slot[(uint8_t)(head - 1u) & (BUS_SESSION_SLOTS - 1u)];
+        if (!join || queued == 0u || s->bus_id != bus_id || s->len == BUS_CAPTURE_MAX_DATA ||
+            (uint32_t)(now - s->ms) > BUS_SESSION_BURST_MS)
+        {
+            if (queued == BUS_SESSION_SLOTS)
+            {
+                if (g_bus_session.dropped != 0xFFFFu)
+                    g_bus_session.dropped++;
+                irq_restore(primask);
+                return;
+            }
+            s = &g_bus_session.slot[head & (BUS_SESSION_SLOTS - 1u)];
+            s->bus_id = bus_id;
+            s->len = 0u;
+            g_bus_session.head = (uint8_t)(head + 1u);
+        }
+        uint16_t take = (uint16_t)(BUS_CAPTURE_MAX_DATA - s->len);
+        if (take > len)
+            take = len;
+        for (uint16_t i = 0; i < take; ++i)
+            s->data[s->len + i] = data[i];
+        s->len = (uint8_t)(s->len + take);
+        s->ms = now;
+        irq_restore(primask);
+        data += take;
+        len = (uint16_t)(len - take);
+    }
+}
+
+void bus_session_start(void)
+{
+    if (g_bus_session.state == BUS_SESSION_RECORDING)
+        bus_session_stop();
+    uint32_t primask = irq_save();
+    g_bus_session.head = g_bus_session.tail = 0u;
+    g_bus_session.flags = 0u;
+    g_bus_session.dropped = 0u;
+    g_bus_session.buttons_valid = 0u;
+    for (uint8_t i = 0; i < BUS_SESSION_ADC_INPUTS; ++i)
+        g_bus_session.adc_valid[i] = 0u;
+    g_bus_session.records = 0u;
+    g_bus_session.start_ms = g_bus_session.last_ms = g_ms;
+    crc32_stream_begin(&g_bus_session.crc);
+    /* Sector 0 holds the old header: erase it before the first page. */
+    page_writer_begin(&g_bus_session.writer, g_bus_session_page, BUS_SESSION_DATA_BASE,
+                      BUS_SESSION_STORAGE_BASE);
+    g_bus_session.state = BUS_SESSION_RECORDING;
+    irq_restore(primask);
+}
+
+void bus_session_stop(void)
+{
+    if (g_bus_session.state != BUS_SESSION_RECORDING)
+        return;
+    bus_session_write(BUS_SESSION_SLOTS, 1u);
+    if (g_bus_session.state == BUS_SESSION_RECORDING)
+        bus_session_finish();
+}
+
+void bus_session_rx(uint8_t bus_id, const uint8_t *data, uint16_t len)
+{
+    if (g_bus_session.state != BUS_SESSION_RECORDING || !data)
+        return;
+    bus_session_queue(bus_id, data, len, 1u);
+}
+
+void bus_session_on_buttons(uint8_t pressed)
+{
+    if (g_bus_session.state != BUS_SESSION_RECORDING ||
+        (g_bus_session.buttons_valid && pressed == g_bus_session.buttons))
+        return;
+    g_bus_session.buttons = pressed;
+    g_bus_session.buttons_valid = 1u;
+    bus_session_queue(BUS_SESSION_BUTTONS, &pressed, 1u, 0u);
+}
+
+void bus_session_on_adc(uint8_t input, uint16_t raw)
+{
+    if (g_bus_session.state != BUS_SESSION_RECORDING || input >= BUS_SESSION_ADC_INPUTS)
+        return;
+    if (g_bus_session.adc_valid[input])
+    {
+        uint16_t last = g_bus_session.adc_raw[input];
+        uint16_t delta = (uint16_t)((raw > last) ? raw - last : last - raw);
+        if (delta < BUS_SESSION_ADC_DELTA &&
+            (uint32_t)(g_ms - g_bus_session.adc_ms[input]) < BUS_SESSION_ADC_PERIOD_MS)
+            return;
+    }
+    g_bus_session.adc_raw[input] = raw;
+    g_bus_session.adc_ms[input] = g_ms;
+    g_bus_session.adc_valid[input] = 1u;
+    uint8_t rec[3];
+    rec[0] = input;
+    store_be16(&rec[1], raw);
+    bus_session_queue(BUS_SESSION_ADC, rec, sizeof(rec), 0u);
+}
+
+void bus_session_tick(void)
+{
+    if (g_bus_session.state == BUS_SESSION_RECORDING)
+        bus_session_write(BUS_SESSION_TICK_MAX, 0u);
+}
+
+void bus_session_get_info(bus_session_info_t *out)
+{
+    if (!out)
+        return;
+    out->state = g_bus_session.state;
+    out->flags = g_bus_session.flags;
+    out->dropped = g_bus_session.dropped;
+    out->records = g_bus_session.records;
+    out->bytes = g_bus_session.writer.bytes;
+    out->start_ms = g_bus_session.start_ms;
+    out->duration_ms = ((g_bus_session.state == BUS_SESSION_RECORDING) ? g_ms : g_bus_session.last_ms) -
+                       g_bus_session.start_ms;
+}
@@ -0,0 +1,183 @@
+#include "bus.h"
+
+#include "app_data.h"
+#include "platform/ram.h"
+#include "platform/time.h"
+#include "storage/flash_jobs.h"
+#include "storage/layout.h"
+#include "storage/page_writer.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+#define BUS_TRIGGER_DATA_BASE (BUS_TRIGGER_STORAGE_BASE + BUS_TRIGGER_HEADER_BYTES)
+#define BUS_TRIGGER_DATA_MAX (BUS_TRIGGER_STORAGE_BYTES - BUS_TRIGGER_HEADER_BYTES)
+/* Job queue slots left to everything else that writes flash. */
+#define BUS_TRIGGER_QUEUE_SPARE 4u
+/* Records moved per tick at most. */
+#define BUS_TRIGGER_TICK_MAX 16u
+
+/*
+ * Recorded frames wait in the capture ring and are packed into whole flash
+ * pages by a page_writer (storage/page_writer.h), which erases sectors just
+ * ahead of the page that needs them. The header goes in last, so an
+ * interrupted recording reads as absent.
+ */
+static struct {
+    bus_trigger_cfg_t cfg;
+    uint8_t state;
+    uint16_t records;
+    uint16_t trigger_index;
+    uint16_t dropped;
+    bus_capture_cursor_t next; /* next capture record to write */
+    uint32_t end_seq;         /* first seq past the post window */
+    page_writer_t writer;
+    uint32_t trigger_ms;
+    crc32_stream_t crc;
+} g_bus_trigger;
+
+/* Erased to 0xFF by page_writer before anything is written. */
+static uint8_t g_bus_trigger_page[2][SPI_FLASH_PAGE_SIZE] RAM_NOZERO;
+
+static uint8_t bus_trigger_match(const bus_trigger_cfg_t *c, uint8_t bus_id, const uint8_t *data, uint8_t len)
+{
+    if ((c->flags & BUS_TRIGGER_F_BUS_ID) && bus_id != c->bus_id)
+        return 0;
+    if ((c->flags & BUS_TRIGGER_F_OPCODE) && (len == 0u || data[0] != c->opcode))
+        return 0;
+    if ((c->flags & BUS_TRIGGER_F_BYTE) &&
+        (len <= c->byte_off || (data[c->byte_off] & c->byte_mask) != c->byte_val))
+        return 0;
+    return 1;
+}
+
+static void bus_trigger_put(const uint8_t *data, uint32_t n)
+{
+    crc32_stream_feed(&g_bus_trigger.crc, data, n);
+    page_writer_put(&g_bus_trigger.writer, data, n);
+}
+
+static void bus_trigger_finish(void)
+{
+    page_writer_commit(&g_bus_trigger.writer);
+    page_writer_erase_through(&g_bus_trigger.writer, BUS_TRIGGER_STORAGE_BASE);
+    uint8_t hdr[BUS_TRIGGER_HEADER_BYTES];
+    store_be32(&hdr[0], BUS_TRIGGER_MAGIC);
+    store_be16(&hdr[4], BUS_TRIGGER_VERSION);
+    store_be16(&hdr[6], g_bus_trigger.records);
+    store_be32(&hdr[8], g_bus_trigger.writer.bytes);
+    store_be32(&hdr[12], crc32_stream_end(&g_bus_trigger.crc));
+    store_be16(&hdr[16], g_bus_trigger.trigger_index);
+    store_be16(&hdr[18], g_bus_trigger.dropped);
+    store_be32(&hdr[20], g_bus_trigger.trigger_ms);
+    hdr[24] = g_bus_trigger.cfg.flags;
+    hdr[25] = g_bus_trigger.cfg.bus_id;
+    hdr[26] = g_bus_trigger.cfg.opcode;
+    for (uint8_t i = 27u; i < BUS_TRIGGER_HEADER_BYTES; ++i)
+        hdr[i] = 0xFFu;
+    flash_jobs_program(BUS_TRIGGER_STORAGE_BASE, hdr, sizeof(hdr));
+    g_bus_trigger.state = BUS_TRIGGER_DONE;
+}
+
+void bus_trigger_arm(const bus_trigger_cfg_t *cfg)
+{
+    if (!cfg)
+        return;
+    if (g_bus_trigger.state == BUS_TRIGGER_RECORDING)
+        bus_trigger_finish();
+    g_bus_trigger.cfg = *cfg;
+    g_bus_trigger.state = BUS_TRIGGER_ARMED;
+    if (!bus_capture_get_enabled())
+        bus_capture_set_enabled(1u, 0u);
+}
+
+void bus_trigger_stop(void)
+{
+    if (g_bus_trigger.state == BUS_TRIGGER_RECORDING)
+    {
+        bus_trigger_tick();
+        if (g_bus_trigger.state == BUS_TRIGGER_RECORDING)
+            bus_trigger_finish();
+    }
+    else if (g_bus_trigger.state == BUS_TRIGGER_ARMED)
+        g_bus_trigger.state = BUS_TRIGGER_IDLE;
+}
+
+void bus_trigger_on_capture(uint32_t seq, uint8_t bus_id, const uint8_t *data, uint8_t len)
+{
+    if (g_bus_trigger.state != BUS_TRIGGER_ARMED || !bus_trigger_match(&g_bus_trigger.cfg, bus_id, data, len))
+        return;
+    /* The seek stops at the oldest record still held. */
+    bus_capture_cursor_seek(&g_bus_trigger.next, seq - g_bus_trigger.cfg.pre);
+
+    g_bus_trigger.state = BUS_TRIGGER_RECORDING;
+    g_bus_trigger.end_seq = g_bus_trigger.cfg.post ? seq + 1u + g_bus_trigger.cfg.post : 0xFFFFFFFFu;
+    g_bus_trigger.trigger_index = (uint16_t)(seq - g_bus_trigger.next.seq);
+    g_bus_trigger.trigger_ms = g_ms;
+    g_bus_trigger.records = 0u;
+    g_bus_trigger.dropped = 0u;
+    crc32_stream_begin(&g_bus_trigger.crc);
+    /* Sector 0 holds the old header: erase it before the first page. */
+    page_writer_begin(&g_bus_trigger.writer, g_bus_trigger_page, BUS_TRIGGER_DATA_BASE,
+                      BUS_TRIGGER_STORAGE_BASE);
+}
+
+void bus_trigger_on_reset(void)
+{
+    if (g_bus_trigger.state == BUS_TRIGGER_RECORDING)
+        bus_trigger_stop();
+}
+
+void bus_trigger_tick(void)
+{
+    if (g_bus_trigger.state != BUS_TRIGGER_RECORDING)
+        return;
+    bus_capture_cursor_t *c = &g_bus_trigger.next;
+    for (uint8_t n = 0; n < BUS_TRIGGER_TICK_MAX; ++n)
+    {
+        if (c->seq >= g_bus_trigger.end_seq)
+            break;
+        if (flash_jobs_pending() + BUS_TRIGGER_QUEUE_SPARE >= FLASH_JOBS_DEPTH)
+            return;
+        uint32_t want = c->seq;
+        bus_capture_record_t r;
+        int got = bus_capture_cursor_next(c, &r);
+        uint32_t lost = (got ? c->seq - 1u : c->seq) - want;
+        if (lost)
+        {
+            /* The writer fell a whole ring behind. */
+            g_bus_trigger.dropped = (uint16_t)((g_bus_trigger.dropped + lost > 0xFFFFu) ? 0xFFFFu
+                                                                                     : g_bus_trigger.dropped + lost);
+        }
+        if (!got)
+            break;
+        if (c->seq > g_bus_trigger.end_seq)
+            break;
+        if (g_bus_trigger.writer.bytes + BUS_REPLAY_RECORD_HEADER_BYTES + r.len > BUS_TRIGGER_DATA_MAX ||
+            g_bus_trigger.records == 0xFFFFu)
+        {
+            bus_trigger_finish();
+            return;
+        }
+        uint8_t rec[BUS_REPLAY_RECORD_HEADER_BYTES];
+        rec[0] = r.bus_id;
+        rec[1] = r.len;
+        store_be16(&rec[2], g_bus_trigger.records ? r.dt_ms : 0u);
+        bus_trigger_put(rec, sizeof(rec));
+        bus_trigger_put(r.data, r.len);
+        g_bus_trigger.records++;
+    }
+    if (c->seq >= g_bus_trigger.end_seq)
+        bus_trigger_finish();
+}
+
+void bus_trigger_get_info(bus_trigger_info_t *out)
+{
+    if (!out)
+        return;
+    out->state = g_bus_trigger.state;
+    out->records = g_bus_trigger.records;
+    out->trigger_index = g_bus_trigger.trigger_index;
+    out->dropped = g_bus_trigger.dropped;
+    out->bytes = g_bus_trigger.writer.bytes;
+    out->trigger_ms = g_bus_trigger.trigger_ms;
+}
@@ -1,5 +1,21 @@
 #include "bus.h"
 
+#include "platform/time.h"
+
+/* Filter key of a frame: bus_id in bits 8..15, opcode in 0..7, bit 16 set
+ * when there is an opcode byte at all. */
+#define BUS_UI_KEY_HAS_OP 0x10000u
+
+typedef struct {
+    uint8_t bus_id;
+    uint8_t opcode;
+    uint8_t len;
+    uint8_t data[BUS_CAPTURE_MAX_DATA];
+    uint16_t dt_ms;
+    uint32_t diff_mask;
+    uint32_t change_ms;
+    uint32_t seen;      /* frame count when last hit, for reuse */
+} bus_ui_slot_t;
 
 static bus_ui_entry_t g_bus_ui_view[BUS_UI_VIEW_MAX];
 static uint8_t g_bus_ui_count;
@@ -11,16 +27,21 @@ static uint8_t g_bus_ui_diff_enabled;
 static uint8_t g_bus_ui_changed_only;
 static uint8_t g_bus_ui_filter_bus_id;
 static uint8_t g_bus_ui_filter_opcode_val;
-static uint8_t g_bus_ui_prev_valid;
-static uint8_t g_bus_ui_prev_len;
-static uint8_t g_bus_ui_prev_data[BUS_CAPTURE_MAX_DATA];
+/* The filters compiled by bus_ui_set_control: a frame passes when
+ * (key ^ want) & mask == 0. */
+static uint32_t g_bus_ui_match_mask;
+static uint32_t g_bus_ui_match_want;
+static bus_ui_slot_t g_bus_ui_slots[BUS_UI_OP_SLOTS];
+static uint8_t g_bus_ui_slots_used;
+static uint32_t g_bus_ui_frames;
 
 
 void bus_ui_reset(void)
 {
     g_bus_ui_count = 0;
     g_bus_ui_head = 0;
-    g_bus_ui_prev_valid = 0;
+    g_bus_ui_slots_used = 0;
+    g_bus_ui_frames = 0;
 }
 
 static uint32_t bus_ui_mask_for_len(uint8_t len)
@@ -32,40 +53,43 @@ static uint32_t bus_ui_mask_for_len(uint8_t len)
     return (uint32_t)((1u << len) - 1u);
 }
 
-static uint32_t bus_ui_diff_mask(const uint8_t *data, uint8_t len)
+/* Bytes of `data` that differ from the slot's frame; bytes present in one
+ * frame only count as changed. */
+static uint32_t bus_ui_diff_mask(const bus_ui_slot_t *s, const uint8_t *data, uint8_t len)
 {
-    if (!data || len == 0)
-        return 0;
-    if (!g_bus_ui_prev_valid)
-        return bus_ui_mask_for_len(len);
-
-    uint8_t max_len = (len > g_bus_ui_prev_len) ? len : g_bus_ui_prev_len;
-    if (max_len > BUS_CAPTURE_MAX_DATA)
-        max_len = BUS_CAPTURE_MAX_DATA;
-
-    uint32_t mask = 0;
-    for (uint8_t i = 0; i < max_len && i < 32u; ++i)
+    uint8_t common = (len < s->len) ? len : s->len;
+    uint32_t mask = bus_ui_mask_for_len((len > s->len) ? len : s->len) & ~bus_ui_mask_for_len(common);
+    for (uint8_t i = 0; i < common; ++i)
     {
-        uint8_t a = (i < len) ? data[i] : 0;
-        uint8_t b = (i < g_bus_ui_prev_len) ? g_bus_ui_prev_data[i] : 0;
-        if (i >= len || i >= g_bus_ui_prev_len || a != b)
+        if (data[i] != s->data[i])
             mask |= (1u << i);
     }
     return mask;
 }
 
-static int bus_ui_match(uint8_t bus_id, const uint8_t *data, uint8_t len)
+/* Slot of the frame's (bus_id, opcode), claiming one if it has none;
+ * `fresh` is set when the slot holds no earlier frame of that kind. */
+static bus_ui_slot_t *bus_ui_slot_for(uint8_t bus_id, uint8_t opcode, uint8_t *fresh)
 {
-    if (g_bus_ui_filter_id && bus_id != g_bus_ui_filter_bus_id)
-        return 0;
-    if (g_bus_ui_filter_opcode)
+    uint8_t oldest = 0;
+    for (uint8_t i = 0; i < g_bus_ui_slots_used; ++i)
     {
-        if (len == 0)
-            return 0;
-        if (data[0] != g_bus_ui_filter_opcode_val)
-            return 0;
+        bus_ui_slot_t *s = &g_bus_ui_slots[i];
+        if (s->bus_id == bus_id && s->opcode == opcode)
+        {
+            *fresh = 0u;
+            return s;
+        }
+        if (s->seen < g_bus_ui_slots[oldest].seen)
+            oldest = i;
     }
-    return 1;
+    bus_ui_slot_t *s = &g_bus_ui_slots[(g_bus_ui_slots_used < BUS_UI_OP_SLOTS) ? g_bus_ui_slots_used++ : oldest];
+    s->bus_id = bus_id;
+    s->opcode = opcode;
+    s->len = 0u;
+    s->dt_ms = 0u;
+    *fresh = 1u;
+    return s;
 }
 
 void bus_ui_set_control(uint8_t flags, uint8_t bus_id, uint8_t opcode)
@@ -77,6 +101,18 @@ void bus_ui_set_control(uint8_t flags, uint8_t bus_id, uint8_t opcode)
     g_bus_ui_changed_only = (flags & BUS_UI_FLAG_CHANGED_ONLY) ? 1u : 0u;
     g_bus_ui_filter_bus_id = bus_id;
     g_bus_ui_filter_opcode_val = opcode;
+    g_bus_ui_match_mask = 0u;
+    g_bus_ui_match_want = 0u;
+    if (g_bus_ui_filter_id)
+    {
+        g_bus_ui_match_mask |= 0xFF00u;
+        g_bus_ui_match_want |= (uint32_t)bus_id << 8;
+    }
+    if (g_bus_ui_filter_opcode)
+    {
+        g_bus_ui_match_mask |= BUS_UI_KEY_HAS_OP | 0xFFu;
+        g_bus_ui_match_want |= BUS_UI_KEY_HAS_OP | opcode;
+    }
     if (flags & BUS_UI_FLAG_RESET)
         bus_ui_reset();
 }
@@ -85,9 +121,29 @@ void bus_ui_on_capture(uint8_t bus_id, const uint8_t *data, uint8_t len, uint16_
 {
     if (!g_bus_ui_enabled)
         return;
-    if (!bus_ui_match(bus_id, data, len))
+    uint8_t opcode = len ? data[0] : 0u;
+    uint32_t key = ((uint32_t)bus_id << 8) | opcode | (len ? BUS_UI_KEY_HAS_OP : 0u);
+    if ((key ^ g_bus_ui_match_want) & g_bus_ui_match_mask)
         return;
 
+    uint8_t fresh;
+    bus_ui_slot_t *s = bus_ui_slot_for(bus_id, opcode, &fresh);
+    uint32_t mask = fresh ? bus_ui_mask_for_len(len) : bus_ui_diff_mask(s, data, len);
+    s->seen = ++g_bus_ui_frames;
+    if (mask)
+    {
+        s->dt_ms = fresh ? 0u : (uint16_t)(((g_ms - s->change_ms) > 0xFFFFu) ? 0xFFFFu : (g_ms - s->change_ms));
+        s->change_ms = g_ms;
+        s->diff_mask = mask;
+        s->len = len;
+        for (uint8_t i = 0; i < len; ++i)
+            s->data[i] = data[i];
+    }
+    else if (g_bus_ui_changed_only)
+    {
+        return;
+    }
+
     bus_ui_entry_t *entry = &g_bus_ui_view[g_bus_ui_head];
     entry->dt_ms = dt_ms;
     entry->bus_id = bus_id;
@@ -96,17 +152,11 @@ void bus_ui_on_capture(uint8_t bus_id, const uint8_t *data, uint8_t len, uint16_
         entry->data[i] = data[i];
 
     uint8_t diff_active = (g_bus_ui_diff_enabled || g_bus_ui_changed_only) ? 1u : 0u;
-    entry->diff_mask = diff_active ? bus_ui_diff_mask(data, len) : 0u;
+    entry->diff_mask = diff_active ? mask : 0u;
 
     g_bus_ui_head = (uint8_t)((g_bus_ui_head + 1u) % BUS_UI_VIEW_MAX);
     if (g_bus_ui_count < BUS_UI_VIEW_MAX)
         g_bus_ui_count++;
-
-    g_bus_ui_prev_valid = 1u;
-    g_bus_ui_prev_len = len;
-    for (uint8_t i = 0; i < len; ++i)
-        g_bus_ui_prev_data[i] = data[i];
-
 }
 
 void bus_ui_get_state(bus_ui_state_t *out)
@@ -132,3 +182,20 @@ int bus_ui_get_last(bus_ui_entry_t *out)
     *out = g_bus_ui_view[idx];
     return 1;
 }
+
+uint8_t bus_ui_get_rows(uint8_t first, bus_ui_row_t *out, uint8_t max)
+{
+    if (!out)
+        return 0;
+    uint8_t n = 0;
+    for (uint8_t i = first; i < g_bus_ui_slots_used && n < max; ++i, ++n)
+    {
+        const bus_ui_slot_t *s = &g_bus_ui_slots[i];
+        out[n].bus_id = s->bus_id;
+        out[n].opcode = s->opcode;
+        out[n].len = s->len;
+        out[n].dt_ms = s->dt_ms;
+        out[n].diff_mask = s->diff_mask;
+    }
+    return n;
+}
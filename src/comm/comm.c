@@ -3,6 +3,9 @@
 #include <string.h>
 
 #include "drivers/uart.h"
+#include "src/bus/bus.h"
+#include "platform/clock.h"
+#include "platform/cpu.h"
 #include "platform/time.h"
 #include "platform/hw.h"
 
@@ -12,20 +15,43 @@ typedef struct {
     uint8_t len;
     uint8_t active;
     uint32_t last_rx_ms;
+    uint32_t frames;    /* polled parser: good frames */
+    uint32_t bad;       /* polled parser: oversize LEN or checksum mismatch */
 } uart_port_t;
 
 static uart_port_t g_ports[] = {
-    { UART1_BASE, {0}, 0, 1, 0 }, /* BLE UART (OEM app) + default active */
-    { UART2_BASE, {0}, 0, 0, 0 }, /* motor UART (Shengyi DWG22), ISR-owned in app mode */
-    { UART4_BASE, {0}, 0, 0, 0 }, /* optional / alternate */
+    { UART1_BASE, {0}, 0, 1, 0, 0, 0 }, /* BLE UART (OEM app) + default active */
+    { UART2_BASE, {0}, 0, 0, 0, 0, 0 }, /* motor UART (Shengyi DWG22), ISR-owned in app mode */
+    { UART4_BASE, {0}, 0, 0, 0, 0, 0 }, /* optional / alternate */
 };
 
 int g_last_rx_port = 0;
+uint32_t g_last_rx_us;
 /* Keep UART2 RX ownership in motor ISR path to avoid byte races with comm parser. */
 int g_comm_skip_uart2 = 1;
 
 static uint8_t tx_buf[COMM_MAX_PAYLOAD + 8];
 
+/* Bytes taken from a port's RX FIFO per poll (one uart_read call). */
+#define COMM_RX_CHUNK 128u
+
+/* UART1 frames are assembled by the RX interrupt (comm_ble_rx_byte) straight
+ * into one of these slots and handed to the handlers by pointer. Slot
+ * [head % N] is always the one being filled, so at most N - 1 wait. */
+#define COMM_RX_SLOTS 4u
+
+static struct {
+    uint8_t slot[COMM_RX_SLOTS][COMM_MAX_PAYLOAD + 4u];
+    uint32_t slot_us[COMM_RX_SLOTS]; /* platform_time_us() at the last byte */
+    volatile uint8_t head;      /* ISR: frames published */
+    volatile uint8_t tail;      /* main loop: frames handled */
+    uint8_t enabled;
+    comm_framer_t framer;
+    uint32_t frames;
+    uint32_t bad;               /* oversize LEN or checksum mismatch */
+    uint32_t overruns;          /* complete frame, no free slot */
+} g_ble_rx;
+
 /* BLE TTM text overlay on UART1.
  * The module emits ASCII status frames (TTM:...) before/after binary protocol
  * traffic. We filter those lines and let only framed binary bytes continue.
@@ -131,8 +157,7 @@ static int ttm_filter_byte(uint8_t b)
 void ble_ttm_send_mac_query(void)
 {
     static const uint8_t query[] = "TTM:MAC-?\r\n";
-    for (size_t i = 0; i < sizeof(query) - 1u; ++i)
-        uart_putc(UART1_BASE, query[i]);
+    uart_tx_write(UART1_BASE, query, sizeof(query) - 1u);
 }
 
 uint8_t ble_ttm_is_connected(void)
@@ -145,6 +170,172 @@ const char *ble_ttm_get_mac(void)
     return g_ttm.mac_str;
 }
 
+/*
+ * UART1 baud upgrade. The module is told its new rate ("TTM:BPS-<baud>")
+ * at the old one, then BRR follows once the command has left and the module
+ * had BLE_BAUD_SETTLE_MS to apply it. The host proves the new rate with any
+ * good frame (a ping) within the timeout; otherwise both sides step back to
+ * the previous rate. Nothing is persisted: comm_ble_baud_restore() returns
+ * the link to 9600 before every reboot, which is what the OEM bootloader and
+ * a fresh app expect.
+ */
+#define BLE_BAUD_DEFAULT     9600u
+#define BLE_BAUD_SETTLE_MS   50u
+#define BLE_BAUD_SETTLE_SPIN 1000000u
+
+static struct
+{
+    uint8_t state;
+    uint8_t reverting;
+    uint16_t timeout_ms;
+    uint32_t target;
+    uint32_t prev;
+    uint32_t deadline_ms;
+    uint32_t uart_baud;
+    uint32_t module_baud;
+    uint16_t fallbacks;
+} g_ble_baud = { BLE_BAUD_IDLE, 0u, 0u, 0u, 0u, 0u, BLE_BAUD_DEFAULT, BLE_BAUD_DEFAULT, 0u };
+
+static int ble_baud_supported(uint32_t baud)
+{
+    return baud == 9600u || baud == 19200u || baud == 38400u || baud == 57600u || baud == 115200u;
+}
+
+static void ttm_send_bps(uint32_t baud)
+{
+    uint8_t cmd[24] = "TTM:BPS-";
+    size_t n = 8u;
+    char digits[8];
+    uint8_t nd = 0u;
+    do
+    {
+        digits[nd++] = (char)('0' + (baud % 10u));
+        baud /= 10u;
+    } while (baud && nd < sizeof(digits));
+    while (nd)
+        cmd[n++] = (uint8_t)digits[--nd];
+    cmd[n++] = '\r';
+    cmd[n++] = '\n';
+    uart_tx_write(UART1_BASE, cmd, n);
+}
+
+static void ble_uart_set_baud(uint32_t baud)
+{
+    uart_set_baud_rate(UART1_BASE, baud);
+    g_ble_baud.uart_baud = baud;
+    /* Bytes straddling the switch are garbage; resync at the next SOF. */
+    uint32_t primask = irq_save();
+    g_ble_rx.framer.pos = 0u;
+    irq_restore(primask);
+    g_ports[PORT_BLE].len = 0u;
+    g_ttm.in_text = 0u;
+    g_ttm.text_pos = 0u;
+}
+
+int comm_ble_baud_request(uint32_t baud, uint16_t timeout_ms)
+{
+    if (!ble_baud_supported(baud))
+        return 0;
+    if (g_ble_baud.state != BLE_BAUD_IDLE)
+        return -1;
+    if (baud == g_ble_baud.uart_baud)
+        return 1;
+    g_ble_baud.prev = g_ble_baud.uart_baud;
+    g_ble_baud.target = baud;
+    g_ble_baud.timeout_ms = timeout_ms;
+    g_ble_baud.reverting = 0u;
+    g_ble_baud.state = BLE_BAUD_DRAIN;
+    return 1;
+}
+
+uint8_t comm_ble_baud_state(uint32_t *baud, uint32_t *target, uint16_t *fallbacks)
+{
+    if (baud)
+        *baud = g_ble_baud.uart_baud;
+    if (target)
+        *target = g_ble_baud.target;
+    if (fallbacks)
+        *fallbacks = g_ble_baud.fallbacks;
+    return g_ble_baud.state;
+}
+
+static void ble_baud_frame_seen(void)
+{
+    if (g_ble_baud.state == BLE_BAUD_PROBATION)
+        g_ble_baud.state = BLE_BAUD_IDLE;
+}
+
+static void ble_baud_tick(void)
+{
+    switch (g_ble_baud.state)
+    {
+    case BLE_BAUD_DRAIN:
+        if (!uart_tx_idle(UART1_BASE))
+            return;
+        ttm_send_bps(g_ble_baud.target);
+        g_ble_baud.module_baud = g_ble_baud.target;
+        g_ble_baud.state = BLE_BAUD_CMD;
+        break;
+    case BLE_BAUD_CMD:
+        if (!uart_tx_idle(UART1_BASE))
+            return;
+        g_ble_baud.deadline_ms = g_ms + BLE_BAUD_SETTLE_MS;
+        g_ble_baud.state = BLE_BAUD_SETTLE;
+        break;
+    case BLE_BAUD_SETTLE:
+        if ((int32_t)(g_ms - g_ble_baud.deadline_ms) < 0)
+            return;
+        ble_uart_set_baud(g_ble_baud.target);
+        if (g_ble_baud.reverting)
+        {
+            g_ble_baud.state = BLE_BAUD_IDLE;
+            break;
+        }
+        g_ble_baud.deadline_ms = g_ms + g_ble_baud.timeout_ms;
+        g_ble_baud.state = BLE_BAUD_PROBATION;
+        break;
+    case BLE_BAUD_PROBATION:
+        if ((int32_t)(g_ms - g_ble_baud.deadline_ms) < 0)
+            return;
+        /* No word from the host at the new rate: go back. */
+        if (g_ble_baud.fallbacks != 0xFFFFu)
+            g_ble_baud.fallbacks++;
+        g_ble_baud.target = g_ble_baud.prev;
+        g_ble_baud.reverting = 1u;
+        g_ble_baud.state = BLE_BAUD_DRAIN;
+        break;
+    default:
+        break;
+    }
+}
+
+void comm_ble_baud_restore(void)
+{
+    if (g_ble_baud.uart_baud == BLE_BAUD_DEFAULT && g_ble_baud.module_baud == BLE_BAUD_DEFAULT)
+    {
+        g_ble_baud.state = BLE_BAUD_IDLE;
+        return;
+    }
+    uart_tx_flush(UART1_BASE);
+    if (g_ble_baud.module_baud != BLE_BAUD_DEFAULT)
+    {
+        if (g_ble_baud.uart_baud != g_ble_baud.module_baud)
+            ble_uart_set_baud(g_ble_baud.module_baud);
+        ttm_send_bps(BLE_BAUD_DEFAULT);
+        uart_tx_flush(UART1_BASE);
+        g_ble_baud.module_baud = BLE_BAUD_DEFAULT;
+        /* May run with IRQs masked (reboot, fault monitor): no g_ms. */
+        uint32_t t0 = platform_cycles_now();
+        for (uint32_t spin = 0; spin < BLE_BAUD_SETTLE_SPIN; ++spin)
+        {
+            if (platform_cycles_to_us(platform_cycles_now() - t0) >= BLE_BAUD_SETTLE_MS * 1000u)
+                break;
+        }
+    }
+    ble_uart_set_baud(BLE_BAUD_DEFAULT);
+    g_ble_baud.state = BLE_BAUD_IDLE;
+}
+
 /* ---------- end TTM ---------- */
 
 void uart_write_port(int port_idx, const uint8_t *data, size_t len)
@@ -154,13 +345,69 @@ void uart_write_port(int port_idx, const uint8_t *data, size_t len)
     if (!data || len == 0u)
         return;
 
-    /* Raw/binary-safe TX for framed protocol responses. */
-    for (size_t i = 0; i < len; ++i)
-        uart_putc(g_ports[port_idx].base, data[i]);
+    /* Raw/binary-safe TX; queued on ports with a TX ring (uart_tx_write). */
+    uart_tx_write(g_ports[port_idx].base, data, len);
+}
+
+uint16_t comm_tx_free(int port_idx)
+{
+    if (port_idx < 0 || (size_t)port_idx >= (sizeof(g_ports) / sizeof(g_ports[0])))
+        return 0u;
+    return uart_tx_free(g_ports[port_idx].base);
+}
+
+static struct {
+    uint8_t active;
+    uint8_t cmd;
+    uint8_t tag;
+    int port;
+} g_reply_tag;
+
+void comm_reply_tag_set(int port, uint8_t cmd, uint8_t tag)
+{
+    g_reply_tag.port = port;
+    g_reply_tag.cmd = cmd;
+    g_reply_tag.tag = tag;
+    g_reply_tag.active = 1u;
+}
+
+void comm_reply_tag_clear(void)
+{
+    g_reply_tag.active = 0u;
+}
+
+/* {tag, cmd, reply}; a reply too long for the two header bytes becomes
+ * {tag, cmd, 0xFD} (bad payload: ask for less). */
+static void send_tagged(int port_idx, uint8_t cmd, const uint8_t *payload, uint8_t len)
+{
+    if (len && !payload)
+        return;
+    uint8_t *w = &tx_buf[3];
+    w[0] = g_reply_tag.tag;
+    w[1] = cmd;
+    if (len > COMM_TAGGED_MAX_REPLY)
+    {
+        w[2] = 0xFDu;
+        len = 1u;
+    }
+    else if (len)
+    {
+        memcpy(&w[2], payload, len);
+    }
+    tx_buf[0] = COMM_SOF;
+    tx_buf[1] = (uint8_t)(COMM_CMD_TAGGED | 0x80u);
+    tx_buf[2] = (uint8_t)(len + 2u);
+    tx_buf[5u + len] = checksum(tx_buf, 5u + len);
+    uart_write_port(port_idx, tx_buf, 6u + len);
 }
 
 void send_frame_port(int port_idx, uint8_t cmd, const uint8_t *payload, uint8_t len)
 {
+    if (g_reply_tag.active && port_idx == g_reply_tag.port && cmd == (uint8_t)(g_reply_tag.cmd | 0x80u))
+    {
+        send_tagged(port_idx, cmd, payload, len);
+        return;
+    }
     size_t frame_len = comm_frame_build(tx_buf, sizeof(tx_buf), cmd, payload, len);
     if (!frame_len)
         return;
@@ -173,52 +420,183 @@ void send_status(uint8_t cmd, uint8_t status)
     send_frame_port(g_last_rx_port, cmd | 0x80, p, 1);
 }
 
-static void handle_frame(const uint8_t *frame, uint8_t len)
+static void dispatch_frame(const uint8_t *frame)
+{
+    uint8_t cmd = frame[1];
+    if (g_last_rx_port == PORT_BLE)
+        ble_baud_frame_seen();
+    if (!comm_handle_command(cmd, &frame[3], frame[2]))
+        send_status(cmd, 0xFF);
+}
+
+static void handle_frame(uart_port_t *p, const uint8_t *frame, uint8_t len)
 {
     if (len < 4)
         return;
-    uint8_t cmd = frame[1];
-    uint8_t plen = frame[2];
     uint8_t want = 0;
     uint8_t ok = comm_frame_validate(frame, len, &want);
     if (!ok)
+    {
+        p->bad++;
         return;
+    }
+    p->frames++;
+    dispatch_frame(frame);
+}
 
-    const uint8_t *p = &frame[3];
-    if (!comm_handle_command(cmd, p, plen))
-        send_status(cmd, 0xFF);
+/* uart_rx_hook_t for UART1: runs in the USART1 interrupt. */
+static int comm_ble_rx_byte(uint8_t b)
+{
+    bus_session_rx(BUS_BLE, &b, 1u);
+    uint8_t *buf = g_ble_rx.slot[g_ble_rx.head % COMM_RX_SLOTS];
+    uint8_t started = (g_ble_rx.framer.pos == 0u);
+    comm_parse_result_t res = comm_framer_feed(&g_ble_rx.framer, buf, COMM_MAX_PAYLOAD, b);
+    if (res == COMM_PARSE_FRAME)
+    {
+        if ((uint8_t)(g_ble_rx.head - g_ble_rx.tail) < COMM_RX_SLOTS - 1u)
+        {
+            g_ble_rx.slot_us[g_ble_rx.head % COMM_RX_SLOTS] = platform_time_us();
+            __asm__ volatile("dmb" ::: "memory");
+            g_ble_rx.head++;
+            g_ble_rx.frames++;
+        }
+        else
+        {
+            g_ble_rx.overruns++;
+        }
+    }
+    else if (res == COMM_PARSE_ERROR)
+    {
+        g_ble_rx.bad++;
+    }
+    /* Bytes outside a frame (TTM text, noise) stay in the FIFO for the TTM
+     * filter; so does the SOF, which ends a partial TTM line as before. */
+    return started ? 0 : 1;
+}
+
+void comm_rx_irq_enable(void)
+{
+    if (g_ble_rx.enabled)
+        return;
+    g_ble_rx.enabled = 1u;
+    uart_rx_set_hook(UART1_BASE, comm_ble_rx_byte);
+}
+
+int comm_rx_pending(void)
+{
+    return g_ble_rx.head != g_ble_rx.tail;
+}
+
+static void poll_ble_frames(uart_port_t *p)
+{
+    /* Fault handlers and masked IRQs: the interrupt cannot drain DR. */
+    if (!cpu_irqs_available())
+        uart_isr_rx_drain(p->base);
+
+    while (g_ble_rx.head != g_ble_rx.tail)
+    {
+        const uint8_t *frame = g_ble_rx.slot[g_ble_rx.tail % COMM_RX_SLOTS];
+        g_last_rx_port = PORT_BLE;
+        g_last_rx_us = g_ble_rx.slot_us[g_ble_rx.tail % COMM_RX_SLOTS];
+        p->active = 1;
+        p->last_rx_ms = g_ms;
+        dispatch_frame(frame);
+        __asm__ volatile("dmb" ::: "memory");
+        g_ble_rx.tail++;
+    }
+
+    uint8_t chunk[COMM_RX_CHUNK];
+    size_t n = uart_read(p->base, chunk, sizeof(chunk));
+    for (size_t i = 0; i < n; ++i)
+        (void)ttm_filter_byte(chunk[i]);
+}
+
+static void poll_port_bytes(size_t pi, uart_port_t *p)
+{
+    uint8_t chunk[COMM_RX_CHUNK];
+    size_t n = uart_read(p->base, chunk, sizeof(chunk));
+    /* With the IRQ hook on, UART1 bytes are recorded as they arrive. */
+    if (pi == PORT_BLE)
+        bus_session_rx(BUS_BLE, chunk, (uint16_t)n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint8_t b = chunk[i];
+
+        if (pi == PORT_BLE && p->len == 0u && ttm_filter_byte(b))
+            continue;
+
+        uint8_t frame_len = 0;
+        comm_parse_result_t res = comm_parser_feed(p->buf, sizeof(p->buf), COMM_MAX_PAYLOAD,
+                                                   &p->len, b, &frame_len);
+        if (res == COMM_PARSE_FRAME)
+        {
+            g_last_rx_port = (int)pi;
+            g_last_rx_us = platform_time_us();
+            p->active = 1;
+            p->last_rx_ms = g_ms;
+            handle_frame(p, p->buf, frame_len);
+        }
+        else if (res == COMM_PARSE_ERROR)
+        {
+            p->bad++;
+        }
+    }
 }
 
 void poll_uart_rx_ports(void)
 {
+    ble_baud_tick();
     size_t port_count = sizeof(g_ports) / sizeof(g_ports[0]);
     for (size_t pi = 0; pi < port_count; ++pi)
     {
         uart_port_t *p = &g_ports[pi];
         if (g_comm_skip_uart2 && p->base == UART2_BASE)
             continue;
-        uint16_t rx_budget = 128u;
-        while (rx_budget-- && uart_rx_available(p->base))
-        {
-            uint8_t b = uart_getc(p->base);
-
-            if (pi == PORT_BLE && p->len == 0u && ttm_filter_byte(b))
-                continue;
-
-            uint8_t frame_len = 0;
-            comm_parse_result_t res = comm_parser_feed(p->buf, sizeof(p->buf), COMM_MAX_PAYLOAD,
-                                                       &p->len, b, &frame_len);
-            if (res == COMM_PARSE_FRAME)
-            {
-                g_last_rx_port = (int)pi;
-                p->active = 1;
-                p->last_rx_ms = g_ms;
-                handle_frame(p->buf, frame_len);
-            }
-            (void)frame_len;
-        }
+        if (pi == PORT_BLE && g_ble_rx.enabled)
+            poll_ble_frames(p);
+        else
+            poll_port_bytes(pi, p);
         /* drop inactivity >15s */
         if (p->active && (g_ms - p->last_rx_ms) > 15000)
             p->active = 0;
     }
 }
+
+int comm_get_port_stats(int port_idx, comm_port_stats_t *out)
+{
+    if (!out || port_idx < 0 || (size_t)port_idx >= (sizeof(g_ports) / sizeof(g_ports[0])))
+        return 0;
+    const uart_port_t *p = &g_ports[port_idx];
+    uart_stats_t us;
+    uart_get_stats(p->base, &us);
+    out->rx_bytes = us.rx_bytes;
+    out->rx_drops = us.rx_drops;
+    out->tx_bytes = us.tx_bytes;
+    out->tx_drops = us.tx_drops;
+    out->tx_stall_us = us.tx_stall_us;
+    out->frames = p->frames;
+    out->bad = p->bad;
+    out->overruns = 0u;
+    if (port_idx == PORT_BLE)
+    {
+        out->frames += g_ble_rx.frames;
+        out->bad += g_ble_rx.bad;
+        out->overruns = g_ble_rx.overruns;
+    }
+    return 1;
+}
+
+void comm_reset_port_stats(void)
+{
+    for (size_t i = 0; i < sizeof(g_ports) / sizeof(g_ports[0]); ++i)
+    {
+        g_ports[i].frames = 0u;
+        g_ports[i].bad = 0u;
+        uart_reset_stats(g_ports[i].base);
+    }
+    uint32_t primask = irq_save();
+    g_ble_rx.frames = 0u;
+    g_ble_rx.bad = 0u;
+    g_ble_rx.overruns = 0u;
+    irq_restore(primask);
+}
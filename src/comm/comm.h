@@ -41,11 +41,22 @@ void comm_tick(void);
 void uart_write_port(int port_idx, const uint8_t *data, size_t len);
 void send_frame_port(int port_idx, uint8_t cmd, const uint8_t *payload, uint8_t len);
 void send_status(uint8_t cmd, uint8_t status);
+/* While set, replies to `cmd` on `port` are wrapped for `tag`
+ * (COMM_CMD_TAGGED); anything else the handler sends goes out as is. */
+void comm_reply_tag_set(int port, uint8_t cmd, uint8_t tag);
+void comm_reply_tag_clear(void);
+/* Bytes the port can queue without waiting (UART_TX_FREE_POLLED if it
+ * transmits synchronously). Periodic senders skip a frame instead of
+ * blocking when a whole frame (payload + 4) does not fit. */
+uint16_t comm_tx_free(int port_idx);
 
 
 int comm_handle_command(uint8_t cmd, const uint8_t *payload, uint8_t len);
 
 extern int g_last_rx_port;
+/* platform_time_us() when the frame being handled was complete: stamped by
+ * the UART1 RX interrupt, by the poll that parsed it on other ports. */
+extern uint32_t g_last_rx_us;
 
 /* Stream API */
 void stream_start(uint16_t period_ms);
@@ -54,10 +65,39 @@ void stream_tick(void);
 
 /* Main loop helpers. */
 void poll_uart_rx_ports(void);
+/* Assemble UART1 frames in the RX interrupt (after platform_uart_irq_init);
+ * poll_uart_rx_ports() then only dispatches complete, checksummed frames. */
+void comm_rx_irq_enable(void);
+/* Non-zero while a received frame waits for poll_uart_rx_ports(). */
+int comm_rx_pending(void);
+
+/* Link counters per port (PORT_*); see uart_stats_t for the driver side. */
+typedef struct {
+    uint32_t rx_bytes;
+    uint32_t frames;        /* checksummed frames handed to the handlers */
+    uint32_t bad;           /* oversize LEN or checksum mismatch */
+    uint32_t rx_drops;      /* bytes lost to a full driver RX FIFO */
+    uint32_t overruns;      /* UART1 frames lost to full frame slots */
+    uint32_t tx_bytes;      /* bytes queued or written to the UART */
+    uint32_t tx_drops;      /* bytes given up on when the UART never freed */
+    uint32_t tx_stall_us;   /* time writers waited for the UART */
+} comm_port_stats_t;
+
+int comm_get_port_stats(int port_idx, comm_port_stats_t *out);
+void comm_reset_port_stats(void);
 
 /* Skip UART2 parsing when we want to sniff raw motor traffic. */
 extern int g_comm_skip_uart2;
 void send_state_frame_bin(void);
+void send_telemetry_v2(void);
+void bulk_read_tick(void);
+/* Sends remote framebuffer chunks while a 0x62 ui_stream is on. */
+void ui_stream_tick(void);
+/* Sends graph cells while a 0x64 graph_export runs. */
+void graph_export_tick(void);
+/* Runs one deferred tagged request per call, once its port has TX room. */
+void comm_tagged_tick(void);
+void ble_hacker_notify_tick(void);
 void print_status(void);
 
 /* ---------- BLE TTM module handshake ---------- */
@@ -72,4 +112,22 @@ uint8_t ble_ttm_is_connected(void);
 /* MAC address string (e.g. "001122334455"), empty if not yet received. */
 const char *ble_ttm_get_mac(void);
 
+/* UART1 baud negotiation states (comm_ble_baud_state). */
+enum {
+    BLE_BAUD_IDLE = 0,
+    BLE_BAUD_DRAIN,     /* wait for queued TX at the old rate */
+    BLE_BAUD_CMD,       /* TTM:BPS command in flight */
+    BLE_BAUD_SETTLE,    /* module applying it; BRR changes after */
+    BLE_BAUD_PROBATION, /* new rate live, waiting for the host */
+};
+
+/* Start moving module and UART1 to baud (9600..115200): 1 accepted (or
+ * already there), 0 unsupported rate, -1 a change is still in progress.
+ * Without a good BLE frame within timeout_ms of the switch, both go back. */
+int comm_ble_baud_request(uint32_t baud, uint16_t timeout_ms);
+/* Current state; baud is the live UART1 rate, target the one being set. */
+uint8_t comm_ble_baud_state(uint32_t *baud, uint32_t *target, uint16_t *fallbacks);
+/* Blocking return to the OEM 9600 on both sides; call before any reboot. */
+void comm_ble_baud_restore(void);
+
 #endif /* COMM_H */
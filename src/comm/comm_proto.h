@@ -8,6 +8,25 @@
 #define COMM_SOF         0x55
 #define COMM_MAX_PAYLOAD 192
 
+/* Unsolicited binary trace records (src/core/trace_bin.h); 0x17 is reserved. */
+#define TRACE_FRAME_CMD  0x97u
+
+/* Tagged request: payload {tag, cmd, args}. Each reply to it comes back as
+ * {tag, cmd | 0x80, reply} under COMM_CMD_TAGGED | 0x80, so a host can keep
+ * several requests in flight and match replies that arrive out of order.
+ * A tagged reply carries at most COMM_TAGGED_MAX_REPLY bytes. */
+#define COMM_CMD_TAGGED       0x19u
+#define COMM_TAGGED_MAX_REPLY (COMM_MAX_PAYLOAD - 2u)
+
+/* Time sync: payload {t1[4], cmd?, args} -> {t1[4], t2[4], t3[4]} under
+ * COMM_CMD_TIME_SYNC | 0x80. t1 is the host's send time, echoed; t2 the
+ * device time (platform_time_us) the request arrived, t3 the device time
+ * the reply was built. With `cmd`, it runs first and its own replies go
+ * out before this one, so t3 - t2 covers its handling. Four timestamps, as
+ * in NTP: offset = ((t2 - t1) + (t3 - t4)) / 2. */
+#define COMM_CMD_TIME_SYNC   0x1Bu
+#define COMM_TIME_SYNC_BYTES 12u
+
 /* XOR checksum (inverted) for 0x55-framed protocol data. */
 static inline uint8_t checksum(const uint8_t *buf, size_t len)
 {
@@ -199,4 +218,46 @@ static inline comm_parse_result_t comm_parser_feed(uint8_t *buf, size_t cap, uin
     return COMM_PARSE_NONE;
 }
 
+/*
+ * Incremental framer with a running checksum, for the receive interrupt.
+ * Bytes are appended to `buf` (COMM_MAX_PAYLOAD + 4 bytes); a frame is
+ * reported only once its checksum byte arrived and matched, so the caller
+ * can publish `buf` as-is. Outside a frame only COMM_SOF is taken.
+ */
+typedef struct {
+    uint8_t pos;    /* bytes of the current frame in buf; 0 = hunting SOF */
+    uint8_t x;      /* XOR of buf[0..pos) */
+} comm_framer_t;
+
+static inline comm_parse_result_t comm_framer_feed(comm_framer_t *f, uint8_t *buf,
+                                                   uint8_t max_payload, uint8_t byte)
+{
+    if (f->pos == 0u)
+    {
+        if (byte != COMM_SOF)
+            return COMM_PARSE_NONE;
+        buf[0] = byte;
+        f->x = byte;
+        f->pos = 1u;
+        return COMM_PARSE_NONE;
+    }
+    if (f->pos == 2u && byte > max_payload)
+    {
+        f->pos = 0u;
+        return COMM_PARSE_ERROR;
+    }
+    if (f->pos >= 3u && f->pos == (uint8_t)(buf[2] + 3u))
+    {
+        f->pos = 0u;
+        uint8_t chk = (uint8_t)~f->x;
+        if (chk != byte)
+            return COMM_PARSE_ERROR;
+        buf[(size_t)buf[2] + 3u] = byte;
+        return COMM_PARSE_FRAME;
+    }
+    buf[f->pos++] = byte;
+    f->x ^= byte;
+    return COMM_PARSE_NONE;
+}
+
 #endif /* COMM_PROTO_H */
@@ -6,30 +6,54 @@
 
 #include "app_data.h"
 #include "ui.h"
+#include "ui_lcd.h"
 #include "ui_state.h"
 #include "ble_hacker.h"
 #include "src/config/config.h"
 #include "src/control/control.h"
+#include "src/control/state_snapshot.h"
 #include "src/power/power.h"
+#include "src/power/clock_profile.h"
 #include "src/input/input.h"
+#include "src/input/input_latency.h"
 #include "src/bus/bus.h"
 #include "src/profiles/profiles.h"
+#include "src/profiles/profile_bundle.h"
 #include "src/telemetry/trip.h"
 #include "src/telemetry/telemetry.h"
+#include "src/telemetry/tlm_stream.h"
 #include "src/system_control.h"
 #include "app_state.h"
 #include "src/motor/shengyi.h"
 #include "src/motor/motor_isr.h"
 #include "src/motor/motor_link.h"
+#include "src/motor/motor_health.h"
+#include "src/kernel/event_bus.h"
+#include "src/kernel/scheduler.h"
+#include "src/kernel/work_queue.h"
+#include "platform/irq_load.h"
 #include "platform/mmio.h"
 #include "platform/time.h"
+#include "platform/overlay.h"
+#include "platform/pc_sample.h"
+#include "platform/ram.h"
+#include "platform/watchdog.h"
 #include "src/boot_phase.h"
 #include "src/boot_monitor.h"
+#include "src/boot_log.h"
 #include "drivers/spi_flash.h"
 #include "storage/layout.h"
 #include "storage/logs.h"
 #include "storage/ab_update.h"
 #include "storage/crash_dump.h"
+#include "storage/flash_health.h"
+#include "storage/lifetime.h"
+#include "storage/flash_jobs.h"
+#include "storage/kv_store.h"
+#include "storage/ota.h"
+#include "storage/ride_log.h"
+#include "storage/splash.h"
+#include "storage/ui_assets.h"
 #include "util/byteorder.h"
 #include "src/core/math_util.h"
 #include "platform/hw.h"
@@ -46,6 +70,7 @@ enum {
     CMD_STATUS_BAD_PAYLOAD = 0xFDu,
     CMD_STATUS_BAD_ARG = 0xFBu,
     CMD_STATUS_BLOCKED_MOVING = 0xFCu,
+    CMD_STATUS_RATE_LIMITED = 0xEFu,
 };
 
 typedef enum {
@@ -64,6 +89,14 @@ typedef enum {
     CMD_ID_SET_STREAM = 0x0Du,
     CMD_ID_REBOOT_BOOTLOADER = 0x0Eu,
     CMD_ID_SET_DEBUG_OUTPUT = 0x0Fu,
+    CMD_ID_CMD_STATS = 0x10u,
+    CMD_ID_STREAM_V2 = 0x11u,
+    CMD_ID_BULK_READ = 0x12u,
+    CMD_ID_BULK_READ_NAK = 0x13u,
+    CMD_ID_COMM_STATS = 0x15u,
+    CMD_ID_BLE_BAUD = 0x16u,
+    CMD_ID_INPUT_LATENCY = 0x17u,
+    CMD_ID_WATCHDOG_STATS = 0x18u,
     CMD_ID_SPEED_RB_SUMMARY = 0x20u,
     CMD_ID_DEBUG_STATE_V2 = 0x21u,
     CMD_ID_GRAPH_SUMMARY = 0x22u,
@@ -74,6 +107,12 @@ typedef enum {
     CMD_ID_MOTOR_PROTO_GET = 0x27u,
     CMD_ID_MOTOR_STX02_OPTS_SET = 0x28u,
     CMD_ID_MOTOR_STX02_OPTS_GET = 0x29u,
+    CMD_ID_UI_PERF = 0x2Au,
+    CMD_ID_MOTOR_HEALTH = 0x2Bu,
+    CMD_ID_SCHED_STATS = 0x2Cu,
+    CMD_ID_EVENT_STATS = 0x2Du,
+    CMD_ID_RAM_STATS = 0x2Eu,
+    CMD_ID_RAM_EXT_CONFIG = 0x2Fu,
     CMD_ID_CONFIG_GET = 0x30u,
     CMD_ID_CONFIG_STAGE = 0x31u,
     CMD_ID_CONFIG_COMMIT = 0x32u,
@@ -85,6 +124,11 @@ typedef enum {
     CMD_ID_SET_DRIVE_MODE = 0x38u,
     CMD_ID_SET_REGEN = 0x39u,
     CMD_ID_SET_HW_CAPS = 0x3Au,
+    CMD_ID_TRIP_QUANTILES = 0x3Bu,
+    CMD_ID_RIDE_LOG_SUMMARY = 0x3Cu,
+    CMD_ID_RIDE_LOG_READ = 0x3Du,
+    CMD_ID_BOOT_PROFILE = 0x3Eu,
+    CMD_ID_CONFIG_PATCH = 0x3Fu,
     CMD_ID_EVENT_LOG_SUMMARY = 0x40u,
     CMD_ID_EVENT_LOG_READ = 0x41u,
     CMD_ID_EVENT_LOG_MARK = 0x42u,
@@ -93,6 +137,9 @@ typedef enum {
     CMD_ID_STREAM_LOG_CONTROL = 0x46u,
     CMD_ID_CRASH_DUMP_READ = 0x47u,
     CMD_ID_CRASH_DUMP_CLEAR = 0x48u,
+    CMD_ID_LOG_QUERY = 0x49u,
+    CMD_ID_BUS_SESSION = 0x4Eu,
+    CMD_ID_BUS_TRIGGER = 0x4Fu,
     CMD_ID_BUS_CAPTURE_SUMMARY = 0x50u,
     CMD_ID_BUS_CAPTURE_READ = 0x51u,
     CMD_ID_BUS_CAPTURE_CONTROL = 0x52u,
@@ -100,6 +147,21 @@ typedef enum {
     CMD_ID_BUS_UI_CONTROL = 0x54u,
     CMD_ID_BUS_INJECT_ARM = 0x55u,
     CMD_ID_BUS_CAPTURE_REPLAY = 0x56u,
+    CMD_ID_BUS_REPLAY_UPLOAD = 0x57u,
+    CMD_ID_STORAGE_STATS = 0x58u,
+    CMD_ID_OTA_BEGIN = 0x59u,
+    CMD_ID_OTA_CHUNK = 0x5Au,
+    CMD_ID_OTA_FINISH = 0x5Bu,
+    CMD_ID_OTA_STATUS = 0x5Cu,
+    CMD_ID_SPLASH_UPLOAD = 0x5Du,
+    CMD_ID_ASSET_UPLOAD = 0x5Eu,
+    CMD_ID_PROFILE_BUNDLE = 0x5Fu,
+    CMD_ID_PC_PROFILE = 0x60u,
+    CMD_ID_IRQ_STATS = 0x61u,
+    CMD_ID_UI_STREAM = 0x62u,
+    CMD_ID_FLASH_HEALTH = 0x63u,
+    CMD_ID_GRAPH_EXPORT = 0x64u,
+    CMD_ID_LIFETIME = 0x65u,
     CMD_ID_BLE_HACKER = 0x70u,
     CMD_ID_AB_STATUS = 0x71u,
     CMD_ID_AB_SET_PENDING = 0x72u,
@@ -115,6 +177,7 @@ extern uint32_t g_reset_csr;
 extern uint16_t g_gear_limit_power_w;
 extern uint16_t g_gear_scale_q15;
 extern uint16_t g_cadence_bias_q15;
+extern event_bus_t g_event_bus;
 
 void process_buttons(uint8_t raw_buttons);
 
@@ -143,25 +206,6 @@ static int config_change_guard(uint8_t cmd)
     return 0;
 }
 
-static int app_phase_privileged_cmd(uint8_t cmd)
-{
-    switch (cmd)
-    {
-    case CMD_ID_WRITE32:
-    case CMD_ID_WRITE_MEM:
-    case CMD_ID_EXEC:
-    case CMD_ID_UPLOAD_EXEC:
-    case CMD_ID_SET_STATE:
-    case CMD_ID_MOTOR_UART2_RAW_TX:
-    case CMD_ID_BUS_CAPTURE_INJECT:
-    case CMD_ID_BUS_INJECT_ARM:
-    case CMD_ID_BUS_CAPTURE_REPLAY:
-        return 1;
-    default:
-        return 0;
-    }
-}
-
 static uint8_t is_thumb_sram_exec_addr(uint32_t addr)
 {
     return ((addr & 1u) != 0u) && ((addr & SRAM_EXEC_ADDR_MASK) == SRAM_EXEC_ADDR_BASE);
@@ -185,8 +229,10 @@ static __attribute__((unused)) void log_set_bytes(const uint8_t *p, uint8_t len)
     g_last_log_len = len;
 }
 
-static void handle_ping(uint8_t cmd)
+static void handle_ping(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     send_status(cmd, CMD_STATUS_OK);
 }
 
@@ -218,15 +264,16 @@ static void handle_monitor_control(const uint8_t *p, uint8_t len, uint8_t cmd)
     send_status(cmd, CMD_STATUS_BAD);
 }
 
-static void handle_log_frame(uint8_t cmd)
+static void handle_log_frame(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     send_frame_port(g_last_rx_port, cmd, g_last_log, g_last_log_len);
 }
 
 static void handle_read32(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 4)
-        return;
+    (void)len;
     uint32_t addr = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
     uint32_t v = mmio_read32(addr);
     uint8_t out[4] = { (uint8_t)(v >> 24), (uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v };
@@ -235,8 +282,7 @@ static void handle_read32(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_write32(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 8)
-        return;
+    (void)len;
     uint32_t addr = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
     uint32_t v = (p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7];
     mmio_write32(addr, v);
@@ -245,28 +291,25 @@ static void handle_write32(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_read_mem(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 5)
-        return;
+    (void)len;
     uint32_t addr = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
     uint8_t n = p[4];
     if (n > COMM_MAX_PAYLOAD || n == 0)
         return;
     uint8_t out[COMM_MAX_PAYLOAD];
     for (uint8_t i = 0; i < n; i++)
-        out[i] = *(volatile uint8_t *)(addr + i);
+        out[i] = *(volatile uint8_t *)(uintptr_t)(addr + i);
     send_frame_port(g_last_rx_port, cmd | 0x80, out, n);
 }
 
 static void handle_write_mem(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 5)
-        return;
     uint32_t addr = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
     uint8_t n = p[4];
     if (n == 0 || n > (len - 5))
         return;
     for (uint8_t i = 0; i < n; i++)
-        *(volatile uint8_t *)(addr + i) = p[5 + i];
+        *(volatile uint8_t *)(uintptr_t)(addr + i) = p[5 + i];
     send_status(cmd, CMD_STATUS_OK);
 }
 
@@ -274,8 +317,7 @@ typedef void (*entry_fn_t)(void);
 
 static void handle_exec(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 4)
-        return;
+    (void)len;
     uint32_t addr = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
     if (g_boot_phase != BOOT_PHASE_APP)
     {
@@ -293,8 +335,6 @@ static void handle_exec(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_upload_exec(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 5)
-        return;
     uint32_t addr = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
     uint8_t n = p[4];
     if (n == 0 || n > (len - 5))
@@ -309,69 +349,196 @@ static void handle_upload_exec(const uint8_t *p, uint8_t len, uint8_t cmd)
         }
     }
     for (uint8_t i = 0; i < n; i++)
-        *(volatile uint8_t *)(addr + i) = p[5 + i];
+        *(volatile uint8_t *)(uintptr_t)(addr + i) = p[5 + i];
     send_status(cmd, CMD_STATUS_OK);
     ((entry_fn_t)(uintptr_t)addr)();
 }
 
+/* External flash is not memory-mapped on hardware; support reads via SPI.
+ * - Simulation stubs map SPI flash at 0x0030_0000.
+ * - The AT32 SPIM window maps at 0x0840_0000 (16MB), if enabled.
+ * Returns `buf` filled over SPI, or the mapped address itself.
+ */
+static const uint8_t *flash_read_view(uint32_t addr, uint8_t *buf, uint8_t n)
+{
+    if (addr >= SPI_FLASH_STORAGE_BASE && addr < FLASH_APP_BASE)
+    {
+        spi_flash_read(addr, buf, n);
+        return buf;
+    }
+    if (addr >= SPIM_FLASH_MAP_BASE && addr < SPIM_FLASH_MAP_LIMIT)
+    {
+        spi_flash_read(addr - SPIM_FLASH_MAP_BASE, buf, n);
+        return buf;
+    }
+    return (const uint8_t *)(uintptr_t)addr;
+}
+
 static void handle_read_flash(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 5)
-        return;
+    (void)len;
     uint32_t addr = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
     uint8_t n = p[4];
     if (n == 0 || n > COMM_MAX_PAYLOAD)
         return;
-
-    /* External flash is not memory-mapped on hardware; support reads via SPI.
-     * - Simulation stubs map SPI flash at 0x0030_0000.
-     * - The AT32 SPIM window maps at 0x0840_0000 (16MB), if enabled.
-     */
-    if (addr >= SPI_FLASH_STORAGE_BASE && addr < FLASH_APP_BASE)
+    uint8_t buf[COMM_MAX_PAYLOAD];
+    send_frame_port(g_last_rx_port, cmd | 0x80, flash_read_view(addr, buf, n), n);
+}
+
+/*
+ * Bulk read: 0x12 starts a transfer, data follows as numbered 0x94 frames
+ * paced by TX queue space, 0x13 re-requests lost sequence numbers. The
+ * address space is read_flash's, so RAM, MCU flash and SPI flash all work.
+ */
+#define BULK_READ_DATA_CMD        0x94u
+#define BULK_READ_CHUNK           (COMM_MAX_PAYLOAD - 2u)
+#define BULK_READ_NAK_MAX         16u
+#define BULK_READ_FRAMES_PER_TICK 4u
+#define BULK_READ_IDLE_MS         10000u
+
+static struct {
+    uint32_t addr;
+    uint32_t len;
+    uint32_t last_ms;       /* last begin, NAK or frame; idle sessions expire */
+    uint16_t frames;
+    uint16_t next;          /* next first-time frame */
+    uint16_t nak[BULK_READ_NAK_MAX];
+    uint8_t nak_head;
+    uint8_t nak_count;
+    uint8_t active;
+    int port;
+} g_bulk;
+
+static void handle_bulk_read_begin(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)len;
+    uint32_t addr = load_be32(&p[0]);
+    uint32_t n = load_be32(&p[4]);
+    uint32_t frames = (n + BULK_READ_CHUNK - 1u) / BULK_READ_CHUNK;
+    if (n == 0u || frames > 0xFFFFu || addr + n < addr)
     {
-        uint8_t buf[COMM_MAX_PAYLOAD];
-        spi_flash_read(addr, buf, n);
-        send_frame_port(g_last_rx_port, cmd | 0x80, buf, n);
+        send_status(cmd, CMD_STATUS_BAD_ARG);
         return;
     }
-    if (addr >= SPIM_FLASH_MAP_BASE && addr < SPIM_FLASH_MAP_LIMIT)
+    g_bulk.addr = addr;
+    g_bulk.len = n;
+    g_bulk.frames = (uint16_t)frames;
+    g_bulk.next = 0u;
+    g_bulk.nak_head = 0u;
+    g_bulk.nak_count = 0u;
+    g_bulk.last_ms = g_ms;
+    g_bulk.port = g_last_rx_port;
+    g_bulk.active = 1u;
+
+    uint8_t out[4];
+    out[0] = CMD_STATUS_OK;
+    store_be16(&out[1], g_bulk.frames);
+    out[3] = BULK_READ_CHUNK;
+    send_frame_port(g_last_rx_port, cmd | 0x80u, out, sizeof(out));
+}
+
+static void handle_bulk_read_nak(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    /* {seq[2] x k} re-sends those frames; empty payload aborts. */
+    if (!g_bulk.active || (len & 1u) || len > 2u * BULK_READ_NAK_MAX)
     {
-        uint8_t buf[COMM_MAX_PAYLOAD];
-        spi_flash_read(addr - SPIM_FLASH_MAP_BASE, buf, n);
-        send_frame_port(g_last_rx_port, cmd | 0x80, buf, n);
+        send_status(cmd, g_bulk.active ? CMD_STATUS_BAD_PAYLOAD : CMD_STATUS_BAD_ARG);
         return;
     }
-
-    const uint8_t *ptr = (const uint8_t *)(uintptr_t)addr;
-    send_frame_port(g_last_rx_port, cmd | 0x80, ptr, n);
+    if (len == 0u)
+    {
+        g_bulk.active = 0u;
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    for (uint8_t i = 0; i < len; i += 2u)
+    {
+        uint16_t seq = load_be16(&p[i]);
+        if (seq >= g_bulk.next || g_bulk.nak_count >= BULK_READ_NAK_MAX)
+            continue;
+        g_bulk.nak[(g_bulk.nak_head + g_bulk.nak_count) % BULK_READ_NAK_MAX] = seq;
+        g_bulk.nak_count++;
+    }
+    g_bulk.last_ms = g_ms;
 }
 
-static void handle_set_bootloader_flag(uint8_t cmd)
+void bulk_read_tick(void)
 {
-    if (g_boot_phase == BOOT_PHASE_APP && !config_change_guard(cmd))
+    if (!g_bulk.active)
+        return;
+    if (g_bulk.next >= g_bulk.frames && g_bulk.nak_count == 0u)
+    {
+        if ((uint32_t)(g_ms - g_bulk.last_ms) >= BULK_READ_IDLE_MS)
+            g_bulk.active = 0u;
         return;
+    }
+
+    for (uint8_t k = 0; k < BULK_READ_FRAMES_PER_TICK; ++k)
+    {
+        uint16_t seq;
+        if (g_bulk.nak_count)
+            seq = g_bulk.nak[g_bulk.nak_head];
+        else if (g_bulk.next < g_bulk.frames)
+            seq = g_bulk.next;
+        else
+            break;
+        uint32_t off = (uint32_t)seq * BULK_READ_CHUNK;
+        uint8_t n = (g_bulk.len - off < BULK_READ_CHUNK) ? (uint8_t)(g_bulk.len - off)
+                                                          : (uint8_t)BULK_READ_CHUNK;
+        /* Paced by the TX ring: wait for room rather than block the loop. */
+        if (comm_tx_free(g_bulk.port) < (uint16_t)(n + 2u + 4u))
+            break;
+        if (g_bulk.nak_count)
+        {
+            g_bulk.nak_head = (uint8_t)((g_bulk.nak_head + 1u) % BULK_READ_NAK_MAX);
+            g_bulk.nak_count--;
+        }
+        else
+        {
+            g_bulk.next++;
+        }
+
+        uint8_t out[COMM_MAX_PAYLOAD];
+        store_be16(&out[0], seq);
+        const uint8_t *src = flash_read_view(g_bulk.addr + off, &out[2], n);
+        for (uint8_t i = 0; src != &out[2] && i < n; ++i)
+            out[2u + i] = src[i];
+        send_frame_port(g_bulk.port, BULK_READ_DATA_CMD, out, (uint8_t)(n + 2u));
+    }
+    g_bulk.last_ms = g_ms;
+}
+
+static void handle_set_bootloader_flag(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)p;
+    (void)len;
     /* Mirror stock behavior: set g_bootloader_mode_flag (SPI flash) so OEM bootloader stays in update mode. */
     spi_flash_set_bootloader_mode_flag();
     send_status(cmd, CMD_STATUS_OK);
 }
 
-static void handle_state_dump(uint8_t cmd)
+static void handle_state_dump(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
+    state_snapshot_t snap;
+    (void)state_snapshot_read(&snap);
+    const motor_state_t *m = &snap.motor;
     uint8_t out[16];
     out[0] = (g_ms >> 24) & 0xFF;
     out[1] = (g_ms >> 16) & 0xFF;
     out[2] = (g_ms >> 8) & 0xFF;
     out[3] = g_ms & 0xFF;
-    out[4] = g_motor.rpm >> 8;
-    out[5] = g_motor.rpm & 0xFF;
-    out[6] = g_motor.torque_raw >> 8;
-    out[7] = g_motor.torque_raw & 0xFF;
-    out[8] = g_motor.speed_dmph >> 8;
-    out[9] = g_motor.speed_dmph & 0xFF;
-    out[10] = g_motor.soc_pct;
-    out[11] = g_motor.err;
-    out[12] = (g_motor.last_ms >> 8) & 0xFF;
-    out[13] = g_motor.last_ms & 0xFF;
+    out[4] = m->rpm >> 8;
+    out[5] = m->rpm & 0xFF;
+    out[6] = m->torque_raw >> 8;
+    out[7] = m->torque_raw & 0xFF;
+    out[8] = m->speed_dmph >> 8;
+    out[9] = m->speed_dmph & 0xFF;
+    out[10] = m->soc_pct;
+    out[11] = m->err;
+    out[12] = (m->last_ms >> 8) & 0xFF;
+    out[13] = m->last_ms & 0xFF;
     out[14] = 0;
     out[15] = 0;
     send_frame_port(g_last_rx_port, cmd | 0x80, out, 16);
@@ -382,31 +549,38 @@ static void handle_state_dump(uint8_t cmd)
 #define DEBUG_STATE_MIN_SIZE 28
 
 
-static void handle_debug_state_v2(uint8_t cmd)
+static void handle_debug_state_v2(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
+    state_snapshot_t snap;
+    (void)state_snapshot_read(&snap);
+    const debug_inputs_t *in = &snap.inputs;
+    const debug_outputs_t *o = &snap.outputs;
+    const power_policy_state_t *pp = &snap.policy;
     uint8_t out[DEBUG_STATE_V2_SIZE];
     for (size_t i = 0; i < DEBUG_STATE_V2_SIZE; ++i)
         out[i] = 0;
     out[0] = DEBUG_STATE_VERSION;
     out[1] = DEBUG_STATE_V2_SIZE;
     store_be32(&out[2], g_ms);
-    store_be32(&out[6], g_inputs.last_ms);
-    store_be16(&out[10], g_inputs.speed_dmph);
-    store_be16(&out[12], g_inputs.cadence_rpm);
-    store_be16(&out[14], g_inputs.torque_raw);
-    out[16] = g_inputs.throttle_pct;
-    out[17] = g_inputs.brake;
-    out[18] = g_inputs.buttons;
-    out[19] = g_outputs.assist_mode;
-    out[20] = g_outputs.profile_id;
-    out[21] = g_outputs.virtual_gear;
-    store_be16(&out[22], g_outputs.cmd_power_w);
-    store_be16(&out[24], g_outputs.cmd_current_dA);
-    out[26] = g_outputs.cruise_state;
+    store_be32(&out[6], in->last_ms);
+    store_be16(&out[10], in->speed_dmph);
+    store_be16(&out[12], in->cadence_rpm);
+    store_be16(&out[14], in->torque_raw);
+    out[16] = in->throttle_pct;
+    out[17] = in->brake;
+    out[18] = in->buttons;
+    out[19] = o->assist_mode;
+    out[20] = o->profile_id;
+    out[21] = o->virtual_gear;
+    store_be16(&out[22], o->cmd_power_w);
+    store_be16(&out[24], o->cmd_current_dA);
+    out[26] = o->cruise_state;
     out[27] = g_adapt.eco_clamp_active ? 1u : 0u;
     /* Profile caps for simulator assertions */
-    const assist_profile_t *p = &g_profiles[g_outputs.profile_id];
-    store_be16(&out[28], p->cap_power_w);
+    const assist_profile_t *prof = &g_profiles[o->profile_id];
+    store_be16(&out[28], prof->cap_power_w);
     store_be16(&out[30], g_effective_cap_current_dA);
     store_be16(&out[32], g_effective_cap_speed_dmph);
     /* Curve-derived internal values (optional assertions) */
@@ -418,24 +592,24 @@ static void handle_debug_state_v2(uint8_t cmd)
     store_be16(&out[40], g_gear_limit_power_w);
     store_be16(&out[42], g_gear_scale_q15);
     store_be16(&out[44], g_cadence_bias_q15);
-    out[46] = (uint8_t)g_walk_state;
+    out[46] = snap.walk_state;
     store_be16(&out[47], g_walk_cmd_power_w);
     store_be16(&out[49], g_walk_cmd_current_dA);
     out[51] = g_config_active.mode;
     store_be16(&out[52], g_effective_cap_current_dA);
     store_be16(&out[54], g_effective_cap_speed_dmph);
     store_be16(&out[56], (uint16_t)g_adapt.speed_delta_dmph);
-    store_be16(&out[58], g_power_policy.p_user_w);
-    store_be16(&out[60], g_power_policy.p_lug_w);
-    store_be16(&out[62], g_power_policy.p_thermal_w);
-    store_be16(&out[64], g_power_policy.p_sag_w);
-    store_be16(&out[66], g_power_policy.p_final_w);
-    out[68] = g_power_policy.limit_reason;
+    store_be16(&out[58], pp->p_user_w);
+    store_be16(&out[60], pp->p_lug_w);
+    store_be16(&out[62], pp->p_thermal_w);
+    store_be16(&out[64], pp->p_sag_w);
+    store_be16(&out[66], pp->p_final_w);
+    out[68] = pp->limit_reason;
     out[69] = g_adapt.trend_active ? 1u : 0u;
-    store_be16(&out[70], g_power_policy.duty_q16);
-    store_be16(&out[72], (uint16_t)g_power_policy.i_phase_est_dA);
-    store_be16(&out[74], g_power_policy.thermal_state);
-    store_be16(&out[76], (uint16_t)g_power_policy.sag_margin_dV);
+    store_be16(&out[70], pp->duty_q16);
+    store_be16(&out[72], (uint16_t)pp->i_phase_est_dA);
+    store_be16(&out[74], pp->thermal_state);
+    store_be16(&out[76], (uint16_t)pp->sag_margin_dV);
     out[78] = g_soft_start.active ? 1u : 0u;
     out[79] = 0;
     store_be16(&out[80], g_soft_start.output_w);
@@ -455,7 +629,7 @@ static void handle_debug_state_v2(uint8_t cmd)
     store_be16(&out[106], g_config_active.boost_threshold_dA);
     store_be16(&out[108], g_config_active.boost_gain_q15);
     out[110] = g_hw_caps;
-    out[111] = regen_capable() ? 1u : 0u;
+    out[111] = (uint8_t)((regen_capable() ? 1u : 0u) | (g_regen.adaptive ? 2u : 0u));
     out[112] = g_regen.level;
     out[113] = g_regen.brake_level;
     store_be16(&out[114], g_regen.cmd_power_w);
@@ -467,8 +641,10 @@ static void handle_debug_state_v2(uint8_t cmd)
     send_frame_port(g_last_rx_port, cmd | 0x80, out, DEBUG_STATE_V2_SIZE);
 }
 
-static void handle_config_get(uint8_t cmd)
+static void handle_config_get(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     uint8_t out[CONFIG_BLOB_SIZE];
     config_store_be(out, &g_config_active);
     send_frame_port(g_last_rx_port, cmd | 0x80, out, CONFIG_BLOB_SIZE);
@@ -476,27 +652,32 @@ static void handle_config_get(uint8_t cmd)
 
 static void handle_config_stage(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < CONFIG_BLOB_SIZE)
-        return;
-    if (!config_change_guard(cmd))
-        return;
+    (void)len;
     uint8_t status = config_stage_blob(p);
     send_status(cmd, status);
 }
 
 static void handle_config_commit(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (!config_change_guard(cmd))
-        return;
     uint8_t status = config_commit_staged(p, len);
     send_status(cmd, status);
 }
 
-static void handle_ab_status(uint8_t cmd)
+static void handle_config_patch(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t status = config_patch_fields(p, len);
+    send_status(cmd, status);
+}
+
+static void handle_ab_status(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    uint8_t out[12];
+    (void)p;
+    (void)len;
+    uint8_t out[20];
+    ab_verify_status_t verify;
+    ab_update_get_verify(&verify);
     out[0] = 1;
-    out[1] = 12;
+    out[1] = (uint8_t)sizeof(out);
     out[2] = g_ab_active_slot;
     out[3] = g_ab_pending_slot;
     out[4] = g_ab_last_good_slot;
@@ -505,16 +686,89 @@ static void handle_ab_status(uint8_t cmd)
         out[5] |= 0x01u;
     if (g_ab_pending_valid)
         out[5] |= 0x02u;
+    if (verify.busy)
+        out[5] |= 0x04u;
     store_be32(&out[6], g_ab_active_build_id);
-    out[10] = 0;
-    out[11] = 0;
+    out[10] = verify.slot;
+    out[11] = verify.queued;
+    store_be32(&out[12], verify.done);
+    store_be32(&out[16], verify.total);
     send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
 }
 
-static void handle_ab_set_pending(const uint8_t *p, uint8_t len, uint8_t cmd)
+static void handle_ota_begin(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t status;
+    uint8_t format = (len >= 19u) ? p[14] : OTA_FORMAT_RAW;
+    if (format == OTA_FORMAT_LZ)
+        status = ota_begin_lz(p[0], load_be32(&p[1]), load_be32(&p[5]), load_be32(&p[9]), p[13], load_be32(&p[15]));
+    else if (format == OTA_FORMAT_DELTA && len >= 23u)
+        status = ota_begin_delta(p[0], load_be32(&p[1]), load_be32(&p[5]), load_be32(&p[9]), p[13], load_be32(&p[15]),
+                                 load_be32(&p[19]));
+    else if (format == OTA_FORMAT_RAW)
+        status = ota_begin(p[0], load_be32(&p[1]), load_be32(&p[5]), load_be32(&p[9]), p[13]);
+    else
+        status = OTA_STATUS_BAD_STREAM;
+    ota_status_t st;
+    ota_get_status(&st);
+    uint8_t out[4];
+    out[0] = status;
+    out[1] = st.window;
+    out[2] = OTA_CHUNK_MAX;
+    out[3] = st.ack_every;
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+}
+
+/* Replies only when an ack is due or the chunk was not taken, so the host
+ * can keep `window` chunks in flight. */
+static void handle_ota_chunk(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 1 || !p)
+    uint8_t status = ota_write(load_be32(&p[0]), &p[4], (uint32_t)(len - 4u));
+    if (status == OTA_STATUS_OK && !ota_ack_due())
         return;
+    ota_status_t st;
+    ota_get_status(&st);
+    uint8_t out[5];
+    out[0] = status;
+    store_be32(&out[1], st.next_offset);
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+}
+
+static void handle_ota_finish(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    send_status(cmd, ota_finish((len >= 1u) ? p[0] : 0u));
+}
+
+static void handle_ota_status(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)p;
+    (void)len;
+    ota_status_t st;
+    ota_get_status(&st);
+    uint8_t out[37];
+    out[0] = 3u;
+    out[1] = (uint8_t)sizeof(out);
+    out[2] = st.active;
+    out[3] = st.slot;
+    out[4] = st.window;
+    out[5] = st.ack_every;
+    store_be32(&out[6], st.size);
+    store_be32(&out[10], st.next_offset);
+    store_be32(&out[14], st.chunks);
+    store_be16(&out[18], st.dups);
+    store_be16(&out[20], st.gaps);
+    store_be16(&out[22], st.stalls);
+    store_be16(&out[24], st.pages);
+    out[26] = st.format;
+    store_be32(&out[27], st.image_size);
+    store_be32(&out[31], st.written);
+    store_be16(&out[35], st.busy);
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+}
+
+static void handle_ab_set_pending(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)len;
     uint8_t slot = p[0];
     uint8_t status = ab_update_set_pending(slot);
     send_status(cmd, status);
@@ -522,8 +776,6 @@ static void handle_ab_set_pending(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_set_profile(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 1)
-        return;
     uint8_t id = p[0];
     int persist = (len >= 2) ? (p[1] != 0) : 1; /* default persist */
     if (persist && !config_change_guard(cmd))
@@ -543,10 +795,6 @@ static void set_active_gear(uint8_t idx)
 
 static void handle_set_gears(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 6)
-        return;
-    if (!config_change_guard(cmd))
-        return;
     vgear_table_t t = {0};
     t.count = p[0];
     t.shape = p[1];
@@ -580,10 +828,7 @@ static void handle_set_gears(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_set_cadence_bias(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 7)
-        return;
-    if (!config_change_guard(cmd))
-        return;
+    (void)len;
     cadence_bias_t cb = g_cadence_bias;
     cb.enabled = p[0] ? 1 : 0;
     cb.target_rpm = load_be16(&p[1]);
@@ -601,10 +846,6 @@ static void handle_set_cadence_bias(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_set_drive_mode(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 1)
-        return;
-    if (!config_change_guard(cmd))
-        return;
     drive_mode_t mode = (drive_mode_t)p[0];
     if (mode > DRIVE_MODE_SPORT)
     {
@@ -640,10 +881,6 @@ static void handle_set_drive_mode(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_set_regen(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 2)
-        return;
-    if (!config_change_guard(cmd))
-        return;
     if (!regen_capable())
     {
         regen_reset();
@@ -651,40 +888,62 @@ static void handle_set_regen(const uint8_t *p, uint8_t len, uint8_t cmd)
         return;
     }
     regen_set_levels(p[0], p[1]);
+    regen_set_adaptive((len > 2u) ? (uint8_t)(p[2] & 0x01u) : 0u);
     send_status(cmd, CMD_STATUS_OK);
 }
 
 static void handle_set_hw_caps(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 1)
-        return;
-    if (!config_change_guard(cmd))
-        return;
+    (void)len;
     g_hw_caps = (uint8_t)(p[0] & (CAP_FLAG_WALK | CAP_FLAG_REGEN));
     if (!(g_hw_caps & CAP_FLAG_REGEN))
         regen_reset();
     send_status(cmd, CMD_STATUS_OK);
 }
 
-static void handle_trip_get(uint8_t cmd)
+static void handle_trip_get(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     trip_snapshot_t cur;
     trip_get_current(&cur);
 
     trip_snapshot_t last = {0};
     int has_last = trip_get_last(&last);
 
-    uint8_t out[3 + 24 + 24];
+    uint8_t out[3 + 24 + 24 + 4];
     out[0] = TRIP_VERSION;
     out[1] = (uint8_t)sizeof(out);
     out[2] = has_last ? 1u : 0u; /* flags */
     trip_snapshot_to_be(&out[3], &cur);
     trip_snapshot_to_be(&out[27], &last);
+    store_be32(&out[51], trip_get_acc()->regen_mwh);
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+}
+
+static void handle_trip_quantiles(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)p;
+    (void)len;
+    trip_quantiles_t cur;
+    trip_get_quantiles(&cur);
+
+    trip_quantiles_t last = {0};
+    int has_last = trip_get_last_quantiles(&last);
+
+    uint8_t out[3 + 2u * TRIP_QUANT_SIZE];
+    out[0] = 1u; /* version */
+    out[1] = TRIP_Q_COUNT;
+    out[2] = has_last ? 1u : 0u; /* flags */
+    trip_quantiles_to_be(&out[3], &cur);
+    trip_quantiles_to_be(&out[3 + TRIP_QUANT_SIZE], &last);
     send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
 }
 
-static void handle_trip_reset(uint8_t cmd)
+static void handle_trip_reset(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     trip_finalize_and_persist();
     send_status(cmd, CMD_STATUS_OK);
 }
@@ -716,8 +975,66 @@ static uint8_t log_read_frame(const uint8_t *p, uint8_t len, uint16_t record_siz
     return (uint8_t)(1u + got * record_size);
 }
 
-static void handle_event_log_summary(uint8_t cmd)
+static void handle_ride_log_summary(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)p;
+    (void)len;
+    ride_log_info_t info;
+    ride_log_get_info(&info);
+    /* base/bytes let 0x12 bulk_read pull the whole history in one transfer. */
+    uint8_t out[22];
+    log_summary_base(out, RIDE_LOG_VERSION, (uint8_t)sizeof(out), info.count,
+                     RIDE_LOG_CAPACITY, RIDE_LOG_RETAINED, RIDE_LOG_RECORD_SIZE);
+    store_be32(&out[10], info.next_seq);
+    store_be32(&out[14], RIDE_LOG_STORAGE_BASE);
+    store_be32(&out[18], RIDE_LOG_STORAGE_BYTES);
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+}
+
+static void handle_ride_log_read(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t out[1 + 2 * RIDE_LOG_RECORD_SIZE];
+    uint8_t out_len = log_read_frame(p, len, RIDE_LOG_RECORD_SIZE, ride_log_copy, out, 2);
+    if (!out_len)
+        return;
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, out_len);
+}
+
+#define BOOT_PROFILE_PAGE 16u
+
+static void handle_boot_profile(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t offset = len ? p[0] : 0u;
+    uint32_t kept = boot_log_count();
+    if (kept > BOOT_LOG_MAX_ENTRIES)
+        kept = BOOT_LOG_MAX_ENTRIES;
+
+    uint8_t out[4 + 12 * BOOT_PROFILE_PAGE];
+    out[0] = 1u; /* version */
+    out[1] = (uint8_t)kept;
+    out[2] = offset;
+    uint8_t n = 0u;
+    boot_log_entry_t prev = {0};
+    boot_log_entry_t e;
+    if (offset)
+        (void)boot_log_read(offset - 1u, &prev);
+    while (n < BOOT_PROFILE_PAGE && boot_log_read((uint32_t)offset + n, &e))
+    {
+        uint8_t *rec = &out[4 + 12u * n];
+        store_be32(&rec[0], e.code);
+        store_be32(&rec[4], e.us);
+        store_be32(&rec[8], (offset + n) ? e.us - prev.us : 0u);
+        prev = e;
+        n++;
+    }
+    out[3] = n;
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)(4u + 12u * n));
+}
+
+static void handle_event_log_summary(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     uint8_t out[16];
     log_summary_base(out, EVENT_LOG_VERSION, (uint8_t)sizeof(out),
                      (uint16_t)g_event_meta.count, (uint16_t)g_event_meta.capacity,
@@ -729,7 +1046,20 @@ static void handle_event_log_summary(uint8_t cmd)
 
 static void handle_event_log_read(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    uint8_t out[1 + 8 * EVENT_LOG_RECORD_SIZE];
+    uint8_t out[3 + 8 * EVENT_LOG_RECORD_SIZE];
+    if (len >= 8 && (p[3] == EVENT_LOG_SEEK_SEQ || p[3] == EVENT_LOG_SEEK_MS))
+    {
+        /* Seek form: offset is relative to the first match; reply carries the start. */
+        uint32_t start = (uint32_t)event_log_seek(p[3], load_be32(&p[4])) + load_be16(&p[0]);
+        uint8_t want = p[2];
+        if (want == 0 || want > 8u)
+            want = 8u;
+        uint8_t got = (start > 0xFFFFu) ? 0u : event_log_copy((uint16_t)start, want, &out[3]);
+        out[0] = got;
+        store_be16(&out[1], (uint16_t)(start > 0xFFFFu ? 0xFFFFu : start));
+        send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)(3u + got * EVENT_LOG_RECORD_SIZE));
+        return;
+    }
     uint8_t out_len = log_read_frame(p, len, EVENT_LOG_RECORD_SIZE, event_log_copy, out, 8);
     if (!out_len)
         return;
@@ -748,8 +1078,10 @@ static void handle_event_log_mark(const uint8_t *p, uint8_t len, uint8_t cmd)
     send_status(cmd, CMD_STATUS_OK);
 }
 
-static void handle_stream_log_summary(uint8_t cmd)
+static void handle_stream_log_summary(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     uint8_t out[18];
     log_summary_base(out, STREAM_LOG_VERSION, (uint8_t)sizeof(out),
                      (uint16_t)g_stream_meta.count, (uint16_t)g_stream_meta.capacity,
@@ -772,12 +1104,11 @@ static void handle_stream_log_read(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_stream_log_control(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 1)
-        return;
     uint8_t enable = p[0];
     if (!enable)
     {
         g_stream_log_enabled = 0;
+        stream_log_flush();
         send_status(cmd, CMD_STATUS_OK);
         return;
     }
@@ -791,21 +1122,176 @@ static void handle_stream_log_control(const uint8_t *p, uint8_t len, uint8_t cmd
     send_status(cmd, CMD_STATUS_OK);
 }
 
-static void handle_crash_dump_read(uint8_t cmd)
+static void handle_log_query(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    /* {log, mode, offset[2]} then optional type_mask[4], ms_from[4],
+     * ms_to[4], flags_mask, flags_want, every/bucket_s[2]. */
+    log_query_t q;
+    q.log = p[0];
+    q.mode = p[1];
+    q.type_mask = (len >= 8u) ? load_be32(&p[4]) : 0xFFFFFFFFu;
+    q.ms_from = (len >= 16u) ? load_be32(&p[8]) : 0u;
+    q.ms_to = (len >= 16u) ? load_be32(&p[12]) : 0xFFFFFFFFu;
+    q.flags_mask = (len >= 18u) ? p[16] : 0u;
+    q.flags_want = (len >= 18u) ? p[17] : 0u;
+    q.every = q.bucket_s = (len >= 20u) ? load_be16(&p[18]) : 0u;
+    if (q.log > LOG_QUERY_STREAM || q.mode > LOG_QUERY_BUCKETS || q.ms_from > q.ms_to)
+    {
+        send_status(cmd, CMD_STATUS_BAD_ARG);
+        return;
+    }
+
+    uint8_t out[8 + 8 * EVENT_LOG_RECORD_SIZE];
+    _Static_assert(9u + 2u * LOG_QUERY_BUCKET_COUNT <= sizeof(out), "log query reply overflow");
+    log_query_result_t res;
+    log_query_run(&q, load_be16(&p[2]), 8u, &out[8], &res);
+    out[0] = 1u; /* version */
+    out[1] = q.log;
+    out[2] = q.mode;
+    store_be16(&out[3], res.next);
+    store_be16(&out[5], res.matched);
+    uint8_t n = 7u;
+    if (q.mode == LOG_QUERY_RECORDS)
+    {
+        out[7] = res.records;
+        n = (uint8_t)(8u + res.records * EVENT_LOG_RECORD_SIZE);
+    }
+    else if (q.mode == LOG_QUERY_STATS)
+    {
+        for (uint8_t f = 0; f < LOG_QUERY_FIELDS; ++f)
+        {
+            store_be16(&out[n], res.min[f]);
+            store_be16(&out[n + 2u], res.max[f]);
+            n = (uint8_t)(n + 4u);
+        }
+    }
+    else
+    {
+        store_be16(&out[n], q.bucket_s ? q.bucket_s : 60u);
+        n = (uint8_t)(n + 2u);
+        for (uint8_t b = 0; b < LOG_QUERY_BUCKET_COUNT; ++b)
+        {
+            store_be16(&out[n], res.bucket[b]);
+            n = (uint8_t)(n + 2u);
+        }
+    }
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, n);
+}
+
+static void handle_crash_dump_read(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    uint8_t out[CRASH_DUMP_SIZE];
-    (void)crash_dump_load(out);
-    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+    /* Optional offset[2]: the dump is read in CRASH_DUMP_PAGE pieces. */
+    uint16_t offset = (len >= 2u) ? load_be16(p) : 0u;
+    if (offset >= CRASH_DUMP_SIZE)
+    {
+        send_status(cmd, CMD_STATUS_BAD_ARG);
+        return;
+    }
+    uint16_t n = (uint16_t)(CRASH_DUMP_SIZE - offset);
+    if (n > CRASH_DUMP_PAGE)
+        n = CRASH_DUMP_PAGE;
+    uint8_t out[CRASH_DUMP_PAGE];
+    (void)crash_dump_copy(offset, out, n);
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)n);
 }
 
-static void handle_crash_dump_clear(uint8_t cmd)
+static void handle_crash_dump_clear(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     crash_dump_clear_storage();
     send_status(cmd, CMD_STATUS_OK);
 }
 
-static void handle_bus_capture_summary(uint8_t cmd)
+static void handle_storage_stats(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)p;
+    (void)len;
+    uint8_t out[34];
+    spi_flash_cache_stats_t cache;
+    flash_jobs_stats_t jobs;
+    kv_stats_t kv;
+    spi_flash_cache_get_stats(&cache);
+    flash_jobs_get_stats(&jobs);
+    kv_get_stats(&kv);
+    out[0] = 1u;
+    out[1] = (uint8_t)sizeof(out);
+    store_be32(&out[2], cache.hits);
+    store_be32(&out[6], cache.misses);
+    store_be32(&out[10], cache.invalidations);
+    store_be32(&out[14], jobs.submitted);
+    store_be32(&out[18], jobs.fallbacks);
+    store_be16(&out[22], jobs.max_depth);
+    store_be32(&out[24], kv.appends);
+    store_be32(&out[28], kv.compactions);
+    store_be16(&out[32], kv.used);
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+}
+
+/* Per-region flash I/O (storage/flash_health.h), FLASH_HEALTH_ROWS regions
+ * per reply from `first`. */
+#define FLASH_HEALTH_VERSION   1u
+#define FLASH_HEALTH_ROW_BYTES 26u
+#define FLASH_HEALTH_ROWS      8u
+
+static void handle_flash_health(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t op = (len >= 1u) ? p[0] : 0u;
+    uint8_t first = (len >= 2u) ? p[1] : 0u;
+    if (op > 1u || first >= FLASH_HEALTH_REGION_COUNT)
+    {
+        send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+        return;
+    }
+    uint8_t n = (uint8_t)(FLASH_HEALTH_REGION_COUNT - first);
+    if (n > FLASH_HEALTH_ROWS)
+        n = FLASH_HEALTH_ROWS;
+    uint8_t out[4u + FLASH_HEALTH_ROWS * FLASH_HEALTH_ROW_BYTES];
+    out[0] = FLASH_HEALTH_VERSION;
+    out[1] = FLASH_HEALTH_REGION_COUNT;
+    out[2] = first;
+    out[3] = n;
+    for (uint8_t i = 0; i < n; ++i)
+    {
+        flash_health_region_t st;
+        flash_health_get((uint8_t)(first + i), &st);
+        uint8_t *r = &out[4u + FLASH_HEALTH_ROW_BYTES * i];
+        store_be32(&r[0], st.erases);
+        store_be32(&r[4], st.pages);
+        store_be32(&r[8], st.read_bytes);
+        store_be32(&r[12], st.busy_ms);
+        store_be32(&r[16], st.block_max_us);
+        store_be32(&r[20], st.life_erases);
+        store_be16(&r[24], st.remaining_permille);
+    }
+    if (op == 1u)
+        flash_health_reset();
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)(4u + n * FLASH_HEALTH_ROW_BYTES));
+}
+
+/* Lifetime counters (storage/lifetime.h), in their reported units. */
+#define LIFETIME_REPLY_VERSION 1u
+
+static void handle_lifetime(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)p;
+    (void)len;
+    lifetime_info_t info;
+    lifetime_get(&info);
+    uint8_t out[8u + 4u * LIFETIME_COUNT];
+    out[0] = LIFETIME_REPLY_VERSION;
+    out[1] = LIFETIME_COUNT;
+    store_be32(&out[2], info.seq);
+    store_be16(&out[6], info.used_max);
+    for (uint8_t i = 0; i < LIFETIME_COUNT; ++i)
+        store_be32(&out[8u + 4u * i], info.value[i]);
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+}
+
+static void handle_bus_capture_summary(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     uint8_t out[14];
     bus_capture_state_t state;
     bus_capture_get_state(&state);
@@ -813,7 +1299,7 @@ static void handle_bus_capture_summary(uint8_t cmd)
     out[1] = (uint8_t)sizeof(out);
     store_be16(&out[2], state.count);
     store_be16(&out[4], state.capacity);
-    store_be16(&out[6], state.head);
+    store_be16(&out[6], state.used);
     out[8] = BUS_CAPTURE_MAX_DATA;
     out[9] = state.enabled ? 1u : 0u;
     store_be32(&out[10], state.seq);
@@ -822,8 +1308,7 @@ static void handle_bus_capture_summary(uint8_t cmd)
 
 static void handle_bus_capture_read(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 3)
-        return;
+    (void)len;
     uint16_t offset = load_be16(&p[0]);
     uint8_t want = p[2];
     if (want == 0 || want > 8)
@@ -839,11 +1324,13 @@ static void handle_bus_capture_read(const uint8_t *p, uint8_t len, uint8_t cmd)
     {
         uint16_t available = (uint16_t)(state.count - offset);
         uint8_t n = (available < want) ? (uint8_t)available : want;
+        bus_capture_cursor_t cur = {0};
+        bus_capture_cursor_seek(&cur, state.seq - state.count + offset);
 
         for (uint8_t i = 0; i < n; ++i)
         {
             bus_capture_record_t rec;
-            if (!bus_capture_get_record((uint16_t)(offset + i), &rec))
+            if (!bus_capture_cursor_next(&cur, &rec))
                 break;
             uint8_t rec_len = (uint8_t)(4u + rec.len);
             if ((pos + rec_len) > sizeof(out))
@@ -864,8 +1351,6 @@ static void handle_bus_capture_read(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_bus_capture_control(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 1)
-        return;
     uint8_t enable = p[0] ? 1u : 0u;
     uint8_t reset = 0;
     if (len >= 2)
@@ -876,8 +1361,6 @@ static void handle_bus_capture_control(const uint8_t *p, uint8_t len, uint8_t cm
 
 static void handle_bus_capture_inject(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 4)
-        return;
     uint8_t bus_id = p[0];
     uint16_t dt_ms = load_be16(&p[1]);
     uint8_t payload_len = p[3];
@@ -921,8 +1404,6 @@ static void handle_bus_capture_inject(const uint8_t *p, uint8_t len, uint8_t cmd
 
 static void handle_bus_ui_control(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 1)
-        return;
     uint8_t flags = p[0];
     bus_ui_state_t state;
     bus_ui_get_state(&state);
@@ -938,8 +1419,6 @@ static void handle_bus_ui_control(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_bus_inject_arm(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 1)
-        return;
     uint8_t armed = p[0] ? 1u : 0u;
     uint8_t override_flags = (len >= 2 && p[1]) ? (uint8_t)p[1] : 0u;
     bus_inject_set_armed(armed, override_flags);
@@ -948,8 +1427,6 @@ static void handle_bus_inject_arm(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_bus_capture_replay(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 1)
-        return;
     uint8_t mode = p[0];
     if (mode == 0)
     {
@@ -964,6 +1441,11 @@ static void handle_bus_capture_replay(const uint8_t *p, uint8_t len, uint8_t cmd
     }
     uint8_t offset = p[1];
     uint16_t rate_ms = load_be16(&p[2]);
+    if (mode > BUS_REPLAY_MODE_FLASH)
+    {
+        send_status(cmd, BUS_INJECT_STATUS_BAD_PAYLOAD);
+        return;
+    }
     if (!bus_capture_get_enabled())
     {
         bus_inject_log(BUS_INJECT_EVENT_BLOCKED_CAPTURE | BUS_INJECT_EVENT_REPLAY);
@@ -986,78 +1468,618 @@ static void handle_bus_capture_replay(const uint8_t *p, uint8_t len, uint8_t cmd
             send_status(cmd, BUS_INJECT_STATUS_BAD_RANGE);
         return;
     }
-    if (rate_ms < BUS_REPLAY_RATE_MIN_MS || rate_ms > BUS_REPLAY_RATE_MAX_MS)
+    /* Fixed mode: rate_ms is the period. Timed modes: rate_ms caps idle gaps (0 = default). */
+    if (mode == BUS_REPLAY_MODE_FIXED && (rate_ms < BUS_REPLAY_RATE_MIN_MS || rate_ms > BUS_REPLAY_RATE_MAX_MS))
     {
         send_status(cmd, BUS_INJECT_STATUS_BAD_RANGE);
         return;
     }
+    if (!bus_replay_start(mode, offset, rate_ms))
+    {
+        send_status(cmd, BUS_REPLAY_STATUS_NO_IMAGE);
+        return;
+    }
     bus_inject_log((uint8_t)(BUS_INJECT_EVENT_OK | BUS_INJECT_EVENT_REPLAY));
-    bus_replay_start(offset, rate_ms);
     send_status(cmd, CMD_STATUS_OK);
 }
 
-static void handle_set_state(const uint8_t *p, uint8_t len, uint8_t cmd)
+static void handle_bus_replay_upload(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 8)
+    uint8_t op = p[0];
+    if (op == 3u)
+    {
+        bus_replay_store_info_t info;
+        bus_replay_store_get_info(&info);
+        uint8_t out[18];
+        out[0] = BUS_REPLAY_STORE_VERSION;
+        out[1] = (uint8_t)sizeof(out);
+        out[2] = info.valid;
+        out[3] = info.uploading;
+        store_be16(&out[4], info.records);
+        store_be32(&out[6], info.bytes);
+        store_be32(&out[10], info.crc32);
+        store_be32(&out[14], info.write_offset);
+        send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
         return;
-    g_motor.rpm        = ((uint16_t)p[0] << 8) | p[1];
-    g_motor.torque_raw = ((uint16_t)p[2] << 8) | p[3];
-    g_motor.speed_dmph = ((uint16_t)p[4] << 8) | p[5];
-    g_motor.soc_pct    = p[6];
-    g_motor.err        = p[7];
-    g_motor.last_ms    = g_ms;
-    speed_rb_push(g_motor.speed_dmph);
-
-    /* Mirror inputs into debug model (with optional extended fields). */
-    g_inputs.speed_dmph   = g_motor.speed_dmph;
-    g_inputs.torque_raw   = g_motor.torque_raw;
-    g_inputs.cadence_rpm  = 0;
-    g_inputs.power_w      = 0;
-    g_inputs.battery_dV   = 0;
-    g_inputs.battery_dA   = 0;
-    g_inputs.ctrl_temp_dC = 0;
-    g_inputs.throttle_pct = 0;
-    g_inputs.brake        = 0;
-    g_inputs.buttons      = 0;
-    g_inputs.last_ms      = g_ms;
-    g_input_caps          = 0;
-
-    if (len >= 10)
-        g_inputs.cadence_rpm = ((uint16_t)p[8] << 8) | p[9];
-    if (len >= 11)
-        g_inputs.throttle_pct = p[10];
-    if (len >= 12)
-        g_inputs.brake = p[11];
-    if (len >= 13)
-        g_inputs.buttons = p[12];
-    if (len >= 15)
-        g_inputs.power_w = ((uint16_t)p[13] << 8) | p[14];
-    if (len >= 17)
+    }
+    /* Sector erases stall the main loop; keep uploads to a stationary bike. */
+    if (!config_change_guard(cmd))
+        return;
+    if (op == 0u)
     {
-        g_inputs.battery_dV = (int16_t)(((uint16_t)p[15] << 8) | p[16]);
-        g_input_caps |= INPUT_CAP_BATT_V;
+        bus_replay_store_begin();
+        send_status(cmd, CMD_STATUS_OK);
+        return;
     }
-    if (len >= 19)
+    if (op == 1u)
     {
-        g_inputs.battery_dA = (int16_t)(((uint16_t)p[17] << 8) | p[18]);
-        g_input_caps |= INPUT_CAP_BATT_I;
+        if (len < 6u)
+        {
+            send_status(cmd, BUS_INJECT_STATUS_BAD_PAYLOAD);
+            return;
+        }
+        uint32_t offset = load_be32(&p[1]);
+        if (!bus_replay_store_write(offset, &p[5], (uint32_t)(len - 5u)))
+        {
+            send_status(cmd, BUS_REPLAY_STATUS_BAD_OFFSET);
+            return;
+        }
+        send_status(cmd, CMD_STATUS_OK);
+        return;
     }
-    if (len >= 21)
+    if (op == 2u)
     {
-        g_inputs.ctrl_temp_dC = (int16_t)(((uint16_t)p[19] << 8) | p[20]);
-        g_input_caps |= INPUT_CAP_TEMP;
+        if (len < 9u)
+        {
+            send_status(cmd, BUS_INJECT_STATUS_BAD_PAYLOAD);
+            return;
+        }
+        if (!bus_replay_store_finish(load_be32(&p[1]), load_be32(&p[5])))
+        {
+            send_status(cmd, BUS_REPLAY_STATUS_BAD_IMAGE);
+            return;
+        }
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    send_status(cmd, BUS_INJECT_STATUS_BAD_PAYLOAD);
+}
+
+/* Session recorder: start/stop/status. Like the trigger recording, the
+ * session is read back with bulk_read from the region base. */
+static void handle_bus_session(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)len;
+    uint8_t op = p[0];
+    if (op == 2u)
+    {
+        bus_session_info_t info;
+        bus_session_get_info(&info);
+        uint8_t out[30];
+        out[0] = BUS_SESSION_VERSION;
+        out[1] = (uint8_t)sizeof(out);
+        out[2] = info.state;
+        out[3] = info.flags;
+        store_be32(&out[4], info.records);
+        store_be32(&out[8], info.bytes);
+        store_be16(&out[12], info.dropped);
+        store_be32(&out[14], info.start_ms);
+        store_be32(&out[18], info.duration_ms);
+        store_be32(&out[22], BUS_SESSION_STORAGE_BASE);
+        store_be32(&out[26], BUS_SESSION_STORAGE_BYTES);
+        send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+        return;
+    }
+    if (op == 1u || op == 0u)
+    {
+        if (op == 0u)
+            bus_session_start();
+        else
+            bus_session_stop();
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    send_status(cmd, BUS_INJECT_STATUS_BAD_PAYLOAD);
+}
+
+/* Trigger recorder: arm/stop/status. The recording itself is read back
+ * from flash with bulk_read at the region base given in the status. */
+static void handle_bus_trigger(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t op = p[0];
+    if (op == 2u)
+    {
+        bus_trigger_info_t info;
+        bus_trigger_get_info(&info);
+        uint8_t out[26];
+        out[0] = BUS_TRIGGER_VERSION;
+        out[1] = (uint8_t)sizeof(out);
+        out[2] = info.state;
+        out[3] = 0u;
+        store_be16(&out[4], info.records);
+        store_be16(&out[6], info.trigger_index);
+        store_be16(&out[8], info.dropped);
+        store_be32(&out[10], info.bytes);
+        store_be32(&out[14], info.trigger_ms);
+        store_be32(&out[18], BUS_TRIGGER_STORAGE_BASE);
+        store_be32(&out[22], BUS_TRIGGER_STORAGE_BYTES);
+        send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+        return;
+    }
+    if (op == 1u)
+    {
+        bus_trigger_stop();
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    if (op == 0u)
+    {
+        if (len < 11u)
+        {
+            send_status(cmd, BUS_INJECT_STATUS_BAD_PAYLOAD);
+            return;
+        }
+        bus_trigger_cfg_t cfg;
+        cfg.flags = p[1];
+        cfg.bus_id = p[2];
+        cfg.opcode = p[3];
+        cfg.byte_off = p[4];
+        cfg.byte_mask = p[5];
+        cfg.byte_val = p[6];
+        cfg.pre = load_be16(&p[7]);
+        cfg.post = load_be16(&p[9]);
+        bus_trigger_arm(&cfg);
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    send_status(cmd, BUS_INJECT_STATUS_BAD_PAYLOAD);
+}
+
+/* Boot splash frame: same begin/write/finish/info ops as the replay upload. */
+static void handle_splash_upload(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t op = p[0];
+    if (op == 3u)
+    {
+        splash_info_t info;
+        splash_get_info(&info);
+        uint8_t out[16];
+        out[0] = SPLASH_VERSION;
+        out[1] = (uint8_t)sizeof(out);
+        out[2] = info.valid;
+        out[3] = info.uploading;
+        store_be16(&out[4], info.w);
+        store_be16(&out[6], info.h);
+        store_be32(&out[8], info.crc32);
+        store_be32(&out[12], info.write_offset);
+        send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+        return;
+    }
+    /* Sector erases stall the main loop; keep uploads to a stationary bike. */
+    if (!config_change_guard(cmd))
+        return;
+    if (op == 0u)
+    {
+        splash_store_begin();
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    if (op == 1u)
+    {
+        if (len < 6u)
+        {
+            send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+            return;
+        }
+        if (!splash_store_write(load_be32(&p[1]), &p[5], (uint32_t)(len - 5u)))
+        {
+            send_status(cmd, CMD_STATUS_BAD_ARG);
+            return;
+        }
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    if (op == 2u)
+    {
+        if (len < 9u)
+        {
+            send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+            return;
+        }
+        if (!splash_store_finish(load_be16(&p[1]), load_be16(&p[3]), load_be32(&p[5])))
+        {
+            send_status(cmd, CMD_STATUS_BAD);
+            return;
+        }
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+}
+
+/* UI asset pack (storage/ui_assets.h): the splash upload ops; finish takes
+ * the body size and CRC and checks the index before committing. */
+static void handle_asset_upload(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t op = p[0];
+    if (op == 3u)
+    {
+        ui_assets_info_t info;
+        ui_assets_get_info(&info);
+        uint8_t out[18];
+        out[0] = UI_ASSET_VERSION;
+        out[1] = (uint8_t)sizeof(out);
+        out[2] = info.valid;
+        out[3] = info.uploading;
+        store_be16(&out[4], info.count);
+        store_be32(&out[6], info.bytes);
+        store_be32(&out[10], info.crc32);
+        store_be32(&out[14], info.write_offset);
+        send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+        return;
+    }
+    if (!config_change_guard(cmd))
+        return;
+    if (op == 0u)
+    {
+        ui_assets_store_begin();
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    if (op == 1u)
+    {
+        if (len < 6u)
+        {
+            send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+            return;
+        }
+        if (!ui_assets_store_write(load_be32(&p[1]), &p[5], (uint32_t)(len - 5u)))
+        {
+            send_status(cmd, CMD_STATUS_BAD_ARG);
+            return;
+        }
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    if (op == 2u)
+    {
+        if (len < 9u)
+        {
+            send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+            return;
+        }
+        if (!ui_assets_store_finish(load_be32(&p[1]), load_be32(&p[5])))
+        {
+            send_status(cmd, CMD_STATUS_BAD);
+            return;
+        }
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+}
+
+#define PROFILE_BUNDLE_READ_MAX 128u
+
+/* Profile bundle (src/profiles/profile_bundle.h): the splash upload ops into
+ * a RAM stage, finish applies and stores the whole image at once; op 4 reads
+ * the active tables back as an image, op 5 returns to the built-in ones. */
+static void handle_profile_bundle(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t op = p[0];
+    if (op == 3u)
+    {
+        profile_bundle_info_t info;
+        profile_bundle_get_info(&info);
+        uint8_t out[14];
+        out[0] = PROFILE_BUNDLE_VERSION;
+        out[1] = (uint8_t)sizeof(out);
+        out[2] = info.stored;
+        out[3] = info.uploading;
+        store_be16(&out[4], info.bytes);
+        store_be32(&out[6], info.crc32);
+        store_be32(&out[10], info.write_offset);
+        send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+        return;
+    }
+    if (op == 4u)
+    {
+        if (len < 3u)
+        {
+            send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+            return;
+        }
+        uint8_t out[3 + PROFILE_BUNDLE_READ_MAX];
+        uint16_t offset = load_be16(&p[1]);
+        int n = profile_bundle_export_read(offset, &out[3], PROFILE_BUNDLE_READ_MAX);
+        if (n < 0)
+        {
+            send_status(cmd, CMD_STATUS_BAD_ARG);
+            return;
+        }
+        out[0] = CMD_STATUS_OK;
+        store_be16(&out[1], offset);
+        send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)(3 + n));
+        return;
+    }
+    /* Applying swaps the tables under the control loop; keep it to a
+     * stationary bike. */
+    if (!config_change_guard(cmd))
+        return;
+    if (op == 0u)
+    {
+        profile_bundle_upload_begin();
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    if (op == 1u)
+    {
+        if (len < 6u)
+        {
+            send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+            return;
+        }
+        if (!profile_bundle_upload_write(load_be32(&p[1]), &p[5], (uint32_t)(len - 5u)))
+        {
+            send_status(cmd, CMD_STATUS_BAD_ARG);
+            return;
+        }
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    if (op == 2u)
+    {
+        send_status(cmd, profile_bundle_upload_finish() ? CMD_STATUS_OK : CMD_STATUS_BAD);
+        return;
+    }
+    if (op == 5u)
+    {
+        profile_bundle_clear();
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+}
+
+#define PC_PROFILE_VERSION 1u
+#define PC_PROFILE_HEADER_BYTES 17u
+#define PC_PROFILE_READ_MAX ((COMM_MAX_PAYLOAD - PC_PROFILE_HEADER_BYTES) / 8u)
+
+/* Sampling profiler: start at a rate, stop, and drain samples while it runs. */
+static void handle_pc_profile(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t op = p[0];
+    if (op == 0u)
+    {
+        if (len < 3u)
+        {
+            send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+            return;
+        }
+        pc_sample_start(load_be16(&p[1]));
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    if (op == 1u)
+    {
+        pc_sample_stop();
+        send_status(cmd, CMD_STATUS_OK);
+        return;
+    }
+    if (op != 2u)
+    {
+        send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+        return;
+    }
+    uint8_t want = (len >= 2u) ? p[1] : 0u;
+    if (want == 0u || want > PC_PROFILE_READ_MAX)
+        want = PC_PROFILE_READ_MAX;
+    pc_sample_t samples[PC_PROFILE_READ_MAX];
+    uint8_t n = (uint8_t)pc_sample_read(samples, want);
+    pc_sample_stats_t st;
+    pc_sample_get_stats(&st);
+
+    uint8_t out[PC_PROFILE_HEADER_BYTES + PC_PROFILE_READ_MAX * 8u];
+    out[0] = PC_PROFILE_VERSION;
+    out[1] = st.running;
+    store_be16(&out[2], st.rate_hz);
+    store_be16(&out[4], st.pending);
+    store_be16(&out[6], st.capacity);
+    store_be32(&out[8], st.total);
+    store_be32(&out[12], st.dropped);
+    out[16] = n;
+    for (uint8_t i = 0; i < n; ++i)
+    {
+        store_be32(&out[PC_PROFILE_HEADER_BYTES + 8u * i], samples[i].pc);
+        store_be32(&out[PC_PROFILE_HEADER_BYTES + 8u * i + 4u], samples[i].lr);
+    }
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)(PC_PROFILE_HEADER_BYTES + 8u * n));
+}
+
+#define IRQ_STATS_VERSION 1u
+#define IRQ_STATS_RECORD_BYTES 14u
+
+static uint16_t irq_stats_us(uint32_t cycles)
+{
+    uint32_t us = platform_cycles_to_us(cycles);
+    return (uint16_t)((us > 0xFFFFu) ? 0xFFFFu : us);
+}
+
+/* op 0 (or none) reads the worst cases per IRQ source, op 1 reads then
+ * starts a new window. */
+static void handle_irq_stats(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t op = (len >= 1u) ? p[0] : 0u;
+    if (op > 1u)
+    {
+        send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+        return;
+    }
+    uint8_t out[2u + PLATFORM_IRQ_SRC_COUNT * IRQ_STATS_RECORD_BYTES];
+    out[0] = IRQ_STATS_VERSION;
+    out[1] = PLATFORM_IRQ_SRC_COUNT;
+    for (uint8_t i = 0; i < PLATFORM_IRQ_SRC_COUNT; ++i)
+    {
+        platform_irq_stats_t st;
+        platform_irq_load_stats(i, &st);
+        uint8_t *r = &out[2u + IRQ_STATS_RECORD_BYTES * i];
+        store_be32(&r[0], st.count);
+        store_be32(&r[4], st.late_count);
+        store_be16(&r[8], irq_stats_us(st.late_max));
+        store_be16(&r[10], irq_stats_us(st.own_max));
+        store_be16(&r[12], irq_stats_us(st.total_max));
+    }
+    if (op == 1u)
+        platform_irq_load_reset_stats();
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+}
+
+/* Remote framebuffer: the compositor's tiles as they change on the panel,
+ * sent unrequested as UI_STREAM_DATA_CMD frames as the TX queue drains. */
+#define UI_STREAM_DATA_CMD        0x9Au
+#define UI_STREAM_HDR_BYTES       12u
+#define UI_STREAM_FRAMES_PER_TICK 2u
+#define UI_STREAM_VERSION         1u
+
+static struct {
+    uint8_t active;
+    int port;
+    uint16_t seq;
+    uint32_t frames;
+    uint32_t bytes;
+} g_ui_stream;
+
+static void handle_ui_stream(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t op = (len >= 1u) ? p[0] : 2u;
+    if (op == 0u)
+    {
+        g_ui_stream.active = 0u;
+        send_status(cmd, CMD_STATUS_OK);
+    }
+    else if (op == 1u)
+    {
+        /* (Re)start: the whole screen is pending, seq counts from 0. */
+        if (!ui_lcd_remote_available())
+        {
+            send_status(cmd, CMD_STATUS_BAD);
+            return;
+        }
+        ui_lcd_remote_refresh();
+        g_ui_stream.active = 1u;
+        g_ui_stream.port = g_last_rx_port;
+        g_ui_stream.seq = 0u;
+        g_ui_stream.frames = 0u;
+        g_ui_stream.bytes = 0u;
+        send_status(cmd, CMD_STATUS_OK);
+    }
+    else if (op == 2u)
+    {
+        uint8_t out[13];
+        out[0] = UI_STREAM_VERSION;
+        out[1] = g_ui_stream.active;
+        out[2] = ui_lcd_remote_available();
+        store_be16(&out[3], ui_lcd_remote_pending());
+        store_be32(&out[5], g_ui_stream.frames);
+        store_be32(&out[9], g_ui_stream.bytes);
+        send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+    }
+    else
+    {
+        send_status(cmd, CMD_STATUS_BAD_ARG);
+    }
+}
+
+void ui_stream_tick(void)
+{
+    if (!g_ui_stream.active)
+        return;
+    for (uint8_t k = 0; k < UI_STREAM_FRAMES_PER_TICK; ++k)
+    {
+        /* Room for a full frame, so the encoder never has to be undone. */
+        if (comm_tx_free(g_ui_stream.port) < (uint16_t)(COMM_MAX_PAYLOAD + 4u))
+            break;
+        uint8_t out[COMM_MAX_PAYLOAD];
+        ui_fb8_remote_chunk_t c;
+        uint16_t n = ui_lcd_remote_next(&c, &out[UI_STREAM_HDR_BYTES],
+                                        (uint16_t)(COMM_MAX_PAYLOAD - UI_STREAM_HDR_BYTES));
+        if (n == 0u)
+            break;
+        store_be16(&out[0], g_ui_stream.seq++);
+        store_be16(&out[2], c.x);
+        store_be16(&out[4], c.y);
+        store_be16(&out[6], c.w);
+        store_be16(&out[8], c.h);
+        store_be16(&out[10], c.pos);
+        send_frame_port(g_ui_stream.port, UI_STREAM_DATA_CMD, out, (uint8_t)(UI_STREAM_HDR_BYTES + n));
+        g_ui_stream.frames++;
+        g_ui_stream.bytes += UI_STREAM_HDR_BYTES + n;
+    }
+}
+
+static void handle_set_state(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    g_motor.rpm        = ((uint16_t)p[0] << 8) | p[1];
+    g_motor.torque_raw = ((uint16_t)p[2] << 8) | p[3];
+    g_motor.speed_dmph = ((uint16_t)p[4] << 8) | p[5];
+    g_motor.soc_pct    = p[6];
+    g_motor.err        = p[7];
+    g_motor.last_ms    = g_ms;
+    speed_rb_push(g_motor.speed_dmph);
+
+    /* Mirror inputs into debug model (with optional extended fields). */
+    g_inputs.speed_dmph   = g_motor.speed_dmph;
+    g_inputs.torque_raw   = g_motor.torque_raw;
+    g_inputs.cadence_rpm  = 0;
+    g_inputs.power_w      = 0;
+    g_inputs.battery_dV   = 0;
+    g_inputs.battery_dA   = 0;
+    g_inputs.ctrl_temp_dC = 0;
+    g_inputs.throttle_pct = 0;
+    g_inputs.brake        = 0;
+    g_inputs.buttons      = 0;
+    g_inputs.last_ms      = g_ms;
+    g_input_caps          = 0;
+
+    if (len >= 10)
+        g_inputs.cadence_rpm = ((uint16_t)p[8] << 8) | p[9];
+    if (len >= 11)
+        g_inputs.throttle_pct = p[10];
+    if (len >= 12)
+        g_inputs.brake = p[11];
+    if (len >= 13)
+        g_inputs.buttons = p[12];
+    if (len >= 15)
+        g_inputs.power_w = ((uint16_t)p[13] << 8) | p[14];
+    if (len >= 17)
+    {
+        g_inputs.battery_dV = (int16_t)(((uint16_t)p[15] << 8) | p[16]);
+        g_input_caps |= INPUT_CAP_BATT_V;
+    }
+    if (len >= 19)
+    {
+        g_inputs.battery_dA = (int16_t)(((uint16_t)p[17] << 8) | p[18]);
+        g_input_caps |= INPUT_CAP_BATT_I;
+    }
+    if (len >= 21)
+    {
+        g_inputs.ctrl_temp_dC = (int16_t)(((uint16_t)p[19] << 8) | p[20]);
+        g_input_caps |= INPUT_CAP_TEMP;
     }
 
     g_inputs_debug_last_ms = g_ms;
     process_buttons(g_inputs.buttons);
+    app_dispatch_events();
     app_apply_inputs();
 
     send_status(cmd, CMD_STATUS_OK);
 
 }
 
-static void handle_speed_rb_summary(uint8_t cmd)
+static void handle_speed_rb_summary(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     ringbuf_i16_summary_t s;
     speed_rb_summary(&s);
     uint8_t out[10];
@@ -1074,11 +2096,23 @@ static void handle_speed_rb_summary(uint8_t cmd)
     send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
 }
 
-static void handle_graph_summary(uint8_t cmd)
+static void handle_graph_summary(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
     graph_summary_t summary;
-    graph_get_active_summary(&summary);
-    uint8_t out[14];
+    if (len >= 3u)
+    {
+        /* Any window: {channel, window_s[2]}. */
+        if (!graph_get_summary(p[0], (uint32_t)load_be16(&p[1]) * 1000u, &summary))
+        {
+            send_status(cmd, CMD_STATUS_BAD_ARG);
+            return;
+        }
+    }
+    else
+    {
+        graph_get_active_summary(&summary);
+    }
+    uint8_t out[18];
     store_be16(&out[0], summary.summary.count);
     store_be16(&out[2], summary.summary.capacity);
     store_be16(&out[4], (uint16_t)summary.summary.min);
@@ -1086,28 +2120,200 @@ static void handle_graph_summary(uint8_t cmd)
     store_be16(&out[8], (uint16_t)summary.summary.latest);
     store_be16(&out[10], summary.period_ms);
     store_be16(&out[12], summary.window_ms);
+    store_be16(&out[14], (uint16_t)summary.mean);
+    store_be16(&out[16], summary.window_s);
     send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
 }
 
-static void handle_motor_uart2_raw_tx(const uint8_t *p, uint8_t len, uint8_t cmd)
+/*
+ * Graph export: every closed pyramid cell of the selected channels and
+ * levels, sent unrequested as GRAPH_EXPORT_DATA_CMD frames as the TX queue
+ * drains, one (channel, level) after the other, oldest cell first. Each
+ * frame's cells are zigzag varint deltas of {min, max, mean} against the
+ * previous cell, the first against zeros, so frames decode on their own.
+ */
+#define GRAPH_EXPORT_DATA_CMD        0x9Bu
+#define GRAPH_EXPORT_HDR_BYTES       9u
+#define GRAPH_EXPORT_CELL_MAX        9u /* three 17-bit zigzag varints */
+#define GRAPH_EXPORT_BATCH           16u
+#define GRAPH_EXPORT_FRAMES_PER_TICK 2u
+#define GRAPH_EXPORT_VERSION         1u
+#define GRAPH_EXPORT_END             0xFFu
+
+static struct {
+    uint8_t active;
+    int port;
+    uint8_t channel_mask;
+    uint8_t level_mask;
+    uint8_t channel;
+    uint8_t level;
+    uint8_t open;           /* cursor/end hold the current pair's range */
+    uint16_t seq;
+    uint32_t cursor;
+    uint32_t end;           /* head when the pair started; later cells wait */
+} g_graph_export;
+
+static uint8_t *graph_export_put(uint8_t *p, int32_t delta)
+{
+    uint32_t v = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+    while (v >= 0x80u)
+    {
+        *p++ = (uint8_t)(v | 0x80u);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+/* Moves to the next selected pair with cells left; 0 when all are sent. */
+static int graph_export_next(void)
 {
-    if (!p || len == 0u)
+    uint8_t channels;
+    uint8_t levels;
+    graph_get_layout(&channels, &levels, NULL);
+    while (g_graph_export.channel < channels)
     {
-        send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+        if ((g_graph_export.channel_mask & (1u << g_graph_export.channel)) &&
+            (g_graph_export.level_mask & (1u << g_graph_export.level)))
+        {
+            if (!g_graph_export.open)
+            {
+                pyramid_cell_t c;
+                (void)graph_get_cells(g_graph_export.channel, g_graph_export.level, 0u, 0u, &c,
+                                      &g_graph_export.cursor, &g_graph_export.end);
+                g_graph_export.open = 1u;
+            }
+            if (g_graph_export.cursor < g_graph_export.end)
+                return 1;
+        }
+        g_graph_export.open = 0u;
+        if (++g_graph_export.level >= levels)
+        {
+            g_graph_export.level = 0u;
+            g_graph_export.channel++;
+        }
+    }
+    return 0;
+}
+
+static void handle_graph_export(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t op = (len >= 1u) ? p[0] : 1u;
+    if (op == 0u)
+    {
+        g_graph_export.active = 0u;
+        send_status(cmd, CMD_STATUS_OK);
         return;
     }
-    /* motor_isr_queue_frame() buffers up to MOTOR_ISR_TX_MAX bytes for TX. */
-    if (len > (uint8_t)MOTOR_ISR_TX_MAX)
+    uint8_t channel_mask = (len >= 2u) ? p[1] : 0xFFu;
+    uint8_t level_mask = (len >= 3u) ? p[2] : 0xFFu;
+    if (op != 1u || channel_mask == 0u || level_mask == 0u)
     {
         send_status(cmd, CMD_STATUS_BAD_ARG);
         return;
     }
+    /* A new export replaces the running one; seq counts from 0. */
+    g_graph_export.active = 1u;
+    g_graph_export.port = g_last_rx_port;
+    g_graph_export.channel_mask = channel_mask;
+    g_graph_export.level_mask = level_mask;
+    g_graph_export.channel = 0u;
+    g_graph_export.level = 0u;
+    g_graph_export.open = 0u;
+    g_graph_export.seq = 0u;
+
+    uint8_t channels;
+    uint8_t levels;
+    uint16_t cells;
+    graph_get_layout(&channels, &levels, &cells);
+    uint8_t out[6u + 4u * 8u];
+    out[0] = CMD_STATUS_OK;
+    out[1] = GRAPH_EXPORT_VERSION;
+    out[2] = channels;
+    out[3] = levels;
+    store_be16(&out[4], cells);
+    for (uint8_t i = 0; i < levels && i < 8u; ++i)
+        store_be32(&out[6u + 4u * i], graph_get_period_ms(i));
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)(6u + 4u * ((levels < 8u) ? levels : 8u)));
+}
+
+void graph_export_tick(void)
+{
+    if (!g_graph_export.active)
+        return;
+    for (uint8_t k = 0; k < GRAPH_EXPORT_FRAMES_PER_TICK; ++k)
+    {
+        if (comm_tx_free(g_graph_export.port) < (uint16_t)(COMM_MAX_PAYLOAD + 4u))
+            break;
+        uint8_t out[COMM_MAX_PAYLOAD];
+        store_be16(&out[0], g_graph_export.seq++);
+        if (!graph_export_next())
+        {
+            /* End marker: seq is the number of data frames before it. */
+            out[2] = GRAPH_EXPORT_END;
+            out[3] = GRAPH_EXPORT_END;
+            store_be32(&out[4], 0u);
+            out[8] = 0u;
+            send_frame_port(g_graph_export.port, GRAPH_EXPORT_DATA_CMD, out, GRAPH_EXPORT_HDR_BYTES);
+            g_graph_export.active = 0u;
+            break;
+        }
+
+        uint8_t *w = &out[GRAPH_EXPORT_HDR_BYTES];
+        const uint8_t *limit = &out[COMM_MAX_PAYLOAD - GRAPH_EXPORT_CELL_MAX];
+        pyramid_cell_t prev = {0, 0, 0};
+        uint32_t first = g_graph_export.cursor;
+        uint8_t n = 0u;
+        uint8_t started = 0u;
+        while (w <= limit && g_graph_export.cursor < g_graph_export.end)
+        {
+            pyramid_cell_t batch[GRAPH_EXPORT_BATCH];
+            uint32_t from;
+            uint32_t left = g_graph_export.end - g_graph_export.cursor;
+            uint16_t got = graph_get_cells(g_graph_export.channel, g_graph_export.level,
+                                           g_graph_export.cursor,
+                                           (uint16_t)((left < GRAPH_EXPORT_BATCH) ? left : GRAPH_EXPORT_BATCH),
+                                           batch, &from, NULL);
+            /* Cells the ring dropped since the pair started are skipped. */
+            if (!started)
+                first = from;
+            else if (from != g_graph_export.cursor)
+                break;
+            started = 1u;
+            g_graph_export.cursor = from;
+            if (got == 0u)
+            {
+                g_graph_export.cursor = g_graph_export.end;
+                break;
+            }
+            for (uint16_t i = 0; i < got && w <= limit; ++i)
+            {
+                w = graph_export_put(w, (int32_t)batch[i].min - prev.min);
+                w = graph_export_put(w, (int32_t)batch[i].max - prev.max);
+                w = graph_export_put(w, (int32_t)batch[i].mean - prev.mean);
+                prev = batch[i];
+                g_graph_export.cursor++;
+                n++;
+            }
+        }
+        out[2] = g_graph_export.channel;
+        out[3] = g_graph_export.level;
+        store_be32(&out[4], first);
+        out[8] = n;
+        send_frame_port(g_graph_export.port, GRAPH_EXPORT_DATA_CMD, out, (uint8_t)(w - out));
+    }
+}
+
+static void handle_motor_uart2_raw_tx(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
     uint8_t ok = motor_isr_queue_frame(p, len) ? 1u : 0u;
     send_status(cmd, ok ? CMD_STATUS_OK : CMD_STATUS_BAD);
 }
 
-static void handle_motor_last_frame(uint8_t cmd)
+static void handle_motor_last_frame(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     uint8_t frame[SHENGYI_MAX_FRAME_SIZE];
     uint8_t frame_len = 0u;
     uint8_t frame_op = 0u;
@@ -1140,8 +2346,7 @@ static void handle_motor_last_frame(uint8_t cmd)
 
 static void handle_motor_proto_set(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (!p || len < 1u)
-        return;
+    (void)len;
     motor_link_mode_t mode = (motor_link_mode_t)p[0];
     if (mode > MOTOR_LINK_MODE_FORCE_V2)
     {
@@ -1152,8 +2357,10 @@ static void handle_motor_proto_set(const uint8_t *p, uint8_t len, uint8_t cmd)
     send_status(cmd, CMD_STATUS_OK);
 }
 
-static void handle_motor_proto_get(uint8_t cmd)
+static void handle_motor_proto_get(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     motor_link_mode_t mode = motor_link_get_mode();
     motor_proto_t active = motor_link_get_active_proto();
     uint8_t locked = motor_link_is_locked();
@@ -1192,12 +2399,11 @@ static void motor_stx02_opts_apply_u8(uint8_t opts)
     /* Keep RAM copy self-consistent even when not persisting. */
     g_config_active.crc32 = 0;
     g_config_active.crc32 = config_crc_expected(&g_config_active);
+    motor_link_apply_config();
 }
 
 static void handle_motor_stx02_opts_set(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (!p || len < 1u)
-        return;
     uint8_t opts = p[0];
     int persist = (len >= 2u) ? (p[1] != 0u) : 1; /* default persist */
 
@@ -1216,8 +2422,10 @@ static void handle_motor_stx02_opts_set(const uint8_t *p, uint8_t len, uint8_t c
     send_status(cmd, CMD_STATUS_OK);
 }
 
-static void handle_motor_stx02_opts_get(uint8_t cmd)
+static void handle_motor_stx02_opts_get(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
+    (void)p;
+    (void)len;
     uint8_t out[3];
     out[0] = motor_stx02_opts_pack_u8();
     uint16_t r = g_config_active.reserved;
@@ -1228,8 +2436,6 @@ static void handle_motor_stx02_opts_get(uint8_t cmd)
 
 static void handle_graph_control(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 2)
-        return;
     uint8_t channel = p[0];
     uint8_t window = p[1];
     uint8_t reset = (len >= 3 && (p[2] & 0x01u)) ? 1u : 0u;
@@ -1241,22 +2447,280 @@ static void handle_graph_control(const uint8_t *p, uint8_t len, uint8_t cmd)
     send_status(cmd, CMD_STATUS_OK);
 }
 
+#define UI_PERF_REPLY_VERSION 2u
+#define UI_PERF_FLAG_RESET 0x01u
+
+static void handle_ui_perf(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t page = (len >= 1u) ? p[0] : UI_PERF_PAGE_ALL;
+    uint8_t flags = (len >= 2u) ? p[1] : 0u;
+    if (page != UI_PERF_PAGE_ALL && page >= UI_PERF_PAGES)
+    {
+        send_status(cmd, CMD_STATUS_BAD_ARG);
+        return;
+    }
+
+    ui_perf_screen_t s;
+    ui_perf_screen_get(&g_ui.perf, page, &s);
+    uint8_t out[2u + 16u + 2u * UI_PERF_HIST_BUCKETS + 12u * UI_PERF_PRIM_COUNT + 6u];
+    uint8_t *w = out;
+    w[0] = UI_PERF_REPLY_VERSION;
+    w[1] = page;
+    w += 2;
+    store_be32(&w[0], s.frames);
+    store_be32(&w[4], s.last_us);
+    store_be32(&w[8], s.max_us);
+    store_be32(&w[12], s.frames ? (s.total_us / s.frames) : 0u);
+    w += 16;
+    for (uint8_t i = 0; i < UI_PERF_HIST_BUCKETS; ++i, w += 2)
+        store_be16(w, s.hist[i]);
+    for (uint8_t i = 0; i < UI_PERF_PRIM_COUNT; ++i, w += 12)
+    {
+        const ui_perf_prim_stat_t *ps = &g_ui.perf.prims[i];
+        store_be32(&w[0], ps->calls);
+        store_be32(&w[4], ps->last_us);
+        store_be32(&w[8], ps->total_us);
+    }
+    store_be32(&w[0], g_ui.perf.culled);
+    store_be16(&w[4], g_ui.perf.last_culled);
+    if (flags & UI_PERF_FLAG_RESET)
+        ui_perf_reset(&g_ui.perf);
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+}
+
+#define MOTOR_HEALTH_REPLY_VERSION 1u
+#define MOTOR_HEALTH_FLAG_RESET 0x01u
+#define MOTOR_HEALTH_HDR_LEN 42u
+#define MOTOR_HEALTH_OP_LEN (8u + 2u * MOTOR_HEALTH_JITTER_BUCKETS)
+
+static void handle_motor_health(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t flags = (len >= 1u) ? p[0] : 0u;
+    const motor_health_t *h = motor_health_get();
+
+    uint8_t out[MOTOR_HEALTH_HDR_LEN + MOTOR_HEALTH_OP_SLOTS * MOTOR_HEALTH_OP_LEN];
+    uint8_t *w = out;
+    w[0] = MOTOR_HEALTH_REPLY_VERSION;
+    w[1] = h->op_count;
+    store_be32(&w[2], h->crc_errors);
+    store_be32(&w[6], h->framing_errors);
+    store_be32(&w[10], h->timeouts);
+    store_be32(&w[14], h->parse_errors);
+    store_be32(&w[18], h->other_errors);
+    store_be32(&w[22], h->untracked_frames);
+    store_be16(&w[26], h->outages);
+    store_be32(&w[28], motor_health_down_ms(g_ms));
+    store_be32(&w[32], h->outage_last_ms);
+    store_be32(&w[36], h->outage_max_ms);
+    /* Total seconds down keeps the header at 42 bytes. */
+    store_be16(&w[40], clamp_u16(h->outage_total_ms / 1000u, 0u, 0xFFFFu));
+    w += MOTOR_HEALTH_HDR_LEN;
+    for (uint8_t i = 0; i < h->op_count; ++i, w += MOTOR_HEALTH_OP_LEN)
+    {
+        const motor_health_op_t *op = &h->ops[i];
+        w[0] = op->proto;
+        w[1] = op->op;
+        store_be32(&w[2], op->frames);
+        store_be16(&w[6], motor_health_rate_x10(op));
+        for (uint8_t b = 0; b < MOTOR_HEALTH_JITTER_BUCKETS; ++b)
+            store_be16(&w[8u + 2u * b], op->jitter_hist[b]);
+    }
+    uint8_t n = (uint8_t)(w - out);
+    if (flags & MOTOR_HEALTH_FLAG_RESET)
+        motor_health_reset();
+    send_frame_port(g_last_rx_port, cmd | 0x80u, out, n);
+}
+
+static void handle_sched_stats(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t slot = (len >= 1u) ? p[0] : 0u;
+    uint8_t flags = (len >= 2u) ? p[1] : 0u;
+    scheduler_stats_t st;
+    if (!scheduler_get_stats(slot, &st))
+    {
+        send_status(cmd, CMD_STATUS_BAD_ARG);
+        return;
+    }
+    app_control_stats_t ctrl;
+    app_control_get_stats(&ctrl);
+    clock_profile_stats_t clk;
+    clock_profile_get_stats(&clk);
+    uint8_t out[4u + 7u * 4u + SCHED_HIST_BUCKETS * 2u + 14u + 5u * 4u + 13u];
+    out[0] = 1u;
+    out[1] = slot;
+    out[2] = scheduler_is_registered(slot) ? 1u : 0u;
+    out[3] = scheduler_is_suspended(slot) ? 1u : 0u;
+    store_be32(&out[4], st.runs);
+    store_be32(&out[8], st.runs ? st.min_us : 0u);
+    store_be32(&out[12], st.max_us);
+    store_be32(&out[16], st.ewma_us);
+    store_be32(&out[20], st.last_us);
+    store_be32(&out[24], st.overruns);
+    store_be32(&out[28], st.late);
+    for (uint8_t b = 0; b < SCHED_HIST_BUCKETS; ++b)
+        store_be16(&out[32u + 2u * b], st.hist[b]);
+    store_be16(&out[64], app_idle_permille());
+    store_be32(&out[66], app_idle_sleeps());
+    store_be32(&out[70], scheduler_get_budget_stops());
+    store_be32(&out[74], st.skipped);
+    store_be32(&out[78], ctrl.runs);
+    store_be32(&out[82], ctrl.deferred);
+    store_be32(&out[86], ctrl.lat_last_us);
+    store_be32(&out[90], ctrl.lat_avg_us);
+    store_be32(&out[94], ctrl.lat_max_us);
+    out[98] = clock_profile_current();
+    store_be32(&out[99], clk.to_low);
+    store_be32(&out[103], clk.to_full);
+    store_be32(&out[107], clk.low_ms);
+    if (flags & 0x01u)
+        scheduler_reset_max_exec_time(slot);
+    send_frame_port(g_last_rx_port, cmd | 0x80u, out, (uint8_t)sizeof(out));
+}
+
+static void handle_input_latency(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t flags = len ? p[0] : 0u;
+    input_latency_stats_t st;
+    input_latency_get(&st);
+    uint8_t out[2u + 3u * 4u + INPUT_LAT_STAGE_COUNT * 8u];
+    out[0] = 1u; /* version */
+    out[1] = (uint8_t)INPUT_LAT_STAGE_COUNT;
+    store_be32(&out[2], st.edges);
+    store_be32(&out[6], st.presses);
+    store_be32(&out[10], st.preempts);
+    for (uint8_t i = 0; i < INPUT_LAT_STAGE_COUNT; ++i)
+    {
+        store_be32(&out[14u + 8u * i], st.last_us[i]);
+        store_be32(&out[18u + 8u * i], st.max_us[i]);
+    }
+    if (flags & 0x01u)
+        input_latency_reset();
+    send_frame_port(g_last_rx_port, cmd | 0x80u, out, (uint8_t)sizeof(out));
+}
+
+static void handle_watchdog_stats(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t flags = len ? p[0] : 0u;
+    watchdog_stats_t st;
+    watchdog_get_stats(&st);
+    /* Margin left at the worst gap: how close the firmware came to a reset. */
+    uint32_t period_us = st.timeout_ms * 1000u;
+    uint32_t margin_us = (st.max_gap_us < period_us) ? period_us - st.max_gap_us : 0u;
+    uint8_t out[29];
+    out[0] = 1u; /* version */
+    store_be32(&out[1], st.timeout_ms);
+    store_be32(&out[5], st.feeds);
+    store_be32(&out[9], st.max_gap_us);
+    store_be32(&out[13], margin_us);
+    store_be32(&out[17], st.budgets);
+    store_be32(&out[21], st.overruns);
+    store_be32(&out[25], st.max_budget_us);
+    if (flags & 0x01u)
+        watchdog_reset_stats();
+    send_frame_port(g_last_rx_port, cmd | 0x80u, out, (uint8_t)sizeof(out));
+}
+
+static void handle_event_stats(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t lane = (len >= 1u) ? p[0] : 0u;
+    uint8_t flags = (len >= 2u) ? p[1] : 0u;
+    event_lane_stats_t st;
+    if (!event_bus_lane_stats(&g_event_bus, lane, &st))
+    {
+        send_status(cmd, CMD_STATUS_BAD_ARG);
+        return;
+    }
+    work_queue_stats_t wq;
+    work_queue_get_stats(&wq);
+    uint8_t out[4u + 6u * 4u + EVENT_LAT_BUCKETS * 2u + 14u];
+    out[0] = 1u;
+    out[1] = lane;
+    out[2] = (uint8_t)event_queue_count(&g_event_bus.lanes[lane]);
+    out[3] = (uint8_t)(EVENT_QUEUE_CAPACITY - 1u);
+    store_be32(&out[4], st.published);
+    store_be32(&out[8], st.dispatched);
+    store_be32(&out[12], st.queue.drops);
+    store_be32(&out[16], st.queue.hwm);
+    store_be32(&out[20], st.queue.lat_max_ms);
+    store_be32(&out[24], st.queue.lat_count ? st.queue.lat_sum_ms / st.queue.lat_count : 0u);
+    for (uint8_t b = 0; b < EVENT_LAT_BUCKETS; ++b)
+        store_be16(&out[28u + 2u * b], st.queue.lat_hist[b]);
+    store_be32(&out[36], wq.posted);
+    store_be32(&out[40], wq.runs);
+    store_be32(&out[44], wq.drops);
+    store_be16(&out[48], wq.hwm);
+    if (flags & 0x01u)
+    {
+        event_bus_reset_lane_stats(&g_event_bus, lane);
+        work_queue_reset_stats();
+    }
+    send_frame_port(g_last_rx_port, cmd | 0x80u, out, (uint8_t)sizeof(out));
+}
+
+static void handle_ram_stats(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)p;
+    (void)len;
+    ram_stats_t st;
+    platform_ram_get_stats(&st);
+    overlay_stats_t ov;
+    platform_overlay_get_stats(&ov);
+    uint8_t out[4u + 12u * 4u];
+    out[0] = 3u;
+    out[1] = st.ext_flags;
+    store_be16(&out[2], 0u);
+    store_be32(&out[4], st.sram_bytes);
+    store_be32(&out[8], st.data_bytes);
+    store_be32(&out[12], st.bss_bytes);
+    store_be32(&out[16], st.stack_bytes);
+    store_be32(&out[20], st.stack_peak);
+    store_be32(&out[24], st.stack_boot_peak);
+    store_be32(&out[28], st.stack_now);
+    store_be32(&out[32], st.ext_used);
+    store_be32(&out[36], st.ramfunc_bytes);
+    /* v2: the shared overlay arena. */
+    store_be32(&out[40], OVERLAY_ARENA_BYTES);
+    store_be32(&out[44], ov.conflicts);
+    /* v3: .noinit, which Reset_Handler neither copies nor zeroes. */
+    store_be32(&out[48], st.noinit_bytes);
+    send_frame_port(g_last_rx_port, cmd | 0x80u, out, (uint8_t)sizeof(out));
+}
+
+#define RAM_EXT_CONFIG_KEY 0x5A3Cu
+
+static void handle_ram_ext_config(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)len;
+    /* Rewrites the MCU option bytes: explicit key (length, motion and rate
+     * are checked by the dispatch table). */
+    if (load_be16(&p[1]) != RAM_EXT_CONFIG_KEY || p[0] > 1u)
+    {
+        send_status(cmd, CMD_STATUS_BAD_ARG);
+        return;
+    }
+    send_status(cmd, platform_ram_ext_configure(p[0]));
+}
+
 static void fill_state_frame(comm_state_frame_t *state)
 {
     if (!state)
         return;
+    state_snapshot_t snap;
+    (void)state_snapshot_read(&snap);
+    const debug_inputs_t *in = &snap.inputs;
+    const debug_outputs_t *o = &snap.outputs;
     state->ms = g_ms;
-    state->speed_dmph = g_inputs.speed_dmph;
-    state->cadence_rpm = g_inputs.cadence_rpm;
-    state->power_w = g_inputs.power_w;
-    state->batt_dV = g_inputs.battery_dV;
-    state->batt_dA = g_inputs.battery_dA;
-    state->ctrl_temp_dC = g_inputs.ctrl_temp_dC;
-    state->assist_mode = g_outputs.assist_mode;
-    state->profile_id = g_outputs.profile_id;
-    state->virtual_gear = g_outputs.virtual_gear;
-    state->flags = (g_inputs.brake ? 0x01u : 0u) |
-                   ((g_walk_state == WALK_STATE_ACTIVE) ? 0x02u : 0u);
+    state->speed_dmph = in->speed_dmph;
+    state->cadence_rpm = in->cadence_rpm;
+    state->power_w = in->power_w;
+    state->batt_dV = in->battery_dV;
+    state->batt_dA = in->battery_dA;
+    state->ctrl_temp_dC = in->ctrl_temp_dC;
+    state->assist_mode = o->assist_mode;
+    state->profile_id = o->profile_id;
+    state->virtual_gear = o->virtual_gear;
+    state->flags = (in->brake ? 0x01u : 0u) |
+                   ((snap.walk_state == WALK_STATE_ACTIVE) ? 0x02u : 0u);
 }
 
 void send_state_frame_bin(void)
@@ -1267,9 +2731,165 @@ void send_state_frame_bin(void)
     uint8_t len = comm_state_frame_build_v1(out, (uint8_t)sizeof(out), &state);
     if (!len)
         return;
+    /* Streaming yields to replies: drop this sample if the port is backed up. */
+    if (comm_tx_free(g_last_rx_port) < (uint16_t)(len + 4u))
+        return;
     send_frame_port(g_last_rx_port, 0x81, out, len); /* streaming telemetry frame */
 }
 
+/* Telemetry stream v2 (0x11 subscribe, 0x91 frames); see tlm_stream.h. */
+#define TLM_STREAM_FRAME_CMD 0x91u
+
+#define TLM_STREAM_SUB_F_US 0x01u /* subscribe flag: frames stamped in device us */
+
+static tlm_stream_t g_tlm_stream;
+static int g_tlm_stream_port;
+static uint8_t g_tlm_stream_flags;
+
+static void fill_tlm_sample(tlm_sample_t *s)
+{
+    s->v[TLM_F_SPEED_DMPH] = g_inputs.speed_dmph;
+    s->v[TLM_F_CADENCE_RPM] = g_inputs.cadence_rpm;
+    s->v[TLM_F_POWER_W] = g_inputs.power_w;
+    s->v[TLM_F_TORQUE_RAW] = g_motor.torque_raw;
+    s->v[TLM_F_BATT_DA] = (uint16_t)g_inputs.battery_dA;
+    s->v[TLM_F_CMD_POWER_W] = g_outputs.cmd_power_w;
+    s->v[TLM_F_CMD_CURRENT_DA] = g_outputs.cmd_current_dA;
+    s->v[TLM_F_MOTOR_RPM] = g_motor.rpm;
+    s->v[TLM_F_BATT_DV] = (uint16_t)g_inputs.battery_dV;
+    s->v[TLM_F_CTRL_TEMP_DC] = (uint16_t)g_inputs.ctrl_temp_dC;
+    s->v[TLM_F_SOC_PCT] = g_motor.soc_pct;
+    s->v[TLM_F_ASSIST_MODE] = g_outputs.assist_mode;
+    s->v[TLM_F_PROFILE_ID] = g_outputs.profile_id;
+    s->v[TLM_F_VIRTUAL_GEAR] = g_outputs.virtual_gear;
+    s->v[TLM_F_FLAGS] = (g_inputs.brake ? 0x01u : 0u) |
+                        ((g_walk_state == WALK_STATE_ACTIVE) ? 0x02u : 0u);
+    s->v[TLM_F_ERR] = g_motor.err;
+}
+
+void send_telemetry_v2(void)
+{
+    if (!g_tlm_stream.mask)
+        return;
+    /* Leave room on the port for replies; tlm_stream retries what did not fit. */
+    uint16_t room = comm_tx_free(g_tlm_stream_port);
+    room = (room > 4u) ? (uint16_t)(room - 4u) : 0u;
+    uint8_t cap = (room > TLM_STREAM_MAX_LEN) ? (uint8_t)TLM_STREAM_MAX_LEN : (uint8_t)room;
+    tlm_sample_t sample;
+    fill_tlm_sample(&sample);
+    uint8_t out[TLM_STREAM_MAX_LEN];
+    uint8_t len = tlm_stream_poll(&g_tlm_stream, g_ms, &sample, out, cap);
+    if (!len)
+        return;
+    if (g_tlm_stream_flags & TLM_STREAM_SUB_F_US)
+        tlm_stream_stamp_us(out, platform_time_us());
+    send_frame_port(g_tlm_stream_port, TLM_STREAM_FRAME_CMD, out, len);
+}
+
+static void handle_stream_v2(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    /* {mask[2]} with default rates, or {mask[2], fast[2], slow[2], state[2], key[2], flags[1]?} */
+    uint16_t period[TLM_GROUP_COUNT] = { 100u, 1000u, 250u };
+    uint16_t key_ms = TLM_KEYFRAME_DEF_MS;
+    if (len != 2u && len < 10u)
+    {
+        send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+        return;
+    }
+    if (len >= 10u)
+    {
+        for (uint8_t g = 0; g < TLM_GROUP_COUNT; ++g)
+            period[g] = load_be16(&p[2u + 2u * g]);
+        key_ms = load_be16(&p[8]);
+    }
+    g_tlm_stream_flags = (len >= 11u) ? p[10] : 0u;
+    g_tlm_stream_port = g_last_rx_port;
+    tlm_stream_configure(&g_tlm_stream, load_be16(&p[0]), period, key_ms);
+    send_status(cmd, CMD_STATUS_OK);
+}
+
+/* ble_hacker telemetry notifications, batched into 0xF0 writes. */
+#define BLE_NOTIFY_CMD         (CMD_ID_BLE_HACKER | 0x80u)
+#define BLE_NOTIFY_DEADLINE_MS 20u
+#define BLE_NOTIFY_MIN_MS      10u
+
+static struct {
+    ble_hacker_batch_t batch;
+    uint16_t period_ms;         /* 0 = not subscribed */
+    uint32_t last_ms;
+    int port;
+    uint8_t was_connected;
+} g_ble_notify;
+
+/* Notifications on the BLE port need a central; a disconnect ends the
+ * subscription. Other ports deliver as long as they are subscribed. */
+static uint8_t ble_notify_link_up(void)
+{
+    if (g_ble_notify.port != PORT_BLE)
+        return 1u;
+    uint8_t up = ble_ttm_is_connected();
+    if (g_ble_notify.was_connected && !up)
+        g_ble_notify.period_ms = 0u;
+    g_ble_notify.was_connected = up;
+    return up;
+}
+
+static uint8_t ble_notify_flush(void)
+{
+    if (!g_ble_notify.batch.count)
+        return 1u;
+    if (comm_tx_free(g_ble_notify.port) < (uint16_t)(g_ble_notify.batch.len + 4u))
+        return 0u;
+    send_frame_port(g_ble_notify.port, BLE_NOTIFY_CMD, g_ble_notify.batch.buf, g_ble_notify.batch.len);
+    ble_hacker_batch_clear(&g_ble_notify.batch);
+    return 1u;
+}
+
+void ble_hacker_notify_tick(void)
+{
+    if (!g_ble_notify.period_ms)
+        return;
+    if (!ble_notify_link_up())
+    {
+        ble_hacker_batch_clear(&g_ble_notify.batch);
+        return;
+    }
+
+    if ((uint32_t)(g_ms - g_ble_notify.last_ms) >= g_ble_notify.period_ms)
+    {
+        g_ble_notify.last_ms = g_ms;
+        uint8_t telem[COMM_STATE_FRAME_V1_LEN];
+        comm_state_frame_t state;
+        fill_state_frame(&state);
+        uint8_t tlen = comm_state_frame_build_v1(telem, (uint8_t)sizeof(telem), &state);
+        uint8_t op = (uint8_t)(BLE_HACKER_OP_TELEMETRY | BLE_HACKER_OP_RESPONSE_FLAG);
+        if (!ble_hacker_batch_add_status(&g_ble_notify.batch, op, BLE_HACKER_STATUS_OK, telem, tlen, g_ms))
+        {
+            /* Full: send what is batched; a sample that still finds no room is dropped. */
+            if (ble_notify_flush())
+                (void)ble_hacker_batch_add_status(&g_ble_notify.batch, op, BLE_HACKER_STATUS_OK,
+                                                  telem, tlen, g_ms);
+        }
+    }
+    if (ble_hacker_batch_due(&g_ble_notify.batch, g_ms))
+        (void)ble_notify_flush();
+}
+
+static uint8_t ble_hacker_subscribe(const ble_hacker_frame_t *req)
+{
+    if (req->payload_len != 2u)
+        return BLE_HACKER_STATUS_BAD_PAYLOAD;
+    uint16_t period = load_be16(req->payload);
+    if (period && period < BLE_NOTIFY_MIN_MS)
+        period = BLE_NOTIFY_MIN_MS;
+    ble_hacker_batch_init(&g_ble_notify.batch, (uint8_t)BLE_HACKER_MAX_PAYLOAD, BLE_NOTIFY_DEADLINE_MS);
+    g_ble_notify.port = g_last_rx_port;
+    g_ble_notify.was_connected = (g_last_rx_port == PORT_BLE) ? ble_ttm_is_connected() : 0u;
+    g_ble_notify.last_ms = g_ms - period;
+    g_ble_notify.period_ms = period;
+    return BLE_HACKER_STATUS_OK;
+}
+
 static void handle_ble_hacker(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
     ble_hacker_frame_t req;
@@ -1295,7 +2915,8 @@ static void handle_ble_hacker(const uint8_t *p, uint8_t len, uint8_t cmd)
         uint8_t payload[3];
         payload[0] = BLE_HACKER_VERSION;
         payload[1] = (uint8_t)BLE_HACKER_MAX_PAYLOAD;
-        payload[2] = BLE_HACKER_CAP_TELEMETRY | BLE_HACKER_CAP_CONFIG | BLE_HACKER_CAP_DEBUG;
+        payload[2] = BLE_HACKER_CAP_TELEMETRY | BLE_HACKER_CAP_CONFIG | BLE_HACKER_CAP_DEBUG |
+                     BLE_HACKER_CAP_NOTIFY;
         resp_len = ble_hacker_encode_status((uint8_t)(req.opcode | BLE_HACKER_OP_RESPONSE_FLAG),
                                             BLE_HACKER_STATUS_OK, payload, (uint8_t)sizeof(payload),
                                             out, (uint8_t)sizeof(out));
@@ -1316,6 +2937,11 @@ static void handle_ble_hacker(const uint8_t *p, uint8_t len, uint8_t cmd)
                                             out, (uint8_t)sizeof(out));
         break;
     }
+    case BLE_HACKER_OP_SUBSCRIBE:
+        resp_len = ble_hacker_encode_status((uint8_t)(req.opcode | BLE_HACKER_OP_RESPONSE_FLAG),
+                                            ble_hacker_subscribe(&req), NULL, 0,
+                                            out, (uint8_t)sizeof(out));
+        break;
     case BLE_HACKER_OP_CONFIG_GET:
     {
         uint8_t cfg[CONFIG_BLOB_SIZE];
@@ -1381,8 +3007,7 @@ static void handle_ble_hacker(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_set_stream(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 2)
-        return;
+    (void)len;
     uint16_t period = ((uint16_t)p[0] << 8) | p[1];
     g_stream_period_ms = period;
     g_last_stream_ms = g_ms;
@@ -1391,114 +3016,519 @@ static void handle_set_stream(const uint8_t *p, uint8_t len, uint8_t cmd)
 
 static void handle_set_debug_output(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (len < 1)
-        return;
+    (void)len;
     uint8_t mask = p[0];
-    mask = (uint8_t)(mask & (DEBUG_UART_TRACE_UI | DEBUG_UART_STATUS));
+    mask = (uint8_t)(mask & (DEBUG_UART_TRACE_UI | DEBUG_UART_STATUS | DEBUG_UART_BINARY));
     g_debug_uart_mask = mask;
     send_status(cmd, CMD_STATUS_OK);
 }
 
-static void handle_reboot_bootloader(uint8_t cmd)
+static void handle_reboot_bootloader(const uint8_t *p, uint8_t len, uint8_t cmd)
 {
-    if (g_boot_phase == BOOT_PHASE_APP && !config_change_guard(cmd))
-        return;
-    handle_set_bootloader_flag(cmd); /* ack + flag */
+    (void)p;
+    (void)len;
+    handle_set_bootloader_flag(p, len, cmd); /* ack + flag */
     reboot_to_bootloader();
 }
 
-int comm_handle_command(uint8_t cmd, const uint8_t *payload, uint8_t len)
+/*
+ * Command dispatch table
+ *
+ * One row per command: handler, payload length bounds, policy flags and a
+ * minimum interval between accepted calls (0 = none). comm_handle_command()
+ * indexes k_cmd_slot[] by the command byte and applies every check before
+ * the handler runs, so handlers only validate payload contents.
+ *
+ *   CMD_F_MONITOR     also served by the boot monitor (before full app init)
+ *   CMD_F_PRIVILEGED  monitor-only: refused with BAD_ARG once the app runs
+ *   CMD_F_STILL       app phase: config_change_guard() (bike stationary)
+ *   CMD_F_SLOW        reads flash: a tagged request is deferred to
+ *                     comm_tagged_tick() so quick ones answer first
+ */
+#define CMD_F_MONITOR    0x01u
+#define CMD_F_PRIVILEGED 0x02u
+#define CMD_F_STILL      0x04u
+#define CMD_F_SLOW       0x08u
+
+#define CMD_LEN_ANY COMM_MAX_PAYLOAD
+
+typedef void (*comm_cmd_fn)(const uint8_t *p, uint8_t len, uint8_t cmd);
+
+static void handle_cmd_stats(const uint8_t *p, uint8_t len, uint8_t cmd);
+static void handle_comm_stats(const uint8_t *p, uint8_t len, uint8_t cmd);
+static void handle_ble_baud(const uint8_t *p, uint8_t len, uint8_t cmd);
+static void handle_tagged(const uint8_t *p, uint8_t len, uint8_t cmd);
+static void handle_time_sync(const uint8_t *p, uint8_t len, uint8_t cmd);
+
+typedef struct {
+    comm_cmd_fn fn;
+    uint8_t id;
+    uint8_t min_len;
+    uint8_t max_len;
+    uint8_t flags;
+    uint16_t min_interval_ms;
+} comm_cmd_desc_t;
+
+/* X(id, handler, min_len, max_len, flags, min_interval_ms) */
+#define COMM_CMD_TABLE(X) \
+    X(CMD_ID_PING,                 handle_ping,                 0u, CMD_LEN_ANY, CMD_F_MONITOR, 0u) \
+    X(CMD_ID_READ32,               handle_read32,               4u, CMD_LEN_ANY, CMD_F_MONITOR, 0u) \
+    X(CMD_ID_WRITE32,              handle_write32,              8u, CMD_LEN_ANY, CMD_F_MONITOR | CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_READ_MEM,             handle_read_mem,             5u, CMD_LEN_ANY, CMD_F_MONITOR, 0u) \
+    X(CMD_ID_WRITE_MEM,            handle_write_mem,            5u, CMD_LEN_ANY, CMD_F_MONITOR | CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_EXEC,                 handle_exec,                 4u, CMD_LEN_ANY, CMD_F_MONITOR | CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_UPLOAD_EXEC,          handle_upload_exec,          5u, CMD_LEN_ANY, CMD_F_MONITOR | CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_READ_FLASH,           handle_read_flash,           5u, CMD_LEN_ANY, CMD_F_MONITOR | CMD_F_SLOW, 0u) \
+    X(CMD_ID_MONITOR,              handle_monitor_control,      0u, CMD_LEN_ANY, CMD_F_MONITOR, 0u) \
+    X(CMD_ID_STATE_DUMP,           handle_state_dump,           0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_SET_BOOTLOADER_FLAG,  handle_set_bootloader_flag,  0u, CMD_LEN_ANY, CMD_F_MONITOR | CMD_F_STILL, 1000u) \
+    X(CMD_ID_SET_STATE,            handle_set_state,            8u, CMD_LEN_ANY, CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_SET_STREAM,           handle_set_stream,           2u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_REBOOT_BOOTLOADER,    handle_reboot_bootloader,    0u, CMD_LEN_ANY, CMD_F_MONITOR | CMD_F_STILL, 0u) \
+    X(CMD_ID_SET_DEBUG_OUTPUT,     handle_set_debug_output,     1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_CMD_STATS,            handle_cmd_stats,            0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_STREAM_V2,            handle_stream_v2,            2u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_BULK_READ,            handle_bulk_read_begin,      8u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_BULK_READ_NAK,        handle_bulk_read_nak,        0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_COMM_STATS,           handle_comm_stats,           0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_BLE_BAUD,             handle_ble_baud,             0u, CMD_LEN_ANY, 0u, 0u) \
+    X(COMM_CMD_TAGGED,             handle_tagged,               2u, CMD_LEN_ANY, 0u, 0u) \
+    X(COMM_CMD_TIME_SYNC,          handle_time_sync,            4u, CMD_LEN_ANY, CMD_F_MONITOR, 0u) \
+    X(CMD_ID_SPEED_RB_SUMMARY,     handle_speed_rb_summary,     0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_DEBUG_STATE_V2,       handle_debug_state_v2,       0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_GRAPH_SUMMARY,        handle_graph_summary,        0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_GRAPH_CONTROL,        handle_graph_control,        2u, CMD_LEN_ANY, 0u, 0u) \
+    /* motor_isr_queue_frame() buffers up to MOTOR_ISR_TX_MAX bytes for TX. */ \
+    X(CMD_ID_MOTOR_UART2_RAW_TX,   handle_motor_uart2_raw_tx,   1u, MOTOR_ISR_TX_MAX, CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_MOTOR_LAST_FRAME,     handle_motor_last_frame,     0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_MOTOR_PROTO_SET,      handle_motor_proto_set,      1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_MOTOR_PROTO_GET,      handle_motor_proto_get,      0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_MOTOR_STX02_OPTS_SET, handle_motor_stx02_opts_set, 1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_MOTOR_STX02_OPTS_GET, handle_motor_stx02_opts_get, 0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_UI_PERF,              handle_ui_perf,              0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_MOTOR_HEALTH,         handle_motor_health,         0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_SCHED_STATS,          handle_sched_stats,          0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_INPUT_LATENCY,        handle_input_latency,        0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_WATCHDOG_STATS,       handle_watchdog_stats,       0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_EVENT_STATS,          handle_event_stats,          0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_RAM_STATS,            handle_ram_stats,            0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_RAM_EXT_CONFIG,       handle_ram_ext_config,       3u, CMD_LEN_ANY, CMD_F_STILL, 5000u) \
+    X(CMD_ID_CONFIG_GET,           handle_config_get,           0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_CONFIG_STAGE,         handle_config_stage,         CONFIG_BLOB_SIZE, CMD_LEN_ANY, CMD_F_STILL, 0u) \
+    X(CMD_ID_CONFIG_COMMIT,        handle_config_commit,        0u, CMD_LEN_ANY, CMD_F_STILL, 1000u) \
+    X(CMD_ID_CONFIG_PATCH,         handle_config_patch,         CONFIG_PATCH_ENTRY_BYTES, CONFIG_PATCH_ENTRY_BYTES * CONFIG_PATCH_MAX_FIELDS, CMD_F_STILL, 100u) \
+    X(CMD_ID_SET_PROFILE,          handle_set_profile,          1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_SET_GEARS,            handle_set_gears,            6u, CMD_LEN_ANY, CMD_F_STILL, 0u) \
+    X(CMD_ID_SET_CADENCE_BIAS,     handle_set_cadence_bias,     7u, CMD_LEN_ANY, CMD_F_STILL, 0u) \
+    X(CMD_ID_TRIP_GET,             handle_trip_get,             0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_TRIP_RESET,           handle_trip_reset,           0u, CMD_LEN_ANY, 0u, 1000u) \
+    X(CMD_ID_TRIP_QUANTILES,       handle_trip_quantiles,       0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_RIDE_LOG_SUMMARY,     handle_ride_log_summary,     0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_RIDE_LOG_READ,        handle_ride_log_read,        3u, CMD_LEN_ANY, CMD_F_SLOW, 0u) \
+    X(CMD_ID_BOOT_PROFILE,         handle_boot_profile,         0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_SET_DRIVE_MODE,       handle_set_drive_mode,       1u, CMD_LEN_ANY, CMD_F_STILL, 0u) \
+    X(CMD_ID_SET_REGEN,            handle_set_regen,            2u, CMD_LEN_ANY, CMD_F_STILL, 0u) \
+    X(CMD_ID_SET_HW_CAPS,          handle_set_hw_caps,          1u, CMD_LEN_ANY, CMD_F_STILL, 0u) \
+    X(CMD_ID_EVENT_LOG_SUMMARY,    handle_event_log_summary,    0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_EVENT_LOG_READ,       handle_event_log_read,       3u, CMD_LEN_ANY, CMD_F_SLOW, 0u) \
+    X(CMD_ID_EVENT_LOG_MARK,       handle_event_log_mark,       0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_STREAM_LOG_SUMMARY,   handle_stream_log_summary,   0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_STREAM_LOG_READ,      handle_stream_log_read,      3u, CMD_LEN_ANY, CMD_F_SLOW, 0u) \
+    X(CMD_ID_STREAM_LOG_CONTROL,   handle_stream_log_control,   1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_CRASH_DUMP_READ,      handle_crash_dump_read,      0u, CMD_LEN_ANY, CMD_F_SLOW, 0u) \
+    X(CMD_ID_CRASH_DUMP_CLEAR,     handle_crash_dump_clear,     0u, CMD_LEN_ANY, 0u, 1000u) \
+    X(CMD_ID_LOG_QUERY,            handle_log_query,            4u, CMD_LEN_ANY, CMD_F_SLOW, 0u) \
+    X(CMD_ID_BUS_CAPTURE_SUMMARY,  handle_bus_capture_summary,  0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_BUS_CAPTURE_READ,     handle_bus_capture_read,     3u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_BUS_CAPTURE_CONTROL,  handle_bus_capture_control,  1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_BUS_CAPTURE_INJECT,   handle_bus_capture_inject,   4u, CMD_LEN_ANY, CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_BUS_UI_CONTROL,       handle_bus_ui_control,       1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_BUS_INJECT_ARM,       handle_bus_inject_arm,       1u, CMD_LEN_ANY, CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_BUS_CAPTURE_REPLAY,   handle_bus_capture_replay,   1u, CMD_LEN_ANY, CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_BUS_REPLAY_UPLOAD,    handle_bus_replay_upload,    1u, CMD_LEN_ANY, CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_BUS_TRIGGER,          handle_bus_trigger,          1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_BUS_SESSION,          handle_bus_session,          1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_STORAGE_STATS,        handle_storage_stats,        0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_OTA_BEGIN,            handle_ota_begin,            14u, CMD_LEN_ANY, CMD_F_PRIVILEGED | CMD_F_STILL, 0u) \
+    X(CMD_ID_OTA_CHUNK,            handle_ota_chunk,            5u, CMD_LEN_ANY, CMD_F_PRIVILEGED, 0u) \
+    X(CMD_ID_OTA_FINISH,           handle_ota_finish,           0u, CMD_LEN_ANY, CMD_F_PRIVILEGED | CMD_F_STILL, 0u) \
+    X(CMD_ID_OTA_STATUS,           handle_ota_status,           0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_SPLASH_UPLOAD,        handle_splash_upload,        1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_ASSET_UPLOAD,         handle_asset_upload,         1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_PROFILE_BUNDLE,       handle_profile_bundle,       1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_PC_PROFILE,           handle_pc_profile,           1u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_IRQ_STATS,            handle_irq_stats,            0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_UI_STREAM,            handle_ui_stream,            0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_FLASH_HEALTH,         handle_flash_health,         0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_GRAPH_EXPORT,         handle_graph_export,         0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_LIFETIME,             handle_lifetime,             0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_BLE_HACKER,           handle_ble_hacker,           0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_AB_STATUS,            handle_ab_status,            0u, CMD_LEN_ANY, 0u, 0u) \
+    X(CMD_ID_AB_SET_PENDING,       handle_ab_set_pending,       1u, CMD_LEN_ANY, 0u, 1000u) \
+    X(LOG_FRAME_CMD,               handle_log_frame,            0u, CMD_LEN_ANY, CMD_F_MONITOR, 0u)
+
+enum {
+#define CMD_SLOT_ENUM(id, fn, mn, mx, fl, rt) CMD_SLOT_##id,
+    COMM_CMD_TABLE(CMD_SLOT_ENUM)
+#undef CMD_SLOT_ENUM
+    CMD_SLOT_COUNT
+};
+
+static const comm_cmd_desc_t k_cmds[CMD_SLOT_COUNT] = {
+#define CMD_DESC(id, fn, mn, mx, fl, rt) { fn, (uint8_t)(id), (uint8_t)(mn), (uint8_t)(mx), (uint8_t)(fl), (uint16_t)(rt) },
+    COMM_CMD_TABLE(CMD_DESC)
+#undef CMD_DESC
+};
+
+/* Command byte -> slot + 1 (0 = unknown). */
+static const uint8_t k_cmd_slot[256] = {
+#define CMD_SLOT_INDEX(id, fn, mn, mx, fl, rt) [id] = (uint8_t)(CMD_SLOT_##id + 1),
+    COMM_CMD_TABLE(CMD_SLOT_INDEX)
+#undef CMD_SLOT_INDEX
+};
+
+#define CMD_HIST_BUCKETS 16u
+
+typedef struct {
+    uint32_t last_ms;   /* last accepted call, for min_interval_ms */
+    uint16_t calls;     /* handler runs (saturating) */
+    uint16_t rejects;   /* refused by phase/length/motion/rate checks */
+    uint16_t max_us;    /* longest handler run, including its reply */
+    uint8_t hist[CMD_HIST_BUCKETS]; /* run time, log2 µs buckets (see cmd_hist_bucket) */
+} comm_cmd_stats_t;
+
+static comm_cmd_stats_t g_cmd_stats[CMD_SLOT_COUNT];
+
+static void cmd_stats_reject(comm_cmd_stats_t *s)
 {
-    const uint8_t *p = payload;
+    if (s->rejects != 0xFFFFu)
+        s->rejects++;
+}
 
-    /* Boot monitor gating: before full app init, only a minimal, safe command
-     * surface is allowed (peek/poke, flash reads, exec-in-RAM, reboot).
-     * Everything else is rejected with STATUS_UNSUPPORTED (0xFF). */
-    if (g_boot_phase != BOOT_PHASE_APP)
+/* Bucket 0 is < 1 µs, bucket b holds [2^(b-1), 2^b) µs, the last one the rest. */
+static uint8_t cmd_hist_bucket(uint32_t us)
+{
+    uint8_t b = 0u;
+    while (us && b < CMD_HIST_BUCKETS - 1u)
     {
-        switch (cmd)
-        {
-        case CMD_ID_PING:
-        case CMD_ID_READ32:
-        case CMD_ID_WRITE32:
-        case CMD_ID_READ_MEM:
-        case CMD_ID_WRITE_MEM:
-        case CMD_ID_EXEC:
-        case CMD_ID_UPLOAD_EXEC:
-        case CMD_ID_READ_FLASH:
-        case CMD_ID_MONITOR:
-        case CMD_ID_SET_BOOTLOADER_FLAG:
-        case CMD_ID_REBOOT_BOOTLOADER:
-        case LOG_FRAME_CMD:
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static void cmd_hist_add(comm_cmd_stats_t *s, uint32_t us)
+{
+    uint8_t b = cmd_hist_bucket(us);
+    if (s->hist[b] == 0xFFu)
+    {
+        /* Halve everything: keeps the shape, and favours recent runs. */
+        for (uint8_t i = 0; i < CMD_HIST_BUCKETS; ++i)
+            s->hist[i] = (uint8_t)(s->hist[i] >> 1);
+    }
+    s->hist[b]++;
+}
+
+/* Upper bound of the bucket holding the pct-th percentile, capped at max_us. */
+static uint16_t cmd_hist_percentile(const comm_cmd_stats_t *s, uint8_t pct)
+{
+    uint32_t total = 0u;
+    for (uint8_t i = 0; i < CMD_HIST_BUCKETS; ++i)
+        total += s->hist[i];
+    if (total == 0u)
+        return 0u;
+    uint32_t want = (total * pct + 99u) / 100u;
+    uint32_t seen = 0u;
+    uint8_t b = 0u;
+    for (; b < CMD_HIST_BUCKETS - 1u; ++b)
+    {
+        seen += s->hist[b];
+        if (seen >= want)
             break;
-        default:
-            return 0;
+    }
+    uint32_t upper = (b == 0u) ? 0u : ((1u << b) - 1u);
+    if (b == CMD_HIST_BUCKETS - 1u || upper > s->max_us)
+        upper = s->max_us;
+    return (uint16_t)upper;
+}
+
+#define CMD_STATS_VERSION 2u
+#define CMD_STATS_ENTRY_LEN 11u
+#define CMD_STATS_MAX_ENTRIES ((COMM_MAX_PAYLOAD - 4u) / CMD_STATS_ENTRY_LEN)
+
+static void handle_cmd_stats(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t start = (len >= 1u) ? p[0] : 0u;
+    uint8_t flags = (len >= 2u) ? p[1] : 0u;
+    if (start > CMD_SLOT_COUNT)
+    {
+        send_status(cmd, CMD_STATUS_BAD_ARG);
+        return;
+    }
+    uint8_t out[4u + CMD_STATS_MAX_ENTRIES * CMD_STATS_ENTRY_LEN];
+    uint8_t n = 0u;
+    uint8_t *w = &out[4];
+    for (uint8_t i = start; i < CMD_SLOT_COUNT && n < CMD_STATS_MAX_ENTRIES; ++i, ++n)
+    {
+        const comm_cmd_stats_t *s = &g_cmd_stats[i];
+        w[0] = k_cmds[i].id;
+        store_be16(&w[1], s->calls);
+        store_be16(&w[3], s->rejects);
+        store_be16(&w[5], s->max_us);
+        store_be16(&w[7], cmd_hist_percentile(s, 50u));
+        store_be16(&w[9], cmd_hist_percentile(s, 99u));
+        w += CMD_STATS_ENTRY_LEN;
+    }
+    out[0] = CMD_STATS_VERSION;
+    out[1] = (uint8_t)CMD_SLOT_COUNT;
+    out[2] = start;
+    out[3] = n;
+    if (flags & 0x01u)
+    {
+        for (uint8_t i = 0; i < CMD_SLOT_COUNT; ++i)
+        {
+            g_cmd_stats[i].calls = 0u;
+            g_cmd_stats[i].rejects = 0u;
+            g_cmd_stats[i].max_us = 0u;
+            for (uint8_t b = 0; b < CMD_HIST_BUCKETS; ++b)
+                g_cmd_stats[i].hist[b] = 0u;
         }
     }
-    else if (app_phase_privileged_cmd(cmd))
+    send_frame_port(g_last_rx_port, cmd | 0x80u, out, (uint8_t)(4u + n * CMD_STATS_ENTRY_LEN));
+}
+
+#define COMM_STATS_PORTS 3u
+#define COMM_STATS_PORT_LEN 32u
+
+/* Per-port link counters: where bytes and frames are lost, and how long
+ * writers waited on each UART. */
+static void handle_comm_stats(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint8_t flags = (len >= 1u) ? p[0] : 0u;
+    uint8_t out[2u + COMM_STATS_PORTS * COMM_STATS_PORT_LEN];
+    uint8_t *w = &out[2];
+    out[0] = 2u;
+    out[1] = (uint8_t)COMM_STATS_PORTS;
+    for (int port = 0; port < (int)COMM_STATS_PORTS; ++port)
+    {
+        comm_port_stats_t st = {0};
+        (void)comm_get_port_stats(port, &st);
+        store_be32(&w[0], st.rx_bytes);
+        store_be32(&w[4], st.frames);
+        store_be32(&w[8], st.bad);
+        store_be32(&w[12], st.rx_drops);
+        store_be32(&w[16], st.overruns);
+        store_be32(&w[20], st.tx_bytes);
+        store_be32(&w[24], st.tx_stall_us);
+        store_be32(&w[28], st.tx_drops);
+        w += COMM_STATS_PORT_LEN;
+    }
+    if (flags & 0x01u)
+        comm_reset_port_stats();
+    send_frame_port(g_last_rx_port, cmd | 0x80u, out, (uint8_t)sizeof(out));
+}
+
+#define BLE_BAUD_TIMEOUT_DEF_MS 2000u
+#define BLE_BAUD_TIMEOUT_MIN_MS 200u
+#define BLE_BAUD_TIMEOUT_MAX_MS 10000u
+
+/* Empty payload: report. {baud[4], timeout_ms[2]}: switch the BLE link; the
+ * OK goes out at the old rate, then the host confirms with a ping. */
+static void handle_ble_baud(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    if (len == 0u)
+    {
+        uint32_t baud = 0u;
+        uint32_t target = 0u;
+        uint16_t fallbacks = 0u;
+        uint8_t out[12];
+        out[0] = CMD_STATUS_OK;
+        out[1] = comm_ble_baud_state(&baud, &target, &fallbacks);
+        store_be32(&out[2], baud);
+        store_be32(&out[6], target);
+        store_be16(&out[10], fallbacks);
+        send_frame_port(g_last_rx_port, cmd | 0x80u, out, (uint8_t)sizeof(out));
+        return;
+    }
+    if (len < 4u)
+    {
+        send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+        return;
+    }
+    if (g_last_rx_port != PORT_BLE)
     {
         send_status(cmd, CMD_STATUS_BAD_ARG);
-        return 1;
+        return;
+    }
+    uint16_t timeout_ms = (len >= 6u) ? load_be16(&p[4]) : BLE_BAUD_TIMEOUT_DEF_MS;
+    if (timeout_ms < BLE_BAUD_TIMEOUT_MIN_MS)
+        timeout_ms = BLE_BAUD_TIMEOUT_MIN_MS;
+    if (timeout_ms > BLE_BAUD_TIMEOUT_MAX_MS)
+        timeout_ms = BLE_BAUD_TIMEOUT_MAX_MS;
+    int r = comm_ble_baud_request(load_be32(p), timeout_ms);
+    if (r == 0)
+        send_status(cmd, CMD_STATUS_BAD_ARG);
+    else if (r < 0)
+        send_status(cmd, CMD_STATUS_RATE_LIMITED);
+    else
+        send_status(cmd, CMD_STATUS_OK);
+}
+
+/*
+ * Tagged requests ({tag, cmd, args}, COMM_CMD_TAGGED). Quick commands run at
+ * once with their reply wrapped for the tag. CMD_F_SLOW ones wait in a small
+ * in-flight queue and run from comm_tagged_tick(), one per main-loop pass
+ * once the port has room for a full reply, so pings and state reads sent
+ * after a flash read come back before it.
+ */
+#define TAGGED_QUEUE_LEN 4u
+#define TAGGED_ARGS_MAX  20u
+
+typedef struct {
+    int port;
+    uint8_t tag;
+    uint8_t cmd;
+    uint8_t len;
+    uint8_t args[TAGGED_ARGS_MAX];
+} tagged_req_t;
+
+static struct {
+    tagged_req_t q[TAGGED_QUEUE_LEN];
+    uint8_t head;
+    uint8_t count;
+} g_tagged;
+
+static void tagged_run(int port, uint8_t tag, uint8_t cmd, const uint8_t *args, uint8_t len)
+{
+    int prev_port = g_last_rx_port;
+    g_last_rx_port = port;
+    comm_reply_tag_set(port, cmd, tag);
+    if (!comm_handle_command(cmd, args, len))
+        send_status(cmd, 0xFF);
+    comm_reply_tag_clear();
+    g_last_rx_port = prev_port;
+}
+
+static void handle_tagged(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    (void)cmd;
+    uint8_t tag = p[0];
+    uint8_t inner = p[1];
+    uint8_t n = (uint8_t)(len - 2u);
+    if (inner == COMM_CMD_TAGGED)
+    {
+        comm_reply_tag_set(g_last_rx_port, inner, tag);
+        send_status(inner, CMD_STATUS_BAD_ARG);
+        comm_reply_tag_clear();
+        return;
+    }
+    uint8_t slot = k_cmd_slot[inner];
+    if (slot && (k_cmds[slot - 1u].flags & CMD_F_SLOW) && n <= TAGGED_ARGS_MAX)
+    {
+        if (g_tagged.count >= TAGGED_QUEUE_LEN)
+        {
+            comm_reply_tag_set(g_last_rx_port, inner, tag);
+            send_status(inner, CMD_STATUS_RATE_LIMITED);
+            comm_reply_tag_clear();
+            return;
+        }
+        tagged_req_t *r = &g_tagged.q[(g_tagged.head + g_tagged.count) % TAGGED_QUEUE_LEN];
+        r->port = g_last_rx_port;
+        r->tag = tag;
+        r->cmd = inner;
+        r->len = n;
+        for (uint8_t i = 0; i < n; ++i)
+            r->args[i] = p[2u + i];
+        g_tagged.count++;
+        return;
     }
+    tagged_run(g_last_rx_port, tag, inner, &p[2], n);
+}
 
-    switch (cmd)
-    {
-    case CMD_ID_PING: handle_ping(cmd); return 1;
-    case LOG_FRAME_CMD: handle_log_frame(cmd); return 1;
-    case CMD_ID_READ32: handle_read32(p, len, cmd); return 1;
-    case CMD_ID_WRITE32: handle_write32(p, len, cmd); return 1;
-    case CMD_ID_READ_MEM: handle_read_mem(p, len, cmd); return 1;
-    case CMD_ID_WRITE_MEM: handle_write_mem(p, len, cmd); return 1;
-    case CMD_ID_EXEC: handle_exec(p, len, cmd); return 1;
-    case CMD_ID_UPLOAD_EXEC: handle_upload_exec(p, len, cmd); return 1;
-    case CMD_ID_READ_FLASH: handle_read_flash(p, len, cmd); return 1;
-    case CMD_ID_MONITOR: handle_monitor_control(p, len, cmd); return 1;
-    case CMD_ID_STATE_DUMP: handle_state_dump(cmd); return 1;
-    case CMD_ID_SET_BOOTLOADER_FLAG: handle_set_bootloader_flag(cmd); return 1;
-    case CMD_ID_SET_STATE: handle_set_state(p, len, cmd); return 1;
-    case CMD_ID_SET_STREAM: handle_set_stream(p, len, cmd); return 1;
-    case CMD_ID_REBOOT_BOOTLOADER: handle_reboot_bootloader(cmd); return 1;
-    case CMD_ID_SET_DEBUG_OUTPUT: handle_set_debug_output(p, len, cmd); return 1;
-    case CMD_ID_SPEED_RB_SUMMARY: handle_speed_rb_summary(cmd); return 1;
-    case CMD_ID_DEBUG_STATE_V2: handle_debug_state_v2(cmd); return 1;
-    case CMD_ID_GRAPH_SUMMARY: handle_graph_summary(cmd); return 1;
-    case CMD_ID_GRAPH_CONTROL: handle_graph_control(p, len, cmd); return 1;
-    case CMD_ID_MOTOR_UART2_RAW_TX: handle_motor_uart2_raw_tx(p, len, cmd); return 1;
-    case CMD_ID_MOTOR_LAST_FRAME: handle_motor_last_frame(cmd); return 1;
-    case CMD_ID_MOTOR_PROTO_SET: handle_motor_proto_set(p, len, cmd); return 1;
-    case CMD_ID_MOTOR_PROTO_GET: handle_motor_proto_get(cmd); return 1;
-    case CMD_ID_MOTOR_STX02_OPTS_SET: handle_motor_stx02_opts_set(p, len, cmd); return 1;
-    case CMD_ID_MOTOR_STX02_OPTS_GET: handle_motor_stx02_opts_get(cmd); return 1;
-    case CMD_ID_CONFIG_GET: handle_config_get(cmd); return 1;
-    case CMD_ID_CONFIG_STAGE: handle_config_stage(p, len, cmd); return 1;
-    case CMD_ID_CONFIG_COMMIT: handle_config_commit(p, len, cmd); return 1;
-    case CMD_ID_SET_PROFILE: handle_set_profile(p, len, cmd); return 1;
-    case CMD_ID_SET_GEARS: handle_set_gears(p, len, cmd); return 1;
-    case CMD_ID_SET_CADENCE_BIAS: handle_set_cadence_bias(p, len, cmd); return 1;
-    case CMD_ID_TRIP_GET: handle_trip_get(cmd); return 1;
-    case CMD_ID_TRIP_RESET: handle_trip_reset(cmd); return 1;
-    case CMD_ID_SET_DRIVE_MODE: handle_set_drive_mode(p, len, cmd); return 1;
-    case CMD_ID_SET_REGEN: handle_set_regen(p, len, cmd); return 1;
-    case CMD_ID_SET_HW_CAPS: handle_set_hw_caps(p, len, cmd); return 1;
-    case CMD_ID_EVENT_LOG_SUMMARY: handle_event_log_summary(cmd); return 1;
-    case CMD_ID_EVENT_LOG_READ: handle_event_log_read(p, len, cmd); return 1;
-    case CMD_ID_EVENT_LOG_MARK: handle_event_log_mark(p, len, cmd); return 1;
-    case CMD_ID_STREAM_LOG_SUMMARY: handle_stream_log_summary(cmd); return 1;
-    case CMD_ID_STREAM_LOG_READ: handle_stream_log_read(p, len, cmd); return 1;
-    case CMD_ID_STREAM_LOG_CONTROL: handle_stream_log_control(p, len, cmd); return 1;
-    case CMD_ID_CRASH_DUMP_READ: handle_crash_dump_read(cmd); return 1;
-    case CMD_ID_CRASH_DUMP_CLEAR: handle_crash_dump_clear(cmd); return 1;
-    case CMD_ID_BUS_CAPTURE_SUMMARY: handle_bus_capture_summary(cmd); return 1;
-    case CMD_ID_BUS_CAPTURE_READ: handle_bus_capture_read(p, len, cmd); return 1;
-    case CMD_ID_BUS_CAPTURE_CONTROL: handle_bus_capture_control(p, len, cmd); return 1;
-    case CMD_ID_BUS_CAPTURE_INJECT: handle_bus_capture_inject(p, len, cmd); return 1;
-    case CMD_ID_BUS_UI_CONTROL: handle_bus_ui_control(p, len, cmd); return 1;
-    case CMD_ID_BUS_INJECT_ARM: handle_bus_inject_arm(p, len, cmd); return 1;
-    case CMD_ID_BUS_CAPTURE_REPLAY: handle_bus_capture_replay(p, len, cmd); return 1;
-    case CMD_ID_AB_STATUS: handle_ab_status(cmd); return 1;
-    case CMD_ID_AB_SET_PENDING: handle_ab_set_pending(p, len, cmd); return 1;
-    case CMD_ID_BLE_HACKER: handle_ble_hacker(p, len, cmd); return 1;
-    default:
+void comm_tagged_tick(void)
+{
+    if (!g_tagged.count)
+        return;
+    tagged_req_t *r = &g_tagged.q[g_tagged.head];
+    if (comm_tx_free(r->port) < (uint16_t)(COMM_MAX_PAYLOAD + 4u))
+        return;
+    tagged_req_t req = *r;
+    g_tagged.head = (uint8_t)((g_tagged.head + 1u) % TAGGED_QUEUE_LEN);
+    g_tagged.count--;
+    tagged_run(req.port, req.tag, req.cmd, req.args, req.len);
+}
+
+/* See COMM_CMD_TIME_SYNC. */
+static void handle_time_sync(const uint8_t *p, uint8_t len, uint8_t cmd)
+{
+    uint32_t t2 = g_last_rx_us;
+    if (len > 4u)
+    {
+        uint8_t inner = p[4];
+        if (inner == COMM_CMD_TIME_SYNC)
+        {
+            send_status(cmd, CMD_STATUS_BAD_ARG);
+            return;
+        }
+        if (!comm_handle_command(inner, &p[5], (uint8_t)(len - 5u)))
+            send_status(inner, 0xFF);
+    }
+    uint8_t out[COMM_TIME_SYNC_BYTES];
+    for (uint8_t i = 0; i < 4u; ++i)
+        out[i] = p[i];
+    store_be32(&out[4], t2);
+    store_be32(&out[8], platform_time_us());
+    send_frame_port(g_last_rx_port, cmd | 0x80, out, (uint8_t)sizeof(out));
+}
+
+int comm_handle_command(uint8_t cmd, const uint8_t *payload, uint8_t len)
+{
+    uint8_t slot = k_cmd_slot[cmd];
+    if (slot == 0u)
+        return 0;
+    const comm_cmd_desc_t *d = &k_cmds[slot - 1u];
+    comm_cmd_stats_t *s = &g_cmd_stats[slot - 1u];
+    uint8_t app = (g_boot_phase == BOOT_PHASE_APP) ? 1u : 0u;
+
+    /* Boot monitor gating: before full app init, only a minimal, safe command
+     * surface is allowed (peek/poke, flash reads, exec-in-RAM, reboot).
+     * Everything else is rejected with STATUS_UNSUPPORTED (0xFF). */
+    if (!app && !(d->flags & CMD_F_MONITOR))
         return 0;
+    if (app && (d->flags & CMD_F_PRIVILEGED))
+    {
+        cmd_stats_reject(s);
+        send_status(cmd, CMD_STATUS_BAD_ARG);
+        return 1;
+    }
+    if (len < d->min_len || len > d->max_len)
+    {
+        cmd_stats_reject(s);
+        send_status(cmd, CMD_STATUS_BAD_PAYLOAD);
+        return 1;
+    }
+    if (app && (d->flags & CMD_F_STILL) && !config_change_guard(cmd))
+    {
+        cmd_stats_reject(s);
+        return 1;
     }
+    if (d->min_interval_ms && s->calls && (uint32_t)(g_ms - s->last_ms) < d->min_interval_ms)
+    {
+        cmd_stats_reject(s);
+        send_status(cmd, CMD_STATUS_RATE_LIMITED);
+        return 1;
+    }
+
+    s->last_ms = g_ms;
+    if (s->calls != 0xFFFFu)
+        s->calls++;
+    uint32_t t0 = platform_cycles_now();
+    d->fn(payload, len, cmd);
+    uint32_t us = platform_cycles_to_us(platform_cycles_now() - t0);
+    if (us > 0xFFFFu)
+        us = 0xFFFFu;
+    if (us > s->max_us)
+        s->max_us = (uint16_t)us;
+    cmd_hist_add(s, us);
+    return 1;
 }
@@ -5,12 +5,15 @@
 #include "app_data.h"
 #include "control/control.h"
 #include "drivers/spi_flash.h"
+#include "src/motor/motor_link.h"
 #include "input/input.h"
 #include "power/power.h"
 #include "app_state.h"
 #include "src/profiles/profiles.h"
+#include "storage/kv_store.h"
 #include "storage/layout.h"
 #include "storage/logs.h"
+#include "storage/oem_config.h"
 #include "ui.h"
 #include "util/byteorder.h"
 #include "util/crc32.h"
@@ -21,30 +24,26 @@
 #define PIN_ATTEMPT_FLAG_BAD   0x02u
 #define PIN_ATTEMPT_FLAG_RATE  0x04u
 
-#define OEM_CFG_PRIMARY_ADDR 0x003FD000u
-#define OEM_CFG_BACKUP_ADDR  0x003FB000u
-#define OEM_CFG_SIZE         0xD0u
-
-#define OEM_CFG_OFF_WHEEL_MM     0x1Cu
-#define OEM_CFG_OFF_SPEED_LIMIT  0x7Cu
-
 config_t g_config_active;
 static config_t g_config_staged;
 static uint8_t g_config_staged_valid;
-static int g_config_active_slot;
 static uint32_t g_pin_last_attempt_ms;
+static uint8_t g_profile_persist_pending;
+static uint8_t g_profile_persist_id;
+static uint32_t g_profile_persist_due_ms;
+static uint32_t g_profile_crc_flip[8];
 
-static void config_apply_active(const config_t *c, int slot)
+static void config_apply_active(const config_t *c)
 {
     if (!c)
         return;
     g_config_active = *c;
-    g_config_active_slot = slot;
     if (g_config_active.profile_id >= PROFILE_COUNT)
         g_config_active.profile_id = 0;
     set_active_profile(g_config_active.profile_id, 0);
     g_stream_log_period_ms = stream_log_period_sanitize(g_config_active.log_period_ms);
     drive_apply_config();
+    motor_link_apply_config();
     if (g_stream_log_enabled)
     {
         g_stream_log_last_ms = g_ms;
@@ -52,38 +51,14 @@ static void config_apply_active(const config_t *c, int slot)
     }
 }
 
-static uint16_t load_le16(const uint8_t *p)
-{
-    return (uint16_t)p[0] | (uint16_t)((uint16_t)p[1] << 8);
-}
-
-static int oem_blob_valid(const uint8_t *buf)
-{
-    uint8_t all_zero = 1u;
-    uint8_t all_ff = 1u;
-    for (uint32_t i = 0; i < OEM_CFG_SIZE; ++i)
-    {
-        if (buf[i] != 0u)
-            all_zero = 0u;
-        if (buf[i] != 0xFFu)
-            all_ff = 0u;
-    }
-    return (all_zero || all_ff) ? 0 : 1;
-}
-
 static int config_try_import_oem(config_t *c)
 {
     if (!c)
         return 0;
 
-    uint8_t buf[OEM_CFG_SIZE];
-    spi_flash_read(OEM_CFG_PRIMARY_ADDR, buf, OEM_CFG_SIZE);
-    if (!oem_blob_valid(buf))
-    {
-        spi_flash_read(OEM_CFG_BACKUP_ADDR, buf, OEM_CFG_SIZE);
-        if (!oem_blob_valid(buf))
-            return 0;
-    }
+    const uint8_t *buf = oem_config_blob();
+    if (!buf)
+        return 0;
 
     uint16_t wheel_mm = load_le16(&buf[OEM_CFG_OFF_WHEEL_MM]);
     if (wheel_mm >= 1000u && wheel_mm <= 4000u)
@@ -149,7 +124,7 @@ void config_store_be(uint8_t *dst, const config_t *c)
     store_be32(&dst[8], c->crc32);
     store_be16(&dst[12], c->wheel_mm);
     dst[14] = c->units;
-    dst[15] = c->profile_id;
+    dst[CONFIG_BLOB_PROFILE_OFFSET] = c->profile_id;
     dst[16] = c->theme;
     dst[17] = c->flags;
     dst[18] = c->button_map;
@@ -377,59 +352,93 @@ fail:
     return 0;
 }
 
-void config_write_slot(int slot, const config_t *c)
+/*
+ * Decode and validate a blob as read from flash. The CRC covers the blob
+ * with its own field zeroed, so it is checked over these bytes directly
+ * instead of re-encoding the struct (config_crc_expected). Clobbers the
+ * CRC field of blob.
+ */
+static int config_load_blob(config_t *out, uint8_t *blob)
 {
-    if (!c || slot < 0 || slot >= CONFIG_SLOT_COUNT)
-        return;
-    uint32_t base = CONFIG_STORAGE_BASE + (uint32_t)slot * CONFIG_SLOT_STRIDE;
-    uint8_t buf[CONFIG_BLOB_SIZE];
-    config_store_be(buf, c);
-    spi_flash_erase_4k(base);
-    spi_flash_write(base, buf, CONFIG_BLOB_SIZE);
+    config_load_from_be(out, blob);
+    if (!config_validate(out, 0))
+        return 0;
+    store_be32(&blob[8], 0u);
+    return crc32_compute(blob, CONFIG_BLOB_SIZE) == out->crc32;
 }
 
+/* Legacy double-buffered slots; only read now, to migrate older installs. */
 int config_read_slot(int slot, config_t *out)
 {
     if (!out || slot < 0 || slot >= CONFIG_SLOT_COUNT)
         return 0;
     uint32_t base = CONFIG_STORAGE_BASE + (uint32_t)slot * CONFIG_SLOT_STRIDE;
-    uint8_t buf[CONFIG_BLOB_SIZE];
+    uint8_t buf[CONFIG_BLOB_SIZE] __attribute__((aligned(4)));
     spi_flash_read(base, buf, CONFIG_BLOB_SIZE);
-    config_load_from_be(out, buf);
-    return config_validate(out, 1);
+    return config_load_blob(out, buf);
+}
+
+static void config_kv_write(const config_t *c)
+{
+    uint8_t buf[CONFIG_BLOB_SIZE];
+    config_store_be(buf, c);
+    (void)kv_put(KV_KEY_CONFIG, buf, CONFIG_BLOB_SIZE);
+    /* Keep the profile record consistent so it cannot override this blob;
+     * that also settles any deferred profile write. */
+    (void)kv_put(KV_KEY_PROFILE, &c->profile_id, 1u);
+    g_profile_persist_pending = 0u;
+}
+
+static int config_kv_read(config_t *out)
+{
+    uint8_t buf[CONFIG_BLOB_SIZE] __attribute__((aligned(4)));
+    if (kv_get(KV_KEY_CONFIG, buf, CONFIG_BLOB_SIZE) != (int)CONFIG_BLOB_SIZE)
+        return 0;
+    return config_load_blob(out, buf);
 }
 
 void config_load_active(void)
 {
     config_t best = {0};
-    int best_slot = -1;
-    for (int i = 0; i < CONFIG_SLOT_COUNT; ++i)
+    int found = config_kv_read(&best);
+    if (!found)
     {
-        config_t tmp;
-        if (config_read_slot(i, &tmp))
+        for (int i = 0; i < CONFIG_SLOT_COUNT; ++i)
         {
-            if (best_slot < 0 || tmp.seq > best.seq)
+            config_t tmp;
+            if (config_read_slot(i, &tmp) && (!found || tmp.seq > best.seq))
             {
                 best = tmp;
-                best_slot = i;
+                found = 1;
             }
         }
+        if (!found)
+        {
+            config_defaults(&best);
+            (void)config_try_import_oem(&best);
+        }
+        config_kv_write(&best);
     }
-    if (best_slot < 0)
+
+    /* Profile and gear are persisted as their own small records. */
+    uint8_t v = 0;
+    if (kv_get(KV_KEY_PROFILE, &v, 1u) == 1 && v < PROFILE_COUNT && v != best.profile_id)
     {
-        config_defaults(&best);
-        (void)config_try_import_oem(&best);
-        best_slot = 0;
-        config_write_slot(best_slot, &best);
+        best.profile_id = v;
+        best.crc32 = 0;
+        best.crc32 = config_crc_expected(&best);
     }
+    if (kv_get(KV_KEY_VGEAR, &v, 1u) == 1 && v >= 1u && v <= g_vgears.count)
+        g_active_vgear = v;
+
     g_config_active = best;
-    g_config_active_slot = best_slot;
     if (g_config_active.profile_id >= PROFILE_COUNT)
         g_config_active.profile_id = 0;
     g_active_profile_id = g_config_active.profile_id;
     g_outputs.profile_id = g_active_profile_id;
     g_stream_log_period_ms = stream_log_period_sanitize(g_config_active.log_period_ms);
     drive_apply_config();
+    motor_link_apply_config();
 }
 
 void config_persist_active(void)
@@ -437,18 +446,66 @@ void config_persist_active(void)
     g_config_active.seq += 1u;
     g_config_active.crc32 = 0;
     g_config_active.crc32 = config_crc_expected(&g_config_active);
-    int slot = (g_config_active_slot + 1) % CONFIG_SLOT_COUNT;
-    config_write_slot(slot, &g_config_active);
-    g_config_active_slot = slot;
+    config_kv_write(&g_config_active);
+}
+
+void config_persist_profile(uint8_t id)
+{
+    g_profile_persist_id = id;
+    g_profile_persist_due_ms = g_ms + CONFIG_PROFILE_PERSIST_DELAY_MS;
+    g_profile_persist_pending = 1u;
+}
+
+void config_persist_tick(uint32_t now_ms)
+{
+    if (g_profile_persist_pending && (int32_t)(now_ms - g_profile_persist_due_ms) >= 0)
+        config_persist_flush();
+}
+
+void config_persist_flush(void)
+{
+    if (!g_profile_persist_pending)
+        return;
+    g_profile_persist_pending = 0u;
+    (void)kv_put(KV_KEY_PROFILE, &g_profile_persist_id, 1u);
+}
+
+void config_active_set_profile(uint8_t id)
+{
+    /* CRC32 is affine in the message: flipping bits of one blob byte flips
+     * the CRC by a pattern that depends only on the byte's position. Build
+     * the pattern for each bit of the profile byte once, then a switch is a
+     * few XORs. */
+    if (g_profile_crc_flip[0] == 0u)
+    {
+        uint8_t tail[CONFIG_BLOB_SIZE - CONFIG_BLOB_PROFILE_OFFSET] = {0};
+        for (uint8_t b = 0; b < 8u; ++b)
+        {
+            tail[0] = (uint8_t)(1u << b);
+            g_profile_crc_flip[b] = crc32_update(0u, tail, sizeof(tail));
+        }
+    }
+
+    uint8_t d = (uint8_t)(g_config_active.profile_id ^ id);
+    uint32_t crc = g_config_active.crc32;
+    for (uint8_t b = 0; d; ++b, d >>= 1)
+        if (d & 1u)
+            crc ^= g_profile_crc_flip[b];
+    g_config_active.profile_id = id;
+    g_config_active.crc32 = crc;
+}
+
+void config_persist_vgear(uint8_t gear)
+{
+    (void)kv_put(KV_KEY_VGEAR, &gear, 1u);
 }
 
 int config_commit_active(const config_t *c)
 {
     if (!c)
         return 0;
-    int slot = (g_config_active_slot + 1) % CONFIG_SLOT_COUNT;
-    config_write_slot(slot, c);
-    config_apply_active(c, slot);
+    config_kv_write(c);
+    config_apply_active(c);
     return 1;
 }
 
@@ -484,6 +541,78 @@ uint8_t config_stage_blob(const uint8_t *p)
     return 0;
 }
 
+/* Blob offset and width (bytes) of each patchable field. */
+static const struct
+{
+    uint8_t off;
+    uint8_t width;
+} k_config_fields[CFG_FIELD_COUNT] = {
+    [CFG_FIELD_WHEEL_MM] = {12u, 2u},
+    [CFG_FIELD_UNITS] = {14u, 1u},
+    [CFG_FIELD_PROFILE_ID] = {15u, 1u},
+    [CFG_FIELD_THEME] = {16u, 1u},
+    [CFG_FIELD_FLAGS] = {17u, 1u},
+    [CFG_FIELD_BUTTON_MAP] = {18u, 1u},
+    [CFG_FIELD_BUTTON_FLAGS] = {19u, 1u},
+    [CFG_FIELD_CAP_CURRENT_DA] = {23u, 2u},
+    [CFG_FIELD_CAP_SPEED_DMPH] = {25u, 2u},
+    [CFG_FIELD_LOG_PERIOD_MS] = {27u, 2u},
+    [CFG_FIELD_SOFT_START_RAMP_WPS] = {29u, 2u},
+    [CFG_FIELD_SOFT_START_DEADBAND_W] = {31u, 2u},
+    [CFG_FIELD_SOFT_START_KICK_W] = {33u, 2u},
+    [CFG_FIELD_DRIVE_MODE] = {35u, 1u},
+    [CFG_FIELD_MANUAL_CURRENT_DA] = {36u, 2u},
+    [CFG_FIELD_MANUAL_POWER_W] = {38u, 2u},
+    [CFG_FIELD_BOOST_BUDGET_MS] = {40u, 2u},
+    [CFG_FIELD_BOOST_COOLDOWN_MS] = {42u, 2u},
+    [CFG_FIELD_BOOST_THRESHOLD_DA] = {44u, 2u},
+    [CFG_FIELD_BOOST_GAIN_Q15] = {46u, 2u},
+};
+
+uint8_t config_patch_fields(const uint8_t *p, uint8_t len)
+{
+    if (!p || len == 0u || (len % CONFIG_PATCH_ENTRY_BYTES) != 0u)
+        return 0xFD;
+    uint8_t blob[CONFIG_BLOB_SIZE];
+    config_store_be(blob, &g_config_active);
+    config_reject_reason_t reason = CFG_REJECT_NONE;
+    for (uint8_t i = 0; i < len; i = (uint8_t)(i + CONFIG_PATCH_ENTRY_BYTES))
+    {
+        uint8_t id = p[i];
+        uint16_t v = load_be16(&p[i + 1u]);
+        if (id == 0u || id >= CFG_FIELD_COUNT)
+            return 0xFB;
+        uint8_t off = k_config_fields[id].off;
+        if (k_config_fields[id].width == 2u)
+        {
+            store_be16(&blob[off], v);
+        }
+        else if (v <= 0xFFu)
+        {
+            blob[off] = (uint8_t)v;
+        }
+        else
+        {
+            reason = CFG_REJECT_RANGE;
+            break;
+        }
+    }
+
+    config_t tmp;
+    config_load_from_be(&tmp, blob);
+    tmp.seq = g_config_active.seq + 1u;
+    if (reason != CFG_REJECT_NONE || !config_validate_reason(&tmp, 0, &reason) ||
+        !config_policy_validate(&tmp, &reason))
+    {
+        event_log_append(EVT_CONFIG_REJECT, (uint8_t)reason);
+        return 0xFE;
+    }
+    tmp.crc32 = 0;
+    tmp.crc32 = config_crc_expected(&tmp);
+    config_commit_active(&tmp);
+    return 0;
+}
+
 uint8_t config_commit_staged(const uint8_t *p, uint8_t len)
 {
     if (!g_config_staged_valid)
@@ -51,6 +51,7 @@ typedef struct {
 
 /* Config blob serialization */
 #define CONFIG_VERSION 6u
+#define CONFIG_BLOB_PROFILE_OFFSET 15u
 #define CONFIG_BLOB_CURVE_COUNT_OFFSET 48u
 #define CONFIG_BLOB_CURVE_OFFSET 49u
 #define CONFIG_BLOB_SIZE (CONFIG_BLOB_CURVE_OFFSET + (ASSIST_CURVE_MAX_POINTS * 4u))
@@ -103,6 +104,35 @@ typedef enum {
     CFG_REJECT_PIN       = 7,
 } config_reject_reason_t;
 
+/* Field IDs for config_patch_fields(). Mode and PIN are not patchable: the
+ * PIN check needs the caller to present the PIN in a staged blob. */
+typedef enum {
+    CFG_FIELD_WHEEL_MM = 1,
+    CFG_FIELD_UNITS,
+    CFG_FIELD_PROFILE_ID,
+    CFG_FIELD_THEME,
+    CFG_FIELD_FLAGS,
+    CFG_FIELD_BUTTON_MAP,
+    CFG_FIELD_BUTTON_FLAGS,
+    CFG_FIELD_CAP_CURRENT_DA,
+    CFG_FIELD_CAP_SPEED_DMPH,
+    CFG_FIELD_LOG_PERIOD_MS,
+    CFG_FIELD_SOFT_START_RAMP_WPS,
+    CFG_FIELD_SOFT_START_DEADBAND_W,
+    CFG_FIELD_SOFT_START_KICK_W,
+    CFG_FIELD_DRIVE_MODE,
+    CFG_FIELD_MANUAL_CURRENT_DA,
+    CFG_FIELD_MANUAL_POWER_W,
+    CFG_FIELD_BOOST_BUDGET_MS,
+    CFG_FIELD_BOOST_COOLDOWN_MS,
+    CFG_FIELD_BOOST_THRESHOLD_DA,
+    CFG_FIELD_BOOST_GAIN_Q15,
+    CFG_FIELD_COUNT,
+} config_field_t;
+
+#define CONFIG_PATCH_ENTRY_BYTES 3u /* field[1], value_be[2] */
+#define CONFIG_PATCH_MAX_FIELDS  16u
+
 /* Wizard state */
 typedef enum {
     WIZ_STEP_WHEEL = 0,
@@ -128,14 +158,29 @@ uint32_t config_crc_expected(const config_t *c);
 int config_validate_reason(const config_t *c, int check_crc, config_reject_reason_t *reason_out);
 int config_validate(const config_t *c, int check_crc);
 int config_policy_validate(const config_t *c, config_reject_reason_t *reason_out);
-void config_write_slot(int slot, const config_t *c);
 int config_read_slot(int slot, config_t *out);
 void config_load_active(void);
 void config_persist_active(void);
+/* Single-record appends; no config seq bump or blob rewrite. The profile
+ * record is written once switches have been quiet for
+ * CONFIG_PROFILE_PERSIST_DELAY_MS (config_persist_tick), so cycling through
+ * profiles costs one append; config_persist_flush() writes it now. */
+#define CONFIG_PROFILE_PERSIST_DELAY_MS 1500u
+void config_persist_profile(uint8_t id);
+void config_persist_vgear(uint8_t gear);
+void config_persist_tick(uint32_t now_ms);
+void config_persist_flush(void);
+/* Sets g_config_active.profile_id and moves its CRC along without
+ * re-serializing the blob (the CRC must be valid beforehand). */
+void config_active_set_profile(uint8_t id);
 int config_commit_active(const config_t *c);
 void config_stage_reset(void);
 uint8_t config_stage_blob(const uint8_t *p);
 uint8_t config_commit_staged(const uint8_t *p, uint8_t len);
+/* Sets n x {field[1], value_be[2]} on a copy of the active config and
+ * commits it when the result passes validation and policy. Leaves any
+ * staged blob alone. */
+uint8_t config_patch_fields(const uint8_t *p, uint8_t len);
 
 void wizard_reset(void);
 void wizard_start(void);
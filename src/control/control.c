@@ -17,6 +17,7 @@
 /* Global config instance (defined in main.c) */
 /* Global state instances */
 cruise_state_t g_cruise;
+cruise_load_obs_t g_cruise_obs;
 regen_state_t g_regen;
 drive_state_t g_drive;
 boost_state_t g_boost;
@@ -144,6 +145,8 @@ void regen_reset(void)
     g_regen.active = 0;
     g_regen.cmd_power_w = 0;
     g_regen.cmd_current_dA = 0;
+    g_regen.adaptive = 0;
+    g_regen.auto_level = 0;
 }
 
 void regen_set_levels(uint8_t level, uint8_t brake_level)
@@ -152,6 +155,36 @@ void regen_set_levels(uint8_t level, uint8_t brake_level)
     g_regen.brake_level = regen_clamp_level(brake_level);
 }
 
+void regen_set_adaptive(uint8_t on)
+{
+    g_regen.adaptive = on ? 1u : 0u;
+    g_regen.auto_level = 0;
+}
+
+/* Scale a level by the pack's room to take charge: whole up to the taper
+ * point, none once the pack is nearly full. */
+static uint8_t regen_soc_scale(uint8_t level, uint8_t soc_pct)
+{
+    if (soc_pct >= REGEN_AUTO_SOC_FULL_PCT)
+        return 0;
+    if (soc_pct <= REGEN_AUTO_SOC_TAPER_PCT)
+        return level;
+    uint32_t room = REGEN_AUTO_SOC_FULL_PCT - soc_pct;
+    return (uint8_t)(((uint32_t)level * room) / (REGEN_AUTO_SOC_FULL_PCT - REGEN_AUTO_SOC_TAPER_PCT));
+}
+
+uint8_t regen_adaptive_level(uint8_t ceiling, uint16_t speed_dmph, uint8_t soc_pct)
+{
+    ceiling = regen_clamp_level(ceiling);
+    if (speed_dmph <= REGEN_AUTO_MIN_DMPH)
+        return 0;
+    uint32_t level = ceiling;
+    if (speed_dmph < REGEN_AUTO_FULL_DMPH)
+        level = (level * (speed_dmph - REGEN_AUTO_MIN_DMPH) + (REGEN_AUTO_FULL_DMPH - REGEN_AUTO_MIN_DMPH) / 2u) /
+                (REGEN_AUTO_FULL_DMPH - REGEN_AUTO_MIN_DMPH);
+    return regen_soc_scale((uint8_t)level, soc_pct);
+}
+
 void regen_update(void)
 {
     if (!regen_capable())
@@ -161,8 +194,17 @@ void regen_update(void)
     }
 
     uint8_t target = g_regen.level;
-    if (g_inputs.brake && g_regen.brake_level > target)
-        target = g_regen.brake_level;
+    uint8_t brake_target = g_regen.brake_level;
+    if (g_regen.adaptive)
+    {
+        /* Coasting only: any propulsion request wins over regen. */
+        uint8_t coast = (g_outputs.cmd_power_w == 0u) ? 1u : 0u;
+        g_regen.auto_level = coast ? regen_adaptive_level(g_regen.level, g_inputs.speed_dmph, g_motor.soc_pct) : 0u;
+        target = g_regen.auto_level;
+        brake_target = regen_soc_scale(g_regen.brake_level, g_motor.soc_pct);
+    }
+    if (g_inputs.brake && brake_target > target)
+        target = brake_target;
 
     if (target == 0)
     {
@@ -198,6 +240,9 @@ void cruise_reset(void)
     g_cruise.set_speed_dmph = 0;
     g_cruise.set_power_w = 0;
     g_cruise.output_w = 0;
+    g_cruise.ff_w = 0;
+    g_cruise_obs.valid = 0;
+    g_cruise_obs.load_mN = 0;
 }
 
 void cruise_cancel(uint8_t reason)
@@ -214,6 +259,115 @@ void cruise_cancel(uint8_t reason)
     event_log_append(EVT_CRUISE_EVENT, reason);
 }
 
+#define CRUISE_OBS_DT_MAX_MS  200u
+#define CRUISE_OBS_LOAD_MAX_MN 500000   /* 500 N: past any rideable grade */
+
+static int32_t dmph_to_mms(uint16_t dmph)
+{
+    /* 0.1 mph = 44.704 mm/s */
+    return (int32_t)(((uint32_t)dmph * 447u + 5u) / 10u);
+}
+
+/*
+ * Second-order Luenberger observer on speed with the road load as the
+ * disturbance state (poles at -omega), so no speed derivative is taken:
+ *   v_hat' = (F_drive - F_load) / m + 2*omega*e
+ *   F_load' = -m*omega^2*e,   e = v - v_hat
+ * drive_w is what was actually applied last tick plus the rider share.
+ */
+void cruise_load_obs_update(uint32_t now_ms, uint16_t speed_dmph, uint16_t drive_w)
+{
+    cruise_load_obs_t *o = &g_cruise_obs;
+    if (speed_dmph < CRUISE_OBS_MIN_SPEED_DMPH)
+    {
+        o->valid = 0;
+        return;
+    }
+    int32_t v_mms = dmph_to_mms(speed_dmph);
+    if (!o->valid)
+    {
+        /* The load estimate survives a stop; only the speed state restarts. */
+        o->v_hat_q8 = v_mms * 256;
+        o->last_ms = now_ms;
+        o->valid = 1;
+        return;
+    }
+    uint32_t dt = now_ms - o->last_ms;
+    o->last_ms = now_ms;
+    if (dt == 0u)
+        return;
+    if (dt > CRUISE_OBS_DT_MAX_MS)
+        dt = CRUISE_OBS_DT_MAX_MS;
+
+    int64_t drive_mN = ((int64_t)drive_w * 1000000) / v_mms;
+    int32_t e_q8 = v_mms * 256 - o->v_hat_q8;
+    /* mN / kg is mm/s^2. */
+    int64_t dv_q8 = ((drive_mN - o->load_mN) * 256 * (int64_t)dt) /
+                    ((int64_t)CRUISE_OBS_MASS_KG * 1000);
+    dv_q8 += ((int64_t)e_q8 * 2 * CRUISE_OBS_OMEGA_X10 * (int64_t)dt) / 10000;
+    o->v_hat_q8 += (int32_t)dv_q8;
+
+    int64_t load = o->load_mN -
+                   ((int64_t)e_q8 * CRUISE_OBS_MASS_KG * CRUISE_OBS_OMEGA_X10 * CRUISE_OBS_OMEGA_X10 * (int64_t)dt) /
+                   (100 * 1000 * 256);
+    if (load > CRUISE_OBS_LOAD_MAX_MN)
+        load = CRUISE_OBS_LOAD_MAX_MN;
+    if (load < -CRUISE_OBS_LOAD_MAX_MN)
+        load = -CRUISE_OBS_LOAD_MAX_MN;
+    o->load_mN = (int32_t)load;
+}
+
+/*
+ * Speed hold: the feed-forward (load at the set speed, less what the rider
+ * supplies) carries the hill, and a proportional trim with a deadband
+ * corrects the rest. The observer integrates, so the trim needs no I term.
+ */
+static uint16_t cruise_speed_hold(uint16_t limit_power)
+{
+    int16_t err = (int16_t)g_cruise.set_speed_dmph - (int16_t)g_inputs.speed_dmph;
+    int32_t target;
+    if (g_cruise_obs.valid)
+    {
+        int32_t ff = (int32_t)(((int64_t)g_cruise_obs.load_mN * dmph_to_mms(g_cruise.set_speed_dmph)) / 1000000);
+        ff -= (int32_t)(g_inputs.torque_raw / 4u);
+        if (ff < 0)
+            ff = 0;
+        if (ff > 0xFFFF)
+            ff = 0xFFFF;
+        g_cruise.ff_w = (uint16_t)ff;
+
+        int32_t e = err;
+        if (e > (int32_t)CRUISE_SPEED_DEADBAND_DMPH)
+            e -= (int32_t)CRUISE_SPEED_DEADBAND_DMPH;
+        else if (e < -(int32_t)CRUISE_SPEED_DEADBAND_DMPH)
+            e += (int32_t)CRUISE_SPEED_DEADBAND_DMPH;
+        else
+            e = 0;
+        target = ff + e * (int32_t)CRUISE_SPEED_TRIM_W_PER_DMPH;
+    }
+    else
+    {
+        /* No load estimate below the observer speed: integrate the error. */
+        g_cruise.ff_w = 0;
+        target = (int32_t)g_cruise.output_w + (int32_t)err * (int32_t)CRUISE_SPEED_KP_W_PER_DMPH;
+    }
+
+    int32_t delta = target - (int32_t)g_cruise.output_w;
+    if (delta > (int32_t)CRUISE_SPEED_STEP_MAX_W)
+        delta = CRUISE_SPEED_STEP_MAX_W;
+    else if (delta < -(int32_t)CRUISE_SPEED_STEP_MAX_W)
+        delta = -(int32_t)CRUISE_SPEED_STEP_MAX_W;
+    else if (delta < (int32_t)CRUISE_OUTPUT_HYST_W && delta > -(int32_t)CRUISE_OUTPUT_HYST_W)
+        delta = 0;
+    target = (int32_t)g_cruise.output_w + delta;
+    if (target < 0)
+        target = 0;
+    if (limit_power && target > (int32_t)limit_power)
+        target = limit_power;
+    g_cruise.output_w = (uint16_t)target;
+    return g_cruise.output_w;
+}
+
 static cruise_resume_reason_t cruise_resume_block_reason(void)
 {
     if (g_inputs.brake)
@@ -246,6 +400,12 @@ uint16_t cruise_apply(uint16_t base_power, uint16_t limit_power)
     }
     g_cruise.last_button = (g_inputs.buttons & CRUISE_BUTTON_MASK) ? 1u : 0u;
 
+    if (g_inputs.brake)
+        g_cruise_obs.valid = 0;
+    else
+        cruise_load_obs_update(g_ms, g_inputs.speed_dmph,
+                               (uint16_t)(g_outputs.cmd_power_w + g_inputs.torque_raw / 4u));
+
     if (g_inputs.brake)
     {
         if (g_cruise.mode != CRUISE_OFF)
@@ -357,21 +517,7 @@ uint16_t cruise_apply(uint16_t base_power, uint16_t limit_power)
     }
 
     if (g_cruise.mode == CRUISE_SPEED)
-    {
-        int16_t err = (int16_t)g_cruise.set_speed_dmph - (int16_t)g_inputs.speed_dmph;
-        int32_t delta = (int32_t)err * (int32_t)CRUISE_SPEED_KP_W_PER_DMPH;
-        if (delta > (int32_t)CRUISE_SPEED_STEP_MAX_W)
-            delta = CRUISE_SPEED_STEP_MAX_W;
-        else if (delta < -(int32_t)CRUISE_SPEED_STEP_MAX_W)
-            delta = -(int32_t)CRUISE_SPEED_STEP_MAX_W;
-        int32_t target = (int32_t)g_cruise.output_w + delta;
-        if (target < 0)
-            target = 0;
-        if (limit_power && target > (int32_t)limit_power)
-            target = limit_power;
-        g_cruise.output_w = (uint16_t)target;
-        return g_cruise.output_w;
-    }
+        return cruise_speed_hold(limit_power);
 
     if (g_cruise.mode == CRUISE_POWER)
     {
@@ -28,12 +28,26 @@
 /* Regen parameters */
 #define REGEN_LEVEL_MAX 10u
 #define REGEN_STEP_W    40u  /* per-level regen power target */
+/* Adaptive regen: the level follows speed (little to recover below the
+ * floor, full strength from REGEN_AUTO_FULL_DMPH) and backs off as the pack
+ * nears full, reaching zero at REGEN_AUTO_SOC_FULL_PCT. */
+#define REGEN_AUTO_MIN_DMPH      50u
+#define REGEN_AUTO_FULL_DMPH     200u
+#define REGEN_AUTO_SOC_TAPER_PCT 80u
+#define REGEN_AUTO_SOC_FULL_PCT  95u
 
 /* Cruise parameters */
 #define CRUISE_MIN_SPEED_DMPH     60u   /* 6.0 mph minimum to engage */
 #define CRUISE_MIN_POWER_W        40u   /* avoid zero-power engage */
-#define CRUISE_SPEED_KP_W_PER_DMPH 4    /* proportional gain */
+#define CRUISE_SPEED_KP_W_PER_DMPH 4    /* integral gain without a load estimate */
+#define CRUISE_SPEED_TRIM_W_PER_DMPH 40 /* proportional trim over the feed-forward */
 #define CRUISE_SPEED_STEP_MAX_W   80u   /* clamp per-tick adjustment */
+#define CRUISE_SPEED_DEADBAND_DMPH 2u   /* no trim inside +/-0.2 mph */
+#define CRUISE_OUTPUT_HYST_W      12u   /* hold the command below this change */
+/* Load observer: nominal mass (cargo bike + rider) and bandwidth. */
+#define CRUISE_OBS_MASS_KG        140u
+#define CRUISE_OBS_OMEGA_X10      30u   /* 3.0 rad/s */
+#define CRUISE_OBS_MIN_SPEED_DMPH 30u
 #define CRUISE_RESUME_SPEED_DELTA_DMPH 20u /* 2.0 mph window for resume */
 
 /* Cruise event codes */
@@ -95,8 +109,21 @@ typedef struct {
     uint16_t set_speed_dmph;
     uint16_t set_power_w;
     uint16_t output_w;
+    uint16_t ff_w;           /* feed-forward from the load estimate */
 } cruise_state_t;
 
+/*
+ * Grade/load observer. Drive force (commanded + rider power over speed)
+ * against m*dv/dt leaves the road load: grade, rolling and drag lumped
+ * into one force that cruise feeds forward as load * set speed.
+ */
+typedef struct {
+    uint8_t  valid;
+    int32_t  v_hat_q8;       /* mm/s, Q8 */
+    int32_t  load_mN;        /* estimated road load */
+    uint32_t last_ms;
+} cruise_load_obs_t;
+
 /* Walk assist states */
 typedef enum {
     WALK_STATE_OFF = 0,
@@ -112,6 +139,8 @@ typedef struct {
     uint8_t active;
     uint16_t cmd_power_w;
     uint16_t cmd_current_dA;
+    uint8_t adaptive;         /* level/brake_level become ceilings */
+    uint8_t auto_level;       /* level the adaptive schedule picked */
 } regen_state_t;
 
 /* Drive modes */
@@ -175,6 +204,7 @@ typedef struct {
 
 /* Global state (defined in main.c, accessed via extern) */
 extern cruise_state_t g_cruise;
+extern cruise_load_obs_t g_cruise_obs;
 extern regen_state_t g_regen;
 extern drive_state_t g_drive;
 extern boost_state_t g_boost;
@@ -188,6 +218,8 @@ extern uint8_t g_hw_caps;
 extern uint8_t g_cruise_toggle_request;
 extern uint16_t g_effective_cap_current_dA;
 extern uint16_t g_effective_cap_speed_dmph;
+extern uint16_t g_curve_power_w;
+extern uint16_t g_curve_cadence_q15;
 extern volatile uint32_t g_ms;
 extern vgear_table_t g_vgears;
 extern cadence_bias_t g_cadence_bias;
@@ -202,6 +234,8 @@ void walk_update(void);
 /* Regen API */
 void regen_reset(void);
 void regen_set_levels(uint8_t level, uint8_t brake_level);
+void regen_set_adaptive(uint8_t on);
+uint8_t regen_adaptive_level(uint8_t ceiling, uint16_t speed_dmph, uint8_t soc_pct);
 void regen_update(void);
 uint8_t regen_capable(void);
 
@@ -209,6 +243,7 @@ uint8_t regen_capable(void);
 void cruise_reset(void);
 void cruise_cancel(uint8_t reason);
 uint16_t cruise_apply(uint16_t base_power, uint16_t limit_power);
+void cruise_load_obs_update(uint32_t now_ms, uint16_t speed_dmph, uint16_t drive_w);
 
 /* Drive mode API */
 void drive_reset(void);
@@ -234,8 +269,17 @@ void vgear_defaults(void);
 uint16_t vgear_q15_to_pct(uint16_t q15);
 void vgear_adjust_min(int dir, uint16_t step);
 void vgear_adjust_max(int dir, uint16_t step);
+void vgear_set_shape(uint8_t shape);
 
 /* Cadence bias API */
 void cadence_bias_defaults(void);
 
+/* Control pipeline: g_inputs -> g_outputs, once per control tick. */
+void recompute_outputs(void);
+
+/* Recompiles the assist curves and effective caps of the active profile
+ * after g_profiles / g_assist_curves were rewritten in place (their caches
+ * are keyed on the profile id, not the table contents). */
+void outputs_tables_changed(void);
+
 #endif /* CONTROL_H */
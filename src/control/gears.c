@@ -8,37 +8,59 @@
 #include "control.h"
 #include "core/math_util.h"
 
+/* -------------------------------------------------------------
+ * Shape weights: gear i of n sits at w/32768 of the way from min
+ * to max (i/(n-1) linear, i^2/(n-1)^2 exponential, rounded). Built
+ * offline so regenerating a table is a multiply per gear.
+ * ------------------------------------------------------------- */
+_Static_assert(VGEAR_MAX == 12, "shape weight tables are sized for 12 gears");
+
+static const uint16_t k_vgear_weight_q15[VGEAR_SHAPE_EXP + 1][VGEAR_MAX + 1][VGEAR_MAX] = {
+    [VGEAR_SHAPE_LINEAR] = {
+        [ 0] = { 0 },
+        [ 1] = { 0 },
+        [ 2] = { 0, 32768 },
+        [ 3] = { 0, 16384, 32768 },
+        [ 4] = { 0, 10923, 21845, 32768 },
+        [ 5] = { 0, 8192, 16384, 24576, 32768 },
+        [ 6] = { 0, 6554, 13107, 19661, 26214, 32768 },
+        [ 7] = { 0, 5461, 10923, 16384, 21845, 27307, 32768 },
+        [ 8] = { 0, 4681, 9362, 14043, 18725, 23406, 28087, 32768 },
+        [ 9] = { 0, 4096, 8192, 12288, 16384, 20480, 24576, 28672, 32768 },
+        [10] = { 0, 3641, 7282, 10923, 14564, 18204, 21845, 25486, 29127, 32768 },
+        [11] = { 0, 3277, 6554, 9830, 13107, 16384, 19661, 22938, 26214, 29491, 32768 },
+        [12] = { 0, 2979, 5958, 8937, 11916, 14895, 17873, 20852, 23831, 26810, 29789, 32768 },
+    },
+    [VGEAR_SHAPE_EXP] = {
+        [ 0] = { 0 },
+        [ 1] = { 0 },
+        [ 2] = { 0, 32768 },
+        [ 3] = { 0, 8192, 32768 },
+        [ 4] = { 0, 3641, 14564, 32768 },
+        [ 5] = { 0, 2048, 8192, 18432, 32768 },
+        [ 6] = { 0, 1311, 5243, 11796, 20972, 32768 },
+        [ 7] = { 0, 910, 3641, 8192, 14564, 22756, 32768 },
+        [ 8] = { 0, 669, 2675, 6019, 10700, 16718, 24074, 32768 },
+        [ 9] = { 0, 512, 2048, 4608, 8192, 12800, 18432, 25088, 32768 },
+        [10] = { 0, 405, 1618, 3641, 6473, 10114, 14564, 19823, 25891, 32768 },
+        [11] = { 0, 328, 1311, 2949, 5243, 8192, 11796, 16056, 20972, 26542, 32768 },
+        [12] = { 0, 271, 1083, 2437, 4333, 6770, 9749, 13270, 17332, 21936, 27081, 32768 },
+    },
+};
+
 /* -------------------------------------------------------------
  * Generate gear scale values based on shape
  * ------------------------------------------------------------- */
 void vgear_generate_scales(vgear_table_t *t)
 {
-    if (!t || t->count == 0)
+    if (!t || t->count == 0 || t->count > VGEAR_MAX)
         return;
     uint16_t min = clamp_q15(t->min_scale_q15, VGEAR_SCALE_MIN_Q15, 65535u);
     uint16_t max = clamp_q15(t->max_scale_q15, min, 65535u);
-    if (t->count == 1)
-    {
-        t->scales[0] = min;
-        return;
-    }
+    const uint16_t *w = k_vgear_weight_q15[(t->shape == VGEAR_SHAPE_EXP) ? VGEAR_SHAPE_EXP : VGEAR_SHAPE_LINEAR][t->count];
+    uint32_t span = (uint32_t)(max - min);
     for (uint8_t i = 0; i < t->count; ++i)
-    {
-        if (t->shape == VGEAR_SHAPE_EXP)
-        {
-            /* Quadratic-ish growth: i^2 over (n-1)^2. */
-            uint32_t num = (uint32_t)(max - min) * (uint32_t)i * (uint32_t)i;
-            uint32_t den = (uint32_t)(t->count - 1u) * (uint32_t)(t->count - 1u);
-            t->scales[i] = (uint16_t)(min + num / den);
-        }
-        else
-        {
-            /* Linear step between min..max. */
-            uint32_t num = (uint32_t)(max - min) * (uint32_t)i;
-            uint32_t den = (uint32_t)(t->count - 1u);
-            t->scales[i] = (uint16_t)(min + num / den);
-        }
-    }
+        t->scales[i] = (uint16_t)(min + ((span * w[i] + 16384u) >> 15));
 }
 
 /* -------------------------------------------------------------
@@ -95,6 +117,8 @@ void vgear_adjust_min(int dir, uint16_t step)
         v = VGEAR_SCALE_MIN_Q15;
     if (v > (int32_t)g_vgears.max_scale_q15)
         v = g_vgears.max_scale_q15;
+    if ((uint16_t)v == g_vgears.min_scale_q15)
+        return;
     g_vgears.min_scale_q15 = (uint16_t)v;
     vgear_generate_scales(&g_vgears);
 }
@@ -109,10 +133,23 @@ void vgear_adjust_max(int dir, uint16_t step)
         v = g_vgears.min_scale_q15;
     if (v > (int32_t)VGEAR_SCALE_MAX_Q15)
         v = VGEAR_SCALE_MAX_Q15;
+    if ((uint16_t)v == g_vgears.max_scale_q15)
+        return;
     g_vgears.max_scale_q15 = (uint16_t)v;
     vgear_generate_scales(&g_vgears);
 }
 
+/* -------------------------------------------------------------
+ * Set shape, regenerating only when it changes
+ * ------------------------------------------------------------- */
+void vgear_set_shape(uint8_t shape)
+{
+    if (shape > VGEAR_SHAPE_EXP || shape == g_vgears.shape)
+        return;
+    g_vgears.shape = shape;
+    vgear_generate_scales(&g_vgears);
+}
+
 /* -------------------------------------------------------------
  * Cadence bias defaults
  * ------------------------------------------------------------- */
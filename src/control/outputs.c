@@ -0,0 +1,348 @@
+/*
+ * Control Pipeline
+ *
+ * recompute_outputs(): rider inputs through assist curves, virtual gear,
+ * cadence bias, cruise/adaptive assist, caps and the power policy to the
+ * motor command. Kept apart from main.c so host builds can drive it.
+ */
+
+#include "control.h"
+#include "app_data.h"
+#include "core.h"
+#include "core/math_util.h"
+#include "config/config.h"
+#include "motor/motor_cmd.h"
+#include "motor/shengyi.h"
+#include "power/power.h"
+#include "profiles/profiles.h"
+#include "state_snapshot.h"
+
+uint16_t g_curve_power_w;
+uint16_t g_curve_cadence_q15;
+uint16_t g_effective_cap_current_dA;
+uint16_t g_effective_cap_speed_dmph;
+uint16_t g_gear_limit_power_w;
+uint16_t g_gear_scale_q15;
+uint16_t g_cadence_bias_q15;
+
+static uint16_t cadence_bias_q15(uint16_t cadence_rpm)
+{
+    if (!g_cadence_bias.enabled || g_cadence_bias.band_rpm == 0)
+        return 32768u;
+    if (cadence_rpm <= g_cadence_bias.target_rpm)
+        return 32768u;
+    uint32_t delta = cadence_rpm - g_cadence_bias.target_rpm;
+    if (delta >= g_cadence_bias.band_rpm)
+        return clamp_q15(g_cadence_bias.min_bias_q15, 0, 65535u);
+    uint32_t span = g_cadence_bias.band_rpm;
+    uint32_t drop = (uint32_t)(32768u - g_cadence_bias.min_bias_q15);
+    uint32_t scaled = (drop * delta) / span;
+    uint32_t bias = 32768u - scaled;
+    return (uint16_t)clamp_q15((uint16_t)bias, g_cadence_bias.min_bias_q15, 32768u);
+}
+
+static int32_t cadence_bias_lut_fn(int32_t x, const void *ctx)
+{
+    (void)ctx;
+    return cadence_bias_q15((uint16_t)x);
+}
+
+/*
+ * Assist curves compiled for the active profile and cadence bias. They are
+ * rebuilt when either changes, so recompute_outputs() only indexes them.
+ */
+typedef struct {
+    uint8_t valid;
+    uint8_t profile_id;
+    cadence_bias_t bias_cfg;
+    fxp_lut_t speed;    /* W */
+    fxp_lut_t cadence;  /* Q15 */
+    fxp_lut_t bias;     /* Q15 */
+} assist_lut_t;
+
+static assist_lut_t g_assist_lut;
+
+static void assist_lut_refresh(void)
+{
+    const cadence_bias_t *cb = &g_cadence_bias;
+    assist_lut_t *l = &g_assist_lut;
+    if (l->valid && l->profile_id == g_active_profile_id &&
+        l->bias_cfg.enabled == cb->enabled && l->bias_cfg.target_rpm == cb->target_rpm &&
+        l->bias_cfg.band_rpm == cb->band_rpm && l->bias_cfg.min_bias_q15 == cb->min_bias_q15)
+        return;
+
+    const assist_curve_profile_t *cp = &g_assist_curves[g_active_profile_id];
+    fxp_lut_from_points(&l->speed, cp->speed_curve.pts, cp->speed_curve.count, 0);
+    fxp_lut_from_points(&l->cadence, cp->cadence_curve.pts, cp->cadence_curve.count, 32768);
+    if (cb->enabled && cb->band_rpm)
+        fxp_lut_build(&l->bias, cb->target_rpm, (int32_t)cb->target_rpm + cb->band_rpm,
+                      cadence_bias_lut_fn, NULL);
+    else
+        fxp_lut_from_points(&l->bias, NULL, 0, 32768);
+    l->profile_id = g_active_profile_id;
+    l->bias_cfg = *cb;
+    l->valid = 1u;
+}
+
+/*
+ * Profile, config and street-mode caps only change on a profile switch or
+ * a config write, so the effective caps are kept with the inputs they came
+ * from and re-derived when one of them differs.
+ */
+static struct {
+    uint8_t valid;
+    uint8_t profile_id;
+    uint8_t mode;
+    uint16_t cfg_cap_current_dA;
+    uint16_t cfg_cap_speed_dmph;
+} g_caps_key;
+
+static void effective_caps_refresh(void)
+{
+    if (g_caps_key.valid && g_caps_key.profile_id == g_active_profile_id &&
+        g_caps_key.mode == g_config_active.mode &&
+        g_caps_key.cfg_cap_current_dA == g_config_active.cap_current_dA &&
+        g_caps_key.cfg_cap_speed_dmph == g_config_active.cap_speed_dmph)
+        return;
+
+    const assist_profile_t *p = &g_profiles[g_active_profile_id];
+    uint16_t eff_cap_current = p->cap_current_dA;
+    uint16_t eff_cap_speed = p->cap_speed_dmph;
+
+    if (g_config_active.cap_current_dA && g_config_active.cap_current_dA < eff_cap_current)
+        eff_cap_current = g_config_active.cap_current_dA;
+    if (g_config_active.cap_speed_dmph)
+    {
+        if (eff_cap_speed == 0 || g_config_active.cap_speed_dmph < eff_cap_speed)
+            eff_cap_speed = g_config_active.cap_speed_dmph;
+    }
+    if (g_config_active.mode == MODE_STREET)
+    {
+        if (eff_cap_current > STREET_MAX_CURRENT_DA)
+            eff_cap_current = STREET_MAX_CURRENT_DA;
+        if (eff_cap_speed == 0 || eff_cap_speed > STREET_MAX_SPEED_DMPH)
+            eff_cap_speed = STREET_MAX_SPEED_DMPH;
+    }
+    g_effective_cap_current_dA = eff_cap_current;
+    g_effective_cap_speed_dmph = eff_cap_speed;
+
+    g_caps_key.profile_id = g_active_profile_id;
+    g_caps_key.mode = g_config_active.mode;
+    g_caps_key.cfg_cap_current_dA = g_config_active.cap_current_dA;
+    g_caps_key.cfg_cap_speed_dmph = g_config_active.cap_speed_dmph;
+    g_caps_key.valid = 1u;
+}
+
+void outputs_tables_changed(void)
+{
+    g_assist_lut.valid = 0u;
+    g_caps_key.valid = 0u;
+    assist_lut_refresh();
+    effective_caps_refresh();
+}
+
+void recompute_outputs(void)
+{
+    walk_update();
+
+    uint16_t base_power = (uint16_t)((g_inputs.throttle_pct * 8u) + (g_inputs.torque_raw / 4u));
+    const assist_profile_t *p = &g_profiles[g_active_profile_id];
+    effective_caps_refresh();
+    uint16_t eff_cap_current = g_effective_cap_current_dA;
+    uint16_t eff_cap_speed = g_effective_cap_speed_dmph;
+
+    g_outputs.profile_id     = g_active_profile_id;
+    g_outputs.virtual_gear   = g_active_vgear;
+
+    /* Curve-derived limits (compiled piecewise-linear tables, fixed-point). */
+    assist_lut_refresh();
+    int32_t curve_pw = fxp_lut_eval(&g_assist_lut.speed, (int32_t)g_inputs.speed_dmph);
+    int32_t cadence_q15 = fxp_lut_eval(&g_assist_lut.cadence, (int32_t)g_inputs.cadence_rpm);
+    if (cadence_q15 < 0)
+        cadence_q15 = 0;
+    int32_t curve_pw_scaled = (int32_t)((curve_pw * (int64_t)cadence_q15 + (1 << 14)) >> 15);
+    if (curve_pw_scaled < 0)
+        curve_pw_scaled = 0;
+    if (curve_pw_scaled > 0xFFFF)
+        curve_pw_scaled = 0xFFFF;
+
+    uint16_t limit_power = (uint16_t)curve_pw_scaled;
+    g_curve_power_w = limit_power;
+    g_curve_cadence_q15 = (uint16_t)cadence_q15;
+
+    /* Virtual gear multiplier (Q15) */
+    g_gear_scale_q15 = 32768u;
+    if (g_active_vgear >= 1 && g_active_vgear <= g_vgears.count)
+        g_gear_scale_q15 = g_vgears.scales[g_active_vgear - 1u];
+    g_gear_limit_power_w = (uint16_t)((limit_power * (uint32_t)g_gear_scale_q15 + (1u << 14)) >> 15);
+    if (g_gear_limit_power_w > 0xFFFF)
+        g_gear_limit_power_w = 0xFFFF;
+
+    /* Optional cadence-friendly taper above target band. */
+    g_cadence_bias_q15 = (uint16_t)fxp_lut_eval(&g_assist_lut.bias, (int32_t)g_inputs.cadence_rpm);
+    uint32_t biased_limit = (uint32_t)((g_gear_limit_power_w * (uint32_t)g_cadence_bias_q15 + (1u << 14)) >> 15);
+    if (biased_limit > 0xFFFF)
+        biased_limit = 0xFFFF;
+    limit_power = (uint16_t)biased_limit;
+
+    drive_mode_t drive_mode = g_drive.mode;
+    uint16_t desired_power = 0;
+    if (drive_mode == DRIVE_MODE_AUTO || drive_mode == DRIVE_MODE_SPORT)
+    {
+        desired_power = cruise_apply(base_power, limit_power);
+    }
+    else if (drive_mode == DRIVE_MODE_MANUAL_CURRENT)
+    {
+        if (g_cruise.mode != CRUISE_OFF)
+            cruise_cancel(CRUISE_EVT_CANCEL_USER);
+        uint32_t pwr = (uint32_t)g_drive.setpoint * 2u;
+        if (pwr > 0xFFFF)
+            pwr = 0xFFFF;
+        desired_power = (uint16_t)pwr;
+        limit_power = desired_power;
+    }
+    else if (drive_mode == DRIVE_MODE_MANUAL_POWER)
+    {
+        if (g_cruise.mode != CRUISE_OFF)
+            cruise_cancel(CRUISE_EVT_CANCEL_USER);
+        desired_power = manual_power_apply(g_drive.setpoint);
+        limit_power = 0xFFFF;
+    }
+    g_outputs.cruise_state = (uint8_t)g_cruise.mode;
+
+    {
+        uint8_t allow_adapt = (drive_mode == DRIVE_MODE_AUTO || drive_mode == DRIVE_MODE_SPORT) ? 1u : 0u;
+        uint8_t effort_on = (g_config_active.flags & CFG_FLAG_ADAPT_EFFORT) ? 1u : 0u;
+        uint8_t eco_on = (g_config_active.flags & CFG_FLAG_ADAPT_ECO) ? 1u : 0u;
+        if (!allow_adapt)
+            effort_on = eco_on = 0;
+
+        if (!(effort_on || eco_on))
+        {
+            adaptive_reset();
+        }
+        else
+        {
+            adaptive_update(g_inputs.speed_dmph, g_inputs.power_w, g_ms);
+            if (effort_on)
+            {
+                uint16_t boost = adaptive_effort_boost(base_power, g_inputs.speed_dmph);
+                if (boost > 0)
+                {
+                    uint32_t next = (uint32_t)desired_power + (uint32_t)boost;
+                    if (limit_power && next > limit_power)
+                        next = limit_power;
+                    if (next > 0xFFFFu)
+                        next = 0xFFFFu;
+                    desired_power = (uint16_t)next;
+                }
+            }
+            else
+            {
+                g_adapt.speed_delta_dmph = 0;
+                g_adapt.trend_active = 0;
+            }
+
+            if (eco_on)
+            {
+                desired_power = adaptive_eco_limit(desired_power);
+            }
+            else
+            {
+                g_adapt.eco_output_w = desired_power;
+                g_adapt.eco_clamp_active = 0u;
+                g_adapt.last_speed_dmph = g_inputs.speed_dmph;
+            }
+        }
+    }
+
+    g_outputs.cmd_power_w = desired_power;
+    if (g_outputs.cmd_power_w > limit_power)
+        g_outputs.cmd_power_w = limit_power;
+    g_outputs.cmd_current_dA = (uint16_t)(g_outputs.cmd_power_w / 2u);
+    g_outputs.assist_mode = (g_outputs.cmd_power_w > 0) ? 1u : 0u;
+
+    /* Enforce profile caps (speed cap zeros assist). */
+    if (eff_cap_speed && g_inputs.speed_dmph > eff_cap_speed)
+    {
+        cruise_cancel(CRUISE_EVT_CANCEL_CAP);
+        g_outputs.assist_mode = 0;
+        g_outputs.cmd_power_w = 0;
+        g_outputs.cmd_current_dA = 0;
+    }
+    else
+    {
+        if (g_outputs.cmd_power_w > p->cap_power_w)
+            g_outputs.cmd_power_w = p->cap_power_w;
+        if (g_outputs.cmd_current_dA > eff_cap_current)
+            g_outputs.cmd_current_dA = eff_cap_current;
+    }
+
+    if (g_walk_state == WALK_STATE_ACTIVE)
+    {
+        soft_start_reset();
+    }
+    else
+    {
+        g_outputs.cmd_power_w = soft_start_apply(g_outputs.cmd_power_w);
+        g_outputs.cmd_current_dA = (uint16_t)(g_outputs.cmd_power_w / 2u);
+    }
+
+    /* Apply multi-governor power policy (lugging/thermal/sag). */
+    power_policy_apply(g_outputs.cmd_power_w);
+    g_outputs.cmd_power_w = g_power_policy.p_final_w;
+    g_outputs.cmd_current_dA = (uint16_t)(g_outputs.cmd_power_w / 2u);
+    boost_update();
+
+    /* Reflect zeroed outputs in mode flag. */
+    if (g_outputs.cmd_power_w == 0 || g_outputs.cmd_current_dA == 0)
+        g_outputs.assist_mode = 0;
+
+    /* Walk assist overrides normal outputs when active. */
+    if (g_walk_state == WALK_STATE_ACTIVE)
+    {
+        g_outputs.assist_mode = 2; /* distinct walk flag */
+        g_outputs.cmd_power_w = g_walk_cmd_power_w;
+        g_outputs.cmd_current_dA = g_walk_cmd_current_dA;
+        g_outputs.cruise_state = 0;
+    }
+
+    /* Brake always zeros propulsion (walk + assist). */
+    if (g_inputs.brake)
+    {
+        cruise_cancel(CRUISE_EVT_CANCEL_BRAKE);
+        g_outputs.assist_mode = 0;
+        g_outputs.cmd_power_w = 0;
+        g_outputs.cmd_current_dA = 0;
+        g_outputs.cruise_state = 0;
+    }
+
+    if (motor_cmd_link_fault_active())
+    {
+        cruise_cancel(CRUISE_EVT_CANCEL_FAULT);
+        g_outputs.assist_mode = 0;
+        g_outputs.cmd_power_w = 0;
+        g_outputs.cmd_current_dA = 0;
+        g_outputs.cruise_state = 0;
+    }
+
+    regen_update();
+
+    if (g_outputs.cmd_current_dA > eff_cap_current)
+    {
+        g_outputs.cmd_current_dA = eff_cap_current;
+        {
+            uint32_t p_from_i = (uint32_t)g_outputs.cmd_current_dA * 2u;
+            if (g_outputs.cmd_power_w > p_from_i)
+                g_outputs.cmd_power_w = (uint16_t)p_from_i;
+        }
+    }
+
+    g_outputs.cruise_state = (uint8_t)g_cruise.mode;
+    g_outputs.last_ms        = g_ms;
+
+    g_drive.cmd_power_w = g_outputs.cmd_power_w;
+    g_drive.cmd_current_dA = g_outputs.cmd_current_dA;
+    shengyi_request_update(0u);
+    state_snapshot_publish(g_ms);
+}
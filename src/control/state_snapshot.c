@@ -0,0 +1,51 @@
+#include "state_snapshot.h"
+
+#include <string.h>
+
+#include "control/control.h"
+
+static state_snapshot_t g_snap[2];
+/* 2k: k publishes done, the newest in g_snap[k & 1]; 2k+1 while publish
+ * k+1 writes the other buffer. */
+static uint32_t g_snap_seq;
+
+static void state_snapshot_fill(state_snapshot_t *s, uint32_t now_ms)
+{
+    s->ms = now_ms;
+    s->motor = g_motor;
+    s->inputs = g_inputs;
+    s->outputs = g_outputs;
+    s->policy = g_power_policy;
+    s->walk_state = (uint8_t)g_walk_state;
+}
+
+void state_snapshot_publish(uint32_t now_ms)
+{
+    uint32_t seq = __atomic_load_n(&g_snap_seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&g_snap_seq, seq + 1u, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    state_snapshot_fill(&g_snap[((seq >> 1) + 1u) & 1u], now_ms);
+    __atomic_store_n(&g_snap_seq, seq + 2u, __ATOMIC_RELEASE);
+}
+
+uint32_t state_snapshot_read(state_snapshot_t *out)
+{
+    if (!out)
+        return 0;
+    for (;;)
+    {
+        uint32_t seq = __atomic_load_n(&g_snap_seq, __ATOMIC_ACQUIRE);
+        uint32_t done = seq >> 1;
+        if (done == 0u)
+        {
+            state_snapshot_fill(out, g_ms);
+            return 0;
+        }
+        memcpy(out, &g_snap[done & 1u], sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        /* The buffer is next rewritten by publish done + 2, which starts
+         * by moving seq to 2 * done + 3. */
+        if (__atomic_load_n(&g_snap_seq, __ATOMIC_RELAXED) - (done << 1) < 3u)
+            return done;
+    }
+}
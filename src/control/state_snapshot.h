@@ -0,0 +1,42 @@
+/*
+ * Control-cycle state snapshot
+ *
+ * The ride state (motor, inputs, outputs, power policy) is published as one
+ * copy at the end of each control cycle, so readers outside the cycle
+ * (telemetry replies, the status print, the UI model) see fields that
+ * belong together instead of piecing them from the live globals while the
+ * control step may run from PendSV in between.
+ *
+ * Two buffers alternate under a sequence counter that is odd while a
+ * publish is writing. A reader copies the last complete buffer and retries
+ * only if a second publish lapped it, so neither side masks interrupts and
+ * a reader that preempts the writer never waits for it.
+ */
+
+#ifndef STATE_SNAPSHOT_H
+#define STATE_SNAPSHOT_H
+
+#include <stdint.h>
+
+#include "app_data.h"
+#include "power/power.h"
+
+typedef struct {
+    uint32_t ms;                  /* time of the publish */
+    motor_state_t motor;
+    debug_inputs_t inputs;
+    debug_outputs_t outputs;
+    power_policy_state_t policy;
+    uint8_t walk_state;           /* walk_state_t */
+} state_snapshot_t;
+
+/* Copies the live state into the idle buffer and makes it current. Call at
+ * the end of the control cycle, from one context at a time. */
+void state_snapshot_publish(uint32_t now_ms);
+
+/* Copies the last published state into `out`; safe from any context.
+ * Returns the number of publishes so far (0: nothing published yet, `out`
+ * then holds the live state). */
+uint32_t state_snapshot_read(state_snapshot_t *out);
+
+#endif
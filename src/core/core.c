@@ -1,4 +1,5 @@
 #include "core.h"
+#include <string.h>
 
 static inline int16_t sample_at(const ringbuf_i16_t *rb, uint32_t sample_idx)
 {
@@ -111,6 +112,56 @@ void ringbuf_i16_push(ringbuf_i16_t *rb, int16_t sample)
     }
 }
 
+/*
+ * Rebuild a monotonic queue over the full window in one backward pass: an
+ * index stays queued iff no later sample beats it, which is exactly what
+ * capacity single pushes would have left behind. Entries are written
+ * newest-first ending at slot 0, so front..back stays oldest..newest.
+ */
+static void mono_queue_rebuild(mono_queue_t *q, const int16_t *w, uint16_t n,
+                               uint32_t base, int want_max)
+{
+    uint16_t mask = (uint16_t)(q->capacity - 1u);
+    uint16_t pos = 0;
+    int16_t best = w[n - 1u];
+    q->count = 0;
+    for (uint16_t i = n; i-- > 0u;)
+    {
+        int16_t v = w[i];
+        if (want_max ? (v < best) : (v > best))
+            continue;
+        best = v;
+        pos = (uint16_t)((pos - 1u) & mask);
+        q->buf[pos] = (uint16_t)(base + i);
+        q->count++;
+    }
+    q->head = pos;
+    q->tail = 0;
+}
+
+void ringbuf_i16_push_n(ringbuf_i16_t *rb, const int16_t *samples, uint32_t n)
+{
+    if (!rb || !samples || rb->capacity == 0)
+        return;
+    if (n < rb->capacity)
+    {
+        for (uint32_t i = 0; i < n; ++i)
+            ringbuf_i16_push(rb, samples[i]);
+        return;
+    }
+
+    /* Only the newest capacity samples survive; skip the queue churn of the rest. */
+    uint16_t cap = rb->capacity;
+    const int16_t *w = samples + (n - cap);
+    uint32_t base = rb->head + (n - cap);
+    for (uint16_t i = 0; i < cap; ++i)
+        rb->data[(base + i) & rb->mask] = w[i];
+    rb->head = base + cap;
+    rb->count = cap;
+    mono_queue_rebuild(&rb->min_q, w, cap, base, 0);
+    mono_queue_rebuild(&rb->max_q, w, cap, base, 1);
+}
+
 void ringbuf_i16_summary(const ringbuf_i16_t *rb, ringbuf_i16_summary_t *out)
 {
     if (!rb || !out)
@@ -129,33 +180,496 @@ void ringbuf_i16_summary(const ringbuf_i16_t *rb, ringbuf_i16_summary_t *out)
     out->max = sample_at(rb, mono_queue_front(&rb->max_q));
 }
 
-/* Minimal libc stubs (freestanding build) */
-void __aeabi_memclr(void *dest, size_t n)
+void dring_i16_init(dring_i16_t *r, dring_block_t *storage, uint16_t capacity,
+                    uint16_t *min_idx_buf, uint16_t *max_idx_buf)
+{
+    if (!r || !storage || !min_idx_buf || !max_idx_buf)
+        return;
+    if (capacity < 2u || (capacity & (capacity - 1u)))
+        return;
+    r->blocks = storage;
+    r->capacity = capacity;
+    r->mask = (uint16_t)(capacity - 1u);
+    r->min_q.buf = min_idx_buf;
+    r->min_q.capacity = capacity;
+    r->max_q.buf = max_idx_buf;
+    r->max_q.capacity = capacity;
+    dring_i16_reset(r);
+}
+
+void dring_i16_reset(dring_i16_t *r)
+{
+    if (!r)
+        return;
+    r->full = 0;
+    r->fill = 0;
+    r->recon = 0;
+    r->latest = 0;
+    r->head = 0;
+    r->min_q.head = r->min_q.tail = r->min_q.count = 0;
+    r->max_q.head = r->max_q.tail = r->max_q.count = 0;
+}
+
+static inline const dring_block_t *dring_block(const dring_i16_t *r, uint32_t idx)
+{
+    return &r->blocks[idx & r->mask];
+}
+
+/* Open block is full: it joins the queues and the next slot opens, evicting
+ * the oldest completed block once every slot is in use. */
+static void dring_close_block(dring_i16_t *r)
+{
+    uint32_t idx = r->head;
+    const dring_block_t *b = dring_block(r, idx);
+    while (!mono_queue_empty(&r->min_q) && dring_block(r, mono_queue_back(&r->min_q))->min > b->min)
+        mono_queue_pop_back(&r->min_q);
+    mono_queue_push_back(&r->min_q, (uint16_t)idx);
+    while (!mono_queue_empty(&r->max_q) && dring_block(r, mono_queue_back(&r->max_q))->max < b->max)
+        mono_queue_pop_back(&r->max_q);
+    mono_queue_push_back(&r->max_q, (uint16_t)idx);
+
+    r->head++;
+    r->fill = 0;
+    if (r->full < r->capacity - 1u)
+    {
+        r->full++;
+        return;
+    }
+    uint16_t evict = (uint16_t)(r->head - r->capacity);
+    if (!mono_queue_empty(&r->min_q) && mono_queue_front(&r->min_q) == evict)
+        mono_queue_pop_front(&r->min_q);
+    if (!mono_queue_empty(&r->max_q) && mono_queue_front(&r->max_q) == evict)
+        mono_queue_pop_front(&r->max_q);
+}
+
+void dring_i16_push(dring_i16_t *r, int16_t sample)
+{
+    if (!r || r->capacity == 0)
+        return;
+    dring_block_t *b = &r->blocks[r->head & r->mask];
+    if (r->fill == 0u)
+    {
+        b->key = sample;
+        b->min = sample;
+        b->max = sample;
+        r->recon = sample;
+    }
+    else
+    {
+        int32_t d = (int32_t)sample - r->recon;
+        if (d > 127)
+            d = 127;
+        else if (d < -128)
+            d = -128;
+        b->delta[r->fill - 1u] = (int8_t)d;
+        r->recon = (int16_t)(r->recon + d);
+        if (sample < b->min)
+            b->min = sample;
+        if (sample > b->max)
+            b->max = sample;
+    }
+    r->latest = sample;
+    r->fill++;
+    if (r->fill == DRING_BLOCK)
+        dring_close_block(r);
+}
+
+void dring_i16_summary(const dring_i16_t *r, ringbuf_i16_summary_t *out)
+{
+    if (!r || !out)
+        return;
+    out->capacity = (uint16_t)((r->capacity - 1u) * DRING_BLOCK + (DRING_BLOCK - 1u));
+    out->count = (uint16_t)(r->full * DRING_BLOCK + r->fill);
+    if (out->count == 0)
+    {
+        out->min = 0;
+        out->max = 0;
+        out->latest = 0;
+        return;
+    }
+    out->latest = r->latest;
+    int16_t mn = 0;
+    int16_t mx = 0;
+    uint8_t have = 0;
+    if (r->full)
+    {
+        mn = dring_block(r, mono_queue_front(&r->min_q))->min;
+        mx = dring_block(r, mono_queue_front(&r->max_q))->max;
+        have = 1;
+    }
+    if (r->fill)
+    {
+        const dring_block_t *b = dring_block(r, r->head);
+        if (!have || b->min < mn)
+            mn = b->min;
+        if (!have || b->max > mx)
+            mx = b->max;
+    }
+    out->min = mn;
+    out->max = mx;
+}
+
+int dring_i16_sample(const dring_i16_t *r, uint16_t back, int16_t *out)
+{
+    if (!r || !out || r->capacity == 0)
+        return 0;
+    uint32_t idx;
+    uint8_t k;
+    if (back < r->fill)
+    {
+        idx = r->head;
+        k = (uint8_t)(r->fill - 1u - back);
+    }
+    else
+    {
+        uint32_t older = (uint32_t)back - r->fill;
+        if (older >= (uint32_t)r->full * DRING_BLOCK)
+            return 0;
+        idx = r->head - 1u - older / DRING_BLOCK;
+        k = (uint8_t)(DRING_BLOCK - 1u - older % DRING_BLOCK);
+    }
+    const dring_block_t *b = dring_block(r, idx);
+    int32_t v = b->key;
+    for (uint8_t i = 0; i < k; ++i)
+        v += b->delta[i];
+    *out = (int16_t)v;
+    return 1;
+}
+
+void fxp_lut_build(fxp_lut_t *lut, int32_t x0, int32_t x1, fxp_lut_fn fn, const void *ctx)
+{
+    if (!lut || !fn)
+        return;
+    if (x1 < x0)
+        x1 = x0;
+    uint32_t span = (uint32_t)(x1 - x0);
+    uint8_t shift = 0;
+    while ((span >> shift) + ((span & ((1u << shift) - 1u)) ? 1u : 0u) > FXP_LUT_MAX_BINS)
+        shift++;
+    lut->x0 = x0;
+    lut->x1 = x1;
+    lut->shift = shift;
+    lut->bins = (uint8_t)((span + (1u << shift) - 1u) >> shift);
+    for (uint32_t i = 0; i <= lut->bins; ++i)
+    {
+        int32_t x = x0 + (int32_t)(i << shift);
+        lut->y[i] = fn(x > x1 ? x1 : x, ctx);
+    }
+    for (uint32_t i = 0; i < lut->bins; ++i)
+        lut->dy[i] = lut->y[i + 1u] - lut->y[i];
+}
+
+typedef struct {
+    const fxp_point_t *pts;
+    size_t count;
+} fxp_lut_points_t;
+
+static int32_t fxp_lut_points_fn(int32_t x, const void *ctx)
+{
+    const fxp_lut_points_t *c = (const fxp_lut_points_t *)ctx;
+    return fxp_interp_linear(x, c->pts, c->count);
+}
+
+void fxp_lut_from_points(fxp_lut_t *lut, const fxp_point_t *pts, size_t count, int32_t empty_y)
+{
+    if (!lut)
+        return;
+    if (!pts || count == 0)
+    {
+        lut->x0 = 0;
+        lut->x1 = 0;
+        lut->shift = 0;
+        lut->bins = 0;
+        lut->y[0] = empty_y;
+        return;
+    }
+    fxp_lut_points_t c = { pts, count };
+    fxp_lut_build(lut, pts[0].x, pts[count - 1u].x, fxp_lut_points_fn, &c);
+}
+
+static void pyramid_acc_clear(pyramid_acc_t *a)
+{
+    a->sum = 0;
+    a->min = 0;
+    a->max = 0;
+    a->n = 0;
+}
+
+static void pyramid_acc_add(pyramid_acc_t *a, int16_t min, int16_t max, int16_t mean)
+{
+    if (a->n == 0u || min < a->min)
+        a->min = min;
+    if (a->n == 0u || max > a->max)
+        a->max = max;
+    a->sum += mean;
+    a->n++;
+}
+
+static int16_t pyramid_acc_mean(const pyramid_acc_t *a)
+{
+    if (a->n == 0u)
+        return 0;
+    int32_t half = (int32_t)(a->n / 2u);
+    int32_t q = (a->sum >= 0) ? (a->sum + half) / a->n : (a->sum - half) / a->n;
+    return (int16_t)q;
+}
+
+void pyramid_i16_init(pyramid_i16_t *p, pyramid_cell_t *storage, uint16_t cap,
+                      uint8_t levels, const uint8_t *factors)
+{
+    if (!p || !storage || !factors || cap == 0u || levels == 0u || levels > PYRAMID_MAX_LEVELS)
+        return;
+    p->cells = storage;
+    p->cap = cap;
+    p->levels = levels;
+    for (uint8_t i = 0; i < levels; ++i)
+        p->factor[i] = (i == 0u || factors[i] == 0u) ? 1u : factors[i];
+    pyramid_i16_reset(p);
+}
+
+void pyramid_i16_reset(pyramid_i16_t *p)
+{
+    if (!p)
+        return;
+    for (uint8_t i = 0; i < PYRAMID_MAX_LEVELS; ++i)
+    {
+        p->head[i] = 0u;
+        pyramid_acc_clear(&p->acc[i]);
+    }
+    p->latest = 0;
+}
+
+void pyramid_i16_add(pyramid_i16_t *p, int16_t sample)
+{
+    if (!p || !p->cells)
+        return;
+    pyramid_acc_add(&p->acc[0], sample, sample, sample);
+    p->latest = sample;
+}
+
+void pyramid_i16_commit(pyramid_i16_t *p)
+{
+    if (!p || !p->cells)
+        return;
+    if (p->acc[0].n == 0u)
+        pyramid_acc_add(&p->acc[0], p->latest, p->latest, p->latest);
+    for (uint8_t lvl = 0; lvl < p->levels; ++lvl)
+    {
+        pyramid_acc_t *a = &p->acc[lvl];
+        pyramid_cell_t c = { a->min, a->max, pyramid_acc_mean(a) };
+        p->cells[(uint32_t)lvl * p->cap + (p->head[lvl] % p->cap)] = c;
+        p->head[lvl]++;
+        pyramid_acc_clear(a);
+        if (lvl + 1u >= p->levels)
+            break;
+        pyramid_acc_t *up = &p->acc[lvl + 1u];
+        pyramid_acc_add(up, c.min, c.max, c.mean);
+        if (up->n < p->factor[lvl + 1u])
+            break;
+    }
+}
+
+/* The partial cell of `level`, with the finer levels that have not folded
+ * into it yet: their extremes fold in, and the mean comes from the coarsest
+ * one that has data. */
+static pyramid_acc_t pyramid_partial(const pyramid_i16_t *p, uint8_t level)
+{
+    pyramid_acc_t a = p->acc[level];
+    for (uint8_t lvl = level; lvl-- > 0u;)
+    {
+        const pyramid_acc_t *f = &p->acc[lvl];
+        if (f->n == 0u)
+            continue;
+        if (a.n == 0u)
+        {
+            a = *f;
+            continue;
+        }
+        if (f->min < a.min)
+            a.min = f->min;
+        if (f->max > a.max)
+            a.max = f->max;
+    }
+    return a;
+}
+
+void pyramid_i16_summary(const pyramid_i16_t *p, uint8_t level, uint16_t cells,
+                         pyramid_i16_summary_t *out)
+{
+    if (!out)
+        return;
+    out->count = 0u;
+    out->capacity = 0u;
+    out->min = out->max = out->mean = out->latest = 0;
+    if (!p || !p->cells || level >= p->levels)
+        return;
+    if (cells > p->cap)
+        cells = p->cap;
+    out->capacity = cells;
+
+    /* The partial cell is part of the window; its oldest full cell drops. */
+    pyramid_acc_t a = pyramid_partial(p, level);
+    uint16_t full = (a.n && cells) ? (uint16_t)(cells - 1u) : cells;
+    uint32_t have = p->head[level];
+    if (full > have)
+        full = (uint16_t)have;
+    const pyramid_cell_t *base = &p->cells[(uint32_t)level * p->cap];
+    int32_t sum = 0;
+    int16_t mn = 0;
+    int16_t mx = 0;
+    uint16_t n = 0u;
+    for (uint16_t i = 0; i < full; ++i)
+    {
+        const pyramid_cell_t *c = &base[(have - 1u - i) % p->cap];
+        if (n == 0u || c->min < mn)
+            mn = c->min;
+        if (n == 0u || c->max > mx)
+            mx = c->max;
+        sum += c->mean;
+        n++;
+    }
+    if (a.n)
+    {
+        int16_t am = pyramid_acc_mean(&a);
+        if (n == 0u || a.min < mn)
+            mn = a.min;
+        if (n == 0u || a.max > mx)
+            mx = a.max;
+        sum += am;
+        n++;
+    }
+    if (n == 0u)
+        return;
+    out->count = n;
+    out->min = mn;
+    out->max = mx;
+    out->mean = (int16_t)(sum / (int32_t)n);
+    out->latest = p->latest;
+}
+
+/* First column of absolute cell k when every `cells` cells span `cols`
+ * columns; wraps with k, which only a modulo consumer sees. */
+static uint32_t pyramid_col_of(uint32_t k, uint16_t cells, uint16_t cols)
+{
+    return (k / cells) * cols + (k % cells) * cols / cells;
+}
+
+uint16_t pyramid_i16_columns(const pyramid_i16_t *p, uint8_t level, uint16_t cells,
+                             uint16_t cols, int16_t *min, int16_t *max, uint32_t *last_col)
+{
+    if (!p || !p->cells || level >= p->levels || !min || !max || cols == 0u || cells == 0u)
+        return 0u;
+    if (cells > p->cap)
+        cells = p->cap;
+
+    pyramid_acc_t a = pyramid_partial(p, level);
+    uint32_t have = p->head[level];
+    uint32_t full = (a.n) ? (uint32_t)(cells - 1u) : cells;
+    if (full > have)
+        full = have;
+    uint32_t avail = full + (a.n ? 1u : 0u);
+    if (avail == 0u)
+        return 0u;
+    /* Absolute cell numbers: full cells 0..have-1, the partial one is have. */
+    uint32_t newest = a.n ? have : have - 1u;
+    uint32_t oldest = newest - (avail - 1u);
+    uint32_t end = pyramid_col_of(newest + 1u, cells, cols);
+    uint32_t newest_col = pyramid_col_of(newest, cells, cols);
+    if (end == newest_col)
+        end = newest_col + 1u;
+    uint32_t first = pyramid_col_of(oldest, cells, cols);
+    if (end - first > cols)
+        first = end - cols;
+    const pyramid_cell_t *base = &p->cells[(uint32_t)level * p->cap];
+
+    uint16_t n = (uint16_t)(end - first);
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        min[i] = INT16_MAX;
+        max[i] = INT16_MIN;
+    }
+    for (uint32_t k = oldest; k != newest + 1u; ++k)
+    {
+        int16_t cmin;
+        int16_t cmax;
+        if (a.n && k == have)
+        {
+            cmin = a.min;
+            cmax = a.max;
+        }
+        else
+        {
+            const pyramid_cell_t *cell = &base[k % p->cap];
+            cmin = cell->min;
+            cmax = cell->max;
+        }
+        uint32_t c0 = pyramid_col_of(k, cells, cols);
+        uint32_t c1 = pyramid_col_of(k + 1u, cells, cols);
+        if (c1 == c0)
+            c1 = c0 + 1u;
+        for (uint32_t c = c0; c != c1; ++c)
+        {
+            uint32_t i = c - first;
+            if (i >= n)
+                continue;
+            if (cmin < min[i])
+                min[i] = cmin;
+            if (cmax > max[i])
+                max[i] = cmax;
+        }
+    }
+    if (last_col)
+        *last_col = end - 1u;
+    return n;
+}
+
+uint16_t pyramid_i16_cells(const pyramid_i16_t *p, uint8_t level, uint32_t first, uint16_t max,
+                           pyramid_cell_t *out, uint32_t *first_out)
+{
+    if (!p || !p->cells || level >= p->levels || !out)
+        return 0u;
+    uint32_t have = p->head[level];
+    uint32_t oldest = (have > p->cap) ? have - p->cap : 0u;
+    if (first < oldest)
+        first = oldest;
+    if (first_out)
+        *first_out = first;
+    if (first >= have)
+        return 0u;
+    uint32_t n = have - first;
+    if (n > max)
+        n = max;
+    const pyramid_cell_t *base = &p->cells[(uint32_t)level * p->cap];
+    for (uint32_t i = 0; i < n; ++i)
+        out[i] = base[(first + i) % p->cap];
+    return (uint16_t)n;
+}
+
+/* AEABI memory helpers (freestanding build): the compiler emits these for
+ * struct copies and clears; the 4/8 variants only promise alignment, which
+ * libc's memcpy/memset find for themselves. Marked used because the calls
+ * only appear after link-time optimization has run. */
+__attribute__((used)) void __aeabi_memclr(void *dest, size_t n)
 {
-    uint8_t *d = (uint8_t *)dest;
-    for (size_t i = 0; i < n; ++i)
-        d[i] = 0;
+    (void)memset(dest, 0, n);
 }
 
-void __aeabi_memclr4(void *dest, size_t n)
+__attribute__((used)) void __aeabi_memclr4(void *dest, size_t n)
 {
-    __aeabi_memclr(dest, n);
+    (void)memset(dest, 0, n);
 }
 
-void __aeabi_memcpy4(void *dest, const void *src, size_t n)
+__attribute__((used)) void __aeabi_memcpy4(void *dest, const void *src, size_t n)
 {
-    uint8_t *d = (uint8_t *)dest;
-    const uint8_t *s = (const uint8_t *)src;
-    for (size_t i = 0; i < n; ++i)
-        d[i] = s[i];
+    (void)memcpy(dest, src, n);
 }
 
-void __aeabi_memcpy(void *dest, const void *src, size_t n)
+__attribute__((used)) void __aeabi_memcpy(void *dest, const void *src, size_t n)
 {
-    __aeabi_memcpy4(dest, src, n);
+    (void)memcpy(dest, src, n);
 }
 
-void __aeabi_memcpy8(void *dest, const void *src, size_t n)
+__attribute__((used)) void __aeabi_memcpy8(void *dest, const void *src, size_t n)
 {
-    __aeabi_memcpy4(dest, src, n);
+    (void)memcpy(dest, src, n);
 }
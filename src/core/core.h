@@ -36,10 +36,17 @@ static inline int32_t fxp_watts_from_mv_ma(int32_t mv, int32_t ma)
 /* Convert meters-per-second (scaled by 1e3) to deci-mph (0.1 mph). */
 static inline int16_t fxp_mps1000_to_dmph(int32_t mps_x1000)
 {
-    /* 1 m/s = 2.23694 mph -> 22.3694 deci-mph. Scale by 1000. */
-    const int64_t num = 223694;   /* deci-mph * 1e4 per m/s */
-    const int64_t denom = 100000; /* accounts for x1000 input */
-    return (int16_t)((mps_x1000 * num + (denom / 2)) / denom);
+    /* 1 m/s = 2.23694 mph -> 22.3694 deci-mph. Scale by 1000. 223694/100000
+     * reduced to 111847/50000 stays in 32 bits over the whole int16 result
+     * range; inputs past it saturate. */
+    const int32_t lim = 19000;
+    int32_t m = (mps_x1000 > lim) ? lim : (mps_x1000 < -lim) ? -lim : mps_x1000;
+    int32_t d = (m * 111847 + 25000) / 50000;
+    if (d > INT16_MAX)
+        return INT16_MAX;
+    if (d < INT16_MIN)
+        return INT16_MIN;
+    return (int16_t)d;
 }
 
 /* Simple piecewise-linear interpolation for bounded arrays. */
@@ -75,6 +82,43 @@ static inline int32_t fxp_interp_linear(int32_t x, const fxp_point_t *pts, size_
     return pts[count - 1].y;
 }
 
+/*
+ * Uniform-step lookup table compiled from a curve. Nodes sit every
+ * 1 << shift from x0 (the step is the smallest power of two that fits the
+ * span in FXP_LUT_MAX_BINS bins) and each bin keeps its rise, so a lookup
+ * is index, multiply, shift. Nodes are exact; inside a bin that straddles a
+ * breakpoint the result is the chord between the two nodes.
+ */
+#define FXP_LUT_MAX_BINS 64u
+
+typedef struct {
+    int32_t x0;
+    int32_t x1;
+    uint8_t shift;
+    uint8_t bins;
+    int32_t y[FXP_LUT_MAX_BINS + 1u];
+    int32_t dy[FXP_LUT_MAX_BINS];
+} fxp_lut_t;
+
+typedef int32_t (*fxp_lut_fn)(int32_t x, const void *ctx);
+
+/* Samples fn at the nodes over [x0, x1]; x outside stays at the end values. */
+void fxp_lut_build(fxp_lut_t *lut, int32_t x0, int32_t x1, fxp_lut_fn fn, const void *ctx);
+/* Table of fxp_interp_linear over pts; empty_y when count is 0. */
+void fxp_lut_from_points(fxp_lut_t *lut, const fxp_point_t *pts, size_t count, int32_t empty_y);
+
+static inline int32_t fxp_lut_eval(const fxp_lut_t *lut, int32_t x)
+{
+    if (x <= lut->x0)
+        return lut->y[0];
+    if (x >= lut->x1)
+        return lut->y[lut->bins];
+    uint32_t d = (uint32_t)(x - lut->x0);
+    uint32_t i = d >> lut->shift;
+    int32_t r = (int32_t)(d & ((1u << lut->shift) - 1u));
+    return lut->y[i] + ((r * lut->dy[i]) >> lut->shift);
+}
+
 /* -------------------------------------------------------------
  * Ring buffer with O(1) min/max over the active window.
  * ------------------------------------------------------------- */
@@ -109,6 +153,118 @@ void ringbuf_i16_init(ringbuf_i16_t *rb, int16_t *storage, uint16_t capacity,
                       uint16_t *min_idx_buf, uint16_t *max_idx_buf);
 void ringbuf_i16_reset(ringbuf_i16_t *rb);
 void ringbuf_i16_push(ringbuf_i16_t *rb, int16_t sample);
+/* Same result as n single pushes; n >= capacity refills in one linear pass. */
+void ringbuf_i16_push_n(ringbuf_i16_t *rb, const int16_t *samples, uint32_t n);
 void ringbuf_i16_summary(const ringbuf_i16_t *rb, ringbuf_i16_summary_t *out);
 
+/* -------------------------------------------------------------
+ * Delta-coded ring for slow signals
+ *
+ * Samples are kept in blocks of DRING_BLOCK: the first as a keyframe, the
+ * rest as 8-bit deltas against the reconstructed previous sample (a jump
+ * beyond +-127 is spread over the following deltas). Each block also keeps
+ * its exact min/max, and the completed blocks feed the same monotonic
+ * queues as ringbuf_i16_t, so the summary stays O(1). The window drops
+ * whole blocks: it spans (blocks - 1) full blocks plus the open one.
+ * ------------------------------------------------------------- */
+#define DRING_BLOCK 16u
+
+typedef struct {
+    int16_t key;
+    int16_t min;
+    int16_t max;
+    int8_t delta[DRING_BLOCK - 1u];
+} dring_block_t;
+
+typedef struct {
+    dring_block_t *blocks;
+    uint16_t capacity; /* blocks; must be power-of-two */
+    uint16_t mask;
+    uint16_t full;     /* completed blocks in the window */
+    uint8_t fill;      /* samples in the open block */
+    int16_t recon;     /* decoded value of the newest sample */
+    int16_t latest;    /* exact newest sample */
+    uint32_t head;     /* monotonic index of the open block */
+    mono_queue_t min_q;
+    mono_queue_t max_q;
+} dring_i16_t;
+
+void dring_i16_init(dring_i16_t *r, dring_block_t *storage, uint16_t capacity,
+                    uint16_t *min_idx_buf, uint16_t *max_idx_buf);
+void dring_i16_reset(dring_i16_t *r);
+void dring_i16_push(dring_i16_t *r, int16_t sample);
+/* capacity in the summary is in samples. */
+void dring_i16_summary(const dring_i16_t *r, ringbuf_i16_summary_t *out);
+/* Decoded sample `back` samples ago (0 = newest); 0 when out of range. */
+int dring_i16_sample(const dring_i16_t *r, uint16_t back, int16_t *out);
+
+/* -------------------------------------------------------------
+ * Min/max/mean pyramid (multi-resolution history)
+ *
+ * Level 0 closes one cell per base period from the raw samples added since
+ * the last commit; every factor[i] closed cells of level i-1 fold into one
+ * cell of level i. Each level is a ring of `cap` cells, so level i covers
+ * cap * base * factor[1] * ... * factor[i] of history in the same memory.
+ * ------------------------------------------------------------- */
+#define PYRAMID_MAX_LEVELS 6u
+
+typedef struct {
+    int16_t min;
+    int16_t max;
+    int16_t mean;
+} pyramid_cell_t;
+
+typedef struct {
+    int32_t sum;
+    int16_t min;
+    int16_t max;
+    uint16_t n;
+} pyramid_acc_t;
+
+typedef struct {
+    pyramid_cell_t *cells;              /* levels x cap, level-major */
+    uint16_t cap;
+    uint8_t levels;
+    uint8_t factor[PYRAMID_MAX_LEVELS]; /* factor[0] unused */
+    uint32_t head[PYRAMID_MAX_LEVELS];  /* monotonic cell count per level */
+    pyramid_acc_t acc[PYRAMID_MAX_LEVELS]; /* cell being filled per level */
+    int16_t latest;
+} pyramid_i16_t;
+
+typedef struct {
+    uint16_t count;     /* cells (including a partial one) in the window */
+    uint16_t capacity;  /* cells the window spans at this level */
+    int16_t min;
+    int16_t max;
+    int16_t mean;
+    int16_t latest;
+} pyramid_i16_summary_t;
+
+/* factors[1..levels-1] >= 1; storage holds levels * cap cells. */
+void pyramid_i16_init(pyramid_i16_t *p, pyramid_cell_t *storage, uint16_t cap,
+                      uint8_t levels, const uint8_t *factors);
+void pyramid_i16_reset(pyramid_i16_t *p);
+/* Raw sample into the level-0 cell being filled. */
+void pyramid_i16_add(pyramid_i16_t *p, int16_t sample);
+/* Close the level-0 cell (one base period); with no samples added it
+ * repeats the latest value. Full coarser cells cascade up. */
+void pyramid_i16_commit(pyramid_i16_t *p);
+/* Summary of the newest `cells` cells of `level` plus its partial cell. */
+void pyramid_i16_summary(const pyramid_i16_t *p, uint8_t level, uint16_t cells,
+                         pyramid_i16_summary_t *out);
+/* The same window as min/max columns, oldest first, for strip charts.
+ * Every `cells` cells span `cols` columns on a grid anchored to the absolute
+ * cell count, so a column keeps its number while the window slides: only
+ * the newest columns change from one call to the next. *last_col gets the
+ * number of the newest column. A short history returns fewer than `cols`.
+ * Returns the columns written. */
+uint16_t pyramid_i16_columns(const pyramid_i16_t *p, uint8_t level, uint16_t cells,
+                             uint16_t cols, int16_t *min, int16_t *max, uint32_t *last_col);
+/* Closed cells of `level` by absolute number, oldest first, for bulk export:
+ * from cell `first` (or the oldest still held, when the ring has moved past
+ * it) up to the level's head, at most `max` of them. *first_out gets the
+ * number of the first cell copied; the head is p->head[level]. */
+uint16_t pyramid_i16_cells(const pyramid_i16_t *p, uint8_t level, uint32_t first, uint16_t max,
+                           pyramid_cell_t *out, uint32_t *first_out);
+
 #endif /* CORE_H */
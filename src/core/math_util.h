@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <limits.h>
 
+#include "libc/div64.h"
+
 /* Clamping utilities */
 static inline uint16_t clamp_q15(uint16_t v, uint16_t mn, uint16_t mx)
 {
@@ -73,24 +75,12 @@ static inline int32_t ema_i32(int32_t state, int32_t sample, uint32_t dt_ms, uin
     return next;
 }
 
-/* Integer division for 64-bit numerator (manual implementation to avoid libgcc) */
+/* Low 32 bits of n / d without the 64-bit runtime divide (libc/div64.h) */
 static inline uint32_t divu64_32(uint64_t n, uint32_t d)
 {
     if (d == 0)
         return 0xFFFFFFFFu;
-
-    uint64_t rem = 0;
-    uint32_t q = 0;
-    for (int i = 63; i >= 0; --i)
-    {
-        rem = (rem << 1) | ((n >> i) & 1ull);
-        if (rem >= d)
-        {
-            rem -= d;
-            q |= (uint32_t)(1ull << i);
-        }
-    }
-    return q;
+    return div64_u32(n, d);
 }
 
 #endif /* MATH_UTIL_H */
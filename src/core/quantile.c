@@ -0,0 +1,88 @@
+#include "quantile.h"
+
+static uint16_t qhist_bin_of(uint16_t v)
+{
+    if (v < QHIST_LINEAR_BINS)
+        return v;
+    if (v > QHIST_MAX_VALUE)
+        return (uint16_t)(QHIST_BINS - 1u);
+    uint32_t k = 31u - (uint32_t)__builtin_clz(v);     /* octave: 4..11 */
+    uint32_t sub = ((uint32_t)v >> (k - 3u)) & (QHIST_SUB_BINS - 1u);
+    return (uint16_t)(QHIST_LINEAR_BINS + (k - 4u) * QHIST_SUB_BINS + sub);
+}
+
+static void qhist_bin_range(uint16_t idx, uint32_t *lo, uint32_t *width)
+{
+    if (idx < QHIST_LINEAR_BINS)
+    {
+        *lo = idx;
+        *width = 1u;
+        return;
+    }
+    uint32_t k = 4u + (idx - QHIST_LINEAR_BINS) / QHIST_SUB_BINS;
+    uint32_t sub = (idx - QHIST_LINEAR_BINS) % QHIST_SUB_BINS;
+    *lo = (QHIST_SUB_BINS + sub) << (k - 3u);
+    *width = 1u << (k - 3u);
+}
+
+static uint32_t qhist_sat_add(uint32_t a, uint32_t b)
+{
+    uint32_t out = a + b;
+    return (out < a) ? 0xFFFFFFFFu : out;
+}
+
+void qhist_reset(qhist_t *h)
+{
+    if (!h)
+        return;
+    for (uint16_t i = 0; i < QHIST_BINS; ++i)
+        h->bin[i] = 0u;
+    h->total = 0u;
+    h->max = 0u;
+}
+
+void qhist_add(qhist_t *h, uint16_t value, uint32_t weight)
+{
+    if (!h || weight == 0u)
+        return;
+    uint16_t idx = qhist_bin_of(value);
+    h->bin[idx] = qhist_sat_add(h->bin[idx], weight);
+    h->total = qhist_sat_add(h->total, weight);
+    if (value > h->max)
+        h->max = value;
+}
+
+uint16_t qhist_quantile(const qhist_t *h, uint16_t permille)
+{
+    if (!h || h->total == 0u)
+        return 0u;
+    if (permille >= 1000u)
+        return h->max;
+    /* total * permille / 1000 without a 64-bit product. */
+    uint32_t target = (h->total / 1000u) * permille + ((h->total % 1000u) * permille) / 1000u;
+    uint32_t before = 0u;
+    for (uint16_t i = 0; i < QHIST_BINS; ++i)
+    {
+        uint32_t w = h->bin[i];
+        if (w == 0u || before + w < target)
+        {
+            before += w;
+            continue;
+        }
+        uint32_t lo;
+        uint32_t width;
+        qhist_bin_range(i, &lo, &width);
+        /* Interpolate inside the bin; scale down so r * width fits 32 bits. */
+        uint32_t r = target - before;
+        while (w > 0x7FFFFFu)
+        {
+            w >>= 1;
+            r >>= 1;
+        }
+        uint32_t v = lo + (r * width) / w;
+        if (v >= lo + width)
+            v = lo + width - 1u;
+        return (v > h->max) ? h->max : (uint16_t)v;
+    }
+    return h->max;
+}
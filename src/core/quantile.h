@@ -0,0 +1,34 @@
+#ifndef QUANTILE_H
+#define QUANTILE_H
+
+#include <stdint.h>
+
+/*
+ * Streaming quantiles over a fixed log-linear histogram.
+ *
+ * Values 0..15 get one bin each; above that every octave up to
+ * QHIST_MAX_VALUE splits into QHIST_SUB_BINS equal bins, so a bin is at
+ * most 1/8 of its value wide (about 6% error after interpolation). Larger
+ * values land in the top bin; the exact maximum is kept separately.
+ * Adding a sample is O(1) with no allocation; a quantile query scans the
+ * QHIST_BINS bins once. Samples carry a weight (e.g. dt in ms) so the
+ * result is a time-weighted percentile.
+ */
+#define QHIST_LINEAR_BINS 16u
+#define QHIST_SUB_BINS    8u
+#define QHIST_OCTAVES     8u    /* 16..4095 */
+#define QHIST_BINS        (QHIST_LINEAR_BINS + QHIST_OCTAVES * QHIST_SUB_BINS)
+#define QHIST_MAX_VALUE   4095u
+
+typedef struct {
+    uint32_t bin[QHIST_BINS];
+    uint32_t total;     /* sum of weights, saturating */
+    uint16_t max;       /* largest sample seen */
+} qhist_t;
+
+void qhist_reset(qhist_t *h);
+void qhist_add(qhist_t *h, uint16_t value, uint32_t weight);
+/* Value below which `permille` of the weight lies; 0 when empty. */
+uint16_t qhist_quantile(const qhist_t *h, uint16_t permille);
+
+#endif /* QUANTILE_H */
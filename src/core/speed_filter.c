@@ -0,0 +1,129 @@
+#include "speed_filter.h"
+
+typedef struct {
+    uint16_t iir_alpha_q15;
+    uint16_t ab_alpha_q15;
+    uint16_t ab_beta_q15;
+} speed_filter_coef_t;
+
+/*
+ * IIR: alpha = 1 - exp(-dt / 448 ms); 448 ms is the OEM delta/5 step at 10 Hz.
+ * Alpha-beta: beta = alpha^2 / (2 - alpha) (critically damped), alpha chosen
+ * so the position noise gain matches the IIR's at each rate.
+ */
+static const speed_filter_coef_t k_speed_filter_coef[SPEED_FILTER_RATE_COUNT] = {
+    [SPEED_FILTER_RATE_5HZ] = { 11796u, 19661u, 8426u },   /* 0.360, 0.60, 0.257 */
+    [SPEED_FILTER_RATE_10HZ] = { 6554u, 14746u, 4281u },   /* 0.200, 0.45, 0.131 */
+    [SPEED_FILTER_RATE_20HZ] = { 3460u, 9830u, 1735u },    /* 0.106, 0.30, 0.053 */
+};
+
+#define SPEED_FILTER_Q8_MAX (0xFFFF << 8)
+
+static int32_t speed_filter_mul_q15(int32_t v, uint16_t q15)
+{
+    /* Arithmetic shift of the signed product; |v| < 2^24 keeps it in range. */
+    return (int32_t)(((int64_t)v * q15 + (1 << 14)) >> 15);
+}
+
+static uint16_t speed_filter_out(int32_t v_q8)
+{
+    if (v_q8 <= 0)
+        return 0u;
+    if (v_q8 >= SPEED_FILTER_Q8_MAX)
+        return 0xFFFFu;
+    return (uint16_t)((v_q8 + 128) >> 8);
+}
+
+speed_filter_rate_t speed_filter_rate_for_interval_ms(uint32_t interval_ms)
+{
+    /* Geometric midpoints between 50/100/200 ms. */
+    if (interval_ms < 71u)
+        return SPEED_FILTER_RATE_20HZ;
+    if (interval_ms < 141u)
+        return SPEED_FILTER_RATE_10HZ;
+    return SPEED_FILTER_RATE_5HZ;
+}
+
+void speed_iir_reset(speed_iir_t *f, uint16_t value)
+{
+    if (f)
+        f->y_q8 = (int32_t)value << 8;
+}
+
+uint16_t speed_iir_update(speed_iir_t *f, uint16_t x, speed_filter_rate_t rate)
+{
+    if (!f)
+        return x;
+    if ((uint32_t)rate >= SPEED_FILTER_RATE_COUNT)
+        rate = SPEED_FILTER_RATE_10HZ;
+    if (x == 0u && f->y_q8 < (1 << 8))
+    {
+        /* OEM: a zero target with a sub-unit residue snaps to zero. */
+        f->y_q8 = 0;
+        return 0u;
+    }
+    int32_t x_q8 = (int32_t)x << 8;
+    f->y_q8 += speed_filter_mul_q15(x_q8 - f->y_q8, k_speed_filter_coef[rate].iir_alpha_q15);
+    return speed_filter_out(f->y_q8);
+}
+
+void speed_ab_reset(speed_ab_t *f)
+{
+    if (!f)
+        return;
+    f->x_q8 = 0;
+    f->v_q8 = 0;
+    f->primed = 0u;
+}
+
+uint16_t speed_ab_update(speed_ab_t *f, uint16_t x, speed_filter_rate_t rate)
+{
+    if (!f)
+        return x;
+    if ((uint32_t)rate >= SPEED_FILTER_RATE_COUNT)
+        rate = SPEED_FILTER_RATE_10HZ;
+    int32_t x_q8 = (int32_t)x << 8;
+    if (x == 0u || !f->primed)
+    {
+        f->x_q8 = x_q8;
+        f->v_q8 = 0;
+        f->primed = 1u;
+        return x;
+    }
+
+    const speed_filter_coef_t *c = &k_speed_filter_coef[rate];
+    int32_t pred = f->x_q8 + f->v_q8;
+    int32_t r = x_q8 - pred;
+    f->x_q8 = pred + speed_filter_mul_q15(r, c->ab_alpha_q15);
+    f->v_q8 += speed_filter_mul_q15(r, c->ab_beta_q15);
+    if (f->x_q8 < 0)
+    {
+        f->x_q8 = 0;
+        f->v_q8 = 0;
+    }
+    else if (f->x_q8 > SPEED_FILTER_Q8_MAX)
+    {
+        f->x_q8 = SPEED_FILTER_Q8_MAX;
+    }
+    return speed_filter_out(f->x_q8);
+}
+
+/* 3.6 * 0.621371 = 22.369 deci-mph per (mm / ms); x256 = 5726.6. */
+#define SPEED_CONV_DMPH_Q8 5727u
+
+void speed_conv_set_wheel(speed_conv_t *c, uint16_t wheel_mm)
+{
+    if (!c || c->wheel_mm == wheel_mm)
+        return;
+    c->wheel_mm = wheel_mm;
+    c->num_q8 = (uint32_t)wheel_mm * SPEED_CONV_DMPH_Q8;
+}
+
+uint16_t speed_conv_dmph(const speed_conv_t *c, uint16_t period_ms)
+{
+    if (!c || period_ms == 0u || c->num_q8 == 0u)
+        return 0u;
+    uint32_t den = (uint32_t)period_ms << 8;
+    uint32_t dmph = (c->num_q8 + (den >> 1)) / den;
+    return (dmph > 0xFFFFu) ? 0xFFFFu : (uint16_t)dmph;
+}
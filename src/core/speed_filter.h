@@ -0,0 +1,64 @@
+#ifndef SPEED_FILTER_H
+#define SPEED_FILTER_H
+
+#include <stdint.h>
+
+/*
+ * Shared Q15 speed filters for every motor protocol path.
+ *
+ * Coefficients are precomputed per update rate (see k_speed_filter_coef in
+ * speed_filter.c); callers pick the row matching their sample interval, so
+ * the hot path is multiply/shift only. State is kept in Q8 deci-mph (or
+ * whatever unit the caller feeds, e.g. kph x10) to avoid rounding stalls.
+ */
+
+typedef enum {
+    SPEED_FILTER_RATE_5HZ = 0,   /* 200 ms */
+    SPEED_FILTER_RATE_10HZ = 1,  /* 100 ms: OEM status cadence */
+    SPEED_FILTER_RATE_20HZ = 2,  /* 50 ms: closed-loop TX minimum */
+    SPEED_FILTER_RATE_COUNT = 3,
+} speed_filter_rate_t;
+
+/* Nearest row for a sample interval in ms. */
+speed_filter_rate_t speed_filter_rate_for_interval_ms(uint32_t interval_ms);
+
+/*
+ * First-order IIR, y += alpha * (x - y). The 10 Hz row is the OEM's
+ * step = delta / 5; the other rows keep the same time constant (~450 ms).
+ */
+typedef struct {
+    int32_t y_q8;
+} speed_iir_t;
+
+void speed_iir_reset(speed_iir_t *f, uint16_t value);
+uint16_t speed_iir_update(speed_iir_t *f, uint16_t x, speed_filter_rate_t rate);
+
+/*
+ * Alpha-beta tracker (position + rate per sample). Follows steady
+ * acceleration without the lag of the IIR at a similar noise bandwidth.
+ * A zero sample snaps to zero, matching the OEM stop behaviour.
+ */
+typedef struct {
+    int32_t x_q8;
+    int32_t v_q8;
+    uint8_t primed;
+} speed_ab_t;
+
+void speed_ab_reset(speed_ab_t *f);
+uint16_t speed_ab_update(speed_ab_t *f, uint16_t x, speed_filter_rate_t rate);
+
+/*
+ * Wheel period (ms/rev) to deci-mph with one divide per sample:
+ * dmph = wheel_mm * 36 * 0.621371 / period_ms, with the wheel-dependent
+ * numerator cached in Q8 until the wheel size changes. Matches the old
+ * kph-then-mph integer chain to within one count.
+ */
+typedef struct {
+    uint16_t wheel_mm;
+    uint32_t num_q8;
+} speed_conv_t;
+
+void speed_conv_set_wheel(speed_conv_t *c, uint16_t wheel_mm);
+uint16_t speed_conv_dmph(const speed_conv_t *c, uint16_t period_ms);
+
+#endif /* SPEED_FILTER_H */
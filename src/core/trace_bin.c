@@ -0,0 +1,12 @@
+#include "trace_bin.h"
+
+#include <string.h>
+
+size_t trace_bin_pack(uint8_t *out, size_t cap, uint8_t schema, const void *rec, size_t rec_len)
+{
+    if (!out || !rec || cap < rec_len + 1u)
+        return 0;
+    out[0] = schema;
+    memcpy(&out[1], rec, rec_len);
+    return rec_len + 1u;
+}
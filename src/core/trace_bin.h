@@ -0,0 +1,83 @@
+#ifndef TRACE_BIN_H
+#define TRACE_BIN_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary trace records: the fast alternative to the trace_format.h text
+ * lines. A record is schema[1] followed by the record struct copied as-is
+ * (little-endian, no padding - the asserts below pin the layout), so
+ * emitting one costs a memcpy instead of a dozen decimal conversions.
+ * scripts/trace_decode.py turns a capture back into the text lines.
+ *
+ * Bump the schema ID whenever a record's layout changes; never reuse one.
+ */
+#define TRACE_SCHEMA_STATUS    0x01u /* print_status */
+#define TRACE_SCHEMA_UI        0x02u /* ui_format_dashboard_trace */
+#define TRACE_SCHEMA_UI_ENG    0x03u /* ui_format_engineer_trace */
+
+#define TRACE_BIN_MAX_LEN 40u
+
+typedef struct {
+    uint32_t ms;
+    uint16_t rpm;
+    uint16_t torque_raw;
+    uint16_t speed_dmph;
+    uint8_t soc_pct;
+    uint8_t err;
+} trace_rec_status_t;
+
+typedef struct {
+    uint32_t ms;
+    uint32_t hash;
+    uint16_t render_ms;
+    uint16_t speed_dmph;
+    uint16_t cadence_rpm;
+    uint16_t power_w;
+    int16_t batt_dV;
+    int16_t batt_dA;
+    uint16_t limit_power_w;
+    uint16_t dirty_count;
+    uint16_t draw_ops;
+    uint8_t soc_pct;
+    uint8_t limit_reason;
+    uint8_t page;
+    uint8_t rsvd[3];
+} trace_rec_ui_t;
+
+typedef struct {
+    uint16_t speed_dmph;
+    uint16_t rpm;
+    uint16_t cadence_rpm;
+    uint16_t torque_raw;
+    int16_t batt_dV;
+    int16_t batt_dA;
+    int16_t phase_dA;
+    int16_t sag_margin_dV;
+    uint16_t thermal_state;
+    int16_t ctrl_temp_dC;
+    uint16_t limit_power_w;
+    uint8_t page;
+    uint8_t throttle_pct;
+    uint8_t brake;
+    uint8_t buttons;
+    uint8_t soc_pct;
+    uint8_t err;
+    uint8_t limit_reason;
+    uint8_t rsvd;
+} trace_rec_ui_eng_t;
+
+_Static_assert(sizeof(trace_rec_status_t) == 12u, "status record layout");
+_Static_assert(sizeof(trace_rec_ui_t) == 32u, "ui record layout");
+_Static_assert(sizeof(trace_rec_ui_eng_t) == 30u, "ui eng record layout");
+_Static_assert(1u + sizeof(trace_rec_ui_t) <= TRACE_BIN_MAX_LEN, "TRACE_BIN_MAX_LEN");
+
+/*
+ * Writes schema + rec into out.
+ *
+ * Returns: bytes written, 0 if cap is too small
+ */
+size_t trace_bin_pack(uint8_t *out, size_t cap, uint8_t schema, const void *rec, size_t rec_len);
+
+#endif /* TRACE_BIN_H */
@@ -1,26 +1,78 @@
 #include "trace_format.h"
 
-void append_u32(char **p, size_t *remaining, uint32_t v)
+/*
+ * Decimal goes out two digits per step from a "00".."99" table, halving the
+ * divisions; dividing by the constant 100 compiles to a multiply by its
+ * reciprocal, so no step issues a UDIV. Digits are built from the end of a
+ * stack buffer, then copied while there is room (a value cut short keeps
+ * its leading digits).
+ */
+static const char k_digit_pairs[200] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const char k_hex_lower[16] = "0123456789abcdef";
+static const char k_hex_upper[16] = "0123456789ABCDEF";
+
+#define U32_DIGITS_MAX 10u
+
+/* Digits of v, ending at `end`; returns the first. */
+static char *u32_digits(char *end, uint32_t v)
 {
-    char tmp[12];
-    int i = 0;
-    if (v == 0)
+    char *d = end;
+    while (v >= 100u)
     {
-        tmp[i++] = '0';
+        uint32_t q = v / 100u;
+        const char *pair = &k_digit_pairs[(v - q * 100u) * 2u];
+        *--d = pair[1];
+        *--d = pair[0];
+        v = q;
+    }
+    if (v >= 10u)
+    {
+        *--d = k_digit_pairs[v * 2u + 1u];
+        *--d = k_digit_pairs[v * 2u];
     }
     else
     {
-        while (v && i < (int)sizeof(tmp))
-        {
-            tmp[i++] = (char)('0' + (v % 10u));
-            v /= 10u;
-        }
+        *--d = (char)('0' + v);
     }
-    while (i-- > 0 && *remaining)
+    return d;
+}
+
+static void append_span(char **p, size_t *remaining, const char *s, size_t n)
+{
+    if (n > *remaining)
+        n = *remaining;
+    for (size_t i = 0; i < n; ++i)
+        (*p)[i] = s[i];
+    *p += n;
+    *remaining -= n;
+}
+
+void append_u32(char **p, size_t *remaining, uint32_t v)
+{
+    char tmp[U32_DIGITS_MAX];
+    char *end = tmp + sizeof(tmp);
+    char *d = u32_digits(end, v);
+    append_span(p, remaining, d, (size_t)(end - d));
+}
+
+void append_u32_pad(char **p, size_t *remaining, uint32_t v, uint8_t width)
+{
+    char tmp[U32_DIGITS_MAX];
+    char *end = tmp + sizeof(tmp);
+    char *d = u32_digits(end, v);
+    size_t n = (size_t)(end - d);
+    for (; n < width && *remaining; ++n)
     {
-        *(*p)++ = tmp[i];
+        *(*p)++ = '0';
         (*remaining)--;
     }
+    append_span(p, remaining, d, (size_t)(end - d));
 }
 
 void append_u16(char **p, size_t *remaining, uint16_t v)
@@ -76,31 +128,39 @@ void append_i32(char **p, size_t *remaining, int32_t v)
     append_u32(p, remaining, mag);
 }
 
-static void append_hex_nibble(char **p, size_t *remaining, uint8_t v)
+/* The low `nibbles` hex digits of v, most significant first. */
+static void append_hex(char **p, size_t *remaining, uint32_t v, uint8_t nibbles, const char *digits)
 {
-    static const char hex[] = "0123456789abcdef";
-    if (!*remaining)
-        return;
-    *(*p)++ = hex[v & 0x0Fu];
-    (*remaining)--;
+    char tmp[8];
+    for (uint8_t i = nibbles; i-- > 0u;)
+    {
+        tmp[i] = digits[v & 0x0Fu];
+        v >>= 4;
+    }
+    append_span(p, remaining, tmp, nibbles);
 }
 
 void append_hex_u8(char **p, size_t *remaining, uint8_t v)
 {
-    append_hex_nibble(p, remaining, (uint8_t)(v >> 4));
-    append_hex_nibble(p, remaining, v);
+    append_hex(p, remaining, v, 2u, k_hex_lower);
 }
 
 void append_hex_u16(char **p, size_t *remaining, uint16_t v)
 {
-    append_hex_nibble(p, remaining, (uint8_t)(v >> 12));
-    append_hex_nibble(p, remaining, (uint8_t)(v >> 8));
-    append_hex_nibble(p, remaining, (uint8_t)(v >> 4));
-    append_hex_nibble(p, remaining, (uint8_t)v);
+    append_hex(p, remaining, v, 4u, k_hex_lower);
 }
 
 void append_hex_u32(char **p, size_t *remaining, uint32_t v)
 {
-    for (int shift = 28; shift >= 0; shift -= 4)
-        append_hex_nibble(p, remaining, (uint8_t)((v >> shift) & 0x0Fu));
+    append_hex(p, remaining, v, 8u, k_hex_lower);
+}
+
+void append_hex_u8_upper(char **p, size_t *remaining, uint8_t v)
+{
+    append_hex(p, remaining, v, 2u, k_hex_upper);
+}
+
+void append_hex_u32_upper(char **p, size_t *remaining, uint32_t v)
+{
+    append_hex(p, remaining, v, 8u, k_hex_upper);
 }
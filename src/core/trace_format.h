@@ -5,6 +5,8 @@
 #include <stdint.h>
 
 void append_u32(char **p, size_t *remaining, uint32_t v);
+/* Zero-padded to at least `width` digits. */
+void append_u32_pad(char **p, size_t *remaining, uint32_t v, uint8_t width);
 void append_u16(char **p, size_t *remaining, uint16_t v);
 void append_str(char **p, size_t *remaining, const char *s);
 void append_char(char **p, size_t *remaining, char c);
@@ -13,5 +15,7 @@ void append_i32(char **p, size_t *remaining, int32_t v);
 void append_hex_u8(char **p, size_t *remaining, uint8_t v);
 void append_hex_u16(char **p, size_t *remaining, uint16_t v);
 void append_hex_u32(char **p, size_t *remaining, uint32_t v);
+void append_hex_u8_upper(char **p, size_t *remaining, uint8_t v);
+void append_hex_u32_upper(char **p, size_t *remaining, uint32_t v);
 
 #endif /* TRACE_FORMAT_H */
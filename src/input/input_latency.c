@@ -0,0 +1,68 @@
+/*
+ * Input latency - button edge to pixel timing
+ */
+
+#include "input_latency.h"
+
+#include "platform/time.h"
+
+#define INPUT_LAT_IDLE INPUT_LAT_STAGE_COUNT
+
+static struct
+{
+    uint32_t edge_cycles;
+    uint8_t next;           /* next stage expected, INPUT_LAT_IDLE when done */
+    uint8_t frame_armed;    /* current frame's model includes the press */
+    input_latency_stats_t stats;
+} g_input_lat = { .next = INPUT_LAT_IDLE };
+
+void input_latency_reset(void)
+{
+    g_input_lat.stats = (input_latency_stats_t){0};
+}
+
+void input_latency_edge(uint32_t edge_cycles)
+{
+    g_input_lat.edge_cycles = edge_cycles;
+    g_input_lat.next = INPUT_LAT_SAMPLED;
+    g_input_lat.frame_armed = 0u;
+    g_input_lat.stats.edges++;
+}
+
+void input_latency_mark(input_lat_stage_t stage)
+{
+    if ((uint8_t)stage != g_input_lat.next)
+        return;
+    if (stage == INPUT_LAT_DRAWN && !g_input_lat.frame_armed)
+        return;
+    uint32_t us = platform_cycles_to_us(platform_cycles_now() - g_input_lat.edge_cycles);
+    input_latency_stats_t *s = &g_input_lat.stats;
+    s->last_us[stage] = us;
+    if (us > s->max_us[stage])
+        s->max_us[stage] = us;
+    if (stage == INPUT_LAT_DRAWN)
+    {
+        s->presses++;
+        g_input_lat.frame_armed = 0u;
+        g_input_lat.next = INPUT_LAT_IDLE;
+        return;
+    }
+    g_input_lat.next = (uint8_t)(stage + 1u);
+}
+
+void input_latency_frame_begin(void)
+{
+    if (g_input_lat.next == INPUT_LAT_DRAWN)
+        g_input_lat.frame_armed = 1u;
+}
+
+void input_latency_note_preempt(void)
+{
+    g_input_lat.stats.preempts++;
+}
+
+void input_latency_get(input_latency_stats_t *out)
+{
+    if (out)
+        *out = g_input_lat.stats;
+}
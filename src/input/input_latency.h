@@ -0,0 +1,46 @@
+/*
+ * Input latency - button edge to pixel timing
+ *
+ * Each button edge (EXTI, DWT-stamped) starts a chain of stages that are
+ * marked in order as the press moves through the input path:
+ *
+ *   SAMPLED  - buttons_tick saw the new level
+ *   EVENT    - EVT_BTN_PRESS published (short presses; long presses wait
+ *              for the hold threshold on purpose and are not timed)
+ *   APPLIED  - the button handler ran (gear change, page actions)
+ *   DRAWN    - the first frame built after APPLIED reached the panel
+ *
+ * Times are microseconds since the edge. A stage marked out of order, or
+ * after the chain ended, is ignored; a new edge restarts the chain.
+ */
+
+#ifndef INPUT_LATENCY_H
+#define INPUT_LATENCY_H
+
+#include <stdint.h>
+
+typedef enum {
+    INPUT_LAT_SAMPLED = 0,
+    INPUT_LAT_EVENT,
+    INPUT_LAT_APPLIED,
+    INPUT_LAT_DRAWN,
+    INPUT_LAT_STAGE_COUNT,
+} input_lat_stage_t;
+
+typedef struct {
+    uint32_t edges;
+    uint32_t presses;                        /* chains that reached DRAWN */
+    uint32_t preempts;                       /* presses applied mid-render */
+    uint32_t last_us[INPUT_LAT_STAGE_COUNT];
+    uint32_t max_us[INPUT_LAT_STAGE_COUNT];
+} input_latency_stats_t;
+
+void input_latency_reset(void);
+void input_latency_edge(uint32_t edge_cycles);
+void input_latency_mark(input_lat_stage_t stage);
+/* Model snapshot for the next frame: DRAWN counts only if APPLIED came first. */
+void input_latency_frame_begin(void);
+void input_latency_note_preempt(void);
+void input_latency_get(input_latency_stats_t *out);
+
+#endif /* INPUT_LATENCY_H */
@@ -48,6 +48,9 @@ typedef enum {
     /* Hold-repeat (after initial long press) */
     EVT_BTN_REPEAT_UP   = 0x1C,
     EVT_BTN_REPEAT_DOWN = 0x1D,
+
+    /* Mapped press masks for one sample: payload16 = short | long << 8 */
+    EVT_BTN_PRESS       = 0x1F,
 } button_event_type_t;
 
 /*
@@ -0,0 +1,160 @@
+/*
+ * Event Bus Implementation
+ */
+
+#include "event_bus.h"
+#include "flight_rec.h"
+#include <string.h>
+
+void event_bus_init(event_bus_t *bus)
+{
+    memset(bus, 0, sizeof(*bus));
+    for (uint8_t i = 0; i < EVENT_BUS_LANES; i++) {
+        event_queue_init(&bus->lanes[i]);
+    }
+}
+
+bool event_bus_subscribe(event_bus_t *bus, uint8_t category,
+                         event_handler_fn handler, void *ctx)
+{
+    if (!bus || !handler) {
+        return false;
+    }
+
+    event_sub_t *subs = bus->subs[(category >> 4) & 0x0Fu];
+
+    for (uint8_t i = 0; i < EVENT_BUS_SUBS_PER_CAT; i++) {
+        if (subs[i].handler == handler && subs[i].ctx == ctx) {
+            return false;
+        }
+        if (!subs[i].handler) {
+            subs[i].handler = handler;
+            subs[i].ctx = ctx;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool event_bus_publish(event_bus_t *bus, uint8_t lane, const event_t *evt)
+{
+    if (!bus || !evt || lane >= EVENT_BUS_LANES) {
+        return false;
+    }
+
+    if (!event_queue_push(&bus->lanes[lane], evt)) {
+        return false;
+    }
+
+    bus->published[lane]++;
+    flight_rec_log(FLIGHT_EVENT, evt->type, evt->payload16);
+    return true;
+}
+
+static void event_bus_deliver(event_bus_t *bus, const event_t *evt)
+{
+    const event_sub_t *subs = bus->subs[(evt->type >> 4) & 0x0Fu];
+
+    if (!subs[0].handler) {
+        bus->unhandled++;
+        return;
+    }
+    for (uint8_t i = 0; i < EVENT_BUS_SUBS_PER_CAT && subs[i].handler; i++) {
+        subs[i].handler(evt, subs[i].ctx);
+    }
+}
+
+uint16_t event_bus_dispatch(event_bus_t *bus, uint16_t max_events, uint32_t now_ms)
+{
+    if (!bus) {
+        return 0;
+    }
+
+    /* Bound the batch so busy producers cannot hold the consumer here. */
+    if (max_events == 0) {
+        for (uint8_t i = 0; i < EVENT_BUS_LANES; i++) {
+            max_events = (uint16_t)(max_events + event_queue_count(&bus->lanes[i]));
+        }
+    }
+
+    uint16_t count = 0;
+    event_t evt;
+
+    while (count < max_events) {
+        uint8_t lane = 0;
+
+        /* Re-scan from the top lane so urgent events pre-empt a backlog. */
+        while (lane < EVENT_BUS_LANES && !event_queue_pop(&bus->lanes[lane], &evt)) {
+            lane++;
+        }
+        if (lane == EVENT_BUS_LANES) {
+            break;
+        }
+
+        event_queue_note_latency(&bus->lanes[lane], &evt, now_ms);
+        bus->dispatched[lane]++;
+        event_bus_deliver(bus, &evt);
+        count++;
+    }
+
+    return count;
+}
+
+uint16_t event_bus_dispatch_lane(event_bus_t *bus, uint8_t lane, uint16_t max_events,
+                                 uint32_t now_ms)
+{
+    if (!bus || lane >= EVENT_BUS_LANES) {
+        return 0;
+    }
+    if (max_events == 0) {
+        max_events = event_queue_count(&bus->lanes[lane]);
+    }
+
+    uint16_t count = 0;
+    event_t evt;
+    while (count < max_events && event_queue_pop(&bus->lanes[lane], &evt)) {
+        event_queue_note_latency(&bus->lanes[lane], &evt, now_ms);
+        bus->dispatched[lane]++;
+        event_bus_deliver(bus, &evt);
+        count++;
+    }
+    return count;
+}
+
+bool event_bus_pending(const event_bus_t *bus)
+{
+    for (uint8_t i = 0; i < EVENT_BUS_LANES; i++) {
+        if (!event_queue_empty(&bus->lanes[i])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool event_bus_lane_stats(const event_bus_t *bus, uint8_t lane, event_lane_stats_t *out)
+{
+    if (!out) {
+        return false;
+    }
+    if (!bus || lane >= EVENT_BUS_LANES) {
+        memset(out, 0, sizeof(*out));
+        return false;
+    }
+
+    out->published = bus->published[lane];
+    out->dispatched = bus->dispatched[lane];
+    event_queue_get_stats(&bus->lanes[lane], &out->queue);
+    return true;
+}
+
+void event_bus_reset_lane_stats(event_bus_t *bus, uint8_t lane)
+{
+    if (!bus || lane >= EVENT_BUS_LANES) {
+        return;
+    }
+
+    bus->published[lane] = 0;
+    bus->dispatched[lane] = 0;
+    event_queue_reset_stats(&bus->lanes[lane]);
+}
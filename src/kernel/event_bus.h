@@ -0,0 +1,117 @@
+/*
+ * Event Bus - prioritized SPSC lanes with per-category dispatch
+ *
+ * Each producer (ISR or main-loop module) owns one lane, so every lane
+ * keeps the single-producer guarantee of event_queue_t. The main loop is
+ * the only consumer: event_bus_dispatch() merges the lanes by priority
+ * (lane 0 first) and hands each event to the subscribers registered for
+ * its category (EVENT_CATEGORY()).
+ *
+ * Properties:
+ * *   - No locks, no allocation; ~0.7 KB per bus
+ *   - Push never blocks; a full lane counts a drop (event_queue stats)
+ *   - Up to EVENT_BUS_SUBS_PER_CAT subscribers per category, called in
+ *     registration order
+ */
+
+#ifndef KERNEL_EVENT_BUS_H
+#define KERNEL_EVENT_BUS_H
+
+#include "event.h"
+#include "event_queue.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Lanes - one per producer, ordered by priority (lower = drained first)
+ */
+#define EVENT_LANE_MOTOR   0u   /* motor ISR (TIM2 / UART2 DMA) */
+#define EVENT_LANE_INPUT   1u   /* button sampling (main loop) */
+#define EVENT_BUS_LANES    2u
+
+#define EVENT_BUS_CATEGORIES    16u  /* high nibble of event_t.type */
+#define EVENT_BUS_SUBS_PER_CAT  2u
+
+typedef struct {
+    uint32_t published;
+    uint32_t dispatched;
+    event_queue_stats_t queue;  /* hwm, drops, queueing latency */
+} event_lane_stats_t;
+
+typedef struct {
+    event_handler_fn handler;
+    void *ctx;
+} event_sub_t;
+
+typedef struct {
+    event_queue_t lanes[EVENT_BUS_LANES];
+    volatile uint32_t published[EVENT_BUS_LANES]; /* producer side */
+    uint32_t dispatched[EVENT_BUS_LANES];
+    uint32_t unhandled;   /* events whose category had no subscriber */
+    event_sub_t subs[EVENT_BUS_CATEGORIES][EVENT_BUS_SUBS_PER_CAT];
+} event_bus_t;
+
+/*
+ * Reset lanes, counters and the subscriber table
+ */
+void event_bus_init(event_bus_t *bus);
+
+/*
+ * Subscribe a handler to every event of a category (e.g. EVT_CAT_MOTOR)
+ *
+ * Returns: false if the category is full, the handler is NULL, or the
+ * same handler/ctx pair is already subscribed
+ */
+bool event_bus_subscribe(event_bus_t *bus, uint8_t category,
+                         event_handler_fn handler, void *ctx);
+
+/*
+ * Publish an event on a lane (producer side - ISR safe)
+ *
+ * Only the lane's owner may publish on it.
+ *
+ * Returns: true if queued, false if the lane was full or invalid
+ */
+bool event_bus_publish(event_bus_t *bus, uint8_t lane, const event_t *evt);
+
+/*
+ * Dispatch queued events, highest-priority lane first (consumer side)
+ *
+ * Args:
+ *   max_events - Batch limit; 0 drains what was queued on entry
+ *   now_ms - Current time, for the lanes' queueing latency
+ *
+ * Returns: Number of events dispatched
+ */
+uint16_t event_bus_dispatch(event_bus_t *bus, uint16_t max_events, uint32_t now_ms);
+
+/*
+ * Dispatch queued events of one lane only (consumer side)
+ *
+ * For a path that must react to one producer without running the other
+ * lanes' handlers. The caller keeps the single-consumer guarantee: it must
+ * never run concurrently with event_bus_dispatch().
+ *
+ * Returns: Number of events dispatched (max_events 0 = what was queued)
+ */
+uint16_t event_bus_dispatch_lane(event_bus_t *bus, uint8_t lane, uint16_t max_events,
+                                 uint32_t now_ms);
+
+/*
+ * True if any lane holds an event
+ */
+bool event_bus_pending(const event_bus_t *bus);
+
+/*
+ * Snapshot of one lane's counters
+ *
+ * Returns: false if lane is invalid (out is zeroed)
+ */
+bool event_bus_lane_stats(const event_bus_t *bus, uint8_t lane, event_lane_stats_t *out);
+
+/*
+ * Clear one lane's counters (consumer side)
+ */
+void event_bus_reset_lane_stats(event_bus_t *bus, uint8_t lane);
+
+#endif /* KERNEL_EVENT_BUS_H */
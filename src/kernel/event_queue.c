@@ -29,6 +29,7 @@ void event_queue_init(event_queue_t *q)
 {
     q->head = 0;
     q->tail = 0;
+    event_queue_reset_stats(q);
     MEMORY_BARRIER();
 }
 
@@ -40,6 +41,7 @@ bool event_queue_push(event_queue_t *q, const event_t *evt)
     /* Check if queue is full */
     uint16_t next_head = (head + 1u) & EVENT_QUEUE_MASK;
     if (next_head == tail) {
+        q->drops++;
         return false;  /* Queue full */
     }
 
@@ -52,6 +54,11 @@ bool event_queue_push(event_queue_t *q, const event_t *evt)
     /* Publish new head position */
     q->head = next_head;
 
+    uint16_t depth = (next_head - tail) & EVENT_QUEUE_MASK;
+    if (depth > q->hwm) {
+        q->hwm = depth;
+    }
+
     return true;
 }
 
@@ -114,3 +121,48 @@ uint16_t event_queue_drain(event_queue_t *q, event_handler_fn handler, void *ctx
 
     return count;
 }
+
+void event_queue_note_latency(event_queue_t *q, const event_t *evt, uint32_t now_ms)
+{
+    uint32_t age = now_ms - evt->timestamp;
+
+    /* A timestamp from the future is a producer clock quirk, not latency. */
+    if (age & 0x80000000u) {
+        age = 0;
+    }
+
+    q->lat_count++;
+    q->lat_sum_ms += age;
+    if (age > q->lat_max_ms) {
+        q->lat_max_ms = age;
+    }
+
+    uint8_t b = (age == 0) ? 0u : (age <= 5u) ? 1u : (age <= 20u) ? 2u : 3u;
+    if (q->lat_hist[b] != 0xFFFFu) {
+        q->lat_hist[b]++;
+    }
+}
+
+void event_queue_get_stats(const event_queue_t *q, event_queue_stats_t *out)
+{
+    out->hwm = q->hwm;
+    out->drops = q->drops;
+    out->lat_count = q->lat_count;
+    out->lat_max_ms = q->lat_max_ms;
+    out->lat_sum_ms = q->lat_sum_ms;
+    for (uint8_t i = 0; i < EVENT_LAT_BUCKETS; i++) {
+        out->lat_hist[i] = q->lat_hist[i];
+    }
+}
+
+void event_queue_reset_stats(event_queue_t *q)
+{
+    q->hwm = 0;
+    q->drops = 0;
+    q->lat_count = 0;
+    q->lat_max_ms = 0;
+    q->lat_sum_ms = 0;
+    for (uint8_t i = 0; i < EVENT_LAT_BUCKETS; i++) {
+        q->lat_hist[i] = 0;
+    }
+}
@@ -8,7 +8,7 @@
  *   - Fixed capacity (power of 2 for fast modulo)
  *   - Producer (ISR) writes head, consumer (main) writes tail
  *   - Never blocks - push fails if full, pop fails if empty
- *   - ~270 bytes per queue instance
+ *   - ~300 bytes per queue instance, including statistics
  */
 
 #ifndef KERNEL_EVENT_QUEUE_H
@@ -35,9 +35,36 @@ _Static_assert((EVENT_QUEUE_CAPACITY & EVENT_QUEUE_MASK) == 0,
  *   - head is written by producer (ISR), read by consumer
  *   - tail is written by consumer (main), read by producer
  */
+/*
+ * Enqueue-to-dequeue latency buckets (ms, from event_t.timestamp):
+ * same tick, within one 5 ms tick, up to 20 ms, and longer.
+ */
+#define EVENT_LAT_BUCKETS 4u
+
+/*
+ * Queue statistics
+ *
+ * hwm and drops are written by the producer, the latency fields by the
+ * consumer; each side only ever increments its own.
+ */
+typedef struct {
+    uint16_t hwm;             /* Deepest fill seen after a push */
+    uint32_t drops;           /* Pushes refused because the queue was full */
+    uint32_t lat_count;
+    uint32_t lat_max_ms;
+    uint32_t lat_sum_ms;
+    uint16_t lat_hist[EVENT_LAT_BUCKETS]; /* saturating */
+} event_queue_stats_t;
+
 typedef struct {
     volatile uint16_t head;   /* Next write position (producer) */
     volatile uint16_t tail;   /* Next read position (consumer) */
+    volatile uint16_t hwm;    /* producer */
+    volatile uint32_t drops;  /* producer */
+    uint32_t lat_count;       /* consumer */
+    uint32_t lat_max_ms;
+    uint32_t lat_sum_ms;
+    uint16_t lat_hist[EVENT_LAT_BUCKETS];
     event_t events[EVENT_QUEUE_CAPACITY];
 } event_queue_t;
 
@@ -89,4 +116,25 @@ uint16_t event_queue_count(const event_queue_t *q);
 typedef void (*event_handler_fn)(const event_t *evt, void *ctx);
 uint16_t event_queue_drain(event_queue_t *q, event_handler_fn handler, void *ctx);
 
+/*
+ * Record the queueing latency of a popped event (consumer side)
+ *
+ * Args:
+ *   evt - Event just popped; its timestamp is the enqueue time
+ *   now_ms - Current time in milliseconds
+ */
+void event_queue_note_latency(event_queue_t *q, const event_t *evt, uint32_t now_ms);
+
+/*
+ * Copy queue statistics
+ */
+void event_queue_get_stats(const event_queue_t *q, event_queue_stats_t *out);
+
+/*
+ * Clear queue statistics (consumer side)
+ *
+ * A push racing with the reset may keep its old hwm/drops increment.
+ */
+void event_queue_reset_stats(event_queue_t *q);
+
 #endif /* KERNEL_EVENT_QUEUE_H */
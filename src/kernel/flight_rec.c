@@ -0,0 +1,42 @@
+/*
+ * Flight recorder - always-on RAM trace
+ */
+
+#include "flight_rec.h"
+
+#include <string.h>
+
+#include "platform/ram.h"
+#include "util/byteorder.h"
+
+NOINIT flight_rec_t g_flight_rec;
+
+void flight_rec_init(uint16_t reset_flags)
+{
+    if (g_flight_rec.magic != FLIGHT_REC_MAGIC) {
+        memset(&g_flight_rec, 0, sizeof(g_flight_rec));
+        g_flight_rec.magic = FLIGHT_REC_MAGIC;
+    }
+    flight_rec_log(FLIGHT_BOOT, 0u, reset_flags);
+}
+
+uint8_t flight_rec_copy(uint8_t *out, uint8_t max)
+{
+    if (!out) {
+        return 0;
+    }
+    uint32_t head = g_flight_rec.head;
+    uint32_t n = (head < FLIGHT_REC_ENTRIES) ? head : FLIGHT_REC_ENTRIES;
+    if (n > max) {
+        n = max;
+    }
+    for (uint32_t i = 0; i < n; i++) {
+        const flight_entry_t *e = &g_flight_rec.e[(head - n + i) & (FLIGHT_REC_ENTRIES - 1u)];
+        uint8_t *dst = &out[i * FLIGHT_REC_ENTRY_SIZE];
+        store_be32(&dst[0], e->cycles);
+        dst[4] = e->kind;
+        dst[5] = e->a;
+        store_be16(&dst[6], e->b);
+    }
+    return (uint8_t)n;
+}
@@ -0,0 +1,75 @@
+/*
+ * Flight recorder - always-on RAM trace of the last few dozen things the
+ * firmware did.
+ *
+ * Scheduler dispatches, event bus publishes and motor UART frames each drop
+ * one 8-byte entry {cycles, kind, a, b} into a power-of-two ring. A write is
+ * a DWT_CYCCNT read, one atomic increment and three stores, so the hooks stay
+ * on in release builds and may run from any priority.
+ *
+ * The ring lives in .noinit: a fault, watchdog or software reset keeps it, and
+ * the HardFault path copies it into the crash dump next to the registers.
+ * flight_rec_init() keeps a ring whose magic survived and appends a BOOT
+ * marker, so the entries before the marker are the previous run's last
+ * moments.
+ */
+
+#ifndef FLIGHT_REC_H
+#define FLIGHT_REC_H
+
+#include <stdint.h>
+
+#if !defined(HOST_TEST)
+#include "platform/hw.h"
+#include "platform/mmio.h"
+#endif
+
+#define FLIGHT_REC_MAGIC 0x464C5452u /* 'FLTR' */
+#define FLIGHT_REC_ENTRIES 64u       /* power of two */
+#define FLIGHT_REC_ENTRY_SIZE 8u     /* serialized: cycles[4] kind a b[2] */
+
+typedef enum {
+    FLIGHT_SCHED = 1,    /* a = slot, b = now_ms low 16 */
+    FLIGHT_EVENT,        /* a = event type, b = payload16 */
+    FLIGHT_MOTOR_RX,     /* a = opcode, b = proto << 8 | decode ok */
+    FLIGHT_MOTOR_TX,     /* a = frame[2] (Shengyi opcode), b = length */
+    FLIGHT_BOOT,         /* a = 0, b = reset flags */
+} flight_kind_t;
+
+typedef struct {
+    uint32_t cycles;
+    uint8_t kind;
+    uint8_t a;
+    uint16_t b;
+} flight_entry_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t head;      /* total entries written; slot = head % ENTRIES */
+    flight_entry_t e[FLIGHT_REC_ENTRIES];
+} flight_rec_t;
+
+extern flight_rec_t g_flight_rec;
+
+static inline void flight_rec_log(uint8_t kind, uint8_t a, uint16_t b)
+{
+    uint32_t i = __atomic_fetch_add(&g_flight_rec.head, 1u, __ATOMIC_RELAXED);
+    flight_entry_t *e = &g_flight_rec.e[i & (FLIGHT_REC_ENTRIES - 1u)];
+#if defined(HOST_TEST)
+    e->cycles = i;
+#else
+    e->cycles = mmio_read32(DWT_CYCCNT);
+#endif
+    e->kind = kind;
+    e->a = a;
+    e->b = b;
+}
+
+/* Keeps a surviving ring (valid magic) or clears it, then logs FLIGHT_BOOT. */
+void flight_rec_init(uint16_t reset_flags);
+
+/* Serializes up to `max` entries, oldest first, big-endian, into `out`
+ * (FLIGHT_REC_ENTRY_SIZE bytes each). Returns the entry count written. */
+uint8_t flight_rec_copy(uint8_t *out, uint8_t max);
+
+#endif /* FLIGHT_REC_H */
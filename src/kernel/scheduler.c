@@ -3,29 +3,114 @@
  */
 
 #include "scheduler.h"
+#include "flight_rec.h"
 #include <string.h>
 
+#ifdef HOST_TEST
+/* <time.h> is shadowed by platform/time.h on the include path. */
+#include <sys/time.h>
+#else
+#include "platform/time.h"
+#endif
+
 /*
- * Platform-specific microsecond timer (optional for exec time tracking)
- * For HOST_TEST builds, we'll use a stub
+ * Execution time source: DWT CYCCNT on target, microseconds on host.
+ * Kept outside the scheduler state so scheduler_init() leaves it alone.
  */
+static scheduler_clock_fn clock_now;
+static uint32_t clock_cycles_per_us = 1;
+
+static uint32_t sched_cycles_now(void)
+{
+    if (clock_now) {
+        return clock_now();
+    }
 #ifdef HOST_TEST
-static inline uint32_t get_us(void) { return 0; }
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return (uint32_t)((uint64_t)tv.tv_sec * 1000000u + (uint64_t)tv.tv_usec);
 #else
-/* In real firmware, implement this in platform layer */
-static inline uint32_t get_us(void) {
-    /* Exec time tracking not wired on target; return 0. */
-    return 0;
+    return platform_cycles_now();
+#endif
 }
+
+static uint32_t sched_cycles_to_us(uint32_t cycles)
+{
+    if (clock_now) {
+        return cycles / clock_cycles_per_us;
+    }
+#ifdef HOST_TEST
+    return cycles;
+#else
+    return platform_cycles_to_us(cycles);
 #endif
+}
+
+static void stats_reset(scheduler_slot_t *slot)
+{
+    memset(&slot->stats, 0, sizeof(slot->stats));
+    slot->stats.min_us = 0xFFFFFFFFu;
+    slot->ewma_q4 = 0;
+}
+
+static uint8_t hist_bucket(uint32_t us)
+{
+    uint8_t b = 0;
+    while (us && b < SCHED_HIST_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+/*
+ * Fold one run into the slot statistics
+ */
+static void stats_record(scheduler_slot_t *slot, uint32_t start_cycles)
+{
+    uint32_t us = sched_cycles_to_us(sched_cycles_now() - start_cycles);
+    scheduler_stats_t *st = &slot->stats;
+
+    st->last_us = us;
+    if (us < st->min_us) {
+        st->min_us = us;
+    }
+    if (us > st->max_us) {
+        st->max_us = us;
+    }
+    /* Clamp so the Q4 accumulator cannot overflow. */
+    uint32_t sample_q4 = ((us > 0x0FFFFFFFu) ? 0x0FFFFFFFu : us) << 4;
+    if (st->runs == 0) {
+        slot->ewma_q4 = sample_q4;
+    } else if (sample_q4 >= slot->ewma_q4) {
+        slot->ewma_q4 += (sample_q4 - slot->ewma_q4) >> 3;
+    } else {
+        slot->ewma_q4 -= (slot->ewma_q4 - sample_q4) >> 3;
+    }
+    st->ewma_us = slot->ewma_q4 >> 4;
+    st->runs++;
+
+    uint8_t b = hist_bucket(us);
+    if (st->hist[b] != 0xFFFFu) {
+        st->hist[b]++;
+    }
+    if (slot->interval_ms && us > (uint32_t)slot->interval_ms * 1000u) {
+        st->overruns++;
+    }
+}
 
 /*
  * Scheduler state
  */
 static struct {
     scheduler_slot_t slots[SCHED_SLOT_MAX];
+    uint32_t tick_budget_us;    /* 0 = unlimited */
+    uint32_t budget_stops;
+    int8_t current;             /* slot in its callback, or -1 */
+    uint32_t current_start;     /* cycles when that callback started */
+    bool yielded;
     bool initialized;
-} sched;
+} sched = {.current = -1};
 
 /*
  * Initialize the scheduler
@@ -33,9 +118,22 @@ static struct {
 void scheduler_init(void)
 {
     memset(&sched, 0, sizeof(sched));
+    sched.current = -1;
+#ifndef HOST_TEST
+    platform_cycle_counter_init();
+#endif
     sched.initialized = true;
 }
 
+/*
+ * Replace the execution time source
+ */
+void scheduler_set_clock(scheduler_clock_fn now, uint32_t cycles_per_us)
+{
+    clock_now = now;
+    clock_cycles_per_us = cycles_per_us ? cycles_per_us : 1;
+}
+
 /*
  * Register a task in a specific slot
  */
@@ -56,10 +154,15 @@ bool scheduler_register(uint8_t slot_id, uint16_t interval_ms,
     slot->ctx = ctx;
     slot->interval_ms = interval_ms;
     slot->last_run_ms = 0;
-    slot->max_exec_us = 0;
+    stats_reset(slot);
     slot->registered = true;
     slot->suspended = false;
     slot->first_run = true;
+    slot->continuing = false;
+    slot->kicked = false;
+    slot->realign = false;
+    slot->mode = SCHED_MODE_FREE;
+    slot->phase_ms = 0;
 
     return true;
 }
@@ -145,6 +248,82 @@ bool scheduler_is_suspended(uint8_t slot_id)
     return sched.slots[slot_id].suspended;
 }
 
+/*
+ * Dispatch key of a due slot: its deadline relative to now_ms
+ *
+ * A job is due interval_ms after the previous one (its start in free mode,
+ * its period boundary when phase-locked). last_run_ms only moves when a
+ * job completes, so a yielded job keeps the deadline of its first chunk.
+ * A first run sorts before everything so that a newly registered task
+ * cannot be starved by the budget.
+ */
+static int32_t slot_key(const scheduler_slot_t *slot, uint32_t now_ms)
+{
+    if (slot->first_run) {
+        return INT32_MIN;
+    }
+    int32_t key = (int32_t)(slot->last_run_ms + slot->interval_ms - now_ms);
+    if (slot->kicked && key > 0) {
+        key = 0;
+    }
+    return key;
+}
+
+/*
+ * Place a phase-locked slot's first deadline on its next period boundary
+ */
+static void slot_align(scheduler_slot_t *slot, uint32_t now_ms)
+{
+    uint32_t interval = slot->interval_ms;
+    uint32_t rem = (now_ms % interval + interval - slot->phase_ms % interval) % interval;
+    uint32_t next = rem ? now_ms + (interval - rem) : now_ms;
+
+    slot->last_run_ms = next - interval;
+    slot->first_run = false;
+}
+
+/*
+ * Completion bookkeeping for a phase-locked slot
+ *
+ * The period advances by exactly interval_ms. A slot still a whole period
+ * or more behind either runs back-to-back (catch-up, up to
+ * SCHED_CATCHUP_MAX periods) or drops the missed periods (skip).
+ */
+static void slot_advance_locked(scheduler_slot_t *slot, uint32_t now_ms)
+{
+    slot->last_run_ms += slot->interval_ms;
+
+    uint32_t behind = now_ms - slot->last_run_ms;
+    if (behind & 0x80000000u) {
+        return;  /* kicked ahead of its boundary */
+    }
+    uint32_t periods = behind / slot->interval_ms;
+    if (periods == 0) {
+        return;
+    }
+    if (slot->mode == SCHED_MODE_LOCKED_CATCHUP && periods <= SCHED_CATCHUP_MAX) {
+        return;
+    }
+    slot->last_run_ms += periods * slot->interval_ms;
+    slot->stats.skipped += periods;
+}
+
+static bool slot_due(const scheduler_slot_t *slot, uint32_t now_ms)
+{
+    if (!slot->registered || slot->suspended) {
+        return false;
+    }
+    if (slot->first_run || slot->continuing || slot->kicked) {
+        return true;
+    }
+    uint32_t elapsed = now_ms - slot->last_run_ms;
+    /* A phase-locked deadline may still lie ahead of the last boundary. */
+    if (elapsed & 0x80000000u) {
+        return false;
+    }
+    return elapsed >= slot->interval_ms;
+}
+
 /*
  * Main scheduler tick
  */
@@ -155,51 +334,236 @@ uint8_t scheduler_tick(uint32_t now_ms)
     }
 
     uint8_t tasks_run = 0;
+    uint8_t ran_mask = 0;
+    uint32_t tick_start = sched_cycles_now();
 
-    /* Iterate in priority order (slot 0 first) */
     for (uint8_t slot_id = 0; slot_id < SCHED_SLOT_MAX; slot_id++) {
         scheduler_slot_t *slot = &sched.slots[slot_id];
 
-        /* Skip if not registered or suspended */
-        if (!slot->registered || slot->suspended) {
-            continue;
+        if (slot->registered && slot->first_run && slot->mode != SCHED_MODE_FREE) {
+            slot_align(slot, now_ms);
         }
+    }
 
-        /* Check if interval has elapsed */
-        bool should_run = false;
+    for (;;) {
+        /* Earliest deadline first; ties go to the lower slot_id */
+        int8_t pick = -1;
+        int32_t pick_key = 0;
 
-        if (slot->first_run) {
-            /* Always run on first tick */
-            should_run = true;
-        } else {
-            /* Check if interval has elapsed since last run */
-            uint32_t elapsed_ms = now_ms - slot->last_run_ms;
-            should_run = (elapsed_ms >= slot->interval_ms);
+        for (uint8_t slot_id = 0; slot_id < SCHED_SLOT_MAX; slot_id++) {
+            scheduler_slot_t *slot = &sched.slots[slot_id];
+
+            if ((ran_mask & (1u << slot_id)) || !slot_due(slot, now_ms)) {
+                continue;
+            }
+            int32_t key = slot_key(slot, now_ms);
+            if (pick < 0 || key < pick_key) {
+                pick = (int8_t)slot_id;
+                pick_key = key;
+            }
+        }
+        if (pick < 0) {
+            break;
         }
 
-        if (should_run) {
-            /* Track execution time */
-            uint32_t start_us = get_us();
+        /* Out of budget: leave the rest due for the next tick */
+        if (tasks_run && sched.tick_budget_us &&
+            sched_cycles_to_us(sched_cycles_now() - tick_start) >= sched.tick_budget_us) {
+            sched.budget_stops++;
+            break;
+        }
 
-            /* Execute callback */
-            slot->callback(slot->ctx, now_ms);
+        scheduler_slot_t *slot = &sched.slots[pick];
 
-            /* Update max execution time */
-            uint32_t exec_us = get_us() - start_us;
-            if (exec_us > slot->max_exec_us) {
-                slot->max_exec_us = exec_us;
+        if (!slot->continuing) {
+            /* A whole period missed means the loop fell behind */
+            if (!slot->first_run && slot->interval_ms &&
+                (int32_t)(now_ms - slot->last_run_ms) >= 2 * (int32_t)slot->interval_ms) {
+                slot->stats.late++;
             }
+            slot->job_start_ms = now_ms;
+        }
+
+        slot->kicked = false;
+
+        /* Track execution time */
+        uint32_t start = sched_cycles_now();
+
+        /* Execute callback */
+        sched.current = pick;
+        sched.current_start = start;
+        sched.yielded = false;
+        flight_rec_log(FLIGHT_SCHED, (uint8_t)pick, (uint16_t)now_ms);
+        slot->callback(slot->ctx, now_ms);
+        sched.current = -1;
+
+        stats_record(slot, start);
 
-            /* Update last run time */
-            slot->last_run_ms = now_ms;
+        /* A yielded job resumes on the next tick; otherwise it is done */
+        slot->continuing = sched.yielded;
+        if (!slot->continuing) {
             slot->first_run = false;
-            tasks_run++;
+            if (slot->mode == SCHED_MODE_FREE) {
+                slot->last_run_ms = slot->job_start_ms;
+            } else if (slot->realign) {
+                slot->realign = false;
+                slot->first_run = true;
+            } else {
+                slot_advance_locked(slot, now_ms);
+            }
         }
+        ran_mask |= (uint8_t)(1u << pick);
+        tasks_run++;
     }
 
     return tasks_run;
 }
 
+/*
+ * Time until the next slot is due
+ */
+uint32_t scheduler_next_due_ms(uint32_t now_ms)
+{
+    if (!sched.initialized) {
+        return UINT32_MAX;
+    }
+
+    uint32_t next = UINT32_MAX;
+
+    for (uint8_t slot_id = 0; slot_id < SCHED_SLOT_MAX; slot_id++) {
+        const scheduler_slot_t *slot = &sched.slots[slot_id];
+
+        if (!slot->registered || slot->suspended) {
+            continue;
+        }
+        if (slot_due(slot, now_ms)) {
+            return 0;
+        }
+        if (slot->first_run) {
+            return 0;
+        }
+        uint32_t left = slot->last_run_ms + slot->interval_ms - now_ms;
+        if (left < next) {
+            next = left;
+        }
+    }
+
+    return next;
+}
+
+/*
+ * Select free-running or phase-locked timing for a slot
+ */
+bool scheduler_set_mode(uint8_t slot_id, uint8_t mode, uint16_t phase_ms)
+{
+    if (!sched.initialized || slot_id >= SCHED_SLOT_MAX || mode > SCHED_MODE_LOCKED_CATCHUP) {
+        return false;
+    }
+
+    scheduler_slot_t *slot = &sched.slots[slot_id];
+
+    if (!slot->registered || (mode != SCHED_MODE_FREE && slot->interval_ms == 0)) {
+        return false;
+    }
+
+    slot->mode = mode;
+    slot->phase_ms = phase_ms;
+    /* Re-align on the next tick (a job in progress finishes first). */
+    if (mode != SCHED_MODE_FREE && !slot->continuing) {
+        slot->first_run = true;
+    }
+    return true;
+}
+
+/*
+ * Change a slot's run interval
+ */
+bool scheduler_set_interval(uint8_t slot_id, uint16_t interval_ms)
+{
+    if (!sched.initialized || slot_id >= SCHED_SLOT_MAX) {
+        return false;
+    }
+
+    scheduler_slot_t *slot = &sched.slots[slot_id];
+
+    if (!slot->registered || (slot->mode != SCHED_MODE_FREE && interval_ms == 0)) {
+        return false;
+    }
+    if (slot->interval_ms == interval_ms) {
+        return true;
+    }
+
+    slot->interval_ms = interval_ms;
+    if (slot->mode != SCHED_MODE_FREE) {
+        /* From inside the job (or between chunks) the old boundary stands. */
+        if (sched.current == (int8_t)slot_id || slot->continuing) {
+            slot->realign = true;
+        } else {
+            slot->first_run = true;
+        }
+    }
+    return true;
+}
+
+/*
+ * Make a slot due on the next tick
+ */
+bool scheduler_kick(uint8_t slot_id)
+{
+    if (!sched.initialized || slot_id >= SCHED_SLOT_MAX) {
+        return false;
+    }
+
+    scheduler_slot_t *slot = &sched.slots[slot_id];
+
+    if (!slot->registered) {
+        return false;
+    }
+
+    slot->kicked = true;
+    return true;
+}
+
+/*
+ * Ask for the running job to be continued on the next tick
+ */
+void scheduler_yield(void)
+{
+    if (sched.current >= 0) {
+        sched.yielded = true;
+    }
+}
+
+/*
+ * Time left in the running job's interval
+ */
+uint32_t scheduler_slice_left_us(void)
+{
+    if (sched.current < 0) {
+        return UINT32_MAX;
+    }
+    const scheduler_slot_t *slot = &sched.slots[sched.current];
+    if (!slot->interval_ms) {
+        return UINT32_MAX;
+    }
+    uint32_t slice = (uint32_t)slot->interval_ms * 1000u;
+    uint32_t used = sched_cycles_to_us(sched_cycles_now() - sched.current_start);
+    return (used < slice) ? slice - used : 0;
+}
+
+/*
+ * Per-tick execution budget
+ */
+void scheduler_set_tick_budget(uint32_t budget_us)
+{
+    sched.tick_budget_us = budget_us;
+}
+
+uint32_t scheduler_get_budget_stops(void)
+{
+    return sched.budget_stops;
+}
+
 /*
  * Run all pending tasks regardless of time
  */
@@ -221,16 +585,12 @@ uint8_t scheduler_run_pending(void)
         }
 
         /* Track execution time */
-        uint32_t start_us = get_us();
+        uint32_t start = sched_cycles_now();
 
         /* Execute callback with timestamp 0 */
         slot->callback(slot->ctx, 0);
 
-        /* Update max execution time */
-        uint32_t exec_us = get_us() - start_us;
-        if (exec_us > slot->max_exec_us) {
-            slot->max_exec_us = exec_us;
-        }
+        stats_record(slot, start);
 
         tasks_run++;
     }
@@ -247,7 +607,7 @@ uint32_t scheduler_get_max_exec_time(uint8_t slot_id)
         return 0;
     }
 
-    return sched.slots[slot_id].max_exec_us;
+    return sched.slots[slot_id].stats.max_us;
 }
 
 /*
@@ -259,5 +619,22 @@ void scheduler_reset_max_exec_time(uint8_t slot_id)
         return;
     }
 
-    sched.slots[slot_id].max_exec_us = 0;
+    stats_reset(&sched.slots[slot_id]);
+}
+
+/*
+ * Copy execution statistics for a slot
+ */
+bool scheduler_get_stats(uint8_t slot_id, scheduler_stats_t *out)
+{
+    if (!out) {
+        return false;
+    }
+    if (!sched.initialized || slot_id >= SCHED_SLOT_MAX) {
+        memset(out, 0, sizeof(*out));
+        return false;
+    }
+
+    *out = sched.slots[slot_id].stats;
+    return true;
 }
@@ -6,10 +6,14 @@
  *
  * Features:
  *   - Fixed slot array (compile-time capacity)
- *   - Priority-based: lower slot_id runs first when multiple tasks are due
+ *   - Earliest-deadline dispatch when multiple tasks are due (a job's
+ *     deadline is last start + interval_ms); ties go to the lower slot_id
+ *   - Long jobs can yield and continue on the next tick, and an optional
+ *     per-tick budget defers remaining due tasks to the next pass
  *   - Interval-based timing with last_run tracking
  *   - Optional suspend/resume per slot
- *   - Execution time tracking for debugging
+ *   - Execution time accounting per slot (min/max/EWMA, log2 histogram,
+ *     overruns) from the DWT cycle counter, or gettimeofday() on host
  *
  * Typical usage in main loop:
  *   while (1) {
@@ -35,6 +39,49 @@
 #define SCHED_SLOT_TELEMETRY   4   /* 500ms - trip stats update */
 #define SCHED_SLOT_MAX         8   /* Maximum number of slots */
 
+/*
+ * Execution time histogram: bucket 0 is <1 us, bucket b (1..14) covers
+ * [2^(b-1), 2^b) us, and the last bucket holds everything from 16.384 ms.
+ */
+#define SCHED_HIST_BUCKETS     16
+
+/*
+ * Timing modes (scheduler_set_mode)
+ *
+ * FREE: the next run is due interval_ms after this one started, so the
+ *   period stretches by loop latency.
+ * LOCKED_*: runs are due on fixed boundaries t where
+ *   (t - phase_ms) % interval_ms == 0, and each run advances the period by
+ *   exactly interval_ms. After falling a whole period or more behind,
+ *   CATCHUP runs back-to-back for up to SCHED_CATCHUP_MAX missed periods
+ *   (beyond that it skips), while SKIP drops the missed periods at once.
+ */
+#define SCHED_MODE_FREE            0
+#define SCHED_MODE_LOCKED_SKIP     1
+#define SCHED_MODE_LOCKED_CATCHUP  2
+#define SCHED_CATCHUP_MAX          4
+
+/*
+ * Per-slot execution statistics (microseconds)
+ */
+typedef struct {
+    uint32_t runs;
+    uint32_t last_us;
+    uint32_t min_us;            /* 0xFFFFFFFF until the first run */
+    uint32_t max_us;
+    uint32_t ewma_us;           /* alpha = 1/8 */
+    uint32_t overruns;          /* runs longer than interval_ms */
+    uint32_t late;              /* starts a whole interval or more behind */
+    uint32_t skipped;           /* periods dropped by a phase-locked slot */
+    uint16_t hist[SCHED_HIST_BUCKETS]; /* saturating */
+} scheduler_stats_t;
+
+/*
+ * Cycle source override; cycles_per_us converts its deltas.
+ * Passing NULL restores the platform counter.
+ */
+typedef uint32_t (*scheduler_clock_fn)(void);
+
 /*
  * Scheduler callback function signature
  *
@@ -51,11 +98,19 @@ typedef struct {
     scheduler_fn callback;      /* Task callback function */
     void        *ctx;           /* User context pointer */
     uint16_t     interval_ms;   /* Run interval in milliseconds */
-    uint32_t     last_run_ms;   /* Last execution timestamp */
-    uint32_t     max_exec_us;   /* Maximum execution time (microseconds) */
+    uint32_t     last_run_ms;   /* Start (free) or boundary (locked) of the
+                                   last completed job */
+    uint32_t     job_start_ms;  /* Start of the job in progress */
+    scheduler_stats_t stats;    /* Execution time accounting */
+    uint32_t     ewma_q4;       /* EWMA accumulator, us << 4 */
     bool         registered;    /* Slot is active */
     bool         suspended;     /* Slot is suspended */
     bool         first_run;     /* True until first execution */
+    bool         continuing;    /* Job yielded; resumes next tick */
+    bool         kicked;        /* Run on the next tick regardless of interval */
+    bool         realign;       /* New interval: re-align when the job ends */
+    uint8_t      mode;          /* SCHED_MODE_* */
+    uint16_t     phase_ms;      /* Boundary offset for phase-locked modes */
 } scheduler_slot_t;
 
 /*
@@ -139,7 +194,10 @@ bool scheduler_is_suspended(uint8_t slot_id);
  *   2. Not suspended
  *   3. Due (interval_ms elapsed since last_run_ms)
  *
- * Tasks are run in priority order (slot 0 first).
+ * Tasks run earliest deadline first, each at most once per tick. A
+ * yielded job is due again on the next tick with its original deadline.
+ * With a tick budget set, dispatch stops once the budget is spent and the
+ * remaining tasks stay due (at least one task always runs).
  *
  * Args:
  *   now_ms - Current time in milliseconds
@@ -148,6 +206,89 @@ bool scheduler_is_suspended(uint8_t slot_id);
  */
 uint8_t scheduler_tick(uint32_t now_ms);
 
+/*
+ * Time until the next registered, unsuspended slot is due
+ *
+ * For idle decisions: 0 means something is due now, UINT32_MAX means no
+ * slot is active.
+ *
+ * Args:
+ *   now_ms - Current time in milliseconds
+ */
+uint32_t scheduler_next_due_ms(uint32_t now_ms);
+
+/*
+ * Select free-running or phase-locked timing for a slot
+ *
+ * Phase offsets keep heavy periodic tasks off each other's ticks (e.g. two
+ * 200 ms slots at phase 0 and 100). A phase-locked slot waits for its
+ * first boundary instead of running on the next tick.
+ *
+ * Args:
+ *   slot_id - Registered slot
+ *   mode - SCHED_MODE_*
+ *   phase_ms - Boundary offset (taken modulo interval_ms)
+ *
+ * Returns: false if slot_id is invalid or unregistered, mode is unknown,
+ *   or a locked mode is requested for a zero interval
+ */
+bool scheduler_set_mode(uint8_t slot_id, uint8_t mode, uint16_t phase_ms);
+
+/*
+ * Change a slot's run interval
+ *
+ * For tasks that pace themselves (e.g. the UI frame rate). A free-running
+ * slot is next due interval_ms after its last start. A phase-locked slot
+ * moves to the boundaries of the new period: its next run is the first
+ * of them after the job in progress (or now) ends.
+ *
+ * Returns: false if slot_id is invalid or unregistered, or a locked slot
+ *   is given a zero interval
+ */
+bool scheduler_set_interval(uint8_t slot_id, uint16_t interval_ms);
+
+/*
+ * Make a slot due on the next tick without waiting for its interval
+ *
+ * For work that arrives between periods (queued events, pending I/O). The
+ * kicked run counts as a normal job, so in free mode the next interval
+ * starts from it; a phase-locked slot keeps its boundaries.
+ *
+ * Returns: true if kicked, false if slot_id invalid or not registered
+ */
+bool scheduler_kick(uint8_t slot_id);
+
+/*
+ * Continue the running job on the next tick
+ *
+ * Call from inside a callback that has split its work into chunks. The
+ * slot is re-run on the next tick without waiting for its interval, and
+ * its next interval counts from the start of the first chunk. Statistics
+ * are recorded per chunk. No effect outside scheduler_tick().
+ */
+void scheduler_yield(void);
+
+/*
+ * Time the running job has left before its next interval is due
+ *
+ * Returns: microseconds, 0 once over, UINT32_MAX outside a job or for a
+ * slot without an interval
+ */
+uint32_t scheduler_slice_left_us(void);
+
+/*
+ * Set the per-tick execution budget
+ *
+ * Args:
+ *   budget_us - Stop dispatching once a tick has run this long (0 = off)
+ */
+void scheduler_set_tick_budget(uint32_t budget_us);
+
+/*
+ * Number of ticks that stopped early on the budget
+ */
+uint32_t scheduler_get_budget_stops(void);
+
 /*
  * Run all pending tasks regardless of time
  *
@@ -164,17 +305,31 @@ uint8_t scheduler_run_pending(void);
  *   slot_id - Slot identifier
  *
  * Returns: Maximum execution time in microseconds, 0 if slot invalid
- *
- * Note: Requires microsecond timer support in platform layer
  */
 uint32_t scheduler_get_max_exec_time(uint8_t slot_id);
 
 /*
- * Reset maximum execution time for a slot
+ * Reset execution statistics for a slot
  *
  * Args:
  *   slot_id - Slot identifier
  */
 void scheduler_reset_max_exec_time(uint8_t slot_id);
 
+/*
+ * Copy execution statistics for a slot
+ *
+ * Returns: true if copied, false if slot_id invalid (out is zeroed)
+ */
+bool scheduler_get_stats(uint8_t slot_id, scheduler_stats_t *out);
+
+/*
+ * Replace the cycle source used for execution timing
+ *
+ * Args:
+ *   now - Free-running counter, or NULL for the platform default
+ *   cycles_per_us - Counter rate (ignored for the default)
+ */
+void scheduler_set_clock(scheduler_clock_fn now, uint32_t cycles_per_us);
+
 #endif /* KERNEL_SCHEDULER_H */
@@ -0,0 +1,190 @@
+/*
+ * Software Timer Wheel Implementation
+ */
+
+#include "timer_wheel.h"
+#include <stddef.h>
+
+/*
+ * Bucket heads are sentinels of circular lists. A timer sits in the bucket
+ * of due_ms & TIMER_WHEEL_MASK whatever its distance; a tick relinks the
+ * ones a turn or more away as it passes them.
+ */
+static struct {
+    timer_wheel_link_t bucket[TIMER_WHEEL_SLOTS];
+    uint32_t now_ms;        /* every bucket up to this time has been run */
+    uint16_t count;
+    uint8_t ready;
+} g_wheel;
+
+static void list_init(timer_wheel_link_t *head)
+{
+    head->next = head;
+    head->prev = head;
+}
+
+static void list_unlink(timer_wheel_link_t *l)
+{
+    l->prev->next = l->next;
+    l->next->prev = l->prev;
+    l->next = NULL;
+    l->prev = NULL;
+}
+
+static void list_push(timer_wheel_link_t *head, timer_wheel_link_t *l)
+{
+    l->prev = head->prev;
+    l->next = head;
+    head->prev->next = l;
+    head->prev = l;
+}
+
+static void wheel_ensure(void)
+{
+    if (!g_wheel.ready) {
+        timer_wheel_init(0);
+    }
+}
+
+static void wheel_link(sw_timer_t *t)
+{
+    list_push(&g_wheel.bucket[t->due_ms & TIMER_WHEEL_MASK], &t->link);
+}
+
+/*
+ * Run one bucket against now_ms. The bucket is moved to a local list first
+ * and drained one node at a time, so a callback may start or cancel any
+ * timer (both only touch the node itself) without upsetting the walk.
+ */
+static uint16_t wheel_run_bucket(timer_wheel_link_t *bucket, uint32_t now_ms)
+{
+    timer_wheel_link_t pending;
+    uint16_t fired = 0;
+
+    if (bucket->next == bucket) {
+        return 0;
+    }
+    pending.next = bucket->next;
+    pending.prev = bucket->prev;
+    pending.next->prev = &pending;
+    pending.prev->next = &pending;
+    list_init(bucket);
+
+    while (pending.next != &pending) {
+        sw_timer_t *t = (sw_timer_t *)(void *)pending.next;
+        list_unlink(&t->link);
+        if ((int32_t)(t->due_ms - now_ms) > 0) {
+            /* Due on a later turn. */
+            wheel_link(t);
+            continue;
+        }
+        if (t->period_ms) {
+            t->due_ms += t->period_ms;
+            if ((int32_t)(t->due_ms - now_ms) <= 0) {
+                t->due_ms = now_ms + t->period_ms;
+            }
+            wheel_link(t);
+        } else {
+            g_wheel.count--;
+        }
+        fired++;
+        t->fn(t->ctx, now_ms);
+    }
+    return fired;
+}
+
+void timer_wheel_init(uint32_t now_ms)
+{
+    for (uint32_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        list_init(&g_wheel.bucket[i]);
+    }
+    g_wheel.now_ms = now_ms;
+    g_wheel.count = 0;
+    g_wheel.ready = 1;
+}
+
+bool timer_wheel_start(sw_timer_t *t, uint32_t delay_ms, uint32_t period_ms,
+                       timer_fn fn, void *ctx)
+{
+    if (!t || !fn) {
+        return false;
+    }
+    wheel_ensure();
+    timer_wheel_cancel(t);
+    if (delay_ms == 0) {
+        delay_ms = 1;
+    }
+    t->fn = fn;
+    t->ctx = ctx;
+    t->period_ms = period_ms;
+    t->due_ms = g_wheel.now_ms + delay_ms;
+    wheel_link(t);
+    g_wheel.count++;
+    return true;
+}
+
+void timer_wheel_cancel(sw_timer_t *t)
+{
+    if (!timer_wheel_active(t)) {
+        return;
+    }
+    list_unlink(&t->link);
+    g_wheel.count--;
+}
+
+bool timer_wheel_active(const sw_timer_t *t)
+{
+    return t && t->link.next != NULL;
+}
+
+uint16_t timer_wheel_tick(uint32_t now_ms)
+{
+    uint32_t from;
+    uint32_t steps;
+    uint16_t fired = 0;
+
+    wheel_ensure();
+    from = g_wheel.now_ms;
+    steps = now_ms - from;
+    if ((int32_t)steps <= 0) {
+        return 0;
+    }
+    /* After a gap of a turn or more every bucket is due once. */
+    if (steps > TIMER_WHEEL_SLOTS) {
+        steps = TIMER_WHEEL_SLOTS;
+    }
+    /* Set first: timers started from callbacks count from this tick. */
+    g_wheel.now_ms = now_ms;
+    for (uint32_t i = 1; i <= steps; i++) {
+        fired += wheel_run_bucket(&g_wheel.bucket[(from + i) & TIMER_WHEEL_MASK], now_ms);
+    }
+    return fired;
+}
+
+uint32_t timer_wheel_next_due_ms(uint32_t now_ms)
+{
+    uint32_t best = UINT32_MAX;
+
+    if (!g_wheel.ready || g_wheel.count == 0) {
+        return UINT32_MAX;
+    }
+    for (uint32_t i = 0; i < TIMER_WHEEL_SLOTS; i++) {
+        const timer_wheel_link_t *head = &g_wheel.bucket[i];
+        for (const timer_wheel_link_t *l = head->next; l != head; l = l->next) {
+            const sw_timer_t *t = (const sw_timer_t *)(const void *)l;
+            int32_t left = (int32_t)(t->due_ms - now_ms);
+            if (left <= 0) {
+                return 0;
+            }
+            if ((uint32_t)left < best) {
+                best = (uint32_t)left;
+            }
+        }
+    }
+    return best;
+}
+
+uint16_t timer_wheel_count(void)
+{
+    return g_wheel.count;
+}
@@ -0,0 +1,125 @@
+/*
+ * Software Timer Wheel
+ *
+ * One-shot and periodic timeouts for the main loop, in place of per-module
+ * g_ms comparisons polled on every pass. Timers are caller-owned (no
+ * allocation) and hashed by expiry into TIMER_WHEEL_SLOTS one-millisecond
+ * buckets, each a circular doubly linked list:
+ *
+ *   - Start and cancel are O(1) at any depth
+ *   - A tick visits only the buckets of the milliseconds that passed; a
+ *     timer further out than one turn stays in its bucket until its turn
+ *   - Callbacks run from timer_wheel_tick() on the main loop, never from an
+ *     ISR, and may start or cancel any timer, their own included
+ *
+ * Typical usage:
+ *   static sw_timer_t debounce;
+ *   timer_wheel_start(&debounce, 50u, 0u, on_debounce, NULL);
+ *   ...
+ *   while (1) {
+ *       scheduler_tick(now);
+ *       timer_wheel_tick(now);
+ *   }
+ */
+
+#ifndef KERNEL_TIMER_WHEEL_H
+#define KERNEL_TIMER_WHEEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Buckets per turn - must be power of 2
+ */
+#define TIMER_WHEEL_SLOTS 64u
+#define TIMER_WHEEL_MASK  (TIMER_WHEEL_SLOTS - 1u)
+
+_Static_assert((TIMER_WHEEL_SLOTS & TIMER_WHEEL_MASK) == 0,
+               "TIMER_WHEEL_SLOTS must be power of 2");
+
+/*
+ * Timer callback
+ *
+ * Args:
+ *   ctx - User context pointer (from timer_wheel_start)
+ *   now_ms - Time of the tick that fired it
+ */
+typedef void (*timer_fn)(void *ctx, uint32_t now_ms);
+
+typedef struct timer_wheel_link {
+    struct timer_wheel_link *next;
+    struct timer_wheel_link *prev;
+} timer_wheel_link_t;
+
+/*
+ * Timer state - owned by the caller, zero-initialized means idle
+ */
+typedef struct {
+    timer_wheel_link_t link;    /* bucket list; both NULL while idle */
+    timer_fn fn;
+    void *ctx;
+    uint32_t due_ms;
+    uint32_t period_ms;         /* 0 = one-shot */
+} sw_timer_t;
+
+/*
+ * Reset the wheel; timers armed before are forgotten, not fired
+ *
+ * Args:
+ *   now_ms - Current time in milliseconds
+ */
+void timer_wheel_init(uint32_t now_ms);
+
+/*
+ * Arm (or re-arm) a timer
+ *
+ * The delay counts from the last tick. A periodic timer is next due
+ * period_ms after its due time; after falling more than a period behind it
+ * fires once and skips the missed periods.
+ *
+ * Args:
+ *   t - Timer; restarting an armed timer moves it
+ *   delay_ms - Time to first expiry (0 is taken as 1)
+ *   period_ms - Repeat interval, 0 for one-shot
+ *   fn - Callback
+ *   ctx - User context pointer (passed to callback)
+ *
+ * Returns: false if t or fn is NULL
+ */
+bool timer_wheel_start(sw_timer_t *t, uint32_t delay_ms, uint32_t period_ms,
+                       timer_fn fn, void *ctx);
+
+/*
+ * Disarm a timer; no effect when it is idle
+ */
+void timer_wheel_cancel(sw_timer_t *t);
+
+/*
+ * Check if a timer is armed
+ */
+bool timer_wheel_active(const sw_timer_t *t);
+
+/*
+ * Fire every timer due by now_ms - call from the main loop
+ *
+ * Returns: Number of callbacks run
+ */
+uint16_t timer_wheel_tick(uint32_t now_ms);
+
+/*
+ * Time until the earliest armed timer is due
+ *
+ * For idle decisions: 0 means one is due now, UINT32_MAX means none is
+ * armed. Walks the armed timers, so it is meant for the idle path only.
+ *
+ * Args:
+ *   now_ms - Current time in milliseconds
+ */
+uint32_t timer_wheel_next_due_ms(uint32_t now_ms);
+
+/*
+ * Number of armed timers
+ */
+uint16_t timer_wheel_count(void);
+
+#endif /* KERNEL_TIMER_WHEEL_H */
@@ -0,0 +1,155 @@
+/*
+ * Deferred Work Queue Implementation
+ *
+ * Bounded MPSC ring with a sequence number per cell. A producer claims the
+ * cell at `enq` with a compare-and-swap, fills it, then publishes it by
+ * storing seq = pos + 1; the consumer only takes a cell whose seq says it is
+ * published, and frees it by storing seq = pos + CAPACITY. A producer that is
+ * preempted between claim and publish therefore just delays the consumer at
+ * that cell - it never lets it read a half-written item.
+ *
+ * The __atomic builtins lower to LDREX/STREX + DMB on Cortex-M4.
+ */
+
+#include "work_queue.h"
+
+#if !defined(HOST_TEST)
+#include "platform/hw.h"
+#include "platform/mmio.h"
+#include "platform/nvic.h"
+#endif
+
+typedef struct {
+    uint32_t seq;
+    work_fn fn;
+    void *ctx;
+} work_cell_t;
+
+static struct {
+    uint32_t enq;              /* producers (CAS) */
+    uint32_t deq;              /* consumer */
+    volatile uint8_t draining; /* consumer re-entry guard */
+    uint32_t posted;           /* producers (atomic add) */
+    uint32_t drops;
+    volatile uint16_t hwm;
+    uint32_t runs;             /* consumer */
+    work_cell_t cells[WORK_QUEUE_CAPACITY];
+} wq;
+
+void work_queue_init(void) {
+    for (uint32_t i = 0; i < WORK_QUEUE_CAPACITY; i++) {
+        wq.cells[i].fn = 0;
+        wq.cells[i].ctx = 0;
+        __atomic_store_n(&wq.cells[i].seq, i, __ATOMIC_RELAXED);
+    }
+    wq.deq = 0;
+    wq.draining = 0;
+    __atomic_store_n(&wq.enq, 0u, __ATOMIC_RELEASE);
+    work_queue_reset_stats();
+}
+
+bool work_queue_post(work_fn fn, void *ctx) {
+    if (!fn) {
+        return false;
+    }
+
+    uint32_t pos = __atomic_load_n(&wq.enq, __ATOMIC_RELAXED);
+    work_cell_t *cell;
+    for (;;) {
+        cell = &wq.cells[pos & WORK_QUEUE_MASK];
+        int32_t dif = (int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+        if (dif == 0) {
+            /* A failed CAS reloads pos; retry at the new write index. */
+            if (__atomic_compare_exchange_n(&wq.enq, &pos, pos + 1u, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (dif < 0) {
+            /* Cell still holds an item from the previous lap: full. */
+            __atomic_fetch_add(&wq.drops, 1u, __ATOMIC_RELAXED);
+            return false;
+        } else {
+            pos = __atomic_load_n(&wq.enq, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->fn = fn;
+    cell->ctx = ctx;
+    __atomic_store_n(&cell->seq, pos + 1u, __ATOMIC_RELEASE);
+
+    __atomic_fetch_add(&wq.posted, 1u, __ATOMIC_RELAXED);
+    uint16_t depth = (uint16_t)(pos + 1u - __atomic_load_n(&wq.deq, __ATOMIC_RELAXED));
+    if (depth > wq.hwm) {
+        wq.hwm = depth;  /* racy between producers; statistics only */
+    }
+
+#if !defined(HOST_TEST)
+    mmio_write32(SCB_ICSR, SCB_ICSR_PENDSVSET);
+#endif
+    return true;
+}
+
+uint16_t work_queue_drain(uint16_t max) {
+    /* PendSV can preempt a main-loop drain; it leaves the ring to it. */
+    if (wq.draining) {
+        return 0;
+    }
+    wq.draining = 1;
+
+    uint16_t count = 0;
+    while (max == 0 || count < max) {
+        uint32_t pos = wq.deq;
+        work_cell_t *cell = &wq.cells[pos & WORK_QUEUE_MASK];
+        if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != pos + 1u) {
+            break;  /* empty, or the next claimed cell is not published yet */
+        }
+        work_fn fn = cell->fn;
+        void *ctx = cell->ctx;
+        __atomic_store_n(&cell->seq, pos + WORK_QUEUE_CAPACITY, __ATOMIC_RELEASE);
+        __atomic_store_n(&wq.deq, pos + 1u, __ATOMIC_RELAXED);
+        fn(ctx);
+        wq.runs++;
+        count++;
+    }
+
+    wq.draining = 0;
+    return count;
+}
+
+uint16_t work_queue_pending(void) {
+    uint32_t enq = __atomic_load_n(&wq.enq, __ATOMIC_ACQUIRE);
+    return (uint16_t)(enq - wq.deq);
+}
+
+void work_queue_get_stats(work_queue_stats_t *out) {
+    if (!out) {
+        return;
+    }
+    out->posted = __atomic_load_n(&wq.posted, __ATOMIC_RELAXED);
+    out->runs = wq.runs;
+    out->drops = __atomic_load_n(&wq.drops, __ATOMIC_RELAXED);
+    out->hwm = wq.hwm;
+}
+
+void work_queue_reset_stats(void) {
+    __atomic_store_n(&wq.posted, 0u, __ATOMIC_RELAXED);
+    __atomic_store_n(&wq.drops, 0u, __ATOMIC_RELAXED);
+    wq.hwm = 0;
+    wq.runs = 0;
+}
+
+void work_queue_irq_init(void) {
+#if !defined(HOST_TEST)
+    /* SHPR3[23:16] is PendSV: below every NVIC line, so it only runs once
+     * the ISR that posted (and anything it preempted) has returned. */
+    uint32_t shpr3 = mmio_read32(SCB_SHPR3);
+    shpr3 = (shpr3 & ~(0xFFu << 16)) | ((uint32_t)PLATFORM_PRIO_PENDSV << 16);
+    mmio_write32(SCB_SHPR3, shpr3);
+#endif
+}
+
+#if !defined(HOST_TEST)
+void PendSV_Handler(void) {
+    (void)work_queue_drain(0);
+}
+#endif
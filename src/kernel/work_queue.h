@@ -0,0 +1,86 @@
+/*
+ * Deferred Work Queue (run-to-completion)
+ *
+ * Lets an ISR capture what it needs and hand the rest of its follow-up work
+ * to lower priority. Items are {fn, ctx} pairs in a bounded lock-free ring:
+ *
+ *   - Any number of producers at any priority (per-cell sequence numbers,
+ *     LDREX/STREX compare-and-swap on the write index)
+ *   - One consumer: PendSV at the lowest priority on target, with the main
+ *     loop as a fallback; the two never run items concurrently
+ *   - Never blocks - post fails if full, and the caller does the work inline
+ *   - Items run to completion in the order their slots were claimed
+ */
+
+#ifndef KERNEL_WORK_QUEUE_H
+#define KERNEL_WORK_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Queue capacity - must be power of 2 for efficient modulo
+ */
+#define WORK_QUEUE_CAPACITY 16u
+#define WORK_QUEUE_MASK     (WORK_QUEUE_CAPACITY - 1u)
+
+_Static_assert((WORK_QUEUE_CAPACITY & WORK_QUEUE_MASK) == 0,
+               "WORK_QUEUE_CAPACITY must be power of 2");
+
+typedef void (*work_fn)(void *ctx);
+
+/*
+ * Queue statistics
+ *
+ * posted, drops and hwm are producer counters, runs the consumer's.
+ */
+typedef struct {
+    uint32_t posted;   /* Items accepted */
+    uint32_t runs;     /* Items executed */
+    uint32_t drops;    /* Posts refused because the ring was full */
+    uint16_t hwm;      /* Deepest fill seen after a post */
+} work_queue_stats_t;
+
+/*
+ * Reset the ring and its statistics; call before any producer is enabled
+ */
+void work_queue_init(void);
+
+/*
+ * Queue fn(ctx) for deferred execution (any context, any priority)
+ *
+ * On target this also pends PendSV, so the item runs as soon as no other
+ * exception is active.
+ *
+ * Returns: true if queued, false if fn is NULL or the ring is full
+ */
+bool work_queue_post(work_fn fn, void *ctx);
+
+/*
+ * Run queued items in order (consumer side)
+ *
+ * Args:
+ *   max - Stop after this many items; 0 runs until the ring is empty
+ *
+ * Returns: Number of items run; 0 when another drain is already in progress
+ */
+uint16_t work_queue_drain(uint16_t max);
+
+/*
+ * Number of items posted but not yet run (snapshot)
+ */
+uint16_t work_queue_pending(void);
+
+/*
+ * Copy / clear queue statistics
+ */
+void work_queue_get_stats(work_queue_stats_t *out);
+void work_queue_reset_stats(void);
+
+/*
+ * Give PendSV the lowest exception priority; call once before posting from
+ * ISRs (no-op on host)
+ */
+void work_queue_irq_init(void);
+
+#endif /* KERNEL_WORK_QUEUE_H */
@@ -5,39 +5,61 @@
 #include "app_data.h"
 #include "core.h"
 #include "src/core/trace_format.h"
+#include "src/core/trace_bin.h"
 #include "ui.h"
 #include "ui_state.h"
+#include "ui_display.h"
+#include "gfx/ui_lcd.h"
 #include "src/control/control.h"
+#include "src/control/state_snapshot.h"
 #include "src/power/power.h"
 #include "src/power/battery_monitor.h"
+#include "src/power/brownout.h"
 #include "src/input/input.h"
+#include "src/input/input_latency.h"
 #include "src/input/oem_buttons.h"
 #include "src/motor/shengyi.h"
 #include "src/motor/motor_cmd.h"
 #include "src/motor/motor_isr.h"
 #include "src/motor/motor_link.h"
-#include "src/kernel/event_queue.h"
+#include "src/kernel/event_bus.h"
+#include "src/kernel/flight_rec.h"
+#include "src/kernel/work_queue.h"
 #include "src/bus/bus.h"
 #include "src/comm/comm.h"
 #include "src/profiles/profiles.h"
+#include "src/profiles/profile_bundle.h"
 #include "src/telemetry/trip.h"
 #include "src/telemetry/telemetry.h"
+#include "src/telemetry/tlm_sampler.h"
+#include "src/telemetry/anomaly.h"
 #include "src/config/config.h"
 #include "platform/clock.h"
 #include "platform/cpu.h"
 #include "platform/hw.h"
 #include "platform/mmio.h"
+#include "platform/ram.h"
 #include "platform/time.h"
 #include "platform/board_init.h"
 #include "platform/early_init.h"
+#include "platform/uart_rx_dma.h"
+#include "platform/uart_tx_dma.h"
+#include "platform/watchdog.h"
 #include "drivers/spi_flash.h"
 #include "drivers/uart.h"
 #include "boot_log.h"
+#include "boot_steps.h"
 #include "storage/layout.h"
 #include "storage/boot_stage.h"
 #include "storage/logs.h"
+#include "storage/flash_health.h"
+#include "storage/lifetime.h"
+#include "storage/flash_jobs.h"
+#include "storage/kv_store.h"
+#include "storage/ride_log.h"
 #include "storage/ab_update.h"
 #include "storage/crash_dump.h"
+#include "storage/splash.h"
 #include "util/byteorder.h"
 #include "util/crc32.h"
 #include "src/core/math_util.h"
@@ -73,24 +95,16 @@ static void platform_power_hold_early(void)
     mmio_write32(GPIO_BRR(GPIOA_BASE), (1u << 8));
 }
 
-static uint32_t uart_brr_div(uint32_t pclk_hz, uint32_t baud)
-{
-    if (!pclk_hz || !baud)
-        return 7500u;
-    uint32_t div = (pclk_hz + (baud / 2u)) / baud;
-    return div ? div : 7500u;
-}
-
 static void uart1_init_9600(void)
 {
-    const uint32_t baud = 9600u;
-    uint32_t pclk2 = rcc_get_pclk_hz_fallback(1u);
-    uart_init_basic(UART1_BASE, uart_brr_div(pclk2, baud));
+    uart_init_baud(UART1_BASE, 9600u);
 }
 
 static void monitor_enter(boot_phase_t phase, uint8_t reinit_timebase)
 {
     disable_irqs();
+    /* The monitor re-inits UART1 at 9600; bring the module back first. */
+    comm_ble_baud_restore();
     if (reinit_timebase)
     {
         platform_clock_init();
@@ -107,6 +121,8 @@ static void monitor_enter(boot_phase_t phase, uint8_t reinit_timebase)
     g_boot_phase = phase;
 
     platform_uart_irq_init();
+    platform_buttons_exti_init();
+    comm_rx_irq_enable();
     enable_irqs();
 
     boot_monitor_run();
@@ -133,12 +149,9 @@ uint16_t g_reset_flags;
 uint32_t g_reset_csr;
 uint32_t g_inputs_debug_last_ms;
 static uint32_t g_buttons_last_sample_ms;
+static uint32_t g_buttons_burst_end_ms;
 uint32_t g_stream_period_ms = 0;   /* 0 = off */
 uint32_t g_last_stream_ms = 0;
-uint16_t g_curve_power_w;
-uint16_t g_curve_cadence_q15;
-uint16_t g_effective_cap_current_dA;
-uint16_t g_effective_cap_speed_dmph;
 
 uint8_t g_input_caps;
 uint8_t g_headlight_enabled;
@@ -155,9 +168,6 @@ uint8_t g_hw_caps = CAP_FLAG_WALK;
 vgear_table_t  g_vgears;
 cadence_bias_t g_cadence_bias;
 uint8_t        g_active_vgear;   /* 1-based index */
-uint16_t g_gear_limit_power_w;
-uint16_t g_gear_scale_q15;
-uint16_t g_cadence_bias_q15;
 
 /* button_track_t and button globals from input.h (defined in input.c) */
 /* g_cruise_toggle_request defined in control.c */
@@ -173,6 +183,10 @@ volatile boot_phase_t g_boot_phase = BOOT_PHASE_APP;
  * Config blob (versioned, CRC'd, double-buffered in SPI flash)
  * ------------------------------------------------------------- */
 #define BUTTON_DEBUG_OVERRIDE_TIMEOUT_MS 250u
+/* Sampling continues this long after the last button edge (debounce). */
+#define BUTTON_BURST_MS 60u
+/* Idle resample: lock state and a lost edge are picked up at this rate. */
+#define BUTTON_IDLE_SAMPLE_MS 500u
 
 void process_buttons(uint8_t raw_buttons);
 
@@ -181,16 +195,36 @@ static uint8_t buttons_sample_oem_gpio(void)
     /* OEM app reads GPIOC IDR (PC0-4), pulled up; pressed = 0. */
     uint8_t idr = (uint8_t)(hw_gpio_read_idr('C') & OEM_BTN_MASK);
     uint8_t pressed = (uint8_t)(~idr) & OEM_BTN_MASK;
+    bus_session_on_buttons(pressed);
     uint8_t raw = (uint8_t)(pressed | OEM_BTN_VIRTUAL);
     if ((pressed & (OEM_BTN_UP | OEM_BTN_DOWN | OEM_BTN_LIGHT)) == 0u)
         raw = (uint8_t)(raw & (uint8_t)~OEM_BTN_VIRTUAL);
     return oem_buttons_map_raw(raw, &g_button_virtual);
 }
 
+/* Anything the button path still owes a sample: a press being timed, or
+ * one-shot press flags that the next pass clears. */
+static uint8_t buttons_active(void)
+{
+    return (g_inputs.buttons || g_button_virtual || g_button_short_press || g_button_long_press ||
+            g_button_track.fsm.state != BTN_STATE_IDLE || g_button_track.extra_last) ? 1u : 0u;
+}
+
 void buttons_tick(void)
 {
     if (g_ms == g_buttons_last_sample_ms)
         return;
+    /* EXTI edges open a sampling burst; with nothing pressed the GPIO is
+     * left alone apart from the slow idle resample. */
+    uint32_t edge_cycles;
+    if (platform_buttons_activity_take(&edge_cycles))
+    {
+        g_buttons_burst_end_ms = g_ms + BUTTON_BURST_MS;
+        input_latency_edge(edge_cycles);
+    }
+    else if (!buttons_active() && (int32_t)(g_ms - g_buttons_burst_end_ms) >= 0 &&
+             (uint32_t)(g_ms - g_buttons_last_sample_ms) < BUTTON_IDLE_SAMPLE_MS)
+        return;
     g_buttons_last_sample_ms = g_ms;
 
     if (g_inputs_debug_last_ms != 0u)
@@ -207,7 +241,7 @@ uint8_t g_last_brake_state;
 uint8_t g_brake_edge;
 
 reboot_request_t g_request_soft_reboot;
-event_queue_t g_motor_events;
+event_bus_t g_event_bus;
 
 /* -------------------------------------------------------------
  * SysTick 1ms
@@ -257,31 +291,13 @@ static void headlight_toggle_oem(void)
 
 static void system_reset(void)
 {
+    uart_tx_flush(UART1_BASE);
     platform_key_output_set(0u);
     mmio_write32(SCB_AIRCR, SCB_AIRCR_VECTKEY | SCB_AIRCR_SYSRESETREQ);
     while (1)
         ;
 }
 
-static void watchdog_start_runtime(void)
-{
-    /*
-     * Start IWDG with a long timeout (~26s at 40kHz LSI, /256 prescaler)
-     * so normal runtime can survive long flash/IO operations while still
-     * guaranteeing eventual recovery from hangs.
-     */
-    mmio_write32(IWDG_KR, IWDG_KR_UNLOCK);
-    mmio_write32(IWDG_PR, 0x6u);      /* /256 */
-    mmio_write32(IWDG_RLR, 0x0FFFu);  /* max reload */
-    mmio_write32(IWDG_KR, IWDG_KR_START);
-    mmio_write32(IWDG_KR, IWDG_KR_FEED);
-}
-
-void watchdog_feed_runtime(void)
-{
-    mmio_write32(IWDG_KR, IWDG_KR_FEED);
-}
-
 __attribute__((used)) static void hardfault_capture(uint32_t *stack)
 {
     disable_irqs();
@@ -290,6 +306,8 @@ __attribute__((used)) static void hardfault_capture(uint32_t *stack)
     uint32_t pc = stack[6];
     uint32_t psr = stack[7];
     crash_dump_capture(sp, lr, pc, psr);
+    /* A fault during boot still leaves its stage trail. */
+    boot_stage_commit();
     /* Enter a minimal UART1 boot monitor so the host can fetch crash_dump/memory
      * before we reset. */
     monitor_enter(BOOT_PHASE_PANIC, 1u);
@@ -317,6 +335,8 @@ __attribute__((naked)) void HardFault_Handler(void)
 void process_buttons(uint8_t raw_buttons)
 {
     uint8_t mapped_buttons = button_map_apply(raw_buttons, g_config_active.button_map);
+    if (mapped_buttons != g_inputs.buttons)
+        input_latency_mark(INPUT_LAT_SAMPLED);
     g_inputs.buttons = mapped_buttons;
     wizard_handle_buttons(mapped_buttons);
     if (wizard_is_active())
@@ -352,6 +372,16 @@ void process_buttons(uint8_t raw_buttons)
         request_bootloader_recovery(g_button_long_press);
     }
 
+    if (g_button_short_press | g_button_long_press)
+    {
+        event_t evt = event_create(EVT_BTN_PRESS,
+                                   (uint16_t)(g_button_short_press | ((uint16_t)g_button_long_press << 8)),
+                                   g_ms);
+        (void)event_bus_publish(&g_event_bus, EVENT_LANE_INPUT, &evt);
+        if (g_button_short_press)
+            input_latency_mark(INPUT_LAT_EVENT);
+    }
+
     {
         ui_page_t prev_page = g_ui_page;
         g_ui_page = (ui_page_t)ui_page_from_buttons(g_button_short_press,
@@ -368,22 +398,6 @@ void process_buttons(uint8_t raw_buttons)
     }
 }
 
-static uint16_t cadence_bias_q15(uint16_t cadence_rpm)
-{
-    if (!g_cadence_bias.enabled || g_cadence_bias.band_rpm == 0)
-        return 32768u;
-    if (cadence_rpm <= g_cadence_bias.target_rpm)
-        return 32768u;
-    uint32_t delta = cadence_rpm - g_cadence_bias.target_rpm;
-    if (delta >= g_cadence_bias.band_rpm)
-        return clamp_q15(g_cadence_bias.min_bias_q15, 0, 65535u);
-    uint32_t span = g_cadence_bias.band_rpm;
-    uint32_t drop = (uint32_t)(32768u - g_cadence_bias.min_bias_q15);
-    uint32_t scaled = (drop * delta) / span;
-    uint32_t bias = 32768u - scaled;
-    return (uint16_t)clamp_q15((uint16_t)bias, g_cadence_bias.min_bias_q15, 32768u);
-}
-
 /* -------------------------------------------------------------
  * Profile helpers
  * ------------------------------------------------------------- */
@@ -393,249 +407,25 @@ int set_active_profile(uint8_t id, int persist)
         return 0xFE;
     g_active_profile_id = id;
     g_outputs.profile_id = g_active_profile_id;
-    g_config_active.profile_id = g_active_profile_id;
     g_last_profile_switch_ms = g_ms;
 
-    /* Keep CRC accurate even if we skip persistence. */
-    g_config_active.crc32 = 0;
-    g_config_active.crc32 = config_crc_expected(&g_config_active);
-
+    /* RAM copy only; a persisted switch reaches flash once switching stops. */
+    config_active_set_profile(id);
     if (persist)
     {
-        config_persist_active();
+        config_persist_profile(id);
     }
     return 0;
 }
-void recompute_outputs(void)
-{
-    walk_update();
-
-    uint16_t base_power = (uint16_t)((g_inputs.throttle_pct * 8u) + (g_inputs.torque_raw / 4u));
-    const assist_profile_t *p = &g_profiles[g_active_profile_id];
-    const assist_curve_profile_t *cp = &g_assist_curves[g_active_profile_id];
-    uint16_t eff_cap_current = p->cap_current_dA;
-    uint16_t eff_cap_speed = p->cap_speed_dmph;
-
-    if (g_config_active.cap_current_dA && g_config_active.cap_current_dA < eff_cap_current)
-        eff_cap_current = g_config_active.cap_current_dA;
-    if (g_config_active.cap_speed_dmph)
-    {
-        if (eff_cap_speed == 0 || g_config_active.cap_speed_dmph < eff_cap_speed)
-            eff_cap_speed = g_config_active.cap_speed_dmph;
-    }
-    if (g_config_active.mode == MODE_STREET)
-    {
-        if (eff_cap_current > STREET_MAX_CURRENT_DA)
-            eff_cap_current = STREET_MAX_CURRENT_DA;
-        if (eff_cap_speed == 0 || eff_cap_speed > STREET_MAX_SPEED_DMPH)
-            eff_cap_speed = STREET_MAX_SPEED_DMPH;
-    }
-    g_effective_cap_current_dA = eff_cap_current;
-    g_effective_cap_speed_dmph = eff_cap_speed;
-
-    g_outputs.profile_id     = g_active_profile_id;
-    g_outputs.virtual_gear   = g_active_vgear;
-
-    /* Curve-derived limits (piecewise-linear, fixed-point, bounded). */
-    int32_t curve_pw = 0;
-    if (cp->speed_curve.count)
-        curve_pw = fxp_interp_linear((int32_t)g_inputs.speed_dmph, cp->speed_curve.pts, cp->speed_curve.count);
-    int32_t cadence_q15 = 32768;
-    if (cp->cadence_curve.count)
-        cadence_q15 = fxp_interp_linear((int32_t)g_inputs.cadence_rpm, cp->cadence_curve.pts, cp->cadence_curve.count);
-    if (cadence_q15 < 0)
-        cadence_q15 = 0;
-    int32_t curve_pw_scaled = (int32_t)((curve_pw * (int64_t)cadence_q15 + (1 << 14)) >> 15);
-    if (curve_pw_scaled < 0)
-        curve_pw_scaled = 0;
-    if (curve_pw_scaled > 0xFFFF)
-        curve_pw_scaled = 0xFFFF;
-
-    uint16_t limit_power = (uint16_t)curve_pw_scaled;
-    g_curve_power_w = limit_power;
-    g_curve_cadence_q15 = (uint16_t)cadence_q15;
-
-    /* Virtual gear multiplier (Q15) */
-    g_gear_scale_q15 = 32768u;
-    if (g_active_vgear >= 1 && g_active_vgear <= g_vgears.count)
-        g_gear_scale_q15 = g_vgears.scales[g_active_vgear - 1u];
-    g_gear_limit_power_w = (uint16_t)((limit_power * (uint32_t)g_gear_scale_q15 + (1u << 14)) >> 15);
-    if (g_gear_limit_power_w > 0xFFFF)
-        g_gear_limit_power_w = 0xFFFF;
-
-    /* Optional cadence-friendly taper above target band. */
-    g_cadence_bias_q15 = cadence_bias_q15(g_inputs.cadence_rpm);
-    uint32_t biased_limit = (uint32_t)((g_gear_limit_power_w * (uint32_t)g_cadence_bias_q15 + (1u << 14)) >> 15);
-    if (biased_limit > 0xFFFF)
-        biased_limit = 0xFFFF;
-    limit_power = (uint16_t)biased_limit;
-
-    drive_mode_t drive_mode = g_drive.mode;
-    uint16_t desired_power = 0;
-    if (drive_mode == DRIVE_MODE_AUTO || drive_mode == DRIVE_MODE_SPORT)
-    {
-        desired_power = cruise_apply(base_power, limit_power);
-    }
-    else if (drive_mode == DRIVE_MODE_MANUAL_CURRENT)
-    {
-        if (g_cruise.mode != CRUISE_OFF)
-            cruise_cancel(CRUISE_EVT_CANCEL_USER);
-        uint32_t pwr = (uint32_t)g_drive.setpoint * 2u;
-        if (pwr > 0xFFFF)
-            pwr = 0xFFFF;
-        desired_power = (uint16_t)pwr;
-        limit_power = desired_power;
-    }
-    else if (drive_mode == DRIVE_MODE_MANUAL_POWER)
-    {
-        if (g_cruise.mode != CRUISE_OFF)
-            cruise_cancel(CRUISE_EVT_CANCEL_USER);
-        desired_power = manual_power_apply(g_drive.setpoint);
-        limit_power = 0xFFFF;
-    }
-    g_outputs.cruise_state = (uint8_t)g_cruise.mode;
-
-    {
-        uint8_t allow_adapt = (drive_mode == DRIVE_MODE_AUTO || drive_mode == DRIVE_MODE_SPORT) ? 1u : 0u;
-        uint8_t effort_on = (g_config_active.flags & CFG_FLAG_ADAPT_EFFORT) ? 1u : 0u;
-        uint8_t eco_on = (g_config_active.flags & CFG_FLAG_ADAPT_ECO) ? 1u : 0u;
-        if (!allow_adapt)
-            effort_on = eco_on = 0;
-
-        if (!(effort_on || eco_on))
-        {
-            adaptive_reset();
-        }
-        else
-        {
-            adaptive_update(g_inputs.speed_dmph, g_inputs.power_w, g_ms);
-            if (effort_on)
-            {
-                uint16_t boost = adaptive_effort_boost(base_power, g_inputs.speed_dmph);
-                if (boost > 0)
-                {
-                    uint32_t next = (uint32_t)desired_power + (uint32_t)boost;
-                    if (limit_power && next > limit_power)
-                        next = limit_power;
-                    if (next > 0xFFFFu)
-                        next = 0xFFFFu;
-                    desired_power = (uint16_t)next;
-                }
-            }
-            else
-            {
-                g_adapt.speed_delta_dmph = 0;
-                g_adapt.trend_active = 0;
-            }
-
-            if (eco_on)
-            {
-                desired_power = adaptive_eco_limit(desired_power);
-            }
-            else
-            {
-                g_adapt.eco_output_w = desired_power;
-                g_adapt.eco_clamp_active = 0u;
-                g_adapt.last_speed_dmph = g_inputs.speed_dmph;
-            }
-        }
-    }
-
-    g_outputs.cmd_power_w = desired_power;
-    if (g_outputs.cmd_power_w > limit_power)
-        g_outputs.cmd_power_w = limit_power;
-    g_outputs.cmd_current_dA = (uint16_t)(g_outputs.cmd_power_w / 2u);
-    g_outputs.assist_mode = (g_outputs.cmd_power_w > 0) ? 1u : 0u;
-
-    /* Enforce profile caps (speed cap zeros assist). */
-    if (eff_cap_speed && g_inputs.speed_dmph > eff_cap_speed)
-    {
-        cruise_cancel(CRUISE_EVT_CANCEL_CAP);
-        g_outputs.assist_mode = 0;
-        g_outputs.cmd_power_w = 0;
-        g_outputs.cmd_current_dA = 0;
-    }
-    else
-    {
-        if (g_outputs.cmd_power_w > p->cap_power_w)
-            g_outputs.cmd_power_w = p->cap_power_w;
-        if (g_outputs.cmd_current_dA > eff_cap_current)
-            g_outputs.cmd_current_dA = eff_cap_current;
-    }
-
-    if (g_walk_state == WALK_STATE_ACTIVE)
-    {
-        soft_start_reset();
-    }
-    else
-    {
-        g_outputs.cmd_power_w = soft_start_apply(g_outputs.cmd_power_w);
-        g_outputs.cmd_current_dA = (uint16_t)(g_outputs.cmd_power_w / 2u);
-    }
-
-    /* Apply multi-governor power policy (lugging/thermal/sag). */
-    power_policy_apply(g_outputs.cmd_power_w);
-    g_outputs.cmd_power_w = g_power_policy.p_final_w;
-    g_outputs.cmd_current_dA = (uint16_t)(g_outputs.cmd_power_w / 2u);
-    boost_update();
-
-    /* Reflect zeroed outputs in mode flag. */
-    if (g_outputs.cmd_power_w == 0 || g_outputs.cmd_current_dA == 0)
-        g_outputs.assist_mode = 0;
-
-    /* Walk assist overrides normal outputs when active. */
-    if (g_walk_state == WALK_STATE_ACTIVE)
-    {
-        g_outputs.assist_mode = 2; /* distinct walk flag */
-        g_outputs.cmd_power_w = g_walk_cmd_power_w;
-        g_outputs.cmd_current_dA = g_walk_cmd_current_dA;
-        g_outputs.cruise_state = 0;
-    }
-
-    /* Brake always zeros propulsion (walk + assist). */
-    if (g_inputs.brake)
-    {
-        cruise_cancel(CRUISE_EVT_CANCEL_BRAKE);
-        g_outputs.assist_mode = 0;
-        g_outputs.cmd_power_w = 0;
-        g_outputs.cmd_current_dA = 0;
-        g_outputs.cruise_state = 0;
-    }
-
-    if (motor_cmd_link_fault_active())
-    {
-        cruise_cancel(CRUISE_EVT_CANCEL_FAULT);
-        g_outputs.assist_mode = 0;
-        g_outputs.cmd_power_w = 0;
-        g_outputs.cmd_current_dA = 0;
-        g_outputs.cruise_state = 0;
-    }
-
-    regen_update();
-
-    if (g_outputs.cmd_current_dA > eff_cap_current)
-    {
-        g_outputs.cmd_current_dA = eff_cap_current;
-        {
-            uint32_t p_from_i = (uint32_t)g_outputs.cmd_current_dA * 2u;
-            if (g_outputs.cmd_power_w > p_from_i)
-                g_outputs.cmd_power_w = (uint16_t)p_from_i;
-        }
-    }
-
-    g_outputs.cruise_state = (uint8_t)g_cruise.mode;
-    g_outputs.last_ms        = g_ms;
-
-    g_drive.cmd_power_w = g_outputs.cmd_power_w;
-    g_drive.cmd_current_dA = g_outputs.cmd_current_dA;
-    shengyi_request_update(0u);
-}
-
 void reboot_to_bootloader(void)
 {
     const uint32_t bl_base = FLASH_BOOTLOADER_BASE;
     const uint32_t bl_sp   = *(volatile uint32_t *)(bl_base + FLASH_VECTOR_SP_OFFSET);
     const uint32_t bl_rst  = *(volatile uint32_t *)(bl_base + FLASH_VECTOR_RESET_OFFSET);
+    /* Finish a queued reply; also leaves TXEIE off for the next image. */
+    uart_tx_flush(UART1_BASE);
+    /* The next image (OEM bootloader or app) talks to the BLE module at 9600. */
+    comm_ble_baud_restore();
     disable_irqs();
     /* Match OEM shutdown semantics: deassert controller key/enable before reboot. */
     platform_key_output_set(0u);
@@ -651,6 +441,10 @@ void reboot_to_app(void)
     const uint32_t app_base = FLASH_APP_BASE;
     const uint32_t app_sp   = *(volatile uint32_t *)(app_base + FLASH_VECTOR_SP_OFFSET);
     const uint32_t app_rst  = *(volatile uint32_t *)(app_base + FLASH_VECTOR_RESET_OFFSET);
+    /* Finish a queued reply; also leaves TXEIE off for the next image. */
+    uart_tx_flush(UART1_BASE);
+    /* The next image (OEM bootloader or app) talks to the BLE module at 9600. */
+    comm_ble_baud_restore();
     disable_irqs();
     platform_key_output_set(0u);
     mmio_write32(SCB_VTOR, app_base);
@@ -670,6 +464,23 @@ void print_status(void)
 {
     if ((g_debug_uart_mask & DEBUG_UART_STATUS) == 0u)
         return;
+    state_snapshot_t st;
+    (void)state_snapshot_read(&st);
+    const motor_state_t *m = &st.motor;
+    if (g_debug_uart_mask & DEBUG_UART_BINARY)
+    {
+        trace_rec_status_t r;
+        r.ms = g_ms;
+        r.rpm = m->rpm;
+        r.torque_raw = m->torque_raw;
+        r.speed_dmph = m->speed_dmph;
+        r.soc_pct = m->soc_pct;
+        r.err = m->err;
+        uint8_t rec[TRACE_BIN_MAX_LEN];
+        size_t n = trace_bin_pack(rec, sizeof(rec), TRACE_SCHEMA_STATUS, &r, sizeof(r));
+        send_frame_port(PORT_BLE, TRACE_FRAME_CMD, rec, (uint8_t)n);
+        return;
+    }
     char line[160];
     char *ptr = line;
     size_t rem = sizeof(line);
@@ -677,22 +488,171 @@ void print_status(void)
     append_str(&ptr, &rem, "[open-fw] t=");
     append_u32(&ptr, &rem, g_ms);
     append_str(&ptr, &rem, " ms rpm=");
-    append_u16(&ptr, &rem, g_motor.rpm);
+    append_u16(&ptr, &rem, m->rpm);
     append_str(&ptr, &rem, " tq=");
-    append_u16(&ptr, &rem, g_motor.torque_raw);
+    append_u16(&ptr, &rem, m->torque_raw);
     append_str(&ptr, &rem, " speed=");
-    append_u16(&ptr, &rem, g_motor.speed_dmph / 10u);
+    append_u16(&ptr, &rem, m->speed_dmph / 10u);
     append_char(&ptr, &rem, '.');
-    append_u16(&ptr, &rem, (uint16_t)(g_motor.speed_dmph % 10u));
+    append_u16(&ptr, &rem, (uint16_t)(m->speed_dmph % 10u));
     append_str(&ptr, &rem, " soc=");
-    append_u16(&ptr, &rem, g_motor.soc_pct);
+    append_u16(&ptr, &rem, m->soc_pct);
     append_str(&ptr, &rem, " err=");
-    append_u16(&ptr, &rem, g_motor.err);
+    append_u16(&ptr, &rem, m->err);
     append_char(&ptr, &rem, '\n');
 
     uart_write(UART1_BASE, (const uint8_t *)line, (size_t)(ptr - line));
 }
 
+/* -------------------------------------------------------------
+ * Boot steps (run during the LCD waits, see boot_steps.h)
+ * ------------------------------------------------------------- */
+static void boot_step_state(void)
+{
+    g_motor.rpm = 0;
+    g_motor.torque_raw = 0;
+    g_motor.speed_dmph = 0;
+    g_motor.soc_pct = 0;
+    g_motor.err = 0;
+    g_motor.last_ms = 0;
+
+    g_inputs.speed_dmph = 0;
+    g_inputs.cadence_rpm = 0;
+    g_inputs.torque_raw = 0;
+    g_inputs.power_w = 0;
+    g_inputs.battery_dV = 0;
+    g_inputs.battery_dA = 0;
+    g_inputs.ctrl_temp_dC = 0;
+    g_inputs.throttle_pct = 0;
+    g_inputs.brake = 0;
+    g_inputs.buttons = 0;
+    g_inputs.last_ms = 0;
+    g_input_caps = 0;
+
+    g_outputs.assist_mode = 0;
+    g_outputs.profile_id = 0;
+    g_outputs.virtual_gear = 0;
+    g_outputs.cruise_state = 0;
+    g_outputs.cmd_power_w = 0;
+    g_outputs.cmd_current_dA = 0;
+    g_outputs.last_ms = 0;
+    g_last_brake_state = 0;
+    g_brake_edge = 0;
+    drive_reset();
+    g_boost = (boost_state_t){0};
+    power_policy_reset();
+    adaptive_reset();
+
+    profiles_defaults();
+    vgear_defaults();
+    cadence_bias_defaults();
+    button_track_reset();
+    g_lock_active = 0;
+    g_lock_allowed_mask = 0;
+    g_quick_action_last = QUICK_ACTION_NONE;
+    g_cruise_toggle_request = 0;
+    g_ui_settings_index = 0;
+    g_ui_tune_index = 0;
+    g_ui_graph_channel = UI_GRAPH_CH_SPEED;
+    g_ui_graph_window_idx = 1u;
+    g_ui_bus_offset = 0u;
+    g_ui_profile_select = 0u;
+    g_ui_profile_focus = UI_PROFILE_FOCUS_LIST;
+    g_ui_alert_index = 0u;
+    g_ui_alert_ack_mask = 0u;
+    g_ui_alert_last_seq = 0u;
+    g_alert_ack_active = 0;
+
+    g_request_soft_reboot = REBOOT_REQUEST_NONE;
+}
+
+static void boot_step_store(void)
+{
+    /* Queue and KV index come up before anything loads persisted state. */
+    flash_jobs_init();
+    kv_init();
+    flash_health_init();
+}
+
+static void boot_step_battery(void)
+{
+    /* OEM v2.5.1: battery ADC monitoring is active during normal runtime. */
+    battery_monitor_init();
+}
+
+static void boot_step_config(void)
+{
+    config_stage_reset();
+    /* Ahead of the config, whose saved gear is checked against the table. */
+    profile_bundle_load();
+    config_load_active();
+}
+
+static void boot_step_ride(void)
+{
+    ride_log_load();
+    trip_init();
+    /* Resumes a trip cut by a power loss, then arms the PVD. */
+    brownout_init();
+    range_reset();
+    /* A region formatted now starts from the finalized trips' totals. */
+    trip_totals_t totals;
+    trip_get_totals(&totals);
+    lifetime_init(totals.distance_m, totals.energy_wh);
+}
+
+static void boot_step_logs(void)
+{
+    event_log_load();
+    stream_log_load();
+    if (g_reset_flags)
+        event_log_append(EVT_RESET_REASON, (uint8_t)(g_reset_flags & 0xFFu));
+    if (brownout_restored())
+        event_log_append(EVT_POWER_FAIL, 0u);
+}
+
+static void boot_step_ab(void)
+{
+    ab_update_init();
+}
+
+enum {
+    BOOT_STEP_STATE = 0,
+    BOOT_STEP_STORE,
+    BOOT_STEP_BATTERY,
+    BOOT_STEP_CONFIG,
+    BOOT_STEP_RIDE,
+    BOOT_STEP_LOGS,
+    BOOT_STEP_AB,
+    BOOT_STEP_COUNT
+};
+
+#define BOOT_DEP(step) ((uint8_t)(1u << (step)))
+
+static const boot_step_t k_boot_steps[BOOT_STEP_COUNT] = {
+    [BOOT_STEP_STATE]   = { boot_step_state,   0xBAB0u, 0u },
+    [BOOT_STEP_STORE]   = { boot_step_store,   0xBAB1u, 0u },
+    [BOOT_STEP_BATTERY] = { boot_step_battery, 0xBAA1u, 0u },
+    [BOOT_STEP_CONFIG]  = { boot_step_config,  0xBAA8u, BOOT_DEP(BOOT_STEP_STATE) | BOOT_DEP(BOOT_STEP_STORE) },
+    [BOOT_STEP_RIDE]    = { boot_step_ride,    0xBAADu, BOOT_DEP(BOOT_STEP_STORE) },
+    /* The power-fail event reads what brownout_init() restored. */
+    [BOOT_STEP_LOGS]    = { boot_step_logs,    0xBAA7u, BOOT_DEP(BOOT_STEP_STORE) | BOOT_DEP(BOOT_STEP_RIDE) },
+    [BOOT_STEP_AB]      = { boot_step_ab,      0xBAACu, BOOT_DEP(BOOT_STEP_STORE) },
+};
+
+/* A stored full-screen frame stands in for the boot log until the first
+ * live frame repaints over it. */
+static int boot_splash_show(void)
+{
+    uint32_t addr;
+    uint16_t w;
+    uint16_t h;
+    if (!splash_image(&addr, &w, &h) || w != DISP_W || h != DISP_H)
+        return 0;
+    ui_lcd_blit_rgb565_from_spi_flash(0u, 0u, w, h, addr, NULL, NULL);
+    return 1;
+}
+
 /* -------------------------------------------------------------
  * Basic main
  * ------------------------------------------------------------- */
@@ -710,12 +670,19 @@ int main(void)
     if (mmio_read32(SCB_VTOR) != FLASH_APP_BASE)
         mmio_write32(SCB_VTOR, FLASH_APP_ALIAS);
     reset_flags_capture();
+    /* Before anything logs, so a surviving trace is kept rather than cleared. */
+    flight_rec_init(g_reset_flags);
     /* Encode reset flags for post-mortem: 0xE0000000 | flags. */
     boot_stage_mark(0xE0000000u | (uint32_t)g_reset_flags);
     platform_power_hold_early();
 
     platform_clock_init();
     platform_nvic_init();
+    /* Before the first DMA/UART IRQ can post deferred work. */
+    work_queue_init();
+    work_queue_irq_init();
+    /* Decides, once per boot, whether RAM_EXT buffers are usable. */
+    platform_ram_ext_init();
     boot_stage_mark(0xB001);
 
     /* Bring up OEM timebase (TIM2 5ms) early so SPI flash timeouts can advance g_ms. */
@@ -729,23 +696,24 @@ int main(void)
     /* OEM doesn't have safe-mode. Just init buttons and continue. */
     platform_buttons_init();
 
+    /* Flash loads and state setup fill the LCD power-up waits. */
+    boot_steps_begin(k_boot_steps, BOOT_STEP_COUNT, boot_stage_mark);
+    platform_board_set_wait_hook(boot_steps_run_one);
     platform_board_init();
+    platform_board_set_wait_hook(NULL);
     platform_backlight_set_level(5u);
 
-    boot_log_lcd_ready();
+    if (boot_splash_show())
+        boot_stage_mark(0xBAAE);
+    else
+        boot_log_lcd_ready();
     boot_stage_mark(0xB004);
     /* Keep controller/display power latched once basic display init succeeds. */
     platform_key_output_set(1u);
 
-    /* OEM v2.5.1: battery ADC monitoring is active during normal runtime. */
-    battery_monitor_init();
-    boot_stage_mark(0xBAA1);
-
     /* UART1 (BLE) is on APB2; OEM app uses 9600. */
     const uint32_t uart_baud = 9600u;
-    uint32_t pclk2 = rcc_get_pclk_hz_fallback(1u);
-    uint32_t brr1 = uart_brr_div(pclk2, uart_baud);
-    uart_init_basic(UART1_BASE, brr1);
+    uart_init_baud(UART1_BASE, uart_baud);
     boot_stage_mark(0xBAA2);
     /* OEM v2.3.0: ble_uart1_full_init sends "TTM:MAC-?" to query BLE module MAC. */
     ble_ttm_send_mac_query();
@@ -758,97 +726,40 @@ int main(void)
 
     /* UART2 (motor) is on APB1; match OEM 9600 for Shengyi DWG22. */
     platform_motor_uart_pins_init();
-    uint32_t pclk1 = rcc_get_pclk_hz_fallback(0u);
-    uint32_t brr2 = uart_brr_div(pclk1, uart_baud);
-    uart_init_basic(UART2_BASE, brr2);
+    uart_init_baud(UART2_BASE, uart_baud);
     /* OEM v2.3.0: UART2 is always 8N1 (word_length=0 in usart2_hw_init).
      * The motor controller expects 8-bit framing on all protocols. */
 
     platform_uart_irq_init();
+    /* Comm replies and debug text on UART1 now drain from the TXE interrupt. */
+    uart_tx_irq_enable(UART1_BASE);
+    /* ...and incoming frames are assembled by the RX interrupt. */
+    comm_rx_irq_enable();
     boot_stage_mark(0xBAA4);
 
-    g_motor.rpm = 0;
-    g_motor.torque_raw = 0;
-    g_motor.speed_dmph = 0;
-    g_motor.soc_pct = 0;
-    g_motor.err = 0;
-    g_motor.last_ms = 0;
-
-    g_inputs.speed_dmph = 0;
-    g_inputs.cadence_rpm = 0;
-    g_inputs.torque_raw = 0;
-    g_inputs.power_w = 0;
-    g_inputs.battery_dV = 0;
-    g_inputs.battery_dA = 0;
-    g_inputs.ctrl_temp_dC = 0;
-    g_inputs.throttle_pct = 0;
-    g_inputs.brake = 0;
-    g_inputs.buttons = 0;
-    g_inputs.last_ms = 0;
-    g_input_caps = 0;
-
-    g_outputs.assist_mode = 0;
-    g_outputs.profile_id = 0;
-    g_outputs.virtual_gear = 0;
-    g_outputs.cruise_state = 0;
-    g_outputs.cmd_power_w = 0;
-    g_outputs.cmd_current_dA = 0;
-    g_outputs.last_ms = 0;
-    g_last_brake_state = 0;
-    g_brake_edge = 0;
-    drive_reset();
-    g_boost = (boost_state_t){0};
-    power_policy_reset();
-    adaptive_reset();
-
-    trip_init();
-    range_reset();
+    /* Whatever the LCD waits did not cover. */
+    boot_steps_finish();
 
     speed_rb_init();
     graph_init();
+    tlm_sampler_init();
+    anomaly_reset();
     bus_capture_set_enabled(0, 1);
 
-    event_queue_init(&g_motor_events);
-    motor_isr_init(&g_motor_events);
+    event_bus_init(&g_event_bus);
+    platform_cycle_counter_init();
+    motor_isr_init(&g_event_bus);
     /* Enable motor ISR tick AFTER motor_isr_init, not before. */
     platform_motor_isr_enable();
+    /* Move UART2 RX onto circular DMA; frames are parsed on the IDLE line. */
+    platform_uart2_rx_dma_init();
+    platform_uart2_tx_dma_init();
     boot_stage_mark(0xBAA5);
     motor_cmd_init();
     shengyi_init();
     motor_link_init();
     boot_stage_mark(0xBAA6);
 
-    event_log_load();
-    stream_log_load();
-    boot_stage_mark(0xBAA7);
-    if (g_reset_flags)
-        event_log_append(EVT_RESET_REASON, (uint8_t)(g_reset_flags & 0xFFu));
-
-    vgear_defaults();
-    cadence_bias_defaults();
-    button_track_reset();
-    g_lock_active = 0;
-    g_lock_allowed_mask = 0;
-    g_quick_action_last = QUICK_ACTION_NONE;
-    g_cruise_toggle_request = 0;
-    g_ui_settings_index = 0;
-    g_ui_tune_index = 0;
-    g_ui_graph_channel = UI_GRAPH_CH_SPEED;
-    g_ui_graph_window_idx = 1u;
-    g_ui_bus_offset = 0u;
-    g_ui_profile_select = 0u;
-    g_ui_profile_focus = UI_PROFILE_FOCUS_LIST;
-    g_ui_alert_index = 0u;
-    g_ui_alert_ack_mask = 0u;
-    g_ui_alert_last_seq = 0u;
-    g_alert_ack_active = 0;
-    g_alert_ack_until_ms = 0;
-
-    g_request_soft_reboot = REBOOT_REQUEST_NONE;
-    config_stage_reset();
-    config_load_active();
-    boot_stage_mark(0xBAA8);
-    ab_update_init();
     g_outputs.profile_id = g_config_active.profile_id;
     g_ui_profile_select = g_active_profile_id;
     g_ui_profile_focus = UI_PROFILE_FOCUS_LIST;
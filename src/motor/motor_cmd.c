@@ -9,15 +9,19 @@
 #include "motor_isr.h"
 #include "motor_stx02.h"
 #include "motor_link.h"
+#include "motor_health.h"
 #include "shengyi.h"
 #include "app_data.h"
 #include "../control/control.h"
 #include "../power/power.h"
 #include "battery_soc.h"
+#include "battery_est.h"
 #include "battery_monitor.h"
 #include "../telemetry/telemetry.h"
 #include "../config/config.h"
 #include "../util/bool_to_u8.h"
+#include "../core/speed_filter.h"
+#include "../bus/bus.h"
 
 #include <string.h>
 
@@ -31,9 +35,9 @@ extern volatile uint32_t g_ms;
 /* Keep a deterministic fallback if config has not been loaded. */
 #define MOTOR_CMD_DEFAULT_WHEEL_MM SHENGYI_DEFAULT_WHEEL_MM
 #define MOTOR_CMD_HEALTH_TIMEOUT_MS 500u
-#define MOTOR_CMD_STX02_CMD1_OPCODE 1u
-#define MOTOR_CMD_AUTH_XOR_OPCODE 0x46u
 #define MOTOR_CMD_STALE_STATUS_AGE_MS 200u
+/* Display tracker restarts from the raw sample after a gap this long. */
+#define MOTOR_CMD_SPEED_TRACK_GAP_MS 1000u
 
 /*
  * Module state
@@ -49,6 +53,10 @@ static struct {
     bool speed_over;                /* Speed limit exceeded */
     bool cmd_dirty;                 /* Command needs update */
     bool comm_fault_active;         /* Latched when link times out */
+
+    speed_conv_t speed_conv;        /* Cached wheel numerator for period -> dmph */
+    speed_ab_t speed_track;         /* Display speed (g_motor.speed_dmph) tracker */
+    uint32_t speed_track_ms;        /* Last tracked status frame */
 } g_motor_cmd;
 
 /*
@@ -59,18 +67,18 @@ static uint8_t motor_cmd_get_current_assist_mapped(void);
 static bool motor_cmd_battery_low_flag(void);
 static bool motor_cmd_should_refresh_status_cache(uint8_t opcode, uint32_t now_ms);
 static uint16_t motor_cmd_status_speed_dmph(uint8_t opcode, motor_proto_t proto);
+static uint16_t motor_cmd_track_display_speed(uint16_t speed_dmph, uint32_t now_ms);
 static uint16_t motor_cmd_effective_wheel_mm(void);
 static void motor_cmd_sync_motor_from_inputs(uint32_t now_ms);
 static void motor_cmd_sync_status_cache(uint16_t speed_dmph, uint32_t now_ms);
-static bool motor_cmd_handle_status_0x52(const uint8_t *frame, uint8_t len, uint32_t now_ms);
+static void motor_cmd_apply_status_0x52(const motor_isr_status_t *st, uint32_t now_ms);
 static void motor_cmd_record_parse_error(void);
 static uint16_t motor_cmd_speed_dmph_from_raw(uint16_t speed_raw, uint16_t wheel_mm);
-static int16_t motor_cmd_current_dA_from_raw(uint8_t current_raw);
 static uint16_t motor_cmd_speed_dmph_from_period_ms(uint16_t period_ms, uint16_t wheel_mm);
 
-static bool motor_cmd_handle_stx02_status_cmd1(const uint8_t *frame, uint8_t len, uint32_t now_ms);
-static bool motor_cmd_handle_auth_status_f0x46(const uint8_t *frame, uint8_t len, uint32_t now_ms);
-static bool motor_cmd_handle_v2_short(const uint8_t *frame, uint8_t len, uint32_t now_ms);
+static void motor_cmd_apply_stx02_status_cmd1(const motor_isr_status_t *st, uint32_t now_ms);
+static void motor_cmd_apply_auth_status_f0x46(const motor_isr_status_t *st, uint32_t now_ms);
+static void motor_cmd_apply_v2_short(const motor_isr_status_t *st, uint32_t now_ms);
 
 /*
  * Initialize motor command processor
@@ -81,6 +89,7 @@ void motor_cmd_init(void)
     g_motor_cmd.status.valid = false;
     g_motor_cmd.cmd_dirty = true;  /* Force initial command send */
     g_motor_cmd.comm_fault_active = false;
+    motor_health_reset();
 }
 
 /*
@@ -103,133 +112,146 @@ void motor_cmd_process(const event_t *evt)
             uint8_t opcode = (uint8_t)(evt->payload16 & 0xFFu);
             motor_proto_t proto = (motor_proto_t)(evt->payload16 >> 8);
 
+            /* Unarmed v2 captures are byte-pattern matches; only count them
+             * as link traffic when v2 is the protocol in use. */
+            if (proto != MOTOR_PROTO_V2_FIXED || motor_link_get_active_proto() == MOTOR_PROTO_V2_FIXED)
+                motor_health_on_frame((uint8_t)proto, opcode, evt->timestamp);
+
+            /* Live frames feed the capture ring (and so the trigger recorder). */
+            if (bus_capture_get_enabled())
+            {
+                uint8_t raw[SHENGYI_MAX_FRAME_SIZE];
+                uint8_t raw_len = 0;
+                uint8_t raw_op = 0;
+                uint8_t raw_seq = 0;
+                motor_proto_t raw_proto = proto;
+                uint16_t raw_aux16 = 0u;
+                if (motor_isr_copy_last_frame(raw, sizeof(raw), &raw_len, &raw_op, &raw_seq, &raw_proto,
+                                              &raw_aux16) &&
+                    raw_proto == proto && raw_op == opcode)
+                    bus_capture_append(BUS_MOTOR, raw, raw_len, 0u);
+            }
+
             bool frame_handled = false;
             bool frame_updates_inputs = false;
 
-            uint8_t frame[SHENGYI_MAX_FRAME_SIZE];
-            uint8_t frame_len = 0;
-            uint8_t frame_op = 0;
-            uint8_t frame_seq = 0;
-            motor_proto_t frame_proto = MOTOR_PROTO_SHENGYI_3A1A;
-            uint16_t frame_aux16 = 0u;
-            if (motor_isr_copy_last_frame(frame, sizeof(frame), &frame_len, &frame_op, &frame_seq,
-                                          &frame_proto, &frame_aux16))
+            if (motor_isr_is_status_frame(proto, opcode))
             {
-                if (proto != frame_proto)
+                /* Status frames are decoded by the ISR; no raw copy or re-parse. */
+                motor_isr_status_t st;
+                if (!motor_isr_read_status(&st) || st.proto != (uint8_t)proto || st.op != opcode)
                 {
-                    /* Stale event vs last frame snapshot; ignore. */
+                    /* Stale event vs last status snapshot; ignore. */
                     break;
                 }
 
-                if (proto == MOTOR_PROTO_SHENGYI_3A1A)
+                if (!st.ok)
+                {
+                    motor_cmd_record_parse_error();
+                }
+                else
                 {
-                    /* Shengyi uses the opcode embedded in the frame. */
-                    if (frame_op != opcode)
-                        break;
+                    if (proto == MOTOR_PROTO_SHENGYI_3A1A)
+                        motor_cmd_apply_status_0x52(&st, evt->timestamp);
+                    else if (proto == MOTOR_PROTO_STX02_XOR)
+                        motor_cmd_apply_stx02_status_cmd1(&st, evt->timestamp);
+                    else if (proto == MOTOR_PROTO_AUTH_XOR_CR)
+                        motor_cmd_apply_auth_status_f0x46(&st, evt->timestamp);
+                    else
+                        motor_cmd_apply_v2_short(&st, evt->timestamp);
+                    frame_handled = true;
+                    frame_updates_inputs = true;
+                }
+            }
+            else if (proto == MOTOR_PROTO_SHENGYI_3A1A)
+            {
+                uint8_t frame[SHENGYI_MAX_FRAME_SIZE];
+                uint8_t frame_len = 0;
+                uint8_t frame_op = 0;
+                uint8_t frame_seq = 0;
+                motor_proto_t frame_proto = MOTOR_PROTO_SHENGYI_3A1A;
+                uint16_t frame_aux16 = 0u;
+                if (!motor_isr_copy_last_frame(frame, sizeof(frame), &frame_len, &frame_op, &frame_seq,
+                                               &frame_proto, &frame_aux16))
+                    break;
 
-                    if (opcode == SHENGYI_OPCODE_STATUS)
-                    {
-                        frame_handled = motor_cmd_handle_status_0x52(frame, frame_len, evt->timestamp);
-                        frame_updates_inputs = frame_handled;
-                        if (!frame_handled)
-                            motor_cmd_record_parse_error();
-                    }
-                    else if (opcode == SHENGYI_OPCODE_CONFIG_53)
+                /* Stale event vs last frame snapshot; ignore. Shengyi uses the
+                 * opcode embedded in the frame. */
+                if (frame_proto != proto || frame_op != opcode)
+                    break;
+
+                if (opcode == SHENGYI_OPCODE_CONFIG_53)
+                {
+                    if (shengyi_frame_validate(frame, frame_len, SHENGYI_OPCODE_CONFIG_53, 7u, NULL))
                     {
-                        if (shengyi_frame_validate(frame, frame_len, SHENGYI_OPCODE_CONFIG_53, 7u, NULL))
-                        {
-                            shengyi_notify_rx_opcode(opcode);
-                            g_motor_cmd.cmd_dirty = true;
-                            motor_cmd_update_command();
-                            frame_handled = true;
-                        }
-                        else
-                        {
-                            motor_cmd_record_parse_error();
-                        }
+                        shengyi_notify_rx_opcode(opcode);
+                        g_motor_cmd.cmd_dirty = true;
+                        motor_cmd_update_command();
+                        frame_handled = true;
                     }
-                    else if (opcode == SHENGYI_OPCODE_STATUS_C0)
+                    else
                     {
-                        const uint8_t *payload = NULL;
-                        if (shengyi_frame_validate(frame, frame_len, SHENGYI_OPCODE_STATUS_C0, 52u, &payload))
-                        {
-                            uint8_t status = bool_to_u8(shengyi_apply_config_c0(payload, frame[3]));
-                            uint8_t resp[16];
-                            size_t rlen = shengyi_build_frame_0xC1(status, resp, sizeof(resp));
-                            if (rlen)
-                                motor_isr_queue_frame(resp, (uint8_t)rlen);
-                            g_motor_cmd.cmd_dirty = true;
-                            frame_handled = true;
-                        }
-                        else
-                        {
-                            motor_cmd_record_parse_error();
-                        }
+                        motor_cmd_record_parse_error();
                     }
-                    else if (opcode == SHENGYI_OPCODE_CONFIG_C2)
+                }
+                else if (opcode == SHENGYI_OPCODE_STATUS_C0)
+                {
+                    const uint8_t *payload = NULL;
+                    if (shengyi_frame_validate(frame, frame_len, SHENGYI_OPCODE_STATUS_C0, 52u, &payload))
                     {
-                        if (shengyi_frame_validate(frame, frame_len, SHENGYI_OPCODE_CONFIG_C2, 0u, NULL))
-                        {
-                            uint8_t resp[SHENGYI_MAX_FRAME_SIZE];
-                            size_t rlen = shengyi_build_frame_0xC3(resp, sizeof(resp));
-                            if (rlen)
-                                motor_isr_queue_frame(resp, (uint8_t)rlen);
-                            frame_handled = true;
-                        }
-                        else
-                        {
-                            motor_cmd_record_parse_error();
-                        }
+                        uint8_t status = bool_to_u8(shengyi_apply_config_c0(payload, frame[3]));
+                        uint8_t resp[16];
+                        size_t rlen = shengyi_build_frame_0xC1(status, resp, sizeof(resp));
+                        if (rlen)
+                            motor_isr_queue_frame(resp, (uint8_t)rlen);
+                        g_motor_cmd.cmd_dirty = true;
+                        frame_handled = true;
                     }
-                    else if (opcode == SHENGYI_OPCODE_PROTO_SWITCH)
+                    else
                     {
-                        /* OEM v2.3.0: motor sends 0xAB to request protocol switch.
-                         * payload[0] != 0 triggers switch, payload[1] = protocol index. */
-                        const uint8_t *ab_payload = NULL;
-                        if (shengyi_frame_validate(frame, frame_len, SHENGYI_OPCODE_PROTO_SWITCH, 2u, &ab_payload))
-                        {
-                            if (ab_payload[0] != 0u)
-                                motor_link_switch_protocol(ab_payload[1]);
-                            frame_handled = true;
-                        }
-                        else
-                        {
-                            motor_cmd_record_parse_error();
-                        }
+                        motor_cmd_record_parse_error();
                     }
                 }
-                else if (proto == MOTOR_PROTO_STX02_XOR)
+                else if (opcode == SHENGYI_OPCODE_CONFIG_C2)
                 {
-                    if (opcode == MOTOR_CMD_STX02_CMD1_OPCODE)
+                    if (shengyi_frame_validate(frame, frame_len, SHENGYI_OPCODE_CONFIG_C2, 0u, NULL))
                     {
-                        frame_handled = motor_cmd_handle_stx02_status_cmd1(frame, frame_len, evt->timestamp);
-                        frame_updates_inputs = frame_handled;
-                        if (!frame_handled)
-                            motor_cmd_record_parse_error();
+                        uint8_t resp[SHENGYI_MAX_FRAME_SIZE];
+                        size_t rlen = shengyi_build_frame_0xC3(resp, sizeof(resp));
+                        if (rlen)
+                            motor_isr_queue_frame(resp, (uint8_t)rlen);
+                        frame_handled = true;
                     }
-                }
-                else if (proto == MOTOR_PROTO_AUTH_XOR_CR)
-                {
-                    if (opcode == MOTOR_CMD_AUTH_XOR_OPCODE)
+                    else
                     {
-                        frame_handled = motor_cmd_handle_auth_status_f0x46(frame, frame_len, evt->timestamp);
-                        frame_updates_inputs = frame_handled;
-                        if (!frame_handled)
-                            motor_cmd_record_parse_error();
+                        motor_cmd_record_parse_error();
                     }
                 }
-                else if (proto == MOTOR_PROTO_V2_FIXED)
+                else if (opcode == SHENGYI_OPCODE_PROTO_SWITCH)
                 {
-                    frame_handled = motor_cmd_handle_v2_short(frame, frame_len, evt->timestamp);
-                    frame_updates_inputs = frame_handled;
-                    if (!frame_handled)
+                    /* OEM v2.3.0: motor sends 0xAB to request protocol switch.
+                     * payload[0] != 0 triggers switch, payload[1] = protocol index. */
+                    const uint8_t *ab_payload = NULL;
+                    if (shengyi_frame_validate(frame, frame_len, SHENGYI_OPCODE_PROTO_SWITCH, 2u, &ab_payload))
+                    {
+                        if (ab_payload[0] != 0u)
+                            motor_link_switch_protocol(ab_payload[1]);
+                        frame_handled = true;
+                    }
+                    else
+                    {
                         motor_cmd_record_parse_error();
+                    }
                 }
             }
 
             if (frame_handled && proto == MOTOR_PROTO_SHENGYI_3A1A && opcode == SHENGYI_OPCODE_STATUS)
                 motor_cmd_sync_motor_from_inputs(evt->timestamp);
 
+            /* Control keeps the raw g_inputs speed; only the display copy is tracked. */
+            if (frame_updates_inputs)
+                g_motor.speed_dmph = motor_cmd_track_display_speed(g_motor.speed_dmph, evt->timestamp);
+
             if (frame_updates_inputs && motor_cmd_should_refresh_status_cache(opcode, evt->timestamp))
             {
                 motor_cmd_sync_status_cache(motor_cmd_status_speed_dmph(opcode, proto), evt->timestamp);
@@ -242,6 +264,7 @@ void motor_cmd_process(const event_t *evt)
             /* Protocol error */
             g_motor_cmd.stats.errors++;
             uint8_t error_code = (uint8_t)(evt->payload16 & 0xFF);
+            motor_health_on_error(error_code, evt->timestamp);
 
             /* Update motor error state */
             g_motor.err = error_code;
@@ -260,6 +283,7 @@ void motor_cmd_process(const event_t *evt)
         case EVT_MOTOR_TIMEOUT: {
             /* Communication timeout */
             g_motor_cmd.stats.timeouts++;
+            motor_health_on_timeout(evt->timestamp);
 
             /* Mark motor state as stale */
             if (evt->timestamp - g_motor.last_ms > MOTOR_CMD_HEALTH_TIMEOUT_MS) {
@@ -277,46 +301,36 @@ void motor_cmd_process(const event_t *evt)
 
 static uint16_t motor_cmd_speed_dmph_from_period_ms(uint16_t period_ms, uint16_t wheel_mm)
 {
-    if (period_ms == 0u || wheel_mm == 0u)
-        return 0u;
-
-    /* OEM-style: speed_kmh = (3.6 * wheel_mm) / period_ms where period_ms is ms/rev. */
-    uint32_t kmh_x10 = (36u * (uint32_t)wheel_mm) / (uint32_t)period_ms;
-    /* deci-mph = kmh_x10 * 0.621371... */
-    uint32_t dmph = (kmh_x10 * 621u + 500u) / 1000u;
+    /* OEM-style: speed_kmh = (3.6 * wheel_mm) / period_ms where period_ms is ms/rev,
+     * folded with the mph factor into one cached numerator (single divide). */
+    speed_conv_set_wheel(&g_motor_cmd.speed_conv, wheel_mm);
+    uint16_t dmph = speed_conv_dmph(&g_motor_cmd.speed_conv, period_ms);
     /* OEM caps at 99.9 kph (~62.1 mph). */
-    if (dmph > 621u)
-        dmph = 621u;
-    return (uint16_t)dmph;
+    return (dmph > 621u) ? 621u : dmph;
 }
 
-static bool motor_cmd_handle_stx02_status_cmd1(const uint8_t *frame, uint8_t len, uint32_t now_ms)
+static void motor_cmd_apply_stx02_status_cmd1(const motor_isr_status_t *st, uint32_t now_ms)
 {
     /* OEM v2.5.1 (mode=1): 0x02 len cmd payload... xor. cmd=1 payload is 10 bytes. */
-    motor_stx02_cmd1_t s;
-    if (!motor_stx02_decode_cmd1(frame, len, &s))
-    {
-        return false;
-    }
-
     uint16_t wheel_mm = motor_cmd_effective_wheel_mm();
     uint16_t speed_dmph = 0u;
+    uint16_t period_ms = st->speed_raw;
 
     /*
      * OEM: if period_ms >= 3000, treat speed as 0.
      * Evidence: APP_process_motor_response_packet @ 0x08021CA8 compares to 0x0BB8.
      */
-    if (s.period_ms > 0u && s.period_ms < 3000u)
-        speed_dmph = motor_cmd_speed_dmph_from_period_ms(s.period_ms, wheel_mm);
+    if (period_ms > 0u && period_ms < 3000u)
+        speed_dmph = motor_cmd_speed_dmph_from_period_ms(period_ms, wheel_mm);
 
-    g_motor.err = s.err_code;
+    g_motor.err = st->err;
     g_motor.speed_dmph = speed_dmph;
-    if (s.soc_valid)
-        g_motor.soc_pct = s.soc_pct;
+    if (st->flags & MOTOR_ISR_STATUS_F_SOC)
+        g_motor.soc_pct = st->soc_pct;
     g_motor.last_ms = now_ms;
 
     g_inputs.speed_dmph = speed_dmph;
-    g_inputs.battery_dA = s.current_dA;
+    g_inputs.battery_dA = st->current_dA;
     g_input_caps |= INPUT_CAP_BATT_I;
     /*
      * OEM stores bit2/bit7 from STX02 cmd1 as internal status flags; for JH0 we
@@ -326,70 +340,43 @@ static bool motor_cmd_handle_stx02_status_cmd1(const uint8_t *frame, uint8_t len
     g_inputs.last_ms = now_ms;
 
     speed_rb_push(speed_dmph);
-    return true;
 }
 
-static bool motor_cmd_handle_auth_status_f0x46(const uint8_t *frame, uint8_t len, uint32_t now_ms)
+static void motor_cmd_apply_auth_status_f0x46(const motor_isr_status_t *st, uint32_t now_ms)
 {
     /*
      * OEM v2.5.1 (mode=3): auth-like frames start with 0x46 ('F').
-     * The OEM processes 6 bytes after the SOF as a "battery status packet".
+     * The OEM processes 6 bytes after the SOF as a "battery status packet";
+     * the ISR decodes soc (20*p[0]), current (p[1]/3.0 A) and the wheel period.
      *
      * We mirror the speed math for compatibility, but keep parsing conservative.
      */
-    if (!frame || len < (uint8_t)(1u + 6u + 2u))
-        return false;
-    if (frame[0] != 0x46u)
-        return false;
-
-    const uint8_t *p = &frame[1];
-
-    /* OEM v2.5.1 `APP_process_battery_status_packet` @ 0x8023774 consumes 6 bytes:
-     * p[0] -> if a selector is 1, sets soc_pct-like field = 20*p[0]
-     * p[1] -> (p[1]/3.0)*1000 (looks like current-like scaling)
-     * p[2..3] -> wheel period (ms/rev) */
-    uint8_t soc_pct = (uint8_t)(p[0] * 20u);
-    if (soc_pct > 100u) soc_pct = 100u;
-
-    /* Convert OEM's (byte/3.0)*1000 mA to deci-amps.
-     * dA = mA/100 = (byte*1000/3)/100 = byte*10/3. */
-    int16_t batt_dA = (int16_t)(((int32_t)p[1] * 10 + 1) / 3);
-
-    uint16_t period_ms = (uint16_t)((uint16_t)p[2] << 8) | p[3];
+    uint16_t period_ms = st->speed_raw;
     uint16_t wheel_mm = motor_cmd_effective_wheel_mm();
     uint16_t speed_dmph = 0u;
     if (period_ms > 0u && period_ms < 3000u)
         speed_dmph = motor_cmd_speed_dmph_from_period_ms(period_ms, wheel_mm);
 
     g_motor.speed_dmph = speed_dmph;
-    g_motor.soc_pct = soc_pct;
+    g_motor.soc_pct = st->soc_pct;
     g_motor.last_ms = now_ms;
     g_inputs.speed_dmph = speed_dmph;
-    g_inputs.battery_dA = batt_dA;
+    g_inputs.battery_dA = st->current_dA;
     g_inputs.brake = 0u;
     g_input_caps |= INPUT_CAP_BATT_I;
     g_inputs.last_ms = now_ms;
-    return true;
 }
 
-static bool motor_cmd_handle_v2_short(const uint8_t *frame, uint8_t len, uint32_t now_ms)
+static void motor_cmd_apply_v2_short(const motor_isr_status_t *st, uint32_t now_ms)
 {
-    if (!frame || len != 5u)
-        return false;
-
-    /* Best-effort: treat bytes 2/3 as a period ms (big-endian) if plausible. */
-    uint16_t period_ms = (uint16_t)((uint16_t)frame[2] << 8) | frame[3];
-    if (period_ms < 50u || period_ms > 5000u)
-        return false;
-
+    /* Best-effort: the ISR only publishes plausible periods (50..5000 ms). */
     uint16_t wheel_mm = motor_cmd_effective_wheel_mm();
-    uint16_t speed_dmph = motor_cmd_speed_dmph_from_period_ms(period_ms, wheel_mm);
+    uint16_t speed_dmph = motor_cmd_speed_dmph_from_period_ms(st->speed_raw, wheel_mm);
     g_motor.speed_dmph = speed_dmph;
     g_motor.last_ms = now_ms;
     g_inputs.speed_dmph = speed_dmph;
     g_inputs.brake = 0u;
     g_inputs.last_ms = now_ms;
-    return true;
 }
 
 /*
@@ -560,6 +547,7 @@ static uint16_t motor_cmd_effective_wheel_mm(void)
 static void motor_cmd_record_parse_error(void)
 {
     g_motor_cmd.stats.parse_errors++;
+    motor_health_on_parse_error();
 }
 
 static uint16_t motor_cmd_status_speed_dmph(uint8_t opcode, motor_proto_t proto)
@@ -601,78 +589,57 @@ static bool motor_cmd_battery_low_flag(void)
     return (battery_soc_pct_from_mv(batt_mv, shengyi_nominal_v()) == 0u);
 }
 
-static bool motor_cmd_handle_status_0x52(const uint8_t *frame, uint8_t len, uint32_t now_ms)
+static void motor_cmd_apply_status_0x52(const motor_isr_status_t *st, uint32_t now_ms)
 {
-    if (!frame || len < 13)
-        return false;
-    if (frame[0] != SHENGYI_FRAME_START || frame[2] != SHENGYI_OPCODE_STATUS)
-        return false;
-    uint8_t payload_len = frame[3];
-    if (payload_len < 5 || (uint8_t)(payload_len + 8u) > len)
-        return false;
-    const uint8_t *p = &frame[4];
-
-    uint8_t b0 = p[0];
-    uint8_t b1 = p[1];
-    uint16_t speed_raw = (uint16_t)((uint16_t)p[2] << 8) | p[3];
-    uint8_t err_raw = p[4];
-    uint8_t err = err_raw;
-    if (err_raw != 0u && (err_raw < 33u || err_raw > 38u))
-    {
-        /* Preserve the presence of an unknown controller fault code. */
-        err = 0xFFu;
-    }
-
     /* Battery voltage: low 6 bits are in volts.
      * OEM v2.5.1 also measures battery via ADC (PA0/ADC1). Prefer ADC when
      * it is active to avoid clobbering higher-resolution readings. */
-    uint16_t batt_dV_status = (uint16_t)((b0 & 0x3Fu) * 10u);
     bool adc_ok = battery_monitor_has_sample();
     uint32_t adc_age = adc_ok ? (uint32_t)(now_ms - battery_monitor_last_update_ms()) : 0xFFFFFFFFu;
-    if (!adc_ok || adc_age > MOTOR_CMD_STALE_STATUS_AGE_MS)
+    bool use_status_v = !adc_ok || adc_age > MOTOR_CMD_STALE_STATUS_AGE_MS;
+    if (use_status_v)
     {
-        g_inputs.battery_dV = (int16_t)batt_dV_status;
+        g_inputs.battery_dV = st->batt_dV;
         g_input_caps |= INPUT_CAP_BATT_V;
     }
 
     /* Brake flag (OEM-aligned): byte0 bit6. */
-    g_inputs.brake = bool_to_u8(b0 & 0x40u);
+    g_inputs.brake = bool_to_u8(st->flags & MOTOR_ISR_STATUS_F_BRAKE);
 
     /* Battery current: raw / 3 * 1000 mA */
-    g_inputs.battery_dA = motor_cmd_current_dA_from_raw(b1);
+    g_inputs.battery_dA = st->current_dA;
     g_input_caps |= INPUT_CAP_BATT_I;
 
     /* Speed */
     uint16_t wheel_mm = motor_cmd_effective_wheel_mm();
-    g_inputs.speed_dmph = motor_cmd_speed_dmph_from_raw(speed_raw, wheel_mm);
+    g_inputs.speed_dmph = motor_cmd_speed_dmph_from_raw(st->speed_raw, wheel_mm);
     g_inputs.last_ms = now_ms;
     speed_rb_push(g_inputs.speed_dmph);
     shengyi_speed_update_target(g_inputs.speed_dmph);
 
     g_motor.speed_dmph = g_inputs.speed_dmph;
     uint32_t batt_mv = (uint32_t)((g_inputs.battery_dV > 0) ? g_inputs.battery_dV : 0) * 100u; /* 0.1V -> mV */
-    g_motor.soc_pct = battery_soc_pct_from_mv(batt_mv, shengyi_nominal_v());
-    g_motor.err = err;
+    /* The ADC feeds the estimator itself; the status volts stand in for it. */
+    if (use_status_v)
+        battery_est_update(now_ms, batt_mv, g_inputs.battery_dA, 1u);
+    g_motor.soc_pct = battery_est_soc_pct();
+    g_motor.err = st->err;
     g_motor.last_ms = now_ms;
-    return true;
 }
 
 static uint16_t motor_cmd_speed_dmph_from_raw(uint16_t speed_raw, uint16_t wheel_mm)
 {
-    if (speed_raw == 0 || wheel_mm == 0)
-        return 0;
-    uint32_t kph_x10 = ((uint32_t)wheel_mm * 36u + (speed_raw / 2u)) / speed_raw;
-    uint32_t dmph = (kph_x10 * 62137u + 50000u) / 100000u;
-    if (dmph > 9999u)
-        dmph = 9999u;
-    return (uint16_t)dmph;
+    /* Shengyi speed word is also a wheel period in ms. */
+    speed_conv_set_wheel(&g_motor_cmd.speed_conv, wheel_mm);
+    uint16_t dmph = speed_conv_dmph(&g_motor_cmd.speed_conv, speed_raw);
+    return (dmph > 9999u) ? 9999u : dmph;
 }
 
-static int16_t motor_cmd_current_dA_from_raw(uint8_t current_raw)
+static uint16_t motor_cmd_track_display_speed(uint16_t speed_dmph, uint32_t now_ms)
 {
-    uint32_t ma = ((uint32_t)current_raw * 1000u + 1u) / 3u;
-    uint32_t dA = (ma + 50u) / 100u;
-    if (dA > 32767u)
-        dA = 32767u;
-    return (int16_t)dA;
+    uint32_t dt = (uint32_t)(now_ms - g_motor_cmd.speed_track_ms);
+    g_motor_cmd.speed_track_ms = now_ms;
+    if (dt >= MOTOR_CMD_SPEED_TRACK_GAP_MS)
+        speed_ab_reset(&g_motor_cmd.speed_track);
+    return speed_ab_update(&g_motor_cmd.speed_track, speed_dmph, speed_filter_rate_for_interval_ms(dt));
 }
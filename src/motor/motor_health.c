@@ -0,0 +1,145 @@
+/*
+ * Motor Link Health Metrics Implementation
+ */
+
+#include "motor_health.h"
+
+#include <string.h>
+
+/* EVT_MOTOR_ERROR codes posted by motor_isr's decoder lanes. */
+#define MOTOR_HEALTH_ERR_CHECKSUM 0x02u
+#define MOTOR_HEALTH_ERR_FRAMING  0xFEu
+
+static motor_health_t g_motor_health;
+
+void motor_health_reset(void)
+{
+    memset(&g_motor_health, 0, sizeof(g_motor_health));
+}
+
+const motor_health_t *motor_health_get(void)
+{
+    return &g_motor_health;
+}
+
+static uint8_t motor_health_jitter_bucket(uint32_t jitter_ms)
+{
+    uint8_t b = 0u;
+    while (jitter_ms && b < MOTOR_HEALTH_JITTER_BUCKETS - 1u)
+    {
+        jitter_ms >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static motor_health_op_t *motor_health_slot(uint8_t proto, uint8_t op)
+{
+    motor_health_t *h = &g_motor_health;
+    for (uint8_t i = 0; i < h->op_count; ++i)
+    {
+        if (h->ops[i].proto == proto && h->ops[i].op == op)
+            return &h->ops[i];
+    }
+    if (h->op_count >= MOTOR_HEALTH_OP_SLOTS)
+        return NULL;
+    motor_health_op_t *s = &h->ops[h->op_count++];
+    s->proto = proto;
+    s->op = op;
+    return s;
+}
+
+static void motor_health_link_up(uint32_t now_ms)
+{
+    motor_health_t *h = &g_motor_health;
+    if (!h->link_down)
+        return;
+    uint32_t d = now_ms - h->last_frame_ms;
+    h->link_down = 0u;
+    h->outage_last_ms = d;
+    if (d > h->outage_max_ms)
+        h->outage_max_ms = d;
+    h->outage_total_ms += d;
+}
+
+void motor_health_on_frame(uint8_t proto, uint8_t op, uint32_t now_ms)
+{
+    motor_health_t *h = &g_motor_health;
+    motor_health_link_up(now_ms);
+    h->last_frame_ms = now_ms;
+
+    motor_health_op_t *s = motor_health_slot(proto, op);
+    if (!s)
+    {
+        h->untracked_frames++;
+        return;
+    }
+
+    if (s->frames)
+    {
+        uint32_t interval = now_ms - s->last_ms;
+        if (interval > 0xFFFFu)
+            interval = 0xFFFFu;
+        if (s->interval_avg_ms == 0u)
+        {
+            s->interval_avg_ms = (uint16_t)(interval ? interval : 1u);
+        }
+        else
+        {
+            uint32_t avg = s->interval_avg_ms;
+            uint32_t jitter = (interval > avg) ? (interval - avg) : (avg - interval);
+            uint8_t b = motor_health_jitter_bucket(jitter);
+            if (s->jitter_hist[b] != 0xFFFFu)
+                s->jitter_hist[b]++;
+            avg = (avg * 7u + interval + 4u) / 8u;
+            s->interval_avg_ms = (uint16_t)(avg ? avg : 1u);
+        }
+    }
+    s->frames++;
+    s->last_ms = now_ms;
+}
+
+void motor_health_on_error(uint8_t code, uint32_t now_ms)
+{
+    (void)now_ms;
+    if (code == MOTOR_HEALTH_ERR_CHECKSUM)
+        g_motor_health.crc_errors++;
+    else if (code == MOTOR_HEALTH_ERR_FRAMING)
+        g_motor_health.framing_errors++;
+    else
+        g_motor_health.other_errors++;
+}
+
+void motor_health_on_timeout(uint32_t now_ms)
+{
+    motor_health_t *h = &g_motor_health;
+    h->timeouts++;
+    /* Outages are measured from the last good frame, so a link that never
+     * came up is not counted as down. */
+    if (!h->link_down && h->op_count != 0u &&
+        (uint32_t)(now_ms - h->last_frame_ms) >= MOTOR_HEALTH_LINK_DOWN_MS)
+    {
+        h->link_down = 1u;
+        if (h->outages != 0xFFFFu)
+            h->outages++;
+    }
+}
+
+void motor_health_on_parse_error(void)
+{
+    g_motor_health.parse_errors++;
+}
+
+uint16_t motor_health_rate_x10(const motor_health_op_t *op)
+{
+    if (!op || op->interval_avg_ms == 0u)
+        return 0u;
+    return (uint16_t)((10000u + op->interval_avg_ms / 2u) / op->interval_avg_ms);
+}
+
+uint32_t motor_health_down_ms(uint32_t now_ms)
+{
+    if (!g_motor_health.link_down)
+        return 0u;
+    return now_ms - g_motor_health.last_frame_ms;
+}
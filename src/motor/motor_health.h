@@ -0,0 +1,69 @@
+/*
+ * Motor Link Health Metrics
+ *
+ * Main loop side. Fed from motor_cmd_process() with every EVT_MOTOR_* event,
+ * so it sees exactly what the ISR decoded:
+ *   - per (proto, opcode) RX count, rate and frame-interval jitter histogram
+ *   - error taxonomy: checksum, framing, timeout, field-level parse failures
+ *   - link-down episodes (no decoded frame for MOTOR_HEALTH_LINK_DOWN_MS)
+ *
+ * A slowly rising checksum/framing count with a healthy frame rate is the
+ * signature of a marginal harness connector; outages are the late stage.
+ */
+
+#ifndef MOTOR_HEALTH_H
+#define MOTOR_HEALTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MOTOR_HEALTH_OP_SLOTS        6u
+/* |interval - mean interval| in ms: <1, 1, 2-3, 4-7, 8-15, 16-31, 32-63, >=64. */
+#define MOTOR_HEALTH_JITTER_BUCKETS  8u
+/* Matches motor_cmd_is_alive(). */
+#define MOTOR_HEALTH_LINK_DOWN_MS    500u
+
+typedef struct {
+    uint8_t proto;                   /* motor_proto_t */
+    uint8_t op;
+    uint32_t frames;
+    uint32_t last_ms;
+    uint16_t interval_avg_ms;        /* EWMA, 1/8 weight; 0 until two frames */
+    uint16_t jitter_hist[MOTOR_HEALTH_JITTER_BUCKETS];
+} motor_health_op_t;
+
+typedef struct {
+    motor_health_op_t ops[MOTOR_HEALTH_OP_SLOTS];
+    uint8_t op_count;
+    uint32_t untracked_frames;       /* (proto, op) pairs beyond the slot table */
+
+    uint32_t crc_errors;             /* decoder checksum mismatch */
+    uint32_t framing_errors;         /* impossible length field */
+    uint32_t other_errors;           /* remaining EVT_MOTOR_ERROR codes */
+    uint32_t timeouts;               /* no reply within MOTOR_RX_TIMEOUT_MS */
+    uint32_t parse_errors;           /* frame decoded but fields rejected */
+
+    uint8_t link_down;
+    uint32_t last_frame_ms;
+    uint16_t outages;
+    uint32_t outage_last_ms;
+    uint32_t outage_max_ms;
+    uint32_t outage_total_ms;
+} motor_health_t;
+
+void motor_health_reset(void);
+
+void motor_health_on_frame(uint8_t proto, uint8_t op, uint32_t now_ms);
+void motor_health_on_error(uint8_t code, uint32_t now_ms);
+void motor_health_on_timeout(uint32_t now_ms);
+void motor_health_on_parse_error(void);
+
+const motor_health_t *motor_health_get(void);
+
+/* Frames per second x10 from a slot's mean interval (0 if unknown). */
+uint16_t motor_health_rate_x10(const motor_health_op_t *op);
+
+/* Length of the current outage, 0 while the link is up. */
+uint32_t motor_health_down_ms(uint32_t now_ms);
+
+#endif /* MOTOR_HEALTH_H */
@@ -7,29 +7,52 @@
 
 #include "motor_isr.h"
 #include "shengyi.h"
+#include "motor_stx02.h"
 #include "../kernel/event.h"
+#include "../kernel/flight_rec.h"
 #include "../util/bool_to_u8.h"
+#include "../../platform/ram.h"
 
 #ifndef HOST_TEST
 #include "../../drivers/uart.h"
 #include "../../platform/hw.h"
 #include "../../platform/mmio.h"
+#include "../../platform/uart_rx_dma.h"
+#include "../../platform/uart_tx_dma.h"
+#include "../../platform/time.h"
+#include "../bus/bus.h"
 #define MEMORY_BARRIER() mmio_dmb()
+#define MOTOR_ISR_SESSION_RX(data, len) bus_session_rx(BUS_MOTOR, (data), (uint16_t)(len))
 #else
 #define MEMORY_BARRIER() __asm__ volatile("" ::: "memory")
+#define MOTOR_ISR_SESSION_RX(data, len) ((void)(data), (void)(len))
 /* Host test stubs */
-static int uart_rx_available(uint32_t base) { (void)base; return 0; }
-static uint8_t uart_getc(uint32_t base) { (void)base; return 0; }
+static size_t uart_read(uint32_t base, uint8_t *buf, size_t max) { (void)base; (void)buf; (void)max; return 0; }
 static int uart_tx_ready(uint32_t base) { (void)base; return 1; }
 static void uart_putc(uint32_t base, uint8_t c) { (void)base; (void)c; }
+static uint8_t platform_uart2_rx_dma_active(void) { return 0u; }
+static uint8_t platform_uart2_tx_dma_active(void) { return 0u; }
+static uint8_t platform_uart2_tx_dma_start(const uint8_t *d, uint16_t n) { (void)d; (void)n; return 0u; }
+static uint32_t platform_cycles_now(void) { return 0u; }
+static uint32_t platform_cycles_to_us(uint32_t cycles) { return cycles; }
 #define UART2_BASE 0x40004400u
 #endif
 
-/* Bounded TX readiness wait in ISR context. */
+/* Bounded TX readiness wait in ISR context (polled fallback only). */
 #define MOTOR_ISR_TX_READY_SPINS 128u
+/* TX frame ring; power of two. */
+#define MOTOR_ISR_TXQ_DEPTH 8u
 #define MOTOR_ISR_V2_CHECKSUM_BIAS 32u
+/* 8N1: ten bit times per byte. */
+#define MOTOR_ISR_BITS_PER_BYTE 10u
+#define MOTOR_ISR_DEFAULT_BAUD 9600u
 
-/* Opportunistic V2 frame sizes observed on some controller variants. */
+/* Status opcodes outside the Shengyi header. */
+#define MOTOR_ISR_STX02_STATUS_OP 0x01u
+#define MOTOR_ISR_AUTH_STATUS_OP 0x46u
+#define MOTOR_ISR_V2_STATUS_LEN 5u
+
+/* V2 frame sizes observed on some controller variants. */
 #define MOTOR_ISR_V2_HEURISTIC_MIN_LEN 3u
 #define MOTOR_ISR_V2_HEURISTIC_MAX_LEN 5u
 
@@ -39,40 +62,86 @@ static void uart_putc(uint32_t base, uint8_t c) { (void)base; (void)c; }
 /* sizes come from shengyi.h */
 
 /*
- * RX state machine states (per-protocol).
+ * Framed RX decoders. Each OEM framing is one row of k_motor_rx_lanes and all
+ * rows see every byte in parallel. Per-byte work is constant: lengths come from
+ * the header or a terminator, checksums are accumulated as bytes arrive, and a
+ * failed frame simply drops the lane back to SOF hunting (no buffer rescans).
+ * Supporting another controller variant means adding a row.
  */
 typedef enum {
-    RX_WAIT_START = 0,      /* Waiting for SOF */
-    RX_WAIT_SECOND,         /* Shengyi: got 0x3A, waiting for next header byte */
-    RX_WAIT_OPCODE,         /* Shengyi: got header, waiting for opcode */
-    RX_WAIT_LEN,            /* Shengyi: got opcode, waiting for length */
-    RX_READ_PAYLOAD,        /* Shengyi: reading rest of frame */
-} rx_state_t;
+    MOTOR_RX_LEN_FIELD = 0,     /* total = buf[len_pos] + len_add */
+    MOTOR_RX_LEN_TERM,          /* ends on the term byte once min_total is reached */
+} motor_rx_len_kind_t;
 
 typedef enum {
-    RX02_WAIT_SOF = 0,      /* Waiting for 0x02 */
-    RX02_WAIT_LEN,          /* Waiting for length byte */
-    RX02_READ,              /* Reading until expected total length */
-} rx02_state_t;
+    MOTOR_RX_CKS_SUM16_LE = 0,  /* sum of [1, total-4) == LE16 at total-4 */
+    MOTOR_RX_CKS_XOR_ALL,       /* xor of every byte (incl. checksum) == 0 */
+    MOTOR_RX_CKS_XOR_FROM1,     /* xor of [1, term) == 0 (checksum sits before term) */
+} motor_rx_cks_kind_t;
+
+/* Lane drives MOTOR_ISR_STATE_RX_ACTIVE and reports parse errors. */
+#define MOTOR_RX_F_PRIMARY 0x01u
+
+typedef struct {
+    motor_proto_t proto;
+    uint8_t sof[2];             /* accepted first bytes */
+    uint8_t len_kind;           /* motor_rx_len_kind_t */
+    uint8_t len_pos;
+    uint8_t len_add;
+    uint8_t min_total;
+    uint8_t max_total;          /* also the lane buffer size */
+    uint8_t term;
+    uint8_t cks_kind;           /* motor_rx_cks_kind_t */
+    uint8_t op_pos;
+    uint8_t flags;
+    uint8_t *buf;
+} motor_rx_lane_desc_t;
+
+typedef struct {
+    uint8_t len;                /* 0 = hunting for SOF */
+    uint8_t expected;           /* total length, 0 until known */
+    uint8_t x8;
+    uint16_t sum16;
+} motor_rx_lane_t;
+
+enum {
+    MOTOR_RX_LANE_AUTH = 0,
+    MOTOR_RX_LANE_STX02,
+    MOTOR_RX_LANE_SHENGYI,
+    MOTOR_RX_LANE_COUNT,
+};
+
+#define MOTOR_RX_STX02_MAX 64u
+#define MOTOR_RX_AUTH_MAX 32u
 
 /*
  * Module state
  */
 static struct {
-    event_queue_t *evt_queue;       /* Output event queue */
+    event_bus_t *evt_bus;           /* Output bus (EVENT_LANE_MOTOR) */
     motor_isr_state_t state;        /* Protocol state */
-    rx_state_t rx_state;            /* RX parser state */
 
-    /* TX command buffer (tx_pending shared: main writes, ISR reads) */
-    uint8_t tx_cmd[MOTOR_ISR_TX_MAX]; /* Queued command frame (raw bytes) */
-    uint8_t tx_len;                 /* Command frame length */
-    volatile uint8_t tx_pending;    /* Command ready to send */
+    /* TX frame ring (main writes slots + tx_head, ISR sends + advances tx_tail) */
+    struct {
+        uint8_t buf[MOTOR_ISR_TX_MAX];
+        uint8_t len;
+        uint8_t v2_expect_len;      /* arm v2 capture when this frame goes out */
+        uint16_t v2_msg_id;
+    } txq[MOTOR_ISR_TXQ_DEPTH];
+    volatile uint8_t tx_head;
+    volatile uint8_t tx_tail;
+    volatile uint8_t tx_inflight;   /* txq[tx_tail] owned by the DMA */
+    uint8_t tx_stage_len;           /* staged by motor_isr_v2_expect() */
+    uint16_t tx_stage_msg_id;
     uint32_t tx_last_ms;            /* Last TX timestamp */
+    uint8_t cmd_frame[14];          /* last 0x52 request (main loop only; builder wants 14) */
+    uint8_t cmd_frame_len;
 
-    /* RX frame buffer */
+    /* RX decoder lanes and their frame buffers */
+    motor_rx_lane_t rx_lanes[MOTOR_RX_LANE_COUNT];
     uint8_t rx_buf[SHENGYI_MAX_FRAME_SIZE];
-    uint8_t rx_len;                 /* Current RX length */
-    uint8_t rx_expected;            /* Expected total length */
+    uint8_t rx02_buf[MOTOR_RX_STX02_MAX];
+    uint8_t rx_auth_buf[MOTOR_RX_AUTH_MAX];
 
     /* Last valid frame snapshot (ISR writes, main reads via copy_last_frame) */
     volatile uint8_t last_frame[SHENGYI_MAX_FRAME_SIZE];
@@ -82,25 +151,15 @@ static struct {
     volatile motor_proto_t last_proto;
     volatile uint16_t last_aux16;   /* protocol-specific (e.g., msg_id) */
 
+    /* Decoded status (ISR writes, main reads via motor_isr_read_status) */
+    volatile motor_isr_status_t status;
+
     /* Timing */
     uint32_t rx_start_ms;           /* RX frame start time */
     uint32_t last_valid_rx_ms;      /* Last successful RX */
     uint8_t first_rx_seen;          /* Motor ready flag */
 
-    /* Additional protocol parsers (OEM variants). */
-    struct {
-        rx02_state_t st;
-        uint8_t buf[64];
-        uint8_t len;
-        uint8_t expected;
-    } rx02;
-
-    struct {
-        uint8_t active;
-        uint8_t buf[32];
-        uint8_t len;
-    } rx_auth;
-
+    /* V2 capture: armed request/response buffer, else a 3-byte window. */
     struct {
         uint8_t buf[5];
         uint8_t pos;
@@ -109,34 +168,76 @@ static struct {
         uint16_t msg_id;
     } rx_v2;
 
+    /* Frame trace ring (ISR writes trace_head, main advances trace_tail) */
+    motor_isr_trace_t trace[MOTOR_ISR_TRACE_DEPTH];
+    volatile uint8_t trace_head;
+    volatile uint8_t trace_tail;
+
+    /* Cycle stamps for link timing */
+    uint32_t tx_start_cyc;
+    uint32_t tx_done_cyc;
+    uint32_t last_rx_cyc;
+    uint8_t rsp_pending;            /* reply to the last TX not decoded yet */
+    uint8_t tx_done_valid;
+    uint8_t last_rx_valid;
+    uint32_t us_per_byte;
+    uint32_t status_cyc;            /* last status frame published */
+
+    /* Posted to the work queue after each status frame's event */
+    work_fn status_hook;
+
     /* Statistics */
     motor_isr_stats_t stats;
 } g_motor_isr;
 
+/*
+ * OEM variants observed in v2.5.1 (the v2 short frames are handled separately
+ * because their length is set by the last request, not the frame):
+ * - 0x3A ... sum16 ... CRLF (Shengyi / "tongsheng" misnomer in IDA)
+ * - 0x02 len ... xor (packetized, cmd in byte2, xor covers all but last)
+ * - 0x46/0x53 ... xor ... CR (auth-like, xor excludes first byte)
+ */
+static const motor_rx_lane_desc_t k_motor_rx_lanes[MOTOR_RX_LANE_COUNT] = {
+    [MOTOR_RX_LANE_AUTH] = {
+        .proto = MOTOR_PROTO_AUTH_XOR_CR, .sof = { 0x46u, 0x53u },
+        .len_kind = MOTOR_RX_LEN_TERM, .term = 0x0Du,
+        .min_total = 4u, .max_total = MOTOR_RX_AUTH_MAX,
+        .cks_kind = MOTOR_RX_CKS_XOR_FROM1, .op_pos = 0u,
+        .buf = g_motor_isr.rx_auth_buf,
+    },
+    [MOTOR_RX_LANE_STX02] = {
+        .proto = MOTOR_PROTO_STX02_XOR, .sof = { 0x02u, 0x02u },
+        .len_kind = MOTOR_RX_LEN_FIELD, .len_pos = 1u, .len_add = 0u,
+        .min_total = 4u, .max_total = MOTOR_RX_STX02_MAX,
+        .cks_kind = MOTOR_RX_CKS_XOR_ALL, .op_pos = 2u,
+        .buf = g_motor_isr.rx02_buf,
+    },
+    [MOTOR_RX_LANE_SHENGYI] = {
+        .proto = MOTOR_PROTO_SHENGYI_3A1A, .sof = { SHENGYI_FRAME_START, SHENGYI_FRAME_START },
+        .len_kind = MOTOR_RX_LEN_FIELD, .len_pos = 3u, .len_add = 8u,
+        .min_total = 8u, .max_total = SHENGYI_MAX_FRAME_SIZE,
+        .cks_kind = MOTOR_RX_CKS_SUM16_LE, .op_pos = 2u,
+        .flags = MOTOR_RX_F_PRIMARY,
+        .buf = g_motor_isr.rx_buf,
+    },
+};
+
 /*
  * Forward declarations
  */
-static void motor_isr_process_rx_byte(uint8_t byte, uint32_t now_ms);
-static void motor_isr_process_frame(uint32_t now_ms);
-static void motor_isr_send_tx_cmd(void);
+static RAMFUNC void motor_isr_process_rx_byte(uint8_t byte, uint32_t now_ms);
+static void motor_isr_tx_kick(uint32_t now_ms);
 static void motor_isr_post_event(uint8_t type, uint16_t payload, uint32_t timestamp);
-static bool motor_isr_v2_checksum_ok(const uint8_t *frame, uint8_t len);
-static void motor_isr_v2_heuristic_capture(uint8_t byte, uint32_t now_ms);
+static RAMFUNC bool motor_isr_v2_checksum_ok(const uint8_t *frame, uint8_t len);
+static RAMFUNC void motor_isr_v2_heuristic_capture(uint8_t byte, uint32_t now_ms);
 static bool motor_isr_tx_ready_wait(void);
 
-static void motor_isr_rx02_reset(void)
+static void motor_isr_lane_reset(motor_rx_lane_t *ln)
 {
-    g_motor_isr.rx02.st = RX02_WAIT_SOF;
-    g_motor_isr.rx02.len = 0u;
-    g_motor_isr.rx02.expected = 0u;
-}
-
-static uint8_t motor_isr_xor8(const uint8_t *p, uint8_t n)
-{
-    uint8_t x = 0u;
-    for (uint8_t i = 0; i < n; ++i)
-        x ^= p[i];
-    return x;
+    ln->len = 0u;
+    ln->expected = 0u;
+    ln->x8 = 0u;
+    ln->sum16 = 0u;
 }
 
 static void motor_isr_v2_reset(void)
@@ -147,6 +248,177 @@ static void motor_isr_v2_reset(void)
     g_motor_isr.rx_v2.msg_id = 0u;
 }
 
+static void motor_isr_timing_add(motor_isr_timing_t *t, uint32_t us)
+{
+    t->last_us = us;
+    if (us > t->max_us)
+        t->max_us = us;
+    if (t->avg_us == 0u)
+        t->avg_us = us;
+    else
+        t->avg_us = (uint32_t)(((uint64_t)t->avg_us * 7u + us) >> 3);
+}
+
+static void motor_isr_trace_push(uint8_t dir, uint8_t proto, const uint8_t *frame,
+                                 uint8_t len, uint8_t op, uint32_t t_cycles, uint32_t dt_us)
+{
+    uint8_t head = g_motor_isr.trace_head;
+    if ((uint8_t)(head - g_motor_isr.trace_tail) >= MOTOR_ISR_TRACE_DEPTH)
+    {
+        g_motor_isr.stats.trace_dropped++;
+        return;
+    }
+
+    motor_isr_trace_t *e = &g_motor_isr.trace[head & (MOTOR_ISR_TRACE_DEPTH - 1u)];
+    e->t_cycles = t_cycles;
+    e->dt_us = dt_us;
+    e->dir = dir;
+    e->proto = proto;
+    e->len = len;
+    e->op = op;
+    uint8_t n = (len < MOTOR_ISR_TRACE_BYTES) ? len : MOTOR_ISR_TRACE_BYTES;
+    for (uint8_t i = 0; i < n; ++i)
+        e->bytes[i] = frame[i];
+    MEMORY_BARRIER(); /* publish entry before head */
+    g_motor_isr.trace_head = (uint8_t)(head + 1u);
+}
+
+/* Unarmed v2 captures are pattern matches on raw bytes (roughly 1 in 128 random
+ * triples pass), so they are traced but never counted as link evidence. */
+static bool motor_isr_capture_is_heuristic(motor_proto_t proto)
+{
+    return proto == MOTOR_PROTO_V2_FIXED && !g_motor_isr.rx_v2.active;
+}
+
+static void motor_isr_rx_timing(motor_proto_t proto, const uint8_t *frame, uint8_t len, uint8_t op)
+{
+    uint32_t now = platform_cycles_now();
+    uint32_t since_tx_us = 0u;
+    if (g_motor_isr.tx_done_valid)
+        since_tx_us = platform_cycles_to_us(now - g_motor_isr.tx_done_cyc);
+    motor_isr_trace_push(MOTOR_ISR_TRACE_RX, (uint8_t)proto, frame, len, op, now, since_tx_us);
+
+    if (motor_isr_capture_is_heuristic(proto))
+        return;
+
+    if (g_motor_isr.last_rx_valid)
+        motor_isr_timing_add(&g_motor_isr.stats.rx_gap,
+                             platform_cycles_to_us(now - g_motor_isr.last_rx_cyc));
+    g_motor_isr.last_rx_cyc = now;
+    g_motor_isr.last_rx_valid = 1u;
+
+    if (!g_motor_isr.rsp_pending)
+        return;
+    g_motor_isr.rsp_pending = 0u;
+    motor_isr_timing_add(&g_motor_isr.stats.rsp_latency,
+                         platform_cycles_to_us(now - g_motor_isr.tx_start_cyc));
+    if (g_motor_isr.tx_done_valid)
+    {
+        uint32_t air_us = (uint32_t)len * g_motor_isr.us_per_byte;
+        motor_isr_timing_add(&g_motor_isr.stats.turnaround,
+                             (since_tx_us > air_us) ? (since_tx_us - air_us) : 0u);
+    }
+}
+
+bool motor_isr_is_status_frame(motor_proto_t proto, uint8_t op)
+{
+    switch (proto)
+    {
+        case MOTOR_PROTO_SHENGYI_3A1A: return op == SHENGYI_OPCODE_STATUS;
+        case MOTOR_PROTO_STX02_XOR:    return op == MOTOR_ISR_STX02_STATUS_OP;
+        case MOTOR_PROTO_AUTH_XOR_CR:  return op == MOTOR_ISR_AUTH_STATUS_OP;
+        case MOTOR_PROTO_V2_FIXED:     return true;
+        default:                       return false;
+    }
+}
+
+/* Shengyi/AUTH current byte: raw / 3 A in deci-amps, rounded as
+ * ((raw * 1000 + 1) / 3 + 50) / 100 mA. (raw * 853 + 170) >> 8 matches that
+ * for every byte value without a divide. */
+static inline int16_t motor_isr_current_dA_from_raw(uint8_t current_raw)
+{
+    return (int16_t)(((uint32_t)current_raw * 853u + 170u) >> 8);
+}
+
+bool motor_isr_decode_status(motor_proto_t proto, const uint8_t *frame, uint8_t len,
+                             motor_isr_status_t *st)
+{
+    switch (proto)
+    {
+        case MOTOR_PROTO_SHENGYI_3A1A:
+        {
+            if (len < 13u)
+                return false;
+            uint8_t payload_len = frame[3];
+            if (payload_len < 5u || (uint8_t)(payload_len + 8u) > len)
+                return false;
+            /* payload: [0] brake<<6 | volts, [1] current, [2..3] speed BE, [4] err */
+            const uint8_t *p = &frame[4];
+            uint8_t err_raw = p[4];
+            /* Known faults are 33..38; keep the presence of any other code. */
+            st->err = (err_raw != 0u && (uint8_t)(err_raw - 33u) > 5u) ? 0xFFu : err_raw;
+            st->batt_dV = (int16_t)((p[0] & 0x3Fu) * 10u);
+            st->flags = (uint8_t)((p[0] >> 6) & MOTOR_ISR_STATUS_F_BRAKE);
+            st->current_dA = motor_isr_current_dA_from_raw(p[1]);
+            st->speed_raw = (uint16_t)((uint16_t)p[2] << 8) | p[3];
+            return true;
+        }
+        case MOTOR_PROTO_STX02_XOR:
+        {
+            motor_stx02_cmd1_t c;
+            if (!motor_stx02_decode_cmd1(frame, len, &c))
+                return false;
+            st->err = c.err_code;
+            st->current_dA = c.current_dA;
+            st->speed_raw = c.period_ms;
+            st->soc_pct = c.soc_pct;
+            if (c.soc_valid)
+                st->flags |= MOTOR_ISR_STATUS_F_SOC;
+            return true;
+        }
+        case MOTOR_PROTO_AUTH_XOR_CR:
+        {
+            /* OEM `APP_process_battery_status_packet` consumes 6 bytes after the SOF. */
+            if (len < (uint8_t)(1u + 6u + 2u) || frame[0] != MOTOR_ISR_AUTH_STATUS_OP)
+                return false;
+            const uint8_t *p = &frame[1];
+            uint8_t soc_pct = (uint8_t)(p[0] * 20u);
+            st->soc_pct = (soc_pct > 100u) ? 100u : soc_pct;
+            st->flags |= MOTOR_ISR_STATUS_F_SOC;
+            /* (byte/3.0)*1000 mA in deci-amps: byte*10/3, same rounding as Shengyi. */
+            st->current_dA = motor_isr_current_dA_from_raw(p[1]);
+            st->speed_raw = (uint16_t)((uint16_t)p[2] << 8) | p[3];
+            return true;
+        }
+        case MOTOR_PROTO_V2_FIXED:
+        {
+            if (len != MOTOR_ISR_V2_STATUS_LEN)
+                return false;
+            /* Best-effort: bytes 2/3 as a period ms (big-endian) if plausible. */
+            uint16_t period_ms = (uint16_t)((uint16_t)frame[2] << 8) | frame[3];
+            if (period_ms < 50u || period_ms > 5000u)
+                return false;
+            st->speed_raw = period_ms;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+static void motor_isr_publish_status(motor_proto_t proto, const uint8_t *frame, uint8_t len, uint8_t op)
+{
+    motor_isr_status_t st = {0};
+    st.proto = (uint8_t)proto;
+    st.op = op;
+    st.ok = bool_to_u8(motor_isr_decode_status(proto, frame, len, &st));
+    st.seq = (uint8_t)(g_motor_isr.status.seq + 1u);
+    /* Runs at ISR priority; readers retry on a seq change. */
+    g_motor_isr.status = st;
+    g_motor_isr.status_cyc = platform_cycles_now();
+    flight_rec_log(FLIGHT_MOTOR_RX, op, (uint16_t)(((uint16_t)st.proto << 8) | st.ok));
+}
+
 static void motor_isr_capture_frame(motor_proto_t proto,
                                    const uint8_t *frame,
                                    uint8_t len,
@@ -164,10 +436,15 @@ static void motor_isr_capture_frame(motor_proto_t proto,
     g_motor_isr.last_proto = proto;
     g_motor_isr.last_aux16 = aux16;
     g_motor_isr.last_seq++;
+    if (motor_isr_is_status_frame(proto, op))
+        motor_isr_publish_status(proto, frame, len, op);
 
     g_motor_isr.stats.rx_count++;
+    if ((uint8_t)proto < MOTOR_PROTO_COUNT && !motor_isr_capture_is_heuristic(proto))
+        g_motor_isr.stats.rx_by_proto[proto]++;
     g_motor_isr.last_valid_rx_ms = now_ms;
     g_motor_isr.stats.last_rx_ms = now_ms;
+    motor_isr_rx_timing(proto, frame, len, op);
     g_motor_isr.state = MOTOR_ISR_STATE_IDLE;
 
     if (!g_motor_isr.first_rx_seen)
@@ -179,9 +456,14 @@ static void motor_isr_capture_frame(motor_proto_t proto,
     /* Post frame event; payload: (proto<<8) | op */
     uint16_t payload = (uint16_t)op | ((uint16_t)proto << 8);
     motor_isr_post_event(EVT_MOTOR_STATE, payload, now_ms);
+
+    /* The event is queued first so the hook finds it on the lane. A full
+     * work queue is not retried; the periodic motor task catches up. */
+    if (g_motor_isr.status_hook && motor_isr_is_status_frame(proto, op))
+        (void)work_queue_post(g_motor_isr.status_hook, NULL);
 }
 
-static bool motor_isr_v2_checksum_ok(const uint8_t *frame, uint8_t len)
+static RAMFUNC bool motor_isr_v2_checksum_ok(const uint8_t *frame, uint8_t len)
 {
     if (!frame || len < MOTOR_ISR_V2_HEURISTIC_MIN_LEN || len > MOTOR_ISR_V2_HEURISTIC_MAX_LEN)
         return false;
@@ -197,38 +479,122 @@ static bool motor_isr_v2_checksum_ok(const uint8_t *frame, uint8_t len)
     return false;
 }
 
-static void motor_isr_v2_heuristic_capture(uint8_t byte, uint32_t now_ms)
+static RAMFUNC void motor_isr_v2_heuristic_capture(uint8_t byte, uint32_t now_ms)
 {
-    /* Maintain a small sliding window of the most recent bytes and try each plausible
-     * short-length candidate. This keeps parser behavior tolerant across controller variants. */
-    if (g_motor_isr.rx_v2.pos >= MOTOR_ISR_V2_HEURISTIC_MAX_LEN)
+    /* Every candidate length checks the same trailing (data0, data1, sum) triple,
+     * so the shortest one always wins: only the last three bytes matter. */
+    g_motor_isr.rx_v2.buf[0] = g_motor_isr.rx_v2.buf[1];
+    g_motor_isr.rx_v2.buf[1] = g_motor_isr.rx_v2.buf[2];
+    g_motor_isr.rx_v2.buf[2] = byte;
+    if (g_motor_isr.rx_v2.pos < MOTOR_ISR_V2_HEURISTIC_MIN_LEN)
+        g_motor_isr.rx_v2.pos++;
+    if (g_motor_isr.rx_v2.pos < MOTOR_ISR_V2_HEURISTIC_MIN_LEN)
+        return;
+
+    const uint8_t *frame = g_motor_isr.rx_v2.buf;
+    if (!motor_isr_v2_checksum_ok(frame, MOTOR_ISR_V2_HEURISTIC_MIN_LEN))
+        return;
+
+    uint16_t msg_id = (uint16_t)((uint16_t)frame[0] << 8u) | (uint16_t)frame[1];
+    motor_isr_capture_frame(MOTOR_PROTO_V2_FIXED,
+                            frame,
+                            MOTOR_ISR_V2_HEURISTIC_MIN_LEN,
+                            frame[1],
+                            msg_id,
+                            now_ms);
+    g_motor_isr.rx_v2.pos = 0u;
+}
+
+static void motor_isr_lane_complete(const motor_rx_lane_desc_t *d, motor_rx_lane_t *ln,
+                                    bool ok, uint32_t now_ms)
+{
+    if (ok)
+        motor_isr_capture_frame(d->proto, d->buf, ln->len, d->buf[d->op_pos], 0u, now_ms);
+    else if (d->flags & MOTOR_RX_F_PRIMARY)
     {
-        for (uint8_t i = 1u; i < MOTOR_ISR_V2_HEURISTIC_MAX_LEN; ++i)
-            g_motor_isr.rx_v2.buf[i - 1u] = g_motor_isr.rx_v2.buf[i];
-        g_motor_isr.rx_v2.pos = MOTOR_ISR_V2_HEURISTIC_MAX_LEN - 1u;
+        /* Checksum mismatch */
+        motor_isr_post_event(EVT_MOTOR_ERROR, 0x02, now_ms);
+        g_motor_isr.stats.rx_errors++;
     }
+    motor_isr_lane_reset(ln);
+}
 
-    g_motor_isr.rx_v2.buf[g_motor_isr.rx_v2.pos++] = byte;
+static RAMFUNC void motor_isr_lane_byte(const motor_rx_lane_desc_t *d, motor_rx_lane_t *ln,
+                                        uint8_t byte, uint32_t now_ms)
+{
+    uint8_t i = ln->len;
+    if (i == 0u)
+    {
+        if (byte != d->sof[0] && byte != d->sof[1])
+            return;
+        if (d->flags & MOTOR_RX_F_PRIMARY)
+            g_motor_isr.state = MOTOR_ISR_STATE_RX_ACTIVE;
+    }
+    else if (i >= d->max_total)
+    {
+        /* Unterminated frame filled the buffer; the byte is dropped. */
+        motor_isr_lane_reset(ln);
+        return;
+    }
+
+    d->buf[i] = byte;
+    ln->len = (uint8_t)(i + 1u);
 
-    for (uint8_t len = MOTOR_ISR_V2_HEURISTIC_MIN_LEN; len <= MOTOR_ISR_V2_HEURISTIC_MAX_LEN; ++len)
+    if (d->len_kind == MOTOR_RX_LEN_TERM)
     {
-        if (g_motor_isr.rx_v2.pos < len)
-            continue;
-
-        const uint8_t *frame = &g_motor_isr.rx_v2.buf[g_motor_isr.rx_v2.pos - len];
-        if (!motor_isr_v2_checksum_ok(frame, len))
-            continue;
-
-        uint16_t msg_id = (uint16_t)((uint16_t)frame[0] << 8u) | (uint16_t)frame[1];
-        motor_isr_capture_frame(MOTOR_PROTO_V2_FIXED,
-                                frame,
-                                len,
-                                frame[1],
-                                msg_id,
-                                now_ms);
-        g_motor_isr.rx_v2.pos = 0u;
+        if (i != 0u && byte == d->term && ln->len >= d->min_total)
+        {
+            motor_isr_lane_complete(d, ln, ln->x8 == 0u, now_ms);
+            return;
+        }
+    }
+    else if (i == d->len_pos)
+    {
+        uint16_t total = (uint16_t)byte + d->len_add;
+        if (total < d->min_total || total > d->max_total)
+        {
+            if (d->flags & MOTOR_RX_F_PRIMARY)
+            {
+                motor_isr_post_event(EVT_MOTOR_ERROR, 0xFE, now_ms);
+                g_motor_isr.stats.rx_errors++;
+            }
+            motor_isr_lane_reset(ln);
+            return;
+        }
+        ln->expected = (uint8_t)total;
+    }
+
+    switch (d->cks_kind)
+    {
+        case MOTOR_RX_CKS_SUM16_LE:
+            if (i != 0u && (ln->expected == 0u || (uint16_t)i + 4u < ln->expected))
+                ln->sum16 = (uint16_t)(ln->sum16 + byte);
+            break;
+        case MOTOR_RX_CKS_XOR_ALL:
+            ln->x8 ^= byte;
+            break;
+        case MOTOR_RX_CKS_XOR_FROM1:
+        default:
+            if (i != 0u)
+                ln->x8 ^= byte;
+            break;
+    }
+
+    if (ln->expected == 0u || ln->len < ln->expected)
         return;
+
+    bool ok;
+    if (d->cks_kind == MOTOR_RX_CKS_SUM16_LE)
+    {
+        uint8_t e = ln->expected;
+        uint16_t frame_cks = (uint16_t)d->buf[e - 4u] | ((uint16_t)d->buf[e - 3u] << 8);
+        ok = frame_cks == ln->sum16;
+    }
+    else
+    {
+        ok = ln->x8 == 0u;
     }
+    motor_isr_lane_complete(d, ln, ok, now_ms);
 }
 
 static bool motor_isr_tx_ready_wait(void)
@@ -244,16 +610,16 @@ static bool motor_isr_tx_ready_wait(void)
 /*
  * Initialize motor ISR subsystem
  */
-void motor_isr_init(event_queue_t *evt_queue)
+void motor_isr_init(event_bus_t *evt_bus)
 {
-    g_motor_isr.evt_queue = evt_queue;
+    g_motor_isr.evt_bus = evt_bus;
     g_motor_isr.state = MOTOR_ISR_STATE_IDLE;
-    g_motor_isr.rx_state = RX_WAIT_START;
-    g_motor_isr.tx_len = 0;
-    g_motor_isr.tx_pending = 0;
+    g_motor_isr.tx_head = 0;
+    g_motor_isr.tx_tail = 0;
+    g_motor_isr.tx_inflight = 0;
+    g_motor_isr.tx_stage_len = 0;
+    g_motor_isr.tx_stage_msg_id = 0;
     g_motor_isr.tx_last_ms = 0;
-    g_motor_isr.rx_len = 0;
-    g_motor_isr.rx_expected = 0;
     g_motor_isr.last_len = 0;
     g_motor_isr.last_opcode = 0;
     g_motor_isr.last_seq = 0;
@@ -263,9 +629,8 @@ void motor_isr_init(event_queue_t *evt_queue)
     g_motor_isr.last_valid_rx_ms = 0;
     g_motor_isr.first_rx_seen = 0;
 
-    motor_isr_rx02_reset();
-    g_motor_isr.rx_auth.active = 0u;
-    g_motor_isr.rx_auth.len = 0u;
+    for (uint8_t i = 0; i < MOTOR_RX_LANE_COUNT; ++i)
+        motor_isr_lane_reset(&g_motor_isr.rx_lanes[i]);
     motor_isr_v2_reset();
 
     /* Clear stats */
@@ -275,6 +640,79 @@ void motor_isr_init(event_queue_t *evt_queue)
     g_motor_isr.stats.timeouts = 0;
     g_motor_isr.stats.queue_full = 0;
     g_motor_isr.stats.last_rx_ms = 0;
+    g_motor_isr.stats.tx_dropped = 0;
+    g_motor_isr.stats.trace_dropped = 0;
+    for (uint8_t i = 0; i < MOTOR_PROTO_COUNT; ++i)
+        g_motor_isr.stats.rx_by_proto[i] = 0;
+    g_motor_isr.stats.rsp_latency = (motor_isr_timing_t){0};
+    g_motor_isr.stats.turnaround = (motor_isr_timing_t){0};
+    g_motor_isr.stats.rx_gap = (motor_isr_timing_t){0};
+
+    g_motor_isr.trace_head = 0;
+    g_motor_isr.trace_tail = 0;
+    g_motor_isr.rsp_pending = 0;
+    g_motor_isr.tx_done_valid = 0;
+    g_motor_isr.last_rx_valid = 0;
+    motor_isr_set_baud(MOTOR_ISR_DEFAULT_BAUD);
+}
+
+void motor_isr_set_status_hook(work_fn fn)
+{
+    g_motor_isr.status_hook = fn;
+}
+
+uint32_t motor_isr_status_cycles(void)
+{
+    return g_motor_isr.status_cyc;
+}
+
+void motor_isr_set_baud(uint32_t baud)
+{
+    if (baud == 0u)
+        return;
+    g_motor_isr.us_per_byte = (MOTOR_ISR_BITS_PER_BYTE * 1000000u + baud / 2u) / baud;
+}
+
+bool motor_isr_trace_pop(motor_isr_trace_t *out)
+{
+    uint8_t tail = g_motor_isr.trace_tail;
+    if (tail == g_motor_isr.trace_head)
+        return false;
+    MEMORY_BARRIER(); /* head read before the entry */
+    if (out)
+        *out = g_motor_isr.trace[tail & (MOTOR_ISR_TRACE_DEPTH - 1u)];
+    MEMORY_BARRIER(); /* entry copied before the slot is released */
+    g_motor_isr.trace_tail = (uint8_t)(tail + 1u);
+    return true;
+}
+
+/* Per-byte decode runs from SRAM (RAMFUNC) so its ISR time does not depend on
+ * flash wait states; frame completion and capture stay in flash. */
+RAMFUNC void motor_isr_rx_bytes(const uint8_t *data, uint16_t len, uint32_t now_ms)
+{
+    if (!data)
+        return;
+    for (uint16_t i = 0; i < len; ++i)
+        motor_isr_process_rx_byte(data[i], now_ms);
+    /* A completed response frees the link for the next queued frame. */
+    motor_isr_tx_kick(now_ms);
+}
+
+void motor_isr_tx_done(uint32_t now_ms)
+{
+    if (!g_motor_isr.tx_inflight)
+        return;
+    uint32_t now = platform_cycles_now();
+    uint8_t slot = (uint8_t)(g_motor_isr.tx_tail & (MOTOR_ISR_TXQ_DEPTH - 1u));
+    motor_isr_trace_push(MOTOR_ISR_TRACE_TX, 0u, g_motor_isr.txq[slot].buf, g_motor_isr.txq[slot].len,
+                         0u, g_motor_isr.tx_start_cyc,
+                         platform_cycles_to_us(now - g_motor_isr.tx_start_cyc));
+    g_motor_isr.tx_done_cyc = now;
+    g_motor_isr.tx_done_valid = 1u;
+    g_motor_isr.tx_inflight = 0u;
+    g_motor_isr.tx_tail = (uint8_t)(g_motor_isr.tx_tail + 1u);
+    g_motor_isr.stats.tx_count++;
+    motor_isr_tx_kick(now_ms);
 }
 
 /*
@@ -282,11 +720,14 @@ void motor_isr_init(event_queue_t *evt_queue)
  */
 void motor_isr_tick(uint32_t now_ms)
 {
-    /* Process any incoming RX bytes */
-    uint16_t rx_budget = 128u;
-    while (rx_budget-- && uart_rx_available(UART2_BASE)) {
-        uint8_t byte = uart_getc(UART2_BASE);
-        motor_isr_process_rx_byte(byte, now_ms);
+    /* Process any incoming RX bytes (DMA path delivers via motor_isr_rx_bytes) */
+    if (!platform_uart2_rx_dma_active()) {
+        uint8_t chunk[64];
+        size_t n = uart_read(UART2_BASE, chunk, sizeof(chunk));
+        MOTOR_ISR_SESSION_RX(chunk, n);
+        for (size_t i = 0; i < n; i++) {
+            motor_isr_process_rx_byte(chunk[i], now_ms);
+        }
     }
 
     /* Check for RX timeout */
@@ -298,26 +739,71 @@ void motor_isr_tick(uint32_t now_ms)
             motor_isr_post_event(EVT_MOTOR_TIMEOUT, 0, now_ms);
             g_motor_isr.stats.timeouts++;
             g_motor_isr.state = MOTOR_ISR_STATE_IDLE;
-            g_motor_isr.rx_state = RX_WAIT_START;
-            g_motor_isr.rx_len = 0;
+            g_motor_isr.rsp_pending = 0u;
+            motor_isr_lane_reset(&g_motor_isr.rx_lanes[MOTOR_RX_LANE_SHENGYI]);
             /* Clear any request-aligned capture state. */
             motor_isr_v2_reset();
         }
     }
 
-    /* TX timing: send command every 50ms */
-    uint32_t since_tx = now_ms - g_motor_isr.tx_last_ms;
-    if (since_tx >= MOTOR_TX_INTERVAL_MS) {
-        if (g_motor_isr.tx_pending) {
-            /* Send queued command */
-            motor_isr_send_tx_cmd();
-            g_motor_isr.tx_last_ms = now_ms;
-            g_motor_isr.state = MOTOR_ISR_STATE_WAIT_RESPONSE;
-            g_motor_isr.rx_start_ms = now_ms;
-            g_motor_isr.rx_state = RX_WAIT_START;
-            g_motor_isr.rx_len = 0;
-        }
+    motor_isr_tx_kick(now_ms);
+}
+
+static uint8_t motor_isr_txq_count(void)
+{
+    return (uint8_t)((g_motor_isr.tx_head - g_motor_isr.tx_tail) & 0xFFu);
+}
+
+/*
+ * Start the frame at the ring tail if the link is free: nothing in flight and
+ * either the previous request was answered or MOTOR_TX_INTERVAL_MS has passed.
+ * Runs at TIM2 priority only (tick, RX DMA drain, TX DMA completion).
+ */
+static void motor_isr_tx_kick(uint32_t now_ms)
+{
+    if (g_motor_isr.tx_inflight || motor_isr_txq_count() == 0u)
+        return;
+    if (g_motor_isr.state != MOTOR_ISR_STATE_IDLE &&
+        (uint32_t)(now_ms - g_motor_isr.tx_last_ms) < MOTOR_TX_INTERVAL_MS)
+        return;
+
+    MEMORY_BARRIER(); /* slot contents written before tx_head was published */
+    uint8_t slot = (uint8_t)(g_motor_isr.tx_tail & (MOTOR_ISR_TXQ_DEPTH - 1u));
+    const uint8_t *frame = g_motor_isr.txq[slot].buf;
+    uint8_t len = g_motor_isr.txq[slot].len;
+
+    if (g_motor_isr.txq[slot].v2_expect_len)
+    {
+        g_motor_isr.rx_v2.msg_id = g_motor_isr.txq[slot].v2_msg_id;
+        g_motor_isr.rx_v2.expected = g_motor_isr.txq[slot].v2_expect_len;
+        g_motor_isr.rx_v2.pos = 0u;
+        g_motor_isr.rx_v2.active = 1u;
+    }
+
+    g_motor_isr.tx_last_ms = now_ms;
+    g_motor_isr.state = MOTOR_ISR_STATE_WAIT_RESPONSE;
+    g_motor_isr.rx_start_ms = now_ms;
+    motor_isr_lane_reset(&g_motor_isr.rx_lanes[MOTOR_RX_LANE_SHENGYI]);
+    g_motor_isr.tx_start_cyc = platform_cycles_now();
+    g_motor_isr.tx_done_valid = 0u;
+    g_motor_isr.rsp_pending = 1u;
+    g_motor_isr.tx_inflight = 1u;
+    flight_rec_log(FLIGHT_MOTOR_TX, (len > 2u) ? frame[2] : 0u, len);
+
+    if (platform_uart2_tx_dma_active())
+    {
+        if (!platform_uart2_tx_dma_start(frame, len))
+            g_motor_isr.tx_inflight = 0u; /* retried on the next tick */
+        return;
     }
+
+    /* Polled fallback before the DMA channel is up (and on host). */
+    for (uint8_t i = 0; i < len; i++) {
+        if (!motor_isr_tx_ready_wait())
+            break;
+        uart_putc(UART2_BASE, frame[i]);
+    }
+    motor_isr_tx_done(now_ms);
 }
 
 /*
@@ -329,25 +815,37 @@ bool motor_isr_queue_cmd(uint8_t assist_level,
                          bool battery_low,
                          bool speed_over)
 {
-    /* Build 0x52 request frame */
-    size_t len = shengyi_build_frame_0x52_req(
-        assist_level,
-        bool_to_u8(light_on),
-        bool_to_u8(walk_active),
-        bool_to_u8(battery_low),
-        bool_to_u8(speed_over),
-        g_motor_isr.tx_cmd,
-        sizeof(g_motor_isr.tx_cmd)
-    );
-
-    if (len > 0u && len <= sizeof(g_motor_isr.tx_cmd))
+    /* The 0x52 request only differs in its two payload bytes: keep the last
+     * one and move the sum16 by their deltas instead of rebuilding it. */
+    uint8_t *frame = g_motor_isr.cmd_frame;
+    if (g_motor_isr.cmd_frame_len == 0u)
     {
-        g_motor_isr.tx_len = (uint8_t)len;
-        g_motor_isr.tx_pending = 1u;
-        return true;
+        size_t len = shengyi_build_frame_0x52_req(0u, 0u, 0u, 0u, 0u, frame, sizeof(g_motor_isr.cmd_frame));
+        if (len == 0u)
+            return false;
+        g_motor_isr.cmd_frame_len = (uint8_t)len;
     }
 
-    return false;
+    uint8_t flags = 0u;
+    if (light_on)
+        flags |= SHENGYI_FLAG_LIGHT;
+    if (battery_low)
+        flags |= SHENGYI_FLAG_BATTLOW;
+    if (walk_active)
+        flags |= SHENGYI_FLAG_WALK;
+    if (speed_over)
+        flags |= SHENGYI_FLAG_SPEED;
+
+    if (frame[4] != assist_level || frame[5] != flags)
+    {
+        uint16_t cks = (uint16_t)(frame[6] | ((uint16_t)frame[7] << 8));
+        cks = (uint16_t)(cks - frame[4] - frame[5] + assist_level + flags);
+        frame[4] = assist_level;
+        frame[5] = flags;
+        frame[6] = (uint8_t)(cks & 0xFFu);
+        frame[7] = (uint8_t)(cks >> 8);
+    }
+    return motor_isr_queue_frame(frame, g_motor_isr.cmd_frame_len);
 }
 
 /*
@@ -355,55 +853,59 @@ bool motor_isr_queue_cmd(uint8_t assist_level,
  */
 bool motor_isr_queue_frame(const uint8_t *frame, uint8_t len)
 {
-    if (!frame || len == 0u || len > sizeof(g_motor_isr.tx_cmd))
+    if (!frame || len == 0u || len > MOTOR_ISR_TX_MAX)
         return false;
+    if (motor_isr_txq_count() >= MOTOR_ISR_TXQ_DEPTH)
+    {
+        g_motor_isr.stats.tx_dropped++;
+        return false;
+    }
 
+    uint8_t head = g_motor_isr.tx_head;
+    uint8_t slot = (uint8_t)(head & (MOTOR_ISR_TXQ_DEPTH - 1u));
     for (uint8_t i = 0; i < len; ++i)
-        g_motor_isr.tx_cmd[i] = frame[i];
-    g_motor_isr.tx_len = len;
-    g_motor_isr.tx_pending = 1u;
+        g_motor_isr.txq[slot].buf[i] = frame[i];
+    g_motor_isr.txq[slot].len = len;
+    g_motor_isr.txq[slot].v2_expect_len = g_motor_isr.tx_stage_len;
+    g_motor_isr.txq[slot].v2_msg_id = g_motor_isr.tx_stage_msg_id;
+    g_motor_isr.tx_stage_len = 0u;
+    MEMORY_BARRIER(); /* publish slot before head */
+    g_motor_isr.tx_head = (uint8_t)(head + 1u);
     return true;
 }
 
 bool motor_isr_tx_busy(void)
 {
-    return g_motor_isr.tx_pending != 0u;
+    return motor_isr_txq_count() != 0u;
+}
+
+uint8_t motor_isr_tx_space(void)
+{
+    return (uint8_t)(MOTOR_ISR_TXQ_DEPTH - motor_isr_txq_count());
 }
 
 void motor_isr_v2_expect(uint16_t msg_id, uint8_t expected_total_len)
 {
-    /* Keep this ISR-friendly: just arm a small capture buffer. */
+    /* Staged on the next queued frame; the ISR arms capture when it is sent,
+     * so frames still ahead in the ring cannot consume the expectation. */
     if (expected_total_len == 0u || expected_total_len > sizeof(g_motor_isr.rx_v2.buf))
     {
-        motor_isr_v2_reset();
+        g_motor_isr.tx_stage_len = 0u;
         return;
     }
-    g_motor_isr.rx_v2.msg_id = msg_id;
-    g_motor_isr.rx_v2.expected = expected_total_len;
-    g_motor_isr.rx_v2.pos = 0u;
-    g_motor_isr.rx_v2.active = 1u;
+    g_motor_isr.tx_stage_msg_id = msg_id;
+    g_motor_isr.tx_stage_len = expected_total_len;
 }
 
 /*
  * Process incoming RX byte
  */
-static void motor_isr_process_rx_byte(uint8_t byte, uint32_t now_ms)
-{
-    /*
-     * OEM variants observed in v2.5.1:
-     * - 0x3A ... sum16 ... CRLF (Shengyi / "tongsheng" misnomer in IDA)
-     * - 0x02 len ... xor (packetized, cmd in byte2, xor covers all but last)
-     * - 0x46/0x53 ... xor ... CR (auth-like, xor excludes first byte)
-     * - Short 5-byte replies with simple checksums (heuristic "v2")
-     *
-     * We parse all of these opportunistically. The main loop can decide which
-     * one to trust (usually 0x3A frames on Shengyi DWG22).
-     */
-
+static RAMFUNC void motor_isr_process_rx_byte(uint8_t byte, uint32_t now_ms)
+{
     /* v2: short request/response frames (OEM mode=2).
      * The OEM aligns RX length to the last request; we support both:
      * - deterministic capture when motor_isr_v2_expect() is armed
-     * - opportunistic 5-byte heuristic when not armed */
+     * - opportunistic 3-byte heuristic when not armed */
     if (g_motor_isr.rx_v2.active)
     {
         g_motor_isr.rx_v2.buf[g_motor_isr.rx_v2.pos++] = byte;
@@ -422,234 +924,26 @@ static void motor_isr_process_rx_byte(uint8_t byte, uint32_t now_ms)
     }
     else
     {
-        /* Opportunistic sliding-window capture for variants we don't have request
-         * alignment for yet. */
         motor_isr_v2_heuristic_capture(byte, now_ms);
     }
 
-    /* auth-like XOR+CR frames (SOF 0x46 or 0x53). */
-    if (!g_motor_isr.rx_auth.active)
-    {
-        if (byte == 0x46u || byte == 0x53u)
-        {
-            g_motor_isr.rx_auth.active = 1u;
-            g_motor_isr.rx_auth.len = 0u;
-            g_motor_isr.rx_auth.buf[g_motor_isr.rx_auth.len++] = byte;
-        }
-    }
-    else
-    {
-        if (g_motor_isr.rx_auth.len < sizeof(g_motor_isr.rx_auth.buf))
-            g_motor_isr.rx_auth.buf[g_motor_isr.rx_auth.len++] = byte;
-        else
-        {
-            g_motor_isr.rx_auth.active = 0u;
-            g_motor_isr.rx_auth.len = 0u;
-        }
-
-        if (byte == 0x0Du && g_motor_isr.rx_auth.len >= 4u)
-        {
-            /* Layout (OEM): [0]=SOF, [... data ...], [len-2]=xor, [len-1]=CR */
-            uint8_t len = g_motor_isr.rx_auth.len;
-            uint8_t x = 0u;
-            for (uint8_t i = 1u; i + 2u < len; ++i)
-                x ^= g_motor_isr.rx_auth.buf[i];
-            if (x == g_motor_isr.rx_auth.buf[len - 2u])
-            {
-                uint8_t op = g_motor_isr.rx_auth.buf[0];
-                motor_isr_capture_frame(MOTOR_PROTO_AUTH_XOR_CR,
-                                        g_motor_isr.rx_auth.buf,
-                                        len,
-                                        op,
-                                        0u,
-                                        now_ms);
-            }
-            g_motor_isr.rx_auth.active = 0u;
-            g_motor_isr.rx_auth.len = 0u;
-        }
-    }
-
-    /* 0x02 len ... xor frames */
-    switch (g_motor_isr.rx02.st)
-    {
-        case RX02_WAIT_SOF:
-            if (byte == 0x02u)
-            {
-                g_motor_isr.rx02.buf[0] = byte;
-                g_motor_isr.rx02.len = 1u;
-                g_motor_isr.rx02.st = RX02_WAIT_LEN;
-            }
-            break;
-        case RX02_WAIT_LEN:
-            g_motor_isr.rx02.buf[g_motor_isr.rx02.len++] = byte;
-            g_motor_isr.rx02.expected = byte;
-            if (g_motor_isr.rx02.expected < 4u || g_motor_isr.rx02.expected > sizeof(g_motor_isr.rx02.buf))
-            {
-                motor_isr_rx02_reset();
-            }
-            else
-            {
-                g_motor_isr.rx02.st = RX02_READ;
-            }
-            break;
-        case RX02_READ:
-            if (g_motor_isr.rx02.len < sizeof(g_motor_isr.rx02.buf))
-                g_motor_isr.rx02.buf[g_motor_isr.rx02.len++] = byte;
-            else
-            {
-                motor_isr_rx02_reset();
-                break;
-            }
-            if (g_motor_isr.rx02.len >= g_motor_isr.rx02.expected)
-            {
-                uint8_t exp = g_motor_isr.rx02.expected;
-                uint8_t x = motor_isr_xor8(g_motor_isr.rx02.buf, (uint8_t)(exp - 1u));
-                if (x == g_motor_isr.rx02.buf[exp - 1u])
-                {
-                    uint8_t op = (exp >= 3u) ? g_motor_isr.rx02.buf[2] : 0u;
-                    motor_isr_capture_frame(MOTOR_PROTO_STX02_XOR,
-                                            g_motor_isr.rx02.buf,
-                                            exp,
-                                            op,
-                                            0u,
-                                            now_ms);
-                }
-                motor_isr_rx02_reset();
-            }
-            break;
-    }
-
-    switch (g_motor_isr.rx_state) {
-        case RX_WAIT_START:
-            if (byte == SHENGYI_FRAME_START) {
-                g_motor_isr.rx_buf[0] = byte;
-                g_motor_isr.rx_len = 1;
-                g_motor_isr.rx_state = RX_WAIT_SECOND;
-                g_motor_isr.state = MOTOR_ISR_STATE_RX_ACTIVE;
-            }
-            break;
-
-        case RX_WAIT_SECOND:
-            /* Accept any second header byte to match OEM parser behavior */
-            g_motor_isr.rx_buf[1] = byte;
-            g_motor_isr.rx_len = 2;
-            g_motor_isr.rx_state = RX_WAIT_OPCODE;
-            break;
-
-        case RX_WAIT_OPCODE:
-            g_motor_isr.rx_buf[2] = byte;
-            g_motor_isr.rx_len = 3;
-            g_motor_isr.rx_state = RX_WAIT_LEN;
-            break;
-
-        case RX_WAIT_LEN: {
-            uint8_t payload_len = byte;
-            g_motor_isr.rx_buf[3] = payload_len;
-            g_motor_isr.rx_len = 4;
-            if (payload_len > SHENGYI_MAX_PAYLOAD_LEN) {
-                motor_isr_post_event(EVT_MOTOR_ERROR, 0xFE, now_ms);
-                g_motor_isr.stats.rx_errors++;
-                g_motor_isr.rx_state = RX_WAIT_START;
-                g_motor_isr.rx_len = 0;
-                break;
-            }
-            g_motor_isr.rx_expected = (uint8_t)(payload_len + 8u);
-            g_motor_isr.rx_state = RX_READ_PAYLOAD;
-            break;
-        }
-
-        case RX_READ_PAYLOAD:
-            if (g_motor_isr.rx_len < SHENGYI_MAX_FRAME_SIZE) {
-                g_motor_isr.rx_buf[g_motor_isr.rx_len++] = byte;
-
-                /* Check if frame complete */
-                if (g_motor_isr.rx_len >= g_motor_isr.rx_expected) {
-                    motor_isr_process_frame(now_ms);
-                    g_motor_isr.rx_state = RX_WAIT_START;
-                    g_motor_isr.rx_len = 0;
-                }
-            } else {
-                /* Buffer overflow - reset */
-                motor_isr_post_event(EVT_MOTOR_ERROR, 0xFF, now_ms);
-                g_motor_isr.stats.rx_errors++;
-                g_motor_isr.rx_state = RX_WAIT_START;
-                g_motor_isr.rx_len = 0;
-            }
-            break;
-    }
+    /* Framed variants; the main loop decides which one to trust (usually 0x3A
+     * frames on Shengyi DWG22). */
+    for (uint8_t i = 0; i < MOTOR_RX_LANE_COUNT; ++i)
+        motor_isr_lane_byte(&k_motor_rx_lanes[i], &g_motor_isr.rx_lanes[i], byte, now_ms);
 }
 
 /*
- * Process complete frame
- */
-static void motor_isr_process_frame(uint32_t now_ms)
-{
-    /* Validate checksum */
-    if (g_motor_isr.rx_len < 6) {
-        /* Too short */
-        motor_isr_post_event(EVT_MOTOR_ERROR, 0x01, now_ms);
-        g_motor_isr.stats.rx_errors++;
-        return;
-    }
-
-    /* Calculate checksum (sum bytes 1 to len-4) */
-    uint16_t expected_cks = shengyi_checksum16(g_motor_isr.rx_buf, g_motor_isr.rx_len);
-    uint16_t frame_cks = (uint16_t)(g_motor_isr.rx_buf[g_motor_isr.rx_len - 4]) |
-                        ((uint16_t)(g_motor_isr.rx_buf[g_motor_isr.rx_len - 3]) << 8);
-
-    if (expected_cks != frame_cks) {
-        /* Checksum mismatch */
-        motor_isr_post_event(EVT_MOTOR_ERROR, 0x02, now_ms);
-        g_motor_isr.stats.rx_errors++;
-        return;
-    }
-
-    /* Valid frame received (Shengyi 0x3A framing). */
-    motor_isr_capture_frame(MOTOR_PROTO_SHENGYI_3A1A,
-                            g_motor_isr.rx_buf,
-                            g_motor_isr.rx_len,
-                            g_motor_isr.rx_buf[2],
-                            0u,
-                            now_ms);
-}
-
-/*
- * Send TX command
- */
-static void motor_isr_send_tx_cmd(void)
-{
-    if (!g_motor_isr.tx_pending || g_motor_isr.tx_len == 0)
-        return;
-
-    if (!motor_isr_tx_ready_wait())
-        return;
-
-    /* Send all bytes */
-    for (uint8_t i = 0; i < g_motor_isr.tx_len; i++) {
-        if (!motor_isr_tx_ready_wait())
-        {
-            g_motor_isr.tx_pending = 0u;
-            g_motor_isr.tx_len = 0u;
-            return;
-        }
-        uart_putc(UART2_BASE, g_motor_isr.tx_cmd[i]);
-    }
-
-    g_motor_isr.stats.tx_count++;
-    g_motor_isr.tx_pending = 0;
-}
-
-/*
- * Post event to queue
+ * Post event to the motor lane
  */
 static void motor_isr_post_event(uint8_t type, uint16_t payload, uint32_t timestamp)
 {
-    if (!g_motor_isr.evt_queue)
+    if (!g_motor_isr.evt_bus)
         return;
 
     event_t evt = event_create(type, payload, timestamp);
 
-    if (!event_queue_push(g_motor_isr.evt_queue, &evt)) {
+    if (!event_bus_publish(g_motor_isr.evt_bus, EVENT_LANE_MOTOR, &evt)) {
         /* Queue full - increment error counter */
         g_motor_isr.stats.queue_full++;
     }
@@ -716,3 +1010,19 @@ bool motor_isr_copy_last_frame(uint8_t *out, uint8_t cap, uint8_t *out_len,
 
     return len != 0u;
 }
+
+bool motor_isr_read_status(motor_isr_status_t *out)
+{
+    if (!out)
+        return false;
+
+    uint8_t seq1;
+    do {
+        seq1 = g_motor_isr.status.seq;
+        MEMORY_BARRIER();  /* Ensure seq1 read before field copy */
+        *out = g_motor_isr.status;
+        MEMORY_BARRIER();  /* Ensure copy completes before seq re-read */
+    } while (seq1 != g_motor_isr.status.seq);
+
+    return out->seq != 0u || out->proto != 0u || out->op != 0u;
+}
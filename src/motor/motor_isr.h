@@ -23,7 +23,8 @@
 
 #include <stdint.h>
 #include <stdbool.h>
-#include "../kernel/event_queue.h"
+#include "../kernel/event_bus.h"
+#include "../kernel/work_queue.h"
 
 /*
  * ISR timing parameters
@@ -59,15 +60,17 @@ typedef enum {
     MOTOR_PROTO_V2_FIXED     = 3, /* short fixed frames (heuristic) */
 } motor_proto_t;
 
+#define MOTOR_PROTO_COUNT 4u
+
 /*
  * Initialize motor ISR subsystem
  *
  * Args:
- *   evt_queue - Output event queue for posting motor events
+ *   evt_bus - Bus whose EVENT_LANE_MOTOR receives motor events
  *
  * Note: Must be called before motor_isr_tick()
  */
-void motor_isr_init(event_queue_t *evt_queue);
+void motor_isr_init(event_bus_t *evt_bus);
 
 /*
  * Fast motor tick - called from TIM2 ISR every 5ms
@@ -86,6 +89,14 @@ void motor_isr_init(event_queue_t *evt_queue);
  */
 void motor_isr_tick(uint32_t now_ms);
 
+/*
+ * Feed a burst of received UART2 bytes into the frame assembler
+ *
+ * Called from the UART2 RX DMA IRQ (same priority as TIM2) when the
+ * circular DMA path is active; motor_isr_tick() then skips its RX poll.
+ */
+void motor_isr_rx_bytes(const uint8_t *data, uint16_t len, uint32_t now_ms);
+
 /*
  * Queue a new motor command for transmission
  *
@@ -96,8 +107,8 @@ void motor_isr_tick(uint32_t now_ms);
  *   battery_low  - Battery low flag (true = low)
  *   speed_over   - Speed limit exceeded (true = over)
  *
- * Note: Can be called from main loop. Command will be sent
- *       at next TX interval.
+ * Note: Can be called from main loop. The frame joins the TX ring
+ *       and goes out once the link is free.
  */
 bool motor_isr_queue_cmd(uint8_t assist_level,
                         bool light_on,
@@ -119,17 +130,28 @@ bool motor_isr_queue_cmd(uint8_t assist_level,
 bool motor_isr_queue_frame(const uint8_t *frame, uint8_t len);
 
 /*
- * Returns true if a TX frame is currently pending (will be sent by the ISR),
- * 0 otherwise.
+ * Returns true if any TX frame is queued or in flight, false otherwise.
  */
 bool motor_isr_tx_busy(void);
 
+/*
+ * Free slots in the TX frame ring. Frames are sent in queue order, one at a
+ * time: the next starts when the previous one has left the wire and its reply
+ * arrived (or MOTOR_TX_INTERVAL_MS elapsed).
+ */
+uint8_t motor_isr_tx_space(void);
+
+/*
+ * TX completion from the UART2 TX DMA IRQ (TIM2 priority).
+ */
+void motor_isr_tx_done(uint32_t now_ms);
+
 /*
  * For the short "v2" protocol, the OEM RX side is request/response aligned:
  * the expected response length depends on the last request.
  *
- * Call this immediately before queueing the corresponding request so the ISR
- * can capture the response deterministically.
+ * Call this immediately before queueing the corresponding request; the
+ * expectation travels with that frame and is armed when the ISR sends it.
  *
  * expected_total_len includes all bytes in the response (including checksum).
  */
@@ -154,11 +176,103 @@ bool motor_isr_copy_last_frame(uint8_t *out, uint8_t cap, uint8_t *out_len,
                               motor_proto_t *out_proto,
                               uint16_t *out_aux16);
 
+/*
+ * Decoded controller status, published by the ISR when a status frame
+ * (Shengyi 0x52, STX02 cmd1, AUTH 'F', v2 short) is captured so the main loop
+ * never copies or re-parses the raw bytes. Wheel-size dependent conversions
+ * stay with the reader.
+ */
+#define MOTOR_ISR_STATUS_F_BRAKE  0x01u  /* Shengyi byte0 bit6 */
+#define MOTOR_ISR_STATUS_F_SOC    0x02u  /* soc_pct is a valid percentage */
+
+typedef struct {
+    uint8_t proto;           /* motor_proto_t */
+    uint8_t op;
+    uint8_t ok;              /* 0: status frame failed field validation */
+    uint8_t flags;           /* MOTOR_ISR_STATUS_F_* */
+    uint8_t err;             /* controller error code, protocol-mapped */
+    uint8_t soc_pct;
+    int16_t current_dA;
+    int16_t batt_dV;         /* Shengyi only: status-byte volts, 0.1 V units */
+    uint16_t speed_raw;      /* Shengyi: raw speed word; others: wheel period ms/rev */
+    uint8_t seq;             /* increments on every publish */
+} motor_isr_status_t;
+
+/* True if (proto, op) frames publish a motor_isr_status_t. */
+bool motor_isr_is_status_frame(motor_proto_t proto, uint8_t op);
+
+/*
+ * Decode one captured status frame into *st (fields it does not carry are
+ * left as they were; callers pass a zeroed struct). Fixed offsets, shifts
+ * and masks per protocol, one pass; false if the frame fails validation.
+ * The ISR runs this before publishing; exposed for host tests.
+ */
+bool motor_isr_decode_status(motor_proto_t proto, const uint8_t *frame, uint8_t len,
+                             motor_isr_status_t *st);
+
+/* Seqlock read of the latest decoded status; false until one was published. */
+bool motor_isr_read_status(motor_isr_status_t *out);
+
+/*
+ * Run fn from the work queue after every status frame, once its
+ * EVT_MOTOR_STATE is on the motor lane (NULL disables). On target that is
+ * PendSV, i.e. right after the ISR returns rather than on the next main-loop
+ * pass. motor_isr_status_cycles() is the DWT stamp of the latest status
+ * publish, for measuring frame-to-command latency.
+ */
+void motor_isr_set_status_hook(work_fn fn);
+uint32_t motor_isr_status_cycles(void);
+
 /*
  * Get current ISR state (for debugging)
  */
 motor_isr_state_t motor_isr_get_state(void);
 
+/*
+ * Set the motor UART baud so response airtime can be taken out of the
+ * controller turnaround figure (default 9600).
+ */
+void motor_isr_set_baud(uint32_t baud);
+
+/*
+ * Bus frame trace: one entry per frame that left the wire (TX) or decoded (RX),
+ * stamped from the DWT cycle counter (platform_cycles_now()). Written by the
+ * ISR, drained by the main loop; entries are dropped, not overwritten, when
+ * the ring is full.
+ */
+#define MOTOR_ISR_TRACE_DEPTH   32u
+#define MOTOR_ISR_TRACE_BYTES   12u
+
+#define MOTOR_ISR_TRACE_TX 0u
+#define MOTOR_ISR_TRACE_RX 1u
+
+typedef struct {
+    uint32_t t_cycles;       /* TX: first byte handed to the UART; RX: frame decoded */
+    uint32_t dt_us;          /* TX: time on the wire; RX: since the previous TX finished */
+    uint8_t dir;             /* MOTOR_ISR_TRACE_TX / MOTOR_ISR_TRACE_RX */
+    uint8_t proto;           /* motor_proto_t (RX only) */
+    uint8_t len;             /* full frame length; bytes[] holds the first few */
+    uint8_t op;              /* decoded opcode (RX only) */
+    uint8_t bytes[MOTOR_ISR_TRACE_BYTES];
+} motor_isr_trace_t;
+
+bool motor_isr_trace_pop(motor_isr_trace_t *out);
+
+/*
+ * Link timing in microseconds:
+ *   rsp_latency - TX start to the reply being decoded
+ *   turnaround  - TX end to the controller starting its reply
+ *                 (decode time minus reply airtime)
+ *   rx_gap      - between consecutive decoded frames
+ * RX is decoded at the IDLE line when UART2 RX DMA is active, otherwise at
+ * the 5 ms tick, which bounds the RX-side resolution.
+ */
+typedef struct {
+    uint32_t last_us;
+    uint32_t avg_us;         /* EWMA, 1/8 weight */
+    uint32_t max_us;
+} motor_isr_timing_t;
+
 /*
  * Get statistics (for debugging/telemetry)
  */
@@ -169,6 +283,12 @@ typedef struct {
     uint32_t timeouts;       /* RX timeout count */
     uint32_t queue_full;     /* Event queue full errors */
     uint32_t last_rx_ms;     /* Timestamp of last valid RX */
+    uint32_t tx_dropped;     /* Frames rejected because the TX ring was full */
+    uint32_t trace_dropped;  /* Trace entries lost to a full ring */
+    uint32_t rx_by_proto[MOTOR_PROTO_COUNT]; /* Decoded frames (v2: armed captures only) */
+    motor_isr_timing_t rsp_latency;
+    motor_isr_timing_t turnaround;
+    motor_isr_timing_t rx_gap;
 } motor_isr_stats_t;
 
 void motor_isr_get_stats(motor_isr_stats_t *stats);
@@ -16,6 +16,7 @@
 #include "app_data.h"
 #include "shengyi.h"
 #include "motor_isr.h"
+#include "src/core/speed_filter.h"
 
 #include "src/control/control.h"
 #include "src/config/config.h"
@@ -31,13 +32,21 @@ extern volatile uint32_t g_ms;
 
 /* OEM-mode-ish send cadences (best-effort). */
 #define PROBE_INTERVAL_MS   200u
-#define STX02_INTERVAL_MS   100u
-#define AUTH_INTERVAL_MS    250u
-#define V2_INTERVAL_MS      120u
+
+/* AUTO cold start: listen first, then probe every 9600-baud protocol in one
+ * burst per round; drop to 1200 baud (v2) only after rounds with no match. */
+#define SNIFF_LISTEN_MS     150u
+#define SNIFF_ROUNDS_9600   3u
+#define SNIFF_ROUNDS_1200   2u
+#define MOTOR_LINK_LOCK_SCORE 2u
+
+/* Closed-loop TX: a reply that has not been decoded by this much past the
+ * mean response latency is treated as missing (one TIM2 tick of RX slack). */
+#define MOTOR_LINK_RSP_WINDOW_MARGIN_MS 5u
 
 /* Protocol helpers and wire defaults. */
 #define MOTOR_LINK_DEFAULT_WHEEL_MM SHENGYI_DEFAULT_WHEEL_MM
-#define MOTOR_LINK_PROTO_SLOT_COUNT 4u
+#define MOTOR_LINK_PROTO_SLOT_COUNT MOTOR_PROTO_COUNT
 #define MOTOR_LINK_STX02_FRAME_LEN  20u
 #define MOTOR_LINK_STX02_FRAME_LIMIT_KPH_X10 510u
 #define MOTOR_LINK_STX02_BATT_THRESHOLD_MV 42000u
@@ -47,16 +56,47 @@ extern volatile uint32_t g_ms;
 #define MOTOR_BAUD_DEFAULT  9600u
 #define MOTOR_BAUD_V2       1200u
 
+typedef enum {
+    MOTOR_LINK_SNIFF_LISTEN = 0,    /* passive: decoders run, nothing sent */
+    MOTOR_LINK_SNIFF_PROBE_9600,
+    MOTOR_LINK_SNIFF_PROBE_1200,
+} motor_link_sniff_t;
+
+/* Evidence per decoded frame. Sum16+CRLF and length+xor framings are strong
+ * enough to lock on one frame; the short xor/additive ones need two. */
+static const uint8_t k_motor_link_lock_weight[MOTOR_LINK_PROTO_SLOT_COUNT] = {
+    [MOTOR_PROTO_SHENGYI_3A1A] = 2u,
+    [MOTOR_PROTO_STX02_XOR] = 2u,
+    [MOTOR_PROTO_AUTH_XOR_CR] = 1u,
+    [MOTOR_PROTO_V2_FIXED] = 1u,
+};
+
+typedef struct {
+    uint16_t min_ms;    /* after an answered request */
+    uint16_t max_ms;    /* OEM cadence; ceiling while a reply is missing */
+} motor_link_tx_rate_t;
+
+/* max_ms keeps the OEM-ish fixed cadences; min_ms is bounded by the request +
+ * reply airtime (v2 runs at 1200 baud) and the ISR's 50 ms resend guard. */
+static const motor_link_tx_rate_t k_motor_link_tx_rate_default[MOTOR_LINK_PROTO_SLOT_COUNT] = {
+    [MOTOR_PROTO_SHENGYI_3A1A] = { 50u, 100u },
+    [MOTOR_PROTO_STX02_XOR] = { 50u, 100u },
+    [MOTOR_PROTO_AUTH_XOR_CR] = { 100u, 250u },
+    [MOTOR_PROTO_V2_FIXED] = { 60u, 120u },
+};
+
 static struct {
     motor_link_mode_t mode;
     uint8_t locked;
     motor_proto_t locked_proto;
 
     uint8_t proto_score[MOTOR_LINK_PROTO_SLOT_COUNT];
-    uint8_t last_seq_seen;
+    uint32_t rx_seen[MOTOR_LINK_PROTO_SLOT_COUNT]; /* motor_isr rx_by_proto snapshot */
 
     uint32_t last_probe_ms;
-    uint8_t probe_step;
+    uint8_t sniff_state;             /* motor_link_sniff_t */
+    uint8_t sniff_rounds;
+    uint32_t sniff_start_ms;
 
     uint32_t last_stx02_ms;
     uint32_t last_auth_ms;
@@ -65,25 +105,56 @@ static struct {
     uint32_t last_v2_ms;
     uint8_t v2_step;
 
+    motor_link_tx_rate_t tx_rate[MOTOR_LINK_PROTO_SLOT_COUNT];
+    uint32_t rsp_avg_us;             /* motor_isr rsp_latency EWMA snapshot */
+    uint16_t tx_interval_ms;         /* last interval from motor_link_tx_interval_update */
+
     /* Protocol B (STX02/XOR) OEM-ish state.
      * Mirrors the OEM app's STX02-related globals, but kept local until fully mapped. */
-    uint8_t stx02_bit6_src;           /* OEM byte_20001E55 & 1, default 0 */
-    uint8_t stx02_bit3_src;           /* OEM byte_20001E56 & 1, default 1 */
-    uint8_t stx02_speed_gate;         /* OEM byte_20001E65, default 0 */
-    uint8_t stx02_pulse_req;          /* OEM byte_20001DA4 one-shot (only used when stx02_bit3_src==0) */
+    uint8_t stx02_pulse_req;          /* OEM byte_20001DA4 one-shot (only used when bit3 is disabled) */
     uint8_t stx02_last_walk_active;   /* for edge-detecting walk transitions */
     uint16_t stx02_speed_filt_kph_x10; /* OEM word_20001DAC (filtered speed, kph*10) */
+    speed_iir_t stx02_speed_iir;       /* Q8 state behind stx02_speed_filt_kph_x10 */
 
     uint32_t pclk1_hz;               /* cached APB1 clock for BRR computation */
     uint32_t current_baud;            /* last baud rate set on UART2 */
 } g_motor_link;
 
+/*
+ * Config-derived wire constants, rebuilt by motor_link_apply_config() when
+ * g_config_active changes instead of on every frame build. The STX02 status
+ * frame lives here as the last frame sent: config bytes are written once,
+ * and a send only rewrites the dynamic bytes that changed, moving the XOR
+ * along with them (stx02_patch), then queues the buffer as is.
+ */
+static struct {
+    uint8_t stx02_frame[MOTOR_LINK_STX02_FRAME_LEN];
+    uint8_t stx02_flags_base;        /* bit7, plus bit6/bit3 from config.reserved */
+    uint8_t stx02_bit3_src;          /* OEM byte_20001E56 & 1, default 1 */
+    uint8_t stx02_speed_gate;        /* OEM byte_20001E65, default 0 */
+    uint8_t wheel_code;              /* AUTH b2 bits0..2 */
+    uint16_t v2_speed_code;          /* 0x161F request argument */
+
+    /* The effective caps move with the power policy, not config; their
+     * encodings are recomputed only when the cap itself changes. */
+    uint16_t cap_speed_dmph;
+    uint16_t cap_current_dA;
+    uint8_t speed_limit_kph;         /* STX02 byte 12 */
+    uint8_t auth_speed_field;        /* AUTH b2 bits3..7 */
+    uint8_t current_limit_A;         /* STX02 byte 13 */
+} g_motor_link_cfg;
+
 static uint16_t dmph_to_kph_x10(uint16_t dmph);
 static uint16_t stx02_speed_filter_update(uint16_t target_kph_x10);
-static void stx02_refresh_opts_from_config(void);
-static bool motor_link_send_slot_due(uint32_t now_ms, uint32_t *last_ms, uint32_t interval_ms);
+static bool motor_link_send_slot_due(uint32_t now_ms, uint32_t *last_ms);
 static void motor_link_reset_mode_state(void);
+static void motor_link_snapshot_rx(void);
 static uint16_t motor_link_effective_wheel_mm(void);
+static uint16_t wheel_diam_in_x10_from_wheel_mm(uint16_t wheel_mm);
+static uint8_t wheel_code_from_wheel_mm(uint16_t wheel_mm);
+static uint16_t v2_speed_limit_code(void);
+static uint8_t stx02_xor8(const uint8_t *p, uint8_t n);
+static void motor_link_encode_caps(void);
 
 static void motor_link_set_baud(uint32_t baud)
 {
@@ -98,6 +169,7 @@ static void motor_link_set_baud(uint32_t baud)
 #else
     g_motor_link.current_baud = baud;
 #endif
+    motor_isr_set_baud(baud);
 }
 
 static uint32_t baud_for_proto(motor_proto_t proto)
@@ -138,14 +210,55 @@ motor_proto_t motor_link_get_active_proto(void)
     return MOTOR_PROTO_SHENGYI_3A1A;
 }
 
-static bool motor_link_send_slot_due(uint32_t now_ms, uint32_t *last_ms, uint32_t interval_ms)
+bool motor_link_set_tx_rate(motor_proto_t proto, uint16_t min_ms, uint16_t max_ms)
+{
+    if ((uint32_t)proto >= MOTOR_LINK_PROTO_SLOT_COUNT || min_ms == 0u || min_ms > max_ms)
+        return false;
+    g_motor_link.tx_rate[proto].min_ms = min_ms;
+    g_motor_link.tx_rate[proto].max_ms = max_ms;
+    return true;
+}
+
+uint16_t motor_link_tx_interval_ms(void)
+{
+    return g_motor_link.tx_interval_ms;
+}
+
+/*
+ * Pick the send interval for the active protocol from the reply timing. The
+ * ISR returns to IDLE when a reply is decoded (at the UART IDLE line, so the
+ * controller has already released the bus) or when MOTOR_RX_TIMEOUT_MS has
+ * passed; either way the next request is safe after min_ms. While a reply is
+ * outstanding, wait out the learned window instead of the fixed ceiling.
+ */
+static void motor_link_tx_interval_update(motor_proto_t proto)
+{
+    const motor_link_tx_rate_t *rate = &g_motor_link.tx_rate[proto];
+    uint32_t interval_ms = rate->max_ms;
+
+    if (motor_isr_get_state() == MOTOR_ISR_STATE_IDLE)
+    {
+        interval_ms = rate->min_ms;
+    }
+    else if (g_motor_link.rsp_avg_us != 0u)
+    {
+        uint32_t window_ms = (2u * g_motor_link.rsp_avg_us + 999u) / 1000u + MOTOR_LINK_RSP_WINDOW_MARGIN_MS;
+        if (window_ms < interval_ms)
+            interval_ms = window_ms;
+        if (interval_ms < rate->min_ms)
+            interval_ms = rate->min_ms;
+    }
+    g_motor_link.tx_interval_ms = (uint16_t)interval_ms;
+}
+
+static bool motor_link_send_slot_due(uint32_t now_ms, uint32_t *last_ms)
 {
     if (!last_ms)
         return false;
 
-    if ((uint32_t)(now_ms - *last_ms) < interval_ms)
+    if ((uint32_t)(now_ms - *last_ms) < g_motor_link.tx_interval_ms)
         return false;
-    if (motor_isr_tx_busy())
+    if (motor_isr_tx_space() == 0u)
         return false;
 
     *last_ms = now_ms;
@@ -157,8 +270,10 @@ static void motor_link_reset_mode_state(void)
     g_motor_link.locked = 0u;
     g_motor_link.locked_proto = MOTOR_PROTO_SHENGYI_3A1A;
     memset(g_motor_link.proto_score, 0, sizeof(g_motor_link.proto_score));
-    g_motor_link.last_seq_seen = 0xFFu;
-    g_motor_link.probe_step = 0u;
+    motor_link_snapshot_rx();
+    g_motor_link.sniff_state = MOTOR_LINK_SNIFF_LISTEN;
+    g_motor_link.sniff_rounds = 0u;
+    g_motor_link.sniff_start_ms = g_ms;
     g_motor_link.last_probe_ms = 0u;
     g_motor_link.last_stx02_ms = 0u;
     g_motor_link.last_auth_ms = 0u;
@@ -167,12 +282,10 @@ static void motor_link_reset_mode_state(void)
     g_motor_link.auth_phase = 0u;
 
     /* Reset STX02 state to OEM defaults. */
-    g_motor_link.stx02_bit6_src = 0u;
-    g_motor_link.stx02_bit3_src = 1u;
-    g_motor_link.stx02_speed_gate = 0u;
     g_motor_link.stx02_pulse_req = 0u;
     g_motor_link.stx02_last_walk_active = 0u;
     g_motor_link.stx02_speed_filt_kph_x10 = 0u;
+    speed_iir_reset(&g_motor_link.stx02_speed_iir, 0u);
 }
 
 static uint16_t motor_link_effective_wheel_mm(void)
@@ -202,13 +315,86 @@ void motor_link_set_mode(motor_link_mode_t mode)
 void motor_link_init(void)
 {
     memset(&g_motor_link, 0, sizeof(g_motor_link));
+    memcpy(g_motor_link.tx_rate, k_motor_link_tx_rate_default, sizeof(g_motor_link.tx_rate));
 #ifndef HOST_TEST
     g_motor_link.pclk1_hz = rcc_get_pclk_hz_fallback(0u);
 #else
     g_motor_link.pclk1_hz = 60000000u; /* 60 MHz for tests */
 #endif
     motor_link_set_mode(MOTOR_LINK_MODE_AUTO);
-    stx02_refresh_opts_from_config();
+    motor_link_apply_config();
+}
+
+void motor_link_apply_config(void)
+{
+    /* reserved==0 maps to OEM defaults: bit6=0, bit3=1, speed_gate=0 */
+    uint16_t r = g_config_active.reserved;
+    g_motor_link_cfg.stx02_bit3_src = bool_to_u8((r & CFG_RSVD_STX02_BIT3_DISABLE) == 0u);
+    g_motor_link_cfg.stx02_speed_gate = bool_to_u8(r & CFG_RSVD_STX02_SPEED_GATE_ENABLE);
+    g_motor_link_cfg.stx02_flags_base = 0x80u; /* bit7 */
+    if (r & CFG_RSVD_STX02_BIT6_ENABLE)
+        g_motor_link_cfg.stx02_flags_base |= (1u << 6);
+    if (g_motor_link_cfg.stx02_bit3_src)
+        g_motor_link_cfg.stx02_flags_base |= (1u << 3);
+
+    uint16_t wheel_mm = motor_link_effective_wheel_mm();
+    uint16_t diam_x10 = wheel_diam_in_x10_from_wheel_mm(wheel_mm);
+    g_motor_link_cfg.wheel_code = wheel_code_from_wheel_mm(wheel_mm);
+    g_motor_link_cfg.v2_speed_code = v2_speed_limit_code();
+
+    uint8_t *out = g_motor_link_cfg.stx02_frame;
+    memset(out, 0, MOTOR_LINK_STX02_FRAME_LEN);
+    out[0] = 0x01u; /* frame type */
+    out[1] = MOTOR_LINK_STX02_FRAME_LEN; /* length (data+checksum) */
+    out[2] = 0x01u; /* frame counter (OEM is constant) */
+    /*
+     * OEM byte_20001E54 default is 2 (see sub_801AB64). It is not the 3/5/9
+     * assist count; keep a stable default value for compatibility.
+     */
+    out[3] = 0x02u;
+    out[6] = 0x01u; /* display setting (OEM default is 1) */
+    out[7] = (uint8_t)(diam_x10 >> 8);
+    out[8] = (uint8_t)(diam_x10 & 0xFFu);
+    /* OEM v2.5.1 uses 3 config-derived bytes here (see `sub_801AB64` defaults and
+     * `sub_802164C` config update path 0xC0): n3_1, n3_2, byte_20001E5B.
+     * We do not model these yet; keep OEM defaults (3,3,0) for compatibility. */
+    out[9] = 3u;
+    out[10] = 3u;
+    out[11] = 0u;
+    /* OEM default is 42000mV -> 420 (mV/100). Keep a stable nonzero threshold. */
+    uint16_t batt_thr_q = (uint16_t)((MOTOR_LINK_STX02_BATT_THRESHOLD_MV + 50u) / 100u);
+    out[14] = (uint8_t)(batt_thr_q >> 8);
+    out[15] = (uint8_t)(batt_thr_q & 0xFFu);
+    out[MOTOR_LINK_STX02_FRAME_LEN - 1u] = stx02_xor8(out, (uint8_t)(MOTOR_LINK_STX02_FRAME_LEN - 1u));
+    motor_link_encode_caps();
+}
+
+static void motor_link_encode_caps(void)
+{
+    uint16_t dmph = g_effective_cap_speed_dmph;
+    /* Speed limit encoding: clamp to <= 51.0 km/h (0x1FE). */
+    uint16_t kph_x10 = dmph_to_kph_x10(dmph);
+    if (kph_x10 > MOTOR_LINK_STX02_FRAME_LIMIT_KPH_X10)
+        kph_x10 = MOTOR_LINK_STX02_FRAME_LIMIT_KPH_X10;
+    uint16_t kph = (uint16_t)(kph_x10 / 10u);
+    int32_t field = (int32_t)kph - 20;
+    if (field < 0) field = 0;
+    if (field > 31) field = 31;
+    g_motor_link_cfg.cap_speed_dmph = dmph;
+    g_motor_link_cfg.speed_limit_kph = (uint8_t)kph;
+    g_motor_link_cfg.auth_speed_field = (uint8_t)field;
+
+    uint16_t cap_current_dA = g_effective_cap_current_dA;
+    g_motor_link_cfg.cap_current_dA = cap_current_dA;
+    g_motor_link_cfg.current_limit_A = (uint8_t)((cap_current_dA + 5u) / 10u);
+}
+
+/* Re-encodes the speed/current limits after the effective caps moved. */
+static void motor_link_refresh_caps(void)
+{
+    if (g_effective_cap_speed_dmph != g_motor_link_cfg.cap_speed_dmph ||
+        g_effective_cap_current_dA != g_motor_link_cfg.cap_current_dA)
+        motor_link_encode_caps();
 }
 
 static uint8_t stx02_xor8(const uint8_t *p, uint8_t n)
@@ -269,27 +455,27 @@ static uint8_t stx02_power_level_from_gear_oem(uint8_t gear, uint8_t gears_total
     return 15u;
 }
 
-/* OEM "non-0x3A" status packet (19 bytes + XOR).
- * docs/firmware/README.md describes the payload layout for v2.5.1-style builds. */
-static uint8_t stx02_build_status_0x14(uint8_t *out, uint8_t cap)
+/* Rewrites one dynamic byte of the cached STX02 frame; the trailing XOR
+ * drops the old value and takes the new one. */
+static void stx02_patch(uint8_t pos, uint8_t v)
 {
-    if (!out || cap < MOTOR_LINK_STX02_FRAME_LEN)
-        return 0u;
-
-    /* Keep STX02 option bits sourced from persistent config. */
-    stx02_refresh_opts_from_config();
-
-    uint16_t wheel_mm = motor_link_effective_wheel_mm();
-    uint16_t diam_x10 = wheel_diam_in_x10_from_wheel_mm(wheel_mm);
+    uint8_t *f = g_motor_link_cfg.stx02_frame;
+    uint8_t d = (uint8_t)(f[pos] ^ v);
+    if (d == 0u)
+        return;
+    f[pos] = v;
+    f[MOTOR_LINK_STX02_FRAME_LEN - 1u] ^= d;
+}
 
-    uint16_t kph_x10 = dmph_to_kph_x10(g_effective_cap_speed_dmph);
-    if (kph_x10 > MOTOR_LINK_STX02_FRAME_LIMIT_KPH_X10)
-        kph_x10 = MOTOR_LINK_STX02_FRAME_LIMIT_KPH_X10;
-    uint8_t speed_limit_kph = (uint8_t)(kph_x10 / 10u);
+/* OEM "non-0x3A" status packet (19 bytes + XOR), updated in place in
+ * g_motor_link_cfg.stx02_frame; returns that buffer.
+ * docs/firmware/README.md describes the payload layout for v2.5.1-style builds. */
+static const uint8_t *stx02_update_status_0x14(void)
+{
+    motor_link_refresh_caps();
+    uint8_t speed_limit_kph = g_motor_link_cfg.speed_limit_kph;
     uint16_t speed_limit_kph_x10 = (uint16_t)speed_limit_kph * 10u;
-
-    uint16_t cap_current_dA = g_effective_cap_current_dA;
-    uint8_t current_limit_A = (uint8_t)((cap_current_dA + 5u) / 10u);
+    uint8_t current_limit_A = g_motor_link_cfg.current_limit_A;
 
     uint8_t gears_total = g_vgears.count ? g_vgears.count : 3u;
     uint8_t gears_oem = stx02_profile_type_from_gear_count(gears_total);
@@ -307,7 +493,7 @@ static uint8_t stx02_build_status_0x14(uint8_t *out, uint8_t cap)
      * - bit0: one-shot pulse (byte_20001DA4), only used when byte_20001E56==0
      *
      * We don't fully model all OEM internal variables yet, so we implement:
-     * - stable OEM-ish defaults: bit7 set, bit3 set (via stx02_bit3_src), bit6 clear
+     * - stable OEM-ish defaults: bit7 set, bit3 set, bit6 clear (stx02_flags_base)
      * - user-facing toggles we do have: headlight, walk
      */
     /* Track walk edge to generate an OEM-like one-shot pulse request. */
@@ -316,69 +502,32 @@ static uint8_t stx02_build_status_0x14(uint8_t *out, uint8_t cap)
         g_motor_link.stx02_pulse_req = 1u;
     g_motor_link.stx02_last_walk_active = walk_active;
 
-    uint8_t flags = 0x80u; /* bit7 */
-    if (g_motor_link.stx02_bit6_src)
-        flags |= (1u << 6);
+    uint8_t flags = g_motor_link_cfg.stx02_flags_base;
     if (g_headlight_enabled)
         flags |= (1u << 5);
-    if (g_motor_link.stx02_bit3_src)
-        flags |= (1u << 3);
 
     /* bit2: OEM speed-limit flag (gated by byte_20001E65). Default off unless enabled. */
     uint16_t cur_kph_x10 = dmph_to_kph_x10(g_inputs.speed_dmph);
     uint16_t filt_kph_x10 = stx02_speed_filter_update(cur_kph_x10);
-    if (g_motor_link.stx02_speed_gate && (filt_kph_x10 > speed_limit_kph_x10))
+    if (g_motor_link_cfg.stx02_speed_gate && (filt_kph_x10 > speed_limit_kph_x10))
         flags |= (1u << 2);
 
     if (walk_active)
         flags |= (1u << 1);
 
     /* bit0: one-shot pulse, only when bit3_src is disabled (matches OEM v2.5.1 behavior). */
-    if (!g_motor_link.stx02_bit3_src && g_motor_link.stx02_pulse_req)
+    if (!g_motor_link_cfg.stx02_bit3_src && g_motor_link.stx02_pulse_req)
     {
         flags |= 1u;
         g_motor_link.stx02_pulse_req = 0u;
     }
 
-    out[0] = 0x01u; /* frame type */
-    out[1] = MOTOR_LINK_STX02_FRAME_LEN; /* length (data+checksum) */
-    out[2] = 0x01u; /* frame counter (OEM is constant) */
-    /*
-     * OEM byte_20001E54 default is 2 (see sub_801AB64). It is not the 3/5/9
-     * assist count; keep a stable default value for compatibility.
-     */
-    out[3] = 0x02u;
-    out[4] = power_level;
-    out[5] = flags;
-    out[6] = 0x01u; /* display setting (OEM default is 1) */
-    out[7] = (uint8_t)(diam_x10 >> 8);
-    out[8] = (uint8_t)(diam_x10 & 0xFFu);
-    /* OEM v2.5.1 uses 3 config-derived bytes here (see `sub_801AB64` defaults and
-     * `sub_802164C` config update path 0xC0): n3_1, n3_2, byte_20001E5B.
-     * We do not model these yet; keep OEM defaults (3,3,0) for compatibility. */
-    out[9] = 3u;
-    out[10] = 3u;
-    out[11] = 0u;
-    out[12] = speed_limit_kph;
-    out[13] = current_limit_A;
-    /* OEM default is 42000mV -> 420 (mV/100). Keep a stable nonzero threshold. */
-    uint16_t batt_thr_q = (uint16_t)((MOTOR_LINK_STX02_BATT_THRESHOLD_MV + 50u) / 100u);
-    out[14] = (uint8_t)(batt_thr_q >> 8);
-    out[15] = (uint8_t)(batt_thr_q & 0xFFu);
-    out[16] = 0u;
-    out[17] = 0u;
-    out[18] = (uint8_t)(g_motor.err & 0x0Fu);
-    out[MOTOR_LINK_STX02_FRAME_LEN - 1u] = stx02_xor8(out, (uint8_t)(MOTOR_LINK_STX02_FRAME_LEN - 1u));
-    return MOTOR_LINK_STX02_FRAME_LEN;
-}
-
-static void stx02_refresh_opts_from_config(void)
-{
-    /* reserved==0 maps to OEM defaults: bit6=0, bit3=1, speed_gate=0 */
-    uint16_t r = g_config_active.reserved;
-    g_motor_link.stx02_bit6_src = bool_to_u8(r & CFG_RSVD_STX02_BIT6_ENABLE);
-    g_motor_link.stx02_bit3_src = bool_to_u8((r & CFG_RSVD_STX02_BIT3_DISABLE) == 0u);
-    g_motor_link.stx02_speed_gate = bool_to_u8(r & CFG_RSVD_STX02_SPEED_GATE_ENABLE);
+    stx02_patch(4u, power_level);
+    stx02_patch(5u, flags);
+    stx02_patch(12u, speed_limit_kph);
+    stx02_patch(13u, current_limit_A);
+    stx02_patch(18u, (uint8_t)(g_motor.err & 0x0Fu));
+    return g_motor_link_cfg.stx02_frame;
 }
 
 static uint16_t dmph_to_kph_x10(uint16_t dmph)
@@ -391,32 +540,11 @@ static uint16_t dmph_to_kph_x10(uint16_t dmph)
 
 static uint16_t stx02_speed_filter_update(uint16_t target_kph_x10)
 {
-    /* OEM v2.5.1 filter (`sub_8021574`):
-     * - filtered ramps toward target by a step = abs(delta)/5
-     * - if target==0 and step==0 in the "decreasing" case, force filtered=0 */
-    uint16_t filt = g_motor_link.stx02_speed_filt_kph_x10;
-    if (target_kph_x10 <= filt)
-    {
-        uint16_t diff = (uint16_t)(filt - target_kph_x10);
-        uint16_t step = (uint16_t)(diff / 5u);
-        if (step == 0u && target_kph_x10 == 0u)
-            filt = 0u;
-        else if (filt < step)
-            filt = 0u;
-        else
-            filt = (uint16_t)(filt - step);
-    }
-    else
-    {
-        uint16_t diff = (uint16_t)(target_kph_x10 - filt);
-        uint16_t step = (uint16_t)(diff / 5u);
-        uint32_t next = (uint32_t)filt + (uint32_t)step;
-        if (next >= target_kph_x10)
-            filt = target_kph_x10;
-        else
-            filt = (uint16_t)next;
-    }
-
+    /* OEM v2.5.1 filter (`sub_8021574`) ramps by abs(delta)/5 per 100 ms frame
+     * and forces 0 on a zero target. The shared IIR keeps that time constant at
+     * whatever cadence the closed-loop TX picked, without stalling on /5. */
+    speed_filter_rate_t rate = speed_filter_rate_for_interval_ms(g_motor_link.tx_interval_ms);
+    uint16_t filt = speed_iir_update(&g_motor_link.stx02_speed_iir, target_kph_x10, rate);
     g_motor_link.stx02_speed_filt_kph_x10 = filt;
     return filt;
 }
@@ -495,110 +623,124 @@ static void auth_compute_bytes(uint8_t *out_b1, uint8_t *out_b2)
     if (g_headlight_enabled)
         b1 |= (1u << 7);
 
-    /* Speed limit encoding: clamp to <= 51.0 km/h (0x1FE). */
-    uint16_t dmph = g_effective_cap_speed_dmph;
-    uint16_t kph_x10 = dmph_to_kph_x10(dmph);
-    if (kph_x10 > MOTOR_LINK_STX02_FRAME_LIMIT_KPH_X10)
-        kph_x10 = MOTOR_LINK_STX02_FRAME_LIMIT_KPH_X10;
-    uint16_t kph = (uint16_t)(kph_x10 / 10u);
-    int32_t field = (int32_t)kph - 20;
-    if (field < 0) field = 0;
-    if (field > 31) field = 31;
-
-    uint8_t wheel_code = wheel_code_from_wheel_mm(motor_link_effective_wheel_mm());
-    uint8_t b2 = (uint8_t)(((uint8_t)field & 0x1Fu) << 3) | (wheel_code & 0x07u);
+    motor_link_refresh_caps();
+    uint8_t b2 = (uint8_t)((g_motor_link_cfg.auth_speed_field & 0x1Fu) << 3) | (g_motor_link_cfg.wheel_code & 0x07u);
 
     *out_b1 = b1;
     *out_b2 = b2;
 }
 
-static void motor_link_observe_rx(void)
+static void motor_link_snapshot_rx(void)
 {
-    uint8_t frame[SHENGYI_MAX_FRAME_SIZE];
-    uint8_t len = 0u, op = 0u, seq = 0u;
-    motor_proto_t proto = MOTOR_PROTO_SHENGYI_3A1A;
-    uint16_t aux16 = 0u;
-    if (!motor_isr_copy_last_frame(frame, (uint8_t)sizeof(frame), &len, &op, &seq, &proto, &aux16))
-        return;
+    motor_isr_stats_t st;
+    motor_isr_get_stats(&st);
+    for (uint8_t p = 0; p < MOTOR_LINK_PROTO_SLOT_COUNT; ++p)
+        g_motor_link.rx_seen[p] = st.rx_by_proto[p];
+}
 
-    if (seq == g_motor_link.last_seq_seen)
-        return;
-    g_motor_link.last_seq_seen = seq;
+static void motor_link_lock(motor_proto_t proto)
+{
+    g_motor_link.locked = 1u;
+    g_motor_link.locked_proto = proto;
+    g_motor_link.v2_step = 0u;
+    g_motor_link.auth_phase = 0u;
+    motor_link_set_baud(baud_for_proto(proto));
+}
 
-    if ((uint8_t)proto < MOTOR_LINK_PROTO_SLOT_COUNT)
+static void motor_link_observe_rx(void)
+{
+    /* Every decoder in motor_isr sees every byte; score from its per-protocol
+     * counters so no frame is missed between main-loop passes. */
+    motor_isr_stats_t st;
+    motor_isr_get_stats(&st);
+    g_motor_link.rsp_avg_us = st.rsp_latency.avg_us;
+
+    for (uint8_t p = 0; p < MOTOR_LINK_PROTO_SLOT_COUNT; ++p)
     {
-        if (g_motor_link.proto_score[(uint8_t)proto] < 250u)
-            g_motor_link.proto_score[(uint8_t)proto]++;
+        uint32_t n = st.rx_by_proto[p] - g_motor_link.rx_seen[p];
+        g_motor_link.rx_seen[p] = st.rx_by_proto[p];
+        if (n == 0u)
+            continue;
 
-        if (g_motor_link.mode == MOTOR_LINK_MODE_AUTO && !g_motor_link.locked)
-        {
-            /* Conservative: require two frames of the same type. */
-            if (g_motor_link.proto_score[(uint8_t)proto] >= 2u)
-            {
-                g_motor_link.locked = 1u;
-                g_motor_link.locked_proto = proto;
-                g_motor_link.v2_step = 0u;
-                g_motor_link.auth_phase = 0u;
-                motor_link_set_baud(baud_for_proto(proto));
-            }
-        }
+        uint32_t score = g_motor_link.proto_score[p] + n * k_motor_link_lock_weight[p];
+        g_motor_link.proto_score[p] = (uint8_t)((score > 250u) ? 250u : score);
+
+        if (g_motor_link.mode == MOTOR_LINK_MODE_AUTO && !g_motor_link.locked &&
+            g_motor_link.proto_score[p] >= MOTOR_LINK_LOCK_SCORE)
+            motor_link_lock((motor_proto_t)p);
     }
 }
 
+static void motor_link_probe_9600_burst(void)
+{
+    /* Shengyi: a minimal 0x52 request. */
+    (void)motor_isr_queue_cmd(0u, false, false, false, false);
+
+    /* STX02: OEM-style 0x14 status packet (display->controller). */
+    (void)motor_isr_queue_frame(stx02_update_status_0x14(), MOTOR_LINK_STX02_FRAME_LEN);
+
+    /* AUTH: a basic 'F' frame. */
+    uint8_t pkt[8];
+    uint8_t b1 = 0u, b2 = 0u;
+    auth_compute_bytes(&b1, &b2);
+    uint8_t n = auth_build_frame(0x46u, b1, b2, pkt, (uint8_t)sizeof(pkt));
+    if (n)
+        (void)motor_isr_queue_frame(pkt, n);
+}
+
 static void motor_link_probe_tick(void)
 {
-    if (!motor_link_send_slot_due(g_ms, &g_motor_link.last_probe_ms, PROBE_INTERVAL_MS))
+    uint32_t now_ms = g_ms;
+    if (g_motor_link.sniff_state == MOTOR_LINK_SNIFF_LISTEN)
+    {
+        /* A controller that talks unprompted locks here without any TX. */
+        if ((uint32_t)(now_ms - g_motor_link.sniff_start_ms) < SNIFF_LISTEN_MS)
+            return;
+        g_motor_link.sniff_state = MOTOR_LINK_SNIFF_PROBE_9600;
+        g_motor_link.sniff_rounds = 0u;
+        g_motor_link.last_probe_ms = now_ms - PROBE_INTERVAL_MS;
+    }
+
+    /* One round at a time; never change baud under a queued frame. */
+    if ((uint32_t)(now_ms - g_motor_link.last_probe_ms) < PROBE_INTERVAL_MS || motor_isr_tx_busy())
         return;
+    g_motor_link.last_probe_ms = now_ms;
 
-    switch (g_motor_link.probe_step & 3u)
+    if (g_motor_link.sniff_state == MOTOR_LINK_SNIFF_PROBE_9600)
     {
-        case 0u:
-            /* Probe Shengyi: a minimal 0x52 request. */
-            (void)motor_isr_queue_cmd(0u, false, false, false, false);
-            break;
-        case 1u:
-        {
-            /* Probe STX02: OEM-style 0x14 status packet (display->controller). */
-            uint8_t pkt[32];
-            uint8_t n = stx02_build_status_0x14(pkt, (uint8_t)sizeof(pkt));
-            if (n)
-                (void)motor_isr_queue_frame(pkt, n);
-            break;
-        }
-        case 2u:
+        if (g_motor_link.sniff_rounds < SNIFF_ROUNDS_9600)
         {
-            /* Probe AUTH: send a basic 'F' frame. */
-            uint8_t b1 = 0u, b2 = 0u;
-            auth_compute_bytes(&b1, &b2);
-            uint8_t pkt[8];
-            uint8_t n = auth_build_frame(0x46u, b1, b2, pkt, (uint8_t)sizeof(pkt));
-            if (n)
-                (void)motor_isr_queue_frame(pkt, n);
-            break;
-        }
-        case 3u:
-        default:
-        {
-            /* Probe v2: request 0x11 0x90, expect 5-byte response. */
-            uint8_t req[2] = { 0x11u, 0x90u };
-            motor_isr_v2_expect(0x1190u, 5u);
-            (void)motor_isr_queue_frame(req, (uint8_t)sizeof(req));
-            break;
+            motor_link_probe_9600_burst();
+            g_motor_link.sniff_rounds++;
+            return;
         }
+        g_motor_link.sniff_state = MOTOR_LINK_SNIFF_PROBE_1200;
+        g_motor_link.sniff_rounds = 0u;
+        motor_link_set_baud(MOTOR_BAUD_V2);
     }
 
-    g_motor_link.probe_step++;
+    if (g_motor_link.sniff_rounds < SNIFF_ROUNDS_1200)
+    {
+        /* v2: request 0x11 0x90, expect 5-byte response. */
+        uint8_t req[2] = { 0x11u, 0x90u };
+        motor_isr_v2_expect(0x1190u, 5u);
+        (void)motor_isr_queue_frame(req, (uint8_t)sizeof(req));
+        g_motor_link.sniff_rounds++;
+        return;
+    }
+    g_motor_link.sniff_state = MOTOR_LINK_SNIFF_PROBE_9600;
+    g_motor_link.sniff_rounds = 0u;
+    motor_link_set_baud(MOTOR_BAUD_DEFAULT);
+    motor_link_probe_9600_burst();
+    g_motor_link.sniff_rounds++;
 }
 
 static void motor_link_stx02_tick(void)
 {
-    if (!motor_link_send_slot_due(g_ms, &g_motor_link.last_stx02_ms, STX02_INTERVAL_MS))
+    if (!motor_link_send_slot_due(g_ms, &g_motor_link.last_stx02_ms))
         return;
 
-    uint8_t pkt[32];
-    uint8_t n = stx02_build_status_0x14(pkt, (uint8_t)sizeof(pkt));
-    if (n)
-        (void)motor_isr_queue_frame(pkt, n);
+    (void)motor_isr_queue_frame(stx02_update_status_0x14(), MOTOR_LINK_STX02_FRAME_LEN);
 }
 
 static uint16_t v2_speed_limit_code(void)
@@ -632,7 +774,7 @@ static void motor_link_v2_send_req_161f(uint16_t code)
 
 static void motor_link_v2_tick(void)
 {
-    if (!motor_link_send_slot_due(g_ms, &g_motor_link.last_v2_ms, V2_INTERVAL_MS))
+    if (!motor_link_send_slot_due(g_ms, &g_motor_link.last_v2_ms))
         return;
 
     switch (g_motor_link.v2_step)
@@ -642,7 +784,7 @@ static void motor_link_v2_tick(void)
             g_motor_link.v2_step++;
             break;
         case 1u:
-            motor_link_v2_send_req_161f(v2_speed_limit_code());
+            motor_link_v2_send_req_161f(g_motor_link_cfg.v2_speed_code);
             g_motor_link.v2_step++;
             break;
         case 2u:
@@ -675,7 +817,7 @@ static void motor_link_v2_tick(void)
 
 static void motor_link_auth_tick(void)
 {
-    if (!motor_link_send_slot_due(g_ms, &g_motor_link.last_auth_ms, AUTH_INTERVAL_MS))
+    if (!motor_link_send_slot_due(g_ms, &g_motor_link.last_auth_ms))
         return;
 
     uint8_t b1 = 0u, b2 = 0u;
@@ -721,9 +863,11 @@ void motor_link_periodic_send_tick(void)
     }
 
     motor_proto_t active = motor_link_get_active_proto();
+    motor_link_tx_interval_update(active);
     switch (active)
     {
         case MOTOR_PROTO_SHENGYI_3A1A:
+            shengyi_set_status_interval_ms(g_motor_link.tx_interval_ms);
             shengyi_periodic_send_tick();
             break;
         case MOTOR_PROTO_STX02_XOR:
@@ -24,6 +24,13 @@ typedef enum {
 
 void motor_link_init(void);
 
+/*
+ * Rebuild the wire constants derived from g_config_active (wheel size codes,
+ * STX02 option bits and frame template, v2 speed code). Call after anything
+ * writes g_config_active; periodic sends only patch their dynamic bytes.
+ */
+void motor_link_apply_config(void);
+
 /* Called from the main loop (not ISR). */
 void motor_link_periodic_send_tick(void);
 
@@ -34,6 +41,18 @@ void motor_link_set_mode(motor_link_mode_t mode);
 motor_proto_t motor_link_get_active_proto(void);
 bool motor_link_is_locked(void);
 
+/*
+ * Closed-loop TX cadence per protocol. A request goes out min_ms after the
+ * previous one once its reply has been decoded; while a reply is outstanding
+ * the next send waits out the learned response window (about twice the mean
+ * controller latency), never longer than max_ms. Returns false if
+ * min_ms is 0 or above max_ms.
+ */
+bool motor_link_set_tx_rate(motor_proto_t proto, uint16_t min_ms, uint16_t max_ms);
+
+/* Interval currently applied to the active protocol's status requests. */
+uint16_t motor_link_tx_interval_ms(void);
+
 /* Handle OEM 0xAB protocol switch command from motor controller.
  * proto_idx: 0=Shengyi, 1=STX02, 2=V2short, 3=Tongsheng.
  * Reinitializes the protocol stack. */
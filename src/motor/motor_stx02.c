@@ -10,27 +10,25 @@
 #define STX02_CHECKSUM_BYTES          1u
 #define STX02_MIN_FRAME_BYTES         (STX02_HEADER_BYTES + STX02_MIN_PAYLOAD_LEN + STX02_CHECKSUM_BYTES)
 
-static uint8_t stx02_err_from_flags(uint8_t flags)
-{
-    /*
-     * OEM v2.5.1 maps a priority-ordered error code from the cmd==1 flags byte.
-     * Evidence: APP_process_motor_response_packet @ 0x08021CA8:
-     * - bit1 => 2
-     * - bit3 => 6
-     * - bit0 => 7
-     * - bit5 => 8
-     * - bit4 => 9
-     * - bit6 => 20
-     * - else => 0
-     */
-    if (flags & (1u << 1)) return 2u;
-    if (flags & (1u << 3)) return 6u;
-    if (flags & (1u << 0)) return 7u;
-    if (flags & (1u << 5)) return 8u;
-    if (flags & (1u << 4)) return 9u;
-    if (flags & (1u << 6)) return 20u;
-    return 0u;
-}
+/*
+ * OEM v2.5.1 maps a priority-ordered error code from the cmd==1 flags byte.
+ * Evidence: APP_process_motor_response_packet @ 0x08021CA8:
+ * - bit1 => 2
+ * - bit3 => 6
+ * - bit0 => 7
+ * - bit5 => 8
+ * - bit4 => 9
+ * - bit6 => 20
+ * - else => 0
+ * Expanded at compile time into a table over bits 0..6 (bit7 never maps).
+ */
+#define STX02_ERR(f) (((f) & 0x02u) ? 2u : ((f) & 0x08u) ? 6u : ((f) & 0x01u) ? 7u : \
+                      ((f) & 0x20u) ? 8u : ((f) & 0x10u) ? 9u : ((f) & 0x40u) ? 20u : 0u)
+#define STX02_ERR4(f) STX02_ERR(f), STX02_ERR((f) + 1u), STX02_ERR((f) + 2u), STX02_ERR((f) + 3u)
+#define STX02_ERR16(f) STX02_ERR4(f), STX02_ERR4((f) + 4u), STX02_ERR4((f) + 8u), STX02_ERR4((f) + 12u)
+#define STX02_ERR64(f) STX02_ERR16(f), STX02_ERR16((f) + 16u), STX02_ERR16((f) + 32u), STX02_ERR16((f) + 48u)
+
+static const uint8_t k_stx02_err[128] = { STX02_ERR64(0u), STX02_ERR64(64u) };
 
 bool motor_stx02_decode_cmd1(const uint8_t *frame, uint8_t len, motor_stx02_cmd1_t *out)
 {
@@ -72,7 +70,7 @@ bool motor_stx02_decode_cmd1(const uint8_t *frame, uint8_t len, motor_stx02_cmd1
         dA = 32767u;
 
     out->flags = flags;
-    out->err_code = stx02_err_from_flags(flags);
+    out->err_code = k_stx02_err[flags & 0x7Fu];
     out->flag_bit2 = (uint8_t)((flags >> 2) & 1u);
     out->flag_bit7 = (uint8_t)((flags >> 7) & 1u);
     out->current_dA = (int16_t)dA;
@@ -6,15 +6,20 @@
  */
 
 #include "shengyi.h"
+
+#include <string.h>
+
 #include "../control/control.h"
 #include "../power/power.h"
 #include "battery_soc.h"
 #include "app_data.h"
 #include "../config/config.h"
 #include "motor_isr.h"
+#include "motor_link.h"
 #include "../../drivers/uart.h"
 #include "../../platform/hw.h"
 #include "../util/bool_to_u8.h"
+#include "../core/speed_filter.h"
 
 extern volatile uint32_t g_ms;
 
@@ -29,7 +34,8 @@ static uint32_t g_shengyi_speed_last_ms;
 static uint32_t g_shengyi_status_last_ms;
 static uint16_t g_shengyi_speed_target_dmph;
 static uint16_t g_shengyi_speed_smoothed_dmph;
-static uint16_t g_shengyi_speed_step_dmph;
+static speed_iir_t g_shengyi_speed_filt;
+static uint16_t g_shengyi_status_interval_ms;
 
 #define SHENGYI_CFG_INTERVAL_MS 500u
 #define SHENGYI_STATUS_INTERVAL_MS 100u
@@ -81,6 +87,21 @@ typedef struct {
 
 static shengyi_oem_config_t g_shengyi_cfg;
 
+#define SHENGYI_FRAME_0x53_LEN (7u + 8u)
+#define SHENGYI_FRAME_0xC3_LEN (47u + 8u)
+
+/* Frames and values that depend only on g_shengyi_cfg, rebuilt by
+ * shengyi_cfg_changed() (defaults, 0xC0) rather than per 0x53 retry, 0xC2
+ * reply or battery-low check. */
+static struct {
+    uint8_t frame_0x53[SHENGYI_FRAME_0x53_LEN];
+    uint8_t frame_0xC3[SHENGYI_FRAME_0xC3_LEN];
+    uint8_t nominal_v;
+} g_shengyi_derived;
+
+static size_t shengyi_encode_frame_0xC3(uint8_t *out, size_t cap);
+static size_t shengyi_encode_frame_0x53(uint8_t *out, size_t cap);
+
 static uint16_t shengyi_kph_x10_to_dmph(uint16_t kph_x10)
 {
     uint32_t dmph = ((uint32_t)kph_x10 * 62137u + 50000u) / 100000u;
@@ -95,6 +116,21 @@ static void shengyi_apply_oem_limits(void)
     g_config_active.cap_speed_dmph = shengyi_kph_x10_to_dmph(g_shengyi_cfg.n320);
     if (g_shengyi_cfg.n2355)
         g_config_active.wheel_mm = g_shengyi_cfg.n2355;
+    /* Keep the RAM copy self-consistent; profile switches patch its CRC. */
+    g_config_active.crc32 = 0;
+    g_config_active.crc32 = config_crc_expected(&g_config_active);
+}
+
+static void shengyi_cfg_changed(void)
+{
+    uint8_t v = g_shengyi_cfg.n48;
+    g_shengyi_derived.nominal_v = (v == 24u || v == 36u || v == 48u) ? v : 0u;
+    (void)shengyi_encode_frame_0x53(g_shengyi_derived.frame_0x53, sizeof(g_shengyi_derived.frame_0x53));
+    (void)shengyi_encode_frame_0xC3(g_shengyi_derived.frame_0xC3, sizeof(g_shengyi_derived.frame_0xC3));
+
+    /* The OEM limits land in g_config_active, so the link constants follow. */
+    shengyi_apply_oem_limits();
+    motor_link_apply_config();
 }
 
 void shengyi_notify_rx_opcode(uint8_t opcode)
@@ -111,13 +147,6 @@ uint8_t shengyi_handshake_ok(void)
 void shengyi_speed_update_target(uint16_t speed_dmph)
 {
     g_shengyi_speed_target_dmph = speed_dmph;
-    if (g_shengyi_speed_target_dmph < g_shengyi_speed_smoothed_dmph) {
-        g_shengyi_speed_step_dmph = (uint16_t)((g_shengyi_speed_smoothed_dmph - g_shengyi_speed_target_dmph) / 5u);
-        if (g_shengyi_speed_step_dmph == 0u && g_shengyi_speed_target_dmph == 0u)
-            g_shengyi_speed_smoothed_dmph = 0u;
-    } else {
-        g_shengyi_speed_step_dmph = (uint16_t)((g_shengyi_speed_target_dmph - g_shengyi_speed_smoothed_dmph) / 5u);
-    }
 }
 
 static void shengyi_speed_smooth_tick(uint32_t now_ms)
@@ -125,17 +154,9 @@ static void shengyi_speed_smooth_tick(uint32_t now_ms)
     if ((uint32_t)(now_ms - g_shengyi_speed_last_ms) < SHENGYI_SPEED_SMOOTH_MS)
         return;
     g_shengyi_speed_last_ms = now_ms;
-
-    if (g_shengyi_speed_target_dmph <= g_shengyi_speed_smoothed_dmph) {
-        if (g_shengyi_speed_smoothed_dmph < g_shengyi_speed_step_dmph)
-            g_shengyi_speed_smoothed_dmph = 0u;
-        else
-            g_shengyi_speed_smoothed_dmph = (uint16_t)(g_shengyi_speed_smoothed_dmph - g_shengyi_speed_step_dmph);
-    } else {
-        g_shengyi_speed_smoothed_dmph = (uint16_t)(g_shengyi_speed_smoothed_dmph + g_shengyi_speed_step_dmph);
-        if (g_shengyi_speed_smoothed_dmph >= g_shengyi_speed_target_dmph)
-            g_shengyi_speed_smoothed_dmph = g_shengyi_speed_target_dmph;
-    }
+    /* OEM ramps by delta/5 per 100 ms tick; same IIR without the integer stall. */
+    g_shengyi_speed_smoothed_dmph = speed_iir_update(&g_shengyi_speed_filt, g_shengyi_speed_target_dmph,
+                                                     SPEED_FILTER_RATE_10HZ);
 }
 
 static uint8_t shengyi_oem_wheel_code(uint16_t n290)
@@ -244,13 +265,12 @@ static void shengyi_oem_config_defaults(void)
     g_shengyi_cfg.n40 = 40u;
     g_shengyi_cfg.n65 = 65u;
     g_shengyi_cfg.n49 = 49u;
-    shengyi_apply_oem_limits();
+    shengyi_cfg_changed();
 }
 
 uint8_t shengyi_nominal_v(void)
 {
-    uint8_t v = g_shengyi_cfg.n48;
-    return (v == 24u || v == 36u || v == 48u) ? v : 0u;
+    return g_shengyi_derived.nominal_v;
 }
 
 uint8_t shengyi_batt_soc_pct_from_dV(int16_t batt_dV)
@@ -319,6 +339,16 @@ void shengyi_request_update(uint8_t force)
 /* -------------------------------------------------------------
  * Periodic send tick
  * ------------------------------------------------------------- */
+static uint32_t shengyi_status_interval_ms(void)
+{
+    return g_shengyi_status_interval_ms ? g_shengyi_status_interval_ms : SHENGYI_STATUS_INTERVAL_MS;
+}
+
+void shengyi_set_status_interval_ms(uint16_t interval_ms)
+{
+    g_shengyi_status_interval_ms = interval_ms;
+}
+
 void shengyi_periodic_send_tick(void)
 {
     shengyi_speed_smooth_tick(g_ms);
@@ -326,16 +356,13 @@ void shengyi_periodic_send_tick(void)
 
     if (!g_shengyi_handshake_ok) {
         if ((uint32_t)(now_ms - g_shengyi_cfg_last_ms) >= SHENGYI_CFG_INTERVAL_MS || g_shengyi_req_force) {
-            uint8_t frame[16];
-            size_t len = shengyi_build_frame_0x53(frame, sizeof(frame));
-            if (len)
-                motor_isr_queue_frame(frame, (uint8_t)len);
+            motor_isr_queue_frame(g_shengyi_derived.frame_0x53, (uint8_t)SHENGYI_FRAME_0x53_LEN);
             g_shengyi_cfg_last_ms = now_ms;
             g_shengyi_req_pending = 0u;
             g_shengyi_req_force = 0u;
             return;
         }
-        if ((uint32_t)(now_ms - g_shengyi_status_last_ms) >= SHENGYI_STATUS_INTERVAL_MS) {
+        if ((uint32_t)(now_ms - g_shengyi_status_last_ms) >= shengyi_status_interval_ms()) {
             shengyi_send_0x52_req(0u, 0u, 0u, 0u, 0u);
             g_shengyi_status_last_ms = now_ms;
         }
@@ -343,7 +370,7 @@ void shengyi_periodic_send_tick(void)
     }
 
     if (!g_shengyi_req_pending && !g_shengyi_req_force &&
-        (uint32_t)(now_ms - g_shengyi_status_last_ms) < SHENGYI_STATUS_INTERVAL_MS)
+        (uint32_t)(now_ms - g_shengyi_status_last_ms) < shengyi_status_interval_ms())
         return;
     uint8_t assist = shengyi_assist_level_mapped();
     uint8_t flags = shengyi_build_flags();
@@ -465,8 +492,10 @@ int shengyi_apply_config_c0(const uint8_t *payload, uint8_t len)
 
     if (payload[8] == 3u || payload[8] == 5u || payload[8] == 9u) {
         g_shengyi_cfg.n5_0 = payload[8];
-        g_vgears.count = payload[8];
-        vgear_generate_scales(&g_vgears);
+        if (g_vgears.count != payload[8]) {
+            g_vgears.count = payload[8];
+            vgear_generate_scales(&g_vgears);
+        }
         if (g_active_vgear == 0u || g_active_vgear > g_vgears.count)
             g_active_vgear = g_vgears.count;
     }
@@ -518,7 +547,7 @@ int shengyi_apply_config_c0(const uint8_t *payload, uint8_t len)
     g_shengyi_cfg.n65 = payload[50];
     g_shengyi_cfg.n49 = payload[51];
 
-    shengyi_apply_oem_limits();
+    shengyi_cfg_changed();
     return 1;
 }
 
@@ -530,6 +559,22 @@ size_t shengyi_build_frame_0xC1(uint8_t status, uint8_t *out, size_t cap)
 }
 
 size_t shengyi_build_frame_0xC3(uint8_t *out, size_t cap)
+{
+    if (!out || cap < SHENGYI_FRAME_0xC3_LEN)
+        return 0;
+    memcpy(out, g_shengyi_derived.frame_0xC3, SHENGYI_FRAME_0xC3_LEN);
+    return SHENGYI_FRAME_0xC3_LEN;
+}
+
+size_t shengyi_build_frame_0x53(uint8_t *out, size_t cap)
+{
+    if (!out || cap < SHENGYI_FRAME_0x53_LEN)
+        return 0;
+    memcpy(out, g_shengyi_derived.frame_0x53, SHENGYI_FRAME_0x53_LEN);
+    return SHENGYI_FRAME_0x53_LEN;
+}
+
+static size_t shengyi_encode_frame_0xC3(uint8_t *out, size_t cap)
 {
     uint8_t payload[47];
     payload[0] = g_shengyi_cfg.n5;
@@ -582,7 +627,7 @@ size_t shengyi_build_frame_0xC3(uint8_t *out, size_t cap)
     return shengyi_frame_build(0xC3u, payload, (uint8_t)sizeof(payload), out, cap);
 }
 
-size_t shengyi_build_frame_0x53(uint8_t *out, size_t cap)
+static size_t shengyi_encode_frame_0x53(uint8_t *out, size_t cap)
 {
     uint8_t payload[7];
     uint8_t b0 = (uint8_t)(g_shengyi_cfg.n2_2 & 0x3Fu);
@@ -653,9 +698,10 @@ void shengyi_init(void)
     g_shengyi_cfg_last_ms = 0;
     g_shengyi_speed_last_ms = 0;
     g_shengyi_status_last_ms = 0;
+    g_shengyi_status_interval_ms = 0;
     g_shengyi_speed_target_dmph = 0;
     g_shengyi_speed_smoothed_dmph = 0;
-    g_shengyi_speed_step_dmph = 0;
+    speed_iir_reset(&g_shengyi_speed_filt, 0u);
     shengyi_oem_config_defaults();
 }
 
@@ -68,6 +68,10 @@ void shengyi_speed_update_target(uint16_t speed_dmph);
 /* Periodic tick - sends pending updates */
 void shengyi_periodic_send_tick(void);
 
+/* Status (0x52) request cadence used by the periodic tick; 0 restores the
+ * 100 ms default. motor_link drives this from the controller's reply timing. */
+void shengyi_set_status_interval_ms(uint16_t interval_ms);
+
 /* Calculate checksum for frame */
 static inline uint16_t shengyi_checksum16(const uint8_t *buf, size_t len)
 {
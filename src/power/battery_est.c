@@ -0,0 +1,233 @@
+#include "battery_est.h"
+
+#include "battery_soc.h"
+
+#define EST_SOC_FULL        10000
+#define EST_R_DEFAULT_MOHM  150
+#define EST_R_MIN_MOHM      20
+#define EST_R_MAX_MOHM      800
+#define EST_R_STEP_DA       30      /* 3 A between block means */
+#define EST_R_EWMA_DIV      8
+#define EST_REST_MAX_DA     20      /* |I| <= 2 A reads the curve */
+#define EST_DA_MAX          2000    /* sanity clamp, 200 A */
+
+/* Variances in (0.01 %)^2. */
+#define EST_VAR_INIT        (400u * 400u)   /* first read, compensated with the default R */
+#define EST_VAR_MEAS        (300u * 300u)   /* one curve read at rest */
+#define EST_VAR_MAX         (2000u * 2000u)
+#define EST_Q_BLOCK         16u             /* drift per block */
+#define EST_Q_PER_X100      4u              /* per 0.01 % coulomb-counted */
+
+typedef struct
+{
+    uint8_t nominal_v;
+    uint8_t valid;
+    uint8_t have_prev;
+    uint16_t block_n;
+    int32_t cap_mAs;
+    int32_t charge_mAs;
+    int32_t rem_mAms;          /* sub-mAs remainder of the integration */
+    int32_t r_mohm;
+    uint32_t var;
+    uint32_t last_ms;
+    uint32_t block_start_ms;
+    uint32_t block_sum_mv;
+    int32_t block_sum_dA;
+    int32_t block_charge0;
+    int32_t prev_mv;
+    int32_t prev_dA;
+    uint16_t ocv_soc_x100;
+    uint32_t ocv_updates;
+    uint32_t r_updates;
+} est_state_t;
+
+static est_state_t g_est;
+
+static uint8_t est_nominal_valid(uint8_t v)
+{
+    return (v == 24u || v == 36u || v == 48u) ? 1u : 0u;
+}
+
+/* Same thresholds as the curve selection in battery_soc.c, fixed once. */
+static uint8_t est_infer_nominal(uint32_t batt_mv)
+{
+    if (batt_mv >= 42000u)
+        return 48u;
+    if (batt_mv >= 30000u)
+        return 36u;
+    return 24u;
+}
+
+static int32_t est_abs(int32_t v)
+{
+    return (v < 0) ? -v : v;
+}
+
+static int32_t est_soc_x100(void)
+{
+    if (g_est.cap_mAs <= 0)
+        return 0;
+    return (int32_t)(((int64_t)g_est.charge_mAs * EST_SOC_FULL) / g_est.cap_mAs);
+}
+
+static void est_clamp_charge(void)
+{
+    if (g_est.charge_mAs < 0)
+        g_est.charge_mAs = 0;
+    if (g_est.charge_mAs > g_est.cap_mAs)
+        g_est.charge_mAs = g_est.cap_mAs;
+}
+
+/* Curve SOC at the terminal voltage lifted by the I*R sag. */
+static int32_t est_ocv_soc_x100(int32_t mv, int32_t dA)
+{
+    /* dA * mOhm is 0.1 mV. */
+    int32_t ocv_mv = mv + (dA * g_est.r_mohm) / 10;
+    if (ocv_mv < 0)
+        ocv_mv = 0;
+    return battery_soc_x100_from_mv((uint32_t)ocv_mv, g_est.nominal_v);
+}
+
+void battery_est_reset(uint8_t nominal_v)
+{
+    g_est = (est_state_t){0};
+    g_est.nominal_v = est_nominal_valid(nominal_v) ? nominal_v : 0u;
+    g_est.r_mohm = EST_R_DEFAULT_MOHM;
+}
+
+static void est_start(uint32_t now_ms, uint32_t batt_mv, int32_t dA)
+{
+    if (!g_est.nominal_v)
+        g_est.nominal_v = est_infer_nominal(batt_mv);
+    uint32_t cap_mAh = (BATTERY_EST_PACK_WH * 1000u) / g_est.nominal_v;
+    g_est.cap_mAs = (int32_t)(cap_mAh * 3600u);
+    g_est.ocv_soc_x100 = (uint16_t)est_ocv_soc_x100((int32_t)batt_mv, dA);
+    g_est.charge_mAs = (int32_t)(((int64_t)g_est.ocv_soc_x100 * g_est.cap_mAs) / EST_SOC_FULL);
+    g_est.var = EST_VAR_INIT;
+    g_est.last_ms = now_ms;
+    g_est.block_start_ms = now_ms;
+    g_est.block_charge0 = g_est.charge_mAs;
+    g_est.valid = 1u;
+}
+
+/* Block end: resistance from the current step, then the curve blend. */
+static void est_block(uint32_t now_ms)
+{
+    int32_t mv = (int32_t)(g_est.block_sum_mv / g_est.block_n);
+    int32_t dA = g_est.block_sum_dA / (int32_t)g_est.block_n;
+
+    if (g_est.have_prev)
+    {
+        int32_t di = dA - g_est.prev_dA;
+        if (est_abs(di) >= EST_R_STEP_DA)
+        {
+            int32_t r = ((g_est.prev_mv - mv) * 10) / di;
+            if (r >= EST_R_MIN_MOHM && r <= EST_R_MAX_MOHM)
+            {
+                g_est.r_mohm += (r - g_est.r_mohm) / EST_R_EWMA_DIV;
+                g_est.r_updates++;
+            }
+        }
+    }
+    g_est.prev_mv = mv;
+    g_est.prev_dA = dA;
+    g_est.have_prev = 1u;
+
+    int32_t ocv = est_ocv_soc_x100(mv, dA);
+    g_est.ocv_soc_x100 = (uint16_t)ocv;
+
+    int32_t counted = (int32_t)(((int64_t)est_abs(g_est.charge_mAs - g_est.block_charge0) * EST_SOC_FULL) /
+                                g_est.cap_mAs);
+    uint32_t var = g_est.var + EST_Q_BLOCK + (uint32_t)counted * EST_Q_PER_X100;
+    if (var > EST_VAR_MAX)
+        var = EST_VAR_MAX;
+
+    if (est_abs(dA) <= EST_REST_MAX_DA)
+    {
+        /* Scalar Kalman step: K = P / (P + R), P' = P * R / (P + R). */
+        int32_t soc = est_soc_x100();
+        int64_t corr = ((int64_t)(ocv - soc) * var) / (int64_t)(var + EST_VAR_MEAS);
+        g_est.charge_mAs += (int32_t)((corr * g_est.cap_mAs) / EST_SOC_FULL);
+        est_clamp_charge();
+        var = (uint32_t)(((uint64_t)var * EST_VAR_MEAS) / (var + EST_VAR_MEAS));
+        g_est.ocv_updates++;
+    }
+    g_est.var = var;
+
+    g_est.block_start_ms = now_ms;
+    g_est.block_sum_mv = 0u;
+    g_est.block_sum_dA = 0;
+    g_est.block_n = 0u;
+    g_est.block_charge0 = g_est.charge_mAs;
+}
+
+void battery_est_update(uint32_t now_ms, uint32_t batt_mv, int16_t batt_dA, uint8_t have_current)
+{
+    if (batt_mv == 0u)
+        return;
+    int32_t dA = have_current ? batt_dA : 0;
+    if (dA > EST_DA_MAX)
+        dA = EST_DA_MAX;
+    if (dA < -EST_DA_MAX)
+        dA = -EST_DA_MAX;
+
+    if (!g_est.valid)
+        est_start(now_ms, batt_mv, dA);
+
+    uint32_t dt = now_ms - g_est.last_ms;
+    g_est.last_ms = now_ms;
+    if (dt > BATTERY_EST_BLOCK_MS)
+    {
+        /* Gap: nothing is known about the charge drawn in between. */
+        g_est.block_start_ms = now_ms;
+        g_est.block_sum_mv = 0u;
+        g_est.block_sum_dA = 0;
+        g_est.block_n = 0u;
+        g_est.block_charge0 = g_est.charge_mAs;
+        g_est.have_prev = 0u;
+    }
+    else if (dA)
+    {
+        /* dA * 100 = mA; positive current drains the pack. */
+        g_est.rem_mAms -= dA * 100 * (int32_t)dt;
+        int32_t whole = g_est.rem_mAms / 1000;
+        g_est.charge_mAs += whole;
+        g_est.rem_mAms -= whole * 1000;
+        est_clamp_charge();
+    }
+
+    g_est.block_sum_mv += batt_mv;
+    g_est.block_sum_dA += dA;
+    g_est.block_n++;
+    if ((uint32_t)(now_ms - g_est.block_start_ms) >= BATTERY_EST_BLOCK_MS)
+        est_block(now_ms);
+}
+
+uint8_t battery_est_soc_pct(void)
+{
+    if (!g_est.valid)
+        return 0u;
+    return (uint8_t)((est_soc_x100() + 50) / 100);
+}
+
+uint16_t battery_est_remaining_wh(void)
+{
+    if (!g_est.valid)
+        return 0u;
+    return (uint16_t)(((uint32_t)est_soc_x100() * BATTERY_EST_PACK_WH + 5000u) / 10000u);
+}
+
+void battery_est_get_info(battery_est_info_t *out)
+{
+    if (!out)
+        return;
+    out->soc_x100 = (uint16_t)est_soc_x100();
+    out->ocv_soc_x100 = g_est.ocv_soc_x100;
+    out->remaining_wh = battery_est_remaining_wh();
+    out->r_mohm = (uint16_t)g_est.r_mohm;
+    out->var = g_est.var;
+    out->ocv_updates = g_est.ocv_updates;
+    out->r_updates = g_est.r_updates;
+    out->nominal_v = g_est.nominal_v;
+    out->valid = g_est.valid;
+}
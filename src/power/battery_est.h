@@ -0,0 +1,50 @@
+#ifndef BATTERY_EST_H
+#define BATTERY_EST_H
+
+#include <stdint.h>
+
+/*
+ * Battery state estimator (fixed point).
+ *
+ * Coulomb counting on the pack current carries the SOC between readings of
+ * the OEM OCV curve (battery_soc.c). Under load the terminal voltage sags by
+ * I*R, so the curve is read at v + I*R, with R estimated online from current
+ * steps, and only blended in with a Kalman-style gain while the current is
+ * low. The SOC therefore moves smoothly under load and settles on the curve
+ * at rest; consumers use it and the remaining Wh as-is.
+ *
+ * Fed from the ADC battery sample, or from the controller's status voltage
+ * when the ADC is not sampling.
+ */
+
+#define BATTERY_EST_PACK_WH   500u   /* nominal pack energy */
+#define BATTERY_EST_BLOCK_MS  1000u  /* OCV and resistance update period */
+
+typedef struct {
+    uint16_t soc_x100;       /* 0..10000 */
+    uint16_t ocv_soc_x100;   /* sag-compensated curve SOC, last block */
+    uint16_t remaining_wh;
+    uint16_t r_mohm;         /* internal resistance estimate */
+    uint32_t var;            /* SOC variance, (0.01 %)^2 */
+    uint32_t ocv_updates;    /* blocks the curve was blended in */
+    uint32_t r_updates;      /* current steps that moved the R estimate */
+    uint8_t nominal_v;       /* 24/36/48; resolved from the first sample */
+    uint8_t valid;
+} battery_est_info_t;
+
+/* Forget the state; nominal_v 24/36/48, anything else infers on the first sample. */
+void battery_est_reset(uint8_t nominal_v);
+
+/*
+ * One voltage sample. batt_dA is positive when discharging; with
+ * have_current == 0 the estimator is a slow filter on the curve SOC.
+ * Samples more than a block apart are not integrated across the gap.
+ */
+void battery_est_update(uint32_t now_ms, uint32_t batt_mv, int16_t batt_dA, uint8_t have_current);
+
+/* 0..100; 0 until the first sample. */
+uint8_t battery_est_soc_pct(void);
+uint16_t battery_est_remaining_wh(void);
+void battery_est_get_info(battery_est_info_t *out);
+
+#endif /* BATTERY_EST_H */
@@ -1,14 +1,26 @@
 #include "battery_monitor.h"
 
 #include "battery_soc.h"
-#include "drivers/spi_flash.h"
+#include "battery_est.h"
+#include "storage/oem_config.h"
+#include "util/byteorder.h"
 #include "platform/mmio.h"
 #include "platform/hw.h"
 #include "src/motor/motor_link.h"
 #include "app_data.h"
 #include "src/power/power.h"
+#include "src/bus/bus.h"
 #include "../util/bool_to_u8.h"
 
+#ifndef HOST_TEST
+#include "platform/adc_dma.h"
+#else
+/* Host builds model single conversions only. */
+#define PLATFORM_ADC_IN_BATTERY 0u
+static uint8_t platform_adc_dma_active(void) { return 0u; }
+static uint8_t platform_adc_dma_read(uint8_t input, uint16_t *out) { (void)input; (void)out; return 0u; }
+#endif
+
 /* ADC1 base for AT32F403A (STM32F1-ish register layout). */
 #define ADC1_BASE 0x40012400u
 #define ADC_SR    (ADC1_BASE + 0x00u)
@@ -25,13 +37,6 @@
 #define BATTERY_FILTER_MIN_SAMPLES 3u
 #define BATTERY_FILTER_TRIMMED_DIVISOR ((uint8_t)(BATTERY_FILTER_SIZE - 2u))
 
-/* OEM config block mirrors (see src/config/config.c). */
-#define OEM_CFG_PRIMARY_ADDR 0x003FD000u
-#define OEM_CFG_BACKUP_ADDR  0x003FB000u
-#define OEM_CFG_SIZE         0xD0u
-#define OEM_CFG_OFF_N69300   0x78u /* little-endian u32 */
-#define OEM_CFG_OFF_N48      0x80u /* u8: 24/36/48 */
-
 /* OEM accepted range (see sub_801AFxx). */
 #define OEM_N69300_MIN 0xFE4Cu /* 65100 */
 #define OEM_N69300_MAX 0x11F1Cu /* 73500 */
@@ -54,28 +59,6 @@ static struct {
     batt_filter_t filt;
 } g_batt;
 
-static uint32_t load_le32(const uint8_t *p)
-{
-    return (uint32_t)p[0]
-         | ((uint32_t)p[1] << 8)
-         | ((uint32_t)p[2] << 16)
-         | ((uint32_t)p[3] << 24);
-}
-
-static int oem_blob_valid(const uint8_t *buf)
-{
-    uint8_t all_zero = 1u;
-    uint8_t all_ff = 1u;
-    for (uint32_t i = 0; i < OEM_CFG_SIZE; ++i)
-    {
-        if (buf[i] != 0u)
-            all_zero = 0u;
-        if (buf[i] != 0xFFu)
-            all_ff = 0u;
-    }
-    return (all_zero || all_ff) ? 0 : 1;
-}
-
 static void batt_filter_reset(batt_filter_t *f)
 {
     if (!f)
@@ -132,17 +115,12 @@ static uint16_t batt_filter_push(batt_filter_t *f, uint16_t sample)
 
 static void battery_monitor_load_oem_params(void)
 {
-    uint8_t buf[OEM_CFG_SIZE];
     g_batt.n69300 = OEM_N69300_DEFAULT;
     g_batt.nominal_v = 0u; /* infer */
 
-    spi_flash_read(OEM_CFG_PRIMARY_ADDR, buf, OEM_CFG_SIZE);
-    if (!oem_blob_valid(buf))
-    {
-        spi_flash_read(OEM_CFG_BACKUP_ADDR, buf, OEM_CFG_SIZE);
-        if (!oem_blob_valid(buf))
-            return;
-    }
+    const uint8_t *buf = oem_config_blob();
+    if (!buf)
+        return;
 
     uint32_t n69300 = load_le32(&buf[OEM_CFG_OFF_N69300]);
     if (n69300 >= (uint32_t)OEM_N69300_MIN && n69300 <= (uint32_t)OEM_N69300_MAX)
@@ -183,6 +161,8 @@ void battery_monitor_init(void)
     g_batt.last_update_ms = 0u;
     batt_filter_reset(&g_batt.filt);
     battery_monitor_load_oem_params();
+    battery_soc_init();
+    battery_est_reset(g_batt.nominal_v);
 
     /* Start conversions so DR will have sane data when we begin sampling. */
     adc_start_conversion();
@@ -198,16 +178,24 @@ void battery_monitor_tick(uint32_t now_ms)
     {
         g_batt.last_req_ms = now_ms;
         g_batt.req_pending = 1u;
-        adc_start_conversion();
+        if (!platform_adc_dma_active())
+            adc_start_conversion();
     }
 
     if (!g_batt.req_pending)
         return;
-    if (!adc_eoc())
-        return;
 
-    uint16_t raw = adc_read_dr_12b();
+    /* The DMA scan keeps an 8 ms mean ready; single conversions are the
+     * fallback when it is not running (host builds, DMA error). */
+    uint16_t raw;
+    if (!platform_adc_dma_read(PLATFORM_ADC_IN_BATTERY, &raw))
+    {
+        if (!adc_eoc())
+            return;
+        raw = adc_read_dr_12b();
+    }
     g_batt.req_pending = 0u;
+    bus_session_on_adc(PLATFORM_ADC_IN_BATTERY, raw);
 
     uint16_t filt = batt_filter_push(&g_batt.filt, raw);
     uint32_t batt_mv = ((uint32_t)filt * (uint32_t)g_batt.n69300) >> 12;
@@ -217,11 +205,14 @@ void battery_monitor_tick(uint32_t now_ms)
     g_input_caps |= INPUT_CAP_BATT_V;
     g_inputs.last_ms = now_ms;
     g_batt.last_update_ms = now_ms;
+    battery_est_update(now_ms, batt_mv, g_inputs.battery_dA,
+                       bool_to_u8((g_input_caps & INPUT_CAP_BATT_I) != 0u));
 
+    /* STX02 and AUTH controllers report their own SOC. */
     motor_proto_t proto = motor_link_get_active_proto();
     if (proto != MOTOR_PROTO_STX02_XOR && proto != MOTOR_PROTO_AUTH_XOR_CR)
     {
-        g_motor.soc_pct = battery_soc_pct_from_mv(batt_mv, g_batt.nominal_v);
+        g_motor.soc_pct = battery_est_soc_pct();
     }
 }
 
@@ -7,7 +7,8 @@
 /*
  * OEM v2.5.1-style battery voltage monitoring via ADC1 channel 0 (PA0).
  *
- * - Samples every ~50ms.
+ * - Samples every ~50ms: the latest 8 ms mean from the background DMA scan
+ *   (platform/adc_dma.h), or one started conversion when that is not running.
  * - Filters with 10-sample window, drop min/max, average remaining 8.
  * - Converts using OEM scale factor `n69300` (default 69300) read from the OEM
  *   SPI flash config block at 0x003FD000/0x003FB000 (offset 0x78).
@@ -29,39 +29,85 @@ static const uint16_t k_curve_48_mv[BATTERY_SOC_CURVE_POINTS] = {
     46300u, 45500u, 44900u, 44200u, 42900u, 42000u
 };
 
-static const uint16_t *curve_for_nominal(uint8_t nominal_v, uint32_t batt_mv)
+/*
+ * Direct index over each curve: the span curve[last]..curve[1] is cut into
+ * 2^SOC_INDEX_SHIFT mV buckets, each holding the segment its lowest voltage
+ * falls in. Buckets are narrower than the narrowest segment (200 mV on the
+ * 24 V curve), so a voltage is in that segment or the next one up and one
+ * compare settles it. The interpolation that follows is unchanged, so the
+ * result matches the OEM scan exactly.
+ */
+#define SOC_INDEX_SHIFT   7u
+#define SOC_INDEX_BUCKETS 96u
+#define SOC_CURVE_COUNT   3u
+#define SOC_LAST          (BATTERY_SOC_CURVE_POINTS - 1u)
+
+typedef struct {
+    const uint16_t *mv;
+    uint8_t seg[SOC_INDEX_BUCKETS];
+} soc_index_t;
+
+static soc_index_t g_soc_index[SOC_CURVE_COUNT] = {
+    { .mv = k_curve_24_mv },
+    { .mv = k_curve_36_mv },
+    { .mv = k_curve_48_mv },
+};
+static uint8_t g_soc_index_ready;
+
+_Static_assert(((53800u - 42000u) >> SOC_INDEX_SHIFT) < SOC_INDEX_BUCKETS, "48V curve overflows the index");
+_Static_assert((1u << SOC_INDEX_SHIFT) <= 200u, "buckets must be narrower than every segment");
+
+static const soc_index_t *index_for_nominal(uint8_t nominal_v, uint32_t batt_mv)
 {
     switch (nominal_v)
     {
-        case 24u: return k_curve_24_mv;
-        case 36u: return k_curve_36_mv;
-        case 48u: return k_curve_48_mv;
+        case 24u: return &g_soc_index[0];
+        case 36u: return &g_soc_index[1];
+        case 48u: return &g_soc_index[2];
         default:
             /* OEM has an explicit n48 config. If we don't have it, infer. */
-            if (batt_mv >= 42000u) return k_curve_48_mv;
-            if (batt_mv >= 30000u) return k_curve_36_mv;
-            return k_curve_24_mv;
+            if (batt_mv >= 42000u) return &g_soc_index[2];
+            if (batt_mv >= 30000u) return &g_soc_index[1];
+            return &g_soc_index[0];
     }
 }
 
-uint8_t battery_soc_pct_from_mv(uint32_t batt_mv, uint8_t nominal_v)
+void battery_soc_init(void)
+{
+    for (uint8_t c = 0; c < SOC_CURVE_COUNT; ++c)
+    {
+        soc_index_t *ix = &g_soc_index[c];
+        uint32_t lo = ix->mv[SOC_LAST];
+        uint8_t i = SOC_LAST - 1u;
+        for (uint32_t b = 0; b < SOC_INDEX_BUCKETS; ++b)
+        {
+            /* Same rule as the OEM scan: first i with curve[i+1] <= mv. */
+            uint32_t mv = lo + (b << SOC_INDEX_SHIFT);
+            while (i > 0u && (uint32_t)ix->mv[i] <= mv)
+                i--;
+            ix->seg[b] = i;
+        }
+    }
+    g_soc_index_ready = 1u;
+}
+
+uint16_t battery_soc_x100_from_mv(uint32_t batt_mv, uint8_t nominal_v)
 {
     if (batt_mv == 0u)
         return 0u;
+    if (!g_soc_index_ready)
+        battery_soc_init();
 
-    const uint16_t *curve = curve_for_nominal(nominal_v, batt_mv);
+    const soc_index_t *ix = index_for_nominal(nominal_v, batt_mv);
+    const uint16_t *curve = ix->mv;
 
-    /* Find i such that curve[i+1] <= batt_mv (descending curve points). */
-    uint8_t i = 0u;
-    for (; i < BATTERY_SOC_CURVE_POINTS - 1u; ++i)
-    {
-        if ((uint32_t)curve[i + 1u] <= batt_mv)
-            break;
-    }
-    if (i >= BATTERY_SOC_CURVE_POINTS - 1u)
+    if (batt_mv < curve[SOC_LAST])
         return 0u;
-    if (i == 0u)
-        return 100u;
+    if (batt_mv >= curve[1])
+        return 10000u;
+    uint8_t i = ix->seg[(batt_mv - curve[SOC_LAST]) >> SOC_INDEX_SHIFT];
+    if (batt_mv >= curve[i])
+        i--;
 
     uint32_t x0 = curve[i];
     uint32_t x1 = curve[i + 1u];
@@ -78,9 +124,13 @@ uint8_t battery_soc_pct_from_mv(uint32_t batt_mv, uint8_t nominal_v)
     uint32_t y = y1;
     if (dy && x)
         y = y1 + (dy * x) / dx;
+    if (y > 10000u)
+        y = 10000u;
+    return (uint16_t)y;
+}
 
-    uint32_t pct = (y + 50u) / 100u; /* round to nearest percent */
-    if (pct > 100u)
-        pct = 100u;
-    return (uint8_t)pct;
+uint8_t battery_soc_pct_from_mv(uint32_t batt_mv, uint8_t nominal_v)
+{
+    uint32_t y = battery_soc_x100_from_mv(batt_mv, nominal_v);
+    return (uint8_t)((y + 50u) / 100u); /* round to nearest percent */
 }
@@ -15,5 +15,14 @@
  */
 uint8_t battery_soc_pct_from_mv(uint32_t batt_mv, uint8_t nominal_v);
 
+/* Same curve before rounding: 0..10000 (0.01 % steps). */
+uint16_t battery_soc_x100_from_mv(uint32_t batt_mv, uint8_t nominal_v);
+
+/*
+ * Build the per-curve direct index (battery_monitor_init() calls it; the
+ * first lookup does too if it has not run).
+ */
+void battery_soc_init(void);
+
 #endif /* BATTERY_SOC_H */
 
@@ -0,0 +1,83 @@
+#include "brownout.h"
+
+#include "src/telemetry/trip.h"
+#include "storage/logs.h"
+#include "storage/power_fail.h"
+
+#ifndef HOST_TEST
+#include "drivers/spi_flash.h"
+#include "platform/board_init.h"
+#include "platform/hw.h"
+#include "platform/mmio.h"
+#include "platform/pvd.h"
+#include "platform/time.h"
+#include "platform/watchdog.h"
+#else
+/* Host builds have no PVD; the interrupt never fires. */
+static void platform_pvd_init(void) {}
+static void platform_backlight_set_level(uint8_t level) { (void)level; }
+#endif
+
+_Static_assert(TRIP_STATE_SIZE <= POWER_FAIL_PAYLOAD_MAX, "trip state must fit a power fail record");
+
+static uint8_t g_brownout_restored;
+
+#ifndef HOST_TEST
+/* Fed throughout: the hold is bounded by BROWNOUT_HOLD_MAX_MS instead. */
+static void brownout_hold(void)
+{
+    uint32_t start = platform_cycles_now();
+    uint32_t above_since = start;
+    uint8_t above = 0u;
+    for (;;)
+    {
+        watchdog_feed_runtime();
+        uint32_t now = platform_cycles_now();
+        if (platform_pvd_low())
+            above = 0u;
+        else if (!above)
+        {
+            above = 1u;
+            above_since = now;
+        }
+        if (above && platform_cycles_to_us(now - above_since) >= BROWNOUT_RECOVER_MS * 1000u)
+            break;
+        if (platform_cycles_to_us(now - start) >= BROWNOUT_HOLD_MAX_MS * 1000u)
+            break;
+    }
+    spi_flash_urgent_end();
+    mmio_write32(SCB_AIRCR, SCB_AIRCR_VECTKEY | SCB_AIRCR_SYSRESETREQ);
+    for (;;)
+        ;
+}
+#else
+static void brownout_hold(void) {}
+#endif
+
+void brownout_init(void)
+{
+    uint8_t state[POWER_FAIL_PAYLOAD_MAX];
+    uint32_t n = power_fail_take(state, sizeof(state));
+    g_brownout_restored = (n && trip_state_restore(state, n)) ? 1u : 0u;
+    platform_pvd_init();
+}
+
+void brownout_isr(void)
+{
+    platform_backlight_set_level(0u);
+    uint8_t state[TRIP_STATE_SIZE];
+    uint32_t n = trip_state_save(state);
+    if (n)
+        (void)power_fail_write_urgent(state, n);
+#ifndef HOST_TEST
+    /* Then the events still staged in RAM. */
+    if (spi_flash_urgent_begin())
+        event_log_flush_urgent(spi_flash_urgent_program);
+#endif
+    brownout_hold();
+}
+
+uint8_t brownout_restored(void)
+{
+    return g_brownout_restored;
+}
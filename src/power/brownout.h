@@ -0,0 +1,37 @@
+#ifndef BROWNOUT_H
+#define BROWNOUT_H
+
+#include <stdint.h>
+
+/*
+ * Brown-out early warning.
+ *
+ * The PVD interrupt (platform/pvd.h) fires when the 3.3 V rail falls
+ * through 2.9 V after the pack goes away, leaving the rail's hold-up time
+ * to save what a clean trip_reset would have. It preempts everything and
+ * never returns to the preempted code:
+ *   - the backlight goes off, the largest load on the rail
+ *   - the running trip is written as one power_fail record: a single page
+ *     program into a pre-erased slot (~1 ms, ~3 ms worst case), suspending
+ *     a background erase if one is running
+ *   - it then waits for the supply to die; if VDD stays back above the
+ *     threshold for BROWNOUT_RECOVER_MS, or hovers for BROWNOUT_HOLD_MAX_MS,
+ *     it resets, and the next boot resumes like after a real cut
+ *
+ * Queued flash jobs and the trip's percentile histograms are not saved.
+ * brownout_init() (boot, after trip_init) makes a pending record the
+ * current trip, so its distance still reaches the lifetime totals at the
+ * next trip_reset, and then arms the PVD.
+ */
+#define BROWNOUT_RECOVER_MS 100u
+#define BROWNOUT_HOLD_MAX_MS 2000u
+
+void brownout_init(void);
+
+/* PVD interrupt body; does not return on target. */
+void brownout_isr(void);
+
+/* 1 when this boot resumed a trip from a brown-out record. */
+uint8_t brownout_restored(void);
+
+#endif /* BROWNOUT_H */
@@ -0,0 +1,106 @@
+#include "clock_profile.h"
+
+#include <string.h>
+
+#ifndef HOST_TEST
+#include "drivers/spi_flash.h"
+#include "drivers/uart.h"
+#include "platform/clock.h"
+#include "platform/cpu.h"
+#include "platform/hw.h"
+#include "src/motor/motor_isr.h"
+#else
+/* Host builds have one clock; switches always succeed and TX is idle. */
+#define PLATFORM_CLOCK_FULL 0u
+#define PLATFORM_CLOCK_LOW  1u
+static uint8_t platform_clock_set_profile(uint8_t profile) { (void)profile; return 1u; }
+static uint8_t clock_profile_tx_idle(void) { return 1u; }
+static uint32_t irq_save(void) { return 0u; }
+static void irq_restore(uint32_t primask) { (void)primask; }
+static void uart_clock_changed(void) {}
+static void spi_flash_clock_changed(void) {}
+#endif
+
+static struct {
+    uint8_t inited;
+    uint8_t profile;
+    uint8_t unsupported;     /* SYSCLK not on the HSE PLL: stay put */
+    uint32_t last_active_ms;
+    uint32_t low_since_ms;
+    clock_profile_stats_t stats;
+} g_clock_profile;
+
+#ifndef HOST_TEST
+/* BRR is rewritten with UE off, which would cut a byte in flight. */
+static uint8_t clock_profile_tx_idle(void)
+{
+    return (uart_tx_idle(UART1_BASE) && uart_tx_idle(UART2_BASE) && !motor_isr_tx_busy()) ? 1u : 0u;
+}
+#endif
+
+void clock_profile_reset(void)
+{
+    memset(&g_clock_profile, 0, sizeof(g_clock_profile));
+    g_clock_profile.profile = PLATFORM_CLOCK_FULL;
+}
+
+void clock_profile_tick(uint32_t now_ms, uint8_t active)
+{
+    if (!g_clock_profile.inited)
+    {
+        g_clock_profile.inited = 1u;
+        g_clock_profile.last_active_ms = now_ms;
+    }
+    if (active)
+        g_clock_profile.last_active_ms = now_ms;
+    if (g_clock_profile.unsupported)
+        return;
+
+    uint8_t want = ((uint32_t)(now_ms - g_clock_profile.last_active_ms) >= CLOCK_PROFILE_PARK_MS)
+                       ? PLATFORM_CLOCK_LOW
+                       : PLATFORM_CLOCK_FULL;
+    if (want == g_clock_profile.profile)
+        return;
+    if (!clock_profile_tx_idle())
+    {
+        g_clock_profile.stats.deferred++;
+        return;
+    }
+
+    uint32_t primask = irq_save();
+    uint8_t ok = platform_clock_set_profile(want);
+    if (ok)
+    {
+        uart_clock_changed();
+        spi_flash_clock_changed();
+    }
+    irq_restore(primask);
+    if (!ok)
+    {
+        g_clock_profile.unsupported = 1u;
+        return;
+    }
+
+    g_clock_profile.profile = want;
+    if (want == PLATFORM_CLOCK_LOW)
+    {
+        g_clock_profile.stats.to_low++;
+        g_clock_profile.low_since_ms = now_ms;
+    }
+    else
+    {
+        g_clock_profile.stats.to_full++;
+        g_clock_profile.stats.low_ms += now_ms - g_clock_profile.low_since_ms;
+    }
+}
+
+uint8_t clock_profile_current(void)
+{
+    return g_clock_profile.profile;
+}
+
+void clock_profile_get_stats(clock_profile_stats_t *out)
+{
+    if (out)
+        *out = g_clock_profile.stats;
+}
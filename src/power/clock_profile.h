@@ -0,0 +1,39 @@
+#ifndef CLOCK_PROFILE_H
+#define CLOCK_PROFILE_H
+
+#include <stdint.h>
+
+/*
+ * Parked clock scaling.
+ *
+ * With the bike standing still, no button press and no BLE central for
+ * CLOCK_PROFILE_PARK_MS, SYSCLK drops to PLATFORM_CLOCK_LOW (24 MHz, roughly
+ * a third of the core's dynamic draw); any of the three brings it back to
+ * full speed on the next motor slot, before the UI frame it triggers.
+ *
+ * A switch waits until neither UART is sending (deferred), then runs with
+ * interrupts masked: platform_clock_set_profile() re-times the timers, and
+ * UART BRR and the SPI flash read prescaler are recomputed here. A motor
+ * reply arriving during the few-us BRR rewrite can be lost; the link treats
+ * that as one dropped frame.
+ */
+#define CLOCK_PROFILE_PARK_MS 10000u
+
+typedef struct {
+    uint32_t to_low;
+    uint32_t to_full;
+    uint32_t deferred;      /* ticks a wanted switch waited for TX idle */
+    uint32_t low_ms;        /* closed spells at the low profile */
+} clock_profile_stats_t;
+
+void clock_profile_reset(void);
+
+/* active: moving, a button press, or a BLE connection this tick. */
+void clock_profile_tick(uint32_t now_ms, uint8_t active);
+
+/* PLATFORM_CLOCK_FULL or PLATFORM_CLOCK_LOW. */
+uint8_t clock_profile_current(void);
+
+void clock_profile_get_stats(clock_profile_stats_t *out);
+
+#endif /* CLOCK_PROFILE_H */
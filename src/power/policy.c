@@ -3,11 +3,13 @@
  *
  * Multi-governor power limiting system:
  * - Lug governor: reduces power at low duty cycle (motor stall prevention)
- * - Thermal governor: reduces power based on temperature/I²t model
+ * - Thermal governor: reduces power based on temperature/I²t model, easing
+ *   in ahead of the limit when the fitted thermal model predicts a crossing
  * - Sag governor: reduces power when battery voltage drops
  */
 
 #include "power.h"
+#include "thermal_model.h"
 #include "app_data.h"
 #include "core/math_util.h"
 #include "storage/logs.h"
@@ -37,6 +39,76 @@ adaptive_assist_state_t g_adapt;
 static uint32_t g_adapt_dt_ms;
 static uint16_t g_adapt_speed_dmph;
 
+/*
+ * The direct-temperature derate and the sag factor each depend on a single
+ * input that moves far less often than the control tick runs, so they are
+ * kept with the input value they were computed for and only re-evaluated
+ * when it changes. The lug ramp and the I²t integrators carry state and
+ * still step every call.
+ */
+static struct {
+    uint8_t temp_valid;
+    uint8_t sag_valid;
+    int16_t temp_dC;
+    int16_t batt_dV;
+    uint16_t temp_factor_q16;
+    uint16_t temp_state;
+    uint16_t sag_factor_q16;
+    int16_t sag_margin_dV;
+} g_policy_cache;
+
+static void policy_temp_refresh(int16_t temp_dC)
+{
+    if (g_policy_cache.temp_valid && g_policy_cache.temp_dC == temp_dC)
+        return;
+    int32_t temp = temp_dC;
+    uint16_t factor;
+    if (temp <= THERM_TEMP_SOFT_DC)
+        factor = Q16_ONE;
+    else if (temp >= THERM_TEMP_HARD_DC)
+        factor = THERM_F_MIN_Q16;
+    else
+    {
+        uint32_t span_t = (uint32_t)(THERM_TEMP_HARD_DC - THERM_TEMP_SOFT_DC);
+        uint32_t num_t = (uint32_t)(temp - THERM_TEMP_SOFT_DC) * (uint32_t)(Q16_ONE - THERM_F_MIN_Q16);
+        factor = (uint16_t)(Q16_ONE - (num_t / span_t));
+    }
+    if (temp < 0)
+        temp = 0;
+    g_policy_cache.temp_factor_q16 = factor;
+    g_policy_cache.temp_state = clamp_u16((uint32_t)temp, 0, 0xFFFF);
+    g_policy_cache.temp_dC = temp_dC;
+    g_policy_cache.temp_valid = 1u;
+}
+
+static void policy_sag_refresh(int16_t batt_dV)
+{
+    if (g_policy_cache.sag_valid && g_policy_cache.batt_dV == batt_dV)
+        return;
+    int32_t v = batt_dV;
+    uint16_t factor;
+    if (v < 0)
+        v = 0;
+    if (v >= SAG_START_DV)
+    {
+        factor = Q16_ONE;
+    }
+    else if (v <= SAG_CUTOFF_DV)
+    {
+        factor = 0;
+    }
+    else
+    {
+        uint32_t span_v = (uint32_t)(SAG_START_DV - SAG_CUTOFF_DV);
+        uint32_t num_v = (uint32_t)(v - SAG_CUTOFF_DV) * Q16_ONE;
+        factor = (uint16_t)(num_v / span_v);
+    }
+    g_policy_cache.sag_factor_q16 = factor;
+    g_policy_cache.sag_margin_dV = (int16_t)(v - SAG_START_DV);
+    g_policy_cache.batt_dV = batt_dV;
+    g_policy_cache.sag_valid = 1u;
+}
+
 void power_policy_reset(void)
 {
     g_power_policy.p_user_w = 0;
@@ -56,6 +128,9 @@ void power_policy_reset(void)
     g_power_policy.last_ms = 0;
     g_power_policy.last_log_ms = 0;
     g_power_policy.last_reason = LIMIT_REASON_USER;
+    g_policy_cache.temp_valid = 0u;
+    g_policy_cache.sag_valid = 0u;
+    thermal_model_reset();
 }
 
 void power_policy_apply(uint16_t p_user_w)
@@ -63,6 +138,7 @@ void power_policy_apply(uint16_t p_user_w)
     uint32_t now = g_ms;
     uint32_t dt = (g_power_policy.last_ms == 0) ? 0u : (now - g_power_policy.last_ms);
     g_power_policy.last_ms = now;
+    uint16_t last_final_w = g_power_policy.p_final_w;
 
     g_power_policy.p_user_w = p_user_w;
     g_power_policy.p_lug_w = p_user_w;
@@ -177,20 +253,14 @@ void power_policy_apply(uint16_t p_user_w)
     if (g_input_caps & INPUT_CAP_TEMP)
     {
         /* Direct temperature-based limiting */
-        int32_t temp = g_inputs.ctrl_temp_dC;
-        if (temp <= THERM_TEMP_SOFT_DC)
-            thermal_factor = Q16_ONE;
-        else if (temp >= THERM_TEMP_HARD_DC)
-            thermal_factor = THERM_F_MIN_Q16;
-        else
-        {
-            uint32_t span_t = (uint32_t)(THERM_TEMP_HARD_DC - THERM_TEMP_SOFT_DC);
-            uint32_t num_t = (uint32_t)(temp - THERM_TEMP_SOFT_DC) * (uint32_t)(Q16_ONE - THERM_F_MIN_Q16);
-            thermal_factor = (uint16_t)(Q16_ONE - (num_t / span_t));
-        }
-        if (temp < 0)
-            temp = 0;
-        thermal_state_u16 = clamp_u16((uint32_t)temp, 0, 0xFFFF);
+        policy_temp_refresh(g_inputs.ctrl_temp_dC);
+        thermal_factor = g_policy_cache.temp_factor_q16;
+        thermal_state_u16 = g_policy_cache.temp_state;
+        /* Predictive taper: cmd current is power / 2, as in recompute_outputs(). */
+        uint16_t predicted = thermal_model_update(now, g_inputs.ctrl_temp_dC,
+                                                  (uint16_t)(last_final_w / 2u), (uint16_t)(p_user_w / 2u));
+        if (predicted < thermal_factor)
+            thermal_factor = predicted;
     }
     else if ((g_input_caps & INPUT_CAP_BATT_I) && (g_input_caps & INPUT_CAP_BATT_V))
     {
@@ -226,24 +296,9 @@ void power_policy_apply(uint16_t p_user_w)
     int16_t sag_margin = 0;
     if (g_input_caps & INPUT_CAP_BATT_V)
     {
-        int32_t v = g_inputs.battery_dV;
-        if (v < 0)
-            v = 0;
-        sag_margin = (int16_t)(v - SAG_START_DV);
-        if (v >= SAG_START_DV)
-        {
-            sag_factor = Q16_ONE;
-        }
-        else if (v <= SAG_CUTOFF_DV)
-        {
-            sag_factor = 0;
-        }
-        else
-        {
-            uint32_t span_v = (uint32_t)(SAG_START_DV - SAG_CUTOFF_DV);
-            uint32_t num_v = (uint32_t)(v - SAG_CUTOFF_DV) * Q16_ONE;
-            sag_factor = (uint16_t)(num_v / span_v);
-        }
+        policy_sag_refresh(g_inputs.battery_dV);
+        sag_factor = g_policy_cache.sag_factor_q16;
+        sag_margin = g_policy_cache.sag_margin_dV;
     }
     g_power_policy.sag_margin_dV = sag_margin;
     g_power_policy.p_sag_w = apply_q16(p_user_w, sag_factor);
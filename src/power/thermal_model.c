@@ -0,0 +1,200 @@
+#include "thermal_model.h"
+
+#include "power.h"
+
+#define TM_FORGET_SHIFT   5          /* ~32 windows of memory */
+#define TM_MIN_DET        (1LL << 20)
+#define TM_CMD_MAX_DA     1000u      /* 100 A; keeps I^2 sums in range */
+#define TM_SLEW_MS        10000u     /* full-scale factor change */
+#define TM_WINDOW_S       (THERM_MODEL_WINDOW_MS / 1000u)
+#define TM_HORIZON_WINDOWS (THERM_MODEL_HORIZON_S / TM_WINDOW_S)
+
+typedef struct {
+    uint8_t  started;
+    uint16_t n;
+    int16_t  win_t0;
+    uint32_t last_ms;
+    uint32_t win_start_ms;
+    uint32_t sum_h;          /* applied A^2 */
+    uint32_t sum_req_h;      /* requested A^2 */
+    int32_t  sum_d;          /* dC over ambient */
+    int64_t  s_hh, s_hd, s_dd, s_hy, s_dy;
+    thermal_model_info_t info;
+} tm_state_t;
+
+static tm_state_t g_tm;
+
+static uint32_t tm_isqrt(uint32_t v)
+{
+    uint32_t r = 0u;
+    uint32_t bit = 1u << 30;
+    while (bit > v)
+        bit >>= 2;
+    while (bit)
+    {
+        if (v >= r + bit)
+        {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return r;
+}
+
+static uint32_t tm_h_a2(uint16_t dA)
+{
+    uint32_t i = (dA > TM_CMD_MAX_DA) ? TM_CMD_MAX_DA : dA;
+    return (i * i) / 100u;
+}
+
+static void tm_window_reset(uint32_t now_ms, int16_t temp_dC)
+{
+    g_tm.win_start_ms = now_ms;
+    g_tm.win_t0 = temp_dC;
+    g_tm.sum_h = 0u;
+    g_tm.sum_req_h = 0u;
+    g_tm.sum_d = 0;
+    g_tm.n = 0u;
+}
+
+void thermal_model_reset(void)
+{
+    g_tm = (tm_state_t){0};
+    g_tm.info.ttl_s = THERM_MODEL_TTL_NONE;
+    g_tm.info.target_q16 = Q16_ONE;
+    g_tm.info.factor_q16 = Q16_ONE;
+}
+
+/* Decay the normal-equation sums and solve y = a*h - b*d. */
+static void tm_fit(int32_t h, int32_t d, int32_t y)
+{
+    g_tm.s_hh += (int64_t)h * h - g_tm.s_hh / (1 << TM_FORGET_SHIFT);
+    g_tm.s_hd += (int64_t)h * d - g_tm.s_hd / (1 << TM_FORGET_SHIFT);
+    g_tm.s_dd += (int64_t)d * d - g_tm.s_dd / (1 << TM_FORGET_SHIFT);
+    g_tm.s_hy += (int64_t)h * y - g_tm.s_hy / (1 << TM_FORGET_SHIFT);
+    g_tm.s_dy += (int64_t)d * y - g_tm.s_dy / (1 << TM_FORGET_SHIFT);
+    if (g_tm.info.windows < 0xFFFFu)
+        g_tm.info.windows++;
+
+    /* Steady riding makes h and d collinear; keep the last fit until the
+     * windows differ enough (1 - r^2 >= 1/64) to say something new. */
+    int64_t hh_dd = g_tm.s_hh * g_tm.s_dd;
+    int64_t det = hh_dd - g_tm.s_hd * g_tm.s_hd;
+    if (det < TM_MIN_DET || det < (hh_dd >> 6))
+        return;
+    int64_t den = det >> 8;
+    int64_t a = ((g_tm.s_hy * g_tm.s_dd - g_tm.s_hd * g_tm.s_dy) * 256) / den;
+    int64_t b = ((g_tm.s_hd * g_tm.s_hy - g_tm.s_hh * g_tm.s_dy) * 256) / den;
+    if (a <= 0 || b <= 0 || b >= 65536 || a > 0x7FFFFFFF)
+    {
+        g_tm.info.valid = 0u;
+        return;
+    }
+    g_tm.info.a_q16 = (uint32_t)a;
+    g_tm.info.b_q16 = (uint32_t)b;
+    g_tm.info.valid = (g_tm.info.windows >= THERM_MODEL_MIN_WINDOWS) ? 1u : 0u;
+}
+
+/* Allowed I^2 eases from the request to the sustainable value inside the horizon. */
+static void tm_predict(int16_t temp_dC, uint32_t h_req)
+{
+    thermal_model_info_t *m = &g_tm.info;
+    m->ttl_s = THERM_MODEL_TTL_NONE;
+    m->target_q16 = Q16_ONE;
+    if (!m->valid)
+        return;
+
+    int32_t limit = (int32_t)THERM_TEMP_SOFT_DC - m->ambient_dC;
+    if (limit <= 0)
+        return;
+    uint32_t h_sus = (uint32_t)(((int64_t)limit * m->b_q16) / m->a_q16);
+    m->sustain_dA = (uint16_t)tm_isqrt(h_sus * 100u);
+    if (h_req <= h_sus)
+        return;
+
+    /* Step the model forward at the request until it crosses the limit. */
+    int32_t d_q8 = ((int32_t)temp_dC - m->ambient_dC) * 256;
+    int32_t limit_q8 = limit * 256;
+    uint32_t k = 0u;
+    while (d_q8 < limit_q8 && k < TM_HORIZON_WINDOWS)
+    {
+        int64_t inc = ((int64_t)m->a_q16 * h_req * 256 - (int64_t)m->b_q16 * d_q8) >> 16;
+        if (inc <= 0)
+            return;
+        d_q8 += (int32_t)inc;
+        k++;
+    }
+    if (d_q8 < limit_q8)
+        return;
+    m->ttl_s = (uint16_t)(k * TM_WINDOW_S);
+
+    uint32_t h_allowed = h_sus + (uint32_t)(((uint64_t)(h_req - h_sus) * m->ttl_s) / THERM_MODEL_HORIZON_S);
+    uint32_t ratio_q16 = (uint32_t)(((uint64_t)h_allowed << 16) / h_req);
+    if (ratio_q16 > 0xFFFFu)
+        ratio_q16 = 0xFFFFu;
+    uint32_t f = tm_isqrt(ratio_q16 << 16);
+    if (f < THERM_F_MIN_Q16)
+        f = THERM_F_MIN_Q16;
+    m->target_q16 = (uint16_t)((f > Q16_ONE) ? Q16_ONE : f);
+}
+
+uint16_t thermal_model_update(uint32_t now_ms, int16_t temp_dC, uint16_t applied_dA, uint16_t request_dA)
+{
+    thermal_model_info_t *m = &g_tm.info;
+    if (!g_tm.started)
+    {
+        g_tm.started = 1u;
+        g_tm.last_ms = now_ms;
+        m->ambient_dC = temp_dC;
+        tm_window_reset(now_ms, temp_dC);
+    }
+    /* Power-up temperature stands in for ambient until it reads lower. */
+    if (temp_dC < m->ambient_dC)
+        m->ambient_dC = temp_dC;
+
+    uint32_t dt = now_ms - g_tm.last_ms;
+    g_tm.last_ms = now_ms;
+
+    g_tm.sum_h += tm_h_a2(applied_dA);
+    g_tm.sum_req_h += tm_h_a2(request_dA);
+    g_tm.sum_d += (int32_t)temp_dC - m->ambient_dC;
+    g_tm.n++;
+
+    uint32_t span = now_ms - g_tm.win_start_ms;
+    if (span >= THERM_MODEL_WINDOW_MS)
+    {
+        if (span < 2u * THERM_MODEL_WINDOW_MS)
+        {
+            int32_t y = (int32_t)temp_dC - g_tm.win_t0;
+            tm_fit((int32_t)(g_tm.sum_h / g_tm.n), g_tm.sum_d / (int32_t)g_tm.n, y);
+        }
+        tm_predict(temp_dC, g_tm.sum_req_h / g_tm.n);
+        tm_window_reset(now_ms, temp_dC);
+    }
+
+    /* Slew toward the target so a new prediction never steps the output. */
+    if (dt > TM_SLEW_MS)
+        dt = TM_SLEW_MS;
+    uint32_t step = ((uint32_t)Q16_ONE * dt) / TM_SLEW_MS;
+    if (step == 0u && dt)
+        step = 1u;
+    uint32_t f = m->factor_q16;
+    uint32_t target = m->target_q16;
+    if (f < target)
+        f = (target - f > step) ? f + step : target;
+    else if (f > target)
+        f = (f - target > step) ? f - step : target;
+    m->factor_q16 = (uint16_t)f;
+    return m->factor_q16;
+}
+
+void thermal_model_get_info(thermal_model_info_t *out)
+{
+    if (out)
+        *out = g_tm.info;
+}
@@ -0,0 +1,51 @@
+#ifndef THERMAL_MODEL_H
+#define THERMAL_MODEL_H
+
+#include <stdint.h>
+
+/*
+ * Lumped first-order controller thermal model with predictive derate.
+ *
+ * Per THERM_MODEL_WINDOW_MS window the controller temperature rise is
+ * regressed on the commanded current squared and the excess over ambient:
+ *
+ *   dT/window = a * I^2 - b * (T - T_amb)
+ *
+ * (fixed-point least squares with exponential forgetting). Once the fit
+ * holds, the model predicts how long the present command takes to reach
+ * THERM_TEMP_SOFT_DC. Inside THERM_MODEL_HORIZON_S of that the allowed
+ * I^2 is eased from the command toward the sustainable value (the one that
+ * settles exactly at the soft limit), so a long climb sees a gradual taper
+ * instead of hitting the reactive derate band.
+ */
+
+#define THERM_MODEL_WINDOW_MS    5000u
+#define THERM_MODEL_HORIZON_S    300u
+#define THERM_MODEL_MIN_WINDOWS  12u     /* fits before predictions are used */
+#define THERM_MODEL_TTL_NONE     0xFFFFu
+
+typedef struct {
+    uint8_t  valid;           /* fit is usable */
+    uint16_t windows;         /* windows folded into the fit */
+    int16_t  ambient_dC;
+    uint32_t a_q16;           /* dC per window per A^2 */
+    uint32_t b_q16;           /* 1 / tau, per window */
+    uint16_t ttl_s;           /* to the soft limit at the present command */
+    uint16_t sustain_dA;      /* settles at the soft limit */
+    uint16_t target_q16;      /* predictive current factor before slew */
+    uint16_t factor_q16;      /* slewed factor handed to the policy */
+} thermal_model_info_t;
+
+void thermal_model_reset(void);
+
+/*
+ * Fold in one sample and return the predictive current factor (Q16_ONE when
+ * no derate is due or the fit is not usable yet). The fit uses applied_dA,
+ * the current actually commanded last tick; the prediction uses request_dA,
+ * the rider's request before any derate.
+ */
+uint16_t thermal_model_update(uint32_t now_ms, int16_t temp_dC, uint16_t applied_dA, uint16_t request_dA);
+
+void thermal_model_get_info(thermal_model_info_t *out);
+
+#endif /* THERMAL_MODEL_H */
@@ -0,0 +1,264 @@
+#include "profile_bundle.h"
+
+#include <string.h>
+
+#include "profiles.h"
+#include "drivers/spi_flash.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+_Static_assert(PROFILE_BUNDLE_BYTES <= SPI_FLASH_SECTOR_SIZE, "bundle must fit its sector");
+
+#define BUNDLE_STAGE_IDLE   0u
+#define BUNDLE_STAGE_UPLOAD 1u
+#define BUNDLE_STAGE_EXPORT 2u
+
+static struct {
+    uint8_t stage;           /* BUNDLE_STAGE_*: what img holds */
+    profile_bundle_info_t info;
+    uint8_t img[PROFILE_BUNDLE_BYTES];
+} g_bundle;
+
+static uint8_t *curve_encode(uint8_t *p, const assist_curve_t *c)
+{
+    memset(p, 0, PROFILE_BUNDLE_CURVE_BYTES);
+    p[0] = c->count;
+    for (uint8_t i = 0; i < c->count && i < ASSIST_CURVE_MAX_POINTS; ++i)
+    {
+        store_be16(&p[1u + i * 4u], (uint16_t)c->pts[i].x);
+        store_be16(&p[3u + i * 4u], (uint16_t)c->pts[i].y);
+    }
+    return p + PROFILE_BUNDLE_CURVE_BYTES;
+}
+
+/* 1..ASSIST_CURVE_MAX_POINTS points, x strictly increasing, y <= y_max;
+ * points past count are ignored and left zero. */
+static int curve_decode(const uint8_t *p, assist_curve_t *c, uint16_t y_max)
+{
+    memset(c, 0, sizeof(*c));
+    c->count = p[0];
+    if (c->count == 0u || c->count > ASSIST_CURVE_MAX_POINTS)
+        return 0;
+    for (uint8_t i = 0; i < c->count; ++i)
+    {
+        uint16_t x = load_be16(&p[1u + i * 4u]);
+        uint16_t y = load_be16(&p[3u + i * 4u]);
+        if ((i && x <= (uint16_t)c->pts[i - 1u].x) || y > y_max)
+            return 0;
+        c->pts[i].x = x;
+        c->pts[i].y = y;
+    }
+    return 1;
+}
+
+void profile_bundle_encode(uint8_t *out)
+{
+    uint8_t *p = &out[PROFILE_BUNDLE_HEADER_BYTES];
+    for (uint8_t i = 0; i < PROFILE_COUNT; ++i)
+    {
+        store_be16(&p[0], g_profiles[i].cap_power_w);
+        store_be16(&p[2], g_profiles[i].cap_current_dA);
+        store_be16(&p[4], g_profiles[i].cap_speed_dmph);
+        p = curve_encode(&p[6], &g_assist_curves[i].speed_curve);
+        p = curve_encode(p, &g_assist_curves[i].cadence_curve);
+    }
+    p[0] = g_vgears.count;
+    p[1] = g_vgears.shape;
+    store_be16(&p[2], g_vgears.min_scale_q15);
+    store_be16(&p[4], g_vgears.max_scale_q15);
+    for (uint8_t i = 0; i < VGEAR_MAX; ++i)
+        store_be16(&p[6u + i * 2u], i < g_vgears.count ? g_vgears.scales[i] : 0u);
+    p += PROFILE_BUNDLE_GEAR_BYTES;
+    p[0] = g_cadence_bias.enabled;
+    store_be16(&p[1], g_cadence_bias.target_rpm);
+    store_be16(&p[3], g_cadence_bias.band_rpm);
+    store_be16(&p[5], g_cadence_bias.min_bias_q15);
+
+    store_be32(&out[0], PROFILE_BUNDLE_MAGIC);
+    out[4] = PROFILE_BUNDLE_VERSION;
+    out[5] = PROFILE_COUNT;
+    out[6] = ASSIST_CURVE_MAX_POINTS;
+    out[7] = VGEAR_MAX;
+    store_be32(&out[8], crc32_compute(&out[PROFILE_BUNDLE_HEADER_BYTES], PROFILE_BUNDLE_BODY_BYTES));
+}
+
+static int bundle_header_ok(const uint8_t *img, uint32_t len)
+{
+    if (len != PROFILE_BUNDLE_BYTES)
+        return 0;
+    if (load_be32(&img[0]) != PROFILE_BUNDLE_MAGIC || img[4] != PROFILE_BUNDLE_VERSION)
+        return 0;
+    if (img[5] != PROFILE_COUNT || img[6] != ASSIST_CURVE_MAX_POINTS || img[7] != VGEAR_MAX)
+        return 0;
+    return crc32_compute(&img[PROFILE_BUNDLE_HEADER_BYTES], PROFILE_BUNDLE_BODY_BYTES) ==
+           load_be32(&img[8]);
+}
+
+/* Decodes the body: with apply == 0 it only checks every field, so the
+ * apply pass cannot stop half way. */
+static int bundle_body(const uint8_t *p, int apply)
+{
+    for (uint8_t i = 0; i < PROFILE_COUNT; ++i)
+    {
+        assist_profile_t prof = { i, load_be16(&p[0]), load_be16(&p[2]), load_be16(&p[4]) };
+        if (prof.cap_power_w == 0u || prof.cap_power_w > MANUAL_POWER_MAX_W ||
+            prof.cap_current_dA == 0u || prof.cap_current_dA > MANUAL_CURRENT_MAX_DA)
+            return 0;
+        assist_curve_profile_t cp;
+        if (!curve_decode(&p[6], &cp.speed_curve, MANUAL_POWER_MAX_W) ||
+            !curve_decode(&p[6u + PROFILE_BUNDLE_CURVE_BYTES], &cp.cadence_curve, 65535u))
+            return 0;
+        if (apply)
+        {
+            g_profiles[i] = prof;
+            g_assist_curves[i] = cp;
+        }
+        p += PROFILE_BUNDLE_PROFILE_BYTES;
+    }
+
+    vgear_table_t t = {0};
+    t.count = p[0];
+    t.shape = p[1];
+    t.min_scale_q15 = load_be16(&p[2]);
+    t.max_scale_q15 = load_be16(&p[4]);
+    if (t.count == 0u || t.count > VGEAR_MAX)
+        return 0;
+    for (uint8_t i = 0; i < t.count; ++i)
+        t.scales[i] = load_be16(&p[6u + i * 2u]);
+    if (!vgear_validate(&t))
+        return 0;
+    p += PROFILE_BUNDLE_GEAR_BYTES;
+
+    cadence_bias_t cb;
+    cb.enabled = p[0];
+    cb.target_rpm = load_be16(&p[1]);
+    cb.band_rpm = load_be16(&p[3]);
+    cb.min_bias_q15 = load_be16(&p[5]);
+    if (cb.enabled > 1u || cb.band_rpm == 0u || cb.min_bias_q15 > 32768u)
+        return 0;
+
+    if (apply)
+    {
+        g_vgears = t;
+        g_cadence_bias = cb;
+    }
+    return 1;
+}
+
+/* Body first and header last, as for the other flash images, so a torn
+ * write leaves no bundle rather than a partial one. */
+static void bundle_store(const uint8_t *img)
+{
+    spi_flash_erase_4k(PROFILE_BUNDLE_STORAGE_BASE);
+    spi_flash_write(PROFILE_BUNDLE_STORAGE_BASE + PROFILE_BUNDLE_HEADER_BYTES,
+                    &img[PROFILE_BUNDLE_HEADER_BYTES], PROFILE_BUNDLE_BODY_BYTES);
+    spi_flash_write(PROFILE_BUNDLE_STORAGE_BASE, img, PROFILE_BUNDLE_HEADER_BYTES);
+}
+
+static void bundle_tables_changed(void)
+{
+    if (g_active_vgear == 0u)
+        g_active_vgear = 1u;
+    if (g_active_vgear > g_vgears.count)
+        g_active_vgear = g_vgears.count;
+    outputs_tables_changed();
+}
+
+int profile_bundle_apply(const uint8_t *img, uint32_t len, int persist)
+{
+    if (!img || !bundle_header_ok(img, len))
+        return 0;
+    const uint8_t *body = &img[PROFILE_BUNDLE_HEADER_BYTES];
+    if (!bundle_body(body, 0))
+        return 0;
+    (void)bundle_body(body, 1);
+    bundle_tables_changed();
+    if (persist)
+    {
+        bundle_store(img);
+        g_bundle.info.stored = 1u;
+        g_bundle.info.crc32 = load_be32(&img[8]);
+    }
+    return 1;
+}
+
+void profile_bundle_load(void)
+{
+    g_bundle.stage = BUNDLE_STAGE_IDLE;
+    g_bundle.info = (profile_bundle_info_t){0};
+    spi_flash_read(PROFILE_BUNDLE_STORAGE_BASE, g_bundle.img, PROFILE_BUNDLE_BYTES);
+    if (!profile_bundle_apply(g_bundle.img, PROFILE_BUNDLE_BYTES, 0))
+        return;
+    g_bundle.info.stored = 1u;
+    g_bundle.info.crc32 = load_be32(&g_bundle.img[8]);
+}
+
+void profile_bundle_upload_begin(void)
+{
+    g_bundle.stage = BUNDLE_STAGE_UPLOAD;
+    g_bundle.info.uploading = 1u;
+    g_bundle.info.write_offset = 0u;
+}
+
+int profile_bundle_upload_write(uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    if (g_bundle.stage != BUNDLE_STAGE_UPLOAD || !data || len == 0u)
+        return 0;
+    if (offset != g_bundle.info.write_offset || len > PROFILE_BUNDLE_BYTES - offset)
+        return 0;
+    memcpy(&g_bundle.img[offset], data, len);
+    g_bundle.info.write_offset += len;
+    return 1;
+}
+
+int profile_bundle_upload_finish(void)
+{
+    if (g_bundle.stage != BUNDLE_STAGE_UPLOAD)
+        return 0;
+    g_bundle.stage = BUNDLE_STAGE_IDLE;
+    g_bundle.info.uploading = 0u;
+    return profile_bundle_apply(g_bundle.img, g_bundle.info.write_offset, 1);
+}
+
+int profile_bundle_export_read(uint32_t offset, uint8_t *out, uint32_t cap)
+{
+    if (g_bundle.stage == BUNDLE_STAGE_UPLOAD || !out || offset > PROFILE_BUNDLE_BYTES)
+        return -1;
+    /* Offset 0 snapshots the tables; later reads continue that snapshot. */
+    if (offset == 0u)
+    {
+        profile_bundle_encode(g_bundle.img);
+        g_bundle.stage = BUNDLE_STAGE_EXPORT;
+    }
+    else if (g_bundle.stage != BUNDLE_STAGE_EXPORT)
+    {
+        return -1;
+    }
+    uint32_t n = PROFILE_BUNDLE_BYTES - offset;
+    if (n > cap)
+        n = cap;
+    memcpy(out, &g_bundle.img[offset], n);
+    return (int)n;
+}
+
+void profile_bundle_clear(void)
+{
+    spi_flash_erase_4k(PROFILE_BUNDLE_STORAGE_BASE);
+    g_bundle.stage = BUNDLE_STAGE_IDLE;
+    g_bundle.info.stored = 0u;
+    g_bundle.info.uploading = 0u;
+    g_bundle.info.crc32 = 0u;
+    profiles_defaults();
+    vgear_defaults();
+    cadence_bias_defaults();
+    bundle_tables_changed();
+}
+
+void profile_bundle_get_info(profile_bundle_info_t *out)
+{
+    if (!out)
+        return;
+    *out = g_bundle.info;
+    out->bytes = PROFILE_BUNDLE_BYTES;
+}
@@ -0,0 +1,73 @@
+#ifndef PROFILE_BUNDLE_H
+#define PROFILE_BUNDLE_H
+
+#include <stdint.h>
+
+#include "src/config/config.h"
+#include "src/control/control.h"
+
+/*
+ * Profile bundle: every assist profile, both curves of each, the virtual
+ * gear table and the cadence bias in one versioned, CRC-checked image, so a
+ * bike is provisioned with one streamed upload (comm command 0x5F,
+ * scripts/ble_profile_bundle.py) instead of a round-trip per setting.
+ *
+ * Image (all fields big-endian):
+ *   header: magic[4] 'PRFB', version[1], profiles[1], points[1], gears[1],
+ *           crc32[4] over the body
+ *   body:   profiles x { cap_power_w[2], cap_current_dA[2], cap_speed_dmph[2],
+ *                        speed curve, cadence curve }
+ *           curve = count[1], points x { x[2], y[2] } (unused points zero)
+ *           gears: count[1], shape[1], min_q15[2], max_q15[2], gears x scale[2]
+ *           bias:  enabled[1], target_rpm[2], band_rpm[2], min_bias_q15[2]
+ * profiles/points/gears must match PROFILE_COUNT, ASSIST_CURVE_MAX_POINTS
+ * and VGEAR_MAX. An upload is staged in RAM and only applied once the whole
+ * image checks out; applying swaps every table at once, rebuilds the
+ * compiled assist curves and writes the image to its flash sector, which
+ * boot loads ahead of the config.
+ */
+#define PROFILE_BUNDLE_MAGIC        0x50524642u /* 'PRFB' */
+#define PROFILE_BUNDLE_VERSION      1u
+#define PROFILE_BUNDLE_HEADER_BYTES 12u
+#define PROFILE_BUNDLE_CURVE_BYTES  (1u + ASSIST_CURVE_MAX_POINTS * 4u)
+#define PROFILE_BUNDLE_PROFILE_BYTES (6u + 2u * PROFILE_BUNDLE_CURVE_BYTES)
+#define PROFILE_BUNDLE_GEAR_BYTES   (6u + VGEAR_MAX * 2u)
+#define PROFILE_BUNDLE_BIAS_BYTES   7u
+#define PROFILE_BUNDLE_BODY_BYTES   (PROFILE_COUNT * PROFILE_BUNDLE_PROFILE_BYTES + \
+                                     PROFILE_BUNDLE_GEAR_BYTES + PROFILE_BUNDLE_BIAS_BYTES)
+#define PROFILE_BUNDLE_BYTES        (PROFILE_BUNDLE_HEADER_BYTES + PROFILE_BUNDLE_BODY_BYTES)
+
+typedef struct {
+    uint8_t stored;      /* a valid image is in flash */
+    uint8_t uploading;
+    uint16_t bytes;      /* PROFILE_BUNDLE_BYTES */
+    uint32_t crc32;      /* body CRC of the active tables */
+    uint32_t write_offset;
+} profile_bundle_info_t;
+
+/* Boot: applies the stored image, if any, over the built-in tables. */
+void profile_bundle_load(void);
+
+/* Encodes the active tables into out (PROFILE_BUNDLE_BYTES). */
+void profile_bundle_encode(uint8_t *out);
+
+/* Checks a complete image; applies and stores it when persist is set,
+ * otherwise only applies it. Returns 1 on success, tables untouched on 0. */
+int profile_bundle_apply(const uint8_t *img, uint32_t len, int persist);
+
+/* Streamed upload into the RAM stage: begin, sequential writes, finish. */
+void profile_bundle_upload_begin(void);
+int profile_bundle_upload_write(uint32_t offset, const uint8_t *data, uint32_t len);
+int profile_bundle_upload_finish(void);
+
+/* Export: offset 0 encodes the active tables, reads continue from that
+ * snapshot. Returns the bytes copied (0 past the end), -1 while an upload
+ * holds the stage or without a snapshot. */
+int profile_bundle_export_read(uint32_t offset, uint8_t *out, uint32_t cap);
+
+/* Erases the stored image and restores the built-in tables. */
+void profile_bundle_clear(void);
+
+void profile_bundle_get_info(profile_bundle_info_t *out);
+
+#endif /* PROFILE_BUNDLE_H */
@@ -1,6 +1,11 @@
 #include "profiles.h"
 
-const assist_profile_t g_profiles[PROFILE_COUNT] = {
+#include <string.h>
+
+assist_profile_t g_profiles[PROFILE_COUNT];
+assist_curve_profile_t g_assist_curves[PROFILE_COUNT];
+
+static const assist_profile_t k_profiles_default[PROFILE_COUNT] = {
     /* id,   powerW, current dA, speed cap (0 = unlimited) */
     { 0, 550, 180, 250 }, /* commute */
     { 1, 750, 220, 280 }, /* trail */
@@ -14,7 +19,7 @@ const assist_profile_t g_profiles[PROFILE_COUNT] = {
  * Speed curves output a power limit (W). Cadence curves output a Q15
  * multiplier applied to the speed-derived limit.
  */
-const assist_curve_profile_t g_assist_curves[PROFILE_COUNT] = {
+static const assist_curve_profile_t k_assist_curves_default[PROFILE_COUNT] = {
     /* commute */
     {
         .speed_curve = {6, {
@@ -64,3 +69,9 @@ const assist_curve_profile_t g_assist_curves[PROFILE_COUNT] = {
         }},
     },
 };
+
+void profiles_defaults(void)
+{
+    memcpy(g_profiles, k_profiles_default, sizeof(g_profiles));
+    memcpy(g_assist_curves, k_assist_curves_default, sizeof(g_assist_curves));
+}
@@ -23,8 +23,12 @@ typedef struct {
     assist_curve_t cadence_curve; /* x=cadence_rpm, y=Q15 multiplier */
 } assist_curve_profile_t;
 
-extern const assist_profile_t g_profiles[PROFILE_COUNT];
-extern const assist_curve_profile_t g_assist_curves[PROFILE_COUNT];
+/* Active tables: the built-in ones after profiles_defaults(), until a
+ * profile bundle replaces them (profile_bundle.h). */
+extern assist_profile_t g_profiles[PROFILE_COUNT];
+extern assist_curve_profile_t g_assist_curves[PROFILE_COUNT];
+
+void profiles_defaults(void);
 
 /* Active profile selection (defined in main.c). */
 extern uint8_t g_active_profile_id;
@@ -0,0 +1,212 @@
+/*
+ * Streaming anomaly detectors - Implementation
+ */
+
+#include "anomaly.h"
+
+#include <string.h>
+
+#include "../../storage/event_types.h"
+
+#define ANOMALY_SAG_BASE_SHIFT 11u /* EWMA weight 1/2048: ~40 s at 50 Hz */
+#define ANOMALY_HEAT_SHIFT     3u  /* EWMA weight 1/8 of the blocks */
+#define ANOMALY_HEAT_Z2        16  /* 4 sigma, squared */
+#define ANOMALY_HEAT_VAR_MIN   64u /* sigma >= 0.2 C: sensor steps */
+#define ANOMALY_HEAT_RISE_MAX  200 /* clamp for one block, 0.1 C */
+
+static struct {
+    anomaly_stats_t st;
+    uint32_t last_trip_ms[ANOMALY_COUNT];
+
+    int32_t sag_base_q16; /* 0.1 V << 16 */
+    int32_t sag_sum;
+    uint16_t sag_samples;
+
+    uint32_t heat_block_ms;
+    int16_t heat_block_dC;
+    uint8_t heat_blocks;
+    uint8_t heat_started;
+    int32_t heat_mean_q4;
+    uint32_t heat_var_q4;
+
+    uint32_t link_block_ms;
+    uint32_t link_frames;
+    uint32_t link_errors;
+    uint32_t link_sum;
+    uint8_t link_started;
+} g_anomaly;
+
+static uint8_t sat_u8(int32_t v)
+{
+    return (uint8_t)((v < 0) ? 0 : (v > 255) ? 255 : v);
+}
+
+/* Ends an episode ANOMALY_CLEAR_MS after its last trip. */
+static void anomaly_expire(uint8_t a, uint32_t now_ms)
+{
+    uint8_t bit = (uint8_t)(1u << a);
+    if ((g_anomaly.st.active & bit) && (uint32_t)(now_ms - g_anomaly.last_trip_ms[a]) >= ANOMALY_CLEAR_MS)
+        g_anomaly.st.active &= (uint8_t)~bit;
+}
+
+/* Returns the detector's bit when the trip starts an episode. */
+static uint8_t anomaly_trip(uint8_t a, uint32_t now_ms, uint8_t flags)
+{
+    uint8_t bit = (uint8_t)(1u << a);
+    g_anomaly.st.trips[a]++;
+    g_anomaly.last_trip_ms[a] = now_ms;
+    if (g_anomaly.st.active & bit)
+        return 0u;
+    g_anomaly.st.active |= bit;
+    g_anomaly.st.raised[a]++;
+    g_anomaly.st.last_flags[a] = flags;
+    return bit;
+}
+
+void anomaly_reset(void)
+{
+    memset(&g_anomaly, 0, sizeof(g_anomaly));
+    g_anomaly.heat_var_q4 = ANOMALY_HEAT_VAR_MIN;
+}
+
+static uint8_t anomaly_sag(const tlm_tick_t *s, uint16_t r_mohm)
+{
+    if (r_mohm == 0u || s->battery_dV <= 0)
+        return 0u;
+    /* dA * mOhm / 1000 is the I*R drop in 0.1 V. */
+    int32_t v = (int32_t)s->battery_dV;
+    if (s->battery_dA > 0)
+        v += ((int32_t)s->battery_dA * (int32_t)r_mohm) / 1000;
+    if (g_anomaly.sag_samples == 0u)
+        g_anomaly.sag_base_q16 = v * 65536;
+    else
+        g_anomaly.sag_base_q16 += (v * 65536 - g_anomaly.sag_base_q16) / (1 << ANOMALY_SAG_BASE_SHIFT);
+    g_anomaly.st.sag_base_dV = (int16_t)(g_anomaly.sag_base_q16 / 65536);
+    if (g_anomaly.sag_samples < ANOMALY_SAG_WARMUP)
+    {
+        g_anomaly.sag_samples++;
+        return 0u;
+    }
+
+    int32_t short_dV = (s->battery_dA >= ANOMALY_SAG_MIN_DA) ? (g_anomaly.st.sag_base_dV - v) : 0;
+    g_anomaly.sag_sum += short_dV - ANOMALY_SAG_SLACK_DV;
+    if (g_anomaly.sag_sum < 0)
+        g_anomaly.sag_sum = 0;
+    if (g_anomaly.sag_sum < ANOMALY_SAG_LIMIT)
+        return 0u;
+    g_anomaly.sag_sum = 0;
+    return anomaly_trip(ANOMALY_SAG, s->ms, sat_u8(short_dV));
+}
+
+static uint8_t anomaly_heat(const tlm_tick_t *s)
+{
+    if (s->ctrl_temp_dC == 0)
+    {
+        g_anomaly.heat_started = 0u;
+        return 0u;
+    }
+    uint32_t span = s->ms - g_anomaly.heat_block_ms;
+    if (!g_anomaly.heat_started || span >= 2u * ANOMALY_HEAT_BLOCK_MS)
+    {
+        /* First sample, or a gap: no rise to measure across it. */
+        g_anomaly.heat_started = 1u;
+        g_anomaly.heat_block_ms = s->ms;
+        g_anomaly.heat_block_dC = s->ctrl_temp_dC;
+        return 0u;
+    }
+    if (span < ANOMALY_HEAT_BLOCK_MS)
+        return 0u;
+
+    int32_t rise = (int32_t)s->ctrl_temp_dC - g_anomaly.heat_block_dC;
+    if (rise > ANOMALY_HEAT_RISE_MAX)
+        rise = ANOMALY_HEAT_RISE_MAX;
+    if (rise < -ANOMALY_HEAT_RISE_MAX)
+        rise = -ANOMALY_HEAT_RISE_MAX;
+    g_anomaly.heat_block_ms = s->ms;
+    g_anomaly.heat_block_dC = s->ctrl_temp_dC;
+
+    /* Test against the past blocks, then fold this one in. */
+    int32_t d = rise * 16 - g_anomaly.heat_mean_q4;
+    uint32_t d2 = (uint32_t)(d * d);
+    uint8_t raised = 0u;
+    if (g_anomaly.heat_blocks >= ANOMALY_HEAT_WARMUP && d > 0 && rise >= ANOMALY_HEAT_MIN_DC &&
+        d2 > (uint32_t)ANOMALY_HEAT_Z2 * g_anomaly.heat_var_q4 * 16u)
+    {
+        /* 0.1 C per block to C per minute. */
+        raised = anomaly_trip(ANOMALY_HEAT, s->ms, sat_u8((rise * 6000) / (int32_t)ANOMALY_HEAT_BLOCK_MS));
+    }
+    else if (g_anomaly.heat_blocks < ANOMALY_HEAT_WARMUP)
+    {
+        g_anomaly.heat_blocks++;
+    }
+    g_anomaly.heat_mean_q4 += d / (1 << ANOMALY_HEAT_SHIFT);
+    int32_t var = (int32_t)g_anomaly.heat_var_q4 + ((int32_t)(d2 / 16u) - (int32_t)g_anomaly.heat_var_q4) /
+                                                       (1 << ANOMALY_HEAT_SHIFT);
+    g_anomaly.heat_var_q4 = (var < (int32_t)ANOMALY_HEAT_VAR_MIN) ? ANOMALY_HEAT_VAR_MIN : (uint32_t)var;
+    g_anomaly.st.heat_mean_x16 = (int16_t)g_anomaly.heat_mean_q4;
+    g_anomaly.st.heat_var_x16 = g_anomaly.heat_var_q4;
+    return raised;
+}
+
+uint8_t anomaly_on_sample(const tlm_tick_t *s, uint16_t r_mohm)
+{
+    if (!s)
+        return 0u;
+    anomaly_expire(ANOMALY_SAG, s->ms);
+    anomaly_expire(ANOMALY_HEAT, s->ms);
+    return (uint8_t)(anomaly_sag(s, r_mohm) | anomaly_heat(s));
+}
+
+uint8_t anomaly_on_link(uint32_t now_ms, uint32_t frames, uint32_t errors)
+{
+    anomaly_expire(ANOMALY_LINK, now_ms);
+    if (!g_anomaly.link_started)
+    {
+        g_anomaly.link_started = 1u;
+        g_anomaly.link_block_ms = now_ms;
+        g_anomaly.link_frames = frames;
+        g_anomaly.link_errors = errors;
+        return 0u;
+    }
+    if ((uint32_t)(now_ms - g_anomaly.link_block_ms) < ANOMALY_LINK_BLOCK_MS)
+        return 0u;
+    uint32_t df = frames - g_anomaly.link_frames;
+    uint32_t de = errors - g_anomaly.link_errors;
+    g_anomaly.link_block_ms = now_ms;
+    g_anomaly.link_frames = frames;
+    g_anomaly.link_errors = errors;
+    /* No traffic at all (motor off) says nothing about the link. */
+    if (df + de == 0u)
+        return 0u;
+    uint32_t total = df + de;
+    uint32_t share = (total > 4000000u) ? (de / (total / 1000u)) : ((de * 1000u) / total);
+    g_anomaly.link_sum = (g_anomaly.link_sum + share > ANOMALY_LINK_SLACK)
+                             ? (g_anomaly.link_sum + share - ANOMALY_LINK_SLACK)
+                             : 0u;
+    if (g_anomaly.link_sum < ANOMALY_LINK_LIMIT)
+        return 0u;
+    g_anomaly.link_sum = 0u;
+    return anomaly_trip(ANOMALY_LINK, now_ms, sat_u8((int32_t)(share / 10u)));
+}
+
+uint8_t anomaly_event_type(uint8_t anomaly)
+{
+    switch (anomaly)
+    {
+        case ANOMALY_SAG: return EVT_PACK_SAG;
+        case ANOMALY_HEAT: return EVT_OVERTEMP_WARN;
+        case ANOMALY_LINK: return EVT_COMM_FLAKY;
+        default: return EVT_NONE;
+    }
+}
+
+uint8_t anomaly_flags(uint8_t anomaly)
+{
+    return (anomaly < ANOMALY_COUNT) ? g_anomaly.st.last_flags[anomaly] : 0u;
+}
+
+void anomaly_get_stats(anomaly_stats_t *out)
+{
+    if (out)
+        *out = g_anomaly.st;
+}
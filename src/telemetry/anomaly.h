@@ -0,0 +1,89 @@
+/*
+ * Streaming anomaly detectors
+ *
+ * Cheap on-device checks that turn slow degradation into one event per
+ * episode instead of leaving it to offline analysis of the stream log. All
+ * state is a few words per detector, fixed point, O(1) per input:
+ *
+ *   SAG   pack voltage below what the current explains. The voltage is
+ *         compensated by I*R (R from battery_est) and a one-sided CUSUM
+ *         runs on its shortfall against a slow EWMA of the compensated
+ *         voltage, under load only. A weak cell or a loose connector sags
+ *         more than R predicts before R has caught up.
+ *   HEAT  controller temperature rising unusually fast: the rise over each
+ *         ANOMALY_HEAT_BLOCK_MS is compared with an EWMA mean and variance
+ *         of past rises (4 sigma, plus an absolute floor). A temperature
+ *         of 0 is "not reported" and restarts the block.
+ *   LINK  motor link errors: a one-sided CUSUM on the error share of each
+ *         ANOMALY_LINK_BLOCK_MS of frames.
+ *
+ * A detector that trips is latched: further trips only extend the episode,
+ * which ends ANOMALY_CLEAR_MS after the last one. The caller logs the
+ * anomalies an update returns; flags carry each one's magnitude.
+ *
+ * Usage:
+ *   1. anomaly_reset() at boot
+ *   2. anomaly_on_sample() for every sampler tick
+ *   3. anomaly_on_link() from the main loop with the cumulative counters
+ */
+
+#ifndef TELEMETRY_ANOMALY_H
+#define TELEMETRY_ANOMALY_H
+
+#include <stdint.h>
+
+#include "tlm_sampler.h"
+
+#define ANOMALY_SAG   0u
+#define ANOMALY_HEAT  1u
+#define ANOMALY_LINK  2u
+#define ANOMALY_COUNT 3u
+
+#define ANOMALY_CLEAR_MS 30000u
+
+/* SAG: shortfall in 0.1 V past the slack, summed over loaded samples. */
+#define ANOMALY_SAG_MIN_DA   50   /* below 5 A the sample is not checked */
+#define ANOMALY_SAG_SLACK_DV 10   /* 1 V of model error is normal */
+#define ANOMALY_SAG_LIMIT    500  /* e.g. 2 V short for a second at 50 Hz */
+#define ANOMALY_SAG_WARMUP   250u /* samples before the baseline is trusted */
+
+/* HEAT: rise in 0.1 C per block. */
+#define ANOMALY_HEAT_BLOCK_MS 5000u
+#define ANOMALY_HEAT_MIN_DC   20  /* 2 C in a block, whatever the spread */
+#define ANOMALY_HEAT_WARMUP   12u /* blocks */
+
+/* LINK: error share in per mille. */
+#define ANOMALY_LINK_BLOCK_MS 1000u
+#define ANOMALY_LINK_SLACK    50u   /* 5 % errors is tolerated */
+#define ANOMALY_LINK_LIMIT    1000u /* e.g. 25 % errors for 5 s */
+
+typedef struct {
+    uint32_t raised[ANOMALY_COUNT];  /* episodes */
+    uint32_t trips[ANOMALY_COUNT];   /* trips, episodes included */
+    uint8_t active;                  /* bit per detector in an episode */
+    uint8_t last_flags[ANOMALY_COUNT];
+    int16_t sag_base_dV;             /* compensated voltage baseline */
+    int16_t heat_mean_x16;           /* mean rise per block, 0.1 C x16 */
+    uint32_t heat_var_x16;           /* its variance, (0.1 C)^2 x16 */
+} anomaly_stats_t;
+
+void anomaly_reset(void);
+
+/* One sampler tick; r_mohm 0 (not estimated yet) skips the sag check.
+ * Returns a bit per anomaly raised by this sample. */
+uint8_t anomaly_on_sample(const tlm_tick_t *s, uint16_t r_mohm);
+
+/* Cumulative motor link counters, valid frames and errors of any kind;
+ * evaluated once per ANOMALY_LINK_BLOCK_MS. Returns as anomaly_on_sample. */
+uint8_t anomaly_on_link(uint32_t now_ms, uint32_t frames, uint32_t errors);
+
+/* Event log type and flags for a raised anomaly (storage/event_types.h):
+ * SAG EVT_PACK_SAG with the shortfall in 0.1 V, HEAT EVT_OVERTEMP_WARN
+ * with the rise in C per minute, LINK EVT_COMM_FLAKY with the error share
+ * in percent, each at the trip that raised it (saturating at 255). */
+uint8_t anomaly_event_type(uint8_t anomaly);
+uint8_t anomaly_flags(uint8_t anomaly);
+
+void anomaly_get_stats(anomaly_stats_t *out);
+
+#endif /* TELEMETRY_ANOMALY_H */
@@ -10,109 +10,256 @@
 
 #include "app_data.h"
 #include "app_state.h"
+#include "platform/ram.h"
 #include "platform/time.h"
 #include "src/control/control.h"
 #include "src/power/power.h"
+#include "src/power/battery_est.h"
 #include "storage/logs.h"
 #include "util/byteorder.h"
 
-/* Range estimation constants */
-#define RANGE_SAMPLE_MAX 32u
-#define RANGE_SAMPLE_MIN 8u
-#define RANGE_BATTERY_WH 500u
+/*
+ * Range estimation (v2)
+ *
+ * Two estimates, both updated in O(1) with 32-bit arithmetic:
+ *  - energy: Wh/mile per RANGE_SEG_M of riding (energy over distance of the
+ *    segment), smoothed with an EWMA; spread tracked as an EWMA of the
+ *    absolute deviation. Range = usable Wh / Wh per mile.
+ *  - SOC slope: one SOC point per segment in a RANGE_SOC_POINTS window; a
+ *    least-squares line through them gives %SOC per segment, kept as
+ *    sliding sums so dropping the oldest point is O(1). Range = SOC / slope.
+ * Each estimate carries a relative uncertainty in percent; they fuse by
+ * inverse variance, and the published confidence is 100 minus the fused
+ * uncertainty - i.e. roughly "within this many percent". SOC comes from
+ * the battery estimator, already sag-compensated, so neither pass smooths
+ * it again.
+ */
+#define RANGE_BATTERY_WH BATTERY_EST_PACK_WH
 #define RANGE_SPEED_MIN_DMPH 10u
-
-static uint16_t g_range_samples[RANGE_SAMPLE_MAX];
-static uint8_t g_range_head;
-static uint8_t g_range_sample_count;
-static uint64_t g_range_sum;
-static uint64_t g_range_sumsq;
+#define RANGE_SEG_M 200u
+/* dmph * ms per segment: 1 dmph for 1 ms is 0.044704 mm. */
+#define RANGE_SEG_DMPH_MS ((uint32_t)RANGE_SEG_M * 1000000u / 44704u)
+#define RANGE_SEG_MIN 8u            /* full confidence weight from here */
+#define RANGE_EWMA_SHIFT 3u         /* ~8 segments */
+#define RANGE_WHMI_MAX_D10 5000u    /* 500 Wh/mile: outliers clamp here */
+#define RANGE_SOC_POINTS 32u
+#define RANGE_SOC_MIN_POINTS 4u
+#define RANGE_SOC_MIN_DROP 2u       /* % over the window before trusting it */
+
+static uint32_t g_range_last_ms;
+static uint32_t g_range_seg_wms;        /* W * ms this segment */
+static uint32_t g_range_seg_dms;        /* dmph * ms this segment */
+static uint32_t g_range_whmi_acc;       /* EWMA, << RANGE_EWMA_SHIFT */
+static uint32_t g_range_dev_acc;        /* EWMA of |x - mean|, same scale */
+static uint8_t g_range_soc[RANGE_SOC_POINTS];
+static uint8_t g_range_soc_head;
+static uint8_t g_range_soc_n;
+static int32_t g_range_soc_s;           /* sum y */
+static int32_t g_range_soc_t;           /* sum i*y, i = 0 for the oldest */
+static int32_t g_range_soc_q;           /* sum y*y */
 
 uint16_t g_range_wh_per_mile_d10;
 uint16_t g_range_est_d10;
 uint8_t g_range_confidence;
 uint16_t g_range_count;
 
-static uint16_t range_sample_wh_per_mile_d10(uint16_t speed_dmph, uint16_t power_w)
+static uint32_t isqrt_u32(uint32_t v)
+{
+    uint32_t r = 0u;
+    uint32_t bit = 1uL << 30;
+    while (bit > v)
+        bit >>= 2;
+    while (bit)
+    {
+        if (v >= r + bit)
+        {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        }
+        else
+        {
+            r >>= 1;
+        }
+        bit >>= 2;
+    }
+    return r;
+}
+
+static uint16_t range_clamp_u16(uint32_t v)
+{
+    return (v > 0xFFFFu) ? 0xFFFFu : (uint16_t)v;
+}
+
+/* Wh/mile * 10 of energy over distance; 0 when there is no distance. */
+static uint16_t range_wh_per_mile_d10(uint32_t wms, uint32_t dms)
+{
+    if (dms == 0u)
+        return 0u;
+    /* (W*ms / dmph*ms) * 100 is Wh/mile * 10; split so nothing overflows. */
+    uint32_t v = (wms / dms) * 100u + ((wms % dms) * 100u + dms / 2u) / dms;
+    return (v > RANGE_WHMI_MAX_D10) ? (uint16_t)RANGE_WHMI_MAX_D10 : (uint16_t)v;
+}
+
+static void range_soc_push(uint8_t soc)
+{
+    if (g_range_soc_n == RANGE_SOC_POINTS)
+    {
+        uint8_t oldest = g_range_soc[g_range_soc_head];
+        g_range_soc_s -= oldest;
+        g_range_soc_q -= (int32_t)oldest * oldest;
+        /* The rest move down one index; the oldest had index 0. */
+        g_range_soc_t -= g_range_soc_s;
+        g_range_soc_n--;
+    }
+    g_range_soc[g_range_soc_head] = soc;
+    g_range_soc_head = (uint8_t)((g_range_soc_head + 1u) % RANGE_SOC_POINTS);
+    g_range_soc_t += (int32_t)g_range_soc_n * soc;
+    g_range_soc_s += soc;
+    g_range_soc_q += (int32_t)soc * soc;
+    g_range_soc_n++;
+}
+
+/*
+ * Range (0.1 mi) from the SOC slope; *unc_pct gets its relative
+ * uncertainty. Returns 0 while the window is too short or too flat.
+ */
+static uint16_t range_from_soc(uint8_t soc_pct, uint32_t *unc_pct)
 {
-    if (speed_dmph < RANGE_SPEED_MIN_DMPH || power_w == 0u)
+    int32_t n = g_range_soc_n;
+    if (n < (int32_t)RANGE_SOC_MIN_POINTS)
+        return 0u;
+    int32_t si = n * (n - 1) / 2;
+    int32_t dx = n * n * (n * n - 1) / 12;      /* n*sum(i^2) - sum(i)^2 */
+    int32_t num = n * g_range_soc_t - si * g_range_soc_s;
+    if (num >= 0)
+        return 0u;                              /* not discharging */
+    /* Fitted drop across the window: -slope * (n - 1). */
+    uint32_t drop = (uint32_t)(-num) * (uint32_t)(n - 1) / (uint32_t)dx;
+    if (drop < RANGE_SOC_MIN_DROP)
         return 0u;
-    return (uint16_t)(((uint32_t)power_w * 100u + (uint32_t)(speed_dmph / 2u)) / (uint32_t)speed_dmph);
+
+    /* Segments left = soc / -slope; slope = num / dx. */
+    uint32_t dist_m = (uint32_t)soc_pct * (uint32_t)dx / (uint32_t)(-num) * RANGE_SEG_M;
+    if (dist_m > 100000000u)
+        dist_m = 100000000u;
+
+    /* Uncertainty: the scatter about the line (sqrt(1 - r^2)), but never
+     * finer than one SOC step over the fitted drop. */
+    int32_t dy = n * g_range_soc_q - g_range_soc_s * g_range_soc_s;
+    uint32_t den = isqrt_u32((uint32_t)dx) * isqrt_u32((uint32_t)(dy > 0 ? dy : 0));
+    uint32_t r_pct = den ? (uint32_t)(-num) * 100u / den : 0u;
+    if (r_pct > 100u)
+        r_pct = 100u;
+    uint32_t unc = isqrt_u32(10000u - r_pct * r_pct);
+    uint32_t step = 100u / drop;
+    if (unc < step)
+        unc = step;
+    *unc_pct = unc;
+    return range_clamp_u16((dist_m * 10u + 804u) / 1609u);
 }
 
 void range_reset(void)
 {
-    memset(g_range_samples, 0, sizeof(g_range_samples));
-    g_range_head = 0u;
-    g_range_sample_count = 0u;
-    g_range_sum = 0u;
-    g_range_sumsq = 0u;
+    g_range_last_ms = 0u;
+    g_range_seg_wms = 0u;
+    g_range_seg_dms = 0u;
+    g_range_whmi_acc = 0u;
+    g_range_dev_acc = 0u;
+    memset(g_range_soc, 0, sizeof(g_range_soc));
+    g_range_soc_head = 0u;
+    g_range_soc_n = 0u;
+    g_range_soc_s = 0;
+    g_range_soc_t = 0;
+    g_range_soc_q = 0;
     g_range_wh_per_mile_d10 = 0u;
     g_range_est_d10 = 0u;
     g_range_confidence = 0u;
     g_range_count = 0u;
 }
 
-void range_update(uint16_t speed_dmph, uint16_t power_w, uint8_t soc_pct)
+void range_update(uint32_t now_ms, uint16_t speed_dmph, uint16_t power_w, uint16_t regen_w,
+                  uint8_t soc_pct)
 {
-    uint16_t sample = range_sample_wh_per_mile_d10(speed_dmph, power_w);
-    if (sample == 0u)
+    uint32_t dt = g_range_last_ms ? (uint32_t)(now_ms - g_range_last_ms) : 0u;
+    g_range_last_ms = now_ms;
+    if (dt == 0u || dt > 1000u || speed_dmph < RANGE_SPEED_MIN_DMPH)
         return;
 
-    if (g_range_sample_count < RANGE_SAMPLE_MAX)
+    g_range_seg_wms += (uint32_t)power_w * dt;
+    /* Net draw: a descent that charges the pack lowers the segment cost. */
+    uint32_t back = (uint32_t)regen_w * dt;
+    g_range_seg_wms = (g_range_seg_wms > back) ? g_range_seg_wms - back : 0u;
+    g_range_seg_dms += (uint32_t)speed_dmph * dt;
+
+    uint32_t whmi;
+    if (g_range_seg_dms >= RANGE_SEG_DMPH_MS)
+    {
+        uint32_t x = range_wh_per_mile_d10(g_range_seg_wms, g_range_seg_dms);
+        g_range_seg_wms = 0u;
+        g_range_seg_dms = 0u;
+        if (g_range_count == 0u)
+        {
+            g_range_whmi_acc = x << RANGE_EWMA_SHIFT;
+            g_range_dev_acc = 0u;
+        }
+        else
+        {
+            uint32_t mean = g_range_whmi_acc >> RANGE_EWMA_SHIFT;
+            uint32_t dev = (x > mean) ? x - mean : mean - x;
+            g_range_whmi_acc += x - mean;       /* wraps to subtract when x < mean */
+            g_range_dev_acc += dev - (g_range_dev_acc >> RANGE_EWMA_SHIFT);
+        }
+        if (g_range_count < 0xFFFFu)
+            g_range_count++;
+        range_soc_push(soc_pct);
+        whmi = g_range_whmi_acc >> RANGE_EWMA_SHIFT;
+    }
+    else if (g_range_count == 0u)
     {
-        g_range_samples[g_range_head] = sample;
-        g_range_sum += sample;
-        g_range_sumsq += (uint64_t)sample * (uint64_t)sample;
-        g_range_sample_count++;
+        /* Before the first full segment, the partial one stands in. */
+        whmi = range_wh_per_mile_d10(g_range_seg_wms, g_range_seg_dms);
     }
     else
     {
-        uint16_t old = g_range_samples[g_range_head];
-        g_range_samples[g_range_head] = sample;
-        g_range_sum -= old;
-        g_range_sumsq -= (uint64_t)old * (uint64_t)old;
-        g_range_sum += sample;
-        g_range_sumsq += (uint64_t)sample * (uint64_t)sample;
-    }
-
-    g_range_head = (uint8_t)((g_range_head + 1u) % RANGE_SAMPLE_MAX);
-    g_range_count = g_range_sample_count;
-
-    if (g_range_sample_count == 0u)
         return;
-
-    uint64_t mean = g_range_sum / g_range_sample_count;
-    g_range_wh_per_mile_d10 = (uint16_t)mean;
-
-    uint64_t mean_sq = mean * mean;
-    uint64_t avg_sq = g_range_sumsq / g_range_sample_count;
-    uint64_t var = (avg_sq > mean_sq) ? (avg_sq - mean_sq) : 0u;
-
-    uint8_t conf = 0u;
-    if (mean_sq > 0u)
+    }
+    g_range_wh_per_mile_d10 = (uint16_t)whmi;
+    if (whmi == 0u)
     {
-        uint64_t ratio = (var * 100u) / mean_sq;
-        if (ratio > 100u)
-            ratio = 100u;
-        conf = (uint8_t)(100u - (uint8_t)ratio);
-        if (g_range_sample_count < RANGE_SAMPLE_MIN)
-            conf = (uint8_t)((uint16_t)conf * g_range_sample_count / RANGE_SAMPLE_MIN);
+        g_range_est_d10 = 0u;
+        g_range_confidence = 0u;
+        return;
     }
-    g_range_confidence = conf;
 
+    /* Energy estimate; uncertainty is the segment spread, sigma ~ 1.25 MAD,
+     * eased in over the first RANGE_SEG_MIN segments. */
     uint32_t available_wh = ((uint32_t)RANGE_BATTERY_WH * (uint32_t)soc_pct + 50u) / 100u;
-    if (g_range_wh_per_mile_d10 > 0u)
-    {
-        uint32_t est = (available_wh * 100u + (g_range_wh_per_mile_d10 / 2u)) / g_range_wh_per_mile_d10;
-        if (est > 0xFFFFu)
-            est = 0xFFFFu;
-        g_range_est_d10 = (uint16_t)est;
-    }
-    else
+    uint32_t est_e = range_clamp_u16((available_wh * 100u + (whmi / 2u)) / whmi);
+    uint32_t unc_e = (125u * (g_range_dev_acc >> RANGE_EWMA_SHIFT)) / whmi;
+    if (unc_e > 100u)
+        unc_e = 100u;
+    if (g_range_count < RANGE_SEG_MIN)
+        unc_e = 100u - (100u - unc_e) * g_range_count / RANGE_SEG_MIN;
+    if (unc_e == 0u)
+        unc_e = 1u;
+
+    uint32_t unc_s = 0u;
+    uint32_t est_s = range_from_soc(soc_pct, &unc_s);
+    uint32_t est = est_e;
+    uint32_t unc = unc_e;
+    if (est_s && unc_s < 100u)
     {
-        g_range_est_d10 = 0u;
+        /* Inverse-variance weights, w = 10000 / u^2. */
+        uint32_t we = 10000u / (unc_e * unc_e);
+        uint32_t ws = 10000u / (unc_s * unc_s);
+        if (we + ws)
+        {
+            est = (we * est_e + ws * est_s + (we + ws) / 2u) / (we + ws);
+            unc = unc_e * unc_s / isqrt_u32(unc_e * unc_e + unc_s * unc_s);
+        }
     }
+    g_range_est_d10 = (uint16_t)est;
+    g_range_confidence = (uint8_t)((unc >= 100u) ? 0u : 100u - unc);
 }
 
 void range_get(range_estimate_t *out)
@@ -127,29 +274,30 @@ void range_get(range_estimate_t *out)
 /* -------------------------------------------------------------
  * Speed ring buffer
  * ------------------------------------------------------------- */
-static ringbuf_i16_t g_speed_rb;
-static int16_t g_speed_storage[64];     /* power-of-two for O(1) wrap */
-static uint16_t g_speed_min_idx[64];
-static uint16_t g_speed_max_idx[64];
+/* Delta-coded: 16 blocks of 16 samples give ~4x the horizon of the old
+ * 64-slot ring in about the same RAM. */
+static dring_i16_t g_speed_rb;
+static dring_block_t g_speed_blocks[16]; /* power-of-two for O(1) wrap */
+static uint16_t g_speed_min_idx[16];
+static uint16_t g_speed_max_idx[16];
 
 void speed_rb_init(void)
 {
-    ringbuf_i16_init(&g_speed_rb, g_speed_storage,
-                     (uint16_t)(sizeof(g_speed_storage) / sizeof(g_speed_storage[0])),
-                     g_speed_min_idx, g_speed_max_idx);
-    ringbuf_i16_reset(&g_speed_rb);
+    dring_i16_init(&g_speed_rb, g_speed_blocks,
+                   (uint16_t)(sizeof(g_speed_blocks) / sizeof(g_speed_blocks[0])),
+                   g_speed_min_idx, g_speed_max_idx);
 }
 
 void speed_rb_push(uint16_t speed_dmph)
 {
-    ringbuf_i16_push(&g_speed_rb, (int16_t)speed_dmph);
+    dring_i16_push(&g_speed_rb, (int16_t)speed_dmph);
 }
 
 void speed_rb_summary(ringbuf_i16_summary_t *out)
 {
     if (!out)
         return;
-    ringbuf_i16_summary(&g_speed_rb, out);
+    dring_i16_summary(&g_speed_rb, out);
 }
 
 /* -------------------------------------------------------------
@@ -168,135 +316,104 @@ typedef enum {
     GRAPH_WIN_30S = 0,
     GRAPH_WIN_2M  = 1,
     GRAPH_WIN_10M = 2,
-    GRAPH_WIN_COUNT = 3
+    GRAPH_WIN_1H  = 3,
+    GRAPH_WIN_COUNT = 4
 } graph_window_t;
 
-#define GRAPH_CAPACITY 256u /* power-of-two */
-#define GRAPH_WINDOW_30S_MS 30000u
-#define GRAPH_WINDOW_2M_MS  120000u
-#define GRAPH_WINDOW_10M_MS 600000u
-#define GRAPH_PERIOD_MS(window_ms) ((uint16_t)(((window_ms) + (GRAPH_CAPACITY / 2u)) / GRAPH_CAPACITY))
+/*
+ * One min/max/mean pyramid per channel. Level 0 closes a cell every
+ * GRAPH_BASE_MS from the sampler ticks in that period (25 at 50 Hz); levels above
+ * fold 4, 5 and 6 cells of the one below, so 64 cells per level reach
+ * 32 s, 128 s, 640 s and 64 min - each preset window is served by ~60
+ * cells of the finest level that covers it, and an arbitrary window by the
+ * finest level that does.
+ */
+#define GRAPH_BASE_MS     500u
+#define GRAPH_LEVEL_CELLS 64u
+#define GRAPH_LEVELS      4u
+
+static const uint8_t g_graph_factor[GRAPH_LEVELS] = { 1u, 4u, 5u, 6u };
 
-static const uint16_t g_graph_period_ms[GRAPH_WIN_COUNT] = {
-    GRAPH_PERIOD_MS(GRAPH_WINDOW_30S_MS),
-    GRAPH_PERIOD_MS(GRAPH_WINDOW_2M_MS),
-    GRAPH_PERIOD_MS(GRAPH_WINDOW_10M_MS),
-};
 const uint16_t g_graph_window_s[GRAPH_WIN_COUNT] = {
-    30u, 120u, 600u
+    30u, 120u, 600u, 3600u
 };
 
-static ringbuf_i16_t g_graph_rb[GRAPH_CH_COUNT][GRAPH_WIN_COUNT];
-static int16_t g_graph_storage[GRAPH_CH_COUNT][GRAPH_WIN_COUNT][GRAPH_CAPACITY];
-static uint16_t g_graph_min_idx[GRAPH_CH_COUNT][GRAPH_WIN_COUNT][GRAPH_CAPACITY];
-static uint16_t g_graph_max_idx[GRAPH_CH_COUNT][GRAPH_WIN_COUNT][GRAPH_CAPACITY];
-static uint32_t g_graph_last_tick_ms[GRAPH_CH_COUNT][GRAPH_WIN_COUNT];
-static int16_t g_graph_last_value[GRAPH_CH_COUNT];
-static int16_t g_graph_pending_value[GRAPH_CH_COUNT];
-static uint8_t g_graph_pending[GRAPH_CH_COUNT];
+static pyramid_i16_t g_graph_pyr[GRAPH_CH_COUNT];
+/* Read only below each level's head, which starts at zero. */
+static pyramid_cell_t g_graph_cells[GRAPH_CH_COUNT][GRAPH_LEVELS * GRAPH_LEVEL_CELLS] RAM_NOZERO;
+static uint32_t g_graph_last_tick_ms[GRAPH_CH_COUNT];
 static uint8_t g_graph_enabled[GRAPH_CH_COUNT];
+static tlm_tick_t g_graph_last;       /* newest sample, seeds a reset */
+static uint8_t g_graph_have_sample;
 static uint8_t g_graph_active_channel = GRAPH_CH_SPEED;
 static uint8_t g_graph_active_window = GRAPH_WIN_30S;
 
-static uint16_t graph_window_ms(uint16_t capacity, uint16_t period_ms)
+static uint32_t graph_level_period_ms(uint8_t level)
 {
-    uint32_t window = (uint32_t)capacity * (uint32_t)period_ms;
-    if (window > 0xFFFFu)
-        window = 0xFFFFu;
-    return (uint16_t)window;
+    uint32_t period = GRAPH_BASE_MS;
+    for (uint8_t i = 1; i <= level && i < GRAPH_LEVELS; ++i)
+        period *= g_graph_factor[i];
+    return period;
 }
 
-static int16_t graph_channel_sample(uint8_t channel)
+static int16_t graph_channel_sample(const tlm_tick_t *s, uint8_t channel)
 {
     switch (channel)
     {
-    case GRAPH_CH_SPEED: return (int16_t)g_inputs.speed_dmph;
-    case GRAPH_CH_POWER: return (int16_t)g_inputs.power_w;
-    case GRAPH_CH_VOLT:  return g_inputs.battery_dV;
-    case GRAPH_CH_CAD:   return (int16_t)g_inputs.cadence_rpm;
-    case GRAPH_CH_TEMP:  return g_inputs.ctrl_temp_dC;
+    case GRAPH_CH_SPEED: return (int16_t)s->speed_dmph;
+    case GRAPH_CH_POWER: return (int16_t)s->power_w;
+    case GRAPH_CH_VOLT:  return s->battery_dV;
+    case GRAPH_CH_CAD:   return (int16_t)s->cadence_rpm;
+    case GRAPH_CH_TEMP:  return s->ctrl_temp_dC;
     default:             return 0;
     }
 }
 
-static void graph_reset_channel(uint8_t channel, int16_t seed)
+static void graph_reset_channel(uint8_t channel, const tlm_tick_t *s)
 {
     if (channel >= GRAPH_CH_COUNT)
         return;
-    for (uint8_t win = 0; win < GRAPH_WIN_COUNT; ++win)
-    {
-        ringbuf_i16_reset(&g_graph_rb[channel][win]);
-        uint16_t period = g_graph_period_ms[win];
-        if (period == 0)
-            g_graph_last_tick_ms[channel][win] = g_ms;
-        else
-            g_graph_last_tick_ms[channel][win] = g_ms - (g_ms % period);
-    }
-    g_graph_last_value[channel] = seed;
-    g_graph_pending_value[channel] = seed;
-    g_graph_pending[channel] = 0;
+    pyramid_i16_reset(&g_graph_pyr[channel]);
+    pyramid_i16_add(&g_graph_pyr[channel], graph_channel_sample(s, channel));
+    g_graph_last_tick_ms[channel] = s->ms - (s->ms % GRAPH_BASE_MS);
     g_graph_enabled[channel] = 1;
 }
 
-static void graph_on_input_channel(uint8_t channel, int16_t sample)
-{
-    if (channel >= GRAPH_CH_COUNT)
-        return;
-    if (!g_graph_enabled[channel])
-        graph_reset_channel(channel, sample);
-    g_graph_pending_value[channel] = sample;
-    g_graph_pending[channel] = 1;
-}
-
 void graph_init(void)
 {
     for (uint8_t ch = 0; ch < GRAPH_CH_COUNT; ++ch)
     {
-        for (uint8_t win = 0; win < GRAPH_WIN_COUNT; ++win)
-        {
-            ringbuf_i16_init(&g_graph_rb[ch][win], g_graph_storage[ch][win],
-                             (uint16_t)(sizeof(g_graph_storage[ch][win]) / sizeof(g_graph_storage[ch][win][0])),
-                             g_graph_min_idx[ch][win], g_graph_max_idx[ch][win]);
-            ringbuf_i16_reset(&g_graph_rb[ch][win]);
-            g_graph_last_tick_ms[ch][win] = 0;
-        }
+        pyramid_i16_init(&g_graph_pyr[ch], g_graph_cells[ch], GRAPH_LEVEL_CELLS,
+                         GRAPH_LEVELS, g_graph_factor);
+        g_graph_last_tick_ms[ch] = 0;
         g_graph_enabled[ch] = 0;
-        g_graph_pending[ch] = 0;
-        g_graph_last_value[ch] = 0;
-        g_graph_pending_value[ch] = 0;
     }
+    g_graph_have_sample = 0;
     g_graph_active_channel = GRAPH_CH_SPEED;
     g_graph_active_window = GRAPH_WIN_30S;
 }
 
-void graph_on_input_all(void)
-{
-    for (uint8_t ch = 0; ch < GRAPH_CH_COUNT; ++ch)
-        graph_on_input_channel(ch, graph_channel_sample(ch));
-}
-
-void graph_tick(void)
+void graph_on_sample(const tlm_tick_t *s)
 {
-    uint32_t now = g_ms;
+    if (!s)
+        return;
     for (uint8_t ch = 0; ch < GRAPH_CH_COUNT; ++ch)
     {
         if (!g_graph_enabled[ch])
+        {
+            graph_reset_channel(ch, s);
             continue;
-        for (uint8_t win = 0; win < GRAPH_WIN_COUNT; ++win)
+        }
+        /* Dropped samples close the missed periods with the latest value. */
+        while ((uint32_t)(s->ms - g_graph_last_tick_ms[ch]) >= GRAPH_BASE_MS)
         {
-            uint16_t period = g_graph_period_ms[win];
-            if (period == 0)
-                continue;
-            while ((uint32_t)(now - g_graph_last_tick_ms[ch][win]) >= period)
-            {
-                int16_t sample = g_graph_pending[ch] ? g_graph_pending_value[ch] : g_graph_last_value[ch];
-                ringbuf_i16_push(&g_graph_rb[ch][win], sample);
-                g_graph_last_value[ch] = sample;
-                g_graph_pending[ch] = 0;
-                g_graph_last_tick_ms[ch][win] += period;
-            }
+            pyramid_i16_commit(&g_graph_pyr[ch]);
+            g_graph_last_tick_ms[ch] += GRAPH_BASE_MS;
         }
+        pyramid_i16_add(&g_graph_pyr[ch], graph_channel_sample(s, ch));
     }
+    g_graph_last = *s;
+    g_graph_have_sample = 1;
 }
 
 int graph_set_active(uint8_t channel, uint8_t window, uint8_t reset)
@@ -305,8 +422,11 @@ int graph_set_active(uint8_t channel, uint8_t window, uint8_t reset)
         return 0;
     g_graph_active_channel = channel;
     g_graph_active_window = window;
-    if (reset)
-        graph_reset_channel(channel, graph_channel_sample(channel));
+    /* Reseed from the newest sample; with none yet the next one does it. */
+    if (reset && g_graph_have_sample)
+        graph_reset_channel(channel, &g_graph_last);
+    else if (reset)
+        g_graph_enabled[channel] = 0;
     return 1;
 }
 
@@ -318,15 +438,87 @@ void graph_get_active(uint8_t *channel, uint8_t *window)
         *window = g_graph_active_window;
 }
 
+/* Finest level whose ring covers window_ms, and the cells spanning it. */
+static uint8_t graph_level_for(uint32_t window_ms, uint32_t *cells_out)
+{
+    uint8_t level = 0;
+    while (level + 1u < GRAPH_LEVELS &&
+           graph_level_period_ms(level) * GRAPH_LEVEL_CELLS < window_ms)
+        level++;
+    uint32_t period = graph_level_period_ms(level);
+    uint32_t cells = (window_ms + period - 1u) / period;
+    if (cells > GRAPH_LEVEL_CELLS)
+        cells = GRAPH_LEVEL_CELLS;
+    *cells_out = cells;
+    return level;
+}
+
+int graph_get_summary(uint8_t channel, uint32_t window_ms, graph_summary_t *out)
+{
+    if (!out || channel >= GRAPH_CH_COUNT || window_ms == 0u)
+        return 0;
+    uint32_t cells;
+    uint8_t level = graph_level_for(window_ms, &cells);
+    uint32_t period = graph_level_period_ms(level);
+
+    pyramid_i16_summary_t ps;
+    pyramid_i16_summary(&g_graph_pyr[channel], level, (uint16_t)cells, &ps);
+    out->channel = channel;
+    out->window = 0xFFu;
+    out->summary.count = ps.count;
+    out->summary.capacity = ps.capacity;
+    out->summary.min = ps.min;
+    out->summary.max = ps.max;
+    out->summary.latest = ps.latest;
+    out->mean = ps.mean;
+    out->period_ms = (period > 0xFFFFu) ? 0xFFFFu : (uint16_t)period;
+    uint32_t span_ms = cells * period;
+    out->window_ms = (span_ms > 0xFFFFu) ? 0xFFFFu : (uint16_t)span_ms;
+    out->window_s = (uint16_t)((span_ms + 500u) / 1000u);
+    return 1;
+}
+
+uint16_t graph_get_columns(uint8_t channel, uint32_t window_ms, uint16_t cols,
+                           int16_t *min, int16_t *max, uint32_t *last_col)
+{
+    if (channel >= GRAPH_CH_COUNT || window_ms == 0u)
+        return 0u;
+    uint32_t cells;
+    uint8_t level = graph_level_for(window_ms, &cells);
+    return pyramid_i16_columns(&g_graph_pyr[channel], level, (uint16_t)cells, cols, min, max,
+                               last_col);
+}
+
+void graph_get_layout(uint8_t *channels, uint8_t *levels, uint16_t *cells)
+{
+    if (channels)
+        *channels = GRAPH_CH_COUNT;
+    if (levels)
+        *levels = GRAPH_LEVELS;
+    if (cells)
+        *cells = GRAPH_LEVEL_CELLS;
+}
+
+uint32_t graph_get_period_ms(uint8_t level)
+{
+    return (level < GRAPH_LEVELS) ? graph_level_period_ms(level) : 0u;
+}
+
+uint16_t graph_get_cells(uint8_t channel, uint8_t level, uint32_t first, uint16_t max,
+                         pyramid_cell_t *out, uint32_t *first_out, uint32_t *head)
+{
+    if (channel >= GRAPH_CH_COUNT || level >= GRAPH_LEVELS)
+        return 0u;
+    if (head)
+        *head = g_graph_pyr[channel].head[level];
+    return pyramid_i16_cells(&g_graph_pyr[channel], level, first, max, out, first_out);
+}
+
 void graph_get_active_summary(graph_summary_t *out)
 {
     if (!out)
         return;
-    ringbuf_i16_summary_t s;
-    ringbuf_i16_summary(&g_graph_rb[g_graph_active_channel][g_graph_active_window], &s);
-    out->channel = g_graph_active_channel;
+    (void)graph_get_summary(g_graph_active_channel,
+                            (uint32_t)g_graph_window_s[g_graph_active_window] * 1000u, out);
     out->window = g_graph_active_window;
-    out->summary = s;
-    out->period_ms = g_graph_period_ms[g_graph_active_window];
-    out->window_ms = graph_window_ms(s.capacity, out->period_ms);
 }
@@ -4,6 +4,7 @@
 #include <stdint.h>
 
 #include "core.h"
+#include "tlm_sampler.h"
 
 /* Trip statistics */
 typedef struct {
@@ -23,13 +24,15 @@ typedef struct {
     uint16_t wh_per_km_d10;     /* Wh/km * 10 */
 } range_estimate_t;
 
-/* Graph summary */
+/* Graph summary (count/capacity in cells of period_ms) */
 typedef struct {
     uint8_t channel;
-    uint8_t window;
+    uint8_t window;             /* preset index, 0xFF for graph_get_summary */
     ringbuf_i16_summary_t summary;
-    uint16_t period_ms;
-    uint16_t window_ms;
+    int16_t mean;               /* mean of the cell means */
+    uint16_t period_ms;         /* cell length at the level used */
+    uint16_t window_ms;         /* span covered, saturates at 65535 */
+    uint16_t window_s;
 } graph_summary_t;
 
 /* API declarations - see trip.h for detailed trip tracking */
@@ -37,10 +40,13 @@ void trip_reset(void);
 void trip_snapshot(trip_stats_t *out);
 
 void range_reset(void);
-void range_update(uint16_t speed_dmph, uint16_t power_w, uint8_t soc_pct);
+/* regen_w is power back into the pack; it comes off the segment's draw. */
+void range_update(uint32_t now_ms, uint16_t speed_dmph, uint16_t power_w, uint16_t regen_w,
+                  uint8_t soc_pct);
 void range_get(range_estimate_t *out);
 
-/* Range estimate globals (defined in main.c for now). */
+/* Range estimate globals. Confidence is 100 minus the estimated relative
+ * error of g_range_est_d10 in percent; g_range_count counts segments. */
 extern uint16_t g_range_wh_per_mile_d10;
 extern uint16_t g_range_est_d10;
 extern uint8_t g_range_confidence;
@@ -51,13 +57,30 @@ void speed_rb_push(uint16_t speed_dmph);
 void speed_rb_summary(ringbuf_i16_summary_t *out);
 
 void graph_init(void);
-void graph_on_input_all(void);
-void graph_tick(void);
+/* One sampler tick: closes the cells it passed, then adds it. */
+void graph_on_sample(const tlm_tick_t *s);
 int graph_set_active(uint8_t channel, uint8_t window, uint8_t reset);
 void graph_get_active(uint8_t *channel, uint8_t *window);
 void graph_get_active_summary(graph_summary_t *out);
+/* Any window up to ~64 min, served by the finest pyramid level covering it.
+ * Returns 0 for an unknown channel or a zero window. */
+int graph_get_summary(uint8_t channel, uint32_t window_ms, graph_summary_t *out);
+/* Per-column min/max over the same window, oldest first, for strip-chart
+ * rendering; returns the columns written (fewer while history is short).
+ * Column numbers are stable as the window slides (pyramid_i16_columns). */
+uint16_t graph_get_columns(uint8_t channel, uint32_t window_ms, uint16_t cols,
+                           int16_t *min, int16_t *max, uint32_t *last_col);
 
-/* Graph window labels (seconds) - defined in telemetry.c. */
+/* Bulk export (comm 0x64): the pyramid layout, each level's cell length
+ * (0 past the last level) and its closed cells by absolute number
+ * (pyramid_i16_cells). graph_get_cells returns 0 for an unknown channel or
+ * level; *head gets the level's cell count. */
+void graph_get_layout(uint8_t *channels, uint8_t *levels, uint16_t *cells);
+uint32_t graph_get_period_ms(uint8_t level);
+uint16_t graph_get_cells(uint8_t channel, uint8_t level, uint32_t first, uint16_t max,
+                         pyramid_cell_t *out, uint32_t *first_out, uint32_t *head);
+
+/* Graph window presets (seconds), GRAPH_WIN_COUNT of them - defined in telemetry.c. */
 extern const uint16_t g_graph_window_s[];
 
 #endif /* TELEMETRY_H */
@@ -0,0 +1,114 @@
+/*
+ * Fixed-rate telemetry sampler (see tlm_sampler.h)
+ */
+
+#include "tlm_sampler.h"
+
+#include "app_data.h"
+#include "control/control.h"
+
+#ifdef HOST_TEST
+    #define MEMORY_BARRIER()  __asm__ volatile("" ::: "memory")
+#else
+    #include "platform/stm32f1xx.h"
+    #define MEMORY_BARRIER()  __DMB()
+#endif
+
+#define TLM_SAMPLER_MASK (TLM_SAMPLER_DEPTH - 1u)
+
+_Static_assert((TLM_SAMPLER_DEPTH & TLM_SAMPLER_MASK) == 0u, "depth must be a power of two");
+
+static tlm_tick_t g_tlm_ring[TLM_SAMPLER_DEPTH];
+static volatile uint16_t g_tlm_head;   /* written by the ISR only */
+static volatile uint16_t g_tlm_tail;   /* written by the main loop only */
+static volatile uint8_t g_tlm_ready;
+static uint32_t g_tlm_next_ms;
+static tlm_sampler_stats_t g_tlm_stats;
+
+void tlm_sampler_init(void)
+{
+    g_tlm_ready = 0u;
+    MEMORY_BARRIER();
+    g_tlm_head = 0u;
+    g_tlm_tail = 0u;
+    g_tlm_next_ms = 0u;
+    g_tlm_stats.taken = 0u;
+    g_tlm_stats.dropped = 0u;
+    g_tlm_stats.hwm = 0u;
+    MEMORY_BARRIER();
+    g_tlm_ready = 1u;
+}
+
+void tlm_sampler_isr_tick(uint32_t now_ms)
+{
+    if (!g_tlm_ready)
+        return;
+    if (g_tlm_next_ms == 0u)
+    {
+        g_tlm_next_ms = now_ms - (now_ms % TLM_SAMPLER_PERIOD_MS);
+        if (g_tlm_next_ms != now_ms)
+            g_tlm_next_ms += TLM_SAMPLER_PERIOD_MS;
+    }
+    if ((int32_t)(now_ms - g_tlm_next_ms) < 0)
+        return;
+    g_tlm_next_ms += TLM_SAMPLER_PERIOD_MS;
+    /* Missed ticks (the polled timebase) re-anchor instead of bursting. */
+    if ((int32_t)(now_ms - g_tlm_next_ms) >= 0)
+        g_tlm_next_ms = now_ms - (now_ms % TLM_SAMPLER_PERIOD_MS) + TLM_SAMPLER_PERIOD_MS;
+
+    uint16_t head = g_tlm_head;
+    uint16_t depth = (uint16_t)((head - g_tlm_tail) & 0xFFFFu);
+    if (depth >= TLM_SAMPLER_DEPTH)
+    {
+        g_tlm_stats.dropped++;
+        return;
+    }
+
+    tlm_tick_t *s = &g_tlm_ring[head & TLM_SAMPLER_MASK];
+    s->ms = now_ms;
+    s->speed_dmph = g_inputs.speed_dmph;
+    s->cadence_rpm = g_inputs.cadence_rpm;
+    s->power_w = g_inputs.power_w;
+    s->cmd_power_w = g_outputs.cmd_power_w;
+    s->battery_dV = g_inputs.battery_dV;
+    s->battery_dA = g_inputs.battery_dA;
+    s->ctrl_temp_dC = g_inputs.ctrl_temp_dC;
+    s->assist_mode = g_outputs.assist_mode;
+    s->virtual_gear = g_outputs.virtual_gear;
+    s->profile_id = g_outputs.profile_id;
+    s->soc_pct = g_motor.soc_pct;
+    s->flags = (uint8_t)((g_inputs.brake ? TLM_SAMPLE_F_BRAKE : 0u) |
+                         (g_walk_state == WALK_STATE_ACTIVE ? TLM_SAMPLE_F_WALK : 0u));
+
+    /* Sample lands before the head that publishes it. */
+    MEMORY_BARRIER();
+    g_tlm_head = (uint16_t)(head + 1u);
+
+    g_tlm_stats.taken++;
+    if (depth + 1u > g_tlm_stats.hwm)
+        g_tlm_stats.hwm = (uint16_t)(depth + 1u);
+}
+
+int tlm_sampler_pop(tlm_tick_t *out)
+{
+    if (!out)
+        return 0;
+    uint16_t tail = g_tlm_tail;
+    if (g_tlm_head == tail)
+        return 0;
+    MEMORY_BARRIER();
+    *out = g_tlm_ring[tail & TLM_SAMPLER_MASK];
+    /* Slot is copied out before the ISR may reuse it. */
+    MEMORY_BARRIER();
+    g_tlm_tail = (uint16_t)(tail + 1u);
+    return 1;
+}
+
+void tlm_sampler_get_stats(tlm_sampler_stats_t *out)
+{
+    if (!out)
+        return;
+    out->taken = g_tlm_stats.taken;
+    out->dropped = g_tlm_stats.dropped;
+    out->hwm = g_tlm_stats.hwm;
+}
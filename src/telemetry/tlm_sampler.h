@@ -0,0 +1,63 @@
+/*
+ * Fixed-rate telemetry sampler
+ *
+ * The TIM2 tick snapshots the live inputs every TLM_SAMPLER_PERIOD_MS into
+ * a lock-free SPSC ring; the main loop drains it and feeds every telemetry
+ * consumer (graphs, stream log, range, trip) with the sample's own
+ * timestamp. A long redraw then delays the consumers but no longer changes
+ * the spacing they see.
+ *
+ * The ISR is the only producer and the main loop the only consumer. Each
+ * field is one aligned 16-bit (or 8-bit) read, so a snapshot never holds a
+ * torn value; fields written by the main loop in the same iteration may mix
+ * old and new, which is at most one main-loop pass of skew. When the ring
+ * is full the new sample is dropped and counted, so consumers see the gap
+ * as a jump in ms rather than as compressed time.
+ *
+ * Usage:
+ *   1. tlm_sampler_init() once g_inputs/g_outputs are set up
+ *   2. tlm_sampler_isr_tick() from the TIM2 tick
+ *   3. tlm_sampler_pop() until empty, once per main loop pass
+ */
+
+#ifndef TELEMETRY_TLM_SAMPLER_H
+#define TELEMETRY_TLM_SAMPLER_H
+
+#include <stdint.h>
+
+#define TLM_SAMPLER_PERIOD_MS 20u  /* 4 TIM2 ticks, 50 Hz */
+#define TLM_SAMPLER_DEPTH     32u  /* power-of-two; 640 ms of main-loop stall */
+
+#define TLM_SAMPLE_F_BRAKE 0x01u
+#define TLM_SAMPLE_F_WALK  0x02u
+
+typedef struct {
+    uint32_t ms;
+    uint16_t speed_dmph;
+    uint16_t cadence_rpm;
+    uint16_t power_w;
+    uint16_t cmd_power_w;
+    int16_t  battery_dV;
+    int16_t  battery_dA;
+    int16_t  ctrl_temp_dC;
+    uint8_t  assist_mode;
+    uint8_t  virtual_gear;
+    uint8_t  profile_id;
+    uint8_t  soc_pct;
+    uint8_t  flags;        /* TLM_SAMPLE_F_* */
+} tlm_tick_t;
+
+typedef struct {
+    uint32_t taken;
+    uint32_t dropped;
+    uint16_t hwm;          /* deepest the ring has been */
+} tlm_sampler_stats_t;
+
+void tlm_sampler_init(void);
+/* TIM2 context; takes a sample when now_ms reaches the next period. */
+void tlm_sampler_isr_tick(uint32_t now_ms);
+/* Main loop; returns 0 when the ring is empty. */
+int tlm_sampler_pop(tlm_tick_t *out);
+void tlm_sampler_get_stats(tlm_sampler_stats_t *out);
+
+#endif /* TELEMETRY_TLM_SAMPLER_H */
@@ -0,0 +1,165 @@
+/*
+ * Telemetry Stream v2 - Implementation
+ *
+ * Pure encoder: the caller supplies the sample and the clock, and sends the
+ * payload it gets back, so the same code runs on target and in host tests.
+ */
+
+#include "tlm_stream.h"
+
+#include "../../util/byteorder.h"
+
+/* Field widths (bytes) and groups, indexed by TLM_F_*. */
+static const uint8_t k_width[TLM_FIELD_COUNT] = {
+    2, 2, 2, 2, 2, 2, 2, 2,     /* fast */
+    2, 2, 1,                    /* slow */
+    1, 1, 1, 1, 1,              /* state */
+};
+
+static const uint8_t k_group[TLM_FIELD_COUNT] = {
+    TLM_GROUP_FAST, TLM_GROUP_FAST, TLM_GROUP_FAST, TLM_GROUP_FAST,
+    TLM_GROUP_FAST, TLM_GROUP_FAST, TLM_GROUP_FAST, TLM_GROUP_FAST,
+    TLM_GROUP_SLOW, TLM_GROUP_SLOW, TLM_GROUP_SLOW,
+    TLM_GROUP_STATE, TLM_GROUP_STATE, TLM_GROUP_STATE, TLM_GROUP_STATE,
+    TLM_GROUP_STATE,
+};
+
+uint8_t tlm_stream_field_width(uint8_t field) {
+    return (field < TLM_FIELD_COUNT) ? k_width[field] : 0u;
+}
+
+uint8_t tlm_stream_field_group(uint8_t field) {
+    return (field < TLM_FIELD_COUNT) ? k_group[field] : TLM_GROUP_COUNT;
+}
+
+void tlm_stream_configure(tlm_stream_t *s, uint16_t mask,
+                          const uint16_t period_ms[TLM_GROUP_COUNT],
+                          uint16_t keyframe_ms) {
+    if (!s) {
+        return;
+    }
+    s->mask = (uint16_t)(mask & ((1u << TLM_FIELD_COUNT) - 1u));
+    for (uint8_t g = 0; g < TLM_GROUP_COUNT; g++) {
+        uint16_t p = period_ms ? period_ms[g] : 0u;
+        if (p && p < TLM_PERIOD_MIN_MS) {
+            p = TLM_PERIOD_MIN_MS;
+        }
+        s->period_ms[g] = p;
+    }
+    if (keyframe_ms == 0u) {
+        keyframe_ms = TLM_KEYFRAME_DEF_MS;
+    } else if (keyframe_ms < TLM_KEYFRAME_MIN_MS) {
+        keyframe_ms = TLM_KEYFRAME_MIN_MS;
+    }
+    s->keyframe_ms = keyframe_ms;
+    s->need_key = 1u;
+}
+
+static uint16_t field_value(const tlm_sample_t *cur, uint8_t f) {
+    return (k_width[f] == 2u) ? cur->v[f] : (uint16_t)(cur->v[f] & 0xFFu);
+}
+
+/* Fields of `mask` whose group is set in `groups`. */
+static uint16_t fields_in_groups(uint16_t mask, uint8_t groups) {
+    uint16_t out = 0;
+    for (uint8_t f = 0; f < TLM_FIELD_COUNT; f++) {
+        if ((mask & (1u << f)) && (groups & (1u << k_group[f]))) {
+            out |= (uint16_t)(1u << f);
+        }
+    }
+    return out;
+}
+
+uint8_t tlm_stream_poll(tlm_stream_t *s, uint32_t now_ms,
+                        const tlm_sample_t *cur, uint8_t *out, uint8_t cap) {
+    if (!s || !cur || !out || s->mask == 0u) {
+        return 0;
+    }
+
+    uint8_t key = s->need_key ||
+                  (uint32_t)(now_ms - s->last_key_ms) >= s->keyframe_ms;
+    uint8_t due = 0;
+    uint16_t fmask;
+    if (key) {
+        fmask = s->mask;
+    } else {
+        for (uint8_t g = 0; g < TLM_GROUP_COUNT; g++) {
+            if (s->period_ms[g] &&
+                (uint32_t)(now_ms - s->last_group_ms[g]) >= s->period_ms[g]) {
+                due |= (uint8_t)(1u << g);
+            }
+        }
+        if (!due) {
+            return 0;
+        }
+        fmask = 0;
+        uint16_t cand = fields_in_groups(s->mask, due);
+        for (uint8_t f = 0; f < TLM_FIELD_COUNT; f++) {
+            if ((cand & (1u << f)) && field_value(cur, f) != s->sent[f]) {
+                fmask |= (uint16_t)(1u << f);
+            }
+        }
+        if (!fmask) {
+            /* Nothing changed: the group waits a full period again. */
+            for (uint8_t g = 0; g < TLM_GROUP_COUNT; g++) {
+                if (due & (1u << g)) {
+                    s->last_group_ms[g] = now_ms;
+                }
+            }
+            return 0;
+        }
+    }
+
+    uint8_t len = TLM_STREAM_HDR_LEN;
+    for (uint8_t f = 0; f < TLM_FIELD_COUNT; f++) {
+        if (fmask & (1u << f)) {
+            len = (uint8_t)(len + k_width[f]);
+        }
+    }
+    if (len > cap) {
+        s->skipped++;
+        return 0;
+    }
+
+    out[0] = TLM_STREAM_VERSION;
+    out[1] = key ? TLM_FRAME_KEY : TLM_FRAME_DELTA;
+    store_be16(&out[2], s->seq);
+    store_be32(&out[4], now_ms);
+    store_be16(&out[8], fmask);
+    uint8_t *w = &out[TLM_STREAM_HDR_LEN];
+    for (uint8_t f = 0; f < TLM_FIELD_COUNT; f++) {
+        if (!(fmask & (1u << f))) {
+            continue;
+        }
+        uint16_t v = field_value(cur, f);
+        if (k_width[f] == 2u) {
+            store_be16(w, v);
+            w += 2;
+        } else {
+            *w++ = (uint8_t)v;
+        }
+        s->sent[f] = v;
+    }
+
+    s->seq++;
+    s->frames++;
+    if (key) {
+        s->need_key = 0u;
+        s->last_key_ms = now_ms;
+        for (uint8_t g = 0; g < TLM_GROUP_COUNT; g++) {
+            s->last_group_ms[g] = now_ms;
+        }
+    } else {
+        for (uint8_t g = 0; g < TLM_GROUP_COUNT; g++) {
+            if (due & (1u << g)) {
+                s->last_group_ms[g] = now_ms;
+            }
+        }
+    }
+    return len;
+}
+
+void tlm_stream_stamp_us(uint8_t *frame, uint32_t now_us) {
+    frame[0] = TLM_STREAM_VERSION_US;
+    store_be32(&frame[4], now_us);
+}
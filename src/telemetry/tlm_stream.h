@@ -0,0 +1,120 @@
+/*
+ * Telemetry Stream v2 - field-selected keyframe/delta encoder
+ *
+ * The host subscribes to a bitmask of fields and a period per field group.
+ * The stream sends a keyframe (every subscribed field) on subscribe and every
+ * keyframe_ms, and in between delta frames carrying only fields whose group
+ * is due and whose value changed since it was last sent. Every frame carries
+ * a sequence number; a gap means a lost frame, and the host resyncs at the
+ * next keyframe (or by re-sending the subscription).
+ *
+ * Frame payload (big-endian):
+ *   ver[1]=2, type[1] (0 key, 1 delta), seq[2], ms[4], mask[2],
+ *   then one value per set mask bit in field order (width per field).
+ *
+ * Usage:
+ *   1. tlm_stream_configure() from the subscribe command
+ *   2. tlm_stream_poll() every main loop iteration with the current sample
+ */
+
+#ifndef TELEMETRY_TLM_STREAM_H
+#define TELEMETRY_TLM_STREAM_H
+
+#include <stdint.h>
+
+#define TLM_STREAM_VERSION 2u
+#define TLM_STREAM_HDR_LEN 10u
+/* Same layout; the time field is device us (platform_time_us), not ms. */
+#define TLM_STREAM_VERSION_US 3u
+
+#define TLM_FRAME_KEY   0u
+#define TLM_FRAME_DELTA 1u
+
+/*
+ * Fields (mask bit = index). Width in bytes: see tlm_stream_field_width().
+ */
+enum {
+    TLM_F_SPEED_DMPH = 0,   /* u16, 0.1 mph */
+    TLM_F_CADENCE_RPM,      /* u16 */
+    TLM_F_POWER_W,          /* u16 */
+    TLM_F_TORQUE_RAW,       /* u16 */
+    TLM_F_BATT_DA,          /* i16, 0.1 A */
+    TLM_F_CMD_POWER_W,      /* u16 */
+    TLM_F_CMD_CURRENT_DA,   /* u16, 0.1 A */
+    TLM_F_MOTOR_RPM,        /* u16 */
+    TLM_F_BATT_DV,          /* i16, 0.1 V */
+    TLM_F_CTRL_TEMP_DC,     /* i16, 0.1 C */
+    TLM_F_SOC_PCT,          /* u8 */
+    TLM_F_ASSIST_MODE,      /* u8 */
+    TLM_F_PROFILE_ID,       /* u8 */
+    TLM_F_VIRTUAL_GEAR,     /* u8 */
+    TLM_F_FLAGS,            /* u8: bit0 brake, bit1 walk active */
+    TLM_F_ERR,              /* u8: motor error code */
+    TLM_FIELD_COUNT
+};
+
+_Static_assert(TLM_FIELD_COUNT <= 16, "field mask is 16 bits");
+
+/*
+ * Field groups, each with its own delta period
+ */
+enum {
+    TLM_GROUP_FAST = 0,     /* speed .. motor rpm */
+    TLM_GROUP_SLOW,         /* battery volts, temperature, SOC */
+    TLM_GROUP_STATE,        /* modes, flags, error */
+    TLM_GROUP_COUNT
+};
+
+#define TLM_PERIOD_MIN_MS    10u
+#define TLM_KEYFRAME_MIN_MS  100u
+#define TLM_KEYFRAME_DEF_MS  1000u
+
+/* Largest payload: header plus every field. */
+#define TLM_STREAM_MAX_LEN (TLM_STREAM_HDR_LEN + 26u)
+
+typedef struct {
+    uint16_t v[TLM_FIELD_COUNT];    /* raw values; signed fields as two's complement */
+} tlm_sample_t;
+
+typedef struct {
+    uint16_t mask;                          /* subscribed fields; 0 = off */
+    uint16_t period_ms[TLM_GROUP_COUNT];    /* 0 = group only in keyframes */
+    uint16_t keyframe_ms;
+    uint16_t seq;                           /* next frame's sequence number */
+    uint8_t need_key;
+    uint32_t last_key_ms;
+    uint32_t last_group_ms[TLM_GROUP_COUNT];
+    uint16_t sent[TLM_FIELD_COUNT];         /* value the host last received */
+    uint32_t frames;
+    uint32_t skipped;                       /* due but did not fit the port */
+} tlm_stream_t;
+
+/*
+ * Subscribe (or mask = 0 to stop). Periods below TLM_PERIOD_MIN_MS are
+ * raised to it (0 stays 0); keyframe_ms 0 selects TLM_KEYFRAME_DEF_MS.
+ * The next poll sends a keyframe. The sequence number keeps counting.
+ */
+void tlm_stream_configure(tlm_stream_t *s, uint16_t mask,
+                          const uint16_t period_ms[TLM_GROUP_COUNT],
+                          uint16_t keyframe_ms);
+
+/*
+ * Build the next frame if one is due.
+ *
+ * Args:
+ *   cap - room for the payload; a frame that does not fit is not built and
+ *         the stream state is left as it was, so the same changes go out on
+ *         a later poll
+ *
+ * Returns: payload length written to out, 0 when nothing is due
+ */
+uint8_t tlm_stream_poll(tlm_stream_t *s, uint32_t now_ms,
+                        const tlm_sample_t *cur, uint8_t *out, uint8_t cap);
+
+/* Turn a frame tlm_stream_poll() built into TLM_STREAM_VERSION_US. */
+void tlm_stream_stamp_us(uint8_t *frame, uint32_t now_us);
+
+uint8_t tlm_stream_field_width(uint8_t field);
+uint8_t tlm_stream_field_group(uint8_t field);
+
+#endif /* TELEMETRY_TLM_STREAM_H */
@@ -14,31 +14,41 @@
 #ifndef HOST_TEST
 #include "../../platform/time.h"
 #include "../../storage/layout.h"
+#include "../../storage/kv_store.h"
+#include "../../storage/ride_log.h"
 #include "../motor/app_data.h"
 
 /* SPI flash API (from storage module) */
 extern void spi_flash_read(uint32_t addr, uint8_t *buf, uint32_t len);
-extern void spi_flash_write(uint32_t addr, const uint8_t *buf, uint32_t len);
-extern void spi_flash_erase_4k(uint32_t addr);
 #else
 /* Host test stubs */
-extern volatile uint32_t g_ms;
 #define TRIP_STORAGE_BASE 0x10000u
 static void spi_flash_read(uint32_t addr, uint8_t *buf, uint32_t len) {
     (void)addr; memset(buf, 0, len);
 }
-static void spi_flash_write(uint32_t addr, const uint8_t *buf, uint32_t len) {
-    (void)addr; (void)buf; (void)len;
+#define KV_KEY_TRIP 0x04u
+#define KV_KEY_COUNTERS 0x05u
+#define KV_KEY_TRIP_QUANT 0x06u
+static int kv_get(uint8_t key, uint8_t *out, uint8_t cap) {
+    (void)key; (void)out; (void)cap; return -1;
+}
+static int kv_put(uint8_t key, const uint8_t *data, uint8_t len) {
+    (void)key; (void)data; (void)len; return 1;
+}
+#define RIDE_LOG_PAYLOAD_SIZE 56u
+static void ride_log_append(const uint8_t *payload) {
+    (void)payload;
+}
+static int ride_log_read_recent(uint16_t back, uint8_t *payload, uint32_t *seq) {
+    (void)back; (void)payload; (void)seq; return 0;
 }
-static void spi_flash_erase_4k(uint32_t addr) { (void)addr; }
 
-/* Stub for g_outputs */
-typedef struct { uint16_t cmd_power_w; } stub_outputs_t;
-static stub_outputs_t g_outputs = {0};
 #endif
 
 #include "../core/math_util.h"
 
+_Static_assert(TRIP_RIDE_SIZE == RIDE_LOG_PAYLOAD_SIZE, "ride history payload size");
+
 /*
  * Constants
  */
@@ -53,6 +63,28 @@ static trip_acc_t     g_trip;
 static trip_hist_t    g_trip_hist;
 static trip_summary_t g_trip_last;
 static uint8_t        g_trip_last_valid;
+static trip_totals_t  g_trip_totals;
+static qhist_t        g_trip_q[TRIP_Q_COUNT];
+static trip_quantiles_t g_trip_last_q;
+static uint8_t        g_trip_last_q_valid;
+
+/*
+ * Derived metrics are computed on demand and cached against g_trip_version,
+ * which trip_update bumps whenever the accumulators move. A consumer that
+ * asks twice between ticks gets the cached result without redoing the
+ * divisions or walking the histograms.
+ */
+static uint32_t         g_trip_version;
+static trip_snapshot_t  g_trip_snap;
+static uint32_t         g_trip_snap_version;
+static trip_quantiles_t g_trip_q_cur;
+static uint32_t         g_trip_q_version;
+
+/* Sub-unit remainders carried between ticks (dmph*ms*44704 and W*ms). */
+static uint32_t g_trip_dist_rem;
+static uint32_t g_trip_energy_rem;
+static uint32_t g_trip_regen_rem;
+static uint8_t  g_trip_finalizing;
 
 /*
  * Saturating add for uint32_t
@@ -90,27 +122,107 @@ static int trip_summary_validate(const trip_summary_t *ts)
 }
 
 /*
- * Store trip summary to flash
+ * Store trip summary to flash (one KV append; no sector erase)
  */
 static void trip_store_last(const trip_summary_t *ts)
 {
     if (!ts)
         return;
-    spi_flash_erase_4k(TRIP_STORAGE_BASE);
-    spi_flash_write(TRIP_STORAGE_BASE, (const uint8_t *)ts, TRIP_STORAGE_SIZE);
+    (void)kv_put(KV_KEY_TRIP, (const uint8_t *)ts, TRIP_STORAGE_SIZE);
 }
 
 /*
- * Load trip summary from flash
+ * Load trip summary from flash, falling back to the pre-KV sector
  */
 static int trip_load_last(trip_summary_t *out)
 {
     if (!out)
         return 0;
+    if (kv_get(KV_KEY_TRIP, (uint8_t *)out, TRIP_STORAGE_SIZE) == (int)TRIP_STORAGE_SIZE &&
+        trip_summary_validate(out))
+        return 1;
     spi_flash_read(TRIP_STORAGE_BASE, (uint8_t *)out, TRIP_STORAGE_SIZE);
     return trip_summary_validate(out);
 }
 
+/*
+ * Lifetime totals, stored big-endian
+ */
+#define TRIP_TOTALS_SIZE 16u
+
+static void trip_store_totals(const trip_totals_t *t)
+{
+    uint8_t buf[TRIP_TOTALS_SIZE];
+    store_be32(&buf[0], t->trips);
+    store_be32(&buf[4], t->distance_m);
+    store_be32(&buf[8], t->moving_s);
+    store_be32(&buf[12], t->energy_wh);
+    (void)kv_put(KV_KEY_COUNTERS, buf, TRIP_TOTALS_SIZE);
+}
+
+static void trip_load_totals(trip_totals_t *t)
+{
+    uint8_t buf[TRIP_TOTALS_SIZE];
+    memset(t, 0, sizeof(*t));
+    if (kv_get(KV_KEY_COUNTERS, buf, TRIP_TOTALS_SIZE) != (int)TRIP_TOTALS_SIZE)
+        return;
+    t->trips      = load_be32(&buf[0]);
+    t->distance_m = load_be32(&buf[4]);
+    t->moving_s   = load_be32(&buf[8]);
+    t->energy_wh  = load_be32(&buf[12]);
+}
+
+/*
+ * Percentiles, stored big-endian
+ */
+void trip_quantiles_to_be(uint8_t *dst, const trip_quantiles_t *q)
+{
+    if (!dst || !q)
+        return;
+    for (uint8_t c = 0; c < TRIP_Q_COUNT; ++c) {
+        store_be16(&dst[c * 8u + 0u], q->ch[c].p50);
+        store_be16(&dst[c * 8u + 2u], q->ch[c].p95);
+        store_be16(&dst[c * 8u + 4u], q->ch[c].p99);
+        store_be16(&dst[c * 8u + 6u], q->ch[c].max);
+    }
+}
+
+static void trip_quantiles_from_be(trip_quantiles_t *q, const uint8_t *src)
+{
+    for (uint8_t c = 0; c < TRIP_Q_COUNT; ++c) {
+        q->ch[c].p50 = load_be16(&src[c * 8u + 0u]);
+        q->ch[c].p95 = load_be16(&src[c * 8u + 2u]);
+        q->ch[c].p99 = load_be16(&src[c * 8u + 4u]);
+        q->ch[c].max = load_be16(&src[c * 8u + 6u]);
+    }
+}
+
+static int trip_load_quantiles(trip_quantiles_t *q)
+{
+    uint8_t buf[TRIP_QUANT_SIZE];
+    memset(q, 0, sizeof(*q));
+    if (kv_get(KV_KEY_TRIP_QUANT, buf, TRIP_QUANT_SIZE) != (int)TRIP_QUANT_SIZE)
+        return 0;
+    trip_quantiles_from_be(q, buf);
+    return 1;
+}
+
+static void trip_quantiles_from_hist(trip_quantiles_t *out)
+{
+    for (uint8_t c = 0; c < TRIP_Q_COUNT; ++c) {
+        out->ch[c].p50 = qhist_quantile(&g_trip_q[c], 500u);
+        out->ch[c].p95 = qhist_quantile(&g_trip_q[c], 950u);
+        out->ch[c].p99 = qhist_quantile(&g_trip_q[c], 990u);
+        out->ch[c].max = g_trip_q[c].max;
+    }
+}
+
+static void trip_reset_quantiles(void)
+{
+    for (uint8_t c = 0; c < TRIP_Q_COUNT; ++c)
+        qhist_reset(&g_trip_q[c]);
+}
+
 /*
  * Create snapshot from accumulator
  */
@@ -137,16 +249,18 @@ static void trip_snapshot_from_acc(trip_snapshot_t *out, const trip_acc_t *acc)
         out->avg_speed_dmph = 0;
     }
 
-    /* Calculate efficiency metrics */
-    if (acc->distance_mm > 0 && acc->energy_mwh > 0) {
-        uint64_t num_wh_mile = (uint64_t)acc->energy_mwh * 10ull * (uint64_t)MM_PER_MILE;
+    /* Calculate efficiency metrics on the net draw: what regen put back
+     * comes off what the motor used. */
+    uint32_t net_mwh = (acc->energy_mwh > acc->regen_mwh) ? acc->energy_mwh - acc->regen_mwh : 0u;
+    if (acc->distance_mm > 0 && net_mwh > 0) {
+        uint64_t num_wh_mile = (uint64_t)net_mwh * 10ull * (uint64_t)MM_PER_MILE;
         uint32_t den_mile = acc->distance_mm * 1000u;
         if (den_mile)
             out->wh_per_mile_d10 = (uint16_t)divu64_32(num_wh_mile + ((uint64_t)den_mile / 2ull), den_mile);
         else
             out->wh_per_mile_d10 = 0;
 
-        uint64_t num_wh_km = (uint64_t)acc->energy_mwh * 10ull * (uint64_t)MM_PER_KM;
+        uint64_t num_wh_km = (uint64_t)net_mwh * 10ull * (uint64_t)MM_PER_KM;
         if (den_mile)
             out->wh_per_km_d10 = (uint16_t)divu64_32(num_wh_km + ((uint64_t)den_mile / 2ull), den_mile);
         else
@@ -163,34 +277,77 @@ static void trip_snapshot_from_acc(trip_snapshot_t *out, const trip_acc_t *acc)
 
 void trip_init(void)
 {
-    memset(&g_trip, 0, sizeof(g_trip));
-    memset(&g_trip_hist, 0, sizeof(g_trip_hist));
+    trip_reset_acc();
     memset(&g_trip_last, 0, sizeof(g_trip_last));
     g_trip_last_valid = 0;
+    g_trip_last_q_valid = (uint8_t)trip_load_quantiles(&g_trip_last_q);
 
     /* Try to load last trip from flash */
     if (trip_load_last(&g_trip_last)) {
         g_trip_last_valid = 1;
     }
+    trip_load_totals(&g_trip_totals);
 }
 
 void trip_reset_acc(void)
 {
     memset(&g_trip, 0, sizeof(g_trip));
     memset(&g_trip_hist, 0, sizeof(g_trip_hist));
+    trip_reset_quantiles();
+    g_trip_dist_rem = 0;
+    g_trip_energy_rem = 0;
+    g_trip_regen_rem = 0;
+    g_trip_version++;
+}
+
+uint32_t trip_version(void)
+{
+    return g_trip_version;
+}
+
+/*
+ * Add rate * dt * scale / unit to an accumulator, carrying the remainder so
+ * no tick rounds. Normal ticks stay in 32 bits (unit is a constant, so the
+ * divide folds to a multiply); a long gap falls back to the 64-bit path.
+ */
+static inline uint32_t trip_integrate(uint32_t *rem, uint32_t rate, uint32_t dt,
+                                      uint32_t scale, uint32_t unit)
+{
+    if (rate <= 0xFFFFu && dt <= 0xFFFFu) {
+        uint32_t prod = rate * dt;
+        if (prod <= (0xFFFFFFFFu - unit) / scale) {
+            uint32_t r = *rem + prod * scale;
+            *rem = r % unit;
+            return r / unit;
+        }
+    }
+    uint64_t r = (uint64_t)rate * (uint64_t)dt * (uint64_t)scale + *rem;
+    uint32_t q = divu64_32(r, unit);
+    *rem = (uint32_t)(r - (uint64_t)q * unit);
+    return q;
 }
 
-void trip_update(uint16_t speed_dmph, uint16_t power_w, uint8_t assist_mode,
-                 uint8_t virtual_gear, uint8_t profile_id)
+uint16_t trip_regen_power_w(int16_t batt_dA, int16_t batt_dV)
+{
+    if (batt_dA >= 0 || batt_dV <= 0)
+        return 0u;
+    /* W = (A * 10) * (V * 10) / 100 */
+    uint32_t w = ((uint32_t)(-(int32_t)batt_dA) * (uint32_t)batt_dV + 50u) / 100u;
+    return (w > 0xFFFFu) ? 0xFFFFu : (uint16_t)w;
+}
+
+void trip_update(uint32_t now_ms, uint16_t speed_dmph, uint16_t power_w, uint16_t regen_w,
+                 uint8_t assist_mode, uint8_t virtual_gear, uint8_t profile_id,
+                 int16_t batt_dA, int16_t ctrl_temp_dC)
 {
     if (g_trip.start_ms == 0)
-        g_trip.start_ms = g_ms;
+        g_trip.start_ms = now_ms;
 
     if (g_trip.last_ms == 0)
-        g_trip.last_ms = g_ms;
+        g_trip.last_ms = now_ms;
 
-    uint32_t dt = g_ms - g_trip.last_ms;
-    g_trip.last_ms = g_ms;
+    uint32_t dt = now_ms - g_trip.last_ms;
+    g_trip.last_ms = now_ms;
 
     if (dt == 0)
         return;
@@ -203,8 +360,7 @@ void trip_update(uint16_t speed_dmph, uint16_t power_w, uint8_t assist_mode,
     /* Update distance: speed_dmph * dt_ms * conversion */
     /* speed_dmph * 0.1 mph * dt_ms / 1000s * 1609340 mm/mile / 3600 s/hr */
     /* = speed_dmph * dt * 44.704 / 1000 mm */
-    uint64_t dist_num = (uint64_t)speed_dmph * (uint64_t)dt * 44704ull + 500000ull;
-    g_trip.distance_mm += (uint32_t)divu64_32(dist_num, 1000000u);
+    g_trip.distance_mm += trip_integrate(&g_trip_dist_rem, speed_dmph, dt, 44704u, 1000000u);
 
     /* Update energy */
     uint16_t pwr = power_w;
@@ -213,10 +369,11 @@ void trip_update(uint16_t speed_dmph, uint16_t power_w, uint8_t assist_mode,
         pwr = g_outputs.cmd_power_w;
 #endif
     if (pwr) {
-        /* mWh = W * ms / 3600000, but we accumulate mWh */
-        uint64_t mwh_num = ((uint64_t)pwr * (uint64_t)dt + 1799ull);
-        g_trip.energy_mwh += (uint32_t)divu64_32(mwh_num, 3600u);
+        /* mWh = W * ms / 3600 */
+        g_trip.energy_mwh += trip_integrate(&g_trip_energy_rem, pwr, dt, 1u, 3600u);
     }
+    if (regen_w)
+        g_trip.regen_mwh += trip_integrate(&g_trip_regen_rem, regen_w, dt, 1u, 3600u);
 
     /* Update max speed */
     if (speed_dmph > g_trip.max_speed_dmph)
@@ -241,14 +398,22 @@ void trip_update(uint16_t speed_dmph, uint16_t power_w, uint8_t assist_mode,
             bin = HIST_POWER_BINS - 1u;
         g_trip_hist.power_ms[bin] = sat_add_u32(g_trip_hist.power_ms[bin], dt);
     }
+    if (speed_dmph >= TRIP_MOVING_THRESHOLD_DMPH) {
+        qhist_add(&g_trip_q[TRIP_Q_SPEED], speed_dmph, dt);
+        qhist_add(&g_trip_q[TRIP_Q_POWER], pwr, dt);
+        qhist_add(&g_trip_q[TRIP_Q_CURRENT], (uint16_t)(batt_dA > 0 ? batt_dA : 0), dt);
+        qhist_add(&g_trip_q[TRIP_Q_TEMP], (uint16_t)(ctrl_temp_dC > 0 ? ctrl_temp_dC : 0), dt);
+    }
 
     g_trip.samples++;
+    g_trip_version++;
 }
 
 void trip_finalize_and_persist(void)
 {
+    g_trip_finalizing = 1u;
     trip_snapshot_t snap;
-    trip_snapshot_from_acc(&snap, &g_trip);
+    trip_get_current(&snap);
 
     g_trip_last.magic = TRIP_MAGIC;
     g_trip_last.version = TRIP_VERSION;
@@ -260,13 +425,101 @@ void trip_finalize_and_persist(void)
 
     trip_store_last(&g_trip_last);
     g_trip_last_valid = 1;
+
+    uint8_t ride[TRIP_RIDE_SIZE];
+    trip_get_quantiles(&g_trip_last_q);
+    trip_quantiles_to_be(&ride[TRIP_SNAPSHOT_SIZE], &g_trip_last_q);
+    (void)kv_put(KV_KEY_TRIP_QUANT, &ride[TRIP_SNAPSHOT_SIZE], TRIP_QUANT_SIZE);
+    g_trip_last_q_valid = 1;
+
+    /* Rides with no distance (a reset while parked) stay out of the history. */
+    if (snap.distance_mm) {
+        trip_snapshot_to_be(ride, &snap);
+        ride_log_append(ride);
+    }
+
+    g_trip_totals.trips = sat_add_u32(g_trip_totals.trips, 1u);
+    g_trip_totals.distance_m = sat_add_u32(g_trip_totals.distance_m, (snap.distance_mm + 500u) / 1000u);
+    g_trip_totals.moving_s = sat_add_u32(g_trip_totals.moving_s, (snap.moving_ms + 500u) / 1000u);
+    g_trip_totals.energy_wh = sat_add_u32(g_trip_totals.energy_wh, (snap.energy_mwh + 500u) / 1000u);
+    trip_store_totals(&g_trip_totals);
     trip_reset_acc();
+    g_trip_finalizing = 0u;
+}
+
+/*
+ * Running trip for the brown-out record, big-endian: version, reserved,
+ * max speed, then 57 words (see trip_state_words). Percentile histograms
+ * are not carried; a resumed trip restarts them.
+ */
+#define TRIP_STATE_VERSION 1u
+#define TRIP_STATE_WORDS   57u
+_Static_assert(4u + TRIP_STATE_WORDS * 4u == TRIP_STATE_SIZE, "trip state size");
+
+static uint32_t trip_state_words(uint32_t **w)
+{
+    uint32_t n = 0;
+    w[n++] = &g_trip.elapsed_ms;
+    w[n++] = &g_trip.moving_ms;
+    w[n++] = &g_trip.distance_mm;
+    w[n++] = &g_trip.energy_mwh;
+    w[n++] = &g_trip.regen_mwh;
+    w[n++] = &g_trip.samples;
+    for (uint32_t i = 0; i < 3u; ++i)
+        w[n++] = &g_trip.assist_time_ms[i];
+    for (uint32_t i = 0; i < 12u; ++i)
+        w[n++] = &g_trip.gear_time_ms[i];
+    w[n++] = &g_trip_dist_rem;
+    w[n++] = &g_trip_energy_rem;
+    w[n++] = &g_trip_regen_rem;
+    for (uint32_t i = 0; i < HIST_ASSIST_BINS; ++i)
+        w[n++] = &g_trip_hist.assist_ms[i];
+    for (uint32_t i = 0; i < HIST_GEAR_BINS; ++i)
+        w[n++] = &g_trip_hist.gear_ms[i];
+    for (uint32_t i = 0; i < HIST_POWER_BINS; ++i)
+        w[n++] = &g_trip_hist.power_ms[i];
+    return n;
+}
+
+uint32_t trip_state_save(uint8_t *out)
+{
+    /* Half-finalized state would be counted twice once resumed. */
+    if (!out || g_trip_finalizing || g_trip.samples == 0u)
+        return 0u;
+    uint32_t *w[TRIP_STATE_WORDS];
+    uint32_t n = trip_state_words(w);
+    out[0] = TRIP_STATE_VERSION;
+    out[1] = 0u;
+    store_be16(&out[2], g_trip.max_speed_dmph);
+    for (uint32_t i = 0; i < n; ++i)
+        store_be32(&out[4u + i * 4u], *w[i]);
+    return TRIP_STATE_SIZE;
+}
+
+int trip_state_restore(const uint8_t *in, uint32_t len)
+{
+    if (!in || len != TRIP_STATE_SIZE || in[0] != TRIP_STATE_VERSION)
+        return 0;
+    trip_reset_acc();
+    uint32_t *w[TRIP_STATE_WORDS];
+    uint32_t n = trip_state_words(w);
+    g_trip.max_speed_dmph = load_be16(&in[2]);
+    for (uint32_t i = 0; i < n; ++i)
+        *w[i] = load_be32(&in[4u + i * 4u]);
+    /* start/last stay 0: the first update after boot re-bases the clock. */
+    g_trip_version++;
+    return 1;
 }
 
 void trip_get_current(trip_snapshot_t *out)
 {
-    if (out)
-        trip_snapshot_from_acc(out, &g_trip);
+    if (!out)
+        return;
+    if (g_trip_snap_version != g_trip_version) {
+        trip_snapshot_from_acc(&g_trip_snap, &g_trip);
+        g_trip_snap_version = g_trip_version;
+    }
+    *out = g_trip_snap;
 }
 
 int trip_get_last(trip_snapshot_t *out)
@@ -284,6 +537,51 @@ int trip_last_valid(void)
     return g_trip_last_valid ? 1 : 0;
 }
 
+void trip_get_totals(trip_totals_t *out)
+{
+    if (out)
+        *out = g_trip_totals;
+}
+
+void trip_get_quantiles(trip_quantiles_t *out)
+{
+    if (!out)
+        return;
+    if (g_trip_q_version != g_trip_version) {
+        trip_quantiles_from_hist(&g_trip_q_cur);
+        g_trip_q_version = g_trip_version;
+    }
+    *out = g_trip_q_cur;
+}
+
+int trip_get_last_quantiles(trip_quantiles_t *out)
+{
+    if (!out || !g_trip_last_q_valid)
+        return 0;
+    *out = g_trip_last_q;
+    return 1;
+}
+
+int trip_get_ride(uint16_t back, trip_snapshot_t *snap, trip_quantiles_t *q, uint32_t *seq)
+{
+    uint8_t ride[TRIP_RIDE_SIZE];
+    if (!ride_log_read_recent(back, ride, seq))
+        return 0;
+    if (snap) {
+        snap->distance_mm     = load_be32(&ride[0]);
+        snap->elapsed_ms      = load_be32(&ride[4]);
+        snap->moving_ms       = load_be32(&ride[8]);
+        snap->energy_mwh      = load_be32(&ride[12]);
+        snap->max_speed_dmph  = load_be16(&ride[16]);
+        snap->avg_speed_dmph  = load_be16(&ride[18]);
+        snap->wh_per_mile_d10 = load_be16(&ride[20]);
+        snap->wh_per_km_d10   = load_be16(&ride[22]);
+    }
+    if (q)
+        trip_quantiles_from_be(q, &ride[TRIP_SNAPSHOT_SIZE]);
+    return 1;
+}
+
 const trip_hist_t *trip_get_histogram(void)
 {
     return &g_trip_hist;
@@ -6,7 +6,7 @@
  *
  * Usage:
  *   1. trip_init() on startup (loads last trip from flash)
- *   2. trip_update() every main loop iteration with current data
+ *   2. trip_update() for every sampler tick (tlm_sampler.h)
  *   3. trip_finalize() when ride ends (persists to flash)
  *   4. trip_get_current()/trip_get_last() for UI display
  */
@@ -17,6 +17,8 @@
 #include <stdint.h>
 #include <stddef.h>
 
+#include "quantile.h"
+
 /*
  * Trip snapshot - point-in-time statistics
  */
@@ -41,6 +43,7 @@ typedef struct {
     uint32_t moving_ms;         /* Time spent moving */
     uint32_t distance_mm;       /* Total distance */
     uint32_t energy_mwh;        /* Total energy consumed */
+    uint32_t regen_mwh;         /* Energy returned to the pack */
     uint16_t max_speed_dmph;    /* Maximum speed seen */
     uint32_t samples;           /* Number of updates */
     uint32_t assist_time_ms[3]; /* Time per assist mode: 0=off, 1=assist, 2=walk */
@@ -63,6 +66,16 @@ typedef struct {
     uint32_t crc32;
 } trip_summary_t;
 
+/*
+ * Lifetime totals across finalized trips - stored in flash
+ */
+typedef struct {
+    uint32_t trips;
+    uint32_t distance_m;
+    uint32_t moving_s;
+    uint32_t energy_wh;
+} trip_totals_t;
+
 /*
  * Histogram bins for detailed statistics
  */
@@ -77,6 +90,35 @@ typedef struct {
     uint32_t power_ms[HIST_POWER_BINS];
 } trip_hist_t;
 
+/*
+ * Ride percentiles - time-weighted over moving time, one streaming
+ * histogram (quantile.h) per channel. Current and temperature below zero
+ * count as zero.
+ */
+enum {
+    TRIP_Q_SPEED = 0,   /* 0.1 mph */
+    TRIP_Q_POWER,       /* W */
+    TRIP_Q_CURRENT,     /* battery 0.1 A */
+    TRIP_Q_TEMP,        /* controller 0.1 C */
+    TRIP_Q_COUNT
+};
+
+typedef struct {
+    uint16_t p50;
+    uint16_t p95;
+    uint16_t p99;
+    uint16_t max;
+} trip_quantile_t;
+
+typedef struct {
+    trip_quantile_t ch[TRIP_Q_COUNT];
+} trip_quantiles_t;
+
+#define TRIP_QUANT_SIZE (TRIP_Q_COUNT * 8u)   /* stored big-endian */
+#define TRIP_SNAPSHOT_SIZE 24u
+/* Ride history payload: snapshot then percentiles (RIDE_LOG_PAYLOAD_SIZE). */
+#define TRIP_RIDE_SIZE (TRIP_SNAPSHOT_SIZE + TRIP_QUANT_SIZE)
+
 /*
  * Initialize trip module
  *
@@ -93,36 +135,68 @@ void trip_init(void);
 void trip_reset_acc(void);
 
 /*
- * Update trip with current data
+ * Update trip with one sample
  *
- * Call every main loop iteration (or at regular intervals).
+ * Call for every sampler tick; each step integrates over the time since the
+ * previous now_ms.
  *
  * Args:
+ *   now_ms       - Timestamp of the sample
  *   speed_dmph   - Current speed in deci-mph
  *   power_w      - Current power in watts (0 to use g_outputs.cmd_power_w)
+ *   regen_w      - Power flowing into the pack in watts (trip_regen_power_w)
  *   assist_mode  - Current assist mode (0=off, 1=assist, 2=walk)
  *   virtual_gear - Current virtual gear (1-12)
  *   profile_id   - Current profile ID (0-4)
+ *   batt_dA      - Battery current in 0.1 A (percentiles only)
+ *   ctrl_temp_dC - Controller temperature in 0.1 C (percentiles only)
  */
-void trip_update(uint16_t speed_dmph, uint16_t power_w, uint8_t assist_mode,
-                 uint8_t virtual_gear, uint8_t profile_id);
+void trip_update(uint32_t now_ms, uint16_t speed_dmph, uint16_t power_w, uint16_t regen_w,
+                 uint8_t assist_mode, uint8_t virtual_gear, uint8_t profile_id,
+                 int16_t batt_dA, int16_t ctrl_temp_dC);
+
+/* Power into the pack in watts from battery current/voltage; 0 while discharging. */
+uint16_t trip_regen_power_w(int16_t batt_dA, int16_t batt_dV);
 
 /*
  * Finalize current trip and persist to flash
  *
- * Creates snapshot, stores to flash, resets accumulator.
+ * Creates snapshot and percentiles, stores both to flash, resets accumulator.
  * Call when ride ends (power off, explicit reset, etc.).
  */
 void trip_finalize_and_persist(void);
 
+/*
+ * Running trip across a power cut (src/power/brownout.c)
+ *
+ * trip_state_save() serializes the accumulator into TRIP_STATE_SIZE bytes
+ * and returns that size, or 0 when there is nothing to keep (no samples, or
+ * a finalize in progress). It only reads module state, so the brown-out
+ * interrupt can call it. trip_state_restore() makes a saved state the
+ * current trip; returns 0 if the buffer is not one.
+ */
+#define TRIP_STATE_SIZE 232u
+
+uint32_t trip_state_save(uint8_t *out);
+int trip_state_restore(const uint8_t *in, uint32_t len);
+
 /*
  * Get snapshot of current trip
  *
+ * Averages and Wh/unit are derived on the first call after the accumulators
+ * change and served from a cache until the next trip_update().
+ *
  * Args:
  *   out - Destination for snapshot
  */
 void trip_get_current(trip_snapshot_t *out);
 
+/*
+ * Change counter for the current trip: bumps on every accumulating
+ * trip_update() and on reset. Equal values mean equal trip data.
+ */
+uint32_t trip_version(void);
+
 /*
  * Get last persisted trip
  *
@@ -139,18 +213,48 @@ int trip_get_last(trip_snapshot_t *out);
  */
 int trip_last_valid(void);
 
+/*
+ * Get lifetime totals (updated by trip_finalize_and_persist)
+ */
+void trip_get_totals(trip_totals_t *out);
+
 /*
  * Get pointer to histogram data (for detailed stats)
  */
 const trip_hist_t *trip_get_histogram(void);
 
+/*
+ * Percentiles of the current trip (computed on demand, cached like the
+ * snapshot) and of the last persisted one (returns 0 when none is stored)
+ */
+void trip_get_quantiles(trip_quantiles_t *out);
+int trip_get_last_quantiles(trip_quantiles_t *out);
+
+/*
+ * Ride history (storage/ride_log), appended by trip_finalize_and_persist
+ *
+ * Args:
+ *   back - 1 = most recent finished ride
+ *   snap, q, seq - optional destinations
+ *
+ * Returns:
+ *   1 when the ride exists and its record checks out, 0 otherwise
+ */
+int trip_get_ride(uint16_t back, trip_snapshot_t *snap, trip_quantiles_t *q, uint32_t *seq);
+
+/*
+ * Serialize percentiles to big-endian (TRIP_QUANT_SIZE bytes):
+ * per channel p50, p95, p99, max
+ */
+void trip_quantiles_to_be(uint8_t *dst, const trip_quantiles_t *q);
+
 /*
  * Get raw accumulator (for debugging/testing)
  */
 const trip_acc_t *trip_get_acc(void);
 
 /*
- * Serialize snapshot to big-endian byte array (24 bytes)
+ * Serialize snapshot to big-endian byte array (TRIP_SNAPSHOT_SIZE bytes)
  *
  * For protocol transmission.
  */
@@ -4,13 +4,17 @@
  *
  * Provides:
  * - Vector table for Cortex-M4 and AT32F403A peripherals
- * - Reset handler with BSS zeroing and data initialization
+ * - Reset handler with BSS zeroing and data initialization (burst STM/LDM);
+ *   .noinit (NOINIT, RAM_NOZERO) is left as it is
+ * - Stack painting for the high-water scan (platform/ram.h)
  * - FPU enable
  * - Calls SystemInit() from Artery SDK then main()
  */
 
 #include <stdint.h>
 
+#include "platform/ram.h"
+
 /* Linker-provided symbols */
 extern uint32_t _stack_top;
 extern uint32_t _sbss;
@@ -214,20 +218,59 @@ static inline void enable_irqs(void)
     __asm__ volatile("cpsie i" ::: "memory");
 }
 
+/*
+ * Both loops run before SystemInit, on the 8 MHz HSI, so they move four words
+ * per STM: one instruction for 16 bytes instead of a store, an increment and
+ * a compare per word. The register lists are pinned to r4-r7 because STM and
+ * LDM take them in ascending order. The sections are word aligned; whatever
+ * is left below 16 bytes goes a word at a time.
+ */
 static void bss_zero(void)
 {
-    for (uint32_t *p = &_sbss; p < &_ebss; p++)
-        *p = 0;
+    uint32_t *p = &_sbss;
+    uint32_t *end = &_ebss;
+    register uint32_t z0 __asm__("r4") = 0u;
+    register uint32_t z1 __asm__("r5") = 0u;
+    register uint32_t z2 __asm__("r6") = 0u;
+    register uint32_t z3 __asm__("r7") = 0u;
+    while ((uintptr_t)end - (uintptr_t)p >= 16u)
+        __asm__ volatile("stmia %0!, {%1, %2, %3, %4}"
+                         : "+r"(p)
+                         : "r"(z0), "r"(z1), "r"(z2), "r"(z3)
+                         : "memory");
+    while (p < end)
+        *p++ = 0u;
 }
 
 static void data_init(void)
 {
     uint32_t *dst = &_sdata;
     const uint32_t *src = &_sidata;
-    while (dst < &_edata)
+    uint32_t *end = &_edata;
+    register uint32_t w0 __asm__("r4");
+    register uint32_t w1 __asm__("r5");
+    register uint32_t w2 __asm__("r6");
+    register uint32_t w3 __asm__("r7");
+    while ((uintptr_t)end - (uintptr_t)dst >= 16u)
+        __asm__ volatile("ldmia %4!, {%0, %1, %2, %3}\n\t"
+                         "stmia %5!, {%0, %1, %2, %3}"
+                         : "=&r"(w0), "=&r"(w1), "=&r"(w2), "=&r"(w3), "+r"(src), "+r"(dst)
+                         :
+                         : "memory");
+    while (dst < end)
         *dst++ = *src++;
 }
 
+/* Everything between .bss and this frame is free stack; the margin covers the
+ * words this function and Reset_Handler are using. */
+static void stack_paint(void)
+{
+    uint32_t sp;
+    __asm__ volatile("mov %0, sp" : "=r"(sp));
+    for (uint32_t *p = &_ebss; p < (uint32_t *)(sp - 64u); p++)
+        *p = RAM_STACK_PAINT;
+}
+
 /**
  * @brief Reset handler - entry point after reset
  */
@@ -238,6 +281,7 @@ void Reset_Handler(void)
     /* Zero BSS and copy initialized data */
     bss_zero();
     data_init();
+    stack_paint();
 
     /* Call Artery SDK SystemInit (enables FPU, resets CRM to known state) */
     SystemInit();
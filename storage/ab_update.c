@@ -3,6 +3,8 @@
 #include <stddef.h>
 
 #include "drivers/spi_flash.h"
+#include "platform/watchdog.h"
+#include "storage/flash_util.h"
 #include "util/byteorder.h"
 #include "util/crc32.h"
 
@@ -127,7 +129,8 @@ static void ab_meta_write(const ab_meta_t *m)
     spi_flash_update_bytes(AB_META_BASE + slot * AB_META_STRIDE, buf, AB_META_SIZE);
 }
 
-int ab_slot_read_header(uint8_t slot, ab_slot_hdr_t *out)
+/* Header fields only; the image CRC is checked separately. */
+static int ab_slot_parse_header(uint8_t slot, ab_slot_hdr_t *out)
 {
     if (!ab_slot_valid(slot))
         return 0;
@@ -146,37 +149,206 @@ int ab_slot_read_header(uint8_t slot, ab_slot_hdr_t *out)
         return 0;
     if ((uint32_t)header_size + image_size > AB_SLOT_STRIDE)
         return 0;
-    uint32_t crc_expected = load_be32(&buf[12]);
-    uint32_t payload_addr = ab_slot_base(slot) + header_size;
-    uint32_t remaining = image_size;
-    uint8_t chunk[128];
-    uint32_t crc = 0xFFFFFFFFu;
-    while (remaining)
-    {
-        uint32_t n = remaining;
-        if (n > (uint32_t)sizeof(chunk))
-            n = (uint32_t)sizeof(chunk);
-        spi_flash_read(payload_addr, chunk, n);
-        crc = crc32_update(crc, chunk, n);
-        payload_addr += n;
-        remaining -= n;
-    }
-    uint32_t crc_actual = ~crc;
-    if (crc_actual != crc_expected)
+    out->magic = AB_SLOT_MAGIC;
+    out->version = version;
+    out->header_size = header_size;
+    out->image_size = image_size;
+    out->crc32 = load_be32(&buf[12]);
+    out->build_id = load_be32(&buf[16]);
+    out->flags = load_be32(&buf[20]);
+    out->reserved0 = load_be32(&buf[24]);
+    out->reserved1 = load_be32(&buf[28]);
+    return 1;
+}
+
+int ab_slot_read_header(uint8_t slot, ab_slot_hdr_t *out)
+{
+    ab_slot_hdr_t hdr;
+    if (!ab_slot_parse_header(slot, &hdr))
+        return 0;
+    crc32_stream_t crc;
+    crc32_stream_begin(&crc);
+    spi_flash_crc32_feed(&crc, ab_slot_base(slot) + hdr.header_size, hdr.image_size);
+    if (crc32_stream_end(&crc) != hdr.crc32)
         return 0;
     if (out)
+        *out = hdr;
+    return 1;
+}
+
+/*
+ * Background image verify. Each tick digests the chunk that landed while the
+ * DMA reads the next one into the other buffer, so a 256 KB image costs the
+ * main loop one CRC of AB_VERIFY_CHUNK bytes per pass instead of one long
+ * blocking read. Jobs run in submit order; results are applied on completion.
+ */
+#define AB_VERIFY_CHUNK 512u
+#define AB_VERIFY_QUEUE 4u
+
+enum {
+    AB_VERIFY_ACTIVE = 1,  /* boot: active slot validity and build id */
+    AB_VERIFY_PROMOTE = 2, /* boot: pending slot, promoted if good */
+    AB_VERIFY_PENDING = 3, /* set_pending: pending slot validity */
+};
+
+typedef struct {
+    uint8_t slot;
+    uint8_t kind;
+} ab_verify_job_t;
+
+static struct {
+    ab_verify_job_t queue[AB_VERIFY_QUEUE];
+    uint8_t head;
+    uint8_t count;
+    uint8_t running;       /* queue[head] is being digested */
+    uint8_t buf_idx;       /* buffer the in-flight read targets */
+    uint8_t last_slot;
+    uint8_t last_ok;
+    ab_slot_hdr_t hdr;
+    crc32_stream_t crc;
+    uint32_t read_off;     /* image bytes requested so far */
+    uint32_t pending_len;  /* bytes of the in-flight read */
+    uint8_t buf[2][AB_VERIFY_CHUNK] __attribute__((aligned(4)));
+} g_ab_verify = {.last_slot = AB_SLOT_NONE};
+
+static void ab_verify_apply(uint8_t kind, uint8_t slot, uint8_t ok, const ab_slot_hdr_t *hdr)
+{
+    if (kind == AB_VERIFY_ACTIVE)
+    {
+        if (slot != g_ab_active_slot)
+            return;
+        g_ab_active_valid = ok;
+        g_ab_active_build_id = ok ? hdr->build_id : 0u;
+        return;
+    }
+    if (kind == AB_VERIFY_PENDING)
     {
-        out->magic = AB_SLOT_MAGIC;
-        out->version = version;
-        out->header_size = header_size;
-        out->image_size = image_size;
-        out->crc32 = crc_expected;
-        out->build_id = load_be32(&buf[16]);
-        out->flags = load_be32(&buf[20]);
-        out->reserved0 = load_be32(&buf[24]);
-        out->reserved1 = load_be32(&buf[28]);
+        if (slot == g_ab_pending_slot)
+            g_ab_pending_valid = ok;
+        return;
+    }
+
+    ab_meta_t meta;
+    ab_meta_load(&meta, NULL);
+    if (meta.pending_slot != slot)
+        return;
+    meta.seq += 1u;
+    meta.pending_slot = AB_SLOT_NONE;
+    if (ok)
+    {
+        g_ab_last_good_slot = g_ab_active_slot;
+        g_ab_active_slot = slot;
+        g_ab_active_build_id = hdr->build_id;
+        g_ab_active_valid = 1u;
+        meta.active_slot = g_ab_active_slot;
+        meta.last_good_slot = g_ab_last_good_slot;
+    }
+    ab_meta_write(&meta);
+    g_ab_pending_slot = AB_SLOT_NONE;
+    g_ab_pending_valid = 0u;
+}
+
+static void ab_verify_submit(uint8_t slot, uint8_t kind)
+{
+    if (g_ab_verify.count >= AB_VERIFY_QUEUE)
+        ab_update_verify_wait();
+    uint8_t idx = (uint8_t)((g_ab_verify.head + g_ab_verify.count) % AB_VERIFY_QUEUE);
+    g_ab_verify.queue[idx].slot = slot;
+    g_ab_verify.queue[idx].kind = kind;
+    g_ab_verify.count++;
+}
+
+static void ab_verify_finish(uint8_t ok)
+{
+    ab_verify_job_t job = g_ab_verify.queue[g_ab_verify.head];
+    g_ab_verify.head = (uint8_t)((g_ab_verify.head + 1u) % AB_VERIFY_QUEUE);
+    g_ab_verify.count--;
+    g_ab_verify.running = 0u;
+    g_ab_verify.last_slot = job.slot;
+    g_ab_verify.last_ok = ok;
+    ab_verify_apply(job.kind, job.slot, ok, &g_ab_verify.hdr);
+}
+
+static void ab_verify_read_next(void)
+{
+    uint32_t left = g_ab_verify.hdr.image_size - g_ab_verify.read_off;
+    uint32_t n = (left > AB_VERIFY_CHUNK) ? AB_VERIFY_CHUNK : left;
+    g_ab_verify.pending_len = n;
+    if (n == 0u)
+        return;
+    uint32_t addr = ab_slot_base(g_ab_verify.queue[g_ab_verify.head].slot) +
+                    g_ab_verify.hdr.header_size + g_ab_verify.read_off;
+    uint8_t *dst = g_ab_verify.buf[g_ab_verify.buf_idx];
+    if (!spi_flash_read_async_start(addr, dst, n))
+        spi_flash_read(addr, dst, n);
+    g_ab_verify.read_off += n;
+}
+
+void ab_update_tick(void)
+{
+    if (!g_ab_verify.count)
+        return;
+    if (!g_ab_verify.running)
+    {
+        if (!ab_slot_parse_header(g_ab_verify.queue[g_ab_verify.head].slot, &g_ab_verify.hdr))
+        {
+            ab_verify_finish(0u);
+            return;
+        }
+        crc32_stream_begin(&g_ab_verify.crc);
+        g_ab_verify.read_off = 0u;
+        g_ab_verify.buf_idx = 0u;
+        g_ab_verify.running = 1u;
+        ab_verify_read_next();
+        return;
+    }
+    if (!spi_flash_read_async_poll())
+        return;
+
+    const uint8_t *landed = g_ab_verify.buf[g_ab_verify.buf_idx];
+    uint32_t landed_len = g_ab_verify.pending_len;
+    g_ab_verify.buf_idx ^= 1u;
+    ab_verify_read_next();
+    crc32_stream_feed(&g_ab_verify.crc, landed, landed_len);
+    if (g_ab_verify.pending_len == 0u)
+        ab_verify_finish(crc32_stream_end(&g_ab_verify.crc) == g_ab_verify.hdr.crc32 ? 1u : 0u);
+}
+
+void ab_update_verify_wait(void)
+{
+    /* A 256 KB image digests well inside one budget per job. */
+    watchdog_budget_t budget;
+    uint8_t count = g_ab_verify.count;
+    watchdog_budget_begin(&budget, 0u);
+    while (g_ab_verify.count)
+    {
+        ab_update_tick();
+        if (g_ab_verify.count != count)
+        {
+            count = g_ab_verify.count;
+            watchdog_budget_begin(&budget, 0u);
+        }
+        (void)watchdog_budget_poll(&budget);
+    }
+}
+
+void ab_update_get_verify(ab_verify_status_t *out)
+{
+    if (!out)
+        return;
+    out->busy = g_ab_verify.count ? 1u : 0u;
+    out->queued = g_ab_verify.count;
+    out->slot = g_ab_verify.running ? g_ab_verify.queue[g_ab_verify.head].slot : AB_SLOT_NONE;
+    out->last_slot = g_ab_verify.last_slot;
+    out->last_ok = g_ab_verify.last_ok;
+    out->done = 0u;
+    out->total = 0u;
+    if (g_ab_verify.running)
+    {
+        /* Bytes digested, excluding the read still in flight. */
+        out->done = g_ab_verify.read_off - g_ab_verify.pending_len;
+        out->total = g_ab_verify.hdr.image_size;
     }
-    return 1;
 }
 
 void ab_update_init(void)
@@ -194,42 +366,11 @@ void ab_update_init(void)
     g_ab_pending_valid = 0;
     g_ab_active_build_id = 0;
 
-    ab_slot_hdr_t hdr;
-    if (ab_slot_read_header(g_ab_active_slot, &hdr))
-    {
-        g_ab_active_valid = 1u;
-        g_ab_active_build_id = hdr.build_id;
-    }
-
-    if (g_ab_pending_slot != AB_SLOT_NONE && ab_slot_valid(g_ab_pending_slot) &&
-        g_ab_pending_slot != g_ab_active_slot)
-    {
-        if (ab_slot_read_header(g_ab_pending_slot, &hdr))
-        {
-            g_ab_last_good_slot = g_ab_active_slot;
-            g_ab_active_slot = g_ab_pending_slot;
-            g_ab_active_build_id = hdr.build_id;
-            g_ab_active_valid = 1u;
-            meta.seq += 1u;
-            meta.active_slot = g_ab_active_slot;
-            meta.pending_slot = AB_SLOT_NONE;
-            meta.last_good_slot = g_ab_last_good_slot;
-            ab_meta_write(&meta);
-            g_ab_pending_slot = AB_SLOT_NONE;
-        }
-        else
-        {
-            meta.seq += 1u;
-            meta.pending_slot = AB_SLOT_NONE;
-            ab_meta_write(&meta);
-            g_ab_pending_slot = AB_SLOT_NONE;
-        }
-    }
-
-    if (ab_slot_valid(g_ab_pending_slot))
-        g_ab_pending_valid = ab_slot_read_header(g_ab_pending_slot, &hdr) ? 1u : 0u;
-    else
-        g_ab_pending_valid = 0u;
+    /* Sanitized meta never pends the active slot. Validity flags stay clear
+     * until the background verify reports. */
+    ab_verify_submit(g_ab_active_slot, AB_VERIFY_ACTIVE);
+    if (g_ab_pending_slot != AB_SLOT_NONE)
+        ab_verify_submit(g_ab_pending_slot, AB_VERIFY_PROMOTE);
 }
 
 uint8_t ab_update_set_pending(uint8_t slot)
@@ -237,6 +378,9 @@ uint8_t ab_update_set_pending(uint8_t slot)
     if (slot != AB_SLOT_NONE && !ab_slot_valid(slot))
         return 0xFE;
 
+    /* A boot-time promotion must settle before the meta is rewritten. */
+    ab_update_verify_wait();
+
     ab_meta_t meta;
     uint8_t fresh = 0;
     ab_meta_load(&meta, &fresh);
@@ -251,10 +395,9 @@ uint8_t ab_update_set_pending(uint8_t slot)
     ab_meta_write(&meta);
 
     g_ab_pending_slot = slot;
-    if (slot != AB_SLOT_NONE && ab_slot_read_header(slot, NULL))
-        g_ab_pending_valid = 1u;
-    else
-        g_ab_pending_valid = 0u;
+    g_ab_pending_valid = 0u;
+    if (slot != AB_SLOT_NONE)
+        ab_verify_submit(slot, AB_VERIFY_PENDING);
 
     return 0;
 }
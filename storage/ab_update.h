@@ -45,11 +45,29 @@ extern uint8_t g_ab_active_valid;
 extern uint8_t g_ab_pending_valid;
 extern uint32_t g_ab_active_build_id;
 
+typedef struct {
+    uint8_t busy;
+    uint8_t queued;     /* jobs left, including the running one */
+    uint8_t slot;       /* slot being digested, or AB_SLOT_NONE */
+    uint8_t last_slot;  /* most recent finished verify */
+    uint8_t last_ok;
+    uint32_t done;      /* image bytes digested */
+    uint32_t total;
+} ab_verify_status_t;
+
 uint8_t ab_slot_valid(uint8_t slot);
+/* Blocking header + image CRC check. */
 int ab_slot_read_header(uint8_t slot, ab_slot_hdr_t *out);
 
+/* Both queue a background image verify: g_ab_active_valid and
+ * g_ab_pending_valid (and a boot-time promotion of the pending slot) are
+ * applied when it finishes. ab_update_tick() advances it from the main loop. */
 void ab_update_init(void);
 uint8_t ab_update_set_pending(uint8_t slot);
+void ab_update_tick(void);
+/* Runs queued verifies to completion. */
+void ab_update_verify_wait(void);
+void ab_update_get_verify(ab_verify_status_t *out);
 
 #endif
 
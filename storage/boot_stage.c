@@ -5,47 +5,100 @@
 #include "storage/layout.h"
 #include "util/byteorder.h"
 
-#define BOOT_STAGE_ENTRY_SIZE  8u
-#define BOOT_STAGE_ENTRY_COUNT (SPI_FLASH_SECTOR_SIZE / BOOT_STAGE_ENTRY_SIZE)
+typedef struct {
+    uint32_t code;
+    uint32_t ms;
+} boot_stage_entry_t;
 
-static uint8_t g_boot_stage_buf[SPI_FLASH_SECTOR_SIZE];
-static uint16_t g_boot_stage_index;
-static uint8_t g_boot_stage_inited;
+/* Newest BOOT_STAGE_RAM_ENTRIES codes; g_boot_stage_count keeps counting. */
+static boot_stage_entry_t g_boot_stage_ram[BOOT_STAGE_RAM_ENTRIES];
+static uint32_t g_boot_stage_count;
+static uint32_t g_boot_stage_committed;
 
-static void boot_stage_scan(void)
+static uint32_t boot_stage_slot_addr(uint8_t slot)
 {
-    spi_flash_read(BOOT_STAGE_STORAGE_BASE, g_boot_stage_buf, SPI_FLASH_SECTOR_SIZE);
-    for (uint16_t i = 0; i < BOOT_STAGE_ENTRY_COUNT; ++i)
+    return BOOT_STAGE_STORAGE_BASE + SPI_FLASH_PAGE_SIZE * (1u + (uint32_t)slot);
+}
+
+/* Reads the header; returns the index of the newest written slot or -1. */
+static int boot_stage_header(uint8_t *hdr)
+{
+    spi_flash_read(BOOT_STAGE_STORAGE_BASE, hdr, BOOT_STAGE_MARKS_OFFSET + BOOT_STAGE_SLOTS);
+    if (load_be32(hdr) != BOOT_STAGE_MAGIC)
+        return -2;
+    int last = -1;
+    for (uint8_t i = 0; i < BOOT_STAGE_SLOTS; ++i)
     {
-        const uint8_t *entry = &g_boot_stage_buf[i * BOOT_STAGE_ENTRY_SIZE];
-        if (load_be32(entry) == 0xFFFFFFFFu)
-        {
-            g_boot_stage_index = i;
-            return;
-        }
+        if (hdr[BOOT_STAGE_MARKS_OFFSET + i] == 0xFFu)
+            break;
+        last = i;
     }
-    g_boot_stage_index = BOOT_STAGE_ENTRY_COUNT;
+    return last;
 }
 
 void boot_stage_log(uint32_t code)
 {
-    if (!g_boot_stage_inited)
+    g_boot_stage_ram[g_boot_stage_count % BOOT_STAGE_RAM_ENTRIES] = (boot_stage_entry_t){ code, g_ms };
+    g_boot_stage_count++;
+}
+
+void boot_stage_commit(void)
+{
+    if (g_boot_stage_count == g_boot_stage_committed)
+        return;
+
+    uint8_t hdr[BOOT_STAGE_MARKS_OFFSET + BOOT_STAGE_SLOTS];
+    int last = boot_stage_header(hdr);
+    uint8_t slot = (uint8_t)(last + 1);
+    if (last < -1 || slot >= BOOT_STAGE_SLOTS)
     {
-        boot_stage_scan();
-        g_boot_stage_inited = 1u;
+        spi_flash_erase_4k(BOOT_STAGE_STORAGE_BASE);
+        store_be32(hdr, BOOT_STAGE_MAGIC);
+        spi_flash_write(BOOT_STAGE_STORAGE_BASE, hdr, 4u);
+        slot = 0u;
     }
 
-    if (g_boot_stage_index >= BOOT_STAGE_ENTRY_COUNT)
+    uint8_t page[SPI_FLASH_PAGE_SIZE];
+    uint32_t n = g_boot_stage_count - g_boot_stage_committed;
+    if (n > BOOT_STAGE_RAM_ENTRIES)
+        n = BOOT_STAGE_RAM_ENTRIES;
+    uint32_t first = g_boot_stage_count - n;
+    for (uint32_t i = 0; i < n; ++i)
     {
-        spi_flash_erase_4k(BOOT_STAGE_STORAGE_BASE);
-        g_boot_stage_index = 0u;
+        const boot_stage_entry_t *e = &g_boot_stage_ram[(first + i) % BOOT_STAGE_RAM_ENTRIES];
+        store_be32(&page[i * BOOT_STAGE_ENTRY_SIZE], e->code);
+        store_be32(&page[i * BOOT_STAGE_ENTRY_SIZE + 4u], e->ms);
     }
+    spi_flash_write(boot_stage_slot_addr(slot), page, n * BOOT_STAGE_ENTRY_SIZE);
+
+    uint8_t mark = 0x00u;
+    spi_flash_write(BOOT_STAGE_STORAGE_BASE + BOOT_STAGE_MARKS_OFFSET + slot, &mark, 1u);
+    g_boot_stage_committed = g_boot_stage_count;
+}
+
+int boot_stage_read_last(uint32_t *code_out, uint32_t *ms_out)
+{
+    if (code_out)
+        *code_out = 0u;
+    if (ms_out)
+        *ms_out = 0u;
 
-    uint8_t entry[BOOT_STAGE_ENTRY_SIZE];
-    store_be32(&entry[0], code);
-    store_be32(&entry[4], g_ms);
+    uint8_t hdr[BOOT_STAGE_MARKS_OFFSET + BOOT_STAGE_SLOTS];
+    int last = boot_stage_header(hdr);
+    if (last < 0)
+        return 0;
 
-    spi_flash_write(BOOT_STAGE_STORAGE_BASE + ((uint32_t)g_boot_stage_index * BOOT_STAGE_ENTRY_SIZE),
-                    entry, BOOT_STAGE_ENTRY_SIZE);
-    g_boot_stage_index++;
+    uint8_t page[SPI_FLASH_PAGE_SIZE];
+    spi_flash_read(boot_stage_slot_addr((uint8_t)last), page, sizeof(page));
+    uint32_t i = 0u;
+    while (i < BOOT_STAGE_RAM_ENTRIES && load_be32(&page[i * BOOT_STAGE_ENTRY_SIZE]) != 0xFFFFFFFFu)
+        i++;
+    if (i == 0u)
+        return 0;
+    const uint8_t *e = &page[(i - 1u) * BOOT_STAGE_ENTRY_SIZE];
+    if (code_out)
+        *code_out = load_be32(&e[0]);
+    if (ms_out)
+        *ms_out = load_be32(&e[4]);
+    return 1;
 }
@@ -3,6 +3,28 @@
 
 #include <stdint.h>
 
+/*
+ * Boot stage log: stage codes are staged in RAM while booting and written
+ * in one page program by boot_stage_commit() (end of boot, or the HardFault
+ * path), one page per boot.
+ *
+ * Sector layout (BOOT_STAGE_STORAGE_BASE, 4 KB):
+ *   page 0:  magic[4] 'BSTG', then one mark byte per boot slot
+ *            (0xFF free, 0x00 written)
+ *   page 1+: one boot each, up to 32 entries of {code[4], ms[4]} big-endian,
+ *            ended by an erased code
+ * A slot is marked only after its page is programmed, so a commit cut short
+ * leaves the previous boot as the last one.
+ */
+#define BOOT_STAGE_MAGIC         0x42535447u /* 'BSTG' */
+#define BOOT_STAGE_ENTRY_SIZE    8u
+#define BOOT_STAGE_RAM_ENTRIES   32u         /* one flash page */
+#define BOOT_STAGE_SLOTS         15u
+#define BOOT_STAGE_MARKS_OFFSET  4u
+
 void boot_stage_log(uint32_t code);
+void boot_stage_commit(void);
+/* Last code of the newest committed boot; returns 0 when there is none. */
+int boot_stage_read_last(uint32_t *code_out, uint32_t *ms_out);
 
 #endif
@@ -5,12 +5,14 @@
 #include "drivers/spi_flash.h"
 #include "platform/hw.h"
 #include "platform/mmio.h"
+#include "platform/overlay.h"
 #include "platform/time.h"
 #include "storage/layout.h"
 #include "util/byteorder.h"
 #include "util/crc32.h"
 
-static uint8_t g_crash_dump_buf[CRASH_DUMP_SIZE];
+_Static_assert(CRASH_DUMP_SIZE <= OVERLAY_ARENA_BYTES, "crash dump does not fit the overlay arena");
+
 static uint32_t g_crash_dump_seq;
 
 static void crash_dump_write(const uint8_t *buf)
@@ -36,16 +38,17 @@ static void crash_dump_zero(uint8_t *buf, size_t len)
         buf[i] = 0;
 }
 
-static uint32_t crash_dump_crc32(const uint8_t *buf)
+/* CRC over the record with its CRC field as zero; computed in place. */
+static uint32_t crash_dump_crc32(uint8_t *buf)
 {
-    uint8_t tmp[CRASH_DUMP_SIZE];
-    for (size_t i = 0; i < CRASH_DUMP_SIZE; ++i)
-        tmp[i] = buf[i];
-    store_be32(&tmp[CRASH_DUMP_OFF_CRC], 0);
-    return crc32_compute(tmp, CRASH_DUMP_SIZE);
+    uint32_t stored = load_be32(&buf[CRASH_DUMP_OFF_CRC]);
+    store_be32(&buf[CRASH_DUMP_OFF_CRC], 0);
+    uint32_t crc = crc32_compute(buf, CRASH_DUMP_SIZE);
+    store_be32(&buf[CRASH_DUMP_OFF_CRC], stored);
+    return crc;
 }
 
-static int crash_dump_valid(const uint8_t *buf)
+static int crash_dump_valid(uint8_t *buf)
 {
     if (!buf)
         return 0;
@@ -60,56 +63,96 @@ static int crash_dump_valid(const uint8_t *buf)
     return crc_expected == crc_actual;
 }
 
-uint8_t crash_dump_load(uint8_t *out)
+/* Reads and checks the stored dump in buf; zeroes buf when it is not valid. */
+static uint8_t crash_dump_load_into(uint8_t *buf)
 {
-    crash_dump_read(out);
-    if (!crash_dump_valid(out))
+    crash_dump_read(buf);
+    if (!crash_dump_valid(buf))
     {
-        crash_dump_zero(out, CRASH_DUMP_SIZE);
+        crash_dump_zero(buf, CRASH_DUMP_SIZE);
         return 0;
     }
     return 1;
 }
 
+uint8_t crash_dump_load(void)
+{
+    uint8_t *buf = platform_overlay_lease(OVERLAY_OWNER_CRASH_DUMP, CRASH_DUMP_SIZE);
+    if (!buf)
+        return 0;
+    uint8_t ok = crash_dump_load_into(buf);
+    platform_overlay_release(OVERLAY_OWNER_CRASH_DUMP);
+    return ok;
+}
+
+uint8_t crash_dump_copy(uint16_t offset, uint8_t *out, uint16_t len)
+{
+    if (!out || (uint32_t)offset + len > CRASH_DUMP_SIZE)
+        return 0;
+    crash_dump_zero(out, len);
+    uint8_t *buf = platform_overlay_lease(OVERLAY_OWNER_CRASH_DUMP, CRASH_DUMP_SIZE);
+    if (!buf)
+        return 0;
+    uint8_t ok = crash_dump_load_into(buf);
+    for (uint16_t i = 0; i < len; ++i)
+        out[i] = buf[offset + i];
+    platform_overlay_release(OVERLAY_OWNER_CRASH_DUMP);
+    return ok;
+}
+
 void crash_dump_clear_storage(void)
 {
-    crash_dump_zero(g_crash_dump_buf, CRASH_DUMP_SIZE);
-    crash_dump_write(g_crash_dump_buf);
+    uint8_t *buf = platform_overlay_lease(OVERLAY_OWNER_CRASH_DUMP, CRASH_DUMP_SIZE);
+    if (!buf)
+        return;
+    crash_dump_zero(buf, CRASH_DUMP_SIZE);
+    crash_dump_write(buf);
+    platform_overlay_release(OVERLAY_OWNER_CRASH_DUMP);
 }
 
 void crash_dump_capture(uint32_t sp, uint32_t lr, uint32_t pc, uint32_t psr)
 {
-    crash_dump_zero(g_crash_dump_buf, CRASH_DUMP_SIZE);
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_MAGIC], CRASH_DUMP_MAGIC);
-    store_be16(&g_crash_dump_buf[CRASH_DUMP_OFF_VERSION], CRASH_DUMP_VERSION);
-    store_be16(&g_crash_dump_buf[CRASH_DUMP_OFF_SIZE], CRASH_DUMP_SIZE);
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_FLAGS], 0);
+    /* The fault may have interrupted a flash update holding the arena;
+     * neither it nor anything else in thread mode runs again. */
+    uint8_t *buf = platform_overlay_seize(OVERLAY_OWNER_CRASH_DUMP);
+    crash_dump_zero(buf, CRASH_DUMP_SIZE);
+    store_be32(&buf[CRASH_DUMP_OFF_MAGIC], CRASH_DUMP_MAGIC);
+    store_be16(&buf[CRASH_DUMP_OFF_VERSION], CRASH_DUMP_VERSION);
+    store_be16(&buf[CRASH_DUMP_OFF_SIZE], CRASH_DUMP_SIZE);
+    store_be32(&buf[CRASH_DUMP_OFF_FLAGS], 0);
     g_crash_dump_seq++;
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_SEQ], g_crash_dump_seq);
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_MS], g_ms);
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_SP], sp);
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_LR], lr);
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_PC], pc);
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_PSR], psr);
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_CFSR], mmio_read32(SCB_CFSR));
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_HFSR], mmio_read32(SCB_HFSR));
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_DFSR], mmio_read32(SCB_DFSR));
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_MMFAR], mmio_read32(SCB_MMFAR));
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_BFAR], mmio_read32(SCB_BFAR));
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_AFSR], mmio_read32(SCB_AFSR));
+    store_be32(&buf[CRASH_DUMP_OFF_SEQ], g_crash_dump_seq);
+    store_be32(&buf[CRASH_DUMP_OFF_MS], g_ms);
+    store_be32(&buf[CRASH_DUMP_OFF_SP], sp);
+    store_be32(&buf[CRASH_DUMP_OFF_LR], lr);
+    store_be32(&buf[CRASH_DUMP_OFF_PC], pc);
+    store_be32(&buf[CRASH_DUMP_OFF_PSR], psr);
+    store_be32(&buf[CRASH_DUMP_OFF_CFSR], mmio_read32(SCB_CFSR));
+    store_be32(&buf[CRASH_DUMP_OFF_HFSR], mmio_read32(SCB_HFSR));
+    store_be32(&buf[CRASH_DUMP_OFF_DFSR], mmio_read32(SCB_DFSR));
+    store_be32(&buf[CRASH_DUMP_OFF_MMFAR], mmio_read32(SCB_MMFAR));
+    store_be32(&buf[CRASH_DUMP_OFF_BFAR], mmio_read32(SCB_BFAR));
+    store_be32(&buf[CRASH_DUMP_OFF_AFSR], mmio_read32(SCB_AFSR));
 
     uint32_t count = g_event_meta.count;
     uint8_t want = (count < CRASH_DUMP_EVENT_MAX) ? (uint8_t)count : (uint8_t)CRASH_DUMP_EVENT_MAX;
     uint16_t offset = (count > want) ? (uint16_t)(count - want) : 0u;
     uint8_t got = 0;
     if (want)
-        got = event_log_copy(offset, want, &g_crash_dump_buf[CRASH_DUMP_OFF_EVENT_RECORDS]);
-    store_be16(&g_crash_dump_buf[CRASH_DUMP_OFF_EVENT_COUNT], got);
-    store_be16(&g_crash_dump_buf[CRASH_DUMP_OFF_EVENT_REC_SIZE], EVENT_LOG_RECORD_SIZE);
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_EVENT_SEQ], g_event_meta.seq);
-
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_CRC], 0);
-    uint32_t crc = crc32_compute(g_crash_dump_buf, CRASH_DUMP_SIZE);
-    store_be32(&g_crash_dump_buf[CRASH_DUMP_OFF_CRC], crc);
-    crash_dump_write(g_crash_dump_buf);
+        got = event_log_copy(offset, want, &buf[CRASH_DUMP_OFF_EVENT_RECORDS]);
+    store_be16(&buf[CRASH_DUMP_OFF_EVENT_COUNT], got);
+    store_be16(&buf[CRASH_DUMP_OFF_EVENT_REC_SIZE], EVENT_LOG_RECORD_SIZE);
+    store_be32(&buf[CRASH_DUMP_OFF_EVENT_SEQ], g_event_meta.seq);
+
+    got = flight_rec_copy(&buf[CRASH_DUMP_OFF_FLIGHT_RECORDS], (uint8_t)CRASH_DUMP_FLIGHT_MAX);
+    store_be16(&buf[CRASH_DUMP_OFF_FLIGHT_COUNT], got);
+    store_be16(&buf[CRASH_DUMP_OFF_FLIGHT_REC_SIZE], FLIGHT_REC_ENTRY_SIZE);
+    store_be32(&buf[CRASH_DUMP_OFF_FLIGHT_HEAD], g_flight_rec.head);
+
+    store_be32(&buf[CRASH_DUMP_OFF_CRC], 0);
+    uint32_t crc = crc32_compute(buf, CRASH_DUMP_SIZE);
+    store_be32(&buf[CRASH_DUMP_OFF_CRC], crc);
+    crash_dump_write(buf);
+    /* The panic monitor may read it back or rewrite the boot flag. */
+    platform_overlay_release(OVERLAY_OWNER_CRASH_DUMP);
 }
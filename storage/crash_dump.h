@@ -3,14 +3,20 @@
 
 #include <stdint.h>
 
+#include "src/kernel/flight_rec.h"
 #include "storage/logs.h"
 
 /* Crash dump snapshot (fixed-size record in SPI flash) */
 #define CRASH_DUMP_MAGIC 0x43525348u /* 'CRSH' */
-#define CRASH_DUMP_VERSION 1u
+#define CRASH_DUMP_VERSION 2u
 #define CRASH_DUMP_EVENT_MAX 4u
 #define CRASH_DUMP_HEADER_SIZE 72u
-#define CRASH_DUMP_SIZE (CRASH_DUMP_HEADER_SIZE + (CRASH_DUMP_EVENT_MAX * EVENT_LOG_RECORD_SIZE))
+#define CRASH_DUMP_FLIGHT_MAX FLIGHT_REC_ENTRIES
+/* v2: the flight recorder ring follows the event records. */
+#define CRASH_DUMP_FLIGHT_BASE (CRASH_DUMP_HEADER_SIZE + (CRASH_DUMP_EVENT_MAX * EVENT_LOG_RECORD_SIZE))
+#define CRASH_DUMP_SIZE (CRASH_DUMP_FLIGHT_BASE + 8u + (CRASH_DUMP_FLIGHT_MAX * FLIGHT_REC_ENTRY_SIZE))
+/* Bytes per crash_dump_read reply; the dump no longer fits one frame. */
+#define CRASH_DUMP_PAGE 192u
 
 #define CRASH_DUMP_OFF_MAGIC 0u
 #define CRASH_DUMP_OFF_VERSION 4u
@@ -33,9 +39,17 @@
 #define CRASH_DUMP_OFF_EVENT_REC_SIZE 66u
 #define CRASH_DUMP_OFF_EVENT_SEQ 68u
 #define CRASH_DUMP_OFF_EVENT_RECORDS 72u
+#define CRASH_DUMP_OFF_FLIGHT_COUNT (CRASH_DUMP_FLIGHT_BASE + 0u)
+#define CRASH_DUMP_OFF_FLIGHT_REC_SIZE (CRASH_DUMP_FLIGHT_BASE + 2u)
+#define CRASH_DUMP_OFF_FLIGHT_HEAD (CRASH_DUMP_FLIGHT_BASE + 4u)
+#define CRASH_DUMP_OFF_FLIGHT_RECORDS (CRASH_DUMP_FLIGHT_BASE + 8u)
 
 void crash_dump_clear_storage(void);
-uint8_t crash_dump_load(uint8_t *out);
+/* The stored dump is read into the overlay arena while it is checked;
+ * both return 1 if it was valid. crash_dump_copy() hands back [offset,
+ * offset+len) of it, zeroed when no valid dump is present. */
+uint8_t crash_dump_load(void);
+uint8_t crash_dump_copy(uint16_t offset, uint8_t *out, uint16_t len);
 void crash_dump_capture(uint32_t sp, uint32_t lr, uint32_t pc, uint32_t psr);
 
 #endif
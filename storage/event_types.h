@@ -15,6 +15,8 @@ typedef enum {
     EVT_PIN_ATTEMPT     = 8,
     EVT_RESET_REASON    = 9, /* reset reason flags snapshot */
     EVT_BUS_INJECT      = 10,
+    EVT_POWER_FAIL      = 11, /* trip resumed from a brown-out record */
+    EVT_PACK_SAG        = 12, /* sag beyond I*R; flags=shortfall in 0.1 V */
     EVT_TEST_MARK       = 250, /* reserved for tests */
 } event_type_t;
 
@@ -0,0 +1,210 @@
+#include "storage/flash_health.h"
+
+#include <string.h>
+
+#include "drivers/spi_flash.h"
+#include "storage/kv_store.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+
+/* Stored as {erases[4] per region, then pages[4] per region}, big-endian. */
+#define FLASH_HEALTH_RECORD_SIZE (FLASH_HEALTH_REGION_COUNT * 8u)
+_Static_assert(FLASH_HEALTH_RECORD_SIZE <= KV_VALUE_MAX, "flash wear record does not fit a KV value");
+
+typedef struct {
+    uint32_t base;
+    uint32_t sectors;
+} flash_health_span_t;
+
+/* Everything outside these is FLASH_HEALTH_REGION_OTHER. Searched from the
+ * end: the stream log's last sector is the boot stage sector, and is
+ * charged to the boot stage. */
+static const flash_health_span_t k_spans[FLASH_HEALTH_REGION_OTHER] = {
+    [FLASH_HEALTH_REGION_CONFIG]     = {CONFIG_STORAGE_BASE, CONFIG_SLOT_COUNT},
+    [FLASH_HEALTH_REGION_TRIP]       = {TRIP_STORAGE_BASE, 1u},
+    [FLASH_HEALTH_REGION_EVENT_LOG]  = {EVENT_LOG_STORAGE_BASE, EVENT_LOG_STORAGE_BYTES / SPI_FLASH_SECTOR_SIZE},
+    [FLASH_HEALTH_REGION_STREAM_LOG] = {STREAM_LOG_STORAGE_BASE, STREAM_LOG_STORAGE_BYTES / SPI_FLASH_SECTOR_SIZE},
+    [FLASH_HEALTH_REGION_BOOT_STAGE] = {BOOT_STAGE_STORAGE_BASE, 1u},
+    [FLASH_HEALTH_REGION_CRASH_DUMP] = {CRASH_DUMP_STORAGE_BASE, 1u},
+    [FLASH_HEALTH_REGION_AB_META]    = {AB_META_BASE, (AB_SLOT0_BASE - AB_META_BASE) / SPI_FLASH_SECTOR_SIZE},
+    [FLASH_HEALTH_REGION_AB_SLOT0]   = {AB_SLOT0_BASE, AB_SLOT_STRIDE / SPI_FLASH_SECTOR_SIZE},
+    [FLASH_HEALTH_REGION_AB_SLOT1]   = {AB_SLOT1_BASE, AB_SLOT_STRIDE / SPI_FLASH_SECTOR_SIZE},
+    [FLASH_HEALTH_REGION_KV]         = {KV_STORAGE_BASE, KV_STORAGE_SECTORS},
+    [FLASH_HEALTH_REGION_RIDE_LOG]   = {RIDE_LOG_STORAGE_BASE, RIDE_LOG_STORAGE_BYTES / SPI_FLASH_SECTOR_SIZE},
+};
+
+typedef struct {
+    uint32_t erases;
+    uint32_t pages;
+    uint32_t read_bytes;
+    uint32_t busy_ms;
+    uint16_t busy_us; /* carried into busy_ms */
+    uint32_t block_max_us;
+} flash_health_ram_t;
+
+static struct {
+    flash_health_ram_t ram[FLASH_HEALTH_REGION_COUNT];
+    /* Lifetime totals before the RAM counters started. */
+    uint32_t base_erases[FLASH_HEALTH_REGION_COUNT];
+    uint32_t base_pages[FLASH_HEALTH_REGION_COUNT];
+    uint32_t saved_erases;
+    uint32_t saved_pages;
+    uint32_t saved_ms;
+    uint8_t loaded;
+} g_fh;
+
+uint8_t flash_health_region_of(uint32_t addr)
+{
+    for (uint8_t i = FLASH_HEALTH_REGION_OTHER; i-- > 0u;)
+    {
+        if (addr - k_spans[i].base < k_spans[i].sectors * SPI_FLASH_SECTOR_SIZE)
+            return i;
+    }
+    return FLASH_HEALTH_REGION_OTHER;
+}
+
+void flash_health_note_erase(uint32_t addr)
+{
+    g_fh.ram[flash_health_region_of(addr)].erases++;
+}
+
+void flash_health_note_program(uint32_t addr)
+{
+    g_fh.ram[flash_health_region_of(addr)].pages++;
+}
+
+/* A read that crosses into the next region is charged to the first. */
+void flash_health_note_read(uint32_t addr, uint32_t len)
+{
+    g_fh.ram[flash_health_region_of(addr)].read_bytes += len;
+}
+
+void flash_health_note_busy(uint32_t addr, uint32_t us)
+{
+    flash_health_ram_t *r = &g_fh.ram[flash_health_region_of(addr)];
+    uint32_t t = r->busy_us + us;
+    r->busy_ms += t / 1000u;
+    r->busy_us = (uint16_t)(t % 1000u);
+}
+
+void flash_health_note_block(uint32_t addr, uint32_t us)
+{
+    flash_health_ram_t *r = &g_fh.ram[flash_health_region_of(addr)];
+    if (us > r->block_max_us)
+        r->block_max_us = us;
+}
+
+/*
+ * Change since the last checkpoint: any erase, or a program outside the KV
+ * region. The checkpoint's own KV append would otherwise keep the totals
+ * dirty forever; KV programs ride along with the next real change.
+ */
+static void flash_health_sums(uint32_t *erases, uint32_t *pages)
+{
+    *erases = 0u;
+    *pages = 0u;
+    for (uint8_t i = 0; i < FLASH_HEALTH_REGION_COUNT; ++i)
+    {
+        *erases += g_fh.base_erases[i] + g_fh.ram[i].erases;
+        if (i != FLASH_HEALTH_REGION_KV)
+            *pages += g_fh.base_pages[i] + g_fh.ram[i].pages;
+    }
+}
+
+void flash_health_init(void)
+{
+    uint8_t buf[FLASH_HEALTH_RECORD_SIZE];
+    memset(g_fh.base_erases, 0, sizeof(g_fh.base_erases));
+    memset(g_fh.base_pages, 0, sizeof(g_fh.base_pages));
+    if (kv_get(KV_KEY_FLASH_WEAR, buf, sizeof(buf)) == (int)sizeof(buf))
+    {
+        for (uint8_t i = 0; i < FLASH_HEALTH_REGION_COUNT; ++i)
+        {
+            g_fh.base_erases[i] = load_be32(&buf[4u * i]);
+            g_fh.base_pages[i] = load_be32(&buf[4u * (FLASH_HEALTH_REGION_COUNT + i)]);
+        }
+    }
+    flash_health_sums(&g_fh.saved_erases, &g_fh.saved_pages);
+    g_fh.saved_ms = 0u;
+    g_fh.loaded = 1u;
+}
+
+void flash_health_tick(uint32_t now_ms)
+{
+    if (!g_fh.loaded || (uint32_t)(now_ms - g_fh.saved_ms) < FLASH_HEALTH_SAVE_MS)
+        return;
+    uint32_t erases;
+    uint32_t pages;
+    flash_health_sums(&erases, &pages);
+    if (erases == g_fh.saved_erases && pages == g_fh.saved_pages)
+        return;
+    uint8_t buf[FLASH_HEALTH_RECORD_SIZE];
+    for (uint8_t i = 0; i < FLASH_HEALTH_REGION_COUNT; ++i)
+    {
+        store_be32(&buf[4u * i], g_fh.base_erases[i] + g_fh.ram[i].erases);
+        store_be32(&buf[4u * (FLASH_HEALTH_REGION_COUNT + i)], g_fh.base_pages[i] + g_fh.ram[i].pages);
+    }
+    if (!kv_put(KV_KEY_FLASH_WEAR, buf, sizeof(buf)))
+        return;
+    g_fh.saved_erases = erases;
+    g_fh.saved_pages = pages;
+    g_fh.saved_ms = now_ms;
+}
+
+void flash_health_get(uint8_t region, flash_health_region_t *out)
+{
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+    if (region >= FLASH_HEALTH_REGION_COUNT)
+        return;
+    const flash_health_ram_t *r = &g_fh.ram[region];
+    out->erases = r->erases;
+    out->pages = r->pages;
+    out->read_bytes = r->read_bytes;
+    out->busy_ms = r->busy_ms;
+    out->block_max_us = r->block_max_us;
+    out->life_erases = g_fh.base_erases[region] + r->erases;
+    out->life_pages = g_fh.base_pages[region] + r->pages;
+    if (region == FLASH_HEALTH_REGION_OTHER)
+    {
+        out->remaining_permille = FLASH_HEALTH_WEAR_UNKNOWN;
+        return;
+    }
+    /* Mean cycles per sector against the rating, in per mille. */
+    uint32_t used = (out->life_erases / k_spans[region].sectors) / (FLASH_HEALTH_SECTOR_CYCLES / 1000u);
+    out->remaining_permille = (uint16_t)((used >= 1000u) ? 0u : (1000u - used));
+}
+
+void flash_health_total(flash_health_region_t *out)
+{
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+    out->remaining_permille = FLASH_HEALTH_WEAR_UNKNOWN;
+    for (uint8_t i = 0; i < FLASH_HEALTH_REGION_COUNT; ++i)
+    {
+        flash_health_region_t r;
+        flash_health_get(i, &r);
+        out->erases += r.erases;
+        out->pages += r.pages;
+        out->read_bytes += r.read_bytes;
+        out->busy_ms += r.busy_ms;
+        if (r.block_max_us > out->block_max_us)
+            out->block_max_us = r.block_max_us;
+        out->life_erases += r.life_erases;
+        out->life_pages += r.life_pages;
+        if (r.remaining_permille < out->remaining_permille)
+            out->remaining_permille = r.remaining_permille;
+    }
+}
+
+void flash_health_reset(void)
+{
+    for (uint8_t i = 0; i < FLASH_HEALTH_REGION_COUNT; ++i)
+    {
+        g_fh.base_erases[i] += g_fh.ram[i].erases;
+        g_fh.base_pages[i] += g_fh.ram[i].pages;
+    }
+    memset(g_fh.ram, 0, sizeof(g_fh.ram));
+}
@@ -0,0 +1,69 @@
+#ifndef OPEN_FIRMWARE_STORAGE_FLASH_HEALTH_H
+#define OPEN_FIRMWARE_STORAGE_FLASH_HEALTH_H
+
+#include <stdint.h>
+
+/*
+ * SPI flash I/O per storage region (storage/layout.h), counted by
+ * drivers/spi_flash.c as the operations reach the chip: sector erases, page
+ * programs, bytes read off the bus (cache hits do not count), time the chip
+ * was busy erasing or programming, and the longest a caller blocked waiting
+ * for it.
+ *
+ * Counters run in RAM since boot (or the last reset). Erases and page
+ * programs are also kept for the life of the part: they are checkpointed to
+ * KV_KEY_FLASH_WEAR at most every FLASH_HEALTH_SAVE_MS while they change, so
+ * a power cut loses at most that much. Remaining endurance assumes the
+ * region's erases are spread over its sectors, which holds for the rings,
+ * the A/B config slots and the KV round robin; a region that rewrites one
+ * sector wears it faster than the estimate shows.
+ */
+#define FLASH_HEALTH_REGION_CONFIG     0u
+#define FLASH_HEALTH_REGION_TRIP       1u
+#define FLASH_HEALTH_REGION_EVENT_LOG  2u
+#define FLASH_HEALTH_REGION_STREAM_LOG 3u
+#define FLASH_HEALTH_REGION_BOOT_STAGE 4u
+#define FLASH_HEALTH_REGION_CRASH_DUMP 5u
+#define FLASH_HEALTH_REGION_AB_META    6u
+#define FLASH_HEALTH_REGION_AB_SLOT0   7u
+#define FLASH_HEALTH_REGION_AB_SLOT1   8u
+#define FLASH_HEALTH_REGION_KV         9u
+#define FLASH_HEALTH_REGION_RIDE_LOG   10u
+#define FLASH_HEALTH_REGION_OTHER      11u /* recordings, splash, assets, OEM area */
+#define FLASH_HEALTH_REGION_COUNT      12u
+
+#define FLASH_HEALTH_SECTOR_CYCLES 100000u /* rated erase cycles per sector */
+#define FLASH_HEALTH_SAVE_MS       600000u
+#define FLASH_HEALTH_WEAR_UNKNOWN  0xFFFFu
+
+typedef struct {
+    uint32_t erases;       /* since boot */
+    uint32_t pages;        /* page programs since boot */
+    uint32_t read_bytes;
+    uint32_t busy_ms;      /* chip erasing or programming */
+    uint32_t block_max_us; /* longest wait for the chip to finish */
+    uint32_t life_erases;
+    uint32_t life_pages;
+    uint16_t remaining_permille; /* FLASH_HEALTH_WEAR_UNKNOWN for OTHER */
+} flash_health_region_t;
+
+uint8_t flash_health_region_of(uint32_t addr);
+
+/* Driver hooks: cheap RAM updates, safe before flash_health_init(). */
+void flash_health_note_erase(uint32_t addr);
+void flash_health_note_program(uint32_t addr);
+void flash_health_note_read(uint32_t addr, uint32_t len);
+void flash_health_note_busy(uint32_t addr, uint32_t us);
+void flash_health_note_block(uint32_t addr, uint32_t us);
+
+/* Loads the lifetime totals; after kv_init(). */
+void flash_health_init(void);
+void flash_health_tick(uint32_t now_ms);
+
+void flash_health_get(uint8_t region, flash_health_region_t *out);
+/* Sums every region; block_max_us and remaining_permille are the worst. */
+void flash_health_total(flash_health_region_t *out);
+/* Clears the since-boot counters; lifetime totals are kept. */
+void flash_health_reset(void);
+
+#endif
@@ -0,0 +1,261 @@
+#include "storage/flash_jobs.h"
+
+#include <stddef.h>
+
+#include "drivers/spi_flash.h"
+#include "platform/watchdog.h"
+
+#define FLASH_JOB_ERASE 1u
+#define FLASH_JOB_PROGRAM 2u
+#define FLASH_JOB_READ 3u
+
+typedef struct {
+    uint8_t type;
+    uint32_t addr;
+    uint32_t len;
+    uint32_t done_len; /* programs advance one page per op */
+    const uint8_t *src;
+    uint8_t *dst;
+    flash_job_done_fn done;
+    void *ctx;
+    uint8_t inline_data[FLASH_JOBS_INLINE_MAX];
+} flash_job_t;
+
+static struct {
+    flash_job_t jobs[FLASH_JOBS_DEPTH];
+    uint8_t head;
+    uint8_t count;
+    uint8_t in_flight; /* jobs[head] has an op running */
+    flash_jobs_stats_t stats;
+} g_flash_jobs;
+
+static flash_job_t *flash_jobs_slot(uint8_t i)
+{
+    return &g_flash_jobs.jobs[(uint8_t)((g_flash_jobs.head + i) % FLASH_JOBS_DEPTH)];
+}
+
+static flash_job_t *flash_jobs_alloc(uint8_t type, uint32_t addr, uint32_t len,
+                                     flash_job_done_fn done, void *ctx)
+{
+    if (g_flash_jobs.count >= FLASH_JOBS_DEPTH)
+        return NULL;
+    flash_job_t *j = flash_jobs_slot(g_flash_jobs.count);
+    g_flash_jobs.count++;
+    if (g_flash_jobs.count > g_flash_jobs.stats.max_depth)
+        g_flash_jobs.stats.max_depth = g_flash_jobs.count;
+    g_flash_jobs.stats.submitted++;
+    j->type = type;
+    j->addr = addr;
+    j->len = len;
+    j->done_len = 0u;
+    j->src = NULL;
+    j->dst = NULL;
+    j->done = done;
+    j->ctx = ctx;
+    return j;
+}
+
+static void flash_jobs_pop(void)
+{
+    flash_job_t *j = flash_jobs_slot(0u);
+    flash_job_done_fn done = j->done;
+    void *ctx = j->ctx;
+    g_flash_jobs.head = (uint8_t)((g_flash_jobs.head + 1u) % FLASH_JOBS_DEPTH);
+    g_flash_jobs.count--;
+    g_flash_jobs.in_flight = 0u;
+    g_flash_jobs.stats.completed++;
+    if (done)
+        done(ctx, 1u);
+}
+
+static uint8_t flash_jobs_overlap(const flash_job_t *a, const flash_job_t *b)
+{
+    return (a->addr < b->addr + b->len && b->addr < a->addr + a->len) ? 1u : 0u;
+}
+
+/* Moves the first queued read to the head so it runs before pending writes,
+ * unless one of those writes touches the bytes it reads. */
+static void flash_jobs_promote_read(void)
+{
+    for (uint8_t i = 1u; i < g_flash_jobs.count; ++i)
+    {
+        flash_job_t *j = flash_jobs_slot(i);
+        if (j->type != FLASH_JOB_READ)
+            continue;
+        uint8_t blocked = 0u;
+        for (uint8_t k = 0u; k < i && !blocked; ++k)
+            blocked = flash_jobs_overlap(flash_jobs_slot(k), j);
+        if (blocked)
+            continue;
+        flash_job_t tmp = *j;
+        for (uint8_t k = i; k > 0u; --k)
+            *flash_jobs_slot(k) = *flash_jobs_slot((uint8_t)(k - 1u));
+        *flash_jobs_slot(0u) = tmp;
+        /* Inline program data moved with its job; re-point borrowed copies. */
+        for (uint8_t k = 0u; k <= i; ++k)
+        {
+            flash_job_t *m = flash_jobs_slot(k);
+            if (m->type == FLASH_JOB_PROGRAM && m->len <= FLASH_JOBS_INLINE_MAX)
+                m->src = m->inline_data;
+        }
+        return;
+    }
+}
+
+void flash_jobs_init(void)
+{
+    uint8_t *p = (uint8_t *)&g_flash_jobs;
+    for (size_t i = 0; i < sizeof(g_flash_jobs); ++i)
+        p[i] = 0u;
+}
+
+void flash_jobs_tick(void)
+{
+    if (g_flash_jobs.in_flight)
+    {
+        if (spi_flash_busy())
+        {
+            if (g_flash_jobs.stats.busy_polls != 0xFFFFu)
+                g_flash_jobs.stats.busy_polls++;
+            return;
+        }
+        flash_job_t *j = flash_jobs_slot(0u);
+        if (j->type == FLASH_JOB_PROGRAM && j->done_len < j->len)
+        {
+            g_flash_jobs.in_flight = 0u; /* next page below */
+        }
+        else
+        {
+            flash_jobs_pop();
+        }
+    }
+
+    if (g_flash_jobs.count == 0u)
+        return;
+    if (!g_flash_jobs.in_flight && flash_jobs_slot(0u)->done_len == 0u)
+        flash_jobs_promote_read();
+
+    flash_job_t *j = flash_jobs_slot(0u);
+    switch (j->type)
+    {
+    case FLASH_JOB_READ:
+        /* Reads are short and synchronous; complete in this tick. */
+        spi_flash_read(j->addr, j->dst, j->len);
+        flash_jobs_pop();
+        break;
+    case FLASH_JOB_ERASE:
+        spi_flash_erase_4k_start(j->addr);
+        g_flash_jobs.in_flight = 1u;
+        break;
+    case FLASH_JOB_PROGRAM:
+    {
+        uint32_t addr = j->addr + j->done_len;
+        uint32_t n = SPI_FLASH_PAGE_SIZE - (addr & (SPI_FLASH_PAGE_SIZE - 1u));
+        if (n > j->len - j->done_len)
+            n = j->len - j->done_len;
+        spi_flash_page_program_start(addr, j->src + j->done_len, n);
+        j->done_len += n;
+        g_flash_jobs.in_flight = 1u;
+        break;
+    }
+    default:
+        flash_jobs_pop();
+        break;
+    }
+}
+
+uint8_t flash_jobs_pending(void)
+{
+    return g_flash_jobs.count;
+}
+
+void flash_jobs_flush(void)
+{
+    /* Each job gets its own budget; one that never completes stops the
+     * feeds and leaves the reset to the watchdog. */
+    watchdog_budget_t budget;
+    uint8_t count = g_flash_jobs.count;
+    watchdog_budget_begin(&budget, 0u);
+    while (g_flash_jobs.count)
+    {
+        flash_jobs_tick();
+        if (g_flash_jobs.count != count)
+        {
+            count = g_flash_jobs.count;
+            watchdog_budget_begin(&budget, 0u);
+        }
+        (void)watchdog_budget_poll(&budget);
+    }
+}
+
+int flash_jobs_submit_erase(uint32_t addr, flash_job_done_fn done, void *ctx)
+{
+    return flash_jobs_alloc(FLASH_JOB_ERASE, addr, SPI_FLASH_SECTOR_SIZE, done, ctx) ? 1 : 0;
+}
+
+int flash_jobs_submit_program(uint32_t addr, const uint8_t *data, uint32_t len,
+                              flash_job_done_fn done, void *ctx)
+{
+    if (!data || len == 0u)
+        return 0;
+    flash_job_t *j = flash_jobs_alloc(FLASH_JOB_PROGRAM, addr, len, done, ctx);
+    if (!j)
+        return 0;
+    if (len <= FLASH_JOBS_INLINE_MAX)
+    {
+        for (uint32_t i = 0; i < len; ++i)
+            j->inline_data[i] = data[i];
+        j->src = j->inline_data;
+    }
+    else
+    {
+        j->src = data;
+    }
+    return 1;
+}
+
+int flash_jobs_submit_read(uint32_t addr, uint8_t *out, uint32_t len,
+                           flash_job_done_fn done, void *ctx)
+{
+    if (!out || len == 0u)
+        return 0;
+    flash_job_t *j = flash_jobs_alloc(FLASH_JOB_READ, addr, len, done, ctx);
+    if (!j)
+        return 0;
+    j->dst = out;
+    return 1;
+}
+
+void flash_jobs_erase(uint32_t addr)
+{
+    if (flash_jobs_submit_erase(addr, NULL, NULL))
+        return;
+    g_flash_jobs.stats.fallbacks++;
+    flash_jobs_flush();
+    spi_flash_erase_4k(addr);
+}
+
+void flash_jobs_erase_region(uint32_t addr, uint32_t len)
+{
+    if (len == 0u)
+        return;
+    uint32_t start = addr & ~(SPI_FLASH_SECTOR_SIZE - 1u);
+    uint32_t end = (addr + len + (SPI_FLASH_SECTOR_SIZE - 1u)) & ~(SPI_FLASH_SECTOR_SIZE - 1u);
+    for (uint32_t a = start; a < end; a += SPI_FLASH_SECTOR_SIZE)
+        flash_jobs_erase(a);
+}
+
+void flash_jobs_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if (flash_jobs_submit_program(addr, data, len, NULL, NULL))
+        return;
+    g_flash_jobs.stats.fallbacks++;
+    flash_jobs_flush();
+    spi_flash_write(addr, data, len);
+}
+
+void flash_jobs_get_stats(flash_jobs_stats_t *out)
+{
+    if (out)
+        *out = g_flash_jobs.stats;
+}
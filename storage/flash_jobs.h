@@ -0,0 +1,52 @@
+#ifndef OPEN_FIRMWARE_STORAGE_FLASH_JOBS_H
+#define OPEN_FIRMWARE_STORAGE_FLASH_JOBS_H
+
+#include <stdint.h>
+
+/*
+ * Background SPI flash jobs (erase, program, read) advanced by
+ * flash_jobs_tick() from the main loop: one op is in flight at a time and
+ * completion is detected by polling WIP, so a 4 KB erase costs the loop a
+ * few status reads instead of ~50 ms.
+ *
+ * Jobs run in submission order, except reads, which go ahead of queued
+ * erases/programs. Synchronous spi_flash_read() callers are still safe while
+ * a job runs (the driver suspends the erase around the read).
+ */
+
+#define FLASH_JOBS_DEPTH 8u
+/* Programs up to this size are copied into the job; larger ones borrow the
+ * caller's buffer, which must stay valid until the callback. */
+#define FLASH_JOBS_INLINE_MAX 40u
+
+typedef void (*flash_job_done_fn)(void *ctx, uint8_t ok);
+
+typedef struct {
+    uint32_t submitted;
+    uint32_t completed;
+    uint32_t fallbacks;  /* queue full; ran synchronously */
+    uint16_t max_depth;
+    uint16_t busy_polls; /* saturating */
+} flash_jobs_stats_t;
+
+void flash_jobs_init(void);
+void flash_jobs_tick(void);
+uint8_t flash_jobs_pending(void);
+/* Blocks until the queue is empty (before reset, or to read back queued data). */
+void flash_jobs_flush(void);
+
+/* Return 0 when the queue is full. */
+int flash_jobs_submit_erase(uint32_t addr, flash_job_done_fn done, void *ctx);
+int flash_jobs_submit_program(uint32_t addr, const uint8_t *data, uint32_t len,
+                              flash_job_done_fn done, void *ctx);
+int flash_jobs_submit_read(uint32_t addr, uint8_t *out, uint32_t len,
+                           flash_job_done_fn done, void *ctx);
+
+/* Queue when possible; otherwise flush and run blocking, keeping order. */
+void flash_jobs_erase(uint32_t addr);
+void flash_jobs_erase_region(uint32_t addr, uint32_t len);
+void flash_jobs_program(uint32_t addr, const uint8_t *data, uint32_t len);
+
+void flash_jobs_get_stats(flash_jobs_stats_t *out);
+
+#endif
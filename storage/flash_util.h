@@ -4,6 +4,8 @@
 #include <stdint.h>
 
 #include "drivers/spi_flash.h"
+#include "platform/watchdog.h"
+#include "util/crc32.h"
 
 static inline void spi_flash_erase_region(uint32_t addr, uint32_t len)
 {
@@ -15,5 +17,73 @@ static inline void spi_flash_erase_region(uint32_t addr, uint32_t len)
         spi_flash_erase_4k(a);
 }
 
+/* Feeds `len` bytes of SPI flash into `s`. Page-sized chunks keep each read
+ * on the DMA path; the watchdog is fed between them while the budget lasts. */
+static inline void spi_flash_crc32_feed(crc32_stream_t *s, uint32_t addr, uint32_t len)
+{
+    uint8_t chunk[SPI_FLASH_PAGE_SIZE];
+    watchdog_budget_t budget;
+    watchdog_budget_begin(&budget, 0u);
+    while (len)
+    {
+        uint32_t n = len > sizeof(chunk) ? (uint32_t)sizeof(chunk) : len;
+        spi_flash_read(addr, chunk, n);
+        crc32_stream_feed(s, chunk, n);
+        addr += n;
+        len -= n;
+        (void)watchdog_budget_poll(&budget);
+    }
+}
+
+/*
+ * Sequential upload into a region whose header sits in its first sector and
+ * goes in last. Begin erases that sector, which drops the old header; writes
+ * must arrive strictly in order so sectors can be erased just ahead of the
+ * writer; verify checks the length and CRC of what arrived. Blocking flash
+ * calls, for the command-driven stores (splash, UI assets, bus replay).
+ */
+typedef struct {
+    uint32_t base;         /* flash address of offset 0 */
+    uint32_t max;          /* bytes the region holds past base */
+    uint32_t write_offset; /* bytes written so far */
+    uint32_t erased_end;   /* absolute flash address; sectors below it are erased */
+} flash_upload_t;
+
+static inline void flash_upload_begin(flash_upload_t *u, uint32_t header_addr, uint32_t base, uint32_t max)
+{
+    spi_flash_erase_4k(header_addr);
+    u->base = base;
+    u->max = max;
+    u->write_offset = 0u;
+    u->erased_end = (header_addr & ~(SPI_FLASH_SECTOR_SIZE - 1u)) + SPI_FLASH_SECTOR_SIZE;
+}
+
+/* Returns 0 for an empty, out of order or oversized chunk. */
+static inline int flash_upload_write(flash_upload_t *u, uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    if (!data || len == 0u || offset != u->write_offset || len > u->max - offset)
+        return 0;
+    uint32_t addr = u->base + offset;
+    while (u->erased_end < addr + len)
+    {
+        spi_flash_erase_4k(u->erased_end);
+        u->erased_end += SPI_FLASH_SECTOR_SIZE;
+    }
+    spi_flash_write(addr, data, len);
+    u->write_offset += len;
+    return 1;
+}
+
+/* 1 when exactly `bytes` (non-zero) arrived and they match `crc32`. */
+static inline int flash_upload_verify(const flash_upload_t *u, uint32_t bytes, uint32_t crc32)
+{
+    if (bytes == 0u || bytes != u->write_offset)
+        return 0;
+    crc32_stream_t crc;
+    crc32_stream_begin(&crc);
+    spi_flash_crc32_feed(&crc, u->base, bytes);
+    return crc32_stream_end(&crc) == crc32;
+}
+
 #endif
 
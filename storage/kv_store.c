@@ -0,0 +1,252 @@
+#include "storage/kv_store.h"
+
+#include <stddef.h>
+
+#include "drivers/spi_flash.h"
+#include "storage/flash_jobs.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+#define KV_MAGIC 0x3153564Bu /* 'KVS1' */
+/* Sector header: magic, generation, ~generation. */
+#define KV_HDR_SIZE 12u
+/* Record: key, len, value[len], crc32 over key..value; padded to 4 bytes. */
+#define KV_REC_HDR 2u
+#define KV_REC_CRC 4u
+#define KV_REC_RAW(len) (KV_REC_HDR + (uint32_t)(len) + KV_REC_CRC)
+#define KV_REC_SIZE(len) ((KV_REC_RAW(len) + 3u) & ~3u)
+
+/* A compaction must always fit every live key plus the incoming record. */
+_Static_assert(KV_HDR_SIZE + KV_KEY_COUNT * KV_REC_SIZE(KV_VALUE_MAX) <= SPI_FLASH_SECTOR_SIZE,
+               "kv sector too small for all keys");
+
+static struct {
+    uint8_t ready;
+    uint8_t sector;
+    uint32_t gen;
+    uint32_t off;                 /* next append offset in the active sector */
+    uint16_t rec_off[KV_KEY_COUNT]; /* 0 = absent */
+    uint8_t len[KV_KEY_COUNT];
+    uint32_t crc[KV_KEY_COUNT];
+    kv_stats_t stats;
+} g_kv;
+
+static uint32_t kv_sector_addr(uint8_t s)
+{
+    return KV_STORAGE_BASE + (uint32_t)s * SPI_FLASH_SECTOR_SIZE;
+}
+
+/* flash_jobs copies programs up to FLASH_JOBS_INLINE_MAX, so callers may
+ * reuse their buffer immediately. */
+static void kv_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    while (len)
+    {
+        uint32_t n = len > FLASH_JOBS_INLINE_MAX ? FLASH_JOBS_INLINE_MAX : len;
+        flash_jobs_program(addr, data, n);
+        addr += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static int kv_read_header(uint8_t s, uint32_t *gen)
+{
+    uint8_t h[KV_HDR_SIZE];
+    spi_flash_read(kv_sector_addr(s), h, sizeof(h));
+    if (load_be32(h) != KV_MAGIC)
+        return 0;
+    uint32_t g = load_be32(h + 4);
+    if ((g ^ load_be32(h + 8)) != 0xFFFFFFFFu)
+        return 0;
+    *gen = g;
+    return 1;
+}
+
+static void kv_write_header(uint8_t s, uint32_t gen)
+{
+    uint8_t h[KV_HDR_SIZE];
+    store_be32(h, KV_MAGIC);
+    store_be32(h + 4, gen);
+    store_be32(h + 8, ~gen);
+    kv_program(kv_sector_addr(s), h, sizeof(h));
+}
+
+static uint32_t kv_record_crc(const uint8_t *rec, uint8_t len)
+{
+    return crc32_compute(rec, KV_REC_HDR + (uint32_t)len);
+}
+
+static void kv_scan(void)
+{
+    uint32_t base = kv_sector_addr(g_kv.sector);
+    uint32_t off = KV_HDR_SIZE;
+    uint8_t rec[KV_REC_RAW(KV_VALUE_MAX)];
+    while (off + KV_REC_SIZE(0) <= SPI_FLASH_SECTOR_SIZE)
+    {
+        spi_flash_read(base + off, rec, KV_REC_HDR);
+        uint8_t key = rec[0];
+        uint8_t len = rec[1];
+        if (key == 0xFFu && len == 0xFFu)
+            break; /* erased tail */
+        if (len > KV_VALUE_MAX || off + KV_REC_SIZE(len) > SPI_FLASH_SECTOR_SIZE)
+        {
+            /* Length itself is damaged; nothing after it can be trusted. */
+            g_kv.stats.torn++;
+            off = SPI_FLASH_SECTOR_SIZE;
+            break;
+        }
+        spi_flash_read(base + off + KV_REC_HDR, rec + KV_REC_HDR, (uint32_t)len + KV_REC_CRC);
+        uint32_t crc = kv_record_crc(rec, len);
+        if (key != 0u && key < KV_KEY_COUNT && crc == load_be32(rec + KV_REC_HDR + len))
+        {
+            g_kv.rec_off[key] = (uint16_t)off;
+            g_kv.len[key] = len;
+            g_kv.crc[key] = crc;
+        }
+        else
+        {
+            g_kv.stats.torn++;
+        }
+        off += KV_REC_SIZE(len);
+    }
+    g_kv.off = off;
+}
+
+void kv_init(void)
+{
+    uint8_t *p = (uint8_t *)&g_kv;
+    for (uint32_t i = 0; i < sizeof(g_kv); ++i)
+        p[i] = 0u;
+
+    uint8_t found = 0;
+    for (uint8_t s = 0; s < KV_STORAGE_SECTORS; ++s)
+    {
+        uint32_t gen;
+        if (!kv_read_header(s, &gen))
+            continue;
+        if (!found || (int32_t)(gen - g_kv.gen) > 0)
+        {
+            g_kv.sector = s;
+            g_kv.gen = gen;
+            found = 1;
+        }
+    }
+
+    if (found)
+    {
+        kv_scan();
+    }
+    else
+    {
+        g_kv.sector = 0;
+        g_kv.gen = 1u;
+        g_kv.off = KV_HDR_SIZE;
+        flash_jobs_erase(kv_sector_addr(0));
+        kv_write_header(0, g_kv.gen);
+    }
+    g_kv.ready = 1;
+}
+
+/* Moves live values to the next sector, appends `rec` there and commits it
+ * by writing the header last. */
+static void kv_compact(uint8_t key, const uint8_t *rec, uint8_t len, uint32_t crc)
+{
+    uint8_t src = g_kv.sector;
+    uint8_t dst = (uint8_t)((src + 1u) % KV_STORAGE_SECTORS);
+    uint32_t src_base = kv_sector_addr(src);
+    uint32_t dst_base = kv_sector_addr(dst);
+
+    /* Live records may still be queued; they must be on flash to copy. */
+    flash_jobs_flush();
+    flash_jobs_erase(dst_base);
+
+    uint32_t off = KV_HDR_SIZE;
+    uint8_t buf[KV_REC_RAW(KV_VALUE_MAX)];
+    for (uint8_t k = 1; k < KV_KEY_COUNT; ++k)
+    {
+        if (k == key || !g_kv.rec_off[k])
+            continue;
+        uint32_t n = KV_REC_RAW(g_kv.len[k]);
+        spi_flash_read(src_base + g_kv.rec_off[k], buf, n);
+        kv_program(dst_base + off, buf, n);
+        g_kv.rec_off[k] = (uint16_t)off;
+        off += KV_REC_SIZE(g_kv.len[k]);
+    }
+    kv_program(dst_base + off, rec, KV_REC_RAW(len));
+    g_kv.rec_off[key] = (uint16_t)off;
+    g_kv.len[key] = len;
+    g_kv.crc[key] = crc;
+    off += KV_REC_SIZE(len);
+
+    g_kv.gen++;
+    kv_write_header(dst, g_kv.gen);
+    g_kv.sector = dst;
+    g_kv.off = off;
+    g_kv.stats.compactions++;
+}
+
+int kv_put(uint8_t key, const uint8_t *data, uint8_t len)
+{
+    if (!g_kv.ready || key == 0u || key >= KV_KEY_COUNT || len > KV_VALUE_MAX || (len && !data))
+        return 0;
+
+    uint8_t rec[KV_REC_RAW(KV_VALUE_MAX)];
+    rec[0] = key;
+    rec[1] = len;
+    for (uint8_t i = 0; i < len; ++i)
+        rec[KV_REC_HDR + i] = data[i];
+    uint32_t crc = kv_record_crc(rec, len);
+    store_be32(rec + KV_REC_HDR + len, crc);
+
+    if (g_kv.rec_off[key] && g_kv.len[key] == len && g_kv.crc[key] == crc)
+    {
+        g_kv.stats.unchanged++;
+        return 1;
+    }
+
+    if (g_kv.off + KV_REC_SIZE(len) > SPI_FLASH_SECTOR_SIZE)
+    {
+        kv_compact(key, rec, len, crc);
+    }
+    else
+    {
+        kv_program(kv_sector_addr(g_kv.sector) + g_kv.off, rec, KV_REC_RAW(len));
+        g_kv.rec_off[key] = (uint16_t)g_kv.off;
+        g_kv.len[key] = len;
+        g_kv.crc[key] = crc;
+        g_kv.off += KV_REC_SIZE(len);
+    }
+    g_kv.stats.appends++;
+    return 1;
+}
+
+int kv_get(uint8_t key, uint8_t *out, uint8_t cap)
+{
+    if (!g_kv.ready || key == 0u || key >= KV_KEY_COUNT || !g_kv.rec_off[key] || !out)
+        return -1;
+    uint8_t len = g_kv.len[key];
+    if (len > cap)
+        return -1;
+    if (flash_jobs_pending())
+        flash_jobs_flush();
+    spi_flash_read(kv_sector_addr(g_kv.sector) + g_kv.rec_off[key] + KV_REC_HDR, out, len);
+    return len;
+}
+
+void kv_get_stats(kv_stats_t *out)
+{
+    if (!out)
+        return;
+    *out = g_kv.stats;
+    out->generation = g_kv.gen;
+    out->used = (uint16_t)g_kv.off;
+    out->sector = g_kv.sector;
+    out->live = 0;
+    for (uint8_t k = 1; k < KV_KEY_COUNT; ++k)
+    {
+        if (g_kv.rec_off[k])
+            out->live++;
+    }
+}
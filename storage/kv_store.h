@@ -0,0 +1,50 @@
+#ifndef OPEN_FIRMWARE_STORAGE_KV_STORE_H
+#define OPEN_FIRMWARE_STORAGE_KV_STORE_H
+
+#include <stdint.h>
+
+/*
+ * Append-only key/value log over KV_STORAGE_SECTORS flash sectors.
+ *
+ * A put appends one record {key, len, value, crc32} to the active sector, so
+ * a one-byte value costs 8 bytes of programming and no erase. When the
+ * sector fills, the live values are copied to the next sector (round robin,
+ * which spreads erases over the region) and that sector's header is written
+ * last; until then the old sector stays authoritative. Records that fail
+ * their CRC (torn by a reset) are skipped on load.
+ *
+ * Writes are queued on flash_jobs. kv_get() flushes the queue first, so a
+ * value read back right after a put is the one just written.
+ */
+
+#define KV_KEY_CONFIG   0x01u /* config_t blob (CONFIG_BLOB_SIZE) */
+#define KV_KEY_PROFILE  0x02u /* active profile id */
+#define KV_KEY_VGEAR    0x03u /* active virtual gear */
+#define KV_KEY_TRIP     0x04u /* trip_summary_t of the last ride */
+#define KV_KEY_COUNTERS 0x05u /* lifetime ride totals */
+#define KV_KEY_TRIP_QUANT 0x06u /* trip_quantiles_t of the last ride */
+#define KV_KEY_FLASH_WEAR 0x07u /* storage/flash_health.h lifetime totals */
+#define KV_KEY_COUNT    16u   /* valid keys are 1..KV_KEY_COUNT-1 */
+
+#define KV_VALUE_MAX 96u
+
+typedef struct {
+    uint32_t generation; /* bumped by each compaction */
+    uint32_t appends;
+    uint32_t unchanged;  /* puts skipped because the value matched */
+    uint32_t compactions;
+    uint16_t used;       /* bytes used in the active sector */
+    uint16_t torn;       /* bad records skipped at load */
+    uint8_t sector;
+    uint8_t live;        /* keys with a value */
+} kv_stats_t;
+
+/* Finds the newest sector and indexes it; formats an empty region. */
+void kv_init(void);
+/* Returns the value length, or -1 when the key is absent or `cap` is short. */
+int kv_get(uint8_t key, uint8_t *out, uint8_t cap);
+/* Returns 1 once the record is queued (or the value is unchanged). */
+int kv_put(uint8_t key, const uint8_t *data, uint8_t len);
+void kv_get_stats(kv_stats_t *out);
+
+#endif
@@ -39,4 +39,44 @@
 #define AB_SLOT_STRIDE 0x00040000u
 #define AB_SLOT1_BASE (AB_SLOT0_BASE + AB_SLOT_STRIDE)
 
+/* Bus trigger recording: header + records around a trigger (12x 4KB sectors). */
+#define BUS_TRIGGER_STORAGE_BASE (SPI_FLASH_STORAGE_BASE + 0x00094000u)
+#define BUS_TRIGGER_STORAGE_BYTES 0x0000C000u
+
+/* Uploaded bus capture for bench replay (header + records, 16x 4KB sectors). */
+#define BUS_REPLAY_STORAGE_BASE (SPI_FLASH_STORAGE_BASE + 0x000A0000u)
+#define BUS_REPLAY_STORAGE_BYTES 0x00010000u
+
+/* Key/value log for config and persisted state (4x 4KB sectors, round robin). */
+#define KV_STORAGE_BASE (SPI_FLASH_STORAGE_BASE + 0x000B0000u)
+#define KV_STORAGE_SECTORS 4u
+
+/* Ride history (fixed records in a ring of 3x 4KB indexed sectors). */
+#define RIDE_LOG_STORAGE_BASE (SPI_FLASH_STORAGE_BASE + 0x000B4000u)
+#define RIDE_LOG_STORAGE_BYTES 0x00003000u
+
+/* Profile bundle: assist profiles, curves, gears and cadence bias (one 4KB sector). */
+#define PROFILE_BUNDLE_STORAGE_BASE (SPI_FLASH_STORAGE_BASE + 0x000B8000u)
+
+/* Brown-out records: one page each, kept pre-erased (2x 4KB sectors). */
+#define POWER_FAIL_STORAGE_BASE (SPI_FLASH_STORAGE_BASE + 0x000B9000u)
+#define POWER_FAIL_STORAGE_BYTES 0x00002000u
+
+/* Lifetime counters: header + unary tick areas, two 4KB sectors used in turn. */
+#define LIFETIME_STORAGE_BASE (SPI_FLASH_STORAGE_BASE + 0x000BB000u)
+#define LIFETIME_STORAGE_SECTORS 2u
+
+/* Boot splash: header sector, then one RGB565 frame (32x 4KB sectors). */
+#define SPLASH_STORAGE_BASE (SPI_FLASH_STORAGE_BASE + 0x000C0000u)
+#define SPLASH_STORAGE_BYTES 0x00020000u
+
+/* UI asset pack: header sector, then sprite index + data (16x 4KB sectors). */
+#define UI_ASSET_STORAGE_BASE (SPI_FLASH_STORAGE_BASE + 0x000E0000u)
+#define UI_ASSET_STORAGE_BYTES 0x00010000u
+
+/* Recorded bike session for host sim replay (header + records, 10x 4KB sectors;
+ * the OEM config backup sits at 0x3FB000). */
+#define BUS_SESSION_STORAGE_BASE (SPI_FLASH_STORAGE_BASE + 0x000F0000u)
+#define BUS_SESSION_STORAGE_BYTES 0x0000A000u
+
 #endif
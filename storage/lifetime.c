@@ -0,0 +1,200 @@
+#include "storage/lifetime.h"
+
+#include <string.h>
+
+#include "drivers/spi_flash.h"
+#include "storage/flash_jobs.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+#define LIFETIME_CRC_OFFSET (LIFETIME_HDR_SIZE - 4u)
+#define LIFETIME_AREA_BASE  SPI_FLASH_PAGE_SIZE
+#define LIFETIME_REPORT_DIV 1000u /* fine units per reported unit, every counter */
+
+_Static_assert(12u + 4u * LIFETIME_COUNT == LIFETIME_CRC_OFFSET, "lifetime header layout");
+_Static_assert(LIFETIME_AREA_BASE + LIFETIME_COUNT * LIFETIME_AREA_BYTES <= SPI_FLASH_SECTOR_SIZE,
+               "lifetime areas do not fit a sector");
+_Static_assert(LIFETIME_STORAGE_SECTORS == 2u, "lifetime counters alternate two sectors");
+
+/* Fine units per tick. */
+static const uint32_t k_quantum[LIFETIME_COUNT] = {
+    [LIFETIME_DISTANCE] = 100000u, /* 100 m */
+    [LIFETIME_ENERGY]   = 1000u,   /* 1 Wh */
+    [LIFETIME_MOTOR_ON] = 60000u,  /* 1 min */
+    [LIFETIME_ASSIST0]      = 60000u,
+    [LIFETIME_ASSIST0 + 1u] = 60000u,
+    [LIFETIME_ASSIST0 + 2u] = 60000u,
+    [LIFETIME_ASSIST0 + 3u] = 60000u,
+    [LIFETIME_ASSIST0 + 4u] = 60000u,
+};
+_Static_assert(LIFETIME_ASSIST_PROFILES == 5u, "one quantum per assist profile");
+
+static struct {
+    uint32_t base[LIFETIME_COUNT];    /* ticks in the live header */
+    uint16_t used[LIFETIME_COUNT];    /* ticks programmed into its areas */
+    uint32_t pending[LIFETIME_COUNT]; /* whole ticks not programmed yet */
+    uint32_t rem[LIFETIME_COUNT];     /* fine units short of a tick */
+    uint32_t seq;
+    uint8_t sector;
+    uint8_t ready;
+} g_life;
+
+static uint32_t lifetime_sector_addr(uint8_t sector)
+{
+    return LIFETIME_STORAGE_BASE + (uint32_t)sector * SPI_FLASH_SECTOR_SIZE;
+}
+
+static uint32_t lifetime_area_addr(uint8_t counter)
+{
+    return lifetime_sector_addr(g_life.sector) + LIFETIME_AREA_BASE + (uint32_t)counter * LIFETIME_AREA_BYTES;
+}
+
+static uint8_t lifetime_header_ok(const uint8_t *hdr)
+{
+    if (load_be32(&hdr[0]) != LIFETIME_MAGIC || hdr[4] != LIFETIME_VERSION || hdr[5] != LIFETIME_COUNT)
+        return 0;
+    return crc32_compute(hdr, LIFETIME_CRC_OFFSET) == load_be32(&hdr[LIFETIME_CRC_OFFSET]);
+}
+
+/* flash_jobs copies programs up to FLASH_JOBS_INLINE_MAX, so the header
+ * can be built on the stack. */
+static void lifetime_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    while (len)
+    {
+        uint32_t n = len > FLASH_JOBS_INLINE_MAX ? FLASH_JOBS_INLINE_MAX : len;
+        flash_jobs_program(addr, data, n);
+        addr += n;
+        data += n;
+        len -= n;
+    }
+}
+
+/* Starts `sector` with every counter's total as its base. The erase and the
+ * header program are queued in order, ahead of the ticks that follow. */
+static void lifetime_roll_to(uint8_t sector)
+{
+    uint8_t hdr[LIFETIME_HDR_SIZE];
+    g_life.seq++;
+    store_be32(&hdr[0], LIFETIME_MAGIC);
+    hdr[4] = LIFETIME_VERSION;
+    hdr[5] = LIFETIME_COUNT;
+    hdr[6] = 0u;
+    hdr[7] = 0u;
+    store_be32(&hdr[8], g_life.seq);
+    for (uint8_t c = 0; c < LIFETIME_COUNT; ++c)
+    {
+        g_life.base[c] += g_life.used[c];
+        g_life.used[c] = 0u;
+        store_be32(&hdr[12u + 4u * c], g_life.base[c]);
+    }
+    store_be32(&hdr[LIFETIME_CRC_OFFSET], crc32_compute(hdr, LIFETIME_CRC_OFFSET));
+    g_life.sector = sector;
+    flash_jobs_erase(lifetime_sector_addr(sector));
+    lifetime_program(lifetime_sector_addr(sector), hdr, sizeof(hdr));
+}
+
+static uint16_t lifetime_count_ticks(uint32_t addr)
+{
+    uint8_t buf[64];
+    uint16_t ticks = 0u;
+    for (uint32_t off = 0; off < LIFETIME_AREA_BYTES; off += sizeof(buf))
+    {
+        uint32_t n = (LIFETIME_AREA_BYTES - off < sizeof(buf)) ? LIFETIME_AREA_BYTES - off : sizeof(buf);
+        spi_flash_read(addr + off, buf, n);
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            /* Zero bits, so a torn program can only add a tick or two. */
+            for (uint8_t b = (uint8_t)~buf[i]; b; b &= (uint8_t)(b - 1u))
+                ticks++;
+        }
+    }
+    return ticks;
+}
+
+void lifetime_init(uint32_t seed_distance_m, uint32_t seed_energy_wh)
+{
+    memset(&g_life, 0, sizeof(g_life));
+    uint8_t hdr[LIFETIME_HDR_SIZE];
+    int live = -1;
+    for (uint8_t s = 0; s < LIFETIME_STORAGE_SECTORS; ++s)
+    {
+        spi_flash_read(lifetime_sector_addr(s), hdr, sizeof(hdr));
+        if (!lifetime_header_ok(hdr))
+            continue;
+        uint32_t seq = load_be32(&hdr[8]);
+        if (live >= 0 && (int32_t)(seq - g_life.seq) <= 0)
+            continue;
+        live = s;
+        g_life.seq = seq;
+        for (uint8_t c = 0; c < LIFETIME_COUNT; ++c)
+            g_life.base[c] = load_be32(&hdr[12u + 4u * c]);
+    }
+    if (live < 0)
+    {
+        /* Never formatted (or both headers lost): start from the finalized
+         * trips' totals. */
+        g_life.seq = 0u;
+        g_life.base[LIFETIME_DISTANCE] = seed_distance_m / (k_quantum[LIFETIME_DISTANCE] / LIFETIME_REPORT_DIV);
+        g_life.base[LIFETIME_ENERGY] = seed_energy_wh / (k_quantum[LIFETIME_ENERGY] / LIFETIME_REPORT_DIV);
+        lifetime_roll_to(0u);
+    }
+    else
+    {
+        g_life.sector = (uint8_t)live;
+        for (uint8_t c = 0; c < LIFETIME_COUNT; ++c)
+            g_life.used[c] = lifetime_count_ticks(lifetime_area_addr(c));
+    }
+    g_life.ready = 1u;
+}
+
+void lifetime_add(uint8_t counter, uint32_t amount)
+{
+    if (counter >= LIFETIME_COUNT || amount == 0u)
+        return;
+    uint32_t q = k_quantum[counter];
+    uint32_t t = g_life.rem[counter] + amount;
+    if (t < amount)
+        t = 0xFFFFFFFFu;
+    g_life.pending[counter] += t / q;
+    g_life.rem[counter] = t % q;
+}
+
+void lifetime_tick(void)
+{
+    if (!g_life.ready)
+        return;
+    for (uint8_t c = 0; c < LIFETIME_COUNT; ++c)
+    {
+        if (g_life.pending[c] == 0u)
+            continue;
+        if (g_life.used[c] >= LIFETIME_AREA_TICKS)
+            lifetime_roll_to((uint8_t)(g_life.sector ^ 1u));
+        /* The ticks that fit the current byte go out as one program. */
+        uint16_t used = g_life.used[c];
+        uint8_t bit = (uint8_t)(used % 8u);
+        uint32_t n = 8u - bit;
+        if (n > g_life.pending[c])
+            n = g_life.pending[c];
+        uint8_t v = (uint8_t)(0xFFu << (bit + n));
+        flash_jobs_program(lifetime_area_addr(c) + used / 8u, &v, 1u);
+        g_life.used[c] = (uint16_t)(used + n);
+        g_life.pending[c] -= n;
+    }
+}
+
+void lifetime_get(lifetime_info_t *out)
+{
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+    for (uint8_t c = 0; c < LIFETIME_COUNT; ++c)
+    {
+        uint32_t ticks = g_life.base[c] + g_life.used[c] + g_life.pending[c];
+        out->value[c] = ticks * (k_quantum[c] / LIFETIME_REPORT_DIV) + g_life.rem[c] / LIFETIME_REPORT_DIV;
+        if (g_life.used[c] > out->used_max)
+            out->used_max = g_life.used[c];
+    }
+    out->seq = g_life.seq;
+}
@@ -0,0 +1,65 @@
+#ifndef OPEN_FIRMWARE_STORAGE_LIFETIME_H
+#define OPEN_FIRMWARE_STORAGE_LIFETIME_H
+
+#include <stdint.h>
+
+/*
+ * Lifetime counters for maintenance: distance, energy, time with the motor
+ * driving and assisted riding time per assist profile. They never reset.
+ *
+ * A counter advances in ticks of a fixed quantum (100 m, 1 Wh, 1 min), and a
+ * tick is one bit cleared in a pre-erased unary area, so the common update
+ * is a one-byte program with no erase. The region is two 4 KB sectors used
+ * in turn; the live one is the one with the newest valid header.
+ *
+ * Sector (big-endian):
+ *   page 0: [0..3] magic 'LIFE', [4] version, [5] counters, [6..7] reserved,
+ *           [8..11] seq, [12..43] base ticks per counter, [44..47] crc32
+ *           over 0..43
+ *   then LIFETIME_AREA_BYTES per counter: ticks since the header, as
+ *           cleared bits, lowest bit of each byte first
+ * When a counter's area fills, every counter's base plus its ticks is
+ * rolled up into a header for the other sector, which is erased first; the
+ * old sector stays valid until the new header is complete. That costs one
+ * erase per LIFETIME_AREA_TICKS ticks of the busiest counter (~380 km of
+ * riding).
+ *
+ * Amounts below a tick wait in RAM and are lost at power off, at most one
+ * quantum per counter per boot.
+ *
+ * The trip module's totals (trip_totals_t, KV_KEY_COUNTERS) only grow when
+ * a trip is finalized, and a whole KV record is rewritten each time; these
+ * grow while riding, so a trip cut by a power loss still counts. A region
+ * formatted on a unit that already has totals starts from them, so the two
+ * agree up to the trip in progress and rounding.
+ */
+#define LIFETIME_DISTANCE  0u /* fine unit mm, reported in m */
+#define LIFETIME_ENERGY    1u /* mWh, reported in Wh */
+#define LIFETIME_MOTOR_ON  2u /* ms, reported in s */
+#define LIFETIME_ASSIST0   3u /* ms per assist profile, reported in s */
+#define LIFETIME_ASSIST_PROFILES 5u
+#define LIFETIME_COUNT     (LIFETIME_ASSIST0 + LIFETIME_ASSIST_PROFILES)
+
+#define LIFETIME_MAGIC      0x4C494645u /* 'LIFE' */
+#define LIFETIME_VERSION    1u
+#define LIFETIME_HDR_SIZE   48u
+#define LIFETIME_AREA_BYTES 480u
+#define LIFETIME_AREA_TICKS (LIFETIME_AREA_BYTES * 8u)
+
+typedef struct {
+    uint32_t value[LIFETIME_COUNT]; /* in the reported units */
+    uint32_t seq;                   /* roll-ups since the region was formatted */
+    uint16_t used_max;              /* fullest area, ticks */
+} lifetime_info_t;
+
+/* Boot, after the trip totals are loaded: finds the live sector and counts
+ * its ticks, formatting the region when neither sector holds a valid header.
+ * The seeds (m, Wh) are the distance and energy base of a new region. */
+void lifetime_init(uint32_t seed_distance_m, uint32_t seed_energy_wh);
+/* Adds an amount in the counter's fine unit; whole ticks are queued. */
+void lifetime_add(uint8_t counter, uint32_t amount);
+/* Main loop: programs queued ticks, rolling up first when an area is full. */
+void lifetime_tick(void);
+void lifetime_get(lifetime_info_t *out);
+
+#endif
@@ -5,8 +5,9 @@
 #include "app_data.h"
 #include "control/control.h"
 #include "drivers/spi_flash.h"
+#include "platform/ram.h"
 #include "platform/time.h"
-#include "storage/flash_util.h"
+#include "storage/flash_jobs.h"
 #include "storage/layout.h"
 #include "util/byteorder.h"
 #include "util/crc32.h"
@@ -66,17 +67,6 @@ static uint16_t record_crc16_be(const uint8_t *buf, size_t size)
     return (uint16_t)(crc32_compute(buf, size - 2u) & 0xFFFFu);
 }
 
-static uint8_t event_record_valid_be(const uint8_t *buf)
-{
-    if (!buf)
-        return 0;
-    if (is_all_ff(buf, EVENT_LOG_RECORD_SIZE))
-        return 0;
-    uint16_t crc_expected = load_be16(&buf[EVENT_LOG_RECORD_SIZE - 2u]);
-    uint16_t crc_actual = record_crc16_be(buf, EVENT_LOG_RECORD_SIZE);
-    return crc_expected == crc_actual;
-}
-
 static void event_record_store(uint8_t *dst, const event_record_t *r)
 {
     if (!dst || !r)
@@ -93,23 +83,73 @@ static void event_record_store(uint8_t *dst, const event_record_t *r)
     store_be16(&dst[18], r->crc16);
 }
 
-void event_log_reset(void)
+/*
+ * Event log v2: each 4 KB sector starts with a header
+ *   [0..3] magic, [4..7] seq of its first record, [8..11] ms of its first
+ *   record, [12..13] crc16 over 0..11, [14..15] record count
+ * followed by EVENT_LOG_SECTOR_RECORDS fixed records. The count is left
+ * erased while the sector is being filled and programmed when the log moves
+ * on, so load only reads headers plus a binary search for the head of the
+ * newest sector. Sectors are used as a ring: a full log erases its oldest
+ * sector instead of the whole region.
+ *
+ * Appends are staged in RAM and programmed as one run when the run reaches
+ * the end of the flash page it started in, when the sector fills, after
+ * EVENT_STAGE_FLUSH_MS, before any read, and from the brown-out interrupt.
+ * A record's seq is its position (sector seq + slot), and runs land in
+ * order with no gaps, so a reset loses at most the staged tail and never
+ * repeats a record.
+ */
+#define EVENT_SECTOR_MAGIC   0x45565348u /* 'EVSH' */
+#define EVENT_SECTOR_HDR     16u
+#define EVENT_SECTOR_COUNT   (EVENT_LOG_STORAGE_BYTES / SPI_FLASH_SECTOR_SIZE)
+#define EVENT_COUNT_OPEN     0xFFFFu
+#define EVENT_STAGE_RECORDS  13u /* a run from anywhere in a page to past its end */
+
+_Static_assert(EVENT_SECTOR_COUNT * EVENT_LOG_SECTOR_RECORDS == EVENT_LOG_CAPACITY,
+               "event log capacity does not match its sectors");
+_Static_assert(EVENT_SECTOR_HDR + EVENT_LOG_SECTOR_RECORDS * EVENT_LOG_RECORD_SIZE <= SPI_FLASH_SECTOR_SIZE,
+               "event log sector overflow");
+_Static_assert((SPI_FLASH_PAGE_SIZE + EVENT_LOG_RECORD_SIZE - 1u) / EVENT_LOG_RECORD_SIZE <= EVENT_STAGE_RECORDS,
+               "event stage shorter than a page of records");
+
+typedef struct {
+    uint32_t seq;
+    uint32_t first_ms;
+    uint16_t count;
+    uint8_t valid;
+} event_sector_t;
+
+static struct {
+    event_sector_t sec[EVENT_SECTOR_COUNT];
+    uint8_t cur; /* sector receiving appends */
+    uint8_t stage[2][EVENT_STAGE_RECORDS * EVENT_LOG_RECORD_SIZE];
+    volatile uint8_t busy[2]; /* stage handed to flash_jobs, not yet written */
+    volatile uint8_t opening; /* cur's header (and the erase before it) still queued */
+    uint8_t fill;             /* stage being filled */
+    uint8_t staged;           /* records in it */
+    uint16_t stage_slot;      /* slot of its first record in cur */
+    uint32_t stage_ms;        /* when its first record came in */
+} g_event_log;
+
+static uint32_t event_sector_addr(uint8_t s)
 {
-    spi_flash_erase_region(EVENT_LOG_STORAGE_BASE, EVENT_LOG_STORAGE_BYTES);
-    g_event_meta.magic = EVENT_LOG_MAGIC;
-    g_event_meta.version = EVENT_LOG_VERSION;
-    g_event_meta.record_size = EVENT_LOG_RECORD_SIZE;
-    g_event_meta.capacity = EVENT_LOG_CAPACITY;
-    g_event_meta.reserved = 0;
-    g_event_meta.head = 0;
-    g_event_meta.count = 0;
-    g_event_meta.seq = 1;
-    g_event_meta.crc32 = 0;
+    return EVENT_LOG_STORAGE_BASE + (uint32_t)s * SPI_FLASH_SECTOR_SIZE;
 }
 
-void event_log_load(void)
+static uint32_t event_record_addr(uint8_t s, uint16_t i)
+{
+    return event_sector_addr(s) + EVENT_SECTOR_HDR + (uint32_t)i * EVENT_LOG_RECORD_SIZE;
+}
+
+/* Sector holding older records, if any (the ring has two entries). */
+static uint8_t event_sector_prev(uint8_t s)
+{
+    return (uint8_t)((s + EVENT_SECTOR_COUNT - 1u) % EVENT_SECTOR_COUNT);
+}
+
+static void event_meta_init(void)
 {
-    /* Reset RAM state first. We will only keep flash content if it scans cleanly. */
     g_event_meta.magic = EVENT_LOG_MAGIC;
     g_event_meta.version = EVENT_LOG_VERSION;
     g_event_meta.record_size = EVENT_LOG_RECORD_SIZE;
@@ -119,29 +159,198 @@ void event_log_load(void)
     g_event_meta.count = 0;
     g_event_meta.seq = 1;
     g_event_meta.crc32 = 0;
+    for (uint8_t s = 0; s < EVENT_SECTOR_COUNT; ++s)
+    {
+        g_event_log.sec[s].valid = 0;
+        g_event_log.sec[s].count = 0;
+    }
+    g_event_log.cur = 0;
+    g_event_log.staged = 0;
+}
+
+static void event_meta_refresh(void)
+{
+    uint8_t cur = g_event_log.cur;
+    uint8_t prev = event_sector_prev(cur);
+    uint32_t count = g_event_log.sec[cur].count;
+    if (prev != cur && g_event_log.sec[prev].valid)
+        count += g_event_log.sec[prev].count;
+    g_event_meta.count = count;
+    g_event_meta.head = (uint32_t)cur * EVENT_LOG_SECTOR_RECORDS + g_event_log.sec[cur].count;
+}
 
+static void event_job_done(void *ctx, uint8_t ok)
+{
+    (void)ok;
+    *(volatile uint8_t *)ctx = 0;
+}
+
+/* Programs the staged run, if any, and starts filling the other stage. */
+static void event_stage_commit(void)
+{
+    uint8_t n = g_event_log.staged;
+    if (n == 0u)
+        return;
+    uint8_t f = g_event_log.fill;
+    uint32_t addr = event_record_addr(g_event_log.cur, g_event_log.stage_slot);
+    uint32_t len = (uint32_t)n * EVENT_LOG_RECORD_SIZE;
+    g_event_log.busy[f] = 1;
+    if (!flash_jobs_submit_program(addr, g_event_log.stage[f], len, event_job_done,
+                                   (void *)&g_event_log.busy[f]))
+    {
+        g_event_log.busy[f] = 0;
+        flash_jobs_program(addr, g_event_log.stage[f], len);
+    }
+    g_event_log.staged = 0;
+    g_event_log.fill ^= 1u;
+    if (g_event_log.busy[g_event_log.fill])
+        flash_jobs_flush();
+}
+
+void event_log_flush(void)
+{
+    event_stage_commit();
+}
+
+void event_log_tick(uint32_t now_ms)
+{
+    if (g_event_log.staged && (uint32_t)(now_ms - g_event_log.stage_ms) >= EVENT_STAGE_FLUSH_MS)
+        event_stage_commit();
+}
+
+void event_log_flush_urgent(void (*program)(uint32_t addr, const uint8_t *data, uint32_t len))
+{
+    /* Only behind the queue: a queued erase could be under the run, and a
+     * queued run before it would leave a gap. */
+    if (!program || !g_event_log.staged || g_event_log.opening || g_event_log.busy[g_event_log.fill ^ 1u])
+        return;
+    program(event_record_addr(g_event_log.cur, g_event_log.stage_slot), g_event_log.stage[g_event_log.fill],
+            (uint32_t)g_event_log.staged * EVENT_LOG_RECORD_SIZE);
+    g_event_log.staged = 0;
+}
+
+void event_log_reset(void)
+{
+    flash_jobs_erase_region(EVENT_LOG_STORAGE_BASE, EVENT_LOG_STORAGE_BYTES);
+    event_meta_init();
+}
+
+static uint8_t event_sector_read(uint8_t s, event_sector_t *out)
+{
+    uint8_t h[EVENT_SECTOR_HDR];
+    spi_flash_read(event_sector_addr(s), h, sizeof(h));
+    out->valid = 0;
+    if (is_all_ff(h, sizeof(h)))
+        return 1;
+    if (load_be32(&h[0]) != EVENT_SECTOR_MAGIC ||
+        load_be16(&h[12]) != (uint16_t)(crc32_compute(h, 12u) & 0xFFFFu))
+        return 0;
+    uint16_t count = load_be16(&h[14]);
+    if (count != EVENT_COUNT_OPEN && count > EVENT_LOG_SECTOR_RECORDS)
+        return 0;
+    out->seq = load_be32(&h[4]);
+    out->first_ms = load_be32(&h[8]);
+    out->count = count;
+    out->valid = 1;
+    return 1;
+}
+
+/* Records are appended contiguously, so the first blank slot is the head. */
+static uint16_t event_sector_find_head(uint8_t s)
+{
     uint8_t buf[EVENT_LOG_RECORD_SIZE];
-    for (uint32_t i = 0; i < EVENT_LOG_CAPACITY; ++i)
+    uint16_t lo = 0;
+    uint16_t hi = EVENT_LOG_SECTOR_RECORDS;
+    while (lo < hi)
     {
-        spi_flash_read(EVENT_LOG_STORAGE_BASE + i * EVENT_LOG_RECORD_SIZE, buf, EVENT_LOG_RECORD_SIZE);
-        if (is_all_ff(buf, EVENT_LOG_RECORD_SIZE))
-            return;
-        if (!event_record_valid_be(buf))
+        uint16_t mid = (uint16_t)((lo + hi) / 2u);
+        spi_flash_read(event_record_addr(s, mid), buf, sizeof(buf));
+        if (is_all_ff(buf, sizeof(buf)))
+            hi = mid;
+        else
+            lo = (uint16_t)(mid + 1u);
+    }
+    return lo;
+}
+
+void event_log_load(void)
+{
+    /* Reset RAM state first. We will only keep flash content if the headers check out. */
+    event_meta_init();
+
+    uint8_t newest = 0xFFu;
+    for (uint8_t s = 0; s < EVENT_SECTOR_COUNT; ++s)
+    {
+        if (!event_sector_read(s, &g_event_log.sec[s]))
         {
-            /* Corrupt/partial write: discard and start fresh so future writes succeed. */
+            /* Corrupt header or a v1 log: discard and start fresh so future writes succeed. */
             event_log_reset();
             return;
         }
-        g_event_meta.head = i + 1u;
-        g_event_meta.count = i + 1u;
-        g_event_meta.seq += 1u;
+        if (g_event_log.sec[s].valid &&
+            (newest == 0xFFu || (int32_t)(g_event_log.sec[s].seq - g_event_log.sec[newest].seq) > 0))
+            newest = s;
     }
+    if (newest == 0xFFu)
+        return;
+
+    event_sector_t *cur = &g_event_log.sec[newest];
+    if (cur->count == EVENT_COUNT_OPEN)
+        cur->count = event_sector_find_head(newest);
+    g_event_log.cur = newest;
+
+    /* Only the sector just before the newest one holds live history. */
+    for (uint8_t s = 0; s < EVENT_SECTOR_COUNT; ++s)
+    {
+        event_sector_t *sec = &g_event_log.sec[s];
+        if (s == newest || !sec->valid)
+            continue;
+        if (s != event_sector_prev(newest) || sec->seq + EVENT_LOG_SECTOR_RECORDS != cur->seq)
+            sec->valid = 0;
+        else
+            sec->count = EVENT_LOG_SECTOR_RECORDS;
+    }
+    g_event_meta.seq = cur->seq + cur->count;
+    event_meta_refresh();
+}
+
+static void event_sector_open(uint8_t s, uint32_t first_ms)
+{
+    uint8_t h[EVENT_SECTOR_HDR - 2u];
+    store_be32(&h[0], EVENT_SECTOR_MAGIC);
+    store_be32(&h[4], g_event_meta.seq);
+    store_be32(&h[8], first_ms);
+    store_be16(&h[12], (uint16_t)(crc32_compute(h, 12u) & 0xFFFFu));
+    g_event_log.opening = 1;
+    if (!flash_jobs_submit_program(event_sector_addr(s), h, sizeof(h), event_job_done,
+                                   (void *)&g_event_log.opening))
+    {
+        g_event_log.opening = 0;
+        flash_jobs_program(event_sector_addr(s), h, sizeof(h));
+    }
+    g_event_log.sec[s].seq = g_event_meta.seq;
+    g_event_log.sec[s].first_ms = first_ms;
+    g_event_log.sec[s].count = 0;
+    g_event_log.sec[s].valid = 1;
 }
 
 void event_log_append(uint8_t type, uint8_t flags)
 {
-    if (g_event_meta.head >= EVENT_LOG_CAPACITY)
-        event_log_reset();
+    uint8_t cur = g_event_log.cur;
+    if (g_event_log.sec[cur].valid && g_event_log.sec[cur].count >= EVENT_LOG_SECTOR_RECORDS)
+    {
+        /* Seal the full sector and recycle the oldest one. */
+        event_stage_commit();
+        uint8_t cnt[2];
+        store_be16(cnt, EVENT_LOG_SECTOR_RECORDS);
+        flash_jobs_program(event_sector_addr(cur) + 14u, cnt, sizeof(cnt));
+        cur = (uint8_t)((cur + 1u) % EVENT_SECTOR_COUNT);
+        flash_jobs_erase(event_sector_addr(cur));
+        g_event_log.sec[cur].valid = 0;
+        g_event_log.cur = cur;
+    }
+    if (!g_event_log.sec[cur].valid)
+        event_sector_open(cur, g_ms);
 
     event_record_t r;
     r.ms = g_ms;
@@ -155,45 +364,113 @@ void event_log_append(uint8_t type, uint8_t flags)
     r.cmd_current_dA = g_outputs.cmd_current_dA;
     r.crc16 = 0;
 
-    uint8_t buf[EVENT_LOG_RECORD_SIZE];
+    if (g_event_log.staged == 0u)
+    {
+        g_event_log.stage_slot = g_event_log.sec[cur].count;
+        g_event_log.stage_ms = g_ms;
+    }
+    uint8_t *buf = &g_event_log.stage[g_event_log.fill][(size_t)g_event_log.staged * EVENT_LOG_RECORD_SIZE];
     event_record_store(buf, &r);
     store_be16(&buf[EVENT_LOG_RECORD_SIZE - 2u], record_crc16_be(buf, EVENT_LOG_RECORD_SIZE));
+    g_event_log.staged++;
+    g_event_log.sec[cur].count++;
 
-    uint32_t idx = g_event_meta.head;
-    spi_flash_write(EVENT_LOG_STORAGE_BASE + idx * EVENT_LOG_RECORD_SIZE, buf, EVENT_LOG_RECORD_SIZE);
+    uint32_t start = event_record_addr(cur, g_event_log.stage_slot);
+    uint32_t end = event_record_addr(cur, g_event_log.sec[cur].count);
+    if (end >= (start & ~(SPI_FLASH_PAGE_SIZE - 1u)) + SPI_FLASH_PAGE_SIZE ||
+        g_event_log.staged >= EVENT_STAGE_RECORDS || g_event_log.sec[cur].count >= EVENT_LOG_SECTOR_RECORDS)
+        event_stage_commit();
 
-    g_event_meta.head = g_event_meta.head + 1u;
-    if (g_event_meta.count < EVENT_LOG_CAPACITY)
-        g_event_meta.count++;
     g_event_meta.seq++;
     g_event_meta.crc32 = 0;
+    event_meta_refresh();
 }
 
-static uint8_t log_copy_records(uint32_t base, uint16_t record_size, uint32_t count,
-                                uint16_t offset, uint8_t max_records, uint8_t *out)
+/* Maps a logical index (0 = oldest) to its sector and slot. */
+static uint8_t event_locate(uint32_t idx, uint8_t *sector, uint16_t *slot)
 {
-    if (!out || max_records == 0)
+    uint8_t cur = g_event_log.cur;
+    uint8_t prev = event_sector_prev(cur);
+    uint32_t older = (prev != cur && g_event_log.sec[prev].valid) ? g_event_log.sec[prev].count : 0u;
+    if (idx < older)
+    {
+        *sector = prev;
+        *slot = (uint16_t)idx;
+        return 1;
+    }
+    idx -= older;
+    if (!g_event_log.sec[cur].valid || idx >= g_event_log.sec[cur].count)
         return 0;
-    if (offset >= count)
+    *sector = cur;
+    *slot = (uint16_t)idx;
+    return 1;
+}
+
+uint8_t event_log_copy(uint16_t offset, uint8_t max_records, uint8_t *out)
+{
+    if (!out || max_records == 0 || offset >= g_event_meta.count)
         return 0;
 
-    uint16_t available = (uint16_t)(count - offset);
-    uint8_t n = (available < max_records) ? (uint8_t)available : max_records;
+    /* Appended records may still be staged or queued. */
+    event_stage_commit();
+    flash_jobs_flush();
 
-    for (uint8_t i = 0; i < n; ++i)
+    uint8_t n = 0;
+    uint8_t sector;
+    uint16_t slot;
+    while (n < max_records && event_locate((uint32_t)offset + n, &sector, &slot))
     {
-        uint32_t idx = (uint32_t)offset + (uint32_t)i;
-        spi_flash_read(base + idx * (uint32_t)record_size,
-                       &out[(size_t)i * record_size],
-                       record_size);
+        spi_flash_read(event_record_addr(sector, slot), &out[(size_t)n * EVENT_LOG_RECORD_SIZE],
+                       EVENT_LOG_RECORD_SIZE);
+        n++;
     }
     return n;
 }
 
-uint8_t event_log_copy(uint16_t offset, uint8_t max_records, uint8_t *out)
+uint16_t event_log_seek(uint8_t mode, uint32_t key)
 {
-    return log_copy_records(EVENT_LOG_STORAGE_BASE, EVENT_LOG_RECORD_SIZE,
-                            g_event_meta.count, offset, max_records, out);
+    uint8_t cur = g_event_log.cur;
+    uint8_t prev = event_sector_prev(cur);
+    uint8_t has_prev = (prev != cur && g_event_log.sec[prev].valid);
+    uint32_t older = has_prev ? g_event_log.sec[prev].count : 0u;
+    if (!g_event_meta.count)
+        return 0;
+
+    if (mode == EVENT_LOG_SEEK_SEQ)
+    {
+        uint32_t first = has_prev ? g_event_log.sec[prev].seq : g_event_log.sec[cur].seq;
+        if ((int32_t)(key - first) <= 0)
+            return 0;
+        uint32_t idx = key - first;
+        return (uint16_t)(idx > g_event_meta.count ? g_event_meta.count : idx);
+    }
+
+    /* Timestamps restart at each boot, so start from the newest sector that
+     * begins at or before `key` and scan its records. */
+    event_stage_commit();
+    flash_jobs_flush();
+    uint8_t s = cur;
+    uint32_t base = older;
+    if (has_prev && g_event_log.sec[cur].first_ms > key)
+    {
+        s = prev;
+        base = 0;
+    }
+    for (;;)
+    {
+        uint16_t count = g_event_log.sec[s].count;
+        for (uint16_t i = 0; i < count; ++i)
+        {
+            uint8_t ms[4];
+            spi_flash_read(event_record_addr(s, i), ms, sizeof(ms));
+            if (load_be32(ms) >= key)
+                return (uint16_t)(base + i);
+        }
+        if (s == cur)
+            return (uint16_t)g_event_meta.count;
+        s = cur;
+        base = older;
+    }
 }
 
 uint16_t stream_log_period_sanitize(uint16_t period)
@@ -205,13 +482,129 @@ uint16_t stream_log_period_sanitize(uint16_t period)
     return period;
 }
 
-void stream_log_reset(void)
+/*
+ * Stream log v2: samples are packed into 256-byte pages buffered in RAM and
+ * programmed whole. Page layout:
+ *   [0] tag, [1] samples, [2..3] payload bytes, [4..7] seq of first sample,
+ *   [8..9] crc16 over bytes 0..7 and the payload, [10..] payload.
+ * Each sample is {hdr, mask, [dt varint], [assist, profile], field deltas},
+ * where hdr bits 0-1 carry the brake/walk flags, bit 2 marks the mode bytes,
+ * bit 3 marks dt (omitted when equal to the previous dt), and mask bit i
+ * marks a zigzag varint delta for field i (speed, cadence, power, batt_dV,
+ * batt_dA, temp_dC). Unchanged fields cost nothing. The first sample of a
+ * page is coded against zeros, so pages decode independently.
+ */
+#define STREAM_PAGE_TAG        0xB2u
+#define STREAM_PAGE_HDR        10u
+#define STREAM_PAGE_PAYLOAD    (SPI_FLASH_PAGE_SIZE - STREAM_PAGE_HDR)
+#define STREAM_FIELD_COUNT     6u
+#define STREAM_SAMPLE_MAX      (2u + 3u + 2u + STREAM_FIELD_COUNT * 3u)
+#define STREAM_HDR_MODE        0x04u
+#define STREAM_HDR_DT          0x08u
+
+_Static_assert(STREAM_LOG_PAGES * SPI_FLASH_PAGE_SIZE == STREAM_LOG_STORAGE_BYTES,
+               "stream log page count does not match its region");
+
+typedef struct {
+    uint16_t field[STREAM_FIELD_COUNT];
+    uint16_t dt_ms;
+    uint8_t assist_mode;
+    uint8_t profile_id;
+} stream_sample_t;
+
+static struct {
+    volatile uint8_t busy[2]; /* page handed to flash_jobs, not yet written */
+    uint8_t fill;             /* page being filled */
+    uint16_t used;            /* payload bytes in the fill page */
+    uint8_t samples;          /* samples in the fill page */
+    stream_sample_t prev;
+    uint16_t page_first[STREAM_LOG_PAGES]; /* sample index of each page's first sample */
+} g_stream;
+
+/* Fill pages (read only up to `used`, begun before the first sample) and the
+ * read-back buffer (read only after a flash read fills it). */
+static uint8_t g_stream_page[2][SPI_FLASH_PAGE_SIZE] RAM_NOZERO;
+static uint8_t g_stream_decode[SPI_FLASH_PAGE_SIZE] RAM_NOZERO;
+
+static uint16_t stream_page_crc(const uint8_t *page, uint16_t used)
+{
+    uint32_t crc = crc32_update(0xFFFFFFFFu, page, 8u);
+    crc = crc32_update(crc, &page[STREAM_PAGE_HDR], used);
+    return (uint16_t)(~crc & 0xFFFFu);
+}
+
+static uint8_t stream_page_valid(const uint8_t *page)
+{
+    uint16_t used = load_be16(&page[2]);
+    if (page[0] != STREAM_PAGE_TAG || page[1] == 0u || used > STREAM_PAGE_PAYLOAD)
+        return 0;
+    return load_be16(&page[8]) == stream_page_crc(page, used);
+}
+
+static uint8_t *put_varint(uint8_t *p, uint32_t v)
+{
+    while (v >= 0x80u)
+    {
+        *p++ = (uint8_t)(v | 0x80u);
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static const uint8_t *get_varint(const uint8_t *p, const uint8_t *end, uint32_t *out)
+{
+    uint32_t v = 0;
+    for (uint8_t shift = 0; p < end && shift < 32u; shift = (uint8_t)(shift + 7u))
+    {
+        uint8_t b = *p++;
+        v |= (uint32_t)(b & 0x7Fu) << shift;
+        if (!(b & 0x80u))
+        {
+            *out = v;
+            return p;
+        }
+    }
+    return NULL;
+}
+
+static uint32_t zigzag(int32_t v)
 {
-    spi_flash_erase_region(STREAM_LOG_STORAGE_BASE, STREAM_LOG_STORAGE_BYTES);
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v)
+{
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1u);
+}
+
+static void stream_page_begin(void)
+{
+    g_stream.used = 0;
+    g_stream.samples = 0;
+    for (uint8_t i = 0; i < STREAM_FIELD_COUNT; ++i)
+        g_stream.prev.field[i] = 0;
+    g_stream.prev.dt_ms = 0;
+    g_stream.prev.assist_mode = 0;
+    g_stream.prev.profile_id = 0;
+    uint8_t *page = g_stream_page[g_stream.fill];
+    for (uint32_t i = 0; i < SPI_FLASH_PAGE_SIZE; ++i)
+        page[i] = 0xFFu;
+}
+
+static void stream_page_written(void *ctx, uint8_t ok)
+{
+    (void)ok;
+    *(volatile uint8_t *)ctx = 0;
+}
+
+static void stream_log_erase(void)
+{
+    flash_jobs_erase_region(STREAM_LOG_STORAGE_BASE, STREAM_LOG_STORAGE_BYTES);
     g_stream_meta.magic = STREAM_LOG_MAGIC;
     g_stream_meta.version = STREAM_LOG_VERSION;
     g_stream_meta.record_size = STREAM_LOG_RECORD_SIZE;
-    g_stream_meta.capacity = STREAM_LOG_CAPACITY;
+    g_stream_meta.capacity = STREAM_LOG_PAGES;
     g_stream_meta.reserved = 0;
     g_stream_meta.head = 0;
     g_stream_meta.count = 0;
@@ -219,35 +612,87 @@ void stream_log_reset(void)
     g_stream_meta.crc32 = 0;
 }
 
+/* Programs the fill page (if it holds samples) and starts the other one. */
+static void stream_page_commit(void)
+{
+    if (g_stream.samples == 0u)
+        return;
+    uint8_t *page = g_stream_page[g_stream.fill];
+    if (g_stream_meta.head >= STREAM_LOG_PAGES)
+    {
+        /* Erase-on-wrap; the samples buffered here move to page 0. */
+        uint32_t seq = g_stream_meta.seq;
+        stream_log_erase();
+        g_stream_meta.seq = seq;
+        g_stream_meta.count = g_stream.samples;
+    }
+    g_stream.page_first[g_stream_meta.head] = (uint16_t)(g_stream_meta.count - g_stream.samples);
+    page[0] = STREAM_PAGE_TAG;
+    page[1] = g_stream.samples;
+    store_be16(&page[2], g_stream.used);
+    store_be32(&page[4], g_stream_meta.seq - g_stream.samples);
+    store_be16(&page[8], stream_page_crc(page, g_stream.used));
+
+    uint32_t addr = STREAM_LOG_STORAGE_BASE + g_stream_meta.head * SPI_FLASH_PAGE_SIZE;
+    g_stream.busy[g_stream.fill] = 1;
+    if (!flash_jobs_submit_program(addr, page, SPI_FLASH_PAGE_SIZE,
+                                   stream_page_written, (void *)&g_stream.busy[g_stream.fill]))
+    {
+        g_stream.busy[g_stream.fill] = 0;
+        flash_jobs_program(addr, page, SPI_FLASH_PAGE_SIZE);
+    }
+    g_stream_meta.head++;
+
+    g_stream.fill ^= 1u;
+    if (g_stream.busy[g_stream.fill])
+        flash_jobs_flush();
+    stream_page_begin();
+}
+
+void stream_log_flush(void)
+{
+    stream_page_commit();
+}
+
+void stream_log_reset(void)
+{
+    stream_log_erase();
+    stream_page_begin();
+}
+
 void stream_log_load(void)
 {
     /* Reset RAM state first. We will only keep flash content if it scans cleanly. */
     g_stream_meta.magic = STREAM_LOG_MAGIC;
     g_stream_meta.version = STREAM_LOG_VERSION;
     g_stream_meta.record_size = STREAM_LOG_RECORD_SIZE;
-    g_stream_meta.capacity = STREAM_LOG_CAPACITY;
+    g_stream_meta.capacity = STREAM_LOG_PAGES;
     g_stream_meta.reserved = 0;
     g_stream_meta.head = 0;
     g_stream_meta.count = 0;
     g_stream_meta.seq = 1;
     g_stream_meta.crc32 = 0;
+    g_stream.fill = 0;
+    g_stream.busy[0] = 0;
+    g_stream.busy[1] = 0;
+    stream_page_begin();
 
-    uint8_t buf[STREAM_LOG_RECORD_SIZE];
-    for (uint32_t i = 0; i < STREAM_LOG_CAPACITY; ++i)
+    uint8_t *buf = g_stream_decode;
+    for (uint32_t i = 0; i < STREAM_LOG_PAGES; ++i)
     {
-        spi_flash_read(STREAM_LOG_STORAGE_BASE + i * STREAM_LOG_RECORD_SIZE, buf, STREAM_LOG_RECORD_SIZE);
-        if (is_all_ff(buf, STREAM_LOG_RECORD_SIZE))
+        spi_flash_read(STREAM_LOG_STORAGE_BASE + i * SPI_FLASH_PAGE_SIZE, buf, SPI_FLASH_PAGE_SIZE);
+        if (is_all_ff(buf, STREAM_PAGE_HDR))
             return;
-        uint16_t crc_expected = load_be16(&buf[STREAM_LOG_RECORD_SIZE - 2u]);
-        uint16_t crc_actual = record_crc16_be(buf, STREAM_LOG_RECORD_SIZE);
-        if (crc_expected != crc_actual)
+        if (!stream_page_valid(buf))
         {
+            /* Corrupt page or a v1 log: start fresh so future writes succeed. */
             stream_log_reset();
             return;
         }
+        g_stream.page_first[i] = (uint16_t)g_stream_meta.count;
         g_stream_meta.head = i + 1u;
-        g_stream_meta.count = i + 1u;
-        g_stream_meta.seq += 1u;
+        g_stream_meta.count += buf[1];
+        g_stream_meta.seq = load_be32(&buf[4]) + buf[1];
     }
 }
 
@@ -269,66 +714,429 @@ static void stream_record_store(uint8_t *dst, const stream_record_t *r)
     store_be16(&dst[18], r->crc16);
 }
 
-void stream_log_append(uint8_t flags)
+void stream_log_append_sample(const tlm_tick_t *ts)
 {
-    if (g_stream_meta.head >= STREAM_LOG_CAPACITY)
-        stream_log_reset();
-
-    stream_record_t r;
-    uint32_t now = g_ms;
+    if (!ts)
+        return;
+    uint32_t now = ts->ms;
     uint32_t dt = (g_stream_log_last_sample_ms == 0) ? 0u : (now - g_stream_log_last_sample_ms);
     if (dt > 0xFFFFu)
         dt = 0xFFFFu;
-    r.version = STREAM_LOG_VERSION;
-    r.flags = flags;
-    r.dt_ms = (uint16_t)dt;
-    r.speed_dmph = g_inputs.speed_dmph;
-    r.cadence_rpm = g_inputs.cadence_rpm;
-    r.power_w = g_inputs.power_w;
-    r.batt_dV = g_inputs.battery_dV;
-    r.batt_dA = g_inputs.battery_dA;
-    r.temp_dC = g_inputs.ctrl_temp_dC;
-    r.assist_mode = g_outputs.assist_mode;
-    r.profile_id = g_outputs.profile_id;
-    r.crc16 = 0;
+    uint8_t flags = ts->flags;
 
-    uint8_t buf[STREAM_LOG_RECORD_SIZE];
-    stream_record_store(buf, &r);
-    store_be16(&buf[STREAM_LOG_RECORD_SIZE - 2u], record_crc16_be(buf, STREAM_LOG_RECORD_SIZE));
+    stream_sample_t s;
+    s.field[0] = ts->speed_dmph;
+    s.field[1] = ts->cadence_rpm;
+    s.field[2] = ts->power_w;
+    s.field[3] = (uint16_t)ts->battery_dV;
+    s.field[4] = (uint16_t)ts->battery_dA;
+    s.field[5] = (uint16_t)ts->ctrl_temp_dC;
+    s.dt_ms = (uint16_t)dt;
+    s.assist_mode = ts->assist_mode;
+    s.profile_id = ts->profile_id;
 
-    uint32_t idx = g_stream_meta.head;
-    spi_flash_write(STREAM_LOG_STORAGE_BASE + idx * STREAM_LOG_RECORD_SIZE, buf, STREAM_LOG_RECORD_SIZE);
+    if (g_stream.used + STREAM_SAMPLE_MAX > STREAM_PAGE_PAYLOAD)
+        stream_page_commit();
 
-    g_stream_meta.head = g_stream_meta.head + 1u;
-    if (g_stream_meta.count < STREAM_LOG_CAPACITY)
-        g_stream_meta.count++;
+    uint8_t *start = &g_stream_page[g_stream.fill][STREAM_PAGE_HDR + g_stream.used];
+    uint8_t *p = start + 2;
+    uint8_t hdr = (uint8_t)(flags & 0x03u);
+    uint8_t mask = 0;
+    if (g_stream.samples == 0u || s.dt_ms != g_stream.prev.dt_ms)
+    {
+        hdr |= STREAM_HDR_DT;
+        p = put_varint(p, s.dt_ms);
+    }
+    if (g_stream.samples == 0u || s.assist_mode != g_stream.prev.assist_mode ||
+        s.profile_id != g_stream.prev.profile_id)
+    {
+        hdr |= STREAM_HDR_MODE;
+        *p++ = s.assist_mode;
+        *p++ = s.profile_id;
+    }
+    for (uint8_t i = 0; i < STREAM_FIELD_COUNT; ++i)
+    {
+        int32_t d = (int32_t)(int16_t)(uint16_t)(s.field[i] - g_stream.prev.field[i]);
+        if (d == 0)
+            continue;
+        mask |= (uint8_t)(1u << i);
+        p = put_varint(p, zigzag(d));
+    }
+    start[0] = hdr;
+    start[1] = mask;
+
+    g_stream.used = (uint16_t)(g_stream.used + (uint16_t)(p - start));
+    g_stream.samples++;
+    g_stream.prev = s;
+
+    g_stream_meta.count++;
     g_stream_meta.seq++;
     g_stream_meta.crc32 = 0;
 
     g_stream_log_last_sample_ms = now;
 }
 
+void stream_log_append(uint8_t flags)
+{
+    tlm_tick_t s = {0};
+    s.ms = g_ms;
+    s.speed_dmph = g_inputs.speed_dmph;
+    s.cadence_rpm = g_inputs.cadence_rpm;
+    s.power_w = g_inputs.power_w;
+    s.battery_dV = g_inputs.battery_dV;
+    s.battery_dA = g_inputs.battery_dA;
+    s.ctrl_temp_dC = g_inputs.ctrl_temp_dC;
+    s.assist_mode = g_outputs.assist_mode;
+    s.profile_id = g_outputs.profile_id;
+    s.flags = flags;
+    stream_log_append_sample(&s);
+}
+
+static void stream_record_bytes(uint8_t *dst, const stream_record_t *r)
+{
+    stream_record_store(dst, r);
+    store_be16(&dst[STREAM_LOG_RECORD_SIZE - 2u], record_crc16_be(dst, STREAM_LOG_RECORD_SIZE));
+}
+
+/* Returns 0 to stop the scan after this record. */
+typedef uint8_t (*stream_visit_fn)(void *ctx, const stream_record_t *r);
+
+/* Decodes the samples of one page in order and hands those from `skip` on
+ * to visit(). Returns how many it handed over. */
+static uint8_t stream_page_scan(const uint8_t *page, uint8_t nsamples, uint16_t used,
+                                uint16_t skip, stream_visit_fn visit, void *ctx)
+{
+    const uint8_t *p = &page[STREAM_PAGE_HDR];
+    const uint8_t *end = p + used;
+    stream_sample_t s = {{0}, 0, 0, 0};
+    uint8_t n = 0;
+    for (uint16_t i = 0; i < nsamples; ++i)
+    {
+        if (end - p < 2)
+            break;
+        uint8_t hdr = *p++;
+        uint8_t mask = *p++;
+        uint32_t v;
+        if (hdr & STREAM_HDR_DT)
+        {
+            if (!(p = get_varint(p, end, &v)))
+                break;
+            s.dt_ms = (uint16_t)v;
+        }
+        if (hdr & STREAM_HDR_MODE)
+        {
+            if (end - p < 2)
+                break;
+            s.assist_mode = *p++;
+            s.profile_id = *p++;
+        }
+        for (uint8_t f = 0; f < STREAM_FIELD_COUNT; ++f)
+        {
+            if (!(mask & (1u << f)))
+                continue;
+            if (!(p = get_varint(p, end, &v)))
+                return n;
+            s.field[f] = (uint16_t)(s.field[f] + (uint16_t)unzigzag(v));
+        }
+        if (i < skip)
+            continue;
+
+        stream_record_t r;
+        r.version = STREAM_LOG_VERSION;
+        r.flags = (uint8_t)(hdr & 0x03u);
+        r.dt_ms = s.dt_ms;
+        r.speed_dmph = s.field[0];
+        r.cadence_rpm = s.field[1];
+        r.power_w = s.field[2];
+        r.batt_dV = (int16_t)s.field[3];
+        r.batt_dA = (int16_t)s.field[4];
+        r.temp_dC = (int16_t)s.field[5];
+        r.assist_mode = s.assist_mode;
+        r.profile_id = s.profile_id;
+        r.crc16 = 0;
+        n++;
+        if (!visit(ctx, &r))
+            break;
+    }
+    return n;
+}
+
+typedef struct {
+    uint8_t *out;
+    uint8_t n;
+    uint8_t max;
+} stream_copy_t;
+
+static uint8_t stream_copy_visit(void *ctx, const stream_record_t *r)
+{
+    stream_copy_t *c = (stream_copy_t *)ctx;
+    stream_record_bytes(&c->out[(size_t)c->n * STREAM_LOG_RECORD_SIZE], r);
+    return ++c->n < c->max;
+}
+
+/* Decodes samples [skip, skip + max) of one page into 20-byte records. */
+static uint8_t stream_page_decode(const uint8_t *page, uint8_t nsamples, uint16_t used,
+                                  uint16_t skip, uint8_t max, uint8_t *out)
+{
+    stream_copy_t c = {out, 0u, max};
+    return stream_page_scan(page, nsamples, used, skip, stream_copy_visit, &c);
+}
+
 uint8_t stream_log_copy(uint16_t offset, uint8_t max_records, uint8_t *out)
 {
-    return log_copy_records(STREAM_LOG_STORAGE_BASE, STREAM_LOG_RECORD_SIZE,
-                            g_stream_meta.count, offset, max_records, out);
+    if (!out || max_records == 0 || offset >= g_stream_meta.count)
+        return 0;
+
+    /* Committed pages may still be queued. */
+    flash_jobs_flush();
+
+    uint32_t ram_first = g_stream_meta.count - g_stream.samples;
+    uint32_t idx = offset;
+    uint8_t n = 0;
+    while (n < max_records && idx < ram_first)
+    {
+        uint32_t pg = g_stream_meta.head - 1u;
+        while (pg > 0u && g_stream.page_first[pg] > idx)
+            pg--;
+        spi_flash_read(STREAM_LOG_STORAGE_BASE + pg * SPI_FLASH_PAGE_SIZE,
+                       g_stream_decode, SPI_FLASH_PAGE_SIZE);
+        if (!stream_page_valid(g_stream_decode))
+            return n;
+        uint8_t got = stream_page_decode(g_stream_decode, g_stream_decode[1],
+                                         load_be16(&g_stream_decode[2]),
+                                         (uint16_t)(idx - g_stream.page_first[pg]),
+                                         (uint8_t)(max_records - n),
+                                         &out[(size_t)n * STREAM_LOG_RECORD_SIZE]);
+        if (!got)
+            return n;
+        n = (uint8_t)(n + got);
+        idx += got;
+    }
+    if (n < max_records && idx >= ram_first)
+    {
+        /* Newest samples are still in the RAM page. */
+        n = (uint8_t)(n + stream_page_decode(g_stream_page[g_stream.fill], g_stream.samples,
+                                             g_stream.used, (uint16_t)(idx - ram_first),
+                                             (uint8_t)(max_records - n),
+                                             &out[(size_t)n * STREAM_LOG_RECORD_SIZE]));
+    }
+    return n;
 }
 
-void stream_log_tick(void)
+void stream_log_tick(const tlm_tick_t *s)
 {
-    if (!g_stream_log_enabled)
+    if (!s || !g_stream_log_enabled)
         return;
     if (g_stream_log_period_ms == 0)
         return;
-    uint32_t now = g_ms;
-    if ((uint32_t)(now - g_stream_log_last_ms) >= g_stream_log_period_ms)
-    {
-        g_stream_log_last_ms = now;
-        uint8_t flags = 0u;
-        if (g_inputs.brake)
-            flags |= 0x01u;
-        if (g_walk_state == WALK_STATE_ACTIVE)
-            flags |= 0x02u;
-        stream_log_append(flags);
+    /* Sampler timestamps: a period that is a multiple of the sampler's
+     * gives exactly equal dt between records. */
+    if ((int32_t)(s->ms - g_stream_log_last_ms) >= (int32_t)g_stream_log_period_ms)
+    {
+        g_stream_log_last_ms = s->ms;
+        stream_log_append_sample(s);
+    }
+}
+
+_Static_assert(EVENT_LOG_RECORD_SIZE == STREAM_LOG_RECORD_SIZE,
+               "log queries copy records of one size");
+
+typedef struct {
+    uint32_t ms;
+    uint8_t type;
+    uint8_t flags;
+    uint16_t field[LOG_QUERY_FIELDS];
+} query_rec_t;
+
+typedef struct {
+    const log_query_t *q;
+    log_query_result_t *res;
+    uint8_t *out;
+    uint8_t max;
+    uint8_t signed_mask; /* fields compared as int16 */
+    uint8_t stop;
+    uint16_t since_kept;
+    uint16_t start;      /* records before it only advance the stream clock */
+    uint32_t idx;
+    uint32_t ms;         /* stream clock: dt summed from the oldest sample */
+    uint32_t bucket_ms;
+} query_scan_t;
+
+static uint8_t query_less(const query_scan_t *s, uint8_t f, uint16_t a, uint16_t b)
+{
+    if (s->signed_mask & (1u << f))
+        return (int16_t)a < (int16_t)b;
+    return a < b;
+}
+
+/* One record in log order; `rec` is its 20-byte form for records queries. */
+static void query_visit(query_scan_t *s, const query_rec_t *v, const uint8_t *rec)
+{
+    const log_query_t *q = s->q;
+    log_query_result_t *res = s->res;
+    if (s->idx++ < s->start)
+        return;
+    res->next = (uint16_t)s->idx;
+    uint8_t bit = (uint8_t)(v->type < 31u ? v->type : 31u);
+    if (!(q->type_mask & (1u << bit)) || v->ms < q->ms_from || v->ms > q->ms_to ||
+        (v->flags & q->flags_mask) != q->flags_want)
+        return;
+    if (res->matched != 0xFFFFu)
+        res->matched++;
+
+    if (q->mode == LOG_QUERY_RECORDS)
+    {
+        /* The last match of each group is kept, so a query resumed at `next`
+         * decimates exactly as one that ran on. */
+        if (++s->since_kept < (q->every ? q->every : 1u))
+            return;
+        s->since_kept = 0;
+        for (uint8_t i = 0; i < EVENT_LOG_RECORD_SIZE; ++i)
+            s->out[(size_t)res->records * EVENT_LOG_RECORD_SIZE + i] = rec[i];
+        if (++res->records >= s->max)
+            s->stop = 1u;
+        return;
+    }
+    if (q->mode == LOG_QUERY_STATS)
+    {
+        for (uint8_t f = 0; f < LOG_QUERY_FIELDS; ++f)
+        {
+            if (res->matched == 1u || query_less(s, f, v->field[f], res->min[f]))
+                res->min[f] = v->field[f];
+            if (res->matched == 1u || query_less(s, f, res->max[f], v->field[f]))
+                res->max[f] = v->field[f];
+        }
+        return;
+    }
+    uint32_t b = (v->ms - q->ms_from) / s->bucket_ms;
+    if (b < LOG_QUERY_BUCKET_COUNT && res->bucket[b] != 0xFFFFu)
+        res->bucket[b]++;
+}
+
+static void event_query_scan(query_scan_t *s)
+{
+    /* Appended records may still be staged or queued. */
+    event_stage_commit();
+    flash_jobs_flush();
+
+    uint8_t buf[8u * EVENT_LOG_RECORD_SIZE];
+    uint8_t sector;
+    uint16_t slot;
+    while (!s->stop && event_locate(s->idx, &sector, &slot))
+    {
+        /* Records of a sector are contiguous: read them in runs. */
+        uint16_t n = (uint16_t)(g_event_log.sec[sector].count - slot);
+        if (n > 8u)
+            n = 8u;
+        spi_flash_read(event_record_addr(sector, slot), buf, (uint32_t)n * EVENT_LOG_RECORD_SIZE);
+        for (uint16_t i = 0; i < n && !s->stop; ++i)
+        {
+            const uint8_t *r = &buf[(size_t)i * EVENT_LOG_RECORD_SIZE];
+            query_rec_t v;
+            v.ms = load_be32(&r[0]);
+            v.type = r[4];
+            v.flags = r[5];
+            for (uint8_t f = 0; f < LOG_QUERY_FIELDS; ++f)
+                v.field[f] = load_be16(&r[6u + 2u * f]);
+            query_visit(s, &v, r);
+        }
+    }
+}
+
+static uint8_t stream_query_visit(void *ctx, const stream_record_t *r)
+{
+    query_scan_t *s = (query_scan_t *)ctx;
+    s->ms += r->dt_ms;
+    query_rec_t v;
+    v.ms = s->ms;
+    v.type = r->assist_mode;
+    v.flags = r->flags;
+    v.field[0] = r->speed_dmph;
+    v.field[1] = r->cadence_rpm;
+    v.field[2] = r->power_w;
+    v.field[3] = (uint16_t)r->batt_dV;
+    v.field[4] = (uint16_t)r->batt_dA;
+    v.field[5] = (uint16_t)r->temp_dC;
+    uint8_t rec[STREAM_LOG_RECORD_SIZE];
+    if (s->q->mode == LOG_QUERY_RECORDS)
+        stream_record_bytes(rec, r);
+    query_visit(s, &v, rec);
+    return !s->stop;
+}
+
+static void stream_query_scan(query_scan_t *s, uint8_t timed)
+{
+    /* Committed pages may still be queued. */
+    flash_jobs_flush();
+
+    uint32_t ram_first = g_stream_meta.count - g_stream.samples;
+    uint32_t pg = 0;
+    /* Without a time filter the scan can start at the page holding `start`;
+     * with one, the clock has to run from the oldest sample. */
+    if (!timed)
+    {
+        pg = g_stream_meta.head;
+        while (pg > 0u && s->start < ram_first && g_stream.page_first[pg - 1u] > s->start)
+            pg--;
+        if (pg > 0u && s->start < ram_first)
+            pg--;
+    }
+    for (; pg < g_stream_meta.head && !s->stop; ++pg)
+    {
+        spi_flash_read(STREAM_LOG_STORAGE_BASE + pg * SPI_FLASH_PAGE_SIZE,
+                       g_stream_decode, SPI_FLASH_PAGE_SIZE);
+        if (!stream_page_valid(g_stream_decode))
+            return;
+        s->idx = g_stream.page_first[pg];
+        (void)stream_page_scan(g_stream_decode, g_stream_decode[1], load_be16(&g_stream_decode[2]),
+                               0u, stream_query_visit, s);
+    }
+    if (!s->stop && g_stream.samples)
+    {
+        s->idx = ram_first;
+        (void)stream_page_scan(g_stream_page[g_stream.fill], g_stream.samples, g_stream.used, 0u,
+                               stream_query_visit, s);
+    }
+}
+
+void log_query_run(const log_query_t *q, uint16_t offset, uint8_t max_records, uint8_t *out,
+                   log_query_result_t *res)
+{
+    if (!q || !res)
+        return;
+    for (uint8_t f = 0; f < LOG_QUERY_FIELDS; ++f)
+        res->min[f] = res->max[f] = 0u;
+    for (uint8_t b = 0; b < LOG_QUERY_BUCKET_COUNT; ++b)
+        res->bucket[b] = 0u;
+    res->matched = 0u;
+    res->records = 0u;
+
+    query_scan_t s = {0};
+    s.q = q;
+    s.res = res;
+    s.out = out;
+    s.max = max_records;
+    s.start = offset;
+    s.idx = 0u;
+    s.bucket_ms = (uint32_t)(q->bucket_s ? q->bucket_s : 60u) * 1000u;
+    if (q->mode == LOG_QUERY_RECORDS && (!out || !max_records))
+        s.stop = 1u;
+
+    if (q->log == LOG_QUERY_EVENT)
+    {
+        res->next = (uint16_t)(offset < g_event_meta.count ? g_event_meta.count : offset);
+        s.signed_mask = 0x0Fu;
+        s.idx = offset;
+        s.start = offset;
+        if (!s.stop)
+            event_query_scan(&s);
+    }
+    else
+    {
+        res->next = (uint16_t)(offset < g_stream_meta.count ? g_stream_meta.count : offset);
+        s.signed_mask = 0x38u;
+        if (!s.stop)
+            stream_query_scan(&s, (uint8_t)(q->ms_from != 0u || q->ms_to != 0xFFFFFFFFu ||
+                                            q->mode == LOG_QUERY_BUCKETS));
     }
 }
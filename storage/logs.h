@@ -4,12 +4,19 @@
 #include <stdint.h>
 
 #include "storage/event_types.h"
+#include "src/telemetry/tlm_sampler.h"
 
-/* Event log (fixed-size flash-backed log; erase-on-wrap) */
+/* Event log (fixed-size records in a ring of indexed 4 KB sectors) */
 #define EVENT_LOG_MAGIC        0x45564C47u /* 'EVLG' */
-#define EVENT_LOG_VERSION      1u
+#define EVENT_LOG_VERSION      2u
 #define EVENT_LOG_RECORD_SIZE  20u
-#define EVENT_LOG_CAPACITY     256u
+#define EVENT_LOG_SECTOR_RECORDS 204u /* after the 16-byte sector header */
+#define EVENT_LOG_CAPACITY     408u
+#define EVENT_STAGE_FLUSH_MS   1000u /* longest a staged append waits for flash */
+
+/* event_log_seek() keys */
+#define EVENT_LOG_SEEK_SEQ     1u /* first record with seq >= key */
+#define EVENT_LOG_SEEK_MS      2u /* first record with ms >= key (ms since boot) */
 
 typedef struct {
     uint32_t magic;
@@ -27,14 +34,26 @@ extern event_log_meta_t g_event_meta;
 
 void event_log_load(void);
 void event_log_reset(void);
+/* Stages a record; it reaches flash with the run it belongs to. */
 void event_log_append(uint8_t type, uint8_t flags);
+/* Programs the staged run (before reset or when the caller must read flash). */
+void event_log_flush(void);
+/* Main loop: programs a run that has waited EVENT_STAGE_FLUSH_MS. */
+void event_log_tick(uint32_t now_ms);
+/* Brown-out interrupt, with the bus taken: writes the staged run through
+ * `program` when nothing queued comes before it. */
+void event_log_flush_urgent(void (*program)(uint32_t addr, const uint8_t *data, uint32_t len));
 uint8_t event_log_copy(uint16_t offset, uint8_t max_records, uint8_t *out);
+/* Returns the offset for event_log_copy(), or count when nothing matches. */
+uint16_t event_log_seek(uint8_t mode, uint32_t key);
 
-/* Stream log (sampled telemetry; flash-backed; erase-on-wrap) */
+/* Stream log (sampled telemetry; flash-backed; erase-on-wrap).
+ * v2 stores delta-coded samples in whole 256-byte pages (2-8 bytes per
+ * sample instead of 20); reads still return decoded 20-byte records. */
 #define STREAM_LOG_MAGIC        0x53544C47u /* 'STLG' */
-#define STREAM_LOG_VERSION      1u
+#define STREAM_LOG_VERSION      2u
 #define STREAM_LOG_RECORD_SIZE  20u
-#define STREAM_LOG_CAPACITY     512u
+#define STREAM_LOG_PAGES        48u /* STREAM_LOG_STORAGE_BYTES / page size */
 #define STREAM_LOG_PERIOD_MIN_MS 100u
 #define STREAM_LOG_PERIOD_MAX_MS 60000u
 
@@ -59,8 +78,58 @@ extern uint32_t g_stream_log_last_sample_ms;
 uint16_t stream_log_period_sanitize(uint16_t period);
 void stream_log_load(void);
 void stream_log_reset(void);
+/* Record from one sampler tick; its flags are the record's brake/walk bits. */
+void stream_log_append_sample(const tlm_tick_t *s);
+/* Record from the live inputs at g_ms. */
 void stream_log_append(uint8_t flags);
+/* Programs the partially filled RAM page (before reset or when stopping). */
+void stream_log_flush(void);
 uint8_t stream_log_copy(uint16_t offset, uint8_t max_records, uint8_t *out);
-void stream_log_tick(void);
+/* Feed every sampler tick; records one every g_stream_log_period_ms. */
+void stream_log_tick(const tlm_tick_t *s);
+
+/* Log queries: filter a log on the device and return only the matching
+ * records, or an aggregate over them. A record matches when bit
+ * min(type, 31) of type_mask is set (event type; assist mode in the stream
+ * log), its time is in [ms_from, ms_to] and (flags & flags_mask) ==
+ * flags_want. Event time is the record's ms since boot; stream samples carry
+ * only dt, so their time is the sum of dt from the oldest sample. */
+#define LOG_QUERY_EVENT        0u
+#define LOG_QUERY_STREAM       1u
+#define LOG_QUERY_RECORDS      0u /* every `every`-th match, up to max_records */
+#define LOG_QUERY_STATS        1u /* min/max of each field over the matches */
+#define LOG_QUERY_BUCKETS      2u /* matches per bucket_s-wide bucket from ms_from */
+#define LOG_QUERY_FIELDS       6u
+#define LOG_QUERY_BUCKET_COUNT 32u
+
+typedef struct {
+    uint8_t log;
+    uint8_t mode;
+    uint8_t flags_mask;
+    uint8_t flags_want;
+    uint32_t type_mask;
+    uint32_t ms_from;
+    uint32_t ms_to;
+    uint16_t every;    /* records: 0 and 1 keep every match */
+    uint16_t bucket_s; /* buckets: 0 means 60 */
+} log_query_t;
+
+typedef struct {
+    uint16_t next;    /* offset to resume a records query from; count when done */
+    uint16_t matched; /* matches scanned, kept or not (saturates) */
+    uint8_t records;
+    /* Raw 16-bit fields in record order: event speed, batt_dV, batt_dA,
+     * temp_dC, cmd_power_w, cmd_current_dA; stream speed, cadence, power,
+     * batt_dV, batt_dA, temp_dC. Signed where the record is signed. */
+    uint16_t min[LOG_QUERY_FIELDS];
+    uint16_t max[LOG_QUERY_FIELDS];
+    uint16_t bucket[LOG_QUERY_BUCKET_COUNT];
+} log_query_result_t;
+
+/* Scans the log from `offset`. Records queries copy up to max_records
+ * matching 20-byte records (as the read commands return them) to `out` and
+ * stop after the last one; aggregates run to the end of the log. */
+void log_query_run(const log_query_t *q, uint16_t offset, uint8_t max_records, uint8_t *out,
+                   log_query_result_t *res);
 
 #endif
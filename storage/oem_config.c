@@ -0,0 +1,38 @@
+#include "storage/oem_config.h"
+
+#include <stddef.h>
+
+#include "drivers/spi_flash.h"
+
+static struct {
+    uint8_t loaded;
+    uint8_t valid;
+    uint8_t buf[OEM_CFG_SIZE] __attribute__((aligned(4)));
+} g_oem_cfg;
+
+static int oem_config_has_data(const uint8_t *buf)
+{
+    uint8_t all_zero = 1u;
+    uint8_t all_ff = 1u;
+    for (uint32_t i = 0; i < OEM_CFG_SIZE; ++i)
+    {
+        if (buf[i] != 0u)
+            all_zero = 0u;
+        if (buf[i] != 0xFFu)
+            all_ff = 0u;
+    }
+    return (all_zero || all_ff) ? 0 : 1;
+}
+
+const uint8_t *oem_config_blob(void)
+{
+    if (!g_oem_cfg.loaded)
+    {
+        g_oem_cfg.loaded = 1u;
+        spi_flash_read(OEM_CFG_PRIMARY_ADDR, g_oem_cfg.buf, OEM_CFG_SIZE);
+        if (!oem_config_has_data(g_oem_cfg.buf))
+            spi_flash_read(OEM_CFG_BACKUP_ADDR, g_oem_cfg.buf, OEM_CFG_SIZE);
+        g_oem_cfg.valid = (uint8_t)oem_config_has_data(g_oem_cfg.buf);
+    }
+    return g_oem_cfg.valid ? g_oem_cfg.buf : NULL;
+}
@@ -0,0 +1,24 @@
+#ifndef OPEN_FIRMWARE_STORAGE_OEM_CONFIG_H
+#define OPEN_FIRMWARE_STORAGE_OEM_CONFIG_H
+
+#include <stdint.h>
+
+/*
+ * OEM config block, read-only. The OEM app keeps wheel size, speed limit
+ * and the battery scale in a 0xD0-byte little-endian block with a backup
+ * copy. The battery monitor and the first-boot config import both need it,
+ * so it is read once (primary, then backup) and kept in RAM.
+ */
+#define OEM_CFG_PRIMARY_ADDR 0x003FD000u
+#define OEM_CFG_BACKUP_ADDR  0x003FB000u
+#define OEM_CFG_SIZE         0xD0u
+
+#define OEM_CFG_OFF_WHEEL_MM     0x1Cu /* le16 */
+#define OEM_CFG_OFF_N69300       0x78u /* le32 */
+#define OEM_CFG_OFF_SPEED_LIMIT  0x7Cu /* le16 */
+#define OEM_CFG_OFF_N48          0x80u /* u8: 24/36/48 */
+
+/* NULL when neither copy holds data (all 0x00 or all 0xFF). */
+const uint8_t *oem_config_blob(void);
+
+#endif
@@ -0,0 +1,432 @@
+#include "storage/ota.h"
+
+#include <stddef.h>
+
+#include "drivers/spi_flash.h"
+#include "platform/ram.h"
+#include "storage/ab_update.h"
+#include "storage/flash_jobs.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+#include "util/lz_stream.h"
+
+#define OTA_PAGE_NONE 0xFFu
+/* Delta copy bytes a chunk may run before it is refused with BUSY; the rest
+ * goes one page per ota_tick. */
+#define OTA_DELTA_WRITE_BUDGET 1024u
+
+static struct {
+    ota_status_t st;
+    uint32_t crc_expected;
+    uint32_t build_id;
+    uint8_t bad_stream;
+    uint32_t base;         /* slot base; the image starts after the header */
+    uint32_t erased_end;
+    uint8_t failed;
+    uint8_t since_ack;
+    uint16_t fill_start;   /* first valid byte within the fill page */
+    uint16_t fill_end;
+    uint32_t fill_addr;
+    crc32_stream_t crc;
+    volatile uint8_t busy[OTA_PAGE_BUFS];
+    lz_stream_t lz;
+    /* OTA_FORMAT_DELTA: op decoder and the copy it is running. */
+    uint32_t src_base;     /* active slot image */
+    uint32_t src_size;
+    uint8_t op;
+    uint8_t op_fill;
+    uint8_t op_hdr[8];
+    uint32_t insert_left;
+    uint32_t copy_src;
+    uint32_t copy_left;
+} g_ota;
+
+/* Page buffer being filled, or OTA_PAGE_NONE. Outside g_ota so the struct,
+ * LZ window included, stays in .bss instead of an image copied at reset. */
+static uint8_t g_ota_fill = OTA_PAGE_NONE;
+/* Programmed only over [fill_start, fill_end), which the stream has written. */
+static uint8_t g_ota_pages[OTA_PAGE_BUFS][SPI_FLASH_PAGE_SIZE] __attribute__((aligned(4))) RAM_NOZERO;
+
+static void ota_page_done(void *ctx, uint8_t ok)
+{
+    *(volatile uint8_t *)ctx = 0u;
+    if (!ok)
+        g_ota.failed = 1u;
+}
+
+static uint8_t ota_page_free(void)
+{
+    for (uint8_t i = 0; i < OTA_PAGE_BUFS; ++i)
+    {
+        if (!g_ota.busy[i])
+            return 1u;
+    }
+    return 0u;
+}
+
+static uint8_t ota_take_page(void)
+{
+    for (;;)
+    {
+        for (uint8_t i = 0; i < OTA_PAGE_BUFS; ++i)
+        {
+            if (!g_ota.busy[i])
+                return i;
+        }
+        /* Host window is ahead of the flash; drain and count it. */
+        g_ota.st.stalls++;
+        flash_jobs_flush();
+    }
+}
+
+static void ota_program_fill(void)
+{
+    if (g_ota_fill == OTA_PAGE_NONE)
+        return;
+    uint8_t i = g_ota_fill;
+    g_ota_fill = OTA_PAGE_NONE;
+    if (g_ota.fill_end <= g_ota.fill_start)
+        return;
+    uint32_t n = (uint32_t)(g_ota.fill_end - g_ota.fill_start);
+    g_ota.busy[i] = 1u;
+    if (!flash_jobs_submit_program(g_ota.fill_addr + g_ota.fill_start, &g_ota_pages[i][g_ota.fill_start],
+                                   n, ota_page_done, (void *)&g_ota.busy[i]))
+    {
+        g_ota.st.stalls++;
+        flash_jobs_flush();
+        (void)flash_jobs_submit_program(g_ota.fill_addr + g_ota.fill_start, &g_ota_pages[i][g_ota.fill_start],
+                                        n, ota_page_done, (void *)&g_ota.busy[i]);
+    }
+    g_ota.st.pages++;
+}
+
+static void ota_open_page(uint32_t page_addr, uint16_t start)
+{
+    /* Erases queue ahead of the programs that need them. */
+    while (g_ota.erased_end < page_addr + SPI_FLASH_PAGE_SIZE)
+    {
+        flash_jobs_erase(g_ota.erased_end);
+        g_ota.erased_end += SPI_FLASH_SECTOR_SIZE;
+    }
+    g_ota_fill = ota_take_page();
+    g_ota.fill_addr = page_addr;
+    g_ota.fill_start = start;
+    g_ota.fill_end = start;
+}
+
+static uint8_t ota_start(uint8_t slot, uint32_t image_size, uint32_t crc32, uint32_t build_id, uint8_t window,
+                         uint8_t format, uint32_t stream_size, uint32_t base_crc32)
+{
+    if (!ab_slot_valid(slot) || slot == g_ab_active_slot)
+        return OTA_STATUS_BAD_SLOT;
+    if (image_size == 0u || image_size > AB_SLOT_MAX_IMAGE)
+        return OTA_STATUS_BAD_SIZE;
+    /* LZ4's worst case for incompressible input; a delta is at worst one
+     * insert of the whole image. */
+    if (stream_size == 0u || stream_size > image_size + image_size / 255u + 16u)
+        return OTA_STATUS_BAD_SIZE;
+    ab_slot_hdr_t base;
+    if (format == OTA_FORMAT_DELTA)
+    {
+        /* The patch was made against this exact image (header + CRC check). */
+        if (!ab_slot_valid(g_ab_active_slot) || !ab_slot_read_header(g_ab_active_slot, &base) ||
+            base.crc32 != base_crc32)
+            return OTA_STATUS_BAD_BASE;
+    }
+    ota_abort();
+    /* Never leave a half-written slot marked for the next boot. */
+    if (slot == g_ab_pending_slot)
+        (void)ab_update_set_pending(AB_SLOT_NONE);
+
+    if (window == 0u)
+        window = 1u;
+    if (window > OTA_WINDOW_MAX)
+        window = OTA_WINDOW_MAX;
+    uint8_t *s = (uint8_t *)&g_ota.st;
+    for (uint32_t i = 0; i < sizeof(g_ota.st); ++i)
+        s[i] = 0u;
+    g_ota.st.active = 1u;
+    g_ota.st.slot = slot;
+    g_ota.st.window = window;
+    g_ota.st.ack_every = (uint8_t)((window + 1u) / 2u);
+    g_ota.st.format = format;
+    g_ota.st.size = stream_size;
+    g_ota.st.image_size = image_size;
+    g_ota.crc_expected = crc32;
+    g_ota.build_id = build_id;
+    g_ota.base = (slot == 0u) ? AB_SLOT0_BASE : AB_SLOT1_BASE;
+    g_ota.erased_end = g_ota.base;
+    g_ota.failed = 0u;
+    g_ota.bad_stream = 0u;
+    g_ota.since_ack = 0u;
+    crc32_stream_begin(&g_ota.crc);
+    if (format == OTA_FORMAT_LZ)
+        lz_stream_begin(&g_ota.lz);
+    g_ota.op = 0u;
+    g_ota.op_fill = 0u;
+    g_ota.insert_left = 0u;
+    g_ota.copy_left = 0u;
+    if (format == OTA_FORMAT_DELTA)
+    {
+        g_ota.src_base = ((g_ab_active_slot == 0u) ? AB_SLOT0_BASE : AB_SLOT1_BASE) + base.header_size;
+        g_ota.src_size = base.image_size;
+    }
+    /* Sector 0 holds the header, so its erase also invalidates the slot. */
+    ota_open_page(g_ota.base, AB_SLOT_HEADER_SIZE);
+    return OTA_STATUS_OK;
+}
+
+uint8_t ota_begin(uint8_t slot, uint32_t size, uint32_t crc32, uint32_t build_id, uint8_t window)
+{
+    return ota_start(slot, size, crc32, build_id, window, OTA_FORMAT_RAW, size, 0u);
+}
+
+uint8_t ota_begin_lz(uint8_t slot, uint32_t image_size, uint32_t crc32, uint32_t build_id, uint8_t window,
+                     uint32_t stream_size)
+{
+    return ota_start(slot, image_size, crc32, build_id, window, OTA_FORMAT_LZ, stream_size, 0u);
+}
+
+uint8_t ota_begin_delta(uint8_t slot, uint32_t image_size, uint32_t crc32, uint32_t build_id, uint8_t window,
+                        uint32_t stream_size, uint32_t base_crc32)
+{
+    return ota_start(slot, image_size, crc32, build_id, window, OTA_FORMAT_DELTA, stream_size, base_crc32);
+}
+
+/* Image bytes, in order: CRC them and gather them into pages. */
+static void ota_emit(void *ctx, const uint8_t *data, uint32_t len)
+{
+    (void)ctx;
+    if (len > g_ota.st.image_size - g_ota.st.written)
+    {
+        g_ota.bad_stream = 1u;
+        len = g_ota.st.image_size - g_ota.st.written;
+    }
+    crc32_stream_feed(&g_ota.crc, data, len);
+    g_ota.st.written += len;
+    while (len)
+    {
+        uint32_t n = SPI_FLASH_PAGE_SIZE - g_ota.fill_end;
+        if (n > len)
+            n = len;
+        uint8_t *dst = &g_ota_pages[g_ota_fill][g_ota.fill_end];
+        for (uint32_t i = 0; i < n; ++i)
+            dst[i] = data[i];
+        g_ota.fill_end = (uint16_t)(g_ota.fill_end + n);
+        data += n;
+        len -= n;
+        if (g_ota.fill_end == SPI_FLASH_PAGE_SIZE)
+        {
+            uint32_t next = g_ota.fill_addr + SPI_FLASH_PAGE_SIZE;
+            ota_program_fill();
+            if (g_ota.st.written < g_ota.st.image_size || len)
+                ota_open_page(next, 0u);
+        }
+    }
+}
+
+/* Runs up to `max` bytes of the pending copy, a page-sized read at a time. */
+static uint32_t ota_copy_step(uint32_t max)
+{
+    uint8_t buf[SPI_FLASH_PAGE_SIZE];
+    uint32_t done = 0u;
+    while (g_ota.copy_left && done < max && !g_ota.bad_stream)
+    {
+        uint32_t n = g_ota.copy_left;
+        if (n > sizeof(buf))
+            n = sizeof(buf);
+        if (n > max - done)
+            n = max - done;
+        spi_flash_read(g_ota.src_base + g_ota.copy_src, buf, n);
+        ota_emit(NULL, buf, n);
+        g_ota.copy_src += n;
+        g_ota.copy_left -= n;
+        done += n;
+    }
+    return done;
+}
+
+/* Takes delta ops from the stream; returns the bytes consumed, which stop
+ * short when a copy is still running after the budget. */
+static uint32_t ota_delta_feed(const uint8_t *data, uint32_t len)
+{
+    uint32_t budget = OTA_DELTA_WRITE_BUDGET;
+    uint32_t used = 0u;
+    while (!g_ota.bad_stream)
+    {
+        if (g_ota.copy_left)
+        {
+            budget -= ota_copy_step(budget);
+            if (g_ota.copy_left)
+                break;
+            continue;
+        }
+        if (used == len)
+            break;
+        if (g_ota.insert_left)
+        {
+            uint32_t n = len - used;
+            if (n > g_ota.insert_left)
+                n = g_ota.insert_left;
+            ota_emit(NULL, &data[used], n);
+            g_ota.insert_left -= n;
+            used += n;
+            continue;
+        }
+        uint8_t b = data[used++];
+        if (g_ota.op == 0u)
+        {
+            if (b != OTA_DELTA_COPY && b != OTA_DELTA_INSERT)
+                g_ota.bad_stream = 1u;
+            g_ota.op = b;
+            g_ota.op_fill = 0u;
+            continue;
+        }
+        g_ota.op_hdr[g_ota.op_fill++] = b;
+        if (g_ota.op_fill < ((g_ota.op == OTA_DELTA_COPY) ? 8u : 4u))
+            continue;
+        if (g_ota.op == OTA_DELTA_COPY)
+        {
+            uint32_t src = load_be32(&g_ota.op_hdr[0]);
+            uint32_t n = load_be32(&g_ota.op_hdr[4]);
+            if (src > g_ota.src_size || n > g_ota.src_size - src)
+                g_ota.bad_stream = 1u;
+            g_ota.copy_src = src;
+            g_ota.copy_left = g_ota.bad_stream ? 0u : n;
+        }
+        else
+        {
+            g_ota.insert_left = load_be32(&g_ota.op_hdr[0]);
+        }
+        g_ota.op = 0u;
+    }
+    return used;
+}
+
+uint8_t ota_write(uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    if (!g_ota.st.active)
+        return OTA_STATUS_NO_SESSION;
+    if (!data || len == 0u || len > OTA_CHUNK_MAX)
+        return OTA_STATUS_BAD_SIZE;
+    if (g_ota.bad_stream)
+        return OTA_STATUS_BAD_STREAM;
+    if (offset > g_ota.st.next_offset)
+    {
+        g_ota.st.gaps++;
+        return OTA_STATUS_GAP;
+    }
+    uint32_t skip = g_ota.st.next_offset - offset;
+    if (skip >= len)
+    {
+        g_ota.st.dups++;
+        return OTA_STATUS_DUP;
+    }
+    data += skip;
+    len -= skip;
+    if (len > g_ota.st.size - g_ota.st.next_offset)
+        return OTA_STATUS_BAD_SIZE;
+
+    if (g_ota.st.format == OTA_FORMAT_DELTA)
+    {
+        uint32_t used = ota_delta_feed(data, len);
+        g_ota.st.next_offset += used;
+        if (g_ota.bad_stream)
+            return OTA_STATUS_BAD_STREAM;
+        if (used < len)
+        {
+            g_ota.st.busy++;
+            return OTA_STATUS_BUSY;
+        }
+        g_ota.st.chunks++;
+        g_ota.since_ack++;
+        return OTA_STATUS_OK;
+    }
+
+    g_ota.st.next_offset += len;
+    g_ota.st.chunks++;
+    g_ota.since_ack++;
+    if (g_ota.st.format == OTA_FORMAT_LZ)
+    {
+        if (!lz_stream_feed(&g_ota.lz, data, len, ota_emit, NULL))
+            g_ota.bad_stream = 1u;
+    }
+    else
+    {
+        ota_emit(NULL, data, len);
+    }
+    return g_ota.bad_stream ? OTA_STATUS_BAD_STREAM : OTA_STATUS_OK;
+}
+
+void ota_tick(void)
+{
+    if (g_ota.st.active && g_ota.copy_left && ota_page_free())
+        (void)ota_copy_step(SPI_FLASH_PAGE_SIZE);
+}
+
+uint8_t ota_ack_due(void)
+{
+    if (!g_ota.since_ack)
+        return 0u;
+    if (g_ota.since_ack < g_ota.st.ack_every && g_ota.st.next_offset != g_ota.st.size)
+        return 0u;
+    g_ota.since_ack = 0u;
+    return 1u;
+}
+
+uint8_t ota_finish(uint8_t set_pending)
+{
+    if (!g_ota.st.active)
+        return OTA_STATUS_NO_SESSION;
+    while (g_ota.copy_left && !g_ota.bad_stream)
+        (void)ota_copy_step(SPI_FLASH_PAGE_SIZE);
+    ota_program_fill();
+    flash_jobs_flush();
+    g_ota.st.active = 0u;
+    if (g_ota.failed)
+        return OTA_STATUS_FLASH;
+    if (g_ota.bad_stream || g_ota.st.next_offset != g_ota.st.size || g_ota.st.written != g_ota.st.image_size)
+        return OTA_STATUS_BAD_IMAGE;
+    if (g_ota.st.format == OTA_FORMAT_LZ && !lz_stream_complete(&g_ota.lz))
+        return OTA_STATUS_BAD_IMAGE;
+    if (g_ota.st.format == OTA_FORMAT_DELTA && (g_ota.op || g_ota.insert_left))
+        return OTA_STATUS_BAD_IMAGE;
+    if (crc32_stream_end(&g_ota.crc) != g_ota.crc_expected)
+        return OTA_STATUS_BAD_IMAGE;
+
+    uint8_t hdr[AB_SLOT_HEADER_SIZE];
+    store_be32(&hdr[0], AB_SLOT_MAGIC);
+    store_be16(&hdr[4], AB_SLOT_VERSION);
+    store_be16(&hdr[6], AB_SLOT_HEADER_SIZE);
+    store_be32(&hdr[8], g_ota.st.image_size);
+    store_be32(&hdr[12], g_ota.crc_expected);
+    store_be32(&hdr[16], g_ota.build_id);
+    store_be32(&hdr[20], 0u);
+    store_be32(&hdr[24], 0u);
+    store_be32(&hdr[28], 0u);
+    flash_jobs_program(g_ota.base, hdr, sizeof(hdr));
+    flash_jobs_flush();
+    if (g_ota.failed)
+        return OTA_STATUS_FLASH;
+    if (set_pending)
+        (void)ab_update_set_pending(g_ota.st.slot);
+    return OTA_STATUS_OK;
+}
+
+void ota_abort(void)
+{
+    if (g_ota_fill != OTA_PAGE_NONE || g_ota.st.active)
+    {
+        /* Queued programs borrow the page buffers. */
+        g_ota_fill = OTA_PAGE_NONE;
+        flash_jobs_flush();
+    }
+    g_ota.copy_left = 0u;
+    g_ota.st.active = 0u;
+}
+
+void ota_get_status(ota_status_t *out)
+{
+    if (out)
+        *out = g_ota.st;
+}
@@ -0,0 +1,91 @@
+#ifndef OPEN_FIRMWARE_STORAGE_OTA_H
+#define OPEN_FIRMWARE_STORAGE_OTA_H
+
+#include <stdint.h>
+
+/*
+ * OTA ingest into an A/B slot. The host streams {offset, data} chunks with up
+ * to `window` of them unacknowledged; accepted bytes are gathered into
+ * 256-byte page buffers and programmed through the flash job queue, with the
+ * slot's sectors erased just ahead of the writer. The image CRC is computed as
+ * bytes arrive and checked by ota_finish(), which then writes the slot header.
+ *
+ * An LZ session (ota_begin_lz) streams util/lz_stream.h sequences instead:
+ * offsets and acks count stream bytes, the decoder's output goes into the
+ * pages, and the CRC and header size cover the decompressed image.
+ *
+ * A delta session (ota_begin_delta) streams ops against the active slot's
+ * image, which must match the base CRC the patch was made from:
+ *
+ *   OTA_DELTA_COPY    src[4] len[4]   image bytes [src, src+len) of the base
+ *   OTA_DELTA_INSERT  len[4] data...  literal bytes
+ *
+ * (big-endian). A chunk runs at most OTA_DELTA_WRITE_BUDGET copy bytes; past
+ * that it is taken up to next_offset and refused with OTA_STATUS_BUSY while
+ * ota_tick() finishes the copy a page at a time.
+ */
+
+#define OTA_WINDOW_MAX 8u
+#define OTA_PAGE_BUFS 4u
+/* Largest chunk that fits a comm frame next to its 4-byte offset. */
+#define OTA_CHUNK_MAX 188u
+
+#define OTA_FORMAT_RAW 0u
+#define OTA_FORMAT_LZ 1u            /* LZ_STREAM_WINDOW history */
+#define OTA_FORMAT_DELTA 2u
+
+#define OTA_DELTA_COPY 0x01u
+#define OTA_DELTA_INSERT 0x02u
+
+#define OTA_STATUS_OK 0x00u
+#define OTA_STATUS_DUP 0x01u        /* already received; ignored */
+#define OTA_STATUS_BUSY 0x02u       /* delta copy running; resend from next_offset */
+#define OTA_STATUS_BAD_BASE 0xF5u   /* active slot invalid or not the patch's base */
+#define OTA_STATUS_BAD_STREAM 0xF6u /* LZ stream corrupt or past the image size */
+#define OTA_STATUS_GAP 0xF7u        /* offset ahead of next_offset */
+#define OTA_STATUS_BAD_IMAGE 0xF8u  /* size or CRC mismatch at finish */
+#define OTA_STATUS_NO_SESSION 0xF9u
+#define OTA_STATUS_BAD_SLOT 0xFAu   /* invalid slot, or the active one */
+#define OTA_STATUS_BAD_SIZE 0xFBu
+#define OTA_STATUS_FLASH 0xFCu      /* a queued erase/program failed */
+
+typedef struct {
+    uint8_t active;
+    uint8_t slot;
+    uint8_t window;
+    uint8_t ack_every;
+    uint8_t format;       /* OTA_FORMAT_* */
+    uint32_t size;        /* bytes streamed; the image size when raw */
+    uint32_t image_size;
+    uint32_t written;     /* image bytes produced so far */
+    uint32_t next_offset;
+    uint32_t chunks;
+    uint16_t dups;
+    uint16_t gaps;
+    uint16_t stalls;  /* page pool or job queue full; waited for flash */
+    uint16_t pages;
+    uint16_t busy;    /* chunks cut short by a running delta copy */
+} ota_status_t;
+
+/* Starts a session for `slot`; `window` is clamped to 1..OTA_WINDOW_MAX. */
+uint8_t ota_begin(uint8_t slot, uint32_t size, uint32_t crc32, uint32_t build_id, uint8_t window);
+/* Same for an LZ stream of `stream_size` bytes that decodes to `image_size`. */
+uint8_t ota_begin_lz(uint8_t slot, uint32_t image_size, uint32_t crc32, uint32_t build_id, uint8_t window,
+                     uint32_t stream_size);
+/* Same for a delta stream; base_crc32 is the image CRC in the active slot's
+ * header. */
+uint8_t ota_begin_delta(uint8_t slot, uint32_t image_size, uint32_t crc32, uint32_t build_id, uint8_t window,
+                        uint32_t stream_size, uint32_t base_crc32);
+uint8_t ota_write(uint32_t offset, const uint8_t *data, uint32_t len);
+/* 1 when the host is owed a cumulative ack (every ack_every accepted chunks,
+ * and once the image is complete); clears the pending count. */
+uint8_t ota_ack_due(void);
+/* Main loop: advances a delta copy left running by ota_write. */
+void ota_tick(void);
+/* Programs the tail, checks size/CRC and writes the slot header. With
+ * `set_pending` the slot is then queued for the background A/B verify. */
+uint8_t ota_finish(uint8_t set_pending);
+void ota_abort(void);
+void ota_get_status(ota_status_t *out);
+
+#endif
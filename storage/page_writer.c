@@ -0,0 +1,79 @@
+#include "storage/page_writer.h"
+
+#include "storage/flash_jobs.h"
+
+static void page_writer_written(void *ctx, uint8_t ok)
+{
+    (void)ok;
+    *(volatile uint8_t *)ctx = 0;
+}
+
+/* Erased to 0xFF before anything is written. */
+static void page_writer_page_begin(page_writer_t *w)
+{
+    uint8_t *page = w->pages[w->fill];
+    for (uint32_t i = 0; i < SPI_FLASH_PAGE_SIZE; ++i)
+        page[i] = 0xFFu;
+}
+
+void page_writer_begin(page_writer_t *w, uint8_t (*pages)[SPI_FLASH_PAGE_SIZE], uint32_t base,
+                       uint32_t erased_end)
+{
+    w->pages = pages;
+    w->base = base;
+    w->bytes = 0u;
+    w->erased_end = erased_end;
+    w->used = 0u;
+    page_writer_page_begin(w);
+}
+
+void page_writer_erase_through(page_writer_t *w, uint32_t addr)
+{
+    while (w->erased_end <= addr)
+    {
+        flash_jobs_erase(w->erased_end);
+        w->erased_end += SPI_FLASH_SECTOR_SIZE;
+    }
+}
+
+/* Programs the fill page and starts the other one. */
+void page_writer_commit(page_writer_t *w)
+{
+    if (w->used == 0u)
+        return;
+    uint32_t addr = (w->base + w->bytes - w->used) & ~(SPI_FLASH_PAGE_SIZE - 1u);
+    page_writer_erase_through(w, addr);
+    uint8_t f = w->fill;
+    w->busy[f] = 1;
+    if (!flash_jobs_submit_program(addr, w->pages[f], SPI_FLASH_PAGE_SIZE, page_writer_written,
+                                   (void *)&w->busy[f]))
+    {
+        w->busy[f] = 0;
+        flash_jobs_program(addr, w->pages[f], SPI_FLASH_PAGE_SIZE);
+    }
+    w->used = 0u;
+    w->fill ^= 1u;
+    if (w->busy[w->fill])
+        flash_jobs_flush();
+    page_writer_page_begin(w);
+}
+
+void page_writer_put(page_writer_t *w, const uint8_t *data, uint32_t n)
+{
+    while (n)
+    {
+        uint32_t off = (w->base + w->bytes) & (SPI_FLASH_PAGE_SIZE - 1u);
+        uint32_t take = SPI_FLASH_PAGE_SIZE - off;
+        if (take > n)
+            take = n;
+        uint8_t *dst = &w->pages[w->fill][off];
+        for (uint32_t i = 0; i < take; ++i)
+            dst[i] = data[i];
+        w->used = (uint16_t)(w->used + take);
+        w->bytes += take;
+        data += take;
+        n -= take;
+        if (off + take == SPI_FLASH_PAGE_SIZE)
+            page_writer_commit(w);
+    }
+}
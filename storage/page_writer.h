@@ -0,0 +1,34 @@
+#ifndef OPEN_FIRMWARE_STORAGE_PAGE_WRITER_H
+#define OPEN_FIRMWARE_STORAGE_PAGE_WRITER_H
+
+#include <stdint.h>
+
+#include "drivers/spi_flash.h"
+
+/*
+ * Sequential recorder writer: bytes are packed into whole flash pages, two
+ * caller-owned buffers alternating so one fills while flash_jobs programs
+ * the other, and sectors are erased just ahead of the page that needs them
+ * through the same queue. Used by the bus trigger and session recorders,
+ * which keep their header (written last) and CRC to themselves.
+ */
+typedef struct {
+    uint8_t (*pages)[SPI_FLASH_PAGE_SIZE]; /* two buffers */
+    uint32_t base;            /* flash address of byte 0 */
+    uint32_t bytes;           /* bytes put since begin */
+    uint32_t erased_end;      /* absolute flash address; sectors below it are erased */
+    uint16_t used;            /* bytes in the fill page */
+    uint8_t fill;             /* page buffer being filled */
+    volatile uint8_t busy[2]; /* page handed to flash_jobs, not yet written */
+} page_writer_t;
+
+/* Starts at `base`; nothing below `erased_end` is erased again. */
+void page_writer_begin(page_writer_t *w, uint8_t (*pages)[SPI_FLASH_PAGE_SIZE], uint32_t base,
+                       uint32_t erased_end);
+void page_writer_put(page_writer_t *w, const uint8_t *data, uint32_t n);
+/* Programs the partly filled page, if any. */
+void page_writer_commit(page_writer_t *w);
+/* Erases every sector up to the one holding `addr` that is not yet erased. */
+void page_writer_erase_through(page_writer_t *w, uint32_t addr);
+
+#endif
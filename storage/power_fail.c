@@ -0,0 +1,166 @@
+#include "storage/power_fail.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include "drivers/spi_flash.h"
+#include "storage/flash_jobs.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+#define PF_SLOTS_PER_SECTOR (SPI_FLASH_SECTOR_SIZE / POWER_FAIL_SLOT_SIZE)
+#define PF_SECTORS          (POWER_FAIL_SLOTS / PF_SLOTS_PER_SECTOR)
+#define PF_HDR_SIZE         12u
+#define PF_CRC_OFFSET       248u
+#define PF_MARK_OFFSET      255u
+#define PF_NO_SLOT          POWER_FAIL_SLOTS
+
+_Static_assert(POWER_FAIL_SLOTS * POWER_FAIL_SLOT_SIZE == POWER_FAIL_STORAGE_BYTES,
+               "power fail slots do not fill the region");
+_Static_assert(PF_HDR_SIZE + POWER_FAIL_PAYLOAD_MAX == PF_CRC_OFFSET, "power fail record layout");
+_Static_assert(POWER_FAIL_SLOT_SIZE == SPI_FLASH_PAGE_SIZE, "a record is one page program");
+
+static struct {
+    /* Erased slot for the next write, or PF_NO_SLOT; an erase completion
+     * may set it from the main loop while the interrupt reads it. */
+    volatile uint8_t next;
+    uint32_t next_seq;
+} g_power_fail = { PF_NO_SLOT, 1u };
+
+static uint32_t pf_slot_addr(uint8_t slot)
+{
+    return POWER_FAIL_STORAGE_BASE + (uint32_t)slot * POWER_FAIL_SLOT_SIZE;
+}
+
+static uint8_t pf_is_erased(const uint8_t *buf, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        if (buf[i] != 0xFFu)
+            return 0;
+    }
+    return 1;
+}
+
+static uint8_t pf_record_ok(const uint8_t *page)
+{
+    if (load_be32(&page[0]) != POWER_FAIL_MAGIC || page[10] != POWER_FAIL_VERSION)
+        return 0;
+    if (load_be16(&page[8]) > POWER_FAIL_PAYLOAD_MAX)
+        return 0;
+    return crc32_compute(page, PF_CRC_OFFSET) == load_be32(&page[PF_CRC_OFFSET]);
+}
+
+static void pf_sector_erased(void *ctx, uint8_t ok)
+{
+    if (ok && g_power_fail.next == PF_NO_SLOT)
+        g_power_fail.next = (uint8_t)(uintptr_t)ctx;
+}
+
+/* A sector with no erased slot left only holds taken or torn records. */
+static void pf_recycle_sectors(uint32_t blank_mask)
+{
+    uint8_t keep = g_power_fail.next / PF_SLOTS_PER_SECTOR;
+    for (uint8_t s = 0; s < PF_SECTORS; ++s)
+    {
+        uint32_t bits = ((1u << PF_SLOTS_PER_SECTOR) - 1u) << (s * PF_SLOTS_PER_SECTOR);
+        if (s == keep || (blank_mask & bits))
+            continue;
+        uint8_t first = (uint8_t)(s * PF_SLOTS_PER_SECTOR);
+        void *ctx = (void *)(uintptr_t)first;
+        uint32_t addr = pf_slot_addr(first);
+        /* The slot is only handed out once its sector is erased. */
+        if (!flash_jobs_submit_erase(addr, pf_sector_erased, ctx))
+        {
+            flash_jobs_flush();
+            spi_flash_erase_4k(addr);
+            pf_sector_erased(ctx, 1u);
+        }
+    }
+}
+
+uint32_t power_fail_take(uint8_t *out, uint32_t cap)
+{
+    uint8_t page[POWER_FAIL_SLOT_SIZE];
+    uint32_t blank_mask = 0u;
+    int newest = -1;
+    uint32_t newest_seq = 0u;
+
+    g_power_fail.next = PF_NO_SLOT;
+    g_power_fail.next_seq = 1u;
+    for (uint8_t slot = 0; slot < POWER_FAIL_SLOTS; ++slot)
+    {
+        spi_flash_read(pf_slot_addr(slot), page, sizeof(page));
+        if (pf_is_erased(page, sizeof(page)))
+        {
+            blank_mask |= 1u << slot;
+            continue;
+        }
+        if (!pf_record_ok(page))
+            continue;
+        uint32_t seq = load_be32(&page[4]);
+        if (newest < 0 || (int32_t)(seq - newest_seq) > 0)
+        {
+            newest = slot;
+            newest_seq = seq;
+        }
+    }
+
+    uint32_t n = 0u;
+    uint8_t start = 0u;
+    if (newest >= 0)
+    {
+        uint32_t addr = pf_slot_addr((uint8_t)newest);
+        spi_flash_read(addr, page, sizeof(page));
+        uint16_t len = load_be16(&page[8]);
+        if (page[PF_MARK_OFFSET] == 0xFFu && out && len <= cap)
+        {
+            memcpy(out, &page[PF_HDR_SIZE], len);
+            n = len;
+        }
+        if (page[PF_MARK_OFFSET] == 0xFFu)
+        {
+            uint8_t taken = 0x00u;
+            flash_jobs_program(addr + PF_MARK_OFFSET, &taken, 1u);
+        }
+        g_power_fail.next_seq = newest_seq + 1u;
+        start = (uint8_t)((newest + 1) % (int)POWER_FAIL_SLOTS);
+    }
+
+    for (uint8_t i = 0; i < POWER_FAIL_SLOTS; ++i)
+    {
+        uint8_t slot = (uint8_t)((start + i) % POWER_FAIL_SLOTS);
+        if (blank_mask & (1u << slot))
+        {
+            g_power_fail.next = slot;
+            break;
+        }
+    }
+    pf_recycle_sectors(blank_mask);
+    return n;
+}
+
+uint8_t power_fail_write_urgent(const uint8_t *payload, uint32_t len)
+{
+    uint8_t slot = g_power_fail.next;
+    if (slot >= POWER_FAIL_SLOTS || !payload || len > POWER_FAIL_PAYLOAD_MAX)
+        return 0u;
+
+    uint8_t page[POWER_FAIL_SLOT_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    store_be32(&page[0], POWER_FAIL_MAGIC);
+    store_be32(&page[4], g_power_fail.next_seq);
+    store_be16(&page[8], (uint16_t)len);
+    page[10] = POWER_FAIL_VERSION;
+    page[11] = 0u;
+    memcpy(&page[PF_HDR_SIZE], payload, len);
+    store_be32(&page[PF_CRC_OFFSET], crc32_compute(page, PF_CRC_OFFSET));
+
+    if (!spi_flash_urgent_begin())
+        return 0u;
+    spi_flash_urgent_program(pf_slot_addr(slot), page, sizeof(page));
+    g_power_fail.next = PF_NO_SLOT;
+    g_power_fail.next_seq++;
+    return 1u;
+}
@@ -0,0 +1,40 @@
+#ifndef OPEN_FIRMWARE_STORAGE_POWER_FAIL_H
+#define OPEN_FIRMWARE_STORAGE_POWER_FAIL_H
+
+#include <stdint.h>
+
+/*
+ * Brown-out records: what the firmware saves between the PVD warning and
+ * the supply dying. A write has no time for an erase, so the region (two
+ * 4 KB sectors, 16 one-page slots each) always holds an erased slot, picked
+ * at boot, and a record is a single page program.
+ *
+ * Record (one 256-byte page, big-endian):
+ *   [0..3] magic 'PWRF', [4..7] seq, [8..9] payload len, [10] version,
+ *   [11] reserved, [12..] payload, [248..251] crc32 over 0..247,
+ *   [255] 0xFF while pending, 0x00 once taken
+ * The payload is opaque here; src/power/brownout.c stores the running trip.
+ * A record torn by the cut fails its CRC and is skipped.
+ */
+#define POWER_FAIL_MAGIC        0x50575246u /* 'PWRF' */
+#define POWER_FAIL_VERSION      1u
+#define POWER_FAIL_SLOT_SIZE    256u
+#define POWER_FAIL_SLOTS        32u
+#define POWER_FAIL_PAYLOAD_MAX  236u
+
+/*
+ * Boot: copies the newest pending record's payload to `out` and marks it
+ * taken (returns its length, 0 when there is none), then readies the slot
+ * for the next write, queueing an erase of the spent sector when needed.
+ */
+uint32_t power_fail_take(uint8_t *out, uint32_t cap);
+
+/*
+ * Brown-out interrupt: writes one record into the ready slot through the
+ * spi_flash urgent path, which takes the bus from whatever it preempted.
+ * Returns 0 when no slot is ready or the flash is not up. Once called, the
+ * interrupted code must not run again.
+ */
+uint8_t power_fail_write_urgent(const uint8_t *payload, uint32_t len);
+
+#endif
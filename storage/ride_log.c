@@ -0,0 +1,311 @@
+#include "storage/ride_log.h"
+
+#include <stddef.h>
+
+#include "drivers/spi_flash.h"
+#include "storage/flash_jobs.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+/*
+ * Each sector starts with a header
+ *   [0..3] magic, [4..7] seq of its first record, [8..9] format version,
+ *   [10..11] record size, [12..13] crc16 over 0..11, [14..15] record count
+ * as in the event log: the count stays erased while the sector fills and is
+ * programmed when the ring moves on, so load reads three headers plus a
+ * binary search of the open sector. Sealed sectors form a chain of
+ * consecutive seqs ending at the newest one; a full ring erases its oldest
+ * sector.
+ */
+#define RIDE_SECTOR_MAGIC  0x52445348u /* 'RDSH' */
+#define RIDE_SECTOR_HDR    16u
+#define RIDE_SECTOR_COUNT  (RIDE_LOG_STORAGE_BYTES / SPI_FLASH_SECTOR_SIZE)
+#define RIDE_COUNT_OPEN    0xFFFFu
+
+_Static_assert(RIDE_SECTOR_COUNT * RIDE_LOG_SECTOR_RECORDS == RIDE_LOG_CAPACITY,
+               "ride log capacity does not match its sectors");
+_Static_assert((RIDE_SECTOR_COUNT - 1u) * RIDE_LOG_SECTOR_RECORDS == RIDE_LOG_RETAINED,
+               "ride log retained count does not match its sectors");
+_Static_assert(RIDE_SECTOR_HDR + RIDE_LOG_SECTOR_RECORDS * RIDE_LOG_RECORD_SIZE <= SPI_FLASH_SECTOR_SIZE,
+               "ride log sector overflow");
+_Static_assert(4u + RIDE_LOG_PAYLOAD_SIZE + 4u == RIDE_LOG_RECORD_SIZE, "ride record layout");
+
+typedef struct {
+    uint32_t seq;
+    uint16_t count;
+    uint8_t valid;
+} ride_sector_t;
+
+static struct {
+    ride_sector_t sec[RIDE_SECTOR_COUNT];
+    uint8_t cur;   /* sector receiving appends */
+    uint8_t first; /* oldest sector of the chain */
+    uint8_t used;  /* sectors in the chain, cur included */
+    uint32_t next_seq;
+} g_ride_log;
+
+static uint32_t ride_sector_addr(uint8_t s)
+{
+    return RIDE_LOG_STORAGE_BASE + (uint32_t)s * SPI_FLASH_SECTOR_SIZE;
+}
+
+static uint32_t ride_record_addr(uint8_t s, uint16_t i)
+{
+    return ride_sector_addr(s) + RIDE_SECTOR_HDR + (uint32_t)i * RIDE_LOG_RECORD_SIZE;
+}
+
+static uint8_t ride_sector_prev(uint8_t s)
+{
+    return (uint8_t)((s + RIDE_SECTOR_COUNT - 1u) % RIDE_SECTOR_COUNT);
+}
+
+static uint8_t ride_sector_next(uint8_t s)
+{
+    return (uint8_t)((s + 1u) % RIDE_SECTOR_COUNT);
+}
+
+static uint16_t ride_crc16(const uint8_t *buf, uint32_t len)
+{
+    return (uint16_t)(crc32_compute(buf, len) & 0xFFFFu);
+}
+
+static uint8_t is_erased(const uint8_t *buf, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        if (buf[i] != 0xFFu)
+            return 0;
+    }
+    return 1;
+}
+
+/* flash_jobs copies programs up to FLASH_JOBS_INLINE_MAX, so the record
+ * buffer can live on the stack. */
+static void ride_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    while (len)
+    {
+        uint32_t n = len > FLASH_JOBS_INLINE_MAX ? FLASH_JOBS_INLINE_MAX : len;
+        flash_jobs_program(addr, data, n);
+        addr += n;
+        data += n;
+        len -= n;
+    }
+}
+
+static void ride_state_init(void)
+{
+    for (uint8_t s = 0; s < RIDE_SECTOR_COUNT; ++s)
+    {
+        g_ride_log.sec[s].valid = 0;
+        g_ride_log.sec[s].count = 0;
+    }
+    g_ride_log.cur = 0;
+    g_ride_log.first = 0;
+    g_ride_log.used = 0;
+    g_ride_log.next_seq = 1;
+}
+
+void ride_log_reset(void)
+{
+    flash_jobs_erase_region(RIDE_LOG_STORAGE_BASE, RIDE_LOG_STORAGE_BYTES);
+    ride_state_init();
+}
+
+static uint8_t ride_sector_read(uint8_t s, ride_sector_t *out)
+{
+    uint8_t h[RIDE_SECTOR_HDR];
+    spi_flash_read(ride_sector_addr(s), h, sizeof(h));
+    out->valid = 0;
+    if (is_erased(h, sizeof(h)))
+        return 1;
+    if (load_be32(&h[0]) != RIDE_SECTOR_MAGIC || load_be16(&h[12]) != ride_crc16(h, 12u) ||
+        load_be16(&h[8]) != RIDE_LOG_VERSION || load_be16(&h[10]) != RIDE_LOG_RECORD_SIZE)
+        return 0;
+    uint16_t count = load_be16(&h[14]);
+    if (count != RIDE_COUNT_OPEN && count > RIDE_LOG_SECTOR_RECORDS)
+        return 0;
+    out->seq = load_be32(&h[4]);
+    out->count = count;
+    out->valid = 1;
+    return 1;
+}
+
+/* Records are appended contiguously, so the first blank slot is the head. */
+static uint16_t ride_sector_find_head(uint8_t s)
+{
+    uint8_t buf[4];
+    uint16_t lo = 0;
+    uint16_t hi = RIDE_LOG_SECTOR_RECORDS;
+    while (lo < hi)
+    {
+        uint16_t mid = (uint16_t)((lo + hi) / 2u);
+        spi_flash_read(ride_record_addr(s, mid), buf, sizeof(buf));
+        if (is_erased(buf, sizeof(buf)))
+            hi = mid;
+        else
+            lo = (uint16_t)(mid + 1u);
+    }
+    return lo;
+}
+
+void ride_log_load(void)
+{
+    ride_state_init();
+
+    uint8_t newest = 0xFFu;
+    for (uint8_t s = 0; s < RIDE_SECTOR_COUNT; ++s)
+    {
+        if (!ride_sector_read(s, &g_ride_log.sec[s]))
+        {
+            /* Corrupt header or another format: start fresh so appends succeed. */
+            ride_log_reset();
+            return;
+        }
+        if (g_ride_log.sec[s].valid &&
+            (newest == 0xFFu || (int32_t)(g_ride_log.sec[s].seq - g_ride_log.sec[newest].seq) > 0))
+            newest = s;
+    }
+    if (newest == 0xFFu)
+        return;
+
+    ride_sector_t *cur = &g_ride_log.sec[newest];
+    if (cur->count == RIDE_COUNT_OPEN)
+        cur->count = ride_sector_find_head(newest);
+    g_ride_log.cur = newest;
+    g_ride_log.first = newest;
+    g_ride_log.used = 1;
+
+    /* Walk back while each older sector ends right where the next begins. */
+    uint8_t s = newest;
+    uint32_t want = cur->seq;
+    for (uint8_t k = 1; k < RIDE_SECTOR_COUNT; ++k)
+    {
+        s = ride_sector_prev(s);
+        ride_sector_t *sec = &g_ride_log.sec[s];
+        if (!sec->valid || sec->seq + RIDE_LOG_SECTOR_RECORDS != want)
+            break;
+        sec->count = RIDE_LOG_SECTOR_RECORDS;
+        want = sec->seq;
+        g_ride_log.first = s;
+        g_ride_log.used++;
+    }
+    /* Anything outside the chain is stale and gets recycled as the ring advances. */
+    for (s = 0; s < RIDE_SECTOR_COUNT; ++s)
+    {
+        if ((uint8_t)((s + RIDE_SECTOR_COUNT - g_ride_log.first) % RIDE_SECTOR_COUNT) >= g_ride_log.used)
+            g_ride_log.sec[s].valid = 0;
+    }
+    g_ride_log.next_seq = cur->seq + cur->count;
+}
+
+static void ride_sector_open(uint8_t s)
+{
+    uint8_t h[RIDE_SECTOR_HDR - 2u];
+    store_be32(&h[0], RIDE_SECTOR_MAGIC);
+    store_be32(&h[4], g_ride_log.next_seq);
+    store_be16(&h[8], RIDE_LOG_VERSION);
+    store_be16(&h[10], RIDE_LOG_RECORD_SIZE);
+    store_be16(&h[12], ride_crc16(h, 12u));
+    flash_jobs_program(ride_sector_addr(s), h, sizeof(h));
+    g_ride_log.sec[s].seq = g_ride_log.next_seq;
+    g_ride_log.sec[s].count = 0;
+    g_ride_log.sec[s].valid = 1;
+    if (g_ride_log.used == 0u)
+        g_ride_log.first = s;
+    g_ride_log.used++;
+}
+
+void ride_log_append(const uint8_t *payload)
+{
+    if (!payload)
+        return;
+    uint8_t cur = g_ride_log.cur;
+    if (g_ride_log.sec[cur].valid && g_ride_log.sec[cur].count >= RIDE_LOG_SECTOR_RECORDS)
+    {
+        /* Seal the full sector; recycle the oldest one when the ring is full. */
+        uint8_t cnt[2];
+        store_be16(cnt, RIDE_LOG_SECTOR_RECORDS);
+        flash_jobs_program(ride_sector_addr(cur) + 14u, cnt, sizeof(cnt));
+        cur = ride_sector_next(cur);
+        if (g_ride_log.sec[cur].valid)
+        {
+            g_ride_log.first = ride_sector_next(cur);
+            g_ride_log.used--;
+        }
+        flash_jobs_erase(ride_sector_addr(cur));
+        g_ride_log.sec[cur].valid = 0;
+        g_ride_log.cur = cur;
+    }
+    if (!g_ride_log.sec[cur].valid)
+        ride_sector_open(cur);
+
+    uint8_t rec[RIDE_LOG_RECORD_SIZE];
+    store_be32(&rec[0], g_ride_log.next_seq);
+    for (uint8_t i = 0; i < RIDE_LOG_PAYLOAD_SIZE; ++i)
+        rec[4u + i] = payload[i];
+    store_be16(&rec[60], 0u);
+    store_be16(&rec[62], ride_crc16(rec, RIDE_LOG_RECORD_SIZE - 2u));
+    ride_program(ride_record_addr(cur, g_ride_log.sec[cur].count), rec, sizeof(rec));
+    g_ride_log.sec[cur].count++;
+    g_ride_log.next_seq++;
+}
+
+static uint16_t ride_count(void)
+{
+    if (g_ride_log.used == 0u)
+        return 0;
+    return (uint16_t)((g_ride_log.used - 1u) * RIDE_LOG_SECTOR_RECORDS +
+                      g_ride_log.sec[g_ride_log.cur].count);
+}
+
+void ride_log_get_info(ride_log_info_t *out)
+{
+    if (!out)
+        return;
+    out->count = ride_count();
+    out->next_seq = g_ride_log.next_seq;
+}
+
+/* Maps a logical index (0 = oldest) to its record address. */
+static uint8_t ride_locate(uint32_t idx, uint32_t *addr)
+{
+    if (idx >= ride_count())
+        return 0;
+    uint8_t s = (uint8_t)((g_ride_log.first + idx / RIDE_LOG_SECTOR_RECORDS) % RIDE_SECTOR_COUNT);
+    *addr = ride_record_addr(s, (uint16_t)(idx % RIDE_LOG_SECTOR_RECORDS));
+    return 1;
+}
+
+uint8_t ride_log_copy(uint16_t offset, uint8_t max_records, uint8_t *out)
+{
+    if (!out || max_records == 0)
+        return 0;
+    /* Appended records may still be queued. */
+    flash_jobs_flush();
+    uint8_t n = 0;
+    uint32_t addr;
+    while (n < max_records && ride_locate((uint32_t)offset + n, &addr))
+    {
+        spi_flash_read(addr, &out[(size_t)n * RIDE_LOG_RECORD_SIZE], RIDE_LOG_RECORD_SIZE);
+        n++;
+    }
+    return n;
+}
+
+int ride_log_read_recent(uint16_t back, uint8_t *payload, uint32_t *seq)
+{
+    uint16_t count = ride_count();
+    if (!payload || back == 0u || back > count)
+        return 0;
+    uint8_t rec[RIDE_LOG_RECORD_SIZE];
+    if (ride_log_copy((uint16_t)(count - back), 1u, rec) != 1u ||
+        load_be16(&rec[62]) != ride_crc16(rec, RIDE_LOG_RECORD_SIZE - 2u))
+        return 0;
+    for (uint8_t i = 0; i < RIDE_LOG_PAYLOAD_SIZE; ++i)
+        payload[i] = rec[4u + i];
+    if (seq)
+        *seq = load_be32(&rec[0]);
+    return 1;
+}
@@ -0,0 +1,43 @@
+#ifndef OPEN_FIRMWARE_STORAGE_RIDE_LOG_H
+#define OPEN_FIRMWARE_STORAGE_RIDE_LOG_H
+
+#include <stdint.h>
+
+/*
+ * Ride history: one fixed record per finished ride in a ring of indexed
+ * 4 KB sectors (the event log's layout). The RAM index is one entry per
+ * sector, so any ride is one record read away and the whole history can be
+ * pulled with a single bulk read of the region.
+ *
+ * Record (64 bytes, big-endian):
+ *   [0..3] ride seq, [4..59] payload, [60..61] reserved (0),
+ *   [62..63] crc16 over 0..61
+ * The payload is opaque here; trip.c stores its snapshot (24 bytes) followed
+ * by the ride's percentiles (32 bytes).
+ */
+#define RIDE_LOG_VERSION         1u
+#define RIDE_LOG_RECORD_SIZE     64u
+#define RIDE_LOG_PAYLOAD_SIZE    56u
+#define RIDE_LOG_SECTOR_RECORDS  63u /* after the 16-byte sector header */
+#define RIDE_LOG_CAPACITY        189u
+/* Rides still present right after the oldest sector is recycled. */
+#define RIDE_LOG_RETAINED        126u
+
+typedef struct {
+    uint16_t count;
+    uint32_t next_seq;  /* seq the next ride will get */
+} ride_log_info_t;
+
+void ride_log_load(void);
+void ride_log_reset(void);
+void ride_log_append(const uint8_t *payload);
+void ride_log_get_info(ride_log_info_t *out);
+/* Raw records from logical index `offset` (0 = oldest); returns the count copied. */
+uint8_t ride_log_copy(uint16_t offset, uint8_t max_records, uint8_t *out);
+/*
+ * Payload of the ride `back` rides ago (1 = newest). Returns 0 when there is
+ * no such ride or its record fails the CRC.
+ */
+int ride_log_read_recent(uint16_t back, uint8_t *payload, uint32_t *seq);
+
+#endif
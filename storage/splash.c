@@ -0,0 +1,97 @@
+#include "storage/splash.h"
+
+#include "storage/flash_util.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+
+#define SPLASH_DATA_BASE (SPLASH_STORAGE_BASE + SPI_FLASH_SECTOR_SIZE)
+#define SPLASH_DATA_MAX  (SPLASH_STORAGE_BYTES - SPI_FLASH_SECTOR_SIZE)
+
+static struct {
+    uint8_t loaded;
+    splash_info_t info;
+    flash_upload_t upload;
+} g_splash;
+
+static void splash_load(void)
+{
+    if (g_splash.loaded)
+        return;
+    g_splash.loaded = 1u;
+    g_splash.info.valid = 0u;
+
+    uint8_t hdr[SPLASH_HEADER_BYTES];
+    spi_flash_read(SPLASH_STORAGE_BASE, hdr, sizeof(hdr));
+    if (load_be32(&hdr[0]) != SPLASH_MAGIC || load_be16(&hdr[4]) != SPLASH_VERSION)
+        return;
+    uint16_t w = load_be16(&hdr[6]);
+    uint16_t h = load_be16(&hdr[8]);
+    if (w == 0u || h == 0u || (uint32_t)w * h * 2u > SPLASH_DATA_MAX)
+        return;
+    g_splash.info.valid = 1u;
+    g_splash.info.w = w;
+    g_splash.info.h = h;
+    g_splash.info.crc32 = load_be32(&hdr[12]);
+}
+
+int splash_image(uint32_t *addr_out, uint16_t *w_out, uint16_t *h_out)
+{
+    splash_load();
+    if (!g_splash.info.valid || g_splash.info.uploading)
+        return 0;
+    if (addr_out)
+        *addr_out = SPLASH_DATA_BASE;
+    if (w_out)
+        *w_out = g_splash.info.w;
+    if (h_out)
+        *h_out = g_splash.info.h;
+    return 1;
+}
+
+void splash_store_begin(void)
+{
+    flash_upload_begin(&g_splash.upload, SPLASH_STORAGE_BASE, SPLASH_DATA_BASE, SPLASH_DATA_MAX);
+    g_splash.loaded = 1u;
+    g_splash.info = (splash_info_t){0};
+    g_splash.info.uploading = 1u;
+}
+
+int splash_store_write(uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    if (!g_splash.info.uploading)
+        return 0;
+    return flash_upload_write(&g_splash.upload, offset, data, len);
+}
+
+int splash_store_finish(uint16_t w, uint16_t h, uint32_t crc32)
+{
+    if (!g_splash.info.uploading)
+        return 0;
+    g_splash.info.uploading = 0u;
+    if (!flash_upload_verify(&g_splash.upload, (uint32_t)w * h * 2u, crc32))
+        return 0;
+
+    uint8_t hdr[SPLASH_HEADER_BYTES];
+    store_be32(&hdr[0], SPLASH_MAGIC);
+    store_be16(&hdr[4], SPLASH_VERSION);
+    store_be16(&hdr[6], w);
+    store_be16(&hdr[8], h);
+    store_be16(&hdr[10], 0u);
+    store_be32(&hdr[12], crc32);
+    spi_flash_write(SPLASH_STORAGE_BASE, hdr, sizeof(hdr));
+
+    g_splash.info.valid = 1u;
+    g_splash.info.w = w;
+    g_splash.info.h = h;
+    g_splash.info.crc32 = crc32;
+    return 1;
+}
+
+void splash_get_info(splash_info_t *out)
+{
+    if (!out)
+        return;
+    splash_load();
+    *out = g_splash.info;
+    out->write_offset = g_splash.upload.write_offset;
+}
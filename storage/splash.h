@@ -0,0 +1,39 @@
+#ifndef OPEN_FIRMWARE_STORAGE_SPLASH_H
+#define OPEN_FIRMWARE_STORAGE_SPLASH_H
+
+#include <stdint.h>
+
+/*
+ * Boot splash: one pre-rendered RGB565 frame (normally the dashboard
+ * skeleton from the host UI simulator) that main() streams from SPI flash
+ * to the panel as soon as it is up, before the rest of init runs.
+ *
+ * Layout (SPLASH_STORAGE_BASE):
+ *   sector 0: magic[4] 'SPLS', version[2], w[2], h[2], rsvd[2], crc32[4]
+ *   sector 1+: w*h pixels, row-major, RGB565 big-endian (SPI byte order)
+ * Uploads erase the header first and rewrite it last, so an interrupted
+ * upload leaves no splash rather than a torn one.
+ */
+#define SPLASH_MAGIC        0x53504C53u /* 'SPLS' */
+#define SPLASH_VERSION      1u
+#define SPLASH_HEADER_BYTES 16u
+
+typedef struct {
+    uint8_t valid;
+    uint8_t uploading;
+    uint16_t w;
+    uint16_t h;
+    uint32_t crc32;
+    uint32_t write_offset;
+} splash_info_t;
+
+/* Returns 1 and the pixel address when a complete frame is stored. */
+int splash_image(uint32_t *addr_out, uint16_t *w_out, uint16_t *h_out);
+
+/* Bulk upload: begin, sequential writes, finish (checks size and CRC). */
+void splash_store_begin(void);
+int splash_store_write(uint32_t offset, const uint8_t *data, uint32_t len);
+int splash_store_finish(uint16_t w, uint16_t h, uint32_t crc32);
+void splash_get_info(splash_info_t *out);
+
+#endif
@@ -0,0 +1,146 @@
+#include "storage/ui_assets.h"
+
+#include "storage/flash_util.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+
+#define UI_ASSET_DATA_BASE (UI_ASSET_STORAGE_BASE + SPI_FLASH_SECTOR_SIZE)
+#define UI_ASSET_DATA_MAX  (UI_ASSET_STORAGE_BYTES - SPI_FLASH_SECTOR_SIZE)
+
+static struct {
+    uint8_t loaded;
+    ui_assets_info_t info;
+    flash_upload_t upload;
+    ui_asset_t entries[UI_ASSET_MAX];
+} g_assets;
+
+/* Reads and checks the index of a `bytes` long body; any bad entry rejects
+ * the whole pack. Returns the entry count, 0 if the pack is unusable. */
+static uint16_t index_load(uint32_t bytes)
+{
+    if (bytes < UI_ASSET_INDEX_BYTES || bytes > UI_ASSET_DATA_MAX)
+        return 0u;
+    uint8_t raw[UI_ASSET_INDEX_BYTES + UI_ASSET_MAX * UI_ASSET_ENTRY_BYTES];
+    spi_flash_read(UI_ASSET_DATA_BASE, raw, UI_ASSET_INDEX_BYTES);
+    uint16_t count = load_be16(&raw[0]);
+    if (count == 0u || count > UI_ASSET_MAX)
+        return 0u;
+    uint32_t index_bytes = UI_ASSET_INDEX_BYTES + (uint32_t)count * UI_ASSET_ENTRY_BYTES;
+    if (bytes < index_bytes)
+        return 0u;
+    spi_flash_read(UI_ASSET_DATA_BASE, raw, index_bytes);
+    for (uint16_t i = 0; i < count; ++i)
+    {
+        const uint8_t *e = &raw[UI_ASSET_INDEX_BYTES + (uint32_t)i * UI_ASSET_ENTRY_BYTES];
+        ui_asset_t a;
+        a.id = load_be32(&e[0]);
+        a.w = load_be16(&e[4]);
+        a.h = load_be16(&e[6]);
+        a.fmt = e[8];
+        a.len = load_be16(&e[10]);
+        uint32_t off = load_be32(&e[12]);
+        if (a.w == 0u || a.h == 0u || a.len == 0u)
+            return 0u;
+        if (off < index_bytes || off > bytes || a.len > bytes - off)
+            return 0u;
+        if (a.fmt == UI_ASSET_FMT_RGB565)
+        {
+            if ((uint32_t)a.w * a.h * 2u != a.len)
+                return 0u;
+        }
+        else if (a.fmt != UI_ASSET_FMT_A4_RLE)
+        {
+            return 0u;
+        }
+        a.addr = UI_ASSET_DATA_BASE + off;
+        g_assets.entries[i] = a;
+    }
+    return count;
+}
+
+static void assets_load(void)
+{
+    if (g_assets.loaded)
+        return;
+    g_assets.loaded = 1u;
+    g_assets.info.valid = 0u;
+
+    uint8_t hdr[UI_ASSET_HEADER_BYTES];
+    spi_flash_read(UI_ASSET_STORAGE_BASE, hdr, sizeof(hdr));
+    if (load_be32(&hdr[0]) != UI_ASSET_MAGIC || load_be16(&hdr[4]) != UI_ASSET_VERSION)
+        return;
+    uint32_t bytes = load_be32(&hdr[8]);
+    uint16_t count = index_load(bytes);
+    if (count == 0u || count != load_be16(&hdr[6]))
+        return;
+    g_assets.info.valid = 1u;
+    g_assets.info.count = count;
+    g_assets.info.bytes = bytes;
+    g_assets.info.crc32 = load_be32(&hdr[12]);
+}
+
+int ui_asset_find(uint32_t id, ui_asset_t *out)
+{
+    assets_load();
+    if (!g_assets.info.valid || g_assets.info.uploading)
+        return 0;
+    for (uint16_t i = 0; i < g_assets.info.count; ++i)
+    {
+        if (g_assets.entries[i].id != id)
+            continue;
+        if (out)
+            *out = g_assets.entries[i];
+        return 1;
+    }
+    return 0;
+}
+
+void ui_assets_store_begin(void)
+{
+    flash_upload_begin(&g_assets.upload, UI_ASSET_STORAGE_BASE, UI_ASSET_DATA_BASE, UI_ASSET_DATA_MAX);
+    g_assets.loaded = 1u;
+    g_assets.info = (ui_assets_info_t){0};
+    g_assets.info.uploading = 1u;
+}
+
+int ui_assets_store_write(uint32_t offset, const uint8_t *data, uint32_t len)
+{
+    if (!g_assets.info.uploading)
+        return 0;
+    return flash_upload_write(&g_assets.upload, offset, data, len);
+}
+
+int ui_assets_store_finish(uint32_t bytes, uint32_t crc32)
+{
+    if (!g_assets.info.uploading)
+        return 0;
+    g_assets.info.uploading = 0u;
+    if (!flash_upload_verify(&g_assets.upload, bytes, crc32))
+        return 0;
+    uint16_t count = index_load(bytes);
+    if (count == 0u)
+        return 0;
+
+    uint8_t hdr[UI_ASSET_HEADER_BYTES];
+    store_be32(&hdr[0], UI_ASSET_MAGIC);
+    store_be16(&hdr[4], UI_ASSET_VERSION);
+    store_be16(&hdr[6], count);
+    store_be32(&hdr[8], bytes);
+    store_be32(&hdr[12], crc32);
+    spi_flash_write(UI_ASSET_STORAGE_BASE, hdr, sizeof(hdr));
+
+    g_assets.info.valid = 1u;
+    g_assets.info.count = count;
+    g_assets.info.bytes = bytes;
+    g_assets.info.crc32 = crc32;
+    return 1;
+}
+
+void ui_assets_get_info(ui_assets_info_t *out)
+{
+    if (!out)
+        return;
+    assets_load();
+    *out = g_assets.info;
+    out->write_offset = g_assets.upload.write_offset;
+}
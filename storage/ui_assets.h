@@ -0,0 +1,60 @@
+#ifndef OPEN_FIRMWARE_STORAGE_UI_ASSETS_H
+#define OPEN_FIRMWARE_STORAGE_UI_ASSETS_H
+
+#include <stdint.h>
+
+/*
+ * UI asset pack: icon sprites kept in SPI flash rather than in the image,
+ * built by scripts/pack_ui_icons.py --pack and drawn by ui_draw_icon() in
+ * place of its primitive fallback.
+ *
+ * Layout (UI_ASSET_STORAGE_BASE):
+ *   sector 0: magic[4] 'UIAP', version[2], count[2], bytes[4], crc32[4]
+ *   sector 1+: pack body (bytes long, crc32 over it):
+ *     count[2], rsvd[2]
+ *     count x { id[4], w[2], h[2], fmt[1], rsvd[1], len[2], offset[4] }
+ *     then the sprite data; offset is from the body start
+ * Header and index fields are big-endian. fmt is UI_ASSET_FMT_*: RGB565
+ * data is w*h pre-tinted pixels in SPI byte order (len = w*h*2), A4_RLE is
+ * the packer's row stream. Uploads erase the header first and rewrite it
+ * last, as for the splash, so an interrupted upload leaves no pack and the
+ * UI keeps drawing its built-in icons.
+ */
+#define UI_ASSET_MAGIC        0x55494150u /* 'UIAP' */
+#define UI_ASSET_VERSION      1u
+#define UI_ASSET_HEADER_BYTES 16u
+#define UI_ASSET_INDEX_BYTES  4u
+#define UI_ASSET_ENTRY_BYTES  16u
+#define UI_ASSET_MAX          32u
+
+#define UI_ASSET_FMT_RGB565 1u
+#define UI_ASSET_FMT_A4_RLE 2u
+
+typedef struct {
+    uint32_t id;
+    uint32_t addr; /* absolute SPI flash address of the data */
+    uint16_t w;
+    uint16_t h;
+    uint16_t len;
+    uint8_t fmt;
+} ui_asset_t;
+
+typedef struct {
+    uint8_t valid;
+    uint8_t uploading;
+    uint16_t count;
+    uint32_t bytes;
+    uint32_t crc32;
+    uint32_t write_offset;
+} ui_assets_info_t;
+
+/* Returns 1 and the entry when a committed pack holds `id`. */
+int ui_asset_find(uint32_t id, ui_asset_t *out);
+
+/* Bulk upload: begin, sequential writes, finish (checks size, CRC, index). */
+void ui_assets_store_begin(void);
+int ui_assets_store_write(uint32_t offset, const uint8_t *data, uint32_t len);
+int ui_assets_store_finish(uint32_t bytes, uint32_t crc32);
+void ui_assets_get_info(ui_assets_info_t *out);
+
+#endif
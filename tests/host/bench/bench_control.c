@@ -0,0 +1,292 @@
+/*
+ * Control pipeline benchmark and bit-exactness harness.
+ *
+ * Drives a deterministic synthetic ride (speed, cadence, torque, throttle,
+ * brake, pack SOC/voltage/current, controller temperature, plus periodic
+ * profile/gear/drive-mode changes) through recompute_outputs(), the same
+ * path the firmware runs per control tick. Every tick's outputs are folded
+ * into an FNV-1a hash, so an optimisation of a LUT, cache or governor can
+ * be shown to be bit-identical (same hash) and faster (lower ns/iter).
+ *
+ *   bench_control [vectors]
+ *
+ * The hash over the first BENCH_REF_VECTORS ticks is checked against
+ * BENCH_REF_HASH; a change that is meant to alter control behaviour must
+ * update it in the same commit.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/time.h>   /* <time.h> resolves to platform/time.h here */
+
+#include "src/motor/app_data.h"
+#include "src/control/control.h"
+#include "src/power/power.h"
+#include "src/config/config.h"
+#include "src/profiles/profiles.h"
+
+#define BENCH_TICK_MS        20u
+#define BENCH_SCENE_TICKS    5000u      /* 100 s between scenario changes */
+#define BENCH_DEFAULT_VECTORS 2000000u
+#define BENCH_REF_VECTORS    200000u
+#define BENCH_REF_HASH       0xB01C3DA4u
+
+/* Firmware globals owned by main.c, input.c and the motor layer. */
+volatile uint32_t g_ms;
+config_t g_config_active;
+vgear_table_t g_vgears;
+cadence_bias_t g_cadence_bias;
+uint8_t g_active_vgear;
+uint8_t g_active_profile_id;
+uint8_t g_hw_caps = CAP_FLAG_WALK;
+uint8_t g_input_caps;
+uint8_t g_button_short_press;
+
+static uint32_t s_requests;
+
+bool motor_cmd_link_fault_active(void)
+{
+    return false;
+}
+
+void shengyi_request_update(uint8_t force)
+{
+    (void)force;
+    s_requests++;
+}
+
+void event_log_append(uint8_t type, uint8_t flags)
+{
+    (void)type;
+    (void)flags;
+}
+
+/* -------------------------------------------------------------
+ * Synthetic rider and plant (integer only, so the hash is portable)
+ * ------------------------------------------------------------- */
+typedef struct {
+    uint32_t rng;
+    int32_t speed_dmph;
+    int32_t target_dmph;
+    int32_t cadence_rpm;
+    int32_t charge_mAs;         /* 14 Ah pack */
+    int64_t temp_q16;           /* controller temperature, dC << 16 */
+    uint32_t brake_ticks;
+    uint32_t button_ticks;
+    uint8_t button_mask;
+} bench_ride_t;
+
+#define BENCH_CAP_MAS   (14000 * 3600)
+#define BENCH_AMB_DC    250
+#define BENCH_R_MOHM    150
+#define BENCH_TAU_TICKS 10000           /* 200 s */
+
+static uint32_t rng_next(bench_ride_t *r)
+{
+    uint32_t x = r->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    r->rng = x;
+    return x;
+}
+
+static uint32_t rng_below(bench_ride_t *r, uint32_t n)
+{
+    return rng_next(r) % n;
+}
+
+static void bench_scene(bench_ride_t *r)
+{
+    uint8_t prev_drive = g_config_active.drive_mode;
+    uint32_t pick = rng_below(r, 16u);
+
+    g_active_profile_id = (uint8_t)rng_below(r, PROFILE_COUNT);
+    g_config_active.mode = (pick & 1u) ? MODE_PRIVATE : MODE_STREET;
+    g_config_active.cap_current_dA = (g_config_active.mode == MODE_STREET) ? STREET_MAX_CURRENT_DA : 300u;
+    g_config_active.cap_speed_dmph = (g_config_active.mode == MODE_STREET) ? STREET_MAX_SPEED_DMPH : 0u;
+    g_config_active.flags = (uint8_t)(CAP_FLAG_WALK | CAP_FLAG_REGEN |
+                                      ((pick & 2u) ? CFG_FLAG_ADAPT_EFFORT : 0u) |
+                                      ((pick & 4u) ? CFG_FLAG_ADAPT_ECO : 0u));
+    g_config_active.drive_mode = (pick < 10u) ? DRIVE_MODE_AUTO :
+                                 (pick < 12u) ? DRIVE_MODE_SPORT :
+                                 (pick < 14u) ? DRIVE_MODE_MANUAL_CURRENT : DRIVE_MODE_MANUAL_POWER;
+    if (g_config_active.drive_mode != prev_drive)
+        drive_apply_config();
+    /* Each scene is a fresh ride: no cruise resume carried over. */
+    cruise_reset();
+
+    if (rng_below(r, 4u) == 0u)
+        vgear_set_shape((g_vgears.shape == VGEAR_SHAPE_EXP) ? VGEAR_SHAPE_LINEAR : VGEAR_SHAPE_EXP);
+    g_active_vgear = (uint8_t)(1u + rng_below(r, g_vgears.count));
+    g_cadence_bias.enabled = (uint8_t)(rng_below(r, 2u));
+    g_cadence_bias.target_rpm = (uint16_t)(70u + rng_below(r, 20u));
+
+    /* Most rides report everything; some controllers omit current or temperature. */
+    static const uint8_t k_caps[] = {
+        INPUT_CAP_BATT_V | INPUT_CAP_BATT_I | INPUT_CAP_TEMP,
+        INPUT_CAP_BATT_V | INPUT_CAP_BATT_I | INPUT_CAP_TEMP,
+        INPUT_CAP_BATT_V | INPUT_CAP_BATT_I,
+        INPUT_CAP_BATT_V,
+    };
+    g_input_caps = k_caps[rng_below(r, sizeof(k_caps))];
+    r->target_dmph = (int32_t)(60u + rng_below(r, 240u));
+}
+
+static void bench_inputs(bench_ride_t *r)
+{
+    uint32_t n = rng_next(r);
+
+    if ((n & 0xFFu) == 0u)
+        r->target_dmph = (int32_t)(rng_below(r, 300u));
+    int32_t err = r->target_dmph - r->speed_dmph;
+    r->speed_dmph += (err > 2) ? 2 : (err < -2) ? -2 : err;
+    r->speed_dmph += (int32_t)((n >> 8) & 3u) - 1;
+    if (r->speed_dmph < 0)
+        r->speed_dmph = 0;
+
+    /* Cadence follows speed with noise; coasting drops it to zero. */
+    int32_t cad = (r->target_dmph == 0) ? 0 : 40 + r->speed_dmph / 4 + (int32_t)((n >> 12) & 15u) - 8;
+    r->cadence_rpm += (cad - r->cadence_rpm) / 4;
+    if (r->cadence_rpm < 0)
+        r->cadence_rpm = 0;
+
+    if (r->brake_ticks)
+        r->brake_ticks--;
+    else if (((n >> 16) & 0xFFFu) == 0u)
+        r->brake_ticks = 10u + ((n >> 26) & 31u);
+    if (r->button_ticks)
+        r->button_ticks--;
+    g_button_short_press = 0u;
+    if (((n >> 4) & 0x7FFu) == 1u)
+    {
+        g_button_short_press = CRUISE_BUTTON_MASK;
+        r->button_ticks = 3u;
+        /* Half the presses hold speed-select: speed cruise over power cruise. */
+        r->button_mask = (uint8_t)(CRUISE_BUTTON_MASK | (rng_below(r, 2u) ? CRUISE_SPEED_SELECT_MASK : 0u));
+    }
+
+    int32_t i_dA = (int32_t)g_outputs.cmd_current_dA;
+    r->charge_mAs -= i_dA * 100 * (int32_t)BENCH_TICK_MS / 1000;
+    if (r->charge_mAs < 0)
+        r->charge_mAs = BENCH_CAP_MAS;  /* swap in a fresh pack */
+    int32_t soc = (int32_t)(((int64_t)r->charge_mAs * 100) / BENCH_CAP_MAS);
+    int32_t ocv_dV = 330 + (90 * soc) / 100;
+
+    /* First-order controller heating: settles at ambient + 1.2 dC per A^2. */
+    int64_t heat_dC = BENCH_AMB_DC + ((int64_t)i_dA * i_dA * 12) / 1000;
+    r->temp_q16 += ((heat_dC << 16) - r->temp_q16) / BENCH_TAU_TICKS;
+
+    g_inputs.speed_dmph = (uint16_t)r->speed_dmph;
+    g_inputs.cadence_rpm = (uint16_t)r->cadence_rpm;
+    g_inputs.torque_raw = (uint16_t)((r->cadence_rpm ? 600u : 0u) + ((n >> 20) & 0x7FFu));
+    g_inputs.throttle_pct = (uint8_t)((((n >> 28) & 7u) == 0u) ? ((n >> 3) & 63u) : 0u);
+    g_inputs.brake = r->brake_ticks ? 1u : 0u;
+    g_inputs.buttons = (uint8_t)(r->button_ticks ? r->button_mask : 0u);
+    g_inputs.battery_dA = (int16_t)i_dA;
+    g_inputs.battery_dV = (int16_t)(ocv_dV - (i_dA * BENCH_R_MOHM) / 1000);
+    g_inputs.ctrl_temp_dC = (int16_t)(r->temp_q16 >> 16);
+    g_inputs.power_w = (uint16_t)(((uint32_t)g_inputs.battery_dV * (uint32_t)i_dA) / 100u);
+    g_inputs.last_ms = g_ms;
+}
+
+static uint32_t fnv_u16(uint32_t h, uint16_t v)
+{
+    h = (h ^ (v & 0xFFu)) * 16777619u;
+    return (h ^ (uint32_t)(v >> 8)) * 16777619u;
+}
+
+static uint32_t hash_outputs(uint32_t h)
+{
+    h = fnv_u16(h, (uint16_t)(g_outputs.assist_mode | ((uint16_t)g_outputs.cruise_state << 8)));
+    h = fnv_u16(h, (uint16_t)(g_outputs.profile_id | ((uint16_t)g_outputs.virtual_gear << 8)));
+    h = fnv_u16(h, g_outputs.cmd_power_w);
+    h = fnv_u16(h, g_outputs.cmd_current_dA);
+    h = fnv_u16(h, g_power_policy.p_final_w);
+    h = fnv_u16(h, g_power_policy.limit_reason);
+    return h;
+}
+
+static void bench_reset(bench_ride_t *r)
+{
+    *r = (bench_ride_t){ .rng = 0x2545F491u, .charge_mAs = BENCH_CAP_MAS * 9 / 10,
+                         .temp_q16 = (int64_t)BENCH_AMB_DC << 16 };
+    g_ms = 1000u;
+    g_inputs = (debug_inputs_t){0};
+    g_outputs = (debug_outputs_t){0};
+    g_config_active = (config_t){0};
+    g_config_active.soft_start_ramp_wps = 400u;
+    g_config_active.soft_start_deadband_w = 20u;
+    g_config_active.soft_start_kick_w = 150u;
+    g_config_active.manual_current_dA = 180u;
+    g_config_active.manual_power_w = 400u;
+    g_config_active.boost_budget_ms = BOOST_BUDGET_DEFAULT_MS;
+    g_config_active.boost_cooldown_ms = BOOST_COOLDOWN_DEFAULT_MS;
+    g_config_active.boost_threshold_dA = BOOST_THRESHOLD_DEFAULT_DA;
+    g_config_active.boost_gain_q15 = BOOST_GAIN_DEFAULT_Q15;
+    profiles_defaults();
+    vgear_defaults();
+    cadence_bias_defaults();
+    walk_reset();
+    regen_reset();
+    cruise_reset();
+    drive_apply_config();
+    soft_start_reset();
+    power_policy_reset();
+    adaptive_reset();
+}
+
+static double now_ns(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec * 1e9 + (double)tv.tv_usec * 1e3;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t vectors = BENCH_DEFAULT_VECTORS;
+    if (argc > 1)
+        vectors = (uint32_t)strtoul(argv[1], NULL, 0);
+    if (vectors < BENCH_REF_VECTORS)
+        vectors = BENCH_REF_VECTORS;
+
+    bench_ride_t ride;
+    bench_reset(&ride);
+
+    uint32_t hash = 2166136261u;
+    uint32_t ref_hash = 0u;
+    double t0 = now_ns();
+    for (uint32_t i = 0; i < vectors; ++i)
+    {
+        if ((i % BENCH_SCENE_TICKS) == 0u)
+            bench_scene(&ride);
+        g_ms += BENCH_TICK_MS;
+        bench_inputs(&ride);
+        recompute_outputs();
+        hash = hash_outputs(hash);
+        if (i + 1u == BENCH_REF_VECTORS)
+            ref_hash = hash;
+    }
+    double ns = (now_ns() - t0) / (double)vectors;
+
+    printf("\nControl Pipeline Benchmark\n");
+    printf("==========================\n\n");
+    printf("  vectors        %u\n", vectors);
+    printf("  ns/iter        %.1f\n", ns);
+    printf("  hash           0x%08X\n", hash);
+    printf("  ref hash       0x%08X (%u vectors, expect 0x%08X)\n",
+           ref_hash, BENCH_REF_VECTORS, BENCH_REF_HASH);
+    printf("  motor requests %u\n\n", s_requests);
+
+    if (ref_hash != BENCH_REF_HASH)
+    {
+        printf("FAIL: control outputs changed\n");
+        return 1;
+    }
+    return 0;
+}
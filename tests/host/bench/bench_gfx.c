@@ -0,0 +1,307 @@
+/*
+ * Graphics primitive and screen render benchmark.
+ *
+ * Times each gfx primitive the UI uses (round rects, dithered round rects,
+ * ring arc/gauge, 7-segment digits, bitmap text) against counting backends
+ * that also write a 240x320 framebuffer, then every registered screen's
+ * full render through ui_tick(). Per case it reports ns per call, backend
+ * operations, pixels touched and LCD window sets; screens take those from
+ * the pixel sink's bus cost model, which mirrors gfx/ui_lcd.c. Output is a
+ * single JSON document on stdout so runs can be diffed across commits.
+ *
+ *   bench_gfx [iterations]
+ *
+ * Counts are deterministic; only ns_per_call depends on the host.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>   /* <time.h> resolves to platform/time.h here */
+
+#include "ui.h"
+#include "ui_display.h"
+#include "ui_draw_common.h"
+#include "ui_font_bitmap.h"
+#include "ui_pixel_sink.h"
+
+#define BENCH_DEFAULT_ITERS 2000u
+#define BENCH_PAGE_DIV 20u         /* full screens run iterations / 20 times */
+
+typedef struct {
+    uint32_t ops;
+    uint32_t pixels;
+    uint32_t windows;
+} bench_counts_t;
+
+static uint16_t s_fb[DISP_W * DISP_H];
+static bench_counts_t s_counts;
+static uint8_t s_first = 1;
+
+static void fb_run(int x, int y, int w, uint16_t color)
+{
+    if (y < 0 || y >= (int)DISP_H)
+        return;
+    for (int i = 0; i < w; ++i)
+    {
+        int px = x + i;
+        if (px >= 0 && px < (int)DISP_W)
+            s_fb[(size_t)y * DISP_W + (size_t)px] = color;
+    }
+}
+
+/* Rect backend: every fill is one window + w*h pixels, as ui_lcd_fill_rect. */
+static void rect_fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    s_counts.ops++;
+    s_counts.windows++;
+    s_counts.pixels += (uint32_t)w * h;
+    for (uint16_t yy = 0; yy < h; ++yy)
+        fb_run((int)x, (int)y + yy, (int)w, color);
+}
+
+static void rect_fill_dither(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                             uint16_t c0, uint16_t c1, uint8_t level)
+{
+    s_counts.ops++;
+    s_counts.windows++;
+    s_counts.pixels += (uint32_t)w * h;
+    for (uint16_t yy = 0; yy < h; ++yy)
+        for (uint16_t xx = 0; xx < w; ++xx)
+            fb_run((int)x + xx, (int)y + yy, 1,
+                   ui_draw_dither_pick((uint16_t)(x + xx), (uint16_t)(y + yy), c0, c1, level));
+}
+
+static void ops_fill_hline(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t color)
+{
+    (void)ctx;
+    rect_fill(x, y, w, 1u, color);
+}
+
+static void ops_fill_hline_dither(void *ctx, uint16_t x, uint16_t y, uint16_t w,
+                                  uint16_t c0, uint16_t c1, uint8_t level)
+{
+    (void)ctx;
+    rect_fill_dither(x, y, w, 1u, c0, c1, level);
+}
+
+static void ops_fill_rect(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    (void)ctx;
+    rect_fill(x, y, w, h, color);
+}
+
+static void ops_fill_rect_dither(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                                 uint16_t c0, uint16_t c1, uint8_t level)
+{
+    (void)ctx;
+    rect_fill_dither(x, y, w, h, c0, c1, level);
+}
+
+static const ui_draw_rect_ops_t k_rect_ops = {
+    .fill_hline = ops_fill_hline,
+    .fill_hline_dither = ops_fill_hline_dither,
+    .fill_rect = ops_fill_rect,
+    .fill_rect_dither = ops_fill_rect_dither,
+};
+
+static void px_begin_window(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    (void)ctx;
+    (void)x;
+    (void)y;
+    (void)w;
+    (void)h;
+    s_counts.windows++;
+}
+
+static void px_write_pixel(void *ctx, uint16_t x, uint16_t y, uint16_t color)
+{
+    (void)ctx;
+    s_counts.ops++;
+    s_counts.pixels++;
+    fb_run((int)x, (int)y, 1, color);
+}
+
+static void px_write_run(void *ctx, uint16_t x, uint16_t y, uint16_t n, uint16_t color)
+{
+    (void)ctx;
+    s_counts.ops++;
+    s_counts.pixels += n;
+    fb_run((int)x, (int)y, (int)n, color);
+}
+
+static const ui_draw_pixel_writer_t k_pixel_writer = {
+    .begin_window = px_begin_window,
+    .write_pixel = px_write_pixel,
+    .write_run = px_write_run,
+};
+
+/* Stroke text backend: plots are one-pixel windows, as on the LCD path. */
+static void text_plot(int x, int y, uint16_t color, void *user)
+{
+    (void)user;
+    s_counts.ops++;
+    s_counts.windows++;
+    s_counts.pixels++;
+    fb_run(x, y, 1, color);
+}
+
+static void text_rect(int x, int y, int w, int h, uint16_t color, void *user)
+{
+    (void)user;
+    if (x < 0 || y < 0 || w <= 0 || h <= 0)
+        return;
+    rect_fill((uint16_t)x, (uint16_t)y, (uint16_t)w, (uint16_t)h, color);
+}
+
+static double now_ns(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec * 1e9 + (double)tv.tv_usec * 1e3;
+}
+
+static void emit(const char *group, const char *name, uint32_t iters, double ns,
+                 const bench_counts_t *c)
+{
+    printf("%s\n    {\"group\": \"%s\", \"name\": \"%s\", \"iterations\": %u, "
+           "\"ns_per_call\": %.1f, \"ops\": %u, \"pixels\": %u, \"windows\": %u",
+           s_first ? "" : ",", group, name, iters, ns, c->ops, c->pixels, c->windows);
+    s_first = 0;
+}
+
+typedef void (*bench_fn)(uint32_t i);
+
+/* Runs fn iters times; counts are per call (taken from the first call). */
+static void bench_prim(const char *name, bench_fn fn, uint32_t iters)
+{
+    s_counts = (bench_counts_t){0};
+    fn(0u);
+    bench_counts_t per_call = s_counts;
+    double t0 = now_ns();
+    for (uint32_t i = 0; i < iters; ++i)
+        fn(i);
+    double ns = (now_ns() - t0) / (double)iters;
+    emit("primitive", name, iters, ns, &per_call);
+    printf("}");
+}
+
+static void b_round_rect(uint32_t i)
+{
+    ui_draw_fill_round_rect(&k_rect_ops, NULL, 20, 40, 200, 60, (uint16_t)(0x39E7u + i), 10);
+}
+
+static void b_round_rect_dither(uint32_t i)
+{
+    ui_draw_fill_round_rect_dither(&k_rect_ops, NULL, 20, 40, 200, 60, 0x39E7u, (uint16_t)(0x18E3u + i), 10, 8);
+}
+
+static void b_ring_arc(uint32_t i)
+{
+    ui_draw_ring_arc_a4(&k_pixel_writer, NULL, 0, 0, DISP_W, DISP_W, 120, 120, 100, 14,
+                        -120, 240, (uint16_t)(0xFD20u + i), 0x0000u);
+}
+
+static void b_ring_gauge(uint32_t i)
+{
+    ui_draw_ring_gauge_a4(&k_pixel_writer, NULL, 0, 0, DISP_W, DISP_W, 120, 120, 100, 14,
+                          -120, 240, (uint16_t)(i % 240u), 0x07E0u, 0x2945u, 0x0000u);
+}
+
+static void b_big_digit(uint32_t i)
+{
+    ui_draw_big_digit_7seg(&k_rect_ops, NULL, 40, 60, (uint8_t)(8u - (i & 1u) * 8u), 4, 0xFFFFu);
+}
+
+static void b_text_opaque(uint32_t i)
+{
+    ui_font_bitmap_draw_text(text_plot, text_rect, NULL, 10, 200, "Speed 27.4 km/h",
+                             (uint16_t)(0xFFFFu - (i & 1u)), 0x0000u);
+}
+
+static void b_text_transparent(uint32_t i)
+{
+    ui_font_bitmap_draw_text(text_plot, text_rect, NULL, 10, 200, "Speed 27.4 km/h",
+                             (uint16_t)(0xFFFFu - (i & 1u)), 0xFFFFu);
+}
+
+static void seed_model(ui_model_t *m)
+{
+    memset(m, 0, sizeof(*m));
+    m->speed_dmph = 123;
+    m->rpm = 330;
+    m->cadence_rpm = 88;
+    m->torque_raw = 55;
+    m->assist_mode = 2;
+    m->virtual_gear = 3;
+    m->soc_pct = 77;
+    m->batt_dV = 374;
+    m->batt_dA = -12;
+    m->power_w = 420;
+    m->trip_distance_mm = 12000;
+    m->trip_energy_mwh = 3400;
+    m->trip_max_speed_dmph = 230;
+    m->trip_avg_speed_dmph = 180;
+    m->theme = UI_THEME_DAY;
+    m->profile_id = 1;
+}
+
+/* Full render of one screen: a fresh ui_state forces the full path. */
+static void bench_page(uint8_t page, uint32_t iters)
+{
+    static ui_state_t ui;
+    ui_model_t m;
+    seed_model(&m);
+    m.page = page;
+    ui_trace_t tr = {0};
+    bench_counts_t c = {0};
+
+    double t0 = now_ns();
+    for (uint32_t i = 0; i < iters; ++i)
+    {
+        ui_init(&ui);
+        ui_tick(&ui, &m, UI_TICK_MS, &tr);
+    }
+    double ns = (now_ns() - t0) / (double)iters;
+
+    ui_lcd_cost_t cost;
+    ui_pixel_sink_frame_cost(&cost, NULL);
+    c.ops = tr.draw_ops;
+    c.pixels = cost.pixels;
+    c.windows = cost.windows;
+    emit("screen", ui_page_name(page), iters, ns, &c);
+    printf(", \"page\": %u, \"lcd_est_us\": %u, \"hash\": \"%08x\"}", page, cost.est_us, tr.hash);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iters = BENCH_DEFAULT_ITERS;
+    if (argc > 1)
+        iters = (uint32_t)strtoul(argv[1], NULL, 0);
+    if (iters == 0u)
+        iters = 1u;
+    uint32_t page_iters = iters / BENCH_PAGE_DIV ? iters / BENCH_PAGE_DIV : 1u;
+
+    ui_pixel_sink_set_dump(0u);
+    ui_lcd_cost_model_t model = {3000u, 70u, 350u, 800u};
+    ui_pixel_sink_set_cost_model(&model);
+
+    printf("{\n  \"bench\": \"gfx\",\n  \"results\": [");
+    bench_prim("fill_round_rect", b_round_rect, iters);
+    bench_prim("fill_round_rect_dither", b_round_rect_dither, iters);
+    bench_prim("ring_arc_a4", b_ring_arc, iters);
+    bench_prim("ring_gauge_a4", b_ring_gauge, iters);
+    bench_prim("big_digit_7seg", b_big_digit, iters);
+    bench_prim("font_text_opaque", b_text_opaque, iters);
+    bench_prim("font_text_transparent", b_text_transparent, iters);
+
+    uint8_t count = ui_registry_count();
+    for (uint8_t i = 0; i < count; ++i)
+        bench_page(ui_registry_page(i), page_iters);
+    printf("\n  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,212 @@
+/*
+ * memcpy/memmove/memset benchmark and bit-exactness harness.
+ *
+ * Checks the freestanding libc cores (libc/mem_words.h) against the host
+ * libc for every destination/source offset 0..7 and lengths 0..160, with
+ * guard bytes on both sides and overlapping moves in both directions. It
+ * then times them against the byte loops they replaced on the copies the
+ * firmware does most: a flash sector buffer, a ui_model_t sized struct,
+ * a misaligned frame copy and a sector fill. Output is a single JSON
+ * document on stdout.
+ *
+ *   bench_mem [iterations]
+ *
+ * The host runs the C word path (no Thumb-2 bursts), so the speedups are
+ * a lower bound for the target.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>   /* <time.h> resolves to platform/time.h here */
+
+#include "libc/mem_words.h"
+
+#define BENCH_DEFAULT_ITERS 20000u
+#define CHECK_MAX_LEN 160u
+#define CHECK_GUARD 16u
+#define BUF_BYTES 8192u
+
+/* The byte loops libc_impl.c used before; kept scalar like the target. */
+#if defined(__GNUC__) && !defined(__clang__)
+#define BYTE_LOOP __attribute__((noinline, optimize("no-tree-loop-distribute-patterns", "no-tree-vectorize")))
+#else
+#define BYTE_LOOP __attribute__((noinline))
+#endif
+
+BYTE_LOOP static void byte_copy(uint8_t *d, const uint8_t *s, size_t n)
+{
+    while (n--)
+        *d++ = *s++;
+}
+
+BYTE_LOOP static void byte_fill(uint8_t *d, uint8_t c, size_t n)
+{
+    while (n--)
+        *d++ = c;
+}
+
+__attribute__((noinline)) static void word_copy(uint8_t *d, const uint8_t *s, size_t n)
+{
+    mem_copy_fwd(d, s, n);
+}
+
+__attribute__((noinline)) static void word_move(uint8_t *d, const uint8_t *s, size_t n)
+{
+    if (d < s)
+        mem_copy_fwd(d, s, n);
+    else if (d > s)
+        mem_copy_bwd(d, s, n);
+}
+
+__attribute__((noinline)) static void word_fill(uint8_t *d, uint8_t c, size_t n)
+{
+    mem_fill(d, c, n);
+}
+
+static uint8_t s_a[BUF_BYTES] __attribute__((aligned(8)));
+static uint8_t s_b[BUF_BYTES] __attribute__((aligned(8)));
+static uint8_t s_want[BUF_BYTES] __attribute__((aligned(8)));
+
+static void pattern(uint8_t *p, size_t n, uint32_t seed)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        p[i] = (uint8_t)(seed >> 16);
+    }
+}
+
+static int check_one(const char *what, size_t span, uint32_t d_off, uint32_t s_off, size_t n)
+{
+    if (memcmp(s_b, s_want, span) == 0)
+        return 1;
+    fprintf(stderr, "MEM BENCH %s mismatch dst+%u src+%u len=%zu\n", what, d_off, s_off, n);
+    return 0;
+}
+
+/* Every offset pair and short length, guard bytes included in the compare. */
+static int check_exact(void)
+{
+    const size_t span = CHECK_GUARD * 2u + CHECK_MAX_LEN + 16u;
+    for (uint32_t d_off = 0; d_off < 8u; ++d_off)
+    {
+        for (uint32_t s_off = 0; s_off < 8u; ++s_off)
+        {
+            for (size_t n = 0; n <= CHECK_MAX_LEN; ++n)
+            {
+                uint8_t *d = &s_b[CHECK_GUARD + d_off];
+                uint8_t *w = &s_want[CHECK_GUARD + d_off];
+                const uint8_t *src = &s_a[CHECK_GUARD + s_off];
+                uint32_t seed = (uint32_t)(d_off * 977u + s_off * 131u + n);
+
+                pattern(s_a, span, seed);
+                pattern(s_b, span, ~seed);
+                memcpy(s_want, s_b, span);
+                word_copy(d, src, n);
+                memcpy(w, src, n);
+                if (!check_one("memcpy", span, d_off, s_off, n))
+                    return 0;
+
+                pattern(s_b, span, ~seed);
+                memcpy(s_want, s_b, span);
+                word_fill(d, (uint8_t)seed, n);
+                memset(w, (uint8_t)seed, n);
+                if (!check_one("memset", span, d_off, s_off, n))
+                    return 0;
+
+                /* Overlapping moves inside one buffer, both directions. */
+                uint8_t *lo = &s_b[CHECK_GUARD + d_off];
+                uint8_t *hi = &s_b[CHECK_GUARD + 8u + s_off];
+                uint8_t *lo_w = &s_want[CHECK_GUARD + d_off];
+                uint8_t *hi_w = &s_want[CHECK_GUARD + 8u + s_off];
+                pattern(s_b, span, seed ^ 0x5Au);
+                memcpy(s_want, s_b, span);
+                word_move(lo, hi, n);
+                memmove(lo_w, hi_w, n);
+                if (!check_one("memmove down", span, d_off, s_off, n))
+                    return 0;
+                pattern(s_b, span, seed ^ 0xA5u);
+                memcpy(s_want, s_b, span);
+                word_move(hi, lo, n);
+                memmove(hi_w, lo_w, n);
+                if (!check_one("memmove up", span, d_off, s_off, n))
+                    return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+static double now_ns(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec * 1e9 + (double)tv.tv_usec * 1e3;
+}
+
+static int s_first = 1;
+
+typedef void (*copy_fn)(uint8_t *d, const uint8_t *s, size_t n);
+typedef void (*fill_fn)(uint8_t *d, uint8_t c, size_t n);
+
+static double time_copy(copy_fn fn, uint32_t d_off, uint32_t s_off, size_t n, uint32_t iters)
+{
+    double t0 = now_ns();
+    for (uint32_t i = 0; i < iters; ++i)
+    {
+        fn(&s_b[d_off], &s_a[s_off], n);
+        s_a[s_off + (i % n)]++;
+    }
+    return (now_ns() - t0) / (double)iters;
+}
+
+static double time_fill(fill_fn fn, size_t n, uint32_t iters)
+{
+    double t0 = now_ns();
+    for (uint32_t i = 0; i < iters; ++i)
+        fn(s_b, (uint8_t)i, n);
+    return (now_ns() - t0) / (double)iters;
+}
+
+static void emit(const char *name, size_t bytes, uint32_t iters, double byte_ns, double word_ns)
+{
+    printf("%s\n    {\"name\": \"%s\", \"bytes\": %zu, \"iterations\": %u, "
+           "\"byte_ns\": %.1f, \"word_ns\": %.1f, \"speedup\": %.2f}",
+           s_first ? "" : ",", name, bytes, iters, byte_ns, word_ns,
+           word_ns > 0.0 ? byte_ns / word_ns : 0.0);
+    s_first = 0;
+}
+
+static void bench_copy(const char *name, uint32_t d_off, uint32_t s_off, size_t n, uint32_t iters)
+{
+    double byte_ns = time_copy(byte_copy, d_off, s_off, n, iters);
+    double word_ns = time_copy(word_copy, d_off, s_off, n, iters);
+    emit(name, n, iters, byte_ns, word_ns);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iters = BENCH_DEFAULT_ITERS;
+    if (argc > 1)
+        iters = (uint32_t)strtoul(argv[1], NULL, 0);
+    if (iters == 0u)
+        iters = 1u;
+
+    if (!check_exact())
+        return 1;
+
+    pattern(s_a, sizeof(s_a), 1u);
+    printf("{\n  \"bench\": \"mem\",\n  \"exact\": true,\n  \"results\": [");
+    bench_copy("sector_copy", 0u, 0u, 4096u, iters);
+    bench_copy("struct_copy", 0u, 0u, 600u, iters * 4u);
+    bench_copy("frame_copy_misaligned", 0u, 1u, 1024u, iters);
+    bench_copy("short_copy", 0u, 0u, 24u, iters * 16u);
+    emit("sector_fill", 4096u, iters, time_fill(byte_fill, 4096u, iters),
+         time_fill(word_fill, 4096u, iters));
+    printf("\n  ]\n}\n");
+    return 0;
+}
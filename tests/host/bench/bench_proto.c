@@ -0,0 +1,568 @@
+/*
+ * Protocol parser throughput benchmark.
+ *
+ * Pushes long byte streams through the receive paths that run per byte on
+ * target: the motor UART decoder (motor_isr_rx_bytes(), i.e. every framed
+ * lane plus the v2 heuristic), the comm frame parser (comm_parser_feed(),
+ * main loop) and framer (comm_framer_feed(), UART ISR), and per packet
+ * through ble_hacker_decode(). Streams are:
+ *
+ *   capture   - a synthetic ride as the controller sends it (Shengyi 0x52
+ *               status replies, STX02 cmd1 frames, app command traffic)
+ *   noise     - the capture with 1 % flipped, 0.5 % inserted and 0.5 %
+ *               dropped bytes, so lanes resync constantly
+ *   v2_max    - back-to-back 3-byte v2 frames, the densest decode rate
+ *   file      - records of a BRPL replay image (bus_replay store format:
+ *               16-byte header, then {bus_id, len, dt_ms be16, data}) when
+ *               one is given; motor records feed the motor decoder, BLE
+ *               records the comm parsers
+ *
+ * Per case it reports bytes/s from chunk-sized calls (one call per capture
+ * record, as the DMA IDLE path delivers them) and the per-byte cost
+ * distribution: every byte (every packet for ble_hacker) is timed on its
+ * own, the minimum over BENCH_PASSES identical replays is kept so host
+ * jitter drops out, and mean / p99 / worst ns per byte are taken over that.
+ * Frame and error counts are deterministic; the ns figures are host time,
+ * not target cycles (scale by the target/host ratio of bench_control to
+ * size ISR budgets).
+ *
+ *   bench_proto [stream_bytes] [capture.brpl]
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>   /* built without platform/ on the include path */
+
+#include "bus/bus.h"
+#include "ble/ble_hacker.h"
+#include "comm/comm_proto.h"
+#include "kernel/event_bus.h"
+#include "motor/motor_isr.h"
+#include "motor/shengyi.h"
+
+#define BENCH_DEFAULT_BYTES (256u * 1024u)
+#define BENCH_PASSES 5u
+#define BENCH_MAX_CHUNK 255u
+
+typedef struct {
+    uint8_t *data;
+    uint16_t *chunk;         /* chunk lengths; sum == len */
+    size_t len;
+    size_t chunks;
+    size_t cap;
+} bench_stream_t;
+
+typedef struct {
+    const char *name;
+    uint8_t per_packet;      /* time whole chunks instead of single bytes */
+    void (*reset)(void);
+    void (*feed)(const uint8_t *p, uint16_t n);
+    void (*chunk_done)(void);
+    void (*counts)(uint32_t *frames, uint32_t *errors);
+} bench_parser_t;
+
+static uint32_t s_lcg = 0x2545F491u;
+static uint8_t s_first = 1;
+static double s_timer_ns;
+
+static uint32_t rnd(void)
+{
+    s_lcg = s_lcg * 1664525u + 1013904223u;
+    return s_lcg >> 8;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Smallest back-to-back clock delta, subtracted from every timed call. */
+static double timer_overhead_ns(void)
+{
+    double best = 1e9;
+    for (int i = 0; i < 10000; ++i)
+    {
+        double t0 = now_ns();
+        double d = now_ns() - t0;
+        if (d < best)
+            best = d;
+    }
+    return best;
+}
+
+/* ---- streams ---- */
+
+static void stream_init(bench_stream_t *s, size_t cap)
+{
+    s->cap = cap + BENCH_MAX_CHUNK;
+    s->data = malloc(s->cap);
+    s->chunk = malloc(s->cap * sizeof(s->chunk[0]));
+    s->len = 0;
+    s->chunks = 0;
+    if (!s->data || !s->chunk)
+    {
+        fprintf(stderr, "bench_proto: out of memory\n");
+        exit(1);
+    }
+}
+
+static void stream_free(bench_stream_t *s)
+{
+    free(s->data);
+    free(s->chunk);
+    memset(s, 0, sizeof(*s));
+}
+
+static int stream_full(const bench_stream_t *s)
+{
+    return s->len + BENCH_MAX_CHUNK > s->cap;
+}
+
+static void stream_push(bench_stream_t *s, const uint8_t *p, size_t n)
+{
+    if (n == 0u || n > BENCH_MAX_CHUNK || s->len + n > s->cap)
+        return;
+    memcpy(&s->data[s->len], p, n);
+    s->len += n;
+    s->chunk[s->chunks++] = (uint16_t)n;
+}
+
+static uint8_t xor8(const uint8_t *p, size_t n)
+{
+    uint8_t x = 0;
+    for (size_t i = 0; i < n; ++i)
+        x ^= p[i];
+    return x;
+}
+
+/* Controller side of a DWG22 ride: 0x52 status every poll, config-sized
+ * replies now and then, speed/current drifting so checksums vary. */
+static void build_shengyi_capture(bench_stream_t *s, size_t bytes)
+{
+    stream_init(s, bytes);
+    uint32_t t = 0;
+    while (!stream_full(s) && s->len < bytes)
+    {
+        uint8_t frame[64];
+        uint16_t speed = (uint16_t)(800u + (t * 7u) % 1200u);
+        uint8_t st[5] = {
+            (uint8_t)((t % 37u) == 0u ? 0x40u : 0x00u),
+            (uint8_t)(0x98u + (t & 3u)),
+            (uint8_t)(20u + (t * 3u) % 60u),
+            (uint8_t)(speed >> 8),
+            (uint8_t)speed,
+        };
+        stream_push(s, frame, shengyi_frame_build(0x52u, st, sizeof(st), frame, sizeof(frame)));
+        if ((t % 50u) == 0u)
+        {
+            uint8_t cfg[24];
+            for (uint8_t i = 0; i < sizeof(cfg); ++i)
+                cfg[i] = (uint8_t)(t + i * 17u);
+            stream_push(s, frame, shengyi_frame_build(0xC0u, cfg, sizeof(cfg), frame, sizeof(frame)));
+        }
+        t++;
+    }
+}
+
+static void build_stx02_capture(bench_stream_t *s, size_t bytes)
+{
+    stream_init(s, bytes);
+    uint32_t t = 0;
+    while (!stream_full(s) && s->len < bytes)
+    {
+        /* [0]=SOF, [1]=LEN, [2]=CMD, [3..12]=payload, [13]=XOR */
+        uint8_t f[14] = {0x02u, 14u, 0x01u};
+        uint16_t period = (uint16_t)(250u + (t % 400u));
+        f[3] = (uint8_t)((t % 29u) == 0u ? 0x20u : 0x00u);
+        f[4] = (uint8_t)(t >> 2);
+        f[5] = (uint8_t)(t * 5u);
+        f[6] = (uint8_t)(period >> 8);
+        f[7] = (uint8_t)period;
+        f[8] = (uint8_t)(90u - (t / 1000u) % 90u);
+        f[13] = xor8(f, 13u);
+        stream_push(s, f, sizeof(f));
+        t++;
+    }
+}
+
+/* Unarmed v2 traffic: (data0, data1, data0 + data1) triples back to back. */
+static void build_v2_max(bench_stream_t *s, size_t bytes)
+{
+    stream_init(s, bytes);
+    uint32_t t = 0;
+    while (!stream_full(s) && s->len < bytes)
+    {
+        uint8_t f[3] = {(uint8_t)(0x10u + (t & 0x0Fu)), (uint8_t)(t >> 4)};
+        f[2] = (uint8_t)(f[0] + f[1]);
+        stream_push(s, f, sizeof(f));
+        t++;
+    }
+}
+
+/* App traffic on UART1: short polls, mid-size config writes, the odd
+ * maximum-length block write. */
+static void build_comm_capture(bench_stream_t *s, size_t bytes)
+{
+    stream_init(s, bytes);
+    uint32_t t = 0;
+    while (!stream_full(s) && s->len < bytes)
+    {
+        uint8_t payload[COMM_MAX_PAYLOAD];
+        uint8_t len = 0;
+        uint8_t sel = (uint8_t)(t % 16u);
+        if (sel == 15u)
+            len = 180u;     /* chunk upload, fits BENCH_MAX_CHUNK */
+        else if (sel >= 12u)
+            len = (uint8_t)(16u + rnd() % 48u);
+        else
+            len = (uint8_t)(rnd() % 6u);
+        for (uint8_t i = 0; i < len; ++i)
+            payload[i] = (uint8_t)rnd();
+        uint8_t frame[COMM_MAX_PAYLOAD + 4u];
+        size_t n = comm_frame_build(frame, sizeof(frame), (uint8_t)(0x01u + (t % 0x40u)), payload, len);
+        stream_push(s, frame, n);
+        t++;
+    }
+}
+
+/* BLE writes: one hacker message per packet, up to a 20-byte ATT payload. */
+static void build_ble_capture(bench_stream_t *s, size_t bytes)
+{
+    stream_init(s, bytes);
+    uint32_t t = 0;
+    while (!stream_full(s) && s->len < bytes)
+    {
+        uint8_t payload[17];
+        uint8_t len = (uint8_t)(rnd() % sizeof(payload) + 1u);
+        for (uint8_t i = 0; i < len; ++i)
+            payload[i] = (uint8_t)rnd();
+        uint8_t pkt[20];
+        stream_push(s, pkt, ble_hacker_encode((uint8_t)(t & 0x3Fu), payload, len, pkt, sizeof(pkt)));
+        t++;
+    }
+}
+
+/* Byte-level damage, chunk boundaries kept (DMA still splits on IDLE). */
+static void build_noise(bench_stream_t *out, const bench_stream_t *in)
+{
+    stream_init(out, in->len + in->len / 64u);
+    size_t pos = 0;
+    for (size_t c = 0; c < in->chunks; ++c)
+    {
+        uint8_t buf[BENCH_MAX_CHUNK];
+        size_t n = 0;
+        for (uint16_t i = 0; i < in->chunk[c]; ++i)
+        {
+            uint8_t b = in->data[pos++];
+            uint32_t r = rnd() % 1000u;
+            if (r < 5u)
+                continue;                           /* dropped */
+            if (r < 10u && n < sizeof(buf))
+                buf[n++] = (uint8_t)rnd();          /* inserted */
+            if (r >= 990u)
+                b ^= (uint8_t)(1u << (rnd() & 7u)); /* flipped */
+            if (n < sizeof(buf))
+                buf[n++] = b;
+        }
+        stream_push(out, buf, n);
+    }
+}
+
+static int load_be16(const uint8_t *p) { return (p[0] << 8) | p[1]; }
+
+/* BRPL image -> motor and BLE streams; 0 if the file is not a replay image. */
+static int load_capture(const char *path, bench_stream_t *motor, bench_stream_t *ble)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        fprintf(stderr, "bench_proto: cannot open %s\n", path);
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *img = size > 0 ? malloc((size_t)size) : NULL;
+    int ok = img && fread(img, 1, (size_t)size, f) == (size_t)size &&
+             size >= (long)BUS_REPLAY_STORE_HEADER_BYTES;
+    fclose(f);
+    uint32_t magic = ok ? ((uint32_t)load_be16(img) << 16) | (uint32_t)load_be16(img + 2) : 0u;
+    if (!ok || magic != BUS_REPLAY_STORE_MAGIC)
+    {
+        fprintf(stderr, "bench_proto: %s is not a BRPL replay image\n", path);
+        free(img);
+        return 0;
+    }
+    stream_init(motor, (size_t)size);
+    stream_init(ble, (size_t)size);
+    size_t pos = BUS_REPLAY_STORE_HEADER_BYTES;
+    while (pos + BUS_REPLAY_RECORD_HEADER_BYTES <= (size_t)size)
+    {
+        uint8_t bus_id = img[pos];
+        uint8_t len = img[pos + 1u];
+        if (len > BUS_CAPTURE_MAX_DATA || pos + BUS_REPLAY_RECORD_HEADER_BYTES + len > (size_t)size)
+            break;
+        const uint8_t *data = &img[pos + BUS_REPLAY_RECORD_HEADER_BYTES];
+        stream_push(bus_id == BUS_MOTOR ? motor : ble, data, len);
+        pos += BUS_REPLAY_RECORD_HEADER_BYTES + len;
+    }
+    free(img);
+    return 1;
+}
+
+/* ---- parsers ---- */
+
+static event_bus_t s_bus;
+
+static void motor_reset(void)
+{
+    event_bus_init(&s_bus);
+    motor_isr_init(&s_bus);
+}
+
+static void motor_feed(const uint8_t *p, uint16_t n)
+{
+    motor_isr_rx_bytes(p, n, 0u);
+}
+
+/* What the main loop does between DMA chunks: drain events and the trace. */
+static void motor_chunk_done(void)
+{
+    motor_isr_trace_t tr;
+    event_bus_dispatch(&s_bus, 0xFFFFu, 0u);
+    while (motor_isr_trace_pop(&tr))
+        ;
+}
+
+static void motor_counts(uint32_t *frames, uint32_t *errors)
+{
+    motor_isr_stats_t st;
+    motor_isr_get_stats(&st);
+    *frames = st.rx_count;
+    *errors = st.rx_errors;
+}
+
+static uint8_t s_comm_buf[COMM_MAX_PAYLOAD + 4u];
+static uint8_t s_comm_len;
+static comm_framer_t s_framer;
+static uint32_t s_frames;
+static uint32_t s_errors;
+
+static void comm_reset(void)
+{
+    s_comm_len = 0u;
+    s_framer = (comm_framer_t){0};
+    s_frames = 0u;
+    s_errors = 0u;
+}
+
+static void comm_parser_feed_bytes(const uint8_t *p, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        uint8_t frame_len = 0;
+        comm_parse_result_t r = comm_parser_feed(s_comm_buf, sizeof(s_comm_buf), COMM_MAX_PAYLOAD,
+                                                 &s_comm_len, p[i], &frame_len);
+        if (r == COMM_PARSE_FRAME)
+        {
+            s_frames++;
+            s_comm_len = 0u;
+        }
+        else if (r == COMM_PARSE_ERROR)
+        {
+            s_errors++;
+        }
+    }
+}
+
+static void comm_framer_feed_bytes(const uint8_t *p, uint16_t n)
+{
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        comm_parse_result_t r = comm_framer_feed(&s_framer, s_comm_buf, COMM_MAX_PAYLOAD, p[i]);
+        if (r == COMM_PARSE_FRAME)
+            s_frames++;
+        else if (r == COMM_PARSE_ERROR)
+            s_errors++;
+    }
+}
+
+static void ble_feed(const uint8_t *p, uint16_t n)
+{
+    ble_hacker_frame_t fr;
+    uint8_t status = 0;
+    if (ble_hacker_decode(p, (uint8_t)n, &fr, &status))
+        s_frames++;
+    else
+        s_errors++;
+}
+
+static void no_chunk_done(void)
+{
+}
+
+static void host_counts(uint32_t *frames, uint32_t *errors)
+{
+    *frames = s_frames;
+    *errors = s_errors;
+}
+
+static const bench_parser_t k_motor = {
+    "motor_rx", 0u, motor_reset, motor_feed, motor_chunk_done, motor_counts,
+};
+static const bench_parser_t k_comm_parser = {
+    "comm_parser", 0u, comm_reset, comm_parser_feed_bytes, no_chunk_done, host_counts,
+};
+static const bench_parser_t k_comm_framer = {
+    "comm_framer", 0u, comm_reset, comm_framer_feed_bytes, no_chunk_done, host_counts,
+};
+static const bench_parser_t k_ble = {
+    "ble_hacker_decode", 1u, comm_reset, ble_feed, no_chunk_done, host_counts,
+};
+
+/* ---- measurement ---- */
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_case(const bench_parser_t *pr, const char *stream_name, const bench_stream_t *s)
+{
+    if (s->len == 0u)
+        return;
+
+    /* Throughput: chunk-sized calls, best pass. */
+    double best = 1e30;
+    uint32_t frames = 0;
+    uint32_t errors = 0;
+    for (uint32_t pass = 0; pass < BENCH_PASSES; ++pass)
+    {
+        pr->reset();
+        double busy = 0.0;
+        size_t pos = 0;
+        for (size_t c = 0; c < s->chunks; ++c)
+        {
+            double t0 = now_ns();
+            pr->feed(&s->data[pos], s->chunk[c]);
+            busy += now_ns() - t0 - s_timer_ns;
+            pos += s->chunk[c];
+            pr->chunk_done();
+        }
+        if (busy < best)
+            best = busy;
+        pr->counts(&frames, &errors);
+    }
+
+    /* Per-unit cost: each byte (or packet) timed alone, min over passes. */
+    size_t units = pr->per_packet ? s->chunks : s->len;
+    double *cost = malloc(units * sizeof(double));
+    if (!cost)
+        exit(1);
+    for (size_t u = 0; u < units; ++u)
+        cost[u] = 1e30;
+    for (uint32_t pass = 0; pass < BENCH_PASSES; ++pass)
+    {
+        pr->reset();
+        size_t pos = 0;
+        size_t u = 0;
+        for (size_t c = 0; c < s->chunks; ++c)
+        {
+            uint16_t n = s->chunk[c];
+            uint16_t step = pr->per_packet ? n : 1u;
+            for (uint16_t i = 0; i < n; i += step, ++u)
+            {
+                double t0 = now_ns();
+                pr->feed(&s->data[pos + i], step);
+                double d = (now_ns() - t0 - s_timer_ns) / (double)step;
+                if (d < cost[u])
+                    cost[u] = d;
+            }
+            pos += n;
+            pr->chunk_done();
+        }
+    }
+    double sum = 0.0;
+    for (size_t u = 0; u < units; ++u)
+    {
+        if (cost[u] < 0.0)
+            cost[u] = 0.0;
+        sum += cost[u];
+    }
+    qsort(cost, units, sizeof(double), cmp_double);
+    double p99 = cost[(units * 99u) / 100u];
+    double worst = cost[units - 1u];
+    free(cost);
+
+    double ns_per_byte = best / (double)s->len;
+    printf("%s\n    {\"parser\": \"%s\", \"stream\": \"%s\", \"bytes\": %zu, \"chunks\": %zu, "
+           "\"frames\": %u, \"errors\": %u, \"bytes_per_s\": %.0f, \"ns_per_byte\": %.2f, "
+           "\"unit_mean_ns_per_byte\": %.2f, \"p99_ns_per_byte\": %.2f, \"worst_ns_per_byte\": %.2f}",
+           s_first ? "" : ",", pr->name, stream_name, s->len, s->chunks, frames, errors,
+           best > 0.0 ? (double)s->len * 1e9 / best : 0.0, ns_per_byte,
+           sum / (double)units, p99, worst);
+    s_first = 0;
+}
+
+int main(int argc, char **argv)
+{
+    size_t bytes = BENCH_DEFAULT_BYTES;
+    if (argc > 1)
+        bytes = (size_t)strtoul(argv[1], NULL, 0);
+    if (bytes < 64u)
+        bytes = 64u;
+
+    s_timer_ns = timer_overhead_ns();
+
+    bench_stream_t shengyi, shengyi_noise, stx02, v2, comm, comm_noise, ble, ble_noise;
+    build_shengyi_capture(&shengyi, bytes);
+    build_noise(&shengyi_noise, &shengyi);
+    build_stx02_capture(&stx02, bytes);
+    build_v2_max(&v2, bytes);
+    build_comm_capture(&comm, bytes);
+    build_noise(&comm_noise, &comm);
+    build_ble_capture(&ble, bytes);
+    build_noise(&ble_noise, &ble);
+
+    printf("{\n  \"bench\": \"proto\",\n  \"timer_overhead_ns\": %.1f,\n  \"results\": [", s_timer_ns);
+    bench_case(&k_motor, "shengyi_capture", &shengyi);
+    bench_case(&k_motor, "shengyi_noise", &shengyi_noise);
+    bench_case(&k_motor, "stx02_capture", &stx02);
+    bench_case(&k_motor, "v2_max", &v2);
+    bench_case(&k_comm_parser, "comm_capture", &comm);
+    bench_case(&k_comm_parser, "comm_noise", &comm_noise);
+    bench_case(&k_comm_framer, "comm_capture", &comm);
+    bench_case(&k_comm_framer, "comm_noise", &comm_noise);
+    bench_case(&k_ble, "ble_capture", &ble);
+    bench_case(&k_ble, "ble_noise", &ble_noise);
+
+    if (argc > 2)
+    {
+        bench_stream_t file_motor, file_ble;
+        if (!load_capture(argv[2], &file_motor, &file_ble))
+            return 1;
+        bench_case(&k_motor, "file", &file_motor);
+        bench_case(&k_comm_framer, "file", &file_ble);
+        stream_free(&file_motor);
+        stream_free(&file_ble);
+    }
+    printf("\n  ]\n}\n");
+
+    stream_free(&shengyi);
+    stream_free(&shengyi_noise);
+    stream_free(&stx02);
+    stream_free(&v2);
+    stream_free(&comm);
+    stream_free(&comm_noise);
+    stream_free(&ble);
+    stream_free(&ble_noise);
+    return 0;
+}
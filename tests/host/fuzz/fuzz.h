@@ -0,0 +1,28 @@
+#ifndef FUZZ_H
+#define FUZZ_H
+
+/*
+ * Host fuzz targets (libFuzzer entry points).
+ *
+ * Every fuzz_<name>.c defines LLVMFuzzerTestOneInput(). With clang the
+ * target links against -fsanitize=fuzzer and runs coverage-guided; with any
+ * other compiler fuzz_main.c replays a corpus instead, plus a fixed number
+ * of deterministic mutations per seed, so the regression suite exercises
+ * the same entry points. Targets abort() on a violated invariant.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+/* Firmware glue for targets that link the command handlers
+ * (fuzz_firmware.c): RAM-backed SPI flash and main-loop globals. Init runs
+ * once; flash and module state then persist across inputs like a device
+ * that stays powered. */
+void fuzz_firmware_init(void);
+/* Frames the handlers sent so far; every one is checked for a valid
+ * length and checksum as it goes out. */
+uint32_t fuzz_firmware_replies(void);
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Fuzz target: BLE hacker message codec (the payload of comm cmd 0x70).
+ *
+ * Invariants: a decoded frame points inside the input and re-encodes to the
+ * identical bytes; status replies and notification batches never exceed
+ * their buffers; the batch length always equals the sum of what was added.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+
+#include "ble/ble_hacker.h"
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    uint8_t len = (uint8_t)(size > 255u ? 255u : size);
+    ble_hacker_frame_t f;
+    uint8_t status = 0xFFu;
+    int ok = ble_hacker_decode(data, len, &f, &status);
+    if (ok != (status == BLE_HACKER_STATUS_OK))
+        abort();
+    if (!ok)
+        return 0;
+    if (f.payload < data || f.payload + f.payload_len != data + len)
+        abort();
+
+    uint8_t out[255];
+    uint8_t n = ble_hacker_encode(f.opcode, f.payload, f.payload_len, out, sizeof(out));
+    if (n != len || memcmp(out, data, len) != 0)
+        abort();
+
+    /* Reply as the handler would: status byte + echoed payload. */
+    uint8_t rsp[BLE_HACKER_BATCH_MAX];
+    uint8_t r = ble_hacker_encode_status((uint8_t)(f.opcode | BLE_HACKER_OP_RESPONSE_FLAG),
+                                         BLE_HACKER_STATUS_OK, f.payload, f.payload_len,
+                                         rsp, sizeof(rsp));
+    if (r && (r != (uint8_t)(f.payload_len + 4u) || r > sizeof(rsp)))
+        abort();
+
+    ble_hacker_batch_t b;
+    ble_hacker_batch_init(&b, (uint8_t)(20u + (f.opcode & 0x7Fu)), 50u);
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < 4u; ++i)
+    {
+        uint8_t plen = (uint8_t)(f.payload_len >> i);
+        uint8_t a = ble_hacker_batch_add_status(&b, f.opcode, BLE_HACKER_STATUS_OK, f.payload,
+                                                plen, i * 10u);
+        sum += a;
+        if (b.len > b.mtu || b.len > sizeof(b.buf) || b.len != sum)
+            abort();
+    }
+    return 0;
+}
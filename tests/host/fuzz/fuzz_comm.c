@@ -0,0 +1,88 @@
+/*
+ * Fuzz target: comm framing, validation and command dispatch.
+ *
+ * Byte 0 picks the context the frames arrive in:
+ *   bit0    boot monitor instead of app phase (CMD_F_PRIVILEGED gating)
+ *   bit1-2  receive port (PORT_BLE, PORT_DEBUG, PORT_MOTOR)
+ * The rest is a raw byte stream. It goes through comm_parser_feed() and
+ * comm_frame_validate() like UART bytes do in comm.c, and every frame that
+ * survives is dispatched to the real handler table, hitting config, flash
+ * log, OTA and profile code along the way.
+ *
+ * Commands that take a raw MCU address (peek/poke/exec, and flash reads
+ * outside the SPI windows) are skipped: on target they touch the memory
+ * map by design and on the host they would dereference arbitrary pointers.
+ */
+
+#include <string.h>
+
+#include "fuzz.h"
+
+#include "boot_phase.h"
+#include "comm.h"
+#include "comm_proto.h"
+#include "platform/time.h"
+#include "util/byteorder.h"
+
+#define FUZZ_SPI_LOW_BASE  0x00300000u  /* SPI_FLASH_STORAGE_BASE .. app base */
+#define FUZZ_SPI_LOW_LIMIT 0x08010000u
+#define FUZZ_SPIM_BASE     0x08400000u  /* memory-mapped SPIM window */
+#define FUZZ_SPIM_LIMIT    0x09400000u
+
+static int spi_window(uint32_t addr, uint32_t len)
+{
+    uint32_t end = addr + len;
+    if (end < addr)
+        return 0;
+    if (addr >= FUZZ_SPI_LOW_BASE && end <= FUZZ_SPI_LOW_LIMIT)
+        return 1;
+    return addr >= FUZZ_SPIM_BASE && end <= FUZZ_SPIM_LIMIT;
+}
+
+static int host_safe(uint8_t cmd, const uint8_t *p, uint8_t len)
+{
+    if (cmd >= 0x02u && cmd <= 0x07u)
+        return 0;
+    if (cmd == 0x08u)       /* read_flash: addr, n */
+        return len < 5u || spi_window(load_be32(p), p[4]);
+    if (cmd == 0x12u)       /* bulk_read begin: addr, len */
+        return len < 8u || spi_window(load_be32(p), load_be32(&p[4]));
+    if (cmd == COMM_CMD_TAGGED) /* tag, cmd, args */
+        return len < 2u || host_safe(p[1], &p[2], (uint8_t)(len - 2u));
+    return 1;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_firmware_init();
+    if (size == 0u)
+        return 0;
+
+    uint8_t mode = data[0];
+    g_boot_phase = (mode & 1u) ? BOOT_PHASE_MONITOR : BOOT_PHASE_APP;
+    g_last_rx_port = (int)((mode >> 1) & 3u) % 3;
+
+    uint8_t buf[COMM_MAX_PAYLOAD + 4u];
+    uint8_t buf_len = 0;
+    for (size_t i = 1; i < size; ++i)
+    {
+        uint8_t frame_len = 0;
+        if (comm_parser_feed(buf, sizeof(buf), COMM_MAX_PAYLOAD, &buf_len, data[i],
+                             &frame_len) != COMM_PARSE_FRAME)
+            continue;
+        if (!comm_frame_validate(buf, frame_len, NULL))
+            continue;
+        uint8_t cmd = buf[1];
+        uint8_t len = buf[2];
+        if (!host_safe(cmd, &buf[3], len))
+            continue;
+        if (!comm_handle_command(cmd, &buf[3], len))
+            send_status(cmd, 0xFF);
+        g_ms += 10u;
+        bulk_read_tick();
+        comm_tagged_tick();
+    }
+
+    g_boot_phase = BOOT_PHASE_APP;
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * Fuzz target: config blob decode, validation, staging and field patches.
+ *
+ * Byte 0: bit0 re-seals the CRC after mutation (so the value checks are
+ * reached rather than stopping at CFG_REJECT_CRC), bit1 also feeds the rest
+ * of the input to config_patch_fields(), bit2 then walks the active config
+ * through every profile id via config_active_set_profile(). Bytes 1..CONFIG_BLOB_SIZE are an
+ * XOR mask over the big-endian defaults blob, so an empty mask is the
+ * factory config. Runs against the firmware glue so stage/commit persist to
+ * the RAM-backed flash like the 0x1x config commands do.
+ *
+ * Invariants: store_be(load_from_be(blob)) == blob; validate() and
+ * validate_reason() agree; a blob that validates stages, and whatever ends
+ * up active still validates with its CRC and passes policy; a profile
+ * switch leaves the incrementally patched CRC equal to a full recompute.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+
+#include "src/config/config.h"
+
+static void check_active(void)
+{
+    if (!config_validate(&g_config_active, 1) || !config_policy_validate(&g_config_active, NULL))
+        abort();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    fuzz_firmware_init();
+    uint8_t mode = size ? data[0] : 0u;
+    const uint8_t *mask = size ? &data[1] : data;
+    size_t mask_len = size ? size - 1u : 0u;
+
+    config_t c;
+    uint8_t blob[CONFIG_BLOB_SIZE];
+    config_defaults(&c);
+    config_store_be(blob, &c);
+    for (size_t i = 0; i < mask_len && i < sizeof(blob); ++i)
+        blob[i] ^= mask[i];
+    if (mode & 1u)
+    {
+        config_load_from_be(&c, blob);
+        c.crc32 = config_crc_expected(&c);
+        config_store_be(blob, &c);
+    }
+
+    uint8_t again[CONFIG_BLOB_SIZE];
+    config_load_from_be(&c, blob);
+    config_store_be(again, &c);
+    if (memcmp(blob, again, sizeof(blob)) != 0)
+        abort();
+
+    config_reject_reason_t reason = CFG_REJECT_NONE;
+    int ok = config_validate_reason(&c, 1, &reason);
+    if (ok != config_validate(&c, 1) || (ok != 0) != (reason == CFG_REJECT_NONE))
+        abort();
+    (void)config_validate(&c, 0);
+    int policy_ok = config_policy_validate(&c, &reason);
+
+    uint8_t st = config_stage_blob(blob);
+    if ((ok && policy_ok) != (st == 0u))
+        abort();
+    if (st == 0u)
+    {
+        static const uint8_t k_no_reboot[1] = { 0u };
+        if (config_commit_staged(k_no_reboot, sizeof(k_no_reboot)) != 0u)
+            abort();
+    }
+    check_active();
+
+    if ((mode & 2u) && mask_len)
+    {
+        (void)config_patch_fields(mask, (uint8_t)(mask_len > 255u ? 255u : mask_len));
+        check_active();
+    }
+
+    if (mode & 4u)
+    {
+        for (uint8_t id = PROFILE_COUNT; id-- > 0u;)
+        {
+            config_active_set_profile(id);
+            if (g_config_active.crc32 != config_crc_expected(&g_config_active))
+                abort();
+        }
+        check_active();
+    }
+    return 0;
+}
@@ -0,0 +1,404 @@
+/*
+ * Firmware glue for fuzz targets that link the comm command handlers.
+ *
+ * Provides what src/main.c, src/app.c, src/comm/comm.c, src/boot_monitor.c
+ * and the hardware drivers would: main-loop globals with their main.c
+ * initial values, a 4 MiB RAM-backed SPI flash (erased to 0xFF, NOR
+ * semantics: programming only clears bits), and a reply path that checks
+ * every outgoing frame. Replies are validated and counted, not sent.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "fuzz.h"
+
+#include "app.h"
+#include "app_state.h"
+#include "boot_monitor.h"
+#include "boot_phase.h"
+#include "comm.h"
+#include "system_control.h"
+#include "src/config/config.h"
+#include "src/control/control.h"
+#include "src/kernel/event_bus.h"
+#include "src/motor/app_data.h"
+#include "src/motor/motor_isr.h"
+#include "src/power/brownout.h"
+#include "src/power/power.h"
+#include "src/profiles/profiles.h"
+#include "src/telemetry/trip.h"
+#include "drivers/spi_flash.h"
+#include "drivers/uart.h"
+#include "gfx/ui_lcd.h"
+#include "platform/board_init.h"
+#include "platform/time.h"
+#include "platform/watchdog.h"
+#include "storage/ab_update.h"
+#include "storage/flash_jobs.h"
+#include "storage/kv_store.h"
+#include "storage/layout.h"
+#include "storage/logs.h"
+#include "storage/ride_log.h"
+
+#define FUZZ_FLASH_SIZE 0x400000u
+
+/* ---- src/main.c ---- */
+volatile uint32_t g_ms;
+uint32_t g_last_print;
+uint16_t g_reset_flags;
+uint32_t g_reset_csr;
+uint32_t g_inputs_debug_last_ms;
+uint32_t g_stream_period_ms = 0;
+uint32_t g_last_stream_ms = 0;
+uint8_t g_input_caps;
+uint8_t g_headlight_enabled;
+uint8_t g_hw_caps = CAP_FLAG_WALK;
+vgear_table_t g_vgears;
+cadence_bias_t g_cadence_bias;
+uint8_t g_active_vgear;
+uint8_t g_active_profile_id = 0;
+uint32_t g_last_profile_switch_ms = 0;
+uint8_t g_debug_uart_mask = 0u;
+volatile boot_phase_t g_boot_phase = BOOT_PHASE_APP;
+uint8_t g_last_brake_state;
+uint8_t g_brake_edge;
+reboot_request_t g_request_soft_reboot;
+event_bus_t g_event_bus;
+
+void process_buttons(uint8_t raw_buttons)
+{
+    (void)raw_buttons;
+}
+
+int set_active_profile(uint8_t id, int persist)
+{
+    if (id >= PROFILE_COUNT)
+        return 0xFE;
+    g_active_profile_id = id;
+    g_outputs.profile_id = id;
+    g_config_active.profile_id = id;
+    g_last_profile_switch_ms = g_ms;
+    g_config_active.crc32 = 0;
+    g_config_active.crc32 = config_crc_expected(&g_config_active);
+    if (persist)
+        config_persist_profile(id);
+    return 0;
+}
+
+/* Never leaves the app on host; the flag write is the observable part. */
+void reboot_to_bootloader(void)
+{
+    spi_flash_set_bootloader_mode_flag();
+}
+
+/* ---- src/app.c ---- */
+void app_apply_inputs(void)
+{
+}
+
+void app_dispatch_events(void)
+{
+    (void)event_bus_dispatch(&g_event_bus, 0xFFFFu, g_ms);
+}
+
+uint16_t app_idle_permille(void)
+{
+    return 0u;
+}
+
+uint32_t app_idle_sleeps(void)
+{
+    return 0u;
+}
+
+void app_control_get_stats(app_control_stats_t *out)
+{
+    if (out)
+        memset(out, 0, sizeof(*out));
+}
+
+/* ---- src/comm/comm.c ---- */
+int g_last_rx_port = 0;
+uint32_t g_last_rx_us;
+static uint32_t s_replies;
+
+void send_frame_port(int port_idx, uint8_t cmd, const uint8_t *payload, uint8_t len)
+{
+    uint8_t frame[COMM_MAX_PAYLOAD + 4u];
+    (void)port_idx;
+    size_t n = comm_frame_build(frame, sizeof(frame), cmd, payload, len);
+    /* A handler replying with more than a frame holds is a truncation bug
+     * on target (comm.c drops the reply silently). */
+    if (len > COMM_MAX_PAYLOAD || !n || !comm_frame_is_valid(frame, n))
+        abort();
+    s_replies++;
+}
+
+void send_status(uint8_t cmd, uint8_t status)
+{
+    uint8_t p[1] = {status};
+    send_frame_port(g_last_rx_port, cmd | 0x80, p, 1);
+}
+
+/* Tagged replies are rewrapped by comm.c; the stub only has to link. */
+void comm_reply_tag_set(int port, uint8_t cmd, uint8_t tag)
+{
+    (void)port;
+    (void)cmd;
+    (void)tag;
+}
+
+void comm_reply_tag_clear(void)
+{
+}
+
+uint16_t comm_tx_free(int port_idx)
+{
+    (void)port_idx;
+    return 1024u;
+}
+
+int comm_get_port_stats(int port_idx, comm_port_stats_t *out)
+{
+    if (!out || port_idx < 0 || port_idx > PORT_MOTOR)
+        return 0;
+    memset(out, 0, sizeof(*out));
+    return 1;
+}
+
+void comm_reset_port_stats(void)
+{
+}
+
+uint8_t ble_ttm_is_connected(void)
+{
+    return 1u;
+}
+
+int comm_ble_baud_request(uint32_t baud, uint16_t timeout_ms)
+{
+    (void)timeout_ms;
+    return (baud == 9600u || baud == 115200u) ? 1 : 0;
+}
+
+uint8_t comm_ble_baud_state(uint32_t *baud, uint32_t *target, uint16_t *fallbacks)
+{
+    if (baud)
+        *baud = 9600u;
+    if (target)
+        *target = 9600u;
+    if (fallbacks)
+        *fallbacks = 0u;
+    return 0u;
+}
+
+uint32_t fuzz_firmware_replies(void)
+{
+    return s_replies;
+}
+
+/* ---- src/boot_monitor.c ---- */
+void boot_monitor_request_continue(void)
+{
+}
+
+uint8_t boot_monitor_build_info(uint8_t *out, uint8_t cap)
+{
+    if (!out || cap < 2u)
+        return 0u;
+    out[0] = 1u;
+    out[1] = (uint8_t)g_boot_phase;
+    return 2u;
+}
+
+/* ---- gfx/ui_lcd.c ---- */
+/* No compositor on host: the ui_stream command has nothing to read. */
+uint8_t ui_lcd_remote_available(void)
+{
+    return 0u;
+}
+
+void ui_lcd_remote_refresh(void)
+{
+}
+
+uint16_t ui_lcd_remote_pending(void)
+{
+    return 0u;
+}
+
+uint16_t ui_lcd_remote_next(ui_fb8_remote_chunk_t *c, uint8_t *rle, uint16_t cap)
+{
+    (void)c;
+    (void)rle;
+    (void)cap;
+    return 0u;
+}
+
+/* ---- platform/ and drivers/ ---- */
+uint32_t platform_cycles_now(void)
+{
+    return g_ms * 72000u;
+}
+
+uint32_t platform_cycles_to_us(uint32_t cycles)
+{
+    return cycles / 72u;
+}
+
+uint32_t platform_time_us(void)
+{
+    return g_ms * 1000u;
+}
+
+void platform_cycle_counter_init(void)
+{
+}
+
+void platform_key_output_set(uint8_t on)
+{
+    (void)on;
+}
+
+void uart_write(uint32_t base, const uint8_t *data, size_t len)
+{
+    (void)base;
+    (void)data;
+    (void)len;
+}
+
+void watchdog_budget_begin(watchdog_budget_t *b, uint32_t budget_us)
+{
+    if (!b)
+        return;
+    memset(b, 0, sizeof(*b));
+    b->budget_us = budget_us;
+}
+
+uint8_t watchdog_budget_poll(watchdog_budget_t *b)
+{
+    (void)b;
+    return 1u;
+}
+
+void watchdog_get_stats(watchdog_stats_t *out)
+{
+    if (out)
+        memset(out, 0, sizeof(*out));
+}
+
+void watchdog_reset_stats(void)
+{
+}
+
+static uint8_t s_flash[FUZZ_FLASH_SIZE];
+
+/* The part decodes 22 address bits; higher bits wrap like on the board. */
+#define FLASH_AT(a) s_flash[(a) & (FUZZ_FLASH_SIZE - 1u)]
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        out[i] = FLASH_AT(addr + i);
+}
+
+void spi_flash_erase_4k(uint32_t addr)
+{
+    addr &= ~(SPI_FLASH_SECTOR_SIZE - 1u);
+    for (uint32_t i = 0; i < SPI_FLASH_SECTOR_SIZE; ++i)
+        FLASH_AT(addr + i) = 0xFFu;
+}
+
+void spi_flash_erase_4k_start(uint32_t addr)
+{
+    spi_flash_erase_4k(addr);
+}
+
+void spi_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        FLASH_AT(addr + i) &= data[i];
+}
+
+void spi_flash_page_program_start(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    uint32_t room = SPI_FLASH_PAGE_SIZE - (addr & (SPI_FLASH_PAGE_SIZE - 1u));
+    spi_flash_write(addr, data, len < room ? len : room);
+}
+
+void spi_flash_update_bytes(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        FLASH_AT(addr + i) = data[i];
+}
+
+uint8_t spi_flash_busy(void)
+{
+    return 0u;
+}
+
+uint8_t spi_flash_urgent_begin(void)
+{
+    return 1u;
+}
+
+void spi_flash_urgent_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    spi_flash_write(addr, data, len);
+}
+
+void spi_flash_urgent_end(void) {}
+
+uint8_t spi_flash_read_async_start(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    if (!out || len == 0u)
+        return 0u;
+    spi_flash_read(addr, out, len);
+    return 1u;
+}
+
+uint8_t spi_flash_read_async_poll(void)
+{
+    return 1u;
+}
+
+void spi_flash_cache_get_stats(spi_flash_cache_stats_t *out)
+{
+    if (out)
+        memset(out, 0, sizeof(*out));
+}
+
+/* The OEM bootloader checks only byte[0] at 0x3FF080 == 0xAA. */
+void spi_flash_set_bootloader_mode_flag(void)
+{
+    static const uint8_t k_flag = 0xAAu;
+    spi_flash_update_bytes(SPI_FLASH_BOOTMODE_FLAG_ADDR, &k_flag, 1u);
+}
+
+/* The boot_step_* sequence of main.c that the handlers depend on. */
+void fuzz_firmware_init(void)
+{
+    static uint8_t done;
+    if (done)
+        return;
+    done = 1u;
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    event_bus_init(&g_event_bus);
+    motor_isr_init(&g_event_bus);
+    drive_reset();
+    power_policy_reset();
+    profiles_defaults();
+    vgear_defaults();
+    cadence_bias_defaults();
+    flash_jobs_init();
+    kv_init();
+    config_stage_reset();
+    config_load_active();
+    ride_log_load();
+    trip_init();
+    brownout_init();
+    event_log_load();
+    stream_log_load();
+    ab_update_init();
+}
@@ -0,0 +1,211 @@
+/*
+ * Corpus replay driver for compilers without libFuzzer.
+ *
+ *   fuzz_<name> [--mutations N] [--max-ms MS] <file|dir>...
+ *
+ * Runs every corpus file through LLVMFuzzerTestOneInput(), then N
+ * deterministic mutations of each (bit flips, byte overwrites, inserts,
+ * deletes, splices with another seed). An input slower than --max-ms fails
+ * the run: the decoders run in ISR context, so an input that makes them
+ * rescan or loop is a bug even when the output is right.
+ */
+
+#define _DEFAULT_SOURCE
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>   /* <time.h> resolves to platform/time.h here */
+
+#include "fuzz.h"
+
+#define FUZZ_MAX_INPUT 4096u
+#define FUZZ_MAX_SEEDS 512u
+#define FUZZ_DEFAULT_MUTATIONS 200u
+#define FUZZ_DEFAULT_MAX_MS 100u
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} fuzz_seed_t;
+
+static fuzz_seed_t s_seeds[FUZZ_MAX_SEEDS];
+static size_t s_seed_count;
+static uint32_t s_lcg = 0x9E3779B9u;
+static double s_max_us;
+static double s_limit_us;
+
+static uint32_t rnd(void)
+{
+    s_lcg = s_lcg * 1664525u + 1013904223u;
+    return s_lcg >> 8;
+}
+
+static double now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec * 1e6 + (double)tv.tv_usec;
+}
+
+static void add_seed(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return;
+    uint8_t buf[FUZZ_MAX_INPUT];
+    size_t n = fread(buf, 1, sizeof(buf), f);
+    fclose(f);
+    if (s_seed_count >= FUZZ_MAX_SEEDS)
+        return;
+    fuzz_seed_t *s = &s_seeds[s_seed_count++];
+    s->data = malloc(n ? n : 1u);
+    if (!s->data)
+        exit(1);
+    memcpy(s->data, buf, n);
+    s->len = n;
+}
+
+static int cmp_name(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/* Directory entries in name order, so runs are reproducible. */
+static void add_path(const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0)
+    {
+        fprintf(stderr, "fuzz: cannot stat %s\n", path);
+        exit(1);
+    }
+    if (!S_ISDIR(st.st_mode))
+    {
+        add_seed(path);
+        return;
+    }
+    DIR *d = opendir(path);
+    if (!d)
+        return;
+    char *names[FUZZ_MAX_SEEDS];
+    size_t count = 0;
+    struct dirent *e;
+    while ((e = readdir(d)) != NULL && count < FUZZ_MAX_SEEDS)
+    {
+        if (e->d_name[0] == '.')
+            continue;
+        names[count++] = strdup(e->d_name);
+    }
+    closedir(d);
+    qsort(names, count, sizeof(names[0]), cmp_name);
+    for (size_t i = 0; i < count; ++i)
+    {
+        char full[1024];
+        snprintf(full, sizeof(full), "%s/%s", path, names[i]);
+        add_seed(full);
+        free(names[i]);
+    }
+}
+
+static int run_one(const uint8_t *data, size_t len, const char *what)
+{
+    double t0 = now_us();
+    LLVMFuzzerTestOneInput(data, len);
+    double us = now_us() - t0;
+    if (us > s_max_us)
+        s_max_us = us;
+    if (us > s_limit_us)
+    {
+        fprintf(stderr, "fuzz: %s took %.0f us (limit %.0f)\n", what, us, s_limit_us);
+        return 0;
+    }
+    return 1;
+}
+
+static size_t mutate(uint8_t *out, const fuzz_seed_t *seed)
+{
+    size_t len = seed->len;
+    memcpy(out, seed->data, len);
+    uint32_t edits = 1u + rnd() % 4u;
+    for (uint32_t i = 0; i < edits; ++i)
+    {
+        uint32_t pos = len ? rnd() % (uint32_t)len : 0u;
+        switch (rnd() % 5u)
+        {
+        case 0:
+            if (len)
+                out[pos] ^= (uint8_t)(1u << (rnd() & 7u));
+            break;
+        case 1:
+            if (len)
+                out[pos] = (uint8_t)rnd();
+            break;
+        case 2:
+            if (len < FUZZ_MAX_INPUT)
+            {
+                memmove(&out[pos + 1u], &out[pos], len - pos);
+                out[pos] = (uint8_t)rnd();
+                len++;
+            }
+            break;
+        case 3:
+            if (len)
+            {
+                memmove(&out[pos], &out[pos + 1u], len - pos - 1u);
+                len--;
+            }
+            break;
+        default:
+        {
+            const fuzz_seed_t *other = &s_seeds[rnd() % (uint32_t)s_seed_count];
+            size_t n = other->len;
+            if (pos + n > FUZZ_MAX_INPUT)
+                n = FUZZ_MAX_INPUT - pos;
+            memcpy(&out[pos], other->data, n);
+            if (pos + n > len)
+                len = pos + n;
+            break;
+        }
+        }
+    }
+    return len;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t mutations = FUZZ_DEFAULT_MUTATIONS;
+    s_limit_us = FUZZ_DEFAULT_MAX_MS * 1000.0;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--mutations") == 0 && i + 1 < argc)
+            mutations = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--max-ms") == 0 && i + 1 < argc)
+            s_limit_us = strtod(argv[++i], NULL) * 1000.0;
+        else
+            add_path(argv[i]);
+    }
+    if (s_seed_count == 0u)
+    {
+        static uint8_t empty[1];
+        s_seeds[0].data = empty;
+        s_seeds[0].len = 0u;
+        s_seed_count = 1u;
+    }
+
+    int ok = 1;
+    uint32_t runs = 0;
+    for (size_t i = 0; i < s_seed_count && ok; ++i, ++runs)
+        ok = run_one(s_seeds[i].data, s_seeds[i].len, "seed");
+    uint8_t buf[FUZZ_MAX_INPUT + 1u];
+    for (size_t i = 0; i < s_seed_count && ok; ++i)
+    {
+        for (uint32_t m = 0; m < mutations && ok; ++m, ++runs)
+            ok = run_one(buf, mutate(buf, &s_seeds[i]), "mutation");
+    }
+    printf("fuzz: seeds=%zu runs=%u slowest_us=%.0f %s\n", s_seed_count, runs, s_max_us,
+           ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,87 @@
+/*
+ * Fuzz target: motor UART receive path.
+ *
+ * Byte 0: bits0-5 DMA chunk size - 1 (how the stream is split into
+ * motor_isr_rx_bytes() calls), bit7 arms a v2 short-frame capture whose
+ * expected length is byte 1, as the ISR does when a v2 request leaves. The
+ * remaining bytes run through all four protocol lanes (Shengyi 3A1A, STX02,
+ * AUTH, v2), then the captured frame goes through its protocol decoder.
+ *
+ * Invariants: captured frames fit the caller's buffer and carry a known
+ * protocol; a captured STX02 status frame decodes; published status is
+ * internally consistent.
+ */
+
+#include <stdlib.h>
+
+#include "fuzz.h"
+
+#include "kernel/event_bus.h"
+#include "motor/motor_isr.h"
+#include "motor/motor_stx02.h"
+
+static event_bus_t s_bus;
+
+static void check_last_frame(void)
+{
+    uint8_t frame[255];
+    uint8_t len = 0, op = 0, seq = 0;
+    motor_proto_t proto = MOTOR_PROTO_SHENGYI_3A1A;
+    uint16_t aux = 0;
+    if (!motor_isr_copy_last_frame(frame, sizeof(frame), &len, &op, &seq, &proto, &aux))
+        return;
+    if ((unsigned)proto >= MOTOR_PROTO_COUNT || len == 0u)
+        abort();
+    if (proto == MOTOR_PROTO_STX02_XOR && op == 1u)
+    {
+        motor_stx02_cmd1_t st;
+        if (motor_stx02_decode_cmd1(frame, len, &st) && st.current_dA < 0)
+            abort();
+    }
+
+    motor_isr_status_t s;
+    if (motor_isr_read_status(&s))
+    {
+        if (s.proto >= MOTOR_PROTO_COUNT || !motor_isr_is_status_frame((motor_proto_t)s.proto, s.op))
+            abort();
+        if ((s.flags & MOTOR_ISR_STATUS_F_SOC) && s.soc_pct > 100u)
+            abort();
+    }
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    event_bus_init(&s_bus);
+    motor_isr_init(&s_bus);
+    if (size == 0u)
+        return 0;
+
+    uint8_t mode = data[0];
+    uint16_t chunk = (uint16_t)((mode & 0x3Fu) + 1u);
+    size_t pos = 1;
+    uint32_t now_ms = 0;
+    if ((mode & 0x80u) && size > 1u)
+    {
+        static const uint8_t k_req[] = { 0x01u, 0x00u };
+        motor_isr_v2_expect(0x0001u, data[1]);
+        (void)motor_isr_queue_frame(k_req, sizeof(k_req));
+        motor_isr_tick(now_ms);
+        pos = 2;
+    }
+
+    while (pos < size)
+    {
+        uint16_t n = (uint16_t)((size - pos < chunk) ? size - pos : chunk);
+        motor_isr_rx_bytes(&data[pos], n, now_ms);
+        pos += n;
+        now_ms += 5u;
+
+        motor_isr_trace_t tr;
+        (void)event_bus_dispatch(&s_bus, 0xFFFFu, now_ms);
+        while (motor_isr_trace_pop(&tr))
+            if (tr.dir == MOTOR_ISR_TRACE_RX && tr.proto >= MOTOR_PROTO_COUNT)
+                abort();
+        check_last_frame();
+    }
+    return 0;
+}
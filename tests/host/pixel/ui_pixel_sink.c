@@ -7,11 +7,79 @@
 #include "ui_display.h"
 #include "ui_draw_common.h"
 #include "ui_font_bitmap.h"
+#include "ui_lcd.h"
+#include "sim/sim_prof.h"
 
 static uint16_t g_fb[DISP_W * DISP_H];
 static uint8_t g_frame_pending;
 static uint32_t g_frame_counter;
 static uint8_t g_inited;
+static uint8_t g_dump = 1;
+
+/* Bus cost model: counters for the current frame, attributed to g_cost_prim. */
+static ui_lcd_cost_model_t g_cost_model = {
+    .window_ns = 3000u,    /* 11 CPU-issued bus writes + DMA sync */
+    .pixel_ns = 70u,       /* one FSMC data write, ~5 HCLK */
+    .px_call_ns = 350u,    /* writer callback + line buffer store */
+    .dma_start_ns = 800u,  /* DMA channel setup and completion poll */
+};
+static uint8_t g_cost_model_inited;
+static ui_lcd_cost_t g_cost[UI_PERF_PRIM_COUNT];
+static uint8_t g_cost_prim = UI_PERF_PRIM_FILL;
+static uint16_t g_px_row_w;
+static uint16_t g_px_fill;
+static int g_px_x0, g_px_y0, g_px_x1, g_px_y1;
+
+/* Scissor, as ui_lcd_set_clip: drawing and its cost stop at the edges. */
+static int g_clip_x0;
+static int g_clip_y0;
+static int g_clip_x1 = DISP_W;
+static int g_clip_y1 = DISP_H;
+
+static void cost_model_init(void)
+{
+    if (g_cost_model_inited)
+        return;
+    g_cost_model_inited = 1;
+    const char *env = getenv("BC280_LCD_COST_NS");
+    unsigned w, p, c, d;
+    if (env && sscanf(env, "%u,%u,%u,%u", &w, &p, &c, &d) == 4)
+        g_cost_model = (ui_lcd_cost_model_t){w, p, c, d};
+}
+
+/* fill_rect path on target: one window, one DMA fill of w*h words. */
+static void cost_fill(uint32_t w, uint32_t h)
+{
+    ui_lcd_cost_t *c = &g_cost[g_cost_prim];
+    c->windows++;
+    c->dma_starts++;
+    c->pixels += w * h;
+}
+
+/* One DMA line of n words into an already-open window. */
+static void cost_line(uint32_t n)
+{
+    ui_lcd_cost_t *c = &g_cost[g_cost_prim];
+    c->dma_starts++;
+    c->pixels += n;
+}
+
+static void cost_cpu_pixels(uint32_t n, uint8_t window)
+{
+    ui_lcd_cost_t *c = &g_cost[g_cost_prim];
+    c->windows += window;
+    c->px_calls++;
+    c->pixels += n;
+}
+
+static void cost_finish(ui_lcd_cost_t *c)
+{
+    uint64_t ns = (uint64_t)c->windows * g_cost_model.window_ns +
+                  (uint64_t)c->pixels * g_cost_model.pixel_ns +
+                  (uint64_t)c->px_calls * g_cost_model.px_call_ns +
+                  (uint64_t)c->dma_starts * g_cost_model.dma_start_ns;
+    c->est_us = (uint32_t)((ns + 500u) / 1000u);
+}
 
 static const char *get_outdir(void)
 {
@@ -26,10 +94,15 @@ static const char *get_outdir(void)
 }
 static void ensure_outdir(void)
 {
+    /* Only when the directory changes, not once per frame. */
+    static char made[512];
     const char *dir = get_outdir();
+    if (strcmp(dir, made) == 0)
+        return;
     char cmd[512];
     snprintf(cmd, sizeof(cmd), "mkdir -p %s", dir);
     (void)system(cmd);
+    snprintf(made, sizeof(made), "%s", dir);
 }
 
 static void clear_fb(uint16_t color)
@@ -38,9 +111,42 @@ static void clear_fb(uint16_t color)
         g_fb[i] = color;
 }
 
+static int clip_has(int x, int y)
+{
+    return x >= g_clip_x0 && y >= g_clip_y0 && x < g_clip_x1 && y < g_clip_y1;
+}
+
+/* Cuts a rect to the scissor; 0 when nothing is left. */
+static int clip_rect(int *x, int *y, int *w, int *h)
+{
+    int x0 = *x, y0 = *y, x1 = *x + *w, y1 = *y + *h;
+    if (x0 < g_clip_x0)
+        x0 = g_clip_x0;
+    if (y0 < g_clip_y0)
+        y0 = g_clip_y0;
+    if (x1 > g_clip_x1)
+        x1 = g_clip_x1;
+    if (y1 > g_clip_y1)
+        y1 = g_clip_y1;
+    if (x0 >= x1 || y0 >= y1)
+        return 0;
+    *x = x0;
+    *y = y0;
+    *w = x1 - x0;
+    *h = y1 - y0;
+    return 1;
+}
+
+/* A fill as the target issues it: nothing when the scissor leaves nothing. */
+static void cost_fill_clipped(int x, int y, int w, int h)
+{
+    if (clip_rect(&x, &y, &w, &h))
+        cost_fill((uint32_t)w, (uint32_t)h);
+}
+
 static void set_px(int x, int y, uint16_t color)
 {
-    if (x < 0 || y < 0 || x >= (int)DISP_W || y >= (int)DISP_H)
+    if (!clip_has(x, y))
         return;
     g_fb[(size_t)y * DISP_W + (size_t)x] = color;
 }
@@ -81,6 +187,7 @@ static void pixel_fill_hline_cb(void *ctx, uint16_t x, uint16_t y, uint16_t w, u
 {
     (void)ctx;
     draw_hline((int)x, (int)y, (int)w, color);
+    cost_fill_clipped((int)x, (int)y, (int)w, 1);
 }
 
 static void pixel_fill_hline_dither_cb(void *ctx, uint16_t x, uint16_t y, uint16_t w,
@@ -88,12 +195,14 @@ static void pixel_fill_hline_dither_cb(void *ctx, uint16_t x, uint16_t y, uint16
 {
     (void)ctx;
     draw_hline_dither((int)x, (int)y, (int)w, c0, c1, level);
+    cost_fill_clipped((int)x, (int)y, (int)w, 1);
 }
 
 static void pixel_fill_rect_cb(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
 {
     (void)ctx;
     fill_rect(x, y, w, h, color);
+    cost_fill_clipped((int)x, (int)y, (int)w, (int)h);
 }
 
 static void pixel_fill_rect_dither_cb(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
@@ -101,6 +210,12 @@ static void pixel_fill_rect_dither_cb(void *ctx, uint16_t x, uint16_t y, uint16_
 {
     (void)ctx;
     fill_rect_dither(x, y, w, h, c0, c1, level);
+    int cx = (int)x, cy = (int)y, cw = (int)w, ch = (int)h;
+    if (!clip_rect(&cx, &cy, &cw, &ch))
+        return;
+    cost_fill((uint32_t)cw, 1u);
+    for (int i = 1; i < ch; ++i)
+        cost_line((uint32_t)cw);
 }
 
 static const ui_draw_rect_ops_t k_pixel_rect_ops = {
@@ -110,15 +225,73 @@ static const ui_draw_rect_ops_t k_pixel_rect_ops = {
     .fill_rect_dither = pixel_fill_rect_dither_cb,
 };
 
+/* Pixel writer mirrors lcd_*_cb: the window is cut to the scissor, rows
+ * buffer until full, then one DMA line; pixels outside are dropped. */
+static void pixel_begin_window_cb(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    (void)ctx;
+    int cx = (int)x, cy = (int)y, cw = (int)w, ch = (int)h;
+    g_px_fill = 0u;
+    if (!clip_rect(&cx, &cy, &cw, &ch))
+    {
+        g_px_x0 = g_px_x1 = 0;
+        g_px_row_w = 0u;
+        return;
+    }
+    g_cost[g_cost_prim].windows++;
+    g_px_x0 = cx;
+    g_px_y0 = cy;
+    g_px_x1 = cx + cw;
+    g_px_y1 = cy + ch;
+    g_px_row_w = (uint16_t)cw;
+}
+
+static void cost_px_push(uint16_t n)
+{
+    g_cost[g_cost_prim].px_calls++;
+    while (n)
+    {
+        uint16_t room = (uint16_t)(g_px_row_w - g_px_fill);
+        uint16_t take = (n < room) ? n : room;
+        g_px_fill = (uint16_t)(g_px_fill + take);
+        n = (uint16_t)(n - take);
+        if (g_px_fill >= g_px_row_w)
+        {
+            cost_line(g_px_row_w);
+            g_px_fill = 0u;
+        }
+    }
+}
+
 static void pixel_write_pixel_cb(void *ctx, uint16_t x, uint16_t y, uint16_t color)
 {
     (void)ctx;
+    if ((int)x < g_px_x0 || (int)x >= g_px_x1 || (int)y < g_px_y0 || (int)y >= g_px_y1)
+        return;
     set_px((int)x, (int)y, color);
+    cost_px_push(1u);
+}
+
+static void pixel_write_run_cb(void *ctx, uint16_t x, uint16_t y, uint16_t n, uint16_t color)
+{
+    (void)ctx;
+    if ((int)y < g_px_y0 || (int)y >= g_px_y1)
+        return;
+    int x0 = (int)x, x1 = (int)x + (int)n;
+    if (x0 < g_px_x0)
+        x0 = g_px_x0;
+    if (x1 > g_px_x1)
+        x1 = g_px_x1;
+    if (x0 >= x1)
+        return;
+    draw_hline(x0, (int)y, x1 - x0, color);
+    cost_px_push((uint16_t)(x1 - x0));
 }
 
 static const ui_draw_pixel_writer_t k_pixel_writer = {
-    .begin_window = NULL,
+    .begin_window = pixel_begin_window_cb,
     .write_pixel = pixel_write_pixel_cb,
+    .write_run = pixel_write_run_cb,
 };
 
 static void stroke_plot(int x, int y, uint16_t color, void *user)
@@ -135,47 +308,501 @@ static void stroke_rect(int x, int y, int w, int h, uint16_t color, void *user)
     fill_rect((uint16_t)x, (uint16_t)y, (uint16_t)w, (uint16_t)h, color);
 }
 
-static void write_ppm(void)
+/* Cost-only stroke callbacks: the target's stroke path prices each plot as a
+ * one-pixel window and each rect as a fill. */
+static void cost_stroke_plot(int x, int y, uint16_t color, void *user)
+{
+    (void)color;
+    (void)user;
+    if (clip_has(x, y))
+        cost_cpu_pixels(1u, 1u);
+}
+
+static void cost_stroke_rect(int x, int y, int w, int h, uint16_t color, void *user)
+{
+    (void)color;
+    (void)user;
+    if (x < 0 || y < 0 || w <= 0 || h <= 0)
+        return;
+    cost_fill_clipped(x, y, w, h);
+}
+
+/* Replays ui_lcd_draw_text_stroke's bus traffic: opaque glyphs inside the
+ * scissor go out as one cell window, everything else through the stroke path. */
+static void cost_text(int x, int y, const char *text, uint16_t fg, uint16_t bg)
+{
+    if (bg == 0xFFFFu)
+    {
+        ui_font_bitmap_draw_text(cost_stroke_plot, cost_stroke_rect, NULL, x, y, text, fg, bg);
+        return;
+    }
+    int cx = x;
+    for (const char *p = text; *p; ++p)
+    {
+        const ui_font_bitmap_glyph_t *g = ui_font_bitmap_glyph(*p);
+        if (g->w && g->h)
+        {
+            int gx = cx + g->xoff;
+            int gy = y + g->yoff;
+            uint32_t n = (uint32_t)g->w * g->h;
+            if (clip_has(gx, gy) && clip_has(gx + g->w - 1, gy + g->h - 1) && n <= DISP_W)
+            {
+                cost_fill(n, 1u);
+            }
+            else
+            {
+                char one[2] = {*p, '\0'};
+                ui_font_bitmap_draw_text(cost_stroke_plot, cost_stroke_rect, NULL, cx, y, one, fg, bg);
+            }
+        }
+        cx += g->xadv;
+    }
+}
+
+static void write_ppm_file(const char *path)
 {
-    ensure_outdir();
-    const char *dir = get_outdir();
-    char path[512];
-    char latest[512];
-    snprintf(path, sizeof(path), "%s/host_lcd_%04u.ppm", dir, (unsigned)g_frame_counter);
-    snprintf(latest, sizeof(latest), "%s/host_lcd_latest.ppm", dir);
     FILE *f = fopen(path, "wb");
     if (!f)
         return;
-    fprintf(f, "P6\n%u %u\n255\n", DISP_W, DISP_H);
+    static uint8_t rgb[DISP_W * DISP_H * 3u];
     for (size_t i = 0; i < (size_t)DISP_W * DISP_H; ++i)
     {
         uint16_t c = g_fb[i];
-        uint8_t r = (uint8_t)(((c >> 11) & 0x1F) * 255 / 31);
-        uint8_t g = (uint8_t)(((c >> 5) & 0x3F) * 255 / 63);
-        uint8_t b = (uint8_t)((c & 0x1F) * 255 / 31);
-        fputc(r, f);
-        fputc(g, f);
-        fputc(b, f);
+        rgb[i * 3u + 0u] = (uint8_t)(((c >> 11) & 0x1F) * 255 / 31);
+        rgb[i * 3u + 1u] = (uint8_t)(((c >> 5) & 0x3F) * 255 / 63);
+        rgb[i * 3u + 2u] = (uint8_t)((c & 0x1F) * 255 / 31);
     }
+    fprintf(f, "P6\n%u %u\n255\n", DISP_W, DISP_H);
+    fwrite(rgb, 1, sizeof(rgb), f);
     fclose(f);
-    FILE *src = fopen(path, "rb");
-    FILE *dst = fopen(latest, "wb");
-    if (src && dst)
+}
+
+static void write_ppm_latest(void)
+{
+    char latest[512];
+    snprintf(latest, sizeof(latest), "%s/host_lcd_latest.ppm", get_outdir());
+    write_ppm_file(latest);
+}
+
+static void write_ppm(void)
+{
+    ensure_outdir();
+    char path[512];
+    snprintf(path, sizeof(path), "%s/host_lcd_%04u.ppm", get_outdir(), (unsigned)g_frame_counter);
+    write_ppm_file(path);
+    write_ppm_latest();
+}
+
+/*
+ * Frame dump modes (BC280_LCD_DUMP):
+ *   ppm      every drawn frame as host_lcd_NNNN.ppm (default)
+ *   changed  PPM only when the framebuffer hash differs from the last dump
+ *   stream   one host_lcd.blcd container of dirty-rect deltas (below)
+ *   off      nothing
+ * host_lcd_latest.ppm is kept current in every mode but off; in stream mode
+ * it is written once at exit.
+ */
+enum {
+    DUMP_PPM = 0,
+    DUMP_CHANGED,
+    DUMP_STREAM,
+    DUMP_OFF,
+};
+
+static uint8_t g_dump_mode = DUMP_PPM;
+static uint8_t g_dump_mode_inited;
+static uint32_t g_dump_hash;
+static uint8_t g_dump_have_hash;
+static uint32_t g_frame_ms;
+static uint32_t g_chunk_base_us; /* frame cost when the current chunk began */
+
+static void dump_mode_init(void)
+{
+    if (g_dump_mode_inited)
+        return;
+    g_dump_mode_inited = 1;
+    const char *env = getenv("BC280_LCD_DUMP");
+    if (!env || !env[0] || strcmp(env, "ppm") == 0)
+        g_dump_mode = DUMP_PPM;
+    else if (strcmp(env, "changed") == 0)
+        g_dump_mode = DUMP_CHANGED;
+    else if (strcmp(env, "stream") == 0)
+        g_dump_mode = DUMP_STREAM;
+    else if (strcmp(env, "off") == 0)
+        g_dump_mode = DUMP_OFF;
+    else
+        fprintf(stderr, "pixel sink: unknown BC280_LCD_DUMP=%s, using ppm\n", env);
+}
+
+static uint32_t fb_hash(void)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < (size_t)DISP_W * DISP_H; ++i)
     {
-        char buf[4096];
-        size_t n;
-        while ((n = fread(buf, 1, sizeof(buf), src)) > 0)
-            fwrite(buf, 1, n, dst);
+        h = (h ^ (g_fb[i] & 0xFFu)) * 16777619u;
+        h = (h ^ (g_fb[i] >> 8)) * 16777619u;
     }
-    if (src)
-        fclose(src);
-    if (dst)
-        fclose(dst);
+    return h;
+}
+
+/*
+ * Stream container (host byte order is not assumed; all fields LE):
+ *   header  "BLCD" u16 version u16 width u16 height u16 format(1 = RGB565)
+ *           u32 reserved
+ *   frame   u32 frame u32 t_ms u32 fb_hash u16 rects u16 flags(bit0 key)
+ *           rects x { u16 x y w h, u32 bytes, RLE pixels row-major }
+ *   index   "BIDX" u32 count, count x { u32 frame t_ms offset flags }
+ *   trailer u32 index_offset "BEND"
+ * RLE control byte c: bit7 set = (c & 0x7F) + 1 copies of the next pixel,
+ * clear = c + 1 literal pixels follow. `frame` is the drawn-frame number
+ * (host_lcd_NNNN in ppm mode); frames that changed nothing are skipped. A
+ * frame holds the bands of rows that
+ * changed since the previous frame, each cropped to its changed columns;
+ * every BC280_LCD_KEYFRAME frames (default 100) is a full-screen keyframe so
+ * players can seek. scripts/lcd_stream.py decodes it.
+ */
+#define BLCD_VERSION 1u
+#define BLCD_FORMAT_RGB565 1u
+#define BLCD_MAX_RECTS 16u
+#define BLCD_FLAG_KEY 0x0001u
+
+typedef struct {
+    uint32_t frame;
+    uint32_t t_ms;
+    uint32_t offset;
+    uint32_t flags;
+} blcd_index_t;
+
+static struct {
+    FILE *f;
+    uint16_t prev[DISP_W * DISP_H];
+    uint32_t frames;
+    uint32_t keyframe_every;
+    blcd_index_t *index;
+    uint32_t index_cap;
+    uint64_t bytes;
+} g_stream;
+
+static void put_le16(FILE *f, uint16_t v)
+{
+    uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)};
+    fwrite(b, 1, 2, f);
+}
+
+static void put_le32(FILE *f, uint32_t v)
+{
+    uint8_t b[4] = {(uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24)};
+    fwrite(b, 1, 4, f);
+}
+
+static void stream_close(void)
+{
+    if (!g_stream.f)
+        return;
+    uint32_t index_off = (uint32_t)ftell(g_stream.f);
+    fwrite("BIDX", 1, 4, g_stream.f);
+    put_le32(g_stream.f, g_stream.frames);
+    for (uint32_t i = 0; i < g_stream.frames; ++i)
+    {
+        put_le32(g_stream.f, g_stream.index[i].frame);
+        put_le32(g_stream.f, g_stream.index[i].t_ms);
+        put_le32(g_stream.f, g_stream.index[i].offset);
+        put_le32(g_stream.f, g_stream.index[i].flags);
+    }
+    put_le32(g_stream.f, index_off);
+    fwrite("BEND", 1, 4, g_stream.f);
+    fclose(g_stream.f);
+    g_stream.f = NULL;
+    free(g_stream.index);
+    g_stream.index = NULL;
+    write_ppm_latest();
+}
+
+static uint8_t stream_open(void)
+{
+    ensure_outdir();
+    char path[512];
+    snprintf(path, sizeof(path), "%s/host_lcd.blcd", get_outdir());
+    g_stream.f = fopen(path, "wb");
+    if (!g_stream.f)
+    {
+        fprintf(stderr, "pixel sink: cannot write %s\n", path);
+        g_dump_mode = DUMP_OFF;
+        return 0;
+    }
+    const char *env = getenv("BC280_LCD_KEYFRAME");
+    g_stream.keyframe_every = env ? (uint32_t)strtoul(env, NULL, 0) : 100u;
+    if (g_stream.keyframe_every == 0u)
+        g_stream.keyframe_every = 100u;
+    fwrite("BLCD", 1, 4, g_stream.f);
+    put_le16(g_stream.f, BLCD_VERSION);
+    put_le16(g_stream.f, DISP_W);
+    put_le16(g_stream.f, DISP_H);
+    put_le16(g_stream.f, BLCD_FORMAT_RGB565);
+    put_le32(g_stream.f, 0u);
+    atexit(stream_close);
+    return 1;
+}
+
+static uint32_t rle_rect(uint8_t *out, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    uint32_t n = 0;
+    uint32_t count = (uint32_t)w * h;
+    uint32_t i = 0;
+#define RECT_PX(k) g_fb[(size_t)(y + (k) / w) * DISP_W + x + (k) % w]
+    while (i < count)
+    {
+        uint16_t c = RECT_PX(i);
+        uint32_t run = 1;
+        while (i + run < count && run < 128u && RECT_PX(i + run) == c)
+            run++;
+        if (run >= 2u)
+        {
+            out[n++] = (uint8_t)(0x80u | (run - 1u));
+            out[n++] = (uint8_t)c;
+            out[n++] = (uint8_t)(c >> 8);
+            i += run;
+            continue;
+        }
+        uint32_t lit = 1;
+        while (i + lit < count && lit < 128u &&
+               !(i + lit + 1u < count && RECT_PX(i + lit) == RECT_PX(i + lit + 1u)))
+            lit++;
+        out[n++] = (uint8_t)(lit - 1u);
+        for (uint32_t k = 0; k < lit; ++k)
+        {
+            uint16_t p = RECT_PX(i + k);
+            out[n++] = (uint8_t)p;
+            out[n++] = (uint8_t)(p >> 8);
+        }
+        i += lit;
+    }
+#undef RECT_PX
+    return n;
+}
+
+typedef struct {
+    uint16_t x, y, w, h;
+} blcd_rect_t;
+
+/* Bands of consecutive changed rows, each cropped to its changed columns;
+ * past BLCD_MAX_RECTS the last band absorbs the rest. */
+static uint16_t changed_rects(blcd_rect_t *r)
+{
+    uint16_t n = 0;
+    for (uint16_t yy = 0; yy < DISP_H; ++yy)
+    {
+        const uint16_t *row = &g_fb[(size_t)yy * DISP_W];
+        const uint16_t *old = &g_stream.prev[(size_t)yy * DISP_W];
+        int x0 = -1, x1 = -1;
+        for (uint16_t xx = 0; xx < DISP_W; ++xx)
+        {
+            if (row[xx] != old[xx])
+            {
+                if (x0 < 0)
+                    x0 = xx;
+                x1 = xx;
+            }
+        }
+        if (x0 < 0)
+            continue;
+        blcd_rect_t *last = n ? &r[n - 1u] : NULL;
+        if (last && (last->y + last->h == yy || n == BLCD_MAX_RECTS))
+        {
+            uint16_t rx1 = (uint16_t)(last->x + last->w - 1u);
+            if (x0 < last->x)
+                last->x = (uint16_t)x0;
+            if (x1 > rx1)
+                rx1 = (uint16_t)x1;
+            last->w = (uint16_t)(rx1 - last->x + 1u);
+            last->h = (uint16_t)(yy - last->y + 1u);
+            continue;
+        }
+        r[n++] = (blcd_rect_t){(uint16_t)x0, yy, (uint16_t)(x1 - x0 + 1), 1u};
+    }
+    return n;
+}
+
+static void stream_frame(uint32_t hash)
+{
+    if (!g_stream.f && !stream_open())
+        return;
+    blcd_rect_t rects[BLCD_MAX_RECTS];
+    uint16_t flags = 0;
+    uint16_t n;
+    if (g_stream.frames % g_stream.keyframe_every == 0u)
+    {
+        flags = BLCD_FLAG_KEY;
+        rects[0] = (blcd_rect_t){0u, 0u, DISP_W, DISP_H};
+        n = 1u;
+    }
+    else
+    {
+        n = changed_rects(rects);
+        if (n == 0u)
+            return;
+    }
+    if (g_stream.frames == g_stream.index_cap)
+    {
+        g_stream.index_cap = g_stream.index_cap ? g_stream.index_cap * 2u : 256u;
+        g_stream.index = realloc(g_stream.index, g_stream.index_cap * sizeof(*g_stream.index));
+    }
+    g_stream.index[g_stream.frames] = (blcd_index_t){g_frame_counter, g_frame_ms,
+                                                     (uint32_t)ftell(g_stream.f), flags};
+    put_le32(g_stream.f, g_frame_counter);
+    put_le32(g_stream.f, g_frame_ms);
+    put_le32(g_stream.f, hash);
+    put_le16(g_stream.f, n);
+    put_le16(g_stream.f, flags);
+    /* Worst case RLE: one control byte per 128 literal pixels. */
+    static uint8_t buf[DISP_W * DISP_H * 2u + DISP_W * DISP_H / 128u + 1u];
+    for (uint16_t i = 0; i < n; ++i)
+    {
+        uint32_t bytes = rle_rect(buf, rects[i].x, rects[i].y, rects[i].w, rects[i].h);
+        put_le16(g_stream.f, rects[i].x);
+        put_le16(g_stream.f, rects[i].y);
+        put_le16(g_stream.f, rects[i].w);
+        put_le16(g_stream.f, rects[i].h);
+        put_le32(g_stream.f, bytes);
+        fwrite(buf, 1, bytes, g_stream.f);
+    }
+    memcpy(g_stream.prev, g_fb, sizeof(g_fb));
+    g_stream.frames++;
+}
+
+static void dump_frame(void)
+{
+    dump_mode_init();
+    switch (g_dump_mode)
+    {
+    case DUMP_PPM:
+        write_ppm();
+        break;
+    case DUMP_CHANGED:
+    {
+        uint32_t h = fb_hash();
+        if (g_dump_have_hash && h == g_dump_hash)
+            break;
+        g_dump_hash = h;
+        g_dump_have_hash = 1;
+        write_ppm();
+        break;
+    }
+    case DUMP_STREAM:
+        stream_frame(fb_hash());
+        break;
+    default:
+        break;
+    }
+    /* Numbered by drawn frame in every mode, so dumps line up across modes. */
     g_frame_counter++;
 }
+
+/*
+ * BC280_LCD_MIRROR=direct|comp: every primitive is drawn through
+ * gfx/ui_lcd.c as well, into its host panel model, straight or through the
+ * compositor. Each frame end compares that panel with g_fb; with the
+ * compositor, the remote view ui_stream reads is rebuilt from its RLE
+ * chunks and compared too. Sprites are not mirrored: ui_lcd reads them
+ * from SPI flash, which its host build has not got.
+ */
+enum {
+    MIRROR_OFF = 0,
+    MIRROR_DIRECT,
+    MIRROR_COMP,
+};
+
+static struct {
+    uint8_t mode;
+    uint8_t inited;
+    ui_pixel_sink_mirror_t stats;
+    uint16_t remote[DISP_W * DISP_H];
+} g_mirror;
+
+static uint8_t mirror_mode(void)
+{
+    if (g_mirror.inited)
+        return g_mirror.mode;
+    g_mirror.inited = 1;
+    const char *env = getenv("BC280_LCD_MIRROR");
+    if (!env || !env[0] || strcmp(env, "off") == 0)
+        g_mirror.mode = MIRROR_OFF;
+    else if (strcmp(env, "direct") == 0)
+        g_mirror.mode = MIRROR_DIRECT;
+    else if (strcmp(env, "comp") == 0)
+        g_mirror.mode = MIRROR_COMP;
+    else
+        fprintf(stderr, "pixel sink: unknown BC280_LCD_MIRROR=%s, not mirroring\n", env);
+    if (g_mirror.mode)
+        ui_lcd_set_comp_force((uint8_t)(g_mirror.mode == MIRROR_COMP));
+    return g_mirror.mode;
+}
+
+static void mirror_remote_px(const ui_fb8_remote_chunk_t *c, uint32_t pos, const uint8_t *le)
+{
+    uint32_t x = c->x + pos % c->w;
+    uint32_t y = c->y + pos / c->w;
+    if (x < DISP_W && y < DISP_H)
+        g_mirror.remote[y * DISP_W + x] = (uint16_t)(le[0] | (le[1] << 8));
+}
+
+/* Reads everything the remote view has pending, as ui_stream_tick does. */
+static void mirror_remote(void)
+{
+    ui_fb8_remote_chunk_t c;
+    uint8_t rle[180];
+    uint16_t n;
+    while ((n = ui_lcd_remote_next(&c, rle, sizeof(rle))) != 0u)
+    {
+        g_mirror.stats.remote_bytes += n;
+        uint32_t pos = c.pos;
+        uint16_t i = 0u;
+        while (i < n)
+        {
+            /* bit7: (c & 0x7F) + 1 copies of one pixel, else c + 1 literals. */
+            uint8_t ctl = rle[i++];
+            uint16_t count = (uint16_t)((ctl & 0x7Fu) + 1u);
+            if (ctl & 0x80u)
+            {
+                for (uint16_t k = 0; k < count; ++k)
+                    mirror_remote_px(&c, pos++, &rle[i]);
+                i = (uint16_t)(i + 2u);
+                continue;
+            }
+            for (uint16_t k = 0; k < count; ++k, i = (uint16_t)(i + 2u))
+                mirror_remote_px(&c, pos++, &rle[i]);
+        }
+    }
+    if (ui_lcd_remote_pending())
+        return;
+    g_mirror.stats.remote_frames++;
+    if (memcmp(g_mirror.remote, g_fb, sizeof(g_fb)) != 0)
+        g_mirror.stats.remote_diffs++;
+}
+
+static void mirror_end(void)
+{
+    ui_lcd_frame_end();
+    if (!g_frame_pending)
+        return;
+    ui_pixel_sink_mirror_t *m = &g_mirror.stats;
+    if (memcmp(ui_lcd_host_panel(), g_fb, sizeof(g_fb)) != 0 && m->panel_diffs++ == 0u)
+        m->first_diff = g_frame_counter;
+    if (g_mirror.mode == MIRROR_COMP)
+        mirror_remote();
+    m->frames++;
+}
+
+void ui_pixel_sink_mirror_stats(ui_pixel_sink_mirror_t *out)
+{
+    if (out)
+        *out = g_mirror.stats;
+}
+
 __attribute__((used)) void ui_pixel_sink_begin(uint32_t now_ms, uint8_t full)
 {
-    (void)now_ms;
+    SIM_PROF_SIM_ZONE();
+    g_frame_ms = now_ms;
     if (!g_inited)
     {
         clear_fb(0x0000u);
@@ -183,37 +810,144 @@ __attribute__((used)) void ui_pixel_sink_begin(uint32_t now_ms, uint8_t full)
     }
     if (full)
         clear_fb(0x0000u);
+    if (mirror_mode())
+    {
+        ui_lcd_frame_begin(0u, DISP_H - 1u);
+        if (full)
+        {
+            /* The same clear, as a draw the compositor sees. */
+            ui_lcd_set_clip(0u, 0u, DISP_W, DISP_H);
+            ui_lcd_fill_rect(0u, 0u, DISP_W, DISP_H, 0x0000u);
+            ui_lcd_set_clip((uint16_t)g_clip_x0, (uint16_t)g_clip_y0,
+                            (uint16_t)(g_clip_x1 - g_clip_x0), (uint16_t)(g_clip_y1 - g_clip_y0));
+        }
+    }
     g_frame_pending = 0;
+    cost_model_init();
+    memset(g_cost, 0, sizeof(g_cost));
+    g_cost_prim = UI_PERF_PRIM_FILL;
+    g_chunk_base_us = 0u;
+}
+
+void ui_pixel_sink_resume(void)
+{
+    if (mirror_mode())
+        ui_lcd_frame_resume();
+    ui_lcd_cost_t total;
+    ui_pixel_sink_frame_cost(&total, NULL);
+    g_chunk_base_us = total.est_us;
+}
+
+uint32_t ui_pixel_sink_chunk_us(void)
+{
+    ui_lcd_cost_t total;
+    ui_pixel_sink_frame_cost(&total, NULL);
+    return total.est_us - g_chunk_base_us;
+}
+
+void ui_pixel_sink_set_dump(uint8_t enabled)
+{
+    g_dump = enabled;
+}
+
+const uint16_t *ui_pixel_sink_framebuffer(void)
+{
+    return g_fb;
 }
 
 void ui_pixel_sink_end(void)
 {
-    if (g_frame_pending)
-        write_ppm();
+    SIM_PROF_SIM_ZONE();
+    if (mirror_mode())
+        mirror_end();
+    if (g_frame_pending && g_dump)
+        dump_frame();
+}
+
+void ui_pixel_sink_get_cost_model(ui_lcd_cost_model_t *out)
+{
+    cost_model_init();
+    if (out)
+        *out = g_cost_model;
+}
+
+void ui_pixel_sink_set_cost_model(const ui_lcd_cost_model_t *model)
+{
+    g_cost_model_inited = 1;
+    if (model)
+        g_cost_model = *model;
+}
+
+void ui_pixel_sink_frame_cost(ui_lcd_cost_t *total, ui_lcd_cost_t prims[UI_PERF_PRIM_COUNT])
+{
+    ui_lcd_cost_t sum = {0};
+    for (uint8_t i = 0; i < UI_PERF_PRIM_COUNT; ++i)
+    {
+        ui_lcd_cost_t c = g_cost[i];
+        cost_finish(&c);
+        if (prims)
+            prims[i] = c;
+        sum.windows += c.windows;
+        sum.pixels += c.pixels;
+        sum.px_calls += c.px_calls;
+        sum.dma_starts += c.dma_starts;
+    }
+    cost_finish(&sum);
+    if (total)
+        *total = sum;
 }
 
 void ui_pixel_sink_draw_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
 {
+    SIM_PROF_SIM_ZONE();
+    g_cost_prim = UI_PERF_PRIM_FILL;
     fill_rect(x, y, w, h, color);
+    cost_fill_clipped((int)x, (int)y, (int)w, (int)h);
+    if (mirror_mode())
+        ui_lcd_fill_rect(x, y, w, h, color);
     g_frame_pending = 1;
 }
 
 void ui_pixel_sink_draw_round_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color, uint8_t radius)
 {
+    SIM_PROF_SIM_ZONE();
+    g_cost_prim = UI_PERF_PRIM_FILL;
     ui_draw_fill_round_rect(&k_pixel_rect_ops, NULL, x, y, w, h, color, radius);
+    if (mirror_mode())
+        ui_lcd_fill_round_rect(x, y, w, h, color, radius);
     g_frame_pending = 1;
 }
 
 void ui_pixel_sink_draw_round_rect_dither(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
                                           uint16_t color, uint16_t alt, uint8_t radius, uint8_t level)
 {
+    SIM_PROF_SIM_ZONE();
+    g_cost_prim = UI_PERF_PRIM_FILL;
     ui_draw_fill_round_rect_dither(&k_pixel_rect_ops, NULL, x, y, w, h, color, alt, radius, level);
+    if (mirror_mode())
+        ui_lcd_fill_round_rect_dither(x, y, w, h, color, alt, radius, level);
+    g_frame_pending = 1;
+}
+
+void ui_pixel_sink_draw_panel(const ui_draw_panel_t *panel)
+{
+    SIM_PROF_SIM_ZONE();
+    g_cost_prim = UI_PERF_PRIM_FILL;
+    ui_draw_fill_panel(&k_pixel_rect_ops, NULL, panel);
+    if (mirror_mode())
+        ui_lcd_fill_panel(panel);
     g_frame_pending = 1;
 }
 
 void ui_pixel_sink_draw_text(uint16_t x, uint16_t y, const char *text, uint16_t fg, uint16_t bg)
 {
+    SIM_PROF_SIM_ZONE();
+    g_cost_prim = UI_PERF_PRIM_TEXT;
     ui_font_bitmap_draw_text(stroke_plot, stroke_rect, NULL, (int)x, (int)y, text, fg, bg);
+    if (text)
+        cost_text((int)x, (int)y, text, fg, bg);
+    if (mirror_mode())
+        ui_lcd_draw_text_stroke(x, y, text, fg, bg);
     g_frame_pending = 1;
 }
 
@@ -226,17 +960,40 @@ void ui_pixel_sink_draw_value(uint16_t x, uint16_t y, const char *label, int32_t
 
 void ui_pixel_sink_draw_big_digit(uint16_t x, uint16_t y, uint8_t digit, uint8_t scale, uint16_t color)
 {
+    SIM_PROF_SIM_ZONE();
+    g_cost_prim = UI_PERF_PRIM_FILL;
     ui_draw_big_digit_7seg(&k_pixel_rect_ops, NULL, x, y, digit, scale, color);
+    if (mirror_mode())
+        ui_lcd_draw_big_digit_7seg(x, y, digit, scale, color);
+    g_frame_pending = 1;
+}
+void ui_pixel_sink_draw_glyph(uint16_t x, uint16_t y, const ui_draw_glyph_t *g)
+{
+    SIM_PROF_SIM_ZONE();
+    if (!g || (uint32_t)x + g->w + g->shadow_ofs > DISP_W || (uint32_t)y + g->h + g->shadow_ofs > DISP_H)
+        return;
+    g_cost_prim = UI_PERF_PRIM_TEXT;
+    ui_draw_glyph_a4(&k_pixel_writer, NULL, x, y, g);
+    if (mirror_mode())
+        ui_lcd_draw_glyph(x, y, g);
     g_frame_pending = 1;
 }
 __attribute__((used)) void ui_pixel_sink_draw_battery_icon(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t soc, uint16_t color, uint16_t bg)
 {
+    SIM_PROF_SIM_ZONE();
+    g_cost_prim = UI_PERF_PRIM_FILL;
     ui_draw_battery_icon_ops(&k_pixel_rect_ops, NULL, x, y, w, h, soc, color, bg);
+    if (mirror_mode())
+        ui_lcd_draw_battery_icon(x, y, w, h, soc, color, bg);
     g_frame_pending = 1;
 }
 __attribute__((used)) void ui_pixel_sink_draw_warning_icon(uint16_t x, uint16_t y, uint16_t color)
 {
+    SIM_PROF_SIM_ZONE();
+    g_cost_prim = UI_PERF_PRIM_FILL;
     ui_draw_warning_icon_ops(&k_pixel_rect_ops, NULL, x, y, color);
+    if (mirror_mode())
+        ui_lcd_draw_warning_icon(x, y, color);
     g_frame_pending = 1;
 }
 __attribute__((used)) void ui_pixel_sink_draw_ring_arc_a4(uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
@@ -244,8 +1001,13 @@ __attribute__((used)) void ui_pixel_sink_draw_ring_arc_a4(uint16_t clip_x, uint1
                                     int16_t start_deg_cw, uint16_t sweep_deg_cw,
                                     uint16_t fg, uint16_t bg)
 {
+    SIM_PROF_SIM_ZONE();
+    g_cost_prim = UI_PERF_PRIM_ARC;
     ui_draw_ring_arc_a4(&k_pixel_writer, NULL, clip_x, clip_y, clip_w, clip_h,
                         cx, cy, outer_r, thickness, start_deg_cw, sweep_deg_cw, fg, bg);
+    if (mirror_mode())
+        ui_lcd_draw_ring_arc_a4(clip_x, clip_y, clip_w, clip_h, cx, cy, outer_r, thickness,
+                                start_deg_cw, sweep_deg_cw, fg, bg);
     g_frame_pending = 1;
 }
 __attribute__((used)) void ui_pixel_sink_draw_ring_gauge_a4(uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
@@ -253,8 +1015,96 @@ __attribute__((used)) void ui_pixel_sink_draw_ring_gauge_a4(uint16_t clip_x, uin
                                       int16_t start_deg_cw, uint16_t sweep_deg_cw, uint16_t active_sweep_deg_cw,
                                       uint16_t fg_active, uint16_t fg_inactive, uint16_t bg)
 {
+    SIM_PROF_SIM_ZONE();
+    g_cost_prim = UI_PERF_PRIM_ARC;
     ui_draw_ring_gauge_a4(&k_pixel_writer, NULL, clip_x, clip_y, clip_w, clip_h,
                           cx, cy, outer_r, thickness, start_deg_cw, sweep_deg_cw, active_sweep_deg_cw,
                           fg_active, fg_inactive, bg);
+    if (mirror_mode())
+        ui_lcd_draw_ring_gauge_a4(clip_x, clip_y, clip_w, clip_h, cx, cy, outer_r, thickness,
+                                  start_deg_cw, sweep_deg_cw, active_sweep_deg_cw,
+                                  fg_active, fg_inactive, bg);
     g_frame_pending = 1;
 }
+
+static ui_pixel_sink_flash_read_fn g_flash_read;
+
+void ui_pixel_sink_set_flash_read(ui_pixel_sink_flash_read_fn fn)
+{
+    g_flash_read = fn;
+}
+
+/* Costed as on target: RGB565 is one window and one flash->panel DMA (a DMA
+ * per row when the scissor cuts columns), A4 one window and a line DMA per
+ * visible row. */
+void ui_pixel_sink_draw_sprite(uint16_t x, uint16_t y, const ui_sprite_t *sp, uint16_t fg, uint16_t bg)
+{
+    SIM_PROF_SIM_ZONE();
+    if (!sp || !g_flash_read || sp->w > DISP_W)
+        return;
+    int cx = (int)x, cy = (int)y, cw = (int)sp->w, ch = (int)sp->h;
+    if (!clip_rect(&cx, &cy, &cw, &ch))
+        return;
+    g_cost_prim = UI_PERF_PRIM_BLIT;
+    if (sp->fmt == UI_SPRITE_FMT_RGB565)
+    {
+        uint8_t raw[DISP_W * 2u];
+        for (uint16_t row = 0; row < sp->h; ++row)
+        {
+            g_flash_read(sp->addr + (uint32_t)row * sp->w * 2u, raw, (uint32_t)sp->w * 2u);
+            for (uint16_t i = 0; i < sp->w; ++i)
+                set_px((int)x + i, (int)y + row, (uint16_t)((raw[2u * i] << 8) | raw[2u * i + 1u]));
+        }
+        if (cw == (int)sp->w)
+        {
+            cost_fill((uint32_t)cw, (uint32_t)ch);
+        }
+        else
+        {
+            g_cost[g_cost_prim].windows++;
+            for (int row = 0; row < ch; ++row)
+                cost_line((uint32_t)cw);
+        }
+        g_frame_pending = 1;
+        return;
+    }
+    if (sp->fmt != UI_SPRITE_FMT_A4_RLE || sp->len > UI_SPRITE_A4_MAX_BYTES)
+        return;
+    uint8_t rle[UI_SPRITE_A4_MAX_BYTES];
+    uint16_t line[DISP_W];
+    g_flash_read(sp->addr, rle, sp->len);
+    uint32_t off = 0u;
+    for (uint16_t row = 0; row < sp->h; ++row)
+    {
+        uint32_t used = ui_draw_a4_rle_row(&rle[off], sp->len - off, sp->w, fg, bg, line);
+        if (used == 0u)
+        {
+            for (uint16_t i = 0; i < sp->w; ++i)
+                line[i] = bg;
+        }
+        off += used;
+        for (uint16_t i = 0; i < sp->w; ++i)
+            set_px((int)x + i, (int)y + row, line[i]);
+    }
+    cost_fill((uint32_t)cw, 1u);
+    for (int row = 1; row < ch; ++row)
+        cost_line((uint32_t)cw);
+    g_frame_pending = 1;
+}
+
+void ui_pixel_sink_set_clip(uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    int cx = (int)x, cy = (int)y, cw = (int)w, ch = (int)h;
+    g_clip_x0 = 0;
+    g_clip_y0 = 0;
+    g_clip_x1 = DISP_W;
+    g_clip_y1 = DISP_H;
+    if (!clip_rect(&cx, &cy, &cw, &ch))
+        cw = ch = 0;
+    g_clip_x0 = cx;
+    g_clip_y0 = cy;
+    g_clip_x1 = cx + cw;
+    g_clip_y1 = cy + ch;
+    if (mirror_mode())
+        ui_lcd_set_clip(x, y, w, h);
+}
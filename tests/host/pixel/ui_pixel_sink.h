@@ -3,16 +3,68 @@
 
 #include <stdint.h>
 
+#include "ui_draw_common.h"
+#include "ui_perf.h"
+
+/*
+ * LCD bus cost model. Each sink primitive replays the bus traffic that
+ * gfx/ui_lcd.c generates for the same call on target (address windows,
+ * pixel words, pixel-writer calls, line/fill DMA starts) and prices it, so a
+ * host run can estimate what a frame costs on the 8080/FSMC bus. Transfers
+ * are summed serially: target DMA overlaps the next line's rasterization,
+ * so the estimate is an upper bound on bus time.
+ */
+typedef struct {
+    uint32_t windows;    /* CASET + RASET + RAMWR sequences */
+    uint32_t pixels;     /* 16-bit pixel words */
+    uint32_t px_calls;   /* write_pixel / write_run / stroke plot calls */
+    uint32_t dma_starts; /* line or fill transfers */
+    uint32_t est_us;
+} ui_lcd_cost_t;
+
+/*
+ * Unit costs in ns. The defaults follow the OEM FSMC timing (BTR1 ADDSET=1,
+ * DATAST=1, ~5 HCLK per write at 72 MHz) and the driver paths in
+ * gfx/ui_lcd.c; re-fit them against target ui_perf numbers and override with
+ * BC280_LCD_COST_NS="window,pixel,px_call,dma_start".
+ */
+typedef struct {
+    uint32_t window_ns;
+    uint32_t pixel_ns;
+    uint32_t px_call_ns;
+    uint32_t dma_start_ns;
+} ui_lcd_cost_model_t;
+
+void ui_pixel_sink_get_cost_model(ui_lcd_cost_model_t *out);
+void ui_pixel_sink_set_cost_model(const ui_lcd_cost_model_t *model);
+/* Cost of the last begin..end frame, in total and per UI_PERF_PRIM_* (either
+ * pointer may be NULL). */
+void ui_pixel_sink_frame_cost(ui_lcd_cost_t *total, ui_lcd_cost_t prims[UI_PERF_PRIM_COUNT]);
+
+/* PPM dumps on frame end; on by default, benchmarks turn them off. */
+void ui_pixel_sink_set_dump(uint8_t enabled);
+/* The DISP_W x DISP_H RGB565 framebuffer, row-major. */
+const uint16_t *ui_pixel_sink_framebuffer(void);
+
 void ui_pixel_sink_begin(uint32_t now_ms, uint8_t full);
+/* Draws the next chunk of a progressive frame: nothing is cleared and the
+ * frame cost keeps adding up until ui_pixel_sink_end. */
+void ui_pixel_sink_resume(void);
+/* Bus estimate since the last begin or resume; the host render budget clock. */
+uint32_t ui_pixel_sink_chunk_us(void);
 void ui_pixel_sink_end(void);
+/* Scissor as ui_lcd_set_clip: (0, 0, DISP_W, DISP_H) turns it off. */
+void ui_pixel_sink_set_clip(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
 
 void ui_pixel_sink_draw_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
 void ui_pixel_sink_draw_round_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color, uint8_t radius);
 void ui_pixel_sink_draw_round_rect_dither(uint16_t x, uint16_t y, uint16_t w, uint16_t h,
                                           uint16_t color, uint16_t alt, uint8_t radius, uint8_t level);
+void ui_pixel_sink_draw_panel(const ui_draw_panel_t *panel);
 void ui_pixel_sink_draw_text(uint16_t x, uint16_t y, const char *text, uint16_t fg, uint16_t bg);
 void ui_pixel_sink_draw_value(uint16_t x, uint16_t y, const char *label, int32_t value, uint16_t fg, uint16_t bg);
 void ui_pixel_sink_draw_big_digit(uint16_t x, uint16_t y, uint8_t digit, uint8_t scale, uint16_t color);
+void ui_pixel_sink_draw_glyph(uint16_t x, uint16_t y, const ui_draw_glyph_t *g);
 void ui_pixel_sink_draw_battery_icon(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint8_t soc, uint16_t color, uint16_t bg);
 void ui_pixel_sink_draw_warning_icon(uint16_t x, uint16_t y, uint16_t color);
 void ui_pixel_sink_draw_ring_arc_a4(uint16_t clip_x, uint16_t clip_y, uint16_t clip_w, uint16_t clip_h,
@@ -24,4 +76,23 @@ void ui_pixel_sink_draw_ring_gauge_a4(uint16_t clip_x, uint16_t clip_y, uint16_t
                                       int16_t start_deg_cw, uint16_t sweep_deg_cw, uint16_t active_sweep_deg_cw,
                                       uint16_t fg_active, uint16_t fg_inactive, uint16_t bg);
 
+/* BC280_LCD_MIRROR=direct|comp also draws every frame through gfx/ui_lcd.c
+ * (straight or through the compositor) and compares it with the sink's
+ * framebuffer at frame end; frames stays 0 with it off. */
+typedef struct {
+    uint32_t frames;
+    uint32_t panel_diffs;   /* frames whose ui_lcd host panel differed */
+    uint32_t first_diff;    /* dump number of the first of them */
+    uint32_t remote_frames; /* comp: frames the remote view was fully read */
+    uint32_t remote_diffs;  /* of those, frames it differed */
+    uint32_t remote_bytes;  /* RLE bytes read */
+} ui_pixel_sink_mirror_t;
+void ui_pixel_sink_mirror_stats(ui_pixel_sink_mirror_t *out);
+
+/* Sprites live in SPI flash; the host build that stores an asset pack hands
+ * the sink its flash read (spi_flash_read). Without one sprites draw nothing. */
+typedef void (*ui_pixel_sink_flash_read_fn)(uint32_t addr, uint8_t *out, uint32_t len);
+void ui_pixel_sink_set_flash_read(ui_pixel_sink_flash_read_fn fn);
+void ui_pixel_sink_draw_sprite(uint16_t x, uint16_t y, const ui_sprite_t *sp, uint16_t fg, uint16_t bg);
+
 #endif
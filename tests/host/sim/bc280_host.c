@@ -0,0 +1,170 @@
+#define _DEFAULT_SOURCE
+
+#include "bc280_host.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sim_full.h"
+#include "sim_uart.h"
+#include "ui_display.h"
+#include "ui_pixel_sink.h"
+
+struct bc280_host {
+    sim_full_t full;
+    sim_scenario_t scenario;
+    uint8_t failed;
+};
+
+static bc280_host_t g_host;
+static uint8_t g_host_live;
+
+/* KEY=VALUE tokens into the environment, as host_sim --jobs lines. */
+static void apply_config(const char *config)
+{
+    if (!config)
+        return;
+    char *copy = strdup(config);
+    if (!copy)
+        return;
+    for (char *tok = strtok(copy, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n"))
+    {
+        char *eq = strchr(tok, '=');
+        if (!eq)
+            continue;
+        *eq = '\0';
+        setenv(tok, eq + 1, 1);
+    }
+    free(copy);
+}
+
+uint32_t bc280_host_api_version(void)
+{
+    return BC280_HOST_API_VERSION;
+}
+
+bc280_host_t *bc280_host_create(const char *config)
+{
+    if (g_host_live)
+        return NULL;
+    bc280_host_t *h = &g_host;
+    memset(h, 0, sizeof(*h));
+    apply_config(config);
+
+    sim_scenario_t *scn = NULL;
+    const char *scn_env = getenv("BC280_SIM_SCENARIO");
+    if (scn_env && scn_env[0])
+    {
+        if (!sim_scenario_load(&h->scenario, scn_env))
+            return NULL;
+        scn = &h->scenario;
+    }
+    const char *dt_env = getenv("BC280_SIM_DT_MS");
+    uint32_t dt_ms = dt_env ? (uint32_t)strtoul(dt_env, NULL, 0) : UI_TICK_MS;
+    if (dt_ms == 0)
+        return NULL;
+
+    ui_pixel_sink_set_dump(0u);
+    if (!sim_full_begin(&h->full, scn, dt_ms, getenv("BC280_SIM_OUTDIR")))
+    {
+        sim_full_end(&h->full);
+        return NULL;
+    }
+    g_host_live = 1u;
+    return h;
+}
+
+void bc280_host_destroy(bc280_host_t *h)
+{
+    if (!h || !g_host_live)
+        return;
+    sim_full_end(&h->full);
+    g_host_live = 0u;
+}
+
+uint32_t bc280_host_step(bc280_host_t *h, uint32_t ms)
+{
+    if (!h || h->failed)
+        return 0;
+    uint32_t steps = (ms + h->full.dt_ms - 1u) / h->full.dt_ms;
+    for (uint32_t i = 0; i < steps; ++i)
+    {
+        if (!sim_full_step(&h->full))
+        {
+            h->failed = 1u;
+            return i + 1u;
+        }
+    }
+    return steps;
+}
+
+size_t bc280_host_inject(bc280_host_t *h, uint8_t port, const uint8_t *data, size_t len)
+{
+    if (!h || !data || port > BC280_HOST_PORT_MOTOR)
+        return 0;
+    sim_uart_rx_push((port == BC280_HOST_PORT_BLE) ? SIM_UART1 : SIM_UART2, data, len);
+    return len;
+}
+
+void bc280_host_hold_buttons(bc280_host_t *h, uint8_t mask)
+{
+    if (!h)
+        return;
+    h->full.btn_mask = mask;
+    h->full.btn_env = 1u;
+    h->full.btn_seq_len = 0;
+}
+
+void bc280_host_press(bc280_host_t *h, uint8_t mask)
+{
+    if (!h)
+        return;
+    h->full.scn_buttons = mask;
+    h->full.scn_button_due = 1u;
+}
+
+void bc280_host_set_page(bc280_host_t *h, int page)
+{
+    if (h)
+        h->full.force_page = page;
+}
+
+void bc280_host_set_ride(bc280_host_t *h, double power_w, double grade)
+{
+    if (!h)
+        return;
+    sim_dwg_motor_set_rider_power(&h->full.motor, power_w);
+    sim_dwg_motor_set_grade(&h->full.motor, grade);
+}
+
+const uint16_t *bc280_host_framebuffer(bc280_host_t *h, uint16_t *w, uint16_t *hgt)
+{
+    if (w)
+        *w = DISP_W;
+    if (hgt)
+        *hgt = DISP_H;
+    return h ? ui_pixel_sink_framebuffer() : NULL;
+}
+
+void bc280_host_metrics(bc280_host_t *h, bc280_host_metrics_t *out)
+{
+    if (!out)
+        return;
+    memset(out, 0, sizeof(*out));
+    if (!h)
+        return;
+    const sim_full_t *f = &h->full;
+    out->now_ms = f->now_ms;
+    out->steps = f->steps;
+    out->ui_frames = f->ui_frames;
+    out->frame_hash = f->frame_hash;
+    out->lcd_avg_us = f->lcd_frames ? (uint32_t)(f->lcd_sum_us / f->lcd_frames) : 0u;
+    out->lcd_max_us = f->lcd_max_us;
+    out->lcd_tick_max_us = f->lcd_tick_max_us;
+    out->energy_mwh = (int32_t)f->energy_mwh;
+    out->dist_m = (uint32_t)f->dist_m;
+    out->ble_cmds = f->ble_cmds;
+    out->speed_dmph = sim_dwg_motor_speed_dmph(&f->motor);
+    out->soc_pct = f->motor.bike.soc_pct;
+    out->failed = h->failed;
+}
@@ -0,0 +1,72 @@
+#ifndef BC280_HOST_H
+#define BC280_HOST_H
+
+/*
+ * libbc280_host: the full host sim (sim_full.h) as a shared library, for
+ * tooling that wants thousands of runs or frames without a host_sim
+ * process and PPM files per step. scripts/bc280_host.py wraps it with
+ * ctypes.
+ *
+ * The firmware keeps its state in file-scope globals, so only one context
+ * can be live per process; create() fails while another is. Destroying it
+ * and creating a new one re-runs every init, as a fresh host_sim would.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BC280_HOST_API_VERSION 1u
+
+/* bc280_host_inject() ports. */
+#define BC280_HOST_PORT_BLE 0u   /* UART1: TTM/BLE side */
+#define BC280_HOST_PORT_MOTOR 1u /* UART2: controller side */
+
+typedef struct bc280_host bc280_host_t;
+
+/* Deterministic run metrics, as on the SIM METRICS line. */
+typedef struct {
+    uint32_t now_ms;
+    uint32_t steps;
+    uint32_t ui_frames;
+    uint32_t frame_hash;
+    uint32_t lcd_avg_us;
+    uint32_t lcd_max_us;
+    uint32_t lcd_tick_max_us;
+    int32_t energy_mwh;
+    uint32_t dist_m;
+    uint32_t ble_cmds;
+    uint16_t speed_dmph;
+    uint8_t soc_pct;
+    uint8_t failed;         /* a render blew its budget; step() stops */
+} bc280_host_metrics_t;
+
+uint32_t bc280_host_api_version(void);
+
+/* config is "KEY=VALUE ..." with the host_sim knobs (BC280_SIM_SCENARIO,
+ * BC280_SIM_DT_MS, BC280_SIM_RIDER_POWER, ...), set in the environment
+ * before init; NULL for defaults. PPM dumps are off. Returns NULL while
+ * another context is live, or on a bad knob or scenario. */
+bc280_host_t *bc280_host_create(const char *config);
+void bc280_host_destroy(bc280_host_t *h);
+
+/* Runs whole dt steps (BC280_SIM_DT_MS, default UI_TICK_MS) covering ms.
+ * Returns the steps run. */
+uint32_t bc280_host_step(bc280_host_t *h, uint32_t ms);
+
+/* Queues bytes on a display RX line. Returns the bytes accepted. */
+size_t bc280_host_inject(bc280_host_t *h, uint8_t port, const uint8_t *data, size_t len);
+/* Buttons held from the next step on (OEM_BTN_* mask); replaces the
+ * default MENU/POWER walk and BC280_SIM_BUTTONS_SEQ. */
+void bc280_host_hold_buttons(bc280_host_t *h, uint8_t mask);
+/* Buttons for the next UI tick only, as a scenario "button" entry. */
+void bc280_host_press(bc280_host_t *h, uint8_t mask);
+/* ui_page_t to render, or -1 for the dashboard default. */
+void bc280_host_set_page(bc280_host_t *h, int page);
+/* Rider power in W and road grade as a ratio (0.05 = 5 %). */
+void bc280_host_set_ride(bc280_host_t *h, double power_w, double grade);
+
+/* The RGB565 framebuffer as last drawn, row-major; *w and *h get its size. */
+const uint16_t *bc280_host_framebuffer(bc280_host_t *h, uint16_t *w, uint16_t *hgt);
+void bc280_host_metrics(bc280_host_t *h, bc280_host_metrics_t *out);
+
+#endif
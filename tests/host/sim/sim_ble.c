@@ -2,6 +2,7 @@
 #include "sim_uart.h"
 #include "util/byteorder.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 /* ============================================================================
@@ -927,3 +928,266 @@ size_t sim_ble_build_get_batt_stats(uint8_t *out, size_t cap)
 {
     return sim_ble_build_command(SIM_BLE_CMD_GET_BATT_STATS, NULL, 0, out, cap);
 }
+
+/* ============================================================================
+ * Load generator
+ * ============================================================================
+ */
+
+static uint8_t hex_nibble(char c, int *ok)
+{
+    if (c >= '0' && c <= '9')
+        return (uint8_t)(c - '0');
+    if (c >= 'a' && c <= 'f')
+        return (uint8_t)(c - 'a' + 10);
+    if (c >= 'A' && c <= 'F')
+        return (uint8_t)(c - 'A' + 10);
+    *ok = 0;
+    return 0;
+}
+
+static void load_default_payload(sim_ble_load_cmd_t *c)
+{
+    switch (c->cmd)
+    {
+    case 0x3Du: /* ride/event/stream log read: offset 0, as many as fit */
+    case 0x41u:
+    case 0x45u:
+        c->len = 3u;
+        break;
+    case 0x0Du: /* set_stream: 100 ms */
+        c->len = 2u;
+        store_be16(c->payload, 100u);
+        break;
+    default:
+        break;
+    }
+}
+
+int sim_ble_load_config(sim_ble_load_t *l, const char *mix, const char *fps, const char *baud)
+{
+    if (!l)
+        return 0;
+    memset(l, 0, sizeof(*l));
+    l->rng = 0x2545F491u;
+    l->offered_fps = fps ? (uint16_t)strtoul(fps, NULL, 0) : 10u;
+    l->baud = baud ? (uint32_t)strtoul(baud, NULL, 0) : 9600u;
+    if (!mix || !mix[0])
+        return 1;
+    if (!l->offered_fps || l->baud < 10u)
+        return 0;
+
+    const char *s = mix;
+    while (*s)
+    {
+        if (l->mix_count >= SIM_BLE_LOAD_MIX_MAX)
+            return 0;
+        sim_ble_load_cmd_t *c = &l->mix[l->mix_count];
+        int ok = 1;
+        c->cmd = (uint8_t)(hex_nibble(s[0], &ok) << 4);
+        c->cmd |= ok ? hex_nibble(s[1], &ok) : 0u;
+        if (!ok)
+            return 0;
+        s += 2;
+        if (*s == '/')
+        {
+            ++s;
+            while (*s && *s != ':' && *s != ',')
+            {
+                if (c->len >= SIM_BLE_LOAD_PAYLOAD_MAX)
+                    return 0;
+                uint8_t b = (uint8_t)(hex_nibble(s[0], &ok) << 4);
+                b |= ok ? hex_nibble(s[1], &ok) : 0u;
+                if (!ok)
+                    return 0;
+                c->payload[c->len++] = b;
+                s += 2;
+            }
+        }
+        else
+        {
+            load_default_payload(c);
+        }
+        c->weight = 1u;
+        if (*s == ':')
+        {
+            char *end;
+            c->weight = (uint8_t)strtoul(s + 1, &end, 0);
+            s = end;
+        }
+        if (!c->weight)
+            return 0;
+        l->weight_total += c->weight;
+        l->mix_count++;
+        if (*s == ',')
+            ++s;
+        else if (*s)
+            return 0;
+    }
+    l->enabled = 1u;
+    return 1;
+}
+
+static const sim_ble_load_cmd_t *load_pick(sim_ble_load_t *l)
+{
+    l->rng ^= l->rng << 13;
+    l->rng ^= l->rng >> 17;
+    l->rng ^= l->rng << 5;
+    uint32_t r = l->rng % l->weight_total;
+    for (uint8_t i = 0; i < l->mix_count; ++i)
+    {
+        if (r < l->mix[i].weight)
+            return &l->mix[i];
+        r -= l->mix[i].weight;
+    }
+    return &l->mix[0];
+}
+
+static void load_offer(sim_ble_load_t *l, uint32_t t_ms)
+{
+    const sim_ble_load_cmd_t *c = load_pick(l);
+    uint8_t frame[SIM_BLE_LOAD_PAYLOAD_MAX + 8u];
+    size_t flen = sim_ble_build_command(c->cmd, c->payload, c->len, frame, sizeof(frame));
+    l->offered++;
+    if (!flen || l->up_len + flen > SIM_BLE_LOAD_TTM_BUF)
+    {
+        l->ttm_drops++;
+        return;
+    }
+    memcpy(&l->up[l->up_len], frame, flen);
+    l->up_len = (uint16_t)(l->up_len + flen);
+    l->sent++;
+    if (l->pending_count == SIM_BLE_LOAD_PENDING)
+    {
+        /* The oldest request gives way; it is as good as lost. */
+        memmove(&l->pending[0], &l->pending[1], (SIM_BLE_LOAD_PENDING - 1u) * sizeof(l->pending[0]));
+        l->pending_count--;
+        l->timeouts++;
+    }
+    l->pending[l->pending_count++] = (sim_ble_load_req_t){ c->cmd, t_ms };
+}
+
+static void load_reply(sim_ble_load_t *l, uint8_t cmd, uint32_t t_ms)
+{
+    if (cmd == 0x81u)
+    {
+        if (l->stream_frames && t_ms - l->last_stream_ms > l->stream_gap_max_ms)
+            l->stream_gap_max_ms = t_ms - l->last_stream_ms;
+        l->last_stream_ms = t_ms;
+        l->stream_frames++;
+        return;
+    }
+    if (!(cmd & 0x80u))
+        return;
+    for (uint8_t i = 0; i < l->pending_count; ++i)
+    {
+        if (l->pending[i].cmd != (uint8_t)(cmd & 0x7Fu))
+            continue;
+        uint32_t lat = t_ms - l->pending[i].t_ms;
+        l->replies++;
+        l->lat_sum_ms += lat;
+        if (lat > l->lat_max_ms)
+            l->lat_max_ms = lat;
+        uint32_t b = lat / SIM_BLE_LOAD_BUCKET_MS;
+        l->lat_hist[b < SIM_BLE_LOAD_BUCKETS ? b : SIM_BLE_LOAD_BUCKETS - 1u]++;
+        memmove(&l->pending[i], &l->pending[i + 1u],
+                (size_t)(l->pending_count - i - 1u) * sizeof(l->pending[0]));
+        l->pending_count--;
+        return;
+    }
+}
+
+/* Bytes the link can carry in dt_ms; credit carries the remainder. */
+static uint32_t load_link_bytes(uint32_t baud, uint32_t *credit, uint32_t dt_ms)
+{
+    *credit += baud / 10u * dt_ms;
+    uint32_t n = *credit / 1000u;
+    *credit %= 1000u;
+    return n;
+}
+
+void sim_ble_load_tick(sim_ble_load_t *l, uint32_t t_ms, uint32_t dt_ms)
+{
+    if (!l || !l->enabled)
+        return;
+    l->active_ms += dt_ms;
+
+    l->frame_credit += (uint32_t)l->offered_fps * dt_ms;
+    while (l->frame_credit >= 1000u)
+    {
+        l->frame_credit -= 1000u;
+        load_offer(l, t_ms);
+    }
+
+    uint32_t n = load_link_bytes(l->baud, &l->up_credit, dt_ms);
+    if (n > l->up_len)
+        n = l->up_len;
+    if (n)
+    {
+        sim_uart_rx_push(SIM_UART1, l->up, n);
+        memmove(l->up, &l->up[n], l->up_len - n);
+        l->up_len = (uint16_t)(l->up_len - n);
+        l->up_bytes += n;
+    }
+
+    n = load_link_bytes(l->baud, &l->down_credit, dt_ms);
+    if (n > l->down_len)
+        n = l->down_len;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint8_t frame_len = 0;
+        comm_parse_result_t res = comm_parser_feed(l->parse_frame, sizeof(l->parse_frame),
+                                                   COMM_MAX_PAYLOAD, &l->parse_len,
+                                                   l->down[i], &frame_len);
+        if (res == COMM_PARSE_FRAME && comm_frame_validate(l->parse_frame, frame_len, NULL))
+            load_reply(l, l->parse_frame[1], t_ms);
+    }
+    if (n)
+    {
+        memmove(l->down, &l->down[n], l->down_len - n);
+        l->down_len = (uint16_t)(l->down_len - n);
+        l->down_bytes += n;
+    }
+
+    while (l->pending_count && t_ms - l->pending[0].t_ms >= SIM_BLE_LOAD_TIMEOUT_MS)
+    {
+        memmove(&l->pending[0], &l->pending[1], (size_t)(l->pending_count - 1u) * sizeof(l->pending[0]));
+        l->pending_count--;
+        l->timeouts++;
+    }
+}
+
+void sim_ble_load_on_display_tx(sim_ble_load_t *l, const uint8_t *data, size_t len)
+{
+    if (!l || !data)
+        return;
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (l->down_len >= SIM_BLE_LOAD_TX_BUF)
+        {
+            l->tx_drops += (uint32_t)(len - i);
+            break;
+        }
+        l->down[l->down_len++] = data[i];
+    }
+    if (l->down_len > l->down_max)
+        l->down_max = l->down_len;
+}
+
+uint32_t sim_ble_load_latency_pct(const sim_ble_load_t *l, uint32_t pct)
+{
+    if (!l || !l->replies)
+        return 0u;
+    uint64_t want = ((uint64_t)l->replies * pct + 99u) / 100u;
+    uint64_t seen = 0u;
+    for (uint32_t b = 0; b < SIM_BLE_LOAD_BUCKETS; ++b)
+    {
+        seen += l->lat_hist[b];
+        if (seen >= want)
+        {
+            uint32_t edge = (b + 1u) * SIM_BLE_LOAD_BUCKET_MS;
+            return edge < l->lat_max_ms ? edge : l->lat_max_ms;
+        }
+    }
+    return SIM_BLE_LOAD_TIMEOUT_MS;
+}
@@ -268,4 +268,102 @@ const char *sim_ttm_get_mac_str(const sim_ble_t *ble);
 /* Check display's TX for TTM queries (call periodically) */
 void sim_ttm_check_display_tx(sim_ble_t *ble);
 
+/* ============================================================================
+ * Load generator (BC280_SIM_BLE_LOAD)
+ *
+ * The app floods the display with a weighted mix of comm commands at an
+ * offered rate. Both directions of the TTM link are limited to the UART rate
+ * (baud / 10 bytes per second); frames that do not fit the TTM's buffer
+ * toward the display are dropped there, as on the module. Replies
+ * (cmd | 0x80) are matched to the oldest outstanding request for that
+ * command once their last byte has crossed the link; requests unanswered
+ * after SIM_BLE_LOAD_TIMEOUT_MS count as timeouts. 0x81 stream frames are
+ * timed separately: their worst gap is how late live telemetry gets.
+ * ============================================================================
+ */
+
+#define SIM_BLE_LOAD_MIX_MAX        8u
+#define SIM_BLE_LOAD_PAYLOAD_MAX    8u
+#define SIM_BLE_LOAD_PENDING        32u
+#define SIM_BLE_LOAD_TTM_BUF        512u   /* TTM RX buffer toward the display */
+#define SIM_BLE_LOAD_TX_BUF         4096u  /* display TX bytes awaiting airtime */
+#define SIM_BLE_LOAD_TIMEOUT_MS     1000u
+#define SIM_BLE_LOAD_BUCKET_MS      10u
+#define SIM_BLE_LOAD_BUCKETS        (SIM_BLE_LOAD_TIMEOUT_MS / SIM_BLE_LOAD_BUCKET_MS)
+#define SIM_BLE_LOAD_TICK_MS        10u    /* event-mode step while loading */
+
+typedef struct {
+    uint8_t cmd;
+    uint8_t len;
+    uint8_t weight;
+    uint8_t payload[SIM_BLE_LOAD_PAYLOAD_MAX];
+} sim_ble_load_cmd_t;
+
+typedef struct {
+    uint8_t cmd;
+    uint32_t t_ms;           /* handed to the TTM */
+} sim_ble_load_req_t;
+
+typedef struct {
+    uint8_t enabled;
+    uint16_t offered_fps;
+    uint32_t baud;
+    sim_ble_load_cmd_t mix[SIM_BLE_LOAD_MIX_MAX];
+    uint8_t mix_count;
+    uint16_t weight_total;
+    uint32_t rng;
+
+    /* Pacing and link credit, in thousandths of a frame / byte. */
+    uint32_t frame_credit;
+    uint32_t up_credit;
+    uint32_t down_credit;
+    uint8_t up[SIM_BLE_LOAD_TTM_BUF];
+    uint16_t up_len;
+    uint8_t down[SIM_BLE_LOAD_TX_BUF];
+    uint16_t down_len;
+    uint8_t parse_frame[COMM_MAX_PAYLOAD + 4u];
+    uint8_t parse_len;
+
+    sim_ble_load_req_t pending[SIM_BLE_LOAD_PENDING];
+    uint8_t pending_count;
+
+    /* Statistics */
+    uint32_t active_ms;
+    uint32_t offered;
+    uint32_t sent;
+    uint32_t ttm_drops;      /* frames that did not fit the TTM buffer */
+    uint32_t tx_drops;       /* display TX bytes lost to a full buffer */
+    uint32_t replies;
+    uint32_t timeouts;
+    uint32_t up_bytes;
+    uint32_t down_bytes;
+    uint16_t down_max;       /* worst display TX backlog, bytes */
+    uint64_t lat_sum_ms;
+    uint32_t lat_max_ms;
+    uint32_t lat_hist[SIM_BLE_LOAD_BUCKETS];
+    uint32_t stream_frames;
+    uint32_t last_stream_ms;
+    uint32_t stream_gap_max_ms;
+} sim_ble_load_t;
+
+/*
+ * Configure from the knobs: mix "cmd[/payload]:weight,..." in hex, e.g.
+ * "0A:4,3D/000002:1,0D/0064:1" (NULL or empty leaves the generator off),
+ * offered frames per second (default 10) and link baud (default 9600).
+ * Log reads (0x3D/0x41/0x45) default to a full page from offset 0 and 0x0D
+ * to a 100 ms stream when no payload is given. Returns 0 on a bad mix.
+ */
+int sim_ble_load_config(sim_ble_load_t *l, const char *mix, const char *fps, const char *baud);
+
+/* Offer due requests and move bytes across the link for dt_ms ending at t_ms;
+ * call while the TTM is connected. */
+void sim_ble_load_tick(sim_ble_load_t *l, uint32_t t_ms, uint32_t dt_ms);
+
+/* Queue bytes the display wrote to UART1 TX for the downlink. */
+void sim_ble_load_on_display_tx(sim_ble_load_t *l, const uint8_t *data, size_t len);
+
+/* Latency percentile (0..100) from the histogram: the bucket's upper edge
+ * in ms, capped at the worst latency seen. */
+uint32_t sim_ble_load_latency_pct(const sim_ble_load_t *l, uint32_t pct);
+
 #endif /* SIM_BLE_H */
@@ -0,0 +1,117 @@
+#ifndef SIM_FULL_H
+#define SIM_FULL_H
+
+/*
+ * Full simulation: the firmware UI, storage and motor decoder driven by the
+ * BLE/TTM, Shengyi motor and bike models (BC280_SIM_FULL=1 or a scenario).
+ *
+ * host_sim runs it to completion from sim_main.c; bc280_host.c steps it
+ * from a library. Firmware modules keep their state in file-scope globals,
+ * so there is one run per process at a time.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "sim_ble.h"
+#include "sim_mcu.h"
+#include "sim_motor_link.h"
+#include "sim_protocol.h"
+#include "sim_scenario.h"
+#include "sim_session.h"
+#include "sim_shengyi_motor.h"
+#include "ui.h"
+#include "src/core/core.h"
+#include "src/core/speed_filter.h"
+#include "src/kernel/event_bus.h"
+
+typedef struct {
+    uint32_t step;
+    uint8_t mask;
+} sim_btn_step_t;
+
+typedef struct {
+    sim_mcu_t *mcu;
+    sim_ble_t ble;
+    sim_dwg_motor_t motor;
+    ui_state_t ui;
+    FILE *trace;
+    FILE *ble_trace;
+    FILE *ts_trace;
+    int force_page;
+    pyramid_cell_t graph_cells[64];
+    pyramid_i16_t graph;
+    uint32_t graph_tick_ms;
+    uint8_t saw_ui;
+    uint8_t saw_hash;
+    uint16_t render_over_budget;
+    uint32_t ui_frames;
+    double dist_m;
+    double energy_mwh;          /* battery side, net of regen */
+    /* Scenario timeline (NULL when env-only) and run metrics. */
+    sim_scenario_t *scn;
+    uint8_t scn_button_due;
+    uint8_t scn_buttons;
+    uint32_t ble_cmds;
+    uint32_t frame_hash;
+    uint64_t lcd_sum_us;
+    uint32_t lcd_frames;
+    uint32_t lcd_max_us;
+    uint32_t lcd_tick_max_us; /* worst single render chunk */
+    uint32_t btn_lcd_max_us;
+    uint32_t now_ms;            /* model time, advanced by full_advance() */
+    /* Fixed-step loop: dt per step, steps run, and the button knobs
+     * (BC280_SIM_BUTTONS mask, BC280_SIM_BUTTONS_SEQ). */
+    uint32_t dt_ms;
+    uint32_t steps;
+    uint8_t btn_mask;
+    uint8_t btn_env;
+    sim_btn_step_t btn_seq[16];
+    size_t btn_seq_len;
+    uint8_t event_mode;
+    /* BC280_SIM_BLE_LOAD: the app floods UART1 and sim_proto answers as the
+     * display's comm front end. */
+    sim_ble_load_t load;
+    sim_proto_state_t proto;
+    /* BC280_SIM_MOTOR_*: controller replies cross sim_motor_link into the
+     * firmware's motor RX decoder. */
+    sim_motor_link_t link;
+    uint8_t link_used;
+    event_bus_t motor_bus;
+    uint8_t req_open;
+    uint32_t req_ms;
+    uint64_t rsp_sum_ms;
+    uint32_t rsp_count;
+    uint32_t rsp_max_ms;
+    uint8_t status_seq;
+    uint32_t status_ms;
+    uint32_t status_updates;
+    uint32_t status_gap_max_ms;
+    /* BC280_SIM_SESSION: a recorded session drives the firmware's motor
+     * decoder, the display comm model, the button pins and the ADC, and
+     * the dashboard shows what the decoder made of it. */
+    sim_session_t session;
+    uint8_t session_used;
+    uint8_t session_buttons;
+    uint16_t session_batt_raw;
+    speed_conv_t session_speed;
+    uint32_t session_replayed;
+    uint32_t session_motor_bytes;
+    uint32_t session_ble_bytes;
+    uint32_t session_buttons_seen;
+    uint32_t session_adc;
+    /* Filled by sim_full_end(). */
+    sim_spi_flash_stats_t flash;
+} sim_full_t;
+
+/* Initialises every model and firmware module and reads the BC280_SIM_*
+ * knobs. scn may be NULL; outdir (may be NULL) gets the trace logs.
+ * Returns 0 on a bad knob. */
+int sim_full_begin(sim_full_t *f, sim_scenario_t *scn, uint32_t dt_ms, const char *outdir);
+/* One dt_ms step: models, scenario entries, UART exchange, polls, UI tick.
+ * Returns 0 when a render blew its budget. */
+int sim_full_step(sim_full_t *f);
+/* Closes traces, drains storage and frees the MCU model. */
+void sim_full_end(sim_full_t *f);
+
+#endif
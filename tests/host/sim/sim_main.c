@@ -1,20 +1,39 @@
+#define _DEFAULT_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include <math.h>
 
 #include "ui.h"
+#include "ui_glyph_cache.h"
+#include "ui_pixel_sink.h"
 #include "sim_shengyi.h"
 #include "sim_shengyi_bus.h"
 #include "sim_shengyi_motor.h"
 #include "sim_ble.h"
+#include "sim_full.h"
 #include "sim_mcu.h"
+#include "sim_motor_link.h"
+#include "sim_prof.h"
+#include "sim_scenario.h"
+#include "sim_storage.h"
 #include "sim_protocol.h"
 #include "sim_uart.h"
 #include "comm_proto.h"
+#include "src/core/core.h"
+#include "src/core/trace_bin.h"
 #include "src/input/oem_buttons.h"
+#include "src/kernel/event_bus.h"
+#include "src/motor/motor_isr.h"
+#include "src/motor/shengyi.h"
 #include "util/byteorder.h"
+#include "util/crc32.h"
+#include "src/bus/bus.h"
+#include "drivers/spi_flash.h"
 
 static size_t build_frame(uint8_t cmd, const uint8_t *payload, uint8_t len,
                           uint8_t *out, size_t cap)
@@ -61,12 +80,6 @@ static void emit_set_stream(uint16_t period_ms, uint8_t *frame, size_t cap, size
     *flen = build_frame(0x0D, p, 2, frame, cap);
 }
 
-typedef struct {
-    uint32_t step;
-    uint8_t mask;
-} sim_btn_step_t;
-
-
 static size_t parse_button_seq(const char *s, sim_btn_step_t *out, size_t cap)
 {
     size_t n = 0;
@@ -108,6 +121,97 @@ static uint8_t sample_buttons_oem(sim_mcu_t *mcu, uint8_t logical_buttons)
     return raw;
 }
 
+/*
+ * Estimated LCD bus time per screen, from the pixel sink's cost model. A
+ * frame whose bus time alone exceeds a UI tick fails the run.
+ */
+#define SIM_LCD_PAGES 32u
+
+typedef struct {
+    uint32_t frames;
+    uint32_t full_frames;
+    uint64_t sum_us;
+    uint32_t max_full_us;
+    uint32_t max_partial_us;
+    uint32_t prim_us[UI_PERF_PRIM_COUNT];
+} sim_lcd_page_cost_t;
+
+static sim_lcd_page_cost_t g_lcd_cost[SIM_LCD_PAGES];
+static uint32_t g_lcd_over_us;
+
+/* Returns the frame's LCD bus estimate (0 when nothing was drawn). */
+static uint32_t lcd_cost_note(uint8_t page, const ui_trace_t *tr)
+{
+    if (!tr->draw_ops || page >= SIM_LCD_PAGES)
+        return 0;
+    ui_lcd_cost_t total;
+    ui_lcd_cost_t prims[UI_PERF_PRIM_COUNT];
+    ui_pixel_sink_frame_cost(&total, prims);
+    sim_lcd_page_cost_t *c = &g_lcd_cost[page];
+    c->frames++;
+    c->sum_us += total.est_us;
+    if (tr->full)
+    {
+        c->full_frames++;
+        if (total.est_us > c->max_full_us)
+            c->max_full_us = total.est_us;
+    }
+    else if (total.est_us > c->max_partial_us)
+    {
+        c->max_partial_us = total.est_us;
+    }
+    for (uint8_t i = 0; i < UI_PERF_PRIM_COUNT; ++i)
+        if (prims[i].est_us > c->prim_us[i])
+            c->prim_us[i] = prims[i].est_us;
+    if (total.est_us > UI_TICK_MS * 1000u && total.est_us > g_lcd_over_us)
+        g_lcd_over_us = total.est_us;
+    return total.est_us;
+}
+
+static int lcd_cost_report(void)
+{
+    ui_lcd_cost_model_t m;
+    ui_pixel_sink_get_cost_model(&m);
+    printf("LCD COST: model window=%uns pixel=%uns px_call=%uns dma=%uns\n",
+           m.window_ns, m.pixel_ns, m.px_call_ns, m.dma_start_ns);
+    for (uint8_t p = 0; p < SIM_LCD_PAGES; ++p)
+    {
+        const sim_lcd_page_cost_t *c = &g_lcd_cost[p];
+        if (!c->frames)
+            continue;
+        printf("LCD COST: page=%u frames=%u full=%u avg=%uus max_full=%uus max_partial=%uus "
+               "fill=%uus text=%uus arc=%uus\n",
+               p, c->frames, c->full_frames, (uint32_t)(c->sum_us / c->frames),
+               c->max_full_us, c->max_partial_us,
+               c->prim_us[UI_PERF_PRIM_FILL], c->prim_us[UI_PERF_PRIM_TEXT], c->prim_us[UI_PERF_PRIM_ARC]);
+    }
+    if (g_lcd_over_us)
+    {
+        fprintf(stderr, "SIM FAIL: lcd bus estimate %u us > %u us\n", g_lcd_over_us, UI_TICK_MS * 1000u);
+        return 0;
+    }
+    return 1;
+}
+
+/* BC280_LCD_MIRROR (ui_pixel_sink.h): a frame ui_lcd drew differently from
+ * the sink, on its panel or in the remote view, fails the run. */
+static int lcd_mirror_report(void)
+{
+    ui_pixel_sink_mirror_t m;
+    ui_pixel_sink_mirror_stats(&m);
+    if (!m.frames)
+        return 1;
+    printf("LCD MIRROR: frames=%u panel_diffs=%u remote_frames=%u remote_diffs=%u remote_bytes=%u\n",
+           m.frames, m.panel_diffs, m.remote_frames, m.remote_diffs, m.remote_bytes);
+    if (m.panel_diffs || m.remote_diffs)
+    {
+        fprintf(stderr, "SIM FAIL: ui_lcd output differs from the pixel sink (first at dump %u)\n",
+                m.first_diff);
+        return 0;
+    }
+    return 1;
+}
+
 static int validate_tx_frames(const uint8_t *buf, size_t len, uint8_t *saw_stream)
 {
     size_t i = 0;
@@ -138,254 +242,896 @@ static int validate_tx_frames(const uint8_t *buf, size_t len, uint8_t *saw_strea
     return saw_any ? 1 : 0;
 }
 
-/* Full simulation mode using complete BLE and Shengyi motor simulators */
-static int run_full_sim(uint32_t steps, uint32_t dt_ms, const char *outdir)
+static sim_scenario_t g_scenario;
+static uint8_t g_have_scenario;
+
+/*
+ * Wire capture (BC280_SIM_WIRE_CAPTURE=path, full mode): every byte the
+ * motor and BLE models push toward the display, written as a bus_replay
+ * store image (BRPL) with UART2 as BUS_MOTOR and UART1 as BUS_BLE. The
+ * image can be uploaded for flash replay, fed to bench_proto, or split into
+ * fuzz seeds (scripts/fuzz_corpus.py).
+ */
+static struct {
+    FILE *f;
+    uint32_t now_ms;
+    uint32_t last_ms;
+    uint16_t records;
+    uint32_t bytes;
+    crc32_stream_t crc;
+} g_wire;
+
+static void wire_tap(sim_uart_port_t port, const uint8_t *data, size_t len, void *ctx)
 {
-    FILE *trace = NULL;
-    FILE *ble_trace = NULL;
-    FILE *ts_trace = NULL;
-
-    if (outdir && outdir[0])
+    (void)ctx;
+    if (port != SIM_UART1 && port != SIM_UART2)
+        return;
+    while (len && g_wire.records < 0xFFFFu)
     {
-        char path[512];
-        mkdir(outdir, 0755);
-        snprintf(path, sizeof(path), "%s/sim_ui_trace.txt", outdir);
-        trace = fopen(path, "w");
-        snprintf(path, sizeof(path), "%s/ble_frames.log", outdir);
-        ble_trace = fopen(path, "w");
-        snprintf(path, sizeof(path), "%s/shengyi_motor.log", outdir);
-        ts_trace = fopen(path, "w");
+        uint8_t rec[BUS_REPLAY_RECORD_HEADER_BYTES + BUS_CAPTURE_MAX_DATA];
+        uint8_t n = (uint8_t)((len > BUS_CAPTURE_MAX_DATA) ? BUS_CAPTURE_MAX_DATA : len);
+        uint32_t dt = g_wire.now_ms - g_wire.last_ms;
+        rec[0] = (port == SIM_UART2) ? BUS_MOTOR : BUS_BLE;
+        rec[1] = n;
+        store_be16(&rec[2], (uint16_t)((dt > 0xFFFFu) ? 0xFFFFu : dt));
+        memcpy(&rec[BUS_REPLAY_RECORD_HEADER_BYTES], data, n);
+        size_t total = BUS_REPLAY_RECORD_HEADER_BYTES + (size_t)n;
+        fwrite(rec, 1, total, g_wire.f);
+        crc32_stream_feed(&g_wire.crc, rec, total);
+        g_wire.bytes += (uint32_t)total;
+        g_wire.records++;
+        g_wire.last_ms = g_wire.now_ms;
+        data += n;
+        len -= n;
     }
+}
 
-    /* Initialize all simulators */
-    sim_uart_init();
-    sim_mcu_t *mcu = sim_mcu_create();
-
-    sim_ble_t ble;
-    sim_ble_init(&ble);
+static void wire_capture_open(const char *path)
+{
+    if (!path || !path[0])
+        return;
+    memset(&g_wire, 0, sizeof(g_wire));
+    g_wire.f = fopen(path, "wb");
+    if (!g_wire.f)
+    {
+        fprintf(stderr, "sim: cannot write %s\n", path);
+        return;
+    }
+    uint8_t hdr[BUS_REPLAY_STORE_HEADER_BYTES] = {0};
+    fwrite(hdr, 1, sizeof(hdr), g_wire.f);  /* rewritten on close */
+    crc32_stream_begin(&g_wire.crc);
+    sim_uart_set_rx_tap(wire_tap, NULL);
+}
 
-    sim_dwg_motor_t motor;
-    sim_dwg_motor_init(&motor);
+static void wire_capture_close(void)
+{
+    if (!g_wire.f)
+        return;
+    sim_uart_set_rx_tap(NULL, NULL);
+    uint8_t hdr[BUS_REPLAY_STORE_HEADER_BYTES];
+    store_be32(&hdr[0], BUS_REPLAY_STORE_MAGIC);
+    store_be16(&hdr[4], BUS_REPLAY_STORE_VERSION);
+    store_be16(&hdr[6], g_wire.records);
+    store_be32(&hdr[8], g_wire.bytes);
+    store_be32(&hdr[12], crc32_stream_end(&g_wire.crc));
+    fseek(g_wire.f, 0, SEEK_SET);
+    fwrite(hdr, 1, sizeof(hdr), g_wire.f);
+    fclose(g_wire.f);
+    g_wire.f = NULL;
+    printf("WIRE CAPTURE: records=%u bytes=%u\n", (unsigned)g_wire.records, (unsigned)g_wire.bytes);
+}
 
-    ui_state_t ui;
-    ui_init(&ui);
+/*
+ * Storage workload on the MCU's flash model (sim_storage.h).
+ * BC280_SIM_STREAM_LOG_MS sets the stream log period (default 1000 ms, the
+ * config default; 0 turns it off) and BC280_SIM_FLASH_TIMING=max swaps the
+ * typical datasheet times for worst-case ones. BC280_SIM_ASSET_PACK uploads
+ * a scripts/pack_ui_icons.py --pack file so icons draw as flash sprites.
+ */
+static void full_storage_init(sim_full_t *f)
+{
+    sim_spi_flash_t *flash = sim_mcu_spi_flash(f->mcu);
+    const char *timing_env = getenv("BC280_SIM_FLASH_TIMING");
+    if (timing_env && strcmp(timing_env, "max") == 0)
+        sim_spi_flash_timing_max(&flash->timing);
+    const char *period_env = getenv("BC280_SIM_STREAM_LOG_MS");
+    uint16_t period = period_env ? (uint16_t)strtoul(period_env, NULL, 0) : 1000u;
+    sim_storage_init(flash, period);
+    const char *pack_env = getenv("BC280_SIM_ASSET_PACK");
+    if (pack_env && pack_env[0] && !sim_storage_load_assets(pack_env))
+        fprintf(stderr, "asset pack %s rejected, using built-in icons\n", pack_env);
+    ui_set_sprite_lookup(sim_storage_sprite_lookup);
+    ui_pixel_sink_set_flash_read(spi_flash_read);
+    ui_glyph_cache_set_read(spi_flash_read);
+}
 
-    /* Environment config */
-    const char *btn_env = getenv("BC280_SIM_BUTTONS");
-    uint8_t btn_mask = btn_env ? (uint8_t)strtoul(btn_env, NULL, 0) : 0u;
-    sim_btn_step_t btn_seq[16];
-    size_t btn_seq_len = parse_button_seq(getenv("BC280_SIM_BUTTONS_SEQ"), btn_seq, 16);
-    const char *force_page_env = getenv("BC280_SIM_FORCE_PAGE");
-    int force_page = force_page_env ? atoi(force_page_env) : -1;
+/* Busy time and wear over the run, scaled to an hour of riding. Returns
+ * the number of NOR contract violations the storage code caused. */
+static uint32_t full_flash_report(const sim_spi_flash_stats_t *st, uint32_t sim_ms)
+{
+    double hours = sim_ms ? (double)sim_ms / 3600000.0 : 1.0;
+    printf("SIM FLASH: busy_ms=%.1f bus_ms=%.1f stall_ms=%.1f erases=%u sectors=%u max_sector_erases=%u "
+           "programs=%u suspends=%u erases_per_h=%.1f busy_ms_per_h=%.1f\n",
+           (double)st->busy_us / 1000.0, (double)st->bus_us / 1000.0,
+           (double)st->stall_us / 1000.0, st->erases, st->sectors_erased,
+           st->max_sector_erases, st->page_programs, st->suspends,
+           st->erases / hours, (double)st->busy_us / 1000.0 / hours);
+    uint32_t violations = st->bit_violations + st->page_violations + st->busy_violations;
+    if (violations)
+        printf("SIM FLASH: violations bits=%u page=%u busy=%u\n",
+               st->bit_violations, st->page_violations, st->busy_violations);
+    return violations;
+}
 
-    /* Rider power profile from env */
-    double rider_power = 100.0;
-    const char *power_env = getenv("BC280_SIM_RIDER_POWER");
-    if (power_env)
-        rider_power = atof(power_env);
-    sim_dwg_motor_set_rider_power(&motor, rider_power);
+/* Advance every clocked model by dt: MCU timers, bike physics, TTM state. */
+static void full_advance(sim_full_t *f, uint32_t dt_ms)
+{
+    g_wire.now_ms += dt_ms;
+    f->now_ms += dt_ms;
+    sim_mcu_step(f->mcu, dt_ms);
+    sim_dwg_motor_tick(&f->motor, dt_ms);
+    sim_storage_tick(f->now_ms, &f->motor.bike);
+    f->dist_m += f->motor.bike.v_mps * (double)dt_ms / 1000.0;
+    f->energy_mwh += f->motor.bike.batt_v * f->motor.bike.batt_a * (double)dt_ms / 3600.0;
+}
 
-    /* Initial BLE commands to display */
-    uint8_t frame[256];
-    size_t flen;
+/* Apply every timeline entry due by t_ms. A button entry is held for the
+ * next UI tick. */
+static void full_apply_scenario(sim_full_t *f, uint32_t t_ms)
+{
+    const sim_scn_entry_t *e;
+    while ((e = sim_scenario_pop_due(f->scn, t_ms)) != NULL)
+    {
+        switch (e->kind)
+        {
+        case SIM_SCN_POWER:
+            sim_dwg_motor_set_rider_power(&f->motor, e->value);
+            break;
+        case SIM_SCN_GRADE:
+            sim_dwg_motor_set_grade(&f->motor, e->value);
+            break;
+        case SIM_SCN_WIND:
+            sim_dwg_motor_set_wind(&f->motor, e->value);
+            break;
+        case SIM_SCN_FAULT:
+            sim_dwg_motor_set_error(&f->motor, (uint8_t)e->value);
+            break;
+        case SIM_SCN_BUTTON:
+            f->scn_buttons = (uint8_t)e->value;
+            f->scn_button_due = 1;
+            break;
+        case SIM_SCN_LINK:
+            sim_motor_link_set(&f->link, e->cmd, e->value);
+            f->link_used |= f->link.enabled;
+            break;
+        case SIM_SCN_BLE:
+        {
+            uint8_t frame[SIM_SCN_MAX_BLE + 8u];
+            size_t flen = sim_ble_build_command(e->cmd, e->data, e->len, frame, sizeof(frame));
+            if (flen)
+            {
+                sim_uart_rx_push(SIM_UART1, frame, flen);
+                f->ble_cmds++;
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
 
-    /* Note: BLE commands will be sent after TTM connection (auto-connects at 500ms) */
+/* battery_monitor's default ADC-to-mV scale (OEM n69300). */
+#define SIM_SESSION_BATT_SCALE 69300u
 
-    /* Send initial Shengyi status request (display -> motor via UART2 TX) */
-    flen = sim_dwg_build_0xC2_request(frame, sizeof(frame));
-    sim_uart_tx_write(SIM_UART2, frame, flen);
+/* Deliver every session record due by t_ms: controller bytes to the
+ * firmware's motor RX decoder (as the UART2 DMA IDLE path does), app bytes
+ * to the display comm model, button pins and ADC means to the MCU model. */
+static void full_apply_session(sim_full_t *f, uint32_t t_ms)
+{
+    bus_capture_record_t r;
+    uint8_t ble = 0;
+    while (sim_session_pop_due(&f->session, t_ms, &r))
+    {
+        f->session_replayed++;
+        switch (r.bus_id)
+        {
+        case BUS_MOTOR:
+            f->session_motor_bytes += r.len;
+            motor_isr_rx_bytes(r.data, r.len, t_ms);
+            break;
+        case BUS_BLE:
+            f->session_ble_bytes += r.len;
+            for (uint8_t j = 0; j < r.len; ++j)
+                sim_proto_feed(&f->proto, SIM_UART1, r.data[j]);
+            ble = 1;
+            break;
+        case BUS_SESSION_BUTTONS:
+            if (r.len >= 1u)
+            {
+                f->session_buttons = r.data[0];
+                f->session_buttons_seen++;
+            }
+            break;
+        case BUS_SESSION_ADC:
+            if (r.len >= 3u)
+            {
+                uint16_t raw = load_be16(&r.data[1]);
+                sim_mcu_adc_set_channel(f->mcu, (r.data[0] == 0u) ? 0u : 16u, raw);
+                if (r.data[0] == 0u)
+                    f->session_batt_raw = raw;
+                f->session_adc++;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    (void)event_bus_dispatch(&f->motor_bus, 64u, t_ms);
+    if (ble)
+    {
+        f->proto.ms = t_ms;
+        sim_proto_tick(&f->proto);
+    }
+}
 
-    uint8_t saw_ui = 0;
-    uint8_t saw_hash = 0;
-    uint16_t render_over_budget = 0;
-    uint32_t t_ms = 0;
+/* Under replay the dashboard reads the decoder's latest status and the
+ * recorded battery ADC instead of the motor model. */
+static void full_session_model(sim_full_t *f, ui_model_t *model)
+{
+    motor_isr_status_t st;
+    memset(&st, 0, sizeof(st));
+    (void)motor_isr_read_status(&st);
+    uint16_t dmph = st.speed_raw ? speed_conv_dmph(&f->session_speed, st.speed_raw) : 0u;
+    model->speed_dmph = (dmph > 9999u) ? 9999u : dmph;
+    model->cadence_rpm = 0;
+    model->soc_pct = st.soc_pct;
+    model->err = st.err;
+    model->batt_dA = st.current_dA;
+    model->batt_dV = st.batt_dV;
+    if (f->session_batt_raw)
+        model->batt_dV = (int16_t)((((uint32_t)f->session_batt_raw * SIM_SESSION_BATT_SCALE) >> 12) / 100u);
+    int32_t power_w = (int32_t)model->batt_dV * model->batt_dA / 100;
+    model->power_w = (uint16_t)((power_w > 0) ? power_w : 0);
+    model->brake = (st.flags & MOTOR_ISR_STATUS_F_BRAKE) ? 1u : 0u;
+}
 
-    for (uint32_t i = 0; i < steps; ++i)
+/* With the link impaired, the controller's replies cross sim_motor_link and
+ * the firmware's motor RX decoder reads what arrives, as the UART2 DMA IDLE
+ * path delivers it (motor_isr_tick() is not run: the display's requests do
+ * not go through its TX ring here, so its response timeout has nothing to
+ * time from); the UI keeps reading the controller model. Response time
+ * runs from an accepted request to the next status the decoder publishes. */
+static void full_motor_link(sim_full_t *f, uint32_t t_ms)
+{
+    uint8_t buf[512];
+    size_t n = 0;
+    uint8_t b;
+    while (n < sizeof(buf) && sim_uart_rx_pop(SIM_UART2, &b))
+        buf[n++] = b;
+    sim_motor_link_submit(&f->link, buf, n, t_ms);
+    while ((n = sim_motor_link_deliver(&f->link, t_ms, buf, sizeof(buf))) > 0)
+        motor_isr_rx_bytes(buf, (uint16_t)n, t_ms);
+    (void)event_bus_dispatch(&f->motor_bus, 64u, t_ms);
+
+    motor_isr_status_t st;
+    if (!motor_isr_read_status(&st) || (f->status_updates && st.seq == f->status_seq))
+        return;
+    if (f->status_updates && t_ms - f->status_ms > f->status_gap_max_ms)
+        f->status_gap_max_ms = t_ms - f->status_ms;
+    if (f->req_open)
     {
-        t_ms += dt_ms;
+        uint32_t rsp = t_ms - f->req_ms;
+        f->rsp_sum_ms += rsp;
+        f->rsp_count++;
+        if (rsp > f->rsp_max_ms)
+            f->rsp_max_ms = rsp;
+        f->req_open = 0u;
+    }
+    f->status_seq = st.seq;
+    f->status_ms = t_ms;
+    f->status_updates++;
+}
 
-        /* Step MCU and motor physics */
-        sim_mcu_step(mcu, dt_ms);
-        sim_dwg_motor_tick(&motor, dt_ms);
+/* Move whatever the display and the motor queued across the UARTs and let
+ * the TTM/BLE side follow the motor state. */
+static void full_exchange(sim_full_t *f, uint32_t t_ms, uint32_t ble_dt_ms)
+{
+    /* sim_ble is the EXTERNAL TTM chip + BLE app - it GENERATES stimuli.
+     * The display firmware (not compiled in host sim) would read UART1 RX.
+     * For now, we check if display wrote anything to UART1 TX.
+     * In future, when display BLE handler is implemented, it will process
+     * the commands sim_ble pushes to UART1 RX. */
+    if (f->load.enabled && sim_ttm_is_connected(&f->ble))
+    {
+        /* Under load the protocol model stands in for the display: it takes
+         * everything that crossed the link and its replies queue for the
+         * downlink. */
+        sim_ble_load_tick(&f->load, t_ms, ble_dt_ms);
+        uint8_t b;
+        while (sim_uart_rx_pop(SIM_UART1, &b))
+            sim_proto_feed(&f->proto, SIM_UART1, b);
+        sim_dwg_motor_t *m = &f->motor;
+        sim_proto_update_inputs(&f->proto, 0u, 0u, sim_dwg_motor_speed_dmph(m),
+                                sim_dwg_motor_soc_pct(m), sim_dwg_motor_error_code(m),
+                                sim_dwg_motor_cadence_rpm(m), sim_dwg_motor_power_w(m),
+                                sim_dwg_motor_batt_dV(m), sim_dwg_motor_batt_dA(m),
+                                sim_dwg_motor_temp_dC(m));
+        f->proto.ms = t_ms;
+        sim_proto_tick(&f->proto);
+    }
+    {
+        /* Check what display sent to UART1 TX (responses to TTM/BLE) */
+        uint8_t tx_buf[4096];
+        size_t tx_len = sim_uart_tx_read(SIM_UART1, tx_buf, sizeof(tx_buf));
+        if (tx_len > 0 && f->load.enabled)
+            sim_ble_load_on_display_tx(&f->load, tx_buf, tx_len);
+    }
 
-        /* sim_ble is the EXTERNAL TTM chip + BLE app - it GENERATES stimuli.
-         * The display firmware (not compiled in host sim) would read UART1 RX.
-         * For now, we check if display wrote anything to UART1 TX.
-         * In future, when display BLE handler is implemented, it will process
-         * the commands sim_ble pushes to UART1 RX. */
+    /* Feed UART2 RX bytes to motor simulator (from display TX) */
+    {
+        uint8_t tx_buf[4096];
+        size_t tx_len = sim_uart_tx_read(SIM_UART2, tx_buf, sizeof(tx_buf));
+        if (tx_len && f->link.enabled)
         {
-            /* Check what display sent to UART1 TX (responses to TTM/BLE) */
-            uint8_t tx_buf[256];
-            size_t tx_len = sim_uart_tx_read(SIM_UART1, tx_buf, sizeof(tx_buf));
-            if (tx_len > 0)
+            if (sim_motor_link_accept(&f->link, t_ms))
+            {
+                f->req_open = 1u;
+                f->req_ms = t_ms;
+            }
+            else
             {
-                /* Display firmware would respond here - for now just count */
-                /* When display BLE handler is implemented, sim_ble can verify responses */
-                (void)tx_buf;
+                tx_len = 0;
             }
         }
+        for (size_t j = 0; j < tx_len; ++j)
+            sim_dwg_motor_feed_byte(&f->motor, tx_buf[j]);
+    }
 
-        /* Feed UART2 RX bytes to motor simulator (from display TX) */
+    /* Process motor simulator and generate responses */
+    sim_dwg_motor_process(&f->motor);
+    if (f->link.enabled)
+        full_motor_link(f, t_ms);
+
+    /* Note: sim_ble_process() is NOT called here.
+     * sim_ble is the EXTERNAL TTM chip - it doesn't process commands,
+     * it GENERATES commands that the display firmware would process.
+     * The display firmware's BLE handler is not yet compiled in host sim. */
+
+    /* Update BLE telemetry from motor */
+    sim_dwg_motor_t *m = &f->motor;
+    sim_ble_update_telemetry(&f->ble,
+                              sim_dwg_motor_speed_dmph(m),
+                              sim_dwg_motor_cadence_rpm(m),
+                              sim_dwg_motor_power_w(m),
+                              sim_dwg_motor_batt_dV(m),
+                              sim_dwg_motor_batt_dA(m),
+                              sim_dwg_motor_temp_dC(m),
+                              sim_dwg_motor_soc_pct(m),
+                              sim_dwg_motor_error_code(m));
+    sim_ble_tick(&f->ble, ble_dt_ms);
+
+    /* Log traces */
+    if (f->ble_trace && f->ble.frames_tx > 0)
+    {
+        fprintf(f->ble_trace, "t=%u ble_rx=%u ble_tx=%u errs=%u\n",
+                t_ms, f->ble.frames_rx, f->ble.frames_tx, f->ble.parse_errors);
+    }
+    if (f->ts_trace && m->frames_tx > 0)
+    {
+        fprintf(f->ts_trace, "t=%u motor_rx=%u motor_tx=%u speed=%.1f cadence=%u power=%u soc=%u\n",
+                t_ms, m->frames_rx, m->frames_tx,
+                m->bike.v_mps * 3.6,
+                (unsigned)m->bike.cadence_rpm,
+                sim_dwg_motor_power_w(m),
+                m->bike.soc_pct);
+    }
+}
+
+static void full_ble_request(void)
+{
+    uint8_t frame[256];
+    size_t flen = sim_ble_build_get_realtime(frame, sizeof(frame));
+    sim_uart_rx_push(SIM_UART1, frame, flen);
+}
+
+/* Motor status request (display -> motor via UART2 TX) */
+static void full_motor_request(sim_full_t *f)
+{
+    uint8_t frame[256];
+    size_t flen = sim_dwg_build_0x52_request(f->motor.bike.assist_level, 0, frame, sizeof(frame));
+    sim_uart_tx_write(SIM_UART2, frame, flen);
+}
+
+/* Build the UI model from motor state and run one UI tick. Returns 0 when a
+ * render blew its budget. */
+static int full_ui_tick(sim_full_t *f, uint32_t t_ms, uint8_t ui_buttons, uint8_t brake)
+{
+    uint8_t pressed = ui_buttons != 0u;
+    uint8_t n63 = sample_buttons_oem(f->mcu, ui_buttons);
+    ui_buttons = oem_buttons_map_raw(n63, NULL);
+
+    sim_dwg_motor_t *m = &f->motor;
+    ui_model_t model = {0};
+    model.page = (f->force_page >= 0) ? (uint8_t)f->force_page : UI_PAGE_DASHBOARD;
+    model.speed_dmph = sim_dwg_motor_speed_dmph(m);
+    model.cadence_rpm = sim_dwg_motor_cadence_rpm(m);
+    model.power_w = sim_dwg_motor_power_w(m);
+    model.soc_pct = sim_dwg_motor_soc_pct(m);
+    model.batt_dV = sim_dwg_motor_batt_dV(m);
+    model.batt_dA = sim_dwg_motor_batt_dA(m);
+    model.ctrl_temp_dC = sim_dwg_motor_temp_dC(m);
+    model.err = sim_dwg_motor_error_code(m);
+    model.assist_mode = m->config.gear_setting;
+    model.virtual_gear = 2;
+    model.buttons = ui_buttons;
+    model.throttle_pct = 37;
+    model.brake = brake;
+    model.theme = UI_THEME_NIGHT;
+    model.units = m->config.units_mode;
+    model.range_est_d10 = 120;
+    model.range_confidence = 3;
+    model.graph_channel = UI_GRAPH_CH_SPEED;
+    model.graph_window_s = 30;
+    model.graph_sample_hz = (uint8_t)(1000u / UI_TICK_MS);
+    if (f->session_used)
+        full_session_model(f, &model);
+    pyramid_i16_add(&f->graph, (int16_t)model.speed_dmph);
+    while ((uint32_t)(t_ms - f->graph_tick_ms) >= 500u)
+    {
+        pyramid_i16_commit(&f->graph);
+        f->graph_tick_ms += 500u;
+    }
+    model.graph_cols = pyramid_i16_columns(&f->graph, 0u, 60u, UI_GRAPH_COLS,
+                                           model.graph_min, model.graph_max,
+                                           &model.graph_pos);
+
+    /* Tick UI */
+    ui_trace_t tr;
+    if (ui_tick(&f->ui, &model, t_ms, &tr))
+    {
+        /* On target a progressive redraw finishes over the next few
+         * scheduler ticks, well inside this UI step. */
+        uint32_t tick_us = ui_pixel_sink_chunk_us();
+        while (ui_render_pending(&f->ui))
         {
-            uint8_t tx_buf[4096];
-            size_t tx_len = sim_uart_tx_read(SIM_UART2, tx_buf, sizeof(tx_buf));
-            for (size_t j = 0; j < tx_len; ++j)
-                sim_dwg_motor_feed_byte(&motor, tx_buf[j]);
+            (void)ui_tick(&f->ui, &model, t_ms, NULL);
+            uint32_t chunk_us = ui_pixel_sink_chunk_us();
+            if (chunk_us > tick_us)
+                tick_us = chunk_us;
         }
-
-        /* Process motor simulator and generate responses */
-        sim_dwg_motor_process(&motor);
-
-        /* Note: sim_ble_process() is NOT called here.
-         * sim_ble is the EXTERNAL TTM chip - it doesn't process commands,
-         * it GENERATES commands that the display firmware would process.
-         * The display firmware's BLE handler is not yet compiled in host sim. */
-
-        /* Update BLE telemetry from motor */
-        sim_ble_update_telemetry(&ble,
-                                  sim_dwg_motor_speed_dmph(&motor),
-                                  sim_dwg_motor_cadence_rpm(&motor),
-                                  sim_dwg_motor_power_w(&motor),
-                                  sim_dwg_motor_batt_dV(&motor),
-                                  sim_dwg_motor_batt_dA(&motor),
-                                  sim_dwg_motor_temp_dC(&motor),
-                                  sim_dwg_motor_soc_pct(&motor),
-                                  sim_dwg_motor_error_code(&motor));
-        sim_ble_tick(&ble, dt_ms);
-
-        /* Periodically send BLE commands (every 500ms) - only when connected */
-        if (sim_ttm_is_connected(&ble) && (i % (500 / dt_ms)) == 0 && i > 0)
+        if (tr.draw_ops && tick_us > f->lcd_tick_max_us)
+            f->lcd_tick_max_us = tick_us;
+        f->saw_ui = 1;
+        f->ui_frames++;
+        if (tr.hash != 0)
+            f->saw_hash = 1;
+        if (tr.render_ms > UI_TICK_MS)
         {
-            flen = sim_ble_build_get_realtime(frame, sizeof(frame));
-            sim_uart_rx_push(SIM_UART1, frame, flen);
+            f->render_over_budget = tr.render_ms;
+            return 0;
         }
-
-        /* Periodically send motor status request (every 100ms) - display -> motor via UART2 TX */
-        if ((t_ms % 100) == 0 && t_ms > 0)
+        uint32_t lcd_us = lcd_cost_note(model.page, &tr);
+        f->frame_hash = (f->frame_hash ^ tr.hash) * 16777619u;
+        if (tr.draw_ops)
+        {
+            ui_lcd_cost_t cost;
+            ui_pixel_sink_frame_cost(&cost, NULL);
+            f->lcd_sum_us += cost.est_us;
+            f->lcd_frames++;
+            if (cost.est_us > f->lcd_max_us)
+                f->lcd_max_us = cost.est_us;
+            if (pressed && cost.est_us > f->btn_lcd_max_us)
+                f->btn_lcd_max_us = cost.est_us;
+        }
+        if (f->trace)
         {
-            flen = sim_dwg_build_0x52_request(motor.bike.assist_level, 0, frame, sizeof(frame));
-            sim_uart_tx_write(SIM_UART2, frame, flen);
+            fprintf(f->trace, "t=%u hash=%08x ops=%u dirty=%u full=%u page=%u lcd_us=%u\n",
+                    t_ms, tr.hash, tr.draw_ops, tr.dirty_count, tr.full, model.page, lcd_us);
         }
+    }
+    return 1;
+}
 
-        /* Log traces */
-        if (ble_trace && ble.frames_tx > 0)
+/* Button mask for UI step i: the BC280_SIM_BUTTONS_SEQ entry for that step,
+ * else the default MENU/POWER walk when no button env is set. */
+static uint8_t full_buttons(uint32_t i, uint8_t btn_mask, uint8_t btn_env,
+                            const sim_btn_step_t *seq, size_t seq_len)
+{
+    uint8_t ui_buttons = btn_mask;
+    if (seq_len)
+    {
+        for (size_t bi = 0; bi < seq_len; ++bi)
         {
-            fprintf(ble_trace, "t=%u ble_rx=%u ble_tx=%u errs=%u\n",
-                    t_ms, ble.frames_rx, ble.frames_tx, ble.parse_errors);
+            if (seq[bi].step == i)
+                ui_buttons = seq[bi].mask;
         }
-        if (ts_trace && motor.frames_tx > 0)
+    }
+    else if (!btn_env)
+    {
+        if (i == 12u)
+            ui_buttons = OEM_BTN_MENU;
+        else if (i == 22u)
+            ui_buttons = OEM_BTN_POWER;
+    }
+    return ui_buttons;
+}
+
+/*
+ * Discrete-event time advance (BC280_SIM_EVENT=1). Instead of visiting every
+ * dt, time jumps straight to the next scheduled event: the display's motor
+ * poll (100 ms), the BLE realtime poll (500 ms while connected), the motor's
+ * own status push, a UI tick (BC280_SIM_UI_MS, default UI_TICK_MS) or a
+ * button step (step k of BC280_SIM_BUTTONS_SEQ fires at k * dt_ms). Bike
+ * physics integrate across the gap in SIM_EVENT_MAX_DT_MS slices and the UART
+ * models are drained at every event, so with a coarse UI period a
+ * multi-hour ride runs in seconds.
+ */
+#define SIM_EVENT_MAX_DT_MS 100u
+#define SIM_EVENT_NONE 0xFFFFFFFFu
+
+static uint32_t next_multiple(uint32_t t, uint32_t period)
+{
+    return (t / period + 1u) * period;
+}
+
+static uint32_t event_next_button(uint32_t t_ms, uint32_t dt_ms, uint8_t btn_env,
+                                  const sim_btn_step_t *seq, size_t seq_len)
+{
+    uint32_t next = SIM_EVENT_NONE;
+    if (seq_len)
+    {
+        for (size_t bi = 0; bi < seq_len; ++bi)
         {
-            fprintf(ts_trace, "t=%u motor_rx=%u motor_tx=%u speed=%.1f cadence=%u power=%u soc=%u\n",
-                    t_ms, motor.frames_rx, motor.frames_tx,
-                    motor.bike.v_mps * 3.6,
-                    (unsigned)motor.bike.cadence_rpm,
-                    sim_dwg_motor_power_w(&motor),
-                    motor.bike.soc_pct);
+            uint32_t at = seq[bi].step * dt_ms;
+            if (at > t_ms && at < next)
+                next = at;
         }
+    }
+    else if (!btn_env)
+    {
+        if (12u * dt_ms > t_ms)
+            next = 12u * dt_ms;
+        else if (22u * dt_ms > t_ms)
+            next = 22u * dt_ms;
+    }
+    return next;
+}
 
-        /* Buttons */
-        uint8_t ui_buttons = btn_mask;
-        if (btn_seq_len)
+static uint32_t event_min(uint32_t a, uint32_t b)
+{
+    return (a < b) ? a : b;
+}
+
+static void run_event_loop(sim_full_t *f, uint32_t duration_ms, uint32_t dt_ms, uint32_t ui_ms,
+                           uint8_t btn_mask, uint8_t btn_env,
+                           const sim_btn_step_t *seq, size_t seq_len, uint32_t *events)
+{
+    uint32_t t_ms = 0;
+    uint32_t ble_t_ms = 0;
+    while (t_ms < duration_ms)
+    {
+        uint32_t next = event_min(next_multiple(t_ms, 100u), next_multiple(t_ms, ui_ms));
+        if (sim_ttm_is_connected(&f->ble))
+            next = event_min(next, next_multiple(t_ms, 500u));
+        if (f->load.enabled && sim_ttm_is_connected(&f->ble))
+            next = event_min(next, next_multiple(t_ms, SIM_BLE_LOAD_TICK_MS));
+        if (f->link.enabled)
+            next = event_min(next, next_multiple(t_ms, SIM_MOTOR_LINK_TICK_MS));
+        if (f->motor.status_period_ms > 0)
+            next = event_min(next, f->motor.last_status_ms + f->motor.status_period_ms);
+        uint32_t btn_at = event_next_button(t_ms, dt_ms, btn_env, seq, seq_len);
+        next = event_min(event_min(next, btn_at), duration_ms);
+        next = event_min(next, sim_scenario_next_ms(f->scn));
+        if (next <= t_ms)
+            next = t_ms + 1u;
+
+        while (t_ms < next)
         {
-            for (size_t bi = 0; bi < btn_seq_len; ++bi)
-            {
-                if (btn_seq[bi].step == i)
-                    ui_buttons = btn_seq[bi].mask;
-            }
+            uint32_t step = event_min(next - t_ms, SIM_EVENT_MAX_DT_MS);
+            full_advance(f, step);
+            t_ms += step;
         }
-        else if (!btn_env)
+        (*events)++;
+        full_apply_scenario(f, t_ms);
+
+        if (sim_ttm_is_connected(&f->ble) && (t_ms % 500u) == 0)
+            full_ble_request();
+        if ((t_ms % 100u) == 0)
+            full_motor_request(f);
+        full_exchange(f, t_ms, t_ms - ble_t_ms);
+        ble_t_ms = t_ms;
+
+        uint8_t btn_due = (t_ms == btn_at) || f->scn_button_due;
+        if (btn_due || (t_ms % ui_ms) == 0)
         {
-            if (i == 12u)
-                ui_buttons = OEM_BTN_MENU;
-            else if (i == 22u)
-                ui_buttons = OEM_BTN_POWER;
+            uint32_t i = t_ms / dt_ms;
+            uint8_t on_step = (t_ms % dt_ms) == 0;
+            uint8_t buttons = on_step ? full_buttons(i, btn_mask, btn_env, seq, seq_len) : btn_mask;
+            if (f->scn_button_due)
+                buttons = f->scn_buttons;
+            f->scn_button_due = 0;
+            if (!full_ui_tick(f, t_ms, buttons, (on_step && i == 10u) ? 1u : 0u))
+                break;
         }
+    }
+}
 
-        uint8_t n63 = sample_buttons_oem(mcu, ui_buttons);
-        ui_buttons = oem_buttons_map_raw(n63, NULL);
+int sim_full_begin(sim_full_t *f, sim_scenario_t *scn, uint32_t dt_ms, const char *outdir)
+{
+    memset(f, 0, sizeof(*f));
+    f->scn = scn;
+    f->dt_ms = dt_ms;
+    f->frame_hash = 2166136261u;
+
+    if (outdir && outdir[0])
+    {
+        char path[512];
+        mkdir(outdir, 0755);
+        snprintf(path, sizeof(path), "%s/sim_ui_trace.txt", outdir);
+        f->trace = fopen(path, "w");
+        snprintf(path, sizeof(path), "%s/ble_frames.log", outdir);
+        f->ble_trace = fopen(path, "w");
+        snprintf(path, sizeof(path), "%s/shengyi_motor.log", outdir);
+        f->ts_trace = fopen(path, "w");
+    }
 
-        /* Build UI model from motor state */
-        ui_model_t model = {0};
-        model.page = (force_page >= 0) ? (uint8_t)force_page : UI_PAGE_DASHBOARD;
-        model.speed_dmph = sim_dwg_motor_speed_dmph(&motor);
-        model.cadence_rpm = sim_dwg_motor_cadence_rpm(&motor);
-        model.power_w = sim_dwg_motor_power_w(&motor);
-        model.soc_pct = sim_dwg_motor_soc_pct(&motor);
-        model.batt_dV = sim_dwg_motor_batt_dV(&motor);
-        model.batt_dA = sim_dwg_motor_batt_dA(&motor);
-        model.ctrl_temp_dC = sim_dwg_motor_temp_dC(&motor);
-        model.err = sim_dwg_motor_error_code(&motor);
-        model.assist_mode = motor.config.gear_setting;
-        model.virtual_gear = 2;
-        model.buttons = ui_buttons;
-        model.throttle_pct = 37;
-        model.brake = (i == 10u) ? 1 : 0;
-        model.theme = UI_THEME_NIGHT;
-        model.units = motor.config.units_mode;
-        model.range_est_d10 = 120;
-        model.range_confidence = 3;
-        model.graph_channel = UI_GRAPH_CH_SPEED;
-        model.graph_window_s = 30;
-        model.graph_sample_hz = (uint8_t)(1000u / UI_TICK_MS);
-
-        /* Tick UI */
-        ui_trace_t tr;
-        if (ui_tick(&ui, &model, t_ms, &tr))
+    /* Initialize all simulators */
+    sim_uart_init();
+    wire_capture_open(getenv("BC280_SIM_WIRE_CAPTURE"));
+    f->mcu = sim_mcu_create();
+    sim_ble_init(&f->ble);
+    sim_dwg_motor_init(&f->motor);
+    ui_init(&f->ui);
+    full_storage_init(f);
+
+    /* Environment config */
+    const char *btn_env = getenv("BC280_SIM_BUTTONS");
+    f->btn_mask = btn_env ? (uint8_t)strtoul(btn_env, NULL, 0) : 0u;
+    f->btn_env = btn_env != NULL;
+    f->btn_seq_len = parse_button_seq(getenv("BC280_SIM_BUTTONS_SEQ"), f->btn_seq, 16);
+    const char *force_page_env = getenv("BC280_SIM_FORCE_PAGE");
+    f->force_page = force_page_env ? atoi(force_page_env) : -1;
+    const char *event_env = getenv("BC280_SIM_EVENT");
+    f->event_mode = event_env && event_env[0] == '1';
+
+    /* Rider power profile from env */
+    double rider_power = 100.0;
+    const char *power_env = getenv("BC280_SIM_RIDER_POWER");
+    if (power_env)
+        rider_power = atof(power_env);
+    sim_dwg_motor_set_rider_power(&f->motor, rider_power);
+    if (!sim_ble_load_config(&f->load, getenv("BC280_SIM_BLE_LOAD"),
+                             getenv("BC280_SIM_BLE_LOAD_FPS"), getenv("BC280_SIM_BLE_BAUD")))
+    {
+        fprintf(stderr, "SIM FAIL: bad BC280_SIM_BLE_LOAD mix\n");
+        return 0;
+    }
+    sim_proto_init(&f->proto);
+    if (!sim_motor_link_config(&f->link))
+    {
+        fprintf(stderr, "SIM FAIL: bad BC280_SIM_MOTOR_* link knob\n");
+        return 0;
+    }
+    f->link_used = f->link.enabled;
+    const char *session_env = getenv("BC280_SIM_SESSION");
+    if (session_env && session_env[0])
+    {
+        if (f->event_mode)
         {
-            saw_ui = 1;
-            if (tr.hash != 0)
-                saw_hash = 1;
-            if (tr.render_ms > UI_TICK_MS)
-            {
-                render_over_budget = tr.render_ms;
-                break;
-            }
-            if (trace)
-            {
-                fprintf(trace, "t=%u hash=%08x ops=%u dirty=%u full=%u\n",
-                        t_ms, tr.hash, tr.draw_ops, tr.dirty_count, tr.full);
-            }
+            fprintf(stderr, "SIM FAIL: BC280_SIM_SESSION replays on the fixed-step loop only\n");
+            return 0;
+        }
+        if (!sim_session_load(&f->session, session_env))
+        {
+            fprintf(stderr, "SIM FAIL: bad BC280_SIM_SESSION image %s\n", session_env);
+            return 0;
         }
+        f->session_used = 1u;
+        speed_conv_set_wheel(&f->session_speed, SHENGYI_DEFAULT_WHEEL_MM);
     }
+    event_bus_init(&f->motor_bus);
+    motor_isr_init(&f->motor_bus);
+    if (f->scn)
+        full_apply_scenario(f, 0u);
 
-    if (trace)
-        fclose(trace);
-    if (ble_trace)
-        fclose(ble_trace);
-    if (ts_trace)
-        fclose(ts_trace);
-    sim_mcu_destroy(mcu);
+    /* Note: BLE commands will be sent after TTM connection (auto-connects at 500ms) */
+
+    /* Send initial Shengyi status request (display -> motor via UART2 TX) */
+    {
+        uint8_t frame[256];
+        size_t flen = sim_dwg_build_0xC2_request(frame, sizeof(frame));
+        sim_uart_tx_write(SIM_UART2, frame, flen);
+    }
+
+    /* Speed history for the graphs page, as graph_on_sample keeps it on target
+     * (500 ms cells, level 0 only: the 30 s window). */
+    static const uint8_t graph_factor[1] = { 1u };
+    pyramid_i16_init(&f->graph, f->graph_cells, 64u, 1u, graph_factor);
+    return 1;
+}
+
+int sim_full_step(sim_full_t *f)
+{
+    uint32_t i = f->steps++;
+
+    /* Step MCU and motor physics */
+    full_advance(f, f->dt_ms);
+    uint32_t t_ms = f->now_ms;
+    full_apply_scenario(f, t_ms);
+    if (f->session_used)
+        full_apply_session(f, t_ms);
+    full_exchange(f, t_ms, f->dt_ms);
+
+    /* Periodically send BLE commands (every 500ms) - only when connected */
+    if (sim_ttm_is_connected(&f->ble) && (i % (500 / f->dt_ms)) == 0 && i > 0)
+        full_ble_request();
+
+    /* Periodically send motor status request (every 100ms) */
+    if ((t_ms % 100) == 0 && t_ms > 0)
+        full_motor_request(f);
+
+    uint8_t buttons = f->session_used ? f->session_buttons
+                                      : full_buttons(i, f->btn_mask, f->btn_env, f->btn_seq, f->btn_seq_len);
+    if (f->scn_button_due)
+        buttons = f->scn_buttons;
+    f->scn_button_due = 0;
+    return full_ui_tick(f, t_ms, buttons, (i == 10u) ? 1 : 0);
+}
+
+void sim_full_end(sim_full_t *f)
+{
+    if (f->trace)
+        fclose(f->trace);
+    if (f->ble_trace)
+        fclose(f->ble_trace);
+    if (f->ts_trace)
+        fclose(f->ts_trace);
+    f->trace = f->ble_trace = f->ts_trace = NULL;
+    wire_capture_close();
+    sim_session_free(&f->session);
+    sim_storage_finish();
+    f->flash = sim_mcu_spi_flash(f->mcu)->stats;
+    sim_mcu_destroy(f->mcu);
+    f->mcu = NULL;
+}
+
+static int run_full_sim(uint32_t steps, uint32_t dt_ms, const char *outdir)
+{
+    static sim_full_t full;
+    sim_full_t *f = &full;
+    if (!sim_full_begin(f, g_have_scenario ? &g_scenario : NULL, dt_ms, outdir))
+        return 1;
+    /* A session runs to its last record unless BC280_SIM_STEPS says otherwise. */
+    if (f->session_used && !getenv("BC280_SIM_STEPS"))
+        steps = f->session.end_ms / dt_ms + 1u;
+
+    uint32_t sim_ms = 0;
+    uint32_t events = 0;
+    if (f->event_mode)
+    {
+        const char *dur_env = getenv("BC280_SIM_DURATION_S");
+        const char *ui_env = getenv("BC280_SIM_UI_MS");
+        uint32_t duration_ms = dur_env ? (uint32_t)strtoul(dur_env, NULL, 0) * 1000u : steps * dt_ms;
+        uint32_t ui_ms = ui_env ? (uint32_t)strtoul(ui_env, NULL, 0) : UI_TICK_MS;
+        if (ui_ms == 0)
+            ui_ms = UI_TICK_MS;
+        run_event_loop(f, duration_ms, dt_ms, ui_ms, f->btn_mask, f->btn_env,
+                       f->btn_seq, f->btn_seq_len, &events);
+        sim_ms = duration_ms;
+    }
+    else
+    {
+        while (f->steps < steps && sim_full_step(f))
+            ;
+        sim_ms = f->now_ms;
+    }
+    sim_full_end(f);
 
     const char *lcd_out = getenv("UI_LCD_OUTDIR");
     if (!lcd_out || !lcd_out[0])
         lcd_out = "out/lcd_out";
     printf("LCD DUMP: %s/host_lcd_latest.ppm\n", lcd_out);
+    if (!lcd_cost_report() || !lcd_mirror_report())
+        return 1;
+    uint32_t flash_violations = full_flash_report(&f->flash, sim_ms);
 
     printf("FULL SIM: TTM MAC=%s connects=%u disconnects=%u mac_queries=%u\n",
-           sim_ttm_get_mac_str(&ble),
-           ble.ttm.connections, ble.ttm.disconnections, ble.ttm.mac_queries);
+           sim_ttm_get_mac_str(&f->ble),
+           f->ble.ttm.connections, f->ble.ttm.disconnections, f->ble.ttm.mac_queries);
     printf("FULL SIM: BLE frames rx=%u tx=%u errs=%u\n",
-           ble.frames_rx, ble.frames_tx, ble.parse_errors);
+           f->ble.frames_rx, f->ble.frames_tx, f->ble.parse_errors);
     printf("FULL SIM: Motor frames rx=%u tx=%u errs=%u\n",
-           motor.frames_rx, motor.frames_tx, motor.parse_errors);
+           f->motor.frames_rx, f->motor.frames_tx, f->motor.parse_errors);
+    if (f->load.enabled)
+    {
+        const sim_ble_load_t *l = &f->load;
+        uint32_t link_bytes = (uint32_t)((uint64_t)l->baud / 10u * l->active_ms / 1000u);
+        printf("SIM BLE LOAD: fps=%u baud=%u offered=%u sent=%u ttm_drops=%u replies=%u "
+               "timeouts=%u lat_avg_ms=%u lat_p95_ms=%u lat_max_ms=%u up_pct=%u down_pct=%u "
+               "tx_backlog_max=%u tx_drops=%u stream=%u stream_gap_max_ms=%u\n",
+               l->offered_fps, l->baud, l->offered, l->sent, l->ttm_drops, l->replies,
+               l->timeouts, l->replies ? (uint32_t)(l->lat_sum_ms / l->replies) : 0u,
+               sim_ble_load_latency_pct(l, 95u), l->lat_max_ms,
+               link_bytes ? (uint32_t)((uint64_t)l->up_bytes * 100u / link_bytes) : 0u,
+               link_bytes ? (uint32_t)((uint64_t)l->down_bytes * 100u / link_bytes) : 0u,
+               l->down_max, l->tx_drops, l->stream_frames, l->stream_gap_max_ms);
+        printf("SIM BLE LOAD: ui_frames=%u lcd_avg_us=%u lcd_max_us=%u\n",
+               f->ui_frames, f->lcd_frames ? (uint32_t)(f->lcd_sum_us / f->lcd_frames) : 0u,
+               f->lcd_max_us);
+    }
+    if (f->link_used)
+    {
+        const sim_motor_link_t *l = &f->link;
+        motor_isr_stats_t ms;
+        motor_isr_get_stats(&ms);
+        printf("SIM MOTOR LINK: req=%u ignored=%u replies=%u bytes=%u dropped=%u slipped=%u "
+               "flipped=%u bursts=%u lat_max_ms=%u\n",
+               l->requests, l->ignored, l->replies, l->bytes, l->dropped, l->slipped,
+               l->flipped, l->bursts, l->lat_max_ms);
+        printf("SIM MOTOR LINK: decoded=%u rx_errors=%u status=%u rsp_avg_ms=%u rsp_max_ms=%u "
+               "status_gap_max_ms=%u\n",
+               ms.rx_count, ms.rx_errors, f->status_updates,
+               f->rsp_count ? (uint32_t)(f->rsp_sum_ms / f->rsp_count) : 0u,
+               f->rsp_max_ms, f->status_gap_max_ms);
+    }
+    if (f->session_used)
+    {
+        const sim_session_t *s = &f->session;
+        motor_isr_stats_t ms;
+        motor_isr_get_stats(&ms);
+        printf("SIM SESSION: records=%u replayed=%u end_ms=%u motor_bytes=%u ble_bytes=%u "
+               "buttons=%u adc=%u decoded=%u rx_errors=%u dropped=%u flags=%u\n",
+               s->records, f->session_replayed, s->end_ms, f->session_motor_bytes,
+               f->session_ble_bytes, f->session_buttons_seen, f->session_adc, ms.rx_count,
+               ms.rx_errors, s->dropped, s->flags);
+    }
+    printf("FULL SIM: Ride dist=%.2f km soc=%u%% sim_ms=%u ui_frames=%u ui_chunks=%u\n",
+           f->dist_m / 1000.0, f->motor.bike.soc_pct, sim_ms, f->ui_frames, f->ui.chunks);
+
+    /* Deterministic per-run metrics for scripts/sim_batch.py baselines. */
+    printf("SIM METRICS: name=%s hash=%08x frames=%u lcd_avg_us=%u lcd_max_us=%u "
+           "lcd_tick_max_us=%u btn_lcd_us=%u energy_mwh=%d dist_m=%u soc=%u ble_cmds=%u "
+           "flash_busy_us=%u flash_erases=%u\n",
+           f->scn ? f->scn->name : "env", f->frame_hash, f->ui_frames,
+           f->lcd_frames ? (uint32_t)(f->lcd_sum_us / f->lcd_frames) : 0u,
+           f->lcd_max_us, f->lcd_tick_max_us, f->btn_lcd_max_us, (int32_t)f->energy_mwh,
+           (uint32_t)f->dist_m, f->motor.bike.soc_pct, f->ble_cmds,
+           (uint32_t)f->flash.busy_us, f->flash.erases);
+
+    if (flash_violations)
+    {
+        fprintf(stderr, "SIM FAIL: %u SPI flash contract violations\n", flash_violations);
+        return 1;
+    }
 
-    if (render_over_budget)
+    if (f->render_over_budget)
     {
-        fprintf(stderr, "SIM FAIL: ui render dt %u > %u\n", render_over_budget, UI_TICK_MS);
+        fprintf(stderr, "SIM FAIL: ui render dt %u > %u\n", f->render_over_budget, UI_TICK_MS);
         return 1;
     }
-    if (!saw_ui || !saw_hash)
+    if (!f->saw_ui || !f->saw_hash)
     {
         fprintf(stderr, "SIM FAIL: missing UI ticks or hash\n");
         return 1;
     }
 
-    printf("FULL SIM PASS: steps=%u dt=%u ms\n", steps, dt_ms);
+    if (f->event_mode)
+        printf("FULL SIM PASS: event mode sim=%u ms events=%u\n", sim_ms, events);
+    else
+        printf("FULL SIM PASS: steps=%u dt=%u ms\n", steps, dt_ms);
     return 0;
 }
 
-int main(void)
+static int run_sim(void)
 {
+    const char *scn_env = getenv("BC280_SIM_SCENARIO");
+    if (scn_env && scn_env[0])
+    {
+        if (!sim_scenario_load(&g_scenario, scn_env))
+            return 1;
+        g_have_scenario = 1;
+    }
     const char *steps_env = getenv("BC280_SIM_STEPS");
     const char *dt_env = getenv("BC280_SIM_DT_MS");
     const char *outdir = getenv("BC280_SIM_OUTDIR");
@@ -399,12 +1145,14 @@ int main(void)
     }
 
     /* Use full simulation mode if BC280_SIM_FULL=1 */
-    if (full_sim_env && full_sim_env[0] == '1')
+    const char *session_env = getenv("BC280_SIM_SESSION");
+    if ((full_sim_env && full_sim_env[0] == '1') || g_have_scenario || (session_env && session_env[0]))
     {
         return run_full_sim(steps, dt_ms, outdir);
     }
 
     FILE *trace = NULL;
+    FILE *bin_trace = NULL;
     FILE *ts_trace = NULL;
     if (outdir && outdir[0])
     {
@@ -412,6 +1160,9 @@ int main(void)
         mkdir(outdir, 0755);
         snprintf(path, sizeof(path), "%s/sim_ui_trace.txt", outdir);
         trace = fopen(path, "w");
+        /* Same records as the text, framed as on UART1; see scripts/trace_decode.py. */
+        snprintf(path, sizeof(path), "%s/sim_ui_trace.bin", outdir);
+        bin_trace = fopen(path, "wb");
         snprintf(path, sizeof(path), "%s/shengyi_frames.log", outdir);
         ts_trace = fopen(path, "w");
     }
@@ -610,10 +1361,11 @@ int main(void)
             render_over_budget = t.render_ms;
             break;
         }
+        uint32_t lcd_us = lcd_cost_note(model.page, &t);
         if (trace)
         {
-            fprintf(trace, "t=%u hash=%08x ops=%u dirty=%u full=%u\n",
-                    proto.ms, t.hash, t.draw_ops, t.dirty_count, t.full);
+            fprintf(trace, "t=%u hash=%08x ops=%u dirty=%u full=%u page=%u lcd_us=%u\n",
+                    proto.ms, t.hash, t.draw_ops, t.dirty_count, t.full, model.page, lcd_us);
             if (model.page != UI_PAGE_DASHBOARD)
             {
                 char line[256];
@@ -622,11 +1374,24 @@ int main(void)
                     fprintf(trace, "%s", line);
             }
         }
+        if (bin_trace)
+        {
+            uint8_t rec[TRACE_BIN_MAX_LEN];
+            uint8_t frame[TRACE_BIN_MAX_LEN + 4u];
+            size_t n = ui_pack_dashboard_trace(rec, sizeof(rec), &model, &t, proto.ms);
+            if (model.page != UI_PAGE_DASHBOARD)
+                n = ui_pack_engineer_trace(rec, sizeof(rec), &model);
+            size_t fl = comm_frame_build(frame, sizeof(frame), TRACE_FRAME_CMD, rec, (uint8_t)n);
+            if (fl)
+                fwrite(frame, 1, fl, bin_trace);
+        }
     }
     }
 
     if (trace)
         fclose(trace);
+    if (bin_trace)
+        fclose(bin_trace);
     if (ts_trace)
         fclose(ts_trace);
     sim_mcu_destroy(mcu);
@@ -635,6 +1400,8 @@ int main(void)
     if (!lcd_out || !lcd_out[0])
         lcd_out = "out/lcd_out";
     printf("LCD DUMP: %s/host_lcd_latest.ppm\n", lcd_out);
+    if (!lcd_cost_report() || !lcd_mirror_report())
+        return 1;
 
     if (render_over_budget)
     {
@@ -684,3 +1451,161 @@ int main(void)
     printf("SIM PASS: steps=%u dt=%u ms\n", steps, dt_ms);
     return 0;
 }
+
+/*
+ * BC280_SIM_PROFILE=<file|dir>: after the run, write the firmware call tree
+ * as folded stacks (sim_prof.h); a directory gets <scenario name>.folded.
+ * Only host_sim_prof is instrumented.
+ */
+static int run_sim_profiled(void)
+{
+    int rc = run_sim();
+    sim_prof_write(getenv("BC280_SIM_PROFILE"), g_have_scenario ? g_scenario.name : "env");
+    return rc;
+}
+
+/*
+ * --jobs N: fan scenarios out across worker processes. Each scenario is one
+ * line of KEY=VALUE pairs (the same env knobs as a single run; '#' starts a
+ * comment). Firmware and sim modules keep their state in file-scope globals,
+ * so every scenario runs in a forked child with a private copy of them; its
+ * output is collected and printed as one "[job N]" block when it exits.
+ * Scenarios that write PPMs or traces need their own UI_LCD_OUTDIR /
+ * BC280_SIM_OUTDIR.
+ */
+#define SIM_JOBS_MAX_SCENARIOS 512u
+#define SIM_JOBS_LINE 512u
+
+typedef struct {
+    pid_t pid;
+    FILE *log;
+    uint32_t index;
+} sim_job_t;
+
+static void job_apply_env(char *line)
+{
+    for (char *tok = strtok(line, " \t\r\n"); tok; tok = strtok(NULL, " \t\r\n"))
+    {
+        char *eq = strchr(tok, '=');
+        if (!eq)
+            continue;
+        *eq = '\0';
+        setenv(tok, eq + 1, 1);
+    }
+}
+
+static int job_finish(sim_job_t *job, int status, const char *scenario)
+{
+    int ok = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    printf("[job %u] %s: %s\n", job->index, ok ? "PASS" : "FAIL", scenario);
+    char buf[512];
+    rewind(job->log);
+    while (fgets(buf, sizeof(buf), job->log))
+        printf("[job %u] %s", job->index, buf);
+    fclose(job->log);
+    job->pid = 0;
+    return ok;
+}
+
+static int run_jobs(uint32_t jobs, const char *path)
+{
+    FILE *in = (path && strcmp(path, "-") != 0) ? fopen(path, "r") : stdin;
+    if (!in)
+    {
+        fprintf(stderr, "cannot open scenarios %s\n", path);
+        return 1;
+    }
+    static char scenarios[SIM_JOBS_MAX_SCENARIOS][SIM_JOBS_LINE];
+    uint32_t count = 0;
+    char line[SIM_JOBS_LINE];
+    while (count < SIM_JOBS_MAX_SCENARIOS && fgets(line, sizeof(line), in))
+    {
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strspn(line, " \t") == strlen(line))
+            continue;
+        memcpy(scenarios[count++], line, sizeof(line));
+    }
+    if (in != stdin)
+        fclose(in);
+    if (!count)
+    {
+        fprintf(stderr, "no scenarios\n");
+        return 1;
+    }
+
+    sim_job_t slots[64] = {0};
+    if (jobs > 64u)
+        jobs = 64u;
+    uint32_t next = 0, running = 0, failed = 0;
+    while (next < count || running)
+    {
+        while (next < count && running < jobs)
+        {
+            sim_job_t *job = NULL;
+            for (uint32_t i = 0; i < jobs && !job; ++i)
+                if (!slots[i].pid)
+                    job = &slots[i];
+            job->log = tmpfile();
+            job->index = next;
+            if (!job->log)
+            {
+                perror("tmpfile");
+                return 1;
+            }
+            fflush(NULL);
+            pid_t pid = fork();
+            if (pid < 0)
+            {
+                perror("fork");
+                return 1;
+            }
+            if (pid == 0)
+            {
+                char env_line[SIM_JOBS_LINE];
+                memcpy(env_line, scenarios[next], sizeof(env_line));
+                job_apply_env(env_line);
+                dup2(fileno(job->log), STDOUT_FILENO);
+                dup2(fileno(job->log), STDERR_FILENO);
+                exit(run_sim_profiled());
+            }
+            job->pid = pid;
+            running++;
+            next++;
+        }
+        int status = 0;
+        pid_t done = wait(&status);
+        if (done < 0)
+            break;
+        for (uint32_t i = 0; i < jobs; ++i)
+        {
+            if (slots[i].pid != done)
+                continue;
+            if (!job_finish(&slots[i], status, scenarios[slots[i].index]))
+                failed++;
+            running--;
+            break;
+        }
+    }
+    printf("SIM JOBS: scenarios=%u jobs=%u failed=%u\n", count, jobs, failed);
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc >= 3 && strcmp(argv[1], "--jobs") == 0)
+    {
+        long jobs = strtol(argv[2], NULL, 0);
+        if (jobs <= 0)
+            jobs = sysconf(_SC_NPROCESSORS_ONLN);
+        return run_jobs(jobs > 0 ? (uint32_t)jobs : 1u, (argc >= 4) ? argv[3] : NULL);
+    }
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s [--jobs N [scenarios|-]]\n", argv[0]);
+        return 1;
+    }
+    return run_sim_profiled();
+}
@@ -53,21 +53,11 @@ struct sim_mcu {
     uint32_t gpio_idr[5];
     uint32_t gpio_odr[5];
     sim_uart_t uart[3];
-    uint8_t spi_flash[0x400000];
     uint32_t now_ms;
+    /* Last: survives sim_mcu_reset() like the external part does. */
+    sim_spi_flash_t flash;
 };
 
-static sim_uart_t *uart_by_addr(sim_mcu_t *s, uint32_t addr)
-{
-    if (addr >= UART1_BASE && addr < UART1_BASE + 0x100)
-        return &s->uart[0];
-    if (addr >= UART2_BASE && addr < UART2_BASE + 0x100)
-        return &s->uart[1];
-    if (addr >= UART4_BASE && addr < UART4_BASE + 0x100)
-        return &s->uart[2];
-    return NULL;
-}
-
 static void uart_push_rx(sim_uart_t *u, const uint8_t *data, size_t len)
 {
     for (size_t i = 0; i < len; ++i)
@@ -109,6 +99,7 @@ sim_mcu_t *sim_mcu_create(void)
     sim_mcu_t *s = (sim_mcu_t *)calloc(1, sizeof(*s));
     if (!s)
         return NULL;
+    sim_spi_flash_reset(&s->flash);
     sim_mcu_reset(s);
     return s;
 }
@@ -123,14 +114,13 @@ void sim_mcu_reset(sim_mcu_t *s)
 {
     if (!s)
         return;
-    memset(s, 0, sizeof(*s));
+    memset(s, 0, offsetof(sim_mcu_t, flash));
     s->rcc_csr = (1u << 27);
     for (int i = 0; i < 3; ++i)
         s->uart[i].sr = UART_SR_TXE;
     for (int ch = 0; ch < 18; ++ch)
         s->adc_values[ch] = 2000;
     s->adc_sr = 0;
-    s->spi_flash[0x3FF080] = 0xAA;
 }
 
 void sim_mcu_step(sim_mcu_t *s, uint32_t dt_ms)
@@ -138,6 +128,7 @@ void sim_mcu_step(sim_mcu_t *s, uint32_t dt_ms)
     if (!s)
         return;
     s->now_ms += dt_ms;
+    sim_spi_flash_advance_us(&s->flash, (uint64_t)dt_ms * 1000u);
     if (s->iwdg_started && s->iwdg_rlr)
     {
         uint32_t timeout_ms = (uint32_t)((s->iwdg_rlr + 1u) * 4u / 40u);
@@ -151,153 +142,206 @@ void sim_mcu_step(sim_mcu_t *s, uint32_t dt_ms)
     }
 }
 
-static uint32_t gpio_index(uint32_t base)
+/*
+ * Register access dispatches on the 1 KB peripheral page: (addr - 0x40000000)
+ * >> 10 indexes a constant table of handlers plus the unit (UART/GPIO
+ * instance) the page belongs to. Each readable page also names one
+ * side-effect-free register - the status and input registers drivers spin
+ * on - that read32 returns straight from the model without calling the
+ * handler.
+ */
+#define MMIO_BASE 0x40000000u
+#define MMIO_PAGE_SHIFT 10u
+#define MMIO_PAGE_MASK 0x3FFu
+#define MMIO_PAGES 0xC0u /* APB1, APB2 and AHB up to 0x40030000 */
+#define MMIO_PAGE(base) (((base) - MMIO_BASE) >> MMIO_PAGE_SHIFT)
+
+typedef uint32_t (*mmio_read_fn)(sim_mcu_t *s, uint8_t unit, uint32_t off);
+typedef void (*mmio_write_fn)(sim_mcu_t *s, uint8_t unit, uint32_t off, uint32_t value);
+
+typedef struct {
+    mmio_read_fn read;
+    mmio_write_fn write;
+    uint8_t unit;
+    uint16_t hot_off;   /* page offset of the fast-path register */
+    uint16_t hot_field; /* its offset in sim_mcu_t */
+} mmio_page_t;
+
+static uint32_t rcc_read(sim_mcu_t *s, uint8_t unit, uint32_t off)
 {
-    switch (base)
-    {
-        case GPIOA_BASE: return 0;
-        case GPIOB_BASE: return 1;
-        case GPIOC_BASE: return 2;
-        case GPIOD_BASE: return 3;
-        case GPIOE_BASE: return 4;
-        default: return 0xFFFFFFFFu;
-    }
+    (void)unit;
+    return (off == 0x24u) ? s->rcc_csr : 0u;
 }
 
-uint32_t sim_mcu_read32(sim_mcu_t *s, uint32_t addr)
+static void rcc_write(sim_mcu_t *s, uint8_t unit, uint32_t off, uint32_t value)
 {
-    if (!s)
-        return 0;
-    if (addr == RCC_CSR)
-        return s->rcc_csr;
-    if (addr >= GPIOA_BASE && addr <= GPIOE_BASE + 0x0Cu)
+    (void)unit;
+    if (off == 0x24u && (value & (1u << 24)))
+        s->rcc_csr &= ~0xFE000000u;
+}
+
+static void iwdg_write(sim_mcu_t *s, uint8_t unit, uint32_t off, uint32_t value)
+{
+    (void)unit;
+    switch (off)
     {
-        uint32_t idx = gpio_index(addr & ~0x3FFu);
-        if (idx < 5 && (addr & 0x3FFu) == 0x08u)
-            return s->gpio_idr[idx];
-        if (idx < 5 && (addr & 0x3FFu) == 0x0Cu)
-            return s->gpio_odr[idx];
+        case 0x00:
+            if (value == 0x5555u)
+                s->iwdg_unlocked = 1;
+            else if (value == 0xCCCCu)
+            {
+                s->iwdg_started = 1;
+                s->iwdg_kick_ms = s->now_ms;
+            }
+            else if (value == 0xAAAAu)
+            {
+                s->iwdg_kick_ms = s->now_ms;
+            }
+            break;
+        case 0x04:
+            if (s->iwdg_unlocked)
+                s->iwdg_pr = value & 0x7u;
+            break;
+        case 0x08:
+            if (s->iwdg_unlocked)
+                s->iwdg_rlr = value & 0x0FFFu;
+            break;
+        default:
+            break;
     }
-    if ((addr >= UART1_BASE && addr < UART1_BASE + 0x100) ||
-        (addr >= UART2_BASE && addr < UART2_BASE + 0x100) ||
-        (addr >= UART4_BASE && addr < UART4_BASE + 0x100))
+}
+
+static uint32_t uart_read(sim_mcu_t *s, uint8_t unit, uint32_t off)
+{
+    sim_uart_t *u = &s->uart[unit];
+    switch (off)
     {
-        sim_uart_t *u = uart_by_addr(s, addr);
-        if (!u)
+        case 0x00: return u->sr;
+        case 0x04:
+            if (u->rx_tail != u->rx_head)
+            {
+                uint8_t v = u->rx_buf[u->rx_tail];
+                u->rx_tail = (u->rx_tail + 1u) % sizeof(u->rx_buf);
+                if (u->rx_tail == u->rx_head)
+                    u->sr &= ~UART_SR_RXNE;
+                return v;
+            }
             return 0;
-        switch (addr & 0xFFu)
-        {
-            case 0x00: return u->sr;
-            case 0x04:
-                if (u->rx_tail != u->rx_head)
-                {
-                    uint8_t v = u->rx_buf[u->rx_tail];
-                    u->rx_tail = (u->rx_tail + 1u) % sizeof(u->rx_buf);
-                    if (u->rx_tail == u->rx_head)
-                        u->sr &= ~UART_SR_RXNE;
-                    return v;
-                }
-                return 0;
-            case 0x08: return u->brr;
-            case 0x0C: return u->cr1;
-            default: return 0;
-        }
+        case 0x08: return u->brr;
+        case 0x0C: return u->cr1;
+        default: return 0;
     }
-    if (addr == ADC1_BASE + 0x00u)
-        return s->adc_sr;
-    if (addr == ADC1_BASE + 0x4Cu)
+}
+
+static void uart_write(sim_mcu_t *s, uint8_t unit, uint32_t off, uint32_t value)
+{
+    sim_uart_t *u = &s->uart[unit];
+    switch (off)
     {
-        /* Reading DR clears EOC in SR (STM32F1-like behavior). */
-        s->adc_sr &= ~(1u << 1);
-        return s->adc_last;
+        case 0x04:
+            uart_push_tx(u, (uint8_t)value);
+            break;
+        case 0x08:
+            u->brr = value;
+            break;
+        case 0x0C:
+            u->cr1 = value;
+            break;
+        default:
+            break;
     }
+}
+
+static uint32_t gpio_read(sim_mcu_t *s, uint8_t unit, uint32_t off)
+{
+    if (off == 0x08u)
+        return s->gpio_idr[unit];
+    if (off == 0x0Cu)
+        return s->gpio_odr[unit];
     return 0;
 }
 
-void sim_mcu_write32(sim_mcu_t *s, uint32_t addr, uint32_t value)
+static void gpio_write(sim_mcu_t *s, uint8_t unit, uint32_t off, uint32_t value)
 {
-    if (!s)
-        return;
-    if (addr == RCC_CSR)
+    if (off == 0x10u)
     {
-        if (value & (1u << 24))
-            s->rcc_csr &= ~0xFE000000u;
-        return;
+        uint32_t set = value & 0xFFFFu;
+        uint32_t rst = (value >> 16) & 0xFFFFu;
+        s->gpio_odr[unit] |= set;
+        s->gpio_odr[unit] &= ~rst;
     }
-    if (addr >= GPIOA_BASE && addr <= GPIOE_BASE + 0x18u)
+    else if (off == 0x14u)
     {
-        uint32_t idx = gpio_index(addr & ~0x3FFu);
-        uint32_t off = addr & 0x3FFu;
-        if (idx < 5 && off == 0x10u)
-        {
-            uint32_t set = value & 0xFFFFu;
-            uint32_t rst = (value >> 16) & 0xFFFFu;
-            s->gpio_odr[idx] |= set;
-            s->gpio_odr[idx] &= ~rst;
-        }
-        else if (idx < 5 && off == 0x14u)
-        {
-            s->gpio_odr[idx] &= ~(value & 0xFFFFu);
-        }
-        return;
+        s->gpio_odr[unit] &= ~(value & 0xFFFFu);
     }
-    if ((addr >= UART1_BASE && addr < UART1_BASE + 0x100) ||
-        (addr >= UART2_BASE && addr < UART2_BASE + 0x100) ||
-        (addr >= UART4_BASE && addr < UART4_BASE + 0x100))
-    {
-        sim_uart_t *u = uart_by_addr(s, addr);
-        if (!u)
-            return;
-        switch (addr & 0xFFu)
-        {
-            case 0x04:
-                uart_push_tx(u, (uint8_t)value);
-                break;
-            case 0x08:
-                u->brr = value;
-                break;
-            case 0x0C:
-                u->cr1 = value;
-                break;
-            default:
-                break;
-        }
-        return;
-    }
-    if (addr == IWDG_BASE + 0x00u)
-    {
-        if (value == 0x5555u)
-            s->iwdg_unlocked = 1;
-        else if (value == 0xCCCCu)
-        {
-            s->iwdg_started = 1;
-            s->iwdg_kick_ms = s->now_ms;
-        }
-        else if (value == 0xAAAAu)
-        {
-            s->iwdg_kick_ms = s->now_ms;
-        }
-        return;
-    }
-    if (addr == IWDG_BASE + 0x04u && s->iwdg_unlocked)
+}
+
+static uint32_t adc_read(sim_mcu_t *s, uint8_t unit, uint32_t off)
+{
+    (void)unit;
+    if (off == 0x00u)
+        return s->adc_sr;
+    if (off == 0x4Cu)
     {
-        s->iwdg_pr = value & 0x7u;
-        return;
+        /* Reading DR clears EOC in SR (STM32F1-like behavior). */
+        s->adc_sr &= ~(1u << 1);
+        return s->adc_last;
     }
-    if (addr == IWDG_BASE + 0x08u && s->iwdg_unlocked)
+    return 0;
+}
+
+static void adc_write(sim_mcu_t *s, uint8_t unit, uint32_t off, uint32_t value)
+{
+    (void)unit;
+    if (off == 0x08u && (value & (1u << 22)))
     {
-        s->iwdg_rlr = value & 0x0FFFu;
-        return;
+        s->adc_last = s->adc_values[0];
+        s->adc_sr |= (1u << 1); /* EOC */
     }
-    if (addr == ADC1_BASE + 0x08u)
-    {
-        if (value & (1u << 22))
-        {
-            s->adc_last = s->adc_values[0];
-            s->adc_sr |= (1u << 1); /* EOC */
-        }
+}
+
+#define UART_PAGE(unit) \
+    {uart_read, uart_write, (unit), 0x00u, (uint16_t)offsetof(sim_mcu_t, uart[unit].sr)}
+#define GPIO_PAGE(unit) \
+    {gpio_read, gpio_write, (unit), 0x08u, (uint16_t)offsetof(sim_mcu_t, gpio_idr[unit])}
+
+static const mmio_page_t k_mmio_pages[MMIO_PAGES] = {
+    [MMIO_PAGE(IWDG_BASE)] = {NULL, iwdg_write, 0, 0, 0},
+    [MMIO_PAGE(UART2_BASE)] = UART_PAGE(1),
+    [MMIO_PAGE(UART4_BASE)] = UART_PAGE(2),
+    [MMIO_PAGE(GPIOA_BASE)] = GPIO_PAGE(0),
+    [MMIO_PAGE(GPIOB_BASE)] = GPIO_PAGE(1),
+    [MMIO_PAGE(GPIOC_BASE)] = GPIO_PAGE(2),
+    [MMIO_PAGE(GPIOD_BASE)] = GPIO_PAGE(3),
+    [MMIO_PAGE(GPIOE_BASE)] = GPIO_PAGE(4),
+    [MMIO_PAGE(ADC1_BASE)] = {adc_read, adc_write, 0, 0x00u, (uint16_t)offsetof(sim_mcu_t, adc_sr)},
+    [MMIO_PAGE(UART1_BASE)] = UART_PAGE(0),
+    [MMIO_PAGE(RCC_BASE)] = {rcc_read, rcc_write, 0, 0x24u, (uint16_t)offsetof(sim_mcu_t, rcc_csr)},
+};
+
+static inline const mmio_page_t *mmio_page(uint32_t addr)
+{
+    uint32_t page = (addr - MMIO_BASE) >> MMIO_PAGE_SHIFT;
+    return (page < MMIO_PAGES) ? &k_mmio_pages[page] : NULL;
+}
+
+uint32_t sim_mcu_read32(sim_mcu_t *s, uint32_t addr)
+{
+    const mmio_page_t *p = mmio_page(addr);
+    if (!s || !p || !p->read)
+        return 0;
+    uint32_t off = addr & MMIO_PAGE_MASK;
+    if (off == p->hot_off)
+        return *(const uint32_t *)(const void *)((const uint8_t *)s + p->hot_field);
+    return p->read(s, p->unit, off);
+}
+
+void sim_mcu_write32(sim_mcu_t *s, uint32_t addr, uint32_t value)
+{
+    const mmio_page_t *p = mmio_page(addr);
+    if (!s || !p || !p->write)
         return;
-    }
+    p->write(s, p->unit, addr & MMIO_PAGE_MASK, value);
 }
 
 void sim_mcu_gpio_set_input(sim_mcu_t *s, char port, uint8_t pin, uint8_t level)
@@ -363,16 +407,36 @@ void sim_mcu_spi_flash_write(sim_mcu_t *s, uint32_t addr, const uint8_t *data, s
 {
     if (!s || !data)
         return;
-    if (addr + len > sizeof(s->spi_flash))
+    if (addr + len > SIM_SPI_FLASH_SIZE)
+        return;
+    while (len)
+    {
+        size_t n = sim_spi_flash_page_program(&s->flash, addr, data, len);
+        sim_spi_flash_wait(&s->flash);
+        addr += (uint32_t)n;
+        data += n;
+        len -= n;
+    }
+}
+
+void sim_mcu_spi_flash_erase_4k(sim_mcu_t *s, uint32_t addr)
+{
+    if (!s || addr >= SIM_SPI_FLASH_SIZE)
         return;
-    memcpy(&s->spi_flash[addr], data, len);
+    sim_spi_flash_erase_4k(&s->flash, addr);
+    sim_spi_flash_wait(&s->flash);
 }
 
 void sim_mcu_spi_flash_read(sim_mcu_t *s, uint32_t addr, uint8_t *out, size_t len)
 {
     if (!s || !out)
         return;
-    if (addr + len > sizeof(s->spi_flash))
+    if (addr + len > SIM_SPI_FLASH_SIZE)
         return;
-    memcpy(out, &s->spi_flash[addr], len);
+    sim_spi_flash_read(&s->flash, addr, out, len);
+}
+
+sim_spi_flash_t *sim_mcu_spi_flash(sim_mcu_t *s)
+{
+    return s ? &s->flash : NULL;
 }
@@ -4,6 +4,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "sim_spi_flash.h"
+
 typedef struct sim_mcu sim_mcu_t;
 
 sim_mcu_t *sim_mcu_create(void);
@@ -22,7 +24,12 @@ void sim_mcu_adc_set_channel(sim_mcu_t *s, uint8_t ch, uint16_t value);
 size_t sim_mcu_uart_pop_tx(sim_mcu_t *s, int uart, uint8_t *out, size_t cap);
 size_t sim_mcu_uart_push_rx(sim_mcu_t *s, int uart, const uint8_t *data, size_t len);
 
+/* NOR semantics (see sim_spi_flash.h): writes program page by page and
+ * wait for WIP, so they only clear bits; erase first to rewrite. */
 void sim_mcu_spi_flash_write(sim_mcu_t *s, uint32_t addr, const uint8_t *data, size_t len);
+void sim_mcu_spi_flash_erase_4k(sim_mcu_t *s, uint32_t addr);
 void sim_mcu_spi_flash_read(sim_mcu_t *s, uint32_t addr, uint8_t *out, size_t len);
+/* The flash model, advanced by sim_mcu_step(); kept across resets. */
+sim_spi_flash_t *sim_mcu_spi_flash(sim_mcu_t *s);
 
 #endif
@@ -0,0 +1,209 @@
+#include "sim_motor_link.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const k_param_names[SIM_MOTOR_LINK_PARAMS] = {
+    "latency", "jitter", "tail_pct", "tail_ms", "ppm", "drop", "noise", "noise_len", "gap",
+};
+
+static uint32_t link_rand(sim_motor_link_t *l)
+{
+    l->rng ^= l->rng << 13;
+    l->rng ^= l->rng >> 17;
+    l->rng ^= l->rng << 5;
+    return l->rng;
+}
+
+/* Uniform in [0, 1). */
+static double link_unit(sim_motor_link_t *l)
+{
+    return (double)(link_rand(l) >> 8) / 16777216.0;
+}
+
+static void link_update_enabled(sim_motor_link_t *l)
+{
+    l->enabled = 0u;
+    for (uint8_t i = 0; i < SIM_MOTOR_LINK_PARAMS; ++i)
+    {
+        if (i != SIM_MOTOR_LINK_NOISE_LEN && l->param[i] != 0.0)
+            l->enabled = 1u;
+    }
+}
+
+/* "a[:b[:c...]]" into consecutive params from first; 0 on junk. */
+static int link_parse(sim_motor_link_t *l, const char *env, uint8_t first, uint8_t max_fields)
+{
+    const char *s = getenv(env);
+    if (!s || !s[0])
+        return 1;
+    for (uint8_t i = 0; i < max_fields; ++i)
+    {
+        char *end;
+        l->param[first + i] = strtod(s, &end);
+        if (end == s)
+            return 0;
+        s = end;
+        if (*s != ':')
+            break;
+        ++s;
+    }
+    return *s == '\0';
+}
+
+int sim_motor_link_config(sim_motor_link_t *l)
+{
+    memset(l, 0, sizeof(*l));
+    l->rng = 0x9E3779B9u;
+    l->param[SIM_MOTOR_LINK_NOISE_LEN] = 8.0;
+    int ok = link_parse(l, "BC280_SIM_MOTOR_LATENCY", SIM_MOTOR_LINK_LATENCY, 4u) &&
+             link_parse(l, "BC280_SIM_MOTOR_BAUD_PPM", SIM_MOTOR_LINK_PPM, 1u) &&
+             link_parse(l, "BC280_SIM_MOTOR_DROP_PCT", SIM_MOTOR_LINK_DROP, 1u) &&
+             link_parse(l, "BC280_SIM_MOTOR_NOISE", SIM_MOTOR_LINK_NOISE, 2u) &&
+             link_parse(l, "BC280_SIM_MOTOR_MIN_GAP_MS", SIM_MOTOR_LINK_GAP, 1u);
+    if (l->param[SIM_MOTOR_LINK_NOISE_LEN] < 1.0)
+        ok = 0;
+    link_update_enabled(l);
+    return ok;
+}
+
+void sim_motor_link_set(sim_motor_link_t *l, uint8_t param, double value)
+{
+    if (!l || param >= SIM_MOTOR_LINK_PARAMS)
+        return;
+    if (param == SIM_MOTOR_LINK_NOISE_LEN && value < 1.0)
+        value = 1.0;
+    l->param[param] = value;
+    link_update_enabled(l);
+}
+
+int sim_motor_link_param_id(const char *name)
+{
+    for (int i = 0; i < (int)SIM_MOTOR_LINK_PARAMS; ++i)
+    {
+        if (strcmp(name, k_param_names[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+int sim_motor_link_accept(sim_motor_link_t *l, uint32_t t_ms)
+{
+    l->requests++;
+    uint32_t gap = (uint32_t)l->param[SIM_MOTOR_LINK_GAP];
+    if (l->answered && gap && t_ms - l->last_answer_ms < gap)
+    {
+        l->ignored++;
+        return 0;
+    }
+    l->answered = 1u;
+    l->last_answer_ms = t_ms;
+    return 1;
+}
+
+/* Chance that the display mis-samples a byte sent ppm off its baud. */
+static double link_slip_chance(double ppm)
+{
+    double err = fabs(ppm) / 1e6;
+    if (err <= 0.02)
+        return 0.0;
+    if (err >= 0.05)
+        return 1.0;
+    return (err - 0.02) / 0.03;
+}
+
+/* One byte through the channel; returns 0 when it is lost. */
+static int link_channel(sim_motor_link_t *l, uint8_t *b)
+{
+    if (l->param[SIM_MOTOR_LINK_DROP] > 0.0 && link_unit(l) * 100.0 < l->param[SIM_MOTOR_LINK_DROP])
+    {
+        l->dropped++;
+        return 0;
+    }
+    double ppm = l->param[SIM_MOTOR_LINK_PPM];
+    double slip = link_slip_chance(ppm);
+    if (slip > 0.0 && link_unit(l) < slip)
+    {
+        /* A fast sender's stop bit lands inside the last data bit and the
+         * other way round for a slow one. */
+        *b = (ppm > 0.0) ? (uint8_t)((*b << 1) | 1u) : (uint8_t)((*b >> 1) | 0x80u);
+        l->slipped++;
+    }
+    if (l->in_burst)
+    {
+        if (link_unit(l) * l->param[SIM_MOTOR_LINK_NOISE_LEN] < 1.0)
+            l->in_burst = 0u;
+    }
+    else if (l->param[SIM_MOTOR_LINK_NOISE] > 0.0 &&
+             link_unit(l) * 100.0 < l->param[SIM_MOTOR_LINK_NOISE])
+    {
+        l->in_burst = 1u;
+        l->bursts++;
+    }
+    if (l->in_burst)
+    {
+        *b ^= (uint8_t)(1u << (link_rand(l) & 7u));
+        l->flipped++;
+    }
+    return 1;
+}
+
+void sim_motor_link_submit(sim_motor_link_t *l, const uint8_t *data, size_t len, uint32_t t_ms)
+{
+    if (!len)
+        return;
+    l->replies++;
+    double lat = l->param[SIM_MOTOR_LINK_LATENCY] + link_unit(l) * l->param[SIM_MOTOR_LINK_JITTER];
+    if (l->param[SIM_MOTOR_LINK_TAIL_PCT] > 0.0 &&
+        link_unit(l) * 100.0 < l->param[SIM_MOTOR_LINK_TAIL_PCT])
+        lat += link_unit(l) * l->param[SIM_MOTOR_LINK_TAIL_MS];
+    if (lat < 0.0)
+        lat = 0.0;
+    if ((uint32_t)lat > l->lat_max_ms)
+        l->lat_max_ms = (uint32_t)lat;
+
+    /* The controller clocks bytes out back to back at its own baud, after
+     * whatever it is still sending. */
+    double baud = SIM_MOTOR_LINK_BAUD * (1.0 + l->param[SIM_MOTOR_LINK_PPM] / 1e6);
+    uint64_t byte_us = (uint64_t)(10e6 / baud);
+    uint64_t at = (uint64_t)t_ms * 1000u + (uint64_t)(lat * 1000.0);
+    if (at < l->wire_free_us)
+        at = l->wire_free_us;
+    for (size_t i = 0; i < len; ++i)
+    {
+        at += byte_us;
+        uint8_t b = data[i];
+        l->bytes++;
+        if (!link_channel(l, &b))
+            continue;
+        if (l->q_len >= SIM_MOTOR_LINK_QUEUE)
+        {
+            l->overflow++;
+            continue;
+        }
+        l->q[l->q_len] = b;
+        l->q_at_us[l->q_len] = at;
+        l->q_len++;
+    }
+    l->wire_free_us = at;
+}
+
+size_t sim_motor_link_deliver(sim_motor_link_t *l, uint32_t t_ms, uint8_t *out, size_t cap)
+{
+    uint64_t now_us = (uint64_t)t_ms * 1000u;
+    size_t n = 0;
+    while (n < l->q_len && n < cap && l->q_at_us[n] <= now_us)
+    {
+        out[n] = l->q[n];
+        n++;
+    }
+    if (n)
+    {
+        memmove(l->q, &l->q[n], l->q_len - n);
+        memmove(l->q_at_us, &l->q_at_us[n], (l->q_len - n) * sizeof(l->q_at_us[0]));
+        l->q_len = (uint16_t)(l->q_len - n);
+    }
+    return n;
+}
@@ -0,0 +1,99 @@
+#ifndef SIM_MOTOR_LINK_H
+#define SIM_MOTOR_LINK_H
+
+/*
+ * Controller side of the UART2 link for the full sim: an adversary for the
+ * display's motor RX path.
+ *
+ * The controller model (sim_dwg_motor) answers at once and cleanly; this
+ * layer sits between its replies and the display. Each reply is held for a
+ * response latency drawn from base + uniform jitter, with a tail_pct chance
+ * of up to tail_ms more, then clocked out byte by byte at the controller's
+ * own baud (9600 off by ppm). On the way a byte can be:
+ *   - mis-sampled by the display when the baud error is large: never below
+ *     2 %, always beyond 5 %, linear between; the byte slips one bit
+ *   - dropped (drop_pct per byte)
+ *   - hit by a noise burst: a Gilbert-Elliott two-state channel enters a
+ *     burst with noise_pct per byte and stays for noise_len bytes on
+ *     average; burst bytes get one random bit flipped
+ * and the controller can be rate limited: a request arriving less than
+ * min_gap_ms after the last one it answered is ignored.
+ *
+ * Knobs (env or scenario KEY=VALUE), every impairment off by default:
+ *   BC280_SIM_MOTOR_LATENCY=base[:jitter[:tail_pct:tail_ms]]   ms
+ *   BC280_SIM_MOTOR_BAUD_PPM=ppm          signed controller baud error
+ *   BC280_SIM_MOTOR_DROP_PCT=pct
+ *   BC280_SIM_MOTOR_NOISE=pct:len
+ *   BC280_SIM_MOTOR_MIN_GAP_MS=ms
+ * and mid-run from the timeline: `<time> link <param> <value>` with param
+ * one of latency, jitter, tail_pct, tail_ms, ppm, drop, noise, noise_len,
+ * gap (sim_motor_link_set()).
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_MOTOR_LINK_QUEUE     2048u   /* reply bytes in flight */
+#define SIM_MOTOR_LINK_BAUD      9600u
+#define SIM_MOTOR_LINK_TICK_MS   5u      /* event-mode step while impaired */
+
+typedef enum {
+    SIM_MOTOR_LINK_LATENCY = 0,
+    SIM_MOTOR_LINK_JITTER,
+    SIM_MOTOR_LINK_TAIL_PCT,
+    SIM_MOTOR_LINK_TAIL_MS,
+    SIM_MOTOR_LINK_PPM,
+    SIM_MOTOR_LINK_DROP,
+    SIM_MOTOR_LINK_NOISE,
+    SIM_MOTOR_LINK_NOISE_LEN,
+    SIM_MOTOR_LINK_GAP,
+    SIM_MOTOR_LINK_PARAMS
+} sim_motor_link_param_t;
+
+typedef struct {
+    uint8_t enabled;
+    double param[SIM_MOTOR_LINK_PARAMS];
+    uint32_t rng;
+    uint8_t in_burst;
+
+    /* Bytes on their way to the display, each with its arrival time. */
+    uint8_t q[SIM_MOTOR_LINK_QUEUE];
+    uint64_t q_at_us[SIM_MOTOR_LINK_QUEUE];
+    uint16_t q_len;
+    uint64_t wire_free_us;   /* controller TX idle from here */
+
+    uint32_t last_answer_ms;
+    uint8_t answered;
+
+    /* Statistics */
+    uint32_t requests;
+    uint32_t ignored;        /* rate limited */
+    uint32_t replies;
+    uint32_t bytes;
+    uint32_t dropped;
+    uint32_t slipped;        /* baud mismatch */
+    uint32_t flipped;        /* noise */
+    uint32_t bursts;
+    uint32_t overflow;       /* bytes lost to a full queue */
+    uint32_t lat_max_ms;
+} sim_motor_link_t;
+
+/* Read the knobs; returns 0 on a malformed value. */
+int sim_motor_link_config(sim_motor_link_t *l);
+
+/* Timeline change; any non-zero impairment enables the link. */
+void sim_motor_link_set(sim_motor_link_t *l, uint8_t param, double value);
+
+/* Timeline parameter name -> sim_motor_link_param_t, -1 when unknown. */
+int sim_motor_link_param_id(const char *name);
+
+/* A display request at t_ms: 1 if the controller takes it, 0 if ignored. */
+int sim_motor_link_accept(sim_motor_link_t *l, uint32_t t_ms);
+
+/* One controller reply produced at t_ms. */
+void sim_motor_link_submit(sim_motor_link_t *l, const uint8_t *data, size_t len, uint32_t t_ms);
+
+/* Bytes that reached the display by t_ms; returns how many were copied. */
+size_t sim_motor_link_deliver(sim_motor_link_t *l, uint32_t t_ms, uint8_t *out, size_t cap);
+
+#endif
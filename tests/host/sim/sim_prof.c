@@ -0,0 +1,269 @@
+#define _DEFAULT_SOURCE
+
+#include "sim_prof.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define NO_INSTR __attribute__((no_instrument_function))
+
+#define SIM_PROF_NODES 32768u
+#define SIM_PROF_DEPTH 256u
+/* Pseudo function address of the [sim] zone frame. */
+#define SIM_PROF_SIM_FN ((void *)1)
+
+/* Call tree: one node per distinct call path, children as a sibling list.
+ * Node 0 is the root (outside any firmware call). */
+typedef struct {
+    void *fn;
+    uint32_t parent;
+    uint32_t child;
+    uint32_t sibling;
+    uint64_t self_us;
+    uint64_t calls;
+} prof_node_t;
+
+typedef struct {
+    uint32_t node;
+    uint64_t t0_us;
+    uint64_t child_us;
+} prof_frame_t;
+
+static prof_node_t g_nodes[SIM_PROF_NODES];
+static uint32_t g_node_count = 1u;
+static prof_frame_t g_stack[SIM_PROF_DEPTH];
+static uint32_t g_depth;
+static uint32_t g_overflow;     /* frames deeper than the stack, not tracked */
+static uint32_t g_dropped;      /* call paths merged into their parent: pool full */
+static uint64_t g_entries;
+
+void __cyg_profile_func_enter(void *fn, void *site) NO_INSTR;
+void __cyg_profile_func_exit(void *fn, void *site) NO_INSTR;
+
+/* Microseconds, as the benches: platform/time.h hides the host <time.h>.
+ * Most calls are shorter than a tick, but the phase is random so the sums
+ * come out right over a run. */
+static NO_INSTR uint64_t now_us(void)
+{
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000ull + (uint64_t)tv.tv_usec;
+}
+
+static NO_INSTR uint32_t child_of(uint32_t parent, void *fn)
+{
+    uint32_t i;
+    for (i = g_nodes[parent].child; i; i = g_nodes[i].sibling)
+    {
+        if (g_nodes[i].fn == fn)
+            return i;
+    }
+    if (g_node_count >= SIM_PROF_NODES)
+    {
+        g_dropped++;
+        return parent;
+    }
+    i = g_node_count++;
+    g_nodes[i].fn = fn;
+    g_nodes[i].parent = parent;
+    g_nodes[i].sibling = g_nodes[parent].child;
+    g_nodes[parent].child = i;
+    return i;
+}
+
+static NO_INSTR void prof_push(void *fn)
+{
+    if (g_depth >= SIM_PROF_DEPTH)
+    {
+        g_overflow++;
+        return;
+    }
+    uint32_t n = child_of(g_depth ? g_stack[g_depth - 1u].node : 0u, fn);
+    g_nodes[n].calls++;
+    g_stack[g_depth].node = n;
+    g_stack[g_depth].child_us = 0;
+    g_stack[g_depth].t0_us = now_us();
+    g_depth++;
+}
+
+static NO_INSTR void prof_pop(void)
+{
+    uint64_t t = now_us();
+    if (g_overflow)
+    {
+        g_overflow--;
+        return;
+    }
+    if (!g_depth)
+        return;
+    prof_frame_t *f = &g_stack[--g_depth];
+    uint64_t elapsed = t - f->t0_us;
+    g_nodes[f->node].self_us += (elapsed > f->child_us) ? elapsed - f->child_us : 0u;
+    if (g_depth)
+        g_stack[g_depth - 1u].child_us += elapsed;
+}
+
+void __cyg_profile_func_enter(void *fn, void *site)
+{
+    (void)site;
+    g_entries++;
+    prof_push(fn);
+}
+
+void __cyg_profile_func_exit(void *fn, void *site)
+{
+    (void)fn;
+    (void)site;
+    prof_pop();
+}
+
+int sim_prof_sim_enter(void)
+{
+    /* Only when firmware called in, and once per nest (draw_value -> draw_text). */
+    if (!g_depth || g_overflow || g_nodes[g_stack[g_depth - 1u].node].fn == SIM_PROF_SIM_FN)
+        return 0;
+    prof_push(SIM_PROF_SIM_FN);
+    return 1;
+}
+
+void sim_prof_sim_leave(int *token)
+{
+    if (*token)
+        prof_pop();
+}
+
+/* Function names from the running binary's symbol table, rebased by the
+ * load address of a known function (PIE). */
+typedef struct {
+    uintptr_t addr;
+    char *name;
+} prof_sym_t;
+
+static prof_sym_t *g_syms;
+static size_t g_sym_count;
+
+static int sym_cmp(const void *a, const void *b)
+{
+    uintptr_t x = ((const prof_sym_t *)a)->addr;
+    uintptr_t y = ((const prof_sym_t *)b)->addr;
+    return (x > y) - (x < y);
+}
+
+static void syms_load(void)
+{
+    char exe[400];
+    ssize_t len = readlink("/proc/self/exe", exe, sizeof(exe) - 1u);
+    if (len <= 0)
+        return;
+    exe[len] = '\0';
+    char cmd[480];
+    snprintf(cmd, sizeof(cmd), "nm --defined-only '%s' 2>/dev/null", exe);
+    FILE *p = popen(cmd, "r");
+    if (!p)
+        return;
+    size_t cap = 0;
+    uintptr_t anchor = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), p))
+    {
+        unsigned long long addr;
+        char type;
+        char name[400];
+        if (sscanf(line, "%llx %c %399s", &addr, &type, name) != 3)
+            continue;
+        if (type != 'T' && type != 't' && type != 'W' && type != 'w')
+            continue;
+        if (g_sym_count == cap)
+        {
+            cap = cap ? cap * 2u : 1024u;
+            prof_sym_t *grown = realloc(g_syms, cap * sizeof(*g_syms));
+            if (!grown)
+                break;
+            g_syms = grown;
+        }
+        g_syms[g_sym_count].addr = (uintptr_t)addr;
+        g_syms[g_sym_count].name = strdup(name);
+        if (strcmp(name, "sim_prof_write") == 0)
+            anchor = (uintptr_t)addr;
+        g_sym_count++;
+    }
+    pclose(p);
+    uintptr_t bias = anchor ? (uintptr_t)&sim_prof_write - anchor : 0u;
+    for (size_t i = 0; i < g_sym_count; ++i)
+        g_syms[i].addr += bias;
+    qsort(g_syms, g_sym_count, sizeof(*g_syms), sym_cmp);
+}
+
+static const char *sym_name(void *fn, char *buf, size_t cap)
+{
+    if (fn == SIM_PROF_SIM_FN)
+        return "[sim]";
+    prof_sym_t key = {(uintptr_t)fn, NULL};
+    const prof_sym_t *s = g_sym_count ? bsearch(&key, g_syms, g_sym_count, sizeof(*g_syms), sym_cmp) : NULL;
+    if (s && s->name)
+        return s->name;
+    snprintf(buf, cap, "%p", fn);
+    return buf;
+}
+
+void sim_prof_write(const char *path, const char *name)
+{
+    if (!path || !path[0])
+        return;
+    if (!g_entries)
+    {
+        fprintf(stderr, "SIM PROFILE: no instrumented firmware in this binary; run host_sim_prof\n");
+        return;
+    }
+
+    char file[512];
+    struct stat st;
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode))
+    {
+        char base[96];
+        snprintf(base, sizeof(base), "%s", (name && name[0]) ? name : "sim");
+        for (char *c = base; *c; ++c)
+            if (*c == '/' || *c == ' ')
+                *c = '_';
+        snprintf(file, sizeof(file), "%s/%s.folded", path, base);
+    }
+    else
+    {
+        snprintf(file, sizeof(file), "%s", path);
+    }
+    FILE *out = fopen(file, "w");
+    if (!out)
+    {
+        perror(file);
+        return;
+    }
+
+    const char *weight_env = getenv("BC280_SIM_PROFILE_WEIGHT");
+    int by_calls = weight_env && strcmp(weight_env, "calls") == 0;
+    syms_load();
+
+    /* Node order is creation order, so identical runs write identical files. */
+    uint32_t chain[SIM_PROF_DEPTH + 1u];
+    char hex[32];
+    for (uint32_t i = 1; i < g_node_count; ++i)
+    {
+        uint64_t v = by_calls ? g_nodes[i].calls : g_nodes[i].self_us;
+        if (!v)
+            continue;
+        uint32_t n = 0;
+        for (uint32_t j = i; j && n < SIM_PROF_DEPTH + 1u; j = g_nodes[j].parent)
+            chain[n++] = j;
+        while (n--)
+            fprintf(out, "%s%c", sym_name(g_nodes[chain[n]].fn, hex, sizeof(hex)), n ? ';' : ' ');
+        fprintf(out, "%llu\n", (unsigned long long)v);
+    }
+    fclose(out);
+    printf("SIM PROFILE: file=%s weight=%s paths=%u calls=%llu dropped=%u%s\n", file,
+           by_calls ? "calls" : "us", g_node_count - 1u, (unsigned long long)g_entries, g_dropped,
+           g_sym_count ? "" : " (no nm: addresses only)");
+}
@@ -0,0 +1,35 @@
+#ifndef SIM_PROF_H
+#define SIM_PROF_H
+
+/*
+ * Function-level profile of the firmware running in the host sim.
+ *
+ * host_sim_prof builds the firmware translation units with
+ * -finstrument-functions and the sim/pixel ones without, so the hooks here
+ * see only firmware calls. Each entry/exit updates a call tree with self
+ * time (gettimeofday) and call counts; sim_prof_write() dumps it as
+ * folded stacks ("a;b;c value") for flamegraph.pl, inferno or speedscope.
+ *
+ * Sim code the firmware calls into (the pixel sink) is not instrumented,
+ * so its time would land in the calling firmware function. Entry points
+ * that do real work open a SIM_PROF_SIM_ZONE() instead: inside it time is
+ * charged to a "[sim]" frame, and firmware it calls back (gfx fill ops)
+ * nests under that frame.
+ *
+ * In plain host_sim nothing calls the hooks, the zone is a no-op and
+ * sim_prof_write() says the binary is not instrumented.
+ */
+
+/* Writes the profile to path, or to path/<name>.folded when path is a
+ * directory. BC280_SIM_PROFILE_WEIGHT=calls weighs frames by call count
+ * (identical between runs) instead of self microseconds. NULL/empty path
+ * does nothing. */
+void sim_prof_write(const char *path, const char *name);
+
+int sim_prof_sim_enter(void);
+void sim_prof_sim_leave(int *token);
+
+#define SIM_PROF_SIM_ZONE() \
+    int sim_prof_zone_ __attribute__((cleanup(sim_prof_sim_leave), unused)) = sim_prof_sim_enter()
+
+#endif
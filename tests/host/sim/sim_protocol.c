@@ -2,6 +2,8 @@
 #include "util/byteorder.h"
 #include "comm_proto.h"
 #include "src/config/config.h"
+#include "storage/logs.h"
+#include "storage/ride_log.h"
 
 typedef struct {
     uint8_t frame[COMM_MAX_PAYLOAD + 4];
@@ -25,6 +27,21 @@ static void send_status(sim_uart_port_t port, uint8_t cmd, uint8_t code)
     send_frame(port, (uint8_t)(cmd | 0x80u), payload, 1);
 }
 
+/* Log reads answer with a full page of blank records, the reply size the
+ * firmware sends from a populated log: count, then up to max_records. */
+static void send_log_read(sim_uart_port_t port, uint8_t cmd, const uint8_t *p, uint8_t len,
+                          uint8_t record_size, uint8_t max_records)
+{
+    if (len < 3)
+        return;
+    uint8_t want = p[2];
+    if (want == 0 || want > max_records)
+        want = max_records;
+    uint8_t out[COMM_MAX_PAYLOAD] = {0};
+    out[0] = want;
+    send_frame(port, (uint8_t)(cmd | 0x80u), out, (uint8_t)(1u + want * record_size));
+}
+
 static void send_stream_frame(sim_proto_state_t *s)
 {
     uint8_t payload[COMM_STATE_FRAME_V1_LEN];
@@ -157,6 +174,15 @@ static void handle_frame(sim_proto_state_t *s, sim_uart_port_t port, uint8_t cmd
             s->stream_period_ms = load_be16(&p[0]);
             send_status(port, cmd, 0);
             break;
+        case 0x3D: /* ride log read */
+            send_log_read(port, cmd, p, len, RIDE_LOG_RECORD_SIZE, 2u);
+            break;
+        case 0x41: /* event log read */
+            send_log_read(port, cmd, p, len, EVENT_LOG_RECORD_SIZE, 8u);
+            break;
+        case 0x45: /* stream log read */
+            send_log_read(port, cmd, p, len, STREAM_LOG_RECORD_SIZE, 8u);
+            break;
         default:
             send_status(port, cmd, 0xFF);
             break;
@@ -0,0 +1,165 @@
+#define _DEFAULT_SOURCE
+
+#include "sim_scenario.h"
+#include "sim_motor_link.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int parse_time_ms(const char *tok, uint32_t *out)
+{
+    char *end = NULL;
+    double v = strtod(tok, &end);
+    if (!end || end == tok || v < 0.0)
+        return 0;
+    double scale = 1.0;
+    if (strcmp(end, "s") == 0)
+        scale = 1000.0;
+    else if (strcmp(end, "m") == 0)
+        scale = 60000.0;
+    else if (strcmp(end, "h") == 0)
+        scale = 3600000.0;
+    else if (*end && strcmp(end, "ms") != 0)
+        return 0;
+    *out = (uint32_t)(v * scale + 0.5);
+    return 1;
+}
+
+static int parse_kind(const char *tok, uint8_t *out)
+{
+    static const char *const k_names[] = {"power", "grade", "wind", "fault", "button", "ble", "link"};
+    for (uint8_t i = 0; i < sizeof(k_names) / sizeof(k_names[0]); ++i)
+    {
+        if (strcmp(tok, k_names[i]) == 0)
+        {
+            *out = i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int parse_entry(sim_scn_entry_t *e, char *line)
+{
+    char *tok = strtok(line, " \t");
+    if (!tok || !parse_time_ms(tok, &e->t_ms))
+        return 0;
+    tok = strtok(NULL, " \t");
+    if (!tok || !parse_kind(tok, &e->kind))
+        return 0;
+    tok = strtok(NULL, " \t");
+    if (!tok)
+        return 0;
+    char *end = NULL;
+    if (e->kind == SIM_SCN_BLE)
+    {
+        e->cmd = (uint8_t)strtoul(tok, &end, 16);
+        if (*end)
+            return 0;
+        while ((tok = strtok(NULL, " \t")) != NULL)
+        {
+            if (e->len >= SIM_SCN_MAX_BLE)
+                return 0;
+            e->data[e->len++] = (uint8_t)strtoul(tok, &end, 16);
+            if (*end)
+                return 0;
+        }
+        return 1;
+    }
+    if (e->kind == SIM_SCN_LINK)
+    {
+        int id = sim_motor_link_param_id(tok);
+        if (id < 0 || (tok = strtok(NULL, " \t")) == NULL)
+            return 0;
+        e->cmd = (uint8_t)id;
+    }
+    e->value = strtod(tok, &end);
+    if (e->kind == SIM_SCN_BUTTON || e->kind == SIM_SCN_FAULT)
+        e->value = (double)strtoul(tok, &end, 0);
+    return *end == '\0' && strtok(NULL, " \t") == NULL;
+}
+
+int sim_scenario_load(sim_scenario_t *s, const char *path)
+{
+    memset(s, 0, sizeof(*s));
+    FILE *f = fopen(path, "r");
+    if (!f)
+    {
+        fprintf(stderr, "scenario: cannot open %s\n", path);
+        return 0;
+    }
+    const char *base = strrchr(path, '/');
+    snprintf(s->name, sizeof(s->name), "%s", base ? base + 1 : path);
+
+    char line[256];
+    unsigned lineno = 0;
+    int ok = 1;
+    while (ok && fgets(line, sizeof(line), f))
+    {
+        lineno++;
+        char *hash = strchr(line, '#');
+        if (hash)
+            *hash = '\0';
+        line[strcspn(line, "\r\n")] = '\0';
+        char *p = line + strspn(line, " \t");
+        if (!*p)
+            continue;
+        char *eq = strchr(p, '=');
+        if (strncmp(p, "name ", 5) == 0)
+        {
+            snprintf(s->name, sizeof(s->name), "%s", p + 5);
+        }
+        else if (eq && !strchr(p, ' '))
+        {
+            *eq = '\0';
+            setenv(p, eq + 1, 1);
+        }
+        else if (s->count < SIM_SCN_MAX_ENTRIES)
+        {
+            char copy[256];
+            snprintf(copy, sizeof(copy), "%s", p);
+            sim_scn_entry_t *e = &s->entries[s->count];
+            memset(e, 0, sizeof(*e));
+            if (parse_entry(e, copy))
+                s->count++;
+            else
+                ok = 0;
+        }
+        else
+        {
+            ok = 0;
+        }
+        if (!ok)
+            fprintf(stderr, "scenario: %s:%u: bad line: %s\n", path, lineno, p);
+    }
+    fclose(f);
+
+    /* Insertion sort keeps file order for equal times. */
+    for (size_t i = 1; i < s->count; ++i)
+    {
+        sim_scn_entry_t e = s->entries[i];
+        size_t j = i;
+        while (j > 0 && s->entries[j - 1].t_ms > e.t_ms)
+        {
+            s->entries[j] = s->entries[j - 1];
+            j--;
+        }
+        s->entries[j] = e;
+    }
+    return ok;
+}
+
+uint32_t sim_scenario_next_ms(const sim_scenario_t *s)
+{
+    if (!s || s->next >= s->count)
+        return SIM_SCN_NONE;
+    return s->entries[s->next].t_ms;
+}
+
+const sim_scn_entry_t *sim_scenario_pop_due(sim_scenario_t *s, uint32_t t_ms)
+{
+    if (!s || s->next >= s->count || s->entries[s->next].t_ms > t_ms)
+        return NULL;
+    return &s->entries[s->next++];
+}
@@ -0,0 +1,65 @@
+#ifndef SIM_SCENARIO_H
+#define SIM_SCENARIO_H
+
+/*
+ * Host sim scenario files (*.scn): one directive per line, '#' comments.
+ *
+ *   name <label>                    label for batch reports
+ *   KEY=VALUE                       env knob, applied before the run
+ *   <time> power <watts>            rider power from <time> on
+ *   <time> grade <ratio>            road grade (0.05 = 5 %)
+ *   <time> wind <m/s>               headwind
+ *   <time> fault <code>             controller error code (0 clears)
+ *   <time> button <mask>            OEM button mask for one UI tick
+ *   <time> ble <cmd> [byte ...]     BLE app frame pushed into UART1 RX
+ *   <time> link <param> <value>     motor link impairment (sim_motor_link.h)
+ *
+ * <time> is milliseconds, or takes an s / m / h suffix. Timeline lines may
+ * appear in any order; the loader sorts them (stable for equal times).
+ * Loading a scenario selects the full simulation.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_SCN_MAX_ENTRIES 256u
+#define SIM_SCN_MAX_BLE 32u
+#define SIM_SCN_NONE 0xFFFFFFFFu
+
+typedef enum {
+    SIM_SCN_POWER = 0,
+    SIM_SCN_GRADE,
+    SIM_SCN_WIND,
+    SIM_SCN_FAULT,
+    SIM_SCN_BUTTON,
+    SIM_SCN_BLE,
+    SIM_SCN_LINK,
+} sim_scn_kind_t;
+
+typedef struct {
+    uint32_t t_ms;
+    uint8_t kind;
+    uint8_t len;                    /* BLE payload length */
+    uint8_t cmd;                    /* BLE command; link: sim_motor_link_param_t */
+    double value;
+    uint8_t data[SIM_SCN_MAX_BLE];
+} sim_scn_entry_t;
+
+typedef struct {
+    char name[64];
+    sim_scn_entry_t entries[SIM_SCN_MAX_ENTRIES];
+    size_t count;
+    size_t next;
+} sim_scenario_t;
+
+/* Parses `path`, applies its KEY=VALUE lines with setenv(). Returns 0 and
+ * prints the offending line on a parse error. */
+int sim_scenario_load(sim_scenario_t *s, const char *path);
+
+/* Time of the next unapplied entry, SIM_SCN_NONE when the timeline is done. */
+uint32_t sim_scenario_next_ms(const sim_scenario_t *s);
+
+/* Next unapplied entry due at or before t_ms, NULL when none is due. */
+const sim_scn_entry_t *sim_scenario_pop_due(sim_scenario_t *s, uint32_t t_ms);
+
+#endif
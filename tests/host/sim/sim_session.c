@@ -0,0 +1,134 @@
+#include "sim_session.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+int sim_session_parse(sim_session_t *s, const uint8_t *image, size_t len)
+{
+    memset(s, 0, sizeof(*s));
+    if (len < BUS_REPLAY_STORE_HEADER_BYTES)
+    {
+        fprintf(stderr, "session: image too short\n");
+        return 0;
+    }
+    uint32_t magic = load_be32(&image[0]);
+    uint32_t hdr_bytes;
+    if (magic == BUS_SESSION_MAGIC && len >= BUS_SESSION_HEADER_BYTES)
+    {
+        hdr_bytes = BUS_SESSION_HEADER_BYTES;
+        s->flags = load_be16(&image[6]);
+        s->records = load_be32(&image[16]);
+        s->dropped = load_be16(&image[28]);
+    }
+    else if (magic == BUS_TRIGGER_MAGIC && len >= BUS_TRIGGER_HEADER_BYTES)
+    {
+        hdr_bytes = BUS_TRIGGER_HEADER_BYTES;
+        s->records = load_be16(&image[6]);
+        s->dropped = load_be16(&image[18]);
+    }
+    else if (magic == BUS_REPLAY_STORE_MAGIC)
+    {
+        hdr_bytes = BUS_REPLAY_STORE_HEADER_BYTES;
+        s->records = load_be16(&image[6]);
+    }
+    else
+    {
+        fprintf(stderr, "session: unknown magic %08x\n", (unsigned)magic);
+        return 0;
+    }
+    uint32_t bytes = load_be32(&image[8]);
+    if (bytes > len - hdr_bytes)
+    {
+        fprintf(stderr, "session: %u data bytes, image holds %u\n", (unsigned)bytes,
+                (unsigned)(len - hdr_bytes));
+        return 0;
+    }
+    const uint8_t *data = &image[hdr_bytes];
+    if (crc32_compute(data, bytes) != load_be32(&image[12]))
+    {
+        fprintf(stderr, "session: crc mismatch\n");
+        return 0;
+    }
+
+    uint32_t pos = 0;
+    uint32_t n = 0;
+    uint32_t end_ms = 0;
+    while (pos < bytes)
+    {
+        if (bytes - pos < BUS_REPLAY_RECORD_HEADER_BYTES ||
+            data[pos + 1] > BUS_CAPTURE_MAX_DATA ||
+            bytes - pos - BUS_REPLAY_RECORD_HEADER_BYTES < data[pos + 1])
+        {
+            fprintf(stderr, "session: bad record at offset %u\n", (unsigned)pos);
+            return 0;
+        }
+        end_ms += load_be16(&data[pos + 2]);
+        pos += BUS_REPLAY_RECORD_HEADER_BYTES + data[pos + 1];
+        n++;
+    }
+    if (n != s->records)
+    {
+        fprintf(stderr, "session: header says %u records, found %u\n", (unsigned)s->records,
+                (unsigned)n);
+        return 0;
+    }
+
+    s->data = malloc(bytes ? bytes : 1u);
+    if (!s->data)
+        return 0;
+    memcpy(s->data, data, bytes);
+    s->bytes = bytes;
+    s->magic = magic;
+    s->end_ms = end_ms;
+    s->due_ms = bytes ? load_be16(&s->data[2]) : 0u;
+    return 1;
+}
+
+int sim_session_load(sim_session_t *s, const char *path)
+{
+    memset(s, 0, sizeof(*s));
+    FILE *f = fopen(path, "rb");
+    if (!f)
+    {
+        fprintf(stderr, "session: cannot open %s\n", path);
+        return 0;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *image = (len > 0) ? malloc((size_t)len) : NULL;
+    int ok = image && fread(image, 1, (size_t)len, f) == (size_t)len &&
+             sim_session_parse(s, image, (size_t)len);
+    if (!ok && !image)
+        fprintf(stderr, "session: cannot read %s\n", path);
+    free(image);
+    fclose(f);
+    return ok;
+}
+
+void sim_session_free(sim_session_t *s)
+{
+    free(s->data);
+    s->data = NULL;
+    s->bytes = 0;
+    s->pos = 0;
+}
+
+int sim_session_pop_due(sim_session_t *s, uint32_t t_ms, bus_capture_record_t *out)
+{
+    if (!s->data || s->pos >= s->bytes || s->due_ms > t_ms)
+        return 0;
+    const uint8_t *r = &s->data[s->pos];
+    out->bus_id = r[0];
+    out->len = r[1];
+    out->dt_ms = load_be16(&r[2]);
+    memcpy(out->data, &r[BUS_REPLAY_RECORD_HEADER_BYTES], r[1]);
+    s->pos += BUS_REPLAY_RECORD_HEADER_BYTES + r[1];
+    if (s->pos < s->bytes)
+        s->due_ms += load_be16(&s->data[s->pos + 2]);
+    return 1;
+}
@@ -0,0 +1,44 @@
+#ifndef SIM_SESSION_H
+#define SIM_SESSION_H
+
+/*
+ * Recorded bike sessions for the full sim (BC280_SIM_SESSION=path).
+ *
+ * The file is the BUS_SESSION flash region as bulk_read returns it (header
+ * "BSES", see src/bus/bus.h). Bus replay store images ("BRPL", e.g. a
+ * BC280_SIM_WIRE_CAPTURE file) and trigger recordings ("BTRG") share the
+ * record framing and load too; they carry RX bytes only.
+ *
+ * Records replay on the sim clock from t = 0: a record is due once the sum
+ * of the dt_ms fields up to it has passed, so dt_ms = 1 replays every byte
+ * burst on the millisecond it arrived.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "src/bus/bus.h"
+
+typedef struct {
+    uint8_t *data;      /* records, after the header */
+    uint32_t bytes;
+    uint32_t pos;       /* next record */
+    uint32_t due_ms;    /* sim time it is due */
+    uint32_t magic;
+    uint32_t records;
+    uint32_t end_ms;    /* sum of every dt_ms: when the last record is due */
+    uint16_t flags;
+    uint16_t dropped;
+} sim_session_t;
+
+/* Validates magic, length, CRC32 and record framing of a region image.
+ * Returns 0 with a message on stderr when the image is rejected. */
+int sim_session_parse(sim_session_t *s, const uint8_t *image, size_t len);
+int sim_session_load(sim_session_t *s, const char *path);
+/* Releases the records; the header fields stay for the run report. */
+void sim_session_free(sim_session_t *s);
+
+/* Copies the next record due by t_ms and steps past it; 0 when none is due. */
+int sim_session_pop_due(sim_session_t *s, uint32_t t_ms, bus_capture_record_t *out);
+
+#endif
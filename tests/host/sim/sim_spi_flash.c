@@ -0,0 +1,376 @@
+#include "sim_spi_flash.h"
+
+#include <string.h>
+
+#include "drivers/spi_flash.h"
+#include "storage/layout.h"
+
+#define SIM_FLASH_CMD_BYTES 4u  /* opcode + 24-bit address */
+
+void sim_spi_flash_timing_typ(sim_spi_flash_timing_t *t)
+{
+    t->sector_erase_us = 45000u;
+    t->page_program_us = 400u;
+    t->byte_first_us = 30u;
+    t->byte_next_x10_us = 25u;
+    t->suspend_us = 20u;
+    t->cmd_ns_per_byte = 444u;
+    t->read_ns_per_byte = 222u;
+}
+
+void sim_spi_flash_timing_max(sim_spi_flash_timing_t *t)
+{
+    sim_spi_flash_timing_typ(t);
+    t->sector_erase_us = 400000u;
+    t->page_program_us = 3000u;
+    t->byte_first_us = 50u;
+    t->byte_next_x10_us = 120u;
+}
+
+void sim_spi_flash_reset(sim_spi_flash_t *f)
+{
+    if (!f)
+        return;
+    memset(f->data, 0xFF, sizeof(f->data));
+    memset(f->sector_erases, 0, sizeof(f->sector_erases));
+    memset(&f->stats, 0, sizeof(f->stats));
+    sim_spi_flash_timing_typ(&f->timing);
+    f->now_us = 0;
+    f->busy_until_us = 0;
+    f->busy_op = SPI_FLASH_OP_NONE;
+    f->data[SPI_FLASH_BOOTMODE_FLAG_ADDR] = 0xAAu;
+}
+
+void sim_spi_flash_advance_us(sim_spi_flash_t *f, uint64_t us)
+{
+    if (!f)
+        return;
+    f->now_us += us;
+    if (f->busy_op != SPI_FLASH_OP_NONE && f->now_us >= f->busy_until_us)
+        f->busy_op = SPI_FLASH_OP_NONE;
+}
+
+uint8_t sim_spi_flash_busy(const sim_spi_flash_t *f)
+{
+    return (f && f->busy_op != SPI_FLASH_OP_NONE && f->now_us < f->busy_until_us) ? 1u : 0u;
+}
+
+uint64_t sim_spi_flash_wait(sim_spi_flash_t *f)
+{
+    if (!sim_spi_flash_busy(f))
+    {
+        if (f)
+            f->busy_op = SPI_FLASH_OP_NONE;
+        return 0;
+    }
+    uint64_t wait = f->busy_until_us - f->now_us;
+    f->stats.stall_us += wait;
+    sim_spi_flash_advance_us(f, wait);
+    return wait;
+}
+
+static void bus_time(sim_spi_flash_t *f, size_t bytes, uint32_t ns_per_byte)
+{
+    uint64_t us = ((uint64_t)bytes * ns_per_byte + 999u) / 1000u;
+    f->stats.bus_us += us;
+    f->now_us += us;
+}
+
+/* A new WIP operation; one issued while busy queues behind the running one
+ * (the real part would ignore it, which the violation count flags). */
+static void start_op(sim_spi_flash_t *f, uint8_t op, uint32_t us)
+{
+    if (sim_spi_flash_busy(f))
+    {
+        f->stats.busy_violations++;
+        sim_spi_flash_wait(f);
+    }
+    f->busy_op = op;
+    f->busy_until_us = f->now_us + us;
+    f->stats.busy_us += us;
+}
+
+void sim_spi_flash_read(sim_spi_flash_t *f, uint32_t addr, uint8_t *out, size_t len)
+{
+    if (!f || !out || len == 0)
+        return;
+    if (f->busy_op == SPI_FLASH_OP_ERASE && sim_spi_flash_busy(f))
+    {
+        /* Erase suspend: the read goes out, the erase resumes afterwards. */
+        f->stats.suspends++;
+        f->stats.stall_us += f->timing.suspend_us;
+        uint64_t before = f->now_us;
+        f->now_us += f->timing.suspend_us;
+        bus_time(f, SIM_FLASH_CMD_BYTES + 1u + len, f->timing.read_ns_per_byte);
+        f->busy_until_us += f->now_us - before;
+    }
+    else
+    {
+        bus_time(f, SIM_FLASH_CMD_BYTES + 1u + len, f->timing.read_ns_per_byte);
+    }
+    for (size_t i = 0; i < len; ++i)
+        out[i] = f->data[(addr + i) & (SIM_SPI_FLASH_SIZE - 1u)];
+    f->stats.read_bytes += (uint32_t)len;
+}
+
+void sim_spi_flash_erase_4k(sim_spi_flash_t *f, uint32_t addr)
+{
+    if (!f)
+        return;
+    uint32_t sector = (addr & (SIM_SPI_FLASH_SIZE - 1u)) / SPI_FLASH_SECTOR_SIZE;
+    bus_time(f, 1u + SIM_FLASH_CMD_BYTES, f->timing.cmd_ns_per_byte); /* WREN + SE */
+    start_op(f, SPI_FLASH_OP_ERASE, f->timing.sector_erase_us);
+    memset(&f->data[sector * SPI_FLASH_SECTOR_SIZE], 0xFF, SPI_FLASH_SECTOR_SIZE);
+    if (f->sector_erases[sector]++ == 0u)
+        f->stats.sectors_erased++;
+    if (f->sector_erases[sector] > f->stats.max_sector_erases)
+        f->stats.max_sector_erases = f->sector_erases[sector];
+    f->stats.erases++;
+}
+
+size_t sim_spi_flash_page_program(sim_spi_flash_t *f, uint32_t addr, const uint8_t *data, size_t len)
+{
+    if (!f || !data || len == 0)
+        return 0;
+    addr &= SIM_SPI_FLASH_SIZE - 1u;
+    size_t room = SPI_FLASH_PAGE_SIZE - (addr & (SPI_FLASH_PAGE_SIZE - 1u));
+    if (len > room)
+    {
+        /* The part wraps to the page start; the driver must split instead. */
+        f->stats.page_violations++;
+        len = room;
+    }
+    uint32_t us = f->timing.byte_first_us + (uint32_t)((len - 1u) * f->timing.byte_next_x10_us / 10u);
+    if (us > f->timing.page_program_us)
+        us = f->timing.page_program_us;
+    bus_time(f, 1u + SIM_FLASH_CMD_BYTES + len, f->timing.cmd_ns_per_byte); /* WREN + PP */
+    start_op(f, SPI_FLASH_OP_PROGRAM, us);
+    for (size_t i = 0; i < len; ++i)
+    {
+        uint8_t *cell = &f->data[addr + i];
+        if ((*cell & data[i]) != data[i])
+            f->stats.bit_violations++;
+        *cell &= data[i];
+    }
+    f->stats.page_programs++;
+    f->stats.program_bytes += (uint32_t)len;
+    return len;
+}
+
+/* ---- drivers/spi_flash.h on the bound model ---- */
+
+static sim_spi_flash_t *g_bound;
+static uint8_t g_sector_buf[SPI_FLASH_SECTOR_SIZE];
+
+void sim_spi_flash_bind(sim_spi_flash_t *f)
+{
+    g_bound = f;
+}
+
+sim_spi_flash_t *sim_spi_flash_bound(void)
+{
+    return g_bound;
+}
+
+/* Blocking page program, as drivers/spi_flash.c spi_flash_page_program(). */
+static void program_wait(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    sim_spi_flash_wait(g_bound);
+    sim_spi_flash_page_program(g_bound, addr, data, len);
+    sim_spi_flash_wait(g_bound);
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    if (!g_bound)
+        return;
+    if (g_bound->busy_op == SPI_FLASH_OP_PROGRAM)
+        sim_spi_flash_wait(g_bound);
+    sim_spi_flash_read(g_bound, addr, out, len);
+}
+
+void spi_flash_lcd_blit_start(uint32_t addr, uint32_t run_px, uint16_t runs, uint32_t stride,
+                              spi_flash_blit_done_fn done, void *ctx)
+{
+    (void)addr;
+    (void)stride;
+    if (g_bound && run_px != 0u && runs != 0u)
+    {
+        /* One READ per chunk on target; modeled as one per run. */
+        uint32_t bytes = run_px * runs * 2u;
+        sim_spi_flash_wait(g_bound);
+        bus_time(g_bound, (SIM_FLASH_CMD_BYTES + 1u) * runs + (size_t)bytes, g_bound->timing.read_ns_per_byte);
+        g_bound->stats.read_bytes += bytes;
+    }
+    if (done)
+        done(ctx);
+}
+
+uint8_t spi_flash_lcd_blit_busy(void)
+{
+    return 0u;
+}
+
+void spi_flash_lcd_blit_wait(void)
+{
+}
+
+void spi_flash_erase_4k(uint32_t addr)
+{
+    if (!g_bound)
+        return;
+    sim_spi_flash_wait(g_bound);
+    sim_spi_flash_erase_4k(g_bound, addr);
+    sim_spi_flash_wait(g_bound);
+}
+
+void spi_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if (!g_bound || !data)
+        return;
+    while (len)
+    {
+        uint32_t chunk = SPI_FLASH_PAGE_SIZE - (addr & (SPI_FLASH_PAGE_SIZE - 1u));
+        if (chunk > len)
+            chunk = len;
+        program_wait(addr, data, chunk);
+        addr += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+/* Same decisions as drivers/spi_flash.c: program the differing runs when
+ * NOR allows it, otherwise read-modify-erase-write the sector. */
+void spi_flash_update_bytes(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if (!g_bound || !data)
+        return;
+    while (len)
+    {
+        uint32_t sector = addr & ~(SPI_FLASH_SECTOR_SIZE - 1u);
+        uint32_t off = addr - sector;
+        uint32_t chunk = SPI_FLASH_SECTOR_SIZE - off;
+        if (chunk > len)
+            chunk = len;
+
+        uint8_t *buf = g_sector_buf;
+        spi_flash_read(addr, &buf[off], chunk);
+        uint8_t same = 1u;
+        uint8_t programmable = 1u;
+        for (uint32_t i = 0; i < chunk; ++i)
+        {
+            if (buf[off + i] != data[i])
+                same = 0u;
+            if ((buf[off + i] & data[i]) != data[i])
+                programmable = 0u;
+        }
+
+        if (!same && programmable)
+        {
+            uint32_t i = 0;
+            while (i < chunk)
+            {
+                if (data[i] == buf[off + i])
+                {
+                    i++;
+                    continue;
+                }
+                uint32_t start = i;
+                uint32_t page_end = ((off + start) | (SPI_FLASH_PAGE_SIZE - 1u)) + 1u - off;
+                uint32_t last = start;
+                uint32_t end = start;
+                while (end < chunk && end < page_end)
+                {
+                    if (data[end] != buf[off + end])
+                        last = end;
+                    end++;
+                }
+                program_wait(sector + off + start, &data[start], last - start + 1u);
+                i = end;
+            }
+        }
+        else if (!same)
+        {
+            if (off)
+                spi_flash_read(sector, buf, off);
+            if (off + chunk < SPI_FLASH_SECTOR_SIZE)
+                spi_flash_read(addr + chunk, &buf[off + chunk], SPI_FLASH_SECTOR_SIZE - off - chunk);
+            memcpy(&buf[off], data, chunk);
+            spi_flash_erase_4k(sector);
+            for (uint32_t page = 0; page < SPI_FLASH_SECTOR_SIZE; page += SPI_FLASH_PAGE_SIZE)
+            {
+                uint8_t blank = 1u;
+                for (uint32_t i = 0; i < SPI_FLASH_PAGE_SIZE && blank; ++i)
+                    blank = (buf[page + i] == 0xFFu);
+                if (!blank)
+                    program_wait(sector + page, &buf[page], SPI_FLASH_PAGE_SIZE);
+            }
+        }
+
+        addr += chunk;
+        data += chunk;
+        len -= chunk;
+    }
+}
+
+/* A status read costs RDSR shift time, so polling loops (flash_jobs_flush)
+ * move model time forward; polls that find WIP set are CPU stall. */
+uint8_t spi_flash_busy(void)
+{
+    if (!sim_spi_flash_busy(g_bound))
+        return 0u;
+    uint64_t before = g_bound->now_us;
+    bus_time(g_bound, 2u, g_bound->timing.cmd_ns_per_byte);
+    g_bound->stats.stall_us += g_bound->now_us - before;
+    sim_spi_flash_advance_us(g_bound, 0u);
+    return 1u;
+}
+
+void spi_flash_erase_4k_start(uint32_t addr)
+{
+    if (g_bound)
+        sim_spi_flash_erase_4k(g_bound, addr);
+}
+
+void spi_flash_page_program_start(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if (g_bound)
+        sim_spi_flash_page_program(g_bound, addr, data, len);
+}
+
+uint8_t spi_flash_read_async_start(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    if (!g_bound || !out || len == 0u)
+        return 0u;
+    spi_flash_read(addr, out, len);
+    return 1u;
+}
+
+uint8_t spi_flash_read_async_poll(void)
+{
+    return 1u;
+}
+
+void spi_flash_cache_get_stats(spi_flash_cache_stats_t *out)
+{
+    if (out)
+        memset(out, 0, sizeof(*out));
+}
+
+void spi_flash_cache_invalidate(void)
+{
+}
+
+void spi_flash_set_bootloader_mode_flag(void)
+{
+    static const uint8_t k_flag = 0xAAu;
+    uint8_t cur = 0xFFu;
+    spi_flash_read(SPI_FLASH_BOOTMODE_FLAG_ADDR, &cur, 1u);
+    if (cur == 0xAAu)
+        return;
+    if (cur == 0xFFu)
+        spi_flash_write(SPI_FLASH_BOOTMODE_FLAG_ADDR, &k_flag, 1u);
+    else
+        spi_flash_update_bytes(SPI_FLASH_BOOTMODE_FLAG_ADDR, &k_flag, 1u);
+}
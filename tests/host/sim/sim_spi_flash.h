@@ -0,0 +1,82 @@
+#ifndef SIM_SPI_FLASH_H
+#define SIM_SPI_FLASH_H
+
+/*
+ * Timed model of the W25Q32-class SPI NOR on the board.
+ *
+ * Data behaves like NOR: erase sets a 4 KiB sector to 0xFF, programming can
+ * only clear bits and never crosses a 256-byte page. Erase and program hold
+ * the WIP bit for their datasheet time against a microsecond clock the sim
+ * advances; bus transfers cost SPI shift time. Every sector counts its
+ * erases so a run can report wear.
+ *
+ * sim_spi_flash.c also implements the drivers/spi_flash.h API on top of the
+ * bound instance (sim_spi_flash_bind()), so host builds that link the real
+ * storage modules see the same busy/erase behaviour as on target.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_SPI_FLASH_SIZE    0x400000u
+#define SIM_SPI_FLASH_SECTORS (SIM_SPI_FLASH_SIZE / 0x1000u)
+
+/* W25Q32JV datasheet, 3.3 V. Typical figures by default, max on request. */
+typedef struct {
+    uint32_t sector_erase_us;   /* tSE: 45 ms typ, 400 ms max */
+    uint32_t page_program_us;   /* tPP: 0.4 ms typ, 3 ms max (full page) */
+    uint32_t byte_first_us;     /* tBP1: 30 us typ, 50 us max */
+    uint32_t byte_next_x10_us;  /* tBPn: 2.5 us typ, 12 us max (x10) */
+    uint32_t suspend_us;        /* tSUS: 20 us max (read during erase) */
+    uint32_t cmd_ns_per_byte;   /* command/program shift at fPCLK/4 (18 MHz) */
+    uint32_t read_ns_per_byte;  /* fast read at 36 MHz */
+} sim_spi_flash_timing_t;
+
+typedef struct {
+    uint64_t busy_us;           /* WIP high: erases + programs */
+    uint64_t bus_us;            /* SPI shift time of every command */
+    uint64_t stall_us;          /* time blocking calls spent waiting on WIP */
+    uint32_t erases;
+    uint32_t page_programs;
+    uint32_t program_bytes;
+    uint32_t read_bytes;
+    uint32_t suspends;          /* reads that suspended a running erase */
+    uint32_t max_sector_erases;
+    uint32_t sectors_erased;    /* distinct sectors erased at least once */
+    uint32_t bit_violations;    /* programs asking for a 0 -> 1 transition */
+    uint32_t page_violations;   /* programs that would wrap inside a page */
+    uint32_t busy_violations;   /* erase/program issued while WIP was set */
+} sim_spi_flash_stats_t;
+
+typedef struct {
+    uint8_t data[SIM_SPI_FLASH_SIZE];
+    uint32_t sector_erases[SIM_SPI_FLASH_SECTORS];
+    sim_spi_flash_timing_t timing;
+    sim_spi_flash_stats_t stats;
+    uint64_t now_us;
+    uint64_t busy_until_us;
+    uint8_t busy_op;            /* SPI_FLASH_OP_* of the running operation */
+} sim_spi_flash_t;
+
+void sim_spi_flash_timing_typ(sim_spi_flash_timing_t *t);
+void sim_spi_flash_timing_max(sim_spi_flash_timing_t *t);
+
+/* Erased array (plus the OEM boot-mode flag byte), typical timing. */
+void sim_spi_flash_reset(sim_spi_flash_t *f);
+void sim_spi_flash_advance_us(sim_spi_flash_t *f, uint64_t us);
+uint8_t sim_spi_flash_busy(const sim_spi_flash_t *f);
+/* Blocks (in model time) until WIP clears; returns the wait. */
+uint64_t sim_spi_flash_wait(sim_spi_flash_t *f);
+
+/* Raw commands. They do not wait: issuing erase/program while busy is
+ * counted as a violation and then serialised behind the running op. */
+void sim_spi_flash_read(sim_spi_flash_t *f, uint32_t addr, uint8_t *out, size_t len);
+void sim_spi_flash_erase_4k(sim_spi_flash_t *f, uint32_t addr);
+/* Programs at most up to the end of addr's page; returns bytes taken. */
+size_t sim_spi_flash_page_program(sim_spi_flash_t *f, uint32_t addr, const uint8_t *data, size_t len);
+
+/* Routes the drivers/spi_flash.h functions to f (NULL unbinds). */
+void sim_spi_flash_bind(sim_spi_flash_t *f);
+sim_spi_flash_t *sim_spi_flash_bound(void);
+
+#endif
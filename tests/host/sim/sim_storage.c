@@ -0,0 +1,133 @@
+#include "sim_storage.h"
+
+#include <stdio.h>
+
+#include "app_data.h"
+#include "platform/time.h"
+#include "platform/watchdog.h"
+#include "storage/event_types.h"
+#include "storage/flash_jobs.h"
+#include "storage/logs.h"
+#include "storage/ui_assets.h"
+#include "util/crc32.h"
+
+/* Firmware globals the storage modules read; the sim owns them here. */
+volatile uint32_t g_ms;
+debug_inputs_t g_inputs;
+debug_outputs_t g_outputs;
+
+/* No watchdog on the host; flash_jobs_flush() only needs the calls. */
+void watchdog_budget_begin(watchdog_budget_t *b, uint32_t budget_us)
+{
+    (void)b;
+    (void)budget_us;
+}
+
+uint8_t watchdog_budget_poll(watchdog_budget_t *b)
+{
+    (void)b;
+    return 1u;
+}
+
+#define SIM_RESET_POR 0x01u
+
+static uint32_t g_next_sample_ms;
+
+void sim_storage_init(sim_spi_flash_t *flash, uint16_t stream_period_ms)
+{
+    sim_spi_flash_bind(flash);
+    g_ms = 0;
+    g_next_sample_ms = TLM_SAMPLER_PERIOD_MS;
+    flash_jobs_init();
+    event_log_load();
+    stream_log_load();
+    event_log_append(EVT_RESET_REASON, SIM_RESET_POR);
+    g_stream_log_enabled = stream_period_ms ? 1u : 0u;
+    g_stream_log_period_ms = stream_log_period_sanitize(stream_period_ms);
+    g_stream_log_last_ms = 0;
+    g_stream_log_last_sample_ms = 0;
+}
+
+static void sample(uint32_t ms, const sim_shengyi_t *bike)
+{
+    g_inputs.speed_dmph = sim_shengyi_speed_dmph(bike);
+    g_inputs.cadence_rpm = sim_shengyi_cadence_rpm(bike);
+    g_inputs.power_w = sim_shengyi_power_w(bike);
+    g_inputs.battery_dV = sim_shengyi_batt_dV(bike);
+    g_inputs.battery_dA = sim_shengyi_batt_dA(bike);
+    g_inputs.ctrl_temp_dC = (int16_t)(bike->temp_c * 10.0);
+    g_inputs.last_ms = ms;
+    g_outputs.assist_mode = bike->assist_level;
+
+    tlm_tick_t s = {0};
+    s.ms = ms;
+    s.speed_dmph = g_inputs.speed_dmph;
+    s.cadence_rpm = g_inputs.cadence_rpm;
+    s.power_w = g_inputs.power_w;
+    s.battery_dV = g_inputs.battery_dV;
+    s.battery_dA = g_inputs.battery_dA;
+    s.ctrl_temp_dC = g_inputs.ctrl_temp_dC;
+    s.assist_mode = g_outputs.assist_mode;
+    s.soc_pct = bike->soc_pct;
+    stream_log_tick(&s);
+}
+
+void sim_storage_tick(uint32_t now_ms, const sim_shengyi_t *bike)
+{
+    if (!sim_spi_flash_bound() || !bike)
+        return;
+    g_ms = now_ms;
+    while ((int32_t)(now_ms - g_next_sample_ms) >= 0)
+    {
+        sample(g_next_sample_ms, bike);
+        g_next_sample_ms += TLM_SAMPLER_PERIOD_MS;
+    }
+    flash_jobs_tick();
+}
+
+void sim_storage_finish(void)
+{
+    if (!sim_spi_flash_bound())
+        return;
+    stream_log_flush();
+    flash_jobs_flush();
+    sim_spi_flash_bind(NULL);
+}
+
+int sim_storage_load_assets(const char *path)
+{
+    if (!sim_spi_flash_bound() || !path)
+        return 0;
+    FILE *f = fopen(path, "rb");
+    if (!f)
+        return 0;
+    static uint8_t body[0x10000];
+    size_t n = fread(body, 1, sizeof(body), f);
+    fclose(f);
+    if (n == 0u)
+        return 0;
+    ui_assets_store_begin();
+    for (uint32_t off = 0; off < n; off += 184u)
+    {
+        uint32_t len = (n - off < 184u) ? (uint32_t)(n - off) : 184u;
+        if (!ui_assets_store_write(off, &body[off], len))
+            return 0;
+    }
+    return ui_assets_store_finish((uint32_t)n, crc32_compute(body, n));
+}
+
+int sim_storage_sprite_lookup(uint32_t id, ui_sprite_t *out)
+{
+    ui_asset_t a;
+    if (!ui_asset_find(id, &a))
+        return 0;
+    ui_assets_info_t info;
+    ui_assets_get_info(&info);
+    out->addr = a.addr;
+    out->tag = info.crc32;
+    out->w = a.w;
+    out->h = a.h;
+    out->len = a.len;
+    out->fmt = a.fmt;
+    return 1;
+}
@@ -0,0 +1,34 @@
+#ifndef SIM_STORAGE_H
+#define SIM_STORAGE_H
+
+/*
+ * Firmware storage workload for the full host sim.
+ *
+ * Runs the real flash job queue, event log and stream log (storage/) on the
+ * SPI flash model, fed the way app.c feeds them: a sampler tick every
+ * TLM_SAMPLER_PERIOD_MS from the bike model and one flash_jobs_tick() per
+ * main-loop pass. The model's busy time and per-sector erase counts then
+ * show what a ride costs the part.
+ */
+
+#include <stdint.h>
+
+#include "sim_shengyi.h"
+#include "sim_spi_flash.h"
+#include "ui_draw_common.h"
+
+/* Boot as main.c does (queue, log load, reset-reason event). A stream
+ * period of 0 leaves stream logging off, as on a factory config. */
+void sim_storage_init(sim_spi_flash_t *flash, uint16_t stream_period_ms);
+/* Samples due up to now_ms, then one job queue step. */
+void sim_storage_tick(uint32_t now_ms, const sim_shengyi_t *bike);
+/* Shutdown path: program the open stream page and drain the queue. */
+void sim_storage_finish(void);
+
+/* Uploads an asset pack body (scripts/pack_ui_icons.py --pack) through the
+ * ui_assets store path, as the BLE upload would. Returns 1 once committed. */
+int sim_storage_load_assets(const char *path);
+/* ui_set_sprite_lookup() adapter over the stored pack, as in app.c. */
+int sim_storage_sprite_lookup(uint32_t id, ui_sprite_t *out);
+
+#endif
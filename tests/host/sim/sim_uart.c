@@ -14,6 +14,8 @@ typedef struct {
 } sim_uart_t;
 
 static sim_uart_t g_uart[SIM_UART_MAX];
+static sim_uart_tap_fn g_rx_tap;
+static void *g_rx_tap_ctx;
 
 void sim_uart_init(void)
 {
@@ -32,6 +34,8 @@ void sim_uart_rx_push(sim_uart_port_t port, const uint8_t *data, size_t len)
     sim_uart_t *u = port_uart(port);
     if (!u || !data)
         return;
+    if (g_rx_tap)
+        g_rx_tap(port, data, len, g_rx_tap_ctx);
     for (size_t i = 0; i < len; ++i)
     {
         size_t next = (u->rx_tail + 1u) % RX_CAP;
@@ -42,6 +46,12 @@ void sim_uart_rx_push(sim_uart_port_t port, const uint8_t *data, size_t len)
     }
 }
 
+void sim_uart_set_rx_tap(sim_uart_tap_fn fn, void *ctx)
+{
+    g_rx_tap = fn;
+    g_rx_tap_ctx = ctx;
+}
+
 int sim_uart_rx_pop(sim_uart_port_t port, uint8_t *out)
 {
     sim_uart_t *u = port_uart(port);
@@ -18,4 +18,9 @@ void sim_uart_tx_write(sim_uart_port_t port, const uint8_t *data, size_t len);
 size_t sim_uart_tx_size(sim_uart_port_t port);
 size_t sim_uart_tx_read(sim_uart_port_t port, uint8_t *out, size_t max_len);
 
+/* Observer called with every chunk pushed toward the display, before ring
+ * overflow drops any of it (wire capture). NULL removes it. */
+typedef void (*sim_uart_tap_fn)(sim_uart_port_t port, const uint8_t *data, size_t len, void *ctx);
+void sim_uart_set_rx_tap(sim_uart_tap_fn fn, void *ctx);
+
 #endif
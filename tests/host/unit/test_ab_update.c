@@ -7,6 +7,7 @@
 #include <string.h>
 
 #include "storage/ab_update.h"
+#include "platform/watchdog.h"
 #include "storage/layout.h"
 #include "util/byteorder.h"
 #include "util/crc32.h"
@@ -32,6 +33,31 @@ void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
     memcpy(out, &s_flash[addr], len);
 }
 
+static uint8_t *s_async_out;
+static uint32_t s_async_addr;
+static uint32_t s_async_len;
+static uint32_t s_async_started;
+
+/* Lands on the next poll so the verifier has to overlap reads. */
+uint8_t spi_flash_read_async_start(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    s_async_out = out;
+    s_async_addr = addr;
+    s_async_len = len;
+    s_async_started++;
+    return 1u;
+}
+
+uint8_t spi_flash_read_async_poll(void)
+{
+    if (s_async_out)
+    {
+        spi_flash_read(s_async_addr, s_async_out, s_async_len);
+        s_async_out = NULL;
+    }
+    return 1u;
+}
+
 void spi_flash_update_bytes(uint32_t addr, const uint8_t *data, uint32_t len)
 {
     if ((size_t)addr + (size_t)len > sizeof(s_flash))
@@ -39,6 +65,19 @@ void spi_flash_update_bytes(uint32_t addr, const uint8_t *data, uint32_t len)
     memcpy(&s_flash[addr], data, len);
 }
 
+/* Waits run unbudgeted on the host. */
+void watchdog_budget_begin(watchdog_budget_t *b, uint32_t budget_us)
+{
+    (void)b;
+    (void)budget_us;
+}
+
+uint8_t watchdog_budget_poll(watchdog_budget_t *b)
+{
+    (void)b;
+    return 1u;
+}
+
 #define TEST(name) static void test_##name(void)
 #define RUN_TEST(name) do { \
     printf("  %-50s ", #name); \
@@ -177,6 +216,7 @@ TEST(invalid_pending_slot_does_not_replace_active)
     write_slot_image(1u, payload, sizeof(payload), 0xDEADBEEFu, 0u);
 
     ab_update_init();
+    ab_update_verify_wait();
 
     ASSERT_TRUE(g_ab_active_slot == 0u);
     ASSERT_TRUE(g_ab_last_good_slot == 0u);
@@ -196,6 +236,7 @@ TEST(valid_pending_slot_replaces_active)
     write_slot_image(1u, payload, sizeof(payload), 0x0B0B0B0Bu, 1u);
 
     ab_update_init();
+    ab_update_verify_wait();
 
     ASSERT_TRUE(g_ab_active_slot == 1u);
     ASSERT_TRUE(g_ab_last_good_slot == 0u);
@@ -214,6 +255,7 @@ TEST(invalid_active_slot_sanitizes_to_zero)
     write_slot_image(0u, payload, sizeof(payload), 0x01020304u, 1u);
 
     ab_update_init();
+    ab_update_verify_wait();
 
     ASSERT_TRUE(g_ab_active_slot == 0u);
     ASSERT_TRUE(g_ab_last_good_slot == 0u);
@@ -230,6 +272,7 @@ TEST(invalid_pending_slot_clears_meta_pending)
     write_slot_image(1u, payload, sizeof(payload), 0x0E0E0E0Eu, 0u);
 
     ab_update_init();
+    ab_update_verify_wait();
 
     test_meta_t meta;
     ASSERT_TRUE(read_meta_best(&meta) == 1);
@@ -247,6 +290,7 @@ TEST(invalid_pending_slot_preserves_last_good)
     write_slot_image(1u, payload, sizeof(payload), 0x22222222u, 1u);
 
     ab_update_init();
+    ab_update_verify_wait();
 
     ASSERT_TRUE(g_ab_active_slot == 1u);
     ASSERT_TRUE(g_ab_last_good_slot == 0u);
@@ -265,6 +309,7 @@ TEST(fresh_meta_written_on_empty_flash)
     flash_reset();
 
     ab_update_init();
+    ab_update_verify_wait();
 
     ASSERT_TRUE(g_ab_active_slot == 0u);
     ASSERT_TRUE(g_ab_last_good_slot == 0u);
@@ -292,6 +337,7 @@ TEST(pending_valid_overrides_invalid_active_header)
     write_slot_image(1u, payload, sizeof(payload), 0x20202020u, 1u);
 
     ab_update_init();
+    ab_update_verify_wait();
 
     ASSERT_TRUE(g_ab_active_slot == 1u);
     ASSERT_TRUE(g_ab_last_good_slot == 0u);
@@ -323,6 +369,7 @@ TEST(set_pending_none_clears_pending)
     write_slot_image(1u, payload, sizeof(payload), 0x13572468u, 1u);
 
     ASSERT_TRUE(ab_update_set_pending(1u) == 0u);
+    ab_update_verify_wait();
     ASSERT_TRUE(g_ab_pending_slot == 1u);
     ASSERT_TRUE(g_ab_pending_valid == 1u);
 
@@ -358,8 +405,10 @@ TEST(set_pending_rejects_active_slot)
     write_slot_image(0u, payload, sizeof(payload), 0x0C0FFEEu, 1u);
 
     ab_update_init();
+    ab_update_verify_wait();
 
     ASSERT_TRUE(ab_update_set_pending(0u) == 0u);
+    ab_update_verify_wait();
     ASSERT_TRUE(g_ab_pending_slot == AB_SLOT_NONE);
     ASSERT_TRUE(g_ab_pending_valid == 0u);
 }
@@ -369,6 +418,7 @@ TEST(set_pending_invalid_header_marks_pending_invalid)
     flash_reset();
 
     ASSERT_TRUE(ab_update_set_pending(1u) == 0u);
+    ab_update_verify_wait();
     ASSERT_TRUE(g_ab_pending_slot == 1u);
     ASSERT_TRUE(g_ab_pending_valid == 0u);
 }
@@ -382,6 +432,7 @@ TEST(set_pending_updates_meta)
     write_slot_image(1u, payload, sizeof(payload), 0x42424242u, 1u);
 
     ASSERT_TRUE(ab_update_set_pending(1u) == 0u);
+    ab_update_verify_wait();
     ASSERT_TRUE(g_ab_pending_slot == 1u);
     ASSERT_TRUE(g_ab_pending_valid == 1u);
 
@@ -402,6 +453,7 @@ TEST(set_pending_preserves_last_good)
     write_slot_image(0u, payload, sizeof(payload), 0x01020304u, 1u);
 
     ASSERT_TRUE(ab_update_set_pending(0u) == 0u);
+    ab_update_verify_wait();
     ASSERT_TRUE(g_ab_pending_slot == 0u);
     ASSERT_TRUE(g_ab_pending_valid == 1u);
 
@@ -421,6 +473,7 @@ TEST(set_pending_on_empty_flash_writes_meta)
     write_slot_image(1u, payload, sizeof(payload), 0x11223344u, 1u);
 
     ASSERT_TRUE(ab_update_set_pending(1u) == 0u);
+    ab_update_verify_wait();
     ASSERT_TRUE(g_ab_pending_slot == 1u);
     ASSERT_TRUE(g_ab_pending_valid == 1u);
 
@@ -441,6 +494,7 @@ TEST(pending_slot_matching_active_is_cleared)
     write_slot_image(0u, payload, sizeof(payload), 0xCAFEBABEu, 1u);
 
     ab_update_init();
+    ab_update_verify_wait();
 
     ASSERT_TRUE(g_ab_active_slot == 0u);
     ASSERT_TRUE(g_ab_pending_slot == AB_SLOT_NONE);
@@ -449,6 +503,51 @@ TEST(pending_slot_matching_active_is_cleared)
     ASSERT_TRUE(g_ab_active_build_id == 0xCAFEBABEu);
 }
 
+TEST(verify_runs_in_background_chunks)
+{
+    flash_reset();
+
+    static uint8_t payload[3000];
+    for (uint32_t i = 0; i < sizeof(payload); ++i)
+        payload[i] = (uint8_t)(i * 7u);
+    write_meta_copy(0, 1u, 0u, 1u, 0u, 0u);
+    write_slot_image(0u, payload, sizeof(payload), 0x0102A0A0u, 1u);
+    write_slot_image(1u, payload, sizeof(payload), 0x0102B0B0u, 1u);
+    s_async_started = 0u;
+
+    ab_update_init();
+
+    ab_verify_status_t st;
+    ab_update_get_verify(&st);
+    ASSERT_TRUE(st.busy == 1u);
+    ASSERT_TRUE(st.queued == 2u);
+    ASSERT_TRUE(g_ab_active_valid == 0u);
+    ASSERT_TRUE(g_ab_pending_slot == 1u);
+
+    ab_update_tick();
+    ab_update_tick();
+    ab_update_get_verify(&st);
+    ASSERT_TRUE(st.slot == 0u);
+    ASSERT_TRUE(st.total == sizeof(payload));
+    ASSERT_TRUE(st.done > 0u && st.done < st.total);
+
+    uint32_t ticks = 0u;
+    for (;;)
+    {
+        ab_update_get_verify(&st);
+        if (!st.busy)
+            break;
+        ab_update_tick();
+        ASSERT_TRUE(++ticks < 100u);
+    }
+    ASSERT_TRUE(s_async_started == 12u); /* 6 chunks per slot */
+    ASSERT_TRUE(st.last_slot == 1u && st.last_ok == 1u);
+    ASSERT_TRUE(g_ab_active_slot == 1u);
+    ASSERT_TRUE(g_ab_active_valid == 1u);
+    ASSERT_TRUE(g_ab_active_build_id == 0x0102B0B0u);
+    ASSERT_TRUE(g_ab_pending_slot == AB_SLOT_NONE);
+}
+
 int main(void)
 {
     printf("\nA/B Update Unit Tests\n");
@@ -470,6 +569,7 @@ int main(void)
     RUN_TEST(set_pending_preserves_last_good);
     RUN_TEST(set_pending_on_empty_flash_writes_meta);
     RUN_TEST(pending_slot_matching_active_is_cleared);
+    RUN_TEST(verify_runs_in_background_chunks);
 
     printf("\n");
     printf("======================\n");
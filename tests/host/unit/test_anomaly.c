@@ -0,0 +1,213 @@
+/*
+ * Unit Tests for the streaming sag, heat-rate and link-error detectors.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "src/telemetry/anomaly.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    anomaly_reset(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define R_MOHM 100u /* 10 A drops 1 V */
+
+static uint8_t sample(uint32_t ms, int16_t dV, int16_t dA, int16_t temp_dC)
+{
+    tlm_tick_t s;
+    memset(&s, 0, sizeof(s));
+    s.ms = ms;
+    s.battery_dV = dV;
+    s.battery_dA = dA;
+    s.ctrl_temp_dC = temp_dC;
+    return anomaly_on_sample(&s, R_MOHM);
+}
+
+/* 50 Hz of samples for the given span; returns the OR of the raised bits. */
+static uint8_t run(uint32_t *ms, uint32_t span_ms, int16_t dV, int16_t dA, int16_t temp_dC)
+{
+    uint8_t raised = 0u;
+    for (uint32_t t = 0; t < span_ms; t += 20u)
+    {
+        raised |= sample(*ms, dV, dA, temp_dC);
+        *ms += 20u;
+    }
+    return raised;
+}
+
+TEST(sag_follows_ir_without_alarm)
+{
+    uint32_t ms = 0u;
+    /* 50 V at rest, and exactly the I*R drop under 10 and 20 A. */
+    for (uint32_t i = 0; i < 20u; ++i)
+    {
+        ASSERT_TRUE(run(&ms, 2000u, 500, 0, 0) == 0u);
+        ASSERT_TRUE(run(&ms, 2000u, 490, 100, 0) == 0u);
+        ASSERT_TRUE(run(&ms, 2000u, 480, 200, 0) == 0u);
+    }
+    /* Low voltage with no load is not a sag. */
+    ASSERT_TRUE(run(&ms, 5000u, 440, 0, 0) == 0u);
+
+    anomaly_stats_t st;
+    anomaly_get_stats(&st);
+    ASSERT_TRUE(st.trips[ANOMALY_SAG] == 0u);
+    ASSERT_TRUE(st.sag_base_dV >= 490 && st.sag_base_dV <= 500);
+}
+
+TEST(sag_raises_once_per_episode)
+{
+    uint32_t ms = 0u;
+    ASSERT_TRUE(run(&ms, 10000u, 490, 100, 0) == 0u);
+
+    /* 3 V more than R explains: raised within the second, then held. */
+    uint8_t raised = run(&ms, 1000u, 460, 100, 0);
+    ASSERT_TRUE(raised == (1u << ANOMALY_SAG));
+    ASSERT_TRUE(anomaly_event_type(ANOMALY_SAG) == 12u);
+    /* 3 V short, less what the baseline has drifted towards it. */
+    ASSERT_TRUE(anomaly_flags(ANOMALY_SAG) >= 28u && anomaly_flags(ANOMALY_SAG) <= 30u);
+    ASSERT_TRUE(run(&ms, 5000u, 460, 100, 0) == 0u);
+
+    anomaly_stats_t st;
+    anomaly_get_stats(&st);
+    ASSERT_TRUE(st.raised[ANOMALY_SAG] == 1u);
+    ASSERT_TRUE(st.trips[ANOMALY_SAG] > 1u);
+
+    /* Quiet for the clear time, then it counts as a new episode. */
+    ASSERT_TRUE(run(&ms, ANOMALY_CLEAR_MS, 490, 100, 0) == 0u);
+    ASSERT_TRUE(run(&ms, 2000u, 460, 100, 0) == (1u << ANOMALY_SAG));
+    anomaly_get_stats(&st);
+    ASSERT_TRUE(st.raised[ANOMALY_SAG] == 2u);
+}
+
+TEST(sag_needs_a_resistance_estimate)
+{
+    tlm_tick_t s;
+    memset(&s, 0, sizeof(s));
+    s.battery_dA = 200;
+    for (uint32_t i = 0; i < 2000u; ++i)
+    {
+        s.ms = i * 20u;
+        s.battery_dV = (int16_t)((i < 1000u) ? 500 : 300);
+        ASSERT_TRUE(anomaly_on_sample(&s, 0u) == 0u);
+    }
+}
+
+TEST(heat_flags_a_fast_rise)
+{
+    uint32_t ms = 0u;
+    int16_t temp = 300;
+    /* 0.5 C per 5 s block for a minute and a half. */
+    for (uint32_t b = 0; b < 18u; ++b)
+    {
+        ASSERT_TRUE(run(&ms, ANOMALY_HEAT_BLOCK_MS, 500, 0, temp) == 0u);
+        temp = (int16_t)(temp + 5);
+    }
+    /* 4 C in one block. */
+    ASSERT_TRUE(run(&ms, ANOMALY_HEAT_BLOCK_MS, 500, 0, temp) == 0u);
+    temp = (int16_t)(temp + 40);
+    ASSERT_TRUE(run(&ms, 40u, 500, 0, temp) == (1u << ANOMALY_HEAT));
+    ASSERT_TRUE(anomaly_event_type(ANOMALY_HEAT) == 4u);
+    ASSERT_TRUE(anomaly_flags(ANOMALY_HEAT) == 48u); /* 4 C per 5 s */
+
+    /* Still climbing fast: the same episode. */
+    ASSERT_TRUE(run(&ms, ANOMALY_HEAT_BLOCK_MS, 500, 0, temp) == 0u);
+    temp = (int16_t)(temp + 40);
+    ASSERT_TRUE(run(&ms, ANOMALY_HEAT_BLOCK_MS, 500, 0, temp) == 0u);
+}
+
+TEST(heat_ignores_unreported_and_gaps)
+{
+    uint32_t ms = 0u;
+    for (uint32_t b = 0; b < 20u; ++b)
+        ASSERT_TRUE(run(&ms, ANOMALY_HEAT_BLOCK_MS, 500, 0, 300) == 0u);
+    /* Not reported, then back much hotter: no rise is measured over it. */
+    ASSERT_TRUE(run(&ms, 20000u, 500, 0, 0) == 0u);
+    ASSERT_TRUE(run(&ms, 2u * ANOMALY_HEAT_BLOCK_MS, 500, 0, 600) == 0u);
+    /* Likewise across a gap in the samples. */
+    ms += 3u * ANOMALY_HEAT_BLOCK_MS;
+    ASSERT_TRUE(run(&ms, 2u * ANOMALY_HEAT_BLOCK_MS, 500, 0, 900) == 0u);
+
+    anomaly_stats_t st;
+    anomaly_get_stats(&st);
+    ASSERT_TRUE(st.trips[ANOMALY_HEAT] == 0u);
+}
+
+TEST(link_errors_raise_once)
+{
+    uint32_t ms = 0u;
+    uint32_t frames = 0u;
+    uint32_t errors = 0u;
+    ASSERT_TRUE(anomaly_on_link(ms, frames, errors) == 0u);
+    /* 3 % errors is within the slack. */
+    for (uint32_t i = 0; i < 60u; ++i)
+    {
+        ms += 1000u;
+        frames += 97u;
+        errors += 3u;
+        ASSERT_TRUE(anomaly_on_link(ms, frames, errors) == 0u);
+    }
+    /* No traffic at all says nothing. */
+    ms += 10000u;
+    ASSERT_TRUE(anomaly_on_link(ms, frames, errors) == 0u);
+
+    uint8_t raised = 0u;
+    uint32_t raised_at = 0u;
+    for (uint32_t i = 1; i <= 10u; ++i)
+    {
+        ms += 1000u;
+        frames += 70u;
+        errors += 30u;
+        uint8_t r = anomaly_on_link(ms, frames, errors);
+        if (r && !raised_at)
+            raised_at = i;
+        raised |= r;
+    }
+    ASSERT_TRUE(raised == (1u << ANOMALY_LINK));
+    ASSERT_TRUE(raised_at == 4u); /* 250 per mille past the slack a second */
+    ASSERT_TRUE(anomaly_event_type(ANOMALY_LINK) == 2u);
+    ASSERT_TRUE(anomaly_flags(ANOMALY_LINK) == 30u);
+
+    anomaly_stats_t st;
+    anomaly_get_stats(&st);
+    ASSERT_TRUE(st.raised[ANOMALY_LINK] == 1u && st.trips[ANOMALY_LINK] == 2u);
+}
+
+int main(void)
+{
+    printf("\nAnomaly Detector Unit Tests\n");
+    printf("===========================\n\n");
+
+    RUN_TEST(sag_follows_ir_without_alarm);
+    RUN_TEST(sag_raises_once_per_episode);
+    RUN_TEST(sag_needs_a_resistance_estimate);
+    RUN_TEST(heat_flags_a_fast_rise);
+    RUN_TEST(heat_ignores_unreported_and_gaps);
+    RUN_TEST(link_errors_raise_once);
+
+    printf("\n");
+    printf("===========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("===========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * Unit Tests for the battery state estimator.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "battery_est.h"
+#include "battery_soc.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+static uint32_t s_now;
+
+static void setup(void)
+{
+    battery_est_reset(36u);
+    s_now = 1000u;
+}
+
+/* ADC cadence: one sample every 50 ms for ms milliseconds. */
+static void feed(uint32_t ms, uint32_t mv, int16_t dA, uint8_t have_i)
+{
+    for (uint32_t t = 0; t < ms; t += 50u)
+    {
+        battery_est_update(s_now, mv, dA, have_i);
+        s_now += 50u;
+    }
+}
+
+TEST(load_sag_does_not_move_soc)
+{
+    /* 75 % at rest, then 15 A through 150 mOhm for a minute. */
+    feed(5000u, 38500u, 0, 1u);
+    ASSERT_TRUE(battery_est_soc_pct() == 75u);
+    feed(60000u, 38500u - 2250u, 150, 1u);
+
+    /* 250 mAh of a 13.9 Ah pack is 1.8 %; the raw curve would read ~43 %. */
+    uint8_t soc = battery_est_soc_pct();
+    ASSERT_TRUE(battery_soc_pct_from_mv(38500u - 2250u, 36u) < 50u);
+    ASSERT_TRUE(soc >= 72u && soc <= 74u);
+    ASSERT_TRUE(battery_est_remaining_wh() >= 360u && battery_est_remaining_wh() <= 370u);
+}
+
+TEST(resistance_tracks_current_steps)
+{
+    battery_est_info_t info;
+    /* True R 300 mOhm: 0 A and 20 A alternate every 2 s. */
+    for (uint8_t i = 0; i < 40u; ++i)
+    {
+        int16_t dA = (i & 1u) ? 200 : 0;
+        feed(2000u, 38000u - (uint32_t)dA * 300u / 10u, dA, 1u);
+    }
+    battery_est_get_info(&info);
+    ASSERT_TRUE(info.r_updates >= 20u);
+    ASSERT_TRUE(info.r_mohm >= 270u && info.r_mohm <= 310u);
+}
+
+TEST(rest_reading_converges_on_the_curve)
+{
+    battery_est_info_t info;
+    /* First sample sagged with no current sensor; the pack then rests at 90 %. */
+    feed(1000u, 36500u, 0, 0u);
+    uint8_t first = battery_est_soc_pct();
+    ASSERT_TRUE(first < 50u);
+    feed(1000u, 39500u, 0, 0u);
+    ASSERT_TRUE(battery_est_soc_pct() > first && battery_est_soc_pct() < 90u);
+    feed(600000u, 39500u, 0, 0u);
+    battery_est_get_info(&info);
+    ASSERT_TRUE(info.soc_x100 >= 8900u && info.soc_x100 <= 9000u);
+    ASSERT_TRUE(info.var < 300u * 300u);
+}
+
+int main(void)
+{
+    printf("\nBattery Estimator Unit Tests\n");
+    printf("============================\n\n");
+
+    RUN_TEST(load_sag_does_not_move_soc);
+    RUN_TEST(resistance_tracks_current_steps);
+    RUN_TEST(rest_reading_converges_on_the_curve);
+
+    printf("\n");
+    printf("============================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("============================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -40,11 +40,69 @@ static void test_infer_nominal_curve(void)
     assert_eq_u8(battery_soc_pct_from_mv(42000u, 0u), 0u, "infer 42.0V -> 0%");
 }
 
+/* The OEM linear scan the direct index replaced, kept as the reference. */
+static const uint16_t k_ref_pct_x100[13] = {
+    42000u, 10000u, 9000u, 7500u, 6000u, 4500u, 3692u,
+    3115u, 2000u, 1000u, 800u, 500u, 0u
+};
+static const uint16_t k_ref_curves[3][13] = {
+    { 0u, 29000u, 27700u, 27000u, 26300u, 25600u, 25200u,
+      25000u, 24500u, 24200u, 23800u, 23100u, 21000u },
+    { 0u, 40800u, 39500u, 38500u, 37500u, 36500u, 36000u,
+      35600u, 35000u, 34500u, 34000u, 33000u, 31500u },
+    { 0u, 53800u, 51400u, 50100u, 48800u, 47500u, 46800u,
+      46300u, 45500u, 44900u, 44200u, 42900u, 42000u },
+};
+
+static uint8_t ref_soc(uint32_t mv, const uint16_t *curve)
+{
+    if (mv == 0u)
+        return 0u;
+    uint8_t i = 0u;
+    for (; i < 12u; ++i)
+    {
+        if ((uint32_t)curve[i + 1u] <= mv)
+            break;
+    }
+    if (i >= 12u)
+        return 0u;
+    if (i == 0u)
+        return 100u;
+    uint32_t x1 = curve[i + 1u];
+    uint32_t dx = curve[i] - x1;
+    uint32_t dy = k_ref_pct_x100[i] - k_ref_pct_x100[i + 1u];
+    uint32_t y = k_ref_pct_x100[i + 1u] + (dy * (mv - x1)) / dx;
+    uint32_t pct = (y + 50u) / 100u;
+    return (uint8_t)(pct > 100u ? 100u : pct);
+}
+
+static void test_index_matches_scan(void)
+{
+    static const uint8_t nominal[3] = { 24u, 36u, 48u };
+    battery_soc_init();
+    for (uint8_t c = 0; c < 3u; ++c)
+    {
+        for (uint32_t mv = 0; mv <= 60000u; ++mv)
+        {
+            uint8_t want = ref_soc(mv, k_ref_curves[c]);
+            uint8_t got = battery_soc_pct_from_mv(mv, nominal[c]);
+            if (got != want)
+            {
+                fprintf(stderr, "FAIL: %uV curve at %u mV (got=%u want=%u)\n",
+                        nominal[c], mv, got, want);
+                g_failures++;
+                return;
+            }
+        }
+    }
+}
+
 int main(void)
 {
     test_fixed_points_48v();
     test_fixed_points_36v();
     test_infer_nominal_curve();
+    test_index_matches_scan();
 
     if (g_failures)
     {
@@ -0,0 +1,97 @@
+/*
+ * Unit Tests for ble_hacker framing and notification batching.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "src/ble/ble_hacker.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+TEST(encode_decode_roundtrip)
+{
+    uint8_t payload[4] = { 1u, 2u, 3u, 4u };
+    uint8_t out[16];
+    ble_hacker_frame_t req;
+    uint8_t status = 0xFFu;
+    uint8_t n = ble_hacker_encode(BLE_HACKER_OP_CONFIG_GET, payload, sizeof(payload), out, sizeof(out));
+    ASSERT_TRUE(n == 7u);
+    ASSERT_TRUE(ble_hacker_decode(out, n, &req, &status) == 1);
+    ASSERT_TRUE(status == BLE_HACKER_STATUS_OK && req.payload_len == 4u && req.payload[3] == 4u);
+    ASSERT_TRUE(ble_hacker_decode(out, (uint8_t)(n - 1u), &req, &status) == 0);
+    ASSERT_TRUE(status == BLE_HACKER_STATUS_BAD_LENGTH);
+}
+
+TEST(batch_packs_until_full)
+{
+    ble_hacker_batch_t b;
+    uint8_t telem[22];
+    memset(telem, 0x5Au, sizeof(telem));
+    ble_hacker_batch_init(&b, 60u, 20u);
+
+    /* 3 + 1 + 22 = 26 bytes each: two fit in 60. */
+    ASSERT_TRUE(ble_hacker_batch_add_status(&b, 0x82u, 0u, telem, sizeof(telem), 100u) == 26u);
+    ASSERT_TRUE(ble_hacker_batch_add_status(&b, 0x82u, 0u, telem, sizeof(telem), 105u) == 26u);
+    ASSERT_TRUE(ble_hacker_batch_add_status(&b, 0x82u, 0u, telem, sizeof(telem), 110u) == 0u);
+    ASSERT_TRUE(b.count == 2u && b.len == 52u);
+
+    /* Messages stay self-delimiting back to back. */
+    ble_hacker_frame_t req;
+    ASSERT_TRUE(ble_hacker_decode(&b.buf[26], 26u, &req, NULL) == 1);
+    ASSERT_TRUE(req.opcode == 0x82u && req.payload[0] == 0u && req.payload[1] == 0x5Au);
+}
+
+TEST(batch_deadline_from_first_message)
+{
+    ble_hacker_batch_t b;
+    uint8_t v = 7u;
+    ble_hacker_batch_init(&b, 0u, 20u);
+    ASSERT_TRUE(b.mtu == BLE_HACKER_BATCH_MAX);
+    ASSERT_TRUE(ble_hacker_batch_due(&b, 1000u) == 0);
+
+    ASSERT_TRUE(ble_hacker_batch_add_status(&b, 0x82u, 0u, &v, 1u, 1000u) != 0u);
+    ASSERT_TRUE(ble_hacker_batch_add_status(&b, 0x82u, 0u, &v, 1u, 1015u) != 0u);
+    ASSERT_TRUE(ble_hacker_batch_due(&b, 1019u) == 0);
+    ASSERT_TRUE(ble_hacker_batch_due(&b, 1020u) == 1);
+
+    ble_hacker_batch_clear(&b);
+    ASSERT_TRUE(b.len == 0u && ble_hacker_batch_due(&b, 5000u) == 0);
+}
+
+int main(void)
+{
+    printf("\nBLE Hacker Unit Tests\n");
+    printf("=====================\n\n");
+
+    RUN_TEST(encode_decode_roundtrip);
+    RUN_TEST(batch_packs_until_full);
+    RUN_TEST(batch_deadline_from_first_message);
+
+    printf("\n");
+    printf("=====================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("=====================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
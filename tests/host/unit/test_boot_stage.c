@@ -0,0 +1,154 @@
+/*
+ * Unit Tests for the RAM-staged boot stage log.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "storage/boot_stage.h"
+#include "storage/layout.h"
+#include "drivers/spi_flash.h"
+#include "util/byteorder.h"
+
+volatile uint32_t g_ms;
+
+static uint8_t s_flash[SPI_FLASH_SECTOR_SIZE];
+static uint32_t s_erases;
+static uint32_t s_programs;
+static uint32_t s_read_bytes;
+
+static uint32_t off_of(uint32_t addr)
+{
+    return addr - BOOT_STAGE_STORAGE_BASE;
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    s_read_bytes += len;
+    memcpy(out, &s_flash[off_of(addr)], len);
+}
+
+void spi_flash_erase_4k(uint32_t addr)
+{
+    s_erases++;
+    memset(&s_flash[off_of(addr)], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+void spi_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    s_programs++;
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[off_of(addr) + i] &= data[i];
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void setup(void)
+{
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    s_erases = 0u;
+    s_programs = 0u;
+    s_read_bytes = 0u;
+    g_ms = 0u;
+}
+
+/* One boot's worth of marks, then the end-of-boot commit. */
+static void boot(uint32_t tag, uint32_t marks)
+{
+    for (uint32_t i = 0; i < marks; ++i)
+    {
+        g_ms += 3u;
+        boot_stage_log(tag + i);
+    }
+    boot_stage_commit();
+}
+
+TEST(marks_stay_in_ram_until_commit)
+{
+    for (uint32_t i = 0; i < 20u; ++i)
+        boot_stage_log(0xB000u + i);
+    ASSERT_TRUE(s_programs == 0u && s_read_bytes == 0u);
+
+    boot_stage_commit();
+    /* Sector init (magic), the page, the slot mark. */
+    ASSERT_TRUE(s_erases == 1u && s_programs == 3u);
+    /* The header alone locates the slot. */
+    ASSERT_TRUE(s_read_bytes < 32u);
+
+    uint32_t code = 0u;
+    uint32_t ms = 0u;
+    ASSERT_TRUE(boot_stage_read_last(&code, &ms));
+    ASSERT_TRUE(code == 0xB013u);
+
+    /* Nothing new: a second commit (e.g. a later fault) writes nothing. */
+    boot_stage_commit();
+    ASSERT_TRUE(s_programs == 3u);
+}
+
+TEST(boots_fill_slots_then_recycle_the_sector)
+{
+    for (uint32_t b = 0; b < BOOT_STAGE_SLOTS; ++b)
+        boot(0x1000u * (b + 1u), 5u);
+    ASSERT_TRUE(s_erases == 1u);
+
+    uint32_t code = 0u;
+    ASSERT_TRUE(boot_stage_read_last(&code, NULL));
+    ASSERT_TRUE(code == 0x1000u * BOOT_STAGE_SLOTS + 4u);
+
+    boot(0xA000u, 40u);
+    ASSERT_TRUE(s_erases == 2u);
+    ASSERT_TRUE(boot_stage_read_last(&code, NULL));
+    ASSERT_TRUE(code == 0xA000u + 39u);
+    /* The page keeps the newest 32 marks. */
+    uint32_t first = load_be32(&s_flash[SPI_FLASH_PAGE_SIZE]);
+    ASSERT_TRUE(first == 0xA000u + 8u);
+}
+
+TEST(unmarked_page_is_ignored)
+{
+    boot(0x2000u, 4u);
+    /* Power cut after the page program, before the slot mark. */
+    memset(&s_flash[2u * SPI_FLASH_PAGE_SIZE], 0x00, 8u);
+
+    uint32_t code = 0u;
+    ASSERT_TRUE(boot_stage_read_last(&code, NULL));
+    ASSERT_TRUE(code == 0x2003u);
+}
+
+int main(void)
+{
+    printf("\nBoot Stage Log Unit Tests\n");
+    printf("=========================\n\n");
+
+    RUN_TEST(marks_stay_in_ram_until_commit);
+    RUN_TEST(boots_fill_slots_then_recycle_the_sector);
+    RUN_TEST(unmarked_page_is_ignored);
+
+    printf("\n");
+    printf("=========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("=========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * Unit Tests for the dependency-ordered boot step runner.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "boot_steps.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static uint32_t s_order[BOOT_STEPS_MAX];
+static uint8_t s_ran;
+static uint32_t s_marks[BOOT_STEPS_MAX];
+static uint8_t s_marked;
+
+static void record(uint32_t id)
+{
+    s_order[s_ran++] = id;
+}
+
+static void mark(uint32_t code)
+{
+    s_marks[s_marked++] = code;
+}
+
+static void step_a(void) { record(0xA); }
+static void step_b(void) { record(0xB); }
+static void step_c(void) { record(0xC); }
+
+/* Stands in for a step that waits in board code, which calls back in. */
+static void step_nested(void)
+{
+    record(0xD);
+    while (boot_steps_run_one())
+        ;
+}
+
+static void setup(void)
+{
+    s_ran = 0u;
+    s_marked = 0u;
+}
+
+TEST(dependents_wait_for_their_deps)
+{
+    /* c needs a and b, b needs a; listed in reverse on purpose. */
+    boot_step_t steps[] = {
+        { step_c, 0xC0u, (uint8_t)((1u << 2) | (1u << 1)) },
+        { step_b, 0xB0u, (uint8_t)(1u << 2) },
+        { step_a, 0xA0u, 0x0u },
+    };
+    boot_steps_begin(steps, 3u, mark);
+
+    ASSERT_TRUE(boot_steps_run_one());
+    ASSERT_TRUE(s_ran == 1u && s_order[0] == 0xA);
+    boot_steps_finish();
+    ASSERT_TRUE(s_ran == 3u && s_order[1] == 0xB && s_order[2] == 0xC);
+    ASSERT_TRUE(s_marked == 3u && s_marks[0] == 0xA0u && s_marks[2] == 0xC0u);
+    ASSERT_TRUE(boot_steps_done_mask() == 0x7u);
+    ASSERT_TRUE(!boot_steps_run_one());
+}
+
+TEST(nested_run_skips_steps_waiting_on_the_running_one)
+{
+    boot_step_t steps[] = {
+        { step_nested, 0xD0u, 0x0u },
+        { step_b,      0xB0u, 0x1u },   /* needs the nested step done */
+        { step_a,      0xA0u, 0x0u },
+    };
+    boot_steps_begin(steps, 3u, mark);
+
+    ASSERT_TRUE(boot_steps_run_one());
+    /* Inside the nested step only a could run; b waited for it. */
+    ASSERT_TRUE(s_ran == 2u && s_order[0] == 0xD && s_order[1] == 0xA);
+    boot_steps_finish();
+    ASSERT_TRUE(s_ran == 3u && s_order[2] == 0xB);
+}
+
+int main(void)
+{
+    printf("\nBoot Steps Unit Tests\n");
+    printf("=====================\n\n");
+
+    RUN_TEST(dependents_wait_for_their_deps);
+    RUN_TEST(nested_run_skips_steps_waiting_on_the_running_one);
+
+    printf("\n");
+    printf("=====================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("=====================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
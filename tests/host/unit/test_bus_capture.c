@@ -0,0 +1,182 @@
+/*
+ * Unit Tests for the packed bus capture ring and its cursors.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "app_data.h"
+#include "bus.h"
+#include "config/config.h"
+
+debug_inputs_t g_inputs;
+config_t g_config_active;
+volatile uint32_t g_ms;
+
+static uint32_t s_trigger_seq;
+
+uint8_t platform_ram_ext_available(void) { return 0u; }
+void event_log_append(uint8_t type, uint8_t flags) { (void)type; (void)flags; }
+void bus_ui_reset(void) {}
+void bus_ui_on_capture(uint8_t bus_id, const uint8_t *data, uint8_t len, uint16_t dt_ms)
+{
+    (void)bus_id;
+    (void)data;
+    (void)len;
+    (void)dt_ms;
+}
+void bus_replay_reset(void) {}
+void bus_trigger_on_reset(void) {}
+void bus_trigger_on_capture(uint32_t seq, uint8_t bus_id, const uint8_t *data, uint8_t len)
+{
+    (void)bus_id;
+    (void)data;
+    (void)len;
+    s_trigger_seq = seq;
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void setup(void)
+{
+    g_ms = 1000u;
+    bus_capture_set_enabled(1u, 1u);
+}
+
+/* Frame `i`: 1..20 bytes, each byte derived from i. */
+static uint8_t frame_len(uint32_t i)
+{
+    return (uint8_t)(1u + i % 20u);
+}
+
+static void append_frame(uint32_t i)
+{
+    uint8_t data[BUS_CAPTURE_MAX_DATA];
+    uint8_t len = frame_len(i);
+    for (uint8_t j = 0; j < len; ++j)
+        data[j] = (uint8_t)(i * 7u + j);
+    g_ms += 10u;
+    bus_capture_append((uint8_t)(i & 1u), data, len, 0u);
+}
+
+static int frame_matches(uint32_t i, const bus_capture_record_t *r)
+{
+    if (r->len != frame_len(i) || r->bus_id != (uint8_t)(i & 1u))
+        return 0;
+    for (uint8_t j = 0; j < r->len; ++j)
+    {
+        if (r->data[j] != (uint8_t)(i * 7u + j))
+            return 0;
+    }
+    return 1;
+}
+
+TEST(short_frames_take_only_their_bytes)
+{
+    uint8_t data[8] = {0x3A, 0x1A, 0x52, 1, 2, 3, 4, 5};
+    for (uint32_t i = 0; i < 1000u; ++i)
+        bus_capture_append(BUS_MOTOR, data, sizeof(data), 0u);
+    bus_capture_state_t st;
+    bus_capture_get_state(&st);
+    ASSERT_TRUE(st.capacity == BUS_CAPTURE_RING_BYTES);
+    ASSERT_TRUE(st.count == BUS_CAPTURE_RING_BYTES / (BUS_CAPTURE_RECORD_HEADER_BYTES + sizeof(data)));
+    ASSERT_TRUE(st.count >= 3u * 64u);
+    ASSERT_TRUE(st.used == st.count * (BUS_CAPTURE_RECORD_HEADER_BYTES + sizeof(data)));
+    ASSERT_TRUE(st.seq == 1001u);
+    ASSERT_TRUE(s_trigger_seq == 1000u);
+}
+
+TEST(cursor_reads_across_the_wrap)
+{
+    for (uint32_t i = 1; i <= 700u; ++i)
+        append_frame(i);
+    bus_capture_state_t st;
+    bus_capture_get_state(&st);
+    uint32_t oldest = st.seq - st.count;
+    ASSERT_TRUE(st.seq == 701u && st.count < 700u);
+
+    bus_capture_cursor_t c = {0};
+    bus_capture_cursor_seek(&c, 0u);
+    ASSERT_TRUE(c.seq == oldest);
+    bus_capture_record_t r;
+    uint32_t n = 0;
+    while (bus_capture_cursor_next(&c, &r))
+    {
+        ASSERT_TRUE(frame_matches(oldest + n, &r));
+        ASSERT_TRUE(r.dt_ms == (n + oldest == 1u ? 0u : 10u));
+        n++;
+    }
+    ASSERT_TRUE(n == st.count && c.seq == st.seq);
+
+    /* Seeks land on the record asked for, forward or back. */
+    bus_capture_cursor_seek(&c, 690u);
+    ASSERT_TRUE(bus_capture_cursor_next(&c, &r) && frame_matches(690u, &r));
+    bus_capture_cursor_seek(&c, oldest + 5u);
+    ASSERT_TRUE(bus_capture_cursor_next(&c, &r) && frame_matches(oldest + 5u, &r));
+    bus_capture_cursor_seek(&c, 5000u);
+    ASSERT_TRUE(c.seq == st.seq && !bus_capture_cursor_next(&c, &r));
+
+    /* A cursor at the end picks up records appended later. */
+    append_frame(701u);
+    ASSERT_TRUE(bus_capture_cursor_next(&c, &r) && frame_matches(701u, &r));
+}
+
+TEST(stale_cursor_jumps_to_the_oldest_record)
+{
+    for (uint32_t i = 1; i <= 10u; ++i)
+        append_frame(i);
+    bus_capture_cursor_t c = {0};
+    bus_capture_cursor_seek(&c, 3u);
+    for (uint32_t i = 11; i <= 400u; ++i)
+        append_frame(i);
+
+    bus_capture_state_t st;
+    bus_capture_get_state(&st);
+    uint32_t oldest = st.seq - st.count;
+    bus_capture_record_t r;
+    ASSERT_TRUE(bus_capture_cursor_next(&c, &r));
+    ASSERT_TRUE(c.seq == oldest + 1u && frame_matches(oldest, &r));
+
+    /* A reset invalidates every cursor placed before it. */
+    bus_capture_set_enabled(1u, 1u);
+    append_frame(1u);
+    ASSERT_TRUE(bus_capture_cursor_next(&c, &r) && c.seq == 2u && frame_matches(1u, &r));
+}
+
+int main(void)
+{
+    printf("\nBus Capture Unit Tests\n");
+    printf("======================\n\n");
+
+    RUN_TEST(short_frames_take_only_their_bytes);
+    RUN_TEST(cursor_reads_across_the_wrap);
+    RUN_TEST(stale_cursor_jumps_to_the_oldest_record);
+
+    printf("\n");
+    printf("======================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("======================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
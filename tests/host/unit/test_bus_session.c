@@ -0,0 +1,231 @@
+/*
+ * Unit Tests for the session recorder and the host sim's session loader:
+ * what bus_session writes to flash is what sim_session replays.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "bus.h"
+#include "sim/sim_session.h"
+#include "storage/flash_jobs.h"
+#include "storage/layout.h"
+#include "drivers/spi_flash.h"
+
+volatile uint32_t g_ms;
+
+static uint8_t s_flash[BUS_SESSION_STORAGE_BYTES];
+
+static uint32_t off_of(uint32_t addr)
+{
+    return addr - BUS_SESSION_STORAGE_BASE;
+}
+
+void flash_jobs_erase(uint32_t addr)
+{
+    memset(&s_flash[off_of(addr) & ~(SPI_FLASH_SECTOR_SIZE - 1u)], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+void flash_jobs_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[off_of(addr) + i] &= data[i];
+}
+
+/* Every program runs synchronously through the fallback. */
+int flash_jobs_submit_program(uint32_t addr, const uint8_t *data, uint32_t len,
+                              flash_job_done_fn done, void *ctx)
+{
+    (void)addr;
+    (void)data;
+    (void)len;
+    (void)done;
+    (void)ctx;
+    return 0;
+}
+
+void flash_jobs_flush(void) {}
+uint8_t flash_jobs_pending(void) { return 0u; }
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void setup(void)
+{
+    memset(s_flash, 0x00, sizeof(s_flash)); /* erase-before-program shows up as garbage */
+    g_ms = 5000u;
+}
+
+/* Advances the clock ms by ms, ticking the recorder each one. */
+static void run_ms(uint32_t ms)
+{
+    while (ms--)
+    {
+        g_ms++;
+        bus_session_tick();
+    }
+}
+
+TEST(records_replay_with_their_timing)
+{
+    static const uint8_t frame_a[3] = { 0x3Au, 0x1Au, 0x52u };
+    static const uint8_t frame_b[2] = { 0x0Du, 0x0Au };
+    static const uint8_t app[4] = { 0x55u, 0x30u, 0x00u, 0xCFu };
+
+    bus_session_start();
+    bus_session_on_buttons(0u);
+    bus_session_on_adc(0u, 2000u);
+    run_ms(10u);
+    /* One burst: bytes a millisecond apart share a record. */
+    bus_session_rx(BUS_MOTOR, frame_a, sizeof(frame_a));
+    run_ms(1u);
+    bus_session_rx(BUS_MOTOR, frame_b, sizeof(frame_b));
+    run_ms(20u);
+    bus_session_rx(BUS_BLE, app, sizeof(app));
+    bus_session_on_buttons(0x02u);
+    bus_session_on_buttons(0x02u);   /* unchanged: not recorded */
+    bus_session_on_adc(0u, 2002u);   /* within the delta: not recorded */
+    run_ms(BUS_SESSION_ADC_PERIOD_MS);
+    bus_session_on_adc(0u, 2002u);   /* a period later it is */
+    bus_session_stop();
+
+    bus_session_info_t info;
+    bus_session_get_info(&info);
+    ASSERT_TRUE(info.state == BUS_SESSION_DONE && info.records == 6u && info.dropped == 0u);
+
+    sim_session_t s;
+    ASSERT_TRUE(sim_session_parse(&s, s_flash, sizeof(s_flash)));
+    ASSERT_TRUE(s.records == 6u && s.flags == 0u);
+    ASSERT_TRUE(s.end_ms == 10u + 1u + 20u + BUS_SESSION_ADC_PERIOD_MS);
+
+    bus_capture_record_t r;
+    ASSERT_TRUE(sim_session_pop_due(&s, 0u, &r) && r.bus_id == BUS_SESSION_BUTTONS && r.data[0] == 0u);
+    ASSERT_TRUE(sim_session_pop_due(&s, 0u, &r) && r.bus_id == BUS_SESSION_ADC && r.len == 3u);
+    ASSERT_TRUE(r.data[0] == 0u && r.data[1] == (2000u >> 8) && r.data[2] == (2000u & 0xFFu));
+    /* The burst is stamped with its last byte. */
+    ASSERT_TRUE(!sim_session_pop_due(&s, 10u, &r));
+    ASSERT_TRUE(sim_session_pop_due(&s, 11u, &r) && r.bus_id == BUS_MOTOR && r.len == 5u);
+    ASSERT_TRUE(memcmp(r.data, frame_a, 3u) == 0 && memcmp(&r.data[3], frame_b, 2u) == 0);
+    ASSERT_TRUE(!sim_session_pop_due(&s, 30u, &r));
+    ASSERT_TRUE(sim_session_pop_due(&s, 31u, &r) && r.bus_id == BUS_BLE && r.len == 4u);
+    ASSERT_TRUE(sim_session_pop_due(&s, 31u, &r) && r.bus_id == BUS_SESSION_BUTTONS && r.data[0] == 0x02u);
+    ASSERT_TRUE(sim_session_pop_due(&s, s.end_ms, &r) && r.bus_id == BUS_SESSION_ADC);
+    ASSERT_TRUE(!sim_session_pop_due(&s, 0xFFFFFFFFu, &r));
+    sim_session_free(&s);
+}
+
+TEST(bursts_split_on_gaps_and_record_size)
+{
+    uint8_t bytes[BUS_CAPTURE_MAX_DATA + 8u];
+    for (uint32_t i = 0; i < sizeof(bytes); ++i)
+        bytes[i] = (uint8_t)i;
+
+    bus_session_start();
+    bus_session_rx(BUS_MOTOR, bytes, sizeof(bytes));
+    bus_session_rx(BUS_BLE, bytes, 1u);
+    run_ms(BUS_SESSION_BURST_MS + 1u);
+    bus_session_rx(BUS_BLE, bytes, 1u);
+    bus_session_stop();
+
+    sim_session_t s;
+    ASSERT_TRUE(sim_session_parse(&s, s_flash, sizeof(s_flash)));
+    bus_capture_record_t r;
+    ASSERT_TRUE(sim_session_pop_due(&s, 0u, &r) && r.bus_id == BUS_MOTOR && r.len == BUS_CAPTURE_MAX_DATA);
+    ASSERT_TRUE(sim_session_pop_due(&s, 0u, &r) && r.bus_id == BUS_MOTOR && r.len == 8u);
+    ASSERT_TRUE(r.data[0] == BUS_CAPTURE_MAX_DATA);
+    ASSERT_TRUE(sim_session_pop_due(&s, 0u, &r) && r.bus_id == BUS_BLE && r.len == 1u);
+    ASSERT_TRUE(sim_session_pop_due(&s, BUS_SESSION_BURST_MS + 1u, &r) && r.bus_id == BUS_BLE);
+    ASSERT_TRUE(s.records == 4u);
+    sim_session_free(&s);
+}
+
+TEST(full_queue_drops_and_full_region_stops)
+{
+    uint8_t b = 0x5Au;
+    bus_session_start();
+    /* No tick runs: the RAM queue fills, the rest is counted. */
+    for (uint32_t i = 0; i < 40u; ++i)
+        bus_session_on_adc(0u, (uint16_t)(i * 100u));
+    bus_session_info_t info;
+    bus_session_get_info(&info);
+    ASSERT_TRUE(info.dropped == 40u - 32u);
+
+    /* Once the queue drains, records of 4 + 32 bytes until the region is
+     * out of room. */
+    run_ms(BUS_SESSION_BURST_MS + 1u);
+    uint8_t bytes[BUS_CAPTURE_MAX_DATA];
+    memset(bytes, b, sizeof(bytes));
+    for (uint32_t i = 0; i < BUS_SESSION_STORAGE_BYTES / 16u; ++i)
+    {
+        bus_session_rx((uint8_t)(i & 1u), bytes, sizeof(bytes));
+        run_ms(1u);
+        bus_session_get_info(&info);
+        if (info.state != BUS_SESSION_RECORDING)
+            break;
+    }
+    ASSERT_TRUE(info.state == BUS_SESSION_DONE && (info.flags & BUS_SESSION_F_FULL));
+    ASSERT_TRUE(info.bytes <= BUS_SESSION_STORAGE_BYTES - BUS_SESSION_HEADER_BYTES);
+
+    sim_session_t s;
+    ASSERT_TRUE(sim_session_parse(&s, s_flash, sizeof(s_flash)));
+    ASSERT_TRUE(s.records == info.records && s.dropped == 8u && (s.flags & BUS_SESSION_F_FULL));
+    sim_session_free(&s);
+}
+
+TEST(unfinished_or_corrupt_sessions_are_rejected)
+{
+    static const uint8_t frame[4] = { 1u, 2u, 3u, 4u };
+    bus_session_start();
+    bus_session_rx(BUS_MOTOR, frame, sizeof(frame));
+    run_ms(BUS_SESSION_BURST_MS + 2u);
+
+    /* Not stopped: the header is still erased. */
+    sim_session_t s;
+    memset(s_flash, 0xFF, BUS_SESSION_HEADER_BYTES);
+    ASSERT_TRUE(!sim_session_parse(&s, s_flash, sizeof(s_flash)));
+
+    bus_session_stop();
+    ASSERT_TRUE(sim_session_parse(&s, s_flash, sizeof(s_flash)));
+    sim_session_free(&s);
+
+    s_flash[BUS_SESSION_HEADER_BYTES + BUS_REPLAY_RECORD_HEADER_BYTES] ^= 0x01u;
+    ASSERT_TRUE(!sim_session_parse(&s, s_flash, sizeof(s_flash)));
+}
+
+int main(void)
+{
+    printf("\nBus Session Unit Tests\n");
+    printf("======================\n\n");
+
+    RUN_TEST(records_replay_with_their_timing);
+    RUN_TEST(bursts_split_on_gaps_and_record_size);
+    RUN_TEST(full_queue_drops_and_full_region_stops);
+    RUN_TEST(unfinished_or_corrupt_sessions_are_rejected);
+
+    printf("\n");
+    printf("======================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("======================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
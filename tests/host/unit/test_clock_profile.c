@@ -0,0 +1,99 @@
+/*
+ * Unit Tests for parked clock scaling (profile choice and switch counts).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "src/power/clock_profile.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    clock_profile_reset(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define PROFILE_FULL 0u
+#define PROFILE_LOW  1u
+
+/* Ticks at the 5 ms motor slot from t to t + span with a fixed input. */
+static uint32_t run(uint32_t t, uint32_t span, uint8_t active)
+{
+    for (uint32_t n = span / 5u; n; --n, t += 5u)
+        clock_profile_tick(t, active);
+    return t;
+}
+
+TEST(parks_after_the_delay_and_wakes_at_once)
+{
+    uint32_t t = run(1000u, 2000u, 1u);
+    ASSERT_TRUE(clock_profile_current() == PROFILE_FULL);
+
+    /* Standing still: full speed until the park delay has run out. */
+    t = run(t, CLOCK_PROFILE_PARK_MS - 5u, 0u);
+    ASSERT_TRUE(clock_profile_current() == PROFILE_FULL);
+    t = run(t, 10u, 0u);
+    ASSERT_TRUE(clock_profile_current() == PROFILE_LOW);
+
+    /* One active tick (motion, a press, a BLE connection) is enough. */
+    t = run(t, 3000u, 0u);
+    clock_profile_tick(t, 1u);
+    ASSERT_TRUE(clock_profile_current() == PROFILE_FULL);
+
+    clock_profile_stats_t st;
+    clock_profile_get_stats(&st);
+    ASSERT_TRUE(st.to_low == 1u && st.to_full == 1u);
+    ASSERT_TRUE(st.low_ms >= 3000u && st.low_ms <= 3010u);
+}
+
+TEST(activity_restarts_the_park_delay)
+{
+    /* A press every 8 s never lets the delay run out. */
+    uint32_t t = 0u;
+    for (int i = 0; i < 5; ++i)
+    {
+        t = run(t, 8000u, 0u);
+        clock_profile_tick(t, 1u);
+    }
+    ASSERT_TRUE(clock_profile_current() == PROFILE_FULL);
+    clock_profile_stats_t st;
+    clock_profile_get_stats(&st);
+    ASSERT_TRUE(st.to_low == 0u);
+
+    /* The first tick after boot starts the delay; g_ms wrap is harmless. */
+    clock_profile_reset();
+    t = run(0xFFFFF000u, CLOCK_PROFILE_PARK_MS + 100u, 0u);
+    ASSERT_TRUE(clock_profile_current() == PROFILE_LOW);
+}
+
+int main(void)
+{
+    printf("\nClock Profile Unit Tests\n");
+    printf("========================\n\n");
+
+    RUN_TEST(parks_after_the_delay_and_wakes_at_once);
+    RUN_TEST(activity_restarts_the_park_delay);
+
+    printf("\n");
+    printf("========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -4,7 +4,10 @@
 
 #include "comm_proto.h"
 #include "core.h"
+#include "quantile.h"
 #include "core/math_util.h"
+#include "core/speed_filter.h"
+#include "core/trace_format.h"
 
 static int g_failures = 0;
 
@@ -43,6 +46,9 @@ static void test_fxp_helpers(void)
 
     /* 1.0 m/s (x1000) should be about 2.236 mph => ~22 deci-mph (rounded). */
     assert_eq_i32(fxp_mps1000_to_dmph(1000), 2237, "mps->deci-mph scaling");
+    assert_eq_i32(fxp_mps1000_to_dmph(-1000), -2236, "mps->deci-mph negative");
+    assert_eq_i32(fxp_mps1000_to_dmph(14648), 32767, "mps->deci-mph top of range");
+    assert_eq_i32(fxp_mps1000_to_dmph(2000000), INT16_MAX, "mps->deci-mph saturates");
 
     {
         fxp_point_t pts[] = {{0, 0}, {10, 100}, {20, 200}};
@@ -80,6 +86,303 @@ static void test_ringbuf_minmax(void)
     assert_eq_u16(s.latest, 9, "ringbuf latest after wrap");
 }
 
+static void test_ringbuf_push_n(void)
+{
+    int16_t src[40];
+    int16_t sa[8], sb[8];
+    uint16_t amin[8], amax[8], bmin[8], bmax[8];
+    ringbuf_i16_t a, b;
+    ringbuf_i16_summary_t x, y;
+    uint32_t seed = 7u;
+
+    for (int i = 0; i < 40; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        src[i] = (int16_t)((seed >> 16) % 9u) - 4;  /* small range: plenty of ties */
+    }
+    ringbuf_i16_init(&a, sa, 8, amin, amax);
+    ringbuf_i16_init(&b, sb, 8, bmin, bmax);
+    for (int i = 0; i < 3; ++i)
+        ringbuf_i16_push(&a, src[i]);
+    ringbuf_i16_push_n(&b, src, 3);
+
+    /* Bulk refill past capacity, then single pushes must evict identically. */
+    for (int i = 3; i < 30; ++i)
+        ringbuf_i16_push(&a, src[i]);
+    ringbuf_i16_push_n(&b, &src[3], 27);
+    for (int i = 30; i < 40; ++i)
+    {
+        ringbuf_i16_summary(&a, &x);
+        ringbuf_i16_summary(&b, &y);
+        assert_eq_u16(y.count, x.count, "push_n count");
+        assert_eq_i32(y.min, x.min, "push_n min");
+        assert_eq_i32(y.max, x.max, "push_n max");
+        assert_eq_i32(y.latest, x.latest, "push_n latest");
+        ringbuf_i16_push(&a, src[i]);
+        ringbuf_i16_push(&b, src[i]);
+    }
+}
+
+static void test_dring_window(void)
+{
+    int16_t src[200];
+    dring_block_t blocks[4];
+    uint16_t mn_idx[4], mx_idx[4];
+    dring_i16_t r;
+    ringbuf_i16_summary_t s;
+    int16_t v = 0;
+    uint32_t seed = 11u;
+
+    for (int i = 0; i < 200; ++i)
+    {
+        seed = seed * 1103515245u + 12345u;
+        /* Random walk: every step fits a delta, so decoding is exact. */
+        src[i] = (int16_t)((i ? src[i - 1] : 200) + (int)((seed >> 16) % 201u) - 100);
+    }
+    dring_i16_init(&r, blocks, 4, mn_idx, mx_idx);
+    dring_i16_summary(&r, &s);
+    assert_eq_u16(s.capacity, 63, "dring capacity");
+    assert_eq_u16(s.count, 0, "dring empty");
+    assert_eq_i32(!dring_i16_sample(&r, 0, &v), 1, "dring empty sample");
+
+    for (int i = 0; i < 200; ++i)
+    {
+        dring_i16_push(&r, src[i]);
+        dring_i16_summary(&r, &s);
+        /* Whole blocks drop out: 3 completed plus the open one. */
+        int n = (i + 1 <= 63) ? i + 1 : 48 + (i + 1) % 16;
+        int16_t bmin = src[i], bmax = src[i];
+        for (int k = i + 1 - n; k <= i; ++k)
+        {
+            if (src[k] < bmin)
+                bmin = src[k];
+            if (src[k] > bmax)
+                bmax = src[k];
+        }
+        assert_eq_u16(s.count, (uint16_t)n, "dring count");
+        assert_eq_i32(s.min, bmin, "dring min");
+        assert_eq_i32(s.max, bmax, "dring max");
+        assert_eq_i32(s.latest, src[i], "dring latest");
+    }
+    for (uint16_t back = 0; back < s.count; ++back)
+    {
+        assert_eq_i32(dring_i16_sample(&r, back, &v), 1, "dring sample in range");
+        assert_eq_i32(v, src[199 - back], "dring sample decode");
+    }
+    assert_eq_i32(!dring_i16_sample(&r, s.count, &v), 1, "dring sample past window");
+
+    /* A jump wider than a delta is spread over the next samples; min/max
+     * stay exact regardless. */
+    dring_i16_reset(&r);
+    dring_i16_push(&r, 0);
+    dring_i16_push(&r, 300);
+    dring_i16_push(&r, 300);
+    dring_i16_push(&r, 300);
+    dring_i16_summary(&r, &s);
+    assert_eq_i32(s.max, 300, "dring jump max");
+    assert_eq_i32(dring_i16_sample(&r, 2, &v) && v == 127, 1, "dring jump clamped");
+    assert_eq_i32(dring_i16_sample(&r, 0, &v) && v == 300, 1, "dring jump converged");
+}
+
+static void test_fxp_lut(void)
+{
+    static const fxp_point_t speed[6] = {
+        {   0, 120 }, {  50, 180 }, { 100, 260 },
+        { 150, 360 }, { 200, 450 }, { 250, 550 },
+    };
+    static const fxp_point_t cadence[3] = {
+        {  60, 32768 }, {  90, 32768 }, { 120, 24576 },
+    };
+    fxp_lut_t lut;
+
+    /* Span 250 needs 4-wide bins; only bins straddling a breakpoint deviate. */
+    fxp_lut_from_points(&lut, speed, 6, 0);
+    assert_eq_u8(lut.shift, 2, "lut shift");
+    int32_t worst = 0;
+    for (int32_t x = -10; x <= 300; ++x)
+    {
+        int32_t d = fxp_lut_eval(&lut, x) - fxp_interp_linear(x, speed, 6);
+        if (d < 0)
+            d = -d;
+        if (d > worst)
+            worst = d;
+        if (x <= 0 || x >= 250 || (x % 4) == 0)
+            assert_eq_i32(d, 0, "lut exact at nodes and ends");
+    }
+    assert_eq_i32(worst <= 1, 1, "lut chord error");
+
+    /* A span that fits the bins is exact everywhere. */
+    fxp_lut_from_points(&lut, cadence, 3, 32768);
+    assert_eq_u8(lut.shift, 0, "lut unit step");
+    for (int32_t x = 40; x <= 140; ++x)
+        assert_eq_i32(fxp_lut_eval(&lut, x), fxp_interp_linear(x, cadence, 3), "lut unit step exact");
+
+    fxp_lut_from_points(&lut, NULL, 0, 32768);
+    assert_eq_i32(fxp_lut_eval(&lut, -5), 32768, "lut empty low");
+    assert_eq_i32(fxp_lut_eval(&lut, 500), 32768, "lut empty high");
+}
+
+static void test_pyramid_cascade(void)
+{
+    static const uint8_t factors[3] = {1u, 2u, 3u};
+    pyramid_cell_t cells[3 * 4];
+    pyramid_i16_t p;
+    pyramid_i16_summary_t s;
+
+    pyramid_i16_init(&p, cells, 4, 3, factors);
+
+    /* Level 0 cell: min/max/mean of the raw samples in the period. */
+    pyramid_i16_add(&p, 10);
+    pyramid_i16_add(&p, -2);
+    pyramid_i16_add(&p, 4);
+    pyramid_i16_commit(&p);
+    pyramid_i16_summary(&p, 0, 4, &s);
+    assert_eq_u16(s.count, 1, "pyramid l0 count");
+    assert_eq_i32(s.min, -2, "pyramid l0 min");
+    assert_eq_i32(s.max, 10, "pyramid l0 max");
+    assert_eq_i32(s.mean, 4, "pyramid l0 mean");
+    assert_eq_i32(s.latest, 4, "pyramid latest");
+
+    /* An empty period repeats the latest value; two l0 cells make one l1. */
+    pyramid_i16_commit(&p);
+    pyramid_i16_summary(&p, 1, 4, &s);
+    assert_eq_u16(s.count, 1, "pyramid l1 count");
+    assert_eq_i32(s.min, -2, "pyramid l1 min");
+    assert_eq_i32(s.max, 10, "pyramid l1 max");
+    assert_eq_i32(s.mean, 4, "pyramid l1 mean");
+
+    /* Six l0 cells make one l2 cell; the 7th sample sits in partial cells. */
+    for (int i = 0; i < 4; ++i)
+    {
+        pyramid_i16_add(&p, 20);
+        pyramid_i16_commit(&p);
+    }
+    pyramid_i16_add(&p, 50);
+    pyramid_i16_summary(&p, 2, 1, &s);
+    assert_eq_u16(s.count, 1, "pyramid l2 partial only");
+    assert_eq_i32(s.max, 50, "pyramid l2 sees unfolded l0 sample");
+    pyramid_i16_summary(&p, 2, 2, &s);
+    assert_eq_u16(s.count, 2, "pyramid l2 count");
+    assert_eq_i32(s.min, -2, "pyramid l2 min");
+    assert_eq_i32(s.max, 50, "pyramid l2 max");
+
+    /* The ring keeps the newest cap cells per level. */
+    for (int i = 0; i < 8; ++i)
+    {
+        pyramid_i16_add(&p, 7);
+        pyramid_i16_commit(&p);
+    }
+    pyramid_i16_summary(&p, 0, 4, &s);
+    assert_eq_u16(s.count, 4, "pyramid l0 ring count");
+    assert_eq_i32(s.min, 7, "pyramid l0 ring min");
+    assert_eq_i32(s.max, 7, "pyramid l0 ring max");
+}
+
+static void test_pyramid_columns(void)
+{
+    static const uint8_t factors[1] = {1u};
+    pyramid_cell_t cells[8];
+    pyramid_i16_t p;
+    int16_t mn[16];
+    int16_t mx[16];
+    uint32_t pos = 0u;
+
+    pyramid_i16_init(&p, cells, 8, 1, factors);
+    assert_eq_u16(pyramid_i16_columns(&p, 0, 8, 4, mn, mx, &pos), 0, "columns empty");
+
+    /* A one-sample spike in a long window stays in its column's max. */
+    for (int i = 0; i < 8; ++i)
+    {
+        pyramid_i16_add(&p, (i == 5) ? 90 : 10);
+        pyramid_i16_add(&p, (i == 2) ? -30 : 10);
+        pyramid_i16_commit(&p);
+    }
+    assert_eq_u16(pyramid_i16_columns(&p, 0, 8, 4, mn, mx, &pos), 4, "columns full");
+    assert_eq_i32((int32_t)pos, 3, "newest column number");
+    assert_eq_i32(mn[1], -30, "column keeps dip");
+    assert_eq_i32(mx[2], 90, "column keeps spike");
+    assert_eq_i32(mx[0], 10, "column without spike");
+    assert_eq_i32(mx[3], 10, "newest column");
+
+    /* More columns than cells: cells repeat; a short history fills the
+     * newest columns only. */
+    pyramid_i16_reset(&p);
+    pyramid_i16_add(&p, 3);
+    pyramid_i16_commit(&p);
+    pyramid_i16_add(&p, 4);
+    assert_eq_u16(pyramid_i16_columns(&p, 0, 8, 16, mn, mx, &pos), 4, "columns short history");
+    assert_eq_i32(mx[0], 3, "oldest cell first");
+    assert_eq_i32(mx[1], 3, "cell spans two columns");
+    assert_eq_i32(mx[3], 4, "partial cell newest");
+    assert_eq_i32((int32_t)pos, 3, "short history column number");
+
+    /* Column numbers stick to their cells as the window slides. */
+    for (int i = 0; i < 8; ++i)
+    {
+        pyramid_i16_add(&p, (int16_t)(10 + i));
+        pyramid_i16_commit(&p);
+    }
+    assert_eq_u16(pyramid_i16_columns(&p, 0, 8, 16, mn, mx, &pos), 16, "columns slid");
+    assert_eq_i32((int32_t)pos, 17, "slid column number");
+    assert_eq_i32(mx[15], 17, "newest cell last");
+    assert_eq_i32(mn[0], 4, "oldest cell after slide");
+}
+
+static void test_pyramid_cells(void)
+{
+    static const uint8_t factors[1] = {1u};
+    pyramid_cell_t cells[4];
+    pyramid_cell_t out[8];
+    pyramid_i16_t p;
+    uint32_t first = 0xFFu;
+
+    pyramid_i16_init(&p, cells, 4, 1, factors);
+    assert_eq_u16(pyramid_i16_cells(&p, 0, 0, 8, out, &first), 0, "cells empty");
+    assert_eq_i32((int32_t)first, 0, "cells empty first");
+
+    /* The partial cell is not exported; closed cells by absolute number. */
+    for (int i = 0; i < 6; ++i)
+    {
+        pyramid_i16_add(&p, (int16_t)(i * 10));
+        pyramid_i16_commit(&p);
+    }
+    pyramid_i16_add(&p, 99);
+    assert_eq_u16(pyramid_i16_cells(&p, 0, 0, 8, out, &first), 4, "cells ring held");
+    assert_eq_i32((int32_t)first, 2, "cells clamp to oldest held");
+    assert_eq_i32(out[0].mean, 20, "cells oldest first");
+    assert_eq_i32(out[3].max, 50, "cells newest closed");
+    assert_eq_u16(pyramid_i16_cells(&p, 0, 4, 1, out, &first), 1, "cells limited");
+    assert_eq_i32(out[0].min, 40, "cells from first");
+    assert_eq_u16(pyramid_i16_cells(&p, 0, 6, 8, out, &first), 0, "cells at head");
+}
+
+static void test_qhist_quantiles(void)
+{
+    qhist_t h;
+    qhist_reset(&h);
+    assert_eq_u16(qhist_quantile(&h, 500), 0, "qhist empty");
+
+    /* Small values are exact. */
+    for (uint16_t v = 1; v <= 10; ++v)
+        qhist_add(&h, v, 1u);
+    assert_eq_u16(qhist_quantile(&h, 500), 5, "qhist linear p50");
+    assert_eq_u16(qhist_quantile(&h, 1000), 10, "qhist max");
+
+    /* Time weighting: 90% at 200 W, 10% at 1200 W. */
+    qhist_reset(&h);
+    qhist_add(&h, 200, 9000u);
+    qhist_add(&h, 1200, 1000u);
+    uint16_t p50 = qhist_quantile(&h, 500);
+    uint16_t p95 = qhist_quantile(&h, 950);
+    assert_eq_i32(p50 >= 192 && p50 <= 208, 1, "qhist p50 within bin");
+    assert_eq_i32(p95 >= 1152 && p95 <= 1200, 1, "qhist p95 within bin");
+
+    /* Out-of-range samples pin to the top bin but keep the true max. */
+    qhist_add(&h, 60000u, 1u);
+    assert_eq_u16(h.max, 60000u, "qhist keeps max");
+    assert_eq_u16(qhist_quantile(&h, 1000), 60000u, "qhist p100 is max");
+}
+
 static void test_comm_checksum(void)
 {
     uint8_t frame1[] = {COMM_SOF, 0x01u, 0x00u};
@@ -206,6 +509,38 @@ static void test_comm_parser_ignores_noise(void)
     assert_eq_u8(len_io, 0u, "parser noise len_io");
 }
 
+static void test_comm_framer_feed(void)
+{
+    uint8_t out[8];
+    uint8_t payload[2] = {0x42u, COMM_SOF};
+    size_t len = comm_frame_build(out, sizeof(out), 0x22u, payload, sizeof(payload));
+    uint8_t buf[COMM_MAX_PAYLOAD + 4u] = {0};
+    comm_framer_t f = {0};
+    comm_parse_result_t res = COMM_PARSE_NONE;
+
+    assert_eq_i32(comm_framer_feed(&f, buf, COMM_MAX_PAYLOAD, 'T'), COMM_PARSE_NONE, "framer text");
+    assert_eq_u8(f.pos, 0u, "framer hunting");
+    for (size_t i = 0; i < len; ++i)
+    {
+        res = comm_framer_feed(&f, buf, COMM_MAX_PAYLOAD, out[i]);
+        if (i + 1u < len)
+            assert_eq_i32(res, COMM_PARSE_NONE, "framer mid-frame");
+    }
+    assert_eq_i32(res, COMM_PARSE_FRAME, "framer frame");
+    assert_eq_i32(memcmp(buf, out, len), 0, "framer frame bytes");
+    assert_eq_u8(f.pos, 0u, "framer reset");
+
+    out[len - 1u] ^= 0x01u;
+    for (size_t i = 0; i < len; ++i)
+        res = comm_framer_feed(&f, buf, COMM_MAX_PAYLOAD, out[i]);
+    assert_eq_i32(res, COMM_PARSE_ERROR, "framer bad checksum");
+
+    comm_framer_feed(&f, buf, 1u, COMM_SOF);
+    comm_framer_feed(&f, buf, 1u, 0x10u);
+    assert_eq_i32(comm_framer_feed(&f, buf, 1u, 0x05u), COMM_PARSE_ERROR, "framer oversize");
+    assert_eq_u8(f.pos, 0u, "framer oversize reset");
+}
+
 static void test_clamp_helpers(void)
 {
     assert_eq_u16(clamp_q15(0u, 10u, 20u), 10u, "clamp_q15 low");
@@ -213,17 +548,162 @@ static void test_clamp_helpers(void)
     assert_eq_u16(clamp_q15(15u, 10u, 20u), 15u, "clamp_q15 mid");
 }
 
+static uint64_t div_rand(uint64_t *s)
+{
+    *s ^= *s << 13;
+    *s ^= *s >> 7;
+    *s ^= *s << 17;
+    return *s;
+}
+
+/* The UDIV-step divider against the host's 64-bit divide, across divisor
+ * widths and the normalization edges. */
+static void test_div64(void)
+{
+    static const uint64_t edges[] = {
+        1u, 2u, 3u, 0xFFFFu, 0x10000u, 0x7FFFFFFFu, 0x80000000u, 0xFFFFFFFFu,
+        0x100000000ull, 0x100000001ull, 0x7FFFFFFFFFFFFFFFull, 0x8000000000000000ull,
+        0xFFFFFFFFFFFFFFFFull, 0xFFFFFFFF00000000ull, 0x8000000080000000ull,
+    };
+    const size_t n_edges = sizeof(edges) / sizeof(edges[0]);
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    int bad = 0;
+
+    for (uint32_t i = 0; i < 200000u && !bad; ++i)
+    {
+        uint64_t n = div_rand(&seed);
+        uint64_t d = div_rand(&seed) >> (i % 64u);
+        if (i < n_edges * n_edges)
+        {
+            n = edges[i / n_edges];
+            d = edges[i % n_edges];
+        }
+        if (d == 0u)
+            d = 1u;
+        uint64_t r;
+        uint64_t q = div64_u64(n, d, &r);
+        if (q != n / d || r != n % d)
+        {
+            fprintf(stderr, "FAIL: div64_u64 %llu / %llu\n", (unsigned long long)n, (unsigned long long)d);
+            bad = 1;
+        }
+        uint32_t d32 = (uint32_t)d ? (uint32_t)d : 1u;
+        if (divu64_32(n, d32) != (uint32_t)(n / d32))
+        {
+            fprintf(stderr, "FAIL: divu64_32 %llu / %u\n", (unsigned long long)n, d32);
+            bad = 1;
+        }
+    }
+    g_failures += bad;
+    assert_eq_i32((int32_t)divu64_32(5u, 0u), (int32_t)0xFFFFFFFFu, "divu64_32 by zero");
+}
+
+static void test_speed_filters(void)
+{
+    speed_conv_t conv = {0};
+    speed_conv_set_wheel(&conv, 2100u);
+    /* 2100 mm in 500 ms = 15.12 kph = 9.39 mph. */
+    assert_eq_u16(speed_conv_dmph(&conv, 500u), 94u, "speed_conv 2100mm/500ms");
+    assert_eq_u16(speed_conv_dmph(&conv, 0u), 0u, "speed_conv zero period");
+
+    speed_iir_t iir;
+    speed_iir_reset(&iir, 0u);
+    uint16_t y = 0u;
+    for (int i = 0; i < 40; ++i)
+        y = speed_iir_update(&iir, 200u, SPEED_FILTER_RATE_10HZ);
+    /* The OEM delta/5 ramp stalled at target-4; the Q8 state converges. */
+    assert_eq_u16(y, 200u, "iir converges");
+    speed_iir_reset(&iir, 3u);
+    assert_eq_u16(speed_iir_update(&iir, 0u, SPEED_FILTER_RATE_10HZ), 2u, "iir decays");
+    speed_iir_reset(&iir, 0u);
+    assert_eq_u16(speed_iir_update(&iir, 0u, SPEED_FILTER_RATE_10HZ), 0u, "iir zero snap");
+
+    /* Tracker follows a ramp with less lag than the IIR at the same rate. */
+    speed_ab_t ab;
+    speed_ab_reset(&ab);
+    speed_iir_reset(&iir, 100u);
+    uint16_t ab_out = 0u;
+    for (uint16_t i = 0; i < 30u; ++i)
+    {
+        uint16_t x = (uint16_t)(100u + 5u * i);
+        ab_out = speed_ab_update(&ab, x, SPEED_FILTER_RATE_10HZ);
+        y = speed_iir_update(&iir, x, SPEED_FILTER_RATE_10HZ);
+    }
+    assert_eq_i32(ab_out > y, 1, "tracker leads iir on ramp");
+    assert_eq_i32(ab_out >= 240u && ab_out <= 250u, 1, "tracker near ramp");
+    assert_eq_u16(speed_ab_update(&ab, 0u, SPEED_FILTER_RATE_10HZ), 0u, "tracker zero snap");
+
+    assert_eq_i32(speed_filter_rate_for_interval_ms(50u), SPEED_FILTER_RATE_20HZ, "rate 50ms");
+    assert_eq_i32(speed_filter_rate_for_interval_ms(100u), SPEED_FILTER_RATE_10HZ, "rate 100ms");
+    assert_eq_i32(speed_filter_rate_for_interval_ms(250u), SPEED_FILTER_RATE_5HZ, "rate 250ms");
+}
+
+static void test_trace_format(void)
+{
+    /* Decimal against printf across digit-count edges and a sweep. */
+    int bad = 0;
+    uint32_t v = 0u;
+    for (uint32_t i = 0; i < 5000u; ++i)
+    {
+        char got[16];
+        char want[16];
+        char *p = got;
+        size_t rem = sizeof(got) - 1u;
+        append_u32(&p, &rem, v);
+        *p = 0;
+        snprintf(want, sizeof(want), "%lu", (unsigned long)v);
+        if (strcmp(got, want) != 0)
+        {
+            fprintf(stderr, "FAIL: append_u32 %s != %s\n", got, want);
+            bad = 1;
+        }
+        v = (i < 1000u) ? i + 1u : v * 7u + 13u;
+    }
+    g_failures += bad;
+
+    char buf[16];
+    char *p = buf;
+    size_t rem = 3u;
+    append_u32(&p, &rem, 4294967295u);
+    *p = 0;
+    assert_eq_i32(strcmp(buf, "429"), 0, "append_u32 keeps leading digits");
+    p = buf;
+    rem = 8u;
+    append_u32_pad(&p, &rem, 42u, 4u);
+    append_i32(&p, &rem, -2147483647 - 1);
+    *p = 0;
+    assert_eq_i32(strcmp(buf, "0042-214"), 0, "pad then truncated negative");
+    p = buf;
+    rem = 15u;
+    append_hex_u32(&p, &rem, 0xDEADBEEFu);
+    append_hex_u8_upper(&p, &rem, 0xa5u);
+    append_hex_u16(&p, &rem, 0x0F0Fu);
+    *p = 0;
+    assert_eq_i32(strcmp(buf, "deadbeefA50f0f"), 0, "hex digits");
+}
+
 int main(void)
 {
     test_fxp_helpers();
     test_ringbuf_minmax();
+    test_ringbuf_push_n();
+    test_dring_window();
+    test_fxp_lut();
+    test_pyramid_cascade();
+    test_pyramid_columns();
+    test_pyramid_cells();
+    test_qhist_quantiles();
     test_comm_checksum();
     test_comm_state_frame_v1();
     test_comm_frame_build_validate();
     test_comm_parser_feed();
+    test_comm_framer_feed();
     test_comm_parser_oversize();
     test_comm_parser_ignores_noise();
     test_clamp_helpers();
+    test_div64();
+    test_speed_filters();
+    test_trace_format();
 
     if (g_failures)
     {
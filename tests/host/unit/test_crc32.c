@@ -0,0 +1,105 @@
+/*
+ * Unit Tests for the table-driven CRC32 and its streaming wrapper.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "util/crc32.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* The bit-serial form the tables replace. */
+static uint32_t crc32_bitwise(uint32_t crc, const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; ++i)
+    {
+        crc ^= data[i];
+        for (int j = 0; j < 8; ++j)
+            crc = (crc >> 1) ^ (0xEDB88320u & (uint32_t)(-(int32_t)(crc & 1u)));
+    }
+    return crc;
+}
+
+TEST(check_value)
+{
+    const uint8_t msg[] = "123456789";
+    ASSERT_TRUE(crc32_compute(msg, 9u) == 0xCBF43926u);
+    ASSERT_TRUE(crc32_compute(msg, 0u) == 0x00000000u);
+}
+
+TEST(matches_bitwise_for_all_lengths_and_alignments)
+{
+    uint8_t buf[300];
+    uint32_t x = 0x12345678u;
+    for (size_t i = 0; i < sizeof(buf); ++i)
+    {
+        x = x * 1103515245u + 12345u;
+        buf[i] = (uint8_t)(x >> 16);
+    }
+    for (size_t off = 0; off < 4u; ++off)
+    {
+        for (size_t len = 0; len + off <= sizeof(buf); len += 7u)
+        {
+            uint32_t seed = 0xFFFFFFFFu ^ (uint32_t)len;
+            ASSERT_TRUE(crc32_update(seed, &buf[off], len) == crc32_bitwise(seed, &buf[off], len));
+        }
+    }
+}
+
+TEST(stream_equals_one_shot)
+{
+    uint8_t buf[1000];
+    for (size_t i = 0; i < sizeof(buf); ++i)
+        buf[i] = (uint8_t)(i * 31u + 7u);
+    crc32_stream_t s;
+    crc32_stream_begin(&s);
+    size_t pos = 0;
+    size_t step = 1;
+    while (pos < sizeof(buf))
+    {
+        size_t n = sizeof(buf) - pos < step ? sizeof(buf) - pos : step;
+        crc32_stream_feed(&s, &buf[pos], n);
+        pos += n;
+        step = step * 3u + 1u;
+    }
+    ASSERT_TRUE(s.bytes == sizeof(buf));
+    ASSERT_TRUE(crc32_stream_end(&s) == crc32_compute(buf, sizeof(buf)));
+}
+
+int main(void)
+{
+    printf("\nCRC32 Unit Tests\n");
+    printf("================\n\n");
+
+    RUN_TEST(check_value);
+    RUN_TEST(matches_bitwise_for_all_lengths_and_alignments);
+    RUN_TEST(stream_equals_one_shot);
+
+    printf("\n");
+    printf("================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,193 @@
+/*
+ * Unit Tests for cruise speed hold and its grade/load feed-forward.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include "src/motor/app_data.h"
+#include "src/control/control.h"
+#include "src/config/config.h"
+#include "src/power/power.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* Firmware globals owned by main.c, input.c and outputs.c. */
+volatile uint32_t g_ms;
+config_t g_config_active;
+uint8_t g_hw_caps;
+uint8_t g_input_caps;
+uint8_t g_button_short_press;
+uint16_t g_effective_cap_speed_dmph;
+
+bool motor_cmd_link_fault_active(void)
+{
+    return false;
+}
+
+void event_log_append(uint8_t type, uint8_t flags)
+{
+    (void)type;
+    (void)flags;
+}
+
+/* Plant: cargo bike + rider, motor power delivered as commanded. */
+#define PLANT_MASS_KG   150.0
+#define PLANT_CRR       0.008
+#define PLANT_CDA       0.6
+#define PLANT_RIDER_W   50.0        /* torque_raw 200 -> 50 W */
+#define TICK_MS         20u
+#define MPS_PER_DMPH    0.044704
+
+typedef struct {
+    double v_mps;
+    double grade;
+    uint16_t base_w;            /* assist request while cruise is off */
+    uint16_t applied_w;
+    uint32_t changes;
+    double min_mph;
+    double max_mph;
+} plant_t;
+
+static plant_t s_plant;
+
+static void setup(void)
+{
+    g_ms = 1000u;
+    g_inputs = (debug_inputs_t){0};
+    g_outputs = (debug_outputs_t){0};
+    cruise_reset();
+    s_plant = (plant_t){ .v_mps = 140.0 * MPS_PER_DMPH, .base_w = 120u };
+}
+
+static void stats_reset(void)
+{
+    s_plant.changes = 0u;
+    s_plant.min_mph = 1e9;
+    s_plant.max_mph = 0.0;
+}
+
+static void ride(uint32_t ms)
+{
+    for (uint32_t t = 0; t < ms; t += TICK_MS)
+    {
+        g_ms += TICK_MS;
+        g_inputs.speed_dmph = (uint16_t)(s_plant.v_mps / MPS_PER_DMPH + 0.5);
+        g_inputs.cadence_rpm = 70u;
+        g_inputs.torque_raw = 200u;
+        uint16_t out = cruise_apply(s_plant.base_w, 800u);
+        if (out != s_plant.applied_w)
+            s_plant.changes++;
+        s_plant.applied_w = out;
+        g_outputs.cmd_power_w = out;
+
+        double v = s_plant.v_mps;
+        double drive = (s_plant.applied_w + PLANT_RIDER_W) / v;
+        double load = PLANT_MASS_KG * 9.81 * (s_plant.grade + PLANT_CRR) + 0.5 * 1.2 * PLANT_CDA * v * v;
+        s_plant.v_mps += (drive - load) / PLANT_MASS_KG * (TICK_MS / 1000.0);
+        double mph = s_plant.v_mps / MPS_PER_DMPH / 10.0;
+        if (mph < s_plant.min_mph)
+            s_plant.min_mph = mph;
+        if (mph > s_plant.max_mph)
+            s_plant.max_mph = mph;
+    }
+}
+
+static double set_mph(void)
+{
+    return g_cruise.set_speed_dmph / 10.0;
+}
+
+static double err_mph(void)
+{
+    double e = g_inputs.speed_dmph / 10.0 - set_mph();
+    return (e < 0.0) ? -e : e;
+}
+
+/* Settle at the assist request, then engage speed cruise. */
+static void engage_speed_cruise(void)
+{
+    ride(30000u);
+    g_inputs.buttons = CRUISE_SPEED_SELECT_MASK;
+    g_cruise_toggle_request = 1u;
+    ride(TICK_MS);
+    g_inputs.buttons = 0u;
+}
+
+TEST(holds_speed_on_flat_without_hunting)
+{
+    engage_speed_cruise();
+    ASSERT_TRUE(g_cruise.mode == CRUISE_SPEED);
+    ride(10000u);
+    stats_reset();
+    ride(30000u);
+    ASSERT_TRUE(s_plant.min_mph > set_mph() - 0.3 && s_plant.max_mph < set_mph() + 0.3);
+    /* Settled: deadband and hysteresis hold the command still. */
+    ASSERT_TRUE(s_plant.changes < 5u);
+}
+
+TEST(feed_forward_carries_a_hill)
+{
+    engage_speed_cruise();
+    ride(30000u);
+
+    /* 6 % climb: ~5x the flat power. */
+    s_plant.grade = 0.06;
+    stats_reset();
+    ride(20000u);
+    ASSERT_TRUE(s_plant.min_mph > set_mph() - 0.9);
+    ASSERT_TRUE(s_plant.changes < 200u);
+    stats_reset();
+    ride(40000u);
+    ASSERT_TRUE(err_mph() < 0.3);
+    ASSERT_TRUE(s_plant.changes < 10u);
+    ASSERT_TRUE(g_cruise.ff_w > 400u);
+
+    /* Crest: overshoot stays small and the command winds back down. */
+    s_plant.grade = 0.0;
+    stats_reset();
+    ride(20000u);
+    ASSERT_TRUE(s_plant.max_mph < set_mph() + 0.9);
+    stats_reset();
+    ride(40000u);
+    ASSERT_TRUE(err_mph() < 0.3);
+    ASSERT_TRUE(s_plant.changes < 10u);
+    ASSERT_TRUE(s_plant.applied_w < 150u);
+}
+
+int main(void)
+{
+    printf("\nCruise Control Unit Tests\n");
+    printf("=========================\n\n");
+
+    RUN_TEST(holds_speed_on_flat_without_hunting);
+    RUN_TEST(feed_forward_carries_a_hill);
+
+    printf("\n");
+    printf("=========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("=========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
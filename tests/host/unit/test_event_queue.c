@@ -7,6 +7,8 @@
  *   - Wrap-around behavior
  *   - Drain functionality
  *   - Event creation helpers
+ *   - Event bus: lane priority, category dispatch, batching, overflow
+ *   - Deferred work queue: order, capacity, re-entrant posts
  */
 
 #include <stdio.h>
@@ -16,6 +18,8 @@
 
 #include "src/kernel/event.h"
 #include "src/kernel/event_queue.h"
+#include "src/kernel/event_bus.h"
+#include "src/kernel/work_queue.h"
 
 static int tests_passed = 0;
 static int tests_failed = 0;
@@ -290,6 +294,250 @@ TEST(queue_capacity)
     ASSERT_EQ(EVENT_QUEUE_CAPACITY, 32);
 }
 
+/*
+ * Event bus: subscribers record what they see
+ */
+static uint8_t bus_seen[64];
+static int bus_seen_count;
+static int bus_ctx_hits;
+
+static void bus_record(const event_t *evt, void *ctx)
+{
+    (void)ctx;
+    bus_seen[bus_seen_count++] = evt->type;
+}
+
+static void bus_count_ctx(const event_t *evt, void *ctx)
+{
+    (void)evt;
+    (*(int *)ctx)++;
+}
+
+static event_bus_t bus;
+
+TEST(bus_lane_priority_and_categories)
+{
+    event_bus_init(&bus);
+    bus_seen_count = 0;
+    bus_ctx_hits = 0;
+
+    ASSERT_TRUE(event_bus_subscribe(&bus, EVT_CAT_MOTOR, bus_record, NULL));
+    ASSERT_TRUE(event_bus_subscribe(&bus, EVT_CAT_BUTTON, bus_record, NULL));
+    ASSERT_TRUE(event_bus_subscribe(&bus, EVT_CAT_BUTTON, bus_count_ctx, &bus_ctx_hits));
+    /* Duplicate and overfull categories are refused */
+    ASSERT_TRUE(!event_bus_subscribe(&bus, EVT_CAT_MOTOR, bus_record, NULL));
+    ASSERT_TRUE(!event_bus_subscribe(&bus, EVT_CAT_BUTTON, bus_count_ctx, NULL));
+
+    event_t b = event_simple(EVT_BTN_PRESS, 1);
+    event_t m = event_simple(EVT_MOTOR_STATE, 2);
+    event_t u = event_simple(CMD_UI_REFRESH, 3);
+    ASSERT_TRUE(event_bus_publish(&bus, EVENT_LANE_INPUT, &b));
+    ASSERT_TRUE(event_bus_publish(&bus, EVENT_LANE_INPUT, &u));
+    ASSERT_TRUE(event_bus_publish(&bus, EVENT_LANE_MOTOR, &m));
+    ASSERT_TRUE(!event_bus_publish(&bus, EVENT_BUS_LANES, &m));
+    ASSERT_TRUE(event_bus_pending(&bus));
+
+    /* Motor lane first, then the input lane in FIFO order */
+    ASSERT_EQ(event_bus_dispatch(&bus, 0, 0), 3);
+    ASSERT_EQ(bus_seen_count, 2);
+    ASSERT_EQ(bus_seen[0], EVT_MOTOR_STATE);
+    ASSERT_EQ(bus_seen[1], EVT_BTN_PRESS);
+    ASSERT_EQ(bus_ctx_hits, 1);
+    ASSERT_EQ(bus.unhandled, 1);
+    ASSERT_TRUE(!event_bus_pending(&bus));
+
+    event_lane_stats_t st;
+    ASSERT_TRUE(event_bus_lane_stats(&bus, EVENT_LANE_INPUT, &st));
+    ASSERT_EQ(st.published, 2);
+    ASSERT_EQ(st.dispatched, 2);
+    ASSERT_EQ(st.queue.drops, 0);
+    ASSERT_TRUE(!event_bus_lane_stats(&bus, EVENT_BUS_LANES, &st));
+}
+
+TEST(bus_batch_and_overflow)
+{
+    event_bus_init(&bus);
+    bus_seen_count = 0;
+    event_bus_subscribe(&bus, EVT_CAT_MOTOR, bus_record, NULL);
+    event_bus_subscribe(&bus, EVT_CAT_BUTTON, bus_record, NULL);
+
+    event_t m = event_simple(EVT_MOTOR_STATE, 0);
+    for (uint32_t i = 0; i < EVENT_QUEUE_CAPACITY + 2u; i++) {
+        event_bus_publish(&bus, EVENT_LANE_MOTOR, &m);
+    }
+    event_lane_stats_t st;
+    event_bus_lane_stats(&bus, EVENT_LANE_MOTOR, &st);
+    ASSERT_EQ(st.published, EVENT_QUEUE_CAPACITY - 1u);
+    ASSERT_EQ(st.queue.drops, 3);
+    ASSERT_EQ(st.queue.hwm, EVENT_QUEUE_CAPACITY - 1u);
+
+    /* A batch limit leaves the rest queued; lower lanes wait for the motor backlog */
+    ASSERT_EQ(event_bus_dispatch(&bus, 4, 0), 4);
+    event_t b = event_simple(EVT_BTN_PRESS, 0);
+    event_bus_publish(&bus, EVENT_LANE_INPUT, &b);
+    ASSERT_EQ(event_bus_dispatch(&bus, 0, 0), EVENT_QUEUE_CAPACITY - 4u);
+    ASSERT_EQ(bus_seen[bus_seen_count - 1], EVT_BTN_PRESS);
+    ASSERT_TRUE(!event_bus_pending(&bus));
+}
+
+TEST(bus_dispatch_single_lane)
+{
+    event_bus_init(&bus);
+    bus_seen_count = 0;
+    event_bus_subscribe(&bus, EVT_CAT_MOTOR, bus_record, NULL);
+    event_bus_subscribe(&bus, EVT_CAT_BUTTON, bus_record, NULL);
+
+    event_t b = event_simple(EVT_BTN_PRESS, 0);
+    event_t m = event_simple(EVT_MOTOR_STATE, 0);
+    event_bus_publish(&bus, EVENT_LANE_INPUT, &b);
+    event_bus_publish(&bus, EVENT_LANE_MOTOR, &m);
+    event_bus_publish(&bus, EVENT_LANE_MOTOR, &m);
+
+    /* The input lane stays queued for the main-loop dispatch */
+    ASSERT_EQ(event_bus_dispatch_lane(&bus, EVENT_LANE_MOTOR, 1, 0), 1);
+    ASSERT_EQ(event_bus_dispatch_lane(&bus, EVENT_LANE_MOTOR, 0, 0), 1);
+    ASSERT_EQ(event_bus_dispatch_lane(&bus, EVENT_LANE_MOTOR, 0, 0), 0);
+    ASSERT_EQ(event_bus_dispatch_lane(&bus, EVENT_BUS_LANES, 0, 0), 0);
+    ASSERT_EQ(bus_seen_count, 2);
+    ASSERT_TRUE(event_bus_pending(&bus));
+    ASSERT_EQ(event_bus_dispatch(&bus, 0, 0), 1);
+    ASSERT_EQ(bus_seen[2], EVT_BTN_PRESS);
+}
+
+/*
+ * Test: High-water mark, drops and queueing latency
+ */
+TEST(queue_stats)
+{
+    event_queue_t q;
+    event_queue_init(&q);
+
+    event_t e0 = event_simple(EVT_MOTOR_STATE, 100);
+    event_t e1 = event_simple(EVT_MOTOR_STATE, 103);
+    event_t e2 = event_simple(EVT_MOTOR_STATE, 110);
+    event_queue_push(&q, &e0);
+    event_queue_push(&q, &e1);
+    event_queue_push(&q, &e2);
+
+    event_t out;
+    event_queue_pop(&q, &out);
+    event_queue_note_latency(&q, &out, 100);  /* 0 ms */
+    event_queue_pop(&q, &out);
+    event_queue_note_latency(&q, &out, 108);  /* 5 ms */
+    event_queue_pop(&q, &out);
+    event_queue_note_latency(&q, &out, 150);  /* 40 ms */
+    event_queue_push(&q, &e0);
+
+    event_queue_stats_t st;
+    event_queue_get_stats(&q, &st);
+    ASSERT_EQ(st.hwm, 3);
+    ASSERT_EQ(st.drops, 0);
+    ASSERT_EQ(st.lat_count, 3);
+    ASSERT_EQ(st.lat_max_ms, 40);
+    ASSERT_EQ(st.lat_sum_ms, 45);
+    ASSERT_EQ(st.lat_hist[0], 1);
+    ASSERT_EQ(st.lat_hist[1], 1);
+    ASSERT_EQ(st.lat_hist[2], 0);
+    ASSERT_EQ(st.lat_hist[3], 1);
+
+    /* Fill to capacity: the last push is dropped and counted */
+    for (uint32_t i = 0; i < EVENT_QUEUE_CAPACITY; i++) {
+        event_queue_push(&q, &e0);
+    }
+    event_queue_get_stats(&q, &st);
+    ASSERT_EQ(st.hwm, EVENT_QUEUE_CAPACITY - 1u);
+    ASSERT_EQ(st.drops, 2);
+
+    event_queue_reset_stats(&q);
+    event_queue_get_stats(&q, &st);
+    ASSERT_EQ(st.hwm, 0);
+    ASSERT_EQ(st.drops, 0);
+    ASSERT_EQ(st.lat_count, 0);
+}
+
+/*
+ * Deferred work: items recorded in run order
+ */
+static uint8_t work_log[WORK_QUEUE_CAPACITY * 2];
+static uint8_t work_log_len;
+static uint16_t work_nested_runs;
+
+static void work_record(void *ctx)
+{
+    work_log[work_log_len++] = (uint8_t)(uintptr_t)ctx;
+}
+
+/* Posts a follow-up and tries to drain from inside a running item. */
+static void work_chain(void *ctx)
+{
+    work_record(ctx);
+    work_queue_post(work_record, (void *)(uintptr_t)((uintptr_t)ctx + 100u));
+    work_nested_runs = work_queue_drain(0);
+}
+
+/*
+ * Test: FIFO order, full ring and statistics
+ */
+TEST(work_queue_order_and_capacity)
+{
+    work_queue_init();
+    work_log_len = 0;
+    ASSERT_EQ(work_queue_drain(0), 0);
+    ASSERT_TRUE(!work_queue_post(NULL, NULL));
+
+    /* Several laps so the per-cell sequence numbers wrap the ring. */
+    for (uint32_t lap = 0; lap < 3; lap++) {
+        for (uint32_t i = 0; i < WORK_QUEUE_CAPACITY; i++) {
+            ASSERT_TRUE(work_queue_post(work_record, (void *)(uintptr_t)i));
+        }
+        ASSERT_TRUE(!work_queue_post(work_record, (void *)0xFF));
+        ASSERT_EQ(work_queue_pending(), WORK_QUEUE_CAPACITY);
+
+        work_log_len = 0;
+        ASSERT_EQ(work_queue_drain(5), 5);
+        ASSERT_EQ(work_queue_pending(), WORK_QUEUE_CAPACITY - 5u);
+        ASSERT_EQ(work_queue_drain(0), WORK_QUEUE_CAPACITY - 5u);
+        ASSERT_EQ(work_log_len, WORK_QUEUE_CAPACITY);
+        for (uint32_t i = 0; i < WORK_QUEUE_CAPACITY; i++) {
+            ASSERT_EQ(work_log[i], i);
+        }
+    }
+
+    work_queue_stats_t st;
+    work_queue_get_stats(&st);
+    ASSERT_EQ(st.posted, 3u * WORK_QUEUE_CAPACITY);
+    ASSERT_EQ(st.runs, 3u * WORK_QUEUE_CAPACITY);
+    ASSERT_EQ(st.drops, 3);
+    ASSERT_EQ(st.hwm, WORK_QUEUE_CAPACITY);
+
+    work_queue_reset_stats();
+    work_queue_get_stats(&st);
+    ASSERT_EQ(st.posted, 0);
+    ASSERT_EQ(st.drops, 0);
+    ASSERT_EQ(st.hwm, 0);
+}
+
+/*
+ * Test: Work posted by a running item runs in the same drain; a nested
+ * drain (PendSV preempting the main loop) backs off
+ */
+TEST(work_queue_reentrant_post)
+{
+    work_queue_init();
+    work_log_len = 0;
+    work_nested_runs = 0xFFFF;
+
+    work_queue_post(work_chain, (void *)1);
+    work_queue_post(work_record, (void *)2);
+    ASSERT_EQ(work_queue_drain(0), 3);
+    ASSERT_EQ(work_nested_runs, 0);
+    ASSERT_EQ(work_log_len, 3);
+    ASSERT_EQ(work_log[0], 1);
+    ASSERT_EQ(work_log[1], 2);
+    ASSERT_EQ(work_log[2], 101);
+    ASSERT_EQ(work_queue_pending(), 0);
+}
+
 int main(void)
 {
     printf("Event Queue Tests\n");
@@ -306,6 +554,12 @@ int main(void)
     RUN_TEST(drain_all);
     RUN_TEST(event_size);
     RUN_TEST(queue_capacity);
+    RUN_TEST(queue_stats);
+    RUN_TEST(bus_lane_priority_and_categories);
+    RUN_TEST(bus_batch_and_overflow);
+    RUN_TEST(bus_dispatch_single_lane);
+    RUN_TEST(work_queue_order_and_capacity);
+    RUN_TEST(work_queue_reentrant_post);
 
     printf("\n");
     printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
@@ -0,0 +1,203 @@
+/*
+ * Unit Tests for the per-region SPI flash counters and their KV checkpoint.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "storage/flash_health.h"
+#include "storage/kv_store.h"
+#include "storage/layout.h"
+
+#define KV_BYTES (KV_STORAGE_SECTORS * SPI_FLASH_SECTOR_SIZE)
+
+static uint8_t s_flash[KV_BYTES];
+static uint32_t s_kv_programs;
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    memcpy(out, &s_flash[addr - KV_STORAGE_BASE], len);
+}
+
+void flash_jobs_erase(uint32_t addr)
+{
+    uint32_t off = (addr - KV_STORAGE_BASE) & ~(SPI_FLASH_SECTOR_SIZE - 1u);
+    memset(&s_flash[off], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+void flash_jobs_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[addr - KV_STORAGE_BASE + i] &= data[i];
+    s_kv_programs++;
+}
+
+void flash_jobs_flush(void) {}
+uint8_t flash_jobs_pending(void) { return 0u; }
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* A reboot: RAM counters gone, lifetime totals reloaded from the KV store. */
+static void reboot(void)
+{
+    flash_health_reset();
+    kv_init();
+    flash_health_init();
+}
+
+static void setup(void)
+{
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    reboot();
+    s_kv_programs = 0u;
+}
+
+TEST(addresses_map_to_their_regions)
+{
+    ASSERT_TRUE(flash_health_region_of(CONFIG_STORAGE_BASE) == FLASH_HEALTH_REGION_CONFIG);
+    ASSERT_TRUE(flash_health_region_of(CONFIG_STORAGE_BASE + 0x1FFFu) == FLASH_HEALTH_REGION_CONFIG);
+    ASSERT_TRUE(flash_health_region_of(TRIP_STORAGE_BASE) == FLASH_HEALTH_REGION_TRIP);
+    ASSERT_TRUE(flash_health_region_of(EVENT_LOG_STORAGE_BASE + 0x1000u) == FLASH_HEALTH_REGION_EVENT_LOG);
+    ASSERT_TRUE(flash_health_region_of(STREAM_LOG_STORAGE_BASE + 0x1FFFu) == FLASH_HEALTH_REGION_STREAM_LOG);
+    ASSERT_TRUE(flash_health_region_of(BOOT_STAGE_STORAGE_BASE) == FLASH_HEALTH_REGION_BOOT_STAGE);
+    ASSERT_TRUE(flash_health_region_of(AB_SLOT0_BASE + AB_SLOT_STRIDE - 1u) == FLASH_HEALTH_REGION_AB_SLOT0);
+    ASSERT_TRUE(flash_health_region_of(AB_SLOT1_BASE) == FLASH_HEALTH_REGION_AB_SLOT1);
+    ASSERT_TRUE(flash_health_region_of(KV_STORAGE_BASE + 0x3000u) == FLASH_HEALTH_REGION_KV);
+    ASSERT_TRUE(flash_health_region_of(SPLASH_STORAGE_BASE) == FLASH_HEALTH_REGION_OTHER);
+    ASSERT_TRUE(flash_health_region_of(0u) == FLASH_HEALTH_REGION_OTHER);
+}
+
+TEST(counters_accumulate_per_region)
+{
+    flash_health_note_erase(EVENT_LOG_STORAGE_BASE);
+    flash_health_note_program(EVENT_LOG_STORAGE_BASE + 0x100u);
+    flash_health_note_program(EVENT_LOG_STORAGE_BASE + 0x200u);
+    flash_health_note_read(EVENT_LOG_STORAGE_BASE, 64u);
+    flash_health_note_busy(EVENT_LOG_STORAGE_BASE, 700u);
+    flash_health_note_busy(EVENT_LOG_STORAGE_BASE, 700u);
+    flash_health_note_block(EVENT_LOG_STORAGE_BASE, 45000u);
+    flash_health_note_block(EVENT_LOG_STORAGE_BASE, 900u);
+    flash_health_note_block(RIDE_LOG_STORAGE_BASE, 60000u);
+
+    flash_health_region_t st;
+    flash_health_get(FLASH_HEALTH_REGION_EVENT_LOG, &st);
+    ASSERT_TRUE(st.erases == 1u && st.pages == 2u && st.read_bytes == 64u);
+    ASSERT_TRUE(st.busy_ms == 1u);
+    flash_health_note_busy(EVENT_LOG_STORAGE_BASE, 600u);
+    flash_health_get(FLASH_HEALTH_REGION_EVENT_LOG, &st);
+    ASSERT_TRUE(st.busy_ms == 2u);
+    ASSERT_TRUE(st.block_max_us == 45000u);
+
+    flash_health_get(FLASH_HEALTH_REGION_STREAM_LOG, &st);
+    ASSERT_TRUE(st.erases == 0u && st.pages == 0u && st.read_bytes == 0u);
+
+    flash_health_total(&st);
+    ASSERT_TRUE(st.erases == 1u && st.pages == 2u && st.block_max_us == 60000u);
+
+    flash_health_reset();
+    flash_health_get(FLASH_HEALTH_REGION_EVENT_LOG, &st);
+    ASSERT_TRUE(st.erases == 0u && st.block_max_us == 0u);
+    ASSERT_TRUE(st.life_erases == 1u && st.life_pages == 2u);
+}
+
+TEST(checkpoint_survives_reboot)
+{
+    for (uint32_t i = 0; i < 5u; ++i)
+        flash_health_note_erase(STREAM_LOG_STORAGE_BASE);
+    flash_health_note_program(CONFIG_STORAGE_BASE);
+
+    /* Nothing is stored before the interval. */
+    flash_health_tick(FLASH_HEALTH_SAVE_MS - 1u);
+    ASSERT_TRUE(s_kv_programs == 0u);
+    flash_health_tick(FLASH_HEALTH_SAVE_MS);
+    ASSERT_TRUE(s_kv_programs > 0u);
+
+    reboot();
+    flash_health_region_t st;
+    flash_health_get(FLASH_HEALTH_REGION_STREAM_LOG, &st);
+    ASSERT_TRUE(st.erases == 0u && st.life_erases == 5u);
+    flash_health_get(FLASH_HEALTH_REGION_CONFIG, &st);
+    ASSERT_TRUE(st.life_pages == 1u);
+
+    /* Counting resumes on top of the stored totals. */
+    flash_health_note_erase(STREAM_LOG_STORAGE_BASE);
+    flash_health_tick(2u * FLASH_HEALTH_SAVE_MS);
+    reboot();
+    flash_health_get(FLASH_HEALTH_REGION_STREAM_LOG, &st);
+    ASSERT_TRUE(st.life_erases == 6u);
+}
+
+TEST(kv_programs_alone_do_not_checkpoint)
+{
+    flash_health_note_erase(TRIP_STORAGE_BASE);
+    flash_health_tick(FLASH_HEALTH_SAVE_MS);
+    uint32_t saved = s_kv_programs;
+    ASSERT_TRUE(saved > 0u);
+
+    /* The checkpoint's own append shows up as KV programs. */
+    flash_health_note_program(KV_STORAGE_BASE);
+    flash_health_tick(2u * FLASH_HEALTH_SAVE_MS);
+    ASSERT_TRUE(s_kv_programs == saved);
+
+    flash_health_note_program(RIDE_LOG_STORAGE_BASE);
+    flash_health_tick(3u * FLASH_HEALTH_SAVE_MS);
+    ASSERT_TRUE(s_kv_programs > saved);
+}
+
+TEST(remaining_endurance_spreads_over_sectors)
+{
+    flash_health_region_t st;
+    flash_health_get(FLASH_HEALTH_REGION_KV, &st);
+    ASSERT_TRUE(st.remaining_permille == 1000u);
+
+    /* Half the rating on each of the KV sectors. */
+    for (uint32_t i = 0; i < KV_STORAGE_SECTORS * (FLASH_HEALTH_SECTOR_CYCLES / 2u); ++i)
+        flash_health_note_erase(KV_STORAGE_BASE);
+    flash_health_get(FLASH_HEALTH_REGION_KV, &st);
+    ASSERT_TRUE(st.remaining_permille == 500u);
+
+    flash_health_get(FLASH_HEALTH_REGION_OTHER, &st);
+    ASSERT_TRUE(st.remaining_permille == FLASH_HEALTH_WEAR_UNKNOWN);
+    flash_health_total(&st);
+    ASSERT_TRUE(st.remaining_permille == 500u);
+}
+
+int main(void)
+{
+    printf("\nFlash Health Unit Tests\n");
+    printf("=======================\n\n");
+
+    RUN_TEST(addresses_map_to_their_regions);
+    RUN_TEST(counters_accumulate_per_region);
+    RUN_TEST(checkpoint_survives_reboot);
+    RUN_TEST(kv_programs_alone_do_not_checkpoint);
+    RUN_TEST(remaining_endurance_spreads_over_sectors);
+
+    printf("\n");
+    printf("=======================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("=======================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,213 @@
+/*
+ * Unit Tests for the background SPI flash job queue.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "drivers/spi_flash.h"
+#include "platform/watchdog.h"
+#include "storage/flash_jobs.h"
+
+#define FLASH_SIZE 0x4000u
+
+static uint8_t s_flash[FLASH_SIZE];
+static uint8_t s_busy_polls_left;
+static uint32_t s_sync_ops;
+static char s_trace[64];
+static size_t s_trace_len;
+
+static void trace(char c)
+{
+    if (s_trace_len + 1u < sizeof(s_trace))
+    {
+        s_trace[s_trace_len++] = c;
+        s_trace[s_trace_len] = '\0';
+    }
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    trace('R');
+    memcpy(out, &s_flash[addr], len);
+}
+
+void spi_flash_erase_4k(uint32_t addr)
+{
+    s_sync_ops++;
+    memset(&s_flash[addr & ~(SPI_FLASH_SECTOR_SIZE - 1u)], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+void spi_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    s_sync_ops++;
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[addr + i] &= data[i];
+}
+
+uint8_t spi_flash_busy(void)
+{
+    if (s_busy_polls_left)
+    {
+        s_busy_polls_left--;
+        return 1u;
+    }
+    return 0u;
+}
+
+void spi_flash_erase_4k_start(uint32_t addr)
+{
+    trace('E');
+    memset(&s_flash[addr & ~(SPI_FLASH_SECTOR_SIZE - 1u)], 0xFF, SPI_FLASH_SECTOR_SIZE);
+    s_busy_polls_left = 3u;
+}
+
+void spi_flash_page_program_start(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    trace('P');
+    uint32_t room = SPI_FLASH_PAGE_SIZE - (addr & (SPI_FLASH_PAGE_SIZE - 1u));
+    if (len > room)
+        len = room;
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[addr + i] &= data[i];
+    s_busy_polls_left = 1u;
+}
+
+/* Waits run unbudgeted on the host. */
+void watchdog_budget_begin(watchdog_budget_t *b, uint32_t budget_us)
+{
+    (void)b;
+    (void)budget_us;
+}
+
+uint8_t watchdog_budget_poll(watchdog_budget_t *b)
+{
+    (void)b;
+    return 1u;
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+static int s_done_calls;
+
+static void setup(void)
+{
+    memset(s_flash, 0x00, sizeof(s_flash));
+    s_busy_polls_left = 0u;
+    s_sync_ops = 0u;
+    s_trace_len = 0u;
+    s_trace[0] = '\0';
+    s_done_calls = 0;
+    flash_jobs_init();
+}
+
+static void on_done(void *ctx, uint8_t ok)
+{
+    (void)ctx;
+    if (ok)
+        s_done_calls++;
+}
+
+TEST(erase_then_program_runs_in_background)
+{
+    uint8_t rec[20];
+    memset(rec, 0x5A, sizeof(rec));
+    ASSERT_TRUE(flash_jobs_submit_erase(0x1000u, on_done, NULL));
+    ASSERT_TRUE(flash_jobs_submit_program(0x1010u, rec, sizeof(rec), on_done, NULL));
+    memset(rec, 0x00, sizeof(rec)); /* inline copy: caller buffer may change */
+
+    flash_jobs_tick(); /* starts erase */
+    ASSERT_TRUE(strcmp(s_trace, "E") == 0);
+    flash_jobs_tick();
+    flash_jobs_tick();
+    flash_jobs_tick();
+    ASSERT_TRUE(s_done_calls == 0); /* still busy */
+    flash_jobs_flush();
+    ASSERT_TRUE(s_done_calls == 2);
+    ASSERT_TRUE(strcmp(s_trace, "EP") == 0);
+    ASSERT_TRUE(s_flash[0x1010u] == 0x5Au && s_flash[0x1023u] == 0x5Au);
+    ASSERT_TRUE(s_flash[0x1024u] == 0xFFu);
+    ASSERT_TRUE(s_sync_ops == 0u);
+}
+
+TEST(program_splits_at_page_boundary)
+{
+    static uint8_t big[300];
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    memset(big, 0x11, sizeof(big));
+    ASSERT_TRUE(flash_jobs_submit_program(0x00F0u, big, sizeof(big), NULL, NULL));
+    flash_jobs_flush();
+    ASSERT_TRUE(strcmp(s_trace, "PPP") == 0); /* 16 + 256 + 28 */
+    ASSERT_TRUE(s_flash[0x00F0u] == 0x11u && s_flash[0x00F0u + 299u] == 0x11u);
+}
+
+TEST(read_jumps_queued_writes_unless_overlapping)
+{
+    uint8_t rec[4] = {1, 2, 3, 4};
+    uint8_t out[4];
+    uint8_t out2[4];
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    ASSERT_TRUE(flash_jobs_submit_erase(0x1000u, NULL, NULL));
+    ASSERT_TRUE(flash_jobs_submit_program(0x2000u, rec, sizeof(rec), NULL, NULL));
+    ASSERT_TRUE(flash_jobs_submit_read(0x2000u, out2, sizeof(out2), NULL, NULL));
+    ASSERT_TRUE(flash_jobs_submit_read(0x3000u, out, sizeof(out), NULL, NULL));
+    flash_jobs_flush();
+    /* Unrelated read first; the read of 0x2000 waits for its program. */
+    ASSERT_TRUE(strcmp(s_trace, "REPR") == 0);
+    ASSERT_TRUE(memcmp(out2, rec, sizeof(rec)) == 0);
+}
+
+TEST(full_queue_falls_back_in_order)
+{
+    uint8_t rec[4] = {0xA0, 0xA1, 0xA2, 0xA3};
+    for (uint8_t i = 0; i < FLASH_JOBS_DEPTH; ++i)
+        flash_jobs_erase(0x1000u);
+    ASSERT_TRUE(flash_jobs_pending() == FLASH_JOBS_DEPTH);
+    flash_jobs_program(0x1000u, rec, sizeof(rec));
+    /* Queue drained before the synchronous write. */
+    ASSERT_TRUE(flash_jobs_pending() == 0u);
+    ASSERT_TRUE(s_sync_ops == 1u);
+    ASSERT_TRUE(s_flash[0x1000u] == 0xA0u);
+    flash_jobs_stats_t st;
+    flash_jobs_get_stats(&st);
+    ASSERT_TRUE(st.fallbacks == 1u);
+    ASSERT_TRUE(st.max_depth == FLASH_JOBS_DEPTH);
+}
+
+int main(void)
+{
+    printf("\nFlash Job Queue Unit Tests\n");
+    printf("==========================\n\n");
+
+    RUN_TEST(erase_then_program_runs_in_background);
+    RUN_TEST(program_splits_at_page_boundary);
+    RUN_TEST(read_jumps_queued_writes_unless_overlapping);
+    RUN_TEST(full_queue_falls_back_in_order);
+
+    printf("\n");
+    printf("==========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("==========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
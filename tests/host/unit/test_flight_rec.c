@@ -0,0 +1,97 @@
+/*
+ * Unit Tests for the flight recorder ring.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "src/kernel/flight_rec.h"
+#include "util/byteorder.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static uint8_t s_out[FLIGHT_REC_ENTRIES * FLIGHT_REC_ENTRY_SIZE];
+
+static void setup(void)
+{
+    /* Power-on: garbage without the magic. */
+    memset(&g_flight_rec, 0xA5, sizeof(g_flight_rec));
+    memset(s_out, 0, sizeof(s_out));
+}
+
+TEST(cold_boot_clears_and_marks_boot)
+{
+    flight_rec_init(0x0004u);
+    ASSERT_TRUE(g_flight_rec.magic == FLIGHT_REC_MAGIC);
+    ASSERT_TRUE(g_flight_rec.head == 1u);
+    ASSERT_TRUE(flight_rec_copy(s_out, FLIGHT_REC_ENTRIES) == 1u);
+    ASSERT_TRUE(s_out[4] == FLIGHT_BOOT);
+    ASSERT_TRUE(load_be16(&s_out[6]) == 0x0004u);
+}
+
+TEST(copy_is_oldest_first_after_wrap)
+{
+    flight_rec_init(0u);
+    for (uint32_t i = 0; i < FLIGHT_REC_ENTRIES + 10u; i++) {
+        flight_rec_log(FLIGHT_SCHED, (uint8_t)i, (uint16_t)i);
+    }
+    ASSERT_TRUE(flight_rec_copy(s_out, FLIGHT_REC_ENTRIES) == FLIGHT_REC_ENTRIES);
+    /* BOOT plus the first 10 dispatches fell out; 11 dispatches ago is first. */
+    ASSERT_TRUE(s_out[4] == FLIGHT_SCHED);
+    ASSERT_TRUE(s_out[5] == 10u);
+    const uint8_t *last = &s_out[(FLIGHT_REC_ENTRIES - 1u) * FLIGHT_REC_ENTRY_SIZE];
+    ASSERT_TRUE(last[5] == (uint8_t)(FLIGHT_REC_ENTRIES + 9u));
+    /* A short copy keeps the newest entries. */
+    ASSERT_TRUE(flight_rec_copy(s_out, 2u) == 2u);
+    ASSERT_TRUE(s_out[5] == (uint8_t)(FLIGHT_REC_ENTRIES + 8u));
+}
+
+TEST(warm_reset_keeps_previous_run)
+{
+    flight_rec_init(0u);
+    flight_rec_log(FLIGHT_EVENT, 0x21u, 0x1234u);
+    flight_rec_init(0x0010u);
+    ASSERT_TRUE(flight_rec_copy(s_out, FLIGHT_REC_ENTRIES) == 3u);
+    ASSERT_TRUE(s_out[8 + 4] == FLIGHT_EVENT);
+    ASSERT_TRUE(load_be16(&s_out[8 + 6]) == 0x1234u);
+    ASSERT_TRUE(s_out[16 + 4] == FLIGHT_BOOT);
+    ASSERT_TRUE(load_be16(&s_out[16 + 6]) == 0x0010u);
+}
+
+int main(void)
+{
+    printf("\nFlight Recorder Unit Tests\n");
+    printf("==========================\n\n");
+
+    RUN_TEST(cold_boot_clears_and_marks_boot);
+    RUN_TEST(copy_is_oldest_first_after_wrap);
+    RUN_TEST(warm_reset_keeps_previous_run);
+
+    printf("\n");
+    printf("==========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("==========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+/*
+ * Unit Tests for the button edge-to-pixel latency chain.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "src/input/input_latency.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* DWT stand-in: one cycle per microsecond. */
+static uint32_t s_cycles;
+
+uint32_t platform_cycles_now(void)
+{
+    return s_cycles;
+}
+
+uint32_t platform_cycles_to_us(uint32_t cycles)
+{
+    return cycles;
+}
+
+static void setup(void)
+{
+    s_cycles = 1000u;
+    input_latency_reset();
+}
+
+TEST(stages_time_from_the_edge_in_order)
+{
+    input_latency_edge(s_cycles);
+    s_cycles += 300u;
+    input_latency_mark(INPUT_LAT_SAMPLED);
+    s_cycles += 200u;
+    input_latency_mark(INPUT_LAT_EVENT);
+    s_cycles += 100u;
+    input_latency_mark(INPUT_LAT_APPLIED);
+    input_latency_frame_begin();
+    s_cycles += 9000u;
+    input_latency_mark(INPUT_LAT_DRAWN);
+    /* Chain is done: a later frame is not the first pixel. */
+    s_cycles += 5000u;
+    input_latency_frame_begin();
+    input_latency_mark(INPUT_LAT_DRAWN);
+
+    input_latency_stats_t st;
+    input_latency_get(&st);
+    ASSERT_TRUE(st.edges == 1u && st.presses == 1u);
+    ASSERT_TRUE(st.last_us[INPUT_LAT_SAMPLED] == 300u);
+    ASSERT_TRUE(st.last_us[INPUT_LAT_EVENT] == 500u);
+    ASSERT_TRUE(st.last_us[INPUT_LAT_APPLIED] == 600u);
+    ASSERT_TRUE(st.last_us[INPUT_LAT_DRAWN] == 9600u);
+    ASSERT_TRUE(st.max_us[INPUT_LAT_DRAWN] == 9600u);
+}
+
+TEST(frame_built_before_the_press_does_not_count)
+{
+    input_latency_edge(s_cycles);
+    input_latency_mark(INPUT_LAT_SAMPLED);
+    /* Model snapshot taken before the handler ran. */
+    input_latency_frame_begin();
+    input_latency_mark(INPUT_LAT_EVENT);
+    input_latency_mark(INPUT_LAT_APPLIED);
+    s_cycles += 4000u;
+    input_latency_mark(INPUT_LAT_DRAWN);
+
+    input_latency_stats_t st;
+    input_latency_get(&st);
+    ASSERT_TRUE(st.presses == 0u);
+
+    input_latency_frame_begin();
+    s_cycles += 8000u;
+    input_latency_mark(INPUT_LAT_DRAWN);
+    input_latency_get(&st);
+    ASSERT_TRUE(st.presses == 1u);
+    ASSERT_TRUE(st.last_us[INPUT_LAT_DRAWN] == 12000u);
+}
+
+TEST(long_press_stops_after_sampled)
+{
+    input_latency_edge(s_cycles);
+    s_cycles += 50u;
+    input_latency_mark(INPUT_LAT_SAMPLED);
+    /* No EVENT for a long press: later stages are out of order. */
+    s_cycles += 800000u;
+    input_latency_mark(INPUT_LAT_APPLIED);
+    input_latency_frame_begin();
+    input_latency_mark(INPUT_LAT_DRAWN);
+
+    input_latency_stats_t st;
+    input_latency_get(&st);
+    ASSERT_TRUE(st.last_us[INPUT_LAT_SAMPLED] == 50u);
+    ASSERT_TRUE(st.max_us[INPUT_LAT_APPLIED] == 0u);
+    ASSERT_TRUE(st.presses == 0u);
+}
+
+int main(void)
+{
+    printf("\nInput Latency Unit Tests\n");
+    printf("========================\n\n");
+
+    RUN_TEST(stages_time_from_the_edge_in_order);
+    RUN_TEST(frame_built_before_the_press_does_not_count);
+    RUN_TEST(long_press_stops_after_sampled);
+
+    printf("\n");
+    printf("========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
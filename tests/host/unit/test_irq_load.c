@@ -0,0 +1,109 @@
+/*
+ * Unit Tests for the IRQ load counters and per-source worst cases.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform/dma.h"
+#include "platform/irq_load.h"
+
+static uint32_t s_cycles;
+
+uint32_t platform_cycles_now(void)
+{
+    return s_cycles;
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    platform_irq_load_reset_stats(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static platform_irq_stats_t stats(uint8_t src)
+{
+    platform_irq_stats_t st;
+    platform_irq_load_stats(src, &st);
+    return st;
+}
+
+TEST(preemption_is_charged_to_the_preempting_handler)
+{
+    uint32_t before[PLATFORM_IRQ_LOAD_COUNT];
+    uint32_t after[PLATFORM_IRQ_LOAD_COUNT];
+    platform_irq_load_cycles(before);
+
+    /* TIM2 runs 1000 cycles, 300 of them under a DMA completion. */
+    platform_irq_span_t outer;
+    platform_irq_span_t inner;
+    platform_irq_load_enter(&outer);
+    s_cycles += 400u;
+    platform_irq_load_enter(&inner);
+    s_cycles += 300u;
+    platform_irq_load_exit(PLATFORM_IRQ_SRC_DMA(PLATFORM_DMA_FLASH_TX), &inner);
+    s_cycles += 300u;
+    platform_irq_load_exit(PLATFORM_IRQ_SRC_TIM2, &outer);
+
+    platform_irq_load_cycles(after);
+    ASSERT_TRUE(after[PLATFORM_IRQ_LOAD_TIM2] - before[PLATFORM_IRQ_LOAD_TIM2] == 700u);
+    ASSERT_TRUE(after[PLATFORM_IRQ_LOAD_DMA] - before[PLATFORM_IRQ_LOAD_DMA] == 300u);
+
+    platform_irq_stats_t tim2 = stats(PLATFORM_IRQ_SRC_TIM2);
+    ASSERT_TRUE(tim2.count == 1u && tim2.own_max == 700u && tim2.total_max == 1000u);
+    platform_irq_stats_t dma = stats(PLATFORM_IRQ_SRC_DMA(PLATFORM_DMA_FLASH_TX));
+    ASSERT_TRUE(dma.count == 1u && dma.own_max == 300u && dma.total_max == 300u);
+}
+
+TEST(latency_counts_only_stamped_entries)
+{
+    platform_irq_span_t span;
+    platform_irq_load_enter_late(&span, 0u);
+    platform_irq_load_exit(PLATFORM_IRQ_SRC_TIM2, &span);
+    platform_irq_load_enter_late(&span, 720u);
+    platform_irq_load_exit(PLATFORM_IRQ_SRC_TIM2, &span);
+    platform_irq_load_enter_late(&span, 72u);
+    platform_irq_load_exit(PLATFORM_IRQ_SRC_TIM2, &span);
+    platform_irq_load_enter(&span);
+    platform_irq_load_exit(PLATFORM_IRQ_SRC_TIM2, &span);
+
+    platform_irq_stats_t st = stats(PLATFORM_IRQ_SRC_TIM2);
+    ASSERT_TRUE(st.count == 4u && st.late_count == 3u && st.late_max == 720u);
+
+    platform_irq_load_reset_stats();
+    st = stats(PLATFORM_IRQ_SRC_TIM2);
+    ASSERT_TRUE(st.count == 0u && st.late_count == 0u && st.late_max == 0u && st.total_max == 0u);
+}
+
+int main(void)
+{
+    printf("\nIRQ Load Unit Tests\n");
+    printf("===================\n\n");
+
+    RUN_TEST(preemption_is_charged_to_the_preempting_handler);
+    RUN_TEST(latency_counts_only_stamped_entries);
+
+    printf("\n");
+    printf("===================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("===================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
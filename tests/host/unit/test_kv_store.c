@@ -0,0 +1,230 @@
+/*
+ * Unit Tests for the append-only key/value store.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "storage/kv_store.h"
+#include "storage/layout.h"
+
+#define KV_BYTES (KV_STORAGE_SECTORS * SPI_FLASH_SECTOR_SIZE)
+
+static uint8_t s_flash[KV_BYTES];
+static uint32_t s_erases[KV_STORAGE_SECTORS];
+static uint32_t s_programmed;
+/* Programs stop landing once this many bytes were written (power cut). */
+static uint32_t s_cut_after;
+
+static uint32_t off_of(uint32_t addr)
+{
+    return addr - KV_STORAGE_BASE;
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    memcpy(out, &s_flash[off_of(addr)], len);
+}
+
+/* Jobs complete immediately; ordering is all the store relies on. */
+void flash_jobs_erase(uint32_t addr)
+{
+    uint32_t off = off_of(addr) & ~(SPI_FLASH_SECTOR_SIZE - 1u);
+    if (s_programmed >= s_cut_after)
+        return;
+    s_erases[off / SPI_FLASH_SECTOR_SIZE]++;
+    memset(&s_flash[off], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+void flash_jobs_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        if (s_programmed >= s_cut_after)
+            return;
+        s_flash[off_of(addr) + i] &= data[i];
+        s_programmed++;
+    }
+}
+
+void flash_jobs_flush(void) {}
+uint8_t flash_jobs_pending(void) { return 0u; }
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void setup(void)
+{
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    memset(s_erases, 0, sizeof(s_erases));
+    s_programmed = 0u;
+    s_cut_after = 0xFFFFFFFFu;
+    kv_init();
+}
+
+TEST(put_get_roundtrip_and_overwrite)
+{
+    uint8_t v = 3;
+    uint8_t out[8];
+    ASSERT_TRUE(kv_get(KV_KEY_VGEAR, out, sizeof(out)) == -1);
+    ASSERT_TRUE(kv_put(KV_KEY_VGEAR, &v, 1u));
+    v = 4;
+    ASSERT_TRUE(kv_put(KV_KEY_VGEAR, &v, 1u));
+    ASSERT_TRUE(kv_get(KV_KEY_VGEAR, out, sizeof(out)) == 1 && out[0] == 4u);
+    ASSERT_TRUE(kv_get(KV_KEY_VGEAR, out, 0u) == -1); /* too small */
+
+    /* Same value again: no append. */
+    uint32_t before = s_programmed;
+    ASSERT_TRUE(kv_put(KV_KEY_VGEAR, &v, 1u));
+    ASSERT_TRUE(s_programmed == before);
+
+    /* A one-byte value is an 8-byte record. */
+    kv_stats_t st;
+    kv_get_stats(&st);
+    ASSERT_TRUE(st.appends == 2u && st.unchanged == 1u);
+    ASSERT_TRUE(st.used == 12u + 2u * 8u);
+    ASSERT_TRUE(s_erases[0] == 1u); /* format only */
+}
+
+TEST(reload_finds_latest_values)
+{
+    uint8_t blob[81];
+    uint8_t out[96];
+    for (uint8_t i = 0; i < sizeof(blob); ++i)
+        blob[i] = (uint8_t)(i * 7u);
+    ASSERT_TRUE(kv_put(KV_KEY_CONFIG, blob, sizeof(blob)));
+    uint8_t p = 2;
+    ASSERT_TRUE(kv_put(KV_KEY_PROFILE, &p, 1u));
+    blob[0] = 0xAA;
+    ASSERT_TRUE(kv_put(KV_KEY_CONFIG, blob, sizeof(blob)));
+
+    kv_init(); /* reboot */
+    ASSERT_TRUE(kv_get(KV_KEY_CONFIG, out, sizeof(out)) == (int)sizeof(blob));
+    ASSERT_TRUE(memcmp(out, blob, sizeof(blob)) == 0);
+    ASSERT_TRUE(kv_get(KV_KEY_PROFILE, out, sizeof(out)) == 1 && out[0] == 2u);
+}
+
+TEST(compaction_rotates_sectors_and_keeps_live_values)
+{
+    uint8_t blob[40];
+    uint8_t out[96];
+    memset(blob, 0x42, sizeof(blob));
+    ASSERT_TRUE(kv_put(KV_KEY_TRIP, blob, sizeof(blob)));
+
+    /* ~500 gear changes per sector; go round the region twice. */
+    for (uint32_t i = 0; i < 4500u; ++i)
+    {
+        uint8_t g = (uint8_t)(1u + (i % 6u));
+        ASSERT_TRUE(kv_put(KV_KEY_VGEAR, &g, 1u));
+    }
+    kv_stats_t st;
+    kv_get_stats(&st);
+    ASSERT_TRUE(st.compactions >= 8u);
+    for (uint8_t s = 0; s < KV_STORAGE_SECTORS; ++s)
+        ASSERT_TRUE(s_erases[s] >= 2u && s_erases[s] <= 4u);
+
+    kv_init();
+    ASSERT_TRUE(kv_get(KV_KEY_TRIP, out, sizeof(out)) == (int)sizeof(blob));
+    ASSERT_TRUE(memcmp(out, blob, sizeof(blob)) == 0);
+    ASSERT_TRUE(kv_get(KV_KEY_VGEAR, out, sizeof(out)) == 1 && out[0] == (uint8_t)(1u + (4499u % 6u)));
+    kv_get_stats(&st);
+    ASSERT_TRUE(st.live == 2u && st.torn == 0u);
+}
+
+TEST(torn_append_keeps_previous_value)
+{
+    uint8_t blob[32];
+    uint8_t out[96];
+    memset(blob, 0x11, sizeof(blob));
+    ASSERT_TRUE(kv_put(KV_KEY_COUNTERS, blob, sizeof(blob)));
+    memset(blob, 0x22, sizeof(blob));
+    s_cut_after = s_programmed + 10u; /* header and part of the value */
+    (void)kv_put(KV_KEY_COUNTERS, blob, sizeof(blob));
+
+    s_cut_after = 0xFFFFFFFFu;
+    kv_init();
+    ASSERT_TRUE(kv_get(KV_KEY_COUNTERS, out, sizeof(out)) == (int)sizeof(blob));
+    ASSERT_TRUE(out[0] == 0x11u);
+    kv_stats_t st;
+    kv_get_stats(&st);
+    ASSERT_TRUE(st.torn == 1u);
+
+    /* Appends continue past the torn record. */
+    ASSERT_TRUE(kv_put(KV_KEY_COUNTERS, blob, sizeof(blob)));
+    kv_init();
+    ASSERT_TRUE(kv_get(KV_KEY_COUNTERS, out, sizeof(out)) == (int)sizeof(blob));
+    ASSERT_TRUE(out[0] == 0x22u);
+}
+
+TEST(interrupted_compaction_keeps_old_sector)
+{
+    uint8_t g = 1;
+    uint8_t out[8];
+    kv_stats_t st;
+    /* Fill sector 0 right up to the point where the next put compacts. */
+    for (;;)
+    {
+        kv_get_stats(&st);
+        if (st.used + 8u > SPI_FLASH_SECTOR_SIZE)
+            break;
+        g = (uint8_t)(g == 1u ? 2u : 1u);
+        ASSERT_TRUE(kv_put(KV_KEY_VGEAR, &g, 1u));
+    }
+    uint8_t last = g;
+    uint8_t next = 5;
+    /* Power drops after the erase and copy but before the header lands. */
+    s_cut_after = s_programmed + 8u;
+    (void)kv_put(KV_KEY_VGEAR, &next, 1u);
+
+    s_cut_after = 0xFFFFFFFFu;
+    kv_init();
+    kv_get_stats(&st);
+    ASSERT_TRUE(st.sector == 0u && st.generation == 1u);
+    ASSERT_TRUE(kv_get(KV_KEY_VGEAR, out, sizeof(out)) == 1 && out[0] == last);
+
+    /* The retry completes the move. */
+    ASSERT_TRUE(kv_put(KV_KEY_VGEAR, &next, 1u));
+    kv_init();
+    kv_get_stats(&st);
+    ASSERT_TRUE(st.sector == 1u && st.generation == 2u);
+    ASSERT_TRUE(kv_get(KV_KEY_VGEAR, out, sizeof(out)) == 1 && out[0] == next);
+}
+
+int main(void)
+{
+    printf("\nKV Store Unit Tests\n");
+    printf("===================\n\n");
+
+    RUN_TEST(put_get_roundtrip_and_overwrite);
+    RUN_TEST(reload_finds_latest_values);
+    RUN_TEST(compaction_rotates_sectors_and_keeps_live_values);
+    RUN_TEST(torn_append_keeps_previous_value);
+    RUN_TEST(interrupted_compaction_keeps_old_sector);
+
+    printf("\n");
+    printf("===================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("===================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,158 @@
+/*
+ * Unit Tests for the LCD pixel DMA: completion with IRQs on, and the CPU
+ * and polled paths taken while they are masked.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform/lcd_dma.h"
+
+static uint32_t s_cycles;
+
+uint32_t platform_cycles_now(void)
+{
+    return s_cycles;
+}
+
+uint32_t platform_cycles_to_us(uint32_t cycles)
+{
+    return cycles;
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    memset(&g_lcd_dma_host, 0, sizeof(g_lcd_dma_host)); \
+    s_done_calls = 0; \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static int s_done_calls;
+
+static void on_done(void *ctx)
+{
+    (void)ctx;
+    s_done_calls++;
+}
+
+static uint16_t s_pixels[0x10000u + 64u];
+
+static void fill_pixels(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+        s_pixels[i] = (uint16_t)(i * 7u + 1u);
+}
+
+TEST(write_completes_from_the_channel_irq)
+{
+    fill_pixels(240u);
+    platform_lcd_dma_write_u16_async(s_pixels, 240u, on_done, 0);
+    ASSERT_TRUE(platform_lcd_dma_busy());
+    ASSERT_TRUE(g_lcd_dma_host.cpu_pixels == 0u && s_done_calls == 0);
+
+    platform_lcd_dma_host_complete();
+    ASSERT_TRUE(!platform_lcd_dma_busy());
+    ASSERT_TRUE(g_lcd_dma_host.dma_pixels == 240u && s_done_calls == 1);
+}
+
+TEST(write_runs_every_chunk_of_a_long_transfer)
+{
+    uint32_t count = 0x10000u + 64u;
+    fill_pixels(count);
+    platform_lcd_dma_write_u16(s_pixels, count);
+    platform_lcd_dma_host_complete();
+    ASSERT_TRUE(platform_lcd_dma_busy());
+    ASSERT_TRUE(g_lcd_dma_host.last == s_pixels[0xFFFFu]);
+
+    platform_lcd_dma_host_complete();
+    ASSERT_TRUE(!platform_lcd_dma_busy());
+    ASSERT_TRUE(g_lcd_dma_host.dma_pixels == count);
+}
+
+TEST(masked_irqs_write_with_the_cpu)
+{
+    fill_pixels(240u);
+    g_lcd_dma_host.irqs_masked = 1u;
+    platform_lcd_dma_write_u16_async(s_pixels, 240u, on_done, 0);
+    ASSERT_TRUE(!platform_lcd_dma_busy());
+    ASSERT_TRUE(g_lcd_dma_host.cpu_pixels == 240u && g_lcd_dma_host.dma_pixels == 0u);
+    ASSERT_TRUE(g_lcd_dma_host.last == s_pixels[239] && s_done_calls == 1);
+
+    /* A second push must not wait on a completion that never comes. */
+    platform_lcd_dma_write_u16(s_pixels, 240u);
+    platform_lcd_dma_wait();
+    ASSERT_TRUE(g_lcd_dma_host.cpu_pixels == 480u);
+}
+
+TEST(masked_wait_polls_a_transfer_started_with_irqs_on)
+{
+    fill_pixels(240u);
+    platform_lcd_dma_write_u16_async(s_pixels, 240u, on_done, 0);
+    ASSERT_TRUE(platform_lcd_dma_busy());
+
+    g_lcd_dma_host.irqs_masked = 1u;
+    platform_lcd_dma_wait();
+    ASSERT_TRUE(!platform_lcd_dma_busy());
+    ASSERT_TRUE(g_lcd_dma_host.dma_pixels == 240u && s_done_calls == 1);
+}
+
+TEST(fill_streams_one_colour_word)
+{
+    platform_lcd_dma_fill_u16(0xF800u, 320u * 240u);
+    ASSERT_TRUE(platform_lcd_dma_busy() && g_lcd_dma_host.last == 0xF800u);
+    platform_lcd_dma_host_complete();
+    platform_lcd_dma_host_complete();
+    ASSERT_TRUE(!platform_lcd_dma_busy());
+    ASSERT_TRUE(g_lcd_dma_host.dma_pixels == 320u * 240u && g_lcd_dma_host.cpu_pixels == 0u);
+}
+
+TEST(masked_irqs_fill_with_the_cpu)
+{
+    /* board_init clears the whole panel before enable_irqs(). */
+    g_lcd_dma_host.irqs_masked = 1u;
+    platform_lcd_dma_fill_u16(0x001Fu, 320u * 240u);
+    ASSERT_TRUE(!platform_lcd_dma_busy());
+    ASSERT_TRUE(g_lcd_dma_host.cpu_pixels == 320u * 240u && g_lcd_dma_host.dma_pixels == 0u);
+    ASSERT_TRUE(g_lcd_dma_host.last == 0x001Fu);
+
+    platform_lcd_dma_fill_u16(0x07E0u, 16u);
+    ASSERT_TRUE(!platform_lcd_dma_busy() && g_lcd_dma_host.last == 0x07E0u);
+}
+
+int main(void)
+{
+    printf("\nLCD DMA Unit Tests\n");
+    printf("==================\n\n");
+
+    platform_lcd_dma_init();
+    RUN_TEST(write_completes_from_the_channel_irq);
+    RUN_TEST(write_runs_every_chunk_of_a_long_transfer);
+    RUN_TEST(masked_irqs_write_with_the_cpu);
+    RUN_TEST(masked_wait_polls_a_transfer_started_with_irqs_on);
+    RUN_TEST(fill_streams_one_colour_word);
+    RUN_TEST(masked_irqs_fill_with_the_cpu);
+
+    printf("\n");
+    printf("==================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("==================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
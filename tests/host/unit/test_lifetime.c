@@ -0,0 +1,304 @@
+/*
+ * Unit Tests for the lifetime counters and their unary flash encoding.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "storage/flash_jobs.h"
+#include "storage/layout.h"
+#include "storage/lifetime.h"
+
+#define LIFE_BYTES (LIFETIME_STORAGE_SECTORS * SPI_FLASH_SECTOR_SIZE)
+
+static uint8_t s_flash[LIFE_BYTES];
+static uint32_t s_erases;
+static uint32_t s_programs;
+static uint32_t s_program_bytes;
+
+/* Deferred mode runs jobs at queue_flush(), in order, the way flash_jobs
+ * does: programs up to FLASH_JOBS_INLINE_MAX bytes are copied, larger ones
+ * borrow the caller's buffer. A borrowed buffer is not read back (its frame
+ * is gone by then), so such a program lands as garbage and is counted. */
+#define QUEUE_DEPTH 64u
+#define JOB_ERASE   0xFFFFFFFFu
+static uint8_t s_deferred;
+static uint32_t s_borrowed;
+static struct {
+    uint32_t addr;
+    uint32_t len;
+    uint8_t data[FLASH_JOBS_INLINE_MAX];
+} s_queue[QUEUE_DEPTH];
+static uint32_t s_queued;
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    memcpy(out, &s_flash[addr - LIFETIME_STORAGE_BASE], len);
+}
+
+static void flash_erase_now(uint32_t addr)
+{
+    uint32_t off = (addr - LIFETIME_STORAGE_BASE) & ~(SPI_FLASH_SECTOR_SIZE - 1u);
+    memset(&s_flash[off], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+static void flash_program_now(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[addr - LIFETIME_STORAGE_BASE + i] &= data ? data[i] : 0x5Au;
+}
+
+static void queue_flush(void)
+{
+    for (uint32_t i = 0; i < s_queued; ++i)
+    {
+        if (s_queue[i].len == JOB_ERASE)
+            flash_erase_now(s_queue[i].addr);
+        else if (s_queue[i].len > FLASH_JOBS_INLINE_MAX)
+            flash_program_now(s_queue[i].addr, NULL, s_queue[i].len);
+        else
+            flash_program_now(s_queue[i].addr, s_queue[i].data, s_queue[i].len);
+    }
+    s_queued = 0u;
+}
+
+static void queue_job(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if (s_queued == QUEUE_DEPTH)
+        queue_flush();
+    s_queue[s_queued].addr = addr;
+    s_queue[s_queued].len = len;
+    if (len <= FLASH_JOBS_INLINE_MAX)
+        memcpy(s_queue[s_queued].data, data, len);
+    else if (len != JOB_ERASE)
+        s_borrowed++;
+    s_queued++;
+}
+
+void flash_jobs_erase(uint32_t addr)
+{
+    s_erases++;
+    if (s_deferred)
+        queue_job(addr, NULL, JOB_ERASE);
+    else
+        flash_erase_now(addr);
+}
+
+void flash_jobs_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    s_programs++;
+    s_program_bytes += len;
+    if (s_deferred)
+        queue_job(addr, data, len);
+    else
+        flash_program_now(addr, data, len);
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void setup(void)
+{
+    s_deferred = 0u;
+    s_borrowed = 0u;
+    s_queued = 0u;
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    lifetime_init(0u, 0u);
+    s_erases = 0u;
+    s_programs = 0u;
+    s_program_bytes = 0u;
+}
+
+static uint32_t value(uint8_t counter)
+{
+    lifetime_info_t info;
+    lifetime_get(&info);
+    return info.value[counter];
+}
+
+TEST(fresh_region_is_formatted)
+{
+    lifetime_info_t info;
+    lifetime_get(&info);
+    ASSERT_TRUE(info.seq == 1u && info.used_max == 0u);
+    for (uint8_t c = 0; c < LIFETIME_COUNT; ++c)
+        ASSERT_TRUE(info.value[c] == 0u);
+    /* A reboot finds the header instead of formatting again. */
+    lifetime_init(0u, 0u);
+    ASSERT_TRUE(s_erases == 0u);
+    lifetime_get(&info);
+    ASSERT_TRUE(info.seq == 1u);
+}
+
+TEST(ticks_are_single_byte_programs)
+{
+    /* 250 m: two ticks and 50 m waiting in RAM. */
+    lifetime_add(LIFETIME_DISTANCE, 250000u);
+    ASSERT_TRUE(value(LIFETIME_DISTANCE) == 250u);
+    lifetime_tick();
+    ASSERT_TRUE(s_programs == 1u && s_program_bytes == 1u && s_erases == 0u);
+    lifetime_tick();
+    ASSERT_TRUE(s_programs == 1u);
+
+    /* Ticks that cross a byte take one program per byte. */
+    lifetime_add(LIFETIME_ENERGY, 10000u);
+    lifetime_tick();
+    lifetime_tick();
+    ASSERT_TRUE(s_programs == 3u && s_program_bytes == 3u && s_erases == 0u);
+    ASSERT_TRUE(value(LIFETIME_ENERGY) == 10u);
+}
+
+TEST(counts_survive_reboot)
+{
+    lifetime_add(LIFETIME_DISTANCE, 1234567u);
+    lifetime_add(LIFETIME_MOTOR_ON, 3u * 60000u + 59999u);
+    lifetime_add(LIFETIME_ASSIST0 + 4u, 600000u);
+    for (int i = 0; i < 4; ++i)
+        lifetime_tick();
+
+    /* Whole ticks are kept; the part of a tick in RAM is not. */
+    lifetime_init(0u, 0u);
+    ASSERT_TRUE(value(LIFETIME_DISTANCE) == 1200u);
+    ASSERT_TRUE(value(LIFETIME_MOTOR_ON) == 180u);
+    ASSERT_TRUE(value(LIFETIME_ASSIST0 + 4u) == 600u);
+    ASSERT_TRUE(value(LIFETIME_ASSIST0) == 0u);
+
+    lifetime_add(LIFETIME_DISTANCE, 100000u);
+    lifetime_tick();
+    lifetime_init(0u, 0u);
+    ASSERT_TRUE(value(LIFETIME_DISTANCE) == 1300u);
+}
+
+TEST(full_area_rolls_up_into_other_sector)
+{
+    /* Fill the distance area, then one tick more. */
+    for (uint32_t i = 0; i < LIFETIME_AREA_TICKS + 1u; ++i)
+    {
+        lifetime_add(LIFETIME_DISTANCE, 100000u);
+        lifetime_tick();
+    }
+    lifetime_add(LIFETIME_ENERGY, 5000u);
+    lifetime_tick();
+    ASSERT_TRUE(s_erases == 1u);
+
+    lifetime_info_t info;
+    lifetime_get(&info);
+    ASSERT_TRUE(info.seq == 2u && info.used_max == 5u);
+    ASSERT_TRUE(info.value[LIFETIME_DISTANCE] == (LIFETIME_AREA_TICKS + 1u) * 100u);
+
+    lifetime_init(0u, 0u);
+    lifetime_get(&info);
+    ASSERT_TRUE(info.seq == 2u);
+    ASSERT_TRUE(info.value[LIFETIME_DISTANCE] == (LIFETIME_AREA_TICKS + 1u) * 100u);
+    ASSERT_TRUE(info.value[LIFETIME_ENERGY] == 5u);
+}
+
+TEST(torn_rollup_keeps_old_sector)
+{
+    for (uint32_t i = 0; i < 40u; ++i)
+    {
+        lifetime_add(LIFETIME_MOTOR_ON, 60000u);
+        lifetime_tick();
+    }
+    /* Power lost after erasing the next sector, before its header. */
+    memset(&s_flash[SPI_FLASH_SECTOR_SIZE], 0xFF, SPI_FLASH_SECTOR_SIZE);
+    s_flash[SPI_FLASH_SECTOR_SIZE] = 0x4Cu;
+    lifetime_init(0u, 0u);
+    lifetime_info_t info;
+    lifetime_get(&info);
+    ASSERT_TRUE(info.seq == 1u);
+    ASSERT_TRUE(info.value[LIFETIME_MOTOR_ON] == 40u * 60u);
+}
+
+TEST(queued_header_survives_reboot)
+{
+    /* Format and tick with every job left in the queue until the caller's
+     * stack is long gone. */
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    s_deferred = 1u;
+    lifetime_init(0u, 0u);
+    lifetime_add(LIFETIME_DISTANCE, 300000u);
+    lifetime_tick();
+    queue_flush();
+    ASSERT_TRUE(s_borrowed == 0u);
+
+    s_erases = 0u;
+    lifetime_init(0u, 0u);
+    queue_flush();
+    ASSERT_TRUE(s_erases == 0u);
+    ASSERT_TRUE(value(LIFETIME_DISTANCE) == 300u);
+
+    /* Likewise for the roll-up into the other sector. */
+    for (uint32_t i = 0; i < LIFETIME_AREA_TICKS; ++i)
+    {
+        lifetime_add(LIFETIME_ENERGY, 1000u);
+        lifetime_tick();
+    }
+    lifetime_add(LIFETIME_ENERGY, 1000u);
+    lifetime_tick();
+    queue_flush();
+    ASSERT_TRUE(s_borrowed == 0u && s_erases == 1u);
+    lifetime_init(0u, 0u);
+    lifetime_info_t info;
+    lifetime_get(&info);
+    ASSERT_TRUE(info.seq == 2u);
+    ASSERT_TRUE(info.value[LIFETIME_ENERGY] == LIFETIME_AREA_TICKS + 1u);
+    ASSERT_TRUE(info.value[LIFETIME_DISTANCE] == 300u);
+}
+
+TEST(new_region_starts_from_trip_totals)
+{
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    lifetime_init(12345u, 678u);
+    ASSERT_TRUE(value(LIFETIME_DISTANCE) == 12300u);
+    ASSERT_TRUE(value(LIFETIME_ENERGY) == 678u);
+    ASSERT_TRUE(value(LIFETIME_MOTOR_ON) == 0u);
+
+    /* Only a new region is seeded; an existing one keeps its own count. */
+    lifetime_add(LIFETIME_DISTANCE, 100000u);
+    lifetime_tick();
+    lifetime_init(99999u, 9999u);
+    ASSERT_TRUE(value(LIFETIME_DISTANCE) == 12400u);
+    ASSERT_TRUE(value(LIFETIME_ENERGY) == 678u);
+}
+
+int main(void)
+{
+    printf("\nLifetime Counter Unit Tests\n");
+    printf("===========================\n\n");
+
+    RUN_TEST(fresh_region_is_formatted);
+    RUN_TEST(ticks_are_single_byte_programs);
+    RUN_TEST(counts_survive_reboot);
+    RUN_TEST(full_area_rolls_up_into_other_sector);
+    RUN_TEST(torn_rollup_keeps_old_sector);
+    RUN_TEST(queued_header_survives_reboot);
+    RUN_TEST(new_region_starts_from_trip_totals);
+
+    printf("\n");
+    printf("===========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("===========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,396 @@
+/*
+ * Unit Tests for the flash logs: page-packed stream log and the
+ * sector-indexed event log.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "app_data.h"
+#include "control/control.h"
+#include "storage/layout.h"
+#include "storage/logs.h"
+#include "util/byteorder.h"
+
+debug_inputs_t g_inputs;
+debug_outputs_t g_outputs;
+walk_state_t g_walk_state;
+volatile uint32_t g_ms;
+
+/* Event log through the end of the stream log. */
+#define LOGS_BASE EVENT_LOG_STORAGE_BASE
+#define LOGS_BYTES (STREAM_LOG_STORAGE_BASE + STREAM_LOG_STORAGE_BYTES - EVENT_LOG_STORAGE_BASE)
+#define STREAM_OFF (STREAM_LOG_STORAGE_BASE - LOGS_BASE)
+
+static uint8_t s_flash[LOGS_BYTES];
+static uint32_t s_page_programs;
+static uint32_t s_event_programs;
+static uint32_t s_reads;
+
+static uint32_t off_of(uint32_t addr)
+{
+    return addr - LOGS_BASE;
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    s_reads++;
+    memcpy(out, &s_flash[off_of(addr)], len);
+}
+
+void flash_jobs_erase_region(uint32_t addr, uint32_t len)
+{
+    memset(&s_flash[off_of(addr)], 0xFF, len);
+}
+
+void flash_jobs_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    if (addr >= STREAM_LOG_STORAGE_BASE)
+        s_page_programs++;
+    else
+        s_event_programs++;
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[off_of(addr) + i] &= data[i];
+}
+
+int flash_jobs_submit_program(uint32_t addr, const uint8_t *data, uint32_t len,
+                              void (*done)(void *, uint8_t), void *ctx)
+{
+    flash_jobs_program(addr, data, len);
+    if (done)
+        done(ctx, 1u);
+    return 1;
+}
+
+void flash_jobs_flush(void) {}
+
+void flash_jobs_erase(uint32_t addr)
+{
+    memset(&s_flash[off_of(addr) & ~(SPI_FLASH_SECTOR_SIZE - 1u)], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void setup(void)
+{
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    s_page_programs = 0u;
+    s_event_programs = 0u;
+    memset(&g_inputs, 0, sizeof(g_inputs));
+    memset(&g_outputs, 0, sizeof(g_outputs));
+    g_ms = 1000u;
+    g_stream_log_last_sample_ms = 0u;
+    s_reads = 0u;
+    stream_log_load();
+    event_log_load();
+}
+
+/* A plausible ride: speed and power wander, voltage sags slowly. */
+static void ride_sample(uint32_t i)
+{
+    g_ms += 200u;
+    g_inputs.speed_dmph = (uint16_t)(150u + (i % 17u));
+    g_inputs.cadence_rpm = (uint16_t)(70u + (i % 5u));
+    g_inputs.power_w = (uint16_t)(250u + ((i * 7u) % 40u));
+    g_inputs.battery_dV = (int16_t)(520 - (int16_t)(i / 50u));
+    g_inputs.battery_dA = (int16_t)(60 + (int16_t)(i % 9u));
+    g_inputs.ctrl_temp_dC = (int16_t)(300 + (int16_t)(i / 100u));
+    g_outputs.assist_mode = 1u;
+    g_outputs.profile_id = (uint8_t)((i / 300u) % 3u);
+    stream_log_append((uint8_t)((i % 11u) == 0u ? 0x01u : 0x00u));
+}
+
+static int record_matches(const uint8_t *r, uint32_t i)
+{
+    return r[0] == STREAM_LOG_VERSION &&
+           r[1] == ((i % 11u) == 0u ? 0x01u : 0x00u) &&
+           load_be16(&r[4]) == 150u + (i % 17u) &&
+           load_be16(&r[6]) == 70u + (i % 5u) &&
+           load_be16(&r[8]) == 250u + ((i * 7u) % 40u) &&
+           (int16_t)load_be16(&r[10]) == (int16_t)(520 - (int16_t)(i / 50u)) &&
+           (int16_t)load_be16(&r[12]) == (int16_t)(60 + (int16_t)(i % 9u)) &&
+           (int16_t)load_be16(&r[14]) == (int16_t)(300 + (int16_t)(i / 100u)) &&
+           r[16] == 1u && r[17] == (uint8_t)((i / 300u) % 3u);
+}
+
+TEST(roundtrip_across_pages_and_ram)
+{
+    uint8_t out[8 * STREAM_LOG_RECORD_SIZE];
+    for (uint32_t i = 0; i < 1000u; ++i)
+        ride_sample(i);
+    ASSERT_TRUE(g_stream_meta.count == 1000u);
+    /* Whole pages only: far fewer programs than samples. */
+    ASSERT_TRUE(s_page_programs == g_stream_meta.head);
+    ASSERT_TRUE(s_page_programs < 1000u / 20u);
+
+    for (uint32_t off = 0; off < 1000u; off += 8u)
+    {
+        uint8_t n = stream_log_copy((uint16_t)off, 8u, out);
+        ASSERT_TRUE(n == (1000u - off < 8u ? 1000u - off : 8u));
+        for (uint8_t k = 0; k < n; ++k)
+            ASSERT_TRUE(record_matches(&out[k * STREAM_LOG_RECORD_SIZE], off + k));
+    }
+    ASSERT_TRUE(load_be16(&out[2]) == 200u); /* dt carried across omitted fields */
+}
+
+TEST(retention_is_several_times_v1)
+{
+    uint32_t i = 0;
+    /* Fill the region until the first wrap. */
+    while (g_stream_meta.head < STREAM_LOG_PAGES)
+        ride_sample(i++);
+    /* v1 held 512 fixed 20-byte records in the same space. */
+    ASSERT_TRUE(g_stream_meta.count >= 3u * 512u);
+}
+
+TEST(reload_recovers_flushed_samples)
+{
+    uint8_t out[STREAM_LOG_RECORD_SIZE];
+    for (uint32_t i = 0; i < 300u; ++i)
+        ride_sample(i);
+    stream_log_flush();
+    uint32_t seq = g_stream_meta.seq;
+
+    stream_log_load();
+    ASSERT_TRUE(g_stream_meta.count == 300u);
+    ASSERT_TRUE(g_stream_meta.seq == seq);
+    ASSERT_TRUE(stream_log_copy(299u, 1u, out) == 1u);
+    ASSERT_TRUE(record_matches(out, 299u));
+
+    /* Appends after reload land on a fresh page and stay readable. */
+    ride_sample(300u);
+    ASSERT_TRUE(stream_log_copy(300u, 1u, out) == 1u);
+    ASSERT_TRUE(record_matches(out, 300u));
+}
+
+TEST(corrupt_page_resets_log)
+{
+    for (uint32_t i = 0; i < 300u; ++i)
+        ride_sample(i);
+    stream_log_flush();
+    s_flash[STREAM_OFF + 20u] ^= 0x01u;
+    stream_log_load();
+    ASSERT_TRUE(g_stream_meta.count == 0u && g_stream_meta.head == 0u);
+}
+
+static void event_append_at(uint32_t ms, uint8_t flags)
+{
+    g_ms = ms;
+    event_log_append(0x7Eu, flags);
+}
+
+TEST(event_log_ring_keeps_previous_sector)
+{
+    uint8_t out[EVENT_LOG_RECORD_SIZE];
+    for (uint32_t i = 0; i < EVENT_LOG_CAPACITY + 10u; ++i)
+        event_append_at(1000u + i * 10u, (uint8_t)i);
+    /* Wrapped into sector 0: it holds 10 records, sector 1 the 204 before. */
+    ASSERT_TRUE(g_event_meta.count == EVENT_LOG_SECTOR_RECORDS + 10u);
+    ASSERT_TRUE(g_event_meta.seq == 1u + EVENT_LOG_CAPACITY + 10u);
+    ASSERT_TRUE(event_log_copy(0u, 1u, out) == 1u);
+    ASSERT_TRUE(out[5] == (uint8_t)(EVENT_LOG_SECTOR_RECORDS));
+    ASSERT_TRUE(event_log_copy((uint16_t)(g_event_meta.count - 1u), 1u, out) == 1u);
+    ASSERT_TRUE(out[5] == (uint8_t)(EVENT_LOG_CAPACITY + 9u));
+    ASSERT_TRUE(event_log_copy((uint16_t)g_event_meta.count, 1u, out) == 0u);
+}
+
+TEST(event_log_load_reads_headers_not_records)
+{
+    for (uint32_t i = 0; i < 300u; ++i)
+        event_append_at(1000u + i, 0u);
+    event_log_flush();
+    uint32_t seq = g_event_meta.seq;
+    uint32_t head = g_event_meta.head;
+
+    s_reads = 0u;
+    event_log_load();
+    ASSERT_TRUE(g_event_meta.count == 300u);
+    ASSERT_TRUE(g_event_meta.seq == seq && g_event_meta.head == head);
+    /* Two headers plus a binary search of the open sector. */
+    ASSERT_TRUE(s_reads <= 2u + 9u);
+
+    event_append_at(5000u, 0x55u);
+    uint8_t out[EVENT_LOG_RECORD_SIZE];
+    ASSERT_TRUE(event_log_copy(300u, 1u, out) == 1u);
+    ASSERT_TRUE(out[5] == 0x55u && load_be32(&out[0]) == 5000u);
+}
+
+TEST(event_log_seek_by_seq_and_time)
+{
+    for (uint32_t i = 0; i < 250u; ++i)
+        event_append_at(10000u + i * 100u, 0u);
+    ASSERT_TRUE(event_log_seek(EVENT_LOG_SEEK_SEQ, 1u) == 0u);
+    ASSERT_TRUE(event_log_seek(EVENT_LOG_SEEK_SEQ, 101u) == 100u);
+    ASSERT_TRUE(event_log_seek(EVENT_LOG_SEEK_SEQ, 9999u) == 250u);
+    ASSERT_TRUE(event_log_seek(EVENT_LOG_SEEK_MS, 0u) == 0u);
+    ASSERT_TRUE(event_log_seek(EVENT_LOG_SEEK_MS, 10000u + 50u * 100u) == 50u);
+    ASSERT_TRUE(event_log_seek(EVENT_LOG_SEEK_MS, 10000u + 220u * 100u - 1u) == 220u);
+    ASSERT_TRUE(event_log_seek(EVENT_LOG_SEEK_MS, 0xFFFFFFFFu) == 250u);
+}
+
+static void urgent_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[off_of(addr) + i] &= data[i];
+}
+
+TEST(event_log_stages_appends_into_page_runs)
+{
+    uint8_t out[EVENT_LOG_RECORD_SIZE];
+    for (uint32_t i = 0; i < 26u; ++i)
+        event_append_at(1000u + i, (uint8_t)i);
+    /* The sector header, then one run per page: records 0-11 end at byte
+     * 256, 12-24 at 516; 25 waits in RAM. */
+    ASSERT_TRUE(g_event_meta.count == 26u);
+    ASSERT_TRUE(s_event_programs == 3u);
+    event_log_tick(g_ms + EVENT_STAGE_FLUSH_MS - 1u);
+    ASSERT_TRUE(s_event_programs == 3u);
+    event_log_tick(g_ms + EVENT_STAGE_FLUSH_MS);
+    ASSERT_TRUE(s_event_programs == 4u);
+
+    event_log_load();
+    ASSERT_TRUE(g_event_meta.count == 26u && g_event_meta.seq == 27u);
+    ASSERT_TRUE(event_log_copy(25u, 1u, out) == 1u && out[5] == 25u);
+
+    /* Reads see staged records. */
+    event_append_at(5000u, 0x77u);
+    ASSERT_TRUE(s_event_programs == 4u);
+    ASSERT_TRUE(event_log_copy(26u, 1u, out) == 1u && out[5] == 0x77u);
+    ASSERT_TRUE(s_event_programs == 5u);
+
+    /* The brown-out path writes the staged run itself. */
+    event_append_at(6000u, 0x78u);
+    event_log_flush_urgent(urgent_program);
+    event_log_load();
+    ASSERT_TRUE(g_event_meta.count == 28u);
+    ASSERT_TRUE(event_log_copy(27u, 1u, out) == 1u && out[5] == 0x78u);
+}
+
+static log_query_t query_all(uint8_t log, uint8_t mode)
+{
+    log_query_t q = {0};
+    q.log = log;
+    q.mode = mode;
+    q.type_mask = 0xFFFFFFFFu;
+    q.ms_to = 0xFFFFFFFFu;
+    return q;
+}
+
+TEST(event_log_query_filters_and_resumes)
+{
+    for (uint32_t i = 0; i < 250u; ++i)
+    {
+        g_ms = 10000u + i * 100u;
+        g_inputs.speed_dmph = (uint16_t)i;
+        event_log_append((i % 5u) == 0u ? EVT_SENSOR_DROPOUT : EVT_BRAKE, 0u);
+    }
+    uint8_t out[8 * EVENT_LOG_RECORD_SIZE];
+    log_query_result_t res;
+    log_query_t q = query_all(LOG_QUERY_EVENT, LOG_QUERY_RECORDS);
+    q.type_mask = 1u << EVT_SENSOR_DROPOUT;
+    q.ms_from = 10000u + 100u * 100u;
+    q.ms_to = 10000u + 200u * 100u;
+
+    /* Dropouts 100, 105 .. 200, eight per call. */
+    uint16_t off = 0u;
+    uint32_t want = 100u;
+    for (uint8_t call = 0; call < 3u; ++call)
+    {
+        log_query_run(&q, off, 8u, out, &res);
+        ASSERT_TRUE(res.records == (call < 2u ? 8u : 5u));
+        for (uint8_t k = 0; k < res.records; ++k, want += 5u)
+        {
+            ASSERT_TRUE(out[k * EVENT_LOG_RECORD_SIZE + 4u] == EVT_SENSOR_DROPOUT);
+            ASSERT_TRUE(load_be16(&out[k * EVENT_LOG_RECORD_SIZE + 6u]) == want);
+        }
+        off = res.next;
+    }
+    ASSERT_TRUE(want == 205u && off == 250u);
+
+    /* Every other match, resumed mid-way, keeps the same phase. */
+    q.every = 2u;
+    log_query_run(&q, 0u, 2u, out, &res);
+    ASSERT_TRUE(res.records == 2u && load_be16(&out[6]) == 105u && res.next == 116u);
+    log_query_run(&q, res.next, 1u, out, &res);
+    ASSERT_TRUE(res.records == 1u && load_be16(&out[6]) == 125u);
+
+    q.mode = LOG_QUERY_STATS;
+    log_query_run(&q, 0u, 0u, NULL, &res);
+    ASSERT_TRUE(res.matched == 21u && res.min[0] == 100u && res.max[0] == 200u);
+
+    q.mode = LOG_QUERY_BUCKETS;
+    q.bucket_s = 1u;
+    log_query_run(&q, 0u, 0u, NULL, &res);
+    ASSERT_TRUE(res.bucket[0] == 2u && res.bucket[9] == 2u && res.bucket[10] == 1u && res.bucket[11] == 0u);
+}
+
+TEST(stream_log_query_runs_the_clock_and_resumes)
+{
+    for (uint32_t i = 0; i < 1000u; ++i)
+        ride_sample(i);
+    uint8_t out[8 * STREAM_LOG_RECORD_SIZE];
+    log_query_result_t res;
+    log_query_t q = query_all(LOG_QUERY_STREAM, LOG_QUERY_RECORDS);
+    q.flags_mask = 0x01u;
+    q.flags_want = 0x01u;
+
+    /* Braking samples are every 11th; resuming from 500 starts at 506. */
+    log_query_run(&q, 500u, 1u, out, &res);
+    ASSERT_TRUE(res.records == 1u && res.next == 507u && record_matches(out, 506u));
+
+    q.mode = LOG_QUERY_STATS;
+    log_query_run(&q, 0u, 0u, NULL, &res);
+    ASSERT_TRUE(res.matched == 91u && res.next == 1000u);
+    ASSERT_TRUE(res.min[3] == (uint16_t)(520 - 19) && res.max[3] == 520u);
+
+    /* Sample i sits 200 ms * i into the log. */
+    q.mode = LOG_QUERY_BUCKETS;
+    q.ms_from = 200u * 957u;
+    log_query_run(&q, 0u, 0u, NULL, &res);
+    ASSERT_TRUE(res.matched == 4u && res.bucket[0] == 4u);
+}
+
+int main(void)
+{
+    printf("\nFlash Log Unit Tests\n");
+    printf("====================\n\n");
+
+    RUN_TEST(roundtrip_across_pages_and_ram);
+    RUN_TEST(retention_is_several_times_v1);
+    RUN_TEST(reload_recovers_flushed_samples);
+    RUN_TEST(corrupt_page_resets_log);
+    RUN_TEST(event_log_ring_keeps_previous_sector);
+    RUN_TEST(event_log_load_reads_headers_not_records);
+    RUN_TEST(event_log_seek_by_seq_and_time);
+    RUN_TEST(event_log_stages_appends_into_page_runs);
+    RUN_TEST(event_log_query_filters_and_resumes);
+    RUN_TEST(stream_log_query_runs_the_clock_and_resumes);
+
+    printf("\n");
+    printf("====================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("====================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
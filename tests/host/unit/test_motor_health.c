@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdint.h>
+
+#include "motor_health.h"
+
+static int g_failures = 0;
+
+static void assert_eq_u32(uint32_t got, uint32_t want, const char *msg)
+{
+    if (got != want)
+    {
+        fprintf(stderr, "FAIL: %s (got=%u want=%u)\n", msg, (unsigned)got, (unsigned)want);
+        g_failures++;
+    }
+}
+
+static void test_rate_and_jitter(void)
+{
+    motor_health_reset();
+    uint32_t t = 1000u;
+    for (uint8_t i = 0; i < 10u; ++i, t += 100u)
+        motor_health_on_frame(0u, 0x52u, t);
+    /* One late frame: 150 ms after a 100 ms cadence -> jitter 50 (32-63 bucket). */
+    motor_health_on_frame(0u, 0x52u, t + 50u);
+
+    const motor_health_t *h = motor_health_get();
+    assert_eq_u32(h->op_count, 1u, "one stream tracked");
+    assert_eq_u32(h->ops[0].frames, 11u, "frame count");
+    assert_eq_u32(h->ops[0].jitter_hist[0], 8u, "steady intervals in <1 ms bucket");
+    assert_eq_u32(h->ops[0].jitter_hist[6], 1u, "late frame in 32-63 ms bucket");
+    /* Mean moved 100 -> (700 + 150 + 4) / 8 = 106 ms -> 9.4 Hz. */
+    assert_eq_u32(motor_health_rate_x10(&h->ops[0]), 94u, "rate from mean interval");
+}
+
+static void test_slot_overflow(void)
+{
+    motor_health_reset();
+    for (uint8_t op = 0; op < MOTOR_HEALTH_OP_SLOTS + 2u; ++op)
+        motor_health_on_frame(1u, op, 10u);
+    const motor_health_t *h = motor_health_get();
+    assert_eq_u32(h->op_count, MOTOR_HEALTH_OP_SLOTS, "slot table full");
+    assert_eq_u32(h->untracked_frames, 2u, "overflow counted");
+}
+
+static void test_error_taxonomy(void)
+{
+    motor_health_reset();
+    motor_health_on_error(0x02u, 0u);
+    motor_health_on_error(0x02u, 0u);
+    motor_health_on_error(0xFEu, 0u);
+    motor_health_on_error(0x10u, 0u);
+    motor_health_on_parse_error();
+    const motor_health_t *h = motor_health_get();
+    assert_eq_u32(h->crc_errors, 2u, "checksum errors");
+    assert_eq_u32(h->framing_errors, 1u, "framing errors");
+    assert_eq_u32(h->other_errors, 1u, "other errors");
+    assert_eq_u32(h->parse_errors, 1u, "parse errors");
+}
+
+static void test_outage(void)
+{
+    motor_health_reset();
+    /* Timeouts before the first frame are not an outage. */
+    motor_health_on_timeout(2000u);
+    assert_eq_u32(motor_health_get()->outages, 0u, "no outage before link up");
+
+    motor_health_on_frame(0u, 0x52u, 3000u);
+    motor_health_on_timeout(3100u);
+    assert_eq_u32(motor_health_down_ms(3100u), 0u, "short gap is not down");
+    motor_health_on_timeout(3600u);
+    assert_eq_u32(motor_health_down_ms(3700u), 700u, "down since last frame");
+    motor_health_on_timeout(3800u);
+    motor_health_on_frame(0u, 0x52u, 4200u);
+
+    const motor_health_t *h = motor_health_get();
+    assert_eq_u32(h->timeouts, 4u, "timeouts counted");
+    assert_eq_u32(h->outages, 1u, "one outage");
+    assert_eq_u32(h->outage_last_ms, 1200u, "outage length");
+    assert_eq_u32(h->outage_total_ms, 1200u, "outage total");
+    assert_eq_u32(motor_health_down_ms(4300u), 0u, "link back up");
+}
+
+int main(void)
+{
+    test_rate_and_jitter();
+    test_slot_overflow();
+    test_error_taxonomy();
+    test_outage();
+
+    if (g_failures)
+    {
+        fprintf(stderr, "%d failure(s)\n", g_failures);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,481 @@
+/*
+ * Unit Tests for OTA ingest into an A/B slot.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "storage/ab_update.h"
+#include "storage/ota.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+#include "util/lz_stream.h"
+
+#define FLASH_SIZE ((size_t)AB_SLOT1_BASE + (size_t)AB_SLOT_STRIDE)
+#define JOB_DEPTH 3u
+
+static uint8_t s_flash[FLASH_SIZE];
+
+uint8_t g_ab_active_slot;
+uint8_t g_ab_pending_slot;
+uint8_t g_ab_last_good_slot;
+uint8_t g_ab_active_valid;
+uint8_t g_ab_pending_valid;
+uint32_t g_ab_active_build_id;
+
+/* Programs stay queued, borrowing the caller's buffer, until a flush. */
+typedef struct {
+    uint32_t addr;
+    const uint8_t *data;
+    uint32_t len;
+    void (*done)(void *ctx, uint8_t ok);
+    void *ctx;
+} job_t;
+
+static job_t s_jobs[JOB_DEPTH];
+static uint32_t s_job_count;
+static uint32_t s_flushes;
+
+uint8_t ab_slot_valid(uint8_t slot)
+{
+    return (slot <= 1u) ? 1u : 0u;
+}
+
+/* Header fields only; the image CRC check is the firmware's business. */
+int ab_slot_read_header(uint8_t slot, ab_slot_hdr_t *out)
+{
+    const uint8_t *p = &s_flash[(slot == 0u) ? AB_SLOT0_BASE : AB_SLOT1_BASE];
+    if (load_be32(&p[0]) != AB_SLOT_MAGIC)
+        return 0;
+    out->header_size = load_be16(&p[6]);
+    out->image_size = load_be32(&p[8]);
+    out->crc32 = load_be32(&p[12]);
+    return 1;
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    memcpy(out, &s_flash[addr], len);
+}
+
+uint8_t ab_update_set_pending(uint8_t slot)
+{
+    g_ab_pending_slot = slot;
+    return 0u;
+}
+
+static void program_now(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[addr + i] &= data[i];
+}
+
+void flash_jobs_flush(void)
+{
+    for (uint32_t i = 0; i < s_job_count; ++i)
+    {
+        program_now(s_jobs[i].addr, s_jobs[i].data, s_jobs[i].len);
+        if (s_jobs[i].done)
+            s_jobs[i].done(s_jobs[i].ctx, 1u);
+    }
+    s_job_count = 0u;
+    s_flushes++;
+}
+
+int flash_jobs_submit_program(uint32_t addr, const uint8_t *data, uint32_t len,
+                              void (*done)(void *ctx, uint8_t ok), void *ctx)
+{
+    if (s_job_count >= JOB_DEPTH)
+        return 0;
+    s_jobs[s_job_count].addr = addr;
+    s_jobs[s_job_count].data = data;
+    s_jobs[s_job_count].len = len;
+    s_jobs[s_job_count].done = done;
+    s_jobs[s_job_count].ctx = ctx;
+    s_job_count++;
+    return 1;
+}
+
+void flash_jobs_erase(uint32_t addr)
+{
+    flash_jobs_flush();
+    memset(&s_flash[addr & ~(SPI_FLASH_SECTOR_SIZE - 1u)], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+void flash_jobs_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    flash_jobs_flush();
+    program_now(addr, data, len);
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static uint8_t s_image[9000];
+
+static void setup(void)
+{
+    memset(s_flash, 0x00, sizeof(s_flash));
+    s_job_count = 0u;
+    s_flushes = 0u;
+    g_ab_active_slot = 0u;
+    g_ab_pending_slot = AB_SLOT_NONE;
+    for (uint32_t i = 0; i < sizeof(s_image); ++i)
+        s_image[i] = (uint8_t)(i * 13u + (i >> 8));
+    ota_abort();
+}
+
+static uint32_t stream(uint32_t size, uint32_t chunk)
+{
+    uint32_t acks = 0u;
+    for (uint32_t off = 0; off < size; off += chunk)
+    {
+        uint32_t n = (size - off < chunk) ? size - off : chunk;
+        if (ota_write(off, &s_image[off], n) != OTA_STATUS_OK)
+            return 0xFFFFFFFFu;
+        acks += ota_ack_due();
+    }
+    return acks;
+}
+
+TEST(streams_image_into_slot)
+{
+    uint32_t crc = crc32_compute(s_image, sizeof(s_image));
+    ASSERT_TRUE(ota_begin(1u, sizeof(s_image), crc, 0x00C0FFEEu, 4u) == OTA_STATUS_OK);
+
+    /* 9000 / 188 = 48 chunks, acked every 2 chunks. */
+    ASSERT_TRUE(stream(sizeof(s_image), OTA_CHUNK_MAX) == 24u);
+    ASSERT_TRUE(ota_finish(1u) == OTA_STATUS_OK);
+
+    const uint8_t *slot = &s_flash[AB_SLOT1_BASE];
+    ASSERT_TRUE(load_be32(&slot[0]) == AB_SLOT_MAGIC);
+    ASSERT_TRUE(load_be32(&slot[8]) == sizeof(s_image));
+    ASSERT_TRUE(load_be32(&slot[12]) == crc);
+    ASSERT_TRUE(load_be32(&slot[16]) == 0x00C0FFEEu);
+    ASSERT_TRUE(memcmp(&slot[AB_SLOT_HEADER_SIZE], s_image, sizeof(s_image)) == 0);
+    ASSERT_TRUE(g_ab_pending_slot == 1u);
+
+    ota_status_t st;
+    ota_get_status(&st);
+    ASSERT_TRUE(st.active == 0u);
+    ASSERT_TRUE(st.next_offset == sizeof(s_image));
+    /* (32 + 9000) bytes span 36 pages. */
+    ASSERT_TRUE(st.pages == 36u);
+}
+
+TEST(gap_and_duplicate_chunks)
+{
+    uint32_t crc = crc32_compute(s_image, 600u);
+    ASSERT_TRUE(ota_begin(1u, 600u, crc, 1u, 1u) == OTA_STATUS_OK);
+
+    ASSERT_TRUE(ota_write(0u, &s_image[0], 100u) == OTA_STATUS_OK);
+    ASSERT_TRUE(ota_ack_due() == 1u);
+    ASSERT_TRUE(ota_write(200u, &s_image[200], 100u) == OTA_STATUS_GAP);
+    ASSERT_TRUE(ota_write(0u, &s_image[0], 100u) == OTA_STATUS_DUP);
+    /* Overlapping resend contributes only its new tail. */
+    ASSERT_TRUE(ota_write(50u, &s_image[50], 150u) == OTA_STATUS_OK);
+    ASSERT_TRUE(ota_write(200u, &s_image[200], 188u) == OTA_STATUS_OK);
+    ASSERT_TRUE(ota_write(388u, &s_image[388], 188u) == OTA_STATUS_OK);
+    ASSERT_TRUE(ota_write(576u, &s_image[576], 30u) == OTA_STATUS_BAD_SIZE);
+    ASSERT_TRUE(ota_write(576u, &s_image[576], 24u) == OTA_STATUS_OK);
+    ASSERT_TRUE(ota_finish(0u) == OTA_STATUS_OK);
+    ASSERT_TRUE(memcmp(&s_flash[AB_SLOT1_BASE + AB_SLOT_HEADER_SIZE], s_image, 600u) == 0);
+    ASSERT_TRUE(g_ab_pending_slot == AB_SLOT_NONE);
+
+    ota_status_t st;
+    ota_get_status(&st);
+    ASSERT_TRUE(st.gaps == 1u && st.dups == 1u);
+}
+
+TEST(bad_crc_leaves_slot_without_header)
+{
+    ASSERT_TRUE(ota_begin(1u, 1000u, 0x12345678u, 1u, 8u) == OTA_STATUS_OK);
+    ASSERT_TRUE(stream(1000u, 100u) != 0xFFFFFFFFu);
+    ASSERT_TRUE(ota_finish(1u) == OTA_STATUS_BAD_IMAGE);
+    ASSERT_TRUE(load_be32(&s_flash[AB_SLOT1_BASE]) == 0xFFFFFFFFu);
+    ASSERT_TRUE(g_ab_pending_slot == AB_SLOT_NONE);
+}
+
+TEST(short_image_is_rejected)
+{
+    ASSERT_TRUE(ota_begin(1u, 1000u, 0u, 1u, 2u) == OTA_STATUS_OK);
+    ASSERT_TRUE(stream(500u, 100u) != 0xFFFFFFFFu);
+    ASSERT_TRUE(ota_finish(0u) == OTA_STATUS_BAD_IMAGE);
+    ASSERT_TRUE(ota_write(500u, s_image, 10u) == OTA_STATUS_NO_SESSION);
+}
+
+TEST(begin_validates_slot_and_size)
+{
+    ASSERT_TRUE(ota_begin(0u, 100u, 0u, 0u, 1u) == OTA_STATUS_BAD_SLOT);
+    ASSERT_TRUE(ota_begin(2u, 100u, 0u, 0u, 1u) == OTA_STATUS_BAD_SLOT);
+    ASSERT_TRUE(ota_begin(1u, 0u, 0u, 0u, 1u) == OTA_STATUS_BAD_SIZE);
+    ASSERT_TRUE(ota_begin(1u, AB_SLOT_MAX_IMAGE + 1u, 0u, 0u, 1u) == OTA_STATUS_BAD_SIZE);
+
+    g_ab_pending_slot = 1u;
+    ASSERT_TRUE(ota_begin(1u, 100u, 0u, 0u, 200u) == OTA_STATUS_OK);
+    ASSERT_TRUE(g_ab_pending_slot == AB_SLOT_NONE);
+    ota_status_t st;
+    ota_get_status(&st);
+    ASSERT_TRUE(st.window == OTA_WINDOW_MAX);
+    ASSERT_TRUE(st.ack_every == OTA_WINDOW_MAX / 2u);
+}
+
+static uint32_t s_lz_head[4096];
+static uint8_t s_lz[10000];
+
+static uint32_t lz_put_len(uint8_t *out, uint32_t o, uint32_t n)
+{
+    for (; n >= 255u; n -= 255u)
+        out[o++] = 255u;
+    out[o++] = (uint8_t)n;
+    return o;
+}
+
+static uint32_t lz_sequence(uint8_t *out, uint32_t o, const uint8_t *lit, uint32_t nlit,
+                            uint32_t dist, uint32_t mlen)
+{
+    uint32_t m = mlen ? mlen - LZ_STREAM_MIN_MATCH : 0u;
+    out[o++] = (uint8_t)(((nlit < 15u ? nlit : 15u) << 4) | (m < 15u ? m : 15u));
+    if (nlit >= 15u)
+        o = lz_put_len(out, o, nlit - 15u);
+    memcpy(&out[o], lit, nlit);
+    o += nlit;
+    if (!mlen)
+        return o;
+    out[o++] = (uint8_t)dist;
+    out[o++] = (uint8_t)(dist >> 8);
+    if (m >= 15u)
+        o = lz_put_len(out, o, m - 15u);
+    return o;
+}
+
+/* Greedy encoder for the stream format (scripts/ble_ota_push.py --lz). */
+static uint32_t lz_compress(const uint8_t *in, uint32_t n, uint8_t *out)
+{
+    memset(s_lz_head, 0, sizeof(s_lz_head));
+    uint32_t o = 0u, anchor = 0u, i = 0u;
+    while (i + LZ_STREAM_MIN_MATCH <= n)
+    {
+        uint32_t h = (load_be32(&in[i]) * 2654435761u) >> 20;
+        uint32_t cand = s_lz_head[h];
+        s_lz_head[h] = i + 1u;
+        uint32_t len = 0u;
+        if (cand && i - (cand - 1u) <= LZ_STREAM_WINDOW)
+        {
+            while (i + len < n && in[cand - 1u + len] == in[i + len])
+                len++;
+        }
+        if (len < LZ_STREAM_MIN_MATCH)
+        {
+            i++;
+            continue;
+        }
+        o = lz_sequence(out, o, &in[anchor], i - anchor, i - (cand - 1u), len);
+        i += len;
+        anchor = i;
+    }
+    return lz_sequence(out, o, &in[anchor], n - anchor, 0u, 0u);
+}
+
+TEST(lz_stream_decodes_into_slot)
+{
+    uint32_t crc = crc32_compute(s_image, sizeof(s_image));
+    uint32_t zlen = lz_compress(s_image, sizeof(s_image), s_lz);
+    ASSERT_TRUE(zlen < sizeof(s_image) / 2u);
+    ASSERT_TRUE(ota_begin_lz(1u, sizeof(s_image), crc, 7u, 4u, zlen) == OTA_STATUS_OK);
+
+    /* Odd chunk sizes split tokens, lengths and offsets across writes. */
+    for (uint32_t off = 0; off < zlen; off += 37u)
+    {
+        uint32_t n = (zlen - off < 37u) ? zlen - off : 37u;
+        ASSERT_TRUE(ota_write(off, &s_lz[off], n) == OTA_STATUS_OK);
+    }
+    ASSERT_TRUE(ota_finish(0u) == OTA_STATUS_OK);
+
+    const uint8_t *slot = &s_flash[AB_SLOT1_BASE];
+    ASSERT_TRUE(load_be32(&slot[8]) == sizeof(s_image));
+    ASSERT_TRUE(load_be32(&slot[12]) == crc);
+    ASSERT_TRUE(memcmp(&slot[AB_SLOT_HEADER_SIZE], s_image, sizeof(s_image)) == 0);
+
+    ota_status_t st;
+    ota_get_status(&st);
+    ASSERT_TRUE(st.format == OTA_FORMAT_LZ);
+    ASSERT_TRUE(st.size == zlen && st.next_offset == zlen);
+    ASSERT_TRUE(st.written == sizeof(s_image));
+}
+
+TEST(lz_bad_stream_is_rejected)
+{
+    /* One literal, then a match reaching back past the start. */
+    static const uint8_t bad[] = {0x10u, 'A', 0x05u, 0x00u};
+    ASSERT_TRUE(ota_begin_lz(1u, 100u, 0u, 1u, 1u, 1000u) == OTA_STATUS_BAD_SIZE);
+    ASSERT_TRUE(ota_begin_lz(1u, 100u, 0u, 1u, 1u, sizeof(bad)) == OTA_STATUS_OK);
+    ASSERT_TRUE(ota_write(0u, bad, sizeof(bad)) == OTA_STATUS_BAD_STREAM);
+    ASSERT_TRUE(ota_finish(0u) == OTA_STATUS_BAD_IMAGE);
+
+    /* A stream that decodes past the image size. */
+    static const uint8_t big[] = {0x1Fu, 'A', 0x01u, 0x00u, 200u};
+    ASSERT_TRUE(ota_begin_lz(1u, 100u, 0u, 1u, 1u, sizeof(big)) == OTA_STATUS_OK);
+    ASSERT_TRUE(ota_write(0u, big, sizeof(big)) == OTA_STATUS_BAD_STREAM);
+    ASSERT_TRUE(ota_finish(0u) == OTA_STATUS_BAD_IMAGE);
+    ASSERT_TRUE(load_be32(&s_flash[AB_SLOT1_BASE]) == 0xFFFFFFFFu);
+}
+
+/* Base image in slot 0 as ota_finish would have left it. */
+static uint32_t put_base(const uint8_t *image, uint32_t len)
+{
+    uint8_t *p = &s_flash[AB_SLOT0_BASE];
+    uint32_t crc = crc32_compute(image, len);
+    store_be32(&p[0], AB_SLOT_MAGIC);
+    store_be16(&p[4], AB_SLOT_VERSION);
+    store_be16(&p[6], AB_SLOT_HEADER_SIZE);
+    store_be32(&p[8], len);
+    store_be32(&p[12], crc);
+    memcpy(&p[AB_SLOT_HEADER_SIZE], image, len);
+    return crc;
+}
+
+static uint32_t delta_copy(uint8_t *out, uint32_t o, uint32_t src, uint32_t len)
+{
+    out[o] = OTA_DELTA_COPY;
+    store_be32(&out[o + 1u], src);
+    store_be32(&out[o + 5u], len);
+    return o + 9u;
+}
+
+static uint32_t delta_insert(uint8_t *out, uint32_t o, const uint8_t *data, uint32_t len)
+{
+    out[o] = OTA_DELTA_INSERT;
+    store_be32(&out[o + 1u], len);
+    memcpy(&out[o + 5u], data, len);
+    return o + 5u + len;
+}
+
+TEST(delta_rebuilds_image_from_active_slot)
+{
+    static uint8_t base[sizeof(s_image)];
+    for (uint32_t i = 0; i < sizeof(base); ++i)
+        base[i] = (uint8_t)(i * 7u + 3u);
+    uint32_t base_crc = put_base(base, sizeof(base));
+
+    /* New image: moved base code, a patched run, and base code again. */
+    memcpy(&s_image[0], &base[1000], 5000u);
+    memset(&s_image[5000], 0x5Au, 40u);
+    memcpy(&s_image[5040], &base[0], sizeof(s_image) - 5040u);
+    uint32_t o = delta_copy(s_lz, 0u, 1000u, 5000u);
+    o = delta_insert(s_lz, o, &s_image[5000], 40u);
+    o = delta_copy(s_lz, o, 0u, sizeof(s_image) - 5040u);
+    uint32_t crc = crc32_compute(s_image, sizeof(s_image));
+
+    ASSERT_TRUE(ota_begin_delta(1u, sizeof(s_image), crc, 9u, 4u, o, base_crc ^ 1u) == OTA_STATUS_BAD_BASE);
+    ASSERT_TRUE(ota_begin_delta(1u, sizeof(s_image), crc, 9u, 4u, o, base_crc) == OTA_STATUS_OK);
+
+    /* Long copies refuse the rest of a chunk until ota_tick catches up. */
+    uint32_t off = 0u;
+    uint32_t busy = 0u;
+    while (off < o)
+    {
+        uint32_t n = (o - off < 7u) ? o - off : 7u;
+        uint8_t status = ota_write(off, &s_lz[off], n);
+        ota_status_t st;
+        ota_get_status(&st);
+        if (status == OTA_STATUS_BUSY)
+        {
+            busy++;
+            ota_tick();
+        }
+        else
+        {
+            ASSERT_TRUE(status == OTA_STATUS_OK);
+        }
+        off = st.next_offset;
+    }
+    ASSERT_TRUE(busy > 0u);
+    ASSERT_TRUE(ota_finish(1u) == OTA_STATUS_OK);
+
+    const uint8_t *slot = &s_flash[AB_SLOT1_BASE];
+    ASSERT_TRUE(load_be32(&slot[8]) == sizeof(s_image));
+    ASSERT_TRUE(load_be32(&slot[12]) == crc);
+    ASSERT_TRUE(memcmp(&slot[AB_SLOT_HEADER_SIZE], s_image, sizeof(s_image)) == 0);
+    ASSERT_TRUE(g_ab_pending_slot == 1u);
+
+    ota_status_t st;
+    ota_get_status(&st);
+    ASSERT_TRUE(st.format == OTA_FORMAT_DELTA);
+    ASSERT_TRUE(st.busy == busy);
+}
+
+TEST(delta_bad_ops_are_rejected)
+{
+    uint32_t base_crc = put_base(s_image, 100u);
+    uint8_t ops[16];
+
+    /* No valid image in the active slot. */
+    ASSERT_TRUE(ota_begin_delta(0u, 50u, 0u, 1u, 1u, 9u, base_crc) == OTA_STATUS_BAD_SLOT);
+    g_ab_active_slot = 1u;
+    ASSERT_TRUE(ota_begin_delta(0u, 50u, 0u, 1u, 1u, 9u, base_crc) == OTA_STATUS_BAD_BASE);
+    g_ab_active_slot = 0u;
+
+    /* Copy reaching past the base image. */
+    uint32_t o = delta_copy(ops, 0u, 60u, 50u);
+    ASSERT_TRUE(ota_begin_delta(1u, 50u, 0u, 1u, 1u, o, base_crc) == OTA_STATUS_OK);
+    ASSERT_TRUE(ota_write(0u, ops, o) == OTA_STATUS_BAD_STREAM);
+    ASSERT_TRUE(ota_finish(0u) == OTA_STATUS_BAD_IMAGE);
+
+    /* Unknown op. */
+    ops[0] = 0x7Eu;
+    ASSERT_TRUE(ota_begin_delta(1u, 50u, 0u, 1u, 1u, 1u, base_crc) == OTA_STATUS_OK);
+    ASSERT_TRUE(ota_write(0u, ops, 1u) == OTA_STATUS_BAD_STREAM);
+    ASSERT_TRUE(ota_finish(0u) == OTA_STATUS_BAD_IMAGE);
+
+    /* Output past the image size. */
+    o = delta_copy(ops, 0u, 0u, 60u);
+    ASSERT_TRUE(ota_begin_delta(1u, 50u, 0u, 1u, 1u, o, base_crc) == OTA_STATUS_OK);
+    ASSERT_TRUE(ota_write(0u, ops, o) == OTA_STATUS_BAD_STREAM);
+    ASSERT_TRUE(ota_finish(0u) == OTA_STATUS_BAD_IMAGE);
+    ASSERT_TRUE(load_be32(&s_flash[AB_SLOT1_BASE]) == 0xFFFFFFFFu);
+}
+
+int main(void)
+{
+    printf("\nOTA Ingest Unit Tests\n");
+    printf("======================\n\n");
+
+    RUN_TEST(streams_image_into_slot);
+    RUN_TEST(gap_and_duplicate_chunks);
+    RUN_TEST(bad_crc_leaves_slot_without_header);
+    RUN_TEST(short_image_is_rejected);
+    RUN_TEST(begin_validates_slot_and_size);
+    RUN_TEST(lz_stream_decodes_into_slot);
+    RUN_TEST(lz_bad_stream_is_rejected);
+    RUN_TEST(delta_rebuilds_image_from_active_slot);
+    RUN_TEST(delta_bad_ops_are_rejected);
+
+    printf("\n");
+    printf("======================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("======================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
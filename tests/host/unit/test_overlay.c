@@ -0,0 +1,115 @@
+/*
+ * Unit Tests for the overlay arena's lease and release checks.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform/overlay.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static overlay_stats_t stats(void)
+{
+    overlay_stats_t st;
+    platform_overlay_get_stats(&st);
+    return st;
+}
+
+TEST(one_owner_at_a_time)
+{
+    uint32_t conflicts = stats().conflicts;
+    uint8_t *a = platform_overlay_lease(OVERLAY_OWNER_FLASH_RMW, OVERLAY_ARENA_BYTES);
+    ASSERT_TRUE(a != NULL && ((uintptr_t)a & 3u) == 0u);
+    ASSERT_TRUE(stats().owner == OVERLAY_OWNER_FLASH_RMW);
+
+    ASSERT_TRUE(platform_overlay_lease(OVERLAY_OWNER_CRASH_DUMP, 16u) == NULL);
+    ASSERT_TRUE(stats().conflicts == conflicts + 1u);
+    ASSERT_TRUE(stats().last_conflict == OVERLAY_OWNER_CRASH_DUMP);
+
+    /* Only the holder can give it back. */
+    platform_overlay_release(OVERLAY_OWNER_CRASH_DUMP);
+    ASSERT_TRUE(stats().owner == OVERLAY_OWNER_FLASH_RMW);
+    ASSERT_TRUE(stats().conflicts == conflicts + 2u);
+
+    platform_overlay_release(OVERLAY_OWNER_FLASH_RMW);
+    uint8_t *b = platform_overlay_lease(OVERLAY_OWNER_CRASH_DUMP, 16u);
+    ASSERT_TRUE(b == a);
+    platform_overlay_release(OVERLAY_OWNER_CRASH_DUMP);
+    ASSERT_TRUE(stats().owner == OVERLAY_OWNER_NONE);
+    ASSERT_TRUE(stats().conflicts == conflicts + 2u);
+}
+
+TEST(oversized_lease_is_refused)
+{
+    uint32_t conflicts = stats().conflicts;
+    ASSERT_TRUE(platform_overlay_lease(OVERLAY_OWNER_FLASH_RMW, OVERLAY_ARENA_BYTES + 1u) == NULL);
+    ASSERT_TRUE(stats().owner == OVERLAY_OWNER_NONE);
+    ASSERT_TRUE(stats().conflicts == conflicts + 1u);
+}
+
+TEST(overrun_is_caught_on_release)
+{
+    uint32_t conflicts = stats().conflicts;
+    uint8_t *a = platform_overlay_lease(OVERLAY_OWNER_FLASH_RMW, OVERLAY_ARENA_BYTES);
+    ASSERT_TRUE(a != NULL);
+    memset(a, 0x5A, OVERLAY_ARENA_BYTES);
+    platform_overlay_release(OVERLAY_OWNER_FLASH_RMW);
+    ASSERT_TRUE(stats().conflicts == conflicts);
+
+    a = platform_overlay_lease(OVERLAY_OWNER_FLASH_RMW, OVERLAY_ARENA_BYTES);
+    memset(a, 0x5A, OVERLAY_ARENA_BYTES + 1u);
+    platform_overlay_release(OVERLAY_OWNER_FLASH_RMW);
+    ASSERT_TRUE(stats().conflicts == conflicts + 1u);
+    ASSERT_TRUE(stats().owner == OVERLAY_OWNER_NONE);
+}
+
+TEST(seize_takes_it_from_the_holder)
+{
+    uint8_t *a = platform_overlay_lease(OVERLAY_OWNER_FLASH_RMW, OVERLAY_ARENA_BYTES);
+    ASSERT_TRUE(a != NULL);
+    ASSERT_TRUE(platform_overlay_seize(OVERLAY_OWNER_CRASH_DUMP) == a);
+    ASSERT_TRUE(stats().owner == OVERLAY_OWNER_CRASH_DUMP);
+    ASSERT_TRUE(stats().last_conflict == OVERLAY_OWNER_FLASH_RMW);
+    platform_overlay_release(OVERLAY_OWNER_CRASH_DUMP);
+    ASSERT_TRUE(platform_overlay_lease(OVERLAY_OWNER_FLASH_RMW, 1u) == a);
+    platform_overlay_release(OVERLAY_OWNER_FLASH_RMW);
+}
+
+int main(void)
+{
+    printf("\nOverlay Arena Unit Tests\n");
+    printf("========================\n\n");
+
+    RUN_TEST(one_owner_at_a_time);
+    RUN_TEST(oversized_lease_is_refused);
+    RUN_TEST(overrun_is_caught_on_release);
+    RUN_TEST(seize_takes_it_from_the_holder);
+
+    printf("\n");
+    printf("========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
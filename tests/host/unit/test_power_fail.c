@@ -0,0 +1,223 @@
+/*
+ * Unit Tests for the brown-out records and the trip state they carry.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "storage/power_fail.h"
+#include "storage/flash_jobs.h"
+#include "storage/layout.h"
+#include "drivers/spi_flash.h"
+#include "src/telemetry/trip.h"
+
+static uint8_t s_flash[POWER_FAIL_STORAGE_BYTES];
+static uint32_t s_erases;
+/* Erase jobs wait here until the test lets them complete. */
+#define JOBS 2u
+static struct {
+    uint32_t addr;
+    flash_job_done_fn done;
+    void *ctx;
+} s_jobs[JOBS];
+static uint32_t s_job_count;
+
+static uint32_t off_of(uint32_t addr)
+{
+    return addr - POWER_FAIL_STORAGE_BASE;
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    memcpy(out, &s_flash[off_of(addr)], len);
+}
+
+void spi_flash_erase_4k(uint32_t addr)
+{
+    memset(&s_flash[off_of(addr) & ~(SPI_FLASH_SECTOR_SIZE - 1u)], 0xFF, SPI_FLASH_SECTOR_SIZE);
+    s_erases++;
+}
+
+uint8_t spi_flash_urgent_begin(void)
+{
+    return 1u;
+}
+
+void spi_flash_urgent_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[off_of(addr) + i] &= data[i];
+}
+
+void flash_jobs_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    spi_flash_urgent_program(addr, data, len);
+}
+
+int flash_jobs_submit_erase(uint32_t addr, flash_job_done_fn done, void *ctx)
+{
+    if (s_job_count == JOBS)
+        return 0;
+    s_jobs[s_job_count].addr = addr;
+    s_jobs[s_job_count].done = done;
+    s_jobs[s_job_count].ctx = ctx;
+    s_job_count++;
+    return 1;
+}
+
+void flash_jobs_flush(void)
+{
+    for (uint32_t i = 0; i < s_job_count; ++i)
+    {
+        spi_flash_erase_4k(s_jobs[i].addr);
+        s_jobs[i].done(s_jobs[i].ctx, 1u);
+    }
+    s_job_count = 0u;
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define SLOTS_PER_SECTOR (SPI_FLASH_SECTOR_SIZE / POWER_FAIL_SLOT_SIZE)
+
+static void setup(void)
+{
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    s_erases = 0u;
+    s_job_count = 0u;
+}
+
+static uint8_t *slot_at(uint32_t slot)
+{
+    return &s_flash[slot * POWER_FAIL_SLOT_SIZE];
+}
+
+/* One brown-out, then one boot; returns what the boot got back. */
+static uint32_t cut_and_boot(uint8_t tag, uint8_t *out)
+{
+    uint8_t payload[4] = { tag, 0x11u, 0x22u, 0x33u };
+    if (!power_fail_write_urgent(payload, sizeof(payload)))
+        return 0u;
+    return power_fail_take(out, POWER_FAIL_PAYLOAD_MAX);
+}
+
+TEST(record_is_taken_once_and_torn_records_are_skipped)
+{
+    uint8_t out[POWER_FAIL_PAYLOAD_MAX];
+    ASSERT_TRUE(power_fail_take(out, sizeof(out)) == 0u);
+
+    ASSERT_TRUE(cut_and_boot(0xA1u, out) == 4u);
+    ASSERT_TRUE(out[0] == 0xA1u && out[3] == 0x33u);
+    ASSERT_TRUE(slot_at(0)[255] == 0x00u);
+    /* Taken records do not come back on the next boot. */
+    ASSERT_TRUE(power_fail_take(out, sizeof(out)) == 0u);
+
+    /* The next cut lands in the following slot; a tear there leaves the
+     * older, already taken record, so nothing is restored. */
+    uint8_t payload[4] = { 0xB2u, 0, 0, 0 };
+    ASSERT_TRUE(power_fail_write_urgent(payload, sizeof(payload)));
+    ASSERT_TRUE(slot_at(1)[12] == 0xB2u);
+    slot_at(1)[40] = 0x00u;
+    ASSERT_TRUE(power_fail_take(out, sizeof(out)) == 0u);
+
+    /* The torn page is not reused; the next record skips it. */
+    ASSERT_TRUE(cut_and_boot(0xC3u, out) == 4u && out[0] == 0xC3u);
+    ASSERT_TRUE(slot_at(2)[12] == 0xC3u);
+    ASSERT_TRUE(s_erases == 0u);
+}
+
+TEST(spent_sector_is_erased_before_it_is_handed_out)
+{
+    uint8_t out[POWER_FAIL_PAYLOAD_MAX];
+    (void)power_fail_take(out, sizeof(out));
+    for (uint8_t i = 0; i < SLOTS_PER_SECTOR; ++i)
+        ASSERT_TRUE(cut_and_boot(i, out) == 4u && out[0] == i);
+    /* Sector 0 is spent: its erase is queued while sector 1 takes writes. */
+    ASSERT_TRUE(s_job_count == 1u && s_jobs[0].addr == POWER_FAIL_STORAGE_BASE);
+    flash_jobs_flush();
+    ASSERT_TRUE(s_erases == 1u);
+    for (uint8_t i = 0; i < SLOTS_PER_SECTOR; ++i)
+        ASSERT_TRUE(cut_and_boot((uint8_t)(0x40u + i), out) == 4u && out[0] == 0x40u + i);
+    ASSERT_TRUE(slot_at(2u * SLOTS_PER_SECTOR - 1u)[12] == 0x4Fu);
+    ASSERT_TRUE(s_job_count == 1u && s_jobs[0].addr == POWER_FAIL_STORAGE_BASE + SPI_FLASH_SECTOR_SIZE);
+    flash_jobs_flush();
+
+    /* No erased page at all: nothing is written until an erase completes. */
+    memset(s_flash, 0x00, sizeof(s_flash));
+    ASSERT_TRUE(power_fail_take(out, sizeof(out)) == 0u);
+    uint8_t payload[4] = { 0xEEu, 0, 0, 0 };
+    ASSERT_TRUE(!power_fail_write_urgent(payload, sizeof(payload)));
+    flash_jobs_flush();
+    ASSERT_TRUE(power_fail_write_urgent(payload, sizeof(payload)));
+    ASSERT_TRUE(power_fail_take(out, sizeof(out)) == 4u && out[0] == 0xEEu);
+}
+
+TEST(trip_state_resumes_the_running_trip)
+{
+    uint8_t state[TRIP_STATE_SIZE];
+    trip_init();
+    ASSERT_TRUE(trip_state_save(state) == 0u);
+
+    for (uint32_t t = 1000u; t <= 61000u; t += 200u)
+        trip_update(t, 150u, 300u, 0u, 1u, 3u, 2u, 80, 350);
+    trip_acc_t before = *trip_get_acc();
+    trip_hist_t hist = *trip_get_histogram();
+    ASSERT_TRUE(trip_state_save(state) == TRIP_STATE_SIZE);
+
+    /* A power cycle later the clock starts over near zero. */
+    trip_init();
+    ASSERT_TRUE(trip_get_acc()->distance_mm == 0u);
+    ASSERT_TRUE(trip_state_restore(state, sizeof(state)));
+    const trip_acc_t *acc = trip_get_acc();
+    ASSERT_TRUE(acc->distance_mm == before.distance_mm && acc->distance_mm > 0u);
+    ASSERT_TRUE(acc->energy_mwh == before.energy_mwh);
+    ASSERT_TRUE(acc->elapsed_ms == before.elapsed_ms);
+    ASSERT_TRUE(acc->max_speed_dmph == 150u);
+    ASSERT_TRUE(acc->gear_time_ms[2] == before.gear_time_ms[2]);
+    ASSERT_TRUE(memcmp(trip_get_histogram(), &hist, sizeof(hist)) == 0);
+
+    trip_update(500u, 150u, 300u, 0u, 1u, 3u, 2u, 80, 350);
+    trip_update(700u, 150u, 300u, 0u, 1u, 3u, 2u, 80, 350);
+    ASSERT_TRUE(trip_get_acc()->elapsed_ms == before.elapsed_ms + 200u);
+
+    state[0] ^= 0xFFu;
+    ASSERT_TRUE(!trip_state_restore(state, sizeof(state)));
+    ASSERT_TRUE(!trip_state_restore(state, sizeof(state) - 1u));
+}
+
+int main(void)
+{
+    printf("\nPower Fail Unit Tests\n");
+    printf("=====================\n\n");
+
+    RUN_TEST(record_is_taken_once_and_torn_records_are_skipped);
+    RUN_TEST(spent_sector_is_erased_before_it_is_handed_out);
+    RUN_TEST(trip_state_resumes_the_running_trip);
+
+    printf("\n");
+    printf("=====================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("=====================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
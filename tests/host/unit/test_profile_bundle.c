@@ -0,0 +1,250 @@
+/*
+ * Unit Tests for the profile bundle (import/export of every assist table).
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "src/profiles/profile_bundle.h"
+#include "src/profiles/profiles.h"
+#include "src/control/control.h"
+#include "storage/layout.h"
+#include "drivers/spi_flash.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+vgear_table_t g_vgears;
+cadence_bias_t g_cadence_bias;
+uint8_t g_active_vgear;
+
+static uint8_t s_flash[SPI_FLASH_SECTOR_SIZE];
+static uint32_t s_erases;
+static uint32_t s_rebuilds;
+
+static uint32_t off_of(uint32_t addr)
+{
+    return addr - PROFILE_BUNDLE_STORAGE_BASE;
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    memcpy(out, &s_flash[off_of(addr)], len);
+}
+
+void spi_flash_erase_4k(uint32_t addr)
+{
+    memset(&s_flash[off_of(addr)], 0xFF, SPI_FLASH_SECTOR_SIZE);
+    s_erases++;
+}
+
+void spi_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[off_of(addr) + i] &= data[i];
+}
+
+void outputs_tables_changed(void)
+{
+    s_rebuilds++;
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define CHUNK 184u
+/* Body offset of profile 1's speed curve, and of the gear table. */
+#define OFF_P1_SPEED (PROFILE_BUNDLE_HEADER_BYTES + PROFILE_BUNDLE_PROFILE_BYTES + 6u)
+#define OFF_GEARS    (PROFILE_BUNDLE_HEADER_BYTES + PROFILE_COUNT * PROFILE_BUNDLE_PROFILE_BYTES)
+
+static uint8_t s_img[PROFILE_BUNDLE_BYTES];
+
+static void setup(void)
+{
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    s_erases = 0u;
+    s_rebuilds = 0u;
+    profiles_defaults();
+    vgear_defaults();
+    cadence_bias_defaults();
+    profile_bundle_load();
+}
+
+static void reseal(uint8_t *img)
+{
+    store_be32(&img[8], crc32_compute(&img[PROFILE_BUNDLE_HEADER_BYTES], PROFILE_BUNDLE_BODY_BYTES));
+}
+
+static int upload(const uint8_t *img, uint32_t len)
+{
+    profile_bundle_upload_begin();
+    for (uint32_t off = 0; off < len; off += CHUNK)
+    {
+        uint32_t n = (len - off) < CHUNK ? (len - off) : CHUNK;
+        if (!profile_bundle_upload_write(off, &img[off], n))
+            return 0;
+    }
+    return profile_bundle_upload_finish();
+}
+
+/* An edited export: trail gets a 500 W cap and a 3-point curve, 8 exp gears,
+ * cadence bias on. */
+static void make_edited(uint8_t *img)
+{
+    profile_bundle_encode(img);
+    uint8_t *p1 = &img[OFF_P1_SPEED - 6u];
+    store_be16(&p1[0], 500u);
+    uint8_t *c = &img[OFF_P1_SPEED];
+    memset(c, 0, PROFILE_BUNDLE_CURVE_BYTES);
+    c[0] = 3u;
+    store_be16(&c[1], 0u);
+    store_be16(&c[3], 100u);
+    store_be16(&c[5], 150u);
+    store_be16(&c[7], 300u);
+    store_be16(&c[9], 300u);
+    store_be16(&c[11], 500u);
+
+    vgear_table_t t = { .count = 8u, .shape = VGEAR_SHAPE_EXP,
+                        .min_scale_q15 = 16384u, .max_scale_q15 = 49152u };
+    vgear_generate_scales(&t);
+    uint8_t *g = &img[OFF_GEARS];
+    g[0] = t.count;
+    g[1] = t.shape;
+    store_be16(&g[2], t.min_scale_q15);
+    store_be16(&g[4], t.max_scale_q15);
+    for (uint8_t i = 0; i < VGEAR_MAX; ++i)
+        store_be16(&g[6u + i * 2u], t.scales[i]);
+    g[PROFILE_BUNDLE_GEAR_BYTES] = 1u;
+    reseal(img);
+}
+
+TEST(export_round_trips_and_upload_applies_everything)
+{
+    /* The built-in tables export and re-import unchanged. */
+    profile_bundle_encode(s_img);
+    ASSERT_TRUE(load_be32(&s_img[0]) == PROFILE_BUNDLE_MAGIC);
+    ASSERT_TRUE(profile_bundle_apply(s_img, sizeof(s_img), 0));
+    uint8_t again[PROFILE_BUNDLE_BYTES];
+    profile_bundle_encode(again);
+    ASSERT_TRUE(memcmp(again, s_img, sizeof(again)) == 0);
+
+    g_active_vgear = 6u;
+    make_edited(s_img);
+    s_rebuilds = 0u;
+    ASSERT_TRUE(upload(s_img, sizeof(s_img)));
+    ASSERT_TRUE(s_rebuilds == 1u);
+    ASSERT_TRUE(s_erases == 1u);
+    ASSERT_TRUE(g_profiles[1].cap_power_w == 500u);
+    ASSERT_TRUE(g_assist_curves[1].speed_curve.count == 3u);
+    ASSERT_TRUE(g_assist_curves[1].speed_curve.pts[2].y == 500);
+    ASSERT_TRUE(g_assist_curves[1].speed_curve.pts[3].x == 0);
+    ASSERT_TRUE(g_vgears.count == 8u && g_vgears.shape == VGEAR_SHAPE_EXP);
+    ASSERT_TRUE(g_cadence_bias.enabled == 1u);
+    ASSERT_TRUE(g_active_vgear == 6u);
+
+    /* Reading it back in pieces gives the uploaded image. */
+    uint32_t off = 0u;
+    int n;
+    while ((n = profile_bundle_export_read(off, &again[off], 100u)) > 0)
+        off += (uint32_t)n;
+    ASSERT_TRUE(off == sizeof(again));
+    ASSERT_TRUE(memcmp(again, s_img, sizeof(again)) == 0);
+
+    /* It is in flash: the next boot over defaults comes up with it. */
+    profiles_defaults();
+    vgear_defaults();
+    profile_bundle_load();
+    profile_bundle_info_t info;
+    profile_bundle_get_info(&info);
+    ASSERT_TRUE(info.stored == 1u);
+    ASSERT_TRUE(info.crc32 == load_be32(&s_img[8]));
+    ASSERT_TRUE(g_profiles[1].cap_power_w == 500u);
+    ASSERT_TRUE(g_vgears.count == 8u);
+
+    /* Clear drops it and the built-in tables come back at once. */
+    profile_bundle_clear();
+    ASSERT_TRUE(g_profiles[1].cap_power_w == 750u);
+    ASSERT_TRUE(g_vgears.count == 6u);
+    profile_bundle_load();
+    profile_bundle_get_info(&info);
+    ASSERT_TRUE(info.stored == 0u);
+}
+
+TEST(bad_image_changes_nothing)
+{
+    make_edited(s_img);
+    ASSERT_TRUE(upload(s_img, sizeof(s_img)));
+    uint32_t erases = s_erases;
+
+    /* Wrong CRC, short image, a curve running backwards, a bad gear and a
+     * zero current cap are each refused before any table or flash moves. */
+    uint8_t bad[PROFILE_BUNDLE_BYTES];
+    profile_bundle_encode(bad);
+    bad[OFF_P1_SPEED - 6u + 1u] ^= 0x01u;
+    ASSERT_TRUE(!upload(bad, sizeof(bad)));
+    ASSERT_TRUE(!upload(s_img, sizeof(s_img) - 1u));
+
+    memcpy(bad, s_img, sizeof(bad));
+    store_be16(&bad[OFF_P1_SPEED + 5u], 120u);
+    store_be16(&bad[OFF_P1_SPEED + 9u], 110u);
+    reseal(bad);
+    ASSERT_TRUE(!upload(bad, sizeof(bad)));
+
+    memcpy(bad, s_img, sizeof(bad));
+    store_be16(&bad[OFF_GEARS + 6u + 7u * 2u], 100u);
+    reseal(bad);
+    ASSERT_TRUE(!upload(bad, sizeof(bad)));
+
+    memcpy(bad, s_img, sizeof(bad));
+    store_be16(&bad[PROFILE_BUNDLE_HEADER_BYTES + 2u], 0u);
+    reseal(bad);
+    ASSERT_TRUE(!upload(bad, sizeof(bad)));
+
+    ASSERT_TRUE(s_erases == erases);
+    ASSERT_TRUE(g_profiles[1].cap_power_w == 500u);
+    ASSERT_TRUE(g_profiles[0].cap_current_dA == 180u);
+    ASSERT_TRUE(g_vgears.count == 8u);
+    profile_bundle_info_t info;
+    profile_bundle_get_info(&info);
+    ASSERT_TRUE(info.stored == 1u && info.crc32 == load_be32(&s_img[8]));
+
+    /* Out-of-order writes and reads mid-upload are refused. */
+    profile_bundle_upload_begin();
+    ASSERT_TRUE(!profile_bundle_upload_write(4u, s_img, 4u));
+    ASSERT_TRUE(profile_bundle_export_read(0u, bad, 16u) < 0);
+}
+
+int main(void)
+{
+    printf("\nProfile Bundle Unit Tests\n");
+    printf("=========================\n\n");
+
+    RUN_TEST(export_round_trips_and_upload_applies_everything);
+    RUN_TEST(bad_image_changes_nothing);
+
+    printf("\n");
+    printf("=========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("=========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
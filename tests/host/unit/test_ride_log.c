@@ -0,0 +1,205 @@
+/*
+ * Unit Tests for the ride history ring.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "storage/ride_log.h"
+#include "storage/layout.h"
+#include "util/byteorder.h"
+
+static uint8_t s_flash[RIDE_LOG_STORAGE_BYTES];
+static uint32_t s_erases;
+static uint32_t s_programmed;
+/* Programs stop landing once this many bytes were written (power cut). */
+static uint32_t s_cut_after;
+
+static uint32_t off_of(uint32_t addr)
+{
+    return addr - RIDE_LOG_STORAGE_BASE;
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    memcpy(out, &s_flash[off_of(addr)], len);
+}
+
+/* Jobs complete immediately; ordering is all the log relies on. */
+void flash_jobs_erase(uint32_t addr)
+{
+    uint32_t off = off_of(addr) & ~(SPI_FLASH_SECTOR_SIZE - 1u);
+    if (s_programmed >= s_cut_after)
+        return;
+    s_erases++;
+    memset(&s_flash[off], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+void flash_jobs_erase_region(uint32_t addr, uint32_t len)
+{
+    for (uint32_t a = 0; a < len; a += SPI_FLASH_SECTOR_SIZE)
+        flash_jobs_erase(addr + a);
+}
+
+void flash_jobs_program(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+    {
+        if (s_programmed >= s_cut_after)
+            return;
+        s_flash[off_of(addr) + i] &= data[i];
+        s_programmed++;
+    }
+}
+
+void flash_jobs_flush(void) {}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void setup(void)
+{
+    memset(s_flash, 0xFF, sizeof(s_flash));
+    s_erases = 0u;
+    s_programmed = 0u;
+    s_cut_after = 0xFFFFFFFFu;
+    ride_log_load();
+}
+
+static void payload_for(uint32_t ride, uint8_t *p)
+{
+    memset(p, 0, RIDE_LOG_PAYLOAD_SIZE);
+    store_be32(&p[0], ride * 1000u);
+    p[RIDE_LOG_PAYLOAD_SIZE - 1u] = (uint8_t)ride;
+}
+
+TEST(append_and_read_back)
+{
+    uint8_t p[RIDE_LOG_PAYLOAD_SIZE];
+    uint8_t out[RIDE_LOG_PAYLOAD_SIZE];
+    uint32_t seq = 0;
+    ride_log_info_t info;
+
+    ASSERT_TRUE(!ride_log_read_recent(1u, out, &seq));
+    for (uint32_t r = 1; r <= 3u; ++r)
+    {
+        payload_for(r, p);
+        ride_log_append(p);
+    }
+    ride_log_get_info(&info);
+    ASSERT_TRUE(info.count == 3u && info.next_seq == 4u);
+    ASSERT_TRUE(ride_log_read_recent(1u, out, &seq) && seq == 3u);
+    ASSERT_TRUE(load_be32(out) == 3000u);
+    ASSERT_TRUE(ride_log_read_recent(3u, out, &seq) && seq == 1u && out[RIDE_LOG_PAYLOAD_SIZE - 1u] == 1u);
+    ASSERT_TRUE(!ride_log_read_recent(4u, out, &seq));
+
+    uint8_t raw[2 * RIDE_LOG_RECORD_SIZE];
+    ASSERT_TRUE(ride_log_copy(1u, 2u, raw) == 2u);
+    ASSERT_TRUE(load_be32(&raw[0]) == 2u && load_be32(&raw[RIDE_LOG_RECORD_SIZE]) == 3u);
+    ASSERT_TRUE(s_erases == 0u);
+}
+
+TEST(wrap_recycles_oldest_sector_and_reloads)
+{
+    uint8_t p[RIDE_LOG_PAYLOAD_SIZE];
+    uint8_t out[RIDE_LOG_PAYLOAD_SIZE];
+    uint32_t seq = 0;
+    ride_log_info_t info;
+
+    for (uint32_t r = 1; r <= 200u; ++r)
+    {
+        payload_for(r, p);
+        ride_log_append(p);
+    }
+    /* Each move to the next sector erases it; ride 190 recycled sector 0. */
+    ride_log_get_info(&info);
+    ASSERT_TRUE(info.count == RIDE_LOG_RETAINED + 11u);
+    ASSERT_TRUE(s_erases == 3u);
+
+    ride_log_load(); /* reboot */
+    ride_log_get_info(&info);
+    ASSERT_TRUE(info.count == RIDE_LOG_RETAINED + 11u && info.next_seq == 201u);
+    ASSERT_TRUE(ride_log_read_recent(1u, out, &seq) && seq == 200u);
+    ASSERT_TRUE(ride_log_read_recent(info.count, out, &seq) && seq == 64u);
+    ASSERT_TRUE(load_be32(out) == 64000u);
+
+    payload_for(201u, p);
+    ride_log_append(p);
+    ASSERT_TRUE(ride_log_read_recent(1u, out, &seq) && seq == 201u);
+}
+
+TEST(torn_record_fails_its_crc)
+{
+    uint8_t p[RIDE_LOG_PAYLOAD_SIZE];
+    uint8_t out[RIDE_LOG_PAYLOAD_SIZE];
+    uint32_t seq = 0;
+    ride_log_info_t info;
+
+    payload_for(1u, p);
+    ride_log_append(p);
+    s_cut_after = s_programmed + 20u;
+    payload_for(2u, p);
+    ride_log_append(p);
+
+    s_cut_after = 0xFFFFFFFFu;
+    ride_log_load();
+    ride_log_get_info(&info);
+    /* The torn slot still counts as used; its CRC keeps it out of reads. */
+    ASSERT_TRUE(info.count == 2u);
+    ASSERT_TRUE(!ride_log_read_recent(1u, out, &seq));
+    ASSERT_TRUE(ride_log_read_recent(2u, out, &seq) && seq == 1u);
+}
+
+TEST(corrupt_header_resets_log)
+{
+    uint8_t p[RIDE_LOG_PAYLOAD_SIZE];
+    ride_log_info_t info;
+
+    payload_for(1u, p);
+    ride_log_append(p);
+    s_flash[5] ^= 0x01u;
+    ride_log_load();
+    ride_log_get_info(&info);
+    ASSERT_TRUE(info.count == 0u && info.next_seq == 1u);
+    ride_log_append(p);
+    ride_log_get_info(&info);
+    ASSERT_TRUE(info.count == 1u);
+}
+
+int main(void)
+{
+    printf("\nRide Log Unit Tests\n");
+    printf("===================\n\n");
+
+    RUN_TEST(append_and_read_back);
+    RUN_TEST(wrap_recycles_oldest_sector_and_reloads);
+    RUN_TEST(torn_record_fails_its_crc);
+    RUN_TEST(corrupt_header_resets_log);
+
+    printf("\n");
+    printf("===================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("===================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
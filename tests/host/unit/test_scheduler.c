@@ -5,7 +5,11 @@
  *   - Initialization
  *   - Slot registration/unregistration
  *   - Interval timing (tasks run at correct intervals)
- *   - Priority ordering (lower slot_id runs first)
+ *   - Earliest-deadline ordering (ties: lower slot_id runs first)
+ *   - Yielded jobs and the per-tick budget
+ *   - Next-due query and kicks
+ *   - Phase-locked modes (offsets, skip, catch-up)
+ *   - Interval changes at run time
  *   - Suspend/resume functionality
  *   - Edge cases (invalid slots, double registration, etc.)
  */
@@ -541,24 +545,347 @@ TEST(max_slot_count)
     }
 }
 
+/* Fake cycle counter: each callback advances it by its slot's cost. */
+static uint32_t fake_cycles;
+static uint32_t fake_cost[SCHED_SLOT_MAX];
+
+static uint32_t fake_clock(void)
+{
+    return fake_cycles;
+}
+
+static void costly_callback_0(void *ctx, uint32_t now_ms)
+{
+    (void)ctx;
+    (void)now_ms;
+    fake_cycles += fake_cost[0];
+}
+
 /*
  * Test: get/reset max execution time
  */
 TEST(max_exec_time_tracking)
 {
     scheduler_init();
+    scheduler_set_clock(fake_clock, 100);
 
-    scheduler_register(SCHED_SLOT_MOTOR_MAIN, 10, test_callback_0, NULL);
+    scheduler_register(SCHED_SLOT_MOTOR_MAIN, 10, costly_callback_0, NULL);
 
     /* Initial max exec time is 0 */
     ASSERT_EQ(scheduler_get_max_exec_time(SCHED_SLOT_MOTOR_MAIN), 0);
 
-    /* Run task (exec time tracking requires platform support, will be 0 in tests) */
+    /* 2500 cycles at 100 cycles/us */
+    fake_cost[0] = 2500;
     scheduler_tick(0);
+    ASSERT_EQ(scheduler_get_max_exec_time(SCHED_SLOT_MOTOR_MAIN), 25);
 
     /* Reset should work */
     scheduler_reset_max_exec_time(SCHED_SLOT_MOTOR_MAIN);
     ASSERT_EQ(scheduler_get_max_exec_time(SCHED_SLOT_MOTOR_MAIN), 0);
+    scheduler_set_clock(NULL, 0);
+}
+
+/*
+ * Test: min/max/EWMA, histogram, overruns and late starts
+ */
+TEST(exec_stats_accounting)
+{
+    scheduler_init();
+    scheduler_set_clock(fake_clock, 1);
+    fake_cycles = 0xFFFFF000u; /* wraps during the test */
+
+    scheduler_register(SCHED_SLOT_MOTOR_MAIN, 10, costly_callback_0, NULL);
+
+    fake_cost[0] = 800;
+    scheduler_tick(0);
+    fake_cost[0] = 3;
+    scheduler_tick(10);
+    /* Longer than the 10 ms interval */
+    fake_cost[0] = 12000;
+    scheduler_tick(20);
+    /* Started two periods after the previous run */
+    fake_cost[0] = 800;
+    scheduler_tick(40);
+
+    scheduler_stats_t st;
+    ASSERT_TRUE(scheduler_get_stats(SCHED_SLOT_MOTOR_MAIN, &st));
+    ASSERT_EQ(st.runs, 4);
+    ASSERT_EQ(st.min_us, 3);
+    ASSERT_EQ(st.max_us, 12000);
+    ASSERT_EQ(st.last_us, 800);
+    ASSERT_EQ(st.overruns, 1);
+    ASSERT_EQ(st.late, 1);
+    /* 800 -> 800 - 797/8 -> + (12000 - ewma)/8 -> - (ewma - 800)/8 */
+    ASSERT_TRUE(st.ewma_us > 800 && st.ewma_us < 12000);
+    ASSERT_EQ(st.hist[10], 2); /* 512..1023 us */
+    ASSERT_EQ(st.hist[2], 1);  /* 2..3 us */
+    ASSERT_EQ(st.hist[14], 1); /* 8192..16383 us */
+
+    /* Unregistered and invalid slots */
+    ASSERT_TRUE(scheduler_get_stats(SCHED_SLOT_UI, &st));
+    ASSERT_EQ(st.runs, 0);
+    ASSERT_FALSE(scheduler_get_stats(SCHED_SLOT_MAX, &st));
+    ASSERT_FALSE(scheduler_get_stats(0, NULL));
+
+    scheduler_reset_max_exec_time(SCHED_SLOT_MOTOR_MAIN);
+    ASSERT_TRUE(scheduler_get_stats(SCHED_SLOT_MOTOR_MAIN, &st));
+    ASSERT_EQ(st.runs, 0);
+    ASSERT_TRUE(st.min_us == 0xFFFFFFFFu);
+    scheduler_set_clock(NULL, 0);
+}
+
+/*
+ * Test: Earliest deadline runs first, regardless of slot_id
+ */
+TEST(tick_earliest_deadline_first)
+{
+    scheduler_init();
+    execution_index = 0;
+    memset(execution_order, -1, sizeof(execution_order));
+
+    scheduler_register(SCHED_SLOT_MOTOR_MAIN, 100, priority_callback_0, NULL);
+    scheduler_register(SCHED_SLOT_UI, 20, priority_callback_3, NULL);
+    scheduler_tick(0);
+
+    /* At t=100 the UI deadline (20) is far older than the motor's (100) */
+    execution_index = 0;
+    scheduler_tick(100);
+    ASSERT_EQ(execution_index, 2);
+    ASSERT_EQ(execution_order[0], 3);
+    ASSERT_EQ(execution_order[1], 0);
+}
+
+/*
+ * Test: A yielded job continues next tick and keeps its period
+ */
+static int chunk_calls;
+static int chunks_per_job;
+
+static void chunked_callback(void *ctx, uint32_t now_ms)
+{
+    (void)ctx;
+    (void)now_ms;
+    chunk_calls++;
+    if (chunk_calls % chunks_per_job) {
+        scheduler_yield();
+    }
+}
+
+TEST(yield_continues_next_tick)
+{
+    scheduler_init();
+    reset_callback_tracking();
+    chunk_calls = 0;
+    chunks_per_job = 3;
+
+    scheduler_register(SCHED_SLOT_MOTOR_MAIN, 0, test_callback_0, NULL);
+    scheduler_register(SCHED_SLOT_UI, 50, chunked_callback, NULL);
+
+    scheduler_tick(0);
+    scheduler_tick(1);
+    scheduler_tick(2);
+    ASSERT_EQ(chunk_calls, 3);
+    /* The motor slot ran between every chunk */
+    ASSERT_EQ(callback_count[0], 3);
+
+    /* Done: the next job is due 50 ms after the first chunk */
+    scheduler_tick(49);
+    ASSERT_EQ(chunk_calls, 3);
+    scheduler_tick(50);
+    ASSERT_EQ(chunk_calls, 4);
+
+    /* Outside a callback, yield is ignored */
+    scheduler_yield();
+    scheduler_tick(51);
+    ASSERT_EQ(chunk_calls, 5);
+    scheduler_tick(52);
+    ASSERT_EQ(chunk_calls, 6);
+    scheduler_tick(53);
+    ASSERT_EQ(chunk_calls, 6);
+}
+
+/*
+ * Test: Tick budget defers the remaining due tasks
+ */
+TEST(tick_budget_defers_tasks)
+{
+    scheduler_init();
+    scheduler_set_clock(fake_clock, 1);
+    reset_callback_tracking();
+    fake_cost[0] = 300;
+
+    scheduler_register(SCHED_SLOT_MOTOR_MAIN, 0, costly_callback_0, NULL);
+    scheduler_register(SCHED_SLOT_POWER, 0, test_callback_1, NULL);
+    scheduler_set_tick_budget(200);
+
+    ASSERT_EQ(scheduler_tick(0), 1);
+    ASSERT_EQ(scheduler_get_budget_stops(), 1);
+    ASSERT_EQ(callback_count[1], 0);
+
+    /* The deferred slot runs on the next tick */
+    fake_cost[0] = 0;
+    ASSERT_EQ(scheduler_tick(1), 2);
+    ASSERT_EQ(callback_count[1], 1);
+
+    scheduler_set_tick_budget(0);
+    scheduler_set_clock(NULL, 0);
+}
+
+/*
+ * Test: Next-due query for idle, and kicks between periods
+ */
+TEST(next_due_and_kick)
+{
+    scheduler_init();
+    reset_callback_tracking();
+
+    ASSERT_TRUE(scheduler_next_due_ms(0) == UINT32_MAX);
+
+    scheduler_register(SCHED_SLOT_MOTOR_MAIN, 5, test_callback_0, NULL);
+    scheduler_register(SCHED_SLOT_UI, 200, test_callback_2, NULL);
+    ASSERT_EQ(scheduler_next_due_ms(0), 0);
+    scheduler_tick(0);
+    ASSERT_EQ(scheduler_next_due_ms(0), 5);
+    ASSERT_EQ(scheduler_next_due_ms(3), 2);
+
+    /* A kick runs the slot now and restarts its period */
+    ASSERT_TRUE(scheduler_kick(SCHED_SLOT_MOTOR_MAIN));
+    ASSERT_EQ(scheduler_next_due_ms(3), 0);
+    ASSERT_EQ(scheduler_tick(3), 1);
+    ASSERT_EQ(callback_count[0], 2);
+    ASSERT_EQ(scheduler_next_due_ms(3), 5);
+    ASSERT_EQ(scheduler_tick(5), 0);
+
+    /* Suspended slots never make the loop stay awake */
+    scheduler_suspend(SCHED_SLOT_MOTOR_MAIN);
+    ASSERT_EQ(scheduler_next_due_ms(8), 192);
+
+    ASSERT_FALSE(scheduler_kick(SCHED_SLOT_BLE));
+    ASSERT_FALSE(scheduler_kick(SCHED_SLOT_MAX));
+}
+
+/*
+ * Test: Phase-locked slots hold their boundaries and offsets
+ */
+TEST(phase_locked_boundaries)
+{
+    scheduler_init();
+    reset_callback_tracking();
+
+    scheduler_register(SCHED_SLOT_UI, 200, test_callback_0, NULL);
+    scheduler_register(SCHED_SLOT_TELEMETRY, 200, test_callback_1, NULL);
+    ASSERT_TRUE(scheduler_set_mode(SCHED_SLOT_UI, SCHED_MODE_LOCKED_SKIP, 0));
+    ASSERT_TRUE(scheduler_set_mode(SCHED_SLOT_TELEMETRY, SCHED_MODE_LOCKED_SKIP, 100));
+
+    /* Boundaries: UI at 0, 200, 400...; telemetry at 100, 300... */
+    ASSERT_EQ(scheduler_tick(35), 0);
+    ASSERT_EQ(scheduler_next_due_ms(35), 65);
+    ASSERT_EQ(scheduler_tick(100), 1);
+    ASSERT_EQ(callback_count[1], 1);
+    /* Late by 5 ms: the next boundary does not drift */
+    ASSERT_EQ(scheduler_tick(205), 1);
+    ASSERT_EQ(callback_count[0], 1);
+    ASSERT_EQ(scheduler_next_due_ms(205), 95);
+    ASSERT_EQ(scheduler_tick(300), 1);
+    ASSERT_EQ(scheduler_tick(400), 1);
+    ASSERT_EQ(callback_count[0], 2);
+    ASSERT_EQ(callback_last_time[0], 400);
+
+    /* Skip: a 3-period stall runs once and drops the missed boundaries */
+    ASSERT_EQ(scheduler_tick(1010), 2);
+    scheduler_stats_t st;
+    scheduler_get_stats(SCHED_SLOT_UI, &st);
+    ASSERT_EQ(st.skipped, 2);
+    ASSERT_EQ(st.late, 1);
+    /* Telemetry's next boundary (1100) comes before the UI's (1200) */
+    ASSERT_EQ(scheduler_next_due_ms(1010), 90);
+
+    /* Zero-interval slots cannot be phase-locked */
+    scheduler_register(SCHED_SLOT_MOTOR_MAIN, 0, test_callback_2, NULL);
+    ASSERT_FALSE(scheduler_set_mode(SCHED_SLOT_MOTOR_MAIN, SCHED_MODE_LOCKED_SKIP, 0));
+    ASSERT_FALSE(scheduler_set_mode(SCHED_SLOT_UI, 3, 0));
+    ASSERT_FALSE(scheduler_set_mode(SCHED_SLOT_BLE, SCHED_MODE_FREE, 0));
+}
+
+/*
+ * Test: Catch-up runs missed periods back-to-back, within a limit
+ */
+TEST(phase_locked_catch_up)
+{
+    scheduler_init();
+    reset_callback_tracking();
+
+    scheduler_register(SCHED_SLOT_POWER, 10, test_callback_0, NULL);
+    ASSERT_TRUE(scheduler_set_mode(SCHED_SLOT_POWER, SCHED_MODE_LOCKED_CATCHUP, 0));
+    scheduler_tick(0);
+    ASSERT_EQ(callback_count[0], 1);
+
+    /* Stalled to t=35: boundaries 10, 20, 30 all run */
+    scheduler_tick(35);
+    scheduler_tick(36);
+    scheduler_tick(37);
+    ASSERT_EQ(callback_count[0], 4);
+    scheduler_tick(38);
+    ASSERT_EQ(callback_count[0], 4);
+    ASSERT_EQ(scheduler_next_due_ms(38), 2);
+
+    /* Too far behind: falls back to skipping */
+    scheduler_tick(500);
+    scheduler_tick(501);
+    ASSERT_EQ(callback_count[0], 5);
+    scheduler_stats_t st;
+    scheduler_get_stats(SCHED_SLOT_POWER, &st);
+    ASSERT_EQ(st.skipped, 46);  /* boundaries 50..500 */
+}
+
+/*
+ * Test: A new interval takes effect on the next period, boundaries intact
+ */
+static void set_interval_100(void *ctx, uint32_t now_ms)
+{
+    (void)ctx;
+    callback_count[1]++;
+    callback_last_time[1] = now_ms;
+    scheduler_set_interval(SCHED_SLOT_UI, 100);
+}
+
+TEST(set_interval_realigns)
+{
+    scheduler_init();
+    reset_callback_tracking();
+
+    scheduler_register(SCHED_SLOT_UI, 1000, test_callback_0, NULL);
+    ASSERT_TRUE(scheduler_set_mode(SCHED_SLOT_UI, SCHED_MODE_LOCKED_SKIP, 0));
+    ASSERT_EQ(scheduler_tick(0), 1);
+    ASSERT_EQ(scheduler_next_due_ms(30), 970);
+
+    /* Between jobs: the next 200 ms boundary */
+    ASSERT_TRUE(scheduler_set_interval(SCHED_SLOT_UI, 200));
+    ASSERT_EQ(scheduler_tick(30), 0);
+    ASSERT_EQ(scheduler_next_due_ms(30), 170);
+    ASSERT_EQ(scheduler_tick(200), 1);
+    ASSERT_EQ(scheduler_tick(399), 0);
+    ASSERT_EQ(scheduler_tick(400), 1);
+
+    /* From inside the job: the run ends at 400, the next is at 500 */
+    scheduler_unregister(SCHED_SLOT_UI);
+    scheduler_register(SCHED_SLOT_UI, 200, set_interval_100, NULL);
+    ASSERT_TRUE(scheduler_set_mode(SCHED_SLOT_UI, SCHED_MODE_LOCKED_SKIP, 0));
+    ASSERT_EQ(scheduler_tick(400), 1);
+    ASSERT_EQ(scheduler_tick(401), 0);
+    ASSERT_EQ(scheduler_next_due_ms(401), 99);
+    ASSERT_EQ(scheduler_tick(500), 1);
+    ASSERT_EQ(callback_last_time[1], 500);
+
+    /* Free-running: due interval_ms after the last start */
+    scheduler_register(SCHED_SLOT_BLE, 100, test_callback_2, NULL);
+    ASSERT_EQ(scheduler_tick(510), 1);
+    ASSERT_TRUE(scheduler_set_interval(SCHED_SLOT_BLE, 50));
+    ASSERT_EQ(scheduler_next_due_ms(520), 40);
+
+    ASSERT_FALSE(scheduler_set_interval(SCHED_SLOT_UI, 0));
+    ASSERT_FALSE(scheduler_set_interval(SCHED_SLOT_TELEMETRY, 100));
+    ASSERT_FALSE(scheduler_set_interval(SCHED_SLOT_MAX, 100));
 }
 
 /*
@@ -605,6 +932,14 @@ int main(void)
     RUN_TEST(tick_all_suspended);
     RUN_TEST(max_slot_count);
     RUN_TEST(max_exec_time_tracking);
+    RUN_TEST(exec_stats_accounting);
+    RUN_TEST(tick_earliest_deadline_first);
+    RUN_TEST(yield_continues_next_tick);
+    RUN_TEST(tick_budget_defers_tasks);
+    RUN_TEST(next_due_and_kick);
+    RUN_TEST(phase_locked_boundaries);
+    RUN_TEST(phase_locked_catch_up);
+    RUN_TEST(set_interval_realigns);
     RUN_TEST(max_exec_time_invalid_slot);
 
     printf("\n");
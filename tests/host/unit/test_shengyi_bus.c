@@ -7,6 +7,8 @@
 #include "sim_shengyi_bus.h"
 #include "sim_shengyi_frame.h"
 #include "sim_mcu.h"
+#include "kernel/event_bus.h"
+#include "motor/motor_isr.h"
 
 static int g_failures = 0;
 
@@ -79,6 +81,60 @@ static void test_frame_0x52_decode(void)
     assert_eq_i32(speed_raw, expected_speed_raw, "0x52 speed raw encoding");
 }
 
+/* The ISR's one-pass status decoder against the sim's frames and its own
+ * field decode, over current, voltage, brake, speed and error codes. */
+static void test_frame_0x52_firmware_decode(void)
+{
+    static const uint8_t errs[] = {0u, 33u, 36u, 38u, 12u, 40u};
+    sim_shengyi_t ts;
+    sim_shengyi_init(&ts);
+    ts.wheel_radius_m = 0.34;
+
+    for (int i = 0; i < 600; ++i)
+    {
+        ts.v_mps = (double)(i % 25) * 0.5;
+        ts.batt_v = 30.0 + (double)(i % 31);
+        ts.batt_a = (double)(i % 86);
+        ts.err = errs[i % 6];
+
+        uint8_t frame[32];
+        size_t len = sim_shengyi_build_frame_0x52(&ts, frame, sizeof(frame));
+        double kph_x10 = 0.0;
+        int current_mA = 0;
+        uint8_t batt_v = 0;
+        uint8_t err = 0;
+        if (!sim_shengyi_decode_frame_0x52(frame, len, &ts, &kph_x10, &current_mA, &batt_v, &err))
+        {
+            assert_true(0, "0x52 sim decode");
+            return;
+        }
+
+        /* The sim never brakes; the decoder ignores the checksum. */
+        if ((i / 6) & 1)
+            frame[4] |= 0x40u;
+        motor_isr_status_t st = {0};
+        assert_true(motor_isr_decode_status(MOTOR_PROTO_SHENGYI_3A1A, frame, (uint8_t)len, &st),
+                    "0x52 firmware decode ok");
+        /* The OEM rounds mA to deci-amps after the divide by three. */
+        assert_eq_i32(st.current_dA, (int)(((uint32_t)current_mA + 50u) / 100u), "0x52 firmware current");
+        assert_eq_i32(st.batt_dV, batt_v * 10, "0x52 firmware volts");
+        assert_eq_u8(st.flags, (uint8_t)((i / 6) & 1), "0x52 firmware brake");
+        assert_eq_i32(st.speed_raw, (frame[6] << 8) | frame[7], "0x52 firmware speed word");
+        uint8_t want_err = (err == 0u || (err >= 33u && err <= 38u)) ? err : 0xFFu;
+        assert_eq_u8(st.err, want_err, "0x52 firmware error code");
+        if (g_failures)
+            return;
+    }
+
+    /* Short payloads fail validation. */
+    uint8_t frame[32];
+    size_t len = sim_shengyi_build_frame_0x52(&ts, frame, sizeof(frame));
+    motor_isr_status_t st = {0};
+    assert_true(!motor_isr_decode_status(MOTOR_PROTO_SHENGYI_3A1A, frame, 12u, &st), "0x52 short frame");
+    frame[3] = 4u;
+    assert_true(!motor_isr_decode_status(MOTOR_PROTO_SHENGYI_3A1A, frame, (uint8_t)len, &st), "0x52 short payload");
+}
+
 static void test_frame_0xC2_build(void)
 {
     uint8_t frame[16];
@@ -185,6 +241,43 @@ static void test_frame_0x52_req_roundtrip(void)
     assert_eq_u8(out.speed_over_limit, in.speed_over_limit, "0x52 req speed limit");
 }
 
+static void test_frame_0x52_req_incremental(void)
+{
+    /* motor_isr_queue_cmd patches its cached frame; every frame on the wire
+     * must match a full rebuild, including repeats and flag-only changes. */
+    static event_bus_t bus;
+    event_bus_init(&bus);
+    motor_isr_init(&bus);
+    motor_isr_trace_t tr;
+    while (motor_isr_trace_pop(&tr))
+        ;
+
+    uint32_t now_ms = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        sim_shengyi_cmd52_req_t in = {0};
+        in.assist_level_mapped = (uint8_t)((i / 3) * 37u);
+        in.headlight_enabled = (uint8_t)((i >> 1) & 1);
+        in.battery_low = (uint8_t)((i % 7) == 0);
+        in.walk_assist_active = (uint8_t)((i % 5) == 1);
+        in.speed_over_limit = (uint8_t)((i % 11) > 8);
+
+        uint8_t want[32];
+        size_t len = sim_shengyi_build_frame_0x52_req(&in, want, sizeof(want));
+        assert_true(motor_isr_queue_cmd(in.assist_level_mapped, in.headlight_enabled, in.walk_assist_active,
+                                        in.battery_low, in.speed_over_limit),
+                    "0x52 req queued");
+        now_ms += MOTOR_TX_INTERVAL_MS;
+        motor_isr_tick(now_ms);
+
+        assert_true(motor_isr_trace_pop(&tr) && tr.dir == MOTOR_ISR_TRACE_TX, "0x52 req sent");
+        assert_eq_i32(tr.len, (int)len, "0x52 req length");
+        assert_true(memcmp(tr.bytes, want, len < MOTOR_ISR_TRACE_BYTES ? len : MOTOR_ISR_TRACE_BYTES) == 0, "0x52 req bytes match rebuild");
+        if (g_failures)
+            return;
+    }
+}
+
 static void test_frame_0x53_decode(void)
 {
     sim_shengyi_t ts;
@@ -413,8 +506,19 @@ static void test_mcu_mmio(void)
 
     uint8_t rxv = 0xA5;
     sim_mcu_uart_push_rx(m, 1, &rxv, 1);
+    assert_true((sim_mcu_read32(m, 0x40004400u) & (1u << 5)) != 0, "mcu uart rxne");
     uint32_t dr = sim_mcu_read32(m, 0x40004404u);
     assert_eq_i32(dr, 0xA5, "mcu uart rx");
+    assert_true((sim_mcu_read32(m, 0x40004400u) & (1u << 5)) == 0, "mcu uart rxne cleared");
+    assert_eq_i32(sim_mcu_read32(m, 0x40013800u + 0x10Cu), 0, "mcu uart past regs");
+
+    sim_mcu_write32(m, 0x40011010u, (1u << 13) | (1u << 2));
+    sim_mcu_write32(m, 0x40011010u, (1u << (16 + 2)));
+    assert_eq_i32(sim_mcu_read32(m, 0x4001100Cu), 1u << 13, "mcu gpio bsrr");
+    sim_mcu_write32(m, 0x40011014u, 1u << 13);
+    assert_eq_i32(sim_mcu_read32(m, 0x4001100Cu), 0, "mcu gpio brr");
+    assert_eq_i32(sim_mcu_read32(m, 0x40030000u), 0, "mcu unmapped");
+    assert_eq_i32(sim_mcu_read32(m, 0x20000000u), 0, "mcu below mmio");
 
     sim_mcu_gpio_set_input(m, 'B', 3, 1);
     uint32_t idr = sim_mcu_read32(m, 0x40010C08u);
@@ -435,7 +539,9 @@ static void test_mcu_mmio(void)
 int main(void)
 {
     test_frame_0x52_decode();
+    test_frame_0x52_firmware_decode();
     test_frame_0x52_req_roundtrip();
+    test_frame_0x52_req_incremental();
     test_frame_0x53_decode();
     test_frame_0xC2_build();
     test_frame_0xC3_roundtrip();
@@ -0,0 +1,153 @@
+/*
+ * Unit Tests for the boot splash flash store.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "storage/splash.h"
+#include "storage/layout.h"
+#include "drivers/spi_flash.h"
+#include "platform/watchdog.h"
+#include "util/crc32.h"
+
+volatile uint32_t g_ms;
+
+static uint8_t s_flash[SPLASH_STORAGE_BYTES];
+static uint32_t s_erases;
+
+static uint32_t off_of(uint32_t addr)
+{
+    return addr - SPLASH_STORAGE_BASE;
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    memcpy(out, &s_flash[off_of(addr)], len);
+}
+
+void spi_flash_erase_4k(uint32_t addr)
+{
+    s_erases++;
+    memset(&s_flash[off_of(addr)], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+void spi_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[off_of(addr) + i] &= data[i];
+}
+
+/* Waits run unbudgeted on the host. */
+void watchdog_budget_begin(watchdog_budget_t *b, uint32_t budget_us)
+{
+    (void)b;
+    (void)budget_us;
+}
+
+uint8_t watchdog_budget_poll(watchdog_budget_t *b)
+{
+    (void)b;
+    return 1u;
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define FRAME_W 240u
+#define FRAME_H 240u
+#define FRAME_BYTES (FRAME_W * FRAME_H * 2u)
+#define CHUNK 184u
+
+static uint8_t s_frame[FRAME_BYTES];
+
+static void setup(void)
+{
+    memset(s_flash, 0xA5, sizeof(s_flash));
+    s_erases = 0u;
+    for (uint32_t i = 0; i < FRAME_BYTES; ++i)
+        s_frame[i] = (uint8_t)(i * 7u + (i >> 9));
+}
+
+static int upload(uint32_t bytes)
+{
+    splash_store_begin();
+    for (uint32_t off = 0; off < bytes; off += CHUNK)
+    {
+        uint32_t n = (bytes - off < CHUNK) ? bytes - off : CHUNK;
+        if (!splash_store_write(off, &s_frame[off], n))
+            return 0;
+    }
+    return 1;
+}
+
+TEST(upload_round_trips_and_erases_only_what_it_writes)
+{
+    ASSERT_TRUE(upload(FRAME_BYTES));
+    uint32_t crc = crc32_compute(s_frame, FRAME_BYTES);
+    ASSERT_TRUE(splash_store_finish(FRAME_W, FRAME_H, crc));
+
+    uint32_t addr = 0u;
+    uint16_t w = 0u;
+    uint16_t h = 0u;
+    ASSERT_TRUE(splash_image(&addr, &w, &h));
+    ASSERT_TRUE(w == FRAME_W && h == FRAME_H);
+    ASSERT_TRUE(memcmp(&s_flash[off_of(addr)], s_frame, FRAME_BYTES) == 0);
+    /* Header sector plus the 29 sectors the frame covers. */
+    ASSERT_TRUE(s_erases == 1u + (FRAME_BYTES + SPI_FLASH_SECTOR_SIZE - 1u) / SPI_FLASH_SECTOR_SIZE);
+}
+
+TEST(interrupted_or_corrupt_upload_leaves_no_splash)
+{
+    ASSERT_TRUE(upload(FRAME_BYTES));
+    ASSERT_TRUE(splash_store_finish(FRAME_W, FRAME_H, crc32_compute(s_frame, FRAME_BYTES)));
+
+    /* A new upload drops the old frame until it commits. */
+    ASSERT_TRUE(upload(FRAME_BYTES / 2u));
+    ASSERT_TRUE(!splash_image(NULL, NULL, NULL));
+    ASSERT_TRUE(!splash_store_finish(FRAME_W, FRAME_H, crc32_compute(s_frame, FRAME_BYTES)));
+    ASSERT_TRUE(!splash_image(NULL, NULL, NULL));
+
+    /* Out-of-order chunks and a bad CRC are refused. */
+    splash_store_begin();
+    ASSERT_TRUE(!splash_store_write(CHUNK, s_frame, CHUNK));
+    ASSERT_TRUE(upload(FRAME_BYTES));
+    ASSERT_TRUE(!splash_store_finish(FRAME_W, FRAME_H, 0x12345678u));
+    ASSERT_TRUE(!splash_image(NULL, NULL, NULL));
+}
+
+int main(void)
+{
+    printf("\nBoot Splash Store Unit Tests\n");
+    printf("============================\n\n");
+
+    RUN_TEST(upload_round_trips_and_erases_only_what_it_writes);
+    RUN_TEST(interrupted_or_corrupt_upload_leaves_no_splash);
+
+    printf("\n");
+    printf("============================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("============================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
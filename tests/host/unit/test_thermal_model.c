@@ -0,0 +1,124 @@
+/*
+ * Unit Tests for the lumped thermal model and its predictive derate.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "thermal_model.h"
+#include "power.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* Plant: dT/dt = (T_amb + G * I^2 - T) / tau, I in A, T in dC. */
+#define PLANT_AMB_DC   250.0
+#define PLANT_G        0.6      /* dC per A^2 at steady state */
+#define PLANT_TAU_S    200.0
+#define STEP_MS        50u
+
+typedef struct {
+    double temp_dC;
+    double max_dC;
+    uint16_t applied_dA;
+    uint32_t now_ms;
+    uint16_t first_derate_dC;
+} plant_t;
+
+static plant_t s_plant;
+
+static void setup(void)
+{
+    thermal_model_reset();
+    s_plant = (plant_t){ .temp_dC = PLANT_AMB_DC, .max_dC = PLANT_AMB_DC, .now_ms = 1000u };
+}
+
+/* Ride at request_dA for ms, the model's factor scaling what is applied. */
+static void ride(uint16_t request_dA, uint32_t ms)
+{
+    for (uint32_t t = 0; t < ms; t += STEP_MS)
+    {
+        uint16_t f = thermal_model_update(s_plant.now_ms, (int16_t)s_plant.temp_dC,
+                                          s_plant.applied_dA, request_dA);
+        if (f < Q16_ONE && s_plant.first_derate_dC == 0u)
+            s_plant.first_derate_dC = (uint16_t)s_plant.temp_dC;
+        s_plant.applied_dA = (uint16_t)(((uint32_t)request_dA * f) >> 16);
+        double amps = s_plant.applied_dA / 10.0;
+        double dt_s = STEP_MS / 1000.0;
+        s_plant.temp_dC += dt_s * (PLANT_AMB_DC + PLANT_G * amps * amps - s_plant.temp_dC) / PLANT_TAU_S;
+        if (s_plant.temp_dC > s_plant.max_dC)
+            s_plant.max_dC = s_plant.temp_dC;
+        s_plant.now_ms += STEP_MS;
+    }
+}
+
+TEST(fit_recovers_plant_constants)
+{
+    thermal_model_info_t m;
+    /* 20 A settles at 49 C: under the soft limit, so nothing derates. */
+    ride(200u, 600000u);
+    thermal_model_get_info(&m);
+    ASSERT_TRUE(m.valid);
+    /* a = G * window / tau, b = window / tau, both Q16. */
+    uint32_t want_a = (uint32_t)(PLANT_G * 5.0 / PLANT_TAU_S * 65536.0);
+    uint32_t want_b = (uint32_t)(5.0 / PLANT_TAU_S * 65536.0);
+    ASSERT_TRUE(m.a_q16 > want_a * 8u / 10u && m.a_q16 < want_a * 12u / 10u);
+    ASSERT_TRUE(m.b_q16 > want_b * 8u / 10u && m.b_q16 < want_b * 12u / 10u);
+    ASSERT_TRUE(m.ttl_s == THERM_MODEL_TTL_NONE && m.factor_q16 == Q16_ONE);
+    ASSERT_TRUE(s_plant.first_derate_dC == 0u);
+}
+
+TEST(long_climb_tapers_before_the_soft_limit)
+{
+    thermal_model_info_t m;
+    /* Warm-up that excites the fit, then a sustained 30 A climb that would
+     * settle at 79 C, inside the reactive band. */
+    ride(150u, 300000u);
+    ride(250u, 300000u);
+    ride(300u, 1800000u);
+    thermal_model_get_info(&m);
+
+    ASSERT_TRUE(m.valid);
+    ASSERT_TRUE(s_plant.first_derate_dC != 0u && s_plant.first_derate_dC < THERM_TEMP_SOFT_DC);
+    /* Held at, not past, the point where the reactive governor starts. */
+    ASSERT_TRUE(s_plant.max_dC < THERM_TEMP_SOFT_DC + 10);
+    /* And the current held is close to what the plant can sustain there. */
+    uint32_t sustain_dA = 274u; /* sqrt((700 - 250) / 0.6) A */
+    ASSERT_TRUE(s_plant.applied_dA > sustain_dA * 9u / 10u);
+    ASSERT_TRUE(m.sustain_dA > sustain_dA * 8u / 10u && m.sustain_dA < sustain_dA * 12u / 10u);
+}
+
+int main(void)
+{
+    printf("\nThermal Model Unit Tests\n");
+    printf("========================\n\n");
+
+    RUN_TEST(fit_recovers_plant_constants);
+    RUN_TEST(long_climb_tapers_before_the_soft_limit);
+
+    printf("\n");
+    printf("========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,200 @@
+/*
+ * Unit Tests for the Software Timer Wheel
+ *
+ * Tests cover:
+ *   - One-shot and periodic expiry
+ *   - Timers more than one turn out
+ *   - Cancel and restart, including from callbacks
+ *   - Gaps longer than a turn
+ *   - Next-due hint
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define HOST_TEST 1
+#include "src/kernel/timer_wheel.h"
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+#define ASSERT_EQ(a, b) do { \
+    if ((a) != (b)) { \
+        printf("FAIL\n    Expected %d == %d\n    at %s:%d\n", \
+               (int)(a), (int)(b), __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+typedef struct {
+    int fired;
+    uint32_t last_ms;
+} hit_t;
+
+static void on_hit(void *ctx, uint32_t now_ms)
+{
+    hit_t *h = (hit_t *)ctx;
+    h->fired++;
+    h->last_ms = now_ms;
+}
+
+static void setup(void)
+{
+    /* Close to wrap so every test crosses it. */
+    timer_wheel_init(0xFFFFFF00u);
+}
+
+/* Ticks every millisecond from the wheel's time up to `to`. */
+static void run_until(uint32_t from, uint32_t to)
+{
+    for (uint32_t t = from + 1u; t != to + 1u; t++) {
+        timer_wheel_tick(t);
+    }
+}
+
+TEST(one_shot_fires_once_on_time)
+{
+    sw_timer_t t = {0};
+    hit_t h = {0};
+    uint32_t base = 0xFFFFFF00u;
+    ASSERT_TRUE(timer_wheel_start(&t, 10u, 0u, on_hit, &h));
+    ASSERT_TRUE(timer_wheel_active(&t));
+    run_until(base, base + 9u);
+    ASSERT_EQ(h.fired, 0);
+    run_until(base + 9u, base + 300u);
+    ASSERT_EQ(h.fired, 1);
+    ASSERT_TRUE(h.last_ms == base + 10u);
+    ASSERT_TRUE(!timer_wheel_active(&t));
+    ASSERT_EQ(timer_wheel_count(), 0);
+}
+
+TEST(timer_beyond_one_turn)
+{
+    sw_timer_t t = {0};
+    hit_t h = {0};
+    uint32_t base = 0xFFFFFF00u;
+    timer_wheel_start(&t, 3u * TIMER_WHEEL_SLOTS + 5u, 0u, on_hit, &h);
+    run_until(base, base + 3u * TIMER_WHEEL_SLOTS + 4u);
+    ASSERT_EQ(h.fired, 0);
+    run_until(base + 3u * TIMER_WHEEL_SLOTS + 4u, base + 4u * TIMER_WHEEL_SLOTS);
+    ASSERT_EQ(h.fired, 1);
+    ASSERT_TRUE(h.last_ms == base + 3u * TIMER_WHEEL_SLOTS + 5u);
+}
+
+TEST(periodic_rearms_and_cancels)
+{
+    sw_timer_t t = {0};
+    hit_t h = {0};
+    uint32_t base = 0xFFFFFF00u;
+    timer_wheel_start(&t, 7u, 7u, on_hit, &h);
+    run_until(base, base + 70u);
+    ASSERT_EQ(h.fired, 10);
+    ASSERT_TRUE(timer_wheel_active(&t));
+    timer_wheel_cancel(&t);
+    timer_wheel_cancel(&t);
+    run_until(base + 70u, base + 200u);
+    ASSERT_EQ(h.fired, 10);
+    ASSERT_EQ(timer_wheel_count(), 0);
+}
+
+TEST(gap_longer_than_a_turn)
+{
+    sw_timer_t a = {0}, b = {0}, p = {0};
+    hit_t ha = {0}, hb = {0}, hp = {0};
+    uint32_t base = 0xFFFFFF00u;
+    timer_wheel_start(&a, 5u, 0u, on_hit, &ha);
+    timer_wheel_start(&b, 500u, 0u, on_hit, &hb);
+    timer_wheel_start(&p, 10u, 10u, on_hit, &hp);
+    ASSERT_EQ(timer_wheel_tick(base + 300u), 2);
+    ASSERT_EQ(ha.fired, 1);
+    ASSERT_EQ(hb.fired, 0);
+    /* A late periodic timer fires once and skips the missed periods. */
+    ASSERT_EQ(hp.fired, 1);
+    ASSERT_TRUE(p.due_ms == base + 310u);
+    timer_wheel_tick(base + 500u);
+    ASSERT_EQ(hb.fired, 1);
+}
+
+static sw_timer_t g_self;
+static sw_timer_t g_victim;
+static hit_t g_self_hit;
+static hit_t g_victim_hit;
+
+static void on_restart_and_cancel(void *ctx, uint32_t now_ms)
+{
+    on_hit(ctx, now_ms);
+    timer_wheel_cancel(&g_victim);
+    if (g_self_hit.fired < 3) {
+        timer_wheel_start(&g_self, 1u, 0u, on_restart_and_cancel, ctx);
+    }
+}
+
+TEST(callbacks_may_start_and_cancel)
+{
+    uint32_t base = 0xFFFFFF00u;
+    g_self_hit.fired = 0;
+    g_victim_hit.fired = 0;
+    /* Same bucket: the cancel lands while the victim waits in the drain. */
+    timer_wheel_start(&g_self, 4u, 0u, on_restart_and_cancel, &g_self_hit);
+    timer_wheel_start(&g_victim, 4u, 0u, on_hit, &g_victim_hit);
+    run_until(base, base + 20u);
+    ASSERT_EQ(g_self_hit.fired, 3);
+    ASSERT_TRUE(g_self_hit.last_ms == base + 6u);
+    ASSERT_EQ(g_victim_hit.fired, 0);
+    ASSERT_EQ(timer_wheel_count(), 0);
+}
+
+TEST(next_due_hint)
+{
+    sw_timer_t a = {0}, b = {0};
+    hit_t h = {0};
+    uint32_t base = 0xFFFFFF00u;
+    ASSERT_TRUE(timer_wheel_next_due_ms(base) == UINT32_MAX);
+    timer_wheel_start(&a, 200u, 0u, on_hit, &h);
+    timer_wheel_start(&b, 30u, 0u, on_hit, &h);
+    ASSERT_TRUE(timer_wheel_next_due_ms(base) == 30u);
+    ASSERT_TRUE(timer_wheel_next_due_ms(base + 30u) == 0u);
+    timer_wheel_cancel(&b);
+    ASSERT_TRUE(timer_wheel_next_due_ms(base + 30u) == 170u);
+    /* Restarting moves the timer rather than adding it twice. */
+    timer_wheel_start(&a, 50u, 0u, on_hit, &h);
+    ASSERT_EQ(timer_wheel_count(), 1);
+    ASSERT_TRUE(timer_wheel_next_due_ms(base) == 50u);
+}
+
+int main(void)
+{
+    printf("\nTimer Wheel Unit Tests\n");
+    printf("======================\n\n");
+
+    RUN_TEST(one_shot_fires_once_on_time);
+    RUN_TEST(timer_beyond_one_turn);
+    RUN_TEST(periodic_rearms_and_cancels);
+    RUN_TEST(gap_longer_than_a_turn);
+    RUN_TEST(callbacks_may_start_and_cancel);
+    RUN_TEST(next_due_hint);
+
+    printf("\n");
+    printf("Results: %d passed, %d failed\n", tests_passed, tests_failed);
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * Unit Tests for the fixed-rate telemetry sampler.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "src/telemetry/tlm_sampler.h"
+#include "app_data.h"
+#include "control/control.h"
+
+motor_state_t g_motor;
+debug_inputs_t g_inputs;
+debug_outputs_t g_outputs;
+walk_state_t g_walk_state;
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static void setup(void)
+{
+    memset(&g_motor, 0, sizeof(g_motor));
+    memset(&g_inputs, 0, sizeof(g_inputs));
+    memset(&g_outputs, 0, sizeof(g_outputs));
+    g_walk_state = WALK_STATE_OFF;
+    tlm_sampler_init();
+}
+
+/* 5 ms TIM2 ticks from `from` to `to` inclusive. */
+static void run_ticks(uint32_t from, uint32_t to)
+{
+    for (uint32_t ms = from; ms <= to; ms += 5u)
+        tlm_sampler_isr_tick(ms);
+}
+
+TEST(samples_on_exact_period_boundaries)
+{
+    tlm_tick_t s;
+    g_inputs.speed_dmph = 155u;
+    g_inputs.brake = 1u;
+    g_outputs.assist_mode = 2u;
+    g_motor.soc_pct = 80u;
+
+    run_ticks(1005u, 1100u);
+    uint32_t want = 1000u + TLM_SAMPLER_PERIOD_MS;
+    uint32_t n = 0;
+    while (tlm_sampler_pop(&s))
+    {
+        ASSERT_TRUE(s.ms == want);
+        ASSERT_TRUE(s.speed_dmph == 155u && s.assist_mode == 2u && s.soc_pct == 80u);
+        ASSERT_TRUE(s.flags == TLM_SAMPLE_F_BRAKE);
+        want += TLM_SAMPLER_PERIOD_MS;
+        n++;
+    }
+    ASSERT_TRUE(n == 100u / TLM_SAMPLER_PERIOD_MS);
+}
+
+TEST(full_ring_drops_new_samples_and_counts_them)
+{
+    tlm_tick_t s;
+    tlm_sampler_stats_t st;
+
+    run_ticks(0u, (TLM_SAMPLER_DEPTH + 3u) * TLM_SAMPLER_PERIOD_MS);
+    tlm_sampler_get_stats(&st);
+    ASSERT_TRUE(st.taken == TLM_SAMPLER_DEPTH && st.dropped == 4u);
+    ASSERT_TRUE(st.hwm == TLM_SAMPLER_DEPTH);
+
+    /* The oldest samples survive; the gap shows up as a jump in ms. */
+    ASSERT_TRUE(tlm_sampler_pop(&s) && s.ms == 0u);
+    for (uint32_t i = 1; i < TLM_SAMPLER_DEPTH; ++i)
+        ASSERT_TRUE(tlm_sampler_pop(&s));
+    ASSERT_TRUE(s.ms == (TLM_SAMPLER_DEPTH - 1u) * TLM_SAMPLER_PERIOD_MS);
+    ASSERT_TRUE(!tlm_sampler_pop(&s));
+
+    uint32_t next = (TLM_SAMPLER_DEPTH + 4u) * TLM_SAMPLER_PERIOD_MS;
+    tlm_sampler_isr_tick(next);
+    ASSERT_TRUE(tlm_sampler_pop(&s) && s.ms == next);
+}
+
+TEST(missed_ticks_reanchor_without_a_burst)
+{
+    tlm_tick_t s;
+    tlm_sampler_isr_tick(20u);
+    /* Timebase jumped (polled UIF lost wraps): one sample, then back on grid. */
+    tlm_sampler_isr_tick(135u);
+    tlm_sampler_isr_tick(140u);
+    tlm_sampler_isr_tick(160u);
+    ASSERT_TRUE(tlm_sampler_pop(&s) && s.ms == 20u);
+    ASSERT_TRUE(tlm_sampler_pop(&s) && s.ms == 135u);
+    ASSERT_TRUE(tlm_sampler_pop(&s) && s.ms == 140u);
+    ASSERT_TRUE(tlm_sampler_pop(&s) && s.ms == 160u);
+    ASSERT_TRUE(!tlm_sampler_pop(&s));
+}
+
+int main(void)
+{
+    printf("\nTelemetry Sampler Unit Tests\n");
+    printf("============================\n\n");
+
+    RUN_TEST(samples_on_exact_period_boundaries);
+    RUN_TEST(full_ring_drops_new_samples_and_counts_them);
+    RUN_TEST(missed_ticks_reanchor_without_a_burst);
+
+    printf("\n");
+    printf("============================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("============================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
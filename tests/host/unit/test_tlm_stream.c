@@ -0,0 +1,147 @@
+/*
+ * Unit Tests for the telemetry stream v2 keyframe/delta encoder.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "src/telemetry/tlm_stream.h"
+#include "util/byteorder.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+static const uint16_t k_periods[TLM_GROUP_COUNT] = { 100u, 1000u, 250u };
+
+#define MASK(f) ((uint16_t)(1u << (f)))
+
+TEST(keyframe_then_deltas_of_changed_fields)
+{
+    tlm_stream_t s;
+    tlm_sample_t cur;
+    uint8_t out[TLM_STREAM_MAX_LEN];
+    memset(&s, 0, sizeof(s));
+    memset(&cur, 0, sizeof(cur));
+    uint16_t mask = MASK(TLM_F_SPEED_DMPH) | MASK(TLM_F_POWER_W) | MASK(TLM_F_SOC_PCT);
+    tlm_stream_configure(&s, mask, k_periods, 1000u);
+
+    cur.v[TLM_F_SPEED_DMPH] = 155u;
+    cur.v[TLM_F_POWER_W] = 250u;
+    cur.v[TLM_F_SOC_PCT] = 80u;
+    uint8_t len = tlm_stream_poll(&s, 5000u, &cur, out, sizeof(out));
+    ASSERT_TRUE(len == TLM_STREAM_HDR_LEN + 5u);
+    ASSERT_TRUE(out[0] == TLM_STREAM_VERSION && out[1] == TLM_FRAME_KEY);
+    ASSERT_TRUE(load_be16(&out[2]) == 0u);
+    ASSERT_TRUE(load_be32(&out[4]) == 5000u);
+    ASSERT_TRUE(load_be16(&out[8]) == mask);
+    ASSERT_TRUE(load_be16(&out[10]) == 155u && load_be16(&out[12]) == 250u && out[14] == 80u);
+    /* A us stamp changes the version and the time field only. */
+    tlm_stream_stamp_us(out, 0x89ABCDEFu);
+    ASSERT_TRUE(out[0] == TLM_STREAM_VERSION_US && out[1] == TLM_FRAME_KEY);
+    ASSERT_TRUE(load_be32(&out[4]) == 0x89ABCDEFu && load_be16(&out[8]) == mask);
+
+    /* Fast group not due yet. */
+    cur.v[TLM_F_SPEED_DMPH] = 160u;
+    ASSERT_TRUE(tlm_stream_poll(&s, 5050u, &cur, out, sizeof(out)) == 0u);
+
+    /* Only the changed fast field goes out; the slow group is not due. */
+    cur.v[TLM_F_SOC_PCT] = 79u;
+    len = tlm_stream_poll(&s, 5100u, &cur, out, sizeof(out));
+    ASSERT_TRUE(len == TLM_STREAM_HDR_LEN + 2u);
+    ASSERT_TRUE(out[1] == TLM_FRAME_DELTA && load_be16(&out[2]) == 1u);
+    ASSERT_TRUE(load_be16(&out[8]) == MASK(TLM_F_SPEED_DMPH));
+    ASSERT_TRUE(load_be16(&out[10]) == 160u);
+
+    /* Unchanged: nothing sent. */
+    ASSERT_TRUE(tlm_stream_poll(&s, 5200u, &cur, out, sizeof(out)) == 0u);
+
+    /* Keyframe period elapsed: full frame again. */
+    len = tlm_stream_poll(&s, 6000u, &cur, out, sizeof(out));
+    ASSERT_TRUE(len == TLM_STREAM_HDR_LEN + 5u && out[1] == TLM_FRAME_KEY);
+    ASSERT_TRUE(load_be16(&out[2]) == 2u && out[14] == 79u);
+}
+
+TEST(frame_that_does_not_fit_is_retried)
+{
+    tlm_stream_t s;
+    tlm_sample_t cur;
+    uint8_t out[TLM_STREAM_MAX_LEN];
+    memset(&s, 0, sizeof(s));
+    memset(&cur, 0, sizeof(cur));
+    tlm_stream_configure(&s, 0xFFFFu, k_periods, 0u);
+    ASSERT_TRUE(s.keyframe_ms == TLM_KEYFRAME_DEF_MS);
+
+    ASSERT_TRUE(tlm_stream_poll(&s, 0u, &cur, out, 8u) == 0u);
+    ASSERT_TRUE(s.skipped == 1u && s.seq == 0u);
+    ASSERT_TRUE(tlm_stream_poll(&s, 1u, &cur, out, sizeof(out)) == TLM_STREAM_MAX_LEN);
+    ASSERT_TRUE(out[1] == TLM_FRAME_KEY && load_be16(&out[2]) == 0u);
+
+    cur.v[TLM_F_BATT_DA] = (uint16_t)-12;
+    cur.v[TLM_F_ERR] = 0x1234u;     /* u8 field: only the low byte counts */
+    ASSERT_TRUE(tlm_stream_poll(&s, 101u, &cur, out, 11u) == 0u);
+    uint8_t len = tlm_stream_poll(&s, 102u, &cur, out, sizeof(out));
+    ASSERT_TRUE(len == TLM_STREAM_HDR_LEN + 2u);
+    ASSERT_TRUE(load_be16(&out[8]) == MASK(TLM_F_BATT_DA));
+    ASSERT_TRUE((int16_t)load_be16(&out[10]) == -12);
+    len = tlm_stream_poll(&s, 400u, &cur, out, sizeof(out));
+    ASSERT_TRUE(len == TLM_STREAM_HDR_LEN + 1u && out[10] == 0x34u);
+    ASSERT_TRUE(load_be16(&out[2]) == 2u);
+}
+
+TEST(configure_clamps_and_disables)
+{
+    tlm_stream_t s;
+    tlm_sample_t cur;
+    uint8_t out[TLM_STREAM_MAX_LEN];
+    const uint16_t fast_only[TLM_GROUP_COUNT] = { 1u, 0u, 0u };
+    memset(&s, 0, sizeof(s));
+    memset(&cur, 0, sizeof(cur));
+    tlm_stream_configure(&s, MASK(TLM_F_SPEED_DMPH) | MASK(TLM_F_ASSIST_MODE), fast_only, 5u);
+    ASSERT_TRUE(s.period_ms[TLM_GROUP_FAST] == TLM_PERIOD_MIN_MS);
+    ASSERT_TRUE(s.period_ms[TLM_GROUP_STATE] == 0u);
+    ASSERT_TRUE(s.keyframe_ms == TLM_KEYFRAME_MIN_MS);
+
+    ASSERT_TRUE(tlm_stream_poll(&s, 0u, &cur, out, sizeof(out)) != 0u);
+    /* Group period 0: state fields only travel in keyframes. */
+    cur.v[TLM_F_ASSIST_MODE] = 3u;
+    ASSERT_TRUE(tlm_stream_poll(&s, 50u, &cur, out, sizeof(out)) == 0u);
+
+    tlm_stream_configure(&s, 0u, fast_only, 0u);
+    ASSERT_TRUE(tlm_stream_poll(&s, 500u, &cur, out, sizeof(out)) == 0u);
+}
+
+int main(void)
+{
+    printf("\nTelemetry Stream v2 Unit Tests\n");
+    printf("==============================\n\n");
+
+    RUN_TEST(keyframe_then_deltas_of_changed_fields);
+    RUN_TEST(frame_that_does_not_fit_is_retried);
+    RUN_TEST(configure_clamps_and_disables);
+
+    printf("\n");
+    printf("==============================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("==============================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
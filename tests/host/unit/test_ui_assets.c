@@ -0,0 +1,180 @@
+/*
+ * Unit Tests for the UI asset pack flash store.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "storage/ui_assets.h"
+#include "storage/layout.h"
+#include "drivers/spi_flash.h"
+#include "platform/watchdog.h"
+#include "util/byteorder.h"
+#include "util/crc32.h"
+
+volatile uint32_t g_ms;
+
+static uint8_t s_flash[UI_ASSET_STORAGE_BYTES];
+
+static uint32_t off_of(uint32_t addr)
+{
+    return addr - UI_ASSET_STORAGE_BASE;
+}
+
+void spi_flash_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    memcpy(out, &s_flash[off_of(addr)], len);
+}
+
+void spi_flash_erase_4k(uint32_t addr)
+{
+    memset(&s_flash[off_of(addr)], 0xFF, SPI_FLASH_SECTOR_SIZE);
+}
+
+void spi_flash_write(uint32_t addr, const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; ++i)
+        s_flash[off_of(addr) + i] &= data[i];
+}
+
+/* Waits run unbudgeted on the host. */
+void watchdog_budget_begin(watchdog_budget_t *b, uint32_t budget_us)
+{
+    (void)b;
+    (void)budget_us;
+}
+
+uint8_t watchdog_budget_poll(watchdog_budget_t *b)
+{
+    (void)b;
+    return 1u;
+}
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define CHUNK 184u
+#define ID_RGB 0x424C4501u
+#define ID_A4  0x57524E01u
+
+/* Two sprites: a 4x3 RGB565 block and a 30 byte A4 stream. */
+static uint8_t s_pack[UI_ASSET_INDEX_BYTES + 2u * UI_ASSET_ENTRY_BYTES + 24u + 30u];
+
+static void put_entry(uint8_t *e, uint32_t id, uint16_t w, uint16_t h, uint8_t fmt,
+                      uint16_t len, uint32_t off)
+{
+    store_be32(&e[0], id);
+    store_be16(&e[4], w);
+    store_be16(&e[6], h);
+    e[8] = fmt;
+    e[9] = 0u;
+    store_be16(&e[10], len);
+    store_be32(&e[12], off);
+}
+
+static void setup(void)
+{
+    memset(s_flash, 0xA5, sizeof(s_flash));
+    memset(s_pack, 0, sizeof(s_pack));
+    uint32_t data = UI_ASSET_INDEX_BYTES + 2u * UI_ASSET_ENTRY_BYTES;
+    store_be16(&s_pack[0], 2u);
+    put_entry(&s_pack[UI_ASSET_INDEX_BYTES], ID_RGB, 4u, 3u, UI_ASSET_FMT_RGB565, 24u, data);
+    put_entry(&s_pack[UI_ASSET_INDEX_BYTES + UI_ASSET_ENTRY_BYTES], ID_A4, 6u, 6u,
+              UI_ASSET_FMT_A4_RLE, 30u, data + 24u);
+    for (uint32_t i = data; i < sizeof(s_pack); ++i)
+        s_pack[i] = (uint8_t)(i * 13u);
+}
+
+static int upload(uint32_t bytes)
+{
+    ui_assets_store_begin();
+    for (uint32_t off = 0; off < bytes; off += CHUNK)
+    {
+        uint32_t n = (bytes - off < CHUNK) ? bytes - off : CHUNK;
+        if (!ui_assets_store_write(off, &s_pack[off], n))
+            return 0;
+    }
+    return 1;
+}
+
+TEST(upload_round_trips_and_indexes_sprites)
+{
+    ASSERT_TRUE(upload(sizeof(s_pack)));
+    ASSERT_TRUE(ui_assets_store_finish(sizeof(s_pack), crc32_compute(s_pack, sizeof(s_pack))));
+
+    ui_asset_t a;
+    ASSERT_TRUE(ui_asset_find(ID_A4, &a));
+    ASSERT_TRUE(a.w == 6u && a.h == 6u && a.len == 30u && a.fmt == UI_ASSET_FMT_A4_RLE);
+    ASSERT_TRUE(memcmp(&s_flash[off_of(a.addr)], &s_pack[sizeof(s_pack) - 30u], 30u) == 0);
+    ASSERT_TRUE(ui_asset_find(ID_RGB, &a));
+    ASSERT_TRUE(a.fmt == UI_ASSET_FMT_RGB565 && a.len == 24u);
+    ASSERT_TRUE(!ui_asset_find(0x12345678u, NULL));
+
+    ui_assets_info_t info;
+    ui_assets_get_info(&info);
+    ASSERT_TRUE(info.valid && info.count == 2u && info.bytes == sizeof(s_pack));
+}
+
+TEST(interrupted_or_corrupt_upload_leaves_no_pack)
+{
+    ASSERT_TRUE(upload(sizeof(s_pack)));
+    ASSERT_TRUE(ui_assets_store_finish(sizeof(s_pack), crc32_compute(s_pack, sizeof(s_pack))));
+
+    /* A new upload drops the old pack until it commits. */
+    ASSERT_TRUE(upload(sizeof(s_pack) / 2u));
+    ASSERT_TRUE(!ui_asset_find(ID_RGB, NULL));
+    ASSERT_TRUE(!ui_assets_store_finish(sizeof(s_pack), crc32_compute(s_pack, sizeof(s_pack))));
+    ASSERT_TRUE(!ui_asset_find(ID_RGB, NULL));
+
+    /* Bad CRC. */
+    ASSERT_TRUE(upload(sizeof(s_pack)));
+    ASSERT_TRUE(!ui_assets_store_finish(sizeof(s_pack), 0x12345678u));
+    ASSERT_TRUE(!ui_asset_find(ID_RGB, NULL));
+
+    /* A matching CRC does not save an index that points past the body,
+     * nor an RGB565 entry whose length disagrees with its size. */
+    store_be16(&s_pack[UI_ASSET_INDEX_BYTES + UI_ASSET_ENTRY_BYTES + 10u], 31u);
+    ASSERT_TRUE(upload(sizeof(s_pack)));
+    ASSERT_TRUE(!ui_assets_store_finish(sizeof(s_pack), crc32_compute(s_pack, sizeof(s_pack))));
+    setup();
+    store_be16(&s_pack[UI_ASSET_INDEX_BYTES + 6u], 4u);
+    ASSERT_TRUE(upload(sizeof(s_pack)));
+    ASSERT_TRUE(!ui_assets_store_finish(sizeof(s_pack), crc32_compute(s_pack, sizeof(s_pack))));
+    ASSERT_TRUE(!ui_asset_find(ID_A4, NULL));
+}
+
+int main(void)
+{
+    printf("\nUI Asset Pack Store Unit Tests\n");
+    printf("==============================\n\n");
+
+    RUN_TEST(upload_round_trips_and_indexes_sprites);
+    RUN_TEST(interrupted_or_corrupt_upload_leaves_no_pack);
+
+    printf("\n");
+    printf("==============================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("==============================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,342 @@
+/*
+ * Unit Tests for the RAM band the LCD compositor rasterizes into and the
+ * indexed framebuffer bands are diffed against.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ui_band.h"
+#include "ui_fb8.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+#define UNSET 0xDEADu
+
+static uint16_t s_px[UI_BAND_PIXELS];
+static uint16_t s_panel[DISP_H][DISP_W];
+static ui_band_t s_band;
+static ui_fb8_t s_fb;
+static uint32_t s_pushes;
+static uint32_t s_contiguous;
+
+/* Panel model: the pushed rows land where the window says. */
+static void fake_push(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h,
+                      const uint16_t *px, uint16_t stride)
+{
+    (void)ctx;
+    s_pushes++;
+    if (stride == w)
+        s_contiguous++;
+    for (uint16_t r = 0; r < h; ++r)
+        memcpy(&s_panel[y + r][x], &px[(uint32_t)r * stride], (size_t)w * sizeof(uint16_t));
+}
+
+static void setup(void)
+{
+    for (uint32_t y = 0; y < DISP_H; ++y)
+    {
+        for (uint32_t x = 0; x < DISP_W; ++x)
+            s_panel[y][x] = UNSET;
+    }
+    s_pushes = 0u;
+    s_contiguous = 0u;
+    ui_band_begin(&s_band, s_px, 64u, UI_BAND_H);
+    memset(s_fb.idx, 0x5A, sizeof(s_fb.idx));
+    ui_fb8_reset(&s_fb);
+}
+
+/* One band through the framebuffer, as the compositor does it. */
+static void composite(void)
+{
+    if (ui_fb8_absorb(&s_fb, &s_band))
+    {
+        ui_band_flush(&s_band, fake_push, NULL);
+        ui_fb8_push_row(&s_fb, (uint16_t)(s_band.y0 / UI_FB8_TILE), s_px, fake_push, NULL);
+    }
+    else
+    {
+        ui_band_flush(&s_band, fake_push, NULL);
+    }
+}
+
+static void fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color)
+{
+    ui_band_window(&s_band, x, y, w, h);
+    ui_band_fill(&s_band, color, (uint32_t)w * h);
+}
+
+TEST(overdraw_pushes_one_contiguous_rect)
+{
+    fill(10u, 66u, 100u, 12u, 0x1111u);
+    fill(20u, 68u, 30u, 5u, 0x2222u);
+    uint16_t row[50];
+    for (uint16_t i = 0; i < 50u; ++i)
+        row[i] = (uint16_t)(0x3000u + i);
+    ui_band_window(&s_band, 60u, 75u, 50u, 1u);
+    ui_band_write(&s_band, row, 50u);
+
+    ASSERT_TRUE(ui_band_flush(&s_band, fake_push, NULL) == 1u);
+    ASSERT_TRUE(s_contiguous == 1u);
+    ASSERT_TRUE(s_panel[66][10] == 0x1111u);
+    ASSERT_TRUE(s_panel[77][109] == 0x1111u);
+    ASSERT_TRUE(s_panel[68][20] == 0x2222u);
+    ASSERT_TRUE(s_panel[72][49] == 0x2222u);
+    ASSERT_TRUE(s_panel[73][20] == 0x1111u);
+    ASSERT_TRUE(s_panel[75][60] == 0x3000u);
+    ASSERT_TRUE(s_panel[75][109] == 0x3000u + 49u);
+    ASSERT_TRUE(s_panel[65][10] == UNSET);
+    ASSERT_TRUE(s_panel[78][10] == UNSET);
+    ASSERT_TRUE(s_panel[66][110] == UNSET);
+}
+
+TEST(uncovered_pixels_are_left_alone)
+{
+    /* Two separate blocks and a ragged row. */
+    fill(0u, 64u, 8u, 4u, 0xAAAAu);
+    fill(200u, 64u, 40u, 4u, 0xBBBBu);
+    fill(100u, 76u, 3u, 1u, 0xCCCCu);
+
+    uint16_t rects = ui_band_flush(&s_band, fake_push, NULL);
+    ASSERT_TRUE(rects == 3u);
+    ASSERT_TRUE(s_panel[64][0] == 0xAAAAu);
+    ASSERT_TRUE(s_panel[67][7] == 0xAAAAu);
+    ASSERT_TRUE(s_panel[64][8] == UNSET);
+    ASSERT_TRUE(s_panel[67][239] == 0xBBBBu);
+    ASSERT_TRUE(s_panel[68][239] == UNSET);
+    ASSERT_TRUE(s_panel[76][102] == 0xCCCCu);
+    ASSERT_TRUE(s_panel[76][103] == UNSET);
+    ASSERT_TRUE(s_panel[72][100] == UNSET);
+}
+
+TEST(outside_rows_are_dropped_and_window_wraps)
+{
+    /* Starts above the band: its first rows advance the cursor only. */
+    uint16_t px[8];
+    for (uint16_t i = 0; i < 8u; ++i)
+        px[i] = (uint16_t)(0x4000u + i);
+    ui_band_window(&s_band, 5u, 62u, 2u, 4u);
+    ui_band_write(&s_band, px, 8u);
+    /* Past the window's end nothing more is taken. */
+    ui_band_fill(&s_band, 0xFFFFu, 4u);
+    fill(0u, 64u + UI_BAND_H, 4u, 2u, 0x5555u);
+
+    ASSERT_TRUE(ui_band_flush(&s_band, fake_push, NULL) == 1u);
+    ASSERT_TRUE(s_panel[64][5] == 0x4004u);
+    ASSERT_TRUE(s_panel[64][6] == 0x4005u);
+    ASSERT_TRUE(s_panel[65][5] == 0x4006u);
+    ASSERT_TRUE(s_panel[65][6] == 0x4007u);
+    ASSERT_TRUE(s_panel[63][5] == UNSET);
+    ASSERT_TRUE(s_panel[66][5] == UNSET);
+    ASSERT_TRUE(s_panel[64 + UI_BAND_H][0] == UNSET);
+}
+
+TEST(flush_empties_the_band)
+{
+    ASSERT_TRUE(ui_band_flush(&s_band, fake_push, NULL) == 0u);
+    fill(0u, 64u, DISP_W, UI_BAND_H, 0x0101u);
+    ASSERT_TRUE(ui_band_flush(&s_band, fake_push, NULL) == 1u);
+    ASSERT_TRUE(s_panel[64 + UI_BAND_H - 1u][DISP_W - 1u] == 0x0101u);
+    ASSERT_TRUE(ui_band_flush(&s_band, fake_push, NULL) == 0u);
+    ASSERT_TRUE(s_pushes == 1u);
+}
+
+TEST(framebuffer_pushes_only_changed_tiles)
+{
+    /* Seeds the band row: every tile becomes known. */
+    fill(0u, 64u, DISP_W, UI_BAND_H, 0x0101u);
+    fill(40u, 66u, 8u, 3u, 0x0202u);
+    composite();
+    ASSERT_TRUE(s_pushes == 1u);
+    ASSERT_TRUE(s_panel[66][40] == 0x0202u);
+    ASSERT_TRUE(s_panel[79][239] == 0x0101u);
+
+    /* The same frame again changes nothing. */
+    s_pushes = 0u;
+    fill(0u, 64u, DISP_W, UI_BAND_H, 0x0101u);
+    fill(40u, 66u, 8u, 3u, 0x0202u);
+    composite();
+    ASSERT_TRUE(s_pushes == 0u);
+
+    /* One pixel in tile 12 and a redraw of tiles 2..3: two tile runs. */
+    s_pushes = 0u;
+    fill(200u, 70u, 1u, 1u, 0x0303u);
+    fill(40u, 66u, 8u, 3u, 0x0101u);
+    fill(50u, 66u, 8u, 3u, 0x0404u);
+    composite();
+    ASSERT_TRUE(s_pushes == 2u);
+    ASSERT_TRUE(s_panel[70][200] == 0x0303u);
+    ASSERT_TRUE(s_panel[66][40] == 0x0101u);
+    ASSERT_TRUE(s_panel[68][57] == 0x0404u);
+    ASSERT_TRUE(s_panel[64][0] == 0x0101u);
+}
+
+TEST(unknown_tiles_go_out_from_the_band)
+{
+    /* Partly covered tiles are not known yet: covered pixels only. */
+    fill(3u, 65u, 4u, 2u, 0x0707u);
+    composite();
+    ASSERT_TRUE(s_pushes == 1u);
+    ASSERT_TRUE(s_panel[65][3] == 0x0707u);
+    ASSERT_TRUE(s_panel[65][2] == UNSET);
+
+    /* Seeded, then drawn over behind the compositor's back. */
+    fill(0u, 64u, DISP_W, UI_BAND_H, 0x0101u);
+    composite();
+    ui_fb8_forget(&s_fb, 20u, 70u, 1u, 1u);
+    s_pushes = 0u;
+    fill(16u, 64u, 4u, 1u, 0x0808u);
+    fill(0u, 64u, 4u, 1u, 0x0808u);
+    composite();
+    /* Tile 1 goes out direct (a 4-pixel run), tile 0 from the framebuffer. */
+    ASSERT_TRUE(s_pushes == 2u);
+    ASSERT_TRUE(s_panel[64][16] == 0x0808u);
+    ASSERT_TRUE(s_panel[64][0] == 0x0808u);
+}
+
+TEST(full_lut_is_collected_then_reset)
+{
+    /* 256 colours seed the row; the next frame's new colours free them. */
+    for (uint16_t i = 0; i < 240u; ++i)
+        fill(i, 64u, 1u, UI_BAND_H, (uint16_t)(0x1000u + i));
+    composite();
+    for (uint16_t i = 0; i < 240u; ++i)
+        fill(i, 64u, 1u, UI_BAND_H, (uint16_t)(0x2000u + i));
+    composite();
+    ASSERT_TRUE(s_fb.collects == 1u);
+    ASSERT_TRUE(s_fb.resets == 0u);
+    ASSERT_TRUE(s_panel[79][239] == 0x2000u + 239u);
+
+    /* More colours in one band than the LUT holds. */
+    for (uint16_t i = 0; i < 240u; ++i)
+    {
+        fill(i, 64u, 1u, 8u, (uint16_t)(0x3000u + i));
+        fill(i, 72u, 1u, 8u, (uint16_t)(0x4000u + i));
+    }
+    composite();
+    ASSERT_TRUE(s_fb.resets == 1u);
+    ASSERT_TRUE(s_panel[64][0] == 0x3000u);
+    ASSERT_TRUE(s_panel[79][239] == 0x4000u + 239u);
+}
+
+/* Viewer model: decodes reads into s_view, returns the reads taken. */
+static uint16_t s_view[DISP_H][DISP_W];
+
+static uint32_t remote_drain(uint16_t cap)
+{
+    static uint8_t rle[512];
+    ui_fb8_remote_chunk_t c;
+    uint32_t reads = 0u;
+    uint16_t n;
+    while ((n = ui_fb8_remote_next(&s_fb, &c, rle, cap)) != 0u)
+    {
+        uint32_t k = c.pos;
+        for (uint16_t i = 0; i < n;)
+        {
+            uint8_t ctl = rle[i++];
+            uint32_t count = (ctl & 0x7Fu) + 1u;
+            for (uint32_t j = 0; j < count; ++j)
+            {
+                uint16_t px = (uint16_t)(rle[i] | (rle[i + 1u] << 8));
+                if (!(ctl & 0x80u) || j + 1u == count)
+                    i = (uint16_t)(i + 2u);
+                s_view[c.y + k / c.w][c.x + k % c.w] = px;
+                k++;
+            }
+        }
+        reads++;
+    }
+    return reads;
+}
+
+TEST(remote_reads_what_the_panel_shows)
+{
+    memset(s_view, 0, sizeof(s_view));
+    for (uint16_t i = 0; i < 240u; ++i)
+        fill(i, 64u, 1u, UI_BAND_H, (uint16_t)(((i / 3u) & 1u) ? 0x1234u : (0x4000u + i)));
+    fill(30u, 70u, 50u, 4u, 0x0F0Fu);
+    composite();
+    ASSERT_TRUE(ui_fb8_remote_pending(&s_fb) == UI_FB8_TILES);
+
+    /* One rect for the known row, cut into reads that fit the cap. */
+    ASSERT_TRUE(remote_drain(40u) > 1u);
+    ASSERT_TRUE(ui_fb8_remote_pending(&s_fb) == UI_FB8_TILES - UI_FB8_TILES_X);
+    for (uint16_t y = 64u; y < 64u + UI_BAND_H; ++y)
+        ASSERT_TRUE(memcmp(s_view[y], s_panel[y], sizeof(s_view[y])) == 0);
+    ASSERT_TRUE(s_view[63][0] == 0u);
+
+    /* A redraw: only the changed tile is pending. */
+    fill(0u, 64u, DISP_W, UI_BAND_H, 0x1234u);
+    for (uint16_t i = 0; i < 240u; ++i)
+        fill(i, 64u, 1u, UI_BAND_H, (uint16_t)(((i / 3u) & 1u) ? 0x1234u : (0x4000u + i)));
+    fill(30u, 70u, 50u, 4u, 0x0F0Fu);
+    fill(100u, 75u, 2u, 1u, 0x5555u);
+    composite();
+    ASSERT_TRUE(ui_fb8_remote_pending(&s_fb) == UI_FB8_TILES - UI_FB8_TILES_X + 1u);
+    ASSERT_TRUE(remote_drain(512u) == 1u);
+    ASSERT_TRUE(s_view[75][100] == 0x5555u && s_view[75][101] == 0x5555u);
+    ASSERT_TRUE(memcmp(s_view[75], s_panel[75], sizeof(s_view[75])) == 0);
+}
+
+TEST(remote_drops_a_rect_forgotten_mid_read)
+{
+    fill(0u, 64u, DISP_W, UI_BAND_H, 0x0101u);
+    composite();
+    ui_fb8_remote_chunk_t c;
+    uint8_t rle[3];
+    ASSERT_TRUE(ui_fb8_remote_next(&s_fb, &c, rle, sizeof(rle)) == 3u);
+    ASSERT_TRUE(c.x == 0u && c.y == 64u && c.w == DISP_W && c.pos == 0u);
+    ASSERT_TRUE(ui_fb8_remote_next(&s_fb, &c, rle, sizeof(rle)) == 3u);
+    ASSERT_TRUE(c.pos == 128u);
+
+    /* Tile 5 is no longer known: the row is pending again and the read
+     * starts over with the tiles left of it. */
+    ui_fb8_forget(&s_fb, 80u, 64u, 1u, 1u);
+    ASSERT_TRUE(ui_fb8_remote_next(&s_fb, &c, rle, sizeof(rle)) == 3u);
+    ASSERT_TRUE(c.x == 0u && c.w == 80u && c.pos == 0u);
+    ASSERT_TRUE(ui_fb8_remote_pending(&s_fb) == UI_FB8_TILES - 5u);
+}
+
+int main(void)
+{
+    printf("\nUI Band Unit Tests\n");
+    printf("==================\n\n");
+
+    RUN_TEST(overdraw_pushes_one_contiguous_rect);
+    RUN_TEST(uncovered_pixels_are_left_alone);
+    RUN_TEST(outside_rows_are_dropped_and_window_wraps);
+    RUN_TEST(flush_empties_the_band);
+    RUN_TEST(framebuffer_pushes_only_changed_tiles);
+    RUN_TEST(unknown_tiles_go_out_from_the_band);
+    RUN_TEST(full_lut_is_collected_then_reset);
+    RUN_TEST(remote_reads_what_the_panel_shows);
+    RUN_TEST(remote_drops_a_rect_forgotten_mid_read);
+
+    printf("\n");
+    printf("==================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("==================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,204 @@
+/*
+ * Unit Tests for the big-digit glyph cache and shadowed glyph blit.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "ui_glyph_cache.h"
+#include "ui_draw_common.h"
+
+#define TEST(name) static void test_##name(void)
+#define RUN_TEST(name) do { \
+    printf("  %-50s ", #name); \
+    setup(); \
+    test_##name(); \
+    printf("PASS\n"); \
+    tests_passed++; \
+} while(0)
+
+#define ASSERT_TRUE(cond) do { \
+    if (!(cond)) { \
+        printf("FAIL\n    Assertion failed: %s\n    at %s:%d\n", \
+               #cond, __FILE__, __LINE__); \
+        tests_failed++; \
+        return; \
+    } \
+} while(0)
+
+static int tests_passed = 0;
+static int tests_failed = 0;
+
+/* A 4x4 glyph: rows 0-1 cover columns 0-1 (one repeat token), rows 2-3 empty. */
+static const uint8_t k_glyph[] = {
+    0x02, 0x00, 0x40, 0xFF,
+    0x02, 0x00, 0x40, 0xFF,
+    0x00, 0x00,
+    0x00, 0x00,
+};
+
+static uint8_t s_flash[0x4000];
+static uint32_t s_reads;
+
+static void fake_read(uint32_t addr, uint8_t *out, uint32_t len)
+{
+    s_reads++;
+    memcpy(out, &s_flash[addr], len);
+}
+
+static ui_sprite_t glyph_at(uint32_t addr, uint32_t tag)
+{
+    ui_sprite_t sp = {0};
+    sp.addr = addr;
+    sp.tag = tag;
+    sp.w = 4u;
+    sp.h = 4u;
+    sp.len = sizeof(k_glyph);
+    sp.fmt = UI_SPRITE_FMT_A4_RLE;
+    return sp;
+}
+
+static void setup(void)
+{
+    memset(s_flash, 0, sizeof(s_flash));
+    memcpy(&s_flash[0x100], k_glyph, sizeof(k_glyph));
+    memcpy(&s_flash[0x200], k_glyph, sizeof(k_glyph));
+    s_reads = 0u;
+    ui_glyph_cache_set_read(fake_read);
+}
+
+TEST(glyphs_load_once_until_the_pack_changes)
+{
+    ui_sprite_t sp = glyph_at(0x100u, 1u);
+    const uint8_t *a = ui_glyph_cache_get(&sp);
+    ASSERT_TRUE(a && memcmp(a, k_glyph, sizeof(k_glyph)) == 0);
+    ASSERT_TRUE(ui_glyph_cache_get(&sp) == a);
+    ASSERT_TRUE(s_reads == 1u);
+
+    ui_sprite_t other = glyph_at(0x200u, 1u);
+    ASSERT_TRUE(ui_glyph_cache_get(&other) != a);
+    ASSERT_TRUE(s_reads == 2u);
+
+    /* A new pack (tag) drops everything cached from the old one. */
+    sp.tag = 2u;
+    ASSERT_TRUE(ui_glyph_cache_get(&sp) != NULL);
+    ASSERT_TRUE(s_reads == 3u);
+
+    ui_glyph_cache_stats_t st;
+    ui_glyph_cache_get_stats(&st);
+    ASSERT_TRUE(st.hits == 1u && st.loads == 3u && st.flushes == 1u && st.entries == 1u);
+}
+
+TEST(bad_glyphs_are_rejected_and_not_reread)
+{
+    /* Row 2 claims more bytes than the stream holds. */
+    s_flash[0x100 + 8] = 0x20u;
+    ui_sprite_t sp = glyph_at(0x100u, 1u);
+    ASSERT_TRUE(ui_glyph_cache_get(&sp) == NULL);
+    ASSERT_TRUE(ui_glyph_cache_get(&sp) == NULL);
+    ASSERT_TRUE(s_reads == 1u);
+
+    ui_sprite_t wide = glyph_at(0x200u, 1u);
+    wide.w = UI_GLYPH_MAX_W + 1u;
+    ASSERT_TRUE(ui_glyph_cache_get(&wide) == NULL);
+    ui_sprite_t big = glyph_at(0x200u, 1u);
+    big.addr = 0x300u;
+    big.len = UI_GLYPH_CACHE_BYTES + 1u;
+    ASSERT_TRUE(ui_glyph_cache_get(&big) == NULL);
+    ASSERT_TRUE(s_reads == 1u);
+
+    ui_glyph_cache_stats_t st;
+    ui_glyph_cache_get_stats(&st);
+    ASSERT_TRUE(st.rejects == 3u && st.used == 0u);
+}
+
+TEST(full_pool_starts_over)
+{
+    /* Distinct addresses reading the same glyph fill the slots. */
+    for (uint32_t i = 0; i < UI_GLYPH_CACHE_SLOTS; ++i)
+    {
+        memcpy(&s_flash[0x1000 + i * 0x20u], k_glyph, sizeof(k_glyph));
+        ui_sprite_t sp = glyph_at(0x1000u + i * 0x20u, 1u);
+        ASSERT_TRUE(ui_glyph_cache_get(&sp) != NULL);
+    }
+    ui_sprite_t sp = glyph_at(0x100u, 1u);
+    ASSERT_TRUE(ui_glyph_cache_get(&sp) != NULL);
+
+    ui_glyph_cache_stats_t st;
+    ui_glyph_cache_get_stats(&st);
+    ASSERT_TRUE(st.flushes == 1u && st.entries == 1u && st.used == sizeof(k_glyph));
+}
+
+#define FB_W 6u
+#define FB_H 6u
+#define UNTOUCHED 0xDEADu
+
+typedef struct {
+    uint16_t px[FB_H][FB_W];
+    uint32_t windows;
+    uint16_t win_h;
+} fb_t;
+
+static void fb_begin(void *ctx, uint16_t x, uint16_t y, uint16_t w, uint16_t h)
+{
+    (void)x;
+    (void)y;
+    (void)w;
+    fb_t *fb = (fb_t *)ctx;
+    fb->windows++;
+    if (h > fb->win_h)
+        fb->win_h = h;
+}
+
+static void fb_pixel(void *ctx, uint16_t x, uint16_t y, uint16_t color)
+{
+    ((fb_t *)ctx)->px[y][x] = color;
+}
+
+static void fb_run(void *ctx, uint16_t x, uint16_t y, uint16_t n, uint16_t color)
+{
+    for (uint16_t i = 0; i < n; ++i)
+        fb_pixel(ctx, (uint16_t)(x + i), y, color);
+}
+
+TEST(glyph_blit_puts_face_over_shadow)
+{
+    static const ui_draw_pixel_writer_t ops = {fb_begin, fb_pixel, fb_run};
+    fb_t fb;
+    for (uint16_t y = 0; y < FB_H; ++y)
+        for (uint16_t x = 0; x < FB_W; ++x)
+            fb.px[y][x] = UNTOUCHED;
+    fb.windows = 0u;
+    fb.win_h = 0u;
+
+    const uint16_t fg = 0xF800u, shadow = 0x0010u, bg = 0x0000u;
+    ui_draw_glyph_t g = {k_glyph, sizeof(k_glyph), 4u, 4u, fg, shadow, bg, 2u};
+    ui_draw_glyph_a4(&ops, &fb, 0u, 0u, &g);
+
+    /* Face at (0..1, 0..1), shadow at (2..3, 2..3). */
+    ASSERT_TRUE(fb.px[0][0] == fg && fb.px[1][1] == fg);
+    ASSERT_TRUE(fb.px[2][2] == shadow && fb.px[3][3] == shadow);
+    ASSERT_TRUE(fb.px[0][2] == UNTOUCHED && fb.px[2][0] == UNTOUCHED && fb.px[4][4] == UNTOUCHED);
+    /* Two face rows, then two shadow rows: one window of two rows each. */
+    ASSERT_TRUE(fb.windows == 2u && fb.win_h == 2u);
+}
+
+int main(void)
+{
+    printf("\nUI Glyph Cache Unit Tests\n");
+    printf("=========================\n\n");
+
+    RUN_TEST(glyphs_load_once_until_the_pack_changes);
+    RUN_TEST(bad_glyphs_are_rejected_and_not_reread);
+    RUN_TEST(full_pool_starts_over);
+    RUN_TEST(glyph_blit_puts_face_over_shadow);
+
+    printf("\n");
+    printf("=========================\n");
+    printf("Tests passed: %d\n", tests_passed);
+    printf("Tests failed: %d\n", tests_failed);
+    printf("=========================\n\n");
+
+    return tests_failed > 0 ? 1 : 0;
+}
@@ -1,14 +1,19 @@
 #include "ui.h"
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "src/core/math_util.h"
 #include "src/core/trace_format.h"
+#include "src/core/trace_bin.h"
 #include "src/bus/bus.h"
 #include "util/crc32.h"
+#include "ui_trig.h"
 #include "ui_display.h"
 #include "ui_font_bitmap.h"
 #include "ui_color.h"
+#include "ui_draw_common.h"
+#include "ui_glyph_cache.h"
 #ifdef UI_PIXEL_SIM
 #include "ui_pixel_sink.h"
 #endif
@@ -52,6 +57,10 @@
 #define UI_PANEL_DITHER_TINT 24u
 
 #define MAX_DIRTY UI_MAX_DIRTY
+/* Fixed cost of one extra dirty rect in pixel-equivalents (window set plus a
+ * pass over the screen's widgets). Merging two rects pays off while the union
+ * redraws fewer unchanged pixels than this. */
+#define DIRTY_RECT_COST_PX 768u
 
 #define MM_PER_MILE 1609340u
 #define MM_PER_KM 1000000u
@@ -86,12 +95,48 @@ struct ui_dirty {
     uint8_t full;
 };
 
+/* Colours the screens mix from the palette, expanded once per theme. */
+typedef enum {
+    UI_TINT_CARD = 0,         /* card fill: bg toward panel */
+    UI_TINT_CARD_DITHER,      /* dither partners for card and panel fills */
+    UI_TINT_PANEL_DITHER,
+    UI_TINT_CHIP_ON,          /* panel toward accent */
+    UI_TINT_GAUGE_ON,         /* ring gauges on the card */
+    UI_TINT_GAUGE_OFF,
+    UI_TINT_SEL,              /* selected row on the card */
+    UI_TINT_WARN_PULSE,
+    UI_TINT_ACCENT_DASH,      /* regen glow accent */
+    UI_TINT_COUNT
+} ui_tint_id_t;
+
+typedef struct {
+    uint16_t c[UI_TINT_COUNT];
+} ui_tints_t;
+
 struct ui_render_ctx {
     ui_state_t *ui;
     const ui_palette_t *palette;
+    const ui_tints_t *tints;
     uint8_t hash_enabled;
     uint8_t count_ops;
     uint8_t draw_enabled;
+    /* Progressive redraw: ops below ui->chunk_done are skipped, and with a
+     * budget the chunk stops at op_cut once UI_RENDER_CHUNK_US is spent. */
+    uint8_t chunked;
+    uint8_t chunk_budget;
+    uint16_t op_index;
+    uint16_t op_cut;
+    uint32_t chunk_t0;
+    /* Op diff: each op's signature and bounds are checked against
+     * ui->op_recs, and the ones that changed land in `diff`. */
+    ui_dirty_t *diff;
+    uint32_t op_sig;
+    ui_rect_t op_box;
+    uint16_t op_recs;
+    /* Clip stack (ui_clip_push): ops whose bounds miss the top draw
+     * nothing, and the LCD scissor follows the top. */
+    ui_rect_t clip[UI_CLIP_DEPTH];
+    uint8_t clip_depth;
 };
 
 typedef struct {
@@ -107,6 +152,128 @@ typedef struct {
 #define DIAG_ROW_MODE_IDX 8u
 #define DIAG_ROW_LIMIT_IDX 9u
 #define DIAG_ROW_TEXT_Y 0u
+
+/*
+ * Screen geometry: every widget rect is written once below as a constant
+ * initializer. UI_WIDGETS turns them into widget IDs and the k_ui_widgets
+ * table dirty tracking looks rects up in, and the page layout tables
+ * (k_dash_v2_layout, k_graph_layout) are built from the same macros, so a
+ * rect is a load rather than arithmetic.
+ */
+#define UI_RECT_FULL {0u, 0u, DISP_W, DISP_H}
+
+/* Dashboard v2: 12 px margin, 10 px gaps, 2 px strokes. */
+#define DASH_M 12u
+#define DASH_GAP 10u
+#define DASH_ST 2u
+#define DASH_TOP_H 20u
+#define DASH_STATS_H 44u /* compact 4-column single-row tray */
+#define DASH_SPEED_Y (DASH_M + DASH_TOP_H + DASH_GAP)
+#define DASH_CONTENT_W (DISP_W - 2u * DASH_M)
+#define DASH_SPEED_H (DISP_H - DASH_M - DASH_STATS_H - DASH_GAP - DASH_SPEED_Y)
+#define DASH_TRAY_Y (DASH_SPEED_Y + DASH_SPEED_H + DASH_GAP)
+#define UI_RECT_DASH_TOP {0u, 0u, DISP_W, DASH_SPEED_Y}
+#define UI_RECT_DASH_SPEED {DASH_M, DASH_SPEED_Y, DASH_CONTENT_W, DASH_SPEED_H}
+#define UI_RECT_DASH_SPEED_IN {DASH_M + DASH_ST, DASH_SPEED_Y + DASH_ST, \
+                               DASH_CONTENT_W - 2u * DASH_ST, DASH_SPEED_H - 2u * DASH_ST}
+#define UI_RECT_DASH_TRAY {DASH_M, DASH_TRAY_Y, DASH_CONTENT_W, DASH_STATS_H}
+#define UI_RECT_DASH_TRAY_IN {DASH_M + DASH_ST, DASH_TRAY_Y + DASH_ST, \
+                              DASH_CONTENT_W - 2u * DASH_ST, DASH_STATS_H - 2u * DASH_ST}
+
+/* Graphs: chips under the header, then the chart card. The dirty box adds
+ * the 2 px shadow where the panel has room; the plot is the card less 10 px,
+ * 8 more top and bottom for the labels, and the sweep leaves 2 px columns. */
+#define GRAPH_CHIP_Y (TOP_Y + TOP_H + G)
+#define GRAPH_BOX_X PAD
+#define GRAPH_BOX_Y (GRAPH_CHIP_Y + 32u)
+#define GRAPH_BOX_W (DISP_W - 2u * PAD)
+#define GRAPH_BOX_H 208u
+#define GRAPH_PLOT_X (GRAPH_BOX_X + 10u)
+#define GRAPH_PLOT_Y (GRAPH_BOX_Y + 10u + 8u)
+#define GRAPH_PLOT_W (GRAPH_BOX_W - 20u)
+#define GRAPH_PLOT_H (GRAPH_BOX_H - 20u - 16u)
+#define UI_RECT_GRAPH_HEADER {0u, TOP_Y, DISP_W, TOP_H}
+#define UI_RECT_GRAPH_CHIP_CHANNEL {PAD, GRAPH_CHIP_Y, 72u, 24u}
+#define UI_RECT_GRAPH_CHIP_WINDOW {PAD + 80u, GRAPH_CHIP_Y, 72u, 24u}
+#define UI_RECT_GRAPH_CHIP_HZ {PAD + 160u, GRAPH_CHIP_Y, 72u, 24u}
+#define UI_RECT_GRAPH_BOX {GRAPH_BOX_X, GRAPH_BOX_Y, GRAPH_BOX_W, GRAPH_BOX_H}
+#define UI_RECT_GRAPH_DIRTY {GRAPH_BOX_X, GRAPH_BOX_Y, \
+                             (GRAPH_BOX_X + GRAPH_BOX_W + 2u <= DISP_W) ? GRAPH_BOX_W + 2u : DISP_W - GRAPH_BOX_X, \
+                             (GRAPH_BOX_Y + GRAPH_BOX_H + 2u <= DISP_H) ? GRAPH_BOX_H + 2u : DISP_H - GRAPH_BOX_Y}
+#define UI_RECT_GRAPH_PLOT {GRAPH_PLOT_X, GRAPH_PLOT_Y, GRAPH_PLOT_W, GRAPH_PLOT_H}
+#define UI_RECT_GRAPH_SWEEP {GRAPH_PLOT_X + 2u, GRAPH_PLOT_Y, GRAPH_PLOT_W - 4u, GRAPH_PLOT_H}
+#define UI_RECT_GRAPH_LABEL_MIN {GRAPH_BOX_X + 12u, GRAPH_BOX_Y + GRAPH_BOX_H - 20u, 72u, 16u}
+#define UI_RECT_GRAPH_LABEL_MAX {GRAPH_BOX_X + GRAPH_BOX_W - 72u, GRAPH_BOX_Y + 10u, 72u, 16u}
+_Static_assert(GRAPH_BOX_H - 20u > 28u && GRAPH_PLOT_W > 4u, "graph plot insets assume a roomy card");
+
+#define UI_RECT_DIAG_ROW(i) {PAD, TOP_Y + TOP_H + G + DIAG_ROW_OFFSET_Y + (i) * DIAG_ROW_H, DISP_W - 2u * PAD, DIAG_ROW_H}
+
+/* Bus monitor: summary card, then the opcode rows (16 px and a 1 px rule
+ * every 18 px), then link health. The page runs past the panel bottom;
+ * rects are cut there, to nothing once wholly below it. */
+#define BUS_TOP_Y (TOP_Y + TOP_H + G)
+#define BUS_TOP_H 96u
+#define BUS_LIST_Y (BUS_TOP_Y + BUS_TOP_H + G)
+#define BUS_LIST_H 132u
+#define BUS_LINK_Y (BUS_LIST_Y + BUS_LIST_H + G)
+#define BUS_ROW_Y(i) (BUS_LIST_Y + 38u + (i) * 18u)
+#define BUS_ON_PANEL_H(y, h) (((y) + (h) <= DISP_H) ? (h) : (((y) < DISP_H) ? DISP_H - (y) : 0u))
+#define UI_RECT_BUS_COUNT {PAD + 92u, BUS_TOP_Y + 10u, DISP_W - 2u * PAD - 104u, 14u}
+#define UI_RECT_BUS_LAST {PAD + 12u, BUS_TOP_Y + 38u, DISP_W - 2u * PAD - 14u, 14u}
+#define UI_RECT_BUS_ROW(i) {PAD + 10u, BUS_ROW_Y(i), DISP_W - 2u * PAD - 20u, BUS_ON_PANEL_H(BUS_ROW_Y(i), 18u)}
+#define UI_RECT_BUS_LINK {PAD + 12u, BUS_LINK_Y + 8u, DISP_W - 2u * PAD - 14u, BUS_ON_PANEL_H(BUS_LINK_Y + 8u, 14u)}
+
+#define UI_WIDGETS(X)                                         \
+    X(DASH_TOP, UI_RECT_DASH_TOP)                             \
+    X(DASH_SPEED_IN, UI_RECT_DASH_SPEED_IN)                   \
+    X(DASH_TRAY_IN, UI_RECT_DASH_TRAY_IN)                     \
+    X(GRAPH_CHIP_CHANNEL, UI_RECT_GRAPH_CHIP_CHANNEL)         \
+    X(GRAPH_CHIP_WINDOW, UI_RECT_GRAPH_CHIP_WINDOW)           \
+    X(GRAPH_CHIP_HZ, UI_RECT_GRAPH_CHIP_HZ)                   \
+    X(GRAPH_DIRTY, UI_RECT_GRAPH_DIRTY)                       \
+    X(DIAG_ROW_0, UI_RECT_DIAG_ROW(0u))                       \
+    X(DIAG_ROW_1, UI_RECT_DIAG_ROW(1u))                       \
+    X(DIAG_ROW_2, UI_RECT_DIAG_ROW(2u))                       \
+    X(DIAG_ROW_3, UI_RECT_DIAG_ROW(3u))                       \
+    X(DIAG_ROW_4, UI_RECT_DIAG_ROW(4u))                       \
+    X(DIAG_ROW_5, UI_RECT_DIAG_ROW(5u))                       \
+    X(DIAG_ROW_6, UI_RECT_DIAG_ROW(6u))                       \
+    X(DIAG_ROW_7, UI_RECT_DIAG_ROW(7u))                       \
+    X(DIAG_ROW_8, UI_RECT_DIAG_ROW(8u))                       \
+    X(DIAG_ROW_9, UI_RECT_DIAG_ROW(9u))                       \
+    X(DIAG_ROW_10, UI_RECT_DIAG_ROW(10u))                     \
+    X(DIAG_ROW_11, UI_RECT_DIAG_ROW(11u))                     \
+    X(DIAG_ROW_12, UI_RECT_DIAG_ROW(12u))                     \
+    X(DIAG_ROW_13, UI_RECT_DIAG_ROW(13u))                     \
+    X(DIAG_ROW_14, UI_RECT_DIAG_ROW(14u))                     \
+    X(DIAG_ROW_15, UI_RECT_DIAG_ROW(15u))                     \
+    X(DIAG_ROW_16, UI_RECT_DIAG_ROW(16u))                     \
+    X(DIAG_ROW_17, UI_RECT_DIAG_ROW(17u))                     \
+    X(DIAG_ROW_18, UI_RECT_DIAG_ROW(18u))                     \
+    X(BUS_COUNT, UI_RECT_BUS_COUNT)                           \
+    X(BUS_LAST, UI_RECT_BUS_LAST)                             \
+    X(BUS_ROW_0, UI_RECT_BUS_ROW(0u))                         \
+    X(BUS_ROW_1, UI_RECT_BUS_ROW(1u))                         \
+    X(BUS_ROW_2, UI_RECT_BUS_ROW(2u))                         \
+    X(BUS_ROW_3, UI_RECT_BUS_ROW(3u))                         \
+    X(BUS_ROW_4, UI_RECT_BUS_ROW(4u))                         \
+    X(BUS_ROW_5, UI_RECT_BUS_ROW(5u))                         \
+    X(BUS_LINK, UI_RECT_BUS_LINK)
+
+#define UI_WIDGET_ID(id, rect) UI_W_##id,
+typedef enum {
+    UI_WIDGETS(UI_WIDGET_ID)
+    UI_W_COUNT
+} ui_widget_id_t;
+#undef UI_WIDGET_ID
+
+#define UI_WIDGET_RECT(id, rect) [UI_W_##id] = rect,
+static const ui_rect_t k_ui_widgets[UI_W_COUNT] = {
+    UI_WIDGETS(UI_WIDGET_RECT)
+};
+#undef UI_WIDGET_RECT
+_Static_assert(UI_W_DIAG_ROW_18 - UI_W_DIAG_ROW_0 + 1u == DIAG_ROW_COUNT, "one widget per diagnostics row");
+_Static_assert(UI_W_BUS_ROW_5 - UI_W_BUS_ROW_0 + 1u == BUS_UI_VIEW_MAX, "one widget per bus row");
 #define UI_WARN_PULSE_STEPS 2u
 #define UI_CHIP_POP_STEPS 2u
 #define UI_ACCENT_SWEEP_STEPS 2u
@@ -122,10 +289,24 @@ static void render_table_row_text_bg(ui_render_ctx_t *ctx, uint16_t y, const cha
 static void render_table_row_hex_bg(ui_render_ctx_t *ctx, uint16_t y, const char *label, uint32_t value,
                                     uint16_t bg, uint16_t text);
 static void diagnostics_rows(const ui_model_t *m, diag_row_t *rows);
-static ui_rect_t diagnostics_row_rect(uint8_t idx);
+
+/* Formatter a ui_fmt_slot_t was filled by. */
+enum {
+    UI_FMT_NONE = 0,
+    UI_FMT_U32,
+    UI_FMT_D10,
+    UI_FMT_HHMM,
+    UI_FMT_AGE,
+    UI_FMT_DIST,
+    UI_FMT_VALUE,
+};
+static const char *fmt_at(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, uint8_t kind,
+                          uint32_t value, uint8_t units, const char *label);
 static uint16_t rgb565_lerp(uint16_t a, uint16_t b, uint8_t t);
 static uint8_t rect_intersects(ui_rect_t a, ui_rect_t b);
 static ui_rect_t rect_union(ui_rect_t a, ui_rect_t b);
+static ui_rect_t clip_top(const ui_render_ctx_t *ctx);
+static uint32_t rect_merge_waste(ui_rect_t a, ui_rect_t b);
 
 static const ui_palette_t k_ui_palettes[UI_THEME_COUNT] = {
     /* UI_THEME_DAY - modern desaturated palette */
@@ -237,16 +418,55 @@ static uint16_t ui_color(const ui_render_ctx_t *ctx, ui_color_id_t id)
     return ctx->palette->colors[id];
 }
 
+static void tints_build(ui_tints_t *t, const ui_palette_t *p)
+{
+    const uint16_t *c = p->colors;
+    uint16_t card = rgb565_lerp(c[UI_COLOR_BG], c[UI_COLOR_PANEL], 32u);
+    t->c[UI_TINT_CARD] = card;
+    t->c[UI_TINT_CARD_DITHER] = rgb565_lerp(card, c[UI_COLOR_BG], UI_PANEL_DITHER_TINT);
+    t->c[UI_TINT_PANEL_DITHER] = rgb565_lerp(c[UI_COLOR_PANEL], c[UI_COLOR_BG], UI_PANEL_DITHER_TINT);
+    t->c[UI_TINT_CHIP_ON] = rgb565_lerp(c[UI_COLOR_PANEL], c[UI_COLOR_ACCENT], 180u);
+    t->c[UI_TINT_GAUGE_ON] = rgb565_lerp(card, c[UI_COLOR_ACCENT], 220u);
+    t->c[UI_TINT_GAUGE_OFF] = rgb565_lerp(card, c[UI_COLOR_MUTED], 64u);
+    t->c[UI_TINT_SEL] = rgb565_lerp(card, c[UI_COLOR_ACCENT], 28u);
+    t->c[UI_TINT_WARN_PULSE] = rgb565_lerp(c[UI_COLOR_WARN], 0xFFFFu, 64u);
+    t->c[UI_TINT_ACCENT_DASH] = rgb565_lerp(c[UI_COLOR_ACCENT], c[UI_COLOR_OK], 180u);
+}
+
+/* Built on a theme's first frame; the palettes are constant after that. */
+static const ui_tints_t *ui_theme_tints(uint8_t theme_id)
+{
+    static ui_tints_t tints[UI_THEME_COUNT];
+    static uint8_t built;
+    uint8_t t = theme_normalize(theme_id);
+    if (!(built & (1u << t)))
+    {
+        tints_build(&tints[t], &k_ui_palettes[t]);
+        built |= (uint8_t)(1u << t);
+    }
+    return &tints[t];
+}
+
+static uint16_t ui_tint(const ui_render_ctx_t *ctx, ui_tint_id_t id)
+{
+    if (!ctx || !ctx->tints || (uint8_t)id >= UI_TINT_COUNT)
+        return 0;
+    return ctx->tints->c[id];
+}
+
 static void hash_u32(ui_render_ctx_t *ctx, uint32_t v)
 {
-    if (!ctx->hash_enabled)
+    if (!ctx->hash_enabled && !ctx->diff)
         return;
     uint8_t buf[4];
     buf[0] = (uint8_t)(v & 0xFFu);
     buf[1] = (uint8_t)((v >> 8) & 0xFFu);
     buf[2] = (uint8_t)((v >> 16) & 0xFFu);
     buf[3] = (uint8_t)((v >> 24) & 0xFFu);
-    ctx->ui->hash = crc32_update(ctx->ui->hash, buf, sizeof(buf));
+    if (ctx->hash_enabled)
+        ctx->ui->hash = crc32_update(ctx->ui->hash, buf, sizeof(buf));
+    if (ctx->diff)
+        ctx->op_sig = crc32_update(ctx->op_sig, buf, sizeof(buf));
 }
 
 static size_t ui_strnlen(const char *s, size_t max_len)
@@ -261,16 +481,240 @@ static size_t ui_strnlen(const char *s, size_t max_len)
 
 static void hash_bytes(ui_render_ctx_t *ctx, const char *s)
 {
-    if (!ctx->hash_enabled || !s)
+    if (!s)
+        return;
+    if (ctx->hash_enabled)
+        ctx->ui->hash = crc32_update(ctx->ui->hash, (const uint8_t *)s, ui_strnlen(s, 96u));
+    if (ctx->diff)
+        ctx->op_sig = crc32_update(ctx->op_sig, (const uint8_t *)s, ui_strnlen(s, 96u));
+}
+
+static ui_preempt_fn g_ui_preempt;
+
+void ui_set_preempt_hook(ui_preempt_fn fn)
+{
+    g_ui_preempt = fn;
+}
+
+static ui_sprite_lookup_fn g_ui_sprite_lookup;
+
+void ui_set_sprite_lookup(ui_sprite_lookup_fn fn)
+{
+    g_ui_sprite_lookup = fn;
+}
+
+static uint32_t chunk_elapsed_us(const ui_render_ctx_t *ctx)
+{
+#ifdef UI_PIXEL_SIM
+    /* Modeled bus time, so host runs split frames deterministically. */
+    (void)ctx;
+    return ui_pixel_sink_chunk_us();
+#else
+    return ui_perf_cycles_to_us(ui_perf_now() - ctx->chunk_t0);
+#endif
+}
+
+/* Every chunk walks the whole page; only its own slice of ops draws. */
+static void chunk_gate(ui_render_ctx_t *ctx)
+{
+    uint16_t i = ctx->op_index++;
+    uint16_t done = ctx->ui->chunk_done;
+    if (i < done || ctx->op_cut)
+    {
+        ctx->draw_enabled = 0u;
+        return;
+    }
+    if (ctx->chunk_budget && i > done && chunk_elapsed_us(ctx) >= UI_RENDER_CHUNK_US)
+    {
+        ctx->op_cut = i;
+        ctx->draw_enabled = 0u;
+        return;
+    }
+    ctx->draw_enabled = 1u;
+}
+
+static uint8_t rect_same(ui_rect_t a, ui_rect_t b)
+{
+    return (uint8_t)(a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h);
+}
+
+/* Settles the op recorded last: changed, its old and new bounds are dirty. */
+static void op_rec_close(ui_render_ctx_t *ctx)
+{
+    if (!ctx->op_recs)
         return;
-    ctx->ui->hash = crc32_update(ctx->ui->hash, (const uint8_t *)s, ui_strnlen(s, 96u));
+    uint16_t i = (uint16_t)(ctx->op_recs - 1u);
+    if (i >= UI_OP_RECS)
+        return;
+    ui_op_rec_t *r = &ctx->ui->op_recs[i];
+    if (!ctx->ui->op_rec_valid || i >= ctx->ui->op_rec_count)
+    {
+        ui_dirty_add(ctx->diff, ctx->op_box);
+    }
+    else if (r->sig != ctx->op_sig || !rect_same(r->box, ctx->op_box))
+    {
+        ui_dirty_add(ctx->diff, r->box);
+        ui_dirty_add(ctx->diff, ctx->op_box);
+    }
+    r->sig = ctx->op_sig;
+    r->box = ctx->op_box;
 }
 
 static void draw_op(ui_render_ctx_t *ctx, uint32_t op_id)
 {
+    if (ctx->diff)
+    {
+        op_rec_close(ctx);
+        ctx->op_recs++;
+        ctx->op_sig = 0xFFFFFFFFu;
+        ctx->op_box = (ui_rect_t){0, 0, 0, 0};
+    }
     hash_u32(ctx, op_id);
     if (ctx->count_ops)
         ctx->ui->draw_ops++;
+    if (ctx->chunked)
+        chunk_gate(ctx);
+    if (ctx->draw_enabled && g_ui_preempt)
+        g_ui_preempt();
+}
+
+/* Every primitive reports the pixels it covers here before drawing; returns
+ * 0 when it must not draw (disabled, or culled by the clip stack). Without
+ * count_ops only the ops that pass the clip are counted. */
+static uint8_t op_drawn(ui_render_ctx_t *ctx, ui_rect_t box)
+{
+    if (ctx->diff)
+        ctx->op_box = box;
+    if (!ctx->draw_enabled)
+        return 0u;
+    if (ctx->clip_depth)
+    {
+        ui_rect_t top = clip_top(ctx);
+        if (top.w == 0u || top.h == 0u || !rect_intersects(box, top))
+        {
+            ui_perf_cull(&ctx->ui->perf);
+            return 0u;
+        }
+    }
+    if (!ctx->count_ops)
+        ctx->ui->draw_ops++;
+    return 1u;
+}
+
+/* [x0, x1) x [y0, y1) cut to the panel. */
+static ui_rect_t rect_span(int x0, int y0, int x1, int y1)
+{
+    if (x0 < 0)
+        x0 = 0;
+    if (y0 < 0)
+        y0 = 0;
+    if (x1 > (int)DISP_W)
+        x1 = (int)DISP_W;
+    if (y1 > (int)DISP_H)
+        y1 = (int)DISP_H;
+    if (x0 >= x1 || y0 >= y1)
+        return (ui_rect_t){0, 0, 0, 0};
+    return (ui_rect_t){(uint16_t)x0, (uint16_t)y0, (uint16_t)(x1 - x0), (uint16_t)(y1 - y0)};
+}
+
+static ui_rect_t rect_box(uint32_t x, uint32_t y, uint32_t w, uint32_t h)
+{
+    return rect_span((int)x, (int)y, (int)(x + w), (int)(y + h));
+}
+
+/* Glyph cells of `text` at baseline y; glyphs may overhang their advance. */
+static ui_rect_t text_bounds(uint16_t x, uint16_t y, const char *text)
+{
+    int x0 = INT32_MAX, y0 = INT32_MAX, x1 = INT32_MIN, y1 = INT32_MIN;
+    int cx = (int)x;
+    for (const char *p = text; p && *p; ++p)
+    {
+        const ui_font_bitmap_glyph_t *g = ui_font_bitmap_glyph(*p);
+        if (g->w && g->h)
+        {
+            int gx = cx + g->xoff;
+            int gy = (int)y + g->yoff;
+            x0 = (gx < x0) ? gx : x0;
+            y0 = (gy < y0) ? gy : y0;
+            x1 = (gx + g->w > x1) ? gx + g->w : x1;
+            y1 = (gy + g->h > y1) ? gy + g->h : y1;
+        }
+        cx += g->xadv;
+    }
+    return rect_span(x0, y0, x1, y1);
+}
+
+static ui_rect_t rect_cover(ui_rect_t a, ui_rect_t b)
+{
+    if (a.w == 0u || a.h == 0u)
+        return b;
+    if (b.w == 0u || b.h == 0u)
+        return a;
+    return rect_union(a, b);
+}
+
+/* The ring rasterizer's box: outer circle plus AA margin, cut to clip. */
+static ui_rect_t ring_bounds(ui_rect_t clip, int16_t cx, int16_t cy, uint16_t outer_r)
+{
+    int x0 = (int)cx - (int)outer_r - 2;
+    int y0 = (int)cy - (int)outer_r - 2;
+    int x1 = (int)cx + (int)outer_r + 2;
+    int y1 = (int)cy + (int)outer_r + 2;
+    if (x0 < (int)clip.x)
+        x0 = (int)clip.x;
+    if (y0 < (int)clip.y)
+        y0 = (int)clip.y;
+    if (x1 > (int)clip.x + (int)clip.w)
+        x1 = (int)clip.x + (int)clip.w;
+    if (y1 > (int)clip.y + (int)clip.h)
+        y1 = (int)clip.y + (int)clip.h;
+    return rect_span(x0, y0, x1, y1);
+}
+
+static void scissor_set(ui_rect_t r)
+{
+#ifdef UI_PIXEL_SIM
+    ui_pixel_sink_set_clip(r.x, r.y, r.w, r.h);
+#elif UI_LCD_HW
+    ui_lcd_set_clip(r.x, r.y, r.w, r.h);
+#else
+    (void)r;
+#endif
+}
+
+static ui_rect_t clip_top(const ui_render_ctx_t *ctx)
+{
+    uint8_t n = (ctx->clip_depth < UI_CLIP_DEPTH) ? ctx->clip_depth : (uint8_t)UI_CLIP_DEPTH;
+    return n ? ctx->clip[n - 1u] : (ui_rect_t){0, 0, DISP_W, DISP_H};
+}
+
+void ui_clip_push(ui_render_ctx_t *ctx, ui_rect_t r)
+{
+    if (!ctx || ctx->clip_depth == 0xFFu)
+        return;
+    ui_rect_t top = clip_top(ctx);
+    /* Pushes past the stack keep the deepest clip, but still pair with pops. */
+    if (ctx->clip_depth++ >= UI_CLIP_DEPTH)
+        return;
+    int x0 = (r.x > top.x) ? r.x : top.x;
+    int y0 = (r.y > top.y) ? r.y : top.y;
+    int x1 = (r.x + r.w < top.x + top.w) ? r.x + r.w : top.x + top.w;
+    int y1 = (r.y + r.h < top.y + top.h) ? r.y + r.h : top.y + top.h;
+    ctx->clip[ctx->clip_depth - 1u] = rect_span(x0, y0, x1, y1);
+    scissor_set(clip_top(ctx));
+}
+
+void ui_clip_pop(ui_render_ctx_t *ctx)
+{
+    if (!ctx || !ctx->clip_depth)
+        return;
+    ctx->clip_depth--;
+    scissor_set(clip_top(ctx));
+}
+
+static void prim_end(ui_render_ctx_t *ctx, ui_perf_prim_t prim, uint32_t t0)
+{
+    ui_perf_prim_add(&ctx->ui->perf, prim, ui_perf_now() - t0);
 }
 
 void ui_draw_round_rect(ui_render_ctx_t *ctx, ui_rect_t r, uint16_t color, uint8_t radius)
@@ -282,13 +726,15 @@ void ui_draw_round_rect(ui_render_ctx_t *ctx, ui_rect_t r, uint16_t color, uint8
     hash_u32(ctx, r.h);
     hash_u32(ctx, color);
     hash_u32(ctx, radius);
-    if (!ctx->draw_enabled)
+    if (!op_drawn(ctx, rect_box(r.x, r.y, r.w, r.h)))
         return;
+    uint32_t t0 = ui_perf_now();
 #ifdef UI_PIXEL_SIM
     ui_pixel_sink_draw_round_rect(r.x, r.y, r.w, r.h, color, radius);
 #elif UI_LCD_HW
     ui_lcd_fill_round_rect(r.x, r.y, r.w, r.h, color, radius);
 #endif
+    prim_end(ctx, UI_PERF_PRIM_FILL, t0);
 }
 
 void ui_draw_rect(ui_render_ctx_t *ctx, ui_rect_t r, uint16_t color)
@@ -299,34 +745,15 @@ void ui_draw_rect(ui_render_ctx_t *ctx, ui_rect_t r, uint16_t color)
     hash_u32(ctx, r.w);
     hash_u32(ctx, r.h);
     hash_u32(ctx, color);
-    if (!ctx->draw_enabled)
+    if (!op_drawn(ctx, rect_box(r.x, r.y, r.w, r.h)))
         return;
+    uint32_t t0 = ui_perf_now();
 #ifdef UI_PIXEL_SIM
     ui_pixel_sink_draw_rect(r.x, r.y, r.w, r.h, color);
 #elif UI_LCD_HW
     ui_lcd_fill_rect(r.x, r.y, r.w, r.h, color);
 #endif
-}
-
-static void ui_draw_round_rect_dither(ui_render_ctx_t *ctx, ui_rect_t r, uint16_t color, uint16_t alt,
-                                      uint8_t radius, uint8_t level)
-{
-    draw_op(ctx, 3u);
-    hash_u32(ctx, r.x);
-    hash_u32(ctx, r.y);
-    hash_u32(ctx, r.w);
-    hash_u32(ctx, r.h);
-    hash_u32(ctx, color);
-    hash_u32(ctx, alt);
-    hash_u32(ctx, radius);
-    hash_u32(ctx, level);
-    if (!ctx->draw_enabled)
-        return;
-#ifdef UI_PIXEL_SIM
-    ui_pixel_sink_draw_round_rect_dither(r.x, r.y, r.w, r.h, color, alt, radius, level);
-#elif UI_LCD_HW
-    ui_lcd_fill_round_rect_dither(r.x, r.y, r.w, r.h, color, alt, radius, level);
-#endif
+    prim_end(ctx, UI_PERF_PRIM_FILL, t0);
 }
 
 void ui_draw_text(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, const char *text, uint16_t fg, uint16_t bg)
@@ -339,13 +766,15 @@ void ui_draw_text(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, const char *text
     hash_u32(ctx, fg);
     hash_u32(ctx, bg);
     hash_bytes(ctx, text);
-    if (!ctx->draw_enabled)
+    if (!op_drawn(ctx, text_bounds(x, y, text)))
         return;
+    uint32_t t0 = ui_perf_now();
 #ifdef UI_PIXEL_SIM
     ui_pixel_sink_draw_text(x, y, text, fg, bg);
 #elif UI_LCD_HW
     ui_lcd_draw_text_stroke(x, y, text, fg, bg);
 #endif
+    prim_end(ctx, UI_PERF_PRIM_TEXT, t0);
 }
 
 void ui_draw_value(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, const char *label, int32_t value, uint16_t fg, uint16_t bg)
@@ -359,13 +788,18 @@ void ui_draw_value(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, const char *lab
     hash_u32(ctx, (uint32_t)value);
     hash_u32(ctx, fg);
     hash_u32(ctx, bg);
-    if (!ctx->draw_enabled)
+    if (!ctx->draw_enabled && !ctx->diff)
+        return;
+    const char *text = fmt_at(ctx, x, y, UI_FMT_VALUE, (uint32_t)value, 0u, label);
+    if (!op_drawn(ctx, text_bounds(x, y, text)))
         return;
+    uint32_t t0 = ui_perf_now();
 #ifdef UI_PIXEL_SIM
-    ui_pixel_sink_draw_value(x, y, label, value, fg, bg);
+    ui_pixel_sink_draw_text(x, y, text, fg, bg);
 #elif UI_LCD_HW
-    ui_lcd_draw_value_stroke(x, y, label, value, fg, bg);
+    ui_lcd_draw_text_stroke(x, y, text, fg, bg);
 #endif
+    prim_end(ctx, UI_PERF_PRIM_TEXT, t0);
 }
 
 void ui_draw_big_digit(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, uint8_t digit, uint8_t scale, uint16_t color)
@@ -390,13 +824,121 @@ void ui_draw_big_digit(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, uint8_t dig
     if (digit < 10)
         hash_u32(ctx, segs[digit]);
     hash_u32(ctx, color);
-    if (!ctx->draw_enabled)
+    if (!op_drawn(ctx, rect_box(x, y, UI_BIG_DIGIT_WIDTH(scale), UI_BIG_DIGIT_HEIGHT(scale))))
         return;
+    uint32_t t0 = ui_perf_now();
 #ifdef UI_PIXEL_SIM
     ui_pixel_sink_draw_big_digit(x, y, digit, scale, color);
 #elif UI_LCD_HW
     ui_lcd_draw_big_digit_7seg(x, y, digit, scale, color);
 #endif
+    prim_end(ctx, UI_PERF_PRIM_TEXT, t0);
+}
+
+/* Big-digit glyphs in the asset pack: 'D' 'G' scale digit (scripts/pack_ui_icons.py). */
+#define DIGIT_ASSET_ID(scale, digit) (0x44470000u | ((uint32_t)(scale) << 8) | (uint32_t)(digit))
+#define BIG_DIGIT_SHADOW 2u
+
+static uint8_t big_digit_sprite(uint8_t digit, uint8_t scale, ui_sprite_t *sp)
+{
+    if (!g_ui_sprite_lookup || digit > 9u || !g_ui_sprite_lookup(DIGIT_ASSET_ID(scale, digit), sp))
+        return 0u;
+    if (sp->fmt != UI_SPRITE_FMT_A4_RLE || sp->w != UI_BIG_DIGIT_WIDTH(scale) || sp->h != UI_BIG_DIGIT_HEIGHT(scale))
+        return 0u;
+    return 1u;
+}
+
+/* A digit and its drop shadow as one anti-aliased glyph from the glyph
+ * cache. Returns 0, drawing nothing, when the pack has no usable glyph. */
+static uint8_t ui_draw_big_digit_glyph(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, uint8_t digit, uint8_t scale,
+                                       uint16_t color, uint16_t shadow, uint16_t bg)
+{
+    ui_sprite_t sp;
+    if (!big_digit_sprite(digit, scale, &sp))
+        return 0u;
+    if ((uint32_t)x + sp.w + BIG_DIGIT_SHADOW > DISP_W || (uint32_t)y + sp.h + BIG_DIGIT_SHADOW > DISP_H)
+        return 0u;
+    const uint8_t *rle = ui_glyph_cache_get(&sp);
+    if (!rle)
+        return 0u;
+
+    draw_op(ctx, 14u);
+    hash_u32(ctx, DIGIT_ASSET_ID(scale, digit));
+    hash_u32(ctx, sp.tag);
+    hash_u32(ctx, x);
+    hash_u32(ctx, y);
+    hash_u32(ctx, color);
+    hash_u32(ctx, shadow);
+    hash_u32(ctx, bg);
+    if (!op_drawn(ctx, rect_box(x, y, sp.w + BIG_DIGIT_SHADOW, sp.h + BIG_DIGIT_SHADOW)))
+        return 1u;
+    ui_draw_glyph_t g = {rle, sp.len, sp.w, sp.h, color, shadow, bg, (uint8_t)BIG_DIGIT_SHADOW};
+    uint32_t t0 = ui_perf_now();
+#ifdef UI_PIXEL_SIM
+    ui_pixel_sink_draw_glyph(x, y, &g);
+#elif UI_LCD_HW
+    ui_lcd_draw_glyph(x, y, &g);
+#endif
+    prim_end(ctx, UI_PERF_PRIM_TEXT, t0);
+    return 1u;
+}
+
+/* Digit i (0 = leftmost) of an n digit number; the leftmost is not reduced
+ * mod 10, as the callers have always drawn it. */
+static uint8_t big_number_digit(uint16_t value, uint8_t n, uint8_t i)
+{
+    uint16_t div = 1u;
+    for (uint8_t k = (uint8_t)(i + 1u); k < n; ++k)
+        div = (uint16_t)(div * 10u);
+    uint16_t d = (uint16_t)(value / div);
+    return (uint8_t)((i == 0u) ? d : d % 10u);
+}
+
+/*
+ * n (at most 3) big digits of `value`, `pitch` apart, with the 2px drop
+ * shadow. When the asset pack has glyphs for all of them each digit is one
+ * shadowed glyph; otherwise the 7-segment shadows go first, then the faces.
+ * Bit i of `mask` selects digit i, so a caller can redraw only the digits
+ * that changed.
+ */
+static void ui_draw_big_number(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, uint16_t value, uint8_t n,
+                               uint8_t scale, uint16_t pitch, uint16_t color, uint16_t bg, uint8_t mask)
+{
+    uint16_t shadow = rgb565_dim(color);
+    uint8_t glyphs = 1u;
+    for (uint8_t i = 0; i < n && glyphs; ++i)
+    {
+        ui_sprite_t sp;
+        glyphs = big_digit_sprite(big_number_digit(value, n, i), scale, &sp);
+    }
+    if (glyphs)
+    {
+        for (uint8_t i = 0; i < n; ++i)
+        {
+            if (!(mask & (1u << i)))
+                continue;
+            uint16_t dx = (uint16_t)(x + i * pitch);
+            uint8_t d = big_number_digit(value, n, i);
+            if (ui_draw_big_digit_glyph(ctx, dx, y, d, scale, color, shadow, bg))
+                continue;
+            /* Glyph unreadable: this digit alone falls back. */
+            ui_draw_big_digit(ctx, (uint16_t)(dx + BIG_DIGIT_SHADOW), (uint16_t)(y + BIG_DIGIT_SHADOW), d, scale,
+                              shadow);
+            ui_draw_big_digit(ctx, dx, y, d, scale, color);
+        }
+        return;
+    }
+    for (uint8_t i = 0; i < n; ++i)
+    {
+        if (mask & (1u << i))
+            ui_draw_big_digit(ctx, (uint16_t)(x + i * pitch + BIG_DIGIT_SHADOW), (uint16_t)(y + BIG_DIGIT_SHADOW),
+                              big_number_digit(value, n, i), scale, shadow);
+    }
+    for (uint8_t i = 0; i < n; ++i)
+    {
+        if (mask & (1u << i))
+            ui_draw_big_digit(ctx, (uint16_t)(x + i * pitch), y, big_number_digit(value, n, i), scale, color);
+    }
 }
 
 void ui_draw_battery_icon(ui_render_ctx_t *ctx, ui_rect_t r, uint8_t soc, uint16_t color, uint16_t bg)
@@ -409,13 +951,15 @@ void ui_draw_battery_icon(ui_render_ctx_t *ctx, ui_rect_t r, uint8_t soc, uint16
     hash_u32(ctx, soc);
     hash_u32(ctx, color);
     hash_u32(ctx, bg);
-    if (!ctx->draw_enabled)
+    if (!op_drawn(ctx, rect_box(r.x, r.y, r.w, r.h)))
         return;
+    uint32_t t0 = ui_perf_now();
 #ifdef UI_PIXEL_SIM
     ui_pixel_sink_draw_battery_icon(r.x, r.y, r.w, r.h, soc, color, bg);
 #elif UI_LCD_HW
     ui_lcd_draw_battery_icon(r.x, r.y, r.w, r.h, soc, color, bg);
 #endif
+    prim_end(ctx, UI_PERF_PRIM_BLIT, t0);
 }
 
 void ui_draw_warning_icon(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, uint16_t color)
@@ -424,13 +968,15 @@ void ui_draw_warning_icon(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, uint16_t
     hash_u32(ctx, x);
     hash_u32(ctx, y);
     hash_u32(ctx, color);
-    if (!ctx->draw_enabled)
+    if (!op_drawn(ctx, rect_box(x, y, 12u, 12u)))
         return;
+    uint32_t t0 = ui_perf_now();
 #ifdef UI_PIXEL_SIM
     ui_pixel_sink_draw_warning_icon(x, y, color);
 #elif UI_LCD_HW
     ui_lcd_draw_warning_icon(x, y, color);
 #endif
+    prim_end(ctx, UI_PERF_PRIM_BLIT, t0);
 }
 
 void ui_draw_ring_arc(ui_render_ctx_t *ctx, ui_rect_t clip,
@@ -451,8 +997,9 @@ void ui_draw_ring_arc(ui_render_ctx_t *ctx, ui_rect_t clip,
     hash_u32(ctx, sweep_deg_cw);
     hash_u32(ctx, fg);
     hash_u32(ctx, bg);
-    if (!ctx->draw_enabled)
+    if (!op_drawn(ctx, ring_bounds(clip, cx, cy, outer_r)))
         return;
+    uint32_t t0 = ui_perf_now();
 #ifdef UI_PIXEL_SIM
     ui_pixel_sink_draw_ring_arc_a4(clip.x, clip.y, clip.w, clip.h,
                                    cx, cy, outer_r, thickness,
@@ -464,6 +1011,7 @@ void ui_draw_ring_arc(ui_render_ctx_t *ctx, ui_rect_t clip,
                             start_deg_cw, sweep_deg_cw,
                             fg, bg);
 #endif
+    prim_end(ctx, UI_PERF_PRIM_ARC, t0);
 }
 
 void ui_draw_ring_gauge(ui_render_ctx_t *ctx, ui_rect_t clip,
@@ -486,8 +1034,9 @@ void ui_draw_ring_gauge(ui_render_ctx_t *ctx, ui_rect_t clip,
     hash_u32(ctx, fg_active);
     hash_u32(ctx, fg_inactive);
     hash_u32(ctx, bg);
-    if (!ctx->draw_enabled)
+    if (!op_drawn(ctx, ring_bounds(clip, cx, cy, outer_r)))
         return;
+    uint32_t t0 = ui_perf_now();
 #ifdef UI_PIXEL_SIM
     ui_pixel_sink_draw_ring_gauge_a4(clip.x, clip.y, clip.w, clip.h,
                                      cx, cy, outer_r, thickness,
@@ -499,6 +1048,7 @@ void ui_draw_ring_gauge(ui_render_ctx_t *ctx, ui_rect_t clip,
                               start_deg_cw, sweep_deg_cw, active_sweep_deg_cw,
                               fg_active, fg_inactive, bg);
 #endif
+    prim_end(ctx, UI_PERF_PRIM_ARC, t0);
 }
 
 #if defined(UI_PIXEL_SIM) || UI_LCD_HW
@@ -537,11 +1087,69 @@ static void icon_ring(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, uint16_t w,
                            bg, (uint8_t)(radius > thick ? radius - thick : 1u));
 }
 
+/* Asset IDs of the pack sprites (scripts/pack_ui_icons.py). */
+static const uint32_t k_icon_asset_id[] = {
+    [UI_ICON_BLE] = 0x424C4501u,
+    [UI_ICON_LOCK] = 0x4C4F4301u,
+    [UI_ICON_THERMO] = 0x54485201u,
+    [UI_ICON_GRAPH] = 0x47524101u,
+    [UI_ICON_TRIP] = 0x54524901u,
+    [UI_ICON_SETTINGS] = 0x53455401u,
+    [UI_ICON_CRUISE] = 0x43525501u,
+    [UI_ICON_BATTERY] = 0x42415401u,
+    [UI_ICON_ALERT] = 0x414C5201u,
+    [UI_ICON_BUS] = 0x42555301u,
+    [UI_ICON_CAPTURE] = 0x43415001u,
+    [UI_ICON_TUNE] = 0x54554E01u,
+    [UI_ICON_INFO] = 0x494E4601u,
+    [UI_ICON_PROFILE] = 0x50524F01u,
+};
+
+/* One DMA (RGB565) or one decode pass (A4) for an icon found in the asset
+ * pack. Returns 0, drawing nothing, when the icon has to use primitives. */
+static uint8_t ui_draw_sprite(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, ui_icon_id_t icon,
+                              uint16_t fg, uint16_t bg)
+{
+    if (!g_ui_sprite_lookup || icon == UI_ICON_NONE ||
+        (size_t)icon >= sizeof(k_icon_asset_id) / sizeof(k_icon_asset_id[0]))
+        return 0u;
+    ui_sprite_t sp;
+    if (!g_ui_sprite_lookup(k_icon_asset_id[icon], &sp))
+        return 0u;
+    /* The icon box is what the dirty rects cover; RGB565 rows cannot be clipped. */
+    if (sp.w > ICON_SIZE || sp.h > ICON_SIZE || (uint32_t)x + sp.w > DISP_W || (uint32_t)y + sp.h > DISP_H)
+        return 0u;
+    if (sp.fmt != UI_SPRITE_FMT_RGB565 && sp.fmt != UI_SPRITE_FMT_A4_RLE)
+        return 0u;
+    if (sp.fmt == UI_SPRITE_FMT_A4_RLE && sp.len > UI_SPRITE_A4_MAX_BYTES)
+        return 0u;
+
+    draw_op(ctx, 13u);
+    hash_u32(ctx, k_icon_asset_id[icon]);
+    hash_u32(ctx, sp.tag);
+    hash_u32(ctx, x);
+    hash_u32(ctx, y);
+    hash_u32(ctx, fg);
+    hash_u32(ctx, bg);
+    if (!op_drawn(ctx, rect_box(x, y, sp.w, sp.h)))
+        return 1u;
+    uint32_t t0 = ui_perf_now();
+#ifdef UI_PIXEL_SIM
+    ui_pixel_sink_draw_sprite(x, y, &sp, fg, bg);
+#elif UI_LCD_HW
+    ui_lcd_draw_sprite(x, y, &sp, fg, bg);
+#endif
+    prim_end(ctx, UI_PERF_PRIM_BLIT, t0);
+    return 1u;
+}
+
 static void ui_draw_icon(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, ui_icon_id_t icon,
                          uint16_t fg, uint16_t bg)
 {
     const uint16_t s = ICON_SIZE;
     const uint16_t t = 2u;
+    if (ui_draw_sprite(ctx, x, y, icon, fg, bg))
+        return;
     switch (icon)
     {
     case UI_ICON_BLE:
@@ -621,24 +1229,85 @@ static void ui_draw_icon(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, ui_icon_i
 
 void ui_dirty_add(ui_dirty_t *d, ui_rect_t r)
 {
-    if (d->full)
+    if (d->full || r.w == 0u || r.h == 0u)
+        return;
+
+    /* Absorb r into the cheapest neighbour while that costs less than keeping
+     * a separate rect; the grown rect may then coalesce with others. */
+    for (;;)
+    {
+        uint8_t best = MAX_DIRTY;
+        uint32_t best_waste = DIRTY_RECT_COST_PX + 1u;
+        for (uint8_t i = 0; i < d->count; ++i)
+        {
+            uint32_t waste = rect_merge_waste(d->rects[i], r);
+            if (waste < best_waste)
+            {
+                best_waste = waste;
+                best = i;
+            }
+        }
+        if (best == MAX_DIRTY)
+            break;
+        r = rect_union(d->rects[best], r);
+        d->rects[best] = d->rects[--d->count];
+    }
+
+    if (d->count < MAX_DIRTY)
+    {
+        d->rects[d->count++] = r;
         return;
+    }
+
+    /* Table full: force the cheapest merge among the existing rects and r. */
+    uint8_t bi = 0u;
+    uint8_t bj = MAX_DIRTY;
+    uint32_t best_waste = UINT32_MAX;
     for (uint8_t i = 0; i < d->count; ++i)
     {
-        if (rect_intersects(d->rects[i], r))
+        for (uint8_t j = (uint8_t)(i + 1u); j <= d->count; ++j)
         {
-            d->rects[i] = rect_union(d->rects[i], r);
-            return;
+            ui_rect_t b = (j == d->count) ? r : d->rects[j];
+            uint32_t waste = rect_merge_waste(d->rects[i], b);
+            if (waste < best_waste)
+            {
+                best_waste = waste;
+                bi = i;
+                bj = j;
+            }
         }
     }
-    if (d->count >= MAX_DIRTY)
+    if (bj == d->count)
     {
-        d->full = 1u;
-        d->count = 1u;
-        d->rects[0] = (ui_rect_t){0, 0, DISP_W, DISP_H};
+        d->rects[bi] = rect_union(d->rects[bi], r);
         return;
     }
-    d->rects[d->count++] = r;
+    d->rects[bi] = rect_union(d->rects[bi], d->rects[bj]);
+    d->rects[bj] = r;
+}
+
+#ifdef HOST_TEST
+ui_dirty_t *ui_dirty_host_reset(void)
+{
+    static ui_dirty_t d;
+    memset(&d, 0, sizeof(d));
+    return &d;
+}
+
+uint8_t ui_dirty_count(const ui_dirty_t *d)
+{
+    return d->count;
+}
+
+ui_rect_t ui_dirty_rect(const ui_dirty_t *d, uint8_t index)
+{
+    return (index < d->count) ? d->rects[index] : (ui_rect_t){0, 0, 0, 0};
+}
+#endif
+
+static void dirty_add_widget(ui_dirty_t *d, ui_widget_id_t id)
+{
+    ui_dirty_add(d, k_ui_widgets[id]);
 }
 
 void ui_dirty_full(ui_dirty_t *d)
@@ -668,6 +1337,27 @@ static ui_rect_t rect_union(ui_rect_t a, ui_rect_t b)
     return (ui_rect_t){x0, y0, (uint16_t)(x1 - x0), (uint16_t)(y1 - y0)};
 }
 
+static uint32_t rect_area(ui_rect_t r)
+{
+    return (uint32_t)r.w * (uint32_t)r.h;
+}
+
+/* Pixels the union of a and b redraws that neither a nor b covers. */
+static uint32_t rect_merge_waste(ui_rect_t a, ui_rect_t b)
+{
+    uint32_t covered = rect_area(a) + rect_area(b);
+    if (rect_intersects(a, b))
+    {
+        uint16_t x0 = (a.x > b.x) ? a.x : b.x;
+        uint16_t y0 = (a.y > b.y) ? a.y : b.y;
+        uint16_t x1 = (uint16_t)((a.x + a.w < b.x + b.w) ? (a.x + a.w) : (b.x + b.w));
+        uint16_t y1 = (uint16_t)((a.y + a.h < b.y + b.h) ? (a.y + a.h) : (b.y + b.h));
+        covered -= (uint32_t)(x1 - x0) * (uint32_t)(y1 - y0);
+    }
+    uint32_t area = rect_area(rect_union(a, b));
+    return (area > covered) ? (area - covered) : 0u;
+}
+
 static uint8_t warn_active(const ui_model_t *m)
 {
     if (!m)
@@ -675,6 +1365,33 @@ static uint8_t warn_active(const ui_model_t *m)
     return (m->err || m->limit_reason != LIMIT_REASON_USER) ? 1u : 0u;
 }
 
+#if UI_LCD_HW && !defined(UI_PIXEL_SIM)
+static uint16_t dirty_band_y0(const ui_dirty_t *d)
+{
+    if (d->full || d->count == 0u)
+        return 0u;
+    uint16_t y0 = d->rects[0].y;
+    for (uint8_t i = 1; i < d->count; ++i)
+        if (d->rects[i].y < y0)
+            y0 = d->rects[i].y;
+    return y0;
+}
+
+static uint16_t dirty_band_y1(const ui_dirty_t *d)
+{
+    if (d->full || d->count == 0u)
+        return (uint16_t)(DISP_H - 1u);
+    uint16_t y1 = 0u;
+    for (uint8_t i = 0; i < d->count; ++i)
+    {
+        uint16_t bottom = (uint16_t)(d->rects[i].y + d->rects[i].h - 1u);
+        if (bottom > y1)
+            y1 = bottom;
+    }
+    return y1;
+}
+#endif
+
 static uint8_t rect_dirty(const ui_dirty_t *d, ui_rect_t r)
 {
     if (d->full)
@@ -708,50 +1425,15 @@ static uint16_t trip_wh_per_unit_d10(const ui_model_t *m)
     return (val > 0xFFFFu) ? 0xFFFFu : (uint16_t)val;
 }
 
-static void ui_graph_sample(ui_state_t *ui, const ui_model_t *m)
+static uint16_t seg_digit_w(uint8_t scale)
+{
+    /* Must match the pixel sink's 7-seg renderer (host + eventual target). */
+    return (uint16_t)(12u * (uint16_t)scale);
+}
+
+static void fmt_u32(char *out, size_t len, uint32_t v)
 {
-    if (!ui || !m)
-        return;
-    if (ui->graph_channel != m->graph_channel)
-    {
-        ui->graph_channel = m->graph_channel;
-        ui->graph_head = 0u;
-        ui->graph_count = 0u;
-    }
-    uint16_t sample = 0u;
-    switch (m->graph_channel)
-    {
-    case UI_GRAPH_CH_POWER:
-        sample = m->power_w;
-        break;
-    case UI_GRAPH_CH_VOLT:
-        sample = (uint16_t)((m->batt_dV > 0) ? m->batt_dV : 0);
-        break;
-    case UI_GRAPH_CH_CAD:
-        sample = m->cadence_rpm;
-        break;
-    case UI_GRAPH_CH_SPEED:
-    default:
-        sample = (uint16_t)(m->speed_dmph / 10u);
-        break;
-    }
-    if (UI_GRAPH_SAMPLES == 0u)
-        return;
-    ui->graph_samples[ui->graph_head] = sample;
-    ui->graph_head = (uint8_t)((ui->graph_head + 1u) % UI_GRAPH_SAMPLES);
-    if (ui->graph_count < UI_GRAPH_SAMPLES)
-        ui->graph_count++;
-}
-
-static uint16_t seg_digit_w(uint8_t scale)
-{
-    /* Must match the pixel sink's 7-seg renderer (host + eventual target). */
-    return (uint16_t)(12u * (uint16_t)scale);
-}
-
-static void fmt_u32(char *out, size_t len, uint32_t v)
-{
-    if (!out || len == 0)
+    if (!out || len == 0)
         return;
     char *ptr = out;
     size_t rem = len - 1u;
@@ -768,20 +1450,10 @@ static void fmt_u32_pad4(char *out, size_t len, uint32_t v)
         out[0] = 0;
         return;
     }
-    v %= 10000u;
-    char tmp[12];
-    char *ptr = tmp;
-    size_t rem = sizeof(tmp) - 1u;
-    append_u32(&ptr, &rem, v);
+    char *ptr = out;
+    size_t rem = len - 1u;
+    append_u32_pad(&ptr, &rem, v % 10000u, 4u);
     *ptr = 0;
-    size_t digits = (size_t)(ptr - tmp);
-    size_t pad = (digits < 4u) ? (4u - digits) : 0u;
-    size_t i = 0;
-    for (; i < pad && i + 1 < len; ++i)
-        out[i] = '0';
-    for (size_t j = 0; tmp[j] && i + 1 < len; ++j)
-        out[i++] = tmp[j];
-    out[i] = 0;
 }
 
 static void fmt_u32_hex8(char *out, size_t len, uint32_t v)
@@ -790,14 +1462,8 @@ static void fmt_u32_hex8(char *out, size_t len, uint32_t v)
         return;
     char *ptr = out;
     size_t rem = len - 1u;
-    append_hex_u32(&ptr, &rem, v);
+    append_hex_u32_upper(&ptr, &rem, v);
     *ptr = 0;
-    for (size_t i = 0; out[i]; ++i)
-    {
-        char c = out[i];
-        if (c >= 'a' && c <= 'f')
-            out[i] = (char)(c - ('a' - 'A'));
-    }
 }
 
 static void fmt_u32_hex2(char *out, size_t len, uint32_t v)
@@ -809,11 +1475,10 @@ static void fmt_u32_hex2(char *out, size_t len, uint32_t v)
         out[0] = 0;
         return;
     }
-    uint8_t b = (uint8_t)(v & 0xFFu);
-    static const char hex[] = "0123456789ABCDEF";
-    out[0] = hex[(b >> 4) & 0x0Fu];
-    out[1] = hex[b & 0x0Fu];
-    out[2] = 0;
+    char *ptr = out;
+    size_t rem = 2u;
+    append_hex_u8_upper(&ptr, &rem, (uint8_t)v);
+    *ptr = 0;
 }
 
 static void fmt_d10(char *out, size_t len, int32_t v_d10)
@@ -916,6 +1581,46 @@ static void fmt_time_hhmm(char *out, size_t len, uint32_t ms)
     out[i < len ? i : (len - 1u)] = 0;
 }
 
+/*
+ * Numeric widgets format through a small per-widget cache (ui_state_t.fmt):
+ * the widget at x/y keeps its text and the (kind, value, units, label) that
+ * produced it, so an unchanged reading skips the divide/modulo chains on
+ * both the hash and the draw pass. Slots are direct-mapped by position; a
+ * collision only costs a reformat. The text is valid until the next call.
+ */
+static const char *fmt_at(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, uint8_t kind,
+                          uint32_t value, uint8_t units, const char *label)
+{
+    static char scratch[UI_FMT_TEXT];
+    char *out = scratch;
+    if (ctx && ctx->ui)
+    {
+        uint32_t h = ((uint32_t)x * 31u + y) * 2654435761u;
+        ui_fmt_slot_t *s = &ctx->ui->fmt[h >> (32u - UI_FMT_SLOT_BITS)];
+        if (s->kind == kind && s->x == x && s->y == y && s->value == value &&
+            s->units == units && s->label == label)
+            return s->text;
+        s->kind = kind;
+        s->x = x;
+        s->y = y;
+        s->value = value;
+        s->units = units;
+        s->label = label;
+        out = s->text;
+    }
+    switch (kind)
+    {
+        case UI_FMT_U32: fmt_u32(out, UI_FMT_TEXT, value); break;
+        case UI_FMT_D10: fmt_d10(out, UI_FMT_TEXT, (int32_t)value); break;
+        case UI_FMT_HHMM: fmt_time_hhmm(out, UI_FMT_TEXT, value); break;
+        case UI_FMT_AGE: fmt_seconds_label(out, UI_FMT_TEXT, value); break;
+        case UI_FMT_DIST: fmt_distance_label(out, UI_FMT_TEXT, (uint16_t)value, units); break;
+        case UI_FMT_VALUE: ui_draw_format_value(out, UI_FMT_TEXT, label, (long)(int32_t)value); break;
+        default: out[0] = 0; break;
+    }
+    return out;
+}
+
 static const char *alert_type_label(uint8_t type)
 {
     switch (type)
@@ -930,6 +1635,7 @@ static const char *alert_type_label(uint8_t type)
         case 8u: return "PIN";
         case 9u: return "RESET";
         case 10u: return "BUS";
+        case 12u: return "SAG";
         default: return "EVENT";
     }
 }
@@ -947,6 +1653,7 @@ static ui_icon_id_t alert_type_icon(uint8_t type)
         case 8u: return UI_ICON_LOCK;
         case 9u: return UI_ICON_INFO;
         case 10u: return UI_ICON_BUS;
+        case 12u: return UI_ICON_BATTERY;
         default: return UI_ICON_ALERT;
     }
 }
@@ -993,6 +1700,22 @@ static void ui_draw_drop_shadow(ui_render_ctx_t *ctx, ui_rect_t r, uint8_t radiu
     ui_draw_round_rect(ctx, (ui_rect_t){(uint16_t)sx, (uint16_t)sy, r.w, r.h}, color, radius);
 }
 
+static void hash_rrect(ui_render_ctx_t *ctx, const ui_draw_rrect_t *r)
+{
+    hash_u32(ctx, r->x);
+    hash_u32(ctx, r->y);
+    hash_u32(ctx, r->w);
+    hash_u32(ctx, r->h);
+    hash_u32(ctx, r->radius);
+}
+
+static ui_draw_rrect_t rrect_of(ui_rect_t r, uint8_t radius)
+{
+    return (ui_draw_rrect_t){r.x, r.y, r.w, r.h, radius};
+}
+
+/* Shadow, border and fill go out as one composite primitive that writes
+ * every covered pixel once (ui_draw_fill_panel). */
 void ui_draw_panel(ui_render_ctx_t *ctx, ui_rect_t r, const ui_panel_style_t *style)
 {
     if (!style)
@@ -1003,39 +1726,62 @@ void ui_draw_panel(ui_render_ctx_t *ctx, ui_rect_t r, const ui_panel_style_t *st
 
     uint8_t rad = style->radius;
     uint8_t bt = style->border_thick;
-    uint8_t dither = panel_dither_enabled(ctx, style, r);
-    uint16_t dither_alt = style->fill;
-    if (dither)
-        dither_alt = rgb565_lerp(style->fill, ui_color(ctx, UI_COLOR_BG), UI_PANEL_DITHER_TINT);
+    ui_draw_panel_t p = {0};
+    p.fill_color = style->fill;
+    p.fill_alt = style->fill;
+    if (panel_dither_enabled(ctx, style, r))
+    {
+        if (style->fill == ui_tint(ctx, UI_TINT_CARD))
+            p.fill_alt = ui_tint(ctx, UI_TINT_CARD_DITHER);
+        else if (style->fill == ui_color(ctx, UI_COLOR_PANEL))
+            p.fill_alt = ui_tint(ctx, UI_TINT_PANEL_DITHER);
+        else
+            p.fill_alt = rgb565_lerp(style->fill, ui_color(ctx, UI_COLOR_BG), UI_PANEL_DITHER_TINT);
+        p.dither_level = UI_PANEL_DITHER_LEVEL;
+    }
 
     if (style->shadow && (style->shadow_dx || style->shadow_dy))
     {
-        ui_draw_drop_shadow(ctx, r, rad, style->shadow_dx, style->shadow_dy, style->shadow);
+        int sx = (int)r.x + (int)style->shadow_dx;
+        int sy = (int)r.y + (int)style->shadow_dy;
+        p.shadow = (ui_draw_rrect_t){(uint16_t)(sx < 0 ? 0 : sx), (uint16_t)(sy < 0 ? 0 : sy), r.w, r.h, rad};
+        p.shadow_color = style->shadow;
     }
 
     if (bt == 0u)
     {
-        if (dither)
-            ui_draw_round_rect_dither(ctx, r, style->fill, dither_alt, rad, UI_PANEL_DITHER_LEVEL);
-        else
-            ui_draw_round_rect(ctx, r, style->fill, rad);
-        return;
+        p.fill = rrect_of(r, rad);
     }
-
-    ui_draw_round_rect(ctx, r, style->border, rad);
-    ui_rect_t inner = inset_rect(r, bt);
-    if (inner.w >= 2u && inner.h >= 2u)
+    else
     {
-        uint8_t inner_rad = rad;
-        if (inner_rad > bt)
-            inner_rad = (uint8_t)(inner_rad - bt);
-        else
-            inner_rad = 1u;
-        if (dither)
-            ui_draw_round_rect_dither(ctx, inner, style->fill, dither_alt, inner_rad, UI_PANEL_DITHER_LEVEL);
-        else
-            ui_draw_round_rect(ctx, inner, style->fill, inner_rad);
+        p.body = rrect_of(r, rad);
+        p.border = style->border;
+        ui_rect_t inner = inset_rect(r, bt);
+        if (inner.w >= 2u && inner.h >= 2u)
+            p.fill = rrect_of(inner, (rad > bt) ? (uint8_t)(rad - bt) : 1u);
     }
+
+    draw_op(ctx, 12u);
+    hash_rrect(ctx, &p.shadow);
+    hash_rrect(ctx, &p.body);
+    hash_rrect(ctx, &p.fill);
+    hash_u32(ctx, p.shadow_color);
+    hash_u32(ctx, p.border);
+    hash_u32(ctx, p.fill_color);
+    hash_u32(ctx, p.fill_alt);
+    hash_u32(ctx, p.dither_level);
+    ui_rect_t box = rect_cover(rect_box(p.shadow.x, p.shadow.y, p.shadow.w, p.shadow.h),
+                               rect_cover(rect_box(p.body.x, p.body.y, p.body.w, p.body.h),
+                                          rect_box(p.fill.x, p.fill.y, p.fill.w, p.fill.h)));
+    if (!op_drawn(ctx, box))
+        return;
+    uint32_t t0 = ui_perf_now();
+#ifdef UI_PIXEL_SIM
+    ui_pixel_sink_draw_panel(&p);
+#elif UI_LCD_HW
+    ui_lcd_fill_panel(&p);
+#endif
+    prim_end(ctx, UI_PERF_PRIM_FILL, t0);
 }
 
 static void draw_outline_panel(ui_render_ctx_t *ctx, ui_rect_t r, uint16_t border, uint16_t fill, uint8_t radius)
@@ -1083,30 +1829,19 @@ typedef struct {
     ui_rect_t tray_in;
 } ui_dash_v2_layout_t;
 
-static ui_dash_v2_layout_t dash_v2_layout(void)
-{
-    ui_dash_v2_layout_t l = {0};
-    l.U = 4u;
-    l.M = 12u;
-    l.GAP = 10u;
-    l.ST = 2u;
-    l.R = 16u;
-    l.full = (ui_rect_t){0, 0, DISP_W, DISP_H};
-
-    const uint16_t top_y = l.M;
-    const uint16_t top_h = 20u;
-    const uint16_t speed_y = (uint16_t)(top_y + top_h + l.GAP);
-    const uint16_t stats_h = 44u; /* Compact 4-column single-row tray */
-    const uint16_t content_w = (uint16_t)(DISP_W - 2u * l.M);
-    const uint16_t speed_h = (uint16_t)(DISP_H - l.M - stats_h - l.GAP - speed_y);
-
-    l.top_area = (ui_rect_t){0, 0, DISP_W, speed_y};
-    l.speed = (ui_rect_t){l.M, speed_y, content_w, speed_h};
-    l.speed_in = inset_rect(l.speed, l.ST);
-    l.tray = (ui_rect_t){l.M, (uint16_t)(l.speed.y + l.speed.h + l.GAP), content_w, stats_h};
-    l.tray_in = inset_rect(l.tray, l.ST);
-    return l;
-}
+static const ui_dash_v2_layout_t k_dash_v2_layout = {
+    .U = 4u,
+    .M = DASH_M,
+    .GAP = DASH_GAP,
+    .ST = DASH_ST,
+    .R = 16u,
+    .full = UI_RECT_FULL,
+    .top_area = UI_RECT_DASH_TOP,
+    .speed = UI_RECT_DASH_SPEED,
+    .speed_in = UI_RECT_DASH_SPEED_IN,
+    .tray = UI_RECT_DASH_TRAY,
+    .tray_in = UI_RECT_DASH_TRAY_IN,
+};
 
 static void dash_v2_render_top(ui_render_ctx_t *ctx, const ui_model_t *m,
                                const ui_dash_v2_layout_t *l,
@@ -1120,7 +1855,6 @@ static void dash_v2_render_top(ui_render_ctx_t *ctx, const ui_model_t *m,
                                uint16_t danger,
                                uint16_t ok)
 {
-    char buf[20];
     uint16_t warn_pulse = warn;
     if (ctx && ctx->ui && ctx->ui->warn_pulse_phase)
         warn_pulse = rgb565_lerp(warn, 0xFFFFu, 64u);
@@ -1137,8 +1871,10 @@ static void dash_v2_render_top(ui_render_ctx_t *ctx, const ui_model_t *m,
         assist_border = accent;
     draw_outline_panel(ctx, chip, assist_border, card_fill, 10u);
     ui_draw_text(ctx, (uint16_t)(chip.x + 8u), (uint16_t)(chip.y + 2u), "AST", muted, card_fill);
-    fmt_u32(buf, sizeof(buf), (uint32_t)m->assist_mode);
-    ui_draw_text(ctx, (uint16_t)(chip.x + 34u), (uint16_t)(chip.y + 2u), buf, text, card_fill);
+    ui_draw_text(ctx, (uint16_t)(chip.x + 34u), (uint16_t)(chip.y + 2u),
+                 fmt_at(ctx, (uint16_t)(chip.x + 34u), (uint16_t)(chip.y + 2u), UI_FMT_U32,
+                        (uint32_t)m->assist_mode, 0u, NULL),
+                 text, card_fill);
 
     chip.x = (uint16_t)(chip.x + chip.w + 6u);
     chip.w = 40u;
@@ -1147,8 +1883,10 @@ static void dash_v2_render_top(ui_render_ctx_t *ctx, const ui_model_t *m,
         gear_border = accent;
     draw_outline_panel(ctx, chip, gear_border, card_fill, 10u);
     ui_draw_text(ctx, (uint16_t)(chip.x + 8u), (uint16_t)(chip.y + 2u), "G", muted, card_fill);
-    fmt_u32(buf, sizeof(buf), (uint32_t)m->virtual_gear);
-    ui_draw_text(ctx, (uint16_t)(chip.x + 20u), (uint16_t)(chip.y + 2u), buf, text, card_fill);
+    ui_draw_text(ctx, (uint16_t)(chip.x + 20u), (uint16_t)(chip.y + 2u),
+                 fmt_at(ctx, (uint16_t)(chip.x + 20u), (uint16_t)(chip.y + 2u), UI_FMT_U32,
+                        (uint32_t)m->virtual_gear, 0u, NULL),
+                 text, card_fill);
     uint16_t left_end = (uint16_t)(chip.x + chip.w + 6u);
 
     /* Right: SOC + battery icon. */
@@ -1159,12 +1897,13 @@ static void dash_v2_render_top(ui_render_ctx_t *ctx, const ui_model_t *m,
         icon_color = warn;
     ui_rect_t batt = {(uint16_t)(DISP_W - l->M - 40u), (uint16_t)(top_y + 3u), 38u, 14u};
     ui_draw_battery_icon(ctx, batt, m->soc_pct, icon_color, bg);
-    fmt_u32(buf, sizeof(buf), (uint32_t)m->soc_pct);
-    uint16_t soc_w = txt_w_est(buf);
+    /* Right-aligned to the icon, so keyed by the icon's corner. */
+    const char *soc = fmt_at(ctx, batt.x, batt.y, UI_FMT_U32, (uint32_t)m->soc_pct, 0u, NULL);
+    uint16_t soc_w = txt_w_est(soc);
     uint16_t soc_x = 0u;
     if (batt.x > (uint16_t)(4u + soc_w))
         soc_x = (uint16_t)(batt.x - 4u - soc_w);
-    ui_draw_text(ctx, soc_x, (uint16_t)(top_y + 2u), buf, text, bg);
+    ui_draw_text(ctx, soc_x, (uint16_t)(top_y + 2u), soc, text, bg);
 
     /* Center label priority: WALK > CRUISE > limiter > mode. */
     const char *center_str = m->mode ? "PRIVATE" : "LEGAL";
@@ -1209,20 +1948,83 @@ static void dash_v2_render_top(ui_render_ctx_t *ctx, const ui_model_t *m,
     }
 }
 
-static void dash_v2_render_speed_inner(ui_render_ctx_t *ctx, const ui_model_t *m,
-                                       const ui_dash_v2_layout_t *l,
-                                       uint16_t panel,
-                                       uint16_t text,
-                                       uint16_t muted,
-                                       uint16_t accent,
-                                       uint16_t warn,
-                                       uint16_t stroke,
-                                       uint16_t card_fill)
+/*
+ * Retained-mode dashboard cells: the speed card and stat tray remember what
+ * they last drew (ui_state_t.dash_cache) so a partial redraw repaints only
+ * the sub-rects whose value changed. Anything that moves layout or colour
+ * (units, palette, glow/sweep phase, oversized text) falls back to a full
+ * cell repaint, which refreshes the cache. The hash pass never uses it.
+ */
+static ui_dash_cache_t *dash_cache(ui_render_ctx_t *ctx)
 {
-    char buf[20];
+    return (ctx && ctx->ui && ctx->draw_enabled) ? &ctx->ui->dash_cache : NULL;
+}
+
+static uint8_t dash_text_copy(char *dst, const char *text, size_t cap)
+{
+    size_t n = ui_strnlen(text, cap);
+    if (n >= cap)
+    {
+        dst[0] = 0;
+        return 0u;
+    }
+    for (size_t i = 0; i <= n; ++i)
+        dst[i] = text[i];
+    return 1u;
+}
+
+static uint8_t dash_text_store(char *slot, const char *text)
+{
+    return dash_text_copy(slot, text, UI_DASH_CACHE_TEXT);
+}
+
+/* A retained text cell can be updated in place if old and new both fit the
+ * cell (glyph boxes never reach the next item). */
+static uint8_t dash_text_fits(const char *old_text, const char *new_text, uint16_t cell_w)
+{
+    return (txt_w_est(old_text) < cell_w && txt_w_est(new_text) < cell_w) ? 1u : 0u;
+}
+
+/* Erase the old string's glyph boxes with bg, then draw the new one. */
+static void dash_text_swap(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, char *slot,
+                           const char *text, uint16_t fg, uint16_t bg)
+{
+    ui_draw_text(ctx, x, y, slot, bg, bg);
+    ui_draw_text(ctx, x, y, text, fg, bg);
+    (void)dash_text_store(slot, text);
+}
+
+typedef struct {
+    int16_t gcx;
+    int16_t gcy;
+    uint16_t outer_r;
+    uint16_t thick;
+    int16_t start_deg;
+    uint16_t sweep_deg;
+    uint16_t active_sweep;
+    uint16_t gauge_active;
+    uint16_t gauge_inactive;
+    uint16_t unit_x;
+    uint16_t unit_y;
+    uint16_t spd;
+    uint8_t digits;
+    uint8_t scale;
+    uint16_t dw;
+    uint16_t dgap;
+    uint16_t dx0;
+    uint16_t dy0;
+    uint16_t info_y;
+    uint16_t tick_x;
+    uint16_t tick_y;
+    uint8_t ticks;
+} dash_v2_speed_geom_t;
+
+static dash_v2_speed_geom_t dash_v2_speed_geom(const ui_model_t *m, const ui_dash_v2_layout_t *l,
+                                               uint16_t muted, uint16_t accent, uint16_t warn,
+                                               uint16_t card_fill)
+{
+    dash_v2_speed_geom_t g;
     ui_rect_t speed = l->speed;
-    ui_rect_t speed_in = l->speed_in;
-    ui_draw_round_rect(ctx, speed_in, card_fill, (uint8_t)(l->R - 2u));
 
     /*
      * Curved power gauge (halo arc) clipped to the speed card.
@@ -1246,89 +2048,399 @@ static void dash_v2_render_speed_inner(ui_render_ctx_t *ctx, const ui_model_t *m
     }
 
     /* Power halo arc behind digits - bolder presence. */
-    const uint16_t gauge_active = rgb565_lerp(card_fill, (m->limit_reason != LIMIT_REASON_USER) ? warn : accent, 240u);
-    const uint16_t gauge_inactive = rgb565_lerp(card_fill, muted, 48u);
-    const int16_t gcx = (int16_t)(speed.x + speed.w / 2u);
-    const int16_t gcy = (int16_t)(speed.y + speed.h - 28u); /* centered lower for bigger arc */
-    const uint16_t outer_r = 105u;
-    const uint16_t thick = 14u;        /* thicker ring for visual weight */
-    const int16_t start_deg = 210;     /* wider sweep */
-    const uint16_t sweep_deg = 120u;   /* 120 degree arc across top */
-    const uint16_t active_sweep = (uint16_t)((uint32_t)sweep_deg * pct / 100u);
-    ui_draw_ring_gauge(ctx, speed_in,
-                       gcx, gcy, outer_r, thick,
-                       start_deg, sweep_deg, active_sweep,
-                       gauge_active, gauge_inactive, card_fill);
+    g.gauge_active = rgb565_lerp(card_fill, (m->limit_reason != LIMIT_REASON_USER) ? warn : accent, 240u);
+    g.gauge_inactive = rgb565_lerp(card_fill, muted, 48u);
+    g.gcx = (int16_t)(speed.x + speed.w / 2u);
+    g.gcy = (int16_t)(speed.y + speed.h - 28u); /* centered lower for bigger arc */
+    g.outer_r = 105u;
+    g.thick = 14u;        /* thicker ring for visual weight */
+    g.start_deg = 210;    /* wider sweep */
+    g.sweep_deg = 120u;   /* 120 degree arc across top */
+    g.active_sweep = (uint16_t)((uint32_t)g.sweep_deg * pct / 100u);
 
     /* Unit label: above digits, centered (never overlaps). */
-    const char *unit = m->units ? "KMH" : "MPH";
-    ui_draw_text(ctx, (uint16_t)(speed.x + speed.w / 2u - 14u), (uint16_t)(speed.y + 10u), unit, muted, card_fill);
+    g.unit_x = (uint16_t)(speed.x + speed.w / 2u - 14u);
+    g.unit_y = (uint16_t)(speed.y + 10u);
 
     /* Big speed digits: centered. */
-    uint16_t spd = (uint16_t)(m->speed_dmph / 10u);
-    uint8_t digits = (spd >= 100u) ? 3u : ((spd >= 10u) ? 2u : 1u);
-    uint8_t scale = 5u;
-    uint16_t dw = seg_digit_w(scale);
-    uint16_t dgap = (uint16_t)(2u * (uint16_t)scale);
-    uint16_t total = (uint16_t)(digits * dw + (digits - 1u) * dgap);
-    uint16_t dx0 = (speed.w > total) ? (uint16_t)(speed.x + (speed.w - total) / 2u) : speed.x;
-    uint16_t dy0 = (uint16_t)(speed.y + 48u);
+    g.spd = (uint16_t)(m->speed_dmph / 10u);
+    g.digits = (g.spd >= 100u) ? 3u : ((g.spd >= 10u) ? 2u : 1u);
+    g.scale = 5u;
+    g.dw = seg_digit_w(g.scale);
+    g.dgap = (uint16_t)(2u * (uint16_t)g.scale);
+    uint16_t total = (uint16_t)(g.digits * g.dw + (g.digits - 1u) * g.dgap);
+    g.dx0 = (speed.w > total) ? (uint16_t)(speed.x + (speed.w - total) / 2u) : speed.x;
+    g.dy0 = (uint16_t)(speed.y + 48u);
 
-    uint16_t digit_shadow = rgb565_dim(accent);
-    uint16_t sx = (uint16_t)(dx0 + 2u);
-    uint16_t sy = (uint16_t)(dy0 + 2u);
-    if (digits == 3u)
-    {
-        ui_draw_big_digit(ctx, sx, sy, (uint8_t)(spd / 100u), scale, digit_shadow);
-        sx = (uint16_t)(sx + dw + dgap);
-    }
-    if (digits >= 2u)
+    /* Bottom info row inside speed card. */
+    g.info_y = (uint16_t)(speed.y + speed.h - 22u);
+
+    /* Range confidence ticks (0..5). */
+    uint16_t conf = m->range_confidence;
+    g.ticks = (uint8_t)((conf * 5u + 50u) / 100u);
+    if (g.ticks > 5u)
+        g.ticks = 5u;
+    g.tick_x = (uint16_t)(speed.x + speed.w - 10u - 5u * 6u);
+    g.tick_y = (g.info_y > 16u) ? (uint16_t)(g.info_y - 16u) : g.info_y;
+    return g;
+}
+
+static void dash_v2_draw_speed_gauge(ui_render_ctx_t *ctx, const dash_v2_speed_geom_t *g,
+                                     ui_rect_t clip, uint16_t card_fill)
+{
+    ui_draw_ring_gauge(ctx, clip,
+                       g->gcx, g->gcy, g->outer_r, g->thick,
+                       g->start_deg, g->sweep_deg, g->active_sweep,
+                       g->gauge_active, g->gauge_inactive, card_fill);
+}
+
+/* Bit i of `mask` redraws digit i (0 = leftmost); 0x7 draws them all. */
+static void dash_v2_draw_speed_digits(ui_render_ctx_t *ctx, const dash_v2_speed_geom_t *g, uint16_t accent,
+                                      uint16_t bg, uint8_t mask)
+{
+    ui_draw_big_number(ctx, g->dx0, g->dy0, g->spd, g->digits, g->scale, (uint16_t)(g->dw + g->dgap), accent, bg,
+                       mask);
+}
+
+static void dash_v2_draw_speed_ticks(ui_render_ctx_t *ctx, const dash_v2_speed_geom_t *g,
+                                     uint16_t accent, uint16_t stroke)
+{
+    for (uint8_t i = 0; i < 5u; ++i)
     {
-        ui_draw_big_digit(ctx, sx, sy, (uint8_t)((spd / 10u) % 10u), scale, digit_shadow);
-        sx = (uint16_t)(sx + dw + dgap);
+        ui_rect_t t = {(uint16_t)(g->tick_x + i * 6u), g->tick_y, 4u, 2u};
+        ui_draw_rect(ctx, t, (i < g->ticks) ? accent : stroke);
     }
-    ui_draw_big_digit(ctx, sx, sy, (uint8_t)(spd % 10u), scale, digit_shadow);
+}
+
+static ui_rect_t dash_text_box(uint16_t x, uint16_t y, const char *text)
+{
+    /* Glyph boxes may overhang the advance by a pixel. */
+    return (ui_rect_t){x, y, (uint16_t)(txt_w_est(text) + 2u), UI_FONT_BITMAP_LINE_HEIGHT};
+}
 
-    uint16_t dx = dx0;
-    if (digits == 3u)
+static ui_rect_t dash_v2_digits_box(const dash_v2_speed_geom_t *g)
+{
+    uint16_t total = (uint16_t)(g->digits * g->dw + (g->digits - 1u) * g->dgap);
+    /* Main digits plus the 2px drop shadow. */
+    return (ui_rect_t){g->dx0, g->dy0, (uint16_t)(total + 2u), (uint16_t)(20u * g->scale + 2u)};
+}
+
+/* Digit i (0 = leftmost) of the speed with its shadow. */
+static ui_rect_t dash_v2_digit_box(const dash_v2_speed_geom_t *g, uint8_t i)
+{
+    return (ui_rect_t){(uint16_t)(g->dx0 + i * (g->dw + g->dgap)), g->dy0, (uint16_t)(g->dw + 2u),
+                       (uint16_t)(20u * g->scale + 2u)};
+}
+
+/* Bounding box of the ring sector between two sweep offsets (AA margin included). */
+static ui_rect_t dash_v2_gauge_sector_box(const dash_v2_speed_geom_t *g, uint16_t s0, uint16_t s1)
+{
+    if (s0 > s1)
     {
-        ui_draw_big_digit(ctx, dx, dy0, (uint8_t)(spd / 100u), scale, accent);
-        dx = (uint16_t)(dx + dw + dgap);
+        uint16_t t = s0;
+        s0 = s1;
+        s1 = t;
     }
-    if (digits >= 2u)
-    {
-        ui_draw_big_digit(ctx, dx, dy0, (uint8_t)((spd / 10u) % 10u), scale, accent);
-        dx = (uint16_t)(dx + dw + dgap);
+    int16_t a0 = (int16_t)(g->start_deg + (int16_t)s0);
+    int16_t a1 = (int16_t)(g->start_deg + (int16_t)s1);
+    int32_t r_in = (int32_t)g->outer_r - (int32_t)g->thick - 2;
+    int32_t r_out = (int32_t)g->outer_r + 2;
+    if (r_in < 0)
+        r_in = 0;
+
+    int32_t minx = INT32_MAX, miny = INT32_MAX, maxx = INT32_MIN, maxy = INT32_MIN;
+    int16_t a = a0;
+    for (;;)
+    {
+        ui_vec2_i16_t v = ui_trig_unit_deg_cw_q15(a);
+        for (uint8_t k = 0; k < 2u; ++k)
+        {
+            int32_t r = k ? r_out : r_in;
+            int32_t x = (int32_t)g->gcx + (((int32_t)v.x * r) >> 15);
+            int32_t y = (int32_t)g->gcy + (((int32_t)v.y * r) >> 15);
+            minx = (x < minx) ? x : minx;
+            maxx = (x > maxx) ? x : maxx;
+            miny = (y < miny) ? y : miny;
+            maxy = (y > maxy) ? y : maxy;
+        }
+        if (a == a1)
+            break;
+        /* Visit every axis crossing inside the sector, then the end angle. */
+        int16_t next = (int16_t)((a / 90 + 1) * 90);
+        if (a < 0 && a % 90 != 0)
+            next = (int16_t)((a / 90) * 90);
+        a = (next < a1) ? next : a1;
     }
-    ui_draw_big_digit(ctx, dx, dy0, (uint8_t)(spd % 10u), scale, accent);
 
-    /* Bottom info row inside speed card. */
-    uint16_t info_y = (uint16_t)(speed.y + speed.h - 22u);
-    ui_draw_rect(ctx, (ui_rect_t){(uint16_t)(speed.x + 12u), (uint16_t)(info_y - 6u), (uint16_t)(speed.w - 24u), 1u}, stroke);
+    minx -= 2;
+    miny -= 2;
+    maxx += 2;
+    maxy += 2;
+    if (minx < 0)
+        minx = 0;
+    if (miny < 0)
+        miny = 0;
+    return (ui_rect_t){(uint16_t)minx, (uint16_t)miny, (uint16_t)(maxx - minx + 1), (uint16_t)(maxy - miny + 1)};
+}
 
-    ui_draw_text(ctx, (uint16_t)(speed.x + 18u), info_y, "PWR", muted, card_fill);
-    fmt_u32(buf, sizeof(buf), (uint32_t)m->power_w);
-    ui_draw_text(ctx, (uint16_t)(speed.x + 48u), info_y, buf, text, card_fill);
-    ui_draw_text(ctx, (uint16_t)(speed.x + 78u), info_y, "W", muted, card_fill);
+#define DASH_SPEED_ITEMS 10u
+#define DASH_DAMAGE_MAX 20u
 
-    ui_draw_text(ctx, (uint16_t)(speed.x + speed.w / 2u + 6u), info_y, "RNG", muted, card_fill);
-    fmt_d10(buf, sizeof(buf), (int32_t)m->range_est_d10);
-    ui_draw_text(ctx, (uint16_t)(speed.x + speed.w / 2u + 38u), info_y, buf, text, card_fill);
-    ui_draw_text(ctx, (uint16_t)(speed.x + speed.w / 2u + 74u), info_y, m->units ? "KM" : "MI", muted, card_fill);
+typedef struct {
+    ui_rect_t r[DASH_DAMAGE_MAX];
+    uint8_t n;
+} dash_damage_t;
 
-    /* Range confidence ticks (0..5). */
-    uint16_t conf = m->range_confidence;
-    uint8_t ticks = (uint8_t)((conf * 5u + 50u) / 100u);
-    if (ticks > 5u)
-        ticks = 5u;
-    uint16_t tx = (uint16_t)(speed.x + speed.w - 10u - 5u * 6u);
-    uint16_t ty = (info_y > 16u) ? (uint16_t)(info_y - 16u) : info_y;
-    for (uint8_t i = 0; i < 5u; ++i)
-    {
-        ui_rect_t t = {(uint16_t)(tx + i * 6u), ty, 4u, 2u};
-        ui_draw_rect(ctx, t, (i < ticks) ? accent : stroke);
+static uint8_t dash_damage_add(dash_damage_t *d, ui_rect_t r)
+{
+    if (r.w == 0u || r.h == 0u)
+        return 1u;
+    if (d->n >= DASH_DAMAGE_MAX)
+        return 0u;
+    d->r[d->n++] = r;
+    return 1u;
+}
+
+static uint8_t dash_damage_hits(const dash_damage_t *d, ui_rect_t r)
+{
+    for (uint8_t i = 0; i < d->n; ++i)
+        if (rect_intersects(d->r[i], r))
+            return 1u;
+    return 0u;
+}
+
+static uint8_t rect_eq(ui_rect_t a, ui_rect_t b)
+{
+    return (a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h) ? 1u : 0u;
+}
+
+static uint8_t rect_contains(ui_rect_t outer, ui_rect_t inner)
+{
+    return (inner.x >= outer.x && inner.y >= outer.y &&
+            inner.x + inner.w <= outer.x + outer.w &&
+            inner.y + inner.h <= outer.y + outer.h) ? 1u : 0u;
+}
+
+static ui_panel_style_t dash_v2_card_style(const ui_model_t *m, const ui_dash_v2_layout_t *l,
+                                           uint16_t panel, uint16_t card_fill)
+{
+    return (ui_panel_style_t){
+        .radius = l->R,
+        .border_thick = (uint8_t)l->ST,
+        .shadow_dx = 2,
+        .shadow_dy = 2,
+        .fill = card_fill,
+        .border = panel,
+        .shadow = rgb565_dim(panel),
+        .flags = panel_flags_for_theme(m->theme),
+    };
+}
+
+/* The digits reach below the speed card, where the full render leaves them on
+ * the page background and the card's bottom edge; repaint both under r. */
+static void dash_v2_restore_below_speed(ui_render_ctx_t *ctx, const ui_model_t *m,
+                                        const ui_dash_v2_layout_t *l, ui_rect_t r,
+                                        uint16_t panel, uint16_t card_fill)
+{
+    int y0 = (int)l->speed_in.y + (int)l->speed_in.h;
+    int y1 = (int)r.y + (int)r.h;
+    if (y1 <= y0 || r.w == 0u)
+        return;
+    ui_rect_t below = rect_span(r.x, (r.y > y0) ? r.y : y0, (int)r.x + (int)r.w, y1);
+    ui_panel_style_t style = dash_v2_card_style(m, l, panel, card_fill);
+    ui_clip_push(ctx, below);
+    ui_draw_rect(ctx, below, ui_color(ctx, UI_COLOR_BG));
+    ui_draw_panel(ctx, l->speed, &style);
+    ui_clip_pop(ctx);
+}
+
+static void dash_v2_render_speed_inner(ui_render_ctx_t *ctx, const ui_model_t *m,
+                                       const ui_dash_v2_layout_t *l,
+                                       uint16_t panel,
+                                       uint16_t text,
+                                       uint16_t muted,
+                                       uint16_t accent,
+                                       uint16_t warn,
+                                       uint16_t stroke,
+                                       uint16_t card_fill,
+                                       uint8_t retained)
+{
+    ui_rect_t speed = l->speed;
+    ui_rect_t speed_in = l->speed_in;
+    dash_v2_speed_geom_t g = dash_v2_speed_geom(m, l, muted, accent, warn, card_fill);
+
+    /* Paint order below; the retained path redraws these by index. */
+    const char *unit = m->units ? "KMH" : "MPH";
+    const char *rng_unit = m->units ? "KM" : "MI";
+    const uint16_t pwr_x = (uint16_t)(speed.x + 48u);
+    const uint16_t rng_x = (uint16_t)(speed.x + speed.w / 2u + 38u);
+    /* Both strings are used together, so copy them out of the fmt cache. */
+    char pwr[UI_FMT_TEXT];
+    char rng[UI_FMT_TEXT];
+    (void)dash_text_copy(pwr, fmt_at(ctx, pwr_x, g.info_y, UI_FMT_U32, m->power_w, 0u, NULL), sizeof(pwr));
+    (void)dash_text_copy(rng, fmt_at(ctx, rng_x, g.info_y, UI_FMT_D10, m->range_est_d10, 0u, NULL), sizeof(rng));
+    ui_rect_t items[DASH_SPEED_ITEMS] = {
+        dash_text_box(g.unit_x, g.unit_y, unit),
+        dash_v2_digits_box(&g),
+        {(uint16_t)(speed.x + 12u), (uint16_t)(g.info_y - 6u), (uint16_t)(speed.w - 24u), 1u},
+        dash_text_box((uint16_t)(speed.x + 18u), g.info_y, "PWR"),
+        dash_text_box(pwr_x, g.info_y, pwr),
+        dash_text_box((uint16_t)(speed.x + 78u), g.info_y, "W"),
+        dash_text_box((uint16_t)(speed.x + speed.w / 2u + 6u), g.info_y, "RNG"),
+        dash_text_box(rng_x, g.info_y, rng),
+        dash_text_box((uint16_t)(speed.x + speed.w / 2u + 74u), g.info_y, rng_unit),
+        {g.tick_x, g.tick_y, 5u * 6u, 2u},
+    };
+
+    ui_dash_cache_t *c = dash_cache(ctx);
+    /* The gauge repaints its whole clip box with bg, so it alone restores the
+     * card background for any sub-rect when its box covers the card. */
+    ui_rect_t gauge_box = {(uint16_t)(g.gcx - (int16_t)g.outer_r - 2), (uint16_t)(g.gcy - (int16_t)g.outer_r - 2),
+                           (uint16_t)(2u * g.outer_r + 4u), (uint16_t)(2u * g.outer_r + 4u)};
+    uint8_t gauge_is_bg = (g.gcx >= (int16_t)(g.outer_r + 2u) && g.gcy >= (int16_t)(g.outer_r + 2u) &&
+                           rect_contains(gauge_box, speed_in)) ? 1u : 0u;
+    if (retained && c && c->speed_valid && gauge_is_bg &&
+        c->units == m->units && c->card_fill == card_fill && c->accent == accent &&
+        c->text == text && c->gauge_active == g.gauge_active)
+    {
+        dash_damage_t dmg = {0};
+        uint8_t ok = 1u;
+        if (c->spd != g.spd && rect_eq(c->digit_box, items[1]))
+        {
+            /* Same digit count: only the digits that changed. */
+            for (uint8_t i = 0; i < g.digits; ++i)
+                if (big_number_digit(c->spd, g.digits, i) != big_number_digit(g.spd, g.digits, i))
+                    ok &= dash_damage_add(&dmg, dash_v2_digit_box(&g, i));
+        }
+        else if (c->spd != g.spd)
+        {
+            ok &= dash_damage_add(&dmg, c->digit_box);
+            ok &= dash_damage_add(&dmg, items[1]);
+        }
+        if (c->active_sweep != g.active_sweep)
+            ok &= dash_damage_add(&dmg, dash_v2_gauge_sector_box(&g, c->active_sweep, g.active_sweep));
+        if (c->pwr_w != m->power_w)
+        {
+            ok &= dash_damage_add(&dmg, dash_text_box(pwr_x, g.info_y, c->pwr));
+            ok &= dash_damage_add(&dmg, items[4]);
+        }
+        if (c->rng_d10 != m->range_est_d10)
+        {
+            ok &= dash_damage_add(&dmg, dash_text_box(rng_x, g.info_y, c->rng));
+            ok &= dash_damage_add(&dmg, items[7]);
+        }
+        if (c->ticks != g.ticks)
+            ok &= dash_damage_add(&dmg, items[9]);
+
+        if (ok)
+        {
+            /* Background (gauge) under the changed rects only. */
+            for (uint8_t i = 0; i < dmg.n; ++i)
+            {
+                ui_rect_t r = dmg.r[i];
+                uint16_t x1 = (uint16_t)(r.x + r.w);
+                uint16_t y1 = (uint16_t)(r.y + r.h);
+                if (x1 > speed_in.x + speed_in.w)
+                    x1 = (uint16_t)(speed_in.x + speed_in.w);
+                if (y1 > speed_in.y + speed_in.h)
+                    y1 = (uint16_t)(speed_in.y + speed_in.h);
+                if (r.x < speed_in.x)
+                    r.x = speed_in.x;
+                if (r.y < speed_in.y)
+                    r.y = speed_in.y;
+                if (x1 <= r.x || y1 <= r.y)
+                    continue;
+                r.w = (uint16_t)(x1 - r.x);
+                r.h = (uint16_t)(y1 - r.y);
+                dash_v2_draw_speed_gauge(ctx, &g, r, card_fill);
+            }
+            for (uint8_t i = 0; i < dmg.n; ++i)
+                dash_v2_restore_below_speed(ctx, m, l, dmg.r[i], panel, card_fill);
+
+            /* Redraw every later item touching the damage; each redrawn item
+             * paints its whole box, so it extends the damage for later ones. */
+            for (uint8_t i = 0; i < DASH_SPEED_ITEMS && ok; ++i)
+            {
+                if (!dash_damage_hits(&dmg, items[i]))
+                    continue;
+                switch (i)
+                {
+                case 0: ui_draw_text(ctx, g.unit_x, g.unit_y, unit, muted, card_fill); break;
+                case 1:
+                {
+                    uint8_t mask = 0u;
+                    for (uint8_t d = 0; d < g.digits; ++d)
+                        if (dash_damage_hits(&dmg, dash_v2_digit_box(&g, d)))
+                            mask |= (uint8_t)(1u << d);
+                    dash_v2_draw_speed_digits(ctx, &g, accent, card_fill, mask);
+                    for (uint8_t d = 0; d < g.digits; ++d)
+                        if (mask & (1u << d))
+                            ok &= dash_damage_add(&dmg, dash_v2_digit_box(&g, d));
+                    continue;
+                }
+                case 2: ui_draw_rect(ctx, items[2], stroke); break;
+                case 3: ui_draw_text(ctx, items[3].x, g.info_y, "PWR", muted, card_fill); break;
+                case 4: ui_draw_text(ctx, pwr_x, g.info_y, pwr, text, card_fill); break;
+                case 5: ui_draw_text(ctx, items[5].x, g.info_y, "W", muted, card_fill); break;
+                case 6: ui_draw_text(ctx, items[6].x, g.info_y, "RNG", muted, card_fill); break;
+                case 7: ui_draw_text(ctx, rng_x, g.info_y, rng, text, card_fill); break;
+                case 8: ui_draw_text(ctx, items[8].x, g.info_y, rng_unit, muted, card_fill); break;
+                default: dash_v2_draw_speed_ticks(ctx, &g, accent, stroke); break;
+                }
+                ok &= dash_damage_add(&dmg, items[i]);
+            }
+        }
+        if (ok)
+        {
+            c->spd = g.spd;
+            c->digit_box = items[1];
+            c->active_sweep = g.active_sweep;
+            c->ticks = g.ticks;
+            c->pwr_w = m->power_w;
+        c->rng_d10 = m->range_est_d10;
+        c->speed_valid = (uint8_t)(dash_text_store(c->pwr, pwr) & dash_text_store(c->rng, rng));
+            return;
+        }
+    }
+
+    /* Whatever number was there before, across the card. */
+    if (retained)
+        dash_v2_restore_below_speed(ctx, m, l,
+                                    (ui_rect_t){speed_in.x, items[1].y, speed_in.w, items[1].h},
+                                    panel, card_fill);
+    ui_draw_round_rect(ctx, speed_in, card_fill, (uint8_t)(l->R - 2u));
+    dash_v2_draw_speed_gauge(ctx, &g, speed_in, card_fill);
+    ui_draw_text(ctx, g.unit_x, g.unit_y, unit, muted, card_fill);
+    dash_v2_draw_speed_digits(ctx, &g, accent, card_fill, 0x7u);
+
+    /* Bottom info row inside speed card. */
+    ui_draw_rect(ctx, items[2], stroke);
+
+    ui_draw_text(ctx, items[3].x, g.info_y, "PWR", muted, card_fill);
+    ui_draw_text(ctx, pwr_x, g.info_y, pwr, text, card_fill);
+    ui_draw_text(ctx, items[5].x, g.info_y, "W", muted, card_fill);
+
+    ui_draw_text(ctx, items[6].x, g.info_y, "RNG", muted, card_fill);
+    ui_draw_text(ctx, rng_x, g.info_y, rng, text, card_fill);
+    ui_draw_text(ctx, items[8].x, g.info_y, rng_unit, muted, card_fill);
+
+    dash_v2_draw_speed_ticks(ctx, &g, accent, stroke);
+
+    if (c)
+    {
+        c->units = m->units;
+        c->card_fill = card_fill;
+        c->accent = accent;
+        c->text = text;
+        c->gauge_active = g.gauge_active;
+        c->spd = g.spd;
+        c->digit_box = items[1];
+        c->active_sweep = g.active_sweep;
+        c->ticks = g.ticks;
+        c->pwr_w = m->power_w;
+        c->rng_d10 = m->range_est_d10;
+        c->speed_valid = (uint8_t)(dash_text_store(c->pwr, pwr) & dash_text_store(c->rng, rng));
     }
-    (void)panel;
 }
 
 static void dash_v2_render_tray_inner(ui_render_ctx_t *ctx, const ui_model_t *m,
@@ -1339,18 +2451,46 @@ static void dash_v2_render_tray_inner(ui_render_ctx_t *ctx, const ui_model_t *m,
                                       uint16_t muted,
                                       uint16_t stroke,
                                       uint16_t accent,
-                                      uint16_t card_fill)
+                                      uint16_t card_fill,
+                                      uint8_t retained)
 {
-    char buf[20];
+    char vals[4][UI_FMT_TEXT];
     ui_rect_t tray = l->tray;
     ui_rect_t tray_in = l->tray_in;
-
-    ui_draw_round_rect(ctx, tray_in, card_fill, (uint8_t)(l->R - 2u));
+    uint8_t sweep_phase = (ctx && ctx->ui) ? ctx->ui->accent_sweep_phase : 0u;
 
     /* 4-column layout: VOLT | CUR | TRIP | WH/MI */
     uint16_t col_w = (uint16_t)(tray.w / 4u);
     uint16_t label_y = (uint16_t)(tray.y + 6u);
     uint16_t value_y = (uint16_t)(tray.y + 22u);
+    const int32_t v[4] = {m->batt_dV, m->batt_dA, (int32_t)dist_d10, (int32_t)wh_d10};
+    for (uint8_t i = 0; i < 4u; ++i)
+        (void)dash_text_copy(vals[i], fmt_at(ctx, (uint16_t)(tray.x + i * col_w + 4u), value_y, UI_FMT_D10,
+                                             (uint32_t)v[i], 0u, NULL), sizeof(vals[i]));
+
+    ui_dash_cache_t *c = dash_cache(ctx);
+    if (retained && c && c->tray_valid &&
+        c->tray_units == m->units && c->tray_fill == card_fill && c->tray_text == text &&
+        c->sweep_phase == sweep_phase)
+    {
+        /* Cells end 4px short of the next divider; the last one at the card edge. */
+        uint8_t fits = 1u;
+        for (uint8_t i = 0; i < 4u; ++i)
+            fits &= dash_text_fits(c->tray[i], vals[i], (uint16_t)(col_w - 8u));
+        if (fits)
+        {
+            for (uint8_t i = 0; i < 4u; ++i)
+            {
+                if (c->tray_v[i] == v[i])
+                    continue;
+                dash_text_swap(ctx, (uint16_t)(tray.x + i * col_w + 4u), value_y, c->tray[i], vals[i], text, card_fill);
+                c->tray_v[i] = v[i];
+            }
+            return;
+        }
+    }
+
+    ui_draw_round_rect(ctx, tray_in, card_fill, (uint8_t)(l->R - 2u));
 
     /* Draw 3 vertical dividers between columns */
     for (uint8_t i = 1u; i < 4u; ++i) {
@@ -1363,323 +2503,154 @@ static void dash_v2_render_tray_inner(ui_render_ctx_t *ctx, const ui_model_t *m,
         ui_draw_rect(ctx, vdiv, stroke);
     }
 
-    /* Column 0: VOLT */
-    uint16_t col0_x = (uint16_t)(tray.x + 4u);
-    ui_draw_text(ctx, col0_x, label_y, "VOLT", muted, card_fill);
-    fmt_d10(buf, sizeof(buf), m->batt_dV);
-    ui_draw_text(ctx, col0_x, value_y, buf, text, card_fill);
-
-    /* Column 1: CUR */
-    uint16_t col1_x = (uint16_t)(tray.x + col_w + 4u);
-    ui_draw_text(ctx, col1_x, label_y, "CUR", muted, card_fill);
-    fmt_d10(buf, sizeof(buf), m->batt_dA);
-    ui_draw_text(ctx, col1_x, value_y, buf, text, card_fill);
-
-    /* Column 2: TRIP */
-    uint16_t col2_x = (uint16_t)(tray.x + 2u * col_w + 4u);
-    ui_draw_text(ctx, col2_x, label_y, "TRIP", muted, card_fill);
-    fmt_d10(buf, sizeof(buf), (int32_t)dist_d10);
-    ui_draw_text(ctx, col2_x, value_y, buf, text, card_fill);
-
-    /* Column 3: WH/MI (efficiency) */
-    uint16_t col3_x = (uint16_t)(tray.x + 3u * col_w + 4u);
-    ui_draw_text(ctx, col3_x, label_y, m->units ? "WH/K" : "WH/M", muted, card_fill);
-    fmt_d10(buf, sizeof(buf), (int32_t)wh_d10);
-    ui_draw_text(ctx, col3_x, value_y, buf, text, card_fill);
+    static const char *const k_labels[3] = {"VOLT", "CUR", "TRIP"};
+    for (uint8_t i = 0; i < 4u; ++i)
+    {
+        uint16_t col_x = (uint16_t)(tray.x + i * col_w + 4u);
+        const char *label = (i < 3u) ? k_labels[i] : (m->units ? "WH/K" : "WH/M"); /* efficiency */
+        ui_draw_text(ctx, col_x, label_y, label, muted, card_fill);
+        ui_draw_text(ctx, col_x, value_y, vals[i], text, card_fill);
+    }
 
-    if (ctx && ctx->ui && ctx->ui->accent_sweep_phase)
+    if (sweep_phase)
     {
-        uint16_t sweep_w = (uint16_t)((tray.w > 16u) ? (tray.w / 2u - 8u) : tray.w);
-        uint16_t sweep_x = (ctx->ui->accent_sweep_phase == 1u)
-                               ? (uint16_t)(tray.x + 8u)
+        /* Clear of the inner card's corners, which the cell repaint leaves alone. */
+        uint16_t sweep_w = (uint16_t)((tray.w > 2u * l->R) ? (tray.w / 2u - l->R) : tray.w);
+        uint16_t sweep_x = (sweep_phase == 1u)
+                               ? (uint16_t)(tray.x + l->R)
                                : (uint16_t)(tray.x + tray.w / 2u);
         uint16_t sweep_y = (uint16_t)(tray.y + 2u);
         if (sweep_w > 0u)
             ui_draw_rect(ctx, (ui_rect_t){sweep_x, sweep_y, sweep_w, 1u}, accent);
     }
-}
 
-static void dirty_dashboard_v2(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    ui_dash_v2_layout_t l = dash_v2_layout();
-
-    if (m->assist_mode != p->assist_mode || m->virtual_gear != p->virtual_gear || m->soc_pct != p->soc_pct ||
-        m->mode != p->mode || m->limit_reason != p->limit_reason || m->err != p->err || m->brake != p->brake ||
-        m->walk_state != p->walk_state || m->cruise_mode != p->cruise_mode)
-        ui_dirty_add(d, l.top_area);
-
-    if (m->speed_dmph != p->speed_dmph || m->power_w != p->power_w || m->limit_power_w != p->limit_power_w ||
-        m->limit_reason != p->limit_reason || m->range_est_d10 != p->range_est_d10 ||
-        m->range_confidence != p->range_confidence || m->units != p->units)
-        ui_dirty_add(d, l.speed_in);
-
-    if (m->batt_dV != p->batt_dV || m->batt_dA != p->batt_dA ||
-        m->trip_distance_mm != p->trip_distance_mm || m->trip_energy_mwh != p->trip_energy_mwh ||
-        m->units != p->units)
-        ui_dirty_add(d, l.tray_in);
-}
-
-static void dirty_focus(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->focus_metric != p->focus_metric ||
-        m->power_w != p->power_w ||
-        m->speed_dmph != p->speed_dmph ||
-        m->units != p->units ||
-        m->soc_pct != p->soc_pct)
-    {
-        ui_dirty_full(d);
-    }
-}
-
-static void dirty_trip_summary(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->trip_distance_mm != p->trip_distance_mm ||
-        m->trip_energy_mwh != p->trip_energy_mwh ||
-        m->trip_max_speed_dmph != p->trip_max_speed_dmph ||
-        m->trip_avg_speed_dmph != p->trip_avg_speed_dmph ||
-        m->trip_moving_ms != p->trip_moving_ms ||
-        m->trip_assist_ms != p->trip_assist_ms ||
-        m->trip_gear_ms != p->trip_gear_ms ||
-        m->virtual_gear != p->virtual_gear ||
-        m->units != p->units)
+    if (c)
     {
-        ui_dirty_full(d);
-    }
-}
-
-static void dirty_profiles(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->profile_select != p->profile_select ||
-        m->profile_focus != p->profile_focus ||
-        m->profile_id != p->profile_id ||
-        m->virtual_gear != p->virtual_gear ||
-        m->gear_count != p->gear_count ||
-        m->gear_min_pct != p->gear_min_pct ||
-        m->gear_max_pct != p->gear_max_pct ||
-        m->gear_shape != p->gear_shape)
-    {
-        ui_dirty_full(d);
+        uint8_t ok = 1u;
+        for (uint8_t i = 0; i < 4u; ++i)
+        {
+            ok &= dash_text_store(c->tray[i], vals[i]);
+            c->tray_v[i] = v[i];
+        }
+        c->tray_units = m->units;
+        c->tray_fill = card_fill;
+        c->tray_text = text;
+        c->sweep_phase = sweep_phase;
+        c->tray_valid = ok;
     }
 }
 
-static void dirty_settings(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->settings_index != p->settings_index ||
-        m->units != p->units ||
-        m->button_map != p->button_map ||
-        m->theme != p->theme ||
-        m->mode != p->mode ||
-        m->pin_code != p->pin_code)
-    {
-        ui_dirty_full(d);
-    }
-}
+#define DASH_V2_TOP_DEPS (UI_CH_ASSIST | UI_CH_SOC | UI_CH_MODE | UI_CH_LIMIT | UI_CH_ERR | \
+                          UI_CH_BRAKE | UI_CH_CRUISE)
+#define DASH_V2_SPEED_DEPS (UI_CH_SPEED | UI_CH_POWER | UI_CH_LIMIT | UI_CH_RANGE | UI_CH_UNITS)
+#define DASH_V2_TRAY_DEPS (UI_CH_BATT | UI_CH_TRIP | UI_CH_UNITS)
+#define DASH_V2_DEPS (DASH_V2_TOP_DEPS | DASH_V2_SPEED_DEPS | DASH_V2_TRAY_DEPS)
 
-static void dirty_cruise(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
+static void dirty_dashboard_v2(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p, uint32_t changes)
 {
-    if (m->cruise_mode != p->cruise_mode ||
-        m->cruise_set_dmph != p->cruise_set_dmph ||
-        m->cruise_set_power_w != p->cruise_set_power_w ||
-        m->cruise_resume_available != p->cruise_resume_available ||
-        m->cruise_resume_reason != p->cruise_resume_reason ||
-        m->units != p->units)
-    {
-        ui_dirty_full(d);
-    }
+    (void)m;
+    (void)p;
+    if (changes & DASH_V2_TOP_DEPS)
+        dirty_add_widget(d, UI_W_DASH_TOP);
+    if (changes & DASH_V2_SPEED_DEPS)
+        dirty_add_widget(d, UI_W_DASH_SPEED_IN);
+    if (changes & DASH_V2_TRAY_DEPS)
+        dirty_add_widget(d, UI_W_DASH_TRAY_IN);
 }
 
-static void dirty_battery(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->soc_pct != p->soc_pct ||
-        m->batt_dV != p->batt_dV ||
-        m->batt_dA != p->batt_dA ||
-        m->range_est_d10 != p->range_est_d10 ||
-        m->range_confidence != p->range_confidence ||
-        m->sag_margin_dV != p->sag_margin_dV ||
-        m->units != p->units)
-    {
-        ui_dirty_full(d);
-    }
-}
+#define BUS_DEPS (UI_CH_BUS | UI_CH_BUS_VIEW | UI_CH_LINK)
 
-static void dirty_thermal(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
+/* A row redraws when its opcode's frame changed it, or when it gains, loses
+ * or changes the rule it draws under itself. */
+static void dirty_bus(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p, uint32_t changes)
 {
-    if (m->ctrl_temp_dC != p->ctrl_temp_dC ||
-        m->thermal_state != p->thermal_state ||
-        m->limit_reason != p->limit_reason)
-    {
-        ui_dirty_full(d);
-    }
-}
-
-static void dirty_diagnostics(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->speed_dmph != p->speed_dmph)
-        ui_dirty_add(d, diagnostics_row_rect(0u));
-    if (m->rpm != p->rpm)
-        ui_dirty_add(d, diagnostics_row_rect(1u));
-    if (m->cadence_rpm != p->cadence_rpm)
-        ui_dirty_add(d, diagnostics_row_rect(2u));
-    if (m->torque_raw != p->torque_raw)
-        ui_dirty_add(d, diagnostics_row_rect(3u));
-    if (m->throttle_pct != p->throttle_pct)
-        ui_dirty_add(d, diagnostics_row_rect(4u));
-    if (m->brake != p->brake)
-        ui_dirty_add(d, diagnostics_row_rect(5u));
-    if (m->buttons != p->buttons)
-        ui_dirty_add(d, diagnostics_row_rect(6u));
-    if (m->err != p->err)
-        ui_dirty_add(d, diagnostics_row_rect(7u));
-    if (m->mode != p->mode)
-        ui_dirty_add(d, diagnostics_row_rect(DIAG_ROW_MODE_IDX));
-    if (m->limit_reason != p->limit_reason)
-        ui_dirty_add(d, diagnostics_row_rect(DIAG_ROW_LIMIT_IDX));
-    if (m->assist_mode != p->assist_mode)
-        ui_dirty_add(d, diagnostics_row_rect(10u));
-    if (m->walk_state != p->walk_state)
-        ui_dirty_add(d, diagnostics_row_rect(11u));
-    if (m->cruise_mode != p->cruise_mode)
-        ui_dirty_add(d, diagnostics_row_rect(12u));
-    if (m->cruise_resume_available != p->cruise_resume_available)
-        ui_dirty_add(d, diagnostics_row_rect(13u));
-    if (m->drive_mode != p->drive_mode)
-        ui_dirty_add(d, diagnostics_row_rect(14u));
-    if (m->regen_level != p->regen_level)
-        ui_dirty_add(d, diagnostics_row_rect(15u));
-    if (m->regen_brake_level != p->regen_brake_level)
-        ui_dirty_add(d, diagnostics_row_rect(16u));
-    if (m->link_timeouts != p->link_timeouts)
-        ui_dirty_add(d, diagnostics_row_rect(17u));
-    if (m->link_rx_errors != p->link_rx_errors)
-        ui_dirty_add(d, diagnostics_row_rect(18u));
-}
-
-static void dirty_bus(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->bus_count != p->bus_count ||
-        m->bus_last_id != p->bus_last_id ||
-        m->bus_last_len != p->bus_last_len ||
-        m->bus_last_dt_ms != p->bus_last_dt_ms ||
-        m->bus_last_opcode != p->bus_last_opcode ||
-        m->bus_diff != p->bus_diff ||
-        m->bus_changed_only != p->bus_changed_only ||
-        m->bus_filter_id_active != p->bus_filter_id_active ||
-        m->bus_filter_opcode_active != p->bus_filter_opcode_active ||
-        m->bus_filter_id != p->bus_filter_id ||
-        m->bus_filter_opcode != p->bus_filter_opcode ||
-        m->bus_entries != p->bus_entries)
+    if (changes & UI_CH_BUS_VIEW)
     {
         ui_dirty_full(d);
         return;
     }
-    for (uint8_t i = 0; i < BUS_UI_VIEW_MAX; ++i)
-    {
-        if (m->bus_list_id[i] != p->bus_list_id[i] ||
-            m->bus_list_op[i] != p->bus_list_op[i] ||
-            m->bus_list_len[i] != p->bus_list_len[i] ||
-            m->bus_list_dt_ms[i] != p->bus_list_dt_ms[i])
+    if (changes & UI_CH_BUS)
+    {
+        if (m->bus_count != p->bus_count)
+            dirty_add_widget(d, UI_W_BUS_COUNT);
+        if (m->bus_last_id != p->bus_last_id || m->bus_last_opcode != p->bus_last_opcode ||
+            m->bus_last_len != p->bus_last_len || m->bus_last_dt_ms != p->bus_last_dt_ms)
+            dirty_add_widget(d, UI_W_BUS_LAST);
+        for (uint8_t i = 0; i < BUS_UI_VIEW_MAX; ++i)
         {
-            ui_dirty_full(d);
-            return;
+            uint8_t shown = (uint8_t)(i < m->bus_entries);
+            uint8_t was = (uint8_t)(i < p->bus_entries);
+            uint8_t rule = (uint8_t)(i + 1u < m->bus_entries);
+            uint8_t was_rule = (uint8_t)(i + 1u < p->bus_entries);
+            if (shown != was || rule != was_rule ||
+                (shown && (m->bus_list_id[i] != p->bus_list_id[i] || m->bus_list_op[i] != p->bus_list_op[i] ||
+                           m->bus_list_len[i] != p->bus_list_len[i] ||
+                           m->bus_list_dt_ms[i] != p->bus_list_dt_ms[i])))
+                dirty_add_widget(d, (ui_widget_id_t)(UI_W_BUS_ROW_0 + i));
         }
     }
+    if (changes & UI_CH_LINK)
+        dirty_add_widget(d, UI_W_BUS_LINK);
 }
 
-static void dirty_capture(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->capture_enabled != p->capture_enabled ||
-        m->capture_count != p->capture_count)
-    {
-        ui_dirty_full(d);
-    }
-}
+#define DIAG_DEPS (UI_CH_SPEED | UI_CH_PEDAL | UI_CH_BRAKE | UI_CH_BUTTONS | UI_CH_ERR | UI_CH_MODE | \
+                   UI_CH_LIMIT | UI_CH_ASSIST | UI_CH_DRIVE | UI_CH_CRUISE | UI_CH_REGEN | UI_CH_LINK)
 
-static void dirty_alerts(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
+/* One row per field; groups holding several rows compare their fields. */
+static void dirty_diagnostics(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p, uint32_t changes)
 {
-    if (m->err != p->err ||
-        m->limit_reason != p->limit_reason ||
-        m->alert_ack_active != p->alert_ack_active ||
-        m->alert_count != p->alert_count ||
-        m->alert_entries != p->alert_entries ||
-        m->alert_selected != p->alert_selected ||
-        m->alert_ack_mask != p->alert_ack_mask ||
-        m->units != p->units)
+    if (changes & UI_CH_SPEED)
+        dirty_add_widget(d, UI_W_DIAG_ROW_0);
+    if (changes & UI_CH_PEDAL)
     {
-        ui_dirty_full(d);
-        return;
+        if (m->rpm != p->rpm)
+            dirty_add_widget(d, UI_W_DIAG_ROW_1);
+        if (m->cadence_rpm != p->cadence_rpm)
+            dirty_add_widget(d, UI_W_DIAG_ROW_2);
+        if (m->torque_raw != p->torque_raw)
+            dirty_add_widget(d, UI_W_DIAG_ROW_3);
+        if (m->throttle_pct != p->throttle_pct)
+            dirty_add_widget(d, UI_W_DIAG_ROW_4);
     }
-    for (uint8_t i = 0; i < 3u; ++i)
-    {
-        if (m->alert_type[i] != p->alert_type[i] ||
-            m->alert_flags[i] != p->alert_flags[i] ||
-            m->alert_age_s[i] != p->alert_age_s[i] ||
-            m->alert_dist_d10[i] != p->alert_dist_d10[i])
-        {
-            ui_dirty_full(d);
-            return;
-        }
+    if (changes & UI_CH_BRAKE)
+        dirty_add_widget(d, UI_W_DIAG_ROW_5);
+    if (changes & UI_CH_BUTTONS)
+        dirty_add_widget(d, UI_W_DIAG_ROW_6);
+    if (changes & UI_CH_ERR)
+        dirty_add_widget(d, UI_W_DIAG_ROW_7);
+    if (changes & UI_CH_MODE)
+        dirty_add_widget(d, UI_W_DIAG_ROW_0 + DIAG_ROW_MODE_IDX);
+    if ((changes & UI_CH_LIMIT) && m->limit_reason != p->limit_reason)
+        dirty_add_widget(d, UI_W_DIAG_ROW_0 + DIAG_ROW_LIMIT_IDX);
+    if (changes & UI_CH_ASSIST)
+    {
+        if (m->assist_mode != p->assist_mode)
+            dirty_add_widget(d, UI_W_DIAG_ROW_10);
+        if (m->walk_state != p->walk_state)
+            dirty_add_widget(d, UI_W_DIAG_ROW_11);
     }
-}
-
-static void dirty_tune(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->tune_index != p->tune_index ||
-        m->tune_cap_current_dA != p->tune_cap_current_dA ||
-        m->tune_ramp_wps != p->tune_ramp_wps ||
-        m->tune_boost_s != p->tune_boost_s)
+    if (changes & UI_CH_CRUISE)
     {
-        ui_dirty_full(d);
+        if (m->cruise_mode != p->cruise_mode)
+            dirty_add_widget(d, UI_W_DIAG_ROW_12);
+        if (m->cruise_resume_available != p->cruise_resume_available)
+            dirty_add_widget(d, UI_W_DIAG_ROW_13);
     }
-}
-
-static void dirty_ambient(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->soc_pct != p->soc_pct ||
-        m->batt_dA != p->batt_dA)
-    {
-        ui_dirty_full(d);
+    if ((changes & UI_CH_DRIVE) && m->drive_mode != p->drive_mode)
+        dirty_add_widget(d, UI_W_DIAG_ROW_14);
+    if (changes & UI_CH_REGEN)
+    {
+        if (m->regen_level != p->regen_level)
+            dirty_add_widget(d, UI_W_DIAG_ROW_15);
+        if (m->regen_brake_level != p->regen_brake_level)
+            dirty_add_widget(d, UI_W_DIAG_ROW_16);
     }
-}
-
-static void dirty_about(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    (void)d;
-    (void)m;
-    (void)p;
-}
-
-static void dirty_engineer_raw(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->bus_diff != p->bus_diff ||
-        m->speed_dmph != p->speed_dmph ||
-        m->rpm != p->rpm ||
-        m->cadence_rpm != p->cadence_rpm ||
-        m->torque_raw != p->torque_raw ||
-        m->throttle_pct != p->throttle_pct ||
-        m->brake != p->brake ||
-        m->buttons != p->buttons ||
-        m->soc_pct != p->soc_pct ||
-        m->err != p->err)
+    if (changes & UI_CH_LINK)
     {
-        ui_dirty_full(d);
-    }
-}
-
-static void dirty_engineer_power(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
-{
-    if (m->bus_diff != p->bus_diff ||
-        m->batt_dV != p->batt_dV ||
-        m->batt_dA != p->batt_dA ||
-        m->phase_dA != p->phase_dA ||
-        m->sag_margin_dV != p->sag_margin_dV ||
-        m->thermal_state != p->thermal_state ||
-        m->ctrl_temp_dC != p->ctrl_temp_dC ||
-        m->limit_power_w != p->limit_power_w ||
-        m->regen_supported != p->regen_supported ||
-        m->regen_cmd_power_w != p->regen_cmd_power_w ||
-        m->limit_reason != p->limit_reason)
-    {
-        ui_dirty_full(d);
+        if (m->link_timeouts != p->link_timeouts)
+            dirty_add_widget(d, UI_W_DIAG_ROW_17);
+        if (m->link_rx_errors != p->link_rx_errors)
+            dirty_add_widget(d, UI_W_DIAG_ROW_18);
     }
 }
 
@@ -1691,7 +2662,7 @@ static void render_dashboard(ui_render_ctx_t *ctx, const ui_model_t *m, uint16_t
      * - strong hierarchy: SPEED dominates, then power/range, then bottom stats
      * - consistent spacing: 4px grid, 12px margin, 2px strokes, 16px radii
      */
-    ui_dash_v2_layout_t l = dash_v2_layout();
+    const ui_dash_v2_layout_t *l = &k_dash_v2_layout;
 
     const uint16_t bg = ui_color(ctx, UI_COLOR_BG);
     const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
@@ -1702,34 +2673,24 @@ static void render_dashboard(ui_render_ctx_t *ctx, const ui_model_t *m, uint16_t
     const uint16_t danger = ui_color(ctx, UI_COLOR_DANGER);
     const uint16_t ok = ui_color(ctx, UI_COLOR_OK);
     const uint16_t stroke = rgb565_dim(muted);
-    const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bg, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     uint16_t accent_dash = accent;
     if (ctx && ctx->ui && ctx->ui->regen_glow_phase)
-        accent_dash = rgb565_lerp(accent, ok, 180u);
+        accent_dash = ui_tint(ctx, UI_TINT_ACCENT_DASH);
 
-    ui_draw_rect(ctx, l.full, bg);
+    ui_draw_rect(ctx, l->full, bg);
 
     /* ===== Top status row (no heavy bar) ===== */
-    dash_v2_render_top(ctx, m, &l, bg, text, muted, accent_dash, card_fill, stroke, warn, danger, ok);
+    dash_v2_render_top(ctx, m, l, bg, text, muted, accent_dash, card_fill, stroke, warn, danger, ok);
 
     /* ===== Speed card ===== */
-    ui_panel_style_t card_style = {
-        .radius = l.R,
-        .border_thick = (uint8_t)l.ST,
-        .shadow_dx = 2,
-        .shadow_dy = 2,
-        .fill = card_fill,
-        .border = panel,
-        .shadow = shadow,
-        .flags = panel_flags_for_theme(m->theme),
-    };
-    ui_draw_panel(ctx, l.speed, &card_style);
-    dash_v2_render_speed_inner(ctx, m, &l, panel, text, muted, accent_dash, warn, stroke, card_fill);
+    ui_panel_style_t card_style = dash_v2_card_style(m, l, panel, card_fill);
+    ui_draw_panel(ctx, l->speed, &card_style);
+    dash_v2_render_speed_inner(ctx, m, l, panel, text, muted, accent_dash, warn, stroke, card_fill, 0u);
 
     /* ===== Bottom stats tray (4-column compact row) ===== */
-    ui_draw_panel(ctx, l.tray, &card_style);
-    dash_v2_render_tray_inner(ctx, m, &l, dist_d10, wh_d10, text, muted, stroke, accent_dash, card_fill);
+    ui_draw_panel(ctx, l->tray, &card_style);
+    dash_v2_render_tray_inner(ctx, m, l, dist_d10, wh_d10, text, muted, stroke, accent_dash, card_fill, 0u);
 }
 
 static void render_focus(ui_render_ctx_t *ctx, const ui_model_t *m,
@@ -1807,38 +2768,24 @@ typedef struct {
     ui_rect_t graph;
     ui_rect_t graph_dirty;
     ui_rect_t plot;
+    ui_rect_t sweep;        /* plot columns the strip chart may use */
+    ui_rect_t label_min;
+    ui_rect_t label_max;
 } ui_graph_layout_t;
 
-static ui_graph_layout_t graph_layout(void)
-{
-    ui_graph_layout_t l = {0};
-    l.full = (ui_rect_t){0, 0, DISP_W, DISP_H};
-    l.header = (ui_rect_t){0, TOP_Y, DISP_W, TOP_H};
-
-    uint16_t y = (uint16_t)(TOP_Y + TOP_H + G);
-    l.chip_channel = (ui_rect_t){PAD, y, 72u, 24u};
-    l.chip_window = (ui_rect_t){(uint16_t)(PAD + 80u), y, 72u, 24u};
-    l.chip_hz = (ui_rect_t){(uint16_t)(PAD + 160u), y, 72u, 24u};
-    l.graph = (ui_rect_t){PAD, (uint16_t)(y + 32u), (uint16_t)(DISP_W - 2u * PAD), 208u};
-    l.graph_dirty = l.graph;
-
-    if (l.graph_dirty.x + l.graph_dirty.w + 2u <= DISP_W)
-        l.graph_dirty.w = (uint16_t)(l.graph_dirty.w + 2u);
-    else
-        l.graph_dirty.w = (uint16_t)(DISP_W - l.graph_dirty.x);
-    if (l.graph_dirty.y + l.graph_dirty.h + 2u <= DISP_H)
-        l.graph_dirty.h = (uint16_t)(l.graph_dirty.h + 2u);
-    else
-        l.graph_dirty.h = (uint16_t)(DISP_H - l.graph_dirty.y);
-
-    l.plot = inset_rect(l.graph, 10u);
-    if (l.plot.h > 28u)
-    {
-        l.plot.y = (uint16_t)(l.plot.y + 8u);
-        l.plot.h = (uint16_t)(l.plot.h - 16u);
-    }
-    return l;
-}
+static const ui_graph_layout_t k_graph_layout = {
+    .full = UI_RECT_FULL,
+    .header = UI_RECT_GRAPH_HEADER,
+    .chip_channel = UI_RECT_GRAPH_CHIP_CHANNEL,
+    .chip_window = UI_RECT_GRAPH_CHIP_WINDOW,
+    .chip_hz = UI_RECT_GRAPH_CHIP_HZ,
+    .graph = UI_RECT_GRAPH_BOX,
+    .graph_dirty = UI_RECT_GRAPH_DIRTY,
+    .plot = UI_RECT_GRAPH_PLOT,
+    .sweep = UI_RECT_GRAPH_SWEEP,
+    .label_min = UI_RECT_GRAPH_LABEL_MIN,
+    .label_max = UI_RECT_GRAPH_LABEL_MAX,
+};
 
 static const char *graph_channel_label(uint8_t channel)
 {
@@ -1883,7 +2830,122 @@ static void render_graph_hz_chip(ui_render_ctx_t *ctx, const ui_model_t *m,
                   (uint16_t)(l->chip_hz.y + 6u), "HZ", m->graph_sample_hz, text, panel);
 }
 
-static void render_graph_panel(ui_render_ctx_t *ctx, const ui_graph_layout_t *l,
+/* Axis labels in the chip's unit: speed is sampled in 0.1 mph. */
+static int32_t graph_label_value(uint8_t channel, int16_t v)
+{
+    return (channel == UI_GRAPH_CH_SPEED) ? (int32_t)v / 10 : (int32_t)v;
+}
+
+/*
+ * The strip chart sweeps: column number graph_pos lands at sweep offset
+ * graph_pos % width, so a new sample redraws a few columns at the cursor
+ * instead of shifting the whole plot. GRAPH_SWEEP_GAP blank columns mark
+ * the cursor. (ST7789 hardware scrolling only runs along the 320-line axis;
+ * the time axis here is the 240 px one.)
+ */
+#define GRAPH_SWEEP_GAP 3u
+
+typedef struct {
+    int32_t lo;
+    int32_t hi;
+} ui_graph_scale_t;
+
+static uint16_t graph_visible_cols(const ui_model_t *m, uint16_t width)
+{
+    uint16_t n = (m->graph_cols > UI_GRAPH_COLS) ? UI_GRAPH_COLS : m->graph_cols;
+    uint16_t room = (width > GRAPH_SWEEP_GAP) ? (uint16_t)(width - GRAPH_SWEEP_GAP) : 0u;
+    return (n > room) ? room : n;
+}
+
+/* Column shown at sweep offset o; 0 for a blank one. */
+static uint8_t graph_column_at(const ui_model_t *m, uint16_t width, uint16_t o,
+                               int16_t *lo, int16_t *hi)
+{
+    uint16_t count = graph_visible_cols(m, width);
+    uint16_t d = (uint16_t)(((m->graph_pos % width) + width - o) % width);
+    if (d >= count)
+        return 0u;
+    uint16_t i = (uint16_t)(m->graph_cols - 1u - d);
+    *lo = m->graph_min[i];
+    *hi = m->graph_max[i];
+    return 1u;
+}
+
+static int32_t floor_div_i32(int32_t a, int32_t b)
+{
+    int32_t q = a / b;
+    return (a % b != 0 && a < 0) ? q - 1 : q;
+}
+
+/* Data range snapped to a power-of-two step near a quarter of the span, so
+ * the scale (and with it the whole plot) only changes when the data moves
+ * past a grid step, not on every new sample. */
+static ui_graph_scale_t graph_scale(const ui_model_t *m, uint16_t width)
+{
+    ui_graph_scale_t sc = {0, 1};
+    uint16_t count = graph_visible_cols(m, width);
+    if (count == 0u)
+        return sc;
+    int32_t mn = INT32_MAX;
+    int32_t mx = INT32_MIN;
+    for (uint16_t i = (uint16_t)(m->graph_cols - count); i < m->graph_cols; ++i)
+    {
+        if (m->graph_min[i] < mn)
+            mn = m->graph_min[i];
+        if (m->graph_max[i] > mx)
+            mx = m->graph_max[i];
+    }
+    int32_t q = 1;
+    while (q * 4 < mx - mn)
+        q <<= 1;
+    sc.lo = floor_div_i32(mn, q) * q;
+    sc.hi = -floor_div_i32(-mx, q) * q;
+    if (sc.hi <= sc.lo)
+        sc.hi = sc.lo + q;
+    return sc;
+}
+
+/* One sweep column: background, grid pixels, then the min..max span. */
+static void render_graph_column(ui_render_ctx_t *ctx, const ui_model_t *m,
+                                const ui_graph_layout_t *l, ui_graph_scale_t sc,
+                                uint16_t o, uint8_t clear,
+                                uint16_t card_fill, uint16_t stroke, uint16_t span_color)
+{
+    uint16_t x = (uint16_t)(l->sweep.x + o);
+    if (clear)
+    {
+        ui_draw_rect(ctx, (ui_rect_t){x, l->plot.y, 1u, l->plot.h}, card_fill);
+        for (uint8_t i = 1u; i <= 3u; ++i)
+        {
+            uint16_t gy = (uint16_t)(l->plot.y + (uint16_t)((uint32_t)l->plot.h * (uint32_t)i / 4u));
+            ui_draw_rect(ctx, (ui_rect_t){x, gy, 1u, 1u}, stroke);
+        }
+    }
+    int16_t lo;
+    int16_t hi;
+    if (!graph_column_at(m, l->sweep.w, o, &lo, &hi))
+        return;
+    uint32_t range = (uint32_t)(sc.hi - sc.lo);
+    uint32_t plot_h = (l->plot.h > 2u) ? (uint32_t)(l->plot.h - 2u) : 0u;
+    uint16_t y_lo = (uint16_t)((uint32_t)((int32_t)lo - sc.lo) * plot_h / range);
+    uint16_t y_hi = (uint16_t)((uint32_t)((int32_t)hi - sc.lo) * plot_h / range);
+    uint16_t base_y = (uint16_t)(l->plot.y + l->plot.h - 1u);
+    ui_draw_rect(ctx, (ui_rect_t){x, (uint16_t)(base_y - y_hi), 1u, (uint16_t)(y_hi - y_lo + 1u)},
+                 span_color);
+}
+
+static void render_graph_labels(ui_render_ctx_t *ctx, const ui_model_t *m,
+                                const ui_graph_layout_t *l, ui_graph_scale_t sc,
+                                uint16_t muted, uint16_t card_fill)
+{
+    ui_draw_value(ctx, l->label_min.x, l->label_min.y, "MIN",
+                  graph_label_value(m->graph_channel, (int16_t)sc.lo), muted, card_fill);
+    ui_draw_value(ctx, l->label_max.x, l->label_max.y, "MAX",
+                  graph_label_value(m->graph_channel, (int16_t)sc.hi), muted, card_fill);
+}
+
+static void render_graph_panel(ui_render_ctx_t *ctx, const ui_model_t *m,
+                               const ui_graph_layout_t *l,
                                const ui_panel_style_t *card,
                                uint16_t card_fill, uint16_t stroke,
                                uint16_t accent, uint16_t muted)
@@ -1897,53 +2959,37 @@ static void render_graph_panel(ui_render_ctx_t *ctx, const ui_graph_layout_t *l,
         ui_draw_rect(ctx, (ui_rect_t){l->plot.x, gy, l->plot.w, 1u}, stroke);
     }
 
-    uint16_t min = 0xFFFFu;
-    uint16_t max = 0u;
-    uint8_t count = (ctx && ctx->ui) ? ctx->ui->graph_count : 0u;
-    uint8_t start = 0u;
-    if (ctx && ctx->ui && count)
-        start = (uint8_t)((ctx->ui->graph_head + UI_GRAPH_SAMPLES - count) % UI_GRAPH_SAMPLES);
-
-    for (uint8_t i = 0; i < count; ++i)
-    {
-        uint16_t v = ctx->ui->graph_samples[(uint8_t)((start + i) % UI_GRAPH_SAMPLES)];
-        if (v < min)
-            min = v;
-        if (v > max)
-            max = v;
-    }
-    if (count == 0u)
-    {
-        min = 0u;
-        max = 1u;
-    }
-    if (max == min)
-        max = (uint16_t)(min + 1u);
+    /* One vertical min..max span per pixel column: peaks survive any window
+     * length and the cost follows the panel width, not the sample count. */
+    ui_graph_scale_t sc = graph_scale(m, l->sweep.w);
+    const uint16_t span_color = rgb565_lerp(card_fill, accent, 220u);
+    for (uint16_t o = 0; o < l->sweep.w; ++o)
+        render_graph_column(ctx, m, l, sc, o, 0u, card_fill, stroke, span_color);
 
-    uint16_t step = 1u;
-    if (count > 1u && l->plot.w > 6u)
-        step = (uint16_t)((l->plot.w - 6u) / (uint16_t)(count - 1u));
-    if (step == 0u)
-        step = 1u;
+    render_graph_labels(ctx, m, l, sc, muted, card_fill);
+}
 
-    const uint16_t bar_color = rgb565_lerp(card_fill, accent, 220u);
-    for (uint8_t i = 0; i < count; ++i)
+/* Redraw only the sweep columns in the dirty set, then any label they (or
+ * the dirty set) touched, since the labels overlap the plot. */
+static void render_graph_columns(ui_render_ctx_t *ctx, const ui_model_t *m,
+                                 const ui_graph_layout_t *l, const ui_dirty_t *dirty,
+                                 uint16_t card_fill, uint16_t stroke,
+                                 uint16_t accent, uint16_t muted)
+{
+    ui_graph_scale_t sc = graph_scale(m, l->sweep.w);
+    const uint16_t span_color = rgb565_lerp(card_fill, accent, 220u);
+    uint8_t labels = (rect_dirty(dirty, l->label_min) || rect_dirty(dirty, l->label_max)) ? 1u : 0u;
+    for (uint16_t o = 0; o < l->sweep.w; ++o)
     {
-        uint16_t v = ctx->ui->graph_samples[(uint8_t)((start + i) % UI_GRAPH_SAMPLES)];
-        uint16_t h = (uint16_t)((uint32_t)(v - min) * (l->plot.h - 2u) / (uint32_t)(max - min));
-        ui_rect_t bar = {
-            (uint16_t)(l->plot.x + 2u + i * step),
-            (uint16_t)(l->plot.y + l->plot.h - 1u - h),
-            2u,
-            (uint16_t)(h ? h : 1u)
-        };
-        if (bar.x + bar.w < l->plot.x + l->plot.w - 1u)
-            ui_draw_rect(ctx, bar, bar_color);
+        ui_rect_t col = {(uint16_t)(l->sweep.x + o), l->plot.y, 1u, l->plot.h};
+        if (!rect_dirty(dirty, col))
+            continue;
+        render_graph_column(ctx, m, l, sc, o, 1u, card_fill, stroke, span_color);
+        if (rect_intersects(col, l->label_min) || rect_intersects(col, l->label_max))
+            labels = 1u;
     }
-
-    /* Corner labels. */
-    ui_draw_value(ctx, (uint16_t)(l->graph.x + 12u), (uint16_t)(l->graph.y + l->graph.h - 20u), "MIN", min, muted, card_fill);
-    ui_draw_value(ctx, (uint16_t)(l->graph.x + l->graph.w - 72u), (uint16_t)(l->graph.y + 10u), "MAX", max, muted, card_fill);
+    if (labels)
+        render_graph_labels(ctx, m, l, sc, muted, card_fill);
 }
 
 static void render_graphs(ui_render_ctx_t *ctx, const ui_model_t *m,
@@ -1951,7 +2997,7 @@ static void render_graphs(ui_render_ctx_t *ctx, const ui_model_t *m,
 {
     (void)dist_d10;
     (void)wh_d10;
-    ui_graph_layout_t l = graph_layout();
+    const ui_graph_layout_t *l = &k_graph_layout;
     const uint16_t bgc = ui_color(ctx, UI_COLOR_BG);
     const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
     const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
@@ -1959,9 +3005,9 @@ static void render_graphs(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t stroke = rgb565_dim(muted);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
 
-    ui_draw_rect(ctx, l.full, bgc);
+    ui_draw_rect(ctx, l->full, bgc);
     render_header_icon(ctx, "GRAPHS", UI_ICON_GRAPH);
 
     ui_panel_style_t card = {
@@ -1974,10 +3020,10 @@ static void render_graphs(ui_render_ctx_t *ctx, const ui_model_t *m,
         .shadow = shadow,
     };
 
-    render_graph_channel_chip(ctx, m, &l, bgc, panel, accent);
-    render_graph_window_chip(ctx, m, &l, text, panel);
-    render_graph_hz_chip(ctx, m, &l, text, panel);
-    render_graph_panel(ctx, &l, &card, card_fill, stroke, accent, muted);
+    render_graph_channel_chip(ctx, m, l, bgc, panel, accent);
+    render_graph_window_chip(ctx, m, l, text, panel);
+    render_graph_hz_chip(ctx, m, l, text, panel);
+    render_graph_panel(ctx, m, l, &card, card_fill, stroke, accent, muted);
 }
 
 static void draw_trip_card(ui_render_ctx_t *ctx, ui_rect_t r, const ui_panel_style_t *card,
@@ -2005,11 +3051,32 @@ static void render_trip_summary(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     const uint16_t stroke = rgb565_dim(muted);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
-    render_header_icon(ctx, "TRIP", UI_ICON_TRIP);
+    char buf[16];
+    if (m->trip_view)
+    {
+        /* A stored ride: "RIDE -n", n rides back. */
+        char num[6];
+        fmt_u32(num, sizeof(num), (uint32_t)m->trip_view);
+        size_t i = 0u;
+        const char *pre = "RIDE -";
+        while (pre[i])
+        {
+            buf[i] = pre[i];
+            i++;
+        }
+        for (size_t j = 0u; num[j] && (i + 1u) < sizeof(buf); ++j)
+            buf[i++] = num[j];
+        buf[i] = 0;
+        render_header_icon(ctx, buf, UI_ICON_TRIP);
+    }
+    else
+    {
+        render_header_icon(ctx, "TRIP", UI_ICON_TRIP);
+    }
 
     ui_panel_style_t card = {
         .radius = 10u,
@@ -2038,32 +3105,49 @@ static void render_trip_summary(ui_render_ctx_t *ctx, const ui_model_t *m,
     ui_rect_t r3l = {PAD, (uint16_t)(y + 3u * (ch + gap)), cw, ch};
     ui_rect_t r3r = {(uint16_t)(PAD + cw + gap), (uint16_t)(y + 3u * (ch + gap)), cw, ch};
 
-    char buf[16];
-    fmt_d10(buf, sizeof(buf), (int32_t)dist_d10);
-    draw_trip_card(ctx, r0l, &card, "DIST", buf, dist_unit, text, muted, stroke, card_fill);
+    draw_trip_card(ctx, r0l, &card, "DIST",
+                   fmt_at(ctx, r0l.x, r0l.y, UI_FMT_D10, (uint32_t)dist_d10, 0u, NULL),
+                   dist_unit, text, muted, stroke, card_fill);
 
-    fmt_time_hhmm(buf, sizeof(buf), m->trip_moving_ms);
-    draw_trip_card(ctx, r0r, &card, "MOVE", buf, NULL, text, muted, stroke, card_fill);
+    draw_trip_card(ctx, r0r, &card, "MOVE",
+                   fmt_at(ctx, r0r.x, r0r.y, UI_FMT_HHMM, m->trip_moving_ms, 0u, NULL),
+                   NULL, text, muted, stroke, card_fill);
 
-    fmt_d10(buf, sizeof(buf), (int32_t)m->trip_avg_speed_dmph);
-    draw_trip_card(ctx, r1l, &card, "AVG", buf, speed_unit, text, muted, stroke, card_fill);
+    draw_trip_card(ctx, r1l, &card, "AVG",
+                   fmt_at(ctx, r1l.x, r1l.y, UI_FMT_D10, (uint32_t)m->trip_avg_speed_dmph, 0u, NULL),
+                   speed_unit, text, muted, stroke, card_fill);
 
-    fmt_d10(buf, sizeof(buf), (int32_t)m->trip_max_speed_dmph);
-    draw_trip_card(ctx, r1r, &card, "MAX", buf, speed_unit, text, muted, stroke, card_fill);
+    draw_trip_card(ctx, r1r, &card, "MAX",
+                   fmt_at(ctx, r1r.x, r1r.y, UI_FMT_D10, (uint32_t)m->trip_max_speed_dmph, 0u, NULL),
+                   speed_unit, text, muted, stroke, card_fill);
 
     {
         int32_t wh_d10_local = (int32_t)((uint32_t)m->trip_energy_mwh / 100u);
-        fmt_d10(buf, sizeof(buf), wh_d10_local);
-        draw_trip_card(ctx, r2l, &card, "ENERGY", buf, "Wh", text, muted, stroke, card_fill);
+        draw_trip_card(ctx, r2l, &card, "ENERGY",
+                       fmt_at(ctx, r2l.x, r2l.y, UI_FMT_D10, (uint32_t)wh_d10_local, 0u, NULL),
+                       "Wh", text, muted, stroke, card_fill);
     }
 
-    fmt_d10(buf, sizeof(buf), (int32_t)wh_d10);
-    draw_trip_card(ctx, r2r, &card, eff_label, buf, NULL, text, muted, stroke, card_fill);
+    draw_trip_card(ctx, r2r, &card, eff_label,
+                   fmt_at(ctx, r2r.x, r2r.y, UI_FMT_D10, (uint32_t)wh_d10, 0u, NULL),
+                   NULL, text, muted, stroke, card_fill);
 
-    fmt_time_hhmm(buf, sizeof(buf), m->trip_assist_ms);
-    draw_trip_card(ctx, r3l, &card, "ASSIST", buf, NULL, text, muted, stroke, card_fill);
+    if (m->trip_view)
+    {
+        /* Stored rides keep no assist/gear split; show total time and p95 speed. */
+        draw_trip_card(ctx, r3l, &card, "TIME",
+                       fmt_at(ctx, r3l.x, r3l.y, UI_FMT_HHMM, m->trip_elapsed_ms, 0u, NULL),
+                       NULL, text, muted, stroke, card_fill);
+        draw_trip_card(ctx, r3r, &card, "P95",
+                       fmt_at(ctx, r3r.x, r3r.y, UI_FMT_D10, (uint32_t)m->trip_p95_speed_dmph, 0u, NULL),
+                       speed_unit, text, muted, stroke, card_fill);
+        return;
+    }
+
+    draw_trip_card(ctx, r3l, &card, "ASSIST",
+                   fmt_at(ctx, r3l.x, r3l.y, UI_FMT_HHMM, m->trip_assist_ms, 0u, NULL),
+                   NULL, text, muted, stroke, card_fill);
 
-    fmt_time_hhmm(buf, sizeof(buf), m->trip_gear_ms);
     {
         char gear_unit[8];
         char gear_num[6];
@@ -2076,7 +3160,9 @@ static void render_trip_summary(ui_render_ctx_t *ctx, const ui_model_t *m,
             i++;
         }
         gear_unit[i + 1u] = 0;
-        draw_trip_card(ctx, r3r, &card, "GEAR", buf, gear_unit, text, muted, stroke, card_fill);
+        draw_trip_card(ctx, r3r, &card, "GEAR",
+                       fmt_at(ctx, r3r.x, r3r.y, UI_FMT_HHMM, m->trip_gear_ms, 0u, NULL),
+                       gear_unit, text, muted, stroke, card_fill);
     }
 }
 
@@ -2091,7 +3177,7 @@ static void render_profiles(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
     const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
     render_header_icon(ctx, "PROFILES", UI_ICON_PROFILE);
@@ -2200,10 +3286,9 @@ static void render_settings(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
     const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
-    const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t stroke = rgb565_dim(muted);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
     render_header_icon(ctx, "SETTINGS", UI_ICON_SETTINGS);
@@ -2223,7 +3308,7 @@ static void render_settings(ui_render_ctx_t *ctx, const ui_model_t *m,
     ui_rect_t list = {PAD, y, (uint16_t)(DISP_W - 2u * PAD), 212u};
     ui_draw_panel(ctx, list, &card);
 
-    const uint16_t sel_fill = rgb565_lerp(card_fill, accent, 28u);
+    const uint16_t sel_fill = ui_tint(ctx, UI_TINT_SEL);
     const uint8_t count = UI_SETTINGS_ITEM_COUNT;
     const uint16_t row_h = 28u;
     const uint16_t row_pitch = 32u;
@@ -2296,7 +3381,7 @@ static void render_cruise(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t warn = ui_color(ctx, UI_COLOR_WARN);
     const uint16_t ok = ui_color(ctx, UI_COLOR_OK);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
     render_header_icon(ctx, "CRUISE", UI_ICON_CRUISE);
@@ -2352,33 +3437,7 @@ static void render_cruise(ui_render_ctx_t *ctx, const ui_model_t *m,
     uint16_t dx0 = (hero.w > total) ? (uint16_t)(hero.x + (hero.w - total) / 2u) : hero.x;
     uint16_t dy0 = (uint16_t)(hero.y + 56u);
 
-    uint16_t digit_shadow = rgb565_dim(accent);
-    uint16_t sx = (uint16_t)(dx0 + 2u);
-    uint16_t sy = (uint16_t)(dy0 + 2u);
-    if (digits == 3u)
-    {
-        ui_draw_big_digit(ctx, sx, sy, (uint8_t)(spd / 100u), scale, digit_shadow);
-        sx = (uint16_t)(sx + dw + gap);
-    }
-    if (digits >= 2u)
-    {
-        ui_draw_big_digit(ctx, sx, sy, (uint8_t)((spd / 10u) % 10u), scale, digit_shadow);
-        sx = (uint16_t)(sx + dw + gap);
-    }
-    ui_draw_big_digit(ctx, sx, sy, (uint8_t)(spd % 10u), scale, digit_shadow);
-
-    uint16_t dx = dx0;
-    if (digits == 3u)
-    {
-        ui_draw_big_digit(ctx, dx, dy0, (uint8_t)(spd / 100u), scale, accent);
-        dx = (uint16_t)(dx + dw + gap);
-    }
-    if (digits >= 2u)
-    {
-        ui_draw_big_digit(ctx, dx, dy0, (uint8_t)((spd / 10u) % 10u), scale, accent);
-        dx = (uint16_t)(dx + dw + gap);
-    }
-    ui_draw_big_digit(ctx, dx, dy0, (uint8_t)(spd % 10u), scale, accent);
+    ui_draw_big_number(ctx, dx0, dy0, spd, digits, scale, (uint16_t)(dw + gap), accent, card_fill, 0x7u);
 
     /* Resume reason (friendly label) */
     const char *reason = "OK";
@@ -2413,7 +3472,7 @@ static void render_battery_screen(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t warn = ui_color(ctx, UI_COLOR_WARN);
     const uint16_t danger = ui_color(ctx, UI_COLOR_DANGER);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     const uint16_t stroke = rgb565_dim(muted);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
@@ -2443,7 +3502,7 @@ static void render_battery_screen(ui_render_ctx_t *ctx, const ui_model_t *m,
         soc_color = danger;
     else if (soc < 40u)
         soc_color = warn;
-    uint16_t inactive = rgb565_lerp(card_fill, muted, 64u);
+    uint16_t inactive = ui_tint(ctx, UI_TINT_GAUGE_OFF);
     ui_rect_t clip = inset_rect(hero, 6u);
     int16_t cx = (int16_t)(hero.x + 62u);
     int16_t cy = (int16_t)(hero.y + 74u);
@@ -2462,47 +3521,9 @@ static void render_battery_screen(ui_render_ctx_t *ctx, const ui_model_t *m,
     uint16_t total = (uint16_t)(sd * dw + (sd - 1u) * gap);
     uint16_t dx0 = (uint16_t)((int)cx - (int)total / 2);
     uint16_t dy0 = (uint16_t)((int)cy - 18);
-    uint16_t digit_shadow = rgb565_dim(soc_color);
-    uint16_t sx = (uint16_t)(dx0 + 2u);
-    uint16_t sy = (uint16_t)(dy0 + 2u);
-    if (sd == 3u)
-    {
-        ui_draw_big_digit(ctx, sx, sy, 1u, scale, digit_shadow);
-        sx = (uint16_t)(sx + dw + gap);
-        ui_draw_big_digit(ctx, sx, sy, 0u, scale, digit_shadow);
-        sx = (uint16_t)(sx + dw + gap);
-        ui_draw_big_digit(ctx, sx, sy, 0u, scale, digit_shadow);
-    }
-    else if (sd == 2u)
-    {
-        ui_draw_big_digit(ctx, sx, sy, (uint8_t)(soc / 10u), scale, digit_shadow);
-        sx = (uint16_t)(sx + dw + gap);
-        ui_draw_big_digit(ctx, sx, sy, (uint8_t)(soc % 10u), scale, digit_shadow);
-    }
-    else
-    {
-        ui_draw_big_digit(ctx, sx, sy, (uint8_t)(soc % 10u), scale, digit_shadow);
-    }
-
-    uint16_t dx = dx0;
-    if (sd == 3u)
-    {
-        ui_draw_big_digit(ctx, dx, dy0, 1u, scale, soc_color);
-        dx = (uint16_t)(dx + dw + gap);
-        ui_draw_big_digit(ctx, dx, dy0, 0u, scale, soc_color);
-        dx = (uint16_t)(dx + dw + gap);
-        ui_draw_big_digit(ctx, dx, dy0, 0u, scale, soc_color);
-    }
-    else if (sd == 2u)
-    {
-        ui_draw_big_digit(ctx, dx, dy0, (uint8_t)(soc / 10u), scale, soc_color);
-        dx = (uint16_t)(dx + dw + gap);
-        ui_draw_big_digit(ctx, dx, dy0, (uint8_t)(soc % 10u), scale, soc_color);
-    }
-    else
-    {
-        ui_draw_big_digit(ctx, dx, dy0, (uint8_t)(soc % 10u), scale, soc_color);
-    }
+    /* Three digits only ever show 100. */
+    ui_draw_big_number(ctx, dx0, dy0, (sd == 3u) ? 100u : soc, sd, scale, (uint16_t)(dw + gap), soc_color, card_fill,
+                       0x7u);
     ui_draw_text(ctx, (uint16_t)(dx0 + total + 4u), (uint16_t)(dy0 + 22u), "%", muted, card_fill);
 
     /* Right-side stats */
@@ -2519,10 +3540,10 @@ static void render_battery_screen(ui_render_ctx_t *ctx, const ui_model_t *m,
     ui_draw_panel(ctx, bottom, &card);
     ui_draw_text(ctx, (uint16_t)(bottom.x + 12u), (uint16_t)(bottom.y + 10u), "RANGE", muted, card_fill);
     {
-        char buf[16];
-        fmt_d10(buf, sizeof(buf), (int32_t)m->range_est_d10);
-        ui_draw_text(ctx, (uint16_t)(bottom.x + 12u), (uint16_t)(bottom.y + 30u), buf, text, card_fill);
-        ui_draw_text(ctx, (uint16_t)(bottom.x + 72u), (uint16_t)(bottom.y + 30u), m->units ? "KM" : "MI", muted, card_fill);
+        uint16_t vx = (uint16_t)(bottom.x + 12u);
+        uint16_t vy = (uint16_t)(bottom.y + 30u);
+        ui_draw_text(ctx, vx, vy, fmt_at(ctx, vx, vy, UI_FMT_D10, m->range_est_d10, 0u, NULL), text, card_fill);
+        ui_draw_text(ctx, (uint16_t)(bottom.x + 72u), vy, m->units ? "KM" : "MI", muted, card_fill);
     }
     ui_draw_value(ctx, (uint16_t)(bottom.x + bottom.w - 96u), (uint16_t)(bottom.y + 10u), "SAG dV", m->sag_margin_dV, muted, card_fill);
     /* Confidence bar (5 ticks) */
@@ -2553,7 +3574,7 @@ static void render_thermal(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t warn = ui_color(ctx, UI_COLOR_WARN);
     const uint16_t danger = ui_color(ctx, UI_COLOR_DANGER);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     const uint16_t stroke = rgb565_dim(muted);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
@@ -2596,14 +3617,14 @@ static void render_thermal(ui_render_ctx_t *ctx, const ui_model_t *m,
     uint16_t thick = 14u;
     uint16_t sweep = 300u;
     uint16_t active_sweep = (uint16_t)((uint32_t)sweep * pct / 100u);
-    uint16_t inactive = rgb565_lerp(card_fill, muted, 64u);
+    uint16_t inactive = ui_tint(ctx, UI_TINT_GAUGE_OFF);
     ui_draw_ring_gauge(ctx, clip, cx, cy, outer_r, thick, 210, sweep, active_sweep,
                        rgb565_lerp(card_fill, tcol, 220u), inactive, card_fill);
 
     /* Temperature readout (center) */
     {
-        char buf[16];
-        fmt_d10(buf, sizeof(buf), (int32_t)m->ctrl_temp_dC);
+        /* Centred on the gauge, so keyed by the hero card's corner. */
+        const char *buf = fmt_at(ctx, hero.x, hero.y, UI_FMT_D10, (uint32_t)(int32_t)m->ctrl_temp_dC, 0u, NULL);
         uint16_t tw = txt_w_est(buf);
         uint16_t tx = (tw < 96u) ? (uint16_t)((int)cx - (int)tw / 2) : hero.x;
         ui_draw_text(ctx, tx, (uint16_t)(hero.y + 60u), buf, tcol, card_fill);
@@ -2726,13 +3747,6 @@ const char *ui_diagnostics_row_label(size_t index)
 }
 #endif
 
-static ui_rect_t diagnostics_row_rect(uint8_t idx)
-{
-    uint16_t base_y = (uint16_t)(TOP_Y + TOP_H + G);
-    uint16_t ry = (uint16_t)(base_y + DIAG_ROW_OFFSET_Y + (uint16_t)idx * DIAG_ROW_H);
-    return (ui_rect_t){PAD, ry, (uint16_t)(DISP_W - 2u * PAD), DIAG_ROW_H};
-}
-
 static void render_diagnostics(ui_render_ctx_t *ctx, const ui_model_t *m,
                                uint16_t dist_d10, uint16_t wh_d10)
 {
@@ -2744,7 +3758,7 @@ static void render_diagnostics(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
     const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     const uint16_t stroke = rgb565_dim(muted);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
@@ -2805,12 +3819,10 @@ static void render_diagnostics_partial(ui_render_ctx_t *ctx, const ui_model_t *m
 
     (void)dist_d10;
     (void)wh_d10;
-    const uint16_t bgc = ui_color(ctx, UI_COLOR_BG);
-    const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
     const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
     const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
 
     uint16_t base_y = (uint16_t)(TOP_Y + TOP_H + G);
     uint16_t box_h = (uint16_t)(DIAG_ROW_OFFSET_Y + (uint16_t)(DIAG_ROW_COUNT * DIAG_ROW_H));
@@ -2823,10 +3835,11 @@ static void render_diagnostics_partial(ui_render_ctx_t *ctx, const ui_model_t *m
 
     for (uint8_t i = 0; i < DIAG_ROW_COUNT; ++i)
     {
-        ui_rect_t row = diagnostics_row_rect(i);
+        ui_rect_t row = k_ui_widgets[UI_W_DIAG_ROW_0 + i];
         if (!rect_dirty(dirty, row))
             continue;
         uint16_t val_color = diagnostics_value_color(m, i, text, accent);
+        ui_clip_push(ctx, row);
         ui_draw_rect(ctx, row, card_fill);
         ui_draw_text(ctx, label_x, (uint16_t)(row.y + DIAG_ROW_TEXT_Y), rows[i].label, muted, card_fill);
         if (i == DIAG_ROW_BTN_IDX || i == DIAG_ROW_ERR_IDX)
@@ -2840,9 +3853,52 @@ static void render_diagnostics_partial(ui_render_ctx_t *ctx, const ui_model_t *m
         {
             ui_draw_value(ctx, value_x, (uint16_t)(row.y + DIAG_ROW_TEXT_Y), "", rows[i].value, val_color, card_fill);
         }
+        ui_clip_pop(ctx);
     }
 }
 
+static void render_bus_count(ui_render_ctx_t *ctx, const ui_model_t *m, uint16_t text, uint16_t card_fill)
+{
+    ui_draw_value(ctx, PAD + 92u, BUS_TOP_Y + 10u, "CNT", m->bus_count, text, card_fill);
+}
+
+/* Last frame summary */
+static void render_bus_last(ui_render_ctx_t *ctx, const ui_model_t *m, uint16_t text, uint16_t muted,
+                            uint16_t card_fill)
+{
+    ui_draw_value(ctx, PAD + 12u, BUS_TOP_Y + 38u, "ID", m->bus_last_id, text, card_fill);
+    ui_draw_value(ctx, PAD + 60u, BUS_TOP_Y + 38u, "OP", m->bus_last_opcode, text, card_fill);
+    ui_draw_value(ctx, PAD + 112u, BUS_TOP_Y + 38u, "LEN", m->bus_last_len, text, card_fill);
+    ui_draw_value(ctx, PAD + 164u, BUS_TOP_Y + 38u, "DT", m->bus_last_dt_ms, muted, card_fill);
+}
+
+/* Opcode row `i` and the rule under it when another row follows. */
+static void render_bus_row(ui_render_ctx_t *ctx, const ui_model_t *m, uint8_t i, uint16_t text, uint16_t muted,
+                           uint16_t card_fill, uint16_t stroke)
+{
+    ui_rect_t row = {PAD + 10u, (uint16_t)BUS_ROW_Y(i), DISP_W - 2u * PAD - 20u, 16u};
+    ui_draw_rect(ctx, row, card_fill);
+    ui_draw_value(ctx, row.x, (uint16_t)(row.y + 2u), "ID", m->bus_list_id[i], text, card_fill);
+    ui_draw_value(ctx, (uint16_t)(row.x + 48u), (uint16_t)(row.y + 2u), "OP", m->bus_list_op[i], text, card_fill);
+    ui_draw_value(ctx, (uint16_t)(row.x + 104u), (uint16_t)(row.y + 2u), "L", m->bus_list_len[i], text, card_fill);
+    ui_draw_value(ctx, (uint16_t)(row.x + 136u), (uint16_t)(row.y + 2u), "DT", m->bus_list_dt_ms[i], muted, card_fill);
+    if (i + 1u < m->bus_entries)
+        ui_draw_rect(ctx, (ui_rect_t){row.x, (uint16_t)(row.y + 16u), row.w, 1u}, stroke);
+}
+
+static void render_bus_link(ui_render_ctx_t *ctx, const ui_model_t *m, uint16_t text, uint16_t muted,
+                            uint16_t accent, uint16_t card_fill)
+{
+    ui_draw_value(ctx, PAD + 12u, BUS_LINK_Y + 8u, "CRC", m->link_crc_errors,
+                  m->link_crc_errors ? accent : text, card_fill);
+    ui_draw_value(ctx, PAD + 64u, BUS_LINK_Y + 8u, "FRM", m->link_frame_errors,
+                  m->link_frame_errors ? accent : text, card_fill);
+    ui_draw_value(ctx, PAD + 116u, BUS_LINK_Y + 8u, "DN", m->link_outages,
+                  m->link_outages ? accent : text, card_fill);
+    ui_draw_value(ctx, PAD + 160u, BUS_LINK_Y + 8u, "HZ", (int32_t)(m->link_rate_x10 / 10u),
+                  muted, card_fill);
+}
+
 static void render_bus(ui_render_ctx_t *ctx, const ui_model_t *m,
                        uint16_t dist_d10, uint16_t wh_d10)
 {
@@ -2854,7 +3910,7 @@ static void render_bus(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
     const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     const uint16_t stroke = rgb565_dim(muted);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
@@ -2875,18 +3931,14 @@ static void render_bus(ui_render_ctx_t *ctx, const ui_model_t *m,
     ui_rect_t top = {PAD, y, (uint16_t)(DISP_W - 2u * PAD), 96u};
     ui_draw_panel(ctx, top, &card);
     ui_draw_text(ctx, (uint16_t)(top.x + 12u), (uint16_t)(top.y + 10u), "FRAMES", muted, card_fill);
-    ui_draw_value(ctx, (uint16_t)(top.x + 92u), (uint16_t)(top.y + 10u), "CNT", m->bus_count, text, card_fill);
+    render_bus_count(ctx, m, text, card_fill);
     ui_draw_rect(ctx, (ui_rect_t){(uint16_t)(top.x + 12u), (uint16_t)(top.y + 30u), (uint16_t)(top.w - 24u), 1u}, stroke);
 
-    /* Last frame summary */
-    ui_draw_value(ctx, (uint16_t)(top.x + 12u), (uint16_t)(top.y + 38u), "ID", m->bus_last_id, text, card_fill);
-    ui_draw_value(ctx, (uint16_t)(top.x + 60u), (uint16_t)(top.y + 38u), "OP", m->bus_last_opcode, text, card_fill);
-    ui_draw_value(ctx, (uint16_t)(top.x + 112u), (uint16_t)(top.y + 38u), "LEN", m->bus_last_len, text, card_fill);
-    ui_draw_value(ctx, (uint16_t)(top.x + 164u), (uint16_t)(top.y + 38u), "DT", m->bus_last_dt_ms, muted, card_fill);
+    render_bus_last(ctx, m, text, muted, card_fill);
 
     /* Filter chips */
     ui_rect_t chip = {(uint16_t)(top.x + 12u), (uint16_t)(top.y + 66u), 52u, 20u};
-    uint16_t chip_on = rgb565_lerp(panel, accent, 180u);
+    uint16_t chip_on = ui_tint(ctx, UI_TINT_CHIP_ON);
     uint16_t chip_off = panel;
     uint16_t chip_fg_on = bgc;
     uint16_t chip_fg_off = text;
@@ -2917,18 +3969,66 @@ static void render_bus(ui_render_ctx_t *ctx, const ui_model_t *m,
     ui_draw_text(ctx, (uint16_t)(list.x + 12u), (uint16_t)(list.y + 10u), "LATEST", muted, card_fill);
     ui_draw_rect(ctx, (ui_rect_t){(uint16_t)(list.x + 12u), (uint16_t)(list.y + 28u), (uint16_t)(list.w - 24u), 1u}, stroke);
 
-    uint16_t ry = (uint16_t)(list.y + 38u);
-    for (uint8_t i = 0; i < m->bus_entries && i < 6u; ++i)
+    for (uint8_t i = 0; i < m->bus_entries && i < BUS_UI_VIEW_MAX; ++i)
+        render_bus_row(ctx, m, i, text, muted, card_fill, stroke);
+
+    /* Link health: decoder error taxonomy, outages, busiest RX rate. */
+    ui_rect_t link = {PAD, (uint16_t)(list.y + list.h + G), (uint16_t)(DISP_W - 2u * PAD), 28u};
+    ui_draw_panel(ctx, link, &card);
+    render_bus_link(ctx, m, text, muted, accent, card_fill);
+}
+
+/* Rows and the two summary lines redraw alone; chips and panels go through
+ * a full redraw (view or theme changes). */
+static void render_bus_partial(ui_render_ctx_t *ctx, const ui_model_t *m,
+                               uint16_t dist_d10, uint16_t wh_d10,
+                               const ui_dirty_t *dirty)
+{
+    if (!dirty || dirty->full)
     {
-        ui_rect_t row = {(uint16_t)(list.x + 10u), ry, (uint16_t)(list.w - 20u), 16u};
-        ui_draw_rect(ctx, row, card_fill);
-        ui_draw_value(ctx, (uint16_t)(row.x + 0u), (uint16_t)(row.y + 2u), "ID", m->bus_list_id[i], text, card_fill);
-        ui_draw_value(ctx, (uint16_t)(row.x + 48u), (uint16_t)(row.y + 2u), "OP", m->bus_list_op[i], text, card_fill);
-        ui_draw_value(ctx, (uint16_t)(row.x + 104u), (uint16_t)(row.y + 2u), "L", m->bus_list_len[i], text, card_fill);
-        ui_draw_value(ctx, (uint16_t)(row.x + 136u), (uint16_t)(row.y + 2u), "DT", m->bus_list_dt_ms[i], muted, card_fill);
-        ry = (uint16_t)(ry + 18u);
-        if (i + 1u < m->bus_entries)
-            ui_draw_rect(ctx, (ui_rect_t){(uint16_t)(row.x + 0u), (uint16_t)(ry - 2u), (uint16_t)(row.w - 0u), 1u}, stroke);
+        render_bus(ctx, m, dist_d10, wh_d10);
+        return;
+    }
+    const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
+    const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
+    const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
+    const uint16_t stroke = rgb565_dim(muted);
+
+    ui_rect_t r = k_ui_widgets[UI_W_BUS_COUNT];
+    if (rect_dirty(dirty, r))
+    {
+        ui_clip_push(ctx, r);
+        ui_draw_rect(ctx, r, card_fill);
+        render_bus_count(ctx, m, text, card_fill);
+        ui_clip_pop(ctx);
+    }
+    r = k_ui_widgets[UI_W_BUS_LAST];
+    if (rect_dirty(dirty, r))
+    {
+        ui_clip_push(ctx, r);
+        ui_draw_rect(ctx, r, card_fill);
+        render_bus_last(ctx, m, text, muted, card_fill);
+        ui_clip_pop(ctx);
+    }
+    for (uint8_t i = 0; i < BUS_UI_VIEW_MAX; ++i)
+    {
+        r = k_ui_widgets[UI_W_BUS_ROW_0 + i];
+        if (!r.h || !rect_dirty(dirty, r))
+            continue;
+        ui_clip_push(ctx, r);
+        ui_draw_rect(ctx, r, card_fill);
+        if (i < m->bus_entries)
+            render_bus_row(ctx, m, i, text, muted, card_fill, stroke);
+        ui_clip_pop(ctx);
+    }
+    r = k_ui_widgets[UI_W_BUS_LINK];
+    if (r.h && rect_dirty(dirty, r))
+    {
+        ui_clip_push(ctx, r);
+        ui_draw_rect(ctx, r, card_fill);
+        render_bus_link(ctx, m, text, muted, accent, card_fill);
+        ui_clip_pop(ctx);
     }
 }
 
@@ -2941,9 +4041,8 @@ static void render_capture(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
     const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
-    const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     const uint16_t stroke = rgb565_dim(muted);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
@@ -2966,7 +4065,7 @@ static void render_capture(ui_render_ctx_t *ctx, const ui_model_t *m,
     ui_draw_text(ctx, (uint16_t)(hero.x + 12u), (uint16_t)(hero.y + 10u), "STATUS", muted, card_fill);
 
     ui_rect_t btn = {(uint16_t)(hero.x + 12u), (uint16_t)(hero.y + 34u), (uint16_t)(hero.w - 24u), 44u};
-    uint16_t btn_fill = m->capture_enabled ? rgb565_lerp(panel, accent, 180u) : panel;
+    uint16_t btn_fill = m->capture_enabled ? ui_tint(ctx, UI_TINT_CHIP_ON) : panel;
     uint16_t btn_text = m->capture_enabled ? bgc : text;
     ui_draw_round_rect(ctx, btn, btn_fill, 12u);
     ui_draw_text(ctx, (uint16_t)(btn.x + 14u), (uint16_t)(btn.y + 14u), m->capture_enabled ? "STOP CAPTURE" : "START CAPTURE", btn_text, btn_fill);
@@ -2991,7 +4090,7 @@ static void render_alerts(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t warn = ui_color(ctx, UI_COLOR_WARN);
     const uint16_t danger = ui_color(ctx, UI_COLOR_DANGER);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     const uint16_t stroke = rgb565_dim(muted);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
@@ -3060,7 +4159,7 @@ static void render_alerts(ui_render_ctx_t *ctx, const ui_model_t *m,
     {
         uint8_t acked = (m->alert_ack_mask & (uint8_t)(1u << i)) ? 1u : 0u;
         uint8_t sel = (m->alert_selected == i) ? 1u : 0u;
-        uint16_t row_fill = sel ? rgb565_lerp(card_fill, accent, 28u) : card_fill;
+        uint16_t row_fill = sel ? ui_tint(ctx, UI_TINT_SEL) : card_fill;
         uint16_t row_text = acked ? muted : text;
         if (sel)
             row_text = bgc;
@@ -3082,12 +4181,14 @@ static void render_alerts(ui_render_ctx_t *ctx, const ui_model_t *m,
         ui_draw_text(ctx, (uint16_t)(row.x + 32u), (uint16_t)(row.y + 8u), etype, row_text, row_fill);
         ui_draw_value(ctx, (uint16_t)(row.x + 112u), (uint16_t)(row.y + 8u), "F", (int32_t)m->alert_flags[i], row_text, row_fill);
 
-        char age_buf[12];
-        char dist_buf[12];
-        fmt_seconds_label(age_buf, sizeof(age_buf), m->alert_age_s[i]);
-        fmt_distance_label(dist_buf, sizeof(dist_buf), m->alert_dist_d10[i], m->units);
-        ui_draw_text(ctx, (uint16_t)(row.x + 32u), (uint16_t)(row.y + 22u), age_buf, muted, row_fill);
-        ui_draw_text(ctx, (uint16_t)(row.x + row.w - 52u), (uint16_t)(row.y + 22u), dist_buf, muted, row_fill);
+        uint16_t age_x = (uint16_t)(row.x + 32u);
+        uint16_t dist_x = (uint16_t)(row.x + row.w - 52u);
+        uint16_t sub_y = (uint16_t)(row.y + 22u);
+        ui_draw_text(ctx, age_x, sub_y, fmt_at(ctx, age_x, sub_y, UI_FMT_AGE, m->alert_age_s[i], 0u, NULL),
+                     muted, row_fill);
+        ui_draw_text(ctx, dist_x, sub_y,
+                     fmt_at(ctx, dist_x, sub_y, UI_FMT_DIST, m->alert_dist_d10[i], m->units, NULL),
+                     muted, row_fill);
 
         ry = (uint16_t)(ry + 44u);
     }
@@ -3104,7 +4205,7 @@ static void render_tune(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
     const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     const uint16_t stroke = rgb565_dim(muted);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
@@ -3160,9 +4261,8 @@ static void render_ambient(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
     const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
-    const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     const uint16_t stroke = rgb565_dim(muted);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
@@ -3186,7 +4286,7 @@ static void render_ambient(ui_render_ctx_t *ctx, const ui_model_t *m,
     uint8_t soc = m->soc_pct;
     if (soc > 100u)
         soc = 100u;
-    uint16_t inactive = rgb565_lerp(card_fill, muted, 64u);
+    uint16_t inactive = ui_tint(ctx, UI_TINT_GAUGE_OFF);
     ui_rect_t clip = inset_rect(hero, 6u);
     int16_t cx = (int16_t)(hero.x + hero.w / 2u);
     int16_t cy = (int16_t)(hero.y + 82u);
@@ -3195,7 +4295,7 @@ static void render_ambient(ui_render_ctx_t *ctx, const ui_model_t *m,
     uint16_t sweep = 360u;
     uint16_t active_sweep = (uint16_t)((uint32_t)sweep * soc / 100u);
     ui_draw_ring_gauge(ctx, clip, cx, cy, outer_r, thick, -90, sweep, active_sweep,
-                       rgb565_lerp(card_fill, accent, 220u), inactive, card_fill);
+                       ui_tint(ctx, UI_TINT_GAUGE_ON), inactive, card_fill);
 
     ui_draw_text(ctx, (uint16_t)(hero.x + 12u), (uint16_t)(hero.y + 10u), "SOC", muted, card_fill);
     ui_draw_value(ctx, (uint16_t)(hero.x + 12u), (uint16_t)(hero.y + 28u), "", soc, text, card_fill);
@@ -3216,7 +4316,7 @@ static void render_about(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
     const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     const uint16_t stroke = rgb565_dim(muted);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
@@ -3336,9 +4436,8 @@ static void render_engineer_raw(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
     const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
-    const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
     render_header_icon(ctx, "ENG RAW", UI_ICON_INFO);
@@ -3355,7 +4454,7 @@ static void render_engineer_raw(ui_render_ctx_t *ctx, const ui_model_t *m,
     };
 
     uint16_t y = (uint16_t)(TOP_Y + TOP_H + G);
-    uint16_t chip_on = rgb565_lerp(panel, accent, 180u);
+    uint16_t chip_on = ui_tint(ctx, UI_TINT_CHIP_ON);
     uint16_t chip_off = panel;
     uint16_t chip_fg_on = bgc;
     ui_rect_t chip = {PAD, y, 64u, 20u};
@@ -3394,9 +4493,8 @@ static void render_engineer_power(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
     const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
-    const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
 
     ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
     render_header_icon(ctx, "ENG PWR", UI_ICON_INFO);
@@ -3413,7 +4511,7 @@ static void render_engineer_power(ui_render_ctx_t *ctx, const ui_model_t *m,
     };
 
     uint16_t y = (uint16_t)(TOP_Y + TOP_H + G);
-    uint16_t chip_on = rgb565_lerp(panel, accent, 180u);
+    uint16_t chip_on = ui_tint(ctx, UI_TINT_CHIP_ON);
     uint16_t chip_off = panel;
     uint16_t chip_fg_on = bgc;
     ui_rect_t chip = {PAD, y, 64u, 20u};
@@ -3447,6 +4545,89 @@ static void render_engineer_power(ui_render_ctx_t *ctx, const ui_model_t *m,
     render_table_row_bg(ctx, y, "DERATE", m->limit_reason, card_fill, text);
 }
 
+/* Half-width grid cell on the perf card: label left, value right. */
+static void render_perf_cell(ui_render_ctx_t *ctx, uint16_t x, uint16_t y, const char *label, int32_t value,
+                             uint16_t bg, uint16_t text)
+{
+    ui_draw_text(ctx, (uint16_t)(x + 4u), y, label, text, bg);
+    ui_draw_value(ctx, (uint16_t)(x + 58u), y, "", value, text, bg);
+}
+
+static void render_engineer_perf(ui_render_ctx_t *ctx, const ui_model_t *m,
+                                 uint16_t dist_d10, uint16_t wh_d10)
+{
+    (void)dist_d10;
+    (void)wh_d10;
+    const uint16_t bgc = ui_color(ctx, UI_COLOR_BG);
+    const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
+    const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
+    const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
+    const uint16_t warn = ui_color(ctx, UI_COLOR_WARN);
+    const uint16_t shadow = rgb565_dim(panel);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
+
+    ui_draw_rect(ctx, (ui_rect_t){0, 0, DISP_W, DISP_H}, bgc);
+    render_header_icon(ctx, "ENG PERF", UI_ICON_INFO);
+
+    ui_panel_style_t card = {
+        .radius = 10u,
+        .border_thick = 1u,
+        .shadow_dx = 2,
+        .shadow_dy = 2,
+        .fill = card_fill,
+        .border = panel,
+        .shadow = shadow,
+        .flags = panel_flags_for_theme(m->theme),
+    };
+
+    uint16_t y = (uint16_t)(TOP_Y + TOP_H + G);
+    uint16_t chip_on = ui_tint(ctx, UI_TINT_CHIP_ON);
+    uint16_t chip_off = panel;
+    uint16_t chip_fg_on = bgc;
+    /* Scheduler chips: slowest task run (us) and overrun/late count. */
+    ui_rect_t chip = {PAD, y, 100u, 20u};
+    ui_draw_round_rect(ctx, chip, chip_on, 10u);
+    ui_draw_value(ctx, (uint16_t)(chip.x + 10u), (uint16_t)(chip.y + 6u), "TSK ",
+                  (int32_t)m->sched_max_us, chip_fg_on, chip_on);
+    chip.x = (uint16_t)(chip.x + chip.w + 8u);
+    uint16_t ovr_fill = m->sched_overruns ? rgb565_lerp(panel, warn, 180u) : chip_off;
+    ui_draw_round_rect(ctx, chip, ovr_fill, 10u);
+    ui_draw_value(ctx, (uint16_t)(chip.x + 10u), (uint16_t)(chip.y + 6u), "OVR ",
+                  (int32_t)m->sched_overruns, m->sched_overruns ? chip_fg_on : muted, ovr_fill);
+
+    /* Two columns of 16 px rows: loads in per mille ("d%"), times in us. */
+    y = (uint16_t)(y + chip.h + 8u);
+    ui_rect_t box = {PAD, y, (uint16_t)(DISP_W - 2u * PAD), 160u};
+    ui_draw_panel(ctx, box, &card);
+    const uint16_t l = PAD;
+    const uint16_t r = (uint16_t)(PAD + box.w / 2u);
+    y = (uint16_t)(y + 8u);
+    render_perf_cell(ctx, l, y, "LOOP d%", m->loop_permille, card_fill, text);
+    render_perf_cell(ctx, r, y, "TIM2 d%", m->isr_tim2_permille, card_fill, text); y += 16u;
+    render_perf_cell(ctx, l, y, "UART d%", m->isr_usart_permille, card_fill, text);
+    render_perf_cell(ctx, r, y, "DMA d%", m->isr_dma_permille, card_fill, text); y += 16u;
+    render_perf_cell(ctx, l, y, "FLSH d%", m->flash_permille, card_fill, text);
+    render_perf_cell(ctx, r, y, "TSK AVG", (int32_t)m->sched_ewma_us, card_fill, text); y += 16u;
+    render_perf_cell(ctx, l, y, "FRAME", (int32_t)m->perf_frame_us, card_fill, text);
+    render_perf_cell(ctx, r, y, "OPS", m->perf_draw_ops, card_fill, text); y += 16u;
+    render_perf_cell(ctx, l, y, "AVG", (int32_t)m->perf_avg_us, card_fill, text);
+    render_perf_cell(ctx, r, y, "MAX", (int32_t)m->perf_max_us, card_fill, text); y += 16u;
+    render_perf_cell(ctx, l, y, "OVER", m->perf_over_budget, card_fill, m->perf_over_budget ? warn : text);
+    ui_draw_text(ctx, (uint16_t)(r + 4u), y, "WORST", text, card_fill);
+    ui_draw_text(ctx, (uint16_t)(r + 38u), y,
+                 (m->perf_worst_page == UI_PERF_PAGE_ALL) ? "--" : ui_page_name(m->perf_worst_page), text,
+                 card_fill);
+    y += 16u;
+    render_perf_cell(ctx, l, y, "WQ HWM", m->wq_hwm, card_fill, text);
+    render_perf_cell(ctx, r, y, "EVQ HWM", m->evq_hwm, card_fill, text); y += 16u;
+    render_perf_cell(ctx, l, y, "FILL", (int32_t)m->perf_prim_us[UI_PERF_PRIM_FILL], card_fill, text);
+    render_perf_cell(ctx, r, y, "TEXT", (int32_t)m->perf_prim_us[UI_PERF_PRIM_TEXT], card_fill, text); y += 16u;
+    render_perf_cell(ctx, l, y, "ARC", (int32_t)m->perf_prim_us[UI_PERF_PRIM_ARC], card_fill, text);
+    render_perf_cell(ctx, r, y, "BLIT", (int32_t)m->perf_prim_us[UI_PERF_PRIM_BLIT], card_fill, text); y += 16u;
+    render_perf_cell(ctx, l, y, "ERASES", (int32_t)m->flash_erases, card_fill, text);
+    render_perf_cell(ctx, r, y, "FL BLK", (int32_t)m->flash_block_max_us, card_fill, text);
+}
+
 static void render_dashboard_partial(ui_render_ctx_t *ctx, const ui_model_t *m,
                                      uint16_t dist_d10, uint16_t wh_d10,
                                      const ui_dirty_t *dirty)
@@ -3457,7 +4638,7 @@ static void render_dashboard_partial(ui_render_ctx_t *ctx, const ui_model_t *m,
         return;
     }
 
-    ui_dash_v2_layout_t l = dash_v2_layout();
+    const ui_dash_v2_layout_t *l = &k_dash_v2_layout;
     const uint16_t bg = ui_color(ctx, UI_COLOR_BG);
     const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
     const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
@@ -3467,34 +4648,83 @@ static void render_dashboard_partial(ui_render_ctx_t *ctx, const ui_model_t *m,
     const uint16_t danger = ui_color(ctx, UI_COLOR_DANGER);
     const uint16_t ok = ui_color(ctx, UI_COLOR_OK);
     const uint16_t stroke = rgb565_dim(muted);
-    const uint16_t card_fill = rgb565_lerp(bg, panel, 32u);
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
     uint16_t accent_dash = accent;
     if (ctx && ctx->ui && ctx->ui->regen_glow_phase)
-        accent_dash = rgb565_lerp(accent, ok, 180u);
+        accent_dash = ui_tint(ctx, UI_TINT_ACCENT_DASH);
 
-    if (rect_dirty(dirty, l.top_area))
-        dash_v2_render_top(ctx, m, &l, bg, text, muted, accent_dash, card_fill, stroke, warn, danger, ok);
+    if (rect_dirty(dirty, l->top_area))
+    {
+        ui_clip_push(ctx, l->top_area);
+        dash_v2_render_top(ctx, m, l, bg, text, muted, accent_dash, card_fill, stroke, warn, danger, ok);
+        ui_clip_pop(ctx);
+    }
 
-    if (rect_dirty(dirty, l.speed_in))
-        dash_v2_render_speed_inner(ctx, m, &l, panel, text, muted, accent_dash, warn, stroke, card_fill);
+    if (rect_dirty(dirty, l->speed_in))
+    {
+        /* Tall digits spill below the card; the full render paints the tray
+         * panel over them, so they stop where that panel starts. */
+        ui_clip_push(ctx, rect_span(l->speed_in.x, l->speed_in.y,
+                                    l->speed_in.x + l->speed_in.w, l->tray.y));
+        dash_v2_render_speed_inner(ctx, m, l, panel, text, muted, accent_dash, warn, stroke, card_fill, 1u);
+        ui_clip_pop(ctx);
+    }
 
-    if (rect_dirty(dirty, l.tray_in))
-        dash_v2_render_tray_inner(ctx, m, &l, dist_d10, wh_d10, text, muted, stroke, accent_dash, card_fill);
+    if (rect_dirty(dirty, l->tray_in))
+    {
+        ui_clip_push(ctx, l->tray_in);
+        dash_v2_render_tray_inner(ctx, m, l, dist_d10, wh_d10, text, muted, stroke, accent_dash, card_fill, 1u);
+        ui_clip_pop(ctx);
+    }
 }
 
-static void dirty_graphs(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
+static void dirty_graphs(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p, uint32_t changes)
 {
-    ui_graph_layout_t l = graph_layout();
+    (void)changes;
+    const ui_graph_layout_t *l = &k_graph_layout;
 
-    /* Always refresh the plot area to advance the strip chart. */
-    ui_dirty_add(d, l.graph_dirty);
+    /* A new scale or data source moves every span; otherwise only the sweep
+     * columns whose content differs from last tick are redrawn. */
+    ui_graph_scale_t sc_m = graph_scale(m, l->sweep.w);
+    ui_graph_scale_t sc_p = graph_scale(p, l->sweep.w);
+    if (m->graph_channel != p->graph_channel || m->graph_window_s != p->graph_window_s ||
+        sc_m.lo != sc_p.lo || sc_m.hi != sc_p.hi)
+    {
+        dirty_add_widget(d, UI_W_GRAPH_DIRTY);
+    }
+    else
+    {
+        uint16_t run = 0u;
+        for (uint16_t o = 0; o <= l->sweep.w; ++o)
+        {
+            uint8_t changed = 0u;
+            if (o < l->sweep.w)
+            {
+                int16_t ml = 0;
+                int16_t mh = 0;
+                int16_t pl = 0;
+                int16_t ph = 0;
+                uint8_t mv = graph_column_at(m, l->sweep.w, o, &ml, &mh);
+                uint8_t pv = graph_column_at(p, l->sweep.w, o, &pl, &ph);
+                changed = (mv != pv || ml != pl || mh != ph) ? 1u : 0u;
+            }
+            if (changed)
+            {
+                run++;
+                continue;
+            }
+            if (run)
+                ui_dirty_add(d, (ui_rect_t){(uint16_t)(l->sweep.x + o - run), l->plot.y, run, l->plot.h});
+            run = 0u;
+        }
+    }
 
     if (m->graph_channel != p->graph_channel)
-        ui_dirty_add(d, l.chip_channel);
+        dirty_add_widget(d, UI_W_GRAPH_CHIP_CHANNEL);
     if (m->graph_window_s != p->graph_window_s)
-        ui_dirty_add(d, l.chip_window);
+        dirty_add_widget(d, UI_W_GRAPH_CHIP_WINDOW);
     if (m->graph_sample_hz != p->graph_sample_hz)
-        ui_dirty_add(d, l.chip_hz);
+        dirty_add_widget(d, UI_W_GRAPH_CHIP_HZ);
 }
 
 static void render_graphs_partial(ui_render_ctx_t *ctx, const ui_model_t *m,
@@ -3509,34 +4739,39 @@ static void render_graphs_partial(ui_render_ctx_t *ctx, const ui_model_t *m,
         return;
     }
 
-    ui_graph_layout_t l = graph_layout();
+    const ui_graph_layout_t *l = &k_graph_layout;
     const uint16_t bgc = ui_color(ctx, UI_COLOR_BG);
     const uint16_t panel = ui_color(ctx, UI_COLOR_PANEL);
     const uint16_t text = ui_color(ctx, UI_COLOR_TEXT);
     const uint16_t muted = ui_color(ctx, UI_COLOR_MUTED);
     const uint16_t accent = ui_color(ctx, UI_COLOR_ACCENT);
     const uint16_t stroke = rgb565_dim(muted);
-    const uint16_t shadow = rgb565_dim(panel);
-    const uint16_t card_fill = rgb565_lerp(bgc, panel, 32u);
-
-    ui_panel_style_t card = {
-        .radius = 10u,
-        .border_thick = 1u,
-        .shadow_dx = 2,
-        .shadow_dy = 2,
-        .fill = card_fill,
-        .border = panel,
-        .shadow = shadow,
-    };
+    const uint16_t card_fill = ui_tint(ctx, UI_TINT_CARD);
 
-    if (rect_dirty(dirty, l.chip_channel))
-        render_graph_channel_chip(ctx, m, &l, bgc, panel, accent);
-    if (rect_dirty(dirty, l.chip_window))
-        render_graph_window_chip(ctx, m, &l, text, panel);
-    if (rect_dirty(dirty, l.chip_hz))
-        render_graph_hz_chip(ctx, m, &l, text, panel);
-    if (rect_dirty(dirty, l.graph_dirty))
-        render_graph_panel(ctx, &l, &card, card_fill, stroke, accent, muted);
+    if (rect_dirty(dirty, l->chip_channel))
+    {
+        ui_clip_push(ctx, l->chip_channel);
+        render_graph_channel_chip(ctx, m, l, bgc, panel, accent);
+        ui_clip_pop(ctx);
+    }
+    if (rect_dirty(dirty, l->chip_window))
+    {
+        ui_clip_push(ctx, l->chip_window);
+        render_graph_window_chip(ctx, m, l, text, panel);
+        ui_clip_pop(ctx);
+    }
+    if (rect_dirty(dirty, l->chip_hz))
+    {
+        ui_clip_push(ctx, l->chip_hz);
+        render_graph_hz_chip(ctx, m, l, text, panel);
+        ui_clip_pop(ctx);
+    }
+    if (rect_dirty(dirty, l->graph_dirty))
+    {
+        ui_clip_push(ctx, l->graph_dirty);
+        render_graph_columns(ctx, m, l, dirty, card_fill, stroke, accent, muted);
+        ui_clip_pop(ctx);
+    }
 }
 
 static const ui_screen_def_t k_ui_screens[] = {
@@ -3547,6 +4782,7 @@ static const ui_screen_def_t k_ui_screens[] = {
         .render_full = render_dashboard,
         .render_partial = render_dashboard_partial,
         .dirty_fn = dirty_dashboard_v2,
+        .deps = DASH_V2_DEPS,
     },
     {
         .id = UI_PAGE_FOCUS,
@@ -3554,7 +4790,8 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "focus",
         .render_full = render_focus,
         .render_partial = NULL,
-        .dirty_fn = dirty_focus,
+        .dirty_fn = NULL,
+        .deps = UI_CH_SETTINGS | UI_CH_SPEED | UI_CH_POWER | UI_CH_UNITS | UI_CH_SOC,
     },
     {
         .id = UI_PAGE_GRAPHS,
@@ -3563,6 +4800,7 @@ static const ui_screen_def_t k_ui_screens[] = {
         .render_full = render_graphs,
         .render_partial = render_graphs_partial,
         .dirty_fn = dirty_graphs,
+        .deps = UI_CH_GRAPH,
     },
     {
         .id = UI_PAGE_TRIP,
@@ -3570,7 +4808,8 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "trip",
         .render_full = render_trip_summary,
         .render_partial = NULL,
-        .dirty_fn = dirty_trip_summary,
+        .dirty_fn = NULL,
+        .deps = UI_CH_TRIP | UI_CH_TRIP_STATS | UI_CH_ASSIST | UI_CH_UNITS,
     },
     {
         .id = UI_PAGE_PROFILES,
@@ -3578,7 +4817,8 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "profiles",
         .render_full = render_profiles,
         .render_partial = NULL,
-        .dirty_fn = dirty_profiles,
+        .dirty_fn = NULL,
+        .deps = UI_CH_PROFILE | UI_CH_ASSIST,
     },
     {
         .id = UI_PAGE_SETTINGS,
@@ -3586,7 +4826,8 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "settings",
         .render_full = render_settings,
         .render_partial = NULL,
-        .dirty_fn = dirty_settings,
+        .dirty_fn = NULL,
+        .deps = UI_CH_SETTINGS | UI_CH_UNITS | UI_CH_MODE,
     },
     {
         .id = UI_PAGE_CRUISE,
@@ -3594,15 +4835,17 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "cruise",
         .render_full = render_cruise,
         .render_partial = NULL,
-        .dirty_fn = dirty_cruise,
+        .dirty_fn = NULL,
+        .deps = UI_CH_CRUISE | UI_CH_UNITS,
     },
     {
         .id = UI_PAGE_BATTERY,
-        .flags = 0u,
+        .flags = UI_SCREEN_FLAG_PROGRESSIVE,
         .name = "battery",
         .render_full = render_battery_screen,
         .render_partial = NULL,
-        .dirty_fn = dirty_battery,
+        .dirty_fn = NULL,
+        .deps = UI_CH_SOC | UI_CH_BATT | UI_CH_RANGE | UI_CH_UNITS,
     },
     {
         .id = UI_PAGE_THERMAL,
@@ -3610,23 +4853,26 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "thermal",
         .render_full = render_thermal,
         .render_partial = NULL,
-        .dirty_fn = dirty_thermal,
+        .dirty_fn = NULL,
+        .deps = UI_CH_THERMAL | UI_CH_LIMIT,
     },
     {
         .id = UI_PAGE_DIAGNOSTICS,
-        .flags = 0u,
+        .flags = UI_SCREEN_FLAG_PROGRESSIVE,
         .name = "diag",
         .render_full = render_diagnostics,
         .render_partial = render_diagnostics_partial,
         .dirty_fn = dirty_diagnostics,
+        .deps = DIAG_DEPS,
     },
     {
         .id = UI_PAGE_BUS,
-        .flags = 0u,
+        .flags = UI_SCREEN_FLAG_PROGRESSIVE,
         .name = "bus",
         .render_full = render_bus,
-        .render_partial = NULL,
+        .render_partial = render_bus_partial,
         .dirty_fn = dirty_bus,
+        .deps = BUS_DEPS,
     },
     {
         .id = UI_PAGE_CAPTURE,
@@ -3634,15 +4880,17 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "capture",
         .render_full = render_capture,
         .render_partial = NULL,
-        .dirty_fn = dirty_capture,
+        .dirty_fn = NULL,
+        .deps = UI_CH_CAPTURE,
     },
     {
         .id = UI_PAGE_ALERTS,
-        .flags = 0u,
+        .flags = UI_SCREEN_FLAG_PROGRESSIVE,
         .name = "alerts",
         .render_full = render_alerts,
         .render_partial = NULL,
-        .dirty_fn = dirty_alerts,
+        .dirty_fn = NULL,
+        .deps = UI_CH_ALERTS | UI_CH_ERR | UI_CH_LIMIT | UI_CH_UNITS,
     },
     {
         .id = UI_PAGE_TUNE,
@@ -3650,7 +4898,8 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "tune",
         .render_full = render_tune,
         .render_partial = NULL,
-        .dirty_fn = dirty_tune,
+        .dirty_fn = NULL,
+        .deps = UI_CH_TUNE,
     },
     {
         .id = UI_PAGE_AMBIENT,
@@ -3658,7 +4907,8 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "ambient",
         .render_full = render_ambient,
         .render_partial = NULL,
-        .dirty_fn = dirty_ambient,
+        .dirty_fn = NULL,
+        .deps = UI_CH_SOC | UI_CH_BATT,
     },
     {
         .id = UI_PAGE_ABOUT,
@@ -3666,7 +4916,8 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "about",
         .render_full = render_about,
         .render_partial = NULL,
-        .dirty_fn = dirty_about,
+        .dirty_fn = NULL,
+        .deps = 0u,
     },
     {
         .id = UI_PAGE_ENGINEER_RAW,
@@ -3674,7 +4925,10 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "eng_raw",
         .render_full = render_engineer_raw,
         .render_partial = NULL,
-        .dirty_fn = dirty_engineer_raw,
+        .dirty_fn = NULL,
+        .deps = UI_CH_BUS_VIEW | UI_CH_SPEED | UI_CH_PEDAL | UI_CH_BRAKE | UI_CH_BUTTONS | UI_CH_SOC |
+                UI_CH_ERR,
+        .vis = UI_VIS_DEV,
     },
     {
         .id = UI_PAGE_ENGINEER_POWER,
@@ -3682,7 +4936,19 @@ static const ui_screen_def_t k_ui_screens[] = {
         .name = "eng_power",
         .render_full = render_engineer_power,
         .render_partial = NULL,
-        .dirty_fn = dirty_engineer_power,
+        .dirty_fn = NULL,
+        .deps = UI_CH_BUS_VIEW | UI_CH_BATT | UI_CH_THERMAL | UI_CH_LIMIT | UI_CH_REGEN,
+        .vis = UI_VIS_DEV,
+    },
+    {
+        .id = UI_PAGE_ENGINEER_PERF,
+        .flags = 0u,
+        .name = "eng_perf",
+        .render_full = render_engineer_perf,
+        .render_partial = NULL,
+        .dirty_fn = NULL,
+        .deps = UI_CH_PERF,
+        .vis = UI_VIS_DEV,
     },
 };
 
@@ -3705,6 +4971,7 @@ static const uint8_t k_ui_layout[] = {
     UI_PAGE_ABOUT,
     UI_PAGE_ENGINEER_RAW,
     UI_PAGE_ENGINEER_POWER,
+    UI_PAGE_ENGINEER_PERF,
 };
 
 static const ui_screen_def_t *ui_screen_by_id(uint8_t id)
@@ -3737,6 +5004,13 @@ uint8_t ui_registry_count(void)
     return (uint8_t)(sizeof(k_ui_screens) / sizeof(k_ui_screens[0]));
 }
 
+uint8_t ui_registry_page(uint8_t index)
+{
+    if (index >= ui_registry_count())
+        return UI_PAGE_DASHBOARD;
+    return k_ui_screens[index].id;
+}
+
 uint8_t ui_registry_layout_count(void)
 {
     return ui_layout_count();
@@ -3758,12 +5032,36 @@ uint8_t ui_registry_index(uint8_t page)
     return 0u;
 }
 
+uint8_t ui_page_visible(uint8_t page, uint8_t dev_screens_enabled)
+{
+    const ui_screen_def_t *screen = ui_screen_by_id(page);
+    if (!screen)
+        return 0u;
+    if (screen->vis & UI_VIS_DEV)
+        return dev_screens_enabled ? 1u : 0u;
+    return 1u;
+}
+
 const char *ui_page_name(uint8_t page)
 {
     const ui_screen_def_t *screen = ui_screen_by_id(page);
     return screen ? screen->name : "unknown";
 }
 
+/* What ui_tick reads on every page: warning pulse, chip pops, tray sweep,
+ * regen glow and the trip numbers, plus speed so riding keeps the frame
+ * pacing up whatever page is shown. */
+#define UI_TICK_DEPS (UI_CH_SCREEN | UI_CH_SPEED | UI_CH_ERR | UI_CH_LIMIT | UI_CH_ASSIST | UI_CH_REGEN | \
+                      DASH_V2_TRAY_DEPS)
+
+uint32_t ui_page_model_deps(uint8_t page)
+{
+    const ui_screen_def_t *screen = ui_screen_by_id(page);
+    if (!screen)
+        return UI_CH_ALL;
+    return screen->deps | UI_TICK_DEPS;
+}
+
 static void render_page(ui_render_ctx_t *ctx, const ui_model_t *m, uint16_t dist_d10, uint16_t wh_d10)
 {
     const ui_screen_def_t *screen = ui_screen_by_id(m->page);
@@ -3774,20 +5072,202 @@ static void render_page(ui_render_ctx_t *ctx, const ui_model_t *m, uint16_t dist
     screen->render_full(ctx, m, dist_d10, wh_d10);
 }
 
-static void dirty_from_page(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p)
+/* The partial renderer of screens without one: the page replays once per
+ * dirty rect under the scissor, and ops outside the rect are skipped before
+ * they touch the bus. Only the ops that draw count. */
+static void render_replay(ui_render_ctx_t *ctx, const ui_model_t *m, uint16_t dist_d10, uint16_t wh_d10,
+                          const ui_dirty_t *dirty)
+{
+    ctx->count_ops = 0u;
+    for (uint8_t i = 0; i < dirty->count; ++i)
+    {
+        ui_clip_push(ctx, dirty->rects[i]);
+        render_page(ctx, m, dist_d10, wh_d10);
+        ui_clip_pop(ctx);
+    }
+}
+
+/* Each ui_model_t field and its UI_CH_* group, in declaration order. */
+#define UI_MODEL_FIELDS(X) \
+    X(UI_CH_SCREEN, page) \
+    X(UI_CH_SPEED, speed_dmph) \
+    X(UI_CH_PEDAL, rpm) \
+    X(UI_CH_PEDAL, torque_raw) \
+    X(UI_CH_ASSIST, assist_mode) \
+    X(UI_CH_ASSIST, virtual_gear) \
+    X(UI_CH_SOC, soc_pct) \
+    X(UI_CH_ERR, err) \
+    X(UI_CH_BATT, batt_dV) \
+    X(UI_CH_BATT, batt_dA) \
+    X(UI_CH_BATT, phase_dA) \
+    X(UI_CH_BATT, sag_margin_dV) \
+    X(UI_CH_THERMAL, thermal_state) \
+    X(UI_CH_THERMAL, ctrl_temp_dC) \
+    X(UI_CH_PEDAL, cadence_rpm) \
+    X(UI_CH_PEDAL, throttle_pct) \
+    X(UI_CH_BRAKE, brake) \
+    X(UI_CH_BUTTONS, buttons) \
+    X(UI_CH_POWER, power_w) \
+    X(UI_CH_LIMIT, limit_power_w) \
+    X(UI_CH_TRIP, trip_distance_mm) \
+    X(UI_CH_TRIP, trip_energy_mwh) \
+    X(UI_CH_TRIP_STATS, trip_max_speed_dmph) \
+    X(UI_CH_TRIP_STATS, trip_avg_speed_dmph) \
+    X(UI_CH_TRIP_STATS, trip_moving_ms) \
+    X(UI_CH_TRIP_STATS, trip_assist_ms) \
+    X(UI_CH_TRIP_STATS, trip_gear_ms) \
+    X(UI_CH_TRIP_STATS, trip_view) \
+    X(UI_CH_TRIP_STATS, trip_elapsed_ms) \
+    X(UI_CH_TRIP_STATS, trip_p95_speed_dmph) \
+    X(UI_CH_UNITS, units) \
+    X(UI_CH_SCREEN, theme) \
+    X(UI_CH_MODE, mode) \
+    X(UI_CH_LIMIT, limit_reason) \
+    X(UI_CH_DRIVE, drive_mode) \
+    X(UI_CH_DRIVE, boost_seconds) \
+    X(UI_CH_RANGE, range_est_d10) \
+    X(UI_CH_RANGE, range_confidence) \
+    X(UI_CH_CRUISE, cruise_resume_available) \
+    X(UI_CH_CRUISE, cruise_resume_reason) \
+    X(UI_CH_REGEN, regen_supported) \
+    X(UI_CH_REGEN, regen_level) \
+    X(UI_CH_REGEN, regen_brake_level) \
+    X(UI_CH_REGEN, regen_cmd_power_w) \
+    X(UI_CH_REGEN, regen_cmd_current_dA) \
+    X(UI_CH_ASSIST, walk_state) \
+    X(UI_CH_LINK, link_timeouts) \
+    X(UI_CH_LINK, link_rx_errors) \
+    X(UI_CH_LINK, link_crc_errors) \
+    X(UI_CH_LINK, link_frame_errors) \
+    X(UI_CH_LINK, link_outages) \
+    X(UI_CH_LINK, link_rate_x10) \
+    X(UI_CH_SETTINGS, settings_index) \
+    X(UI_CH_SETTINGS, focus_metric) \
+    X(UI_CH_SETTINGS, button_map) \
+    X(UI_CH_SETTINGS, pin_code) \
+    X(UI_CH_CAPTURE, capture_enabled) \
+    X(UI_CH_CAPTURE, capture_count) \
+    X(UI_CH_ALERTS, alert_ack_active) \
+    X(UI_CH_ALERTS, alert_count) \
+    X(UI_CH_BUS, bus_last_id) \
+    X(UI_CH_BUS, bus_last_len) \
+    X(UI_CH_BUS, bus_last_opcode) \
+    X(UI_CH_BUS, bus_last_dt_ms) \
+    X(UI_CH_BUS, bus_count) \
+    X(UI_CH_PROFILE, profile_id) \
+    X(UI_CH_TUNE, tune_index) \
+    X(UI_CH_TUNE, tune_cap_current_dA) \
+    X(UI_CH_TUNE, tune_ramp_wps) \
+    X(UI_CH_TUNE, tune_boost_s) \
+    X(UI_CH_CRUISE, cruise_mode) \
+    X(UI_CH_CRUISE, cruise_set_dmph) \
+    X(UI_CH_CRUISE, cruise_set_power_w) \
+    X(UI_CH_CRUISE, cruise_change_ms) \
+    X(UI_CH_ALERTS, alert_entries) \
+    X(UI_CH_ALERTS, alert_type) \
+    X(UI_CH_ALERTS, alert_flags) \
+    X(UI_CH_ALERTS, alert_age_s) \
+    X(UI_CH_ALERTS, alert_dist_d10) \
+    X(UI_CH_GRAPH, graph_channel) \
+    X(UI_CH_GRAPH, graph_window_s) \
+    X(UI_CH_GRAPH, graph_sample_hz) \
+    X(UI_CH_GRAPH, graph_cols) \
+    X(UI_CH_GRAPH, graph_pos) \
+    X(UI_CH_GRAPH, graph_min) \
+    X(UI_CH_GRAPH, graph_max) \
+    X(UI_CH_BUS_VIEW, bus_diff) \
+    X(UI_CH_BUS_VIEW, bus_changed_only) \
+    X(UI_CH_BUS, bus_entries) \
+    X(UI_CH_BUS_VIEW, bus_filter_id_active) \
+    X(UI_CH_BUS_VIEW, bus_filter_opcode_active) \
+    X(UI_CH_BUS_VIEW, bus_filter_id) \
+    X(UI_CH_BUS_VIEW, bus_filter_opcode) \
+    X(UI_CH_BUS, bus_list_id) \
+    X(UI_CH_BUS, bus_list_op) \
+    X(UI_CH_BUS, bus_list_len) \
+    X(UI_CH_BUS, bus_list_dt_ms) \
+    X(UI_CH_ALERTS, alert_selected) \
+    X(UI_CH_ALERTS, alert_ack_mask) \
+    X(UI_CH_PROFILE, profile_select) \
+    X(UI_CH_PROFILE, profile_focus) \
+    X(UI_CH_PROFILE, gear_count) \
+    X(UI_CH_PROFILE, gear_shape) \
+    X(UI_CH_PROFILE, gear_min_pct) \
+    X(UI_CH_PROFILE, gear_max_pct) \
+    X(UI_CH_PERF, perf_frame_us) \
+    X(UI_CH_PERF, perf_avg_us) \
+    X(UI_CH_PERF, perf_max_us) \
+    X(UI_CH_PERF, perf_over_budget) \
+    X(UI_CH_PERF, perf_worst_page) \
+    X(UI_CH_PERF, perf_prim_us) \
+    X(UI_CH_PERF, perf_draw_ops) \
+    X(UI_CH_PERF, sched_max_us) \
+    X(UI_CH_PERF, sched_ewma_us) \
+    X(UI_CH_PERF, sched_overruns) \
+    X(UI_CH_PERF, loop_permille) \
+    X(UI_CH_PERF, isr_tim2_permille) \
+    X(UI_CH_PERF, isr_usart_permille) \
+    X(UI_CH_PERF, isr_dma_permille) \
+    X(UI_CH_PERF, flash_permille) \
+    X(UI_CH_PERF, flash_erases) \
+    X(UI_CH_PERF, flash_block_max_us) \
+    X(UI_CH_PERF, wq_hwm) \
+    X(UI_CH_PERF, evq_hwm)
+
+/* Groups of `mask` that differ; a group stops being compared once one of
+ * its fields has. */
+static uint32_t model_changes_in(const ui_model_t *m, const ui_model_t *prev, uint32_t mask)
+{
+    uint32_t changes = 0u;
+#define UI_MODEL_DIFF(grp, f)                                          \
+    if ((mask & (grp)) && memcmp(&m->f, &prev->f, sizeof(m->f)) != 0) \
+    {                                                                  \
+        changes |= (grp);                                              \
+        mask &= ~(uint32_t)(grp);                                      \
+    }
+    UI_MODEL_FIELDS(UI_MODEL_DIFF)
+#undef UI_MODEL_DIFF
+    return changes;
+}
+
+uint32_t ui_model_changes(const ui_model_t *m, const ui_model_t *prev)
+{
+    if (!m || !prev)
+        return UI_CH_ALL;
+    return model_changes_in(m, prev, UI_CH_ALL);
+}
+
+/* Brings prev up to `m`; fields in unchanged groups already match. */
+static void model_copy_changed(ui_model_t *prev, const ui_model_t *m, uint32_t changes)
+{
+#define UI_MODEL_COPY(grp, f) \
+    if (changes & (grp))      \
+        memcpy(&prev->f, &m->f, sizeof(prev->f));
+    UI_MODEL_FIELDS(UI_MODEL_COPY)
+#undef UI_MODEL_COPY
+}
+
+static void dirty_from_page(ui_dirty_t *d, const ui_model_t *m, const ui_model_t *p, uint32_t changes)
 {
-    if (m->theme != p->theme || m->page != p->page)
+    if (changes & UI_CH_SCREEN)
     {
         ui_dirty_full(d);
         return;
     }
     const ui_screen_def_t *screen = ui_screen_by_id(m->page);
-    if (!screen || !screen->dirty_fn)
+    if (!screen)
+    {
+        ui_dirty_full(d);
+        return;
+    }
+    if (!(changes & screen->deps))
+        return;
+    if (!screen->dirty_fn)
     {
         ui_dirty_full(d);
         return;
     }
-    screen->dirty_fn(d, m, p);
+    screen->dirty_fn(d, m, p, changes);
 }
 
 uint8_t ui_page_from_buttons(uint8_t short_press, uint8_t long_press, uint8_t current_page)
@@ -3822,19 +5302,153 @@ void ui_init(ui_state_t *ui)
     uint8_t *p = (uint8_t *)ui;
     for (size_t i = 0; i < sizeof(*ui); ++i)
         p[i] = 0;
+    ui_perf_init();
+#if UI_LCD_HW && !defined(UI_PIXEL_SIM)
+    ui_lcd_pace_stats(NULL, &ui->pace_missed);
+#endif
+}
+
+/* With an empty dirty set the page renders exactly as last tick, except for
+ * inputs the dirty functions do not see: trip figures and animation steps. */
+static uint8_t ui_page_hash_reusable(const ui_state_t *ui, uint16_t dist_d10, uint16_t wh_d10)
+{
+    if (!ui->page_hash_valid)
+        return 0u;
+    if (ui->page_hash_dist_d10 != dist_d10 || ui->page_hash_wh_d10 != wh_d10)
+        return 0u;
+    if (ui->warn_pulse_steps || ui->chip_pop_assist_steps || ui->chip_pop_gear_steps ||
+        ui->accent_sweep_steps || ui->regen_glow_steps)
+        return 0u;
+    return 1u;
+}
+
+static uint8_t ui_animating(const ui_state_t *ui)
+{
+    return (ui->warn_pulse_steps || ui->chip_pop_assist_steps || ui->chip_pop_gear_steps ||
+            ui->accent_sweep_steps || ui->regen_glow_steps || ui->chunk_pending) ? 1u : 0u;
+}
+
+uint16_t ui_frame_interval_ms(const ui_state_t *ui)
+{
+    if (!ui || ui->frame_request)
+        return UI_TICK_FAST_MS;
+    if (ui->static_frames == 0u)
+        return ui->pace_backoff ? UI_TICK_MS : UI_TICK_FAST_MS;
+    return (ui->static_frames < UI_IDLE_FRAMES) ? UI_TICK_MS : UI_TICK_IDLE_MS;
+}
+
+void ui_request_frame(ui_state_t *ui)
+{
+    if (ui)
+        ui->frame_request = 1u;
+}
+
+bool ui_render_pending(const ui_state_t *ui)
+{
+    return ui && ui->chunk_pending;
+}
+
+/* After a chunk: either the frame is complete or the next chunk starts at
+ * the op the budget stopped on. */
+static void chunk_end(ui_state_t *ui, const ui_render_ctx_t *ctx)
+{
+    if (ctx->op_cut)
+    {
+        ui->chunk_done = ctx->op_cut;
+        ui->chunk_pending = 1u;
+        return;
+    }
+    ui->chunk_pending = 0u;
+#ifdef UI_PIXEL_SIM
+    ui_pixel_sink_end();
+#endif
+}
+
+/* Draws on from where the frame in flight stopped, with the model it began
+ * with (prev); without a budget, everything that is left. Continuation
+ * chunks skip the tear pacing since the frame is already on the panel. */
+static void chunk_continue(ui_state_t *ui, uint8_t budgeted)
+{
+    const ui_model_t *m = &ui->prev;
+    uint32_t t0 = ui_perf_now();
+    ui_perf_frame_begin(&ui->perf);
+    ui_render_ctx_t ctx = {.ui = ui, .palette = ui_theme_palette(m->theme), .tints = ui_theme_tints(m->theme),
+                           .chunked = 1u, .chunk_budget = budgeted, .chunk_t0 = t0};
+#ifdef UI_PIXEL_SIM
+    ui_pixel_sink_resume();
+#elif UI_LCD_HW
+    ui_lcd_frame_resume();
+#endif
+    render_page(&ctx, m, ui->chunk_dist_d10, ui->chunk_wh_d10);
+#if UI_LCD_HW && !defined(UI_PIXEL_SIM)
+    ui_lcd_frame_end();
+#endif
+    chunk_end(ui, &ctx);
+    ui->chunks++;
+    (void)ui_perf_frame_end(&ui->perf, m->page, ui_perf_now() - t0);
+}
+
+/*
+ * Dirty rects of a screen without a partial renderer: a walk of the page
+ * that draws nothing checks each op against the frame drawn last, and only
+ * the old and new bounds of the ops that changed are redrawn. A new screen
+ * (`fresh`), a different op count or more than UI_OP_RECS ops keep `dirty`
+ * full.
+ */
+static void op_diff(ui_state_t *ui, ui_dirty_t *dirty, const ui_model_t *m, uint16_t dist_d10,
+                    uint16_t wh_d10, uint8_t fresh)
+{
+    if (fresh || ui->op_rec_page != m->page)
+        ui->op_rec_valid = 0u;
+    ui_dirty_t diff = {0};
+    ui_render_ctx_t ctx = {.ui = ui, .palette = ui_theme_palette(m->theme), .tints = ui_theme_tints(m->theme),
+                           .diff = &diff};
+    render_page(&ctx, m, dist_d10, wh_d10);
+    op_rec_close(&ctx);
+
+    uint8_t same = (ui->op_rec_valid && ctx.op_recs == ui->op_rec_count) ? 1u : 0u;
+    ui->op_rec_valid = (ctx.op_recs <= UI_OP_RECS) ? 1u : 0u;
+    ui->op_rec_count = ctx.op_recs;
+    ui->op_rec_page = m->page;
+    if (same && ui->op_rec_valid)
+        *dirty = diff;
+    else
+        ui_dirty_full(dirty);
 }
 
 bool ui_tick(ui_state_t *ui, const ui_model_t *model, uint32_t now_ms, ui_trace_t *trace)
 {
     if (!ui || !model)
         return false;
-    if ((uint32_t)(now_ms - ui->last_tick_ms) < UI_TICK_MS)
+    uint8_t due = (ui->frame_request || (uint32_t)(now_ms - ui->last_tick_ms) >= UI_TICK_FAST_MS) ? 1u : 0u;
+    if (ui->chunk_pending)
+    {
+        if (model->page != ui->prev.page || model->theme != ui->prev.theme)
+        {
+            /* The new screen repaints everything: drop the rest, start it now. */
+            ui->chunk_pending = 0u;
+#ifdef UI_PIXEL_SIM
+            ui_pixel_sink_end();
+#endif
+            due = 1u;
+        }
+        else
+        {
+            chunk_continue(ui, (uint8_t)!due);
+            if (!due)
+                return false;
+        }
+    }
+    if (!due)
         return false;
+    /* Cleared up front: input that lands while this frame draws asks for
+     * the next one. */
+    ui->frame_request = 0u;
 
-    ui_graph_sample(ui, model);
+    uint32_t perf_t0 = ui_perf_now();
+    ui_perf_frame_begin(&ui->perf);
 
     uint8_t had_prev = ui->prev_valid;
-    uint32_t start_ms = now_ms;
     ui_dirty_t dirty = {0};
     uint8_t force_full = 0u;
 
@@ -3844,7 +5458,11 @@ bool ui_tick(ui_state_t *ui, const ui_model_t *model, uint32_t now_ms, ui_trace_
         ui->prev_valid = 1u;
     }
 
-    dirty_from_page(&dirty, model, &ui->prev);
+    /* Groups the page does not read are neither compared nor copied; the
+     * switch to a page that does read them is a full redraw anyway. */
+    uint32_t changes = had_prev ? model_changes_in(model, &ui->prev, ui_page_model_deps(model->page)) : UI_CH_ALL;
+    ui->changes = changes;
+    dirty_from_page(&dirty, model, &ui->prev, changes);
     if (force_full)
     {
         dirty.full = 1u;
@@ -3867,7 +5485,7 @@ bool ui_tick(ui_state_t *ui, const ui_model_t *model, uint32_t now_ms, ui_trace_
     {
         ui->warn_pulse_phase = (uint8_t)((ui->warn_pulse_steps & 1u) == 0u);
         if (warn_prev == warn_now && model->page == UI_PAGE_DASHBOARD)
-            ui_dirty_add(&dirty, dash_v2_layout().top_area);
+            dirty_add_widget(&dirty, UI_W_DASH_TOP);
     }
     else
     {
@@ -3880,25 +5498,19 @@ bool ui_tick(ui_state_t *ui, const ui_model_t *model, uint32_t now_ms, ui_trace_
             ui->chip_pop_assist_steps = UI_CHIP_POP_STEPS;
         if (model->virtual_gear != ui->prev.virtual_gear)
             ui->chip_pop_gear_steps = UI_CHIP_POP_STEPS;
-        if (model->batt_dV != ui->prev.batt_dV ||
-            model->batt_dA != ui->prev.batt_dA ||
-            model->trip_distance_mm != ui->prev.trip_distance_mm ||
-            model->trip_energy_mwh != ui->prev.trip_energy_mwh ||
-            model->units != ui->prev.units)
-        {
+        if (changes & DASH_V2_TRAY_DEPS)
             ui->accent_sweep_steps = UI_ACCENT_SWEEP_STEPS;
-        }
     }
     if ((ui->chip_pop_assist_steps > 0u || ui->chip_pop_gear_steps > 0u) &&
         model->page == UI_PAGE_DASHBOARD)
     {
-        ui_dirty_add(&dirty, dash_v2_layout().top_area);
+        dirty_add_widget(&dirty, UI_W_DASH_TOP);
     }
     if (ui->accent_sweep_steps > 0u)
     {
         ui->accent_sweep_phase = (uint8_t)((ui->accent_sweep_steps & 1u) == 0u);
         if (model->page == UI_PAGE_DASHBOARD)
-            ui_dirty_add(&dirty, dash_v2_layout().tray_in);
+            dirty_add_widget(&dirty, UI_W_DASH_TRAY_IN);
     }
     else
     {
@@ -3920,7 +5532,7 @@ bool ui_tick(ui_state_t *ui, const ui_model_t *model, uint32_t now_ms, ui_trace_
     {
         ui->regen_glow_phase = (uint8_t)((ui->regen_glow_steps & 1u) == 0u);
         if (model->page == UI_PAGE_DASHBOARD)
-            ui_dirty_add(&dirty, dash_v2_layout().speed_in);
+            dirty_add_widget(&dirty, UI_W_DASH_SPEED_IN);
     }
     else
     {
@@ -3933,49 +5545,118 @@ bool ui_tick(ui_state_t *ui, const ui_model_t *model, uint32_t now_ms, ui_trace_
     if (trace)
         need_trip = 1u;
     if (need_trip) {
-        dist_d10 = trip_distance_d10(model);
-        wh_d10 = trip_wh_per_unit_d10(model);
+        if (!ui->trip_cache_valid || ui->trip_cache_mm != model->trip_distance_mm ||
+            ui->trip_cache_mwh != model->trip_energy_mwh || ui->trip_cache_units != model->units) {
+            ui->trip_cache_dist_d10 = trip_distance_d10(model);
+            ui->trip_cache_wh_d10 = trip_wh_per_unit_d10(model);
+            ui->trip_cache_mm = model->trip_distance_mm;
+            ui->trip_cache_mwh = model->trip_energy_mwh;
+            ui->trip_cache_units = model->units;
+            ui->trip_cache_valid = 1u;
+        }
+        dist_d10 = ui->trip_cache_dist_d10;
+        wh_d10 = ui->trip_cache_wh_d10;
     }
     const ui_palette_t *palette = ui_theme_palette(model->theme);
+    const ui_tints_t *tints = ui_theme_tints(model->theme);
     const ui_screen_def_t *screen = ui_screen_by_id(model->page);
     if (!screen)
         screen = ui_screen_by_id(UI_PAGE_DASHBOARD);
+    ui_render_partial_fn render_partial = screen->render_partial;
+    if (!render_partial)
+    {
+        render_partial = render_replay;
+        if (dirty.count || dirty.full)
+            op_diff(ui, &dirty, model, dist_d10, wh_d10, (uint8_t)(force_full || (changes & UI_CH_SCREEN)));
+    }
+
+    uint8_t draw_any = (dirty.count || dirty.full) ? 1u : 0u;
+    uint8_t draw_full = dirty.full;
+    /* A full redraw emits every op of the page, so it hashes in the same pass. */
+    uint8_t hash_fused = (trace && draw_any && draw_full) ? 1u : 0u;
 
-    if (trace) {
+    if (!trace) {
+        ui->hash = 0u;
+        ui->page_hash_valid = 0u;
+    } else if (hash_fused) {
+        ui->hash = 0xFFFFFFFFu;
+    } else if (!draw_any && ui_page_hash_reusable(ui, dist_d10, wh_d10)) {
+        ui->hash = ui->page_hash;
+    } else {
         ui->hash = 0xFFFFFFFFu;
-        ui_render_ctx_t hash_ctx = {ui, palette, 1u, 0u, 0u};
+        ui_render_ctx_t hash_ctx = {.ui = ui, .palette = palette, .tints = tints, .hash_enabled = 1u};
         render_page(&hash_ctx, model, dist_d10, wh_d10);
         ui->hash = ~ui->hash;
-    } else {
-        ui->hash = 0u;
+    }
+
+    /* Another screen is about to overwrite the dashboard cells. */
+    if (screen->render_full != render_dashboard)
+    {
+        ui->dash_cache.speed_valid = 0u;
+        ui->dash_cache.tray_valid = 0u;
     }
 
     ui->draw_ops = 0u;
-    if (dirty.count || dirty.full)
+    if (draw_any)
     {
-        ui_render_ctx_t draw_ctx = {ui, palette, 0u, 1u, 1u};
+        uint8_t chunked = (draw_full && (screen->flags & UI_SCREEN_FLAG_PROGRESSIVE)) ? 1u : 0u;
+        ui_render_ctx_t draw_ctx = {.ui = ui, .palette = palette, .tints = tints, .hash_enabled = hash_fused,
+                                    .count_ops = 1u, .draw_enabled = 1u, .chunked = chunked,
+                                    .chunk_budget = chunked, .chunk_t0 = ui_perf_now()};
+        if (chunked)
+        {
+            ui->chunk_done = 0u;
+            ui->chunk_dist_d10 = dist_d10;
+            ui->chunk_wh_d10 = wh_d10;
+        }
 #ifdef UI_PIXEL_SIM
         ui_pixel_sink_begin(now_ms, dirty.full);
+#elif UI_LCD_HW
+        ui_lcd_frame_begin(dirty_band_y0(&dirty), dirty_band_y1(&dirty));
 #endif
-        if (dirty.full || !screen || !screen->render_partial)
+        if (draw_full)
         {
             render_page(&draw_ctx, model, dist_d10, wh_d10);
         }
         else
         {
-            screen->render_partial(&draw_ctx, model, dist_d10, wh_d10, &dirty);
+            render_partial(&draw_ctx, model, dist_d10, wh_d10, &dirty);
         }
+#if UI_LCD_HW && !defined(UI_PIXEL_SIM)
+        ui_lcd_frame_end();
+        /* With the compositor the pacing runs at frame_end, so the miss
+         * count is read once the frame is out. */
+        uint32_t pace_missed;
+        ui_lcd_pace_stats(NULL, &pace_missed);
+        if (pace_missed != ui->pace_missed)
+            ui->pace_backoff = UI_PACE_BACKOFF_FRAMES;
+        else if (ui->pace_backoff)
+            ui->pace_backoff--;
+        ui->pace_missed = pace_missed;
+#endif
+        if (draw_ctx.chunked)
+            chunk_end(ui, &draw_ctx);
 #ifdef UI_PIXEL_SIM
-        ui_pixel_sink_end();
+        else
+            ui_pixel_sink_end();
 #endif
+        if (hash_fused)
+            ui->hash = ~ui->hash;
     }
+    uint32_t render_us = 0u;
+    if (draw_any)
+        render_us = ui_perf_frame_end(&ui->perf, model->page, ui_perf_now() - perf_t0);
 
     if (trace)
     {
+        ui->page_hash = ui->hash;
+        ui->page_hash_dist_d10 = dist_d10;
+        ui->page_hash_wh_d10 = wh_d10;
+        ui->page_hash_valid = 1u;
         trace->hash = ui->hash;
         trace->dirty_count = dirty.count;
         trace->draw_ops = ui->draw_ops;
-        trace->render_ms = (uint16_t)((now_ms - start_ms) & 0xFFFFu);
+        trace->render_ms = (uint16_t)((render_us / 1000u) & 0xFFFFu);
         trace->full = dirty.full;
         trace->page = model->page;
         trace->trip_distance_d10 = dist_d10;
@@ -3993,7 +5674,15 @@ bool ui_tick(ui_state_t *ui, const ui_model_t *model, uint32_t now_ms, ui_trace_
     if (ui->regen_glow_steps > 0u)
         ui->regen_glow_steps--;
 
-    ui->prev = *model;
+    if (changes || ui_animating(ui))
+        ui->static_frames = 0u;
+    else if (ui->static_frames < 0xFFu)
+        ui->static_frames++;
+
+    if (had_prev)
+        model_copy_changed(&ui->prev, model, changes);
+    else
+        ui->prev = *model;
     ui->last_tick_ms = now_ms;
     return true;
 }
@@ -4122,6 +5811,55 @@ size_t ui_format_dashboard_trace(char *out, size_t len, const ui_model_t *model,
     return (size_t)(ptr - out);
 }
 
+size_t ui_pack_engineer_trace(uint8_t *out, size_t len, const ui_model_t *m)
+{
+    if (!m)
+        return 0;
+    trace_rec_ui_eng_t r = {0};
+    r.speed_dmph = m->speed_dmph;
+    r.rpm = m->rpm;
+    r.cadence_rpm = m->cadence_rpm;
+    r.torque_raw = m->torque_raw;
+    r.batt_dV = m->batt_dV;
+    r.batt_dA = m->batt_dA;
+    r.phase_dA = m->phase_dA;
+    r.sag_margin_dV = m->sag_margin_dV;
+    r.thermal_state = m->thermal_state;
+    r.ctrl_temp_dC = m->ctrl_temp_dC;
+    r.limit_power_w = m->limit_power_w;
+    r.page = m->page;
+    r.throttle_pct = m->throttle_pct;
+    r.brake = m->brake;
+    r.buttons = m->buttons;
+    r.soc_pct = m->soc_pct;
+    r.err = m->err;
+    r.limit_reason = m->limit_reason;
+    return trace_bin_pack(out, len, TRACE_SCHEMA_UI_ENG, &r, sizeof(r));
+}
+
+size_t ui_pack_dashboard_trace(uint8_t *out, size_t len, const ui_model_t *model,
+                               const ui_trace_t *trace, uint32_t now_ms)
+{
+    if (!model || !trace)
+        return 0;
+    trace_rec_ui_t r = {0};
+    r.ms = now_ms;
+    r.hash = trace->hash;
+    r.render_ms = trace->render_ms;
+    r.speed_dmph = model->speed_dmph;
+    r.cadence_rpm = model->cadence_rpm;
+    r.power_w = model->power_w;
+    r.batt_dV = model->batt_dV;
+    r.batt_dA = model->batt_dA;
+    r.limit_power_w = model->limit_power_w;
+    r.dirty_count = trace->dirty_count;
+    r.draw_ops = trace->draw_ops;
+    r.soc_pct = model->soc_pct;
+    r.limit_reason = model->limit_reason;
+    r.page = trace->page;
+    return trace_bin_pack(out, len, TRACE_SCHEMA_UI, &r, sizeof(r));
+}
+
 size_t ui_registry_format_trace(char *out, size_t len)
 {
     if (!out || len == 0)
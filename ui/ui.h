@@ -5,8 +5,23 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "ui_draw_common.h"
+#include "ui_perf.h"
+
 #define UI_TICK_MS 200u
-#define UI_GRAPH_SAMPLES 150u /* 30s window @ 5 Hz (UI_TICK_MS=200) */
+/* Adaptive frame pacing (ui_frame_interval_ms): UI_TICK_FAST_MS while the
+ * model changes or an animation runs, UI_TICK_MS once it settles, and
+ * UI_TICK_IDLE_MS after UI_IDLE_FRAMES frames with nothing to draw. */
+#define UI_TICK_FAST_MS 100u
+#define UI_TICK_IDLE_MS 1000u
+#define UI_IDLE_FRAMES 10u
+/* A frame whose scanline pacing timed out (ui_lcd_pace_stats missed) holds
+ * the rate at UI_TICK_MS for this many frames: each miss is a torn frame
+ * plus a full pacing spin, and the fast rate would double both. */
+#define UI_PACE_BACKOFF_FRAMES 20u
+/* Per-tick draw time for a progressive full redraw (UI_SCREEN_FLAG_PROGRESSIVE). */
+#define UI_RENDER_CHUNK_US 5000u
+#define UI_GRAPH_COLS 184u /* graph plot width in px: one min/max span each */
 #define UI_GRAPH_CH_SPEED 0u
 #define UI_GRAPH_CH_POWER 1u
 #define UI_GRAPH_CH_VOLT  2u
@@ -36,6 +51,7 @@ typedef enum {
     UI_PAGE_AMBIENT = 16,
     UI_PAGE_ABOUT = 17,
     UI_PAGE_POWER = 18,  /* Consolidated Battery+Thermal screen */
+    UI_PAGE_ENGINEER_PERF = 19,
 } ui_page_t;
 
 /* Screen visibility categories */
@@ -137,6 +153,12 @@ typedef struct {
     uint32_t trip_moving_ms;
     uint32_t trip_assist_ms;
     uint32_t trip_gear_ms;
+    /* Trip page: 0 = live ride, n = n-th most recent stored ride; the
+     * trip_* fields above then hold that ride and these two replace the
+     * assist/gear cards. */
+    uint16_t trip_view;
+    uint32_t trip_elapsed_ms;
+    uint16_t trip_p95_speed_dmph;
     uint8_t units; /* 0=imperial, 1=metric */
     uint8_t theme;
     uint8_t mode;  /* 0=street/legal, 1=private */
@@ -155,6 +177,10 @@ typedef struct {
     uint8_t walk_state; /* 0=off, 1=active, 2=cancelled, 3=disabled */
     uint16_t link_timeouts;
     uint16_t link_rx_errors;
+    uint16_t link_crc_errors;
+    uint16_t link_frame_errors;
+    uint16_t link_outages;
+    uint16_t link_rate_x10;   /* busiest RX opcode, frames/s x10 */
     uint8_t settings_index;
     uint8_t focus_metric;
     uint8_t button_map;
@@ -183,8 +209,15 @@ typedef struct {
     uint16_t alert_age_s[3];
     uint16_t alert_dist_d10[3];
     uint8_t graph_channel;
-    uint8_t graph_window_s;
+    uint16_t graph_window_s;
     uint8_t graph_sample_hz;
+    /* Strip chart from the telemetry graph pyramid: per-column min/max,
+     * oldest first, graph_cols of them (fewer while history is short);
+     * graph_pos numbers the newest column and only grows as time passes. */
+    uint16_t graph_cols;
+    uint32_t graph_pos;
+    int16_t graph_min[UI_GRAPH_COLS];
+    int16_t graph_max[UI_GRAPH_COLS];
     uint8_t bus_diff;
     uint8_t bus_changed_only;
     uint8_t bus_entries;
@@ -204,8 +237,70 @@ typedef struct {
     uint8_t gear_shape;
     uint16_t gear_min_pct;
     uint16_t gear_max_pct;
+    /* Render timing snapshot (ui_perf) for the engineer perf page. */
+    uint32_t perf_frame_us;
+    uint32_t perf_avg_us;
+    uint32_t perf_max_us;
+    uint16_t perf_over_budget;
+    uint8_t perf_worst_page;
+    uint32_t perf_prim_us[UI_PERF_PRIM_COUNT];
+    uint16_t perf_draw_ops;     /* last frame */
+    uint32_t sched_max_us;      /* slowest scheduler task run */
+    uint32_t sched_ewma_us;     /* highest per-slot EWMA */
+    uint32_t sched_overruns;    /* overruns + late starts, all slots */
+    /* Per mille of the last second: main loop awake, handler groups
+     * (platform/irq_load.h) and SPI flash DMA. */
+    uint16_t loop_permille;
+    uint16_t isr_tim2_permille;
+    uint16_t isr_usart_permille;
+    uint16_t isr_dma_permille;
+    uint16_t flash_permille;
+    uint32_t flash_erases;       /* since boot, storage/flash_health.h */
+    uint32_t flash_block_max_us; /* longest wait for an erase/program */
+    uint16_t wq_hwm;            /* work queue */
+    uint16_t evq_hwm;           /* deepest event bus lane */
 } ui_model_t;
 
+/*
+ * Model field groups. ui_tick diffs the model against the last drawn one
+ * once per tick into a mask of these; screens list the groups they draw
+ * from (ui_screen_def_t.deps), only those are compared (ui_page_model_deps)
+ * and only changed groups are copied forward.
+ * Every ui_model_t field belongs to exactly one group (UI_MODEL_FIELDS in
+ * ui.c), so a new field needs an entry there.
+ */
+#define UI_CH_SCREEN     (1u << 0)  /* page, theme */
+#define UI_CH_UNITS      (1u << 1)
+#define UI_CH_MODE       (1u << 2)  /* street/private */
+#define UI_CH_SPEED      (1u << 3)
+#define UI_CH_POWER      (1u << 4)
+#define UI_CH_LIMIT      (1u << 5)  /* power limit and its reason */
+#define UI_CH_PEDAL      (1u << 6)  /* rpm, cadence, torque, throttle */
+#define UI_CH_BRAKE      (1u << 7)
+#define UI_CH_BUTTONS    (1u << 8)
+#define UI_CH_ASSIST     (1u << 9)  /* assist level, gear, walk */
+#define UI_CH_SOC        (1u << 10)
+#define UI_CH_BATT       (1u << 11) /* pack voltage/current, phase, sag */
+#define UI_CH_RANGE      (1u << 12)
+#define UI_CH_THERMAL    (1u << 13)
+#define UI_CH_ERR        (1u << 14)
+#define UI_CH_TRIP       (1u << 15) /* trip distance and energy */
+#define UI_CH_TRIP_STATS (1u << 16) /* the rest of the trip page */
+#define UI_CH_CRUISE     (1u << 17)
+#define UI_CH_REGEN      (1u << 18)
+#define UI_CH_LINK       (1u << 19) /* motor link counters */
+#define UI_CH_BUS        (1u << 20) /* bus monitor traffic */
+#define UI_CH_SETTINGS   (1u << 21)
+#define UI_CH_PROFILE    (1u << 22)
+#define UI_CH_TUNE       (1u << 23)
+#define UI_CH_CAPTURE    (1u << 24)
+#define UI_CH_ALERTS     (1u << 25)
+#define UI_CH_GRAPH      (1u << 26)
+#define UI_CH_PERF       (1u << 27)
+#define UI_CH_BUS_VIEW   (1u << 28) /* bus diff, changed-only and filters */
+#define UI_CH_DRIVE      (1u << 29) /* drive mode, boost countdown */
+#define UI_CH_ALL        ((1u << 30) - 1u)
+
 typedef struct ui_render_ctx ui_render_ctx_t;
 typedef struct ui_dirty ui_dirty_t;
 
@@ -214,17 +309,26 @@ typedef void (*ui_render_full_fn)(ui_render_ctx_t *ctx, const ui_model_t *model,
 typedef void (*ui_render_partial_fn)(ui_render_ctx_t *ctx, const ui_model_t *model,
                                      uint16_t trip_distance_d10, uint16_t trip_wh_per_unit_d10,
                                      const ui_dirty_t *dirty);
-typedef void (*ui_dirty_fn)(ui_dirty_t *dirty, const ui_model_t *model, const ui_model_t *prev);
+/* Turns the tick's UI_CH_* changes (already known to touch deps) into dirty rects. */
+typedef void (*ui_dirty_fn)(ui_dirty_t *dirty, const ui_model_t *model, const ui_model_t *prev,
+                            uint32_t changes);
 
 #define UI_SCREEN_FLAG_PARTIAL 0x01u
+/* Full redraws are drawn in UI_RENDER_CHUNK_US chunks over several ticks. */
+#define UI_SCREEN_FLAG_PROGRESSIVE 0x02u
 
 typedef struct {
     uint8_t id;
     uint8_t flags;
     const char *name;
     ui_render_full_fn render_full;
+    /* NULL: render_full replays under the scissor, once per dirty rect. */
     ui_render_partial_fn render_partial;
+    /* NULL: any change in deps redraws the whole screen, or with no
+     * render_partial either only the ops that changed (UI_OP_RECS). */
     ui_dirty_fn dirty_fn;
+    uint32_t deps; /* UI_CH_* groups the screen draws from */
+    uint8_t vis;   /* UI_VIS_*; 0 is a user screen */
 } ui_screen_def_t;
 
 typedef struct {
@@ -238,15 +342,64 @@ typedef struct {
     uint16_t trip_wh_per_unit_d10;
 } ui_trace_t;
 
+#define UI_DASH_CACHE_TEXT 12u
+
+/* What the dashboard speed/tray cells last drew (retained-mode redraw). */
+typedef struct {
+    uint8_t speed_valid;
+    uint8_t units;
+    uint8_t ticks;
+    uint16_t card_fill;
+    uint16_t accent;
+    uint16_t text;
+    uint16_t gauge_active;
+    uint16_t spd;
+    uint16_t active_sweep;
+    ui_rect_t digit_box;
+    /* Values behind the cached text; compared instead of the strings. */
+    uint16_t pwr_w;
+    uint16_t rng_d10;
+    char pwr[UI_DASH_CACHE_TEXT];
+    char rng[UI_DASH_CACHE_TEXT];
+    uint8_t tray_valid;
+    uint8_t tray_units;
+    uint8_t sweep_phase;
+    uint16_t tray_fill;
+    uint16_t tray_text;
+    int32_t tray_v[4];
+    char tray[4][UI_DASH_CACHE_TEXT];
+} ui_dash_cache_t;
+
+#define UI_FMT_SLOT_BITS 5u
+#define UI_FMT_SLOTS (1u << UI_FMT_SLOT_BITS)
+#define UI_FMT_TEXT 32u
+
+/* A numeric widget's last formatted text and the inputs that produced it. */
+typedef struct {
+    const char *label;
+    uint32_t value;
+    uint16_t x;
+    uint16_t y;
+    uint8_t kind; /* 0: empty */
+    uint8_t units;
+    char text[UI_FMT_TEXT];
+} ui_fmt_slot_t;
+
+/* Screens without their own partial renderer are diffed op by op against
+ * the frame last drawn; past UI_OP_RECS ops they redraw in full. */
+#define UI_OP_RECS 96u
+
+typedef struct {
+    uint32_t sig;  /* op id and parameters */
+    ui_rect_t box; /* covers every pixel the op writes */
+} ui_op_rec_t;
+
 typedef struct {
     ui_model_t prev;
     uint32_t last_tick_ms;
     uint32_t hash;
     uint16_t draw_ops;
     uint8_t prev_valid;
-    uint8_t graph_head;
-    uint8_t graph_count;
-    uint8_t graph_channel;
     uint8_t warn_pulse_steps;
     uint8_t warn_pulse_phase;
     uint8_t chip_pop_assist_steps;
@@ -255,15 +408,71 @@ typedef struct {
     uint8_t accent_sweep_phase;
     uint8_t regen_glow_steps;
     uint8_t regen_glow_phase;
-    uint16_t graph_samples[UI_GRAPH_SAMPLES];
+    ui_dash_cache_t dash_cache;
+    ui_fmt_slot_t fmt[UI_FMT_SLOTS]; /* by widget x/y, direct-mapped */
+    ui_op_rec_t op_recs[UI_OP_RECS];
+    uint16_t op_rec_count;
+    uint8_t op_rec_page;
+    uint8_t op_rec_valid;
+    ui_perf_t perf;
+    /* Last traced page hash; reused while nothing on the page is dirty. */
+    uint32_t page_hash;
+    uint16_t page_hash_dist_d10;
+    uint16_t page_hash_wh_d10;
+    uint8_t page_hash_valid;
+    /* Trip distance and Wh/unit, recomputed only when their inputs change. */
+    uint32_t trip_cache_mm;
+    uint32_t trip_cache_mwh;
+    uint16_t trip_cache_dist_d10;
+    uint16_t trip_cache_wh_d10;
+    uint8_t trip_cache_units;
+    uint8_t trip_cache_valid;
+    /* Progressive redraw in flight: the first chunk_done draw ops of `prev`
+     * are on the panel and the next ui_tick draws on from there. */
+    uint16_t chunk_done;
+    uint16_t chunk_dist_d10;
+    uint16_t chunk_wh_d10;
+    uint8_t chunk_pending;
+    uint32_t changes; /* UI_CH_* groups that changed on the last tick */
+    uint32_t chunks; /* progressive chunks drawn after a frame's first */
+    uint8_t static_frames; /* frames in a row with no change or animation */
+    uint8_t frame_request;
+    uint8_t pace_backoff; /* frames left at UI_TICK_MS after a missed vsync */
+    uint32_t pace_missed; /* ui_lcd_pace_stats missed count, as of the last frame */
 } ui_state_t;
 
 void ui_init(ui_state_t *ui);
 bool ui_tick(ui_state_t *ui, const ui_model_t *model, uint32_t now_ms, ui_trace_t *trace);
+/* ui_tick draws at most one frame per UI_TICK_FAST_MS; the caller paces
+ * frames at the period this returns, as of the last frame drawn. */
+uint16_t ui_frame_interval_ms(const ui_state_t *ui);
+/* Input landed: the next ui_tick draws at once, whatever the pacing. */
+void ui_request_frame(ui_state_t *ui);
+/* A progressive redraw has chunks left. Calling ui_tick again draws the next
+ * one without waiting for the frame period and returns false: the frame's trace
+ * went out with its first chunk. Once the next tick is due the rest is drawn
+ * in one go, so a frame never spans more than one UI period. */
+bool ui_render_pending(const ui_state_t *ui);
+/* UI_CH_* groups whose fields differ between m and prev (all for NULL). */
+uint32_t ui_model_changes(const ui_model_t *m, const ui_model_t *prev);
+/* UI_CH_* groups a tick on `page` reads (all for an unknown page). The model
+ * only needs those filled in; ui_tick neither compares nor keeps the rest. */
+uint32_t ui_page_model_deps(uint8_t page);
+/* Called between draw ops while ui_tick draws, so input that lands during
+ * a long redraw is handled without waiting for the frame. The hook must not
+ * touch the LCD or the model being drawn. NULL disables it. */
+typedef void (*ui_preempt_fn)(void);
+void ui_set_preempt_hook(ui_preempt_fn fn);
+/* Finds an icon sprite by asset ID (storage/ui_assets.h pack); icons with
+ * no sprite, or with no lookup set, are drawn from primitives. */
+typedef int (*ui_sprite_lookup_fn)(uint32_t id, ui_sprite_t *out);
+void ui_set_sprite_lookup(ui_sprite_lookup_fn fn);
 
 uint8_t ui_page_from_buttons(uint8_t short_press, uint8_t long_press, uint8_t current_page);
 const char *ui_page_name(uint8_t page);
 uint8_t ui_registry_count(void);
+/* Page id of registry entry `index` (every ui_screen_def_t, not just the layout). */
+uint8_t ui_registry_page(uint8_t index);
 uint8_t ui_registry_layout_count(void);
 uint8_t ui_registry_layout_get(uint8_t index);
 uint8_t ui_registry_index(uint8_t page);
@@ -271,6 +480,20 @@ size_t ui_registry_format_trace(char *out, size_t len);
 
 void ui_dirty_add(ui_dirty_t *dirty, ui_rect_t rect);
 void ui_dirty_full(ui_dirty_t *dirty);
+#ifdef HOST_TEST
+/* One cleared dirty set (static) for driving ui_dirty_add directly. */
+ui_dirty_t *ui_dirty_host_reset(void);
+uint8_t ui_dirty_count(const ui_dirty_t *dirty);
+ui_rect_t ui_dirty_rect(const ui_dirty_t *dirty, uint8_t index);
+#endif
+
+/* Clip stack for the ui_draw_* calls below: each push narrows the clip to
+ * its intersection with the one below, and primitives whose bounds miss it
+ * are dropped before any LCD traffic (counted in ui_perf_t.culled). Pixels
+ * are cut to it by the LCD scissor. Pops must pair with pushes. */
+#define UI_CLIP_DEPTH 4u
+void ui_clip_push(ui_render_ctx_t *ctx, ui_rect_t rect);
+void ui_clip_pop(ui_render_ctx_t *ctx);
 
 void ui_draw_round_rect(ui_render_ctx_t *ctx, ui_rect_t rect, uint16_t color, uint8_t radius);
 void ui_draw_rect(ui_render_ctx_t *ctx, ui_rect_t rect, uint16_t color);
@@ -296,5 +519,9 @@ uint8_t ui_theme_normalize(uint8_t theme_id);
 size_t ui_format_engineer_trace(char *out, size_t len, const ui_model_t *model);
 size_t ui_format_dashboard_trace(char *out, size_t len, const ui_model_t *model,
                                   const ui_trace_t *trace, uint32_t now_ms);
+/* Binary counterparts (src/core/trace_bin.h records), same fields. */
+size_t ui_pack_engineer_trace(uint8_t *out, size_t len, const ui_model_t *model);
+size_t ui_pack_dashboard_trace(uint8_t *out, size_t len, const ui_model_t *model,
+                               const ui_trace_t *trace, uint32_t now_ms);
 
 #endif
@@ -0,0 +1,113 @@
+#include "ui_glyph_cache.h"
+
+#include <string.h>
+
+#include "platform/ram.h"
+
+typedef struct {
+    uint32_t addr;
+    uint16_t off;
+    uint16_t len; /* 0: rejected, remembered so it is not read again */
+} glyph_slot_t;
+
+static struct {
+    ui_glyph_read_fn read;
+    uint32_t tag;
+    glyph_slot_t slots[UI_GLYPH_CACHE_SLOTS];
+    uint8_t n;
+    uint16_t used;
+    ui_glyph_cache_stats_t stats;
+} g_glyphs;
+
+/* A slot lists its range only once the range has been read in. */
+static uint8_t g_glyph_pool[UI_GLYPH_CACHE_BYTES] RAM_NOZERO;
+
+void ui_glyph_cache_set_read(ui_glyph_read_fn fn)
+{
+    g_glyphs.read = fn;
+    ui_glyph_cache_reset();
+}
+
+static void glyph_flush(uint32_t tag)
+{
+    g_glyphs.tag = tag;
+    g_glyphs.n = 0u;
+    g_glyphs.used = 0u;
+}
+
+void ui_glyph_cache_reset(void)
+{
+    glyph_flush(0u);
+    memset(&g_glyphs.stats, 0, sizeof(g_glyphs.stats));
+}
+
+/* Every row must decode and the rows must fit the stream. */
+static uint8_t glyph_rows_ok(const uint8_t *rle, uint32_t len, uint16_t w, uint16_t h)
+{
+    uint8_t alpha[UI_GLYPH_MAX_W];
+    uint32_t off = 0u;
+    for (uint16_t row = 0; row < h; ++row)
+    {
+        uint32_t used = ui_draw_a4_rle_alpha(&rle[off], len - off, w, alpha);
+        if (used == 0u)
+            return 0u;
+        off += used;
+    }
+    return 1u;
+}
+
+static const uint8_t *glyph_reject(const ui_sprite_t *sp)
+{
+    g_glyphs.stats.rejects++;
+    if (g_glyphs.n < UI_GLYPH_CACHE_SLOTS)
+        g_glyphs.slots[g_glyphs.n++] = (glyph_slot_t){sp->addr, 0u, 0u};
+    return NULL;
+}
+
+const uint8_t *ui_glyph_cache_get(const ui_sprite_t *sp)
+{
+    if (!sp || !g_glyphs.read)
+        return NULL;
+    if (sp->tag != g_glyphs.tag)
+    {
+        if (g_glyphs.n)
+            g_glyphs.stats.flushes++;
+        glyph_flush(sp->tag);
+    }
+    for (uint8_t i = 0; i < g_glyphs.n; ++i)
+    {
+        const glyph_slot_t *s = &g_glyphs.slots[i];
+        if (s->addr != sp->addr)
+            continue;
+        if (s->len == 0u)
+            return NULL;
+        g_glyphs.stats.hits++;
+        return &g_glyph_pool[s->off];
+    }
+
+    if (sp->fmt != UI_SPRITE_FMT_A4_RLE || sp->w > UI_GLYPH_MAX_W || sp->len == 0u ||
+        sp->len > UI_GLYPH_CACHE_BYTES)
+        return glyph_reject(sp);
+    if (g_glyphs.n >= UI_GLYPH_CACHE_SLOTS || sp->len > UI_GLYPH_CACHE_BYTES - g_glyphs.used)
+    {
+        g_glyphs.stats.flushes++;
+        glyph_flush(sp->tag);
+    }
+    uint8_t *dst = &g_glyph_pool[g_glyphs.used];
+    g_glyphs.read(sp->addr, dst, sp->len);
+    g_glyphs.stats.loads++;
+    if (!glyph_rows_ok(dst, sp->len, sp->w, sp->h))
+        return glyph_reject(sp);
+    g_glyphs.slots[g_glyphs.n++] = (glyph_slot_t){sp->addr, g_glyphs.used, sp->len};
+    g_glyphs.used = (uint16_t)(g_glyphs.used + sp->len);
+    return dst;
+}
+
+void ui_glyph_cache_get_stats(ui_glyph_cache_stats_t *out)
+{
+    if (!out)
+        return;
+    *out = g_glyphs.stats;
+    out->used = g_glyphs.used;
+    out->entries = g_glyphs.n;
+}
@@ -0,0 +1,38 @@
+#ifndef OPEN_FIRMWARE_UI_GLYPH_CACHE_H
+#define OPEN_FIRMWARE_UI_GLYPH_CACHE_H
+
+#include <stdint.h>
+
+#include "ui_draw_common.h"
+
+/*
+ * RAM copies of the big-digit glyphs (A4 sprites in the asset pack), so a
+ * speed change draws from SRAM instead of re-reading SPI flash. A glyph is
+ * cached whole, keyed by its flash address under the current pack tag, and
+ * its rows are checked once on load. When a new glyph does not fit the pool
+ * starts over: the handful of digits one frame shows stays resident (a
+ * scale 5 digit is about 1.5 KB) without an allocator.
+ */
+#define UI_GLYPH_CACHE_BYTES 6144u
+#define UI_GLYPH_CACHE_SLOTS 10u
+
+typedef void (*ui_glyph_read_fn)(uint32_t addr, uint8_t *out, uint32_t len);
+
+typedef struct {
+    uint32_t hits;
+    uint32_t loads;   /* glyphs read from flash */
+    uint32_t flushes; /* pool restarts (full, or a new pack) */
+    uint32_t rejects; /* not A4, too big for the pool, or rows that do not decode */
+    uint16_t used;    /* pool bytes in use */
+    uint8_t entries;
+} ui_glyph_cache_stats_t;
+
+/* Flash read used to fill the cache (spi_flash_read); none: every get fails. */
+void ui_glyph_cache_set_read(ui_glyph_read_fn fn);
+/* The A4 stream of `sp` in RAM, or NULL when the glyph cannot be used. The
+ * pointer is valid until the next get, which may restart the pool. */
+const uint8_t *ui_glyph_cache_get(const ui_sprite_t *sp);
+void ui_glyph_cache_reset(void);
+void ui_glyph_cache_get_stats(ui_glyph_cache_stats_t *out);
+
+#endif
@@ -0,0 +1,173 @@
+#include "ui_perf.h"
+
+#if defined(HOST_TEST)
+/* <time.h> is shadowed by platform/time.h on the include path. */
+#include <sys/time.h>
+#else
+#include "platform/clock.h"
+#include "platform/hw.h"
+#include "platform/mmio.h"
+#endif
+
+static const uint32_t k_ui_perf_bucket_us[UI_PERF_HIST_BUCKETS - 1u] = {
+    2000u, 5000u, 10000u, 20000u, 50000u, 100000u, 200000u,
+};
+
+/* Host counts microseconds directly. */
+static uint32_t g_ui_perf_cycles_per_us = 1u;
+
+void ui_perf_init(void)
+{
+#if !defined(HOST_TEST)
+    uint32_t mhz = rcc_get_hclk_hz_fallback() / 1000000u;
+    g_ui_perf_cycles_per_us = mhz ? mhz : 1u;
+    mmio_write32(DEMCR, mmio_read32(DEMCR) | DEMCR_TRCENA);
+    if ((mmio_read32(DWT_CTRL) & DWT_CTRL_CYCCNTENA) == 0u)
+    {
+        mmio_write32(DWT_CYCCNT, 0u);
+        mmio_write32(DWT_CTRL, mmio_read32(DWT_CTRL) | DWT_CTRL_CYCCNTENA);
+    }
+#endif
+}
+
+uint32_t ui_perf_now(void)
+{
+#if defined(HOST_TEST)
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return (uint32_t)((uint64_t)tv.tv_sec * 1000000u + (uint64_t)tv.tv_usec);
+#else
+    return mmio_read32(DWT_CYCCNT);
+#endif
+}
+
+uint32_t ui_perf_cycles_to_us(uint32_t cycles)
+{
+    return cycles / g_ui_perf_cycles_per_us;
+}
+
+void ui_perf_reset(ui_perf_t *perf)
+{
+    if (!perf)
+        return;
+    uint8_t *p = (uint8_t *)perf;
+    for (uint32_t i = 0; i < sizeof(*perf); ++i)
+        p[i] = 0u;
+}
+
+void ui_perf_frame_begin(ui_perf_t *perf)
+{
+    if (!perf)
+        return;
+    for (uint8_t i = 0; i < UI_PERF_PRIM_COUNT; ++i)
+    {
+        perf->frame_cycles[i] = 0u;
+        perf->frame_calls[i] = 0u;
+    }
+    perf->frame_culled = 0u;
+}
+
+void ui_perf_prim_add(ui_perf_t *perf, ui_perf_prim_t prim, uint32_t cycles)
+{
+    if (!perf || (uint32_t)prim >= UI_PERF_PRIM_COUNT)
+        return;
+    perf->frame_cycles[prim] += cycles;
+    if (perf->frame_calls[prim] != 0xFFFFu)
+        perf->frame_calls[prim]++;
+}
+
+void ui_perf_cull(ui_perf_t *perf)
+{
+    if (perf && perf->frame_culled != 0xFFFFu)
+        perf->frame_culled++;
+}
+
+static uint8_t ui_perf_bucket(uint32_t us)
+{
+    uint8_t b = 0u;
+    while (b < UI_PERF_HIST_BUCKETS - 1u && us >= k_ui_perf_bucket_us[b])
+        b++;
+    return b;
+}
+
+uint32_t ui_perf_frame_end(ui_perf_t *perf, uint8_t page, uint32_t cycles)
+{
+    uint32_t us = ui_perf_cycles_to_us(cycles);
+    if (!perf)
+        return us;
+
+    for (uint8_t i = 0; i < UI_PERF_PRIM_COUNT; ++i)
+    {
+        ui_perf_prim_stat_t *p = &perf->prims[i];
+        uint32_t prim_us = ui_perf_cycles_to_us(perf->frame_cycles[i]);
+        p->last_us = prim_us;
+        p->total_us += prim_us;
+        p->calls += perf->frame_calls[i];
+    }
+
+    perf->culled += perf->frame_culled;
+    perf->last_culled = perf->frame_culled;
+    perf->last_us = us;
+    perf->last_page = page;
+    if (page >= UI_PERF_PAGES)
+        return us;
+    ui_perf_screen_t *s = &perf->screens[page];
+    s->frames++;
+    s->total_us += us;
+    s->last_us = us;
+    if (us > s->max_us)
+        s->max_us = us;
+    uint8_t b = ui_perf_bucket(us);
+    if (s->hist[b] != 0xFFFFu)
+        s->hist[b]++;
+    return us;
+}
+
+void ui_perf_screen_get(const ui_perf_t *perf, uint8_t page, ui_perf_screen_t *out)
+{
+    if (!out)
+        return;
+    uint8_t *o = (uint8_t *)out;
+    for (uint32_t i = 0; i < sizeof(*out); ++i)
+        o[i] = 0u;
+    if (!perf)
+        return;
+    if (page != UI_PERF_PAGE_ALL)
+    {
+        if (page < UI_PERF_PAGES)
+            *out = perf->screens[page];
+        return;
+    }
+    out->last_us = perf->last_us;
+    for (uint8_t p = 0; p < UI_PERF_PAGES; ++p)
+    {
+        const ui_perf_screen_t *s = &perf->screens[p];
+        out->frames += s->frames;
+        out->total_us += s->total_us;
+        if (s->max_us > out->max_us)
+            out->max_us = s->max_us;
+        for (uint8_t b = 0; b < UI_PERF_HIST_BUCKETS; ++b)
+        {
+            uint32_t v = (uint32_t)out->hist[b] + s->hist[b];
+            out->hist[b] = (uint16_t)((v > 0xFFFFu) ? 0xFFFFu : v);
+        }
+    }
+}
+
+uint8_t ui_perf_worst_page(const ui_perf_t *perf)
+{
+    uint8_t worst = UI_PERF_PAGE_ALL;
+    uint32_t worst_us = 0u;
+    if (!perf)
+        return worst;
+    for (uint8_t p = 0; p < UI_PERF_PAGES; ++p)
+    {
+        if (perf->screens[p].frames &&
+            (worst == UI_PERF_PAGE_ALL || perf->screens[p].max_us > worst_us))
+        {
+            worst_us = perf->screens[p].max_us;
+            worst = p;
+        }
+    }
+    return worst;
+}
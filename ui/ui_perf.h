@@ -0,0 +1,70 @@
+#ifndef OPEN_FIRMWARE_UI_PERF_H
+#define OPEN_FIRMWARE_UI_PERF_H
+
+#include <stdint.h>
+
+/*
+ * Render timing for ui_tick: whole-frame time per screen plus per-primitive
+ * totals. Time comes from DWT CYCCNT on target and gettimeofday() on host;
+ * both are reported in microseconds.
+ */
+
+#define UI_PERF_PAGES 20u
+#define UI_PERF_PAGE_ALL 0xFFu
+/* Frame-time buckets: <2, <5, <10, <20, <50, <100, <200 ms, then over budget. */
+#define UI_PERF_HIST_BUCKETS 8u
+
+typedef enum {
+    UI_PERF_PRIM_FILL = 0, /* rect, round rect, dither */
+    UI_PERF_PRIM_TEXT = 1, /* text, value, big digit */
+    UI_PERF_PRIM_ARC = 2,  /* ring arc, ring gauge */
+    UI_PERF_PRIM_BLIT = 3, /* battery and warning icons, sprites */
+    UI_PERF_PRIM_COUNT = 4,
+} ui_perf_prim_t;
+
+typedef struct {
+    uint32_t frames;
+    uint32_t total_us;
+    uint32_t last_us;
+    uint32_t max_us;
+    uint16_t hist[UI_PERF_HIST_BUCKETS];
+} ui_perf_screen_t;
+
+typedef struct {
+    uint32_t calls;
+    uint32_t total_us;
+    uint32_t last_us; /* summed over the last recorded frame */
+} ui_perf_prim_stat_t;
+
+typedef struct {
+    ui_perf_screen_t screens[UI_PERF_PAGES];
+    ui_perf_prim_stat_t prims[UI_PERF_PRIM_COUNT];
+    uint32_t frame_cycles[UI_PERF_PRIM_COUNT];
+    uint16_t frame_calls[UI_PERF_PRIM_COUNT];
+    /* Draws dropped by the clip stack before touching the LCD. */
+    uint32_t culled;
+    uint16_t frame_culled;
+    uint16_t last_culled;
+    uint32_t last_us;
+    uint8_t last_page;
+} ui_perf_t;
+
+/* Starts the cycle counter; safe to call more than once. */
+void ui_perf_init(void);
+uint32_t ui_perf_now(void);
+uint32_t ui_perf_cycles_to_us(uint32_t cycles);
+
+void ui_perf_reset(ui_perf_t *perf);
+void ui_perf_frame_begin(ui_perf_t *perf);
+void ui_perf_prim_add(ui_perf_t *perf, ui_perf_prim_t prim, uint32_t cycles);
+void ui_perf_cull(ui_perf_t *perf);
+/* Records a frame for `page` and returns its duration in microseconds. */
+uint32_t ui_perf_frame_end(ui_perf_t *perf, uint8_t page, uint32_t cycles);
+
+/* Copies one screen's stats, or the sum over all screens for UI_PERF_PAGE_ALL
+ * (whose last_us is the most recent frame on any screen). */
+void ui_perf_screen_get(const ui_perf_t *perf, uint8_t page, ui_perf_screen_t *out);
+/* Page with the largest max frame time, or UI_PERF_PAGE_ALL if none recorded. */
+uint8_t ui_perf_worst_page(const ui_perf_t *perf);
+
+#endif
@@ -10,6 +10,7 @@ uint8_t g_ui_settings_index;
 uint8_t g_ui_tune_index;
 uint8_t g_ui_graph_channel;
 uint8_t g_ui_graph_window_idx;
+uint16_t g_ui_trip_view;
 uint8_t g_ui_bus_offset;
 uint8_t g_ui_profile_select;
 uint8_t g_ui_profile_focus;
@@ -17,4 +18,3 @@ uint8_t g_ui_alert_index;
 uint8_t g_ui_alert_ack_mask;
 uint32_t g_ui_alert_last_seq;
 uint8_t g_alert_ack_active;
-uint32_t g_alert_ack_until_ms;
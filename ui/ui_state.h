@@ -15,6 +15,7 @@ extern uint8_t g_ui_settings_index;
 extern uint8_t g_ui_tune_index;
 extern uint8_t g_ui_graph_channel;
 extern uint8_t g_ui_graph_window_idx;
+extern uint16_t g_ui_trip_view;
 extern uint8_t g_ui_bus_offset;
 extern uint8_t g_ui_profile_select;
 extern uint8_t g_ui_profile_focus;
@@ -22,6 +23,5 @@ extern uint8_t g_ui_alert_index;
 extern uint8_t g_ui_alert_ack_mask;
 extern uint32_t g_ui_alert_last_seq;
 extern uint8_t g_alert_ack_active;
-extern uint32_t g_alert_ack_until_ms;
 
 #endif /* OPEN_FIRMWARE_UI_STATE_H */
@@ -4,9 +4,34 @@
 #include <stddef.h>
 #include <stdint.h>
 
-/* CRC32 polynomial 0xEDB88320, seed 0xFFFFFFFF, final ~ (Ethernet/PKZip). */
+/* CRC32 polynomial 0xEDB88320, seed 0xFFFFFFFF, final ~ (Ethernet/PKZip).
+ * Target builds use the MCU CRC unit for larger spans and slice-by-4 tables
+ * otherwise; results are identical either way. */
 uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t len);
 uint32_t crc32_compute(const uint8_t *data, size_t len);
 
+/* Streaming form for data that arrives in chunks (e.g. SPI flash reads). */
+typedef struct {
+    uint32_t state;
+    uint32_t bytes;
+} crc32_stream_t;
+
+static inline void crc32_stream_begin(crc32_stream_t *s)
+{
+    s->state = 0xFFFFFFFFu;
+    s->bytes = 0u;
+}
+
+static inline void crc32_stream_feed(crc32_stream_t *s, const uint8_t *data, size_t len)
+{
+    s->state = crc32_update(s->state, data, len);
+    s->bytes += (uint32_t)len;
+}
+
+static inline uint32_t crc32_stream_end(const crc32_stream_t *s)
+{
+    return ~s->state;
+}
+
 #endif
 
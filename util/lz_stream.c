@@ -0,0 +1,124 @@
+#include "util/lz_stream.h"
+
+#define LZ_TOKEN 0u
+#define LZ_LIT_EXT 1u
+#define LZ_LIT 2u
+#define LZ_OFF_LO 3u
+#define LZ_OFF_HI 4u
+#define LZ_MATCH_EXT 5u
+
+/* Longer runs than any slot holds mean a corrupt length field. */
+#define LZ_RUN_MAX 0x00FFFFFFu
+
+void lz_stream_begin(lz_stream_t *z)
+{
+    z->state = LZ_TOKEN;
+    z->failed = 0u;
+    z->offset = 0u;
+    z->pos = 0u;
+    z->flushed = 0u;
+    z->lit = 0u;
+    z->match = 0u;
+    z->produced = 0u;
+}
+
+static void lz_flush(lz_stream_t *z, lz_stream_out_fn out, void *ctx)
+{
+    if (z->pos > z->flushed)
+        out(ctx, &z->ring[z->flushed], (uint32_t)(z->pos - z->flushed));
+    z->flushed = z->pos;
+}
+
+static void lz_put(lz_stream_t *z, uint8_t b, lz_stream_out_fn out, void *ctx)
+{
+    z->ring[z->pos++] = b;
+    z->produced++;
+    if (z->pos == LZ_STREAM_WINDOW)
+    {
+        lz_flush(z, out, ctx);
+        z->pos = 0u;
+        z->flushed = 0u;
+    }
+}
+
+/* Byte by byte: a distance shorter than the length repeats the tail. */
+static uint8_t lz_copy_match(lz_stream_t *z, lz_stream_out_fn out, void *ctx)
+{
+    if (z->offset == 0u || z->offset > LZ_STREAM_WINDOW || z->offset > z->produced)
+        return 0u;
+    uint32_t src = ((uint32_t)z->pos + LZ_STREAM_WINDOW - z->offset) % LZ_STREAM_WINDOW;
+    for (; z->match; --z->match)
+    {
+        uint8_t b = z->ring[src];
+        src = (src + 1u) % LZ_STREAM_WINDOW;
+        lz_put(z, b, out, ctx);
+    }
+    z->state = LZ_TOKEN;
+    return 1u;
+}
+
+uint8_t lz_stream_feed(lz_stream_t *z, const uint8_t *in, uint32_t len, lz_stream_out_fn out, void *ctx)
+{
+    if (z->failed)
+        return 0u;
+    while (len && !z->failed)
+    {
+        if (z->state == LZ_LIT)
+        {
+            for (; z->lit && len; --z->lit, --len)
+                lz_put(z, *in++, out, ctx);
+            if (z->lit == 0u)
+                z->state = LZ_OFF_LO;
+            continue;
+        }
+        uint8_t b = *in++;
+        len--;
+        switch (z->state)
+        {
+        case LZ_TOKEN:
+            z->lit = b >> 4;
+            z->match = (uint32_t)(b & 0x0Fu) + LZ_STREAM_MIN_MATCH;
+            if (z->lit == 15u)
+                z->state = LZ_LIT_EXT;
+            else
+                z->state = z->lit ? LZ_LIT : LZ_OFF_LO;
+            break;
+        case LZ_LIT_EXT:
+            z->lit += b;
+            if (z->lit > LZ_RUN_MAX)
+                z->failed = 1u;
+            else if (b != 255u)
+                z->state = LZ_LIT;
+            break;
+        case LZ_OFF_LO:
+            z->offset = b;
+            z->state = LZ_OFF_HI;
+            break;
+        case LZ_OFF_HI:
+            z->offset = (uint16_t)(z->offset | ((uint16_t)b << 8));
+            if (z->match == 15u + LZ_STREAM_MIN_MATCH)
+                z->state = LZ_MATCH_EXT;
+            else if (!lz_copy_match(z, out, ctx))
+                z->failed = 1u;
+            break;
+        default: /* LZ_MATCH_EXT */
+            z->match += b;
+            if (z->match > LZ_RUN_MAX)
+                z->failed = 1u;
+            else if (b != 255u && !lz_copy_match(z, out, ctx))
+                z->failed = 1u;
+            break;
+        }
+    }
+    lz_flush(z, out, ctx);
+    return z->failed ? 0u : 1u;
+}
+
+uint8_t lz_stream_complete(const lz_stream_t *z)
+{
+    if (z->failed)
+        return 0u;
+    /* Sequences end either after their match or, for the last one, right
+     * after the literals where an offset would follow. */
+    return (z->state == LZ_TOKEN || z->state == LZ_OFF_LO) ? 1u : 0u;
+}
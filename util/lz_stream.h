@@ -0,0 +1,43 @@
+#ifndef OPEN_FIRMWARE_UTIL_LZ_STREAM_H
+#define OPEN_FIRMWARE_UTIL_LZ_STREAM_H
+
+#include <stdint.h>
+
+/*
+ * Streaming decoder for LZ4 block-format sequences with the match distance
+ * capped at LZ_STREAM_WINDOW, so history fits a small RAM ring:
+ *
+ *   token[1]   literal count (high nibble) | match length - 4 (low nibble);
+ *              a nibble of 15 continues in 255-valued bytes plus a last < 255
+ *   literals
+ *   offset[2]  little-endian distance 1..LZ_STREAM_WINDOW back
+ *   (match extension bytes)
+ *
+ * The last sequence stops after its literals. Input may be split anywhere;
+ * decoded bytes are handed to `out` in runs (at most one window per call).
+ */
+#define LZ_STREAM_WINDOW 2048u
+#define LZ_STREAM_MIN_MATCH 4u
+
+typedef void (*lz_stream_out_fn)(void *ctx, const uint8_t *data, uint32_t len);
+
+typedef struct {
+    uint8_t state;
+    uint8_t failed;
+    uint16_t offset;
+    uint16_t pos;        /* ring write index */
+    uint16_t flushed;    /* ring bytes before this were handed out */
+    uint32_t lit;        /* literals still to come in this sequence */
+    uint32_t match;
+    uint32_t produced;
+    uint8_t ring[LZ_STREAM_WINDOW];
+} lz_stream_t;
+
+void lz_stream_begin(lz_stream_t *z);
+/* Returns 0 once the stream is corrupt (distance past the start or the
+ * window); later calls then do nothing. */
+uint8_t lz_stream_feed(lz_stream_t *z, const uint8_t *in, uint32_t len, lz_stream_out_fn out, void *ctx);
+/* 1 when the input so far ends on a sequence boundary. */
+uint8_t lz_stream_complete(const lz_stream_t *z);
+
+#endif